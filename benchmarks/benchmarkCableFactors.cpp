@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkCableFactors.cpp
+ * @brief Benchmark linearizing the cable robot factors.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+using gtsam::Point3;
+
+namespace {
+
+const Point3 wPa(3, 0, 3), xPb(0.15, 0, 0.15);
+
+// A pose and twist of the end effector, with one cable's variables.
+gtsam::Values CableValues() {
+  gtsam::Values values;
+  InsertJointAngle(&values, 0, 1.8);
+  InsertJointVel(&values, 0, 0.1);
+  InsertTorque(&values, 0, 2.0);
+  InsertPose(&values, 1,
+             gtsam::Pose3(gtsam::Rot3::Ry(0.1), Point3(1.5, 0, 1.5)));
+  InsertTwist(&values, 1,
+              (gtsam::Vector6() << 0, 0.2, 0, 0.3, 0, -0.1).finished());
+  InsertWrench(&values, 1, 0, gtsam::Vector6::Zero());
+  return values;
+}
+
+template <class FACTOR>
+void Linearize(benchmark::State &state, const FACTOR &factor) {
+  const gtsam::Values values = CableValues();
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(factor.linearize(values));
+  }
+}
+
+void CableLengthLinearize(benchmark::State &state) {
+  Linearize(state, CableLengthFactor(JointAngleKey(0), PoseKey(1),
+                                     gtsam::noiseModel::Isotropic::Sigma(1, 1),
+                                     wPa, xPb));
+}
+BENCHMARK(CableLengthLinearize);
+
+void CableVelocityLinearize(benchmark::State &state) {
+  Linearize(state, CableVelocityFactor(
+                       JointVelKey(0), PoseKey(1), TwistKey(1),
+                       gtsam::noiseModel::Isotropic::Sigma(1, 1), wPa, xPb));
+}
+BENCHMARK(CableVelocityLinearize);
+
+void CableTensionLinearize(benchmark::State &state) {
+  Linearize(state, CableTensionFactor(
+                       TorqueKey(0), PoseKey(1), WrenchKey(1, 0),
+                       gtsam::noiseModel::Isotropic::Sigma(6, 1), wPa, xPb));
+}
+BENCHMARK(CableTensionLinearize);
+
+}  // namespace
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkChain.cpp
+ * @brief Benchmark dynamic and fixed-size leg chains.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/dynamics/ChainIK.h>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+using gtsam::Point3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace {
+
+// A 3-joint leg, with the screw axes of the DynamicalEquality3 tests.
+Chain3 Leg() {
+  const Pose3 sMb(Rot3(), Point3(0, 3, 8));
+  Chain3::Axes axes;
+  axes << 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 3, 0, 5, 0, 0, 0, 0, 29;
+  return Chain3(sMb, axes);
+}
+
+const Vector3 kAngles(0.3, -0.5, 1.2), kTorques(1, 2, 3);
+const Vector6 kWrench = (Vector6() << 1, -2, 3, 0.5, 0.1, -1).finished();
+
+void ChainDynamicalEquality(benchmark::State &state) {
+  Chain chain = Leg().chain();
+  Matrix H_wrench, H_angles, H_torques;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chain.DynamicalEquality3(
+        kWrench, kAngles, kTorques, H_wrench, H_angles, H_torques));
+  }
+}
+BENCHMARK(ChainDynamicalEquality);
+
+void Chain3DynamicalEquality(benchmark::State &state) {
+  const Chain3 chain = Leg();
+  gtsam::Matrix36 H_wrench;
+  gtsam::Matrix3 H_angles, H_torques;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chain.DynamicalEquality3(
+        kWrench, kAngles, kTorques, H_wrench, H_angles, H_torques));
+  }
+}
+BENCHMARK(Chain3DynamicalEquality);
+
+void ChainPoe(benchmark::State &state) {
+  Chain chain = Leg().chain();
+  const gtsam::Vector angles = kAngles;
+  Matrix J;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chain.poe(angles, boost::none, J));
+  }
+}
+BENCHMARK(ChainPoe);
+
+void Chain3Poe(benchmark::State &state) {
+  const Chain3 chain = Leg();
+  Chain3::Axes J;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chain.poe(kAngles, boost::none, J));
+  }
+}
+BENCHMARK(Chain3Poe);
+
+void Chain3IK(benchmark::State &state) {
+  const ChainIK<3> ik(Leg(), Vector3::Constant(-10), Vector3::Constant(10));
+  const Pose3 goal = ik.chain().poe(kAngles);
+  const Vector3 q_init(0.2, -0.4, 1.0);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ik.solve(goal, q_init));
+  }
+}
+BENCHMARK(Chain3IK);
+
+}  // namespace
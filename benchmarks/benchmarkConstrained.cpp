@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkConstrained.cpp
+ * @brief Benchmark every optimization method on the problems of
+ * constrainedProblems.h. Besides the wall time, every benchmark reports the
+ * LM iterations of a solve and the cost and constraint violation of its
+ * result as counters, which the JSON output includes, e.g.
+ *   ./gtdynamics_benchmarks --benchmark_filter=Constrained \
+ *       --benchmark_out=constrained.json --benchmark_out_format=json
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarkModels.h"
+#include "constrainedProblems.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+using Method = OptimizationParameters::Method;
+
+/**
+ * Build a problem once per run. If it cannot be built, e.g. because a model
+ * does not load, the benchmark is skipped and nullptr is returned.
+ */
+const ConstrainedProblem *GetProblem(benchmark::State &state,
+                                     const ProblemFactory &factory) {
+  static std::map<std::string, ConstrainedProblem> problems;
+  auto it = problems.find(factory.name);
+  if (it == problems.end()) {
+    try {
+      it = problems.emplace(factory.name, factory.create()).first;
+    } catch (const std::exception &e) {
+      state.SkipWithError(e.what());
+      return nullptr;
+    }
+  }
+  return &it->second;
+}
+
+void SolveConstrained(benchmark::State &state, const ProblemFactory &factory,
+                      Method method) {
+  const ConstrainedProblem *problem = GetProblem(state, factory);
+  if (!problem) return;
+  OptimizationParameters parameters;
+  parameters.method = method;
+  parameters.telemetry = std::make_shared<OptimizerTelemetry>();
+  const Optimizer optimizer(parameters);
+
+  gtsam::Values result;
+  size_t iterations = 0;
+  for (auto _ : state) {
+    parameters.telemetry->clear();
+    result = optimizer.optimize(problem->costs, problem->constraints,
+                                problem->initial_values);
+    iterations = parameters.telemetry->iterations().size();
+  }
+
+  const ConstraintEvaluation evaluation =
+      EvaluateConstraints(problem->constraints, result);
+  state.counters["lm_iterations"] = iterations;
+  state.counters["violation"] = evaluation.violationNorm();
+  state.counters["max_violation"] = evaluation.max_violation;
+  state.counters["cost"] = problem->costs.error(result);
+}
+
+// Register "Constrained/<problem>/<method>" for every problem and method.
+bool RegisterConstrained() {
+  const std::vector<std::pair<std::string, Method>> methods{
+      {"soft_constraints", Method::SOFT_CONSTRAINTS},
+      {"penalty", Method::PENALTY},
+      {"augmented_lagrangian", Method::AUGMENTED_LAGRANGIAN},
+      {"incremental", Method::INCREMENTAL},
+      {"sqp", Method::SQP}};
+  for (auto &&factory : ConstrainedProblems()) {
+    for (auto &&method : methods) {
+      const Method m = method.second;
+      benchmark::RegisterBenchmark(
+          ("Constrained/" + factory.name + "/" + method.first).c_str(),
+          [factory, m](benchmark::State &state) {
+            SolveConstrained(state, factory, m);
+          })
+          ->Unit(benchmark::kMillisecond)
+          ->UseRealTime();
+    }
+  }
+  return true;
+}
+
+const bool registered = RegisterConstrained();
+
+}  // namespace
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkDynamicsGraph.cpp
+ * @brief Benchmark linear dynamics solves and trajectory graph construction.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsDerivatives.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Kinematics at zero joint angles and velocities, with given torques or
+// joint accelerations, as needed by linearSolveFD and linearSolveID.
+gtsam::Values KnownValues(const Robot &robot, bool accelerations) {
+  gtsam::Values known;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known, j, 0.0);
+    InsertJointVel(&known, j, 0.0);
+    if (accelerations) {
+      InsertJointAccel(&known, j, 0.0);
+    } else {
+      InsertTorque(&known, j, 0.0);
+    }
+  }
+  return robot.forwardKinematics(known, 0, RootLinkName(robot));
+}
+
+void LinearSolveFD(benchmark::State &state, const Robot &robot) {
+  DynamicsGraph graph_builder(kGravity);
+  const gtsam::Values known = KnownValues(robot, false);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.linearSolveFD(robot, 0, known));
+  }
+}
+
+void LinearSolveID(benchmark::State &state, const Robot &robot) {
+  DynamicsGraph graph_builder(kGravity);
+  const gtsam::Values known = KnownValues(robot, true);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.linearSolveID(robot, 0, known));
+  }
+}
+
+const bool registered = RegisterPerModel("linearSolveFD", LinearSolveFD) &&
+                        RegisterPerModel("linearSolveID", LinearSolveID);
+
+// Forward dynamics with its Jacobians, with the root link fixed.
+void ForwardDynamicsJacobians(benchmark::State &state, const Robot &model) {
+  const Robot robot = model.fixLink(RootLinkName(model));
+  std::unique_ptr<DynamicsDerivatives> derivatives;
+  try {
+    derivatives.reset(new DynamicsDerivatives(robot, kGravity));
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  const gtsam::Values known = KnownValues(robot, false);
+  std::vector<gtsam::Pose3> poses;
+  std::vector<gtsam::Vector6> twists;
+  for (auto &&link : robot.links()) {
+    poses.push_back(Pose(known, link->id()));
+    twists.push_back(Twist(known, link->id()));
+  }
+  const gtsam::Vector zeros = gtsam::Vector::Zero(robot.numJoints());
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    derivatives->solveForward(poses, twists, zeros, zeros);
+    benchmark::DoNotOptimize(derivatives->H_q());
+  }
+}
+
+const bool registered_derivatives = RegisterPerModel(
+    "DynamicsDerivatives::solveForward", ForwardDynamicsJacobians);
+
+// Build the trajectory graph of a quadruped for state.range(0) steps.
+void TrajectoryFG(benchmark::State &state) {
+  const Model quadruped{"vision60", kUrdfPath + std::string("vision60.urdf"),
+                        ""};
+  const Robot *robot = LoadRobot(state, quadruped);
+  if (!robot) return;
+  DynamicsGraph graph_builder(kGravity);
+  const int num_steps = state.range(0);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        graph_builder.trajectoryFG(*robot, num_steps, 0.01));
+  }
+  state.SetItemsProcessed(state.iterations() * num_steps);
+}
+BENCHMARK(TrajectoryFG)->Arg(1)->Arg(10)->Arg(100)->Arg(300);
+}  // namespace
@@ -0,0 +1,57 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkKinematics.cpp
+ * @brief Benchmark forward and inverse kinematics.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/Slice.h>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+
+void ForwardKinematics(benchmark::State &state, const Robot &robot) {
+  const gtsam::Values joint_values = ZeroJointValues(robot);
+  const std::string root = RootLinkName(robot);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(robot.forwardKinematics(joint_values, 0, root));
+  }
+}
+
+const bool registered =
+    RegisterPerModel("forwardKinematics", ForwardKinematics);
+
+// Inverse kinematics of a quadruped standing on four feet.
+void KinematicsInverse(benchmark::State &state) {
+  const Model quadruped{"vision60", kUrdfPath + std::string("vision60.urdf"),
+                        ""};
+  const Robot *robot = LoadRobot(state, quadruped);
+  if (!robot) return;
+  const gtsam::Point3 contact_in_com(0.14, 0, 0);
+  const ContactGoals contact_goals = {
+      {{robot->link("lower1"), contact_in_com}, {-0.4, 0.16, -0.2}},
+      {{robot->link("lower0"), contact_in_com}, {0.3, 0.16, -0.2}},
+      {{robot->link("lower2"), contact_in_com}, {0.3, -0.16, -0.2}},
+      {{robot->link("lower3"), contact_in_com}, {-0.4, -0.16, -0.2}}};
+  const Kinematics kinematics;
+  const Slice slice(0);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kinematics.inverse(slice, *robot, contact_goals));
+  }
+}
+BENCHMARK(KinematicsInverse)->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkModels.h
+ * @brief Robot models and allocation counting shared by the benchmarks.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace benchmarks {
+
+/// A robot description in models/urdfs or models/sdfs.
+struct Model {
+  std::string name;        ///< Name used in benchmark names.
+  std::string path;        ///< Path to the urdf or sdf file.
+  std::string model_name;  ///< Model to load from an sdf file.
+};
+
+/// The robots in models/urdfs and models/sdfs.
+inline const std::vector<Model> &Models() {
+  static const std::vector<Model> models{
+      {"a1", kUrdfPath + std::string("a1/a1.urdf"), ""},
+      {"atlas", kUrdfPath + std::string("atlas.urdf"), ""},
+      {"biped", kUrdfPath + std::string("biped.urdf"), ""},
+      {"cart_pole", kUrdfPath + std::string("cart_pole.urdf"), ""},
+      {"fanuc_lrmate200id", kUrdfPath + std::string("fanuc_lrmate200id.urdf"),
+       ""},
+      {"fetch", kUrdfPath + std::string("fetch.urdf"), ""},
+      {"inverted_pendulum", kUrdfPath + std::string("inverted_pendulum.urdf"),
+       ""},
+      {"laikago", kUrdfPath + std::string("laikago.urdf"), ""},
+      {"panda", kUrdfPath + std::string("panda/panda.urdf"), ""},
+      {"ur5", kUrdfPath + std::string("ur5/ur5.urdf"), ""},
+      {"vision60", kUrdfPath + std::string("vision60.urdf"), ""},
+      {"a1_sdf", kSdfPath + std::string("a1.sdf"), "a1_description"},
+      {"gripper_sdf", kSdfPath + std::string("gripper.sdf"), "simple_gripper"},
+      {"kuka_sdf", kSdfPath + std::string("kuka_world.sdf"), "lbr_iiwa"},
+      {"spider_sdf", kSdfPath + std::string("spider.sdf"), "spider"},
+      {"spider_alt_sdf", kSdfPath + std::string("spider_alt.sdf"), "spider"}};
+  return models;
+}
+
+/**
+ * Load a robot once per run. If the model cannot be loaded, the benchmark is
+ * skipped with the parse error and nullptr is returned.
+ */
+inline const Robot *LoadRobot(benchmark::State &state, const Model &model) {
+  static std::map<std::string, Robot> robots;
+  auto it = robots.find(model.name);
+  if (it == robots.end()) {
+    try {
+      it = robots
+               .emplace(model.name,
+                        CreateRobotFromFile(model.path, model.model_name))
+               .first;
+    } catch (const std::exception &e) {
+      state.SkipWithError(e.what());
+      return nullptr;
+    }
+  }
+  if (it->second.numJoints() == 0) {
+    state.SkipWithError("model has no joints");
+    return nullptr;
+  }
+  return &it->second;
+}
+
+/// Name of the link used as the root for forward kinematics.
+inline std::string RootLinkName(const Robot &robot) {
+  for (auto &&link : robot.links())
+    if (link->isFixed()) return link->name();
+  return robot.links().front()->name();
+}
+
+/// Zero joint angles, velocities, accelerations and torques at time k.
+inline gtsam::Values ZeroJointValues(const Robot &robot, size_t k = 0) {
+  gtsam::Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, k, 0.0);
+    InsertJointVel(&values, j, k, 0.0);
+    InsertJointAccel(&values, j, k, 0.0);
+    InsertTorque(&values, j, k, 0.0);
+  }
+  return values;
+}
+
+/**
+ * Counts heap allocations made while it is alive, and reports them per
+ * iteration as the "allocs" counter. Allocations are only counted when
+ * GTDynamics is configured with GTDYNAMICS_PROFILE_ALLOCATIONS.
+ */
+class AllocationCounter {
+  benchmark::State &state_;
+  size_t start_;
+
+ public:
+  explicit AllocationCounter(benchmark::State &state)
+      : state_(state), start_(FactorProfile::NumAllocations()) {}
+
+  ~AllocationCounter() {
+    if (!FactorProfile::CountsAllocations()) return;
+    state_.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(FactorProfile::NumAllocations() - start_),
+        benchmark::Counter::kAvgIterations);
+  }
+};
+
+/**
+ * Register one benchmark per model, named "<name>/<model>".
+ * @param name  benchmark name
+ * @param run   benchmark body, given the state and a loaded robot
+ */
+inline bool RegisterPerModel(
+    const std::string &name,
+    const std::function<void(benchmark::State &, const Robot &)> &run) {
+  for (auto &&model : Models()) {
+    benchmark::RegisterBenchmark(
+        (name + "/" + model.name).c_str(),
+        [model, run](benchmark::State &state) {
+          if (const Robot *robot = LoadRobot(state, model)) run(state, *robot);
+        });
+  }
+  return true;
+}
+
+}  // namespace benchmarks
+}  // namespace gtdynamics
@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkScaling.cpp
+ * @brief Benchmark how kinematics, dynamics and trajectory graphs scale with
+ * the number of joints of synthetic robots and with the horizon length.
+ * Fit the scaling exponents with scaling_exponents.py, e.g.
+ *   ./gtdynamics_benchmarks --benchmark_filter=Scaling \
+ *       --benchmark_format=json > scaling.json
+ *   python3 scaling_exponents.py scaling.json
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/Initializer.h>
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Generated robots by topology, sized by the number of joints n.
+enum class Topology { kChain, kTree, kWalker };
+
+const Robot &Generated(Topology topology, int n) {
+  static std::map<std::pair<Topology, int>, Robot> robots;
+  auto it = robots.find({topology, n});
+  if (it != robots.end()) return it->second;
+  Robot robot;
+  switch (topology) {
+    case Topology::kChain:
+      robot = robot_generator::SerialChain(n);
+      break;
+    case Topology::kTree:
+      // 2^levels - 2 joints; n is rounded down to a full tree.
+      robot = robot_generator::BinaryTree(
+          static_cast<size_t>(std::log2(n + 2)));
+      break;
+    case Topology::kWalker:
+      // Four legs of n / 4 joints.
+      robot = robot_generator::Walker(4, n / 4);
+      break;
+  }
+  return robots.emplace(std::make_pair(topology, n), robot).first->second;
+}
+
+// Sizes in joints, as a power-of-two sweep that keeps trees full.
+void JointSweep(benchmark::internal::Benchmark *b) {
+  for (int n = 6; n <= 510; n = 2 * n + 2) b->Arg(n);
+}
+
+// Kinematics at zero joint angles and velocities with zero torques.
+gtsam::Values KnownValues(const Robot &robot) {
+  gtsam::Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), 0.0);
+    InsertJointVel(&known, joint->id(), 0.0);
+    InsertTorque(&known, joint->id(), 0.0);
+  }
+  return robot.forwardKinematics(known, 0, RootLinkName(robot));
+}
+
+void ScalingForwardKinematics(benchmark::State &state, Topology topology) {
+  const Robot &robot = Generated(topology, state.range(0));
+  const gtsam::Values joint_values = ZeroJointValues(robot);
+  const std::string root = RootLinkName(robot);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(robot.forwardKinematics(joint_values, 0, root));
+  }
+  state.SetComplexityN(robot.numJoints());
+}
+
+void ScalingLinearSolveFD(benchmark::State &state, Topology topology) {
+  const Robot &robot = Generated(topology, state.range(0));
+  const DynamicsGraph graph_builder(kGravity);
+  const gtsam::Values known = KnownValues(robot);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.linearSolveFD(robot, 0, known));
+  }
+  state.SetComplexityN(robot.numJoints());
+}
+
+// Build a 10-step trajectory graph.
+void ScalingTrajectoryFG(benchmark::State &state, Topology topology) {
+  const Robot &robot = Generated(topology, state.range(0));
+  const DynamicsGraph graph_builder(kGravity);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.trajectoryFG(robot, 10, 0.01));
+  }
+  state.SetComplexityN(robot.numJoints());
+}
+
+// Linearize a 10-step trajectory graph at zero values.
+void ScalingLinearize(benchmark::State &state, Topology topology) {
+  const Robot &robot = Generated(topology, state.range(0));
+  const DynamicsGraph graph_builder(kGravity);
+  const auto graph = graph_builder.trajectoryFG(robot, 10, 0.01);
+  const gtsam::Values values = Initializer().ZeroValuesTrajectory(robot, 10);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph.linearize(values));
+  }
+  state.SetComplexityN(robot.numJoints());
+}
+
+// Register "<name>/<topology>" for every topology, over the joint sweep.
+bool RegisterScaling(const std::string &name,
+                     void (*run)(benchmark::State &, Topology)) {
+  const std::vector<std::pair<std::string, Topology>> topologies{
+      {"chain", Topology::kChain},
+      {"tree", Topology::kTree},
+      {"walker", Topology::kWalker}};
+  for (auto &&topology : topologies) {
+    const Topology t = topology.second;
+    benchmark::RegisterBenchmark(
+        (name + "/" + topology.first).c_str(),
+        [run, t](benchmark::State &state) { run(state, t); })
+        ->Apply(JointSweep)
+        ->Complexity();
+  }
+  return true;
+}
+
+const bool registered =
+    RegisterScaling("ScalingForwardKinematics", ScalingForwardKinematics) &&
+    RegisterScaling("ScalingLinearSolveFD", ScalingLinearSolveFD) &&
+    RegisterScaling("ScalingTrajectoryFG", ScalingTrajectoryFG) &&
+    RegisterScaling("ScalingLinearize", ScalingLinearize);
+
+// Build and linearize the trajectory graph of a 12-joint walker for
+// state.range(0) steps.
+void ScalingHorizon(benchmark::State &state) {
+  const Robot &robot = Generated(Topology::kWalker, 12);
+  const DynamicsGraph graph_builder(kGravity);
+  const int num_steps = state.range(0);
+  const gtsam::Values values =
+      Initializer().ZeroValuesTrajectory(robot, num_steps);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.01);
+    benchmark::DoNotOptimize(graph.linearize(values));
+  }
+  state.SetComplexityN(num_steps);
+}
+BENCHMARK(ScalingHorizon)
+    ->RangeMultiplier(2)
+    ->Range(4, 256)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkSimulator.cpp
+ * @brief Benchmark simulating robots with the Simulator.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/Simulator.h>
+
+#include <algorithm>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+constexpr size_t kNumSteps = 100;
+constexpr double kDt = 0.01;
+
+// Simulate kNumSteps steps with constant torques from rest.
+void Simulate(benchmark::State &state, const Robot &robot) {
+  const auto &links = robot.links();
+  if (std::none_of(links.begin(), links.end(),
+                   [](const LinkSharedPtr &link) { return link->isFixed(); })) {
+    state.SkipWithError("Simulator needs a fixed link");
+    return;
+  }
+  gtsam::Values initial_values, torques;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&initial_values, joint->id(), 0.0);
+    InsertJointVel(&initial_values, joint->id(), 0.0);
+    InsertTorque(&torques, joint->id(), 0.1);
+  }
+  const std::vector<gtsam::Values> torques_seq(kNumSteps, torques);
+  Simulator simulator(robot, initial_values, gtsam::Vector3(0, 0, -9.8));
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    simulator.reset();
+    benchmark::DoNotOptimize(simulator.simulate(torques_seq, kDt));
+  }
+  state.SetItemsProcessed(state.iterations() * kNumSteps);
+}
+
+const bool registered = RegisterPerModel("Simulator::simulate", Simulate);
+
+}  // namespace
@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchmarkStatics.cpp
+ * @brief Benchmark solving for static wrenches.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/Slice.h>
+
+#include <vector>
+
+#include "benchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+
+// Wrenches and torques holding each robot at zero joint angles.
+void StaticsSolve(benchmark::State &state, const Robot &robot) {
+  const Statics statics(
+      StaticsParameters(1e-5, gtsam::Vector3(0, 0, -9.8)));
+  const Slice slice(0);
+  const gtsam::Values configuration = robot.forwardKinematics(
+      ZeroJointValues(robot), 0, RootLinkName(robot));
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(statics.solve(slice, robot, configuration));
+  }
+}
+
+const bool registered = RegisterPerModel("Statics::solve", StaticsSolve);
+
+// The same, for a batch of 64 configurations at once.
+void StaticsSolveBatch(benchmark::State &state, const Robot &robot) {
+  const Statics statics(
+      StaticsParameters(1e-5, gtsam::Vector3(0, 0, -9.8)));
+  const Slice slice(0);
+  const std::vector<gtsam::Values> configurations(
+      64, robot.forwardKinematics(ZeroJointValues(robot), 0,
+                                  RootLinkName(robot)));
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(statics.solveBatch(slice, robot, configurations));
+  }
+  state.SetItemsProcessed(state.iterations() * configurations.size());
+}
+
+const bool registered_batch =
+    RegisterPerModel("Statics::solveBatch", StaticsSolveBatch);
+
+// Closed-form gravity compensation torques and their Jacobian, with the root
+// link fixed, as in a control loop.
+void GravityCompensation(benchmark::State &state, const Robot &model) {
+  const Robot robot = model.fixLink(RootLinkName(model));
+  const gtsam::Vector q = gtsam::Vector::Zero(robot.numJoints());
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  gtsam::Matrix H_q;
+  try {
+    GravityCompensationTorques(robot, q, gravity);
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GravityCompensationTorques(robot, q, gravity, H_q));
+  }
+}
+
+const bool registered_gravity = RegisterPerModel(
+    "Statics::GravityCompensationTorques", GravityCompensation);
+
+}  // namespace
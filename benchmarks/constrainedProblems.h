@@ -0,0 +1,209 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  constrainedProblems.h
+ * @brief Constrained optimization problems on robot models, with fixed
+ * initial values, for comparing the optimization methods.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace benchmarks {
+
+/// Minimize the costs subject to the constraints, from the initial values.
+struct ConstrainedProblem {
+  gtsam::NonlinearFactorGraph costs;
+  EqualityConstraints constraints;
+  gtsam::Values initial_values;
+};
+
+/// Seed of the noise added to initial values.
+constexpr uint64_t kProblemSeed = 42;
+
+/// Every factor of a graph as a FactorEquality with the given tolerance.
+inline EqualityConstraints FactorConstraints(
+    const gtsam::NonlinearFactorGraph &graph, double tolerance) {
+  EqualityConstraints constraints;
+  for (auto &&factor : graph) {
+    auto noise_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (!noise_factor) {
+      throw std::invalid_argument(
+          "FactorConstraints: factors must be noise model factors");
+    }
+    constraints.emplace_shared<FactorEquality>(noise_factor, tolerance);
+  }
+  return constraints;
+}
+
+/// Minimum-torque inverse dynamics of a four-bar linkage, a closed loop.
+inline ConstrainedProblem FourBarInverseDynamics() {
+  ConstrainedProblem problem;
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath +
+                          std::string("test/four_bar_linkage_pure.sdf"))
+          .fixLink("l1");
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, -10, 0),
+                                    gtsam::Vector3(1, 0, 0));
+  gtsam::NonlinearFactorGraph constraints =
+      graph_builder.dynamicsFactorGraph(robot, 0);
+  gtsam::Values at_rest;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&at_rest, joint->id(), 0, 0.0);
+    InsertJointVel(&at_rest, joint->id(), 0, 0.0);
+    InsertJointAccel(&at_rest, joint->id(), 0, 0.0);
+  }
+  constraints.add(graph_builder.inverseDynamicsPriors(robot, 0, at_rest));
+  for (auto &&link : robot.links()) {
+    constraints.addPrior(PoseKey(link->id(), 0), link->bMcom(),
+                         gtsam::noiseModel::Constrained::All(6));
+    constraints.addPrior<gtsam::Vector6>(
+        TwistKey(link->id(), 0), gtsam::Z_6x1,
+        gtsam::noiseModel::Constrained::All(6));
+  }
+  problem.constraints = FactorConstraints(constraints, 1e-4);
+  for (auto &&joint : robot.joints()) {
+    problem.costs.emplace_shared<MinTorqueFactor>(
+        TorqueKey(joint->id(), 0), gtsam::noiseModel::Unit::Create(1));
+  }
+  problem.initial_values =
+      Initializer(1, true, kProblemSeed).ZeroValues(robot, 0, 0.1);
+  return problem;
+}
+
+/// Inverse kinematics of a quadruped standing on four contact goals.
+inline ConstrainedProblem QuadrupedInverseKinematics() {
+  ConstrainedProblem problem;
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+  const gtsam::Point3 contact_in_com(0.14, 0, 0);
+  const ContactGoals contact_goals = {
+      {{robot.link("lower1"), contact_in_com}, {-0.4, 0.16, -0.2}},
+      {{robot.link("lower0"), contact_in_com}, {0.3, 0.16, -0.2}},
+      {{robot.link("lower2"), contact_in_com}, {0.3, -0.16, -0.2}},
+      {{robot.link("lower3"), contact_in_com}, {-0.4, -0.16, -0.2}}};
+  const Kinematics kinematics;
+  const Slice slice(0);
+  problem.constraints = kinematics.constraints(slice, robot);
+  problem.constraints.add(
+      kinematics.pointGoalConstraints(slice, contact_goals));
+  problem.costs = kinematics.jointAngleObjectives(slice, robot);
+  problem.initial_values = kinematics.initialValues(slice, robot, 0.1);
+  return problem;
+}
+
+/**
+ * Swing-up of a cart-pole in num_steps steps of dt, from rest to the pole up
+ * at x = 1, with the pole joint unactuated and minimal cart forces.
+ */
+inline ConstrainedProblem CartPoleSwingUp(int num_steps = 40,
+                                          double dt = 0.05) {
+  ConstrainedProblem problem;
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("cart_pole.urdf"))
+          .fixLink("l0");
+  const int j0 = robot.joint("j0")->id(), j1 = robot.joint("j1")->id();
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const auto exact = gtsam::noiseModel::Constrained::All(1);
+
+  gtsam::NonlinearFactorGraph constraints = graph_builder.trajectoryFG(
+      robot, num_steps, dt, CollocationScheme::Trapezoidal);
+  for (int t = 0; t <= num_steps; t++) {
+    constraints.addPrior(TorqueKey(j1, t), 0.0, exact);
+  }
+  for (int j : {j0, j1}) {
+    constraints.addPrior(JointAngleKey(j, 0), 0.0, exact);
+    constraints.addPrior(JointVelKey(j, 0), 0.0, exact);
+    constraints.addPrior(JointVelKey(j, num_steps), 0.0, exact);
+  }
+  constraints.addPrior(JointAngleKey(j0, num_steps), 1.0, exact);
+  constraints.addPrior(JointAngleKey(j1, num_steps), M_PI, exact);
+  problem.constraints = FactorConstraints(constraints, 1e-4);
+
+  const auto control_model = gtsam::noiseModel::Isotropic::Sigma(1, 20);
+  for (int t = 0; t <= num_steps; t++) {
+    problem.costs.emplace_shared<MinTorqueFactor>(TorqueKey(j0, t),
+                                                  control_model);
+  }
+  Initializer initializer(1, true, kProblemSeed);
+  problem.initial_values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.01);
+  return problem;
+}
+
+/**
+ * Statics of a spider with its body held in place: joint torques and
+ * wrenches that hold the legs against gravity, near zero joint angles, with
+ * minimal torques.
+ */
+inline ConstrainedProblem SpiderStatics() {
+  ConstrainedProblem problem;
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider")
+          .fixLink("body");
+  const Slice slice(0);
+  const Statics statics(StaticsParameters(1e-5, gtsam::Vector3(0, 0, -9.8)));
+
+  problem.constraints = statics.constraints(slice, robot);
+  gtsam::NonlinearFactorGraph constraints = statics.graph(slice, robot);
+  const auto body = robot.link("body");
+  constraints.addPrior(PoseKey(body->id(), 0), body->bMcom(),
+                       gtsam::noiseModel::Constrained::All(6));
+  problem.constraints.add(FactorConstraints(constraints, 1e-4));
+
+  problem.costs = statics.jointAngleObjectives(slice, robot);
+  const auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 10);
+  for (auto &&joint : robot.joints()) {
+    problem.costs.emplace_shared<MinTorqueFactor>(TorqueKey(joint->id(), 0),
+                                                  torque_model);
+  }
+  problem.initial_values =
+      statics.Kinematics::initialValues(slice, robot, 0.1);
+  problem.initial_values.insert(statics.initialValues(slice, robot));
+  return problem;
+}
+
+/// A named problem, built on demand.
+struct ProblemFactory {
+  std::string name;
+  std::function<ConstrainedProblem()> create;
+};
+
+/// All problems.
+inline const std::vector<ProblemFactory> &ConstrainedProblems() {
+  static const std::vector<ProblemFactory> problems{
+      {"four_bar_id", FourBarInverseDynamics},
+      {"vision60_ik", QuadrupedInverseKinematics},
+      {"cart_pole_swing_up", [] { return CartPoleSwingUp(); }},
+      {"spider_statics", SpiderStatics}};
+  return problems;
+}
+
+}  // namespace benchmarks
+}  // namespace gtdynamics
@@ -0,0 +1,70 @@
+"""
+GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+Atlanta, Georgia 30332-0415
+All Rights Reserved
+See LICENSE for the license information
+
+@file  scaling_exponents.py
+@brief Fit scaling exponents to the output of the scaling benchmarks.
+@author GTDynamics Team
+
+Fits time ~ c * n^k by least squares on log(time) and log(n), per benchmark
+family, where n is the complexity N reported by the benchmark, otherwise its
+argument: the number of joints, or the number of steps of the horizon
+sweep. Usage:
+
+    ./gtdynamics_benchmarks --benchmark_filter=Scaling \
+        --benchmark_format=json > scaling.json
+    python3 scaling_exponents.py scaling.json
+"""
+
+import argparse
+import json
+import math
+from collections import defaultdict
+
+
+def fit_exponent(points):
+    """Slope and intercept of log(time) against log(n)."""
+    xs = [math.log(n) for n, _ in points]
+    ys = [math.log(t) for _, t in points]
+    x_mean = sum(xs) / len(xs)
+    y_mean = sum(ys) / len(ys)
+    sxx = sum((x - x_mean)**2 for x in xs)
+    sxy = sum((x - x_mean) * (y - y_mean) for x, y in zip(xs, ys))
+    slope = sxy / sxx
+    return slope, y_mean - slope * x_mean
+
+
+def families(benchmarks):
+    """Group (n, cpu time) points by benchmark name without its argument."""
+    points = defaultdict(list)
+    for benchmark in benchmarks:
+        if benchmark.get("run_type") == "aggregate":
+            continue
+        family, _, arg = benchmark["name"].rpartition("/")
+        # Older versions of Google Benchmark do not report complexity_n.
+        n = benchmark.get("complexity_n", int(arg) if arg.isdigit() else 0)
+        if n > 0 and benchmark["cpu_time"] > 0:
+            points[family].append((n, benchmark["cpu_time"]))
+    return points
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Fit scaling exponents to benchmark output.")
+    parser.add_argument("json", help="Google Benchmark JSON output")
+    args = parser.parse_args()
+    with open(args.json) as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    print("{:<40} {:>6} {:>9}".format("benchmark", "points", "exponent"))
+    for family, points in sorted(families(benchmarks).items()):
+        if len(set(n for n, _ in points)) < 2:
+            continue
+        slope, _ = fit_exponent(points)
+        print("{:<40} {:>6} {:>9.2f}".format(family, len(points), slope))
+
+
+if __name__ == "__main__":
+    main()
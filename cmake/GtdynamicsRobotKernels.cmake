@@ -0,0 +1,51 @@
+# gtdynamics_add_robot_kernels(<target> MODEL <urdf or sdf file> CLASS <name>
+#                              [MODEL_NAME <model in sdf file>]
+#                              [FIXED_LINK <link name>]
+#                              [NAMESPACE <namespace>]
+#                              [GRAVITY <gx> <gy> <gz>])
+#
+# Generate a RobotKernels class specialized for one robot at build time, with
+# gtdynamics_generate_robot_kernels, and build it as the static library
+# <target>. Targets linking <target> include the generated header as
+# "<CLASS>.h". The kernels are regenerated when the model file changes.
+include(CMakeParseArguments)
+
+function(gtdynamics_add_robot_kernels target)
+  cmake_parse_arguments(ARG "" "MODEL;CLASS;MODEL_NAME;FIXED_LINK;NAMESPACE"
+                        "GRAVITY" ${ARGN})
+  if(NOT ARG_MODEL OR NOT ARG_CLASS)
+    message(FATAL_ERROR
+            "gtdynamics_add_robot_kernels: MODEL and CLASS are required")
+  endif()
+
+  set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/${target})
+  set(header ${output_dir}/${ARG_CLASS}.h)
+  set(source ${output_dir}/${ARG_CLASS}.cpp)
+  set(args --model ${ARG_MODEL} --class ${ARG_CLASS} --header ${header}
+           --source ${source})
+  if(ARG_MODEL_NAME)
+    list(APPEND args --model-name ${ARG_MODEL_NAME})
+  endif()
+  if(ARG_FIXED_LINK)
+    list(APPEND args --fixed-link ${ARG_FIXED_LINK})
+  endif()
+  if(ARG_NAMESPACE)
+    list(APPEND args --namespace ${ARG_NAMESPACE})
+  endif()
+  if(ARG_GRAVITY)
+    list(APPEND args --gravity ${ARG_GRAVITY})
+  endif()
+
+  file(MAKE_DIRECTORY ${output_dir})
+  add_custom_command(
+    OUTPUT ${header} ${source}
+    COMMAND gtdynamics_generate_robot_kernels ${args}
+    DEPENDS gtdynamics_generate_robot_kernels ${ARG_MODEL}
+    COMMENT "Generating ${ARG_CLASS} from ${ARG_MODEL}"
+    VERBATIM)
+
+  add_library(${target} STATIC ${source} ${header})
+  set_target_properties(${target} PROPERTIES POSITION_INDEPENDENT_CODE ON)
+  target_include_directories(${target} PUBLIC ${output_dir})
+  target_link_libraries(${target} PUBLIC gtdynamics)
+endfunction()
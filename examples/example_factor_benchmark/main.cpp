@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Time linearization of the dynamics graph with expression factors and
+ * with the hand-derived analytic factors.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace gtdynamics;
+
+/// Average time in microseconds to linearize a graph at the given values.
+double TimeLinearize(const gtsam::NonlinearFactorGraph& graph,
+                     const gtsam::Values& values, int num_runs) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_runs; i++) graph.linearize(values);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         num_runs;
+}
+
+int main(int argc, char** argv) {
+  const int num_steps = 10, num_runs = 100;
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+
+  // Evaluate both graphs at the same random values.
+  Initializer initializer;
+  auto values = initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+
+  std::cout << "Linearizing the " << num_steps
+            << "-step vision60 dynamics graph, average of " << num_runs
+            << " runs:" << std::endl;
+  double expression_time = 0;
+  for (bool analytic : {false, true}) {
+    OptimizerSetting opt;
+    opt.setAnalyticFactors(analytic);
+    DynamicsGraph graph_builder(opt, gravity);
+    gtsam::NonlinearFactorGraph graph;
+    for (int k = 0; k <= num_steps; k++)
+      graph.add(graph_builder.dynamicsFactorGraph(robot, k));
+
+    const double time = TimeLinearize(graph, values, num_runs);
+    std::cout << (analytic ? "  analytic:   " : "  expression: ") << time
+              << " us";
+    if (analytic) {
+      std::cout << " (" << expression_time / time << "x)";
+    } else {
+      expression_time = time;
+    }
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,456 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Receding-horizon kinematic trot controller for the vision 60
+ * quadruped, run at a fixed rate in its own thread, with latency and jitter
+ * histograms.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolvePlan.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::noiseModel::Isotropic;
+
+using namespace gtdynamics;
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+const double kGroundHeight = -0.2;
+const Point3 kContactInCom(0.14, 0, 0);  // Foot is 14cm along X in COM.
+
+// Swing pairs of the trot: left hind with right front, and right hind with
+// left front, half a gait cycle apart.
+const std::vector<std::string> kFeet{"lower0", "lower1", "lower2", "lower3"};
+const std::vector<double> kPhaseOffsets{0.0, 0.5, 0.0, 0.5};
+
+const auto kBodyModel = Isotropic::Sigma(6, 1e-2);
+const auto kMeasurementModel = Isotropic::Sigma(6, 1e-3);
+const auto kFootModel = Isotropic::Sigma(3, 1e-3);
+const auto kSmoothnessModel = Isotropic::Sigma(1, 0.1);
+}  // namespace
+
+/**
+ * Trot at constant forward speed: the body moves along x at a constant
+ * height, stance feet stay on their footholds, and swing feet move to the
+ * next foothold along a sine arc.
+ */
+class TrotReference {
+ public:
+  TrotReference(const Robot &robot, double speed, double gait_period,
+                double step_height)
+      : body_(robot.link("body")->bMcom()),
+        speed_(speed),
+        period_(gait_period),
+        height_(step_height) {
+    for (auto &&foot : kFeet) {
+      const Point3 p = robot.link(foot)->bMcom() * kContactInCom;
+      nominal_.emplace_back(p.x(), p.y(), kGroundHeight);
+    }
+  }
+
+  /// Body pose at time t.
+  Pose3 body(double t) const {
+    return Pose3(body_.rotation(),
+                 body_.translation() + Point3(speed_ * t, 0, 0));
+  }
+
+  /// Position of foot i at time t.
+  Point3 foot(size_t i, double t) const {
+    // Phase in the gait cycle: stance in [0, 0.5), swing in [0.5, 1).
+    const double s = std::fmod(t / period_ + kPhaseOffsets[i], 1.0);
+    // The foothold is under the nominal offset at the middle of the stance.
+    const double x = nominal_[i].x() + speed_ * (t - (s - 0.25) * period_);
+    if (s < 0.5) return Point3(x, nominal_[i].y(), kGroundHeight);
+    const double u = 2 * (s - 0.5);
+    return Point3(x + u * speed_ * period_, nominal_[i].y(),
+                  kGroundHeight + height_ * std::sin(M_PI * u));
+  }
+
+  /// Body pose reported by the state estimator at time t; a stand-in for
+  /// the real estimate, with a lateral sway the plan did not anticipate.
+  Pose3 measuredBody(double t) const {
+    const Pose3 wTb = body(t);
+    return Pose3(wTb.rotation(), wTb.translation() +
+                                     Point3(0, 0.01 * std::sin(2 * M_PI * t),
+                                            0));
+  }
+
+ private:
+  Pose3 body_;
+  double speed_, period_, height_;
+  std::vector<Point3> nominal_;
+};
+
+/// Goal factors of the step with key time t, for the reference at time.
+NonlinearFactorGraph GoalFactors(const Robot &robot,
+                                 const TrotReference &reference, size_t t,
+                                 double time) {
+  NonlinearFactorGraph graph;
+  graph.addPrior(PoseKey(robot.link("body")->id(), t), reference.body(time),
+                 kBodyModel);
+  for (size_t i = 0; i < kFeet.size(); i++) {
+    graph.emplace_shared<PointGoalFactor>(
+        PoseKey(robot.link(kFeet[i])->id(), t), kFootModel, kContactInCom,
+        reference.foot(i, time));
+  }
+  return graph;
+}
+
+/// Factors keeping the joint angles of step t close to those of step t - 1.
+NonlinearFactorGraph SmoothnessFactors(const Robot &robot, size_t t) {
+  NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints()) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(joint->id(), t - 1), JointAngleKey(joint->id(), t), 0.0,
+        kSmoothnessModel);
+  }
+  return graph;
+}
+
+/// Initial values of step t: the nominal stance under the reference body.
+Values NominalValues(const Robot &robot, const TrotReference &reference,
+                     size_t t, double time) {
+  Values values;
+  const Pose3 offset(Rot3(), reference.body(time).translation() -
+                                 robot.link("body")->bMcom().translation());
+  for (auto &&link : robot.links()) {
+    InsertPose(&values, link->id(), t, offset * link->bMcom());
+  }
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), t, 0.0);
+  }
+  return values;
+}
+
+/// The variables of step from in values, at step to.
+Values Retimed(const Robot &robot, const Values &values, size_t from,
+               size_t to) {
+  Values retimed;
+  for (auto &&link : robot.links()) {
+    InsertPose(&retimed, link->id(), to, Pose(values, link->id(), from));
+  }
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&retimed, joint->id(), to,
+                     JointAngle(values, joint->id(), from));
+  }
+  return retimed;
+}
+
+/**
+ * Receding-horizon controller: every cycle it takes the measured body pose,
+ * re-plans the next steps, and returns the joint angles to command now.
+ */
+class Controller {
+ public:
+  virtual ~Controller() {}
+
+  /// Joint angles to command at cycle k, given the measured body pose.
+  virtual Values command(size_t k, const Pose3 &measured_body) = 0;
+};
+
+/**
+ * Keeps the plan in iSAM2: every cycle adds the step entering the horizon,
+ * instantiated from the kinematics template, and marginalizes the step that
+ * left it, so only the end of the Bayes tree is re-eliminated.
+ */
+class IncrementalController : public Controller {
+ public:
+  IncrementalController(const Robot &robot, const TrotReference &reference,
+                        size_t horizon, double dt,
+                        const OptimizationParameters &params)
+      : robot_(robot),
+        reference_(reference),
+        horizon_(horizon),
+        dt_(dt),
+        optimizer_(params),
+        slice_(DynamicsGraph().qFactors(robot, 0), 0) {}
+
+  Values command(size_t k, const Pose3 &measured_body) override {
+    NonlinearFactorGraph graph;
+    Values values;
+    if (k == 0) {
+      for (size_t t = 0; t < horizon_; t++) {
+        addStep(t, &graph);
+        values.insert(NominalValues(robot_, reference_, t, t * dt_));
+      }
+    } else {
+      // Warm start the new step from the last step of the previous plan.
+      const size_t t = k + horizon_ - 1;
+      addStep(t, &graph);
+      values = Retimed(robot_, estimate_, t - 1, t);
+    }
+    graph.addPrior(PoseKey(robot_.link("body")->id(), k), measured_body,
+                   kMeasurementModel);
+    estimate_ = optimizer_.update(graph, values, k);
+    return Retimed(robot_, estimate_, k, k);
+  }
+
+ private:
+  void addStep(size_t t, NonlinearFactorGraph *graph) const {
+    graph->add(slice_.instantiate(t));
+    graph->add(GoalFactors(robot_, reference_, t, t * dt_));
+    if (t > 0) graph->add(SmoothnessFactors(robot_, t));
+  }
+
+  const Robot robot_;
+  const TrotReference reference_;
+  const size_t horizon_;
+  const double dt_;
+  IncrementalOptimizer optimizer_;
+  const GraphTemplate slice_;
+  Values estimate_;
+};
+
+/**
+ * Solves a fixed window of steps 0..horizon-1 in batch: the kinematic and
+ * smoothness factors are built once, only the goals change from cycle to
+ * cycle, so every solve has the same structure and reuses its elimination
+ * ordering. Warm starts from the previous solution, shifted by one step.
+ */
+class BatchController : public Controller {
+ public:
+  BatchController(const Robot &robot, const TrotReference &reference,
+                  size_t horizon, double dt,
+                  const OptimizationParameters &params)
+      : robot_(robot),
+        reference_(reference),
+        horizon_(horizon),
+        dt_(dt),
+        optimizer_(params) {
+    const GraphTemplate slice(DynamicsGraph().qFactors(robot, 0), 0);
+    for (size_t t = 0; t < horizon; t++) {
+      structure_.add(slice.instantiate(t));
+      if (t > 0) structure_.add(SmoothnessFactors(robot, t));
+      const Values step = NominalValues(robot, reference, t, t * dt);
+      step_keys_.push_back(step.keys());
+      solution_.insert(step);
+    }
+  }
+
+  Values command(size_t k, const Pose3 &measured_body) override {
+    if (k > 0) shift();
+    NonlinearFactorGraph graph;
+    graph.reserve(structure_.size() + horizon_ * (kFeet.size() + 1) + 1);
+    graph.add(structure_);
+    for (size_t t = 0; t < horizon_; t++) {
+      graph.add(GoalFactors(robot_, reference_, t, (k + t) * dt_));
+    }
+    graph.addPrior(PoseKey(robot_.link("body")->id(), 0), measured_body,
+                   kMeasurementModel);
+    solution_ = optimizer_.optimize(graph, solution_);
+    return Retimed(robot_, solution_, 0, k);
+  }
+
+ private:
+  // Move the solution one step towards the start of the window; the last
+  // step keeps its values.
+  void shift() {
+    for (size_t t = 0; t + 1 < horizon_; t++) {
+      const gtsam::KeyVector &to = step_keys_[t], &from = step_keys_[t + 1];
+      for (size_t v = 0; v < to.size(); v++) {
+        solution_.update(to[v], solution_.at(from[v]));
+      }
+    }
+  }
+
+  const Robot robot_;
+  const TrotReference reference_;
+  const size_t horizon_;
+  const double dt_;
+  const Optimizer optimizer_;
+  NonlinearFactorGraph structure_;
+  std::vector<gtsam::KeyVector> step_keys_;
+  Values solution_;
+};
+
+/// Durations in seconds, summarized by percentiles and a histogram.
+class TimingHistogram {
+ public:
+  explicit TimingHistogram(size_t capacity) { samples_.reserve(capacity); }
+
+  void add(double seconds) { samples_.push_back(seconds); }
+
+  const std::vector<double> &samples() const { return samples_; }
+
+  /// Print percentiles, and counts in bins of bin_width up to the last bin.
+  void print(const std::string &title, double bin_width,
+             size_t num_bins) const {
+    cout << title << " (ms), " << samples_.size() << " samples" << endl;
+    if (samples_.empty()) return;
+    std::vector<double> sorted = samples_;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+      return 1e3 * sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+    };
+    const double mean =
+        std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    cout << std::fixed << std::setprecision(3) << "  mean " << 1e3 * mean
+         << "  p50 " << percentile(0.5) << "  p90 " << percentile(0.9)
+         << "  p99 " << percentile(0.99) << "  max " << percentile(1.0)
+         << endl;
+
+    std::vector<size_t> counts(num_bins, 0);
+    for (double s : sorted) {
+      counts[std::min(static_cast<size_t>(s / bin_width), num_bins - 1)]++;
+    }
+    const size_t most = *std::max_element(counts.begin(), counts.end());
+    for (size_t b = 0; b < num_bins; b++) {
+      cout << "  " << std::setw(7) << 1e3 * b * bin_width
+           << (b + 1 < num_bins ? "  " : "+ ") << std::setw(6) << counts[b]
+           << " " << std::string(50 * counts[b] / most, '#') << endl;
+    }
+    cout.unsetf(std::ios::fixed);
+  }
+
+ private:
+  std::vector<double> samples_;
+};
+
+/// Ask for real-time scheduling of the calling thread; needs privileges.
+bool SetRealtimePriority() {
+#ifdef __linux__
+  sched_param param;
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+  return false;
+#endif
+}
+
+int main(int argc, char **argv) {
+  const std::string mode = argc > 1 ? argv[1] : "incremental";
+  const size_t num_cycles = argc > 2 ? std::stoul(argv[2]) : 250;
+  if (mode != "incremental" && mode != "batch") {
+    std::cerr << "usage: " << argv[0] << " [incremental|batch] [cycles]"
+              << endl;
+    return 1;
+  }
+
+  // Load the vision 60 quadruped by Ghost robotics:
+  // https://youtu.be/wrBNJKZKg10
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+
+  // Control at 50Hz over a horizon of 10 steps of one control period each.
+  const double period = 0.02;
+  const size_t horizon = 10;
+  const TrotReference reference(robot, 0.3, 0.5, 0.08);
+
+  // Every solve has most of the period; the rest is left for the loop.
+  OptimizationParameters params;
+  params.time_budget = 0.75 * period;
+  params.lm_parameters.setMaxIterations(10);
+  params.num_isam2_updates = 3;
+  params.solve_plans = std::make_shared<SolvePlanCache>();
+
+  std::unique_ptr<Controller> controller;
+  if (mode == "incremental") {
+    controller.reset(
+        new IncrementalController(robot, reference, horizon, period, params));
+  } else {
+    controller.reset(
+        new BatchController(robot, reference, horizon, period, params));
+  }
+
+  // The control loop runs in its own thread, on a fixed schedule: a cycle
+  // that overruns delays the next one, which shows up as jitter.
+  TimingHistogram jitter(num_cycles), latency(num_cycles);
+  std::vector<Values> commands;
+  commands.reserve(num_cycles);
+  size_t overruns = 0;
+  bool realtime = false;
+  std::thread loop([&]() {
+    realtime = SetRealtimePriority();
+    const auto step = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(period));
+    auto wakeup = Clock::now() + step;
+    for (size_t k = 0; k < num_cycles; k++, wakeup += step) {
+      std::this_thread::sleep_until(wakeup);
+      const auto start = Clock::now();
+      commands.push_back(
+          controller->command(k, reference.measuredBody(k * period)));
+      const auto end = Clock::now();
+      jitter.add(std::chrono::duration<double>(start - wakeup).count());
+      latency.add(std::chrono::duration<double>(end - start).count());
+      if (end > wakeup + step) overruns++;
+    }
+  });
+  loop.join();
+
+  cout << mode << " controller, " << num_cycles << " cycles at "
+       << 1 / period << "Hz, horizon " << horizon << ", "
+       << (realtime ? "real-time" : "default") << " scheduling" << endl;
+  latency.print("Solve latency", 0.1 * params.time_budget, 12);
+  jitter.print("Wake-up jitter", 1e-4, 10);
+  cout << "Overruns: " << overruns << endl;
+  if (mode == "batch") {
+    cout << "Solve plans: " << params.solve_plans->hits() << " hits, "
+         << params.solve_plans->misses() << " misses" << endl;
+  }
+
+  // Commanded joint angles, and timing of every cycle.
+  std::ofstream traj_file("mpc_traj.csv");
+  traj_file << "t";
+  for (auto &&joint : robot.joints()) traj_file << "," << joint->name();
+  traj_file << "\n";
+  for (size_t k = 0; k < commands.size(); k++) {
+    traj_file << k * period;
+    for (auto &&joint : robot.joints()) {
+      traj_file << "," << JointAngle(commands[k], joint->id(), k);
+    }
+    traj_file << "\n";
+  }
+
+  std::ofstream timing_file("mpc_timing.csv");
+  timing_file << "k,jitter,latency\n";
+  for (size_t k = 0; k < num_cycles; k++) {
+    timing_file << k << "," << jitter.samples()[k] << ","
+                << latency.samples()[k] << "\n";
+  }
+
+  return 0;
+}
@@ -85,6 +85,15 @@ class MinTorqueFactor : gtsam::NonlinearFactor {
              const gtsam::KeyFormatter &keyFormatter=gtdynamics::GTDKeyFormatter);
 };
 
+#include <gtdynamics/factors/MinTorqueBlockFactor.h>
+class MinTorqueBlockFactor : gtsam::NonlinearFactor {
+  MinTorqueBlockFactor(const gtsam::KeyVector &torque_keys,
+                       const gtsam::noiseModel::Base *cost_model);
+
+  void print(const string &s="",
+             const gtsam::KeyFormatter &keyFormatter=gtdynamics::GTDKeyFormatter);
+};
+
 /// TODO(yetong): remove the wrapper for WrenchFactor once EqualityConstraint is
 /// wrapped (Issue #319).
 #include <gtdynamics/factors/WrenchFactor.h>
@@ -184,7 +193,7 @@ class JointParams {
 virtual class Joint {
   enum Type { Revolute, Prismatic, Screw, Fixed };
 
-  uint8_t id() const;
+  uint16_t id() const;
   const gtsam::Pose3 &jMp() const;
   const gtsam::Pose3 &jMc() const;
   gtsam::Pose3 pMc() const;
@@ -257,6 +266,7 @@ class Robot {
   gtdynamics::Joint* joint(string name) const;
 
   gtdynamics::Robot fixLink(const string& name);
+  gtdynamics::Robot lumpFixedJoints() const;
 
   int numLinks() const;
 
@@ -274,6 +284,15 @@ class Robot {
       const gtsam::Values &known_values, size_t t,
       const boost::optional<string> &prior_link_name) const;
 
+  void forwardKinematics(const gtsam::Values &known_values, size_t t,
+                         gtsam::Values @result) const;
+
+  void forwardKinematicsInPlace(gtsam::Values @values, size_t t = 0) const;
+
+  gtsam::Pose3 relativePose(const gtsam::Values &joint_angles,
+                            const string &start_link_name,
+                            const string &end_link_name, size_t t = 0) const;
+
   // enabling serialization functionality
   void serialize() const;
 };
@@ -284,6 +303,14 @@ gtdynamics::Robot CreateRobotFromFile(const string &urdf_file_path,
                                       const string &model_name = "",
                                       bool preserve_fixed_joint = false);
 
+#include <gtdynamics/universal_robot/RobotCache.h>
+gtdynamics::Robot CreateRobotFromFileCached(const string &file_path,
+                                            const string &model_name = "",
+                                            bool preserve_fixed_joint = false,
+                                            const string &cache_path = "");
+// Pickling of Robot and Values in the binary formats of RobotToBytes and
+// ValuesToBytes is defined in specializations and the package __init__.
+
 /********************** utilities **********************/
 #include <gtdynamics/utils/PointOnLink.h>
 
@@ -307,6 +334,109 @@ class OptimizationParameters {
   OptimizationParameters();
 };
 
+// optimize is defined in specializations, releasing the GIL.
+class Optimizer {
+  Optimizer();
+  Optimizer(const gtdynamics::OptimizationParameters &parameters);
+};
+
+#include <gtdynamics/optimizer/ParameterSweep.h>
+class ParameterGrid {
+  ParameterGrid();
+  void add(const string &name, const std::vector<double> &values);
+  std::vector<string> names() const;
+  size_t size() const;
+  std::map<string, double> point(size_t index) const;
+};
+
+class SweepProblem {
+  SweepProblem();
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial_values;
+};
+
+class SweepResult {
+  size_t index;
+  std::map<string, double> point;
+  bool solved;
+  double initial_error;
+  double error;
+  double seconds;
+  std::vector<double> outputs;
+  string message;
+};
+
+// run and solve are defined in specializations, releasing the GIL.
+class ParameterSweep {
+  ParameterSweep(const gtdynamics::ParameterGrid &grid);
+  ParameterSweep(const gtdynamics::ParameterGrid &grid,
+                 const gtdynamics::OptimizationParameters &parameters);
+  ParameterSweep(const gtdynamics::ParameterGrid &grid,
+                 const gtdynamics::OptimizationParameters &parameters,
+                 const gtsam::KeyVector &output_keys);
+  ParameterSweep(const gtdynamics::ParameterGrid &grid,
+                 const gtdynamics::OptimizationParameters &parameters,
+                 const gtsam::KeyVector &output_keys, size_t num_threads);
+  const gtdynamics::ParameterGrid &grid() const;
+};
+
+#include <gtdynamics/optimizer/GaitSearch.h>
+class GaitCandidate {
+  GaitCandidate();
+  string name;
+  gtdynamics::FootContactVector states;
+  std::vector<size_t> phase_lengths;
+  gtdynamics::WalkCycle walkCycle() const;
+};
+
+class GaitResult {
+  size_t index;
+  string name;
+  bool solved;
+  bool pruned;
+  double initial_error;
+  double partial_error;
+  double error;
+  double seconds;
+  gtsam::Values values;
+  string message;
+};
+
+// run is defined in specializations, releasing the GIL.
+class GaitSearch {
+  GaitSearch();
+  GaitSearch(const gtdynamics::OptimizationParameters &parameters);
+  GaitSearch(const gtdynamics::OptimizationParameters &parameters,
+             size_t screening_iterations, double prune_ratio);
+  GaitSearch(const gtdynamics::OptimizationParameters &parameters,
+             size_t screening_iterations, double prune_ratio,
+             size_t max_survivors, size_t num_threads);
+};
+
+#include <gtdynamics/optimizer/MultiStartOptimizer.h>
+class MultiStartParameters {
+  MultiStartParameters();
+  size_t num_starts;
+  size_t num_threads;
+  double prune_ratio;
+  size_t min_iterations;
+};
+
+class MultiStartResult {
+  gtsam::Values values;
+  size_t best;
+  std::vector<double> errors;
+  std::vector<bool> pruned;
+};
+
+// optimize is defined in specializations, releasing the GIL.
+class MultiStartOptimizer {
+  MultiStartOptimizer();
+  MultiStartOptimizer(const gtdynamics::OptimizationParameters &parameters);
+  MultiStartOptimizer(const gtdynamics::OptimizationParameters &parameters,
+                      const gtdynamics::MultiStartParameters &multi_start);
+};
+
 /********************** kinematics **********************/
 #include <gtdynamics/kinematics/Kinematics.h>
 
@@ -331,12 +461,7 @@ class KinematicsParameters : gtdynamics::OptimizationParameters {
 class Kinematics {
   Kinematics(gtdynamics::KinematicsParameters parameters =
                  gtdynamics::KinematicsParameters());
-  gtsam::Values inverse(const gtdynamics::Slice &slice,
-                        const gtdynamics::Robot &robot,
-                        const gtdynamics::ContactGoals &contact_goals);
-  gtsam::Values inverse(const gtdynamics::Interval interval,
-                        const gtdynamics::Robot &robot,
-                        const gtdynamics::ContactGoals &contact_goals);
+  // inverse is defined in specializations, releasing the GIL.
   gtsam::Values
   interpolate(const gtdynamics::Interval &interval,
               const gtdynamics::Robot &robot,
@@ -449,14 +574,7 @@ class DynamicsGraph {
       const gtdynamics::Robot &robot, const int num_steps,
       const gtsam::Values &known_values) const;
 
-  gtsam::NonlinearFactorGraph trajectoryFG(
-      const gtdynamics::Robot &robot, const int num_steps, const double dt) const;
-
-  gtsam::NonlinearFactorGraph trajectoryFG(
-      const gtdynamics::Robot &robot, const int num_steps, const double dt,
-      const gtdynamics::CollocationScheme collocation,
-      const boost::optional<gtdynamics::PointOnLinks> &contact_points,
-      const boost::optional<double> &mu) const;
+  // trajectoryFG is defined in specializations, releasing the GIL.
 
   gtsam::NonlinearFactorGraph multiPhaseTrajectoryFG(
       const gtdynamics::Robot &robot,
@@ -482,6 +600,18 @@ class DynamicsGraph {
       gtsam::noiseModel::Base* cost_model,
       const gtdynamics::CollocationScheme collocation);
 
+  static void addHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph @graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key, const double dt,
+      gtsam::noiseModel::Base* cost_model);
+
+  static void addMultiPhaseHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph @graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key,
+      const gtsam::Key phase_key, gtsam::noiseModel::Base* cost_model);
+
   gtsam::NonlinearFactorGraph jointCollocationFactors(
       const int j, const int t, const double dt,
       const gtdynamics::CollocationScheme collocation) const;
@@ -564,10 +694,62 @@ class DynamicsGraph {
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  static void saveGraphSummary(const string &file_path,
+                               const gtsam::NonlinearFactorGraph &graph,
+                               const gtsam::Values &values);
+  static void saveGraphSummary(const string &file_path,
+                               const gtsam::NonlinearFactorGraph &graph,
+                               const gtsam::Values &values,
+                               size_t steps_per_chunk);
+
   /* return the optimizer setting. */
   const gtdynamics::OptimizerSetting &opt() const;
 };
 
+#include <gtdynamics/dynamics/ChainDynamicsGraph.h>
+class ChainDynamicsGraph : gtdynamics::DynamicsGraph {
+  ChainDynamicsGraph(const gtdynamics::Robot &robot,
+                     const gtdynamics::OptimizerSetting &opt);
+  ChainDynamicsGraph(const gtdynamics::Robot &robot,
+                     const gtdynamics::OptimizerSetting &opt,
+                     const boost::optional<gtsam::Vector3> &gravity);
+  gtdynamics::Link* base() const;
+};
+
+#include <gtdynamics/dynamics/PlanarDynamicsGraph.h>
+class PlanarDynamicsGraph : gtdynamics::DynamicsGraph {
+  PlanarDynamicsGraph(const gtdynamics::Robot &robot,
+                      const gtsam::Vector3 &planar_axis);
+  PlanarDynamicsGraph(const gtdynamics::Robot &robot,
+                      const gtsam::Vector3 &planar_axis,
+                      const gtdynamics::OptimizerSetting &opt);
+  PlanarDynamicsGraph(const gtdynamics::Robot &robot,
+                      const gtsam::Vector3 &planar_axis,
+                      const gtdynamics::OptimizerSetting &opt,
+                      const boost::optional<gtsam::Vector3> &gravity);
+};
+
+#include <gtdynamics/dynamics/CentroidalDynamicsGraph.h>
+class CentroidalDynamicsGraph : gtdynamics::DynamicsGraph {
+  CentroidalDynamicsGraph(const gtdynamics::Robot &robot,
+                          const gtdynamics::OptimizerSetting &opt);
+  CentroidalDynamicsGraph(const gtdynamics::Robot &robot,
+                          const gtdynamics::OptimizerSetting &opt,
+                          const boost::optional<gtsam::Vector3> &gravity);
+  CentroidalDynamicsGraph(const gtdynamics::Robot &robot,
+                          const gtdynamics::OptimizerSetting &opt,
+                          const boost::optional<gtsam::Vector3> &gravity,
+                          double reach);
+  gtdynamics::Link* base() const;
+  double mass() const;
+  gtsam::Matrix inertia() const;
+  gtsam::Pose3 restPose() const;
+  gtsam::Pose3 basePose(const gtsam::Pose3 &wTbody) const;
+  gtsam::Values initialValues(const int t) const;
+  gtsam::Values initialValues(const int t,
+                              const gtdynamics::PointOnLinks &contact_points) const;
+};
+
 /********************** Objective Factors **********************/
 #include <gtdynamics/factors/ObjectiveFactors.h>
 class LinkObjectives : gtsam::NonlinearFactorGraph {
@@ -600,9 +782,28 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
     const gtsam::SharedNoiseModel &joint_velocity_model,
     const gtsam::SharedNoiseModel &joint_acceleration_model, int k = 0);
 
+// Bulk builders, to create all factors of a horizon in one call.
+gtsam::KeyVector JointKeys(const string &label, const std::vector<int> &joints,
+                           size_t num_steps, size_t k = 0);
+gtsam::KeyVector LinkKeys(const string &label, const std::vector<int> &links,
+                          size_t num_steps, size_t k = 0);
+gtsam::NonlinearFactorGraph DoublePriorFactors(
+    const gtsam::KeyVector &keys, const gtsam::Vector &means,
+    const gtsam::SharedNoiseModel &model);
+gtsam::NonlinearFactorGraph PosePriorFactors(
+    const gtsam::KeyVector &keys, const std::vector<gtsam::Pose3> &means,
+    const gtsam::SharedNoiseModel &model);
+gtsam::NonlinearFactorGraph JointPriorObjectives(
+    const gtdynamics::Robot &robot, const string &label,
+    const gtsam::Matrix &means, const gtsam::SharedNoiseModel &model,
+    size_t k = 0);
+gtsam::NonlinearFactorGraph MinTorqueObjectives(
+    const gtdynamics::Robot &robot, size_t num_steps,
+    const gtsam::SharedNoiseModel &cost_model, size_t k = 0);
+
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const gtsam::SharedNoiseModel &cost_model, const gtsam::Point3 &point_com,
-    const std::vector<gtsam::Point3> &goal_trajectory, uint8_t i,
+    const std::vector<gtsam::Point3> &goal_trajectory, uint16_t i,
     size_t k = 0);
 
 std::vector<gtsam::Point3> StanceTrajectory(const gtsam::Point3 &stance_point,
@@ -616,6 +817,8 @@ std::vector<gtsam::Point3> SimpleSwingTrajectory(const gtsam::Point3 &start,
 #include <gtdynamics/utils/Initializer.h>
 class Initializer {
   Initializer();
+  Initializer(size_t num_threads);
+  size_t numThreads() const;
 
   gtsam::Values ZeroValues(
       const gtdynamics::Robot& robot, const int t, double gaussian_noise);
@@ -635,18 +838,20 @@ class DynamicsSymbol {
   DynamicsSymbol(const gtdynamics::DynamicsSymbol& key);
 
   static DynamicsSymbol LinkJointSymbol(const string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx,
+                                        uint16_t link_idx,
+                                        uint16_t joint_idx,
                                         std::uint64_t t);
   static DynamicsSymbol JointSymbol(const string& s,
-                                    uint8_t joint_idx, std::uint64_t t);
-  static DynamicsSymbol LinkSymbol(const string& s, uint8_t link_idx,
+                                    uint16_t joint_idx, std::uint64_t t);
+  static DynamicsSymbol LinkSymbol(const string& s, uint16_t link_idx,
                                    std::uint64_t t);
   static DynamicsSymbol SimpleSymbol(const string& s, std::uint64_t t);
 
   string label() const;
-  uint8_t linkIdx() const;
-  uint8_t jointIdx() const;
+  uint16_t linkIdx() const;
+  uint16_t jointIdx() const;
+  uint8_t robotIdx() const;
+  gtdynamics::DynamicsSymbol ofRobot(uint8_t robot) const;
   size_t time() const;
   gtsam::Key key() const;
 
@@ -729,6 +934,33 @@ gtsam::Vector Wrench(const gtsam::VectorValues &values, int i, int j, int t=0);
 
 gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t=0);
 
+void WriteValuesTable(const gtsam::Values &values, const string &file_path,
+                      int precision = 17);
+
+/********************** TrajectoryBuffer **********************/
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+
+// The arrays and quantity flags are defined in specializations, so that the
+// arrays are NumPy views sharing memory with the buffer.
+class TrajectoryBuffer {
+  TrajectoryBuffer(const gtdynamics::Robot &robot, size_t num_steps);
+  static gtdynamics::TrajectoryBuffer FromValues(
+      const gtdynamics::Robot &robot, const gtsam::Values &values);
+  static gtdynamics::TrajectoryBuffer FromValues(
+      const gtdynamics::Robot &robot, const gtsam::Values &values,
+      size_t num_steps);
+  void insert(gtsam::Values @values) const;
+  void insert(gtsam::Values @values, size_t quantities) const;
+  gtsam::Values values() const;
+  gtsam::Values values(size_t quantities) const;
+  size_t numSteps() const;
+  size_t numLinks() const;
+  void resize(size_t num_steps);
+  size_t quantities() const;
+  int jointIndex(size_t joint_id) const;
+  int linkIndex(size_t link_id) const;
+};
+
 /********************** Simulator **********************/
 #include <gtdynamics/dynamics/Simulator.h>
 
@@ -744,11 +976,111 @@ class Simulator {
   void forwardDynamics(const gtsam::Values &torques);
   void integration(const double dt);
   void step(const gtsam::Values &torques, const double dt);
-  gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
-                         const double dt);
+  // simulate is defined in specializations, releasing the GIL.
   const gtsam::Values &getValues() const;
+  void setJointEfforts();
+  void setJointEfforts(bool passive, bool limits);
+
+  void startRecording();
+  void startRecording(size_t num_steps, bool record_links);
+  void stopRecording();
+  size_t numRecordedSteps() const;
+  gtdynamics::TrajectoryBuffer recording() const;
+  gtsam::Values recordedValues() const;
+};
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+class ContactSimulatorParameters {
+  ContactSimulatorParameters();
+  double mu;
+  double stiffness;
+  double damping;
+  double slip_velocity;
+  double ground_plane_height;
+};
+
+class ContactSimulator {
+  ContactSimulator(const gtdynamics::Robot &robot,
+                   const gtdynamics::PointOnLinks &contact_points,
+                   const gtsam::Vector3 &gravity);
+  ContactSimulator(const gtdynamics::Robot &robot,
+                   const gtdynamics::PointOnLinks &contact_points,
+                   const gtsam::Vector3 &gravity,
+                   const gtdynamics::ContactSimulatorParameters &parameters);
+
+  void setState(const gtsam::Pose3 &base_pose,
+                const gtsam::Vector6 &base_twist,
+                const gtsam::Vector &joint_angles,
+                const gtsam::Vector &joint_vels);
+  void step(const gtsam::Vector &torques, double dt);
+  int t() const;
+  gtsam::Pose3 basePose() const;
+  gtsam::Vector6 baseTwist() const;
+  gtsam::Vector jointAngles() const;
+  gtsam::Vector jointVels() const;
+  gtsam::Values values(int t = 0) const;
+};
+
+#include <gtdynamics/dynamics/VectorEnv.h>
+class VectorEnvParameters {
+  VectorEnvParameters();
+  double dt;
+  size_t substeps;
+  size_t max_episode_steps;
+  double min_base_height;
+  bool auto_reset;
+  gtdynamics::ContactSimulatorParameters contact;
+};
+
+// step, reset and the action, observation and episode arrays are defined in
+// specializations, as NumPy views and releasing the GIL.
+class VectorEnv {
+  VectorEnv(const gtdynamics::Robot &robot,
+            const gtdynamics::PointOnLinks &contact_points, size_t num_envs,
+            const gtsam::Vector3 &gravity);
+  VectorEnv(const gtdynamics::Robot &robot,
+            const gtdynamics::PointOnLinks &contact_points, size_t num_envs,
+            const gtsam::Vector3 &gravity,
+            const gtdynamics::VectorEnvParameters &parameters);
+  VectorEnv(const gtdynamics::Robot &robot,
+            const gtdynamics::PointOnLinks &contact_points, size_t num_envs,
+            const gtsam::Vector3 &gravity,
+            const gtdynamics::VectorEnvParameters &parameters,
+            size_t num_threads);
+
+  size_t numEnvs() const;
+  size_t actionDim() const;
+  size_t observationDim() const;
+  void setInitialState(size_t n, const gtsam::Pose3 &base_pose,
+                       const gtsam::Vector6 &base_twist,
+                       const gtsam::Vector &joint_angles,
+                       const gtsam::Vector &joint_vels);
+  size_t episodeSteps(size_t n) const;
 };
 
+#include <gtdynamics/dynamics/TrajectoryReplay.h>
+class ReplayParameters {
+  ReplayParameters();
+  double kp;
+  double kd;
+  bool feedforward;
+  size_t substeps;
+  bool start_from_plan;
+};
+
+class TrackingMetrics {
+  gtsam::Matrix joint_angle_errors;
+  gtsam::Matrix joint_vel_errors;
+  gtsam::Matrix base_position_errors;
+  gtsam::Matrix torques;
+  gtsam::Vector rms_joint_angle_errors;
+  double max_joint_angle_error;
+  double rms_base_position_error;
+};
+
+// ReplayTrajectory and ReplayTrajectories are defined in specializations,
+// releasing the GIL.
+
 /********************** Trajectory et al  **********************/
 #include <gtdynamics/utils/Slice.h>
 class Slice {
@@ -816,6 +1148,11 @@ class Trajectory {
                         const gtdynamics::DynamicsGraph &graph_builder,
                         const gtdynamics::CollocationScheme collocation,
                         double mu) const;
+  gtsam::NonlinearFactorGraph
+  multiPhaseFactorGraph(const gtdynamics::Robot& robot,
+                        const gtdynamics::DynamicsGraph &graph_builder,
+                        const gtdynamics::CollocationScheme collocation,
+                        double mu, bool reuse_cycles) const;
   std::vector<gtsam::Values>
   transitionPhaseInitialValues(const gtdynamics::Robot& robot, const gtdynamics::Initializer &initializer,
                                double gaussian_noise) const;
@@ -825,6 +1162,7 @@ class Trajectory {
   const Phase &phase(size_t p) const;
   size_t getStartTimeStep(size_t p) const;
   size_t getEndTimeStep(size_t p) const;
+  size_t phaseIndex(int k) const;
   gtsam::NonlinearFactor pointGoalFactor(const gtdynamics::Robot &robot,
                                   const string &link_name,
                                   const gtdynamics::PointOnLink &cp, size_t k,
@@ -838,6 +1176,9 @@ class Trajectory {
   void addMinimumTorqueFactors(gtsam::NonlinearFactorGraph @graph,
                                const gtdynamics::Robot& robot, 
                                const gtsam::SharedNoiseModel &cost_model) const;
+  void addMinimumTorqueBlockFactors(
+      gtsam::NonlinearFactorGraph @graph, const gtdynamics::Robot& robot,
+      const gtsam::SharedNoiseModel &cost_model) const;
   void addBoundaryConditions(
       gtsam::NonlinearFactorGraph @graph,
       const gtdynamics::Robot& robot, 
@@ -851,7 +1192,40 @@ class Trajectory {
   void writeToFile(const gtdynamics::Robot &robot, const string &name, const gtsam::Values &results) const;
 };
 
+#include <gtdynamics/utils/WarmStartLibrary.h>
+class WarmStartTask {
+  WarmStartTask();
+  WarmStartTask(const gtdynamics::Robot &robot,
+                const gtdynamics::Trajectory &trajectory,
+                const gtdynamics::ContactPointGoals &goals);
+  string structure;
+  std::vector<size_t> phase_steps;
+  gtdynamics::ContactPointGoals goals;
+  size_t numTimeSteps() const;
+  double distance(const gtdynamics::WarmStartTask &other) const;
+};
+
+class WarmStartLibrary {
+  WarmStartLibrary();
+  void add(const gtdynamics::WarmStartTask &task,
+           const gtsam::Values &solution);
+  size_t size() const;
+  bool hasMatch(const gtdynamics::WarmStartTask &task) const;
+  gtsam::Values initialValues(const gtdynamics::WarmStartTask &task,
+                              const gtsam::Values &fallback) const;
+  static gtsam::Values TimeWarp(const gtsam::Values &solution,
+                                const std::vector<size_t> &from_steps,
+                                const std::vector<size_t> &to_steps,
+                                const gtsam::Values &fallback);
+};
+
+/********************** Thread pool  **********************/
+#include <gtdynamics/utils/ThreadPool.h>
+// SolverPool, a ThreadPool running solves from Python, and the futures it
+// returns are defined in specializations.
+
 /********************** Utilities  **********************/
+#include <gtdynamics/utils/values.h>
 #include <gtdynamics/utils/format.h>
 string GtdFormat(const gtsam::Values &t, const string &s = "");
 string GtdFormat(const gtsam::NonlinearFactorGraph &t, const string &s = "");
@@ -39,4 +39,120 @@ class PriorFactor : gtsam::NonlinearFactor {
              const gtsam::KeyFormatter &keyFormatter);
 };
 
+/****************************************** Control ******************************************/
+
+#include <gtdynamics/cablerobot/utils/CdprSpatial.h>
+class CdprParameters {
+  CdprParameters();
+  static gtdynamics::CdprParameters Spatial8();
+  std::vector<gtsam::Point3> a_locs;
+  std::vector<gtsam::Point3> b_locs;
+  double mass;
+  gtsam::Matrix3 inertia;
+  gtsam::Vector3 gravity;
+};
+
+class CdprSpatial {
+  CdprSpatial();
+  CdprSpatial(const gtdynamics::CdprParameters &params);
+  const gtdynamics::CdprParameters &params() const;
+  size_t numCables() const;
+  int eeId() const;
+  gtsam::NonlinearFactorGraph kinematicsFactors(const std::vector<int> &ks) const;
+  gtsam::NonlinearFactorGraph dynamicsFactors(const std::vector<int> &ks) const;
+  gtsam::NonlinearFactorGraph collocationFactors(const std::vector<int> &ks,
+                                                 double dt) const;
+  gtsam::NonlinearFactorGraph allFactors(int N, double dt) const;
+  gtsam::NonlinearFactorGraph priorsIk(int k, const gtsam::Pose3 &pose,
+                                       const gtsam::Vector6 &twist) const;
+  gtsam::NonlinearFactorGraph priorsId(int k,
+                                       const std::vector<double> &tensions) const;
+  gtsam::Matrix wrenchMatrix(const gtsam::Pose3 &wTx) const;
+  gtsam::Vector6 requiredWrench(const gtsam::Pose3 &wTx,
+                                const gtsam::Vector6 &twist,
+                                const gtsam::Vector6 &twist_accel) const;
+};
+
+#include <gtdynamics/cablerobot/utils/CdprPlanar.h>
+class CdprPlanar : gtdynamics::CdprSpatial {
+  CdprPlanar();
+  CdprPlanar(const gtdynamics::CdprParameters &params);
+};
+
+#include <gtdynamics/cablerobot/controllers/CableTensionDistribution.h>
+class CableTensionDistributionResult {
+  gtsam::Vector tensions;
+  size_t iterations;
+  double residual;
+  bool feasible;
+};
+
+class CableTensionDistribution {
+  CableTensionDistribution(size_t num_cables, double min_tension,
+                           double max_tension);
+  CableTensionDistribution(size_t num_cables, double min_tension,
+                           double max_tension, size_t max_iterations,
+                           double tolerance);
+  gtdynamics::CableTensionDistributionResult solve(
+      const gtsam::Matrix &W, const gtsam::Vector6 &wrench);
+  gtdynamics::CableTensionDistributionResult solve(
+      const gtdynamics::CdprSpatial &cdpr, const gtsam::Pose3 &wTx,
+      const gtsam::Vector6 &wrench);
+  std::vector<int> activeSet() const;
+  void reset();
+};
+
+#include <gtdynamics/cablerobot/controllers/CdprPlanarController.h>
+class CdprPlanarController {
+  CdprPlanarController(const gtdynamics::CdprPlanar &cdpr,
+                       const std::vector<gtsam::Pose3> &pdes, double dt,
+                       size_t horizon);
+  CdprPlanarController(const gtdynamics::CdprPlanar &cdpr,
+                       const std::vector<gtsam::Pose3> &pdes, double dt,
+                       size_t horizon,
+                       const gtsam::noiseModel::Base *state_cost,
+                       const gtsam::noiseModel::Base *control_cost,
+                       const gtsam::LevenbergMarquardtParams &lm_params);
+  gtsam::Values update(const gtsam::Values &values, int t);
+  const gtsam::Values &solution() const;
+  const gtsam::NonlinearFactorGraph &graph() const;
+  size_t horizon() const;
+};
+
+/****************************************** Simulation ******************************************/
+
+#include <gtdynamics/cablerobot/simulator/CdprBatchSimulator.h>
+class CdprTrajectory {
+  std::vector<gtsam::Pose3> poses;
+  gtsam::Matrix twists;
+  gtsam::Matrix twist_accels;
+  gtsam::Matrix lengths;
+  gtsam::Matrix ldots;
+  gtsam::Matrix tensions;
+};
+
+class CdprBatchSimulator {
+  CdprBatchSimulator(const gtdynamics::CdprPlanar &cdpr, size_t num_envs);
+  CdprBatchSimulator(const gtdynamics::CdprPlanar &cdpr, size_t num_envs,
+                     size_t num_threads);
+  size_t numEnvs() const;
+  size_t numCables() const;
+  int t() const;
+  void setInitialState(const std::vector<gtsam::Pose3> &poses,
+                       const gtsam::Matrix &twists);
+  void reset();
+  void kinematics();
+  void dynamics(const gtsam::Matrix &tensions);
+  void integration(double dt);
+  void step(const gtsam::Matrix &tensions, double dt);
+  std::vector<gtdynamics::CdprTrajectory> simulate(
+      const std::vector<gtsam::Matrix> &tensions_seq, double dt);
+  const std::vector<gtsam::Pose3> &poses() const;
+  const gtsam::Matrix &twists() const;
+  const gtsam::Matrix &twistAccels() const;
+  const gtsam::Matrix &lengths() const;
+  const gtsam::Matrix &ldots() const;
+  gtsam::Matrix positions() const;
+};
+
 }  // namespace gtdynamics
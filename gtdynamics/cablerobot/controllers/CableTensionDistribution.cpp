@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableTensionDistribution.cpp
+ * @brief Bounded tension distribution of redundant cable robots at the
+ * control rate.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/controllers/CableTensionDistribution.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+CableTensionDistribution::CableTensionDistribution(size_t num_cables,
+                                                   double min_tension,
+                                                   double max_tension,
+                                                   size_t max_iterations,
+                                                   double tolerance)
+    : min_tension_(min_tension),
+      max_tension_(max_tension),
+      reference_(0.5 * (min_tension + max_tension)),
+      max_iterations_(max_iterations),
+      tolerance_(tolerance),
+      active_(num_cables, 0) {
+  if (min_tension > max_tension) {
+    throw std::invalid_argument(
+        "CableTensionDistribution: min_tension exceeds max_tension");
+  }
+}
+
+/* ************************************************************************* */
+CableTensionDistribution::Result CableTensionDistribution::solve(
+    const Matrix &W, const Vector6 &wrench) {
+  const size_t m = active_.size();
+  if (W.rows() != 6 || size_t(W.cols()) != m) {
+    throw std::invalid_argument(
+        "CableTensionDistribution: wrench matrix must be 6 x numCables");
+  }
+
+  Result result;
+  Vector &t = result.tensions;
+  t.resize(m);
+  gtsam::Matrix6 S;
+  Vector6 lambda;
+  for (result.iterations = 1;; result.iterations++) {
+    // With the active cables at their bounds, the free ones are
+    // t_ref + W_F^T lambda, with (W_F W_F^T) lambda = w - W t_ref. The small
+    // regularization keeps the solve defined with fewer than 6 free cables.
+    S = 1e-12 * gtsam::I_6x6;
+    for (size_t j = 0; j < m; j++) {
+      if (active_[j] == 0) {
+        t(j) = reference_;
+        S += W.col(j) * W.col(j).transpose();
+      } else {
+        t(j) = active_[j] < 0 ? min_tension_ : max_tension_;
+      }
+    }
+    lambda = S.ldlt().solve(wrench - W * t);
+    const Vector Wt_lambda = W.transpose() * lambda;
+    for (size_t j = 0; j < m; j++) {
+      if (active_[j] == 0) t(j) += Wt_lambda(j);
+    }
+    if (result.iterations >= max_iterations_) break;
+
+    // Fix the free cable most beyond its bounds, if any.
+    size_t worst = m;
+    double violation = tolerance_;
+    for (size_t j = 0; j < m; j++) {
+      if (active_[j] != 0) continue;
+      const double v = std::max(t(j) - max_tension_, min_tension_ - t(j));
+      if (v > violation) {
+        violation = v;
+        worst = j;
+      }
+    }
+    if (worst < m) {
+      active_[worst] = t(worst) > max_tension_ ? 1 : -1;
+      continue;
+    }
+
+    // Otherwise free the active cable with the most negative multiplier.
+    double multiplier = -tolerance_;
+    for (size_t j = 0; j < m; j++) {
+      if (active_[j] == 0) continue;
+      const double gradient = t(j) - reference_ - Wt_lambda(j);
+      const double mu = active_[j] < 0 ? gradient : -gradient;
+      if (mu < multiplier) {
+        multiplier = mu;
+        worst = j;
+      }
+    }
+    if (worst == m) break;
+    active_[worst] = 0;
+  }
+
+  // Without a solution, e.g. for a wrench beyond the bounds, the last
+  // iterate may be anywhere: keep it within the bounds anyway.
+  t = t.cwiseMax(min_tension_).cwiseMin(max_tension_);
+  result.residual = (W * t - wrench).norm();
+  result.feasible = result.residual <= tolerance_ * (1 + wrench.norm());
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableTensionDistribution.h
+ * @brief Bounded tension distribution of redundant cable robots at the
+ * control rate.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/utils/CdprSpatial.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Solution of a tension distribution.
+struct CableTensionDistributionResult {
+  gtsam::Vector tensions;
+  size_t iterations = 0;  // number of linear solves
+  double residual = 0;    // norm of W t - w
+  bool feasible = false;  // whether the wrench is applied within tolerance
+};
+
+/**
+ * CableTensionDistribution finds the cable tensions t of a cable robot that
+ * apply a required wrench w, solving the small QP
+ *
+ *   min 1/2 |t - t_ref|^2  s.t.  W t = w,  t_min <= t <= t_max,
+ *
+ * with W the wrench matrix of CdprSpatial::wrenchMatrix and t_ref halfway
+ * between the bounds. It is solved by an active-set method on the tension
+ * bounds, starting from the active set of the previous solve, which at the
+ * control rate rarely changes, so a tick usually takes one or two linear
+ * solves of size 6. This replaces a nonlinear optimization per tick.
+ */
+class CableTensionDistribution {
+ public:
+  typedef CableTensionDistributionResult Result;
+
+  /**
+   * Constructor.
+   * @param num_cables     number of cables
+   * @param min_tension    lower bound of all tensions, positive to keep the
+   * cables taut
+   * @param max_tension    upper bound of all tensions
+   * @param max_iterations maximum number of active-set changes plus one
+   * @param tolerance      tolerance on bounds, multipliers and residual
+   */
+  CableTensionDistribution(size_t num_cables, double min_tension,
+                           double max_tension, size_t max_iterations = 50,
+                           double tolerance = 1e-9);
+
+  /**
+   * Distribute the tensions for a wrench matrix and required wrench. The
+   * tensions are always within the bounds, and the active set is kept for
+   * the next call.
+   */
+  Result solve(const gtsam::Matrix &W, const gtsam::Vector6 &wrench);
+
+  /// Distribute the tensions of a cable robot at an end-effector pose.
+  Result solve(const CdprSpatial &cdpr, const gtsam::Pose3 &wTx,
+               const gtsam::Vector6 &wrench) {
+    return solve(cdpr.wrenchMatrix(wTx), wrench);
+  }
+
+  /// Active set: -1 for cables at the lower bound, 1 at the upper, else 0.
+  const std::vector<int> &activeSet() const { return active_; }
+
+  /// Forget the active set, e.g. after a jump in the required wrench.
+  void reset() { active_.assign(active_.size(), 0); }
+
+ private:
+  double min_tension_, max_tension_, reference_;
+  size_t max_iterations_;
+  double tolerance_;
+  std::vector<int> active_;
+};
+
+}  // namespace gtdynamics
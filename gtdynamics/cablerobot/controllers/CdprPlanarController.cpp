@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanarController.cpp
+ * @brief Receding-horizon optimal controller for a planar cable robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/controllers/CdprPlanarController.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+/* ************************************************************************* */
+CdprPlanarController::CdprPlanarController(
+    const CdprPlanar &cdpr, const std::vector<Pose3> &pdes, double dt,
+    size_t horizon, const gtsam::SharedNoiseModel &state_cost,
+    const gtsam::SharedNoiseModel &control_cost,
+    const gtsam::LevenbergMarquardtParams &lm_params)
+    : cdpr_(cdpr),
+      pdes_(pdes),
+      dt_(dt),
+      horizon_(horizon),
+      state_cost_(state_cost ? state_cost : Isotropic::Sigma(6, 0.001)),
+      lm_params_(lm_params) {
+  if (pdes_.empty() || horizon_ < 2) {
+    throw std::invalid_argument(
+        "CdprPlanarController: need desired poses and a horizon of 2 steps");
+  }
+
+  // Dynamics, and control costs pulling the tensions to zero.
+  const auto tension_cost =
+      control_cost ? control_cost
+                   : gtsam::noiseModel::Diagonal::Precisions(gtsam::Vector1(1));
+  graph_ = cdpr_.allFactors(horizon_, dt);
+  for (size_t k = 0; k < horizon_; k++) {
+    for (size_t j = 0; j < cdpr_.numCables(); j++) {
+      graph_.addPrior<double>(TorqueKey(j, k), 0.0, tension_cost);
+    }
+  }
+
+  // Placeholders for the priors of every tick.
+  first_prior_ = graph_.size();
+  setPriors(pdes_.front(), Vector6::Zero(), 0);
+
+  const int i = cdpr_.eeId();
+  for (size_t k = 0; k < horizon_; k++) {
+    gtsam::KeyVector keys{PoseKey(i, k), TwistKey(i, k),
+                          TwistAccelKey(i, k)};
+    for (size_t j = 0; j < cdpr_.numCables(); j++) {
+      keys.push_back(JointAngleKey(j, k));
+      keys.push_back(JointVelKey(j, k));
+      keys.push_back(TorqueKey(j, k));
+      keys.push_back(WrenchKey(i, j, k));
+    }
+    step_keys_.push_back(keys);
+  }
+}
+
+/* ************************************************************************* */
+void CdprPlanarController::setPriors(const Pose3 &pose, const Vector6 &twist,
+                                     int t) {
+  const int i = cdpr_.eeId();
+  gtsam::NonlinearFactorGraph priors = cdpr_.priorsIk(0, pose, twist);
+  for (size_t k = 0; k < horizon_; k++) {
+    const size_t tick = std::min<size_t>(t + k, pdes_.size() - 1);
+    priors.addPrior(PoseKey(i, k), pdes_[tick], state_cost_);
+  }
+  for (size_t f = 0; f < priors.size(); f++) {
+    if (first_prior_ + f < graph_.size()) {
+      graph_.replace(first_prior_ + f, priors.at(f));
+    } else {
+      graph_.push_back(priors.at(f));
+    }
+  }
+}
+
+/* ************************************************************************* */
+void CdprPlanarController::initialize(const Pose3 &pose,
+                                      const Vector6 &twist) {
+  const int i = cdpr_.eeId();
+  solution_.clear();
+  solution_.insert(CdprPlanar::kDtKey, dt_);
+  for (size_t k = 0; k < horizon_; k++) {
+    InsertPose(&solution_, i, k, pose);
+    InsertTwist(&solution_, i, k, twist);
+    InsertTwistAccel(&solution_, i, k, Vector6::Zero());
+    for (size_t j = 0; j < cdpr_.numCables(); j++) {
+      InsertJointAngle(&solution_, j, k, 0.0);
+      InsertJointVel(&solution_, j, k, 0.0);
+      InsertTorque(&solution_, j, k, 0.0);
+      InsertWrench(&solution_, i, j, k, Vector6::Zero());
+    }
+  }
+}
+
+/* ************************************************************************* */
+void CdprPlanarController::shift(size_t steps) {
+  steps = std::min(steps, horizon_ - 1);
+  for (size_t k = 0; k + steps < horizon_; k++) {
+    const gtsam::KeyVector &to = step_keys_[k], &from = step_keys_[k + steps];
+    for (size_t v = 0; v < to.size(); v++) {
+      solution_.update(to[v], solution_.at(from[v]));
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values CdprPlanarController::update(const Values &values, int t) {
+  if (t < t_) {
+    throw std::invalid_argument("CdprPlanarController: tick " +
+                                std::to_string(t) + " is in the past");
+  }
+  const int i = cdpr_.eeId();
+  const Pose3 pose = Pose(values, i, t);
+  const Vector6 twist = Twist(values, i, t);
+  setPriors(pose, twist, t);
+
+  // Warm start from the previous solve, at the measured state.
+  if (t_ < 0) {
+    initialize(pose, twist);
+  } else {
+    shift(t - t_);
+    solution_.update(PoseKey(i, 0), pose);
+    solution_.update<Vector6>(TwistKey(i, 0), twist);
+  }
+  t_ = t;
+
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph_, solution_, lm_params_);
+  solution_ = optimizer.optimize();
+
+  Values tensions;
+  for (size_t j = 0; j < cdpr_.numCables(); j++) {
+    InsertTorque(&tensions, j, t, Torque(solution_, j, 0));
+  }
+  return tensions;
+}
+
+}  // namespace gtdynamics
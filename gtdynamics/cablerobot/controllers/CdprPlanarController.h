@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanarController.h
+ * @brief Receding-horizon optimal controller for a planar cable robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/utils/CdprPlanar.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CdprPlanarController tracks a desired end-effector trajectory with the
+ * iLQR problem of CdprController.create_ilqr_fg in cdpr_planar_controller.py,
+ * re-solved over a receding horizon at every control tick instead of once
+ * for the whole trajectory.
+ *
+ * The horizon graph is built once, on steps 0 to horizon - 1. Every tick only
+ * replaces its priors on the measured state and on the desired poses of the
+ * window, and warm-starts from the previous solution shifted by the elapsed
+ * ticks, so a solve takes a few Levenberg-Marquardt iterations.
+ */
+class CdprPlanarController {
+ public:
+  /**
+   * Constructor.
+   * @param cdpr         the cable robot
+   * @param pdes         desired end-effector pose at every tick; the last one
+   * is held once the trajectory ends
+   * @param dt           duration of a tick
+   * @param horizon      number of steps of the horizon, at least 2
+   * @param state_cost   6-dimensional cost of pose errors, isotropic with
+   * sigma 0.001 if null
+   * @param control_cost 1-dimensional cost of cable tensions, unit precision
+   * if null
+   * @param lm_params    parameters of every solve
+   */
+  CdprPlanarController(const CdprPlanar &cdpr,
+                       const std::vector<gtsam::Pose3> &pdes, double dt,
+                       size_t horizon,
+                       const gtsam::SharedNoiseModel &state_cost = nullptr,
+                       const gtsam::SharedNoiseModel &control_cost = nullptr,
+                       const gtsam::LevenbergMarquardtParams &lm_params =
+                           gtsam::LevenbergMarquardtParams());
+
+  /**
+   * Solve the horizon starting at tick t.
+   * @param values the measured end-effector Pose and Twist at time t
+   * @param t      the current tick, not smaller than that of the last call
+   * @return the cable tensions at time t, as TorqueKey(j, t)
+   */
+  gtsam::Values update(const gtsam::Values &values, int t);
+
+  /// Solution of the last update, on horizon steps 0 to horizon - 1.
+  const gtsam::Values &solution() const { return solution_; }
+
+  /// The horizon graph with the priors of the last update.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  size_t horizon() const { return horizon_; }
+
+ private:
+  CdprPlanar cdpr_;
+  std::vector<gtsam::Pose3> pdes_;
+  double dt_;
+  size_t horizon_;
+  gtsam::SharedNoiseModel state_cost_;
+  gtsam::LevenbergMarquardtParams lm_params_;
+
+  gtsam::NonlinearFactorGraph graph_;
+  size_t first_prior_;  // index of the first tick-dependent prior in graph_
+  std::vector<gtsam::KeyVector> step_keys_;  // variables of every step
+
+  gtsam::Values solution_;
+  int t_ = -1;  // tick of the last update
+
+  /// Replace the priors on the state and the desired poses for tick t.
+  void setPriors(const gtsam::Pose3 &pose, const gtsam::Vector6 &twist,
+                 int t);
+
+  /// Initial values of the first solve, at rest at the measured pose.
+  void initialize(const gtsam::Pose3 &pose, const gtsam::Vector6 &twist);
+
+  /// Shift the solution forward by the given number of steps.
+  void shift(size_t steps);
+};
+
+}  // namespace gtdynamics
@@ -59,12 +59,17 @@ class CableLengthFactor
       const double &l, const gtsam::Pose3 &wTx,
       boost::optional<gtsam::Matrix &> H_l = boost::none,
       boost::optional<gtsam::Matrix &> H_wTx = boost::none) const override {
-    gtsam::Matrix36 wPb_H_wTx;
-    gtsam::Matrix13 H_wPb;
-    auto wPb = wTx.transformFrom(xPb_, H_wTx ? &wPb_H_wTx : 0);
-    double expected_l = gtsam::distance3(wPb, wPa_, H_wTx ? &H_wPb : 0);
+    const gtsam::Vector3 wPab = wTx.transformFrom(xPb_) - wPa_;
+    const double expected_l = wPab.norm();
     if (H_l) *H_l = gtsam::I_1x1;
-    if (H_wTx) *H_wTx = -H_wPb * wPb_H_wTx;
+    if (H_wTx) {
+      // Closed form: dl = xu . (v - xPb x w) under wTx * Exp([w; v]), with
+      // xu the cable direction in the end-effector frame.
+      const gtsam::Vector3 xu = wTx.rotation().unrotate(wPab) / expected_l;
+      gtsam::Matrix16 H;
+      H << -xPb_.cross(xu).transpose(), -xu.transpose();
+      *H_wTx = H;
+    }
     return gtsam::Vector1(l - expected_l);
   }
 
@@ -26,37 +26,31 @@ namespace gtdynamics {
 Vector6 CableTensionFactor::computeWrench(
     double t, const Pose3 &wTx, boost::optional<Matrix &> H_t,
     boost::optional<Matrix &> H_wTx) const {
-  // Jacobians: cable direction
-  Matrix33 dir_H_wPb;
-  Matrix36 wPb_H_wTx;
-  // Jacobians: force to wrench conversion
-  Matrix31 wf_H_t;
-  Matrix33 wf_H_dir;
-  Matrix33 xf_H_wf;
-  Matrix33 xf_H_wRx;
-  Matrix63 H_xf;
-  Matrix33 xm_H_xf;  // = H_xf.topRows<3>(); TODO(gerry): pointer?
+  // cable direction, in the end-effector frame
+  const Vector3 wPab = wTx.transformFrom(xPb_) - wPa_;
+  const double l = wPab.norm();
+  const Vector3 xu = wTx.rotation().unrotate(wPab) / l;
 
-  // cable direction
-  Point3 wPb = wTx.transformFrom(xPb_, H_wTx ? &wPb_H_wTx : 0);
-  Vector3 dir = normalize(wPb - wPa_, H_wTx ? &dir_H_wPb : 0);
-  // force->wrench
-  Vector3 wf = -t * dir;
-  if (H_t) wf_H_t = -dir;
-  if (H_wTx) wf_H_dir = -t * I_3x3;
-  Vector3 xf = wTx.rotation().unrotate(wf,  // force in the EE frame
-                                       H_wTx ? &xf_H_wRx : 0,
-                                       (H_t || H_wTx) ? &xf_H_wf : 0);
-  Vector3 xm = cross(xPb_, xf,     // moment in the EE frame
-                     boost::none,  //
-                     (H_t || H_wTx) ? &xm_H_xf : 0);
+  // force->wrench, in the end-effector frame
+  const Vector3 xf = -t * xu;
+  const Vector3 xm = xPb_.cross(xf);
+  Vector6 F;
+  F << xm, xf;
 
-  Vector6 F = (Vector6() << xm, xf).finished();
-  if (H_t || H_wTx) H_xf << xm_H_xf, I_3x3;
-  if (H_t) *H_t = H_xf * xf_H_wf * wf_H_t;
+  // Closed-form jacobians: under wTx * Exp([w; v]),
+  //   d xu = xu x w + (I - xu xu^T) (v - xPb x w) / l.
+  if (H_t) {
+    Matrix61 H;
+    H << -xPb_.cross(xu), -xu;
+    *H_t = H;
+  }
   if (H_wTx) {
-    *(H_wTx) = H_xf * xf_H_wf * wf_H_dir * dir_H_wPb * wPb_H_wTx;
-    H_wTx->leftCols<3>() += H_xf * xf_H_wRx;
+    const Matrix3 P = (I_3x3 - xu * xu.transpose()) / l;
+    Matrix36 xu_H_wTx;
+    xu_H_wTx << skewSymmetric(xu) - P * skewSymmetric(xPb_), P;
+    Matrix6 H;
+    H << -t * skewSymmetric(xPb_) * xu_H_wTx, -t * xu_H_wTx;
+    *H_wTx = H;
   }
   return F;
 }
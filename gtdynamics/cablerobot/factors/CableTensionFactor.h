@@ -57,9 +57,8 @@ class CableTensionFactor
         xPb_(xPb) {}
   virtual ~CableTensionFactor() {}
 
- private:
   /** Computes the wrench acting on the end-effector due to some cable tension
-   * and at some pose.
+   * and at some pose, e.g. to simulate without solving a graph.
    * @param tension the tension on the cable
    * @param wTx the pose of the end effector
    * @return Vector6: calculated wrench
@@ -69,6 +68,7 @@ class CableTensionFactor
       boost::optional<gtsam::Matrix &> H_t = boost::none,
       boost::optional<gtsam::Matrix &> H_wTx = boost::none) const;
 
+ private:
   // an alternate version of the above function that uses adjoint; will upgrade
   // to this version once I figure out how to get the jacobian from an Adjoint
   // operation
@@ -20,45 +20,32 @@ using namespace gtsam;
 
 namespace gtdynamics {
 
+/******************************************************************************/
 double CableVelocityFactor::computeLdot(const Pose3 &wTx, const Vector6 &Vx,
                                         boost::optional<Matrix &> H_wTx,
                                         boost::optional<Matrix &> H_Vx) const {
-  // Jacobians: cable direction
-  Matrix13 H_dir;
-  Matrix33 dir_H_wPb;
-  Matrix36 wPb_H_wTx;
-  // Jacobians: End-effector Mounting point velocity (in world coords)
-  Matrix13 H_wPDOTb;
-  Matrix33 wPDOTb_H_wRx;
-  Matrix33 wPDOTb_H_xPDOTb;
-  Matrix36 xPDOTb_H_Vx;
-  Matrix33 cross_H_omega;
-
-  // cable direction
-  Point3 wPb = wTx.transformFrom(xPb_, H_wTx ? &wPb_H_wTx : 0);
-  Vector3 dir = normalize(wPb - wPa_, H_wTx ? &dir_H_wPb : 0);
-
-  // velocity aka pdot
-  // TODO(gerry): use Adjoint
-  Vector3 eePDOTem =
-      Vx.tail<3>() + cross(Vx.head<3>(), xPb_, H_Vx ? &cross_H_omega : 0);
-  if (H_Vx) xPDOTb_H_Vx << cross_H_omega, I_3x3;
-  Vector3 wPDOTem = wTx.rotation().rotate(eePDOTem,  //
-                                          H_wTx ? &wPDOTb_H_wRx : 0,
-                                          H_Vx ? &wPDOTb_H_xPDOTb : 0);
+  // cable direction and mounting point velocity, in the end-effector frame
+  const Vector3 wPab = wTx.transformFrom(xPb_) - wPa_;
+  const double l = wPab.norm();
+  const Vector3 xu = wTx.rotation().unrotate(wPab) / l;
+  const Vector3 xv = Vx.tail<3>() + Vx.head<3>().cross(xPb_);
 
   // ldot = (cable direction) dot (velocity aka pdot)
-  double ldot = dot(dir, wPDOTem,        //
-                    H_wTx ? &H_dir : 0,  //
-                    H_Vx ? &H_wPDOTb : 0);
+  const double ldot = xu.dot(xv);
 
-  // jacobians
+  // Closed-form jacobians, under wTx * Exp([w; v]) and Vx + [w; v]:
+  //   d xu = xu x w + (I - xu xu^T) (v - xPb x w) / l,   d xv = w x xPb + v.
   if (H_wTx) {
-    *H_wTx = H_dir * dir_H_wPb * wPb_H_wTx;  //
-    H_wTx->leftCols<3>() += H_wPDOTb * wPDOTb_H_wRx;
+    const Vector3 xg = (xv - ldot * xu) / l;  // (I - xu xu^T) xv / l
+    Matrix16 H;
+    H << (xPb_.cross(xg) + xv.cross(xu)).transpose(), xg.transpose();
+    *H_wTx = H;
+  }
+  if (H_Vx) {
+    Matrix16 H;
+    H << xPb_.cross(xu).transpose(), xu.transpose();
+    *H_Vx = H;
   }
-  if (H_Vx) *H_Vx = H_wPDOTb * wPDOTb_H_xPDOTb * xPDOTb_H_Vx;
-
   return ldot;
 }
 
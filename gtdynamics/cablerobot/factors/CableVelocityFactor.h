@@ -54,17 +54,15 @@ class CableVelocityFactor
       : Base(cost_model, ldot_key, wTx_key, Vx_key), wPa_(wPa), xPb_(xPb) {}
   virtual ~CableVelocityFactor() {}
 
- private:
   /** Computes the cable speed that will result from some twist
    * @param wTx the pose of the end effector
    * @param Vx the twist of the end effector in the end effector's frame
-   * @return Vector6: calculated wrench
+   * @return double: calculated cable speed
    */
   double computeLdot(const Pose3 &wTx, const Vector6 &Vx,
                      boost::optional<gtsam::Matrix &> H_wTx = boost::none,
                      boost::optional<gtsam::Matrix &> H_Vx = boost::none) const;
 
- public:
   /** Cable factor
    * @param ldot -- cable speed (ldot)
    * @param wTx -- end effector pose
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprBatchSimulator.cpp
+ * @brief Lockstep simulation of a batch of planar cable robots.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/simulator/CdprBatchSimulator.h>
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+CdprBatchSimulator::CdprBatchSimulator(const CdprPlanar &cdpr,
+                                       size_t num_envs, size_t num_threads)
+    : cdpr_(cdpr), num_envs_(num_envs), t_(0) {
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  num_threads_ = std::min(std::max<size_t>(num_threads, 1),
+                          std::max<size_t>(num_envs, 1));
+
+  // The factors are only used for their math, so keys and noise are moot.
+  const int i = cdpr_.eeId();
+  const auto &params = cdpr_.params();
+  for (size_t j = 0; j < numCables(); j++) {
+    tension_factors_.emplace_back(TorqueKey(j), PoseKey(i), WrenchKey(i, j),
+                                  gtsam::noiseModel::Unit::Create(6),
+                                  params.a_locs[j], params.b_locs[j]);
+    velocity_factors_.emplace_back(JointVelKey(j), PoseKey(i), TwistKey(i),
+                                   gtsam::noiseModel::Unit::Create(1),
+                                   params.a_locs[j], params.b_locs[j]);
+  }
+  inertia_inv_ = cdpr_.eeLink()->inertiaMatrix().inverse();
+
+  initial_poses_.assign(num_envs, Pose3(gtsam::Rot3(), {1.5, 0, 1.5}));
+  initial_twists_.setZero(num_envs, 6);
+  twist_accels_.setZero(num_envs, 6);
+  lengths_.setZero(num_envs, numCables());
+  ldots_.setZero(num_envs, numCables());
+  tensions_.setZero(num_envs, numCables());
+  reset();
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::setInitialState(const std::vector<Pose3> &poses,
+                                         const Matrix &twists) {
+  if (poses.size() != num_envs_ || size_t(twists.rows()) != num_envs_ ||
+      twists.cols() != 6) {
+    throw std::invalid_argument(
+        "CdprBatchSimulator: initial state must be numEnvs poses and twists");
+  }
+  initial_poses_ = poses;
+  initial_twists_ = twists;
+  reset();
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::reset() {
+  t_ = 0;
+  poses_ = initial_poses_;
+  twists_ = initial_twists_;
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::kinematics() {
+  const auto &a_locs = cdpr_.params().a_locs, &b_locs = cdpr_.params().b_locs;
+  const size_t chunk = (num_envs_ + num_threads_ - 1) / num_threads_;
+  ParallelFor(num_threads_, num_threads_, [&](size_t w) {
+    const size_t end = std::min(num_envs_, (w + 1) * chunk);
+    for (size_t n = w * chunk; n < end; n++) {
+      const Vector6 twist = twists_.row(n).transpose();
+      for (size_t j = 0; j < numCables(); j++) {
+        lengths_(n, j) =
+            gtsam::distance3(poses_[n].transformFrom(b_locs[j]), a_locs[j]);
+        ldots_(n, j) = velocity_factors_[j].computeLdot(poses_[n], twist);
+      }
+    }
+  });
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::dynamics(const Matrix &tensions) {
+  if (size_t(tensions.rows()) != num_envs_ ||
+      size_t(tensions.cols()) != numCables()) {
+    throw std::invalid_argument(
+        "CdprBatchSimulator: tensions must be numEnvs x numCables");
+  }
+  tensions_ = tensions;
+
+  // Wrench balance of WrenchFactor, solved for the twist acceleration.
+  const auto &link = cdpr_.eeLink();
+  const gtsam::Matrix6 inertia = link->inertiaMatrix();
+  const auto &params = cdpr_.params();
+  const size_t chunk = (num_envs_ + num_threads_ - 1) / num_threads_;
+  ParallelFor(num_threads_, num_threads_, [&](size_t w) {
+    const size_t end = std::min(num_envs_, (w + 1) * chunk);
+    for (size_t n = w * chunk; n < end; n++) {
+      const Vector6 twist = twists_.row(n).transpose();
+      Vector6 wrench = Coriolis(inertia, twist) +
+                       GravityWrench(params.gravity, params.mass, poses_[n]);
+      for (size_t j = 0; j < numCables(); j++) {
+        wrench += tension_factors_[j].computeWrench(tensions_(n, j), poses_[n]);
+      }
+      twist_accels_.row(n) = (inertia_inv_ * wrench).transpose();
+    }
+  });
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::integration(double dt) {
+  // Euler collocation, as EulerPoseCollocationFactor and
+  // EulerTwistCollocationFactor.
+  for (size_t n = 0; n < num_envs_; n++) {
+    const Vector6 twist = twists_.row(n).transpose();
+    poses_[n] = poses_[n].compose(Pose3::Expmap(twist * dt));
+  }
+  twists_ += dt * twist_accels_;
+}
+
+/* ************************************************************************* */
+void CdprBatchSimulator::step(const Matrix &tensions, double dt) {
+  kinematics();
+  dynamics(tensions);
+  integration(dt);
+  t_++;
+}
+
+/* ************************************************************************* */
+std::vector<CdprTrajectory> CdprBatchSimulator::simulate(
+    const std::vector<Matrix> &tensions_seq, double dt) {
+  const size_t num_steps = tensions_seq.size(), num_cables = numCables();
+  CdprTrajectory empty;
+  empty.poses.resize(num_steps);
+  empty.twists.setZero(num_steps, 6);
+  empty.twist_accels.setZero(num_steps, 6);
+  empty.lengths.setZero(num_steps, num_cables);
+  empty.ldots.setZero(num_steps, num_cables);
+  empty.tensions.setZero(num_steps, num_cables);
+  std::vector<CdprTrajectory> trajectories(num_envs_, empty);
+
+  for (size_t k = 0; k < num_steps; k++) {
+    kinematics();
+    dynamics(tensions_seq[k]);
+    for (size_t n = 0; n < num_envs_; n++) {
+      CdprTrajectory &trajectory = trajectories[n];
+      trajectory.poses[k] = poses_[n];
+      trajectory.twists.row(k) = twists_.row(n);
+      trajectory.twist_accels.row(k) = twist_accels_.row(n);
+      trajectory.lengths.row(k) = lengths_.row(n);
+      trajectory.ldots.row(k) = ldots_.row(n);
+      trajectory.tensions.row(k) = tensions_.row(n);
+    }
+    integration(dt);
+    t_++;
+  }
+  return trajectories;
+}
+
+/* ************************************************************************* */
+Matrix CdprBatchSimulator::positions() const {
+  Matrix positions(num_envs_, 2);
+  for (size_t n = 0; n < num_envs_; n++) {
+    positions(n, 0) = poses_[n].x();
+    positions(n, 1) = poses_[n].z();
+  }
+  return positions;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprBatchSimulator.h
+ * @brief Lockstep simulation of a batch of planar cable robots.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/cablerobot/utils/CdprPlanar.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Recorded states of one cable robot, with one row per step.
+struct CdprTrajectory {
+  std::vector<gtsam::Pose3> poses;  ///< end-effector poses
+  gtsam::Matrix twists;             ///< num_steps x 6 end-effector twists
+  gtsam::Matrix twist_accels;       ///< num_steps x 6 twist accelerations
+  gtsam::Matrix lengths;            ///< num_steps x numCables cable lengths
+  gtsam::Matrix ldots;              ///< num_steps x numCables cable speeds
+  gtsam::Matrix tensions;           ///< num_steps x numCables cable tensions
+};
+
+/**
+ * CdprBatchSimulator steps N copies of a cable robot in lockstep, e.g. for
+ * Monte Carlo rollouts of a cable controller with perturbed initial states
+ * or tensions.
+ *
+ * Every step has the semantics of CdprSimulator.step in cdpr_planar_sim.py:
+ * cable lengths and speeds at the current state, then the twist acceleration
+ * from the tensions, and Euler integration to the next pose and twist. The
+ * graphs that CdprSimulator solves are all square, so instead of solving
+ * them the kernel evaluates the factor math directly: cable speeds with
+ * CableVelocityFactor::computeLdot, cable wrenches with
+ * CableTensionFactor::computeWrench, and the wrench balance of WrenchFactor
+ * with a precomputed inverse of the inertia matrix. Environments are spread
+ * over threads, and the state of all environments is held in matrices.
+ */
+class CdprBatchSimulator {
+ private:
+  CdprPlanar cdpr_;
+  size_t num_envs_, num_threads_;
+  int t_;
+
+  std::vector<CableTensionFactor> tension_factors_;
+  std::vector<CableVelocityFactor> velocity_factors_;
+  gtsam::Matrix6 inertia_inv_;
+
+  std::vector<gtsam::Pose3> initial_poses_, poses_;
+  gtsam::Matrix initial_twists_, twists_, twist_accels_;
+  gtsam::Matrix lengths_, ldots_, tensions_;
+
+ public:
+  /**
+   * Constructor, with all environments at rest at the center of the frame.
+   * @param cdpr        the cable robot
+   * @param num_envs    number of environments N
+   * @param num_threads number of threads, 0 for hardware concurrency
+   */
+  CdprBatchSimulator(const CdprPlanar &cdpr, size_t num_envs,
+                     size_t num_threads = 1);
+
+  /// Number of environments.
+  size_t numEnvs() const { return num_envs_; }
+
+  /// Number of cables.
+  size_t numCables() const { return cdpr_.numCables(); }
+
+  /// Number of steps taken since the last reset.
+  int t() const { return t_; }
+
+  /**
+   * Set the initial state of all environments and reset to it.
+   * @param poses  N initial end-effector poses
+   * @param twists N x 6 initial end-effector twists
+   */
+  void setInitialState(const std::vector<gtsam::Pose3> &poses,
+                       const gtsam::Matrix &twists);
+
+  /// Reset all environments to the initial state.
+  void reset();
+
+  /// Compute the cable lengths and speeds of all environments.
+  void kinematics();
+
+  /**
+   * Compute the twist accelerations of all environments.
+   * @param tensions N x numCables cable tensions
+   */
+  void dynamics(const gtsam::Matrix &tensions);
+
+  /**
+   * Integrate all environments for one time step, with the twist
+   * accelerations of the last dynamics call.
+   * @param dt duration of the time step
+   */
+  void integration(double dt);
+
+  /**
+   * Simulate all environments for one time step.
+   * @param tensions N x numCables cable tensions
+   * @param dt       duration of the time step
+   */
+  void step(const gtsam::Matrix &tensions, double dt);
+
+  /**
+   * Simulate for a sequence of tensions and record the trajectories, where
+   * row k holds the state at step k before integration.
+   * @param tensions_seq one N x numCables tension matrix per step
+   * @param dt           duration of the time steps
+   * @return one trajectory per environment
+   */
+  std::vector<CdprTrajectory> simulate(
+      const std::vector<gtsam::Matrix> &tensions_seq, double dt);
+
+  /// End-effector poses of all environments.
+  const std::vector<gtsam::Pose3> &poses() const { return poses_; }
+
+  /// End-effector twists of all environments, N x 6.
+  const gtsam::Matrix &twists() const { return twists_; }
+
+  /// Twist accelerations of the last dynamics call, N x 6.
+  const gtsam::Matrix &twistAccels() const { return twist_accels_; }
+
+  /// Cable lengths of the last kinematics call, N x numCables.
+  const gtsam::Matrix &lengths() const { return lengths_; }
+
+  /// Cable speeds of the last kinematics call, N x numCables.
+  const gtsam::Matrix &ldots() const { return ldots_; }
+
+  /// End-effector xz-positions of all environments, N x 2.
+  gtsam::Matrix positions() const;
+};
+
+}  // namespace gtdynamics
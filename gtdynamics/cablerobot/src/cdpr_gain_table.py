@@ -0,0 +1,167 @@
+"""
+GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+Atlanta, Georgia 30332-0415
+All Rights Reserved
+See LICENSE for the license information
+
+@file  cdpr_gain_table.py
+@brief Time-varying LQR feedback gains for a cable robot, extracted once from the eliminated
+Bayes net of an iLQR factor graph, and gain scheduling over several nominal trajectories.
+@author Gerry Chen
+"""
+
+import gtdynamics as gtd
+import gtsam
+import numpy as np
+
+NUM_CABLES = 4
+STATE_DIM = 12  # pose and twist of the end-effector
+
+
+def _dims(key):
+    """Dimensions of the variables that can be parents of a tension conditional."""
+    label = gtd.DynamicsSymbol(key).label()
+    return 6 if label in ('p', 'V') else 1
+
+
+class CdprGainTable:
+    """Feedback gains of one nominal trajectory, indexed by time step.
+
+    At time step k the tensions are u = u*_k + du_k + K_k dx, where u*_k are the nominal tensions,
+    dx is the 12-vector of the pose deviation in the local coordinates of the nominal pose
+    followed by the twist deviation, K_k is 4x12, and du_k is the feed-forward correction, near
+    zero when the nominal trajectory is optimal.
+    """
+    def __init__(self, poses, twists, tensions, gains, feedforwards):
+        """constructor
+
+        Args:
+            poses (List[gtsam.Pose3]): nominal poses, one per time step
+            twists (np.ndarray): N x 6 nominal twists
+            tensions (np.ndarray): N x 4 nominal tensions
+            gains (np.ndarray): N x 4 x 12 feedback gains
+            feedforwards (np.ndarray): N x 4 feed-forward corrections
+        """
+        self.poses = list(poses)
+        self.twists = np.asarray(twists)
+        self.tensions = np.asarray(tensions)
+        self.gains = np.asarray(gains)
+        self.feedforwards = np.asarray(feedforwards)
+
+    def __len__(self):
+        return len(self.poses)
+
+    def deviation(self, k, pose, twist):
+        """The state deviation dx from the nominal state at time step k."""
+        return np.concatenate(
+            (self.poses[k].localCoordinates(pose), np.asarray(twist) - self.twists[k]))
+
+    def control(self, k, pose, twist):
+        """The tensions for a measured pose and twist at time step k, holding the last time step
+        past the end of the table."""
+        k = min(k, len(self) - 1)
+        return (self.tensions[k] + self.feedforwards[k] +
+                self.gains[k] @ self.deviation(k, pose, twist))
+
+    @staticmethod
+    def from_ilqr(cdpr, fg, result, N):
+        """Extract the gains from the iLQR graph of CdprController.create_ilqr_fg.
+
+        The graph is linearized at its solution and eliminated backwards in time: at every
+        time step the intermediate variables first, then the tensions, then the pose and twist,
+        and the time step duration last. The conditionals of the tensions then only depend on the
+        tensions eliminated after them, the state at the same time step and the duration, which is
+        constant, so back-substitution gives the tensions as an affine function of the state.
+
+        Args:
+            cdpr (Cdpr): cable robot object
+            fg (gtsam.NonlinearFactorGraph): iLQR factor graph
+            result (gtsam.Values): solution of fg
+            N (int): number of time steps
+
+        Returns:
+            CdprGainTable: the gains at time steps 0 to N-1
+        """
+        ee = cdpr.ee_id()
+        state_keys = [[gtd.PoseKey(ee, k).key(), gtd.TwistKey(ee, k).key()] for k in range(N)]
+        tension_keys = [[gtd.TorqueKey(ji, k).key() for ji in range(NUM_CABLES)]
+                        for k in range(N)]
+        special = set(sum(state_keys + tension_keys, [])) | {0}  # key 0 is dt
+        intermediate = [[] for _ in range(N)]
+        for key in gtd.KeySetToKeyVector(fg.keys()):
+            if key not in special:
+                intermediate[gtd.DynamicsSymbol(key).time()].append(key)
+
+        ordering = gtsam.Ordering()
+        for k in reversed(range(N)):
+            for key in intermediate[k] + tension_keys[k] + state_keys[k]:
+                ordering.push_back(key)
+        ordering.push_back(0)
+        bn = fg.linearize(result).eliminateSequential(ordering)
+        conditionals = {}
+        for i in range(bn.size()):
+            conditional = bn.at(i)
+            conditionals[conditional.keys()[0]] = conditional
+
+        poses, twists = [], np.zeros((N, 6))
+        tensions, gains = np.zeros((N, NUM_CABLES)), np.zeros((N, NUM_CABLES, STATE_DIM))
+        feedforwards = np.zeros((N, NUM_CABLES))
+        for k in range(N):
+            poses.append(gtd.Pose(result, ee, k))
+            twists[k] = gtd.Twist(result, ee, k)
+            # Parents as affine functions G dx + f of the state.
+            affine = {
+                state_keys[k][0]: (np.eye(6, STATE_DIM), np.zeros(6)),
+                state_keys[k][1]: (np.eye(6, STATE_DIM, 6), np.zeros(6)),
+                0: (np.zeros((1, STATE_DIM)), np.zeros(1)),
+            }
+            for ji in reversed(range(NUM_CABLES)):
+                key = tension_keys[k][ji]
+                conditional = conditionals[key]
+                S, col = conditional.S(), 0
+                G, f = np.zeros((1, STATE_DIM)), conditional.d().copy()
+                for parent in list(conditional.keys())[1:]:
+                    if parent not in affine:
+                        raise RuntimeError("CdprGainTable: unexpected parent " +
+                                           str(gtd.DynamicsSymbol(parent).label()))
+                    dim = _dims(parent)
+                    G -= S[:, col:col + dim] @ affine[parent][0]
+                    f -= S[:, col:col + dim] @ affine[parent][1]
+                    col += dim
+                R_inv = np.linalg.inv(conditional.R())
+                affine[key] = (R_inv @ G, R_inv @ f)
+                tensions[k, ji] = gtd.Torque(result, ji, k)
+                gains[k, ji] = affine[key][0][0]
+                feedforwards[k, ji] = affine[key][1][0]
+        return CdprGainTable(poses, twists, tensions, gains, feedforwards)
+
+
+class CdprGainSchedule:
+    """Gain scheduling over the tables of several nominal trajectories (operating points): at
+    every time step, the table whose nominal state is closest to the measured one is used.
+    """
+    def __init__(self, tables=()):
+        """constructor
+
+        Args:
+            tables (List[CdprGainTable], optional): gain tables. Defaults to none.
+        """
+        self.tables = list(tables)
+
+    def add(self, table):
+        """Add the gain table of another operating point."""
+        self.tables.append(table)
+
+    def table(self, k, pose, twist):
+        """The table to use at time step k for the measured pose and twist."""
+        if not self.tables:
+            raise ValueError("CdprGainSchedule: no gain tables")
+        if len(self.tables) == 1:
+            return self.tables[0]
+        def distance(table):
+            return np.linalg.norm(table.deviation(min(k, len(table) - 1), pose, twist))
+        return min(self.tables, key=distance)
+
+    def control(self, k, pose, twist):
+        """The tensions for a measured pose and twist at time step k."""
+        return self.table(k, pose, twist).control(k, pose, twist)
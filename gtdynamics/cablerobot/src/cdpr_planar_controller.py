@@ -16,6 +16,7 @@ import gtsam
 import numpy as np
 
 import utils
+from cdpr_gain_table import CdprGainSchedule, CdprGainTable
 
 
 class CdprControllerBase:
@@ -41,8 +42,8 @@ class CdprControllerBase:
 
 
 class CdprController(CdprControllerBase):
-    """Precomputes the open-loop trajectory
-    then just calls on that for each update.
+    """Precomputes the optimal trajectory and the time-varying LQR feedback gains around it, then
+    just looks up the gains for each update.
     """
     def __init__(self, cdpr, x0, pdes=[], dt=0.01, Q=None, R=np.array([1.])):
         """constructor
@@ -68,12 +69,38 @@ class CdprController(CdprControllerBase):
         self.optimizer = gtsam.LevenbergMarquardtOptimizer(fg, init)
         self.result = self.optimizer.optimize()
         self.fg = fg
+        # feedback gains
+        self.gains = CdprGainSchedule(
+            [CdprGainTable.from_ilqr(cdpr, fg, self.result, len(pdes))])
+
+    def add_operating_point(self, x0, pdes, Q=None, R=np.array([1.])):
+        """Add the gains around the optimal trajectory for another initial state and desired
+        poses, with the same number of time steps, to schedule the gains between them.
+
+        Args:
+            x0 (gtsam.Values): initial state
+            pdes (list): list of desired poses
+            Q (np.ndarray, optional): State objective cost. Defaults to None.
+            R (np.ndarray, optional): Control cost. Defaults to np.array([1.]).
+        """
+        fg = self.create_ilqr_fg(self.cdpr, x0, pdes, self.dt, Q, R)
+        init = utils.zerovalues(self.cdpr.ee_id(), range(len(pdes)), dt=self.dt)
+        result = gtsam.LevenbergMarquardtOptimizer(fg, init).optimize()
+        self.gains.add(CdprGainTable.from_ilqr(self.cdpr, fg, result, len(pdes)))
 
     def update(self, values, t):
-        """New control: returns the entire results vector, which contains the optimal open-loop
-        control from the optimal trajectory.
+        """New control: a table lookup of the feedback gains at time step t, applied to the
+        measured Pose and Twist.
+
+        Returns:
+            gtsam.Values: the cable tensions at time step t
         """
-        return self.result
+        lid = self.cdpr.ee_id()
+        tensions = self.gains.control(t, gtd.Pose(values, lid, t), gtd.Twist(values, lid, t))
+        u = gtsam.Values()
+        for ji, tension in enumerate(tensions):
+            gtd.InsertTorque(u, ji, t, tension)
+        return u
 
     @staticmethod
     def create_ilqr_fg(cdpr, x0, pdes, dt, Q, R):
@@ -100,17 +127,14 @@ class CdprController(CdprControllerBase):
         # dynamics
         fg.push_back(cdpr.all_factors(N, dt))
         # control costs
-        for k in range(N):
-            for ji in range(4):
-                fg.push_back(
-                    gtd.PriorFactorDouble(
-                        gtd.TorqueKey(ji, k).key(), 0.0,
-                        gtsam.noiseModel.Diagonal.Precisions(R)))
+        fg.push_back(
+            gtd.DoublePriorFactors(gtd.JointKeys("T", list(range(4)), N),
+                                   np.zeros(1),
+                                   gtsam.noiseModel.Diagonal.Precisions(R)))
         # state objective costs
         cost_x = gtsam.noiseModel.Isotropic.Sigma(6, 0.001) if Q is None else \
             gtsam.noiseModel.Diagonal.Precisions(Q)
-        for k in range(N):
-            fg.push_back(
-                gtsam.PriorFactorPose3(
-                    gtd.PoseKey(cdpr.ee_id(), k).key(), pdes[k], cost_x))
+        fg.push_back(
+            gtd.PosePriorFactors(gtd.LinkKeys("p", [cdpr.ee_id()], N),
+                                 list(pdes), cost_x))
         return fg
@@ -167,3 +167,32 @@ class CdprSimulator:
         self.fg = gtsam.NonlinearFactorGraph()
         self.x = gtsam.Values(self.x0)
         self.k = 0
+
+    @staticmethod
+    def batch(cdpr, num_envs, num_threads=1):
+        """Creates a native simulator that steps many copies of the cable robot in parallel.
+        Each step computes the same state as `step`, but from the factor math directly instead
+        of solving graphs, and all states are numpy arrays, e.g. for Monte Carlo runs:
+
+            sim = CdprSimulator.batch(cdpr, 100, num_threads=4)
+            sim.setInitialState(poses, np.zeros((100, 6)))
+            for k in range(N):
+                sim.kinematics()
+                sim.step(controller(sim.lengths(), sim.ldots()), dt)
+
+        Args:
+            cdpr (Cdpr): cable robot object
+            num_envs (int): number of simulations
+            num_threads (int, optional): number of threads, 0 for all cores. Defaults to 1.
+
+        Returns:
+            gtd.CdprBatchSimulator: the batch simulator, with all end effectors at rest at the
+            center of the frame
+        """
+        params = gtd.CdprParameters()
+        params.a_locs = [np.array(a, dtype=float) for a in cdpr.params.a_locs]
+        params.b_locs = [np.array(b, dtype=float) for b in cdpr.params.b_locs]
+        params.mass = cdpr.params.mass
+        params.inertia = np.array(cdpr.params.inertia, dtype=float)
+        params.gravity = np.array(cdpr.params.gravity, dtype=float).flatten()
+        return gtd.CdprBatchSimulator(gtd.CdprPlanar(params), num_envs, num_threads)
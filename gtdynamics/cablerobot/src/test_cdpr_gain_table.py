@@ -0,0 +1,77 @@
+"""
+GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+Atlanta, Georgia 30332-0415
+All Rights Reserved
+See LICENSE for the license information
+
+@file  test_cdpr_gain_table.py
+@brief Unit tests for the CDPR feedback gain tables.
+@author Gerry Chen
+"""
+
+import unittest
+
+import gtdynamics as gtd
+import gtsam
+from gtsam import Pose3, Rot3
+import numpy as np
+from cdpr_planar import Cdpr
+from cdpr_planar_controller import CdprController
+from gtsam.utils.test_case import GtsamTestCase
+
+
+def initial_state(cdpr, pose):
+    x0 = gtsam.Values()
+    gtd.InsertPose(x0, cdpr.ee_id(), 0, pose)
+    gtd.InsertTwist(x0, cdpr.ee_id(), 0, np.zeros(6))
+    return x0
+
+
+class TestCdprGainTable(GtsamTestCase):
+    def setUp(self):
+        self.cdpr = Cdpr()
+        self.x_des = [Pose3(Rot3(), (1.5 + k / 20.0, 0, 1.5)) for k in range(10)]
+        self.x0 = initial_state(self.cdpr, self.x_des[0])
+        self.controller = CdprController(self.cdpr, x0=self.x0, pdes=self.x_des, dt=0.1)
+
+    def testNominal(self):
+        """At the nominal states, the tensions are the nominal ones."""
+        table = self.controller.gains.tables[0]
+        self.assertEqual(len(table), 10)
+        self.assertEqual(table.gains.shape, (10, 4, 12))
+        lid = self.cdpr.ee_id()
+        for k in range(10):
+            u = self.controller.update(self.controller.result, k)
+            for ji in range(4):
+                self.assertAlmostEqual(gtd.Torque(u, ji, k),
+                                       gtd.Torque(self.controller.result, ji, k), places=3)
+        np.testing.assert_allclose(
+            table.control(20, gtd.Pose(self.controller.result, lid, 9),
+                          gtd.Twist(self.controller.result, lid, 9)),
+            table.control(9, gtd.Pose(self.controller.result, lid, 9),
+                          gtd.Twist(self.controller.result, lid, 9)))
+
+    def testFeedback(self):
+        """The gains predict the tensions optimal for a perturbed initial state."""
+        table = self.controller.gains.tables[0]
+        perturbed = Pose3(Rot3(), (1.5, 0, 1.501))
+        other = CdprController(self.cdpr, x0=initial_state(self.cdpr, perturbed),
+                               pdes=self.x_des, dt=0.1)
+        actual = np.array([gtd.Torque(other.result, ji, 0) for ji in range(4)])
+        predicted = table.control(0, perturbed, np.zeros(6))
+        change = np.linalg.norm(actual - table.tensions[0])
+        self.assertGreater(change, 0)
+        self.assertLess(np.linalg.norm(predicted - actual), 0.1 * change + 1e-6)
+
+    def testSchedule(self):
+        """The table of the closest operating point is used."""
+        shifted = [Pose3(Rot3(), (p.x(), 0, p.z() + 0.2)) for p in self.x_des]
+        self.controller.add_operating_point(initial_state(self.cdpr, shifted[0]), shifted)
+        schedule = self.controller.gains
+        self.assertEqual(len(schedule.tables), 2)
+        self.assertIs(schedule.table(0, self.x_des[0], np.zeros(6)), schedule.tables[0])
+        self.assertIs(schedule.table(0, shifted[0], np.zeros(6)), schedule.tables[1])
+
+
+if __name__ == "__main__":
+    unittest.main()
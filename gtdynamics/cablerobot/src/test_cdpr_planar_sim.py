@@ -56,6 +56,34 @@ class TestCdprPlanar(GtsamTestCase):
             xddot = 2 * dx / np.sqrt(dx**2 + dy**2)
             x += xdot * dt
             xdot += xddot * dt
+    def testBatch(self):
+        """Tests that the batch simulator matches the graph-based simulation."""
+        class ConstantController(CdprControllerBase):
+            def update(self, values, k):
+                tau = gtsam.Values()
+                for ji, t in enumerate([1., 0.5, 0., 0.2]):
+                    gtd.InsertTorque(tau, ji, k, t)
+                return tau
+        dt = 0.05
+        cdpr = Cdpr()
+        xInit = gtsam.Values()
+        gtd.InsertPose(xInit, cdpr.ee_id(), 0, Pose3(Rot3(), (1.5, 0, 1.5)))
+        gtd.InsertTwist(xInit, cdpr.ee_id(), 0, np.zeros(6))
+        result = CdprSimulator(cdpr, xInit, ConstantController(), dt=dt).run(N=5)
+
+        sim = CdprSimulator.batch(cdpr, 3, num_threads=2)
+        trajectories = sim.simulate([np.tile([1., 0.5, 0., 0.2], (3, 1))] * 5, dt)
+        for trajectory in trajectories:
+            for k in range(5):
+                self.gtsamAssertEquals(trajectory.poses[k],
+                                       gtd.Pose(result, cdpr.ee_id(), k),
+                                       tol=1e-6)
+                np.testing.assert_allclose(trajectory.lengths[k],
+                                           [gtd.JointAngle(result, ji, k) for ji in range(4)],
+                                           atol=1e-6)
+        np.testing.assert_allclose(sim.positions()[:, 0],
+                                   [gtd.Pose(result, cdpr.ee_id(), 5).x()] * 3,
+                                   atol=1e-6)
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,118 @@
+/**
+ * @file  testCableTensionDistribution.cpp
+ * @brief test the spatial cable robot and its tension distribution
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/controllers/CableTensionDistribution.h>
+#include <gtdynamics/cablerobot/utils/CdprSpatial.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+using namespace gtsam;
+using namespace gtdynamics;
+
+namespace example {
+const CdprSpatial cdpr;
+const Pose3 center(Rot3(), Point3(1.5, 1.5, 1.5));
+const double dt = 0.01;
+}  // namespace example
+
+/**
+ * Per step: 8 x (length, velocity, tension) + 1 wrench; per step but the
+ * last 2 collocation; one dt prior.
+ */
+TEST(CdprSpatial, allFactors) {
+  const int N = 5;
+  EXPECT_LONGS_EQUAL(8, example::cdpr.numCables());
+  EXPECT_LONGS_EQUAL(N * 25 + (N - 1) * 2 + 1,
+                     example::cdpr.allFactors(N, example::dt).size());
+}
+
+/**
+ * The 8 cables can resist any wrench, and at rest the cables carry the
+ * weight of the end effector.
+ */
+TEST(CdprSpatial, wrenchMatrix) {
+  const Matrix W = example::cdpr.wrenchMatrix(example::center);
+  EXPECT_LONGS_EQUAL(6, W.rows());
+  EXPECT_LONGS_EQUAL(8, W.cols());
+  EXPECT_LONGS_EQUAL(6, W.fullPivLu().rank());
+
+  const Vector6 w = example::cdpr.requiredWrench(
+      example::center, Vector6::Zero(), Vector6::Zero());
+  const double weight = example::cdpr.params().mass * 9.81;
+  EXPECT(assert_equal((Vector6() << 0, 0, 0, 0, 0, weight).finished(), w,
+                      1e-9));
+}
+
+namespace example {
+const Vector6 w = cdpr.requiredWrench(
+    center, Vector6::Zero(), (Vector6() << 0.5, 0, 0, 1, -2, 3).finished());
+}  // namespace example
+
+/**
+ * Tensions within bounds apply the required wrench.
+ */
+TEST(CableTensionDistribution, solve) {
+  CableTensionDistribution distribution(8, 1, 50);
+  const auto result =
+      distribution.solve(example::cdpr, example::center, example::w);
+  EXPECT(result.feasible);
+  EXPECT_DOUBLES_EQUAL(0, result.residual, 1e-9);
+  EXPECT(result.tensions.minCoeff() >= 1);
+  EXPECT(result.tensions.maxCoeff() <= 50);
+  EXPECT(assert_equal(
+      example::w,
+      example::cdpr.wrenchMatrix(example::center) * result.tensions, 1e-9));
+}
+
+/**
+ * With narrow bounds two cables end up at the lower bound, and the same
+ * wrench is solved again from the cached active set in one linear solve.
+ */
+TEST(CableTensionDistribution, activeSet) {
+  CableTensionDistribution distribution(8, 19.5, 27.2);
+  const auto result =
+      distribution.solve(example::cdpr, example::center, example::w);
+  EXPECT(result.feasible);
+  EXPECT(result.iterations > 1);
+  EXPECT(result.tensions.minCoeff() >= 19.5);
+  EXPECT(result.tensions.maxCoeff() <= 27.2);
+  int num_active = 0;
+  for (int s : distribution.activeSet()) num_active += s != 0;
+  EXPECT_LONGS_EQUAL(2, num_active);
+
+  const auto again =
+      distribution.solve(example::cdpr, example::center, example::w);
+  EXPECT_LONGS_EQUAL(1, again.iterations);
+  EXPECT(assert_equal(result.tensions, again.tensions, 1e-9));
+
+  distribution.reset();
+  for (int s : distribution.activeSet()) EXPECT_LONGS_EQUAL(0, s);
+}
+
+/**
+ * A wrench beyond the tension bounds is reported infeasible, and bad
+ * arguments throw.
+ */
+TEST(CableTensionDistribution, infeasible) {
+  CableTensionDistribution distribution(8, 1, 50);
+  const Vector6 w = (Vector6() << 0, 0, 0, 0, 0, 1e4).finished();
+  const auto result = distribution.solve(example::cdpr, example::center, w);
+  EXPECT(!result.feasible);
+  EXPECT(result.tensions.minCoeff() >= 1);
+  EXPECT(result.tensions.maxCoeff() <= 50);
+
+  CHECK_EXCEPTION(distribution.solve(Matrix::Zero(6, 4), w),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(CableTensionDistribution(8, 2, 1), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -15,6 +15,7 @@
 #include <gtsam/nonlinear/factorTesting.h>
 
 #include <iostream>
+#include <vector>
 
 using namespace std;
 using namespace gtsam;
@@ -62,6 +63,27 @@ TEST(CableVelocityFactor, error) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
 }
 
+/**
+ * Test the closed-form jacobians against numerical ones at general poses
+ */
+TEST(CableVelocityFactor, jacobians) {
+  CableVelocityFactor factor(JointVelKey(0), PoseKey(0), TwistKey(0),
+                             noiseModel::Isotropic::Sigma(1, 1.0),
+                             Point3(0.3, -0.2, 0.7), Point3(-0.15, 0.1, 0.2));
+  const std::vector<Pose3> poses{
+      Pose3(Rot3::RzRyRx(0.3, -0.5, 0.9), Point3(1.5, 0.2, 1.3)),
+      Pose3(Rot3::Ry(-2.5), Point3(-0.4, 1.1, 0.6)),
+      Pose3(Rot3::Rx(M_PI_2), Point3(2.9, 0.1, -0.2))};
+  for (auto &&pose : poses) {
+    Values values;
+    InsertJointVel(&values, 0, 0.4);
+    InsertPose(&values, 0, pose);
+    InsertTwist(&values, 0,
+                (Vector6() << 0.5, -1.3, 0.7, 2.1, -0.4, 0.9).finished());
+    EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
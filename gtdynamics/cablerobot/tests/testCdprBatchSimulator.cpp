@@ -0,0 +1,83 @@
+/**
+ * @file  testCdprBatchSimulator.cpp
+ * @brief test the batched cable robot simulator
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/simulator/CdprBatchSimulator.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace gtsam;
+using namespace gtdynamics;
+
+/**
+ * Pulling on the two right cables, as testSim in test_cdpr_planar_sim.py.
+ */
+TEST(CdprBatchSimulator, simulate) {
+  const double dt = 0.1;
+  CdprBatchSimulator sim(CdprPlanar(), 1);
+  const Matrix u = (Matrix(1, 4) << 1, 1, 0, 0).finished();
+  const std::vector<Matrix> tensions(10, u);
+  const auto trajectories = sim.simulate(tensions, dt);
+  EXPECT_LONGS_EQUAL(10, sim.t());
+
+  double x = 1.5, xdot = 0;
+  for (size_t k = 0; k < 10; k++) {
+    const Pose3 expected(Rot3(), Point3(x, 0, 1.5));
+    EXPECT(assert_equal(expected, trajectories[0].poses[k], 1e-12));
+    const double dx = 3 - x - 0.15, dy = 1.35;  // the cable vector
+    const double xddot = 2 * dx / std::sqrt(dx * dx + dy * dy);
+    EXPECT_DOUBLES_EQUAL(xddot, trajectories[0].twist_accels(k, 3), 1e-12);
+    EXPECT_DOUBLES_EQUAL(std::sqrt(dx * dx + dy * dy),
+                         trajectories[0].lengths(k, 0), 1e-12);
+    EXPECT_DOUBLES_EQUAL(-xdot * dx / std::sqrt(dx * dx + dy * dy),
+                         trajectories[0].ldots(k, 0), 1e-12);
+    x += xdot * dt;
+    xdot += xddot * dt;
+  }
+}
+
+/**
+ * Environments are independent, and are the same on any number of threads.
+ */
+TEST(CdprBatchSimulator, batch) {
+  const size_t N = 7;
+  Matrix tensions = Matrix::Zero(N, 4);
+  std::vector<Pose3> poses;
+  for (size_t n = 0; n < N; n++) {
+    tensions(n, n % 4) = 1 + 0.1 * n;
+    poses.emplace_back(Rot3::Ry(0.01 * n), Point3(1.4 + 0.02 * n, 0, 1.5));
+  }
+
+  CdprBatchSimulator single(CdprPlanar(), 1), batch(CdprPlanar(), N, 3);
+  batch.setInitialState(poses, Matrix::Zero(N, 6));
+  for (size_t k = 0; k < 5; k++) batch.step(tensions, 0.01);
+
+  for (size_t n = 0; n < N; n++) {
+    single.setInitialState({poses[n]}, Matrix::Zero(1, 6));
+    for (size_t k = 0; k < 5; k++) single.step(tensions.row(n), 0.01);
+    EXPECT(assert_equal(single.poses()[0], batch.poses()[n], 1e-12));
+    EXPECT(assert_equal(Vector(single.twists().row(0)),
+                        Vector(batch.twists().row(n)), 1e-12));
+  }
+
+  // Back at the initial state after a reset.
+  batch.reset();
+  EXPECT_LONGS_EQUAL(0, batch.t());
+  EXPECT(assert_equal(poses[3], batch.poses()[3]));
+  EXPECT_LONGS_EQUAL(N, batch.positions().rows());
+
+  CHECK_EXCEPTION(batch.step(Matrix::Zero(N - 1, 4), 0.01),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
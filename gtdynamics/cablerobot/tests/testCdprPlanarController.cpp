@@ -0,0 +1,86 @@
+/**
+ * @file  testCdprPlanarController.cpp
+ * @brief test the receding-horizon cable robot controller
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/controllers/CdprPlanarController.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace gtsam;
+using namespace gtdynamics;
+
+namespace example {
+const CdprPlanar cdpr;
+const Pose3 center(Rot3(), Point3(1.5, 0, 1.5));
+const double dt = 0.01;
+
+Values state(const Pose3 &pose, int t) {
+  Values values;
+  InsertPose(&values, cdpr.eeId(), t, pose);
+  InsertTwist(&values, cdpr.eeId(), t, Vector6::Zero());
+  return values;
+}
+}  // namespace example
+
+/**
+ * The graph has the structure of the python iLQR graph, over the horizon.
+ */
+TEST(CdprPlanar, allFactors) {
+  // Per step: 4 x (length, velocity, tension) + 2 planar + 1 wrench; per
+  // step but the last 2 collocation; one dt prior.
+  const int N = 5;
+  EXPECT_LONGS_EQUAL(N * 15 + (N - 1) * 2 + 1,
+                     example::cdpr.allFactors(N, example::dt).size());
+}
+
+/**
+ * At rest at the desired pose, without gravity, all tensions stay zero.
+ */
+TEST(CdprPlanarController, rest) {
+  const std::vector<Pose3> pdes(20, example::center);
+  CdprPlanarController controller(example::cdpr, pdes, example::dt, 10);
+  const Values tensions =
+      controller.update(example::state(example::center, 0), 0);
+  for (size_t j = 0; j < 4; j++) {
+    EXPECT_DOUBLES_EQUAL(0, Torque(tensions, j, 0), 1e-6);
+  }
+}
+
+/**
+ * Tracking a pose to the right moves the end effector there, and later ticks
+ * re-solve the same graph, warm-started.
+ */
+TEST(CdprPlanarController, track) {
+  const Pose3 goal(Rot3(), Point3(1.6, 0, 1.5));
+  const std::vector<Pose3> pdes(20, goal);
+  CdprPlanarController controller(example::cdpr, pdes, example::dt, 10);
+  const size_t size = controller.graph().size();
+
+  controller.update(example::state(example::center, 0), 0);
+  const int ee = example::cdpr.eeId();
+  const Values &solution = controller.solution();
+  EXPECT(Pose(solution, ee, 9).x() > 1.5);
+  EXPECT(Twist(solution, ee, 1)(3) > 0);
+
+  // The next tick starts where the plan said it would be.
+  const Pose3 next = Pose(solution, ee, 1);
+  const Values tensions = controller.update(example::state(next, 1), 1);
+  EXPECT(tensions.exists(TorqueKey(0, 1)));
+  EXPECT_LONGS_EQUAL(size, controller.graph().size());
+  EXPECT(assert_equal(next, Pose(controller.solution(), ee, 0), 1e-3));
+
+  CHECK_EXCEPTION(controller.update(example::state(next, 0), 0),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanar.cpp
+ * @brief Factors of a planar cable-driven parallel robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/utils/CdprPlanar.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Cost model of cdpr_planar.py.
+const double kSigma = 0.001;
+
+// Selects the out-of-plane coordinates of a pose or twist tangent vector.
+gtsam::Matrix OutOfPlane() {
+  gtsam::Matrix A = gtsam::Matrix::Zero(3, 6);
+  A(0, 0) = A(1, 2) = A(2, 4) = 1;
+  return A;
+}
+}  // namespace
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::kinematicsFactors(
+    const std::vector<int> &ks) const {
+  const auto planar_model = Isotropic::Sigma(3, kSigma);
+  const int i = eeId();
+  NonlinearFactorGraph graph = CdprSpatial::kinematicsFactors(ks);
+  for (int k : ks) {
+    // Constrain out-of-plane motion, linearized at the identity.
+    gtsam::Values zero_pose, zero_twist;
+    InsertPose(&zero_pose, i, k, Pose3());
+    InsertTwist(&zero_twist, i, k, Vector6::Zero());
+    graph.emplace_shared<gtsam::LinearContainerFactor>(
+        gtsam::JacobianFactor(PoseKey(i, k), OutOfPlane(),
+                              gtsam::Vector3::Zero(), planar_model),
+        zero_pose);
+    graph.emplace_shared<gtsam::LinearContainerFactor>(
+        gtsam::JacobianFactor(TwistKey(i, k), OutOfPlane(),
+                              gtsam::Vector3::Zero(), planar_model),
+        zero_twist);
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
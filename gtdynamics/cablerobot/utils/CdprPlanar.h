@@ -0,0 +1,38 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanar.h
+ * @brief Factors of a planar cable-driven parallel robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/utils/CdprSpatial.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CdprPlanar assembles the factors of a planar cable robot, as Cdpr in
+ * cdpr_planar.py: cable j has length JointAngleKey(j), speed JointVelKey(j)
+ * and tension TorqueKey(j), and the end effector moves in the xz-plane.
+ */
+class CdprPlanar : public CdprSpatial {
+ public:
+  explicit CdprPlanar(const CdprParameters &params = CdprParameters())
+      : CdprSpatial(params) {}
+
+  /// Cable length and velocity factors, and xz-plane constraints.
+  gtsam::NonlinearFactorGraph kinematicsFactors(
+      const std::vector<int> &ks) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprSpatial.cpp
+ * @brief Factors of a spatial cable-driven parallel robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/cablerobot/utils/CdprSpatial.h>
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Cost models of cdpr_planar.py, all with sigma 0.001.
+const double kSigma = 0.001;
+}  // namespace
+
+constexpr gtsam::Key CdprSpatial::kDtKey;
+
+/* ************************************************************************* */
+CdprParameters CdprParameters::Spatial8() {
+  CdprParameters params;
+  params.a_locs.clear();
+  params.b_locs.clear();
+  for (double x : {0, 1})
+    for (double y : {0, 1})
+      for (double z : {0, 1}) {
+        params.a_locs.emplace_back(3 * x, 3 * y, 3 * z);
+        const double bx = z ? x : 1 - x, by = z ? 1 - y : y;
+        params.b_locs.emplace_back(0.3 * bx - 0.15, 0.3 * by - 0.15,
+                                   0.3 * z - 0.15);
+      }
+  params.inertia = gtsam::I_3x3 * params.mass * 0.3 * 0.3 / 6;
+  params.gravity = gtsam::Vector3(0, 0, -9.81);
+  return params;
+}
+
+/* ************************************************************************* */
+CdprSpatial::CdprSpatial(const CdprParameters &params)
+    : params_(params),
+      ee_(boost::make_shared<Link>(1, "ee", params.mass, params.inertia,
+                                   Pose3(), Pose3())) {
+  if (params_.a_locs.size() != params_.b_locs.size()) {
+    throw std::invalid_argument(
+        "CdprSpatial: need both mounting locations of every cable");
+  }
+  // The factors are only used for their math, so keys and noise are moot.
+  for (size_t j = 0; j < numCables(); j++) {
+    tension_factors_.emplace_back(TorqueKey(j), PoseKey(eeId()),
+                                  WrenchKey(eeId(), j),
+                                  gtsam::noiseModel::Unit::Create(6),
+                                  params_.a_locs[j], params_.b_locs[j]);
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::kinematicsFactors(
+    const std::vector<int> &ks) const {
+  const auto length_model = Isotropic::Sigma(1, kSigma);
+  const int i = eeId();
+  NonlinearFactorGraph graph;
+  for (int k : ks) {
+    for (size_t j = 0; j < numCables(); j++) {
+      graph.emplace_shared<CableLengthFactor>(
+          JointAngleKey(j, k), PoseKey(i, k), length_model, params_.a_locs[j],
+          params_.b_locs[j]);
+      graph.emplace_shared<CableVelocityFactor>(
+          JointVelKey(j, k), PoseKey(i, k), TwistKey(i, k), length_model,
+          params_.a_locs[j], params_.b_locs[j]);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::dynamicsFactors(
+    const std::vector<int> &ks) const {
+  const auto wrench_model = Isotropic::Sigma(6, kSigma);
+  const int i = eeId();
+  NonlinearFactorGraph graph;
+  for (int k : ks) {
+    std::vector<DynamicsSymbol> wrench_keys;
+    for (size_t j = 0; j < numCables(); j++) {
+      wrench_keys.push_back(WrenchKey(i, j, k));
+    }
+    graph.add(WrenchFactor(wrench_model, ee_, wrench_keys, k,
+                           params_.gravity));
+    for (size_t j = 0; j < numCables(); j++) {
+      graph.emplace_shared<CableTensionFactor>(
+          TorqueKey(j, k), PoseKey(i, k), WrenchKey(i, j, k), wrench_model,
+          params_.a_locs[j], params_.b_locs[j]);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::collocationFactors(const std::vector<int> &ks,
+                                                    double dt) const {
+  const auto model = Isotropic::Sigma(6, kSigma);
+  const int i = eeId();
+  NonlinearFactorGraph graph;
+  for (int k : ks) {
+    graph.emplace_shared<EulerPoseCollocationFactor>(
+        PoseKey(i, k), PoseKey(i, k + 1), TwistKey(i, k), kDtKey, model);
+    graph.emplace_shared<EulerTwistCollocationFactor>(
+        TwistKey(i, k), TwistKey(i, k + 1), TwistAccelKey(i, k), kDtKey,
+        model);
+  }
+  graph.addPrior<double>(kDtKey, dt, Isotropic::Sigma(1, kSigma));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::allFactors(int N, double dt) const {
+  std::vector<int> ks, ks_collocation;
+  for (int k = 0; k < N; k++) {
+    ks.push_back(k);
+    if (k + 1 < N) ks_collocation.push_back(k);
+  }
+  NonlinearFactorGraph graph = kinematicsFactors(ks);
+  graph.push_back(dynamicsFactors(ks));
+  graph.push_back(collocationFactors(ks_collocation, dt));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::priorsIk(int k, const Pose3 &pose,
+                                          const Vector6 &twist) const {
+  NonlinearFactorGraph graph;
+  graph.addPrior(PoseKey(eeId(), k), pose, Isotropic::Sigma(6, kSigma));
+  graph.addPrior<Vector6>(TwistKey(eeId(), k), twist,
+                          Isotropic::Sigma(6, kSigma));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprSpatial::priorsId(
+    int k, const std::vector<double> &tensions) const {
+  NonlinearFactorGraph graph;
+  for (size_t j = 0; j < tensions.size(); j++) {
+    graph.addPrior<double>(TorqueKey(j, k), tensions[j],
+                           Isotropic::Sigma(1, kSigma));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Matrix CdprSpatial::wrenchMatrix(const Pose3 &wTx) const {
+  Matrix W(6, numCables());
+  for (size_t j = 0; j < numCables(); j++) {
+    W.col(j) = tension_factors_[j].computeWrench(1.0, wTx);
+  }
+  return W;
+}
+
+/* ************************************************************************* */
+Vector6 CdprSpatial::requiredWrench(const Pose3 &wTx, const Vector6 &twist,
+                                    const Vector6 &twist_accel) const {
+  // Wrench balance: cables + Coriolis - G * accel + gravity = 0.
+  const gtsam::Matrix6 G = ee_->inertiaMatrix();
+  return G * twist_accel - Coriolis(G, twist) -
+         GravityWrench(params_.gravity, params_.mass, wTx);
+}
+
+}  // namespace gtdynamics
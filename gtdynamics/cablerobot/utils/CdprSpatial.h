@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprSpatial.h
+ * @brief Factors of a spatial cable-driven parallel robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Geometry and inertia of a cable robot, as CdprParams in cdpr_planar.py.
+struct CdprParameters {
+  /// Cable mounting locations on the frame, in world coordinates.
+  std::vector<gtsam::Point3> a_locs{{3, 0, 0}, {3, 0, 3}, {0, 0, 3}, {0, 0, 0}};
+  /// Cable mounting locations on the end effector, in its frame.
+  std::vector<gtsam::Point3> b_locs{
+      {0.15, 0, -0.15}, {0.15, 0, 0.15}, {-0.15, 0, 0.15}, {-0.15, 0, -0.15}};
+  double mass = 1.0;
+  gtsam::Matrix3 inertia = gtsam::I_3x3;
+  gtsam::Vector3 gravity = gtsam::Vector3::Zero();
+
+  /**
+   * An 8-cable spatial robot under gravity: a 0.3 m cubic end effector in a
+   * 3 m cubic frame, with a cable from every corner of the frame to a corner
+   * of the end effector at the same height. The bottom cables cross in x
+   * and the top ones in y, as cables to the matching corners cannot resist
+   * every wrench.
+   */
+  static CdprParameters Spatial8();
+};
+
+/**
+ * CdprSpatial assembles the factors of a cable robot moving in 3D: cable j
+ * has length JointAngleKey(j), speed JointVelKey(j) and tension
+ * TorqueKey(j), and the end effector is a free rigid body. The cables only
+ * pull, see CableTensionDistribution for tensions at the control rate.
+ */
+class CdprSpatial {
+ public:
+  /// Key of the time step duration in the collocation factors.
+  static constexpr gtsam::Key kDtKey = 0;
+
+  explicit CdprSpatial(
+      const CdprParameters &params = CdprParameters::Spatial8());
+  virtual ~CdprSpatial() {}
+
+  const CdprParameters &params() const { return params_; }
+
+  /// Number of cables.
+  size_t numCables() const { return params_.a_locs.size(); }
+
+  /// The end effector.
+  const LinkSharedPtr &eeLink() const { return ee_; }
+
+  /// Id of the end effector link.
+  int eeId() const { return ee_->id(); }
+
+  /// Cable length and velocity factors.
+  virtual gtsam::NonlinearFactorGraph kinematicsFactors(
+      const std::vector<int> &ks) const;
+
+  /// Wrench balance of the end effector and cable tension factors.
+  gtsam::NonlinearFactorGraph dynamicsFactors(const std::vector<int> &ks) const;
+
+  /// Euler collocation from every step in ks to the next, and a dt prior.
+  gtsam::NonlinearFactorGraph collocationFactors(const std::vector<int> &ks,
+                                                 double dt) const;
+
+  /// All factors of N steps, except priors.
+  gtsam::NonlinearFactorGraph allFactors(int N, double dt) const;
+
+  /// Priors on the end effector pose and twist at step k.
+  gtsam::NonlinearFactorGraph priorsIk(int k, const gtsam::Pose3 &pose,
+                                       const gtsam::Vector6 &twist) const;
+
+  /// Priors on the cable tensions at step k.
+  gtsam::NonlinearFactorGraph priorsId(
+      int k, const std::vector<double> &tensions) const;
+
+  /**
+   * Wrench matrix at an end-effector pose: column j is the wrench on the end
+   * effector, in its frame, of a unit tension in cable j.
+   */
+  gtsam::Matrix wrenchMatrix(const gtsam::Pose3 &wTx) const;
+
+  /**
+   * Total wrench the cables have to apply, in the end-effector frame, for
+   * the end effector to move with the given twist acceleration, as in the
+   * wrench balance of dynamicsFactors.
+   */
+  gtsam::Vector6 requiredWrench(const gtsam::Pose3 &wTx,
+                                const gtsam::Vector6 &twist,
+                                const gtsam::Vector6 &twist_accel) const;
+
+ protected:
+  CdprParameters params_;
+  LinkSharedPtr ee_;
+  std::vector<CableTensionFactor> tension_factors_;  // for their math only
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArticulatedBodyForwardDynamics.cpp
+ * @brief O(n) articulated-body forward dynamics for tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+// Screw axes with a smaller joint-space inertia are treated as rigid joints.
+static constexpr double kRigidJointTolerance = 1e-12;
+
+/* ************************************************************************* */
+ArticulatedBodyForwardDynamics::ArticulatedBodyForwardDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : gravity_(gravity) {
+  if (!tree_.build(robot)) {
+    throw std::invalid_argument(
+        "ArticulatedBodyForwardDynamics: robot is not a kinematic tree, use "
+        "DynamicsGraph::linearSolveFD instead");
+  }
+  for (auto &&link : tree_.links) inertias_.push_back(link->inertiaMatrix());
+
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  X_.resize(num_links, gtsam::I_6x6);
+  IA_.resize(num_links, gtsam::Z_6x6);
+  c_.resize(num_links, gtsam::Z_6x1);
+  pA_.resize(num_links, gtsam::Z_6x1);
+  U_.resize(num_links, gtsam::Z_6x1);
+  D_.resize(num_links, 0.0);
+  joint_accels_ = Vector::Zero(num_joints);
+  twist_accels_.resize(num_links, gtsam::Z_6x1);
+  parent_wrenches_.resize(num_joints, gtsam::Z_6x1);
+  child_wrenches_.resize(num_joints, gtsam::Z_6x1);
+}
+
+/* ************************************************************************* */
+bool ArticulatedBodyForwardDynamics::IsTree(const Robot &robot) {
+  KinematicTree tree;
+  return tree.build(robot);
+}
+
+/* ************************************************************************* */
+void ArticulatedBodyForwardDynamics::solve(
+    const std::vector<Pose3> &poses, const std::vector<Vector6> &twists,
+    const Vector &joint_vels, const Vector &torques,
+    const std::vector<Vector6> *external_wrenches) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  if (poses.size() != num_links || twists.size() != num_links ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(torques.size()) != num_joints ||
+      (external_wrenches && external_wrenches->size() != num_links)) {
+    throw std::invalid_argument(
+        "ArticulatedBodyForwardDynamics: input sizes do not match the robot");
+  }
+
+  // Initialize articulated inertias and bias wrenches with the rigid bodies:
+  // F = G * A - ad(V)^T * G * V - [0; m * R^T * g] - F_ext.
+  for (size_t i = 0; i < num_links; i++) {
+    const Matrix6 &G = inertias_[i];
+    IA_[i] = G;
+    pA_[i] = -Pose3::adjointMap(twists[i]).transpose() * G * twists[i];
+    if (gravity_) {
+      pA_[i].tail<3>() -= poses[i].rotation().transpose() * (*gravity_) *
+                           tree_.links[i]->mass();
+    }
+    if (external_wrenches) pA_[i] -= (*external_wrenches)[i];
+  }
+
+  // Velocity-dependent terms: A_b = X * A_a + S * qddot + c.
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    X_[b] = (poses[b].inverse() * poses[a]).AdjointMap();
+    c_[b] = Pose3::adjointMap(twists[b]) * tree_.screw[b] * joint_vels(j);
+  }
+
+  // Backward pass: accumulate articulated inertias from leaves to root.
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const Vector6 &S = tree_.screw[b];
+    Matrix6 Ia = IA_[b];
+    Vector6 pa = pA_[b] + IA_[b] * c_[b];
+    U_[b] = IA_[b] * S;
+    D_[b] = S.dot(U_[b]);
+    if (D_[b] > kRigidJointTolerance) {
+      Ia -= U_[b] * U_[b].transpose() / D_[b];
+      pa = pA_[b] + Ia * c_[b] +
+           U_[b] * (torques(j) - S.dot(pA_[b])) / D_[b];
+    }
+    IA_[a] += X_[b].transpose() * Ia * X_[b];
+    pA_[a] += X_[b].transpose() * pa;
+  }
+
+  // Forward pass: propagate accelerations from the root.
+  const int root = tree_.root;
+  if (tree_.root_fixed) {
+    twist_accels_[root].setZero();
+  } else {
+    // Floating base: no wrench acts on the root through a joint.
+    twist_accels_[root] = -IA_[root].ldlt().solve(pA_[root]);
+  }
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const Vector6 &S = tree_.screw[b];
+    const Vector6 A_prime = X_[b] * twist_accels_[a] + c_[b];
+    double qddot = 0.0;
+    if (D_[b] > kRigidJointTolerance) {
+      qddot = (torques(j) - S.dot(pA_[b]) - U_[b].dot(A_prime)) / D_[b];
+    }
+    joint_accels_(j) = qddot;
+    twist_accels_[b] = A_prime + S * qddot;
+
+    // Wrench on link b through the joint, and its equivalent on link a.
+    const Vector6 F_b = IA_[b] * twist_accels_[b] + pA_[b];
+    const Vector6 F_a = -X_[b].transpose() * F_b;
+    if (tree_.forward[b]) {
+      child_wrenches_[j] = F_b;
+      parent_wrenches_[j] = F_a;
+    } else {
+      parent_wrenches_[j] = F_b;
+      child_wrenches_[j] = F_a;
+    }
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values ArticulatedBodyForwardDynamics::solve(
+    const int t, const gtsam::Values &known_values) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  std::vector<Pose3> poses(num_links);
+  std::vector<Vector6> twists(num_links);
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int i = tree_.links[idx]->id();
+    poses[idx] = Pose(known_values, i, t);
+    twists[idx] = Twist(known_values, i, t);
+  }
+  Vector joint_vels(num_joints), torques(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = tree_.joints[idx]->id();
+    joint_vels(idx) = JointVel(known_values, j, t);
+    torques(idx) = Torque(known_values, j, t);
+  }
+
+  solve(poses, twists, joint_vels, torques);
+
+  gtsam::Values values = known_values;
+  try {
+    for (size_t idx = 0; idx < num_joints; idx++) {
+      const auto &joint = tree_.joints[idx];
+      const int j = joint->id();
+      InsertJointAccel(&values, j, t, joint_accels_(idx));
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   parent_wrenches_[idx]);
+      InsertWrench(&values, joint->child()->id(), j, t, child_wrenches_[idx]);
+    }
+    for (size_t idx = 0; idx < num_links; idx++) {
+      InsertTwistAccel(&values, tree_.links[idx]->id(), t, twist_accels_[idx]);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    ReportDiagnostic("key already exists:", e.key());
+    throw std::invalid_argument(
+        "ArticulatedBodyForwardDynamics: known_values should contain no "
+        "accelerations or wrenches");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
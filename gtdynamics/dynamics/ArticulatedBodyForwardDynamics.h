@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArticulatedBodyForwardDynamics.h
+ * @brief O(n) articulated-body forward dynamics for tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ArticulatedBodyForwardDynamics implements Featherstone's recursive
+ * articulated-body algorithm in the twist/wrench conventions used by the
+ * dynamics factors: twists and wrenches are expressed in link CoM frames, and
+ * each joint relates its links through Joint::screwAxis and the relative pose
+ * of the two links.
+ *
+ * The results have the same semantics as DynamicsGraph::linearSolveFD, but the
+ * cost is linear in the number of links. Only kinematic trees are supported;
+ * the constructor throws for closed chains, in which case the factor graph
+ * solver should be used instead.
+ *
+ * The tree is rooted at the fixed link if there is one, otherwise at a link
+ * that is not the child of any joint, whose twist acceleration is then solved
+ * for as a floating base.
+ */
+class ArticulatedBodyForwardDynamics {
+ private:
+  KinematicTree tree_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  std::vector<gtsam::Matrix6> inertias_;
+
+  /// Per-solve buffers, indexed by link.
+  std::vector<gtsam::Matrix6> X_, IA_;
+  std::vector<gtsam::Vector6> c_, pA_, U_;
+  std::vector<double> D_;
+
+  /// Results of the last solve.
+  gtsam::Vector joint_accels_;
+  std::vector<gtsam::Vector6> twist_accels_, parent_wrenches_,
+      child_wrenches_;
+
+ public:
+  /**
+   * Constructor, extracts the tree topology of the robot.
+   * @param robot    the robot, must be a kinematic tree
+   * @param gravity  gravity in world frame
+   */
+  explicit ArticulatedBodyForwardDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return true if the robot is a connected tree with at most one fixed link.
+  static bool IsTree(const Robot &robot);
+
+  /// Number of joints in the robot.
+  size_t numJoints() const { return tree_.joints.size(); }
+
+  /// Number of links in the robot.
+  size_t numLinks() const { return tree_.links.size(); }
+
+  /// Index of the joint with the given id in the vectors used by solve.
+  int jointIndex(uint16_t id) const { return tree_.joint_index.at(id); }
+
+  /// Index of the link with the given id in the vectors used by solve.
+  int linkIndex(uint16_t id) const { return tree_.link_index.at(id); }
+
+  /// Index of the root link of the tree.
+  int rootIndex() const { return tree_.root; }
+
+  /// Whether the root link is fixed, otherwise it is a floating base.
+  bool rootFixed() const { return tree_.root_fixed; }
+
+  /**
+   * Solve forward dynamics from plain arrays, without touching gtsam::Values.
+   * Does not allocate, so it can run in a real-time loop, see RealTime.h.
+   *
+   * @param poses      CoM pose of every link, in Robot::links() order
+   * @param twists     twist of every link, in Robot::links() order
+   * @param joint_vels joint velocities, in Robot::joints() order
+   * @param torques    joint torques, in Robot::joints() order
+   * @param external_wrenches optional wrench applied to every link, e.g. by
+   * contacts, in its CoM frame and in Robot::links() order
+   */
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels, const gtsam::Vector &torques,
+             const std::vector<gtsam::Vector6> *external_wrenches = nullptr);
+
+  /**
+   * Solve forward dynamics, Values version with the same semantics as
+   * DynamicsGraph::linearSolveFD.
+   *
+   * @param t            time step
+   * @param known_values link poses and twists, joint velocities and torques
+   * @return known_values augmented with joint accelerations, wrenches and
+   * twist accelerations
+   */
+  gtsam::Values solve(const int t, const gtsam::Values &known_values);
+
+  /// Joint accelerations of the last solve, in joint order.
+  const gtsam::Vector &jointAccels() const { return joint_accels_; }
+
+  /// Twist accelerations of the last solve, in link order.
+  const std::vector<gtsam::Vector6> &twistAccels() const {
+    return twist_accels_;
+  }
+
+  /// Wrenches on the parent link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &parentWrenches() const {
+    return parent_wrenches_;
+  }
+
+  /// Wrenches on the child link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &childWrenches() const {
+    return child_wrenches_;
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,168 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.cpp
+ * @brief Lockstep simulation of a batch of environments of the same robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+
+/* ************************************************************************* */
+BatchSimulator::BatchSimulator(const Robot &robot, size_t num_envs,
+                               const boost::optional<gtsam::Vector3> &gravity,
+                               size_t num_threads,
+                               IntegrationScheme integrator)
+    : robot_(robot),
+      num_envs_(num_envs),
+      fk_(robot),
+      stage_fk_(robot),
+      integrator_(integrator),
+      t_(0) {
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  num_threads_ = std::min(std::max<size_t>(num_threads, 1),
+                          std::max<size_t>(num_envs, 1));
+  for (size_t w = 0; w < num_threads_; w++)
+    workers_.emplace_back(robot, gravity);
+
+  const size_t num_joints = robot_.numJoints();
+  initial_q_.setZero(num_envs, num_joints);
+  initial_v_.setZero(num_envs, num_joints);
+  a_.setZero(num_envs, num_joints);
+  torques_.setZero(num_envs, num_joints);
+  reset();
+}
+
+/* ************************************************************************* */
+void BatchSimulator::setInitialState(const Matrix &joint_angles,
+                                     const Matrix &joint_vels) {
+  const size_t num_joints = robot_.numJoints();
+  if (size_t(joint_angles.rows()) != num_envs_ ||
+      size_t(joint_angles.cols()) != num_joints ||
+      size_t(joint_vels.rows()) != num_envs_ ||
+      size_t(joint_vels.cols()) != num_joints) {
+    throw std::invalid_argument(
+        "BatchSimulator: initial state must be numEnvs x numJoints");
+  }
+  initial_q_ = joint_angles;
+  initial_v_ = joint_vels;
+  reset();
+}
+
+/* ************************************************************************* */
+void BatchSimulator::reset() {
+  t_ = 0;
+  q_ = initial_q_;
+  v_ = initial_v_;
+}
+
+/* ************************************************************************* */
+void BatchSimulator::setJointEfforts(bool passive, bool limits) {
+  if (passive || limits) {
+    effort_ = JointEffortModel(robot_, passive, limits);
+  } else {
+    effort_ = boost::none;
+  }
+}
+
+/* ************************************************************************* */
+void BatchSimulator::solve(const Matrix &q, const Matrix &v,
+                           BatchForwardKinematics *fk, Matrix *a) {
+  fk->compute(q, v);
+  a->resize(num_envs_, robot_.numJoints());
+  if (effort_) applied_ = effort_->torques(q, v, torques_);
+  const Matrix &torques = effort_ ? applied_ : torques_;
+
+  // Each worker solves a contiguous range of environments with its own solver.
+  const auto &links = robot_.links();
+  const size_t chunk = (num_envs_ + num_threads_ - 1) / num_threads_;
+  ParallelFor(num_threads_, num_threads_, [&](size_t w) {
+    Worker &worker = workers_[w];
+    const size_t end = std::min(num_envs_, (w + 1) * chunk);
+    for (size_t n = w * chunk; n < end; n++) {
+      for (size_t i = 0; i < links.size(); i++) {
+        worker.poses[i] = fk->pose(n, links[i]->id());
+        worker.twists[i] = fk->twist(n, links[i]->id());
+      }
+      worker.joint_vels = v.row(n).transpose();
+      worker.torques = torques.row(n).transpose();
+      worker.fd.solve(worker.poses, worker.twists, worker.joint_vels,
+                      worker.torques);
+      a->row(n) = worker.fd.jointAccels().transpose();
+    }
+  });
+}
+
+/* ************************************************************************* */
+void BatchSimulator::forwardDynamics(const Matrix &torques) {
+  if (size_t(torques.rows()) != num_envs_ ||
+      size_t(torques.cols()) != robot_.numJoints()) {
+    throw std::invalid_argument(
+        "BatchSimulator: torques must be numEnvs x numJoints");
+  }
+  torques_ = torques;
+  solve(q_, v_, &fk_, &a_);
+}
+
+/* ************************************************************************* */
+void BatchSimulator::integration(double dt) {
+  // Intermediate states keep fk_ at the state of forwardDynamics.
+  Integrate(
+      integrator_,
+      [this](const Matrix &q, const Matrix &v) {
+        Matrix a;
+        solve(q, v, &stage_fk_, &a);
+        return a;
+      },
+      dt, a_, &q_, &v_);
+  if (effort_) effort_->enforceLimits(&q_, &v_);
+}
+
+/* ************************************************************************* */
+void BatchSimulator::step(const Matrix &torques, double dt) {
+  forwardDynamics(torques);
+  integration(dt);
+  t_++;
+}
+
+/* ************************************************************************* */
+std::vector<TrajectoryBuffer> BatchSimulator::simulate(
+    const std::vector<Matrix> &torques_seq, double dt) {
+  const size_t num_steps = torques_seq.size();
+  std::vector<TrajectoryBuffer> trajectories(
+      num_envs_, TrajectoryBuffer(robot_, num_steps));
+  const auto &links = robot_.links();
+  for (size_t k = 0; k < num_steps; k++) {
+    forwardDynamics(torques_seq[k]);
+    for (size_t n = 0; n < num_envs_; n++) {
+      TrajectoryBuffer &trajectory = trajectories[n];
+      trajectory.jointAngles().row(k) = q_.row(n);
+      trajectory.jointVels().row(k) = v_.row(n);
+      trajectory.jointAccels().row(k) = a_.row(n);
+      trajectory.torques().row(k) = effort_ ? applied_.row(n) : torques_.row(n);
+      for (auto &&link : links) {
+        trajectory.pose(link->id(), k) = fk_.pose(n, link->id());
+        trajectory.twist(link->id(), k) = fk_.twist(n, link->id());
+      }
+    }
+    integration(dt);
+    t_++;
+  }
+  return trajectories;
+}
+
+}  // namespace gtdynamics
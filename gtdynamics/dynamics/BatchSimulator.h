@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.h
+ * @brief Lockstep simulation of a batch of environments of the same robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/JointEffortModel.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * BatchSimulator steps N copies of a robot in lockstep, e.g. for Monte Carlo
+ * rollouts with perturbed initial states or torques.
+ *
+ * Every step has the same semantics as Simulator::step with the
+ * ArticulatedBody backend and the same integration scheme, but the state of
+ * all environments is held in N x numJoints matrices, with columns in
+ * Robot::joints() order, and never goes through gtsam::Values. The model is
+ * precomputed once: forward kinematics of the whole batch is a single
+ * BatchForwardKinematics call, the articulated-body solves are spread over
+ * threads that each own a solver, and integration is done on whole matrices.
+ *
+ * The robot must be a kinematic tree with a fixed link, which stays at its
+ * fixed pose.
+ */
+class BatchSimulator {
+ private:
+  /// Solver and scratch space owned by one thread.
+  struct Worker {
+    ArticulatedBodyForwardDynamics fd;
+    std::vector<gtsam::Pose3> poses;
+    std::vector<gtsam::Vector6> twists;
+    gtsam::Vector joint_vels, torques;
+    Worker(const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+        : fd(robot, gravity),
+          poses(fd.numLinks()),
+          twists(fd.numLinks()),
+          joint_vels(fd.numJoints()),
+          torques(fd.numJoints()) {}
+  };
+
+  Robot robot_;
+  size_t num_envs_, num_threads_;
+  BatchForwardKinematics fk_, stage_fk_;
+  std::vector<Worker> workers_;
+  IntegrationScheme integrator_;
+  int t_;
+
+  gtsam::Matrix initial_q_, initial_v_;
+  gtsam::Matrix q_, v_, a_, torques_;
+
+  /// Passive torques and hard limits, if enabled, and the net torques of the
+  /// last solve.
+  boost::optional<JointEffortModel> effort_;
+  gtsam::Matrix applied_;
+
+  /// Accelerations of a batch of states, with forward kinematics in fk.
+  void solve(const gtsam::Matrix &q, const gtsam::Matrix &v,
+             BatchForwardKinematics *fk, gtsam::Matrix *a);
+
+ public:
+  /**
+   * Constructor, with zero initial state.
+   * @param robot       the robot, a kinematic tree with a fixed link
+   * @param num_envs    number of environments N
+   * @param gravity     gravity vector
+   * @param num_threads number of threads, 0 for hardware concurrency
+   * @param integrator  integration scheme
+   */
+  BatchSimulator(
+      const Robot &robot, size_t num_envs,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      size_t num_threads = 1,
+      IntegrationScheme integrator = IntegrationScheme::ExplicitTaylor);
+
+  /// Number of environments.
+  size_t numEnvs() const { return num_envs_; }
+
+  /// Number of joints.
+  size_t numJoints() const { return robot_.numJoints(); }
+
+  /// Integration scheme.
+  IntegrationScheme integrator() const { return integrator_; }
+
+  /**
+   * Apply the JointParams of the robot in every subsequent step, as
+   * Simulator::setJointEfforts. Trajectories from simulate then hold the net
+   * torques applied to the joints.
+   * @param passive whether to add damping and spring torques
+   * @param limits  whether to enforce torque, angle and velocity limits
+   */
+  void setJointEfforts(bool passive = true, bool limits = true);
+
+  /// Number of steps taken since the last reset.
+  int t() const { return t_; }
+
+  /**
+   * Set the initial state of all environments and reset to it.
+   * @param joint_angles N x numJoints initial joint angles
+   * @param joint_vels   N x numJoints initial joint velocities
+   */
+  void setInitialState(const gtsam::Matrix &joint_angles,
+                       const gtsam::Matrix &joint_vels);
+
+  /// Reset all environments to the initial state.
+  void reset();
+
+  /**
+   * Perform forward dynamics to calculate accelerations of all environments.
+   * @param torques N x numJoints joint torques
+   */
+  void forwardDynamics(const gtsam::Matrix &torques);
+
+  /**
+   * Integrate all environments for one time step, with the torques of the
+   * last forwardDynamics call.
+   * @param dt duration of the time step
+   */
+  void integration(double dt);
+
+  /**
+   * Simulate all environments for one time step.
+   * @param torques N x numJoints joint torques
+   * @param dt      duration of the time step
+   */
+  void step(const gtsam::Matrix &torques, double dt);
+
+  /**
+   * Simulate for a sequence of torques and record the trajectories.
+   *
+   * Row k of the trajectory of environment n holds the state at step k, i.e.
+   * the joint angles and velocities before integration together with the
+   * torques, accelerations, and link poses and twists of that step, as in
+   * Simulator::getValues after step k.
+   *
+   * @param torques_seq one N x numJoints torque matrix per step
+   * @param dt          duration of the time steps
+   * @return one trajectory per environment
+   */
+  std::vector<TrajectoryBuffer> simulate(
+      const std::vector<gtsam::Matrix> &torques_seq, double dt);
+
+  /// Joint angles of all environments, N x numJoints.
+  const gtsam::Matrix &jointAngles() const { return q_; }
+
+  /// Joint velocities of all environments, N x numJoints.
+  const gtsam::Matrix &jointVels() const { return v_; }
+
+  /// Joint accelerations of the last forward dynamics, N x numJoints.
+  const gtsam::Matrix &jointAccels() const { return a_; }
+
+  /// Link poses and twists of the last forward dynamics.
+  const BatchForwardKinematics &forwardKinematics() const { return fk_; }
+};
+
+}  // namespace gtdynamics
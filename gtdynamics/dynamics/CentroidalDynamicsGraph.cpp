@@ -0,0 +1,426 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalDynamicsGraph.cpp
+ * @brief Single-rigid-body dynamics graph of a legged robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/CentroidalDynamicsGraph.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/ContactDynamicsBlockFactor.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/universal_robot/SubtreeInertiaCache.h>
+#include <gtdynamics/utils/GraphArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/expressions.h>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::Double_;
+using gtsam::ExpressionFactor;
+using gtsam::Matrix3;
+using gtsam::Matrix6;
+using gtsam::NonlinearFactorGraph;
+using gtsam::OptionalJacobian;
+using gtsam::Pose3;
+using gtsam::Pose3_;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+using gtsam::Vector6_;
+
+namespace gtdynamics {
+
+namespace {
+
+// Jacobian of ad_xi^T y with respect to xi, for y = (moment, force).
+Matrix6 AdjointTransposeJacobian(const Vector6 &y) {
+  const Matrix3 m = gtsam::skewSymmetric(y.head<3>()),
+                f = gtsam::skewSymmetric(y.tail<3>());
+  Matrix6 H;
+  H << m, f, f, Matrix3::Zero();
+  return H;
+}
+
+// Coriolis wrench ad_V^T G V, for any spatial inertia G; Coriolis in
+// Dynamics.h assumes a diagonal one.
+Vector6 CoriolisWrench(const Matrix6 &inertia, const Vector6 &twist,
+                       OptionalJacobian<6, 6> H_twist) {
+  const Vector6 momentum = inertia * twist;
+  if (H_twist) {
+    *H_twist = AdjointTransposeJacobian(momentum) +
+               Pose3::adjointMap(twist).transpose() * inertia;
+  }
+  return Pose3::adjointTranspose(twist, momentum);
+}
+
+// Wrench on the foot, in its COM frame, as a wrench on the body.
+Vector6 TransmittedWrench(const Pose3 &wTbody, const Pose3 &wTfoot,
+                          const Vector6 &wrench,
+                          OptionalJacobian<6, 6> H_body,
+                          OptionalJacobian<6, 6> H_foot,
+                          OptionalJacobian<6, 6> H_wrench) {
+  gtsam::Matrix6 H_X_foot, H_X_body;
+  const Pose3 fTb = wTfoot.between(wTbody, H_foot ? &H_X_foot : nullptr,
+                                   H_body ? &H_X_body : nullptr);
+  const Matrix6 AdT = fTb.AdjointMap().transpose();
+  const Vector6 transmitted = AdT * wrench;
+  // Ad(fTb Exp(xi))^T = (I + ad_xi^T) Ad(fTb)^T to first order.
+  if (H_body || H_foot) {
+    const Matrix6 H_X = AdjointTransposeJacobian(transmitted);
+    if (H_body) *H_body = H_X * H_X_body;
+    if (H_foot) *H_foot = H_X * H_X_foot;
+  }
+  if (H_wrench) *H_wrench = AdT;
+  return transmitted;
+}
+
+// Change of a twist (or pose) over a step, from its rates at both ends.
+Vector6_ Increment(const Vector6_ &rate0, const Vector6_ &rate1,
+                   const Double_ &dt, CollocationScheme collocation) {
+  const bool euler = collocation == CollocationScheme::Euler;
+  return Vector6_(
+      [euler](const Vector6 &r0, const Vector6 &r1, const double &dt,
+              OptionalJacobian<6, 6> H_r0, OptionalJacobian<6, 6> H_r1,
+              OptionalJacobian<6, 1> H_dt) {
+        const Vector6 rate = euler ? r0 : Vector6(0.5 * (r0 + r1));
+        if (H_r0) *H_r0 = (euler ? 1.0 : 0.5) * dt * gtsam::I_6x6;
+        if (H_r1) *H_r1 = (euler ? 0.0 : 0.5) * dt * gtsam::I_6x6;
+        if (H_dt) *H_dt = rate;
+        return Vector6(dt * rate);
+      },
+      rate0, rate1, dt);
+}
+
+// Error between a pose and the previous pose moved by its increment, as in
+// EulerPoseCollocationFactor and TrapezoidalPoseCollocationFactor.
+Vector6_ PoseCollocation(const Pose3_ &pose0, const Pose3_ &pose1,
+                         const Vector6_ &increment) {
+  return Vector6_(
+      [](const Pose3 &pose0, const Pose3 &pose1, const Vector6 &increment,
+         OptionalJacobian<6, 6> H_pose0, OptionalJacobian<6, 6> H_pose1,
+         OptionalJacobian<6, 6> H_increment) {
+        Matrix6 H_predicted_pose0, H_predicted_increment, H_predicted;
+        const Pose3 predicted =
+            predictPose(pose0, increment, H_predicted_pose0,
+                        H_predicted_increment);
+        const Vector6 error = pose1.logmap(predicted, H_pose1, H_predicted);
+        if (H_pose0) *H_pose0 = H_predicted * H_predicted_pose0;
+        if (H_increment) *H_increment = H_predicted * H_predicted_increment;
+        return error;
+      },
+      pose0, pose1, increment);
+}
+
+// Gravity, defaulting to the one of DynamicsGraph.
+Vector3 Gravity(const boost::optional<Vector3> &gravity) {
+  return gravity ? *gravity : Vector3(0, 0, -9.8);
+}
+
+// Sigma of the first dimension of a noise model, 1 if it has none.
+double FirstSigma(const gtsam::SharedNoiseModel &model) {
+  auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  return diagonal ? diagonal->sigma(0) : 1.0;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+CentroidalDynamicsGraph::CentroidalDynamicsGraph(
+    const Robot &robot, const OptimizerSetting &opt,
+    const boost::optional<gtsam::Vector3> &gravity, double reach,
+    const std::vector<LinkSharedPtr> &feet)
+    : DynamicsGraph(opt, gravity), feet_(feet), reach_(reach) {
+  // The base is the link with the most joints.
+  for (auto &&link : robot.links()) {
+    if (!base_ || link->numJoints() > base_->numJoints()) base_ = link;
+  }
+  if (!base_) {
+    throw std::invalid_argument("CentroidalDynamicsGraph: robot has no links");
+  }
+  if (feet_.empty()) {
+    for (auto &&link : robot.links()) {
+      if (link != base_ && link->numJoints() == 1) feet_.push_back(link);
+    }
+  }
+  if (feet_.empty()) {
+    throw std::invalid_argument("CentroidalDynamicsGraph: robot has no feet");
+  }
+
+  // Center of mass and composite inertia in the rest configuration, from the
+  // composite inertias of the trees of the robot.
+  const SubtreeInertiaCache subtrees(robot);
+  const RobotTopology &topology = subtrees.topology();
+  mass_ = 0;
+  Vector3 moment = Vector3::Zero();
+  for (size_t r = 0; r < subtrees.numLinks(); r++) {
+    if (topology.tree_parent[r] >= 0) continue;
+    const double mass = subtrees.subtreeMass(r);
+    mass_ += mass;
+    moment += mass * topology.links[r]->bMcom().transformFrom(
+                         subtrees.subtreeCom(r));
+  }
+  if (mass_ <= 0) {
+    throw std::invalid_argument("CentroidalDynamicsGraph: robot has no mass");
+  }
+  const Rot3 wRbody = base_->bMcom().rotation();
+  rest_pose_ = Pose3(wRbody, moment / mass_);
+
+  inertia_.setZero();
+  for (size_t r = 0; r < subtrees.numLinks(); r++) {
+    if (topology.tree_parent[r] >= 0) continue;
+    const Matrix6 X =
+        topology.links[r]->bMcom().between(rest_pose_).AdjointMap();
+    inertia_ += X.transpose() * subtrees.compositeInertia(r) * X;
+  }
+
+  body_T_base_ = rest_pose_.between(base_->bMcom());
+  for (auto &&foot : feet_) {
+    body_T_feet_.push_back(rest_pose_.between(foot->bMcom()));
+  }
+
+  const double sigma = FirstSigma(opt.p_cost_model);
+  rotation_model_ = SharedIsotropic(3, sigma);
+  reach_model_ = SharedIsotropic(1, sigma);
+}
+
+/* ************************************************************************* */
+size_t CentroidalDynamicsGraph::footIndex(const LinkSharedPtr &link) const {
+  for (size_t i = 0; i < feet_.size(); i++) {
+    if (feet_[i]->id() == link->id()) return i;
+  }
+  throw std::invalid_argument("CentroidalDynamicsGraph: contact link " +
+                              link->name() + " is not a foot");
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::qFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const Pose3_ wTbody(PoseKey(base_->id(), k));
+  for (size_t i = 0; i < feet_.size(); i++) {
+    const Pose3_ bodyTfoot =
+        gtsam::between(wTbody, Pose3_(PoseKey(feet_[i]->id(), k)));
+
+    // The foot keeps its rest orientation relative to the body.
+    const gtsam::Rot3_ bodyRfoot(
+        [](const Pose3 &pose, OptionalJacobian<3, 6> H) {
+          return pose.rotation(H);
+        },
+        bodyTfoot);
+    graph.push_back(MakeShared<ExpressionFactor<Rot3>>(
+        rotation_model_, body_T_feet_[i].rotation(), bodyRfoot));
+
+    // Distance beyond reach of the foot from its rest position.
+    const gtsam::Point3 rest = body_T_feet_[i].translation();
+    const double reach = reach_;
+    const Double_ beyond(
+        [rest, reach](const Pose3 &pose, OptionalJacobian<1, 6> H) {
+          gtsam::Matrix36 H_t;
+          const Vector3 d = pose.translation(H ? &H_t : nullptr) - rest;
+          const double distance = d.norm();
+          const bool active = distance > reach;
+          if (H) {
+            if (active) {
+              *H = d.transpose() / distance * H_t;
+            } else {
+              H->setZero();
+            }
+          }
+          return active ? distance - reach : 0.0;
+        },
+        bodyTfoot);
+    graph.push_back(
+        MakeShared<ExpressionFactor<double>>(reach_model_, 0.0, beyond));
+  }
+
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      footIndex(cp.link);  // throws if the contact is not on a foot
+      graph.push_back(MakeShared<ContactHeightFactor>(
+          PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point,
+          Gravity(gravity_)));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::vFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      footIndex(cp.link);
+      graph.push_back(MakeShared<ContactKinematicsTwistFactor>(
+          TwistKey(cp.link->id(), k), opt_.cv_cost_model,
+          Pose3(Rot3(), -cp.point)));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::aFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  if (contact_points) {
+    for (auto &&cp : *contact_points) footIndex(cp.link);
+  }
+  return NonlinearFactorGraph();
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::dynamicsFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const Vector3 gravity = Gravity(gravity_);
+  const int b = base_->id();
+  const Pose3_ wTbody(PoseKey(b, k));
+
+  // Newton-Euler equations of the body, as in Link::wrenchConstraint.
+  const Matrix6 inertia = inertia_;
+  const double mass = mass_;
+  Vector6_ balance(
+      [inertia, mass, gravity](
+          const Vector6 &twist, const Vector6 &accel, const Pose3 &wTbody,
+          OptionalJacobian<6, 6> H_twist, OptionalJacobian<6, 6> H_accel,
+          OptionalJacobian<6, 6> H_pose) {
+        if (H_accel) *H_accel = -inertia;
+        return Vector6(CoriolisWrench(inertia, twist, H_twist) -
+                       inertia * accel +
+                       GravityWrench(gravity, mass, wTbody, H_pose));
+      },
+      Vector6_(TwistKey(b, k)), Vector6_(TwistAccelKey(b, k)), wTbody);
+
+  std::vector<ContactDynamicsBlockFactor::Contact> contacts;
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      footIndex(cp.link);
+      const int i = cp.link->id();
+      const auto wrench_key = ContactWrenchKey(i, 0, k);
+      balance = balance + Vector6_(TransmittedWrench, wTbody,
+                                   Pose3_(PoseKey(i, k)),
+                                   Vector6_(wrench_key));
+
+      const Pose3 cTcom(Rot3(), -cp.point);
+      if (opt_.contact_block_factors) {
+        contacts.push_back({PoseKey(i, k), wrench_key, cTcom});
+        continue;
+      }
+      graph.push_back(MakeShared<ContactDynamicsFrictionConeFactor>(
+          PoseKey(i, k), wrench_key, opt_.cfriction_cost_model,
+          mu ? *mu : 1.0, gravity));
+      graph.push_back(MakeShared<ContactDynamicsMomentFactor>(
+          wrench_key, opt_.cm_cost_model, cTcom));
+    }
+  }
+  if (!contacts.empty()) {
+    graph.push_back(MakeShared<ContactDynamicsBlockFactor>(
+        contacts, opt_.cfriction_cost_model, opt_.cm_cost_model,
+        mu ? *mu : 1.0, gravity));
+  }
+  graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+      opt_.fa_cost_model, Vector6::Zero(), balance));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::collocationFactors(
+    const Robot &robot, const int t, const double dt,
+    const CollocationScheme collocation) const {
+  return stepCollocationFactors(t, collocation, Double_(dt));
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::multiPhaseCollocationFactors(
+    const Robot &robot, const int t, const int phase,
+    const CollocationScheme collocation) const {
+  return stepCollocationFactors(t, collocation,
+                                Double_(gtsam::Key(PhaseKey(phase))));
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalDynamicsGraph::stepCollocationFactors(
+    const int t, const CollocationScheme collocation, const Double_ &dt) const {
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    throw std::invalid_argument(
+        "CentroidalDynamicsGraph: HermiteSimpson collocation is not "
+        "supported");
+  }
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const int b = base_->id();
+  const Vector6_ V0(TwistKey(b, t)), V1(TwistKey(b, t + 1));
+  graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+      opt_.pose_col_cost_model, Vector6::Zero(),
+      PoseCollocation(Pose3_(PoseKey(b, t)), Pose3_(PoseKey(b, t + 1)),
+                      Increment(V0, V1, dt, collocation))));
+  graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+      opt_.twist_col_cost_model, Vector6::Zero(),
+      V1 - V0 -
+          Increment(Vector6_(TwistAccelKey(b, t)),
+                    Vector6_(TwistAccelKey(b, t + 1)), dt, collocation)));
+  for (auto &&foot : feet_) {
+    const int i = foot->id();
+    graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+        opt_.pose_col_cost_model, Vector6::Zero(),
+        PoseCollocation(Pose3_(PoseKey(i, t)), Pose3_(PoseKey(i, t + 1)),
+                        Increment(Vector6_(TwistKey(i, t)),
+                                  Vector6_(TwistKey(i, t + 1)), dt,
+                                  collocation))));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values CentroidalDynamicsGraph::initialValues(
+    const int t, const boost::optional<PointOnLinks> &contact_points) const {
+  Values values;
+  const int b = base_->id();
+  InsertPose(&values, b, t, rest_pose_);
+  InsertTwist(&values, b, t, Vector6::Zero());
+  InsertTwistAccel(&values, b, t, Vector6::Zero());
+  for (size_t i = 0; i < feet_.size(); i++) {
+    InsertPose(&values, feet_[i]->id(), t, rest_pose_ * body_T_feet_[i]);
+    InsertTwist(&values, feet_[i]->id(), t, Vector6::Zero());
+  }
+
+  if (contact_points && !contact_points->empty()) {
+    // Every contact carries an equal share of the weight.
+    const Vector3 support =
+        -mass_ * Gravity(gravity_) / contact_points->size();
+    for (auto &&cp : *contact_points) {
+      const Pose3 wTfoot = rest_pose_ * body_T_feet_[footIndex(cp.link)];
+      const Vector3 force = wTfoot.rotation().unrotate(support);
+      Vector6 wrench;
+      wrench << cp.point.cross(force), force;
+      values.insert(ContactWrenchKey(cp.link->id(), 0, t), wrench);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalDynamicsGraph.h
+ * @brief Single-rigid-body dynamics graph of a legged robot, for fast gait
+ * planning.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/expressions.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CentroidalDynamicsGraph builds the dynamics graph of a legged robot as a
+ * single rigid body with the total mass of the robot and its composite
+ * inertia in the rest configuration, driven by the contact wrenches of the
+ * feet. Joints are not modeled; kinematic feasibility is kept by bounding the
+ * distance of every foot from its rest position relative to the body. The
+ * variables of a time step are
+ *  - the pose, twist and twist acceleration of the body, under the keys of
+ *    the base link: its frame is at the center of mass of the whole robot,
+ *    with the orientation of the base,
+ *  - the pose and twist of every foot, and
+ *  - the contact wrench of every foot in contact, in its COM frame.
+ *
+ * Foot poses and contact wrenches have the keys and meaning of DynamicsGraph,
+ * so contact point objectives of Trajectory apply unchanged, and a solution
+ * seeds the full problem; basePose gives the base pose for a body pose.
+ *
+ * Collocation integrates the body pose, twist and the foot poses instead of
+ * joint angles, so that Trajectory::multiPhaseFactorGraph builds centroidal
+ * gait problems over WalkCycle phases. HermiteSimpson is not supported.
+ */
+class CentroidalDynamicsGraph : public DynamicsGraph {
+ private:
+  LinkSharedPtr base_;
+  std::vector<LinkSharedPtr> feet_;
+  double mass_;
+  gtsam::Matrix6 inertia_;                // in the body frame
+  gtsam::Pose3 rest_pose_, body_T_base_;  // body at rest, base in body
+  std::vector<gtsam::Pose3> body_T_feet_;  // feet at rest, in body
+  double reach_;
+  gtsam::SharedNoiseModel rotation_model_, reach_model_;
+
+  // Index of the foot, or throw.
+  size_t footIndex(const LinkSharedPtr &link) const;
+
+  // Collocation factors from t to t+1, for a step of duration dt.
+  gtsam::NonlinearFactorGraph stepCollocationFactors(
+      const int t, const CollocationScheme collocation,
+      const gtsam::Double_ &dt) const;
+
+ public:
+  /**
+   * Constructor, computes the mass and composite inertia of the robot.
+   * @param robot   the legged robot, in its rest configuration
+   * @param opt     settings for the optimizer
+   * @param gravity gravitational acceleration
+   * @param reach   largest distance of a foot from its rest position,
+   * relative to the body
+   * @param feet    the feet, by default all links with a single joint
+   * except the base, the link with the most joints
+   */
+  CentroidalDynamicsGraph(
+      const Robot &robot, const OptimizerSetting &opt,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      double reach = 0.1, const std::vector<LinkSharedPtr> &feet = {});
+
+  /// Return the base link, whose keys are used for the body.
+  const LinkSharedPtr &base() const { return base_; }
+
+  /// Return the feet.
+  const std::vector<LinkSharedPtr> &feet() const { return feet_; }
+
+  /// Total mass of the robot.
+  double mass() const { return mass_; }
+
+  /// Spatial inertia of the body at its center of mass, in its frame.
+  const gtsam::Matrix6 &inertia() const { return inertia_; }
+
+  /// Body pose in the rest configuration of the robot.
+  const gtsam::Pose3 &restPose() const { return rest_pose_; }
+
+  /// Pose of the base link COM for a body pose.
+  gtsam::Pose3 basePose(const gtsam::Pose3 &wTbody) const {
+    return wTbody * body_T_base_;
+  }
+
+  /// Foot orientations follow the body, feet stay within reach, and contact
+  /// points are on the ground.
+  gtsam::NonlinearFactorGraph qFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Zero contact point velocities.
+  gtsam::NonlinearFactorGraph vFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// No factors: foot accelerations are not variables.
+  gtsam::NonlinearFactorGraph aFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Body wrench balance, and friction cone and moment of the contacts.
+  gtsam::NonlinearFactorGraph dynamicsFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const override;
+
+  /// Collocation of the body pose and twist, and foot poses, from t to t+1.
+  gtsam::NonlinearFactorGraph collocationFactors(
+      const Robot &robot, const int t, const double dt,
+      const CollocationScheme collocation = Trapezoidal) const override;
+
+  /// Collocation as collocationFactors, with the phase duration a variable.
+  gtsam::NonlinearFactorGraph multiPhaseCollocationFactors(
+      const Robot &robot, const int t, const int phase,
+      const CollocationScheme collocation = Trapezoidal) const override;
+
+  /**
+   * Initial values of a time step: the robot at rest, with the weight
+   * shared equally by the contacts.
+   * @param t              time step
+   * @param contact_points contacts, whose wrenches are inserted
+   */
+  gtsam::Values initialValues(
+      const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+};
+
+}  // namespace gtdynamics
@@ -13,6 +13,8 @@
 
 #include <gtdynamics/dynamics/Chain.h>
 
+#include <memory>
+
 namespace gtdynamics {
 
 Chain operator*(const Chain &chainA, const Chain &chainB) {
@@ -53,36 +55,25 @@ Pose3 Chain::poe(const Vector &q, boost::optional<Pose3 &> fTe,
         "number of angles in q different from number of cols in axes");
   }
 
-  // Build vector of exponential maps to use in poe
-  std::vector<Pose3> exp;
-  for (int i = 0; i < q.size(); ++i) {
-    exp.push_back(Pose3::Expmap(axes_.col(i) * q(i)));
-  }
-
-  Pose3 poe;
-  if (!J) {
-    // If J is not given, compute regular poe
-    poe = sMb_;
-    for (auto &expmap : exp) {
-      poe = poe.compose(expmap);
-    }
-    if (fTe) {
-      // compose end-effector pose
-      poe = poe.compose(*fTe);
-    }
-  } else {
-    // Compute FK + Jacobian with monoid compose.
-    Chain chain(sMb_);
-    for (int j = 0; j < q.size(); ++j) {
-      chain = chain * Chain(exp[j], axes_.col(j));
+  // Compose one joint at a time, adjoining the Jacobian to the new frame, as
+  // in the monoid operation of operator*.
+  Matrix H;
+  if (J) H = Matrix::Zero(6, length());
+  Pose3 poe = sMb_;
+  for (int j = 0; j < q.size(); ++j) {
+    const Pose3 expmap = Pose3::Expmap(axes_.col(j) * q(j));
+    poe = poe.compose(expmap);
+    if (J) {
+      H.leftCols(j) = expmap.inverse().AdjointMap() * H.leftCols(j);
+      H.col(j) = axes_.col(j);
     }
-    if (fTe) {
-      // compose end-effector pose
-      chain = chain * Chain(*fTe);
-    }
-    poe = chain.sMb();
-    *J = chain.axes();
   }
+  if (fTe) {
+    // compose end-effector pose
+    poe = poe.compose(*fTe);
+    if (J) H = fTe->inverse().AdjointMap() * H;
+  }
+  if (J) *J = H;
   return poe;
 }
 
@@ -120,7 +111,23 @@ gtsam::Vector3 Chain::DynamicalEquality3(
     const gtsam::Vector3 &torques, gtsam::OptionalJacobian<3, 6> H_wrench,
     gtsam::OptionalJacobian<3, 3> H_angles,
     gtsam::OptionalJacobian<3, 3> H_torques) {
-  Matrix J;
+  return Chain3(*this).DynamicalEquality3(wrench, angles, torques, H_wrench,
+                                          H_angles, H_torques);
+}
+
+gtsam::Vector3_ Chain::ChainConstraint3(
+    const std::vector<JointSharedPtr> &joints, const gtsam::Key wrench_key,
+    size_t k) {
+  return Chain3(*this).ChainConstraint3(joints, wrench_key, k);
+}
+
+template <>
+gtsam::Vector3 FixedChain<3>::DynamicalEquality3(
+    const gtsam::Vector6 &wrench, const gtsam::Vector3 &angles,
+    const gtsam::Vector3 &torques, gtsam::OptionalJacobian<3, 6> H_wrench,
+    gtsam::OptionalJacobian<3, 3> H_angles,
+    gtsam::OptionalJacobian<3, 3> H_torques) const {
+  Eigen::Matrix<double, 6, 3> J;
   poe(angles, boost::none, J);
   if (H_wrench) {
     // derivative of difference with respect to wrench
@@ -138,22 +145,24 @@ gtsam::Vector3 Chain::DynamicalEquality3(
     // angles at all, the second column depends only on the third angle, and the
     // first column depends on the second and third angles.
     // This means that the 3*3 jacobian has an upper triangular structure.
-    Matrix A = gtsam::Z_3x3;
+    gtsam::Matrix3 A = gtsam::Z_3x3;
 
     // Calculate the Adjoint and take its derivative in relation to angles
-    auto ad_J_angles1 = AdjointMapJacobianQ(angles(1), Pose3(), axes_.col(1));
-    auto ad_J_angles2 = AdjointMapJacobianQ(angles(2), Pose3(), axes_.col(2));
+    const gtsam::Vector6 axis0 = axes_.col(0), axis1 = axes_.col(1),
+                         axis2 = axes_.col(2);
+    auto ad_J_angles1 = AdjointMapJacobianQ(angles(1), Pose3(), axis1);
+    auto ad_J_angles2 = AdjointMapJacobianQ(angles(2), Pose3(), axis2);
 
     // Calculate the invers adjoint maps of the Poses, as we do in * operator
-    Pose3 p1_inv = Pose3::Expmap(-axes_.col(1) * angles(1));
-    Pose3 p2_inv = Pose3::Expmap(-axes_.col(2) * angles(2));
+    Pose3 p1_inv = Pose3::Expmap(-axis1 * angles(1));
+    Pose3 p2_inv = Pose3::Expmap(-axis2 * angles(2));
     auto ad_inv_p1 = p1_inv.AdjointMap();
     auto ad_inv_p2 = p2_inv.AdjointMap();
 
     // calculate the non-zero terms
-    A(1, 2) = (ad_J_angles2 * axes_.col(1)).transpose() * wrench;
-    A(0, 2) = (ad_J_angles2 * ad_inv_p1 * axes_.col(0)).transpose() * wrench;
-    A(0, 1) = (ad_inv_p2 * ad_J_angles1 * axes_.col(0)).transpose() * wrench;
+    A(1, 2) = (ad_J_angles2 * axis1).transpose() * wrench;
+    A(0, 2) = (ad_J_angles2 * ad_inv_p1 * axis0).transpose() * wrench;
+    A(0, 1) = (ad_inv_p2 * ad_J_angles1 * axis0).transpose() * wrench;
 
     *H_angles = A;
   }
@@ -165,9 +174,10 @@ gtsam::Vector3 Chain::DynamicalEquality3(
   return (J.transpose() * wrench - torques);
 }
 
-gtsam::Vector3_ Chain::ChainConstraint3(
+template <>
+gtsam::Vector3_ FixedChain<3>::ChainConstraint3(
     const std::vector<JointSharedPtr> &joints, const gtsam::Key wrench_key,
-    size_t k) {
+    size_t k) const {
   // Get Expression for wrench
   gtsam::Vector6_ wrench(wrench_key);
 
@@ -183,12 +193,18 @@ gtsam::Vector3_ Chain::ChainConstraint3(
       torque2(TorqueKey(joints[2]->id(), k));
   gtsam::Vector3_ torques(MakeVector3, torque0, torque1, torque2);
 
-  // Get expression of the dynamical equality
+  // Get expression of the dynamical equality, with its own copy of the
+  // chain. The copy is made with new, which respects Eigen alignment.
+  std::shared_ptr<const Chain3> chain(new Chain3(*this));
   gtsam::Vector3_ torque_diff(
-      std::bind(&Chain::DynamicalEquality3, this, std::placeholders::_1,
-                std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5,
-                std::placeholders::_6),
+      [chain](const gtsam::Vector6 &wrench, const gtsam::Vector3 &angles,
+              const gtsam::Vector3 &torques,
+              gtsam::OptionalJacobian<3, 6> H_wrench,
+              gtsam::OptionalJacobian<3, 3> H_angles,
+              gtsam::OptionalJacobian<3, 3> H_torques) {
+        return chain->DynamicalEquality3(wrench, angles, torques, H_wrench,
+                                         H_angles, H_torques);
+      },
       wrench, angles, torques);
 
   return torque_diff;
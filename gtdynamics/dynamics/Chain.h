@@ -19,6 +19,8 @@
 #include <gtsam/geometry/Pose3.h>
 
 #include <boost/optional.hpp>
+#include <stdexcept>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/utils/utils.h"
@@ -134,9 +136,283 @@ class Chain {
                                    const gtsam::Key wrench_key, size_t k);
 };
 
+/**
+ * FixedChain is a serial kinematic chain of N joints, with N known at compile
+ * time, e.g. the 3-joint legs of a quadruped. It has the semantics of Chain,
+ * but the screw axes and Jacobians are fixed-size Eigen matrices, so forward
+ * kinematics and composition do not allocate.
+ */
+template <int N>
+class FixedChain {
+ public:
+  typedef Eigen::Matrix<double, 6, N> Axes;
+  typedef Eigen::Matrix<double, N, 1> Angles;
+
+ private:
+  Pose3 sMb_;  // rest pose of "body" with respect to "spatial" frame.
+  Axes axes_;  // screw axes of all joints in the chain expressed in body frame.
+
+  // Derivative of column j of the body Jacobian J with respect to angle k:
+  // only joints after j move column j, by ad(J_j) * J_k.
+  static gtsam::Vector6 JacobianDerivative(const Axes &J, int j, int k) {
+    if (k <= j) return gtsam::Vector6::Zero();
+    return Pose3::adjointMap(J.col(j)) * J.col(k);
+  }
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Default Constructor
+  FixedChain() : axes_(Axes::Zero()) {}
+
+  /// Constructor
+  FixedChain(const Pose3 &sMb, const Axes &axes) : sMb_(sMb), axes_(axes) {}
+
+  /// Construct from a Chain with N joints.
+  explicit FixedChain(const Chain &chain) : sMb_(chain.sMb()) {
+    if (chain.length() != N) {
+      throw std::runtime_error("FixedChain: chain has wrong number of joints");
+    }
+    axes_ = chain.axes();
+  }
+
+  // Return sMb.
+  inline const Pose3 &sMb() const { return sMb_; }
+
+  // Return screw axes.
+  inline const Axes &axes() const { return axes_; }
+
+  // Return number of joints.
+  static constexpr size_t length() { return N; }
+
+  /// Return the Chain with the same pose and screw axes.
+  Chain chain() const { return Chain(sMb_, axes_); }
+
+  /**
+   * Compose with a chain of M joints, with the monoid operation of
+   * Chain::operator*.
+   * @param other ............. chain to compose with
+   * @return .................. Composed chain
+   */
+  template <int M>
+  FixedChain<N + M> operator*(const FixedChain<M> &other) const {
+    const Pose3 &bTc = other.sMb();
+    Eigen::Matrix<double, 6, N + M> axes;
+    axes.template leftCols<N>() = bTc.inverse().AdjointMap() * axes_;
+    axes.template rightCols<M>() = other.axes();
+    return FixedChain<N + M>(sMb_.compose(bTc), axes);
+  }
+
+  /**
+   * Perform forward kinematics given q, return Pose of end-effector and
+   * optionally the Jacobian, as Chain::poe.
+   * @param q ........... Input angles for all joints
+   * @param fTe ......... The end-effector pose with respect to final link
+   * (Optional)
+   * @param(out) J....... The calculated Jacobian (Optional)
+   * @return ............ Pose of the end-effector calculated using Product of
+   * Exponentials
+   */
+  Pose3 poe(const Angles &q, const boost::optional<Pose3> &fTe = boost::none,
+            gtsam::OptionalJacobian<6, N> J = boost::none) const {
+    // Compose one joint at a time, adjoining the Jacobian to the new frame.
+    Pose3 sTe = sMb_;
+    Axes H = Axes::Zero();
+    for (int j = 0; j < N; ++j) {
+      const Pose3 expmap = Pose3::Expmap(axes_.col(j) * q(j));
+      sTe = sTe.compose(expmap);
+      if (J) {
+        H = expmap.inverse().AdjointMap() * H;
+        H.col(j) = axes_.col(j);
+      }
+    }
+    if (fTe) {
+      // compose end-effector pose
+      sTe = sTe.compose(*fTe);
+      if (J) H = fTe->inverse().AdjointMap() * H;
+    }
+    if (J) *J = H;
+    return sTe;
+  }
+
+  /**
+   * Twist of the body frame when the joints are locked and the spatial frame
+   * moves with the given twist, i.e., that twist expressed in the body frame.
+   * @param q ........... Input angles for all joints
+   * @param twist ....... Twist of the spatial frame, in the spatial frame
+   * @return ............ Twist of the body frame, in the body frame
+   */
+  gtsam::Vector6 transformTwist(
+      const Angles &q, const gtsam::Vector6 &twist,
+      gtsam::OptionalJacobian<6, N> H_q = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_twist = boost::none) const {
+    Axes J;
+    const gtsam::Matrix6 Ad = poe(q, boost::none, J).inverse().AdjointMap();
+    const gtsam::Vector6 body_twist = Ad * twist;
+    // Moving the body frame by xi changes its twist by ad(body_twist) * xi.
+    if (H_q) *H_q = Pose3::adjointMap(body_twist) * J;
+    if (H_twist) *H_twist = Ad;
+    return body_twist;
+  }
+
+  /**
+   * Twist of the body frame due to the joint velocities, J(q) * q_dot.
+   * @param q ........... Input angles for all joints
+   * @param q_dot ....... Velocities of all joints
+   * @return ............ Twist of the body frame relative to the spatial
+   * frame, in the body frame
+   */
+  gtsam::Vector6 jointTwist(
+      const Angles &q, const Angles &q_dot,
+      gtsam::OptionalJacobian<6, N> H_q = boost::none,
+      gtsam::OptionalJacobian<6, N> H_q_dot = boost::none) const {
+    Axes J;
+    poe(q, boost::none, J);
+    if (H_q) {
+      H_q->setZero();
+      for (int k = 0; k < N; ++k)
+        for (int j = 0; j < k; ++j)
+          H_q->col(k) += q_dot(j) * JacobianDerivative(J, j, k);
+    }
+    if (H_q_dot) *H_q_dot = J;
+    return J * q_dot;
+  }
+
+  /**
+   * Velocity-product terms of the twist acceleration of the body frame, when
+   * the spatial frame moves with the given twist. With the twist acceleration
+   * of the spatial frame A, the twist acceleration of the body frame is
+   * transformTwist(q, A) + jointTwist(q, q_ddot) + biasTwistAccel(...).
+   * @param q ........... Input angles for all joints
+   * @param q_dot ....... Velocities of all joints
+   * @param twist ....... Twist of the spatial frame, in the spatial frame
+   * @return ............ Twist acceleration, in the body frame
+   */
+  gtsam::Vector6 biasTwistAccel(
+      const Angles &q, const Angles &q_dot, const gtsam::Vector6 &twist,
+      gtsam::OptionalJacobian<6, N> H_q = boost::none,
+      gtsam::OptionalJacobian<6, N> H_q_dot = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_twist = boost::none) const {
+    Axes J;
+    const gtsam::Matrix6 Ad = poe(q, boost::none, J).inverse().AdjointMap();
+    const gtsam::Vector6 x = Ad * twist, y = J * q_dot;
+    const gtsam::Matrix6 ad_x = Pose3::adjointMap(x);
+
+    // ad(x) * y, plus the time derivative of J times q_dot.
+    gtsam::Vector6 accel = ad_x * y;
+    for (int i = 0; i < N; ++i)
+      for (int j = 0; j < i; ++j)
+        accel += q_dot(j) * q_dot(i) * JacobianDerivative(J, j, i);
+
+    if (H_q) {
+      Axes dy = Axes::Zero();
+      for (int k = 0; k < N; ++k)
+        for (int j = 0; j < k; ++j)
+          dy.col(k) += q_dot(j) * JacobianDerivative(J, j, k);
+      *H_q = -Pose3::adjointMap(y) * ad_x * J + ad_x * dy;
+      for (int k = 0; k < N; ++k)
+        for (int i = 0; i < N; ++i)
+          for (int j = 0; j < i; ++j)
+            H_q->col(k) +=
+                q_dot(j) * q_dot(i) *
+                (Pose3::adjointMap(JacobianDerivative(J, j, k)) * J.col(i) +
+                 Pose3::adjointMap(J.col(j)) * JacobianDerivative(J, i, k));
+    }
+    if (H_q_dot) {
+      *H_q_dot = ad_x * J;
+      for (int i = 0; i < N; ++i)
+        for (int j = 0; j < i; ++j) {
+          const gtsam::Vector6 dJ = JacobianDerivative(J, j, i);
+          H_q_dot->col(j) += q_dot(i) * dJ;
+          H_q_dot->col(i) += q_dot(j) * dJ;
+        }
+    }
+    if (H_twist) *H_twist = -Pose3::adjointMap(y) * Ad;
+    return accel;
+  }
+
+  /**
+   * Express a wrench on the body frame in the spatial frame.
+   * @param q ........... Input angles for all joints
+   * @param wrench ...... Wrench, in the body frame
+   * @return ............ The same wrench, in the spatial frame
+   */
+  gtsam::Vector6 transformWrench(
+      const Angles &q, const gtsam::Vector6 &wrench,
+      gtsam::OptionalJacobian<6, N> H_q = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_wrench = boost::none) const {
+    Axes J;
+    const gtsam::Matrix6 AdT =
+        poe(q, boost::none, J).inverse().AdjointMap().transpose();
+    if (H_q) {
+      // Moving the body frame by xi changes the result by -AdT * ad(xi)^T w.
+      const gtsam::Matrix3 m = gtsam::skewSymmetric(wrench.head<3>()),
+                           f = gtsam::skewSymmetric(wrench.tail<3>());
+      gtsam::Matrix6 H_xi;
+      H_xi << m, f, f, gtsam::Z_3x3;
+      *H_q = -AdT * H_xi * J;
+    }
+    if (H_wrench) *H_wrench = AdT;
+    return AdT * wrench;
+  }
+
+  /**
+   * Joint torques balancing a wrench on the body frame, J(q)^T * wrench.
+   * @param q ........... Input angles for all joints
+   * @param wrench ...... Wrench, in the body frame
+   * @return ............ Torques of all joints
+   */
+  Angles jointTorques(
+      const Angles &q, const gtsam::Vector6 &wrench,
+      gtsam::OptionalJacobian<N, N> H_q = boost::none,
+      gtsam::OptionalJacobian<N, 6> H_wrench = boost::none) const {
+    Axes J;
+    poe(q, boost::none, J);
+    if (H_q) {
+      H_q->setZero();
+      for (int j = 0; j < N; ++j)
+        for (int k = j + 1; k < N; ++k)
+          (*H_q)(j, k) = JacobianDerivative(J, j, k).dot(wrench);
+    }
+    if (H_wrench) *H_wrench = J.transpose();
+    return J.transpose() * wrench;
+  }
+
+  /// See Chain::DynamicalEquality3, only defined for N = 3.
+  gtsam::Vector3 DynamicalEquality3(
+      const gtsam::Vector6 &wrench, const gtsam::Vector3 &angles,
+      const gtsam::Vector3 &torques,
+      gtsam::OptionalJacobian<3, 6> H_wrench = boost::none,
+      gtsam::OptionalJacobian<3, 3> H_angles = boost::none,
+      gtsam::OptionalJacobian<3, 3> H_torques = boost::none) const;
+
+  /**
+   * See Chain::ChainConstraint3, only defined for N = 3. The expression holds
+   * a copy of the chain.
+   */
+  gtsam::Vector3_ ChainConstraint3(const std::vector<JointSharedPtr> &joints,
+                                   const gtsam::Key wrench_key,
+                                   size_t k) const;
+};
+
+template <>
+gtsam::Vector3 FixedChain<3>::DynamicalEquality3(
+    const gtsam::Vector6 &wrench, const gtsam::Vector3 &angles,
+    const gtsam::Vector3 &torques, gtsam::OptionalJacobian<3, 6> H_wrench,
+    gtsam::OptionalJacobian<3, 3> H_angles,
+    gtsam::OptionalJacobian<3, 3> H_torques) const;
+
+template <>
+gtsam::Vector3_ FixedChain<3>::ChainConstraint3(
+    const std::vector<JointSharedPtr> &joints, const gtsam::Key wrench_key,
+    size_t k) const;
+
+/// Chain of a 3-joint leg.
+typedef FixedChain<3> Chain3;
+
 // Helper function to create expression with a vector, used in
 // ChainConstraint3.
-gtsam::Vector3 MakeVector3(const double &value0, const double &value1,
+inline gtsam::Vector3 MakeVector3(const double &value0, const double &value1,
                            const double &value2,
                            gtsam::OptionalJacobian<3, 1> J0 = boost::none,
                            gtsam::OptionalJacobian<3, 1> J1 = boost::none,
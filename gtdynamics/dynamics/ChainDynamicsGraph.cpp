@@ -0,0 +1,366 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainDynamicsGraph.cpp
+ * @brief Reduced dynamics graph of a legged robot, with a chain per leg.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/ChainDynamicsGraph.h>
+#include <gtdynamics/factors/ContactDynamicsBlockFactor.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/GraphArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::ExpressionFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::OptionalJacobian;
+using gtsam::Pose3;
+using gtsam::Vector3;
+using gtsam::Vector3_;
+using gtsam::Vector6;
+using gtsam::Vector6_;
+
+namespace gtdynamics {
+
+namespace {
+
+using Leg = ChainDynamicsGraph::Leg;
+
+// Same as graph->addPrior, but allocated from the current GraphArena, if any.
+template <class T>
+void AddPrior(NonlinearFactorGraph *graph, gtsam::Key key, const T &prior,
+              const gtsam::SharedNoiseModel &model) {
+  graph->push_back(MakeShared<gtsam::PriorFactor<T>>(key, prior, model));
+}
+
+// Joint variables of a leg at time step k, e.g. its angles, as a vector.
+Vector3_ LegVector(const Leg &leg, DynamicsSymbol (*key)(int, int), int k) {
+  return Vector3_(MakeVector3, gtsam::Double_(key(leg.joints[0]->id(), k)),
+                  gtsam::Double_(key(leg.joints[1]->id(), k)),
+                  gtsam::Double_(key(leg.joints[2]->id(), k)));
+}
+
+// Twist of the foot from the twist of the base, through the leg.
+Vector6_ FootTwist(const Leg &leg, const Vector3_ &q, const Vector3_ &q_dot,
+                   const Vector6_ &base_twist) {
+  const std::shared_ptr<const Chain3> chain = leg.chain;
+  const Vector6_ transported(
+      [chain](const Vector3 &q, const Vector6 &V, OptionalJacobian<6, 3> H_q,
+              OptionalJacobian<6, 6> H_V) {
+        return chain->transformTwist(q, V, H_q, H_V);
+      },
+      q, base_twist);
+  const Vector6_ relative(
+      [chain](const Vector3 &q, const Vector3 &q_dot,
+              OptionalJacobian<6, 3> H_q, OptionalJacobian<6, 3> H_q_dot) {
+        return chain->jointTwist(q, q_dot, H_q, H_q_dot);
+      },
+      q, q_dot);
+  return transported + relative;
+}
+
+// Twist acceleration of the foot from the base motion, through the leg.
+Vector6_ FootTwistAccel(const Leg &leg, const Vector3_ &q,
+                        const Vector3_ &q_dot, const Vector3_ &q_ddot,
+                        const Vector6_ &base_twist,
+                        const Vector6_ &base_accel) {
+  const std::shared_ptr<const Chain3> chain = leg.chain;
+  const Vector6_ bias(
+      [chain](const Vector3 &q, const Vector3 &q_dot, const Vector6 &V,
+              OptionalJacobian<6, 3> H_q, OptionalJacobian<6, 3> H_q_dot,
+              OptionalJacobian<6, 6> H_V) {
+        return chain->biasTwistAccel(q, q_dot, V, H_q, H_q_dot, H_V);
+      },
+      q, q_dot, base_twist);
+  return FootTwist(leg, q, q_ddot, base_accel) + bias;
+}
+
+// Linear velocity (or acceleration) of the contact point, as in
+// ContactKinematicsTwistConstraint.
+Vector3_ ContactPointLinear(const Vector6_ &twist, const gtsam::Point3 &point) {
+  gtsam::Matrix36 H_vel;
+  H_vel << gtsam::Z_3x3, gtsam::I_3x3;
+  const gtsam::Matrix36 H =
+      H_vel * Pose3(gtsam::Rot3(), -point).AdjointMap();
+  const std::function<Vector3(Vector6)> f = [H](const Vector6 &V) {
+    return H * V;
+  };
+  return gtsam::linearExpression(f, twist, H);
+}
+
+// Gravity, defaulting to the one of DynamicsGraph.
+Vector3 Gravity(const boost::optional<Vector3> &gravity) {
+  return gravity ? *gravity : Vector3(0, 0, -9.8);
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+ChainDynamicsGraph::ChainDynamicsGraph(
+    const Robot &robot, const OptimizerSetting &opt,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : DynamicsGraph(opt, gravity) {
+  // The base is the link with the most joints.
+  for (auto &&link : robot.links()) {
+    if (!base_ || link->numJoints() > base_->numJoints()) base_ = link;
+  }
+  if (!base_) {
+    throw std::invalid_argument("ChainDynamicsGraph: robot has no links");
+  }
+
+  // Follow every joint of the base to a leaf link.
+  for (auto &&hip : base_->joints()) {
+    Leg leg;
+    JointSharedPtr joint = hip;
+    LinkSharedPtr link = base_;
+    while (joint) {
+      if (joint->parent() != link) {
+        throw std::invalid_argument("ChainDynamicsGraph: joint " +
+                                    joint->name() +
+                                    " does not point away from the base");
+      }
+      leg.joints.push_back(joint);
+      link = joint->child();
+      JointSharedPtr next;
+      for (auto &&other : link->joints()) {
+        if (other == joint) continue;
+        if (next) {
+          throw std::invalid_argument("ChainDynamicsGraph: link " +
+                                      link->name() + " is not on a chain");
+        }
+        next = other;
+      }
+      joint = next;
+    }
+    if (leg.joints.size() != 3) {
+      throw std::invalid_argument("ChainDynamicsGraph: the leg of " +
+                                  hip->name() + " does not have 3 joints");
+    }
+    leg.foot = link;
+
+    // Compose the chain from the base COM to the foot COM.
+    Chain chain;
+    for (auto &&j : leg.joints) {
+      chain = chain * Chain(j->pMc(), j->cScrewAxis());
+    }
+    leg.chain.reset(new Chain3(chain));
+    legs_.push_back(leg);
+  }
+  if (3 * legs_.size() != robot.joints().size()) {
+    throw std::invalid_argument(
+        "ChainDynamicsGraph: not all joints are on legs of the base");
+  }
+
+  // One torque model for the three torques of a leg.
+  auto diagonal = boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+      opt.t_cost_model);
+  if (diagonal) {
+    torque_model_ = gtsam::noiseModel::Isotropic::Sigma(3, diagonal->sigma(0));
+  } else {
+    torque_model_ = gtsam::noiseModel::Unit::Create(3);
+  }
+}
+
+/* ************************************************************************* */
+const ChainDynamicsGraph::Leg &ChainDynamicsGraph::legWithFoot(
+    const LinkSharedPtr &foot) const {
+  for (auto &&leg : legs_) {
+    if (leg.foot->id() == foot->id()) return leg;
+  }
+  throw std::invalid_argument("ChainDynamicsGraph: contact link " +
+                              foot->name() + " is not a foot");
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::qFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const int b = base_->id();
+  if (base_->isFixed()) {
+    AddPrior(&graph, PoseKey(b, k), base_->getFixedPose(), opt_.bp_cost_model);
+  }
+
+  // The foot pose is the base pose composed with the leg kinematics.
+  const gtsam::Pose3_ wTb(PoseKey(b, k));
+  for (auto &&leg : legs_) {
+    const std::shared_ptr<const Chain3> chain = leg.chain;
+    const gtsam::Pose3_ bTf(
+        [chain](const Vector3 &q, OptionalJacobian<6, 3> H_q) {
+          return chain->poe(q, boost::none, H_q);
+        },
+        LegVector(leg, JointAngleKey, k));
+    const gtsam::Pose3_ wTf(PoseKey(leg.foot->id(), k));
+    graph.push_back(MakeShared<ExpressionFactor<Pose3>>(
+        opt_.p_cost_model, Pose3(), gtsam::between(wTf, wTb * bTf)));
+  }
+
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      legWithFoot(cp.link);  // throws if the contact is not on a foot
+      graph.push_back(MakeShared<ContactHeightFactor>(
+          PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point,
+          Gravity(gravity_)));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::vFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const int b = base_->id();
+  if (base_->isFixed()) {
+    AddPrior<Vector6>(&graph, TwistKey(b, k), gtsam::Z_6x1,
+                      opt_.bv_cost_model);
+  }
+
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      const Leg &leg = legWithFoot(cp.link);
+      const Vector6_ twist =
+          FootTwist(leg, LegVector(leg, JointAngleKey, k),
+                    LegVector(leg, JointVelKey, k), Vector6_(TwistKey(b, k)));
+      graph.push_back(MakeShared<ExpressionFactor<Vector3>>(
+          opt_.cv_cost_model, Vector3::Zero(),
+          ContactPointLinear(twist, cp.point)));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::aFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const int b = base_->id();
+  if (base_->isFixed()) {
+    AddPrior<Vector6>(&graph, TwistAccelKey(b, k), gtsam::Z_6x1,
+                      opt_.ba_cost_model);
+  }
+
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      const Leg &leg = legWithFoot(cp.link);
+      const Vector6_ accel = FootTwistAccel(
+          leg, LegVector(leg, JointAngleKey, k),
+          LegVector(leg, JointVelKey, k), LegVector(leg, JointAccelKey, k),
+          Vector6_(TwistKey(b, k)), Vector6_(TwistAccelKey(b, k)));
+      graph.push_back(MakeShared<ExpressionFactor<Vector3>>(
+          opt_.ca_cost_model, Vector3::Zero(),
+          ContactPointLinear(accel, cp.point)));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::dynamicsFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const Vector3 gravity = Gravity(gravity_);
+  const int b = base_->id();
+  if (contact_points) {
+    for (auto &&cp : *contact_points) legWithFoot(cp.link);
+  }
+
+  // The base balances the wrenches from the hips.
+  if (!base_->isFixed()) {
+    std::vector<DynamicsSymbol> wrench_keys;
+    for (auto &&leg : legs_) {
+      wrench_keys.push_back(WrenchKey(b, leg.joints[0]->id(), k));
+    }
+    graph.add(WrenchFactor(opt_.fa_cost_model, base_, wrench_keys, k, gravity));
+  }
+
+  std::vector<ContactDynamicsBlockFactor::Contact> contacts;
+  for (auto &&leg : legs_) {
+    const int i = leg.foot->id();
+    const Vector3_ q = LegVector(leg, JointAngleKey, k);
+    const Vector3_ torques = LegVector(leg, TorqueKey, k);
+    const Vector6_ hip_wrench(WrenchKey(b, leg.joints[0]->id(), k));
+
+    bool in_contact = false;
+    Pose3 cTcom;
+    if (contact_points) {
+      for (auto &&cp : *contact_points) {
+        if (cp.link->id() != i) continue;
+        in_contact = true;
+        cTcom = Pose3(gtsam::Rot3(), -cp.point);
+      }
+    }
+
+    // A massless leg in the air carries no wrench and no torques.
+    if (!in_contact) {
+      graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+          opt_.f_cost_model, Vector6::Zero(), hip_wrench));
+      graph.push_back(MakeShared<ExpressionFactor<Vector3>>(
+          torque_model_, Vector3::Zero(), torques));
+      continue;
+    }
+
+    // In contact, the contact wrench passes through the leg to the base, and
+    // the torques balance it: tau = -J^T * C.
+    const auto wrench_key = ContactWrenchKey(i, 0, k);
+    const Vector6_ contact_wrench(wrench_key);
+    const std::shared_ptr<const Chain3> chain = leg.chain;
+    const Vector6_ transmitted(
+        [chain](const Vector3 &q, const Vector6 &wrench,
+                OptionalJacobian<6, 3> H_q, OptionalJacobian<6, 6> H_wrench) {
+          return chain->transformWrench(q, wrench, H_q, H_wrench);
+        },
+        q, contact_wrench);
+    const Vector3_ balanced(
+        [chain](const Vector3 &q, const Vector6 &wrench,
+                OptionalJacobian<3, 3> H_q, OptionalJacobian<3, 6> H_wrench) {
+          return chain->jointTorques(q, wrench, H_q, H_wrench);
+        },
+        q, contact_wrench);
+    graph.push_back(MakeShared<ExpressionFactor<Vector6>>(
+        opt_.f_cost_model, Vector6::Zero(), hip_wrench - transmitted));
+    graph.push_back(MakeShared<ExpressionFactor<Vector3>>(
+        torque_model_, Vector3::Zero(), torques + balanced));
+
+    if (opt_.contact_block_factors) {
+      contacts.push_back({PoseKey(i, k), wrench_key, cTcom});
+      continue;
+    }
+    graph.push_back(MakeShared<ContactDynamicsFrictionConeFactor>(
+        PoseKey(i, k), wrench_key, opt_.cfriction_cost_model, mu ? *mu : 1.0,
+        gravity));
+    graph.push_back(MakeShared<ContactDynamicsMomentFactor>(
+        wrench_key, opt_.cm_cost_model, cTcom));
+  }
+  if (!contacts.empty()) {
+    graph.push_back(MakeShared<ContactDynamicsBlockFactor>(
+        contacts, opt_.cfriction_cost_model, opt_.cm_cost_model,
+        mu ? *mu : 1.0, gravity));
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainDynamicsGraph.h
+ * @brief Reduced dynamics graph of a legged robot, with a chain per leg.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ChainDynamicsGraph builds the dynamics graph of a legged robot in reduced
+ * coordinates: every leg is a serial chain of 3 joints from the base link to
+ * a foot, modeled as massless, so that the leg links are eliminated
+ * analytically. The variables of a time step are
+ *  - the pose, twist and twist acceleration of the base,
+ *  - the pose of every foot,
+ *  - the angle, velocity, acceleration and torque of every joint,
+ *  - the wrench on the base from every hip joint, and
+ *  - the contact wrench of every foot in contact.
+ *
+ * The foot pose is the base pose composed with the forward kinematics of the
+ * leg chain, contacts constrain the foot velocities and accelerations through
+ * the chain, the torques balance the contact wrench through the leg Jacobian,
+ * and the base, the only link with mass, balances the hip wrenches.
+ *
+ * Graphs built with it have the variables above instead of poses, twists,
+ * accelerations and wrenches of all links; collocation and all other factors
+ * of DynamicsGraph, which only involve joints, are unchanged.
+ */
+class ChainDynamicsGraph : public DynamicsGraph {
+ public:
+  /// A leg: its joints from hip to foot, the foot link, and its chain.
+  struct Leg {
+    std::vector<JointSharedPtr> joints;
+    LinkSharedPtr foot;
+    std::shared_ptr<const Chain3> chain;  ///< base COM to foot COM
+  };
+
+ private:
+  LinkSharedPtr base_;
+  std::vector<Leg> legs_;
+  gtsam::SharedNoiseModel torque_model_;  // 3-dim t_cost_model
+
+  // Return the leg with the given foot, or throw.
+  const Leg &legWithFoot(const LinkSharedPtr &foot) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot   the legged robot, all joints of which are on legs of 3
+   * joints that start at the base link, the link with the most joints
+   * @param opt     settings for the optimizer
+   * @param gravity gravitational acceleration
+   */
+  ChainDynamicsGraph(
+      const Robot &robot, const OptimizerSetting &opt,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return the base link.
+  const LinkSharedPtr &base() const { return base_; }
+
+  /// Return the legs, in the order of the joints of the base.
+  const std::vector<Leg> &legs() const { return legs_; }
+
+  /// Base pose prior if fixed, and foot poses from the leg chains.
+  gtsam::NonlinearFactorGraph qFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Base twist prior if fixed, and zero contact point velocities.
+  gtsam::NonlinearFactorGraph vFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Base acceleration prior if fixed, and zero contact point accelerations.
+  gtsam::NonlinearFactorGraph aFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Base wrench balance, leg statics, and contact wrench factors.
+  gtsam::NonlinearFactorGraph dynamicsFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const override;
+};
+
+}  // namespace gtdynamics
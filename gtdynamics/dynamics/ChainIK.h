@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainIK.h
+ * @brief Damped least-squares inverse kinematics on a fixed-size chain,
+ * without factor graphs, for real-time use.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ChainIK.
+struct ChainIKParameters {
+  size_t max_iterations = 100;
+  double tolerance = 1e-12;  // on the squared norm of the pose error
+  double lambda_initial = 1e-3, lambda_factor = 10.0;  // damping
+  double lambda_min = 1e-9, lambda_max = 1e6;
+};
+
+/**
+ * Iterative inverse kinematics of a FixedChain: Levenberg-Marquardt on the
+ * body Jacobian of FixedChain::poe, minimizing the squared norm of the pose
+ * error Logmap(poe(q)^-1 * goal), with the joint angles clamped to their
+ * limits after every step. All work is done in fixed-size matrices, so
+ * solve() does not allocate and is meant for real-time loops, e.g. Cartesian
+ * teleoperation of 6-7 DOF arms. Use Kinematics::inverse for problems with
+ * several goals or contacts.
+ */
+template <int N>
+class ChainIK {
+ public:
+  typedef typename FixedChain<N>::Axes Axes;
+  typedef typename FixedChain<N>::Angles Angles;
+
+  /// Solution of ChainIK::solve.
+  struct Result {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Angles q;               // joint angles
+    double error = 0;       // squared norm of the final pose error
+    size_t iterations = 0;  // number of iterations done
+    bool converged = false;  // whether error is at most the tolerance
+  };
+
+ private:
+  FixedChain<N> chain_;
+  Angles lower_, upper_;
+  ChainIKParameters parameters_;
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor.
+   * @param chain      the chain
+   * @param lower      lower joint limits
+   * @param upper      upper joint limits
+   * @param parameters iteration parameters
+   */
+  ChainIK(const FixedChain<N> &chain, const Angles &lower, const Angles &upper,
+          const ChainIKParameters &parameters = ChainIKParameters())
+      : chain_(chain), lower_(lower), upper_(upper), parameters_(parameters) {}
+
+  /**
+   * Create from N serial joints, from the CoM of the parent link of the first
+   * joint to the CoM of the child link of the last, with the joint limits of
+   * their JointParams.
+   */
+  static ChainIK FromJoints(
+      const std::vector<JointSharedPtr> &joints,
+      const ChainIKParameters &parameters = ChainIKParameters()) {
+    if (joints.size() != N) {
+      throw std::invalid_argument("ChainIK: wrong number of joints");
+    }
+    Chain chain;
+    Angles lower, upper;
+    for (int j = 0; j < N; ++j) {
+      chain = chain * Chain(joints[j]->pMc(), joints[j]->cScrewAxis());
+      const auto &limits = joints[j]->parameters().scalar_limits;
+      lower(j) = limits.value_lower_limit;
+      upper(j) = limits.value_upper_limit;
+    }
+    return ChainIK(FixedChain<N>(chain), lower, upper, parameters);
+  }
+
+  /// Return the chain.
+  const FixedChain<N> &chain() const { return chain_; }
+
+  /// Return the joint angles clamped to the joint limits.
+  Angles clamp(const Angles &q) const {
+    return q.cwiseMax(lower_).cwiseMin(upper_);
+  }
+
+  /**
+   * Solve for the joint angles putting the end-effector at a goal pose.
+   * @param sTe    goal pose of the end-effector in the spatial frame
+   * @param q_init initial joint angles, clamped to the limits
+   * @param fTe    end-effector pose in the last frame of the chain, if any
+   */
+  Result solve(const Pose3 &sTe, const Angles &q_init,
+               const boost::optional<Pose3> &fTe = boost::none) const {
+    typedef Eigen::Matrix<double, N, N> Normal;
+    Result result;
+    result.q = clamp(q_init);
+    Axes J, J_new;
+    gtsam::Vector6 e =
+        Pose3::Logmap(chain_.poe(result.q, fTe, J).between(sTe));
+    result.error = e.squaredNorm();
+
+    // With the body Jacobian J, poe(q + dq) ~ poe(q) * Expmap(J * dq), so the
+    // error becomes e - J * dq to first order.
+    double lambda = parameters_.lambda_initial;
+    while (result.iterations < parameters_.max_iterations &&
+           result.error > parameters_.tolerance) {
+      result.iterations++;
+      const Normal A = J.transpose() * J + lambda * Normal::Identity();
+      const Angles q_new =
+          clamp(result.q + A.ldlt().solve(J.transpose() * e));
+      const gtsam::Vector6 e_new =
+          Pose3::Logmap(chain_.poe(q_new, fTe, J_new).between(sTe));
+      const double error = e_new.squaredNorm();
+      if (error < result.error) {
+        result.q = q_new;
+        result.error = error;
+        e = e_new;
+        J = J_new;
+        lambda = std::max(lambda / parameters_.lambda_factor,
+                          parameters_.lambda_min);
+      } else if (lambda < parameters_.lambda_max) {
+        lambda = std::min(lambda * parameters_.lambda_factor,
+                          parameters_.lambda_max);
+      } else {
+        break;  // no progress, e.g. stuck at a joint limit
+      }
+    }
+    result.converged = result.error <= parameters_.tolerance;
+    return result;
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,360 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledForwardDynamics.cpp
+ * @brief Forward dynamics with sparsity and elimination ordering precomputed
+ * once per robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/CompiledForwardDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CompiledForwardDynamics::CompiledForwardDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis,
+    const std::vector<bool> &known_accels, const PointOnLinks &contact_points)
+    : links_(robot.links()),
+      joints_(robot.joints()),
+      gravity_(gravity),
+      planar_axis_(planar_axis),
+      known_accels_(known_accels),
+      contact_points_(contact_points),
+      link_index_(DynamicsSymbol::kNoIndex + 1, -1),
+      joint_index_(DynamicsSymbol::kNoIndex + 1, -1) {
+  const size_t num_links = links_.size(), num_joints = joints_.size();
+  if (known_accels_.empty()) known_accels_.resize(num_joints, false);
+  if (known_accels_.size() != num_joints) {
+    throw std::invalid_argument(
+        "CompiledForwardDynamics: known_accels must have one entry per joint");
+  }
+
+  // Column and row layout: 6 per moving link, then 7 columns and 7 (or 10 for
+  // planar robots) rows per joint. The first column of a joint is a_j, or
+  // tau_j if a_j is known.
+  int num_cols = 0, num_rows = 0;
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const auto &link = links_[idx];
+    link_index_[link->id()] = idx;
+    inertias_.push_back(link->inertiaMatrix());
+    if (link->isFixed()) {
+      link_cols_.push_back(-1);
+      link_rows_.push_back(-1);
+    } else {
+      link_cols_.push_back(num_cols);
+      link_rows_.push_back(num_rows);
+      num_cols += 6;
+      num_rows += 6;
+    }
+  }
+  const int rows_per_joint = planar_axis_ ? 10 : 7;
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const auto &joint = joints_[idx];
+    joint_index_[joint->id()] = idx;
+    parent_index_.push_back(link_index_[joint->parent()->id()]);
+    child_index_.push_back(link_index_[joint->child()->id()]);
+    screw_axes_.push_back(joint->cScrewAxis());
+    joint_cols_.push_back(num_cols);
+    joint_rows_.push_back(num_rows);
+    num_cols += 7;
+    num_rows += rows_per_joint;
+  }
+  gtsam::Matrix36 H_acc;
+  H_acc << gtsam::Z_3x3, gtsam::I_3x3;
+  for (auto &&cp : contact_points_) {
+    const int i = link_index_[cp.link->id()];
+    if (i < 0 || link_cols_[i] < 0) {
+      throw std::invalid_argument(
+          "CompiledForwardDynamics: contact point on fixed link " +
+          cp.link->name());
+    }
+    contact_links_.push_back(i);
+    contact_cols_.push_back(num_cols);
+    contact_rows_.push_back(num_rows);
+    contact_jacobians_.push_back(
+        H_acc * gtsam::Pose3(gtsam::Rot3(), -cp.point).AdjointMap());
+    num_cols += 3;
+    num_rows += 3;
+  }
+
+  // Collect the structural non-zeros. Kinematics-dependent blocks are stored
+  // densely so that their storage never moves.
+  std::vector<Eigen::Triplet<double>> triplets;
+  auto addBlock = [&triplets](int row, int col, const gtsam::Matrix &block) {
+    for (int r = 0; r < block.rows(); r++)
+      for (int c = 0; c < block.cols(); c++)
+        triplets.emplace_back(row + r, col + c, block(r, c));
+  };
+
+  // Wrench equations: G_i * A_i - sum_j F_i_j = rhs_i, where F_i_j is
+  // -Ad(T_ci)^T * F_c_j if the link is the parent of joint j.
+  for (size_t idx = 0; idx < num_links; idx++) {
+    if (link_rows_[idx] < 0) continue;
+    addBlock(link_rows_[idx], link_cols_[idx], inertias_[idx]);
+  }
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int col_F = joint_cols_[idx] + 1;
+    const int p = parent_index_[idx], c = child_index_[idx];
+    if (link_rows_[c] >= 0) addBlock(link_rows_[c], col_F, -gtsam::I_6x6);
+    if (link_rows_[p] >= 0) addBlock(link_rows_[p], col_F, gtsam::Z_6x6);
+  }
+
+  // Joint equations.
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int row = joint_rows_[idx], col = joint_cols_[idx];
+    const int p = parent_index_[idx], c = child_index_[idx];
+    const Vector6 &S = screw_axes_[idx];
+
+    // Twist acceleration: A_c - Ad(T_cp) * A_p - S * a_j = ad(V_c) * S * v_j
+    if (link_cols_[c] >= 0) addBlock(row, link_cols_[c], gtsam::I_6x6);
+    if (link_cols_[p] >= 0) addBlock(row, link_cols_[p], gtsam::Z_6x6);
+    if (!known_accels_[idx]) addBlock(row, col, -S);
+
+    // Torque: S^T * F_c = tau_j
+    addBlock(row + 6, col + 1, S.transpose());
+    if (known_accels_[idx]) addBlock(row + 6, col, -gtsam::I_1x1);
+
+    // Planar: J * F_c = 0
+    if (planar_axis_) {
+      addBlock(row + 7, col + 1, getPlanarJacobian(*planar_axis_));
+    }
+  }
+
+  // Contacts: H * A_i = 0, and -H^T * f_c in the wrench equation of link i.
+  for (size_t c = 0; c < contact_points_.size(); c++) {
+    const int i = contact_links_[c];
+    const gtsam::Matrix36 &H = contact_jacobians_[c];
+    addBlock(contact_rows_[c], link_cols_[i], H);
+    addBlock(link_rows_[i], contact_cols_[c], -H.transpose());
+  }
+
+  A_.resize(num_rows, num_cols);
+  A_.setFromTriplets(triplets.begin(), triplets.end());
+  A_.makeCompressed();
+
+  // Cache the storage of the blocks overwritten at every solve.
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int p = parent_index_[idx];
+    if (link_cols_[p] >= 0) {
+      ad_entries_.push_back(blockEntries(joint_rows_[idx], link_cols_[p]));
+      ad_transpose_entries_.push_back(
+          blockEntries(link_rows_[p], joint_cols_[idx] + 1));
+    } else {
+      ad_entries_.push_back(EntryIndices());
+      ad_transpose_entries_.push_back(EntryIndices());
+    }
+  }
+
+  // Symbolic analysis, reused by all subsequent numeric factorizations.
+  square_ = (num_rows == num_cols);
+  if (square_) {
+    lu_.analyzePattern(A_);
+  } else {
+    qr_.analyzePattern(A_);
+  }
+
+  b_ = Vector::Zero(num_rows);
+  x_ = Vector::Zero(num_cols);
+  joint_adjoints_.resize(num_joints, gtsam::I_6x6);
+  joint_accels_ = Vector::Zero(num_joints);
+  torques_ = Vector::Zero(num_joints);
+  twist_accels_.resize(num_links, gtsam::Z_6x1);
+  parent_wrenches_.resize(num_joints, gtsam::Z_6x1);
+  child_wrenches_.resize(num_joints, gtsam::Z_6x1);
+  contact_wrenches_.resize(contact_points_.size(), gtsam::Z_6x1);
+}
+
+/* ************************************************************************* */
+CompiledForwardDynamics::EntryIndices CompiledForwardDynamics::blockEntries(
+    int row, int col) {
+  EntryIndices entries;
+  for (int r = 0; r < 6; r++)
+    for (int c = 0; c < 6; c++)
+      entries[6 * r + c] = &A_.coeffRef(row + r, col + c) - A_.valuePtr();
+  return entries;
+}
+
+/* ************************************************************************* */
+void CompiledForwardDynamics::setBlock(const EntryIndices &entries,
+                                       const Matrix6 &block) {
+  double *values = A_.valuePtr();
+  for (int r = 0; r < 6; r++)
+    for (int c = 0; c < 6; c++) values[entries[6 * r + c]] = block(r, c);
+}
+
+/* ************************************************************************* */
+void CompiledForwardDynamics::solve(const std::vector<Pose3> &poses,
+                                    const std::vector<Vector6> &twists,
+                                    const Vector &joint_vels,
+                                    const Vector &torques,
+                                    const Vector *joint_accels) {
+  const size_t num_links = links_.size(), num_joints = joints_.size();
+  if (poses.size() != num_links || twists.size() != num_links ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(torques.size()) != num_joints ||
+      (joint_accels && size_t(joint_accels->size()) != num_joints)) {
+    throw std::invalid_argument(
+        "CompiledForwardDynamics: input sizes do not match the robot");
+  }
+  if (!joint_accels && std::find(known_accels_.begin(), known_accels_.end(),
+                                 true) != known_accels_.end()) {
+    throw std::invalid_argument(
+        "CompiledForwardDynamics: joint accelerations are needed for hybrid "
+        "dynamics");
+  }
+
+  // Right-hand side of the wrench equations: Coriolis and gravity terms.
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int row = link_rows_[idx];
+    if (row < 0) continue;
+    const Matrix6 &G = inertias_[idx];
+    const Vector6 &V = twists[idx];
+    b_.segment<6>(row) = Pose3::adjointMap(V).transpose() * G * V;
+    if (gravity_) {
+      b_.segment<3>(row + 3) += poses[idx].rotation().transpose() *
+                                (*gravity_) * links_[idx]->mass();
+    }
+  }
+
+  // Kinematics-dependent blocks and right-hand side of the joint equations.
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int p = parent_index_[idx], c = child_index_[idx];
+    const int row = joint_rows_[idx];
+    const Vector6 &S = screw_axes_[idx];
+    const Pose3 T_cp = poses[c].inverse() * poses[p];
+    joint_adjoints_[idx] = T_cp.AdjointMap();
+    if (link_cols_[p] >= 0) {
+      setBlock(ad_entries_[idx], -joint_adjoints_[idx]);
+      setBlock(ad_transpose_entries_[idx], joint_adjoints_[idx].transpose());
+    }
+    b_.segment<6>(row) = Pose3::adjointMap(twists[c]) * S * joint_vels(idx);
+    if (known_accels_[idx]) {
+      b_.segment<6>(row) += S * (*joint_accels)(idx);
+      b_(row + 6) = 0;
+    } else {
+      b_(row + 6) = torques(idx);
+    }
+  }
+
+  if (square_) {
+    lu_.factorize(A_);
+    if (lu_.info() != Eigen::Success) {
+      throw std::runtime_error(
+          "CompiledForwardDynamics: factorization failed, is the robot "
+          "under-constrained?");
+    }
+    x_ = lu_.solve(b_);
+  } else {
+    qr_.factorize(A_);
+    if (qr_.info() != Eigen::Success) {
+      throw std::runtime_error(
+          "CompiledForwardDynamics: factorization failed, is the robot "
+          "under-constrained?");
+    }
+    x_ = qr_.solve(b_);
+  }
+
+  // Recover accelerations and wrenches.
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int col = link_cols_[idx];
+    if (col < 0) {
+      twist_accels_[idx].setZero();
+    } else {
+      twist_accels_[idx] = x_.segment<6>(col);
+    }
+  }
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int col = joint_cols_[idx];
+    if (known_accels_[idx]) {
+      joint_accels_(idx) = (*joint_accels)(idx);
+      torques_(idx) = x_(col);
+    } else {
+      joint_accels_(idx) = x_(col);
+      torques_(idx) = torques(idx);
+    }
+    child_wrenches_[idx] = x_.segment<6>(col + 1);
+    parent_wrenches_[idx] =
+        -joint_adjoints_[idx].transpose() * child_wrenches_[idx];
+  }
+  for (size_t c = 0; c < contact_points_.size(); c++) {
+    contact_wrenches_[c] =
+        contact_jacobians_[c].transpose() * x_.segment<3>(contact_cols_[c]);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values CompiledForwardDynamics::solve(
+    const int t, const gtsam::Values &known_values) {
+  const size_t num_links = links_.size(), num_joints = joints_.size();
+  std::vector<Pose3> poses(num_links);
+  std::vector<Vector6> twists(num_links);
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int i = links_[idx]->id();
+    poses[idx] = Pose(known_values, i, t);
+    twists[idx] = Twist(known_values, i, t);
+  }
+  Vector joint_vels(num_joints), torques = Vector::Zero(num_joints),
+                                  joint_accels = Vector::Zero(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = joints_[idx]->id();
+    joint_vels(idx) = JointVel(known_values, j, t);
+    if (known_accels_[idx]) {
+      joint_accels(idx) = JointAccel(known_values, j, t);
+    } else {
+      torques(idx) = Torque(known_values, j, t);
+    }
+  }
+
+  solve(poses, twists, joint_vels, torques, &joint_accels);
+
+  gtsam::Values values = known_values;
+  try {
+    for (size_t idx = 0; idx < num_joints; idx++) {
+      const auto &joint = joints_[idx];
+      const int j = joint->id();
+      if (known_accels_[idx]) {
+        InsertTorque(&values, j, t, torques_(idx));
+      } else {
+        InsertJointAccel(&values, j, t, joint_accels_(idx));
+      }
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   parent_wrenches_[idx]);
+      InsertWrench(&values, joint->child()->id(), j, t, child_wrenches_[idx]);
+    }
+    for (size_t idx = 0; idx < num_links; idx++) {
+      InsertTwistAccel(&values, links_[idx]->id(), t, twist_accels_[idx]);
+    }
+    for (size_t c = 0; c < contact_points_.size(); c++) {
+      values.insert(ContactWrenchKey(contact_points_[c].link->id(), c, t),
+                    contact_wrenches_[c]);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    ReportDiagnostic("key already exists:", e.key());
+    throw std::invalid_argument(
+        "CompiledForwardDynamics: known_values should contain no "
+        "wrenches, twist accelerations, contact wrenches, or unknown joint "
+        "accelerations or torques");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,230 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledForwardDynamics.h
+ * @brief Forward dynamics with sparsity and elimination ordering precomputed
+ * once per robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Sparse>
+#include <array>
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CompiledForwardDynamics solves the same linear system as
+ * DynamicsGraph::linearSolveFD, but "compiles" it for a given Robot: the
+ * sparsity pattern, the column ordering of the sparse factorization, and all
+ * Jacobian/RHS storage are set up in the constructor. Every subsequent solve
+ * only overwrites the entries that depend on the kinematics and refactorizes
+ * numerically.
+ *
+ * Since torques are known in forward dynamics, and the parent-side wrench of a
+ * joint follows from the wrench equivalence constraint, both are substituted
+ * out. The remaining unknowns are the twist accelerations of all moving
+ * links, and the joint acceleration and child-side wrench of every joint.
+ *
+ * Joints and links are indexed in the order returned by Robot::joints() and
+ * Robot::links(), which is also the order used by DynamicsGraph::jointAccels.
+ *
+ * For hybrid dynamics, the accelerations of some joints can be known instead
+ * of their torques. The column of such a joint then holds its torque, so the
+ * system has the same size, but its own sparsity pattern and ordering.
+ *
+ * For stance phases, contact points can be added, with the linear relations
+ * of ContactKinematicsAccelFactor and ContactDynamicsMomentFactor: every
+ * contact point has zero linear acceleration, and applies a pure force f_c,
+ * in a frame at the point aligned with the link CoM frame, to its link. Each
+ * contact adds 3 unknowns and 3 equations.
+ */
+class CompiledForwardDynamics {
+ public:
+  using SparseMatrix = Eigen::SparseMatrix<double, Eigen::ColMajor, int>;
+  using EntryIndices = std::array<int, 36>;
+
+ private:
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+
+  /// Per joint: whether its acceleration is known instead of its torque.
+  std::vector<bool> known_accels_;
+
+  /// Contact points, with the link index, first column of f_c, first row of
+  /// the acceleration constraint, and the map from f_c to the wrench on the
+  /// link, [0 I] * Ad(T_c_com), transposed.
+  PointOnLinks contact_points_;
+  std::vector<int> contact_links_, contact_cols_, contact_rows_;
+  std::vector<gtsam::Matrix36> contact_jacobians_;
+
+  /// Link and joint indices keyed on their ids.
+  std::vector<int> link_index_, joint_index_;
+
+  /// Per link: first column of A_i and first row of its wrench equation, -1 if
+  /// the link is fixed.
+  std::vector<int> link_cols_, link_rows_;
+  std::vector<gtsam::Matrix6> inertias_;
+
+  /// Per joint: link indices, column of a_j (F_c starts at +1), and first row
+  /// of the twist acceleration equation (torque equation at +6).
+  std::vector<int> parent_index_, child_index_, joint_cols_, joint_rows_;
+  std::vector<gtsam::Vector6> screw_axes_;
+
+  /// Storage positions of the kinematics-dependent blocks in A_.
+  std::vector<EntryIndices> ad_entries_, ad_transpose_entries_;
+
+  SparseMatrix A_;
+  gtsam::Vector b_, x_;
+  bool square_;
+  Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> lu_;
+  Eigen::SparseQR<SparseMatrix, Eigen::COLAMDOrdering<int>> qr_;
+
+  /// Results of the last solve.
+  std::vector<gtsam::Matrix6> joint_adjoints_;
+  gtsam::Vector joint_accels_, torques_;
+  std::vector<gtsam::Vector6> twist_accels_, parent_wrenches_,
+      child_wrenches_, contact_wrenches_;
+
+  /// Return storage indices of a dense 6x6 block at (row, col) in A_.
+  EntryIndices blockEntries(int row, int col);
+
+  /// Write a dense 6x6 block into A_ using cached storage indices.
+  void setBlock(const EntryIndices &entries, const gtsam::Matrix6 &block);
+
+  /// Solve, with the known joint accelerations if any.
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels, const gtsam::Vector &torques,
+             const gtsam::Vector *joint_accels);
+
+ public:
+  /**
+   * Constructor, analyzes the structure of the forward dynamics system.
+   * @param robot        the robot
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   * @param known_accels  per joint, in joint order, whether its acceleration
+   * is known instead of its torque; empty for forward dynamics
+   * @param contact_points points in contact, with zero acceleration, on
+   * links that are not fixed
+   */
+  CompiledForwardDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+      const std::vector<bool> &known_accels = std::vector<bool>(),
+      const PointOnLinks &contact_points = PointOnLinks());
+
+  /// Number of scalar unknowns in the compiled system.
+  size_t dim() const { return A_.cols(); }
+
+  /// Number of joints in the compiled robot.
+  size_t numJoints() const { return joints_.size(); }
+
+  /// Number of links in the compiled robot.
+  size_t numLinks() const { return links_.size(); }
+
+  /// Per joint, whether its acceleration is known instead of its torque.
+  const std::vector<bool> &knownAccels() const { return known_accels_; }
+
+  /// Contact points of the compiled system.
+  const PointOnLinks &contactPoints() const { return contact_points_; }
+
+  /// Index of the joint with the given id in the vectors used by solve.
+  int jointIndex(uint16_t id) const { return joint_index_.at(id); }
+
+  /// Index of the link with the given id in the vectors used by solve.
+  int linkIndex(uint16_t id) const { return link_index_.at(id); }
+
+  /**
+   * Solve forward dynamics from plain arrays, without touching gtsam::Values.
+   *
+   * @param poses      CoM pose of every link, in link order
+   * @param twists     twist of every link, in link order
+   * @param joint_vels joint velocities, in joint order
+   * @param torques    joint torques, in joint order
+   */
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels, const gtsam::Vector &torques) {
+    solve(poses, twists, joint_vels, torques, nullptr);
+  }
+
+  /**
+   * Solve hybrid dynamics from plain arrays.
+   *
+   * @param poses        CoM pose of every link, in link order
+   * @param twists       twist of every link, in link order
+   * @param joint_vels   joint velocities, in joint order
+   * @param torques      joint torques, in joint order, read for the joints
+   * whose acceleration is not known
+   * @param joint_accels joint accelerations, in joint order, read for the
+   * joints whose acceleration is known
+   */
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels, const gtsam::Vector &torques,
+             const gtsam::Vector &joint_accels) {
+    solve(poses, twists, joint_vels, torques, &joint_accels);
+  }
+
+  /**
+   * Solve forward dynamics, Values version with the same semantics as
+   * DynamicsGraph::linearSolveFD, or DynamicsGraph::linearSolveHybrid if
+   * some joint accelerations are known.
+   *
+   * @param t            time step
+   * @param known_values link poses and twists, joint velocities, and torques
+   * or accelerations of the joints
+   * @return known_values augmented with the other joint accelerations and
+   * torques, wrenches and twist accelerations, and the wrench of every
+   * contact point c on link i under ContactWrenchKey(i, c, t)
+   */
+  gtsam::Values solve(const int t, const gtsam::Values &known_values);
+
+  /// Joint accelerations of the last solve, in joint order.
+  const gtsam::Vector &jointAccels() const { return joint_accels_; }
+
+  /// Joint torques of the last solve, in joint order.
+  const gtsam::Vector &torques() const { return torques_; }
+
+  /// Twist accelerations of the last solve, in link order.
+  const std::vector<gtsam::Vector6> &twistAccels() const {
+    return twist_accels_;
+  }
+
+  /// Wrenches on the parent link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &parentWrenches() const {
+    return parent_wrenches_;
+  }
+
+  /// Wrenches on the child link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &childWrenches() const {
+    return child_wrenches_;
+  }
+
+  /// Wrench of every contact point on its link, in the link CoM frame, from
+  /// the last solve.
+  const std::vector<gtsam::Vector6> &contactWrenches() const {
+    return contact_wrenches_;
+  }
+};
+
+}  // namespace gtdynamics
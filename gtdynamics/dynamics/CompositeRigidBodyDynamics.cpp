@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompositeRigidBodyDynamics.cpp
+ * @brief Joint-space mass matrix, Coriolis and gravity terms of fixed-base
+ * tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CompositeRigidBodyDynamics::CompositeRigidBodyDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : rnea_(robot, gravity), has_gravity_(gravity), subtree_inertias_(robot) {
+  if (!tree_.build(robot) || !tree_.root_fixed) {
+    throw std::invalid_argument(
+        "CompositeRigidBodyDynamics: robot is not a kinematic tree with a "
+        "fixed link");
+  }
+  for (auto &&link : tree_.links) inertias_.push_back(link->inertiaMatrix());
+
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  X_.resize(num_links, gtsam::I_6x6);
+  IC_.resize(num_links, gtsam::Z_6x6);
+  zero_twists_.resize(num_links, gtsam::Z_6x1);
+  zeros_ = Vector::Zero(num_joints);
+  mass_matrix_ = gtsam::Matrix::Zero(num_joints, num_joints);
+  coriolis_forces_ = Vector::Zero(num_joints);
+  gravity_forces_ = Vector::Zero(num_joints);
+}
+
+/* ************************************************************************* */
+void CompositeRigidBodyDynamics::solve(const std::vector<Pose3> &poses,
+                                       const std::vector<Vector6> &twists,
+                                       const Vector &joint_vels) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  if (poses.size() != num_links || twists.size() != num_links ||
+      size_t(joint_vels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "CompositeRigidBodyDynamics: input sizes do not match the robot");
+  }
+
+  // Composite inertias, accumulated from the leaves: IC_a += X^T * IC_b * X.
+  for (size_t i = 0; i < num_links; i++) IC_[i] = inertias_[i];
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b];
+    X_[b] = (poses[b].inverse() * poses[a]).AdjointMap();
+  }
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k];
+    IC_[tree_.parent[b]] += X_[b].transpose() * IC_[b] * X_[b];
+  }
+  projectMassMatrix(X_, IC_);
+
+  // Bias forces at zero acceleration, and gravity forces at rest.
+  rnea_.solve(poses, twists, joint_vels, zeros_);
+  coriolis_forces_ = rnea_.torques();
+  if (has_gravity_) {
+    rnea_.solve(poses, zero_twists_, zeros_, zeros_);
+    gravity_forces_ = rnea_.torques();
+    coriolis_forces_ -= gravity_forces_;
+  }
+}
+
+/* ************************************************************************* */
+const gtsam::Matrix &CompositeRigidBodyDynamics::solveMassMatrix(
+    const Vector &joint_angles) {
+  subtree_inertias_.setJointAngles(joint_angles);
+  projectMassMatrix(subtree_inertias_.relativeAdjoints(),
+                    subtree_inertias_.compositeInertias());
+  return mass_matrix_;
+}
+
+/* ************************************************************************* */
+const gtsam::Vector &CompositeRigidBodyDynamics::solveGravityForces(
+    const std::vector<Pose3> &poses) {
+  if (poses.size() != tree_.links.size()) {
+    throw std::invalid_argument(
+        "CompositeRigidBodyDynamics: input sizes do not match the robot");
+  }
+  if (has_gravity_) {
+    rnea_.solve(poses, zero_twists_, zeros_, zeros_);
+    gravity_forces_ = rnea_.torques();
+  }
+  return gravity_forces_;
+}
+
+/* ************************************************************************* */
+void CompositeRigidBodyDynamics::projectMassMatrix(
+    const std::vector<Matrix6> &X, const std::vector<Matrix6> &IC) {
+  // Mass matrix: the wrench IC_b * S_b needed to accelerate the subtree of
+  // link b with unit joint acceleration, projected on every joint towards
+  // the root.
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], j = tree_.joint[b];
+    Vector6 F = IC[b] * tree_.screw[b];
+    mass_matrix_(j, j) = tree_.screw[b].dot(F);
+    for (int c = b; tree_.parent[c] != tree_.root;) {
+      F = X[c].transpose() * F;
+      c = tree_.parent[c];
+      const int i = tree_.joint[c];
+      mass_matrix_(i, j) = mass_matrix_(j, i) = tree_.screw[c].dot(F);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void CompositeRigidBodyDynamics::solve(const int t,
+                                       const gtsam::Values &known_values) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  std::vector<Pose3> poses(num_links);
+  std::vector<Vector6> twists(num_links);
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int i = tree_.links[idx]->id();
+    poses[idx] = Pose(known_values, i, t);
+    twists[idx] = Twist(known_values, i, t);
+  }
+  Vector joint_vels(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    joint_vels(idx) = JointVel(known_values, tree_.joints[idx]->id(), t);
+  }
+  solve(poses, twists, joint_vels);
+}
+
+}  // namespace gtdynamics
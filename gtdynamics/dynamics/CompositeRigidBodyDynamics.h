@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompositeRigidBodyDynamics.h
+ * @brief Joint-space mass matrix, Coriolis and gravity terms of fixed-base
+ * tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/SubtreeInertiaCache.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CompositeRigidBodyDynamics computes the terms of the joint-space equations
+ * of motion of a fixed-base robot,
+ *
+ *   tau = M(q) * qddot + C(q, qdot) * qdot + g(q),
+ *
+ * as needed by operational-space and impedance controllers. The mass matrix
+ * is found with the composite-rigid-body algorithm in the twist/wrench
+ * conventions of the dynamics factors, and the Coriolis and gravity terms with
+ * two passes of NewtonEulerInverseDynamics at zero acceleration, instead of
+ * n + 1 inverse dynamics solves with unit accelerations.
+ *
+ * The tree topology is extracted only once, so the object can be reused at
+ * every control tick. Only kinematic trees with a fixed root link are
+ * supported.
+ */
+class CompositeRigidBodyDynamics {
+ private:
+  KinematicTree tree_;
+  NewtonEulerInverseDynamics rnea_;
+  bool has_gravity_;
+
+  std::vector<gtsam::Matrix6> inertias_;
+  SubtreeInertiaCache subtree_inertias_;
+
+  /// Per-solve buffers, indexed by link: relative adjoints and composite
+  /// inertias, and zero twists and joint rates for the gravity pass.
+  std::vector<gtsam::Matrix6> X_, IC_;
+  std::vector<gtsam::Vector6> zero_twists_;
+  gtsam::Vector zeros_;
+
+  /// Results of the last solve.
+  gtsam::Matrix mass_matrix_;
+  gtsam::Vector coriolis_forces_, gravity_forces_;
+
+  /// Fill the mass matrix from relative adjoints and composite inertias.
+  void projectMassMatrix(const std::vector<gtsam::Matrix6> &X,
+                         const std::vector<gtsam::Matrix6> &IC);
+
+ public:
+  /**
+   * Constructor, extracts the tree topology of the robot.
+   * @param robot    the robot, must be a kinematic tree with a fixed link
+   * @param gravity  gravity in world frame
+   */
+  explicit CompositeRigidBodyDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Number of joints in the robot.
+  size_t numJoints() const { return tree_.joints.size(); }
+
+  /// Number of links in the robot.
+  size_t numLinks() const { return tree_.links.size(); }
+
+  /// Index of the joint with the given id in the vectors used by solve.
+  int jointIndex(uint16_t id) const { return tree_.joint_index.at(id); }
+
+  /// Index of the link with the given id in the vectors used by solve.
+  int linkIndex(uint16_t id) const { return tree_.link_index.at(id); }
+
+  /**
+   * Compute the mass matrix, Coriolis and gravity terms from plain arrays.
+   *
+   * @param poses      CoM pose of every link, in Robot::links() order
+   * @param twists     twist of every link, in Robot::links() order
+   * @param joint_vels joint velocities, in Robot::joints() order
+   */
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels);
+
+  /**
+   * Compute the mass matrix, Coriolis and gravity terms, Values version.
+   *
+   * @param t            time step
+   * @param known_values link poses and twists, and joint velocities
+   */
+  void solve(const int t, const gtsam::Values &known_values);
+
+  /**
+   * Compute only the mass matrix, from the joint angles. Composite inertias
+   * are kept in a SubtreeInertiaCache between calls, so only the subtrees
+   * above joints whose angle changed are recomputed.
+   *
+   * @param joint_angles joint angles, in Robot::joints() order
+   * @return the mass matrix, also returned by massMatrix
+   */
+  const gtsam::Matrix &solveMassMatrix(const gtsam::Vector &joint_angles);
+
+  /**
+   * Compute only the gravity forces, e.g. for gravity compensation. Like the
+   * array solve and solveMassMatrix, it does not allocate, see RealTime.h.
+   *
+   * @param poses CoM pose of every link, in Robot::links() order
+   * @return the gravity forces, also returned by gravityForces
+   */
+  const gtsam::Vector &solveGravityForces(
+      const std::vector<gtsam::Pose3> &poses);
+
+  /// Composite inertias used by solveMassMatrix.
+  const SubtreeInertiaCache &subtreeInertias() const {
+    return subtree_inertias_;
+  }
+
+  /// Mass matrix M(q) of the last solve, in joint order.
+  const gtsam::Matrix &massMatrix() const { return mass_matrix_; }
+
+  /// Coriolis and centrifugal forces C(q, qdot) * qdot of the last solve.
+  const gtsam::Vector &coriolisForces() const { return coriolis_forces_; }
+
+  /// Gravity forces g(q) of the last solve, zero without gravity.
+  const gtsam::Vector &gravityForces() const { return gravity_forces_; }
+
+  /// Bias forces C(q, qdot) * qdot + g(q) of the last solve.
+  gtsam::Vector biasForces() const {
+    return coriolis_forces_ + gravity_forces_;
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,192 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompressedTrajectory.cpp
+ * @brief Trajectories stored as joint states, with link states reconstructed
+ * on demand.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/CompressedTrajectory.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+CompressedTrajectory::CompressedTrajectory(
+    const Robot &robot, size_t num_steps,
+    const boost::optional<gtsam::Vector3> &gravity, size_t cache_size)
+    : robot_(robot),
+      num_steps_(num_steps),
+      cache_size_(std::max<size_t>(cache_size, 1)),
+      inverse_dynamics_(robot, gravity) {
+  if (!tree_.build(robot)) {
+    throw std::invalid_argument(
+        "CompressedTrajectory: robot is not a kinematic tree");
+  }
+  const size_t num_joints = tree_.joints.size();
+  q_.setZero(num_steps, num_joints);
+  v_.setZero(num_steps, num_joints);
+  a_.setZero(num_steps, num_joints);
+  torques_.setZero(num_steps, num_joints);
+  if (!tree_.root_fixed) {
+    base_poses_.assign(num_steps, Pose3());
+    base_twists_.setZero(6, num_steps);
+  }
+}
+
+/* ************************************************************************* */
+CompressedTrajectory CompressedTrajectory::FromBuffer(
+    const Robot &robot, const TrajectoryBuffer &buffer,
+    const boost::optional<gtsam::Vector3> &gravity, size_t cache_size) {
+  CompressedTrajectory trajectory(robot, buffer.numSteps(), gravity,
+                                  cache_size);
+  trajectory.q_ = buffer.jointAngles();
+  trajectory.v_ = buffer.jointVels();
+  trajectory.a_ = buffer.jointAccels();
+  trajectory.torques_ = buffer.torques();
+  if (!trajectory.tree_.root_fixed) {
+    const uint16_t root = trajectory.baseLink()->id();
+    for (size_t t = 0; t < buffer.numSteps(); t++) {
+      trajectory.base_poses_[t] = buffer.pose(root, t);
+      trajectory.base_twists_.col(t) = buffer.twist(root, t);
+    }
+  }
+  return trajectory;
+}
+
+/* ************************************************************************* */
+CompressedTrajectory CompressedTrajectory::FromValues(
+    const Robot &robot, const Values &values,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<size_t> &num_steps, size_t cache_size) {
+  return FromBuffer(robot, TrajectoryBuffer::FromValues(robot, values,
+                                                        num_steps),
+                    gravity, cache_size);
+}
+
+/* ************************************************************************* */
+void CompressedTrajectory::invalidate(size_t t) {
+  const auto it = cached_.find(t);
+  if (it == cached_.end()) return;
+  cache_.erase(it->second);
+  cached_.erase(it);
+}
+
+/* ************************************************************************* */
+void CompressedTrajectory::setJointStates(size_t t, const Vector &q,
+                                          const Vector &v, const Vector &a,
+                                          const Vector &torques) {
+  const size_t num_joints = tree_.joints.size();
+  if (t >= num_steps_ || size_t(q.size()) != num_joints ||
+      size_t(v.size()) != num_joints || size_t(a.size()) != num_joints ||
+      size_t(torques.size()) != num_joints) {
+    throw std::invalid_argument(
+        "CompressedTrajectory::setJointStates: wrong step or sizes");
+  }
+  q_.row(t) = q.transpose();
+  v_.row(t) = v.transpose();
+  a_.row(t) = a.transpose();
+  torques_.row(t) = torques.transpose();
+  invalidate(t);
+}
+
+/* ************************************************************************* */
+void CompressedTrajectory::setBaseState(size_t t, const Pose3 &pose,
+                                        const Vector6 &twist) {
+  if (tree_.root_fixed) {
+    throw std::invalid_argument(
+        "CompressedTrajectory::setBaseState: the root link is fixed");
+  }
+  if (t >= num_steps_) {
+    throw std::invalid_argument(
+        "CompressedTrajectory::setBaseState: wrong step");
+  }
+  base_poses_[t] = pose;
+  base_twists_.col(t) = twist;
+  invalidate(t);
+}
+
+/* ************************************************************************* */
+const Values &CompressedTrajectory::step(size_t t) const {
+  if (t >= num_steps_) {
+    throw std::out_of_range("CompressedTrajectory::step: no such step");
+  }
+  const auto it = cached_.find(t);
+  if (it != cached_.end()) {
+    cache_.splice(cache_.begin(), cache_, it->second);
+    return cache_.front().second;
+  }
+
+  // Forward kinematics from the joint states and the root state.
+  const size_t num_joints = tree_.joints.size(),
+               num_links = tree_.links.size();
+  Values known;
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = tree_.joints[idx]->id();
+    InsertJointAngle(&known, j, t, q_(t, idx));
+    InsertJointVel(&known, j, t, v_(t, idx));
+  }
+  const LinkSharedPtr &root = baseLink();
+  if (!tree_.root_fixed) {
+    InsertPose(&known, root->id(), t, base_poses_[t]);
+    InsertTwist(&known, root->id(), t, Vector6(base_twists_.col(t)));
+  }
+  Values values = robot_.forwardKinematics(known, t, root->name());
+
+  // Inverse dynamics for the twist accelerations and wrenches.
+  std::vector<Pose3> poses(num_links);
+  std::vector<Vector6> twists(num_links);
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int i = tree_.links[idx]->id();
+    poses[idx] = Pose(values, i, t);
+    twists[idx] = Twist(values, i, t);
+  }
+  inverse_dynamics_.solve(poses, twists, v_.row(t).transpose(),
+                          a_.row(t).transpose());
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const auto &joint = tree_.joints[idx];
+    const int j = joint->id();
+    InsertJointAccel(&values, j, t, a_(t, idx));
+    InsertTorque(&values, j, t, torques_(t, idx));
+    InsertWrench(&values, joint->parent()->id(), j, t,
+                 inverse_dynamics_.parentWrenches()[idx]);
+    InsertWrench(&values, joint->child()->id(), j, t,
+                 inverse_dynamics_.childWrenches()[idx]);
+  }
+  for (size_t idx = 0; idx < num_links; idx++) {
+    InsertTwistAccel(&values, tree_.links[idx]->id(), t,
+                     inverse_dynamics_.twistAccels()[idx]);
+  }
+
+  // Cache, evicting the least recently used step.
+  while (!cache_.empty() && cache_.size() >= cache_size_) {
+    cached_.erase(cache_.back().first);
+    cache_.pop_back();
+  }
+  cache_.emplace_front(t, std::move(values));
+  cached_[t] = cache_.begin();
+  return cache_.front().second;
+}
+
+/* ************************************************************************* */
+Values CompressedTrajectory::values(const std::vector<size_t> &steps) const {
+  Values result;
+  for (size_t t : steps) result.insert(step(t));
+  return result;
+}
+
+}  // namespace gtdynamics
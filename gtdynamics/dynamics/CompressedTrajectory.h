@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompressedTrajectory.h
+ * @brief Trajectories stored as joint states, with link states reconstructed
+ * on demand.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CompressedTrajectory stores a trajectory of a tree-structured robot as its
+ * joint angles, velocities, accelerations and torques, plus the pose and
+ * twist of the root link if it is not fixed, which is a small fraction of
+ * the link poses, twists, twist accelerations and wrenches of a full
+ * trajectory. The link states of a step are reconstructed on request, by
+ * forward kinematics and NewtonEulerInverseDynamics, and the last few
+ * reconstructed steps are kept in a least-recently-used cache.
+ *
+ * Reconstruction assumes gravity is the only external wrench: the twist
+ * acceleration of a floating root, and all joint wrenches, are those of the
+ * robot in free flight, so trajectories with contacts only reconstruct their
+ * poses and twists exactly. The stored torques are returned as stored.
+ */
+class CompressedTrajectory {
+ private:
+  Robot robot_;
+  KinematicTree tree_;
+  size_t num_steps_, cache_size_;
+  gtsam::Matrix q_, v_, a_, torques_;   // numSteps x numJoints
+  std::vector<gtsam::Pose3> base_poses_;  // empty if the root is fixed
+  gtsam::Matrix base_twists_;             // 6 x numSteps, or empty
+
+  mutable NewtonEulerInverseDynamics inverse_dynamics_;
+  /// Reconstructed steps, most recently used first.
+  mutable std::list<std::pair<size_t, gtsam::Values>> cache_;
+  mutable std::unordered_map<
+      size_t, std::list<std::pair<size_t, gtsam::Values>>::iterator>
+      cached_;
+
+  /// Forget the reconstruction of step t, if any.
+  void invalidate(size_t t);
+
+ public:
+  /**
+   * Constructor, with all joint states zero and the root at the identity.
+   * @param robot      the robot, must be a kinematic tree
+   * @param num_steps  number of time steps
+   * @param gravity    gravity in the world frame, for the wrenches
+   * @param cache_size number of reconstructed steps kept, at least 1
+   */
+  CompressedTrajectory(
+      const Robot &robot, size_t num_steps,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      size_t cache_size = 16);
+
+  /**
+   * Compress the joint states, and the root link state, of a buffer.
+   * @param robot      the robot of the buffer
+   * @param buffer     the trajectory
+   * @param gravity    gravity in the world frame, for the wrenches
+   * @param cache_size number of reconstructed steps kept
+   */
+  static CompressedTrajectory FromBuffer(
+      const Robot &robot, const TrajectoryBuffer &buffer,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      size_t cache_size = 16);
+
+  /**
+   * Compress a trajectory in Values, see TrajectoryBuffer::FromValues; link
+   * states other than the root pose and twist are ignored.
+   */
+  static CompressedTrajectory FromValues(
+      const Robot &robot, const gtsam::Values &values,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<size_t> &num_steps = boost::none,
+      size_t cache_size = 16);
+
+  /// Number of time steps.
+  size_t numSteps() const { return num_steps_; }
+
+  /// The root link, whose state is stored if it is not fixed.
+  const LinkSharedPtr &baseLink() const { return tree_.links[tree_.root]; }
+
+  /// Number of doubles stored, to compare with a full trajectory.
+  size_t numStoredDoubles() const {
+    return 4 * q_.size() + 12 * base_poses_.size() + base_twists_.size();
+  }
+
+  /// Joint angles, numSteps x numJoints, in Robot::joints() order.
+  const gtsam::Matrix &jointAngles() const { return q_; }
+
+  /// Joint velocities, numSteps x numJoints.
+  const gtsam::Matrix &jointVels() const { return v_; }
+
+  /// Joint accelerations, numSteps x numJoints.
+  const gtsam::Matrix &jointAccels() const { return a_; }
+
+  /// Joint torques, numSteps x numJoints.
+  const gtsam::Matrix &torques() const { return torques_; }
+
+  /**
+   * Set the joint states of step t, one entry per joint in Robot::joints()
+   * order.
+   */
+  void setJointStates(size_t t, const gtsam::Vector &q, const gtsam::Vector &v,
+                      const gtsam::Vector &a, const gtsam::Vector &torques);
+
+  /// Set the pose and twist of a floating root link at step t.
+  void setBaseState(size_t t, const gtsam::Pose3 &pose,
+                    const gtsam::Vector6 &twist);
+
+  /**
+   * All states of step t: joint angles, velocities, accelerations and
+   * torques, and link poses, twists, twist accelerations and the wrenches
+   * of all joints, with the keys of values.h. The reference is valid until
+   * the step is evicted from the cache, i.e., until another step is
+   * requested or the step is changed.
+   */
+  const gtsam::Values &step(size_t t) const;
+
+  /// All states of the given steps, in one Values.
+  gtsam::Values values(const std::vector<size_t> &steps) const;
+
+  /// Number of steps currently cached.
+  size_t numCached() const { return cache_.size(); }
+
+  /// Drop all cached steps.
+  void clearCache() const {
+    cache_.clear();
+    cached_.clear();
+  }
+};
+
+}  // namespace gtdynamics
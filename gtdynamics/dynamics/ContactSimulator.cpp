@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.cpp
+ * @brief Forward simulation of a robot in soft contact with flat ground.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+ContactSimulator::ContactSimulator(const Robot &robot,
+                                   const PointOnLinks &contact_points,
+                                   const Vector3 &gravity,
+                                   const ContactSimulatorParameters &parameters)
+    : robot_(robot),
+      contact_points_(contact_points),
+      up_(gravity.norm() > 0 ? Vector3(-gravity.normalized())
+                             : Vector3(0, 0, 1)),
+      parameters_(parameters),
+      fd_(robot, gravity),
+      fk_(robot, robot.links()[fd_.rootIndex()]->name()),
+      t_(0) {
+  const auto &topology = robot.topology();
+  for (auto &&cp : contact_points_) {
+    const int index = topology.link_index.at(cp.link->id());
+    if (index < 0) {
+      throw std::invalid_argument(
+          "ContactSimulator: contact point on a link not in the robot");
+    }
+    contact_links_.push_back(index);
+  }
+
+  const auto &root = robot.links()[fd_.rootIndex()];
+  const size_t num_joints = robot.numJoints();
+  setState(root->isFixed() ? root->getFixedPose() : root->bMcom(),
+           Vector6::Zero(), Vector::Zero(num_joints),
+           Vector::Zero(num_joints));
+  solved_q_ = Vector::Zero(num_joints);
+  solved_v_ = Vector::Zero(num_joints);
+  torques_ = Vector::Zero(num_joints);
+  poses_.resize(fd_.numLinks());
+  twists_.resize(fd_.numLinks(), Vector6::Zero());
+  external_wrenches_.resize(fd_.numLinks(), Vector6::Zero());
+  contact_wrenches_.resize(contact_points_.size(), Vector6::Zero());
+}
+
+/* ************************************************************************* */
+void ContactSimulator::setState(const Pose3 &base_pose,
+                                const Vector6 &base_twist,
+                                const Vector &joint_angles,
+                                const Vector &joint_vels) {
+  const size_t num_joints = robot_.numJoints();
+  if (size_t(joint_angles.size()) != num_joints ||
+      size_t(joint_vels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "ContactSimulator: joint state sizes do not match the robot");
+  }
+  if (fd_.rootFixed()) {
+    base_pose_ = robot_.links()[fd_.rootIndex()]->getFixedPose();
+    base_twist_.setZero();
+  } else {
+    base_pose_ = base_pose;
+    base_twist_ = base_twist;
+  }
+  q_ = joint_angles;
+  v_ = joint_vels;
+}
+
+/* ************************************************************************* */
+void ContactSimulator::forwardDynamics(const Vector &torques) {
+  if (size_t(torques.size()) != robot_.numJoints()) {
+    throw std::invalid_argument(
+        "ContactSimulator: torques size does not match the robot");
+  }
+  solved_q_ = q_;
+  solved_v_ = v_;
+  torques_ = torques;
+  fk_.compute(q_.transpose(), v_.transpose(), base_pose_, base_twist_);
+  const auto &links = robot_.links();
+  for (size_t i = 0; i < links.size(); i++) {
+    poses_[i] = fk_.pose(0, links[i]->id());
+    twists_[i] = fk_.twist(0, links[i]->id());
+  }
+
+  // Soft contact forces of the points below the ground.
+  std::fill(external_wrenches_.begin(), external_wrenches_.end(),
+            Vector6::Zero());
+  const ContactSimulatorParameters &p = parameters_;
+  for (size_t c = 0; c < contact_points_.size(); c++) {
+    contact_wrenches_[c].setZero();
+    const double height = contactHeight(c);
+    if (height >= 0) continue;
+
+    const int l = contact_links_[c];
+    const Point3 &comPc = contact_points_[c].point;
+    const gtsam::Rot3 &wRl = poses_[l].rotation();
+    const Vector6 &V = twists_[l];
+    const Vector3 vel = wRl * Vector3(V.tail<3>() + V.head<3>().cross(comPc));
+
+    const double normal_vel = up_.dot(vel);
+    const double normal_force =
+        std::max(0.0, -p.stiffness * height - p.damping * normal_vel);
+    const Vector3 slip = vel - normal_vel * up_;
+    const Vector3 friction =
+        -p.mu * normal_force * slip /
+        std::sqrt(slip.squaredNorm() + p.slip_velocity * p.slip_velocity);
+
+    const Vector3 force = wRl.unrotate(normal_force * up_ + friction);
+    contact_wrenches_[c] << comPc.cross(force), force;
+    external_wrenches_[l] += contact_wrenches_[c];
+  }
+
+  fd_.solve(poses_, twists_, v_, torques_, &external_wrenches_);
+}
+
+/* ************************************************************************* */
+void ContactSimulator::integration(double dt) {
+  v_ += dt * fd_.jointAccels();
+  q_ += dt * v_;
+  if (!fd_.rootFixed()) {
+    base_twist_ += dt * fd_.twistAccels()[fd_.rootIndex()];
+    base_pose_ = base_pose_ * Pose3::Expmap(dt * base_twist_);
+  }
+}
+
+/* ************************************************************************* */
+void ContactSimulator::step(const Vector &torques, double dt) {
+  forwardDynamics(torques);
+  integration(dt);
+  t_++;
+}
+
+/* ************************************************************************* */
+double ContactSimulator::contactHeight(size_t c) const {
+  const Point3 wPc =
+      poses_[contact_links_.at(c)].transformFrom(contact_points_[c].point);
+  return up_.dot(wPc) - parameters_.ground_plane_height;
+}
+
+/* ************************************************************************* */
+gtsam::Values ContactSimulator::values(int t) const {
+  gtsam::Values values;
+  const auto &joints = robot_.joints();
+  for (size_t j = 0; j < joints.size(); j++) {
+    const int id = joints[j]->id();
+    InsertJointAngle(&values, id, t, solved_q_(j));
+    InsertJointVel(&values, id, t, solved_v_(j));
+    InsertJointAccel(&values, id, t, fd_.jointAccels()(j));
+    InsertTorque(&values, id, t, torques_(j));
+  }
+  const auto &links = robot_.links();
+  for (size_t i = 0; i < links.size(); i++) {
+    const int id = links[i]->id();
+    InsertPose(&values, id, t, poses_[i]);
+    InsertTwist(&values, id, t, twists_[i]);
+    InsertTwistAccel(&values, id, t, fd_.twistAccels()[i]);
+  }
+  for (size_t c = 0; c < contact_points_.size(); c++) {
+    values.insert(
+        ContactWrenchKey(contact_points_[c].link->id(), c, t),
+        contact_wrenches_[c]);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
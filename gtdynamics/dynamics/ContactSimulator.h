@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.h
+ * @brief Forward simulation of a robot in soft contact with flat ground.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of the soft contact model of ContactSimulator.
+struct ContactSimulatorParameters {
+  double mu = 1.0;                   // Coulomb friction coefficient
+  double stiffness = 1e4;            // normal stiffness, N/m
+  double damping = 1e2;              // normal damping, Ns/m
+  double slip_velocity = 1e-3;       // tangential speed of full friction, m/s
+  double ground_plane_height = 0.0;  // ground height along the up direction
+};
+
+/**
+ * ContactSimulator simulates a robot, possibly with a floating base, whose
+ * contact points can touch flat, level ground.
+ *
+ * Contacts follow the conventions of the contact factors: the height of a
+ * contact point is measured along the up direction opposite to gravity, as in
+ * ContactHeightFactor, and the resulting contact wrench is applied to the link
+ * in its CoM frame with the linear force inside the friction cone of
+ * ContactDynamicsFrictionConeFactor. Instead of solving an LCP every step,
+ * contacts are soft: a penetrating point gets a spring-damper normal force,
+ * and a regularized Coulomb friction force that saturates at mu times the
+ * normal force. Every step is then a single articulated-body forward dynamics
+ * solve followed by semi-implicit Euler integration, which is stable for
+ * stiff contacts at moderate time steps.
+ *
+ * The floating base, if any, is the root of ArticulatedBodyForwardDynamics;
+ * its CoM pose and twist are integrated along with the joints. A fixed root
+ * link stays at its fixed pose.
+ */
+class ContactSimulator {
+ private:
+  Robot robot_;
+  PointOnLinks contact_points_;
+  std::vector<int> contact_links_;  // link index of every contact point
+  gtsam::Vector3 up_;
+  ContactSimulatorParameters parameters_;
+  ArticulatedBodyForwardDynamics fd_;
+  BatchForwardKinematics fk_;
+  int t_;
+
+  /// State.
+  gtsam::Pose3 base_pose_;
+  gtsam::Vector6 base_twist_;
+  gtsam::Vector q_, v_;
+
+  /// Inputs and results of the last forward dynamics.
+  gtsam::Vector solved_q_, solved_v_, torques_;
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_, external_wrenches_, contact_wrenches_;
+
+ public:
+  /**
+   * Constructor, with the joints at zero and the robot at rest in its
+   * default configuration.
+   * @param robot          the robot, must be a kinematic tree
+   * @param contact_points points that can touch the ground
+   * @param gravity        gravity vector, also defines the up direction
+   * @param parameters     contact model parameters
+   */
+  ContactSimulator(const Robot &robot, const PointOnLinks &contact_points,
+                   const gtsam::Vector3 &gravity,
+                   const ContactSimulatorParameters &parameters =
+                       ContactSimulatorParameters());
+
+  /**
+   * Set the state.
+   * @param base_pose  CoM pose of the root link, ignored if it is fixed
+   * @param base_twist twist of the root link, ignored if it is fixed
+   * @param joint_angles joint angles, in Robot::joints() order
+   * @param joint_vels   joint velocities, in Robot::joints() order
+   */
+  void setState(const gtsam::Pose3 &base_pose,
+                const gtsam::Vector6 &base_twist,
+                const gtsam::Vector &joint_angles,
+                const gtsam::Vector &joint_vels);
+
+  /**
+   * Compute contact wrenches and accelerations for the current state.
+   * @param torques joint torques, in Robot::joints() order
+   */
+  void forwardDynamics(const gtsam::Vector &torques);
+
+  /**
+   * Integrate the state with the accelerations of the last forwardDynamics
+   * call, using semi-implicit Euler.
+   * @param dt duration of the time step
+   */
+  void integration(double dt);
+
+  /**
+   * Simulate for one time step.
+   * @param torques joint torques, in Robot::joints() order
+   * @param dt      duration of the time step
+   */
+  void step(const gtsam::Vector &torques, double dt);
+
+  /// Number of steps taken.
+  int t() const { return t_; }
+
+  /// The simulated robot.
+  const Robot &robot() const { return robot_; }
+
+  /// The root link, whose pose and twist are the base state.
+  LinkSharedPtr rootLink() const { return robot_.links()[fd_.rootIndex()]; }
+
+  /// CoM pose of the root link.
+  const gtsam::Pose3 &basePose() const { return base_pose_; }
+
+  /// Twist of the root link, in its CoM frame.
+  const gtsam::Vector6 &baseTwist() const { return base_twist_; }
+
+  /// Joint angles, in Robot::joints() order.
+  const gtsam::Vector &jointAngles() const { return q_; }
+
+  /// Joint velocities, in Robot::joints() order.
+  const gtsam::Vector &jointVels() const { return v_; }
+
+  /// Joint accelerations of the last forward dynamics.
+  const gtsam::Vector &jointAccels() const { return fd_.jointAccels(); }
+
+  /// Wrench of every contact point on its link, in the link CoM frame, from
+  /// the last forward dynamics; zero for points not touching the ground.
+  const std::vector<gtsam::Vector6> &contactWrenches() const {
+    return contact_wrenches_;
+  }
+
+  /// Height of a contact point above the ground for the last forward dynamics.
+  double contactHeight(size_t c) const;
+
+  /**
+   * Values of the last forward dynamics, in the same form as
+   * Simulator::getValues: joint angles, velocities, accelerations and torques,
+   * link poses, twists and twist accelerations, and the wrench of every
+   * contact point c on link i under ContactWrenchKey(i, c, t).
+   * @param t time step of the keys
+   */
+  gtsam::Values values(int t = 0) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsDerivatives.cpp
+ * @brief Analytic derivatives of forward and inverse dynamics of fixed-base
+ * tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsDerivatives.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+DynamicsDerivatives::DynamicsDerivatives(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : gravity_(gravity), crba_(robot, gravity) {
+  tree_.build(robot);  // CompositeRigidBodyDynamics checked the tree.
+  for (auto &&link : tree_.links) inertias_.push_back(link->inertiaMatrix());
+
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  X_.resize(num_links, gtsam::I_6x6);
+  A_.resize(num_links, gtsam::Z_6x1);
+  f_.resize(num_links, gtsam::Z_6x1);
+  dV_.resize(num_links, gtsam::Z_6x1);
+  dA_.resize(num_links, gtsam::Z_6x1);
+  df_.resize(num_links, gtsam::Z_6x1);
+  moved_.resize(num_links, false);
+  torques_ = Vector::Zero(num_joints);
+  joint_accels_ = Vector::Zero(num_joints);
+  H_q_ = Matrix::Zero(num_joints, num_joints);
+  H_v_ = Matrix::Zero(num_joints, num_joints);
+  H_u_ = Matrix::Zero(num_joints, num_joints);
+}
+
+/* ************************************************************************* */
+void DynamicsDerivatives::inverseJacobians(const std::vector<Pose3> &poses,
+                                           const std::vector<Vector6> &twists,
+                                           const Vector &joint_vels,
+                                           const Vector &joint_accels) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  if (poses.size() != num_links || twists.size() != num_links ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(joint_accels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "DynamicsDerivatives: input sizes do not match the robot");
+  }
+
+  // Newton-Euler, with gravity as an upward acceleration of the fixed root:
+  // A_b = X * A_a + S * qddot + ad(V_b) * S * qdot, F = G * A - ad(V)^T G V.
+  const int root = tree_.root;
+  A_[root].setZero();
+  if (gravity_) {
+    A_[root].tail<3>() = -poses[root].rotation().unrotate(*gravity_);
+  }
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const Vector6 &S = tree_.screw[b];
+    X_[b] = (poses[b].inverse() * poses[a]).AdjointMap();
+    A_[b] = X_[b] * A_[a] + S * joint_accels(j) +
+            Pose3::adjointMap(twists[b]) * S * joint_vels(j);
+  }
+  for (size_t i = 0; i < num_links; i++) {
+    f_[i] = inertias_[i] * A_[i] -
+            Pose3::adjointMap(twists[i]).transpose() * inertias_[i] *
+                twists[i];
+  }
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k];
+    f_[tree_.parent[b]] += X_[b].transpose() * f_[b];
+  }
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k];
+    torques_(tree_.joint[b]) = tree_.screw[b].dot(f_[b]);
+  }
+
+  // Differentiate the recursion wrt the angle, then the velocity, of the
+  // joint of every link bj. Only X_bj depends on its angle, with
+  // dX/dq = -ad(S) * X, and only the subtree of bj moves.
+  for (size_t kj = 1; kj < tree_.order.size(); kj++) {
+    const int bj = tree_.order[kj], col = tree_.joint[bj];
+    for (const bool wrt_angle : {true, false}) {
+      std::fill(moved_.begin(), moved_.end(), false);
+      for (size_t i = 0; i < num_links; i++) df_[i].setZero();
+
+      // Forward pass over the subtree of bj, which comes after it in BFS.
+      for (size_t k = kj; k < tree_.order.size(); k++) {
+        const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+        if (b != bj && !moved_[a]) continue;
+        moved_[b] = true;
+        const Vector6 &S = tree_.screw[b];
+        if (b != bj) {
+          dV_[b] = X_[b] * dV_[a];
+          dA_[b] = X_[b] * dA_[a];
+        } else if (wrt_angle) {
+          const Matrix6 dX = -Pose3::adjointMap(S) * X_[b];
+          dV_[b] = dX * twists[a];
+          dA_[b] = dX * A_[a];
+        } else {
+          dV_[b] = S;
+          dA_[b] = Pose3::adjointMap(twists[b]) * S;
+        }
+        dA_[b] += Pose3::adjointMap(dV_[b]) * S * joint_vels(j);
+        const Matrix6 &G = inertias_[b];
+        df_[b] = G * dA_[b] -
+                 Pose3::adjointMap(dV_[b]).transpose() * G * twists[b] -
+                 Pose3::adjointMap(twists[b]).transpose() * G * dV_[b];
+      }
+
+      // Backward pass: wrenches change in the subtree and towards the root.
+      for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+        const int b = tree_.order[k], a = tree_.parent[b];
+        if (b == bj && wrt_angle) {
+          df_[a] -= X_[b].transpose() *
+                    Pose3::adjointMap(tree_.screw[b]).transpose() * f_[b];
+        }
+        df_[a] += X_[b].transpose() * df_[b];
+      }
+
+      Matrix &H = wrt_angle ? H_q_ : H_v_;
+      for (size_t k = 1; k < tree_.order.size(); k++) {
+        const int b = tree_.order[k];
+        H(tree_.joint[b], col) = tree_.screw[b].dot(df_[b]);
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+void DynamicsDerivatives::solveInverse(const std::vector<Pose3> &poses,
+                                       const std::vector<Vector6> &twists,
+                                       const Vector &joint_vels,
+                                       const Vector &joint_accels) {
+  inverseJacobians(poses, twists, joint_vels, joint_accels);
+  joint_accels_ = joint_accels;
+  crba_.solve(poses, twists, joint_vels);
+  H_u_ = crba_.massMatrix();
+}
+
+/* ************************************************************************* */
+void DynamicsDerivatives::solveForward(const std::vector<Pose3> &poses,
+                                       const std::vector<Vector6> &twists,
+                                       const Vector &joint_vels,
+                                       const Vector &torques) {
+  if (size_t(torques.size()) != tree_.joints.size()) {
+    throw std::invalid_argument(
+        "DynamicsDerivatives: input sizes do not match the robot");
+  }
+  crba_.solve(poses, twists, joint_vels);
+  const Eigen::LDLT<Matrix> M = crba_.massMatrix().ldlt();
+  const Vector joint_accels = M.solve(torques - crba_.biasForces());
+
+  // Differentiate ID(q, qdot, FD(q, qdot, tau)) = tau.
+  inverseJacobians(poses, twists, joint_vels, joint_accels);
+  joint_accels_ = joint_accels;
+  torques_ = torques;
+  H_q_ = -M.solve(H_q_);
+  H_v_ = -M.solve(H_v_);
+  H_u_ = M.solve(Matrix::Identity(torques.size(), torques.size()));
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsDerivatives.h
+ * @brief Analytic derivatives of forward and inverse dynamics of fixed-base
+ * tree-structured robots.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * DynamicsDerivatives computes the Jacobians of inverse dynamics,
+ * tau = ID(q, qdot, qddot), and of forward dynamics, qddot = FD(q, qdot, tau),
+ * analytically, as needed by gradient-based MPC such as DDP.
+ *
+ * The inverse dynamics Jacobians differentiate the recursive Newton-Euler
+ * algorithm in the twist/wrench conventions of the dynamics factors, one
+ * joint at a time: moving joint j only changes the twists and accelerations
+ * of the subtree beyond it, and the wrenches on the path back to the root.
+ * The Jacobian wrt qddot is the mass matrix M, and the forward dynamics
+ * Jacobians follow as dFD/d(q, qdot) = -M^-1 dID/d(q, qdot) and
+ * dFD/dtau = M^-1.
+ *
+ * The poses and twists given to solve must be those of forward kinematics at
+ * the joint angles and velocities that the Jacobians are taken with respect
+ * to. Only kinematic trees with a fixed root link are supported.
+ */
+class DynamicsDerivatives {
+ private:
+  KinematicTree tree_;
+  boost::optional<gtsam::Vector3> gravity_;
+  CompositeRigidBodyDynamics crba_;
+
+  std::vector<gtsam::Matrix6> inertias_;
+
+  /// Per-solve buffers, indexed by link: relative adjoints, twist
+  /// accelerations including gravity, wrenches through the tree joint, their
+  /// derivatives wrt one joint coordinate, and subtree membership.
+  std::vector<gtsam::Matrix6> X_;
+  std::vector<gtsam::Vector6> A_, f_, dV_, dA_, df_;
+  std::vector<bool> moved_;
+
+  /// Results of the last solve.
+  gtsam::Vector torques_, joint_accels_;
+  gtsam::Matrix H_q_, H_v_, H_u_;
+
+  /// Torques, and Jacobians of torques wrt joint angles and velocities.
+  void inverseJacobians(const std::vector<gtsam::Pose3> &poses,
+                        const std::vector<gtsam::Vector6> &twists,
+                        const gtsam::Vector &joint_vels,
+                        const gtsam::Vector &joint_accels);
+
+ public:
+  /**
+   * Constructor, extracts the tree topology of the robot.
+   * @param robot    the robot, must be a kinematic tree with a fixed link
+   * @param gravity  gravity in world frame
+   */
+  explicit DynamicsDerivatives(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Number of joints in the robot.
+  size_t numJoints() const { return tree_.joints.size(); }
+
+  /**
+   * Inverse dynamics and its Jacobians wrt q, qdot and qddot.
+   *
+   * @param poses        CoM pose of every link, in Robot::links() order
+   * @param twists       twist of every link, in Robot::links() order
+   * @param joint_vels   joint velocities, in Robot::joints() order
+   * @param joint_accels joint accelerations, in Robot::joints() order
+   */
+  void solveInverse(const std::vector<gtsam::Pose3> &poses,
+                    const std::vector<gtsam::Vector6> &twists,
+                    const gtsam::Vector &joint_vels,
+                    const gtsam::Vector &joint_accels);
+
+  /**
+   * Forward dynamics and its Jacobians wrt q, qdot and tau.
+   *
+   * @param poses      CoM pose of every link, in Robot::links() order
+   * @param twists     twist of every link, in Robot::links() order
+   * @param joint_vels joint velocities, in Robot::joints() order
+   * @param torques    joint torques, in Robot::joints() order
+   */
+  void solveForward(const std::vector<gtsam::Pose3> &poses,
+                    const std::vector<gtsam::Vector6> &twists,
+                    const gtsam::Vector &joint_vels,
+                    const gtsam::Vector &torques);
+
+  /// Torques of the last solve, in joint order.
+  const gtsam::Vector &torques() const { return torques_; }
+
+  /// Joint accelerations of the last solve, in joint order.
+  const gtsam::Vector &jointAccels() const { return joint_accels_; }
+
+  /// Jacobian of the output of the last solve wrt joint angles.
+  const gtsam::Matrix &H_q() const { return H_q_; }
+
+  /// Jacobian of the output of the last solve wrt joint velocities.
+  const gtsam::Matrix &H_v() const { return H_v_; }
+
+  /// Jacobian of the output of the last solve wrt its last input: joint
+  /// accelerations for solveInverse, torques for solveForward.
+  const gtsam::Matrix &H_u() const { return H_u_; }
+};
+
+}  // namespace gtdynamics
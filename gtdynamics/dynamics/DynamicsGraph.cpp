@@ -11,14 +11,20 @@
  * @author Yetong Zhang, Alejandro Escontrela
  */
 
+#include <gtdynamics/dynamics/CompiledForwardDynamics.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ContactDynamicsBlockFactor.h>
 #include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
 #include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
 #include <gtdynamics/factors/ContactHeightFactor.h>
 #include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
 #include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/factors/JointLimitBlockFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
@@ -29,9 +35,14 @@
 #include <boost/format.hpp>
 
 #include <algorithm>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -51,10 +62,17 @@ using gtsam::Z_6x1;
 
 namespace gtdynamics {
 
+// Same as graph->addPrior, but allocated from the current GraphArena, if any.
+template <class T>
+static void AddPrior(NonlinearFactorGraph *graph, Key key, const T &prior,
+                     const gtsam::SharedNoiseModel &model) {
+  graph->push_back(MakeShared<PriorFactor<T>>(key, prior, model));
+}
+
 GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
     const Robot &robot, const int t, const gtsam::Values &known_values) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(6);
+  auto all_constrained = SharedConstrained(6);
   for (auto &&link : robot.links()) {
     int i = link->id();
     if (link->isFixed()) {
@@ -113,7 +131,7 @@ GaussianFactorGraph DynamicsGraph::linearFDPriors(
 GaussianFactorGraph DynamicsGraph::linearIDPriors(
     const Robot &robot, const int t, const gtsam::Values &joint_accels) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(1);
+  auto all_constrained = SharedConstrained(1);
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     double accel = JointAccel(joint_accels, j, t);
@@ -148,7 +166,7 @@ Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
       InsertTwistAccel(&values, i, t, TwistAccel(results, i, t));
     }
   } catch (const gtsam::ValuesKeyAlreadyExists &e) {
-    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    ReportDiagnostic("key already exists:", e.key());
     throw std::invalid_argument(
         "linearSolveFD: known_values should contain no accelerations or "
         "wrenches");
@@ -184,7 +202,7 @@ Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
       InsertTwistAccel(&values, i, t, TwistAccel(results, i, t));
     }
   } catch (const gtsam::ValuesKeyAlreadyExists &e) {
-    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    ReportDiagnostic("key already exists:", e.key());
     throw std::invalid_argument(
         "linearSolveID: known_values should contain no torques, "
         "wrenches, or twist accelerations.");
@@ -192,20 +210,78 @@ Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
   return values;
 }
 
+Values DynamicsGraph::linearSolveHybrid(
+    const Robot &robot, const int t, const gtsam::Values &known_values,
+    const std::vector<bool> &joint_mode_mask) {
+  if (joint_mode_mask.size() != robot.numJoints()) {
+    throw std::invalid_argument(
+        "linearSolveHybrid: joint_mode_mask must have one entry per joint");
+  }
+  return compiledSolve(robot, t, known_values, joint_mode_mask,
+                       PointOnLinks());
+}
+
+Values DynamicsGraph::linearSolveContactFD(const Robot &robot, const int t,
+                                           const gtsam::Values &known_values,
+                                           const PointOnLinks &contact_points) {
+  return compiledSolve(robot, t, known_values,
+                       std::vector<bool>(robot.numJoints(), false),
+                       contact_points);
+}
+
+Values DynamicsGraph::compiledSolve(const Robot &robot, const int t,
+                                    const gtsam::Values &known_values,
+                                    const std::vector<bool> &mask,
+                                    const PointOnLinks &contact_points) {
+  CompiledKey key;
+  key.first = mask;
+  for (auto &&cp : contact_points) {
+    key.second.push_back(
+        {double(cp.link->id()), cp.point.x(), cp.point.y(), cp.point.z()});
+  }
+  // A solver is stale once its topology is gone, even if a new robot's
+  // topology was allocated at the same address.
+  const auto topology = robot.sharedTopology();
+  std::lock_guard<std::mutex> lock(compiled_solvers_.mutex);
+  CompiledSolver &compiled = compiled_solvers_.solvers[key];
+  if (!compiled.solver || compiled.topology.lock() != topology) {
+    compiled.topology = topology;
+    compiled.solver = std::make_shared<CompiledForwardDynamics>(
+        robot, gravity_, planar_axis_, mask, contact_points);
+  }
+  return compiled.solver->solve(t, known_values);
+}
+
+ShardedValues DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
+                                           const ShardedValues &known_values) {
+  ShardedValues values = known_values;
+  values.setSlice(t, linearSolveFD(robot, t, known_values.slice(t)));
+  return values;
+}
+
+ShardedValues DynamicsGraph::linearSolveID(const Robot &robot, const int t,
+                                           const ShardedValues &known_values) {
+  ShardedValues values = known_values;
+  values.setSlice(t, linearSolveID(robot, t, known_values.slice(t)));
+  return values;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
     const Robot &robot, const int k,
     const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior(PoseKey(link->id(), k), link->getFixedPose(),
-                     opt_.bp_cost_model);
+      AddPrior(&graph, PoseKey(link->id(), k), link->getFixedPose(),
+               opt_.bp_cost_model);
 
   // TODO(frank): call Kinematics::graph<Slice> instead
   for (auto &&joint : robot.joints()) {
     graph.add(PoseFactor(
         PoseKey(joint->parent()->id(), k), PoseKey(joint->child()->id(), k),
-        JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
+        JointAngleKey(joint->id(), k), opt_.p_cost_model, joint,
+        opt_.analytic_factors));
   }
 
   // TODO(frank): whoever write this should clean up this mess.
@@ -218,9 +294,8 @@ gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactHeightFactor contact_pose_factor(
-          PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point, gravity);
-      graph.add(contact_pose_factor);
+      graph.push_back(MakeShared<ContactHeightFactor>(
+          PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point, gravity));
     }
   }
 
@@ -230,22 +305,23 @@ gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.bv_cost_model);
+      AddPrior<gtsam::Vector6>(&graph, TwistKey(link->id(), t), gtsam::Z_6x1,
+                               opt_.bv_cost_model);
 
   for (auto &&joint : robot.joints())
-    graph.add(TwistFactor(opt_.v_cost_model, joint, t));
+    graph.add(
+        TwistFactor(opt_.v_cost_model, joint, t, opt_.analytic_factors));
 
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsTwistFactor contact_twist_factor(
+      graph.push_back(MakeShared<ContactKinematicsTwistFactor>(
           TwistKey(cp.link->id(), t), opt_.cv_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_twist_factor);
+          gtsam::Pose3(gtsam::Rot3(), -cp.point)));
     }
   }
 
@@ -255,21 +331,22 @@ gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::aFactors(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistAccelKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.ba_cost_model);
+      AddPrior<gtsam::Vector6>(&graph, TwistAccelKey(link->id(), t),
+                               gtsam::Z_6x1, opt_.ba_cost_model);
   for (auto &&joint : robot.joints())
-    graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+    graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t,
+                               opt_.analytic_factors));
 
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsAccelFactor contact_accel_factor(
+      graph.push_back(MakeShared<ContactKinematicsAccelFactor>(
           TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_accel_factor);
+          gtsam::Pose3(gtsam::Rot3(), -cp.point)));
     }
   }
 
@@ -281,6 +358,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
     const Robot &robot, const int k,
     const boost::optional<PointOnLinks> &contact_points,
     const boost::optional<double> &mu) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
 
   // TODO(frank): whoever write this should clean up this mess.
@@ -296,6 +374,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
   else
     mu_ = 1.0;
 
+  std::vector<ContactDynamicsBlockFactor::Contact> contacts;
   for (auto &&link : robot.links()) {
     int i = link->id();
     if (!link->isFixed()) {
@@ -315,13 +394,17 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
           wrench_keys.push_back(wrench_key);
 
           // Add contact dynamics constraints.
-          graph.emplace_shared<ContactDynamicsFrictionConeFactor>(
+          const gtsam::Pose3 cTcom(gtsam::Rot3(), -cp.point);
+          if (opt_.contact_block_factors) {
+            contacts.push_back({PoseKey(i, k), wrench_key, cTcom});
+            continue;
+          }
+          graph.push_back(MakeShared<ContactDynamicsFrictionConeFactor>(
               PoseKey(i, k), wrench_key, opt_.cfriction_cost_model, mu_,
-              gravity);
+              gravity));
 
-          graph.emplace_shared<ContactDynamicsMomentFactor>(
-              wrench_key, opt_.cm_cost_model,
-              gtsam::Pose3(gtsam::Rot3(), -cp.point));
+          graph.push_back(MakeShared<ContactDynamicsMomentFactor>(
+              wrench_key, opt_.cm_cost_model, cTcom));
         }
       }
 
@@ -330,14 +413,21 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
           WrenchFactor(opt_.fa_cost_model, link, wrench_keys, k, gravity));
     }
   }
+  if (!contacts.empty()) {
+    graph.push_back(MakeShared<ContactDynamicsBlockFactor>(
+        contacts, opt_.cfriction_cost_model, opt_.cm_cost_model, mu_,
+        gravity));
+  }
 
   // TODO(frank): use Statics<Slice> calls
   // TODO(frank): sort out const shared ptr mess
   for (auto &&joint : robot.joints()) {
     auto j = joint->id(), child_id = joint->child()->id();
     auto const_joint = joint;
-    graph.add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k));
-    graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k));
+    graph.add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k,
+                                      opt_.analytic_factors));
+    graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k,
+                           opt_.analytic_factors));
     if (planar_axis_)
       graph.add(WrenchPlanarFactor(opt_.planar_cost_model, *planar_axis_,
                                    const_joint, k));
@@ -350,10 +440,68 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactorGraph(
     const boost::optional<PointOnLinks> &contact_points,
     const boost::optional<double> &mu) const {
   NonlinearFactorGraph graph;
-  graph.add(qFactors(robot, t, contact_points));
-  graph.add(vFactors(robot, t, contact_points));
-  graph.add(aFactors(robot, t, contact_points));
-  graph.add(dynamicsFactors(robot, t, contact_points, mu));
+  graph.reserve(numFactorsEstimate(robot, contact_points));
+  addDynamicsFactorGraph(&graph, robot, t, contact_points, mu);
+  return graph;
+}
+
+void DynamicsGraph::addDynamicsFactorGraph(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  appendFactors(graph, qFactors(robot, t, contact_points));
+  appendFactors(graph, vFactors(robot, t, contact_points));
+  appendFactors(graph, aFactors(robot, t, contact_points));
+  appendFactors(graph, dynamicsFactors(robot, t, contact_points, mu));
+}
+
+size_t DynamicsGraph::numFactorsEstimate(
+    const Robot &robot,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  size_t num_fixed = 0;
+  for (auto &&link : robot.links()) num_fixed += link->isFixed();
+  const size_t num_links = robot.numLinks(), num_joints = robot.numJoints();
+  const size_t num_contacts = contact_points ? contact_points->size() : 0;
+
+  // Priors on fixed links, joint factors and contact factors at q, v and a.
+  size_t count = 3 * (num_fixed + num_joints + num_contacts);
+  // Link wrench balance, contact wrenches, and joint wrench factors.
+  count += num_links - num_fixed;
+  if (opt_.contact_block_factors) {
+    count += num_contacts > 0;
+  } else {
+    count += 2 * num_contacts;
+  }
+  count += (planar_axis_ ? 3 : 2) * num_joints;
+  // Angle and velocity collocation.
+  return count + 2 * num_joints;
+}
+
+void DynamicsGraph::appendFactors(NonlinearFactorGraph *graph,
+                                  NonlinearFactorGraph &&factors) {
+  graph->push_back(std::make_move_iterator(factors.begin()),
+                   std::make_move_iterator(factors.end()));
+  factors.resize(0);
+}
+
+// Build independent parts of a graph concurrently, then concatenate them in
+// the order of `parts`, so the factor ordering does not depend on threading.
+static NonlinearFactorGraph BuildInParallel(
+    const std::vector<std::function<NonlinearFactorGraph()>> &parts,
+    size_t num_threads, FactorTimeIndex *index) {
+  std::vector<NonlinearFactorGraph> graphs(parts.size());
+  ParallelFor(parts.size(), num_threads,
+              [&](size_t i) { graphs[i] = parts[i](); });
+
+  size_t total = 0;
+  for (auto &&g : graphs) total += g.size();
+  NonlinearFactorGraph graph;
+  graph.reserve(total);
+  for (auto &&g : graphs) {
+    if (index) index->add(g);
+    graph.push_back(std::make_move_iterator(g.begin()),
+                    std::make_move_iterator(g.end()));
+  }
   return graph;
 }
 
@@ -361,15 +509,22 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFG(
     const Robot &robot, const int num_steps, const double dt,
     const CollocationScheme collocation,
     const boost::optional<PointOnLinks> &contact_points,
-    const boost::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
+    const boost::optional<double> &mu, FactorTimeIndex *index) const {
+  GTDYNAMICS_TRACE_SCOPE("DynamicsGraph::trajectoryFG");
+  std::vector<std::function<NonlinearFactorGraph()>> parts;
   for (int t = 0; t < num_steps + 1; t++) {
-    graph.add(dynamicsFactorGraph(robot, t, contact_points, mu));
-    if (t < num_steps) {
-      graph.add(collocationFactors(robot, t, dt, collocation));
-    }
+    parts.push_back([=, &robot, &contact_points, &mu]() {
+      GTDYNAMICS_TRACE_SCOPE_ARG("DynamicsGraph::step", t);
+      NonlinearFactorGraph graph;
+      graph.reserve(numFactorsEstimate(robot, contact_points));
+      addDynamicsFactorGraph(&graph, robot, t, contact_points, mu);
+      if (t < num_steps) {
+        addCollocationFactors(&graph, robot, t, dt, collocation);
+      }
+      return graph;
+    });
   }
-  return graph;
+  return BuildInParallel(parts, opt_.num_threads, index);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
@@ -377,8 +532,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     const std::vector<gtsam::NonlinearFactorGraph> &transition_graphs,
     const CollocationScheme collocation,
     const boost::optional<std::vector<PointOnLinks>> &phase_contact_points,
-    const boost::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
+    const boost::optional<double> &mu, FactorTimeIndex *index) const {
   int num_phases = phase_steps.size();
 
   // Return either PointOnLinks or None if none specified for phase p
@@ -388,22 +542,30 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     return boost::none;
   };
 
+  std::vector<std::function<NonlinearFactorGraph()>> parts;
+  auto dynamics = [&](int k, int p) {
+    parts.push_back([=, &robot, &contact_points, &mu]() {
+      return dynamicsFactorGraph(robot, k, contact_points(p), mu);
+    });
+  };
+
   // First slice, k==0
-  graph.add(dynamicsFactorGraph(robot, 0, contact_points(0), mu));
+  dynamics(0, 0);
 
   int k = 0;
   for (int p = 0; p < num_phases; p++) {
     // in-phase
     // add dynamics for each step
     for (int step = 0; step < phase_steps[p] - 1; step++) {
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
+      dynamics(++k, p);
     }
     if (p == num_phases - 1) {
       // Last slice, k==K-1
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
+      dynamics(++k, p);
     } else {
       // transition
-      graph.add(transition_graphs[p]);
+      const NonlinearFactorGraph *transition = &transition_graphs[p];
+      parts.push_back([transition]() { return *transition; });
       k++;
     }
   }
@@ -411,11 +573,13 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
   // add collocation factors
   k = 0;
   for (int p = 0; p < num_phases; p++) {
-    for (int step = 0; step < phase_steps[p]; step++) {
-      graph.add(multiPhaseCollocationFactors(robot, k++, p, collocation));
+    for (int step = 0; step < phase_steps[p]; step++, k++) {
+      parts.push_back([=, &robot]() {
+        return multiPhaseCollocationFactors(robot, k, p, collocation);
+      });
     }
   }
-  return graph;
+  return BuildInParallel(parts, opt_.num_threads, index);
 }
 
 void DynamicsGraph::addCollocationFactorDouble(
@@ -428,18 +592,37 @@ void DynamicsGraph::addCollocationFactorDouble(
   Double_ v0_expr(v0_key);
   Double_ v1_expr(v1_key);
   if (collocation == CollocationScheme::Euler) {
-    graph->add(
-        ExpressionFactor(cost_model, 0.0, x0_expr + dt * v0_expr - x1_expr));
+    graph->push_back(MakeShared<ExpressionFactor<double>>(
+        cost_model, 0.0, x0_expr + dt * v0_expr - x1_expr));
   } else if (collocation == CollocationScheme::Trapezoidal) {
-    graph->add(ExpressionFactor(
+    graph->push_back(MakeShared<ExpressionFactor<double>>(
         cost_model, 0.0,
         x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr - x1_expr));
+  } else if (collocation == CollocationScheme::HermiteSimpson) {
+    throw std::invalid_argument(
+        "hermite-simpson collocation needs accelerations, use "
+        "addHermiteSimpsonFactorDouble");
   } else {
-    throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+    throw std::runtime_error("runge-kutta not implemented yet");
   }
 }
 
+void DynamicsGraph::addHermiteSimpsonFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const double dt, const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0_expr(v0_key);
+  Double_ v1_expr(v1_key);
+  Double_ a0_expr(a0_key);
+  Double_ a1_expr(a1_key);
+  graph->push_back(MakeShared<ExpressionFactor<double>>(
+      cost_model, 0.0,
+      x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr +
+          (dt * dt / 12) * a0_expr - (dt * dt / 12) * a1_expr - x1_expr));
+}
+
 // the * operator for doubles in expression factor does not work well yet
 double multDouble(const double &d1, const double &d2,
                   gtsam::OptionalJacobian<1, 1> H1,
@@ -462,56 +645,126 @@ void DynamicsGraph::addMultiPhaseCollocationFactorDouble(
   Double_ v0dt(multDouble, phase_expr, v0_expr);
 
   if (collocation == CollocationScheme::Euler) {
-    graph->add(ExpressionFactor(cost_model, 0.0, x0_expr + v0dt - x1_expr));
+    graph->push_back(MakeShared<ExpressionFactor<double>>(
+        cost_model, 0.0, x0_expr + v0dt - x1_expr));
   } else if (collocation == CollocationScheme::Trapezoidal) {
     Double_ v1dt(multDouble, phase_expr, v1_expr);
-    graph->add(ExpressionFactor(cost_model, 0.0,
-                                x0_expr + 0.5 * v0dt + 0.5 * v1dt - x1_expr));
+    graph->push_back(MakeShared<ExpressionFactor<double>>(
+        cost_model, 0.0, x0_expr + 0.5 * v0dt + 0.5 * v1dt - x1_expr));
+  } else if (collocation == CollocationScheme::HermiteSimpson) {
+    throw std::invalid_argument(
+        "hermite-simpson collocation needs accelerations, use "
+        "addMultiPhaseHermiteSimpsonFactorDouble");
   } else {
-    throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+    throw std::runtime_error("runge-kutta not implemented yet");
+  }
+}
+
+void DynamicsGraph::addMultiPhaseHermiteSimpsonFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const Key phase_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ phase_expr(phase_key);
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0_expr(v0_key);
+  Double_ v1_expr(v1_key);
+  Double_ a0_expr(a0_key);
+  Double_ a1_expr(a1_key);
+  Double_ vdt(multDouble, phase_expr, v0_expr + v1_expr);
+  Double_ adt2(multDouble, phase_expr,
+               Double_(multDouble, phase_expr, a0_expr - a1_expr));
+  graph->push_back(MakeShared<ExpressionFactor<double>>(
+      cost_model, 0.0, x0_expr + 0.5 * vdt + (1.0 / 12) * adt2 - x1_expr));
+}
+
+// Collocation factors of joint j from t to t+1, appended to graph.
+static void AddJointCollocationFactors(NonlinearFactorGraph *graph,
+                                       const OptimizerSetting &opt,
+                                       const int j, const int t,
+                                       const double dt,
+                                       const CollocationScheme collocation) {
+  Key q0_key = JointAngleKey(j, t), q1_key = JointAngleKey(j, t + 1),
+      v0_key = JointVelKey(j, t), v1_key = JointVelKey(j, t + 1),
+      a0_key = JointAccelKey(j, t), a1_key = JointAccelKey(j, t + 1);
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    DynamicsGraph::addHermiteSimpsonFactorDouble(graph, q0_key, q1_key,
+                                                 v0_key, v1_key, a0_key,
+                                                 a1_key, dt,
+                                                 opt.q_col_cost_model);
+    DynamicsGraph::addCollocationFactorDouble(
+        graph, v0_key, v1_key, a0_key, a1_key, dt, opt.v_col_cost_model,
+        CollocationScheme::Trapezoidal);
+    return;
+  }
+  DynamicsGraph::addCollocationFactorDouble(graph, q0_key, q1_key, v0_key,
+                                            v1_key, dt, opt.q_col_cost_model,
+                                            collocation);
+  DynamicsGraph::addCollocationFactorDouble(graph, v0_key, v1_key, a0_key,
+                                            a1_key, dt, opt.v_col_cost_model,
+                                            collocation);
+}
+
+// Collocation factors of joint j from t to t+1 with dt the variable of the
+// phase, appended to graph.
+static void AddJointMultiPhaseCollocationFactors(
+    NonlinearFactorGraph *graph, const OptimizerSetting &opt, const int j,
+    const int t, const int phase, const CollocationScheme collocation) {
+  Key phase_key = PhaseKey(phase), q0_key = JointAngleKey(j, t),
+      q1_key = JointAngleKey(j, t + 1), v0_key = JointVelKey(j, t),
+      v1_key = JointVelKey(j, t + 1), a0_key = JointAccelKey(j, t),
+      a1_key = JointAccelKey(j, t + 1);
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    DynamicsGraph::addMultiPhaseHermiteSimpsonFactorDouble(
+        graph, q0_key, q1_key, v0_key, v1_key, a0_key, a1_key, phase_key,
+        opt.q_col_cost_model);
+    DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+        graph, v0_key, v1_key, a0_key, a1_key, phase_key,
+        opt.v_col_cost_model, CollocationScheme::Trapezoidal);
+    return;
   }
+  DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+      graph, q0_key, q1_key, v0_key, v1_key, phase_key, opt.q_col_cost_model,
+      collocation);
+  DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+      graph, v0_key, v1_key, a0_key, a1_key, phase_key, opt.v_col_cost_model,
+      collocation);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
     const int j, const int t, const double dt,
     const CollocationScheme collocation) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
-  Key q0_key = JointAngleKey(j, t), q1_key = JointAngleKey(j, t + 1),
-      v0_key = JointVelKey(j, t), v1_key = JointVelKey(j, t + 1),
-      a0_key = JointAccelKey(j, t), a1_key = JointAccelKey(j, t + 1);
-  addCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key, dt,
-                             opt_.q_col_cost_model, collocation);
-  addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
-                             opt_.v_col_cost_model, collocation);
+  AddJointCollocationFactors(&graph, opt_, j, t, dt, collocation);
   return graph;
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::collocationFactors(
     const Robot &robot, const int t, const double dt,
     const CollocationScheme collocation) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
+  graph.reserve(2 * robot.numJoints());
   for (auto &&joint : robot.joints()) {
-    int j = joint->id();
-    graph.add(jointCollocationFactors(j, t, dt, collocation));
+    AddJointCollocationFactors(&graph, opt_, joint->id(), t, dt, collocation);
   }
   return graph;
 }
 
+void DynamicsGraph::addCollocationFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const double dt, const CollocationScheme collocation) const {
+  appendFactors(graph, collocationFactors(robot, t, dt, collocation));
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
     const int j, const int t, const int phase,
     const CollocationScheme collocation) const {
-  Key phase_key = PhaseKey(phase), q0_key = JointAngleKey(j, t),
-      q1_key = JointAngleKey(j, t + 1), v0_key = JointVelKey(j, t),
-      v1_key = JointVelKey(j, t + 1), a0_key = JointAccelKey(j, t),
-      a1_key = JointAccelKey(j, t + 1);
-
-  gtsam::NonlinearFactorGraph graph;
-  addMultiPhaseCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key,
-                                       phase_key, opt_.q_col_cost_model,
-                                       collocation);
-  addMultiPhaseCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key,
-                                       phase_key, opt_.v_col_cost_model,
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  AddJointMultiPhaseCollocationFactors(&graph, opt_, j, t, phase,
                                        collocation);
   return graph;
 }
@@ -519,40 +772,51 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseCollocationFactors(
     const Robot &robot, const int t, const int phase,
     const CollocationScheme collocation) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
+  graph.reserve(2 * robot.numJoints());
   for (auto &&joint : robot.joints()) {
-    int j = joint->id();
-    graph.add(jointMultiPhaseCollocationFactors(j, t, phase, collocation));
+    AddJointMultiPhaseCollocationFactors(&graph, opt_, joint->id(), t, phase,
+                                         collocation);
   }
   return graph;
 }
 
+void DynamicsGraph::addMultiPhaseCollocationFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const int phase, const CollocationScheme collocation) const {
+  appendFactors(graph,
+                multiPhaseCollocationFactors(robot, t, phase, collocation));
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::forwardDynamicsPriors(
     const Robot &robot, const int t, const gtsam::Values &known_values) const {
+  GraphArena::Scope scope(arena_);
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, t), JointAngle(known_values, j, t),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, t), JointVel(known_values, j, t),
-                   opt_.prior_qv_cost_model);
-    graph.addPrior(TorqueKey(j, t), Torque(known_values, j, t),
-                   opt_.prior_t_cost_model);
+    AddPrior(&graph, JointAngleKey(j, t), JointAngle(known_values, j, t),
+             opt_.prior_q_cost_model);
+    AddPrior(&graph, JointVelKey(j, t), JointVel(known_values, j, t),
+             opt_.prior_qv_cost_model);
+    AddPrior(&graph, TorqueKey(j, t), Torque(known_values, j, t),
+             opt_.prior_t_cost_model);
   }
   return graph;
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::inverseDynamicsPriors(
     const Robot &robot, const int t, const gtsam::Values &known_values) const {
+  GraphArena::Scope scope(arena_);
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, t), JointAngle(known_values, j, t),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, t), JointVel(known_values, j, t),
-                   opt_.prior_qv_cost_model);
-    graph.addPrior(JointAccelKey(j, t), JointAccel(known_values, j, t),
-                   opt_.prior_qa_cost_model);
+    AddPrior(&graph, JointAngleKey(j, t), JointAngle(known_values, j, t),
+             opt_.prior_q_cost_model);
+    AddPrior(&graph, JointVelKey(j, t), JointVel(known_values, j, t),
+             opt_.prior_qv_cost_model);
+    AddPrior(&graph, JointAccelKey(j, t), JointAccel(known_values, j, t),
+             opt_.prior_qa_cost_model);
   }
   return graph;
 }
@@ -560,16 +824,17 @@ gtsam::NonlinearFactorGraph DynamicsGraph::inverseDynamicsPriors(
 gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
     const Robot &robot, const int num_steps,
     const gtsam::Values &known_values) const {
+  GraphArena::Scope scope(arena_);
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, 0), JointAngle(known_values, j, 0),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, 0), JointVel(known_values, j, 0),
-                   opt_.prior_qv_cost_model);
+    AddPrior(&graph, JointAngleKey(j, 0), JointAngle(known_values, j, 0),
+             opt_.prior_q_cost_model);
+    AddPrior(&graph, JointVelKey(j, 0), JointVel(known_values, j, 0),
+             opt_.prior_qv_cost_model);
     for (int t = 0; t <= num_steps; t++) {
-      graph.addPrior(TorqueKey(j, t), Torque(known_values, j, t),
-                     opt_.prior_t_cost_model);
+      AddPrior(&graph, TorqueKey(j, t), Torque(known_values, j, t),
+               opt_.prior_t_cost_model);
     }
   }
   return graph;
@@ -577,12 +842,125 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
 
 gtsam::NonlinearFactorGraph DynamicsGraph::jointLimitFactors(
     const Robot &robot, const int t) const {
+  GraphArena::Scope scope(arena_);
   NonlinearFactorGraph graph;
-  for (auto &&joint : robot.joints())
-    graph.add(joint->jointLimitFactors(t, opt_));
+  if (!opt_.joint_limit_block_factors) {
+    for (auto &&joint : robot.joints())
+      graph.add(joint->jointLimitFactors(t, opt_));
+    return graph;
+  }
+
+  // The limits of Joint::jointLimitFactors, all in one factor.
+  std::vector<JointLimitBlockFactor::Limit> limits;
+  limits.reserve(4 * robot.numJoints());
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const auto &params = joint->parameters();
+    const auto &scalar = params.scalar_limits;
+    limits.push_back({JointAngleKey(j, t),
+                      scalar.value_lower_limit + scalar.value_limit_threshold,
+                      scalar.value_upper_limit - scalar.value_limit_threshold});
+    limits.push_back({JointVelKey(j, t),
+                      -params.velocity_limit + params.velocity_limit_threshold,
+                      params.velocity_limit - params.velocity_limit_threshold});
+    limits.push_back(
+        {JointAccelKey(j, t),
+         -params.acceleration_limit + params.acceleration_limit_threshold,
+         params.acceleration_limit - params.acceleration_limit_threshold});
+    limits.push_back({TorqueKey(j, t),
+                      -params.torque_limit + params.torque_limit_threshold,
+                      params.torque_limit - params.torque_limit_threshold});
+  }
+  if (!limits.empty()) {
+    graph.push_back(
+        MakeShared<JointLimitBlockFactor>(limits, opt_.jl_cost_model));
+  }
   return graph;
 }
 
+InequalityConstraints DynamicsGraph::jointLimitConstraints(
+    const Robot &robot, const int t, const double tolerance) const {
+  InequalityConstraints constraints;
+  auto add_limits = [&](gtsam::Key key, double low, double high) {
+    gtsam::Double_ value(key);
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        value - gtsam::Double_(low), tolerance);
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        gtsam::Double_(high) - value, tolerance);
+  };
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const auto &params = joint->parameters();
+    const auto &limits = params.scalar_limits;
+    add_limits(JointAngleKey(j, t),
+               limits.value_lower_limit + limits.value_limit_threshold,
+               limits.value_upper_limit - limits.value_limit_threshold);
+    add_limits(JointVelKey(j, t),
+               -params.velocity_limit + params.velocity_limit_threshold,
+               params.velocity_limit - params.velocity_limit_threshold);
+    add_limits(JointAccelKey(j, t),
+               -params.acceleration_limit + params.acceleration_limit_threshold,
+               params.acceleration_limit - params.acceleration_limit_threshold);
+    add_limits(TorqueKey(j, t),
+               -params.torque_limit + params.torque_limit_threshold,
+               params.torque_limit - params.torque_limit_threshold);
+  }
+  return constraints;
+}
+
+/// Friction cone margin mu^2 f_up^2 - f_a^2 - f_b^2 of the spatial contact
+/// force, see ContactDynamicsFrictionConeFactor.
+class FrictionConeMargin {
+ private:
+  gtsam::Vector3 weights_;
+
+ public:
+  FrictionConeMargin(double mu, const gtsam::Vector3 &gravity)
+      : weights_(-gtsam::Vector3::Ones()) {
+    const int up_axis = gravity[0] != 0 ? 0 : (gravity[1] != 0 ? 1 : 2);
+    weights_[up_axis] = mu * mu;
+  }
+
+  double operator()(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &wrench,
+      gtsam::OptionalJacobian<1, 6> H_pose = boost::none,
+      gtsam::OptionalJacobian<1, 6> H_wrench = boost::none) const {
+    const gtsam::Vector3 f_c = wrench.tail<3>();
+    const gtsam::Matrix3 R = pose.rotation().matrix();
+    const gtsam::Vector3 f_s = R * f_c;
+    const Eigen::RowVector3d H_f_s = 2 * weights_.cwiseProduct(f_s).transpose();
+    if (H_pose) {
+      H_pose->setZero();
+      H_pose->leftCols<3>() = -H_f_s * R * gtsam::skewSymmetric(f_c);
+    }
+    if (H_wrench) {
+      H_wrench->setZero();
+      H_wrench->rightCols<3>() = H_f_s * R;
+    }
+    return weights_.dot(f_s.cwiseProduct(f_s));
+  }
+};
+
+InequalityConstraints DynamicsGraph::frictionConeConstraints(
+    const Robot &robot, const int t, const PointOnLinks &contact_points,
+    const boost::optional<double> &mu, const double tolerance) const {
+  const gtsam::Vector3 gravity =
+      gravity_ ? *gravity_ : gtsam::Vector3(0, 0, -9.8);
+  const FrictionConeMargin margin(mu ? *mu : 1.0, gravity);
+
+  InequalityConstraints constraints;
+  for (auto &&cp : contact_points) {
+    if (robot.link(cp.link->name())->isFixed()) continue;
+    const int i = cp.link->id();
+    gtsam::Expression<gtsam::Pose3> pose(gtsam::Key(PoseKey(i, t)));
+    gtsam::Expression<gtsam::Vector6> wrench(
+        gtsam::Key(ContactWrenchKey(i, 0, t)));
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        gtsam::Double_(margin, pose, wrench), tolerance);
+  }
+  return constraints;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::targetAngleFactors(
     const Robot &robot, const int t, const std::string &joint_name,
     const double target_angle) const {
@@ -653,6 +1031,30 @@ gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
   return joint_torques;
 }
 
+gtsam::Vector DynamicsGraph::jointAccels(const Robot &robot,
+                                         const TrajectoryBuffer &buffer,
+                                         const int t) {
+  return buffer.jointAccels().row(t).transpose();
+}
+
+gtsam::Vector DynamicsGraph::jointVels(const Robot &robot,
+                                       const TrajectoryBuffer &buffer,
+                                       const int t) {
+  return buffer.jointVels().row(t).transpose();
+}
+
+gtsam::Vector DynamicsGraph::jointAngles(const Robot &robot,
+                                         const TrajectoryBuffer &buffer,
+                                         const int t) {
+  return buffer.jointAngles().row(t).transpose();
+}
+
+gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
+                                          const TrajectoryBuffer &buffer,
+                                          const int t) {
+  return buffer.torques().row(t).transpose();
+}
+
 JointValueMap DynamicsGraph::jointAccelsMap(const Robot &robot,
                                             const gtsam::Values &result,
                                             const int t) {
@@ -830,6 +1232,51 @@ void DynamicsGraph::saveGraphMultiSteps(
   json_file.close();
 }
 
+void DynamicsGraph::saveGraphSummary(const std::string &file_path,
+                                     const gtsam::NonlinearFactorGraph &graph,
+                                     const gtsam::Values &values,
+                                     size_t steps_per_chunk) {
+  // Chunks are named after the summary, without its directory, as the viewer
+  // loads them relative to the summary.
+  std::string stem = file_path;
+  const size_t dot = stem.rfind('.'), slash = stem.find_last_of("/\\");
+  if (dot != std::string::npos &&
+      (slash == std::string::npos || dot > slash)) {
+    stem.erase(dot);
+  }
+  const std::string directory =
+      slash == std::string::npos ? "" : file_path.substr(0, slash + 1);
+  const std::string base = stem.substr(directory.size());
+  auto chunk_file = [&](uint64_t chunk) {
+    return base + "_" + std::to_string(chunk) + ".json";
+  };
+
+  std::ofstream json_file(file_path);
+  if (!json_file) {
+    throw std::runtime_error("DynamicsGraph: cannot write " + file_path);
+  }
+  std::function<std::string(uint64_t)> chunk_name;
+  if (steps_per_chunk > 0) {
+    chunk_name = [&](uint64_t step) {
+      return chunk_file(step / steps_per_chunk);
+    };
+  }
+  JsonSaver::SaveSummarizedGraph(graph, json_file, values, chunk_name);
+  json_file.close();
+  if (steps_per_chunk == 0) return;
+
+  std::map<uint64_t, gtsam::NonlinearFactorGraph> chunks;
+  for (const auto &factor : graph) {
+    if (factor) {
+      chunks[JsonSaver::GetStep(factor) / steps_per_chunk].push_back(factor);
+    }
+  }
+  for (const auto &chunk : chunks) {
+    std::ofstream chunk_json(directory + chunk_file(chunk.first));
+    JsonSaver::SaveFactorGraph(chunk.second, chunk_json, values);
+  }
+}
+
 /* classify the variables into different clusters */
 typedef std::pair<std::string, int> ClusterInfo;
 
@@ -14,20 +14,33 @@
 #pragma once
 
 #include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorTimeIndex.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/ShardedValues.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
 #include <boost/optional.hpp>
+#include <boost/weak_ptr.hpp>
+#include <array>
 #include <cmath>
 #include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace gtdynamics {
 
+class CompiledForwardDynamics;
+
 using JointValueMap = std::map<std::string, double>;
 
 /// Shorthand for C_i_c_k, for contact wrench c on i-th link at time step k.
@@ -53,9 +66,41 @@ enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
  * motion planning
  */
 class DynamicsGraph {
- private:
+ protected:
   OptimizerSetting opt_;
   boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+  std::shared_ptr<GraphArena> arena_;
+
+ private:
+  /// Solvers of linearSolveHybrid and linearSolveContactFD, keyed on the
+  /// known-acceleration mask and the contact links and points, with the
+  /// topology of the robot they were compiled for. Solvers keep state, so
+  /// lookups and solves hold the mutex. Copies of a DynamicsGraph compile
+  /// their own solvers.
+  using CompiledKey =
+      std::pair<std::vector<bool>, std::vector<std::array<double, 4>>>;
+  struct CompiledSolver {
+    boost::weak_ptr<const RobotTopology> topology;
+    std::shared_ptr<CompiledForwardDynamics> solver;
+  };
+  struct CompiledSolvers {
+    std::mutex mutex;
+    std::map<CompiledKey, CompiledSolver> solvers;
+    CompiledSolvers() = default;
+    CompiledSolvers(const CompiledSolvers &) {}
+    CompiledSolvers &operator=(const CompiledSolvers &) {
+      std::lock_guard<std::mutex> lock(mutex);
+      solvers.clear();
+      return *this;
+    }
+  };
+  CompiledSolvers compiled_solvers_;
+
+  /// Solve with the cached solver for the given mask and contacts.
+  gtsam::Values compiledSolve(const Robot &robot, const int t,
+                              const gtsam::Values &known_values,
+                              const std::vector<bool> &mask,
+                              const PointOnLinks &contact_points);
 
  public:
   /**
@@ -82,7 +127,18 @@ class DynamicsGraph {
       const boost::optional<gtsam::Vector3> &planar_axis = boost::none)
       : opt_(opt), gravity_(gravity), planar_axis_(planar_axis) {}
 
-  ~DynamicsGraph() {}
+  virtual ~DynamicsGraph() {}
+
+  /**
+   * Allocate the factors of subsequent graphs from the given arena, or from
+   * the heap if null. The factors keep the arena alive, so a new arena per
+   * graph releases the memory of each graph in one go; its statistics give
+   * the allocation counts of the build.
+   */
+  void setArena(const std::shared_ptr<GraphArena> &arena) { arena_ = arena; }
+
+  /// Return the arena factors are allocated from, if any.
+  const std::shared_ptr<GraphArena> &arena() const { return arena_; }
 
   /**
    * Return linear factor graph of all dynamics factors, Values version
@@ -114,6 +170,14 @@ class DynamicsGraph {
   gtsam::Values linearSolveFD(const Robot &robot, const int t,
                               const gtsam::Values &known_values);
 
+  /**
+   * Solve forward kinodynamics at time step t of a trajectory, ShardedValues
+   * version: only the slice of time step t is solved and replaced, all other
+   * slices are shared with known_values.
+   */
+  ShardedValues linearSolveFD(const Robot &robot, const int t,
+                              const ShardedValues &known_values);
+
   /**
    * Solve inverse kinodynamics using linear factor graph, Values version.
    * @param  robot        the robot
@@ -121,27 +185,88 @@ class DynamicsGraph {
    * @param known_values  Values with kinematics + joint accelerations
    *
    * @return values of all variables, including computed torques
+   *
+   * For kinematic trees solved repeatedly, NewtonEulerInverseDynamics gives
+   * the same result in linear time.
    */
   gtsam::Values linearSolveID(const Robot &robot, const int t,
                               const gtsam::Values &known_values);
 
+  /// Solve inverse kinodynamics at time step t, ShardedValues version, see
+  /// the ShardedValues version of linearSolveFD.
+  ShardedValues linearSolveID(const Robot &robot, const int t,
+                              const ShardedValues &known_values);
+
+  /**
+   * Solve hybrid dynamics, where the torques of some joints and the
+   * accelerations of the others are known, e.g. for a mix of torque- and
+   * position-controlled joints.
+   *
+   * The linear system is compiled once per mask, see CompiledForwardDynamics,
+   * and reused by later calls with the same mask, so switching between
+   * control modes does not rebuild any graph. Call clearCompiledSolvers after
+   * changing the inertial parameters of the robot.
+   *
+   * @param robot           the robot
+   * @param t               time step
+   * @param known_values    Values with kinematics, and the torque or
+   * acceleration of every joint, according to the mask
+   * @param joint_mode_mask per joint, in Robot::joints() order, whether its
+   * acceleration is known instead of its torque
+   * @return known_values augmented with the other torques and accelerations,
+   * wrenches and twist accelerations
+   */
+  gtsam::Values linearSolveHybrid(const Robot &robot, const int t,
+                                  const gtsam::Values &known_values,
+                                  const std::vector<bool> &joint_mode_mask);
+
+  /**
+   * Solve forward dynamics with contact points in stance, with the linear
+   * form of ContactKinematicsAccelFactor: every contact point has zero
+   * acceleration, and applies a pure force to its link, as with
+   * ContactDynamicsMomentFactor. Friction cones are not enforced.
+   *
+   * As for linearSolveHybrid, the linear system is compiled once per contact
+   * set and reused, so stance phases of a gait can be simulated without any
+   * graph build or nonlinear solve per step.
+   *
+   * @param robot          the robot
+   * @param t              time step
+   * @param known_values   Values with kinematics and torques, as for
+   * linearSolveFD
+   * @param contact_points points in contact, on links that are not fixed
+   * @return known_values augmented with joint accelerations, wrenches, twist
+   * accelerations, and the wrench of every contact point c on link i under
+   * ContactWrenchKey(i, c, t)
+   */
+  gtsam::Values linearSolveContactFD(const Robot &robot, const int t,
+                                     const gtsam::Values &known_values,
+                                     const PointOnLinks &contact_points);
+
+  /// Release the solvers compiled by linearSolveHybrid and
+  /// linearSolveContactFD.
+  void clearCompiledSolvers() {
+    std::lock_guard<std::mutex> lock(compiled_solvers_.mutex);
+    compiled_solvers_.solvers.clear();
+  }
+
   /// Return q-level nonlinear factor graph (pose related factors)
-  gtsam::NonlinearFactorGraph qFactors(
+  virtual gtsam::NonlinearFactorGraph qFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
   /// Return v-level nonlinear factor graph (twist related factors)
-  gtsam::NonlinearFactorGraph vFactors(
+  virtual gtsam::NonlinearFactorGraph vFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
   /// Return a-level nonlinear factor graph (acceleration related factors)
-  gtsam::NonlinearFactorGraph aFactors(
+  virtual gtsam::NonlinearFactorGraph aFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
   /// Return dynamics-level nonlinear factor graph (wrench related factors)
-  gtsam::NonlinearFactorGraph dynamicsFactors(
+  virtual gtsam::NonlinearFactorGraph dynamicsFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none,
       const boost::optional<double> &mu = boost::none) const;
@@ -159,6 +284,31 @@ class DynamicsGraph {
       const boost::optional<PointOnLinks> &contact_points = boost::none,
       const boost::optional<double> &mu = boost::none) const;
 
+  /**
+   * Append the factors of dynamicsFactorGraph to a graph, moving them instead
+   * of copying them through intermediate graphs. The graph is not reserved
+   * here; reserve it once for all time steps with numFactorsEstimate.
+   */
+  void addDynamicsFactorGraph(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const;
+
+  /**
+   * Number of factors of one time step of trajectoryFG, the factors of
+   * dynamicsFactorGraph and collocationFactors, without building them, for
+   * reserving graphs built with the add* methods. It is exact for
+   * DynamicsGraph unless contacts are on fixed links, and an estimate for
+   * derived graph builders.
+   */
+  size_t numFactorsEstimate(
+      const Robot &robot,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+
+  /// Move all factors of `factors` to the end of a graph, leaving it empty.
+  static void appendFactors(gtsam::NonlinearFactorGraph *graph,
+                            gtsam::NonlinearFactorGraph &&factors);
+
   /**
    * Return prior factors of torque, angle, velocity
    * @param robot        the robot
@@ -193,12 +343,14 @@ class DynamicsGraph {
    * @param num_steps   total time steps
    * @param dt          duration of each time step
    * @param collocation the collocation scheme
+   * @param index       if given, the factors are appended to this time index
    */
   gtsam::NonlinearFactorGraph trajectoryFG(
       const Robot &robot, const int num_steps, const double dt,
       const CollocationScheme collocation = Trapezoidal,
       const boost::optional<PointOnLinks> &contact_points = boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      FactorTimeIndex *index = nullptr) const;
 
   /**
    * Return nonlinear factor graph of the entire trajectory for multi-phase
@@ -208,6 +360,7 @@ class DynamicsGraph {
    * @param collocation          the collocation scheme
    * @param phase_contact_points contact points at each phase
    * @param mu                   optional coefficient of static friction
+   * @param index                if given, the time index to append to
    */
   gtsam::NonlinearFactorGraph multiPhaseTrajectoryFG(
       const Robot &robot, const std::vector<int> &phase_steps,
@@ -215,7 +368,8 @@ class DynamicsGraph {
       const CollocationScheme collocation = Trapezoidal,
       const boost::optional<std::vector<PointOnLinks>> &phase_contact_points =
           boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      FactorTimeIndex *index = nullptr) const;
 
   /** Add collocation factor for doubles. */
   static void addCollocationFactorDouble(
@@ -233,7 +387,31 @@ class DynamicsGraph {
       const CollocationScheme collocation = Trapezoidal);
 
   /**
-   * Return collocation factors for the specified joint.
+   * Add Hermite-Simpson collocation factor for doubles, in compressed form.
+   * Simpson quadrature of v, with the midpoint v from cubic Hermite
+   * interpolation of v and a, gives
+   *   x1 = x0 + dt/2 (v0 + v1) + dt^2/12 (a0 - a1),
+   * which is exact for linear a, with local error O(dt^5) instead of the
+   * O(dt^3) of trapezoidal collocation.
+   */
+  static void addHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key, const double dt,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /** Add Hermite-Simpson collocation factor for doubles, with dt a variable. */
+  static void addMultiPhaseHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key,
+      const gtsam::Key phase_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /**
+   * Return collocation factors for the specified joint. HermiteSimpson
+   * collocates the angle with addHermiteSimpsonFactorDouble, and the velocity
+   * with trapezoidal collocation, as jerks are not variables.
    * @param j           joint index
    * @param t           time step
    * @param dt          time delta
@@ -245,6 +423,7 @@ class DynamicsGraph {
 
   /**
    * Return collocation factors for the specified joint, with dt as a variable.
+   * HermiteSimpson is handled as in jointCollocationFactors.
    * @param j           joint index
    * @param t           time step
    * @param phase       the phase of the timestamp
@@ -261,10 +440,15 @@ class DynamicsGraph {
    * @param dt          duration of each timestep
    * @param collocation collocation scheme chosen
    */
-  gtsam::NonlinearFactorGraph collocationFactors(
+  virtual gtsam::NonlinearFactorGraph collocationFactors(
       const Robot &robot, const int t, const double dt,
       const CollocationScheme collocation = Trapezoidal) const;
 
+  /// Append the factors of collocationFactors to a graph, moving them.
+  void addCollocationFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const double dt, const CollocationScheme collocation = Trapezoidal) const;
+
   /**
    * Return collocation factors on angles and velocities from time step t to
    * t+1, with dt as a varaible
@@ -273,18 +457,51 @@ class DynamicsGraph {
    * @param phase       the phase of the timestep
    * @param collocation collocation scheme chosen
    */
-  gtsam::NonlinearFactorGraph multiPhaseCollocationFactors(
+  virtual gtsam::NonlinearFactorGraph multiPhaseCollocationFactors(
       const Robot &robot, const int t, const int phase,
       const CollocationScheme collocation = Trapezoidal) const;
 
+  /// Append the factors of multiPhaseCollocationFactors to a graph, moving
+  /// them.
+  void addMultiPhaseCollocationFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const int phase, const CollocationScheme collocation = Trapezoidal) const;
+
   /**
-   * Return joint factors to limit angle, velocity, acceleration, and torque
+   * Return joint factors to limit angle, velocity, acceleration, and torque,
+   * a single JointLimitBlockFactor if joint_limit_block_factors is set.
    * @param robot the robot
    * @param t time step
    */
   gtsam::NonlinearFactorGraph jointLimitFactors(const Robot &robot,
                                                 const int t) const;
 
+  /**
+   * Return limits on joint angle, velocity, acceleration, and torque as
+   * inequality constraints, to be used instead of jointLimitFactors with the
+   * augmented Lagrangian optimizer.
+   * @param robot     the robot
+   * @param t         time step
+   * @param tolerance constraint tolerance
+   */
+  InequalityConstraints jointLimitConstraints(const Robot &robot, const int t,
+                                              const double tolerance = 1e-3)
+      const;
+
+  /**
+   * Return friction cone constraints mu^2 f_n^2 - |f_t|^2 >= 0 on the
+   * contact wrenches, to be used instead of the friction cone factors.
+   * @param robot          the robot
+   * @param t              time step
+   * @param contact_points contact points, as in dynamicsFactors
+   * @param mu             static friction coefficient, 1.0 by default
+   * @param tolerance      constraint tolerance
+   */
+  InequalityConstraints frictionConeConstraints(
+      const Robot &robot, const int t, const PointOnLinks &contact_points,
+      const boost::optional<double> &mu = boost::none,
+      const double tolerance = 1e-3) const;
+
   /**
    * Return goal factors of joint angle
    * @param robot        the robot
@@ -327,6 +544,30 @@ class DynamicsGraph {
   static gtsam::Vector jointTorques(const Robot &robot,
                                     const gtsam::Values &result, const int t);
 
+  /**
+   * Return the joint accelerations from a trajectory buffer, which unlike the
+   * Values versions needs no key lookups. Use TrajectoryBuffer::FromValues
+   * once when reading many time steps of a result.
+   * @param robot  the robot
+   * @param buffer the trajectory
+   * @param t      time step
+   */
+  static gtsam::Vector jointAccels(const Robot &robot,
+                                   const TrajectoryBuffer &buffer, const int t);
+
+  /// Return joint velocities from a trajectory buffer.
+  static gtsam::Vector jointVels(const Robot &robot,
+                                 const TrajectoryBuffer &buffer, const int t);
+
+  /// Return joint angles from a trajectory buffer.
+  static gtsam::Vector jointAngles(const Robot &robot,
+                                   const TrajectoryBuffer &buffer, const int t);
+
+  /// Return joint torques from a trajectory buffer.
+  static gtsam::Vector jointTorques(const Robot &robot,
+                                    const TrajectoryBuffer &buffer,
+                                    const int t);
+
   /**
    * Return the joint accelerations as std::map<name, acceleration>
    * @param robot the robot
@@ -396,6 +637,24 @@ class DynamicsGraph {
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  /**
+   * Save a level-of-detail summary of a multi-step factor graph in json
+   * format, see JsonSaver::SaveSummarizedGraph, so that the viewer stays
+   * responsive on long trajectories. The detailed graph is written in chunks
+   * of consecutive time steps next to the summary, as <name>_<chunk>.json for
+   * a summary <name>.json, and every summary node names the chunk that
+   * expands it. A chunk holds the factors of its steps, see
+   * JsonSaver::GetStep, and their variables.
+   * @param file_path       path of the json file to store the summary
+   * @param graph           factor graph
+   * @param values          values of variables in factor graph
+   * @param steps_per_chunk time steps per detailed chunk, 0 for no chunks
+   */
+  static void saveGraphSummary(const std::string &file_path,
+                               const gtsam::NonlinearFactorGraph &graph,
+                               const gtsam::Values &values,
+                               size_t steps_per_chunk = 1);
+
   /// Return the optimizer setting.
   const OptimizerSetting &opt() const { return opt_; }
 };
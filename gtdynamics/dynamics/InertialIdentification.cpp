@@ -0,0 +1,267 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.cpp
+ * @brief Linear regressor form of inverse dynamics, and least squares
+ * identification of inertial parameters from logged data.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/utils/values.h>
+
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+InertialRegressor::InertialRegressor(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : gravity_(gravity) {
+  if (!tree_.build(robot) || !tree_.root_fixed) {
+    throw std::invalid_argument(
+        "InertialRegressor: robot is not a kinematic tree with a fixed link");
+  }
+  const size_t num_links = tree_.links.size();
+  poses_.resize(num_links);
+  twists_.resize(num_links, gtsam::Z_6x1);
+  accels_.resize(num_links, gtsam::Z_6x1);
+  X_.resize(num_links, gtsam::I_6x6);
+  poses_[tree_.root] = tree_.links[tree_.root]->getFixedPose();
+  regressor_ = Matrix::Zero(numJoints(), numParameters());
+}
+
+/* ************************************************************************* */
+Vector InertialRegressor::parameters() const {
+  Vector pi(numParameters());
+  for (size_t i = 0; i < numLinks(); i++) {
+    pi.segment<kLinkParameters>(kLinkParameters * i) =
+        Parameters(*tree_.links[i]);
+  }
+  return pi;
+}
+
+/* ************************************************************************* */
+const Matrix &InertialRegressor::compute(const Vector &joint_angles,
+                                         const Vector &joint_vels,
+                                         const Vector &joint_accels) {
+  const size_t num_joints = numJoints();
+  if (size_t(joint_angles.size()) != num_joints ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(joint_accels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "InertialRegressor: input sizes do not match the robot");
+  }
+
+  // Poses, twists and twist accelerations, from the fixed root.
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const Pose3 aTb =
+        tree_.joints[j]->relativePoseOf(tree_.links[b], joint_angles(j));
+    poses_[b] = poses_[a] * aTb;
+    X_[b] = aTb.inverse().AdjointMap();
+    const Vector6 S_qdot = tree_.screw[b] * joint_vels(j);
+    twists_[b] = X_[b] * twists_[a] + S_qdot;
+    accels_[b] = X_[b] * accels_[a] + tree_.screw[b] * joint_accels(j) +
+                 Pose3::adjointMap(twists_[b]) * S_qdot;
+  }
+
+  // The wrench regressor of every link reaches all joints towards the root,
+  // through the same adjoints as in NewtonEulerInverseDynamics.
+  regressor_.setZero();
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int i = tree_.order[k];
+    const Vector3 gravity = gravity_
+                                ? poses_[i].rotation().unrotate(*gravity_)
+                                : Vector3::Zero().eval();
+    LinkRegressorMatrix Y = LinkRegressor(twists_[i], accels_[i], gravity);
+    for (int b = i; b != tree_.root; b = tree_.parent[b]) {
+      regressor_.block<1, kLinkParameters>(tree_.joint[b],
+                                           kLinkParameters * i) +=
+          tree_.screw[b].transpose() * Y;
+      Y = X_[b].transpose() * Y;
+    }
+  }
+  return regressor_;
+}
+
+/* ************************************************************************* */
+const Matrix &InertialRegressor::compute(const gtsam::Values &values, int t) {
+  const size_t num_joints = numJoints();
+  Vector q(num_joints), v(num_joints), a(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = tree_.joints[idx]->id();
+    q(idx) = JointAngle(values, j, t);
+    v(idx) = JointVel(values, j, t);
+    a(idx) = JointAccel(values, j, t);
+  }
+  return compute(q, v, a);
+}
+
+/* ************************************************************************* */
+void InertialRegressor::accumulate(const TrajectoryBuffer &buffer,
+                                   InertialLeastSquares *ls, double weight) {
+  const size_t num_joints = numJoints();
+  Vector q(num_joints), v(num_joints), a(num_joints), tau(num_joints);
+  for (size_t t = 0; t < buffer.numSteps(); t++) {
+    for (size_t idx = 0; idx < num_joints; idx++) {
+      const int j = tree_.joints[idx]->id();
+      q(idx) = buffer.jointAngle(j, t);
+      v(idx) = buffer.jointVel(j, t);
+      a(idx) = buffer.jointAccel(j, t);
+      tau(idx) = buffer.torque(j, t);
+    }
+    ls->add(compute(q, v, a), tau, weight);
+  }
+}
+
+/* ************************************************************************* */
+void InertialRegressor::accumulate(const TrajectoryLog &log,
+                                   InertialLeastSquares *ls, double weight) {
+  const size_t num_joints = numJoints();
+  std::vector<Matrix> q, v, a, tau;
+  for (auto &&joint : tree_.joints) {
+    const int j = joint->id();
+    q.push_back(log.series(JointAngleKey(j)));
+    v.push_back(log.series(JointVelKey(j)));
+    a.push_back(log.series(JointAccelKey(j)));
+    tau.push_back(log.series(TorqueKey(j)));
+  }
+  Vector q_t(num_joints), v_t(num_joints), a_t(num_joints),
+      tau_t(num_joints);
+  for (size_t t = 0; t < log.numSteps(); t++) {
+    bool complete = true;
+    for (size_t idx = 0; idx < num_joints; idx++) {
+      q_t(idx) = q[idx](t, 0);
+      v_t(idx) = v[idx](t, 0);
+      a_t(idx) = a[idx](t, 0);
+      tau_t(idx) = tau[idx](t, 0);
+      complete = complete && !std::isnan(q_t(idx) + v_t(idx) + a_t(idx) +
+                                         tau_t(idx));
+    }
+    if (complete) ls->add(compute(q_t, v_t, a_t), tau_t, weight);
+  }
+}
+
+/* ************************************************************************* */
+InertialRegressor::LinkParameters InertialRegressor::Parameters(
+    const Link &link) {
+  const Matrix3 &I = link.inertia();
+  LinkParameters pi;
+  pi << link.mass(), 0, 0, 0, I(0, 0), I(0, 1), I(0, 2), I(1, 1), I(1, 2),
+      I(2, 2);
+  return pi;
+}
+
+/* ************************************************************************* */
+Matrix6 InertialRegressor::SpatialInertia(const LinkParameters &pi) {
+  Matrix3 I;
+  I << pi(4), pi(5), pi(6),  //
+      pi(5), pi(7), pi(8),   //
+      pi(6), pi(8), pi(9);
+  const Matrix3 H = gtsam::skewSymmetric(pi(1), pi(2), pi(3));
+  Matrix6 G;
+  G << I, H, H.transpose(), pi(0) * gtsam::I_3x3;
+  return G;
+}
+
+/* ************************************************************************* */
+InertialRegressor::LinkRegressorMatrix InertialRegressor::LinkRegressor(
+    const Vector6 &twist, const Vector6 &twist_accel,
+    const Vector3 &gravity) {
+  // The wrench is linear in the parameters, so column k is the wrench for
+  // the k-th unit parameter vector.
+  const Matrix6 adT = Pose3::adjointMap(twist).transpose();
+  LinkRegressorMatrix Y;
+  for (int k = 0; k < kLinkParameters; k++) {
+    const LinkParameters e = LinkParameters::Unit(k);
+    const Matrix6 G = SpatialInertia(e);
+    Y.col(k) = G * twist_accel - adT * (G * twist);
+    // Gravity acts at the center of mass: [h x g; m g].
+    Y.col(k).head<3>() -= e.segment<3>(1).cross(gravity);
+    Y.col(k).tail<3>() -= e(0) * gravity;
+  }
+  return Y;
+}
+
+/* ************************************************************************* */
+void InertialRegressor::Inertia(const LinkParameters &pi, double *mass,
+                                gtsam::Point3 *com, Matrix3 *inertia) {
+  *mass = pi(0);
+  const Vector3 c = pi.segment<3>(1) / pi(0);
+  *com = c;
+  // Parallel axis theorem: I_o = I_c - m [c]^2.
+  const Matrix3 C = gtsam::skewSymmetric(c.x(), c.y(), c.z());
+  *inertia = SpatialInertia(pi).topLeftCorner<3, 3>() + pi(0) * C * C;
+}
+
+/* ************************************************************************* */
+InertialLeastSquares::InertialLeastSquares(size_t num_parameters)
+    : information_(Matrix::Zero(num_parameters, num_parameters)),
+      rhs_(Vector::Zero(num_parameters)) {}
+
+/* ************************************************************************* */
+void InertialLeastSquares::add(const Matrix &regressor, const Vector &torques,
+                               double weight) {
+  if (size_t(regressor.cols()) != numParameters() ||
+      regressor.rows() != torques.size()) {
+    throw std::invalid_argument(
+        "InertialLeastSquares: regressor and torque sizes do not match");
+  }
+  information_.selfadjointView<Eigen::Lower>().rankUpdate(
+      regressor.transpose(), weight);
+  rhs_ += weight * regressor.transpose() * torques;
+  squared_error_ += weight * torques.squaredNorm();
+  num_samples_++;
+}
+
+/* ************************************************************************* */
+void InertialLeastSquares::merge(const InertialLeastSquares &other) {
+  if (other.numParameters() != numParameters()) {
+    throw std::invalid_argument(
+        "InertialLeastSquares: cannot merge different numbers of parameters");
+  }
+  information_ += other.information_;
+  rhs_ += other.rhs_;
+  squared_error_ += other.squared_error_;
+  num_samples_ += other.num_samples_;
+}
+
+/* ************************************************************************* */
+Vector InertialLeastSquares::solve(const Vector &prior,
+                                   double regularization) const {
+  if (size_t(prior.size()) != numParameters()) {
+    throw std::invalid_argument(
+        "InertialLeastSquares: prior size does not match the parameters");
+  }
+  if (!(regularization > 0)) {
+    throw std::invalid_argument(
+        "InertialLeastSquares: regularization must be positive");
+  }
+  // Only the lower triangle of information_ is accumulated.
+  Matrix A = information_.selfadjointView<Eigen::Lower>();
+  A.diagonal().array() += regularization;
+  return A.ldlt().solve(rhs_ + regularization * prior);
+}
+
+/* ************************************************************************* */
+double InertialLeastSquares::error(const Vector &parameters) const {
+  const Vector Ap = information_.selfadjointView<Eigen::Lower>() * parameters;
+  return squared_error_ - 2 * rhs_.dot(parameters) + parameters.dot(Ap);
+}
+
+}  // namespace gtdynamics
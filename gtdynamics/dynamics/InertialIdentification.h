@@ -0,0 +1,212 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.h
+ * @brief Linear regressor form of inverse dynamics, and least squares
+ * identification of inertial parameters from logged data.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+class InertialLeastSquares;
+
+/**
+ * InertialRegressor writes the joint torques of a fixed-base kinematic tree as
+ * tau = Y(q, qdot, qddot) * pi, linear in the inertial parameters pi. Every
+ * link has 10 parameters, in the CoM frame of the Link:
+ *
+ *   [m, m c_x, m c_y, m c_z, I_xx, I_xy, I_xz, I_yy, I_yz, I_zz],
+ *
+ * with c the center of mass and I the rotational inertia about the frame
+ * origin, so the parameters of a Link are [m, 0, 0, 0, inertia()]. The
+ * parameters of link i start at 10 * i, in Robot::links() order; the columns
+ * of the fixed root are zero.
+ *
+ * The twists and twist accelerations only depend on the joint states, so the
+ * regressor of a sample is exact for any parameters, and many samples can be
+ * stacked into one linear least squares problem, see InertialLeastSquares.
+ */
+class InertialRegressor {
+ public:
+  static const int kLinkParameters = 10;
+  using LinkParameters = Eigen::Matrix<double, kLinkParameters, 1>;
+  using LinkRegressorMatrix = Eigen::Matrix<double, 6, kLinkParameters>;
+
+ private:
+  KinematicTree tree_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  /// Per-sample buffers, indexed by link: poses, twists, twist accelerations,
+  /// and adjoints from the tree parent.
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_, accels_;
+  std::vector<gtsam::Matrix6> X_;
+
+  /// Regressor of the last sample, numJoints x numParameters.
+  gtsam::Matrix regressor_;
+
+ public:
+  /**
+   * Constructor, extracts the tree topology of the robot.
+   * @param robot    the robot, a kinematic tree with a fixed link
+   * @param gravity  gravity in world frame
+   */
+  explicit InertialRegressor(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Number of joints in the robot.
+  size_t numJoints() const { return tree_.joints.size(); }
+
+  /// Number of links in the robot.
+  size_t numLinks() const { return tree_.links.size(); }
+
+  /// Number of inertial parameters, 10 per link.
+  size_t numParameters() const { return kLinkParameters * numLinks(); }
+
+  /// Index of the joint with the given id in the vectors used by compute.
+  int jointIndex(uint16_t id) const { return tree_.joint_index.at(id); }
+
+  /// Index of the link with the given id in the parameter vector.
+  int linkIndex(uint16_t id) const { return tree_.link_index.at(id); }
+
+  /// Parameters of all links of the robot.
+  gtsam::Vector parameters() const;
+
+  /**
+   * Regressor of one sample.
+   * @param joint_angles joint angles, in Robot::joints() order
+   * @param joint_vels   joint velocities, in Robot::joints() order
+   * @param joint_accels joint accelerations, in Robot::joints() order
+   * @return numJoints x numParameters matrix, valid until the next call
+   */
+  const gtsam::Matrix &compute(const gtsam::Vector &joint_angles,
+                               const gtsam::Vector &joint_vels,
+                               const gtsam::Vector &joint_accels);
+
+  /// Regressor of one sample, reading the joint angles, velocities and
+  /// accelerations of time step t from values.
+  const gtsam::Matrix &compute(const gtsam::Values &values, int t = 0);
+
+  /**
+   * Add all steps of a buffer, with their joint angles, velocities,
+   * accelerations and torques, to a least squares problem.
+   */
+  void accumulate(const TrajectoryBuffer &buffer, InertialLeastSquares *ls,
+                  double weight = 1.0);
+
+  /**
+   * Add all steps of a trajectory log to a least squares problem. Only the
+   * joint angle, velocity, acceleration and torque columns are read, and
+   * steps where any of them is missing are skipped.
+   */
+  void accumulate(const TrajectoryLog &log, InertialLeastSquares *ls,
+                  double weight = 1.0);
+
+  /// Parameters of a link, see the class documentation.
+  static LinkParameters Parameters(const Link &link);
+
+  /// Spatial inertia about the frame origin, [I, [h]; [h]^T, m I], h = m c.
+  static gtsam::Matrix6 SpatialInertia(const LinkParameters &parameters);
+
+  /**
+   * Regressor of the wrench on one link, F = G * A - ad(V)^T * G * V minus
+   * the gravity wrench, as in NewtonEulerInverseDynamics, with F = Y * pi.
+   * @param twist       twist of the link
+   * @param twist_accel twist acceleration of the link
+   * @param gravity     gravity in the link frame, zero for none
+   */
+  static LinkRegressorMatrix LinkRegressor(const gtsam::Vector6 &twist,
+                                           const gtsam::Vector6 &twist_accel,
+                                           const gtsam::Vector3 &gravity);
+
+  /**
+   * Physical quantities of identified parameters.
+   * @param[in]  parameters parameters of one link
+   * @param[out] mass       the mass
+   * @param[out] com        center of mass in the Link CoM frame
+   * @param[out] inertia    rotational inertia about the center of mass
+   */
+  static void Inertia(const LinkParameters &parameters, double *mass,
+                      gtsam::Point3 *com, gtsam::Matrix3 *inertia);
+};
+
+/**
+ * InertialLeastSquares accumulates the normal equations of the linear least
+ * squares problem min |Y * pi - tau|^2 over any number of samples, in memory
+ * independent of the number of samples. Accumulators of separate parts of a
+ * log can be merged, e.g. when they are filled in parallel.
+ */
+class InertialLeastSquares {
+  gtsam::Matrix information_;  // sum of w Y^T Y, lower triangle
+  gtsam::Vector rhs_;          // sum of w Y^T tau
+  double squared_error_ = 0;   // sum of w tau^T tau
+  size_t num_samples_ = 0;
+
+ public:
+  /// Constructor, for the given number of parameters.
+  explicit InertialLeastSquares(size_t num_parameters);
+
+  /// Number of parameters.
+  size_t numParameters() const { return rhs_.size(); }
+
+  /// Number of samples added.
+  size_t numSamples() const { return num_samples_; }
+
+  /// Sum of w Y^T Y over all samples.
+  gtsam::Matrix information() const {
+    return information_.selfadjointView<Eigen::Lower>();
+  }
+
+  /// Sum of w Y^T tau over all samples.
+  const gtsam::Vector &rhs() const { return rhs_; }
+
+  /**
+   * Add one sample.
+   * @param regressor numJoints x numParameters regressor of the sample
+   * @param torques   measured joint torques of the sample
+   * @param weight    weight of the sample
+   */
+  void add(const gtsam::Matrix &regressor, const gtsam::Vector &torques,
+           double weight = 1.0);
+
+  /// Add all samples of another accumulator.
+  void merge(const InertialLeastSquares &other);
+
+  /**
+   * Solve for the parameters. Rigid-body dynamics only depends on some
+   * combinations of the parameters, so the problem is regularized towards
+   * prior parameters, which fixes the parameters the data does not excite:
+   * min |Y * pi - tau|^2 + regularization * |pi - prior|^2.
+   *
+   * @param prior          prior parameters, e.g. InertialRegressor::parameters
+   * @param regularization weight of the prior, positive
+   */
+  gtsam::Vector solve(const gtsam::Vector &prior,
+                      double regularization = 1e-6) const;
+
+  /// Sum of the weighted squared torque errors of parameters over all samples.
+  double error(const gtsam::Vector &parameters) const;
+};
+
+}  // namespace gtdynamics
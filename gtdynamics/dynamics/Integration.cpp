@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Integration.cpp
+ * @brief Time integration schemes for forward simulation.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/Integration.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+
+namespace {
+// Linearized backward Euler: with A_q, A_v the Jacobians of the accelerations
+// at the current state, v' = v + dv and q' = q + dt v' solve
+// (I - dt A_v - dt^2 A_q) dv = dt (a + dt A_q v).
+void ImplicitEulerStep(const BatchAccelerations &accelerations, double dt,
+                       const Matrix &a, Matrix *q, Matrix *v) {
+  const size_t N = a.rows(), n = a.cols();
+  const double h = 1e-6;
+  std::vector<Matrix> A_q(N, Matrix(n, n)), A_v(N, Matrix(n, n));
+
+  // All rows are independent, so one perturbed batch gives one column of
+  // every row's Jacobian.
+  for (size_t k = 0; k < n; k++) {
+    Matrix perturbed = *q;
+    perturbed.col(k).array() += h;
+    const Matrix a_q = (accelerations(perturbed, *v) - a) / h;
+    perturbed = *v;
+    perturbed.col(k).array() += h;
+    const Matrix a_v = (accelerations(*q, perturbed) - a) / h;
+    for (size_t r = 0; r < N; r++) {
+      A_q[r].col(k) = a_q.row(r).transpose();
+      A_v[r].col(k) = a_v.row(r).transpose();
+    }
+  }
+
+  const Matrix I = Matrix::Identity(n, n);
+  for (size_t r = 0; r < N; r++) {
+    const Matrix M = I - dt * A_v[r] - dt * dt * A_q[r];
+    const gtsam::Vector rhs =
+        dt * (a.row(r).transpose() + dt * A_q[r] * v->row(r).transpose());
+    v->row(r) += M.partialPivLu().solve(rhs).transpose();
+  }
+  *q += dt * *v;
+}
+}  // namespace
+
+/* ************************************************************************* */
+void Integrate(IntegrationScheme scheme,
+               const BatchAccelerations &accelerations, double dt,
+               const Matrix &joint_accels, Matrix *joint_angles,
+               Matrix *joint_vels) {
+  Matrix &q = *joint_angles, &v = *joint_vels;
+  const Matrix &a = joint_accels;
+  switch (scheme) {
+    case IntegrationScheme::ExplicitTaylor:
+      q += dt * v + (0.5 * dt * dt) * a;
+      v += dt * a;
+      return;
+    case IntegrationScheme::SemiImplicitEuler:
+      v += dt * a;
+      q += dt * v;
+      return;
+    case IntegrationScheme::RK4: {
+      const double h = 0.5 * dt;
+      const Matrix v2 = v + h * a;
+      const Matrix a2 = accelerations(q + h * v, v2);
+      const Matrix v3 = v + h * a2;
+      const Matrix a3 = accelerations(q + h * v2, v3);
+      const Matrix v4 = v + dt * a3;
+      const Matrix a4 = accelerations(q + dt * v3, v4);
+      q += (dt / 6) * (v + 2 * v2 + 2 * v3 + v4);
+      v += (dt / 6) * (a + 2 * a2 + 2 * a3 + a4);
+      return;
+    }
+    case IntegrationScheme::ImplicitEuler:
+      ImplicitEulerStep(accelerations, dt, a, &q, &v);
+      return;
+  }
+  throw std::invalid_argument("Integrate: unknown integration scheme");
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Integration.h
+ * @brief Time integration schemes for forward simulation.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+
+#include <functional>
+
+namespace gtdynamics {
+
+/// Schemes for integrating joint angles and velocities over a time step.
+enum class IntegrationScheme {
+  ExplicitTaylor,     // q += dt v + dt^2 a / 2, v += dt a
+  SemiImplicitEuler,  // v += dt a, q += dt v with the new v; symplectic
+  RK4,                // classical Runge-Kutta, 3 extra FD solves per step
+  ImplicitEuler,      // one Newton step of backward Euler, with the FD
+                      // Jacobian from 2 * numJoints extra FD solves
+};
+
+/**
+ * Forward dynamics for a batch of states: joint accelerations as a function
+ * of joint angles and velocities, all N x numJoints with independent rows.
+ */
+using BatchAccelerations = std::function<gtsam::Matrix(
+    const gtsam::Matrix &joint_angles, const gtsam::Matrix &joint_vels)>;
+
+/**
+ * Integrate a batch of states over one time step. Every scheme makes a fixed
+ * number of calls to the forward dynamics, so steps have a fixed cost.
+ *
+ * @param scheme        integration scheme
+ * @param accelerations forward dynamics, called for intermediate states
+ * @param dt            duration of the time step
+ * @param joint_accels  accelerations at the current state, N x numJoints
+ * @param joint_angles  joint angles, updated in place
+ * @param joint_vels    joint velocities, updated in place
+ */
+void Integrate(IntegrationScheme scheme,
+               const BatchAccelerations &accelerations, double dt,
+               const gtsam::Matrix &joint_accels, gtsam::Matrix *joint_angles,
+               gtsam::Matrix *joint_vels);
+
+}  // namespace gtdynamics
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointEffortModel.cpp
+ * @brief Passive joint torques and hard joint limits for simulation.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/JointEffortModel.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Matrix;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+JointEffortModel::JointEffortModel(const Robot &robot, bool passive,
+                                   bool limits)
+    : passive_(passive), limits_(limits) {
+  for (auto &&joint : robot.joints()) {
+    const JointParams &p = joint->parameters();
+    const JointScalarLimit &q = p.scalar_limits;
+    params_.push_back(
+        {p.damping_coefficient, p.spring_coefficient,
+         p.torque_limit + p.torque_limit_threshold,
+         q.value_lower_limit - q.value_limit_threshold,
+         q.value_upper_limit + q.value_limit_threshold,
+         p.velocity_limit + p.velocity_limit_threshold,
+         p.effort_type != JointEffortType::Unactuated});
+  }
+}
+
+/* ************************************************************************* */
+double JointEffortModel::torque(size_t index, double joint_angle,
+                                double joint_vel, double commanded) const {
+  const Params &p = params_[index];
+  double tau = commanded;
+  if (limits_) {
+    tau = p.actuated ? std::min(std::max(tau, -p.torque_limit), p.torque_limit)
+                     : 0.0;
+  }
+  if (passive_) tau -= p.damping * joint_vel + p.spring * joint_angle;
+  return tau;
+}
+
+/* ************************************************************************* */
+Matrix JointEffortModel::torques(const Matrix &joint_angles,
+                                 const Matrix &joint_vels,
+                                 const Matrix &commanded) const {
+  if (size_t(commanded.cols()) != params_.size() ||
+      joint_angles.rows() != commanded.rows() ||
+      joint_angles.cols() != commanded.cols() ||
+      joint_vels.rows() != commanded.rows() ||
+      joint_vels.cols() != commanded.cols()) {
+    throw std::invalid_argument(
+        "JointEffortModel: inputs must be N x numJoints");
+  }
+  Matrix tau(commanded.rows(), commanded.cols());
+  for (size_t j = 0; j < params_.size(); j++) {
+    for (Eigen::Index n = 0; n < commanded.rows(); n++) {
+      tau(n, j) =
+          torque(j, joint_angles(n, j), joint_vels(n, j), commanded(n, j));
+    }
+  }
+  return tau;
+}
+
+/* ************************************************************************* */
+void JointEffortModel::enforceLimits(Matrix *joint_angles,
+                                     Matrix *joint_vels) const {
+  if (!limits_) return;
+  if (size_t(joint_angles->cols()) != params_.size() ||
+      joint_vels->rows() != joint_angles->rows() ||
+      joint_vels->cols() != joint_angles->cols()) {
+    throw std::invalid_argument(
+        "JointEffortModel: states must be N x numJoints");
+  }
+  for (size_t j = 0; j < params_.size(); j++) {
+    const Params &p = params_[j];
+    for (Eigen::Index n = 0; n < joint_angles->rows(); n++) {
+      double &q = (*joint_angles)(n, j), &v = (*joint_vels)(n, j);
+      v = std::min(std::max(v, -p.velocity_limit), p.velocity_limit);
+      // Inelastic stop: no velocity further into the limit.
+      if (q <= p.lower) {
+        q = p.lower;
+        v = std::max(v, 0.0);
+      } else if (q >= p.upper) {
+        q = p.upper;
+        v = std::min(v, 0.0);
+      }
+    }
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointEffortModel.h
+ * @brief Passive joint torques and hard joint limits for simulation.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JointEffortModel applies the JointParams of a robot in simulation, on
+ * N x numJoints matrices with columns in Robot::joints() order, without any
+ * factor graph:
+ *  - passive torques -damping_coefficient * v - spring_coefficient * q are
+ *    added to the commanded torques,
+ *  - commanded torques are clamped to +-torque_limit, and ignored for
+ *    unactuated joints,
+ *  - after integration, joint angles are clamped to the scalar limits, with
+ *    the velocity into a limit removed, and velocities to +-velocity_limit.
+ * A threshold of a limit widens it, as for the limit factors.
+ */
+class JointEffortModel {
+ private:
+  struct Params {
+    double damping, spring, torque_limit, lower, upper, velocity_limit;
+    bool actuated;
+  };
+  std::vector<Params> params_;
+  bool passive_, limits_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot   the robot
+   * @param passive whether to add damping and spring torques
+   * @param limits  whether to enforce torque, angle and velocity limits
+   */
+  explicit JointEffortModel(const Robot &robot, bool passive = true,
+                            bool limits = true);
+
+  /// Whether damping and spring torques are added.
+  bool passive() const { return passive_; }
+
+  /// Whether limits are enforced.
+  bool limits() const { return limits_; }
+
+  /**
+   * Torques applied to the joints.
+   * @param joint_angles N x numJoints joint angles
+   * @param joint_vels   N x numJoints joint velocities
+   * @param commanded    N x numJoints commanded torques
+   * @return N x numJoints net torques
+   */
+  gtsam::Matrix torques(const gtsam::Matrix &joint_angles,
+                        const gtsam::Matrix &joint_vels,
+                        const gtsam::Matrix &commanded) const;
+
+  /// Net torque of one joint, with index in Robot::joints() order.
+  double torque(size_t index, double joint_angle, double joint_vel,
+                double commanded) const;
+
+  /// Clamp integrated joint angles and velocities, N x numJoints, in place.
+  void enforceLimits(gtsam::Matrix *joint_angles,
+                     gtsam::Matrix *joint_vels) const;
+};
+
+}  // namespace gtdynamics
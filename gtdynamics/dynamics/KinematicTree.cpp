@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicTree.cpp
+ * @brief Spanning-tree traversal of a robot used by the recursive dynamics
+ * algorithms.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+
+#include <algorithm>
+#include <queue>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+bool KinematicTree::build(const Robot &robot) {
+  const RobotTopology &topo = robot.topology();
+  links = topo.links;
+  joints = topo.joints;
+  link_index = topo.link_index;
+  joint_index = topo.joint_index;
+  const size_t num_links = links.size();
+  if (num_links == 0) return false;
+
+  // The topology roots at the fixed link, or else at a link that is never a
+  // joint child.
+  if (std::count(topo.fixed.begin(), topo.fixed.end(), true) > 1) return false;
+  root = topo.root;
+  root_fixed = topo.fixed[root];
+
+  order.clear();
+  parent.assign(num_links, -1);
+  joint.assign(num_links, -1);
+  screw.assign(num_links, gtsam::Z_6x1);
+  forward.assign(num_links, true);
+  std::vector<bool> visited(num_links, false);
+  std::vector<bool> used_joint(joints.size(), false);
+
+  std::queue<int> q;
+  q.push(root);
+  visited[root] = true;
+  while (!q.empty()) {
+    const int a = q.front();
+    q.pop();
+    order.push_back(a);
+    for (int k = topo.link_joint_offsets[a]; k < topo.link_joint_offsets[a + 1];
+         k++) {
+      const int j = topo.link_joints[k];
+      if (used_joint[j]) continue;
+      used_joint[j] = true;
+      const int b = topo.link_neighbors[k];
+      // A second path to the same link means a closed kinematic chain.
+      if (visited[b]) return false;
+      visited[b] = true;
+      parent[b] = a;
+      joint[b] = j;
+      forward[b] = (topo.joint_child[j] == b);
+      screw[b] = forward[b] ? topo.c_screw_axes[j] : topo.p_screw_axes[j];
+      q.push(b);
+    }
+  }
+  return order.size() == num_links;
+}
+
+}  // namespace gtdynamics
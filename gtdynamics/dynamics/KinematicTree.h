@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicTree.h
+ * @brief Spanning-tree traversal of a robot used by the recursive dynamics
+ * algorithms.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * KinematicTree stores the breadth-first traversal of a tree-structured robot
+ * from its root link, in the index space of Robot::links() and
+ * Robot::joints().
+ *
+ * The tree is rooted at the fixed link if there is one, otherwise at a link
+ * that is not the child of any joint. Tree edges may run against the joint
+ * direction; the screw axis of every edge is expressed in the frame of the
+ * link further from the root, so recursions can treat all edges alike.
+ */
+struct KinematicTree {
+  std::vector<LinkSharedPtr> links;
+  std::vector<JointSharedPtr> joints;
+
+  /// Link and joint indices keyed on their ids.
+  std::vector<int> link_index, joint_index;
+
+  /// Link indices in BFS order, starting with the root.
+  std::vector<int> order;
+
+  /// For every link: the index of its tree parent, the joint connecting them,
+  /// the joint screw axis in the link frame, and whether the link is the
+  /// joint's child. Unused for the root.
+  std::vector<int> parent, joint;
+  std::vector<gtsam::Vector6> screw;
+  std::vector<bool> forward;
+
+  int root = -1;
+  bool root_fixed = false;
+
+  /**
+   * Extract the tree from a robot.
+   * @return false if the robot is not a connected tree with at most one fixed
+   * link, in which case the contents are unspecified
+   */
+  bool build(const Robot &robot);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,168 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MppiController.cpp
+ * @brief Sampling-based model predictive control with rollouts in a
+ * BatchSimulator.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/MppiController.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+MppiController::MppiController(const Robot &robot, const Cost &cost,
+                               const MppiParameters &parameters,
+                               const boost::optional<gtsam::Vector3> &gravity,
+                               size_t num_threads)
+    : cost_(cost),
+      parameters_(parameters),
+      num_threads_(num_threads == 0 ? std::thread::hardware_concurrency()
+                                    : num_threads),
+      simulator_(robot, parameters.num_samples, gravity, num_threads),
+      rng_(parameters.seed) {
+  if (parameters_.num_samples == 0 || parameters_.horizon == 0) {
+    throw std::invalid_argument(
+        "MppiController: samples and horizon must be positive");
+  }
+  if (parameters_.num_elites > parameters_.num_samples) {
+    throw std::invalid_argument("MppiController: more elites than samples");
+  }
+  if (parameters_.num_elites == 0 && !(parameters_.temperature > 0)) {
+    throw std::invalid_argument(
+        "MppiController: temperature must be positive");
+  }
+  reset();
+}
+
+/* ************************************************************************* */
+void MppiController::reset() {
+  const size_t num_joints = simulator_.numJoints();
+  mean_.setZero(parameters_.horizon, num_joints);
+  sigma_.setConstant(parameters_.horizon, num_joints, parameters_.sigma);
+  costs_.clear();
+}
+
+/* ************************************************************************* */
+void MppiController::setMean(const Matrix &mean) {
+  if (mean.rows() != mean_.rows() || mean.cols() != mean_.cols()) {
+    throw std::invalid_argument(
+        "MppiController: mean must be horizon x numJoints");
+  }
+  mean_ = mean;
+}
+
+/* ************************************************************************* */
+void MppiController::iterate(const Vector &joint_angles,
+                             const Vector &joint_vels) {
+  const size_t K = parameters_.num_samples, H = parameters_.horizon;
+  const size_t num_joints = simulator_.numJoints();
+  if (size_t(joint_angles.size()) != num_joints ||
+      size_t(joint_vels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "MppiController: state must have one value per joint");
+  }
+  simulator_.setInitialState(joint_angles.transpose().replicate(K, 1),
+                             joint_vels.transpose().replicate(K, 1));
+
+  // Sampled torques, the mean first; the extra step reaches the end state.
+  std::normal_distribution<double> normal;
+  torques_.resize(H + 1);
+  for (size_t k = 0; k < H; k++) {
+    Matrix &torques = torques_[k];
+    torques = mean_.row(k).replicate(K, 1);
+    for (size_t s = 1; s < K; s++) {
+      for (size_t j = 0; j < num_joints; j++) {
+        torques(s, j) += sigma_(k, j) * normal(rng_);
+      }
+    }
+  }
+  torques_[H] = torques_[H - 1];
+
+  const std::vector<TrajectoryBuffer> rollouts =
+      simulator_.simulate(torques_, parameters_.dt);
+  costs_.resize(K);
+  ParallelFor(K, num_threads_,
+              [&](size_t s) { costs_[s] = cost_(rollouts[s]); });
+
+  if (parameters_.num_elites == 0) {
+    // MPPI: exponentially weighted average of the samples.
+    const double min_cost = *std::min_element(costs_.begin(), costs_.end());
+    Vector weights(K);
+    for (size_t s = 0; s < K; s++) {
+      weights(s) =
+          std::exp(-(costs_[s] - min_cost) / parameters_.temperature);
+    }
+    weights /= weights.sum();
+    for (size_t k = 0; k < H; k++) {
+      mean_.row(k) = weights.transpose() * torques_[k];
+    }
+    return;
+  }
+
+  // CEM: refit the distribution to the elites.
+  const size_t num_elites = parameters_.num_elites;
+  std::vector<size_t> order(K);
+  std::iota(order.begin(), order.end(), 0);
+  std::partial_sort(order.begin(), order.begin() + num_elites, order.end(),
+                    [&](size_t a, size_t b) { return costs_[a] < costs_[b]; });
+  for (size_t k = 0; k < H; k++) {
+    Matrix elites(num_elites, num_joints);
+    for (size_t e = 0; e < num_elites; e++) {
+      elites.row(e) = torques_[k].row(order[e]);
+    }
+    mean_.row(k) = elites.colwise().mean();
+    for (size_t j = 0; j < num_joints; j++) {
+      const double variance =
+          (elites.col(j).array() - mean_(k, j)).square().mean();
+      sigma_(k, j) = std::max(parameters_.min_sigma, std::sqrt(variance));
+    }
+  }
+}
+
+/* ************************************************************************* */
+void MppiController::shift() {
+  const size_t H = parameters_.horizon;
+  for (size_t k = 0; k + 1 < H; k++) {
+    mean_.row(k) = mean_.row(k + 1);
+    sigma_.row(k) = sigma_.row(k + 1);
+  }
+  sigma_.row(H - 1).setConstant(parameters_.sigma);
+}
+
+/* ************************************************************************* */
+Vector MppiController::control(const Vector &joint_angles,
+                               const Vector &joint_vels) {
+  for (size_t i = 0; i < parameters_.num_iterations; i++) {
+    iterate(joint_angles, joint_vels);
+  }
+  const Vector torques = mean_.row(0).transpose();
+  shift();
+  return torques;
+}
+
+/* ************************************************************************* */
+MppiController::Cost ObjectiveCost(
+    const gtsam::NonlinearFactorGraph &objectives, unsigned quantities) {
+  return [objectives, quantities](const TrajectoryBuffer &rollout) {
+    return objectives.error(rollout.values(quantities));
+  };
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,163 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MppiController.h
+ * @brief Sampling-based model predictive control with rollouts in a
+ * BatchSimulator.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of MppiController.
+struct MppiParameters {
+  size_t num_samples = 64;    ///< torque sequences sampled per iteration
+  size_t horizon = 20;        ///< steps of a rollout
+  double dt = 0.01;           ///< duration of a step
+  double sigma = 1.0;         ///< initial standard deviation of the torques
+  double temperature = 1.0;   ///< MPPI temperature, in units of the cost
+  size_t num_elites = 0;      ///< if > 0, CEM updates from the best samples
+  double min_sigma = 1e-3;    ///< smallest standard deviation of CEM
+  size_t num_iterations = 1;  ///< updates of the distribution per control
+  unsigned seed = 0;          ///< seed of the torque noise
+};
+
+/**
+ * MppiController is a sampling-based model predictive controller, a
+ * complement to the factor-graph MPC. It keeps a Gaussian distribution of the
+ * torques of every step of a receding horizon. Every iteration samples
+ * num_samples torque sequences from it, rolls them all out from the current
+ * state in one BatchSimulator, scores the rollouts with a cost, and updates
+ * the distribution:
+ *
+ *  - MPPI (num_elites = 0): the mean moves by the average of the sampled
+ *    noise, weighted by exp(-(cost - min cost) / temperature); the standard
+ *    deviations stay fixed.
+ *  - CEM (num_elites > 0): mean and standard deviations are refit to the
+ *    num_elites samples of least cost.
+ *
+ * The first sample is always the mean itself, so costs()[0] is the cost of
+ * the mean. Rollouts and costs run on num_threads threads, so the cost must
+ * be thread-safe; the noise is drawn serially, so results do not depend on
+ * the number of threads.
+ *
+ * A rollout is a TrajectoryBuffer of horizon + 1 steps, as from
+ * BatchSimulator::simulate: step k holds the state after k steps, and the
+ * torques and accelerations from it; the torques of the last step are those
+ * of the step before. Costs may evaluate the arrays of the buffer directly,
+ * or the objective factors of a graph, see ObjectiveCost.
+ *
+ *   MppiController mppi(robot, cost, parameters, gravity, 0);
+ *   while (running) {
+ *     const gtsam::Vector torques = mppi.control(q, v);
+ *     ...
+ *   }
+ */
+class MppiController {
+ public:
+  /// Cost of a rollout.
+  typedef std::function<double(const TrajectoryBuffer &)> Cost;
+
+ private:
+  Cost cost_;
+  MppiParameters parameters_;
+  size_t num_threads_;
+  BatchSimulator simulator_;
+  std::mt19937 rng_;
+
+  /// Mean and standard deviations of the torques, horizon x numJoints.
+  gtsam::Matrix mean_, sigma_;
+
+  /// Sampled torques of every step, numSamples x numJoints, and their costs.
+  std::vector<gtsam::Matrix> torques_;
+  std::vector<double> costs_;
+
+ public:
+  /**
+   * Constructor, with zero mean torques.
+   * @param robot       the robot, a kinematic tree with a fixed link
+   * @param cost        cost of a rollout
+   * @param parameters  sampling and update parameters
+   * @param gravity     gravity vector
+   * @param num_threads number of threads, 0 for hardware concurrency
+   */
+  MppiController(const Robot &robot, const Cost &cost,
+                 const MppiParameters &parameters = MppiParameters(),
+                 const boost::optional<gtsam::Vector3> &gravity = boost::none,
+                 size_t num_threads = 1);
+
+  /// Apply the JointParams of the robot in the rollouts, see
+  /// BatchSimulator::setJointEfforts.
+  void setJointEfforts(bool passive = true, bool limits = true) {
+    simulator_.setJointEfforts(passive, limits);
+  }
+
+  /// Parameters.
+  const MppiParameters &parameters() const { return parameters_; }
+
+  /**
+   * Update the distribution num_iterations times from the given state,
+   * return the mean torques of its first step, and shift the horizon.
+   * @param joint_angles current joint angles, in Robot::joints() order
+   * @param joint_vels   current joint velocities
+   */
+  gtsam::Vector control(const gtsam::Vector &joint_angles,
+                        const gtsam::Vector &joint_vels);
+
+  /// Sample, roll out and score once from the given state, and update.
+  void iterate(const gtsam::Vector &joint_angles,
+               const gtsam::Vector &joint_vels);
+
+  /**
+   * Shift the horizon by one step: the mean repeats its last step, and the
+   * last standard deviations are reset to the initial sigma.
+   */
+  void shift();
+
+  /// Mean torques, horizon x numJoints.
+  const gtsam::Matrix &mean() const { return mean_; }
+
+  /// Standard deviations of the torques, horizon x numJoints.
+  const gtsam::Matrix &sigma() const { return sigma_; }
+
+  /// Set the mean torques, e.g. to warm start from a planned trajectory.
+  void setMean(const gtsam::Matrix &mean);
+
+  /// Costs of the samples of the last iteration, the mean first.
+  const std::vector<double> &costs() const { return costs_; }
+
+  /// Reset to zero mean torques and the initial standard deviations.
+  void reset();
+};
+
+/**
+ * Cost of rollouts as the error of objective factors, e.g. from
+ * ObjectiveFactors.h, on the Values of the rollout, with time index k at the
+ * state after k steps.
+ * @param objectives factors on the variables of the rollout
+ * @param quantities variables of the rollout inserted, see TrajectoryBuffer
+ */
+MppiController::Cost ObjectiveCost(
+    const gtsam::NonlinearFactorGraph &objectives,
+    unsigned quantities = TrajectoryBuffer::kAll);
+
+}  // namespace gtdynamics
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiRobotGraph.cpp
+ * @brief Several robots in one factor graph, coupled by shared factors.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/MultiRobotGraph.h>
+#include <gtdynamics/factors/LinkSeparationFactor.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+
+/* ************************************************************************* */
+MultiRobotGraph::MultiRobotGraph(size_t num_robots, const Builder &build,
+                                 size_t num_threads)
+    : robots_(num_robots) {
+  if (num_robots > size_t(DynamicsSymbol::kMaxRobot) + 1) {
+    throw std::runtime_error("MultiRobotGraph: too many robots");
+  }
+  ParallelFor(num_robots, num_threads, [&](size_t r) {
+    DynamicsSymbol::RobotScope scope(r);
+    robots_[r] = build(r);
+  });
+}
+
+/* ************************************************************************* */
+void MultiRobotGraph::addRigidCoupling(
+    uint8_t robot_a, uint16_t link_a, uint8_t robot_b, uint16_t link_b,
+    const gtsam::Pose3 &aTb, size_t k_start, size_t k_end,
+    const gtsam::SharedNoiseModel &cost_model) {
+  for (size_t k = k_start; k <= k_end; k++) {
+    const Key key_a = PoseKey(link_a, k).ofRobot(robot_a),
+              key_b = PoseKey(link_b, k).ofRobot(robot_b);
+    coupling_.emplace_shared<gtsam::BetweenFactor<gtsam::Pose3>>(
+        key_a, key_b, aTb, cost_model);
+  }
+}
+
+/* ************************************************************************* */
+void MultiRobotGraph::addSeparation(
+    uint8_t robot_a, uint16_t link_a, uint8_t robot_b, uint16_t link_b,
+    double distance, size_t k_start, size_t k_end,
+    const gtsam::SharedNoiseModel &cost_model) {
+  for (size_t k = k_start; k <= k_end; k++) {
+    const Key key_a = PoseKey(link_a, k).ofRobot(robot_a),
+              key_b = PoseKey(link_b, k).ofRobot(robot_b);
+    coupling_.emplace_shared<LinkSeparationFactor>(key_a, key_b, distance,
+                                                   cost_model);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph MultiRobotGraph::graph() const {
+  gtsam::NonlinearFactorGraph graph;
+  size_t size = coupling_.size();
+  for (auto &&robot : robots_) size += robot.first.size();
+  graph.reserve(size);
+  for (auto &&robot : robots_) graph.push_back(robot.first);
+  graph.push_back(coupling_);
+  return graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values MultiRobotGraph::initialValues() const {
+  gtsam::Values values;
+  for (auto &&robot : robots_) values.insert(robot.second);
+  return values;
+}
+
+/* ************************************************************************* */
+gtsam::KeyVector MultiRobotGraph::separatorKeys() const {
+  const gtsam::KeySet keys = coupling_.keys();
+  return gtsam::KeyVector(keys.begin(), keys.end());
+}
+
+/* ************************************************************************* */
+gtsam::Ordering MultiRobotGraph::ordering() const {
+  return gtsam::Ordering::ColamdConstrainedLast(graph(), separatorKeys());
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiRobotGraph.h
+ * @brief Several robots in one factor graph, coupled by shared factors.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * MultiRobotGraph holds the factor graphs of several robots, whose keys are
+ * tagged with the robot instance (see DynamicsSymbol::ofRobot), together
+ * with coupling factors between robots, e.g. for a shared payload or for
+ * collision avoidance.
+ *
+ * The robot graphs are built concurrently by single-robot builders, such as
+ * DynamicsGraph::trajectoryFG or Trajectory::multiPhaseFactorGraph, each run
+ * inside a DynamicsSymbol::RobotScope. ordering() eliminates the variables
+ * touched by coupling factors last, so every robot is an independent subtree
+ * of the elimination tree, which the multifrontal solver eliminates in
+ * parallel (when GTSAM is built with TBB) before the coupling separator.
+ */
+class MultiRobotGraph {
+ public:
+  /// Factor graph and initial values of one robot.
+  using RobotProblem = std::pair<gtsam::NonlinearFactorGraph, gtsam::Values>;
+
+  /// Builds the problem of the robot with the given instance index.
+  using Builder = std::function<RobotProblem(size_t robot)>;
+
+ private:
+  std::vector<RobotProblem> robots_;
+  gtsam::NonlinearFactorGraph coupling_;
+
+ public:
+  /**
+   * Build the problems of all robots, concurrently.
+   * @param num_robots  number of robots, at most DynamicsSymbol::kMaxRobot+1
+   * @param build       builds the problem of one robot
+   * @param num_threads number of threads, 0 for hardware concurrency
+   */
+  MultiRobotGraph(size_t num_robots, const Builder &build,
+                  size_t num_threads = 0);
+
+  /// Number of robots.
+  size_t numRobots() const { return robots_.size(); }
+
+  /// Factor graph of one robot.
+  const gtsam::NonlinearFactorGraph &robotGraph(size_t robot) const {
+    return robots_.at(robot).first;
+  }
+
+  /// Initial values of one robot.
+  const gtsam::Values &robotValues(size_t robot) const {
+    return robots_.at(robot).second;
+  }
+
+  /// Factors coupling the robots.
+  const gtsam::NonlinearFactorGraph &couplingFactors() const {
+    return coupling_;
+  }
+
+  /// Add a factor on variables of several robots.
+  void addCoupling(const gtsam::NonlinearFactor::shared_ptr &factor) {
+    coupling_.push_back(factor);
+  }
+
+  /**
+   * Hold two links of different robots at a fixed relative CoM pose over the
+   * time steps k_start..k_end, e.g. while they carry a payload together.
+   * @param robot_a, link_a robot instance and link id of the first link
+   * @param robot_b, link_b robot instance and link id of the second link
+   * @param aTb             pose of the second CoM in the first CoM frame
+   * @param k_start, k_end  first and last time step
+   * @param cost_model      6-dimensional noise model
+   */
+  void addRigidCoupling(uint8_t robot_a, uint16_t link_a, uint8_t robot_b,
+                        uint16_t link_b, const gtsam::Pose3 &aTb,
+                        size_t k_start, size_t k_end,
+                        const gtsam::SharedNoiseModel &cost_model);
+
+  /**
+   * Keep the CoMs of two links of different robots at least `distance` apart
+   * over the time steps k_start..k_end, see LinkSeparationFactor.
+   */
+  void addSeparation(uint8_t robot_a, uint16_t link_a, uint8_t robot_b,
+                     uint16_t link_b, double distance, size_t k_start,
+                     size_t k_end, const gtsam::SharedNoiseModel &cost_model);
+
+  /// All robot graphs and the coupling factors.
+  gtsam::NonlinearFactorGraph graph() const;
+
+  /// Initial values of all robots.
+  gtsam::Values initialValues() const;
+
+  /// Variables touched by coupling factors.
+  gtsam::KeyVector separatorKeys() const;
+
+  /// COLAMD ordering of graph() with the separator keys last.
+  gtsam::Ordering ordering() const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NewtonEulerInverseDynamics.cpp
+ * @brief O(n) recursive Newton-Euler inverse dynamics for tree-structured
+ * robots.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+NewtonEulerInverseDynamics::NewtonEulerInverseDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : gravity_(gravity) {
+  if (!tree_.build(robot)) {
+    throw std::invalid_argument(
+        "NewtonEulerInverseDynamics: robot is not a kinematic tree, use "
+        "DynamicsGraph::linearSolveID instead");
+  }
+  for (auto &&link : tree_.links) inertias_.push_back(link->inertiaMatrix());
+
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  X_.resize(num_links, gtsam::I_6x6);
+  IC_.resize(num_links, gtsam::Z_6x6);
+  c_.resize(num_links, gtsam::Z_6x1);
+  p_.resize(num_links, gtsam::Z_6x1);
+  f_.resize(num_links, gtsam::Z_6x1);
+  torques_ = Vector::Zero(num_joints);
+  twist_accels_.resize(num_links, gtsam::Z_6x1);
+  parent_wrenches_.resize(num_joints, gtsam::Z_6x1);
+  child_wrenches_.resize(num_joints, gtsam::Z_6x1);
+}
+
+/* ************************************************************************* */
+void NewtonEulerInverseDynamics::propagate(const Vector6 &root_accel,
+                                           const Vector &joint_accels) {
+  // Forward pass: A_b = X * A_a + S * qddot + c.
+  twist_accels_[tree_.root] = root_accel;
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    twist_accels_[b] = X_[b] * twist_accels_[a] +
+                       tree_.screw[b] * joint_accels(j) + c_[b];
+  }
+
+  // Backward pass: the wrench through the tree joint of a link balances its
+  // own inertial and bias wrenches plus the wrenches from its subtree.
+  for (size_t i = 0; i < tree_.links.size(); i++) {
+    f_[i] = inertias_[i] * twist_accels_[i] + p_[i];
+  }
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k];
+    f_[tree_.parent[b]] += X_[b].transpose() * f_[b];
+  }
+}
+
+/* ************************************************************************* */
+void NewtonEulerInverseDynamics::solve(const std::vector<Pose3> &poses,
+                                       const std::vector<Vector6> &twists,
+                                       const Vector &joint_vels,
+                                       const Vector &joint_accels) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  if (poses.size() != num_links || twists.size() != num_links ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(joint_accels.size()) != num_joints) {
+    throw std::invalid_argument(
+        "NewtonEulerInverseDynamics: input sizes do not match the robot");
+  }
+
+  // Bias wrenches: F = G * A - ad(V)^T * G * V - [0; m * R^T * g].
+  for (size_t i = 0; i < num_links; i++) {
+    const Matrix6 &G = inertias_[i];
+    p_[i] = -Pose3::adjointMap(twists[i]).transpose() * G * twists[i];
+    if (gravity_) {
+      p_[i].tail<3>() -= poses[i].rotation().transpose() * (*gravity_) *
+                         tree_.links[i]->mass();
+    }
+  }
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    X_[b] = (poses[b].inverse() * poses[a]).AdjointMap();
+    c_[b] = Pose3::adjointMap(twists[b]) * tree_.screw[b] * joint_vels(j);
+  }
+
+  const int root = tree_.root;
+  if (tree_.root_fixed) {
+    propagate(gtsam::Z_6x1, joint_accels);
+  } else {
+    // Floating base: the wrench on the root is affine in its acceleration,
+    // f_root = IC_root * A_root + f0, so solve for the A_root making it zero.
+    for (size_t i = 0; i < num_links; i++) IC_[i] = inertias_[i];
+    for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+      const int b = tree_.order[k];
+      IC_[tree_.parent[b]] += X_[b].transpose() * IC_[b] * X_[b];
+    }
+    propagate(gtsam::Z_6x1, joint_accels);
+    const Vector6 root_accel = -IC_[root].ldlt().solve(f_[root]);
+    propagate(root_accel, joint_accels);
+  }
+
+  // Torques and the joint wrenches on both links: tau = S^T * F_b.
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], j = tree_.joint[b];
+    torques_(j) = tree_.screw[b].dot(f_[b]);
+    const Vector6 F_a = -X_[b].transpose() * f_[b];
+    if (tree_.forward[b]) {
+      child_wrenches_[j] = f_[b];
+      parent_wrenches_[j] = F_a;
+    } else {
+      parent_wrenches_[j] = f_[b];
+      child_wrenches_[j] = F_a;
+    }
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values NewtonEulerInverseDynamics::solve(
+    const int t, const gtsam::Values &known_values) {
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  std::vector<Pose3> poses(num_links);
+  std::vector<Vector6> twists(num_links);
+  for (size_t idx = 0; idx < num_links; idx++) {
+    const int i = tree_.links[idx]->id();
+    poses[idx] = Pose(known_values, i, t);
+    twists[idx] = Twist(known_values, i, t);
+  }
+  Vector joint_vels(num_joints), joint_accels(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = tree_.joints[idx]->id();
+    joint_vels(idx) = JointVel(known_values, j, t);
+    joint_accels(idx) = JointAccel(known_values, j, t);
+  }
+
+  solve(poses, twists, joint_vels, joint_accels);
+
+  gtsam::Values values = known_values;
+  try {
+    for (size_t idx = 0; idx < num_joints; idx++) {
+      const auto &joint = tree_.joints[idx];
+      const int j = joint->id();
+      InsertTorque(&values, j, t, torques_(idx));
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   parent_wrenches_[idx]);
+      InsertWrench(&values, joint->child()->id(), j, t, child_wrenches_[idx]);
+    }
+    for (size_t idx = 0; idx < num_links; idx++) {
+      InsertTwistAccel(&values, tree_.links[idx]->id(), t,
+                       twist_accels_[idx]);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    ReportDiagnostic("key already exists:", e.key());
+    throw std::invalid_argument(
+        "NewtonEulerInverseDynamics: known_values should contain no torques, "
+        "wrenches, or twist accelerations.");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
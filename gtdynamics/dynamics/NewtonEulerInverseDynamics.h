@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NewtonEulerInverseDynamics.h
+ * @brief O(n) recursive Newton-Euler inverse dynamics for tree-structured
+ * robots.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * NewtonEulerInverseDynamics implements the recursive Newton-Euler algorithm
+ * in the twist/wrench conventions used by the dynamics factors. The results
+ * have the same semantics as DynamicsGraph::linearSolveID, at a cost linear in
+ * the number of links, and the tree topology is extracted only once so the
+ * object can be reused at every control tick.
+ *
+ * If the robot has no fixed link, the twist acceleration of the root is
+ * unknown: it is found from the composite inertia of the whole tree, so that
+ * no wrench acts on the root through a joint.
+ */
+class NewtonEulerInverseDynamics {
+ private:
+  KinematicTree tree_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  std::vector<gtsam::Matrix6> inertias_;
+
+  /// Per-solve buffers, indexed by link: relative adjoints, velocity product
+  /// accelerations, bias wrenches, wrenches through the tree joint, and
+  /// composite inertias (floating base only).
+  std::vector<gtsam::Matrix6> X_, IC_;
+  std::vector<gtsam::Vector6> c_, p_, f_;
+
+  /// Results of the last solve.
+  gtsam::Vector torques_;
+  std::vector<gtsam::Vector6> twist_accels_, parent_wrenches_,
+      child_wrenches_;
+
+  /// Propagate accelerations from the root and accumulate wrenches back.
+  void propagate(const gtsam::Vector6 &root_accel,
+                 const gtsam::Vector &joint_accels);
+
+ public:
+  /**
+   * Constructor, extracts the tree topology of the robot.
+   * @param robot    the robot, must be a kinematic tree
+   * @param gravity  gravity in world frame
+   */
+  explicit NewtonEulerInverseDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Number of joints in the robot.
+  size_t numJoints() const { return tree_.joints.size(); }
+
+  /// Number of links in the robot.
+  size_t numLinks() const { return tree_.links.size(); }
+
+  /// Index of the joint with the given id in the vectors used by solve.
+  int jointIndex(uint16_t id) const { return tree_.joint_index.at(id); }
+
+  /// Index of the link with the given id in the vectors used by solve.
+  int linkIndex(uint16_t id) const { return tree_.link_index.at(id); }
+
+  /**
+   * Solve inverse dynamics from plain arrays, without touching gtsam::Values.
+   * Does not allocate, so it can run in a real-time loop, see RealTime.h.
+   *
+   * @param poses        CoM pose of every link, in Robot::links() order
+   * @param twists       twist of every link, in Robot::links() order
+   * @param joint_vels   joint velocities, in Robot::joints() order
+   * @param joint_accels joint accelerations, in Robot::joints() order
+   */
+  void solve(const std::vector<gtsam::Pose3> &poses,
+             const std::vector<gtsam::Vector6> &twists,
+             const gtsam::Vector &joint_vels,
+             const gtsam::Vector &joint_accels);
+
+  /**
+   * Solve inverse dynamics, Values version with the same semantics as
+   * DynamicsGraph::linearSolveID.
+   *
+   * @param t            time step
+   * @param known_values link poses and twists, joint velocities and
+   * accelerations
+   * @return known_values augmented with torques, wrenches and twist
+   * accelerations
+   */
+  gtsam::Values solve(const int t, const gtsam::Values &known_values);
+
+  /// Torques of the last solve, in joint order.
+  const gtsam::Vector &torques() const { return torques_; }
+
+  /// Twist accelerations of the last solve, in link order.
+  const std::vector<gtsam::Vector6> &twistAccels() const {
+    return twist_accels_;
+  }
+
+  /// Wrenches on the parent link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &parentWrenches() const {
+    return parent_wrenches_;
+  }
+
+  /// Wrenches on the child link of each joint from the last solve.
+  const std::vector<gtsam::Vector6> &childWrenches() const {
+    return child_wrenches_;
+  }
+};
+
+}  // namespace gtdynamics
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/NoiseModels.h>
 #include <gtsam/linear/NoiseModel.h>
 
 namespace gtdynamics {
@@ -66,6 +67,12 @@ class OptimizerSetting {
   double epsilon;   // obstacle clearance
   double obsSigma;  // obstacle cost model covariance
 
+  /// graph construction setting
+  size_t num_threads;  // threads building multi-step graphs, 0 for all cores
+  bool analytic_factors;  // hand-derived instead of expression factors
+  bool contact_block_factors;  // one contact factor per step, not per contact
+  bool joint_limit_block_factors;  // one limit factor per step, not per limit
+
   /// default constructor
   OptimizerSetting();
 
@@ -83,45 +90,41 @@ class OptimizerSetting {
   OptimizerSetting(double sigma_dynamics, double sigma_linear = 0.001,
                    double sigma_contact = 0.001, double sigma_joint = 0.001,
                    double sigma_collocation = 0.001, double sigma_time = 0.001)
-      : bp_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        bv_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        ba_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        p_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        v_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        a_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_a_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_f_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        fa_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)),
-        linear_t_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_linear)),
-        cp_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cfriction_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cv_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        ca_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        cm_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_dynamics)),
-        linear_planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_linear)),
-        prior_q_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qv_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qa_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        q_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        v_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        time_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_time)),
-        jl_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
+      : bp_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        bv_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        ba_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        p_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        v_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        a_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        linear_a_cost_model(SharedIsotropic(6, sigma_linear)),
+        f_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        linear_f_cost_model(SharedIsotropic(6, sigma_linear)),
+        fa_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        t_cost_model(SharedIsotropic(1, sigma_dynamics)),
+        linear_t_cost_model(SharedIsotropic(1, sigma_linear)),
+        cp_cost_model(SharedIsotropic(1, sigma_contact)),
+        cfriction_cost_model(SharedIsotropic(1, sigma_contact)),
+        cv_cost_model(SharedIsotropic(3, sigma_contact)),
+        ca_cost_model(SharedIsotropic(3, sigma_contact)),
+        cm_cost_model(SharedIsotropic(3, sigma_contact)),
+        planar_cost_model(SharedIsotropic(3, sigma_dynamics)),
+        linear_planar_cost_model(SharedIsotropic(3, sigma_linear)),
+        prior_q_cost_model(SharedIsotropic(1, sigma_joint)),
+        prior_qv_cost_model(SharedIsotropic(1, sigma_joint)),
+        prior_qa_cost_model(SharedIsotropic(1, sigma_joint)),
+        prior_t_cost_model(SharedIsotropic(1, sigma_joint)),
+        q_col_cost_model(SharedIsotropic(1, sigma_collocation)),
+        v_col_cost_model(SharedIsotropic(1, sigma_collocation)),
+        pose_col_cost_model(SharedIsotropic(6, sigma_collocation)),
+        twist_col_cost_model(SharedIsotropic(6, sigma_collocation)),
+        time_cost_model(SharedIsotropic(1, sigma_time)),
+        jl_cost_model(SharedIsotropic(1, sigma_joint)),
         rel_thresh(1e-2),
-        max_iter(50) {}
+        max_iter(50),
+        num_threads(0),
+        analytic_factors(false),
+        contact_block_factors(false),
+        joint_limit_block_factors(false) {}
 
   // default destructor
   ~OptimizerSetting() {}
@@ -140,6 +143,20 @@ class OptimizerSetting {
 
   // set maximum iteration number
   void setMaxIteration(size_t iter) { max_iter = iter; }
+
+  // set number of threads used to build multi-step graphs
+  void setNumThreads(size_t threads) { num_threads = threads; }
+
+  // use hand-derived pose, twist, acceleration, wrench and torque factors
+  void setAnalyticFactors(bool analytic) { analytic_factors = analytic; }
+
+  // use one ContactDynamicsBlockFactor per time step for all contacts
+  void setContactBlockFactors(bool block) { contact_block_factors = block; }
+
+  // use one JointLimitBlockFactor per time step for all joint limits
+  void setJointLimitBlockFactors(bool block) {
+    joint_limit_block_factors = block;
+  }
 };
 
 }  // namespace gtdynamics
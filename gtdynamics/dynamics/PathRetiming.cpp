@@ -0,0 +1,352 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PathRetiming.cpp
+ * @brief Time-optimal parameterization of joint-space paths under torque,
+ * velocity and acceleration limits.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/dynamics/PathRetiming.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+
+// Largest x = sdot^2 considered, where nothing else bounds the speed.
+constexpr double kMaxX = 1e8;
+
+// Half-plane n_u * u + n_x * x <= d, with |(n_u, n_x)| = 1.
+struct HalfPlane {
+  double nu, nx, d;
+};
+
+// Affine constraint lo <= a * u + b * x <= hi.
+struct Constraint {
+  double a, b, lo, hi;
+};
+
+// Add both sides of a constraint; false if it is violated for all (u, x).
+bool AddConstraint(const Constraint &c, std::vector<HalfPlane> *planes) {
+  const double norm = std::hypot(c.a, c.b);
+  if (norm < 1e-12) return c.lo <= 1e-9 && c.hi >= -1e-9;
+  planes->push_back({c.a / norm, c.b / norm, c.hi / norm});
+  planes->push_back({-c.a / norm, -c.b / norm, -c.lo / norm});
+  return true;
+}
+
+// Range of x over the polygon of the half-planes, found by enumerating its
+// vertices; false if the polygon is empty.
+bool XRange(const std::vector<HalfPlane> &planes, double *x_min,
+            double *x_max) {
+  *x_min = std::numeric_limits<double>::infinity();
+  *x_max = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < planes.size(); i++) {
+    for (size_t k = i + 1; k < planes.size(); k++) {
+      const HalfPlane &p = planes[i], &q = planes[k];
+      const double det = p.nu * q.nx - p.nx * q.nu;
+      if (std::abs(det) < 1e-12) continue;
+      const double u = (p.d * q.nx - p.nx * q.d) / det;
+      const double x = (p.nu * q.d - p.d * q.nu) / det;
+      bool inside = true;
+      for (const HalfPlane &h : planes) {
+        if (h.nu * u + h.nx * x - h.d >
+            1e-9 * (1.0 + std::abs(h.d) + std::abs(x))) {
+          inside = false;
+          break;
+        }
+      }
+      if (!inside) continue;
+      *x_min = std::min(*x_min, x);
+      *x_max = std::max(*x_max, x);
+    }
+  }
+  if (*x_min > *x_max) return false;
+  *x_min = std::max(*x_min, 0.0);
+  return true;
+}
+
+// Range of u at a given x over the half-planes that involve u.
+void URange(const std::vector<HalfPlane> &planes, double x, double *lo,
+            double *hi) {
+  for (const HalfPlane &h : planes) {
+    if (std::abs(h.nu) < 1e-12) continue;
+    const double bound = (h.d - h.nx * x) / h.nu;
+    if (h.nu > 0) {
+      *hi = std::min(*hi, bound);
+    } else {
+      *lo = std::max(*lo, bound);
+    }
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+void RetimedPath::sample(double t, Vector *q, Vector *v) const {
+  const size_t n = times.size();
+  t = std::min(std::max(t, times.front()), times.back());
+  size_t k = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+  k = std::min(std::max<size_t>(k, 1), n - 1);
+  const double dt = times[k] - times[k - 1];
+  const double alpha = dt > 0 ? (t - times[k - 1]) / dt : 0.0;
+  *q = (1 - alpha) * angles.row(k - 1).transpose() +
+       alpha * angles.row(k).transpose();
+  if (v) {
+    *v = (1 - alpha) * vels.row(k - 1).transpose() +
+         alpha * vels.row(k).transpose();
+  }
+}
+
+/* ************************************************************************* */
+PathRetiming::PathRetiming(const Robot &robot,
+                           const boost::optional<gtsam::Vector3> &gravity,
+                           const PathRetimingParameters &parameters)
+    : robot_(robot), gravity_(gravity), parameters_(parameters) {
+  if (parameters_.num_gridpoints < 2) {
+    throw std::invalid_argument(
+        "PathRetiming: at least 2 grid points are needed");
+  }
+  const auto joints = robot_.joints();
+  torque_limit_.resize(joints.size());
+  velocity_limit_.resize(joints.size());
+  acceleration_limit_.resize(joints.size());
+  for (size_t j = 0; j < joints.size(); j++) {
+    const JointParams &params = joints[j]->parameters();
+    torque_limit_(j) = params.torque_limit;
+    velocity_limit_(j) = params.velocity_limit;
+    acceleration_limit_(j) = params.acceleration_limit;
+  }
+  // Fail early on a missing fixed link or a robot with loops.
+  BatchForwardKinematics check_fk(robot_);
+  NewtonEulerInverseDynamics check_id(robot_, gravity_);
+}
+
+/* ************************************************************************* */
+void PathRetiming::Spline(const std::vector<Vector> &waypoints,
+                          const std::vector<double> &s, Matrix *q, Matrix *dq,
+                          Matrix *ddq) {
+  if (waypoints.empty()) {
+    throw std::invalid_argument("PathRetiming: no waypoints");
+  }
+
+  // Distinct waypoints, at normalized chord-length parameters.
+  std::vector<Vector> points{waypoints.front()};
+  std::vector<double> knots{0.0};
+  for (size_t k = 1; k < waypoints.size(); k++) {
+    if (waypoints[k].size() != points.front().size()) {
+      throw std::invalid_argument(
+          "PathRetiming: waypoints must have the same size");
+    }
+    const double length = (waypoints[k] - points.back()).norm();
+    if (length < 1e-12) continue;
+    points.push_back(waypoints[k]);
+    knots.push_back(knots.back() + length);
+  }
+  if (points.size() < 2) {
+    throw std::invalid_argument("PathRetiming: path has zero length");
+  }
+  for (double &knot : knots) knot /= knots.back();
+
+  // Second derivatives of the natural spline, from the tridiagonal system
+  // h_{k-1} M_{k-1} + 2 (h_{k-1} + h_k) M_k + h_k M_{k+1} = 6 (slope
+  // differences), with M_0 = M_n = 0, solved by forward elimination.
+  const size_t n = points.size() - 1, dof = points.front().size();
+  std::vector<double> h(n);
+  for (size_t k = 0; k < n; k++) h[k] = knots[k + 1] - knots[k];
+  std::vector<Vector> M(n + 1, Vector::Zero(dof)),
+      rhs(n + 1, Vector::Zero(dof));
+  std::vector<double> diag(n + 1, 1.0), upper(n + 1, 0.0);
+  for (size_t k = 1; k < n; k++) {
+    const Vector r = 6.0 * ((points[k + 1] - points[k]) / h[k] -
+                            (points[k] - points[k - 1]) / h[k - 1]);
+    const double factor = (k > 1) ? h[k - 1] / diag[k - 1] : 0.0;
+    diag[k] = 2.0 * (h[k - 1] + h[k]) - factor * upper[k - 1];
+    upper[k] = h[k];
+    rhs[k] = r - factor * rhs[k - 1];
+  }
+  for (size_t k = n - 1; k >= 1; k--) {
+    M[k] = (rhs[k] - upper[k] * M[k + 1]) / diag[k];
+  }
+
+  q->resize(s.size(), dof);
+  dq->resize(s.size(), dof);
+  ddq->resize(s.size(), dof);
+  for (size_t i = 0; i < s.size(); i++) {
+    const double si = std::min(std::max(s[i], 0.0), 1.0);
+    size_t k = std::upper_bound(knots.begin(), knots.end(), si) -
+               knots.begin();
+    k = std::min(std::max<size_t>(k, 1), n) - 1;
+    const double hk = h[k], A = knots[k + 1] - si, B = si - knots[k];
+    const Vector c0 = points[k] / hk - M[k] * hk / 6.0;
+    const Vector c1 = points[k + 1] / hk - M[k + 1] * hk / 6.0;
+    q->row(i) = (M[k] * A * A * A / (6.0 * hk) +
+                 M[k + 1] * B * B * B / (6.0 * hk) + c0 * A + c1 * B)
+                    .transpose();
+    dq->row(i) = (-M[k] * A * A / (2.0 * hk) + M[k + 1] * B * B / (2.0 * hk) -
+                  c0 + c1)
+                     .transpose();
+    ddq->row(i) = ((M[k] * A + M[k + 1] * B) / hk).transpose();
+  }
+}
+
+/* ************************************************************************* */
+std::vector<Vector> PathRetiming::Waypoints(const Robot &robot,
+                                            const gtsam::Values &values,
+                                            size_t k_start, size_t k_end) {
+  const auto joints = robot.joints();
+  std::vector<Vector> waypoints;
+  for (size_t k = k_start; k <= k_end; k++) {
+    Vector q(joints.size());
+    for (size_t j = 0; j < joints.size(); j++) {
+      q(j) = JointAngle(values, joints[j]->id(), k);
+    }
+    waypoints.push_back(q);
+  }
+  return waypoints;
+}
+
+/* ************************************************************************* */
+boost::optional<RetimedPath> PathRetiming::retime(
+    const std::vector<Vector> &waypoints) const {
+  const size_t G = parameters_.num_gridpoints, N = G - 1,
+               dof = robot_.numJoints();
+  const double delta = 1.0 / N;
+  RetimedPath path;
+  for (size_t i = 0; i < G; i++) path.s.push_back(i * delta);
+  Matrix Q, dQ, ddQ;
+  Spline(waypoints, path.s, &Q, &dQ, &ddQ);
+  if (size_t(Q.cols()) != dof) {
+    throw std::invalid_argument(
+        "PathRetiming: waypoints do not match the robot");
+  }
+
+  // Dynamics coefficients tau = A * u + B * x + C at every grid point, with
+  // poses and twists (for sdot = 1) of the whole grid in one batch.
+  Matrix A(G, dof), B(G, dof), C(G, dof);
+  if (parameters_.torque_limits) {
+    BatchForwardKinematics fk(robot_);
+    fk.compute(Q, dQ);
+    const auto links = robot_.links();
+    const size_t chunk = 16, num_chunks = (G + chunk - 1) / chunk;
+    ParallelFor(num_chunks, parameters_.num_threads, [&](size_t c) {
+      NewtonEulerInverseDynamics id(robot_, gravity_);
+      const Vector zero = Vector::Zero(dof);
+      std::vector<gtsam::Pose3> poses(links.size());
+      std::vector<gtsam::Vector6> twists(links.size()),
+          rest(links.size(), gtsam::Z_6x1);
+      for (size_t i = c * chunk; i < std::min(G, (c + 1) * chunk); i++) {
+        for (size_t l = 0; l < links.size(); l++) {
+          poses[l] = fk.pose(i, links[l]->id());
+          twists[l] = fk.twist(i, links[l]->id());
+        }
+        const Vector dq = dQ.row(i).transpose(), ddq = ddQ.row(i).transpose();
+        id.solve(poses, rest, zero, zero);
+        const Vector c0 = id.torques();
+        C.row(i) = c0.transpose();
+        id.solve(poses, rest, zero, dq);
+        A.row(i) = (id.torques() - c0).transpose();
+        id.solve(poses, twists, dq, ddq);
+        B.row(i) = (id.torques() - c0).transpose();
+      }
+    });
+  }
+
+  // Constraints and speed bound of every grid point.
+  std::vector<std::vector<HalfPlane>> stages(G);
+  std::vector<double> x_upper(G, kMaxX);
+  for (size_t i = 0; i < G; i++) {
+    std::vector<HalfPlane> &planes = stages[i];
+    for (size_t j = 0; j < dof; j++) {
+      bool feasible = true;
+      if (parameters_.torque_limits) {
+        const double tau = torque_limit_(j);
+        feasible &= AddConstraint(
+            {A(i, j), B(i, j), -tau - C(i, j), tau - C(i, j)}, &planes);
+      }
+      if (parameters_.acceleration_limits) {
+        feasible &= AddConstraint({dQ(i, j), ddQ(i, j),
+                                   -acceleration_limit_(j),
+                                   acceleration_limit_(j)},
+                                  &planes);
+      }
+      if (!feasible) return boost::none;
+      if (parameters_.velocity_limits && std::abs(dQ(i, j)) > 1e-12) {
+        const double bound = velocity_limit_(j) / std::abs(dQ(i, j));
+        x_upper[i] = std::min(x_upper[i], bound * bound);
+      }
+    }
+    planes.push_back({0.0, 1.0, x_upper[i]});
+    planes.push_back({0.0, -1.0, 0.0});
+  }
+
+  // Backward pass: K_i is the range of x at s_i from which K_{i+1} can be
+  // reached, ending at rest.
+  std::vector<double> K_lo(G, 0.0), K_hi(G, 0.0);
+  double u_lo = -std::numeric_limits<double>::infinity(),
+         u_hi = std::numeric_limits<double>::infinity();
+  URange(stages[N], 0.0, &u_lo, &u_hi);
+  if (u_lo > u_hi + 1e-9 * (1.0 + std::abs(u_hi))) return boost::none;
+  const double n2 = std::sqrt(1.0 + 4.0 * delta * delta);
+  for (size_t i = N; i-- > 0;) {
+    std::vector<HalfPlane> planes = stages[i];
+    planes.push_back({2.0 * delta / n2, 1.0 / n2, K_hi[i + 1] / n2});
+    planes.push_back({-2.0 * delta / n2, -1.0 / n2, -K_lo[i + 1] / n2});
+    if (!XRange(planes, &K_lo[i], &K_hi[i])) return boost::none;
+  }
+  if (K_lo[0] > 1e-9) return boost::none;
+
+  // Forward pass: from rest, the largest u that stays controllable.
+  std::vector<double> x(G, 0.0), u(G, 0.0);
+  for (size_t i = 0; i < N; i++) {
+    double lo = (K_lo[i + 1] - x[i]) / (2.0 * delta),
+           hi = (K_hi[i + 1] - x[i]) / (2.0 * delta);
+    URange(stages[i], x[i], &lo, &hi);
+    const double next = x[i] + 2.0 * delta * std::max(lo, hi);
+    x[i + 1] = std::min(std::max(next, K_lo[i + 1]), K_hi[i + 1]);
+    u[i] = (x[i + 1] - x[i]) / (2.0 * delta);
+  }
+  u[N] = std::min(std::max(u[N - 1], u_lo), u_hi);
+
+  // Times from the average speed over every interval.
+  path.times.assign(G, 0.0);
+  for (size_t i = 0; i < N; i++) {
+    const double speed = std::sqrt(x[i]) + std::sqrt(x[i + 1]);
+    if (speed <= 0) return boost::none;
+    path.times[i + 1] = path.times[i] + 2.0 * delta / speed;
+  }
+
+  path.angles = Q;
+  path.vels.resize(G, dof);
+  path.accels.resize(G, dof);
+  path.torques.resize(G, dof);
+  for (size_t i = 0; i < G; i++) {
+    path.vels.row(i) = dQ.row(i) * std::sqrt(x[i]);
+    path.accels.row(i) = dQ.row(i) * u[i] + ddQ.row(i) * x[i];
+    if (parameters_.torque_limits) {
+      path.torques.row(i) = A.row(i) * u[i] + B.row(i) * x[i] + C.row(i);
+    } else {
+      path.torques.row(i).setZero();
+    }
+  }
+  return path;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PathRetiming.h
+ * @brief Time-optimal parameterization of joint-space paths under torque,
+ * velocity and acceleration limits.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of PathRetiming.
+struct PathRetimingParameters {
+  size_t num_gridpoints = 100;  // grid points along the path, at least 2
+  bool torque_limits = true;    // respect JointParams::torque_limit
+  bool velocity_limits = true;  // respect JointParams::velocity_limit
+  bool acceleration_limits = true;  // respect JointParams::acceleration_limit
+  size_t num_threads = 0;  // 0 for all threads of the executor
+};
+
+/// A retimed path, sampled at the grid points.
+struct RetimedPath {
+  std::vector<double> s;      // path parameter of the grid points, in [0, 1]
+  std::vector<double> times;  // time at the grid points, starting at 0
+  /// (num_gridpoints x numJoints) joint angles, velocities, accelerations
+  /// and torques, in Robot::joints() order.
+  gtsam::Matrix angles, vels, accels, torques;
+
+  /// Duration of the retimed path.
+  double duration() const { return times.back(); }
+
+  /// Joint angles and velocities at time t, linearly interpolated.
+  void sample(double t, gtsam::Vector *q, gtsam::Vector *v = nullptr) const;
+};
+
+/**
+ * PathRetiming finds the fastest timing s(t) of a geometric path q(s), from
+ * rest to rest, in the manner of TOPP-RA (Pham and Pham, 2018).
+ *
+ * Waypoints are joined by a natural cubic spline in s, at normalized
+ * chord-length parameters, so that q'(s) and q''(s) are continuous. Along the
+ * path, with x = sdot^2 and u = sddot, the inverse dynamics are affine:
+ *   tau(s) = a(s) * u + b(s) * x + c(s),
+ * with c = ID(q, 0, 0), a = ID(q, 0, q') - c and b = ID(q, q', q'') - c. The
+ * coefficients are found at every grid point with BatchForwardKinematics and
+ * NewtonEulerInverseDynamics, grid points in parallel. Joint velocity and
+ * acceleration limits are affine in (u, x) as well, so every stage is a 2D
+ * linear program, solved exactly by enumerating vertices: a backward pass
+ * finds the controllable sets of x, and a forward pass greedily picks the
+ * largest admissible u.
+ *
+ * Damping is not included in the torques, as it is not affine in x. The robot
+ * needs a fixed link, and must be a kinematic tree.
+ */
+class PathRetiming {
+ private:
+  Robot robot_;
+  boost::optional<gtsam::Vector3> gravity_;
+  PathRetimingParameters parameters_;
+  gtsam::Vector torque_limit_, velocity_limit_, acceleration_limit_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot      the robot, with a fixed link
+   * @param gravity    gravity in world frame
+   * @param parameters retiming parameters
+   */
+  PathRetiming(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const PathRetimingParameters &parameters = PathRetimingParameters());
+
+  const PathRetimingParameters &parameters() const { return parameters_; }
+
+  /**
+   * Sample the spline through waypoints at path parameters s.
+   * @param waypoints  joint angles, in Robot::joints() order
+   * @param s          path parameters in [0, 1]
+   * @param q, dq, ddq (s.size() x numJoints) q(s), q'(s) and q''(s)
+   */
+  static void Spline(const std::vector<gtsam::Vector> &waypoints,
+                     const std::vector<double> &s, gtsam::Matrix *q,
+                     gtsam::Matrix *dq, gtsam::Matrix *ddq);
+
+  /**
+   * Waypoints from the joint angles of time steps k_start to k_end, e.g. the
+   * result of Kinematics::interpolate.
+   */
+  static std::vector<gtsam::Vector> Waypoints(const Robot &robot,
+                                              const gtsam::Values &values,
+                                              size_t k_start, size_t k_end);
+
+  /**
+   * Retime the path through waypoints.
+   * @param waypoints joint angles, in Robot::joints() order
+   * @return the retimed path, or boost::none if the path cannot be followed
+   * within the limits
+   */
+  boost::optional<RetimedPath> retime(
+      const std::vector<gtsam::Vector> &waypoints) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,168 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.cpp
+ * @brief Dynamics graph of a planar robot with SE(2) variables.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/PlanarDynamicsGraph.h>
+#include <gtdynamics/factors/PlanarFactors.h>
+#include <gtdynamics/utils/GraphArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose2;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+namespace {
+
+// Same as graph->addPrior, but allocated from the current GraphArena, if any.
+template <class T>
+void AddPrior(NonlinearFactorGraph *graph, gtsam::Key key, const T &prior,
+              const gtsam::SharedNoiseModel &model) {
+  graph->push_back(MakeShared<gtsam::PriorFactor<T>>(key, prior, model));
+}
+
+// Gravity, defaulting to the one of DynamicsGraph.
+Vector3 Gravity(const boost::optional<Vector3> &gravity) {
+  return gravity ? *gravity : Vector3(0, 0, -9.8);
+}
+
+// 3-dimensional model with the first sigma of a 6-dimensional one.
+gtsam::SharedNoiseModel PlanarModel(const gtsam::SharedNoiseModel &model) {
+  if (boost::dynamic_pointer_cast<gtsam::noiseModel::Constrained>(model)) {
+    return gtsam::noiseModel::Constrained::All(3);
+  }
+  auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  return gtsam::noiseModel::Isotropic::Sigma(3,
+                                             diagonal ? diagonal->sigma(0) : 1);
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+PlanarDynamicsGraph::PlanarDynamicsGraph(
+    const Robot &robot, const Vector3 &planar_axis, const OptimizerSetting &opt,
+    const boost::optional<Vector3> &gravity)
+    : DynamicsGraph(opt, gravity),
+      planar_(robot, planar_axis),
+      bp_model_(PlanarModel(opt.bp_cost_model)),
+      bv_model_(PlanarModel(opt.bv_cost_model)),
+      ba_model_(PlanarModel(opt.ba_cost_model)),
+      p_model_(PlanarModel(opt.p_cost_model)),
+      v_model_(PlanarModel(opt.v_cost_model)),
+      a_model_(PlanarModel(opt.a_cost_model)),
+      f_model_(PlanarModel(opt.f_cost_model)),
+      fa_model_(PlanarModel(opt.fa_cost_model)) {}
+
+/* ************************************************************************* */
+void PlanarDynamicsGraph::checkNoContacts(
+    const boost::optional<PointOnLinks> &contact_points,
+    const char *method) const {
+  if (contact_points && !contact_points->empty()) {
+    throw std::invalid_argument("PlanarDynamicsGraph::" + std::string(method) +
+                                ": contacts are not supported");
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::qFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  checkNoContacts(contact_points, "qFactors");
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  for (auto &&link : planar_.links()) {
+    if (link.link->isFixed()) {
+      const int i = link.link->id();
+      AddPrior(&graph, PoseKey(i, k),
+               planar_.planarPose(i, link.link->getFixedPose()), bp_model_);
+    }
+  }
+  for (auto &&joint : planar_.joints()) {
+    graph.push_back(MakeShared<PlanarPoseFactor>(p_model_, joint, k));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::vFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  checkNoContacts(contact_points, "vFactors");
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  for (auto &&link : planar_.links()) {
+    if (link.link->isFixed()) {
+      AddPrior<Vector3>(&graph, TwistKey(link.link->id(), k), Vector3::Zero(),
+                        bv_model_);
+    }
+  }
+  for (auto &&joint : planar_.joints()) {
+    graph.push_back(MakeShared<PlanarTwistFactor>(v_model_, joint, k));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::aFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  checkNoContacts(contact_points, "aFactors");
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  for (auto &&link : planar_.links()) {
+    if (link.link->isFixed()) {
+      AddPrior<Vector3>(&graph, TwistAccelKey(link.link->id(), k),
+                        Vector3::Zero(), ba_model_);
+    }
+  }
+  for (auto &&joint : planar_.joints()) {
+    graph.push_back(MakeShared<PlanarTwistAccelFactor>(a_model_, joint, k));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::dynamicsFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  checkNoContacts(contact_points, "dynamicsFactors");
+  GraphArena::Scope scope(arena_);
+  NonlinearFactorGraph graph;
+  const gtsam::Vector2 gravity = planar_.planarGravity(Gravity(gravity_));
+  for (auto &&link : planar_.links()) {
+    if (link.link->isFixed()) continue;
+    const int i = link.link->id();
+    std::vector<DynamicsSymbol> wrench_keys;
+    for (auto &&joint : link.link->joints()) {
+      wrench_keys.push_back(WrenchKey(i, joint->id(), k));
+    }
+    graph.push_back(MakeShared<PlanarWrenchFactor>(fa_model_, link,
+                                                   wrench_keys, k, gravity));
+  }
+  for (auto &&joint : planar_.joints()) {
+    graph.push_back(
+        MakeShared<PlanarWrenchEquivalenceFactor>(f_model_, joint, k));
+    graph.push_back(
+        MakeShared<PlanarTorqueFactor>(opt_.t_cost_model, joint, k));
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.h
+ * @brief Dynamics graph of a planar robot with SE(2) variables.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/PlanarRobot.h>
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <boost/optional.hpp>
+
+namespace gtdynamics {
+
+/**
+ * PlanarDynamicsGraph builds the dynamics graph of a robot that moves in a
+ * plane with planar variables: link poses are Pose2 and link twists, twist
+ * accelerations and wrenches 3-vectors, see PlanarRobot, with the keys of
+ * DynamicsGraph. Compared to DynamicsGraph with a planar axis, variables have
+ * half the dimension and no WrenchPlanarFactor is needed, since out-of-plane
+ * motion cannot be represented.
+ *
+ * The factors are those of DynamicsGraph, with 3-dimensional noise models
+ * with the first sigma of the 6-dimensional ones of the OptimizerSetting.
+ * Collocation and all other factors that only involve joints are unchanged;
+ * use PlanarRobot::toPlanar and toSpatial to convert initial values and
+ * results. Contacts are not supported.
+ */
+class PlanarDynamicsGraph : public DynamicsGraph {
+ private:
+  PlanarRobot planar_;
+  gtsam::SharedNoiseModel bp_model_, bv_model_, ba_model_, p_model_, v_model_,
+      a_model_, f_model_, fa_model_;
+
+  // Throw if contact points are given.
+  void checkNoContacts(const boost::optional<PointOnLinks> &contact_points,
+                       const char *method) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot       the robot, see PlanarRobot
+   * @param planar_axis normal of the plane, in world frame
+   * @param opt         settings for the optimizer
+   * @param gravity     gravitational acceleration, in world frame
+   */
+  PlanarDynamicsGraph(
+      const Robot &robot, const gtsam::Vector3 &planar_axis,
+      const OptimizerSetting &opt = OptimizerSetting(),
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return the planar model of the robot.
+  const PlanarRobot &planarRobot() const { return planar_; }
+
+  /// Fixed link pose priors and joint pose factors.
+  gtsam::NonlinearFactorGraph qFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Fixed link twist priors and joint twist factors.
+  gtsam::NonlinearFactorGraph vFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Fixed link acceleration priors and joint acceleration factors.
+  gtsam::NonlinearFactorGraph aFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points =
+          boost::none) const override;
+
+  /// Link wrench balance, joint wrench equivalence and torque factors.
+  gtsam::NonlinearFactorGraph dynamicsFactors(
+      const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,189 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarForwardDynamics.cpp
+ * @brief Forward dynamics of planar tree-structured robots with SE(2)
+ * quantities.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/PlanarForwardDynamics.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix3;
+using gtsam::Pose2;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PlanarForwardDynamics::PlanarForwardDynamics(
+    const Robot &robot, const Vector3 &planar_axis,
+    const boost::optional<Vector3> &gravity)
+    : planar_(robot, planar_axis) {
+  if (!tree_.build(robot) || !tree_.root_fixed) {
+    throw std::invalid_argument(
+        "PlanarForwardDynamics: robot is not a kinematic tree with a fixed "
+        "link");
+  }
+  if (gravity) gravity_ = planar_.planarGravity(*gravity);
+
+  const size_t num_links = tree_.links.size(),
+               num_joints = tree_.joints.size();
+  rest_.resize(num_links);
+  screw_.resize(num_links, Vector3::Zero());
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k];
+    const PlanarRobot::PlanarJoint &joint = planar_.joints()[tree_.joint[b]];
+    if (tree_.forward[b]) {
+      rest_[b] = joint.pMc;
+      screw_[b] = joint.screw;
+    } else {
+      // aTb(q) = Exp(-S q) pMc^-1 = pMc^-1 Exp(-Ad(pMc) S q).
+      rest_[b] = joint.pMc.inverse();
+      screw_[b] = -joint.pMc.AdjointMap() * joint.screw;
+    }
+  }
+  const PlanarRobot::PlanarLink &root = planar_.links()[tree_.root];
+  root_pose_ =
+      planar_.planarPose(root.link->id(), root.link->getFixedPose());
+
+  poses_.resize(num_links);
+  X_.resize(num_links, gtsam::I_3x3);
+  IC_.resize(num_links);
+  twists_.resize(num_links, Vector3::Zero());
+  bias_accels_.resize(num_links, Vector3::Zero());
+  accels_.resize(num_links, Vector3::Zero());
+  wrenches_.resize(num_links, Vector3::Zero());
+  mass_matrix_ = gtsam::Matrix::Zero(num_joints, num_joints);
+  joint_accels_ = Vector::Zero(num_joints);
+}
+
+/* ************************************************************************* */
+void PlanarForwardDynamics::inverseDynamics() {
+  const auto &links = planar_.links();
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b];
+    accels_[b] = X_[b] * accels_[a] +
+                 screw_[b] * joint_accels_(tree_.joint[b]) + bias_accels_[b];
+    const Matrix3 &G = links[b].inertia;
+    wrenches_[b] = G * accels_[b] -
+                   Pose2::adjointMap(twists_[b]).transpose() * G * twists_[b];
+    if (gravity_) {
+      const gtsam::Point2 g = poses_[b].rotation().unrotate(*gravity_);
+      wrenches_[b].head<2>() -= G(0, 0) * g;
+    }
+  }
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k], a = tree_.parent[b];
+    if (a != tree_.root) wrenches_[a] += X_[b].transpose() * wrenches_[b];
+  }
+}
+
+/* ************************************************************************* */
+const Vector &PlanarForwardDynamics::solve(const Vector &joint_angles,
+                                           const Vector &joint_vels,
+                                           const Vector &torques) {
+  const size_t num_joints = tree_.joints.size();
+  if (size_t(joint_angles.size()) != num_joints ||
+      size_t(joint_vels.size()) != num_joints ||
+      size_t(torques.size()) != num_joints) {
+    throw std::invalid_argument(
+        "PlanarForwardDynamics: input sizes do not match the robot");
+  }
+  const auto &links = planar_.links();
+
+  // Poses, twists and velocity-product accelerations, from the root.
+  poses_[tree_.root] = root_pose_;
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const Pose2 aTb = rest_[b] * Pose2::Expmap(screw_[b] * joint_angles(j));
+    poses_[b] = poses_[a] * aTb;
+    X_[b] = aTb.inverse().AdjointMap();
+    twists_[b] = X_[b] * twists_[a] + screw_[b] * joint_vels(j);
+    bias_accels_[b] =
+        Pose2::adjointMap(twists_[b]) * screw_[b] * joint_vels(j);
+  }
+
+  // Bias torques, from inverse dynamics without joint accelerations.
+  joint_accels_.setZero();
+  inverseDynamics();
+  Vector bias(num_joints);
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k];
+    bias(tree_.joint[b]) = screw_[b].dot(wrenches_[b]);
+  }
+
+  // Mass matrix, from the composite inertias.
+  for (size_t i = 0; i < links.size(); i++) IC_[i] = links[i].inertia;
+  for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+    const int b = tree_.order[k];
+    IC_[tree_.parent[b]] += X_[b].transpose() * IC_[b] * X_[b];
+  }
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], j = tree_.joint[b];
+    Vector3 F = IC_[b] * screw_[b];
+    mass_matrix_(j, j) = screw_[b].dot(F);
+    for (int d = b; tree_.parent[d] != tree_.root;) {
+      F = X_[d].transpose() * F;
+      d = tree_.parent[d];
+      const int i = tree_.joint[d];
+      mass_matrix_(i, j) = mass_matrix_(j, i) = screw_[d].dot(F);
+    }
+  }
+
+  joint_accels_ = mass_matrix_.ldlt().solve(torques - bias);
+  inverseDynamics();
+  return joint_accels_;
+}
+
+/* ************************************************************************* */
+gtsam::Values PlanarForwardDynamics::solve(const int t,
+                                           const gtsam::Values &known_values) {
+  const size_t num_joints = tree_.joints.size();
+  Vector joint_angles(num_joints), joint_vels(num_joints), torques(num_joints);
+  for (size_t idx = 0; idx < num_joints; idx++) {
+    const int j = tree_.joints[idx]->id();
+    joint_angles(idx) = JointAngle(known_values, j, t);
+    joint_vels(idx) = JointVel(known_values, j, t);
+    torques(idx) = Torque(known_values, j, t);
+  }
+
+  solve(joint_angles, joint_vels, torques);
+
+  gtsam::Values values = known_values;
+  try {
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k], a = tree_.parent[b];
+      const auto &joint = tree_.joints[tree_.joint[b]];
+      const int j = joint->id(), ib = tree_.links[b]->id(),
+                ia = tree_.links[a]->id();
+      InsertJointAccel(&values, j, t, joint_accels_(tree_.joint[b]));
+      const Vector3 &on_b = wrenches_[b],
+                    on_a = -X_[b].transpose() * wrenches_[b];
+      InsertWrench(&values, ib, j, t, planar_.spatialWrench(ib, on_b));
+      InsertWrench(&values, ia, j, t, planar_.spatialWrench(ia, on_a));
+    }
+    for (size_t i = 0; i < tree_.links.size(); i++) {
+      const int id = tree_.links[i]->id();
+      InsertTwistAccel(&values, id, t, planar_.spatialTwist(id, accels_[i]));
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    ReportDiagnostic("key already exists:", e.key());
+    throw std::invalid_argument(
+        "PlanarForwardDynamics: known_values should contain no "
+        "accelerations or wrenches");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarForwardDynamics.h
+ * @brief Forward dynamics of planar tree-structured robots with SE(2)
+ * quantities.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/universal_robot/PlanarRobot.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * PlanarForwardDynamics solves the forward dynamics of a planar robot that is
+ * a kinematic tree with a fixed link, with the composite rigid body
+ * algorithm on the 3-vector twists and wrenches and 3x3 inertias of the
+ * PlanarRobot, instead of the 6-dimensional ones of
+ * ArticulatedBodyForwardDynamics.
+ */
+class PlanarForwardDynamics {
+ private:
+  PlanarRobot planar_;
+  KinematicTree tree_;
+  boost::optional<gtsam::Vector2> gravity_;
+
+  /// For every link: its rest pose in its tree parent, and its screw axis,
+  /// both in planar frames.
+  std::vector<gtsam::Pose2> rest_;
+  std::vector<gtsam::Vector3> screw_;
+  gtsam::Pose2 root_pose_;
+
+  /// Per-solve buffers and results, indexed by link.
+  std::vector<gtsam::Pose2> poses_;
+  std::vector<gtsam::Matrix3> X_, IC_;
+  std::vector<gtsam::Vector3> twists_, bias_accels_, accels_, wrenches_;
+  gtsam::Matrix mass_matrix_;
+  gtsam::Vector joint_accels_;
+
+  // Accelerations and wrenches from the tree parents, with joint_accels_.
+  void inverseDynamics();
+
+ public:
+  /**
+   * Constructor.
+   * @param robot       the robot, a kinematic tree with a fixed link, see
+   * PlanarRobot
+   * @param planar_axis normal of the plane, in world frame
+   * @param gravity     gravity in world frame
+   */
+  PlanarForwardDynamics(
+      const Robot &robot, const gtsam::Vector3 &planar_axis,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return the planar model of the robot.
+  const PlanarRobot &planarRobot() const { return planar_; }
+
+  /**
+   * Solve forward dynamics.
+   * @param joint_angles joint angles, in Robot::joints() order
+   * @param joint_vels   joint velocities, in Robot::joints() order
+   * @param torques      joint torques, in Robot::joints() order
+   * @return the joint accelerations
+   */
+  const gtsam::Vector &solve(const gtsam::Vector &joint_angles,
+                             const gtsam::Vector &joint_vels,
+                             const gtsam::Vector &torques);
+
+  /**
+   * Solve forward dynamics, Values version with the semantics of
+   * ArticulatedBodyForwardDynamics::solve, except that joint angles are read
+   * instead of link poses and twists.
+   *
+   * @param t            time step
+   * @param known_values joint angles, velocities and torques
+   * @return known_values augmented with joint accelerations, and spatial
+   * wrenches and twist accelerations
+   */
+  gtsam::Values solve(const int t, const gtsam::Values &known_values);
+
+  /// Joint accelerations of the last solve.
+  const gtsam::Vector &jointAccels() const { return joint_accels_; }
+
+  /// Mass matrix of the last solve.
+  const gtsam::Matrix &massMatrix() const { return mass_matrix_; }
+
+  /// Planar poses of the links in the last solve.
+  const std::vector<gtsam::Pose2> &poses() const { return poses_; }
+
+  /// Planar twists of the links in the last solve.
+  const std::vector<gtsam::Vector3> &twists() const { return twists_; }
+
+  /// Planar twist accelerations of the links in the last solve.
+  const std::vector<gtsam::Vector3> &twistAccels() const { return accels_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,399 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernelGenerator.cpp
+ * @brief Generate C++ RobotKernels specialized for one robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/dynamics/RobotKernelGenerator.h>
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using gtsam::Pose3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// A double literal that reads back to the same value.
+std::string Num(double x) {
+  std::ostringstream os;
+  os.precision(std::numeric_limits<double>::max_digits10);
+  os << x;
+  return os.str();
+}
+
+std::string VectorLiteral(const gtsam::Vector &v, const std::string &type) {
+  std::ostringstream os;
+  os << "(" << type << "() << ";
+  for (int i = 0; i < v.size(); i++) os << (i ? ", " : "") << Num(v(i));
+  os << ").finished()";
+  return os.str();
+}
+
+std::string Matrix6Literal(const gtsam::Matrix6 &M) {
+  std::ostringstream os;
+  os << "(Matrix6() <<";
+  for (int r = 0; r < 6; r++) {
+    os << "\n    ";
+    for (int c = 0; c < 6; c++) {
+      os << Num(M(r, c)) << (r == 5 && c == 5 ? "" : ", ");
+    }
+  }
+  os << ").finished()";
+  return os.str();
+}
+
+std::string PoseLiteral(const Pose3 &pose) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  const gtsam::Point3 &t = pose.translation();
+  std::ostringstream os;
+  os << "Pose3(Rot3(";
+  for (int i = 0; i < 9; i++) {
+    os << (i ? ", " : "") << Num(R(i / 3, i % 3));
+  }
+  os << "),\n    Point3(" << Num(t.x()) << ", " << Num(t.y()) << ", "
+     << Num(t.z()) << "))";
+  return os.str();
+}
+
+// The JointMotion specialization of a joint type, none for fixed joints.
+std::string MotionClass(Joint::Type type) {
+  switch (type) {
+    case Joint::Type::Revolute:
+      return "gtdynamics::RevoluteJoint";
+    case Joint::Type::Prismatic:
+      return "gtdynamics::PrismaticJoint";
+    case Joint::Type::Screw:
+      return "gtdynamics::HelicalJoint";
+    case Joint::Type::Fixed:
+      return "";
+  }
+  return "gtdynamics::Joint";
+}
+
+std::vector<std::string> SplitNamespace(const std::string &name) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= name.size()) {
+    const size_t end = name.find("::", start);
+    parts.push_back(name.substr(start, end - start));
+    if (end == std::string::npos) break;
+    start = end + 2;
+  }
+  return parts;
+}
+
+std::string OpenNamespace(const std::vector<std::string> &parts) {
+  std::string s;
+  for (auto &&part : parts) s += "namespace " + part + " {\n";
+  return s;
+}
+
+std::string CloseNamespace(const std::vector<std::string> &parts) {
+  std::string s;
+  for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+    s += "}  // namespace " + *it + "\n";
+  }
+  return s;
+}
+
+// Emits the kernels of one robot, see GenerateRobotKernels.
+class Emitter {
+ public:
+  Emitter(const Robot &robot, const RobotKernelOptions &options)
+      : options_(options) {
+    if (!tree_.build(robot) || !tree_.root_fixed) {
+      throw std::invalid_argument(
+          "GenerateRobotKernels: robot is not a kinematic tree with a fixed "
+          "link");
+    }
+    root_ = tree_.root;
+  }
+
+  std::string header() const {
+    const std::string &name = options_.class_name;
+    const auto ns = SplitNamespace(options_.namespace_name);
+    std::ostringstream os;
+    os << banner() << "\n#pragma once\n\n"
+       << "#include <gtdynamics/dynamics/RobotKernels.h>\n\n"
+       << OpenNamespace(ns) << "\n"
+       << "/// RobotKernels generated for " << description() << ".\n"
+       << "class " << name << " : public gtdynamics::RobotKernels {\n"
+       << " public:\n"
+       << "  " << name << "();\n\n"
+       << "  using gtdynamics::RobotKernels::forwardKinematics;\n"
+       << "  using gtdynamics::RobotKernels::inverseDynamics;\n\n"
+       << "  void forwardKinematics(const gtsam::Vector &q,\n"
+       << "                         const gtsam::Vector &qdot,\n"
+       << "                         std::vector<gtsam::Pose3> *poses,\n"
+       << "                         std::vector<gtsam::Vector6> *twists) "
+          "override;\n\n"
+       << "  gtsam::Vector inverseDynamics(const gtsam::Vector &q,\n"
+       << "                                const gtsam::Vector &qdot,\n"
+       << "                                const gtsam::Vector &qddot) "
+          "override;\n\n"
+       << "  gtsam::Matrix massMatrix(const gtsam::Vector &q) override;\n"
+       << "};\n\n"
+       << CloseNamespace(ns);
+    return os.str();
+  }
+
+  std::string source() const {
+    const auto ns = SplitNamespace(options_.namespace_name);
+    std::ostringstream os;
+    os << banner() << "\n"
+       << "#include \"" << headerName() << "\"\n\n"
+       << "#include <gtdynamics/universal_robot/JointKernels.h>\n\n"
+       << OpenNamespace(ns) << "\n"
+       << "namespace {\n"
+       << "using gtsam::Matrix6;\n"
+       << "using gtsam::Point3;\n"
+       << "using gtsam::Pose3;\n"
+       << "using gtsam::Rot3;\n"
+       << "using gtsam::Vector;\n"
+       << "using gtsam::Vector6;\n\n"
+       << "constexpr size_t kNumLinks = " << tree_.links.size()
+       << ", kNumJoints = " << tree_.joints.size() << ";\n"
+       << "const Pose3 kRootPose = "
+       << PoseLiteral(tree_.links[root_]->getFixedPose()) << ";\n";
+    if (options_.gravity) {
+      os << "const gtsam::Vector3 kGravity = "
+         << VectorLiteral(*options_.gravity, "gtsam::Vector3") << ";\n";
+    }
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      constants(tree_.order[k], os);
+    }
+    os << "}  // namespace\n\n";
+    constructor(os);
+    forwardKinematics(os);
+    inverseDynamics(os);
+    massMatrix(os);
+    os << CloseNamespace(ns);
+    return os.str();
+  }
+
+ private:
+  const RobotKernelOptions &options_;
+  KinematicTree tree_;
+  int root_ = -1;
+
+  std::string description() const {
+    return options_.description.empty() ? "one robot" : options_.description;
+  }
+
+  std::string headerName() const {
+    return options_.header_name.empty() ? options_.class_name + ".h"
+                                        : options_.header_name;
+  }
+
+  std::string banner() const {
+    return "// Generated by gtdynamics::GenerateRobotKernels for " +
+           description() + ".\n// Do not edit: regenerate instead.\n";
+  }
+
+  // Constants of the tree edge to link b, and its relative pose function.
+  void constants(int b, std::ostringstream &os) const {
+    const JointSharedPtr &joint = tree_.joints[tree_.joint[b]];
+    const LinkSharedPtr &link = tree_.links[b];
+    const std::string motion = MotionClass(joint->type());
+    const std::string i = std::to_string(b);
+    os << "\n// Link " << link->name() << ", "
+       << (tree_.forward[b] ? "child" : "parent") << " of joint "
+       << joint->name() << ".\n";
+    // Forward edges move by pMc * exp(S_c q), backward ones by the inverse.
+    const Pose3 rest = tree_.forward[b] ? joint->pMc() : joint->pMc().inverse();
+    os << "const Pose3 kRest" << i << " = " << PoseLiteral(rest) << ";\n";
+    if (!motion.empty()) {
+      os << "const Vector6 kMotion" << i << " = "
+         << VectorLiteral(joint->cScrewAxis(), "Vector6") << ";\n";
+    }
+    os << "const Vector6 kScrew" << i << " = "
+       << VectorLiteral(tree_.screw[b], "Vector6") << ";\n"
+       << "const Matrix6 kInertia" << i << " = "
+       << Matrix6Literal(link->inertiaMatrix()) << ";\n";
+    if (options_.gravity) {
+      os << "constexpr double kMass" << i << " = " << Num(link->mass())
+         << ";\n";
+    }
+    os << "inline Pose3 RelativePose" << i << "(double "
+       << (motion.empty() ? "" : "q") << ") {\n  return ";
+    if (motion.empty()) {
+      os << "kRest" << i;
+    } else if (tree_.forward[b]) {
+      os << "kRest" << i << " * gtdynamics::JointMotion<" << motion
+         << ">::Expmap(kMotion" << i << ", q)";
+    } else {
+      os << "gtdynamics::JointMotion<" << motion << ">::Expmap(kMotion" << i
+         << ", -q) * kRest" << i;
+    }
+    os << ";\n}\n";
+  }
+
+  void constructor(std::ostringstream &os) const {
+    const std::string &name = options_.class_name;
+    os << "/* " << std::string(73, '*') << " */\n"
+       << name << "::" << name << "()\n    : gtdynamics::RobotKernels({";
+    for (size_t i = 0; i < tree_.links.size(); i++) {
+      os << (i ? ", " : "") << tree_.links[i]->id();
+    }
+    os << "}, {";
+    for (size_t j = 0; j < tree_.joints.size(); j++) {
+      os << (j ? ", " : "") << tree_.joints[j]->id();
+    }
+    os << "}) {}\n\n";
+  }
+
+  void forwardKinematics(std::ostringstream &os) const {
+    const std::string &name = options_.class_name;
+    os << "/* " << std::string(73, '*') << " */\n"
+       << "void " << name << "::forwardKinematics(const Vector &q, "
+       << "const Vector &qdot,\n"
+       << "    std::vector<Pose3> *poses, std::vector<Vector6> *twists) {\n"
+       << "  checkJointVector(q, \"q\");\n"
+       << "  if (twists) checkJointVector(qdot, \"qdot\");\n"
+       << "  poses->resize(kNumLinks);\n"
+       << "  Pose3 *P = poses->data();\n"
+       << "  P[" << root_ << "] = kRootPose;\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k];
+      os << "  const Pose3 T" << b << " = RelativePose" << b << "(q("
+         << tree_.joint[b] << "));\n"
+         << "  P[" << b << "] = P[" << tree_.parent[b] << "] * T" << b
+         << ";\n";
+    }
+    os << "  if (!twists) return;\n"
+       << "  twists->resize(kNumLinks);\n"
+       << "  Vector6 *V = twists->data();\n"
+       << "  V[" << root_ << "].setZero();\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k], a = tree_.parent[b];
+      os << "  V[" << b << "] = ";
+      if (a != root_) os << "T" << b << ".inverse().Adjoint(V[" << a << "]) + ";
+      os << "kScrew" << b << " * qdot(" << tree_.joint[b] << ");\n";
+    }
+    os << "}\n\n";
+  }
+
+  void inverseDynamics(std::ostringstream &os) const {
+    const std::string &name = options_.class_name;
+    os << "/* " << std::string(73, '*') << " */\n"
+       << "Vector " << name << "::inverseDynamics(const Vector &q, "
+       << "const Vector &qdot,\n"
+       << "                                const Vector &qddot) {\n"
+       << "  checkJointVector(q, \"q\");\n"
+       << "  checkJointVector(qdot, \"qdot\");\n"
+       << "  checkJointVector(qddot, \"qddot\");\n"
+       << "  Pose3 P[kNumLinks];\n"
+       << "  Matrix6 X[kNumLinks];\n"
+       << "  Vector6 V[kNumLinks], A[kNumLinks], f[kNumLinks];\n"
+       << "  P[" << root_ << "] = kRootPose;\n\n"
+       << "  // Forward pass: poses, twists and twist accelerations.\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+      const std::string B = std::to_string(b), A = std::to_string(a),
+                        J = std::to_string(j);
+      os << "  {\n"
+         << "    const Pose3 T = RelativePose" << B << "(q(" << J << "));\n"
+         << "    P[" << B << "] = P[" << A << "] * T;\n"
+         << "    X[" << B << "] = T.inverse().AdjointMap();\n"
+         << "    V[" << B << "] = ";
+      if (a != root_) os << "X[" << B << "] * V[" << A << "] + ";
+      os << "kScrew" << B << " * qdot(" << J << ");\n"
+         << "    A[" << B << "] = ";
+      if (a != root_) os << "X[" << B << "] * A[" << A << "] + ";
+      os << "kScrew" << B << " * qddot(" << J << ") +\n"
+         << "           Pose3::adjointMap(V[" << B << "]) * kScrew" << B
+         << " * qdot(" << J << ");\n"
+         << "  }\n";
+    }
+    os << "\n  // Inertial, bias and gravity wrenches of every link.\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const std::string B = std::to_string(tree_.order[k]);
+      os << "  f[" << B << "] = kInertia" << B << " * A[" << B << "] -\n"
+         << "         Pose3::adjointMap(V[" << B << "]).transpose() * "
+         << "(kInertia" << B << " * V[" << B << "]);\n";
+      if (options_.gravity) {
+        os << "  f[" << B << "].tail<3>() -=\n"
+           << "      kMass" << B << " * (P[" << B
+           << "].rotation().transpose() * kGravity);\n";
+      }
+    }
+    os << "\n  // Backward pass: wrenches through the tree joints.\n";
+    for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+      const int b = tree_.order[k], a = tree_.parent[b];
+      if (a == root_) continue;
+      os << "  f[" << a << "] += X[" << b << "].transpose() * f[" << b
+         << "];\n";
+    }
+    os << "\n  Vector tau(kNumJoints);\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k];
+      os << "  tau(" << tree_.joint[b] << ") = kScrew" << b << ".dot(f[" << b
+         << "]);\n";
+    }
+    os << "  return tau;\n}\n\n";
+  }
+
+  void massMatrix(std::ostringstream &os) const {
+    const std::string &name = options_.class_name;
+    os << "/* " << std::string(73, '*') << " */\n"
+       << "gtsam::Matrix " << name << "::massMatrix(const Vector &q) {\n"
+       << "  checkJointVector(q, \"q\");\n"
+       << "  Matrix6 X[kNumLinks], IC[kNumLinks];\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k];
+      os << "  X[" << b << "] = RelativePose" << b << "(q(" << tree_.joint[b]
+         << ")).inverse().AdjointMap();\n"
+         << "  IC[" << b << "] = kInertia" << b << ";\n";
+    }
+    os << "\n  // Composite inertias, accumulated from the leaves.\n";
+    for (size_t k = tree_.order.size() - 1; k > 0; k--) {
+      const int b = tree_.order[k], a = tree_.parent[b];
+      if (a == root_) continue;
+      os << "  IC[" << a << "] += X[" << b << "].transpose() * IC[" << b
+         << "] * X[" << b << "];\n";
+    }
+    os << "\n  // Project the wrench of unit joint acceleration on every joint"
+       << "\n  // towards the root.\n"
+       << "  gtsam::Matrix M = gtsam::Matrix::Zero(kNumJoints, kNumJoints);\n"
+       << "  Vector6 F;\n";
+    for (size_t k = 1; k < tree_.order.size(); k++) {
+      const int b = tree_.order[k], j = tree_.joint[b];
+      os << "  F = IC[" << b << "] * kScrew" << b << ";\n"
+         << "  M(" << j << ", " << j << ") = kScrew" << b << ".dot(F);\n";
+      for (int c = b; tree_.parent[c] != root_;) {
+        os << "  F = X[" << c << "].transpose() * F;\n";
+        c = tree_.parent[c];
+        const int i = tree_.joint[c];
+        os << "  M(" << i << ", " << j << ") = M(" << j << ", " << i
+           << ") = kScrew" << c << ".dot(F);\n";
+      }
+    }
+    os << "  return M;\n}\n\n";
+  }
+};
+}  // namespace
+
+/* ************************************************************************* */
+RobotKernelSources GenerateRobotKernels(const Robot &robot,
+                                        const RobotKernelOptions &options) {
+  if (options.class_name.empty() || options.namespace_name.empty()) {
+    throw std::invalid_argument(
+        "GenerateRobotKernels: class and namespace names must not be empty");
+  }
+  const Emitter emitter(robot, options);
+  return RobotKernelSources{emitter.header(), emitter.source()};
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernelGenerator.h
+ * @brief Generate C++ RobotKernels specialized for one robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <string>
+
+namespace gtdynamics {
+
+/// Options of GenerateRobotKernels.
+struct RobotKernelOptions {
+  std::string class_name = "GeneratedRobotKernels";  ///< generated class
+  std::string namespace_name = "gtdynamics";  ///< namespace of the class
+  std::string header_name;  ///< include of the header, class_name.h if empty
+  std::string description;  ///< e.g. the model file, for the file comments
+  boost::optional<gtsam::Vector3> gravity;  ///< gravity in world frame
+};
+
+/// Header and source file of generated kernels.
+struct RobotKernelSources {
+  std::string header, source;
+};
+
+/**
+ * Generate the C++ header and source of a RobotKernels class for one robot.
+ * The tree traversals of GenericRobotKernels are unrolled into straight-line
+ * code per link, with the joint axes, rest poses, inertias and gravity as
+ * constants, and the joint motions specialized per joint type with
+ * JointMotion. The generated class has the results of GenericRobotKernels,
+ * up to rounding, but no loops, branches or pointer chasing over links and
+ * joints.
+ *
+ * Throws std::invalid_argument if the robot is not a kinematic tree with a
+ * fixed link, e.g. a floating-base robot whose base was not fixed with
+ * Robot::fixLink.
+ */
+RobotKernelSources GenerateRobotKernels(const Robot &robot,
+                                        const RobotKernelOptions &options);
+
+}  // namespace gtdynamics
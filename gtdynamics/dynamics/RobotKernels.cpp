@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernels.cpp
+ * @brief Kinematics and dynamics kernels of one fixed-base robot, generic or
+ * generated for that robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/RobotKernels.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+std::vector<uint16_t> LinkIds(const Robot &robot) {
+  std::vector<uint16_t> ids;
+  for (auto &&link : robot.links()) ids.push_back(link->id());
+  return ids;
+}
+
+std::vector<uint16_t> JointIds(const Robot &robot) {
+  std::vector<uint16_t> ids;
+  for (auto &&joint : robot.joints()) ids.push_back(joint->id());
+  return ids;
+}
+}  // namespace
+
+/* ************************************************************************* */
+void RobotKernels::checkJointVector(const Vector &v, const char *name) const {
+  if (size_t(v.size()) != joint_ids_.size()) {
+    throw std::invalid_argument("RobotKernels: " + std::string(name) +
+                                " has size " + std::to_string(v.size()) +
+                                ", the robot has " +
+                                std::to_string(joint_ids_.size()) +
+                                " joints");
+  }
+}
+
+/* ************************************************************************* */
+Values RobotKernels::forwardKinematics(const Values &known_values, size_t t) {
+  const size_t num_joints = numJoints();
+  Vector q(num_joints), qdot(num_joints);
+  for (size_t j = 0; j < num_joints; j++) {
+    q(j) = JointAngle(known_values, joint_ids_[j], t);
+    qdot(j) = JointVel(known_values, joint_ids_[j], t);
+  }
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  forwardKinematics(q, qdot, &poses, &twists);
+
+  Values values = known_values;
+  for (size_t i = 0; i < numLinks(); i++) {
+    InsertPose(&values, link_ids_[i], t, poses[i]);
+    InsertTwist(&values, link_ids_[i], t, twists[i]);
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values RobotKernels::inverseDynamics(const Values &known_values, size_t t) {
+  const size_t num_joints = numJoints();
+  Vector q(num_joints), qdot(num_joints), qddot(num_joints);
+  for (size_t j = 0; j < num_joints; j++) {
+    q(j) = JointAngle(known_values, joint_ids_[j], t);
+    qdot(j) = JointVel(known_values, joint_ids_[j], t);
+    qddot(j) = JointAccel(known_values, joint_ids_[j], t);
+  }
+  const Vector torques = inverseDynamics(q, qdot, qddot);
+
+  Values values = known_values;
+  for (size_t j = 0; j < num_joints; j++) {
+    InsertTorque(&values, joint_ids_[j], t, torques(j));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+GenericRobotKernels::GenericRobotKernels(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : RobotKernels(LinkIds(robot), JointIds(robot)),
+      rnea_(robot, gravity),
+      crba_(robot, gravity) {
+  // CompositeRigidBodyDynamics has checked that the robot is a fixed tree.
+  tree_.build(robot);
+  root_pose_ = tree_.links[tree_.root]->getFixedPose();
+}
+
+/* ************************************************************************* */
+void GenericRobotKernels::forwardKinematics(const Vector &q,
+                                            const Vector &qdot,
+                                            std::vector<Pose3> *poses,
+                                            std::vector<Vector6> *twists) {
+  checkJointVector(q, "q");
+  if (twists) checkJointVector(qdot, "qdot");
+  poses->resize(numLinks());
+  if (twists) twists->assign(numLinks(), gtsam::Z_6x1);
+  (*poses)[tree_.root] = root_pose_;
+  for (size_t k = 1; k < tree_.order.size(); k++) {
+    const int b = tree_.order[k], a = tree_.parent[b], j = tree_.joint[b];
+    const auto &joint = tree_.joints[j];
+    const Pose3 aTb = tree_.forward[b] ? joint->parentTchild(q(j))
+                                       : joint->childTparent(q(j));
+    (*poses)[b] = (*poses)[a] * aTb;
+    if (twists) {
+      (*twists)[b] = aTb.inverse().Adjoint((*twists)[a]) +
+                     tree_.screw[b] * qdot(j);
+    }
+  }
+}
+
+/* ************************************************************************* */
+Vector GenericRobotKernels::inverseDynamics(const Vector &q,
+                                            const Vector &qdot,
+                                            const Vector &qddot) {
+  checkJointVector(qddot, "qddot");
+  forwardKinematics(q, qdot, &poses_, &twists_);
+  rnea_.solve(poses_, twists_, qdot, qddot);
+  return rnea_.torques();
+}
+
+/* ************************************************************************* */
+gtsam::Matrix GenericRobotKernels::massMatrix(const Vector &q) {
+  checkJointVector(q, "q");
+  return crba_.solveMassMatrix(q);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernels.h
+ * @brief Kinematics and dynamics kernels of one fixed-base robot, generic or
+ * generated for that robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/dynamics/KinematicTree.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RobotKernels computes forward kinematics, inverse dynamics with the
+ * recursive Newton-Euler algorithm, and the mass matrix of a robot that is a
+ * kinematic tree with a fixed root link, in the twist/wrench conventions of
+ * the dynamics factors. Links and joints are indexed in Robot::links() and
+ * Robot::joints() order.
+ *
+ * GenericRobotKernels implements it for any such robot by traversing its
+ * links and joints. GenerateRobotKernels, see RobotKernelGenerator.h, emits a
+ * class implementing it for one robot, with the tree traversal unrolled and
+ * all joint axes, rest poses and inertias compiled in as constants; the
+ * gtdynamics_add_robot_kernels CMake function builds one from a URDF or SDF
+ * file. Both have the same results, so existing callers can switch between
+ * them through this interface.
+ *
+ * Kernels keep per-call buffers: use one object per thread.
+ */
+class RobotKernels {
+ protected:
+  std::vector<uint16_t> link_ids_, joint_ids_;
+
+  RobotKernels(const std::vector<uint16_t> &link_ids,
+               const std::vector<uint16_t> &joint_ids)
+      : link_ids_(link_ids), joint_ids_(joint_ids) {}
+
+  /// Throw if a vector of joint quantities has the wrong size.
+  void checkJointVector(const gtsam::Vector &v, const char *name) const;
+
+ public:
+  virtual ~RobotKernels() {}
+
+  /// Number of links.
+  size_t numLinks() const { return link_ids_.size(); }
+
+  /// Number of joints.
+  size_t numJoints() const { return joint_ids_.size(); }
+
+  /// Ids of the links, in link order.
+  const std::vector<uint16_t> &linkIds() const { return link_ids_; }
+
+  /// Ids of the joints, in joint order.
+  const std::vector<uint16_t> &jointIds() const { return joint_ids_; }
+
+  /**
+   * CoM poses, and optionally twists, of all links, with the root link at
+   * its fixed pose.
+   * @param q      joint angles
+   * @param qdot   joint velocities, only used for the twists
+   * @param poses  link poses, resized to the number of links
+   * @param twists link twists, resized to the number of links, or null
+   */
+  virtual void forwardKinematics(const gtsam::Vector &q,
+                                 const gtsam::Vector &qdot,
+                                 std::vector<gtsam::Pose3> *poses,
+                                 std::vector<gtsam::Vector6> *twists) = 0;
+
+  /// Joint torques tau = M(q) * qddot + C(q, qdot) * qdot + g(q).
+  virtual gtsam::Vector inverseDynamics(const gtsam::Vector &q,
+                                        const gtsam::Vector &qdot,
+                                        const gtsam::Vector &qddot) = 0;
+
+  /// Joint-space mass matrix M(q).
+  virtual gtsam::Matrix massMatrix(const gtsam::Vector &q) = 0;
+
+  /**
+   * Forward kinematics, Values version with the semantics of
+   * Robot::forwardKinematics for a robot with a fixed link.
+   * @param known_values joint angles and velocities of time step t
+   * @param t            time step
+   * @return known_values with the poses and twists of all links
+   */
+  gtsam::Values forwardKinematics(const gtsam::Values &known_values,
+                                  size_t t = 0);
+
+  /**
+   * Inverse dynamics, Values version.
+   * @param known_values joint angles, velocities and accelerations of step t
+   * @param t            time step
+   * @return known_values with the torques of all joints
+   */
+  gtsam::Values inverseDynamics(const gtsam::Values &known_values,
+                                size_t t = 0);
+};
+
+/**
+ * RobotKernels of any kinematic tree with a fixed link, with the generic
+ * traversals of KinematicTree, NewtonEulerInverseDynamics and
+ * CompositeRigidBodyDynamics. Also the reference for generated kernels.
+ */
+class GenericRobotKernels : public RobotKernels {
+ private:
+  KinematicTree tree_;
+  gtsam::Pose3 root_pose_;
+  NewtonEulerInverseDynamics rnea_;
+  CompositeRigidBodyDynamics crba_;
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot   the robot, must be a kinematic tree with a fixed link
+   * @param gravity gravity in world frame
+   */
+  explicit GenericRobotKernels(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  using RobotKernels::forwardKinematics;
+  using RobotKernels::inverseDynamics;
+
+  void forwardKinematics(const gtsam::Vector &q, const gtsam::Vector &qdot,
+                         std::vector<gtsam::Pose3> *poses,
+                         std::vector<gtsam::Vector6> *twists) override;
+
+  gtsam::Vector inverseDynamics(const gtsam::Vector &q,
+                                const gtsam::Vector &qdot,
+                                const gtsam::Vector &qddot) override;
+
+  gtsam::Matrix massMatrix(const gtsam::Vector &q) override;
+};
+
+}  // namespace gtdynamics
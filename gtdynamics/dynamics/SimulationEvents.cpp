@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulationEvents.cpp
+ * @brief Event functions and zero-crossing localization for simulation.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/SimulationEvents.h>
+#include <gtdynamics/utils/values.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+bool SimulationEvent::triggered(double before, double after) const {
+  switch (direction) {
+    case EventDirection::Rising:
+      return before < 0 && after >= 0;
+    case EventDirection::Falling:
+      return before > 0 && after <= 0;
+    default:
+      return (before < 0 && after >= 0) || (before > 0 && after <= 0);
+  }
+}
+
+/* ************************************************************************* */
+SimulationEvent ContactHeightEvent(const PointOnLink &contact_point,
+                                   const gtsam::Vector3 &gravity,
+                                   double ground_plane_height,
+                                   EventDirection direction) {
+  // Same height as ContactHeightConstraint.
+  const gtsam::Vector3 up = gravity.normalized().cwiseAbs();
+  const int i = contact_point.link->id();
+  const gtsam::Point3 comPc = contact_point.point;
+  SimulationEvent event;
+  event.name = contact_point.link->name() + " contact height";
+  event.function = [=](const gtsam::Values &values) {
+    return up.dot(Pose(values, i).transformFrom(comPc)) - ground_plane_height;
+  };
+  event.direction = direction;
+  return event;
+}
+
+/* ************************************************************************* */
+SimulationEvent ThresholdEvent(const std::string &name, gtsam::Key key,
+                               double threshold, EventDirection direction) {
+  SimulationEvent event;
+  event.name = name;
+  event.function = [=](const gtsam::Values &values) {
+    return values.at<double>(key) - threshold;
+  };
+  event.direction = direction;
+  return event;
+}
+
+/* ************************************************************************* */
+double LocalizeZeroCrossing(const std::function<double(double)> &f, double t0,
+                            double f0, double t1, double f1, double tolerance,
+                            size_t max_iterations) {
+  if (f0 * f1 > 0) {
+    throw std::invalid_argument(
+        "LocalizeZeroCrossing: the interval does not bracket a crossing");
+  }
+  // Keep f0 != 0, so that the crossing stays in (t0, t1].
+  if (f0 == 0) return t0;
+  int side = 0;
+  for (size_t k = 0; k < max_iterations && std::abs(t1 - t0) > tolerance;
+       k++) {
+    double t = (f0 * t1 - f1 * t0) / (f0 - f1);
+    // Regula falsi can stall near one end, so stay strictly inside.
+    const double margin = 0.5 * tolerance;
+    if (!(std::abs(t - t0) > margin)) t = t0 + (t1 > t0 ? margin : -margin);
+    if (!(std::abs(t1 - t) > margin)) t = t1 - (t1 > t0 ? margin : -margin);
+    const double ft = f(t);
+    if (ft * f0 > 0) {
+      t0 = t, f0 = ft;
+      if (side == -1) f1 *= 0.5;  // Illinois: halve the retained end
+      side = -1;
+    } else {
+      t1 = t, f1 = ft;
+      if (side == 1) f0 *= 0.5;
+      side = 1;
+    }
+  }
+  return t1;
+}
+
+}  // namespace gtdynamics
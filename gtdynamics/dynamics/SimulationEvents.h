@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulationEvents.h
+ * @brief Event functions and zero-crossing localization for simulation.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <string>
+
+namespace gtdynamics {
+
+/// Sign changes of an event function that trigger the event.
+enum class EventDirection {
+  Both,     // any sign change
+  Rising,   // from negative to non-negative, e.g. lift-off
+  Falling,  // from positive to non-positive, e.g. touchdown
+};
+
+/**
+ * A SimulationEvent happens when its function of the state crosses zero, e.g.
+ * at touchdown or lift-off, or when a pressure reaches a threshold. The
+ * function is evaluated on Values at time 0 with the joint angles and
+ * velocities and the link poses and twists of a state.
+ */
+struct SimulationEvent {
+  std::string name;
+  std::function<double(const gtsam::Values &)> function;
+  EventDirection direction = EventDirection::Both;
+
+  /// Whether the values before and after a step trigger the event.
+  bool triggered(double before, double after) const;
+};
+
+/**
+ * Event of a contact point reaching the ground, with the height of
+ * ContactHeightFactor as event function.
+ * @param contact_point       the contact point
+ * @param gravity             gravity vector, defines the up direction
+ * @param ground_plane_height height of the ground
+ * @param direction           Falling for touchdown, Rising for lift-off
+ */
+SimulationEvent ContactHeightEvent(
+    const PointOnLink &contact_point, const gtsam::Vector3 &gravity,
+    double ground_plane_height = 0.0,
+    EventDirection direction = EventDirection::Falling);
+
+/**
+ * Event of a scalar variable, e.g. a pressure or a ground reaction force,
+ * crossing a threshold, with function values.at<double>(key) - threshold.
+ */
+SimulationEvent ThresholdEvent(const std::string &name, gtsam::Key key,
+                               double threshold,
+                               EventDirection direction = EventDirection::Both);
+
+/**
+ * Localize a zero crossing of f in [t0, t1] with the Illinois variant of
+ * regula falsi, which converges superlinearly like the secant method but
+ * keeps a bracket like bisection.
+ *
+ * @param f              function, with f(t0) = f0 and f(t1) = f1 of opposite
+ * signs or zero
+ * @param tolerance      width of the final bracket
+ * @param max_iterations largest number of evaluations of f
+ * @return the end of the final bracket on the side of t1, i.e. just past the
+ * crossing
+ */
+double LocalizeZeroCrossing(const std::function<double(double)> &f, double t0,
+                            double f0, double t1, double f1,
+                            double tolerance = 1e-9,
+                            size_t max_iterations = 50);
+
+}  // namespace gtdynamics
@@ -13,16 +13,57 @@
 
 #pragma once
 
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/CompiledForwardDynamics.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/JointEffortModel.h>
+#include <gtdynamics/dynamics/PlanarForwardDynamics.h>
+#include <gtdynamics/dynamics/SimulationEvents.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <boost/make_shared.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace gtdynamics {
+
+/// Solvers that can compute the forward dynamics in a Simulator step.
+enum class ForwardDynamicsBackend {
+  Auto,             // ArticulatedBody for kinematic trees, else FactorGraph
+  FactorGraph,      // DynamicsGraph::linearSolveFD
+  Compiled,         // CompiledForwardDynamics
+  ArticulatedBody,  // ArticulatedBodyForwardDynamics, trees only
+  Planar,           // PlanarForwardDynamics, planar trees, needs planar_axis
+};
+
+/// Result of Simulator::stepToEvent.
+struct EventStep {
+  double dt;       // duration of the step actually taken
+  int event;  // index of the event that ended the step, -1 if none
+};
+
+/**
+ * Compact state of a Simulator between steps, see Simulator::snapshot: the
+ * step index, and the joint angles and velocities in the order of
+ * Robot::joints(). Saving and restoring it takes O(number of joints) time
+ * and no Values, so tree-search planners can branch a rollout cheaply.
+ */
+struct SimulatorState {
+  int t = 0;
+  gtsam::Vector q, v;
+};
+
 /**
  * Simulator is a class which simulate robot arm motion using forward
  * dynamics.
@@ -37,6 +78,128 @@ private:
   boost::optional<gtsam::Vector3> planar_axis_;
   gtsam::Values current_values_;
   gtsam::Values new_kinematics_;
+  ForwardDynamicsBackend backend_;
+  boost::shared_ptr<CompiledForwardDynamics> compiled_fd_;
+  boost::shared_ptr<ArticulatedBodyForwardDynamics> aba_fd_;
+  boost::shared_ptr<PlanarForwardDynamics> planar_fd_;
+  IntegrationScheme integrator_;
+  gtsam::Values torques_;
+
+  /// Passive torques and hard limits from the JointParams, if enabled.
+  boost::optional<JointEffortModel> effort_;
+
+  /// Events that end a step in stepToEvent.
+  std::vector<SimulationEvent> events_;
+
+  /// Whether new_kinematics_ holds exactly the joint angles and velocities.
+  bool kinematics_allocated_;
+
+  /// Steps recorded since startRecording, and whether still recording.
+  boost::optional<TrajectoryBuffer> recording_;
+  size_t num_recorded_ = 0;
+  bool recording_active_ = false, record_links_ = false;
+
+  /// Log file that every step is appended to, if any.
+  std::shared_ptr<TrajectoryLogWriter> log_;
+
+  /// Forward dynamics from joint angles and velocities, and torques.
+  gtsam::Values solve(const gtsam::Values &kinematics,
+                      const gtsam::Values &torques) {
+    // Do FK to add poses
+    auto values = robot_.forwardKinematics(kinematics);
+
+    // Add torques, with passive torques and torque limits if enabled
+    const auto &joints = robot_.joints();
+    for (size_t i = 0; i < joints.size(); i++) {
+      auto j = joints[i]->id();
+      double torque = Torque(torques, j);
+      if (effort_) {
+        torque = effort_->torque(i, JointAngle(values, j),
+                                 JointVel(values, j), torque);
+      }
+      InsertTorque(&values, j, torque);
+    }
+
+    // Now compute accelerations with forward dynamics
+    if (compiled_fd_) {
+      return compiled_fd_->solve(0, values);
+    } else if (aba_fd_) {
+      return aba_fd_->solve(0, values);
+    } else if (planar_fd_) {
+      return planar_fd_->solve(0, values);
+    } else {
+      return graph_builder_.linearSolveFD(robot_, 0, values);
+    }
+  }
+
+  /// Accelerations at intermediate states of the integrator, 1 x numJoints.
+  gtsam::Matrix accelerations(const gtsam::Matrix &q, const gtsam::Matrix &v) {
+    const auto &joints = robot_.joints();
+    gtsam::Values kinematics;
+    for (size_t i = 0; i < joints.size(); i++) {
+      InsertJointAngle(&kinematics, joints[i]->id(), q(0, i));
+      InsertJointVel(&kinematics, joints[i]->id(), v(0, i));
+    }
+    const gtsam::Values values = solve(kinematics, torques_);
+    gtsam::Matrix a(1, joints.size());
+    for (size_t i = 0; i < joints.size(); i++) {
+      a(0, i) = JointAccel(values, joints[i]->id());
+    }
+    return a;
+  }
+
+  /// Copy of the model of other, at the given state, see fork.
+  Simulator(const Simulator &other, const SimulatorState &state)
+      : robot_(other.robot_), t_(state.t),
+        graph_builder_(other.graph_builder_),
+        initial_values_(other.initial_values_), gravity_(other.gravity_),
+        planar_axis_(other.planar_axis_), backend_(other.backend_),
+        integrator_(other.integrator_), effort_(other.effort_),
+        events_(other.events_), kinematics_allocated_(false) {
+    // The solvers keep per-solve buffers, so every fork gets its own.
+    if (other.compiled_fd_) {
+      compiled_fd_ = boost::make_shared<CompiledForwardDynamics>(
+          robot_, gravity_, planar_axis_);
+    } else if (other.aba_fd_) {
+      aba_fd_ =
+          boost::make_shared<ArticulatedBodyForwardDynamics>(*other.aba_fd_);
+    } else if (other.planar_fd_) {
+      planar_fd_ = boost::make_shared<PlanarForwardDynamics>(*other.planar_fd_);
+    }
+    restore(state);
+  }
+
+  /// Values of all event functions at the state in new_kinematics_.
+  std::vector<double> eventValues() const {
+    const gtsam::Values values = robot_.forwardKinematics(new_kinematics_);
+    std::vector<double> g;
+    for (auto &&event : events_) g.push_back(event.function(values));
+    return g;
+  }
+
+  /// Append the state of the current step to the recording.
+  void recordStep() {
+    if (log_) log_->append(current_values_);
+    if (!recording_active_) return;
+    if (num_recorded_ == recording_->numSteps()) {
+      recording_->resize(std::max<size_t>(1, 2 * num_recorded_));
+    }
+    const size_t k = num_recorded_++;
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      recording_->jointAngle(j, k) = JointAngle(current_values_, j);
+      recording_->jointVel(j, k) = JointVel(current_values_, j);
+      recording_->jointAccel(j, k) = JointAccel(current_values_, j);
+      recording_->torque(j, k) = Torque(current_values_, j);
+    }
+    if (record_links_) {
+      for (auto &&link : robot_.links()) {
+        auto i = link->id();
+        recording_->pose(i, k) = Pose(current_values_, i);
+        recording_->twist(i, k) = Twist(current_values_, i);
+      }
+    }
+  }
 
 public:
   /**
@@ -47,13 +210,38 @@ public:
    * @param initial_values initial joint angles and velocities
    * @param gravity        gravity vector
    * @param planar_axis    planar axis vector
+   * @param backend        solver used for forward dynamics
+   * @param integrator     integration scheme
    */
   Simulator(const Robot &robot, const gtsam::Values &initial_values,
             const boost::optional<gtsam::Vector3> &gravity = boost::none,
-            const boost::optional<gtsam::Vector3> &planar_axis = boost::none)
+            const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+            ForwardDynamicsBackend backend = ForwardDynamicsBackend::Auto,
+            IntegrationScheme integrator = IntegrationScheme::ExplicitTaylor)
       : robot_(robot), t_(0),
         graph_builder_(DynamicsGraph(gravity, planar_axis)),
-        initial_values_(initial_values) {
+        initial_values_(initial_values), gravity_(gravity),
+        planar_axis_(planar_axis), backend_(backend),
+        integrator_(integrator) {
+    if (backend_ == ForwardDynamicsBackend::Auto) {
+      backend_ = ArticulatedBodyForwardDynamics::IsTree(robot_)
+                     ? ForwardDynamicsBackend::ArticulatedBody
+                     : ForwardDynamicsBackend::FactorGraph;
+    }
+    if (backend_ == ForwardDynamicsBackend::Compiled) {
+      compiled_fd_ = boost::make_shared<CompiledForwardDynamics>(
+          robot_, gravity, planar_axis);
+    } else if (backend_ == ForwardDynamicsBackend::ArticulatedBody) {
+      aba_fd_ =
+          boost::make_shared<ArticulatedBodyForwardDynamics>(robot_, gravity);
+    } else if (backend_ == ForwardDynamicsBackend::Planar) {
+      if (!planar_axis) {
+        throw std::invalid_argument(
+            "Simulator: the Planar backend needs a planar axis");
+      }
+      planar_fd_ = boost::make_shared<PlanarForwardDynamics>(
+          robot_, *planar_axis, gravity);
+    }
     reset();
   }
   ~Simulator() {}
@@ -62,6 +250,7 @@ public:
   void reset(const double t = 0) {
     t_ = t;
     new_kinematics_ = initial_values_;
+    kinematics_allocated_ = false;
   }
 
   /**
@@ -69,39 +258,68 @@ public:
    * @param torques torques for the time step
    */
   void forwardDynamics(const gtsam::Values &torques) {
-    // Do FK to add poses
-    auto values = robot_.forwardKinematics(new_kinematics_);
+    torques_ = torques;
+    current_values_ = solve(new_kinematics_, torques);
+  }
 
-    // Add torques
-    for (auto &&joint : robot_.joints()) {
-      auto j = joint->id();
-      InsertTorque(&values, j, Torque(torques, j));
-    }
+  /// Return the forward dynamics solver actually used (never Auto).
+  ForwardDynamicsBackend backend() const { return backend_; }
 
-    // Now compute accelerations with forward dynamics
-    current_values_ = graph_builder_.linearSolveFD(robot_, 0, values);
+  /// Return the integration scheme.
+  IntegrationScheme integrator() const { return integrator_; }
+
+  /**
+   * Apply the JointParams of the robot in every subsequent step, see
+   * JointEffortModel. The torques in getValues() are then the net torques
+   * applied to the joints.
+   * @param passive whether to add damping and spring torques
+   * @param limits  whether to enforce torque, angle and velocity limits
+   */
+  void setJointEfforts(bool passive = true, bool limits = true) {
+    if (passive || limits) {
+      effort_ = JointEffortModel(robot_, passive, limits);
+    } else {
+      effort_ = boost::none;
+    }
   }
 
   /**
-   * Integrate to calculate new q, v for one time step, update q_, v_
-   * @param torques torques for the time step
+   * Integrate to calculate new q, v for one time step, with the torques of
+   * the last forwardDynamics call.
    * @param dt duration for the time step
    */
   void integration(const double dt) {
-    new_kinematics_ = gtsam::Values();
-    const double dt2 = std::pow(dt, 2);
-    for (auto &&joint : robot_.joints()) {
-      auto j = joint->id();
-      const double q = JointAngle(current_values_, j);
-      const double v = JointVel(current_values_, j);
-      const double a = JointAccel(current_values_, j);
+    const auto &joints = robot_.joints();
+    const size_t n = joints.size();
+    gtsam::Matrix q(1, n), v(1, n), a(1, n);
+    for (size_t i = 0; i < n; i++) {
+      auto j = joints[i]->id();
+      q(0, i) = JointAngle(current_values_, j);
+      v(0, i) = JointVel(current_values_, j);
+      a(0, i) = JointAccel(current_values_, j);
+    }
+    Integrate(
+        integrator_,
+        [this](const gtsam::Matrix &q, const gtsam::Matrix &v) {
+          return accelerations(q, v);
+        },
+        dt, a, &q, &v);
+    if (effort_) effort_->enforceLimits(&q, &v);
 
-      // TODO(frank): one could use t values and save entire simulation.
-      const double v_new = v + dt * a;
-      InsertJointVel(&new_kinematics_, j, v_new);
-      // TODO(frank): consider using v_new for symplectic integration.
-      InsertJointAngle(&new_kinematics_, j, q + dt * v + 0.5 * a * dt2);
+    // After the first step the keys are fixed, so update in place.
+    if (!kinematics_allocated_) new_kinematics_ = gtsam::Values();
+    for (size_t i = 0; i < n; i++) {
+      auto j = joints[i]->id();
+      const double q_new = q(0, i), v_new = v(0, i);
+      if (kinematics_allocated_) {
+        new_kinematics_.update<double>(JointVelKey(j), v_new);
+        new_kinematics_.update<double>(JointAngleKey(j), q_new);
+      } else {
+        InsertJointVel(&new_kinematics_, j, v_new);
+        InsertJointAngle(&new_kinematics_, j, q_new);
+      }
     }
+    kinematics_allocated_ = true;
   }
 
   /**
@@ -110,9 +328,71 @@ public:
    * @param dt duration for the time step
    */
   void step(const gtsam::Values &torques, const double dt) {
+    GTDYNAMICS_TRACE_SCOPE_ARG("Simulator::step", t_);
+    forwardDynamics(torques);
+    recordStep();
+    integration(dt);
+    t_++;
+  }
+
+  /// Add an event, evaluated at the start and end of every stepToEvent.
+  void addEvent(const SimulationEvent &event) { events_.push_back(event); }
+
+  /// Remove all events.
+  void clearEvents() { events_.clear(); }
+
+  /// Events, indexed as in EventStep.
+  const std::vector<SimulationEvent> &events() const { return events_; }
+
+  /**
+   * Simulate for one time step as in step, but end the step early at the
+   * first event that triggers within it, e.g. a touchdown. The time of each
+   * triggered event is localized with LocalizeZeroCrossing, integrating from
+   * the start of the step with shorter durations, so large steps are only
+   * shortened near events.
+   *
+   * @param torques   torques for the time step
+   * @param dt        largest duration for the time step
+   * @param tolerance accuracy of the event times
+   * @return the duration of the step and the event that ended it
+   */
+  EventStep stepToEvent(const gtsam::Values &torques, const double dt,
+                        const double tolerance = 1e-9) {
     forwardDynamics(torques);
+    recordStep();
+    if (events_.empty()) {
+      integration(dt);
+      t_++;
+      return {dt, -1};
+    }
+
+    const gtsam::Values start = new_kinematics_;
+    const bool start_allocated = kinematics_allocated_;
+    const std::vector<double> g0 = eventValues();
     integration(dt);
+    const std::vector<double> g1 = eventValues();
+
+    EventStep result{dt, -1};
+    for (size_t e = 0; e < events_.size(); e++) {
+      if (!events_[e].triggered(g0[e], g1[e])) continue;
+      auto g = [&](double h) {
+        new_kinematics_ = start;
+        kinematics_allocated_ = start_allocated;
+        integration(h);
+        return events_[e].function(robot_.forwardKinematics(new_kinematics_));
+      };
+      const double h = LocalizeZeroCrossing(g, 0, g0[e], dt, g1[e], tolerance);
+      if (result.event < 0 || h < result.dt) result = {h, int(e)};
+    }
+
+    // Integrate once more, for exactly the duration taken.
+    if (result.event >= 0) {
+      new_kinematics_ = start;
+      kinematics_allocated_ = start_allocated;
+      integration(result.dt);
+    }
     t_++;
+    return result;
   }
 
   /// Simulation for the specified sequence of torques.
@@ -126,6 +406,141 @@ public:
 
   /// Return all values during simulation.
   const gtsam::Values &getValues() const { return current_values_; }
+
+  /**
+   * Save the state before the next step into state, reusing its storage.
+   * Joint angles and velocities missing from the initial values are 0.
+   */
+  void snapshot(SimulatorState *state) const {
+    const auto &joints = robot_.joints();
+    state->t = t_;
+    state->q.resize(joints.size());
+    state->v.resize(joints.size());
+    for (size_t i = 0; i < joints.size(); i++) {
+      const auto j = joints[i]->id();
+      state->q(i) = new_kinematics_.exists(JointAngleKey(j))
+                        ? JointAngle(new_kinematics_, j)
+                        : 0.0;
+      state->v(i) = new_kinematics_.exists(JointVelKey(j))
+                        ? JointVel(new_kinematics_, j)
+                        : 0.0;
+    }
+  }
+
+  /// Return the state before the next step.
+  SimulatorState snapshot() const {
+    SimulatorState state;
+    snapshot(&state);
+    return state;
+  }
+
+  /**
+   * Continue the simulation from a saved state, e.g. to branch a rollout.
+   * Recordings and logs are not rewound, and getValues() is only updated by
+   * the next step.
+   */
+  void restore(const SimulatorState &state) {
+    const auto &joints = robot_.joints();
+    const size_t n = joints.size();
+    if (size_t(state.q.size()) != n || size_t(state.v.size()) != n) {
+      throw std::invalid_argument(
+          "Simulator: the state does not have one value per joint");
+    }
+    t_ = state.t;
+    if (!kinematics_allocated_) new_kinematics_ = gtsam::Values();
+    for (size_t i = 0; i < n; i++) {
+      auto j = joints[i]->id();
+      if (kinematics_allocated_) {
+        new_kinematics_.update<double>(JointVelKey(j), state.v(i));
+        new_kinematics_.update<double>(JointAngleKey(j), state.q(i));
+      } else {
+        InsertJointVel(&new_kinematics_, j, state.v(i));
+        InsertJointAngle(&new_kinematics_, j, state.q(i));
+      }
+    }
+    kinematics_allocated_ = true;
+  }
+
+  /**
+   * Return a simulator with the same robot, which shares its links and
+   * joints, and the same backend, integrator, joint efforts and events,
+   * starting from the given state. The fork does not record or log, and may
+   * be stepped on another thread than this simulator.
+   */
+  Simulator fork(const SimulatorState &state) const {
+    return Simulator(*this, state);
+  }
+
+  /// Return a simulator forked at the state before the next step.
+  Simulator fork() const { return fork(snapshot()); }
+
+  /**
+   * Record every subsequent step, replacing any previous recording.
+   *
+   * Step k of the recording holds the joint angles and velocities before
+   * integration, the torques and the accelerations, as in getValues() after
+   * that step, and optionally the link poses and twists.
+   *
+   * @param num_steps    number of steps to preallocate, the buffer doubles
+   * when they are used up
+   * @param record_links whether to record link poses and twists
+   */
+  void startRecording(size_t num_steps = 0, bool record_links = false) {
+    recording_ = TrajectoryBuffer(robot_, num_steps);
+    num_recorded_ = 0;
+    recording_active_ = true;
+    record_links_ = record_links;
+  }
+
+  /// Stop recording, keeping the recorded steps.
+  void stopRecording() {
+    if (recording_) recording_->resize(num_recorded_);
+    recording_active_ = false;
+  }
+
+  /// Number of steps recorded since the last startRecording.
+  size_t numRecordedSteps() const { return num_recorded_; }
+
+  /// Recorded steps, indexed from 0 at the start of the recording.
+  TrajectoryBuffer recording() const {
+    TrajectoryBuffer buffer =
+        recording_ ? *recording_ : TrajectoryBuffer(robot_, 0);
+    buffer.resize(num_recorded_);
+    return buffer;
+  }
+
+  /**
+   * Append every subsequent step to a trajectory log, with the variables of
+   * getValues() after that step, replacing any previous log. Unlike
+   * startRecording, memory use does not grow with the number of steps.
+   *
+   * @param file_path   path of the log file
+   * @param chunk_steps number of steps buffered before they are written
+   * @param append      whether to append to an existing log at file_path
+   */
+  void startLogging(const std::string &file_path, size_t chunk_steps = 64,
+                    bool append = false) {
+    stopLogging();
+    log_ = std::make_shared<TrajectoryLogWriter>(file_path, chunk_steps,
+                                                 append);
+  }
+
+  /// Write the remaining logged steps and close the log file.
+  void stopLogging() {
+    if (log_) log_->close();
+    log_.reset();
+  }
+
+  /// Recorded steps as Values, with time indices from 0.
+  gtsam::Values recordedValues() const {
+    unsigned quantities =
+        TrajectoryBuffer::kJointAngles | TrajectoryBuffer::kJointVels |
+        TrajectoryBuffer::kJointAccels | TrajectoryBuffer::kTorques;
+    if (record_links_) {
+      quantities |= TrajectoryBuffer::kPoses | TrajectoryBuffer::kTwists;
+    }
+    return recording().values(quantities);
+  }
 };
 
 } // namespace gtdynamics
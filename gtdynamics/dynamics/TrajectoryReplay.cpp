@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryReplay.cpp
+ * @brief Validation of optimized trajectories by replaying them with PD
+ * tracking in the contact simulator.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/TrajectoryReplay.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+TrackingMetrics ReplayTrajectory(ContactSimulator *simulator,
+                                 const TrajectoryBuffer &trajectory, double dt,
+                                 const ReplayParameters &parameters) {
+  const size_t num_steps = trajectory.numSteps();
+  const size_t num_joints = simulator->robot().numJoints();
+  if (size_t(trajectory.jointAngles().cols()) != num_joints) {
+    throw std::invalid_argument(
+        "ReplayTrajectory: trajectory of another robot");
+  }
+  if (parameters.substeps == 0) {
+    throw std::invalid_argument("ReplayTrajectory: substeps must be positive");
+  }
+
+  const uint16_t root = simulator->rootLink()->id();
+  const unsigned quantities = trajectory.quantities();
+  const bool has_poses = quantities & TrajectoryBuffer::kPoses;
+  if (parameters.start_from_plan && num_steps > 0) {
+    const bool has_twists = quantities & TrajectoryBuffer::kTwists;
+    simulator->setState(
+        has_poses ? trajectory.pose(root, 0) : simulator->basePose(),
+        has_twists ? trajectory.twist(root, 0) : simulator->baseTwist(),
+        trajectory.jointAngles().row(0).transpose(),
+        trajectory.jointVels().row(0).transpose());
+  }
+
+  TrackingMetrics metrics;
+  metrics.joint_angle_errors = Matrix::Zero(num_steps, num_joints);
+  metrics.joint_vel_errors = Matrix::Zero(num_steps, num_joints);
+  metrics.base_position_errors = Matrix::Zero(num_steps, 3);
+  metrics.torques = Matrix::Zero(num_steps, num_joints);
+
+  const double sub_dt = dt / parameters.substeps;
+  Vector torques(num_joints);
+  for (size_t t = 0; t < num_steps; t++) {
+    const Vector q_error = simulator->jointAngles() -
+                           trajectory.jointAngles().row(t).transpose();
+    const Vector v_error =
+        simulator->jointVels() - trajectory.jointVels().row(t).transpose();
+    metrics.joint_angle_errors.row(t) = q_error.transpose();
+    metrics.joint_vel_errors.row(t) = v_error.transpose();
+    if (has_poses) {
+      metrics.base_position_errors.row(t) =
+          (simulator->basePose().translation() -
+           trajectory.pose(root, t).translation())
+              .transpose();
+    }
+
+    torques = -parameters.kp * q_error - parameters.kd * v_error;
+    if (parameters.feedforward) {
+      torques += trajectory.torques().row(t).transpose();
+    }
+    metrics.torques.row(t) = torques.transpose();
+    for (size_t s = 0; s < parameters.substeps; s++) {
+      simulator->step(torques, sub_dt);
+    }
+  }
+
+  if (num_steps > 0) {
+    metrics.rms_joint_angle_errors =
+        (metrics.joint_angle_errors.colwise().squaredNorm() / num_steps)
+            .cwiseSqrt()
+            .transpose();
+    metrics.max_joint_angle_error =
+        num_joints ? metrics.joint_angle_errors.cwiseAbs().maxCoeff() : 0.0;
+    metrics.rms_base_position_error =
+        std::sqrt(metrics.base_position_errors.squaredNorm() / num_steps);
+  } else {
+    metrics.rms_joint_angle_errors = Vector::Zero(num_joints);
+  }
+  return metrics;
+}
+
+/* ************************************************************************* */
+std::vector<TrackingMetrics> ReplayTrajectories(
+    const ContactSimulator &simulator,
+    const std::vector<TrajectoryBuffer> &trajectories, double dt,
+    const ReplayParameters &parameters, size_t num_threads) {
+  std::vector<TrackingMetrics> metrics(trajectories.size());
+  ParallelFor(trajectories.size(), num_threads, [&](size_t i) {
+    ContactSimulator copy = simulator;
+    metrics[i] = ReplayTrajectory(&copy, trajectories[i], dt, parameters);
+  });
+  return metrics;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryReplay.h
+ * @brief Validation of optimized trajectories by replaying them with PD
+ * tracking in the contact simulator.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ReplayTrajectory.
+struct ReplayParameters {
+  double kp = 100.0;         // proportional gain, per radian or meter
+  double kd = 10.0;          // derivative gain
+  bool feedforward = true;   // add the planned torques to the PD torques
+  size_t substeps = 1;       // simulator steps per trajectory step
+  bool start_from_plan = true;  // start from the state of the first step
+};
+
+/// Tracking errors of a replayed trajectory, simulated minus planned.
+struct TrackingMetrics {
+  gtsam::Matrix joint_angle_errors;    // numSteps x numJoints
+  gtsam::Matrix joint_vel_errors;      // numSteps x numJoints
+  gtsam::Matrix base_position_errors;  // numSteps x 3, zero without poses
+  gtsam::Matrix torques;               // applied, numSteps x numJoints
+  gtsam::Vector rms_joint_angle_errors;  // per joint, over all steps
+  double max_joint_angle_error = 0;      // over all joints and steps
+  double rms_base_position_error = 0;    // norm, over all steps
+};
+
+/**
+ * Replay a trajectory in a ContactSimulator, tracking its joint angles and
+ * velocities with a PD controller on top of its torques.
+ *
+ * At every step t the errors of the simulated state against step t of the
+ * trajectory are recorded, then the torques
+ *
+ *   tau = tau_t + kp (q_t - q) + kd (v_t - v)
+ *
+ * are applied for dt, in `substeps` simulator steps. With start_from_plan
+ * the simulator starts from the joint state of step 0 and, if the
+ * trajectory has poses and twists, from the base state of the root link.
+ *
+ * @param simulator  simulator of the robot of the trajectory, advanced
+ * @param trajectory planned trajectory, joints in Robot::joints() order
+ * @param dt         duration of a trajectory step
+ * @param parameters gains and options
+ */
+TrackingMetrics ReplayTrajectory(
+    ContactSimulator *simulator, const TrajectoryBuffer &trajectory,
+    double dt, const ReplayParameters &parameters = ReplayParameters());
+
+/**
+ * Replay a batch of trajectories, each in its own copy of a simulator, in
+ * parallel; see ReplayTrajectory.
+ *
+ * @param simulator    simulator in its initial state, copied per trajectory
+ * @param trajectories planned trajectories
+ * @param dt           duration of a trajectory step
+ * @param parameters   gains and options
+ * @param num_threads  number of threads, 0 for all threads
+ */
+std::vector<TrackingMetrics> ReplayTrajectories(
+    const ContactSimulator &simulator,
+    const std::vector<TrajectoryBuffer> &trajectories, double dt,
+    const ReplayParameters &parameters = ReplayParameters(),
+    size_t num_threads = 0);
+
+}  // namespace gtdynamics
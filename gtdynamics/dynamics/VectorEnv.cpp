@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  VectorEnv.cpp
+ * @brief Vectorized environments of a legged robot, for reinforcement
+ * learning.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/VectorEnv.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+VectorEnv::VectorEnv(const Robot &robot, const PointOnLinks &contact_points,
+                     size_t num_envs, const Vector3 &gravity,
+                     const VectorEnvParameters &parameters,
+                     size_t num_threads)
+    : parameters_(parameters),
+      num_threads_(num_threads),
+      up_(gravity.norm() > 0 ? Vector3(-gravity.normalized())
+                             : Vector3(0, 0, 1)) {
+  if (num_envs == 0) {
+    throw std::invalid_argument("VectorEnv: no environments");
+  }
+  if (parameters_.substeps == 0 || !(parameters_.dt > 0)) {
+    throw std::invalid_argument(
+        "VectorEnv: time step and substeps must be positive");
+  }
+
+  // The simulators are copies of one, sharing the links and joints.
+  const ContactSimulator simulator(robot, contact_points, gravity,
+                                   parameters_.contact);
+  envs_.reserve(num_envs);
+  for (size_t n = 0; n < num_envs; n++) envs_.push_back(simulator);
+  const size_t num_joints = robot.numJoints();
+  initial_poses_.assign(num_envs, simulator.basePose());
+  initial_twists_.assign(num_envs, simulator.baseTwist());
+  initial_q_ = simulator.jointAngles().transpose().replicate(num_envs, 1);
+  initial_v_ = simulator.jointVels().transpose().replicate(num_envs, 1);
+
+  actions_.setZero(num_envs, num_joints);
+  observations_.setZero(num_envs, 13 + 2 * num_joints);
+  terminated_.setZero(num_envs);
+  truncated_.setZero(num_envs);
+  episode_steps_.assign(num_envs, 0);
+  reset();
+}
+
+/* ************************************************************************* */
+void VectorEnv::setInitialState(size_t n, const Pose3 &base_pose,
+                                const Vector6 &base_twist,
+                                const Vector &joint_angles,
+                                const Vector &joint_vels) {
+  if (n >= envs_.size()) {
+    throw std::out_of_range("VectorEnv: no such environment");
+  }
+  if (size_t(joint_angles.size()) != actionDim() ||
+      size_t(joint_vels.size()) != actionDim()) {
+    throw std::invalid_argument(
+        "VectorEnv: state must have one value per joint");
+  }
+  initial_poses_[n] = base_pose;
+  initial_twists_[n] = base_twist;
+  initial_q_.row(n) = joint_angles.transpose();
+  initial_v_.row(n) = joint_vels.transpose();
+}
+
+/* ************************************************************************* */
+void VectorEnv::reset(size_t n) {
+  if (n >= envs_.size()) {
+    throw std::out_of_range("VectorEnv: no such environment");
+  }
+  envs_[n].setState(initial_poses_[n], initial_twists_[n],
+                    initial_q_.row(n).transpose(),
+                    initial_v_.row(n).transpose());
+  episode_steps_[n] = 0;
+  observe(n);
+}
+
+/* ************************************************************************* */
+void VectorEnv::reset() {
+  ParallelFor(envs_.size(), num_threads_, [this](size_t n) { reset(n); });
+  terminated_.setZero();
+  truncated_.setZero();
+}
+
+/* ************************************************************************* */
+void VectorEnv::observe(size_t n) {
+  const ContactSimulator &env = envs_[n];
+  const size_t num_joints = actionDim();
+  const Pose3 &pose = env.basePose();
+  const gtsam::Quaternion quaternion = pose.rotation().toQuaternion();
+  auto observation = observations_.row(n);
+  observation.segment<3>(0) = pose.translation().transpose();
+  observation.segment<4>(3) << quaternion.w(), quaternion.x(), quaternion.y(),
+      quaternion.z();
+  observation.segment<6>(7) = env.baseTwist().transpose();
+  observation.segment(13, num_joints) = env.jointAngles().transpose();
+  observation.segment(13 + num_joints, num_joints) =
+      env.jointVels().transpose();
+}
+
+/* ************************************************************************* */
+void VectorEnv::step() {
+  ParallelFor(envs_.size(), num_threads_, [this](size_t n) {
+    ContactSimulator &env = envs_[n];
+    const Vector torques = actions_.row(n).transpose();
+    for (size_t s = 0; s < parameters_.substeps; s++) {
+      env.step(torques, parameters_.dt);
+    }
+    episode_steps_[n]++;
+    terminated_(n) =
+        up_.dot(env.basePose().translation()) < parameters_.min_base_height;
+    truncated_(n) = !terminated_(n) && parameters_.max_episode_steps > 0 &&
+                    episode_steps_[n] >= parameters_.max_episode_steps;
+    if (parameters_.auto_reset && (terminated_(n) || truncated_(n))) {
+      reset(n);
+    } else {
+      observe(n);
+    }
+  });
+}
+
+}  // namespace gtdynamics
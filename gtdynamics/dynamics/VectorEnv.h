@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  VectorEnv.h
+ * @brief Vectorized environments of a legged robot, for reinforcement
+ * learning.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of VectorEnv.
+struct VectorEnvParameters {
+  double dt = 0.005;     ///< duration of a simulation step
+  size_t substeps = 4;   ///< simulation steps per environment step
+  /// Steps after which an episode is truncated, 0 for no limit.
+  size_t max_episode_steps = 1000;
+  /// Base CoM height, along the up direction, below which an episode
+  /// terminates, e.g. when the robot falls.
+  double min_base_height = -std::numeric_limits<double>::infinity();
+  bool auto_reset = true;  ///< reset environments when their episode ends
+  ContactSimulatorParameters contact;  ///< soft contact model
+};
+
+/**
+ * VectorEnv steps N environments of the same robot on flat ground at once,
+ * with the interface of vectorized reinforcement learning environments:
+ * actions are written into one N x numJoints array of joint torques, and
+ * step() advances all environments on a pool of threads and writes one
+ * N x observationDim array of observations. Both arrays are row-major, so
+ * the Python bindings expose them as NumPy views without copies, and an
+ * environment step crosses the binding boundary once for all environments.
+ *
+ * Every environment is a ContactSimulator, as legged robots need a floating
+ * base and ground contact; they all share the links and joints of one Robot,
+ * loaded once. The observation of an environment is
+ *
+ *   [base position (3), base rotation quaternion w, x, y, z (4),
+ *    base twist in the CoM frame (6), joint angles, joint velocities]
+ *
+ * with joints in Robot::joints() order. The state of a robot with a fixed
+ * root stays at its fixed pose.
+ *
+ * An episode ends when the base falls below min_base_height (terminated) or
+ * after max_episode_steps steps (truncated). With auto_reset, such an
+ * environment is reset to its initial state within the same step, so the
+ * observation after the step is the first one of the next episode.
+ * Rewards are left to the caller, e.g. computed from the observations.
+ */
+class VectorEnv {
+ public:
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                        Eigen::RowMajor>
+      Array;
+  typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, 1> Flags;
+
+ private:
+  VectorEnvParameters parameters_;
+  size_t num_threads_;
+  std::vector<ContactSimulator> envs_;
+  gtsam::Vector3 up_;
+
+  /// Initial state of every environment.
+  std::vector<gtsam::Pose3> initial_poses_;
+  std::vector<gtsam::Vector6> initial_twists_;
+  gtsam::Matrix initial_q_, initial_v_;
+
+  Array actions_, observations_;
+  Flags terminated_, truncated_;
+  std::vector<size_t> episode_steps_;
+
+  /// Write the observation of environment n.
+  void observe(size_t n);
+
+ public:
+  /**
+   * Constructor, with all environments at the rest state of
+   * ContactSimulator.
+   * @param robot          the robot, must be a kinematic tree
+   * @param contact_points points that can touch the ground, e.g. the feet
+   * @param num_envs       number of environments N
+   * @param gravity        gravity vector, also defines the up direction
+   * @param parameters     time step, episodes and contact model
+   * @param num_threads    number of threads, 0 for all threads of the shared
+   * executor
+   */
+  VectorEnv(const Robot &robot, const PointOnLinks &contact_points,
+            size_t num_envs, const gtsam::Vector3 &gravity,
+            const VectorEnvParameters &parameters = VectorEnvParameters(),
+            size_t num_threads = 0);
+
+  /// Number of environments.
+  size_t numEnvs() const { return envs_.size(); }
+
+  /// Number of actions, the joint torques, per environment.
+  size_t actionDim() const { return actions_.cols(); }
+
+  /// Number of observations per environment.
+  size_t observationDim() const { return observations_.cols(); }
+
+  /// Parameters.
+  const VectorEnvParameters &parameters() const { return parameters_; }
+
+  /**
+   * Set the initial state of an environment, used by every reset of it.
+   * @param n            environment
+   * @param base_pose    CoM pose of the root link
+   * @param base_twist   twist of the root link, in its CoM frame
+   * @param joint_angles joint angles, in Robot::joints() order
+   * @param joint_vels   joint velocities
+   */
+  void setInitialState(size_t n, const gtsam::Pose3 &base_pose,
+                       const gtsam::Vector6 &base_twist,
+                       const gtsam::Vector &joint_angles,
+                       const gtsam::Vector &joint_vels);
+
+  /// Reset all environments to their initial states.
+  void reset();
+
+  /// Reset one environment to its initial state.
+  void reset(size_t n);
+
+  /**
+   * Apply the actions to all environments for substeps simulation steps,
+   * update the observations and the ends of the episodes, and reset the
+   * ended environments if auto_reset is set.
+   */
+  void step();
+
+  /// Joint torques of every environment, N x actionDim, written by callers.
+  Array &actions() { return actions_; }
+  const Array &actions() const { return actions_; }
+
+  /// Observations of every environment, N x observationDim.
+  const Array &observations() const { return observations_; }
+
+  /// Whether the episode of every environment terminated in the last step.
+  const Flags &terminated() const { return terminated_; }
+
+  /// Whether the episode of every environment was truncated in the last
+  /// step.
+  const Flags &truncated() const { return truncated_; }
+
+  /// Steps taken in the current episode of an environment.
+  size_t episodeSteps(size_t n) const { return episode_steps_[n]; }
+
+  /// The simulator of an environment, e.g. to read contact wrenches.
+  const ContactSimulator &simulator(size_t n) const { return envs_[n]; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,165 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BSplineFactor.h
+ * @brief A factor on scalar variables that are linear combinations of other
+ * variables, e.g. joint states given by spline control points.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * BSplineFactor rewrites the keys of a wrapped factor: some of its scalar
+ * variables are replaced by fixed linear combinations of other scalar
+ * variables, such as joint angles, velocities and accelerations by the
+ * weighted control points of a spline, see BSplineTrajectory. The other
+ * variables are passed through. Error and linearization are those of the
+ * wrapped factor at the combined values, with the Jacobians of the replaced
+ * variables spread over the combined ones by the chain rule, so any factor
+ * that linearizes to a JacobianFactor can be reused unchanged.
+ */
+class BSplineFactor : public gtsam::NonlinearFactor {
+ public:
+  /// Weighted sum of scalar variables.
+  typedef std::vector<std::pair<gtsam::Key, double>> Combination;
+
+ private:
+  using This = BSplineFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  /// For every key of the wrapped factor, its combination, empty if passed
+  /// through.
+  std::vector<Combination> combinations_;
+
+  /// Add a key to the keys of this factor, once.
+  void addKey(gtsam::Key key) {
+    if (std::find(keys_.begin(), keys_.end(), key) == keys_.end())
+      keys_.push_back(key);
+  }
+
+  /// Values of the keys of the wrapped factor.
+  gtsam::Values wrappedValues(const gtsam::Values &x) const {
+    gtsam::Values y;
+    for (size_t i = 0; i < factor_->size(); i++) {
+      const gtsam::Key key = factor_->keys()[i];
+      if (combinations_[i].empty()) {
+        y.insert(key, x.at(key));
+      } else {
+        double value = 0.0;
+        for (auto &&term : combinations_[i]) {
+          value += term.second * x.at<double>(term.first);
+        }
+        y.insert(key, value);
+      }
+    }
+    return y;
+  }
+
+ public:
+  using shared_ptr = boost::shared_ptr<This>;
+
+  /**
+   * Constructor.
+   * @param factor       the wrapped factor
+   * @param combinations combinations of the replaced keys of the factor
+   */
+  BSplineFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                const std::map<gtsam::Key, Combination> &combinations)
+      : factor_(factor) {
+    for (gtsam::Key key : factor_->keys()) {
+      auto it = combinations.find(key);
+      if (it == combinations.end() || it->second.empty()) {
+        combinations_.emplace_back();
+        addKey(key);
+        continue;
+      }
+      combinations_.push_back(it->second);
+      for (auto &&term : it->second) addKey(term.first);
+    }
+  }
+
+  virtual ~BSplineFactor() {}
+
+  /// The wrapped factor.
+  const gtsam::NonlinearFactor::shared_ptr &factor() const { return factor_; }
+
+  double error(const gtsam::Values &x) const override {
+    return factor_->error(wrappedValues(x));
+  }
+
+  size_t dim() const override { return factor_->dim(); }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override {
+    const auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        factor_->linearize(wrappedValues(x)));
+    if (!jacobian) {
+      throw std::runtime_error(
+          "BSplineFactor: wrapped factor does not linearize to a "
+          "JacobianFactor");
+    }
+    const size_t rows = jacobian->rows();
+    std::map<gtsam::Key, gtsam::Matrix> blocks;
+    for (gtsam::Key key : keys()) {
+      blocks[key] = gtsam::Matrix::Zero(rows, x.at(key).dim());
+    }
+    const gtsam::KeyVector &wrapped_keys = factor_->keys();
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      const size_t i =
+          std::find(wrapped_keys.begin(), wrapped_keys.end(), *it) -
+          wrapped_keys.begin();
+      const gtsam::Matrix A = jacobian->getA(it);
+      if (combinations_[i].empty()) {
+        blocks[*it] += A;
+      } else {
+        for (auto &&term : combinations_[i]) {
+          blocks[term.first] += term.second * A;
+        }
+      }
+    }
+    std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+    terms.reserve(size());
+    for (gtsam::Key key : keys()) terms.emplace_back(key, blocks[key]);
+    return boost::make_shared<gtsam::JacobianFactor>(terms, jacobian->getb(),
+                                                     jacobian->get_model());
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<This>(*this);
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "b-spline factor on";
+    for (gtsam::Key key : keys()) std::cout << " " << keyFormatter(key);
+    std::cout << std::endl;
+    factor_->print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
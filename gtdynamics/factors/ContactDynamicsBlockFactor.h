@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactDynamicsBlockFactor.h
+ * @brief Friction cone and contact moment constraints of all contacts of a
+ * time step in one factor.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <algorithm>
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ContactDynamicsBlockFactor evaluates the constraints of
+ * ContactDynamicsFrictionConeFactor, and optionally those of
+ * ContactDynamicsMomentFactor, for all contacts of a time step in one pass.
+ * A legged robot then adds one factor per time step instead of two per
+ * contact, which saves the virtual calls, whitening and bookkeeping of many
+ * tiny factors during linearization and elimination.
+ *
+ * The error stacks the friction cone errors of all contacts, followed by the
+ * 3-dimensional moment errors of all contacts if they are enabled. Contacts
+ * may share pose or wrench keys.
+ */
+class ContactDynamicsBlockFactor : public gtsam::NoiseModelFactor {
+ public:
+  /// Keys and contact frame of one contact.
+  struct Contact {
+    gtsam::Key pose_key;    // link CoM pose
+    gtsam::Key wrench_key;  // contact wrench on the link
+    gtsam::Pose3 cTcom;     // CoM frame expressed in the contact frame
+  };
+
+ private:
+  using This = ContactDynamicsBlockFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<Contact> contacts_;
+  // Position of the pose and wrench keys of every contact in keys().
+  std::vector<size_t> pose_index_, wrench_index_;
+  std::vector<gtsam::Matrix36> H_moment_;  // moment as a function of wrench
+  int up_axis_;      // Which axis is up (assuming flat ground)?
+  double mu_prime_;  // static friction coefficient squared.
+  bool moments_;
+
+  /// Pose and wrench keys of all contacts, without duplicates.
+  static gtsam::KeyVector ContactKeys(const std::vector<Contact> &contacts) {
+    gtsam::KeyVector keys;
+    for (auto &&contact : contacts) {
+      for (gtsam::Key key : {contact.pose_key, contact.wrench_key}) {
+        if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+          keys.push_back(key);
+        }
+      }
+    }
+    return keys;
+  }
+
+  /// Diagonal model with the sigmas of the per-contact models.
+  static gtsam::SharedNoiseModel BlockModel(
+      size_t num_contacts,
+      const gtsam::noiseModel::Base::shared_ptr &friction_model,
+      const gtsam::noiseModel::Base::shared_ptr &moment_model) {
+    if (num_contacts == 0) {
+      throw std::invalid_argument("ContactDynamicsBlockFactor: no contacts");
+    }
+    const size_t dim = num_contacts * (moment_model ? 4 : 1);
+    gtsam::Vector sigmas(dim);
+    for (size_t i = 0; i < num_contacts; i++) {
+      sigmas(i) = friction_model->sigmas()(0);
+      if (moment_model) {
+        sigmas.segment<3>(num_contacts + 3 * i) = moment_model->sigmas();
+      }
+    }
+    return SharedDiagonal(sigmas);
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param contacts Keys and contact frames of all contacts.
+   * @param friction_model 1-dimensional model of every friction cone.
+   * @param moment_model 3-dimensional model of every contact moment, nullptr
+   * to leave the moments out.
+   * @param mu Static friction coefficient.
+   * @param gravity Gravity vector, which gives the up axis.
+   */
+  ContactDynamicsBlockFactor(
+      const std::vector<Contact> &contacts,
+      const gtsam::noiseModel::Base::shared_ptr &friction_model,
+      const gtsam::noiseModel::Base::shared_ptr &moment_model, double mu,
+      const gtsam::Vector3 &gravity)
+      : Base(BlockModel(contacts.size(), friction_model, moment_model),
+             ContactKeys(contacts)),
+        contacts_(contacts),
+        mu_prime_(mu * mu),
+        moments_(moment_model != nullptr) {
+    if (gravity[0] != 0)
+      up_axis_ = 0;  // x.
+    else if (gravity[1] != 0)
+      up_axis_ = 1;  // y.
+    else
+      up_axis_ = 2;  // z.
+
+    gtsam::Matrix36 H_contact_wrench;
+    H_contact_wrench << gtsam::I_3x3, gtsam::Z_3x3;
+    for (auto &&contact : contacts_) {
+      pose_index_.push_back(
+          std::find(keys().begin(), keys().end(), contact.pose_key) -
+          keys().begin());
+      wrench_index_.push_back(
+          std::find(keys().begin(), keys().end(), contact.wrench_key) -
+          keys().begin());
+      H_moment_.push_back(H_contact_wrench *
+                          contact.cTcom.inverse().AdjointMap().transpose());
+    }
+  }
+
+  virtual ~ContactDynamicsBlockFactor() {}
+
+  /// Number of contacts.
+  size_t numContacts() const { return contacts_.size(); }
+
+  /**
+   * Evaluate the friction cone errors, then the moment errors, of all
+   * contacts.
+   * @param x Values with the poses and contact wrenches.
+   * @param H Jacobians, in the order of keys().
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    const size_t n = contacts_.size();
+    gtsam::Vector error = gtsam::Vector::Zero(dim());
+    if (H) {
+      H->resize(size());
+      for (auto &&H_key : *H) H_key = gtsam::Matrix::Zero(dim(), 6);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      const gtsam::Pose3 &pose = x.at<gtsam::Pose3>(contacts_[i].pose_key);
+      const gtsam::Vector6 &wrench =
+          x.at<gtsam::Vector6>(contacts_[i].wrench_key);
+
+      // Ramp of the squared tangential force minus mu^2 times the squared
+      // normal force, with the force f_s in the spatial frame.
+      const gtsam::Matrix3 R = pose.rotation().matrix();
+      const gtsam::Vector3 f_c = wrench.tail<3>(), f_s = R * f_c;
+      gtsam::Vector3 weighted = f_s;
+      weighted(up_axis_) *= -mu_prime_;
+      const double resultant = weighted.dot(f_s);
+      if (resultant > 0) {
+        error(i) = resultant;
+        if (H) {
+          const gtsam::Matrix13 H_f_s = 2 * weighted.transpose();
+          (*H)[wrench_index_[i]].block<1, 3>(i, 3) += H_f_s * R;
+          (*H)[pose_index_[i]].block<1, 3>(i, 0) -=
+              H_f_s * R * gtsam::skewSymmetric(f_c);
+        }
+      }
+
+      if (moments_) {
+        error.segment<3>(n + 3 * i) = H_moment_[i] * wrench;
+        if (H) {
+          (*H)[wrench_index_[i]].block<3, 6>(n + 3 * i, 0) += H_moment_[i];
+        }
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Contact Dynamics Block Factor, " << contacts_.size()
+              << " contacts" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
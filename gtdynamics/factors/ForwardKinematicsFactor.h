@@ -90,7 +90,8 @@ class ForwardKinematicsFactor : public gtsam::BetweenFactor<gtsam::Pose3> {
 
   /**
    * @brief Function to compute the relative pose between start and end link via
-   * forward kinematics using the joint angles.
+   * forward kinematics using the joint angles, along the kinematic path
+   * between them only, see Robot::relativePose.
    *
    * @param robot Robot model on which to perform forward kinematics.
    * @param start_link_name String for the start link in the kinematic chain.
@@ -104,15 +105,8 @@ class ForwardKinematicsFactor : public gtsam::BetweenFactor<gtsam::Pose3> {
                                    const std::string &end_link_name,
                                    const gtsam::Values &joint_angles,
                                    size_t k) const {
-    auto start_link = robot.link(start_link_name);
-    auto end_link = robot.link(end_link_name);
-
-    gtsam::Values fk =
-        robot.forwardKinematics(joint_angles, k, start_link_name);
-
-    gtsam::Pose3 bTl1 = Pose(fk, start_link->id(), k);
-    gtsam::Pose3 bTl2 = Pose(fk, end_link->id(), k);
-    return bTl1.between(bTl2);
+    return robot.relativePose(joint_angles, start_link_name, end_link_name,
+                              k);
   }
 
   /// print contents
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GatedFactor.h
+ * @brief A factor that is switched on and off in place.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * GatedFactor wraps a factor that can be disabled without removing it from
+ * its graph. Disabled, it has zero error and linearizes to a zero
+ * JacobianFactor on the same keys and rows, so that the structure of the
+ * linearized graph, and hence orderings and symbolic elimination, stay the
+ * same whether it is enabled or not. Graphs hold it by pointer, so enabling
+ * it affects every graph it was added to.
+ */
+class GatedFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = GatedFactor;
+  using Base = gtsam::NonlinearFactor;
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  bool enabled_;
+
+ public:
+  using shared_ptr = boost::shared_ptr<This>;
+
+  /**
+   * Constructor.
+   * @param factor the wrapped factor
+   * @param enabled whether the factor starts enabled
+   */
+  explicit GatedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                       bool enabled = true)
+      : Base(factor->keys()), factor_(factor), enabled_(enabled) {}
+
+  virtual ~GatedFactor() {}
+
+  /// The wrapped factor.
+  const gtsam::NonlinearFactor::shared_ptr &factor() const { return factor_; }
+
+  /// Whether the factor contributes to the graph.
+  bool enabled() const { return enabled_; }
+
+  /// Switch the factor on or off.
+  void setEnabled(bool enabled) { enabled_ = enabled; }
+
+  double error(const gtsam::Values &x) const override {
+    return enabled_ ? factor_->error(x) : 0.0;
+  }
+
+  size_t dim() const override { return factor_->dim(); }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override {
+    if (enabled_) return factor_->linearize(x);
+    std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+    terms.reserve(size());
+    for (gtsam::Key key : keys()) {
+      terms.emplace_back(key, gtsam::Matrix::Zero(dim(), x.at(key).dim()));
+    }
+    return boost::make_shared<gtsam::JacobianFactor>(
+        terms, gtsam::Vector::Zero(dim()));
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<This>(*this);
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "gated factor (" << (enabled_ ? "enabled" : "disabled")
+              << ")" << std::endl;
+    factor_->print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
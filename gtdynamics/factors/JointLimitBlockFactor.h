@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointLimitBlockFactor.h
+ * @brief Joint limits of a whole time step in one factor.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JointLimitBlockFactor evaluates the hinge errors of JointLimitFactor for
+ * many scalar variables at once, e.g. the angle, velocity, acceleration and
+ * torque limits of all joints in a time step. A trajectory then has one limit
+ * factor per time step instead of four per joint, which saves the virtual
+ * calls and bookkeeping of many tiny factors during linearization and
+ * elimination.
+ *
+ * The error stacks the errors of the limits, in order, with the sigma of the
+ * scalar model in every entry. Every key must appear in one limit only.
+ */
+class JointLimitBlockFactor : public gtsam::NoiseModelFactor {
+ public:
+  /// A scalar variable and the interval it is kept in.
+  struct Limit {
+    gtsam::Key key;
+    double low, high;  // limits, already tightened by the threshold
+  };
+
+ private:
+  using This = JointLimitBlockFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<double> low_, high_;
+
+  static gtsam::KeyVector LimitKeys(const std::vector<Limit> &limits) {
+    gtsam::KeyVector keys;
+    keys.reserve(limits.size());
+    for (auto &&limit : limits) keys.push_back(limit.key);
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param limits variables and their limits.
+   * @param cost_model 1-dimensional diagonal model of every limit, as for
+   * JointLimitFactor.
+   */
+  JointLimitBlockFactor(const std::vector<Limit> &limits,
+                        const gtsam::SharedNoiseModel &cost_model)
+      : Base(RepeatedNoiseModel(cost_model, limits.size()),
+             LimitKeys(limits)) {
+    low_.reserve(limits.size());
+    high_.reserve(limits.size());
+    for (auto &&limit : limits) {
+      low_.push_back(limit.low);
+      high_.push_back(limit.high);
+    }
+  }
+
+  virtual ~JointLimitBlockFactor() {}
+
+  /**
+   * Evaluate the hinge errors of all limits,
+   *    error_i = low_i - q_i if q_i < low_i
+   *    error_i = 0 if low_i <= q_i <= high_i
+   *    error_i = q_i - high_i if q_i > high_i
+   * @param x Values with the limited variables.
+   * @param H Jacobians, in the order of keys().
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    const size_t n = size();
+    gtsam::Vector error = gtsam::Vector::Zero(n);
+    if (H) H->assign(n, gtsam::Matrix::Zero(n, 1));
+    for (size_t i = 0; i < n; i++) {
+      const double q = x.at<double>(keys_[i]);
+      if (q < low_[i]) {
+        error(i) = low_[i] - q;
+        if (H) (*H)[i](i, 0) = -1.0;
+      } else if (q > high_[i]) {
+        error(i) = q - high_[i];
+        if (H) (*H)[i](i, 0) = 1.0;
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Joint Limit Block Factor, " << size() << " limits"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &low_;
+    ar &high_;
+  }
+};
+
+}  // namespace gtdynamics
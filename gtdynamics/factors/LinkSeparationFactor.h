@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinkSeparationFactor.h
+ * @brief Factor keeping the CoMs of two links a minimum distance apart.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <algorithm>
+#include <boost/optional.hpp>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * LinkSeparationFactor is a hinge on the distance between the CoMs of two
+ * links, e.g. of two robots avoiding each other: the error is
+ * max(0, distance - |t_a - t_b|), so it vanishes once the links are far
+ * enough apart.
+ */
+class LinkSeparationFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3> {
+ private:
+  using This = LinkSeparationFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3>;
+
+  double distance_;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param pose_a_key key of the CoM pose of the first link
+   * @param pose_b_key key of the CoM pose of the second link
+   * @param distance   minimum distance between the CoMs
+   * @param cost_model 1-dimensional noise model
+   */
+  LinkSeparationFactor(gtsam::Key pose_a_key, gtsam::Key pose_b_key,
+                       double distance,
+                       const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, pose_a_key, pose_b_key), distance_(distance) {}
+  virtual ~LinkSeparationFactor() {}
+
+  /// Minimum distance between the CoMs.
+  double distance() const { return distance_; }
+
+  /**
+   * Evaluate the separation error.
+   * @param wTa CoM pose of the first link
+   * @param wTb CoM pose of the second link
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTa, const gtsam::Pose3 &wTb,
+      boost::optional<gtsam::Matrix &> H_a = boost::none,
+      boost::optional<gtsam::Matrix &> H_b = boost::none) const override {
+    gtsam::Matrix36 H_ta, H_tb;
+    const gtsam::Point3 t_a = wTa.translation(H_a ? &H_ta : 0);
+    const gtsam::Point3 t_b = wTb.translation(H_b ? &H_tb : 0);
+    const gtsam::Vector3 d = t_a - t_b;
+    const double norm = d.norm();
+
+    // Inactive, or coincident CoMs where the direction is undefined.
+    if (norm >= distance_ || norm < 1e-9) {
+      if (H_a) *H_a = gtsam::Matrix16::Zero();
+      if (H_b) *H_b = gtsam::Matrix16::Zero();
+      return (gtsam::Vector(1) << std::max(0.0, distance_ - norm)).finished();
+    }
+
+    const gtsam::Matrix13 H_d = -d.transpose() / norm;
+    if (H_a) *H_a = H_d * H_ta;
+    if (H_b) *H_b = -H_d * H_tb;
+    return (gtsam::Vector(1) << distance_ - norm).finished();
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "link separation factor, distance " << distance_
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(distance_);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MinTorqueBlockFactor.h
+ * @brief Factor to minimize the torques of all joints in a time step.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * MinTorqueBlockFactor minimizes the torques of many joints, as one
+ * MinTorqueFactor per joint does, with the sigma of the scalar model in every
+ * entry. The error is the vector of torques.
+ */
+class MinTorqueBlockFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = MinTorqueBlockFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor.
+   * @param torque_keys keys of the torques, without duplicates.
+   * @param cost_model 1-dimensional diagonal model of every torque, as for
+   * MinTorqueFactor.
+   */
+  MinTorqueBlockFactor(const gtsam::KeyVector &torque_keys,
+                       const gtsam::SharedNoiseModel &cost_model)
+      : Base(RepeatedNoiseModel(cost_model, torque_keys.size()),
+             torque_keys) {}
+
+  virtual ~MinTorqueBlockFactor() {}
+
+  /**
+   * Evaluate the torques.
+   * @param x Values with the torques.
+   * @param H Jacobians, in the order of keys().
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    const size_t n = size();
+    gtsam::Vector error(n);
+    for (size_t i = 0; i < n; i++) error(i) = x.at<double>(keys_[i]);
+    if (H) {
+      H->assign(n, gtsam::Matrix::Zero(n, 1));
+      for (size_t i = 0; i < n; i++) (*H)[i](i, 0) = 1.0;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "min torque block factor, " << size() << " torques"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
@@ -11,6 +11,7 @@
  * @author Frank Dellaert
  */
 
+#include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/factors/ObjectiveFactors.h>
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
@@ -21,6 +22,7 @@
 #include <gtsam/nonlinear/PriorFactor.h>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -41,11 +43,101 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
 
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const SharedNoiseModel& cost_model, const Point3& point_com,
-    const std::vector<Point3>& goal_trajectory, unsigned char i, size_t k) {
+    const std::vector<Point3>& goal_trajectory, uint16_t i, size_t k) {
   gtsam::Key key = PoseKey(i, k);
   return PointGoalFactors(key, cost_model, point_com, goal_trajectory);
 }
 
+gtsam::KeyVector JointKeys(const std::string& label,
+                           const std::vector<int>& joints, size_t num_steps,
+                           size_t k) {
+  gtsam::KeyVector keys;
+  keys.reserve(joints.size() * num_steps);
+  for (size_t t = k; t < k + num_steps; t++) {
+    for (int j : joints) {
+      keys.push_back(DynamicsSymbol::JointSymbol(label, j, t));
+    }
+  }
+  return keys;
+}
+
+gtsam::KeyVector LinkKeys(const std::string& label,
+                          const std::vector<int>& links, size_t num_steps,
+                          size_t k) {
+  gtsam::KeyVector keys;
+  keys.reserve(links.size() * num_steps);
+  for (size_t t = k; t < k + num_steps; t++) {
+    for (int i : links) {
+      keys.push_back(DynamicsSymbol::LinkSymbol(label, i, t));
+    }
+  }
+  return keys;
+}
+
+gtsam::NonlinearFactorGraph DoublePriorFactors(const gtsam::KeyVector& keys,
+                                               const gtsam::Vector& means,
+                                               const SharedNoiseModel& model) {
+  if (means.size() != 1 && size_t(means.size()) != keys.size()) {
+    throw std::invalid_argument(
+        "DoublePriorFactors: need one mean, or one per key");
+  }
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        keys[i], means.size() == 1 ? means(0) : means(i), model);
+  }
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph PosePriorFactors(
+    const gtsam::KeyVector& keys, const std::vector<gtsam::Pose3>& means,
+    const SharedNoiseModel& model) {
+  if (means.size() != keys.size()) {
+    throw std::invalid_argument("PosePriorFactors: need one mean per key");
+  }
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    graph.emplace_shared<gtsam::PriorFactor<gtsam::Pose3>>(keys[i], means[i],
+                                                           model);
+  }
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph JointPriorObjectives(
+    const Robot& robot, const std::string& label, const gtsam::Matrix& means,
+    const SharedNoiseModel& model, size_t k) {
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(means.rows() * robot.numJoints());
+  for (int t = 0; t < means.rows(); t++) {
+    for (auto&& joint : robot.joints()) {
+      if (joint->id() >= means.cols()) {
+        throw std::invalid_argument(
+            "JointPriorObjectives: need one column per joint id");
+      }
+      graph.emplace_shared<gtsam::PriorFactor<double>>(
+          DynamicsSymbol::JointSymbol(label, joint->id(), k + t),
+          means(t, joint->id()), model);
+    }
+  }
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph MinTorqueObjectives(
+    const Robot& robot, size_t num_steps, const SharedNoiseModel& cost_model,
+    size_t k) {
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(num_steps * robot.numJoints());
+  for (size_t t = k; t < k + num_steps; t++) {
+    for (auto&& joint : robot.joints()) {
+      graph.emplace_shared<MinTorqueFactor>(TorqueKey(joint->id(), t),
+                                            cost_model);
+    }
+  }
+  return graph;
+}
+
 std::vector<Point3> StanceTrajectory(const Point3& stance_point,
                                      size_t num_steps) {
   return std::vector<Point3>(num_steps, stance_point);
@@ -22,6 +22,8 @@
 #include <gtsam/nonlinear/PriorFactor.h>
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -167,7 +169,87 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
  */
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const gtsam::SharedNoiseModel& cost_model, const gtsam::Point3& point_com,
-    const std::vector<gtsam::Point3>& goal_trajectory, uint8_t i, size_t k = 0);
+    const std::vector<gtsam::Point3>& goal_trajectory, uint16_t i,
+    size_t k = 0);
+
+/**
+ * @brief Keys of a joint variable for a block of joints and time steps, in
+ * step-major order: the key of joints[j] at step k + t is at index
+ * t * joints.size() + j. Use with the bulk builders below, e.g. from Python,
+ * to create all factors of a horizon in one call.
+ *
+ * @param label variable label, e.g. "q" as in JointAngleKey or "T" as in
+ * TorqueKey
+ * @param joints the joint ids
+ * @param num_steps number of time steps
+ * @param k first time step (default 0).
+ */
+gtsam::KeyVector JointKeys(const std::string& label,
+                           const std::vector<int>& joints, size_t num_steps,
+                           size_t k = 0);
+
+/**
+ * @brief Keys of a link variable for a block of links and time steps, in
+ * step-major order, see JointKeys.
+ *
+ * @param label variable label, e.g. "p" as in PoseKey or "V" as in TwistKey
+ * @param links the link ids
+ * @param num_steps number of time steps
+ * @param k first time step (default 0).
+ */
+gtsam::KeyVector LinkKeys(const std::string& label,
+                          const std::vector<int>& links, size_t num_steps,
+                          size_t k = 0);
+
+/**
+ * @brief Create a graph of priors on scalar variables, e.g. joint angles or
+ * torques.
+ *
+ * @param keys the variables
+ * @param means one mean per key, or a single mean for all of them
+ * @param model noise model of every prior
+ */
+gtsam::NonlinearFactorGraph DoublePriorFactors(
+    const gtsam::KeyVector& keys, const gtsam::Vector& means,
+    const gtsam::SharedNoiseModel& model);
+
+/**
+ * @brief Create a graph of priors on poses, e.g. a link pose trajectory.
+ *
+ * @param keys the variables
+ * @param means one mean per key
+ * @param model noise model of every prior
+ */
+gtsam::NonlinearFactorGraph PosePriorFactors(
+    const gtsam::KeyVector& keys, const std::vector<gtsam::Pose3>& means,
+    const gtsam::SharedNoiseModel& model);
+
+/**
+ * @brief Create a graph of priors on a joint variable of all joints of a
+ * robot, for every time step of a horizon.
+ *
+ * @param robot The robot
+ * @param label variable label, e.g. "q" for joint angles
+ * @param means one row per time step, one column per joint id
+ * @param model noise model of every prior
+ * @param k first time step (default 0).
+ */
+gtsam::NonlinearFactorGraph JointPriorObjectives(
+    const Robot& robot, const std::string& label, const gtsam::Matrix& means,
+    const gtsam::SharedNoiseModel& model, size_t k = 0);
+
+/**
+ * @brief Create a graph of MinTorqueFactors on all joints of a robot, for
+ * every time step of a horizon.
+ *
+ * @param robot The robot
+ * @param num_steps number of time steps
+ * @param cost_model noise model of every factor
+ * @param k first time step (default 0).
+ */
+gtsam::NonlinearFactorGraph MinTorqueObjectives(
+    const Robot& robot, size_t num_steps,
+    const gtsam::SharedNoiseModel& cost_model, size_t k = 0);
 
 /**
  * @brief Create stance foot trajectory.
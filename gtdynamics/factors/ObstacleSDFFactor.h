@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ObstacleSDFFactor.h
+ * @brief Obstacle avoidance for spheres on a link, with a signed distance
+ * field.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ObstacleSDFFactor is a one-way nonlinear factor that keeps a sphere on a
+ * link at least epsilon away from obstacles. With d the signed distance of
+ * its center, the error is the hinge loss max(0, epsilon + radius - d), so
+ * the factor has no cost in free space.
+ */
+class ObstacleSDFFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = ObstacleSDFFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  std::shared_ptr<const SignedDistanceField> sdf_;
+  gtsam::Point3 comPc_;
+  double radius_, epsilon_;
+
+ public:
+  /**
+   * Constructor.
+   * @param pose_key   key of the link CoM pose
+   * @param cost_model 1-dimensional noise model, e.g. with obsSigma
+   * @param sdf        signed distance field of the obstacles
+   * @param comPc      sphere center in the link CoM frame, see sphereCenters
+   * @param radius     sphere radius
+   * @param epsilon    obstacle clearance
+   */
+  ObstacleSDFFactor(gtsam::Key pose_key,
+                    const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                    const std::shared_ptr<const SignedDistanceField> &sdf,
+                    const gtsam::Point3 &comPc, double radius, double epsilon)
+      : Base(cost_model, pose_key),
+        sdf_(sdf),
+        comPc_(comPc),
+        radius_(radius),
+        epsilon_(epsilon) {}
+
+  virtual ~ObstacleSDFFactor() {}
+
+  /// Evaluate the hinge loss, with its derivative w.r.t. the link pose.
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none) const override {
+    gtsam::Matrix36 H_point;
+    const gtsam::Point3 sPc =
+        pose.transformFrom(comPc_, H_pose ? &H_point : nullptr);
+    gtsam::Matrix13 H_distance;
+    const double d = sdf_->distance(sPc, H_pose ? &H_distance : nullptr);
+    const double error = epsilon_ + radius_ - d;
+    if (error <= 0) {
+      if (H_pose) *H_pose = gtsam::Matrix16::Zero();
+      return gtsam::Vector1(0.0);
+    }
+    if (H_pose) *H_pose = -H_distance * H_point;
+    return gtsam::Vector1(error);
+  }
+
+  /// The signed distance field.
+  const std::shared_ptr<const SignedDistanceField> &sdf() const {
+    return sdf_;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "ObstacleSDFFactor, radius "
+              << radius_ << ", epsilon " << epsilon_ << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * Obstacle factors for all spheres on a link.
+ * @param pose_key   key of the link CoM pose
+ * @param cost_model 1-dimensional noise model, e.g. with obsSigma
+ * @param sdf        signed distance field of the obstacles
+ * @param centers    sphere centers in the link CoM frame, see sphereCenters
+ * @param radius     sphere radius
+ * @param epsilon    obstacle clearance
+ */
+inline gtsam::NonlinearFactorGraph ObstacleSDFFactors(
+    gtsam::Key pose_key, const gtsam::noiseModel::Base::shared_ptr &cost_model,
+    const std::shared_ptr<const SignedDistanceField> &sdf,
+    const std::vector<gtsam::Point3> &centers, double radius,
+    double epsilon) {
+  gtsam::NonlinearFactorGraph graph;
+  for (const gtsam::Point3 &comPc : centers) {
+    graph.emplace_shared<ObstacleSDFFactor>(pose_key, cost_model, sdf, comPc,
+                                            radius, epsilon);
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
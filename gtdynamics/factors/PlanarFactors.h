@@ -0,0 +1,366 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarFactors.h
+ * @brief Kinematics and dynamics factors of planar robots, on Pose2 link
+ * poses and 3-vector twists, accelerations and wrenches.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/PlanarRobot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * The planar factors are those of DynamicsGraph for a PlanarRobot, with the
+ * same keys: the variables are the Pose2 poses of the link planar frames,
+ * and their 3-vector twists, twist accelerations and wrenches, see
+ * PlanarRobot. All have closed-form Jacobians.
+ */
+
+/// Child pose predicted from the parent pose and joint angle, minus the
+/// child pose, in the tangent space of the child pose.
+class PlanarPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double> {
+ private:
+  using This = PlanarPoseFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double>;
+
+  PlanarRobot::PlanarJoint joint_;
+
+ public:
+  /**
+   * @param cost_model 3-dimensional noise model
+   * @param joint      the joint connecting the two links
+   * @param t          time step
+   */
+  PlanarPoseFactor(const gtsam::SharedNoiseModel &cost_model,
+                   const PlanarRobot::PlanarJoint &joint, int t)
+      : Base(cost_model, PoseKey(joint.joint->parent()->id(), t),
+             PoseKey(joint.joint->child()->id(), t),
+             JointAngleKey(joint.joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose2 &wTp, const gtsam::Pose2 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix3 predicted_H_wTp, predicted_H_pTc, error_H_predicted,
+        error_H_wTc, log_H;
+    const gtsam::Pose2 predicted =
+        wTp.compose(joint_.parentTchild(q), predicted_H_wTp, predicted_H_pTc);
+    const gtsam::Vector3 error = gtsam::Pose2::Logmap(
+        predicted.between(wTc, error_H_predicted, error_H_wTc), log_H);
+    const gtsam::Matrix3 H_predicted = log_H * error_H_predicted;
+    if (H_wTp) *H_wTp = H_predicted * predicted_H_wTp;
+    if (H_wTc) *H_wTc = log_H * error_H_wTc;
+    if (H_q) *H_q = H_predicted * predicted_H_pTc * joint_.screw;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/// Child twist predicted from the parent twist and the joint velocity, minus
+/// the child twist.
+class PlanarTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3, double,
+                                      double> {
+ private:
+  using This = PlanarTwistFactor;
+  using Base = gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3,
+                                        double, double>;
+
+  PlanarRobot::PlanarJoint joint_;
+
+ public:
+  PlanarTwistFactor(const gtsam::SharedNoiseModel &cost_model,
+                    const PlanarRobot::PlanarJoint &joint, int t)
+      : Base(cost_model, TwistKey(joint.joint->parent()->id(), t),
+             TwistKey(joint.joint->child()->id(), t),
+             JointAngleKey(joint.joint->id(), t),
+             JointVelKey(joint.joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &twist_p, const gtsam::Vector3 &twist_c,
+      const double &q, const double &q_dot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none) const override {
+    const gtsam::Matrix3 Ad = joint_.parentTchild(q).inverse().AdjointMap();
+    const gtsam::Vector3 transformed = Ad * twist_p;
+    if (H_twist_p) *H_twist_p = Ad;
+    if (H_twist_c) *H_twist_c = -gtsam::I_3x3;
+    if (H_q) *H_q = -gtsam::Pose2::adjointMap(joint_.screw) * transformed;
+    if (H_q_dot) *H_q_dot = joint_.screw;
+    return transformed + joint_.screw * q_dot - twist_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/// Child twist acceleration predicted from the parent one, the child twist
+/// and the joint motion, minus the child twist acceleration.
+class PlanarTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                      gtsam::Vector3, double, double, double> {
+ private:
+  using This = PlanarTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                        gtsam::Vector3, double, double,
+                                        double>;
+
+  PlanarRobot::PlanarJoint joint_;
+
+ public:
+  PlanarTwistAccelFactor(const gtsam::SharedNoiseModel &cost_model,
+                         const PlanarRobot::PlanarJoint &joint, int t)
+      : Base(cost_model, TwistAccelKey(joint.joint->parent()->id(), t),
+             TwistAccelKey(joint.joint->child()->id(), t),
+             TwistKey(joint.joint->child()->id(), t),
+             JointAngleKey(joint.joint->id(), t),
+             JointVelKey(joint.joint->id(), t),
+             JointAccelKey(joint.joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &accel_p, const gtsam::Vector3 &accel_c,
+      const gtsam::Vector3 &twist_c, const double &q, const double &q_dot,
+      const double &q_ddot,
+      boost::optional<gtsam::Matrix &> H_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_ddot =
+          boost::none) const override {
+    const gtsam::Vector3 &S = joint_.screw;
+    const gtsam::Matrix3 Ad = joint_.parentTchild(q).inverse().AdjointMap(),
+                         ad_S = gtsam::Pose2::adjointMap(S);
+    const gtsam::Vector3 transformed = Ad * accel_p,
+                         ad_twist_S = gtsam::Pose2::adjointMap(twist_c) * S;
+    if (H_accel_p) *H_accel_p = Ad;
+    if (H_accel_c) *H_accel_c = -gtsam::I_3x3;
+    if (H_twist_c) *H_twist_c = -ad_S * q_dot;
+    if (H_q) *H_q = -ad_S * transformed;
+    if (H_q_dot) *H_q_dot = ad_twist_S;
+    if (H_q_ddot) *H_q_ddot = S;
+    return transformed + S * q_ddot + ad_twist_S * q_dot - accel_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/// Wrench on the parent from the joint plus the wrench on the child,
+/// transformed to the parent frame.
+class PlanarWrenchEquivalenceFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Vector3, gtsam::Vector3, double> {
+ private:
+  using This = PlanarWrenchEquivalenceFactor;
+  using Base =
+      gtsam::NoiseModelFactor3<gtsam::Vector3, gtsam::Vector3, double>;
+
+  PlanarRobot::PlanarJoint joint_;
+
+ public:
+  PlanarWrenchEquivalenceFactor(const gtsam::SharedNoiseModel &cost_model,
+                                const PlanarRobot::PlanarJoint &joint, int t)
+      : Base(cost_model,
+             WrenchKey(joint.joint->parent()->id(), joint.joint->id(), t),
+             WrenchKey(joint.joint->child()->id(), joint.joint->id(), t),
+             JointAngleKey(joint.joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &wrench_p, const gtsam::Vector3 &wrench_c,
+      const double &q,
+      boost::optional<gtsam::Matrix &> H_wrench_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_wrench_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    const gtsam::Matrix3 AdT =
+        joint_.parentTchild(q).inverse().AdjointMap().transpose();
+    if (H_wrench_p) *H_wrench_p = gtsam::I_3x3;
+    if (H_wrench_c) *H_wrench_c = AdT;
+    if (H_q) {
+      *H_q = -AdT * gtsam::Pose2::adjointMap(joint_.screw).transpose() *
+             wrench_c;
+    }
+    return wrench_p + AdT * wrench_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/// Joint torque from the wrench on the child, minus the torque.
+class PlanarTorqueFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Vector3, double> {
+ private:
+  using This = PlanarTorqueFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Vector3, double>;
+
+  PlanarRobot::PlanarJoint joint_;
+
+ public:
+  PlanarTorqueFactor(const gtsam::SharedNoiseModel &cost_model,
+                     const PlanarRobot::PlanarJoint &joint, int t)
+      : Base(cost_model,
+             WrenchKey(joint.joint->child()->id(), joint.joint->id(), t),
+             TorqueKey(joint.joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &wrench, const double &torque,
+      boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none) const override {
+    if (H_wrench) *H_wrench = joint_.screw.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(joint_.screw.dot(wrench) - torque);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/**
+ * Wrench balance of a link, as WrenchFactor: the Coriolis wrench, minus the
+ * change in momentum, plus the wrenches on the link and the gravity wrench,
+ * is zero. Keys are the twist, the twist acceleration, the pose if there is
+ * gravity, and the wrenches.
+ */
+class PlanarWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = PlanarWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix3 inertia_;
+  boost::optional<gtsam::Vector2> gravity_;
+
+  static gtsam::KeyVector Keys(uint16_t id,
+                               const std::vector<DynamicsSymbol> &wrench_keys,
+                               int t, bool gravity) {
+    gtsam::KeyVector keys{TwistKey(id, t), TwistAccelKey(id, t)};
+    if (gravity) keys.push_back(PoseKey(id, t));
+    keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+    return keys;
+  }
+
+ public:
+  /**
+   * @param cost_model  3-dimensional noise model
+   * @param link        the link
+   * @param wrench_keys keys of the wrenches on the link
+   * @param t           time step
+   * @param gravity     gravity in the plane frame, see
+   * PlanarRobot::planarGravity
+   */
+  PlanarWrenchFactor(const gtsam::SharedNoiseModel &cost_model,
+                     const PlanarRobot::PlanarLink &link,
+                     const std::vector<DynamicsSymbol> &wrench_keys, int t,
+                     const boost::optional<gtsam::Vector2> &gravity =
+                         boost::none)
+      : Base(cost_model, Keys(link.link->id(), wrench_keys, t,
+                               gravity.is_initialized())),
+        inertia_(link.inertia),
+        gravity_(gravity) {}
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    const gtsam::Vector3 twist = x.at<gtsam::Vector3>(keys_[0]),
+                         accel = x.at<gtsam::Vector3>(keys_[1]);
+    const gtsam::Vector3 momentum = inertia_ * twist;
+    gtsam::Vector3 error =
+        gtsam::Pose2::adjointMap(twist).transpose() * momentum -
+        inertia_ * accel;
+    const size_t first_wrench = gravity_ ? 3 : 2;
+    for (size_t i = first_wrench; i < size(); i++) {
+      error += x.at<gtsam::Vector3>(keys_[i]);
+    }
+
+    // Gravity in the planar frame: mass * R(theta)^T g.
+    gtsam::Vector3 gravity_H_theta = gtsam::Vector3::Zero();
+    if (gravity_) {
+      const double theta = x.at<gtsam::Pose2>(keys_[2]).theta(),
+                   c = std::cos(theta), s = std::sin(theta),
+                   m = inertia_(0, 0), gx = (*gravity_)(0),
+                   gy = (*gravity_)(1);
+      error += m * gtsam::Vector3(c * gx + s * gy, -s * gx + c * gy, 0);
+      gravity_H_theta << m * (-s * gx + c * gy), m * (-c * gx - s * gy), 0;
+    }
+
+    if (H) {
+      H->assign(size(), gtsam::I_3x3);
+      // Derivative of ad(V)^T * G * V, see Pose2::adjointMap.
+      gtsam::Matrix3 coriolis_H_twist;
+      coriolis_H_twist << 0, 0, momentum(1),  //
+          0, 0, -momentum(0),                 //
+          -momentum(1), momentum(0), 0;
+      (*H)[0] = coriolis_H_twist +
+                gtsam::Pose2::adjointMap(twist).transpose() * inertia_;
+      (*H)[1] = -inertia_;
+      if (gravity_) {
+        (*H)[2] = gtsam::Matrix3::Zero();
+        (*H)[2].col(2) = gravity_H_theta;
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "planar wrench factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -14,7 +14,9 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
@@ -30,6 +32,59 @@ namespace gtdynamics {
 
 using boost::assign::cref_list_of;
 
+/**
+ * AnalyticPoseFactor has the same error as PoseFactor,
+ * Logmap(wTc^-1 * wTp * pTc(q)), but is a fixed-size factor that evaluates
+ * the Jacobians in closed form instead of through an expression tree. The
+ * joint kinematics are specialized for the joint class JOINT, see
+ * JointKernels.h.
+ */
+template <class JOINT = Joint>
+class AnalyticPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double> {
+ private:
+  using This = AnalyticPoseFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * @param wTp_key    Key for parent link's CoM pose in world frame.
+   * @param wTc_key    Key for child link's CoM pose in world frame.
+   * @param q_key      Key for joint value.
+   * @param cost_model The noise model for this factor.
+   * @param joint      The joint connecting the two poses.
+   */
+  AnalyticPoseFactor(gtsam::Key wTp_key, gtsam::Key wTc_key, gtsam::Key q_key,
+                     const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                     const JointConstSharedPtr &joint)
+      : Base(cost_model, wTp_key, wTc_key, q_key), joint_(joint) {}
+
+  virtual ~AnalyticPoseFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTp, const gtsam::Pose3 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix6 H_hat;
+    const gtsam::Pose3 wTc_hat =
+        wTp.compose(ParentTchild<JOINT>(*joint_, q, H_q), H_wTp);
+    const gtsam::Vector6 error =
+        wTc.logmap(wTc_hat, H_wTc, (H_wTp || H_q) ? &H_hat : 0);
+    if (H_wTp) *H_wTp = H_hat * (*H_wTp);
+    if (H_q) *H_q = H_hat * (*H_q);
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
 /**
  * Create single factor relating this link's pose (COM) with previous one.
  * Note: this function is provided for BW compatibility only, and will in time
@@ -44,11 +99,19 @@ using boost::assign::cref_list_of;
  * @param cost_model The noise model for this factor.
  * @param joint The joint connecting the two poses.
  * @param time The timestep at which this factor is defined.
+ * @param analytic Whether to create an AnalyticPoseFactor instead of an
+ * expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     const gtsam::SharedNoiseModel &cost_model, const JointConstSharedPtr &joint,
-    int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+    int time, bool analytic = false) {
+  if (analytic) {
+    return MakeJointTyped<gtsam::NoiseModelFactor, AnalyticPoseFactor>(
+        joint->type(), gtsam::Key(PoseKey(joint->parent()->id(), time)),
+        gtsam::Key(PoseKey(joint->child()->id(), time)),
+        gtsam::Key(JointAngleKey(joint->id(), time)), cost_model, joint);
+  }
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->poseConstraint(time));
 }
 
@@ -62,12 +125,19 @@ inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
  * @param q_key Key for joint value.
  * @param cost_model The noise model for this factor.
  * @param joint The joint connecting the two poses
+ * @param analytic Whether to create an AnalyticPoseFactor instead of an
+ * expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     DynamicsSymbol wTp_key, DynamicsSymbol wTc_key, DynamicsSymbol q_key,
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
-    JointConstSharedPtr joint) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+    JointConstSharedPtr joint, bool analytic = false) {
+  if (analytic) {
+    return MakeJointTyped<gtsam::NoiseModelFactor, AnalyticPoseFactor>(
+        joint->type(), gtsam::Key(wTp_key), gtsam::Key(wTc_key),
+        gtsam::Key(q_key), cost_model, joint);
+  }
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(),
       joint->poseConstraint(wTp_key.time()));
 }
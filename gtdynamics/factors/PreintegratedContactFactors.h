@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -39,7 +40,26 @@ class PreintegratedPointContactMeasurements {
   /// The covariance of the discrete contact noise, aka Σvd in the paper
   gtsam::Matrix3 vdCov_;
 
+  /// Whether Σvd is a multiple of identity, and hence rotation invariant
+  bool isotropic_ = false;
+
+  /// Add dt^2 * R * Σvd * R^T, where R = B / dt.
+  void addRotatedCovariance(const gtsam::Matrix3 &R, double dt) {
+    if (isotropic_) {
+      preintMeasCov_.diagonal().array() += vdCov_(0, 0) * dt * dt;
+    } else {
+      preintMeasCov_.noalias() += (dt * dt) * R * vdCov_ * R.transpose();
+    }
+  }
+
  public:
+  /// A kinematics sample, as given to integrateMeasurement.
+  struct Sample {
+    gtsam::Rot3 deltaRik;
+    gtsam::Pose3 contact_k;
+    double dt;
+  };
+
   PreintegratedPointContactMeasurements() {}
 
   /**
@@ -56,11 +76,10 @@ class PreintegratedPointContactMeasurements {
   PreintegratedPointContactMeasurements(
       const gtsam::Pose3 &base_k, const gtsam::Pose3 &contact_k, double dt,
       const gtsam::Matrix3 &discreteVelocityCovariance)
-      : vdCov_(discreteVelocityCovariance) {
-    // Propagate measurement for the first step, i.e. when k = i.
-    gtsam::Matrix3 B =
-        base_k.rotation().transpose() * contact_k.rotation().matrix() * dt;
-    preintMeasCov_ = B * vdCov_ * B.transpose();
+      : vdCov_(discreteVelocityCovariance),
+        isotropic_(discreteVelocityCovariance.isApprox(
+            discreteVelocityCovariance(0, 0) * gtsam::I_3x3, 0)) {
+    resetIntegration(base_k, contact_k, dt);
   }
 
   /// Virtual destructor for serialization
@@ -76,8 +95,44 @@ class PreintegratedPointContactMeasurements {
    */
   void integrateMeasurement(const gtsam::Rot3 &deltaRik,
                             const gtsam::Pose3 &contact_k, const double dt) {
-    gtsam::Matrix3 B = (deltaRik * contact_k.rotation()).matrix() * dt;
-    preintMeasCov_ = preintMeasCov_ + (B * vdCov_ * B.transpose());
+    addRotatedCovariance(
+        deltaRik.matrix() * contact_k.rotation().matrix(), dt);
+  }
+
+  /**
+   * @brief Add a batch of measurements, as if integrateMeasurement was called
+   * for each sample in order. If Σvd is isotropic, the rotations do not
+   * matter and only the time steps are summed.
+   *
+   * @param samples Contiguous kinematics samples, e.g. from joint encoders.
+   */
+  void integrateMeasurements(const std::vector<Sample> &samples) {
+    if (isotropic_) {
+      double sum_dt2 = 0;
+      for (auto &&sample : samples) sum_dt2 += sample.dt * sample.dt;
+      preintMeasCov_.diagonal().array() += vdCov_(0, 0) * sum_dt2;
+      return;
+    }
+    gtsam::Matrix3 sum = gtsam::Z_3x3;
+    for (auto &&sample : samples) {
+      const gtsam::Matrix3 R =
+          sample.deltaRik.matrix() * sample.contact_k.rotation().matrix();
+      sum.noalias() += (sample.dt * sample.dt) * R * vdCov_ * R.transpose();
+    }
+    preintMeasCov_ += sum;
+  }
+
+  /**
+   * @brief Restart the preintegration at a new initial contact time, e.g.
+   * when streaming measurements in an online estimator, with the same
+   * arguments as the constructor.
+   */
+  void resetIntegration(const gtsam::Pose3 &base_k,
+                        const gtsam::Pose3 &contact_k, double dt) {
+    // Propagate measurement for the first step, i.e. when k = i.
+    preintMeasCov_.setZero();
+    addRotatedCovariance(
+        base_k.rotation().transpose() * contact_k.rotation().matrix(), dt);
   }
 
   gtsam::Matrix3 preintMeasCov() const { return preintMeasCov_; }
@@ -145,26 +200,22 @@ class PreintegratedPointContactFactor
       H << gtsam::SO3::Hat(error), gtsam::Z_3x3;
       *H_wTb_i = H;
     }
+    // The contact translations retract as t <- t + R * δt, so that with the
+    // contact rotation equal to the body rotation, as in the paper, the
+    // Jacobian wrt contact i is [0, -I].
     if (H_wTc_i) {
       gtsam::Matrix36 H;
-      H << gtsam::Z_3x3, -gtsam::I_3x3;
+      H << gtsam::Z_3x3,
+          -(wTb_i.rotation().inverse() * wTc_i.rotation()).matrix();
       *H_wTc_i = H;
     }
     if (H_wTb_j) {
       *H_wTb_j = gtsam::Matrix36::Zero();
     }
     if (H_wTc_j) {
-      // Assert the rotation of the contact frame is the same as the rotation of
-      // the body frame. This will ensure the retraction is d <- d + δR as per
-      // the paper.
-      if (!wTc_i.rotation().equals(wTb_i.rotation()) ||
-          !wTc_j.rotation().equals(wTb_j.rotation())) {
-        throw std::runtime_error(
-            "Body rotation and contact rotation are not equal.");
-      }
       gtsam::Matrix36 H;
       H << gtsam::Z_3x3,
-          (wTc_i.rotation().inverse() * wTc_j.rotation()).matrix();
+          (wTb_i.rotation().inverse() * wTc_j.rotation()).matrix();
       *H_wTc_j = H;
     }
     return error;
@@ -253,6 +304,19 @@ class PreintegratedRigidContactMeasurements {
     preintMeasCov_ *= deltaT;
   }
 
+  /**
+   * @brief Integrate a batch of measurements with constant contact noise, as
+   * if the time varying integrateMeasurement was called for each time step.
+   *
+   * @param dts Time intervals of consecutive measurements.
+   */
+  void integrateMeasurements(const std::vector<double> &dts) {
+    double sum_dt2 = 0;
+    for (const double dt : dts) sum_dt2 += dt * dt;
+    preintMeasCov_.topLeftCorner<3, 3>() += wCov_ * sum_dt2;
+    preintMeasCov_.bottomRightCorner<3, 3>() += vCov_ * sum_dt2;
+  }
+
   gtsam::Matrix6 preintMeasCov() const { return preintMeasCov_; }
 };
 
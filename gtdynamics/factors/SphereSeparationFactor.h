@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SphereSeparationFactor.h
+ * @brief Hinge on the distance between spheres on two links.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <algorithm>
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * SphereSeparationFactor keeps a sphere on one link epsilon away from a
+ * sphere on another, e.g. for self-collision avoidance: with d the distance
+ * between their centers, the error is max(0, r_a + r_b + epsilon - d).
+ */
+class SphereSeparationFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3> {
+ private:
+  using This = SphereSeparationFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3>;
+
+  gtsam::Point3 aPc_, bPc_;
+  double distance_;  // r_a + r_b + epsilon
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param pose_a_key key of the CoM pose of the first link
+   * @param aPc        sphere center in the CoM frame of the first link
+   * @param pose_b_key key of the CoM pose of the second link
+   * @param bPc        sphere center in the CoM frame of the second link
+   * @param distance   minimum distance between the centers, r_a + r_b +
+   *                   epsilon
+   * @param cost_model 1-dimensional noise model
+   */
+  SphereSeparationFactor(gtsam::Key pose_a_key, const gtsam::Point3 &aPc,
+                         gtsam::Key pose_b_key, const gtsam::Point3 &bPc,
+                         double distance,
+                         const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, pose_a_key, pose_b_key),
+        aPc_(aPc),
+        bPc_(bPc),
+        distance_(distance) {}
+  virtual ~SphereSeparationFactor() {}
+
+  /// Minimum distance between the centers.
+  double distance() const { return distance_; }
+
+  /**
+   * Evaluate the separation error.
+   * @param wTa CoM pose of the first link
+   * @param wTb CoM pose of the second link
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTa, const gtsam::Pose3 &wTb,
+      boost::optional<gtsam::Matrix &> H_a = boost::none,
+      boost::optional<gtsam::Matrix &> H_b = boost::none) const override {
+    gtsam::Matrix36 H_pa, H_pb;
+    const gtsam::Point3 p_a = wTa.transformFrom(aPc_, H_a ? &H_pa : 0);
+    const gtsam::Point3 p_b = wTb.transformFrom(bPc_, H_b ? &H_pb : 0);
+    const gtsam::Vector3 d = p_a - p_b;
+    const double norm = d.norm();
+
+    // Inactive, or coincident centers where the direction is undefined.
+    if (norm >= distance_ || norm < 1e-9) {
+      if (H_a) *H_a = gtsam::Matrix16::Zero();
+      if (H_b) *H_b = gtsam::Matrix16::Zero();
+      return (gtsam::Vector(1) << std::max(0.0, distance_ - norm)).finished();
+    }
+
+    const gtsam::Matrix13 H_d = -d.transpose() / norm;
+    if (H_a) *H_a = H_d * H_pa;
+    if (H_b) *H_b = -H_d * H_pb;
+    return (gtsam::Vector(1) << distance_ - norm).finished();
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "sphere separation factor, distance " << distance_
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(aPc_);
+    ar &BOOST_SERIALIZATION_NVP(bPc_);
+    ar &BOOST_SERIALIZATION_NVP(distance_);
+  }
+};
+
+}  // namespace gtdynamics
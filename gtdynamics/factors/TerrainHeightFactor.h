@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TerrainHeightFactor.h
+ * @brief Contact point height on uneven terrain, with a height map.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * TerrainHeightFactor is a unary nonlinear factor that puts a contact point
+ * on a link onto the terrain of a height map, in place of the flat ground of
+ * ContactHeightFactor. With p the contact point in the world frame and h the
+ * terrain height below it, the error is p_z - h(p_x, p_y) - clearance. The
+ * terrain gradient enters the Jacobian, so contacts slide along slopes.
+ */
+class TerrainHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = TerrainHeightFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  std::shared_ptr<const HeightMap> map_;
+  gtsam::Point3 comPc_;
+  HeightMap::Interpolation interpolation_;
+  double clearance_;
+
+ public:
+  /**
+   * Constructor.
+   * @param pose_key      key of the link CoM pose
+   * @param cost_model    1-dimensional noise model
+   * @param map           terrain height map, world z up
+   * @param comPc         contact point in the link CoM frame
+   * @param interpolation interpolation of the height map
+   * @param clearance     height of the contact point above the terrain
+   */
+  TerrainHeightFactor(gtsam::Key pose_key,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const std::shared_ptr<const HeightMap> &map,
+                      const gtsam::Point3 &comPc,
+                      HeightMap::Interpolation interpolation =
+                          HeightMap::Bilinear,
+                      double clearance = 0.0)
+      : Base(cost_model, pose_key),
+        map_(map),
+        comPc_(comPc),
+        interpolation_(interpolation),
+        clearance_(clearance) {}
+
+  virtual ~TerrainHeightFactor() {}
+
+  /// Evaluate the height error, with its derivative w.r.t. the link pose.
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none) const override {
+    gtsam::Matrix36 H_point;
+    const gtsam::Point3 sPc =
+        pose.transformFrom(comPc_, H_pose ? &H_point : nullptr);
+    gtsam::Matrix12 H_height;
+    const double h = map_->height(sPc.head<2>(), H_pose ? &H_height : nullptr,
+                                  interpolation_);
+    if (H_pose) {
+      const gtsam::Matrix13 H_error(-H_height(0), -H_height(1), 1.0);
+      *H_pose = H_error * H_point;
+    }
+    return gtsam::Vector1(sPc.z() - h - clearance_);
+  }
+
+  /// The height map.
+  const std::shared_ptr<const HeightMap> &map() const { return map_; }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "TerrainHeightFactor, comPc "
+              << comPc_.transpose() << ", clearance " << clearance_
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
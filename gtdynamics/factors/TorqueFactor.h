@@ -15,6 +15,7 @@
 
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -32,6 +33,48 @@ namespace gtdynamics {
  * wrench and torque on each link
  */
 
+/**
+ * AnalyticTorqueFactor has the same error as TorqueFactor, S^T * F_c - tau,
+ * as a fixed-size factor with closed-form Jacobians.
+ */
+class AnalyticTorqueFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Vector6, double> {
+ private:
+  using This = AnalyticTorqueFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Vector6, double>;
+
+  gtsam::Vector6 screw_axis_;  // of the joint, in the child link frame
+
+ public:
+  /**
+   * @param cost_model The noise model for this factor.
+   * @param joint      The joint.
+   * @param k          The timestep at which this factor is defined.
+   */
+  AnalyticTorqueFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                       const JointConstSharedPtr &joint, size_t k)
+      : Base(cost_model, WrenchKey(joint->child()->id(), joint->id(), k),
+             TorqueKey(joint->id(), k)),
+        screw_axis_(joint->screwAxis(joint->child())) {}
+
+  virtual ~AnalyticTorqueFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench, const double &torque,
+      boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none) const override {
+    if (H_wrench) *H_wrench = screw_axis_.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(screw_axis_.dot(wrench) - torque);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
 /**
  * Torque factor, common between forward and inverse dynamics.
  * Will create factor corresponding to Lynch & Park book:
@@ -40,11 +83,16 @@ namespace gtdynamics {
  *  screw_axis.transpose() * F.transpose() == torque
  *
  * @param joint JointConstSharedPtr to the joint
+ * @param analytic Whether to create an AnalyticTorqueFactor instead of an
+ * expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr TorqueFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
-    const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<double>>(
+    const JointConstSharedPtr &joint, size_t k = 0, bool analytic = false) {
+  if (analytic) {
+    return MakeShared<AnalyticTorqueFactor>(cost_model, joint, k);
+  }
+  return MakeShared<gtsam::ExpressionFactor<double>>(
       cost_model, 0.0, joint->torqueConstraint(k));
 }
 
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -32,6 +34,78 @@ namespace gtdynamics {
  * between acceleration on previous link and this link.
  */
 
+/**
+ * AnalyticTwistAccelFactor has the same error as TwistAccelFactor,
+ * Ad(cTp(q)) * A_p + ad(V_c) * S * q_dot + S * q_ddot - A_c, as a fixed-size
+ * factor with closed-form Jacobians. The joint kinematics are specialized for
+ * the joint class JOINT, see JointKernels.h.
+ */
+template <class JOINT = Joint>
+class AnalyticTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                      gtsam::Vector6, double, double, double> {
+ private:
+  using This = AnalyticTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                        gtsam::Vector6, double, double, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * @param cost_model The noise model for this factor.
+   * @param joint      The joint connecting the two links.
+   * @param time       The timestep at which this factor is defined.
+   */
+  AnalyticTwistAccelFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const JointConstSharedPtr &joint, int time)
+      : Base(cost_model, TwistKey(joint->child()->id(), time),
+             TwistAccelKey(joint->parent()->id(), time),
+             TwistAccelKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time),
+             JointAccelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  virtual ~AnalyticTwistAccelFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_c, const gtsam::Vector6 &twist_accel_p,
+      const gtsam::Vector6 &twist_accel_c, const double &q,
+      const double &q_dot, const double &q_ddot,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_ddot = boost::none) const override {
+    const gtsam::Vector6 S = joint_->screwAxis(joint_->child());
+    gtsam::Matrix61 cTp_H_q;
+    gtsam::Matrix6 accel_H_cTp, accel_H_accel_p, accel_H_twist_c;
+    const gtsam::Pose3 cTp =
+        ChildTparent<JOINT>(*joint_, q, H_q ? &cTp_H_q : nullptr);
+    const gtsam::Vector6 error =
+        cTp.Adjoint(twist_accel_p, H_q ? &accel_H_cTp : nullptr,
+                    H_twist_accel_p ? &accel_H_accel_p : nullptr) +
+        gtsam::Pose3::adjoint(twist_c, S * q_dot,
+                              H_twist_c ? &accel_H_twist_c : nullptr) +
+        S * q_ddot - twist_accel_c;
+    if (H_twist_c) *H_twist_c = accel_H_twist_c;
+    if (H_twist_accel_p) *H_twist_accel_p = accel_H_accel_p;
+    if (H_twist_accel_c) *H_twist_accel_c = -gtsam::I_6x6;
+    if (H_q) *H_q = accel_H_cTp * cTp_H_q;
+    if (H_q_dot) *H_q_dot = gtsam::Pose3::adjointMap(twist_c) * S;
+    if (H_q_ddot) *H_q_ddot = S;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
 /**
  * Factor linking child link's twist_accel, joint_coordinate, joint_vel,
  * joint_accel with previous link's twist_accel.
@@ -40,11 +114,17 @@ namespace gtdynamics {
  * Equation 8.47, page 293
  *
  * @param joint JointConstSharedPtr to the joint
+ * @param analytic Whether to create an AnalyticTwistAccelFactor instead of an
+ * expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr TwistAccelFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
-    JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+    JointConstSharedPtr joint, int time, bool analytic = false) {
+  if (analytic) {
+    return MakeJointTyped<gtsam::NoiseModelFactor, AnalyticTwistAccelFactor>(
+        joint->type(), cost_model, joint, time);
+  }
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->twistAccelConstraint(time));
 }
 
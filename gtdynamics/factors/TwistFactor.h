@@ -14,6 +14,8 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -30,17 +32,82 @@ namespace gtdynamics {
  * between twist on previous link and this link
  */
 
+/**
+ * AnalyticTwistFactor has the same error as TwistFactor, the child twist
+ * predicted from the parent twist and joint velocity minus the child twist,
+ * as a fixed-size factor with closed-form Jacobians. The joint kinematics are
+ * specialized for the joint class JOINT, see JointKernels.h.
+ */
+template <class JOINT = Joint>
+class AnalyticTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6, double,
+                                      double> {
+ private:
+  using This = AnalyticTwistFactor;
+  using Base =
+      gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6, double, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * @param cost_model The noise model for this factor.
+   * @param joint      The joint connecting the two links.
+   * @param time       The timestep at which this factor is defined.
+   */
+  AnalyticTwistFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const JointConstSharedPtr &joint, int time)
+      : Base(cost_model, TwistKey(joint->parent()->id(), time),
+             TwistKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  virtual ~AnalyticTwistFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_p, const gtsam::Vector6 &twist_c,
+      const double &q, const double &q_dot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none) const override {
+    gtsam::Matrix61 twist_H_q, twist_H_q_dot;
+    gtsam::Matrix6 twist_H_twist_p;
+    const gtsam::Vector6 twist_c_hat = TransformTwistTo<JOINT>(
+        *joint_, joint_->child(), q, q_dot, twist_p, H_q ? &twist_H_q : nullptr,
+        H_q_dot ? &twist_H_q_dot : nullptr,
+        H_twist_p ? &twist_H_twist_p : nullptr);
+    if (H_twist_p) *H_twist_p = twist_H_twist_p;
+    if (H_twist_c) *H_twist_c = -gtsam::I_6x6;
+    if (H_q) *H_q = twist_H_q;
+    if (H_q_dot) *H_q_dot = twist_H_q_dot;
+    return twist_c_hat - twist_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
 /**
  * Create single factor relating child link's twist with parent one.
  * Will create factor corresponding to Lynch & Park book:
  *  Equation 8.45, page 292
  *
  * @param joint a Joint
+ * @param analytic Whether to create an AnalyticTwistFactor instead of an
+ * expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr TwistFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
-    JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+    JointConstSharedPtr joint, int time, bool analytic = false) {
+  if (analytic) {
+    return MakeJointTyped<gtsam::NoiseModelFactor, AnalyticTwistFactor>(
+        joint->type(), cost_model, joint, time);
+  }
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->twistConstraint(time));
 }
 
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -33,14 +35,77 @@ namespace gtdynamics {
 /** WrenchEquivalenceFactor is a 3-way nonlinear factor which enforces
  * relation between wrench expressed in two link frames*/
 
+/**
+ * AnalyticWrenchEquivalenceFactor has the same error as
+ * WrenchEquivalenceFactor, F_p + Ad(cTp(q))^T * F_c, as a fixed-size factor
+ * with closed-form Jacobians. The joint kinematics are specialized for the
+ * joint class JOINT, see JointKernels.h.
+ */
+template <class JOINT = Joint>
+class AnalyticWrenchEquivalenceFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Vector6, gtsam::Vector6, double> {
+ private:
+  using This = AnalyticWrenchEquivalenceFactor;
+  using Base =
+      gtsam::NoiseModelFactor3<gtsam::Vector6, gtsam::Vector6, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * @param cost_model The noise model for this factor.
+   * @param joint      The joint connecting the two links.
+   * @param k          The timestep at which this factor is defined.
+   */
+  AnalyticWrenchEquivalenceFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const JointConstSharedPtr &joint, size_t k)
+      : Base(cost_model, WrenchKey(joint->parent()->id(), joint->id(), k),
+             WrenchKey(joint->child()->id(), joint->id(), k),
+             JointAngleKey(joint->id(), k)),
+        joint_(joint) {}
+
+  virtual ~AnalyticWrenchEquivalenceFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench_p, const gtsam::Vector6 &wrench_c,
+      const double &q,
+      boost::optional<gtsam::Matrix &> H_wrench_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_wrench_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix61 wrench_H_q;
+    gtsam::Matrix6 wrench_H_wrench_c;
+    const gtsam::Vector6 wrench_c_hat = TransformWrenchCoordinate<JOINT>(
+        *joint_, joint_->child(), q, wrench_c, H_q ? &wrench_H_q : nullptr,
+        H_wrench_c ? &wrench_H_wrench_c : nullptr);
+    if (H_wrench_p) *H_wrench_p = gtsam::I_6x6;
+    if (H_wrench_c) *H_wrench_c = wrench_H_wrench_c;
+    if (H_q) *H_q = wrench_H_q;
+    return wrench_p + wrench_c_hat;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
 /**
  * Wrench eq factor, enforce same wrench expressed in different link frames.
  * @param joint JointConstSharedPtr to the joint
+ * @param analytic Whether to create an AnalyticWrenchEquivalenceFactor
+ * instead of an expression factor.
  */
 inline gtsam::NoiseModelFactor::shared_ptr WrenchEquivalenceFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
-    const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+    const JointConstSharedPtr &joint, size_t k = 0, bool analytic = false) {
+  if (analytic) {
+    return MakeJointTyped<gtsam::NoiseModelFactor,
+                          AnalyticWrenchEquivalenceFactor>(
+        joint->type(), cost_model, joint, k);
+  }
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(),
       joint->wrenchEquivalenceConstraint(k));
 }
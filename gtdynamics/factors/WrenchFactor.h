@@ -13,9 +13,12 @@
 
 #pragma once
 
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -26,6 +29,8 @@
 
 #include <boost/optional.hpp>
 #include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -36,19 +41,127 @@ namespace gtdynamics {
  * between wrenches on this link
  */
 
+/**
+ * FixedWrenchFactor has the same error as WrenchFactor, the Coriolis wrench,
+ * minus the change in momentum, plus the K wrenches on the link and the
+ * gravity wrench, for a link with exactly K wrenches, with closed-form
+ * Jacobians computed in fixed-size blocks. Keys are the twist, the twist
+ * acceleration, the K wrenches, and the pose if there is gravity.
+ */
+template <size_t K>
+class FixedWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = FixedWrenchFactor<K>;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix6 inertia_;
+  double mass_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  static gtsam::KeyVector Keys(uint16_t id,
+                               const std::vector<DynamicsSymbol> &wrench_keys,
+                               int t, bool gravity) {
+    if (wrench_keys.size() != K) {
+      throw std::invalid_argument(
+          "FixedWrenchFactor: wrong number of wrench keys");
+    }
+    gtsam::KeyVector keys{TwistKey(id, t), TwistAccelKey(id, t)};
+    keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+    if (gravity) keys.push_back(PoseKey(id, t));
+    return keys;
+  }
+
+ public:
+  /**
+   * @param cost_model  6-dimensional noise model
+   * @param link        the link
+   * @param wrench_keys keys of the K wrenches on the link
+   * @param t           time step
+   * @param gravity     (optional) gravity in the world frame
+   */
+  FixedWrenchFactor(const gtsam::SharedNoiseModel &cost_model,
+                    const LinkConstSharedPtr &link,
+                    const std::vector<DynamicsSymbol> &wrench_keys, int t,
+                    const boost::optional<gtsam::Vector3> &gravity =
+                        boost::none)
+      : Base(cost_model,
+             Keys(link->id(), wrench_keys, t, gravity.is_initialized())),
+        inertia_(link->inertiaMatrix()),
+        mass_(link->mass()),
+        gravity_(gravity) {}
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    gtsam::Matrix6 H_twist, H_pose;
+    gtsam::Vector6 error =
+        Coriolis(inertia_, x.at<gtsam::Vector6>(keys_[0]),
+                 H ? &H_twist : nullptr) -
+        inertia_ * x.at<gtsam::Vector6>(keys_[1]);
+    for (size_t i = 0; i < K; i++) {
+      error += x.at<gtsam::Vector6>(keys_[2 + i]);
+    }
+    if (gravity_) {
+      error += GravityWrench(*gravity_, mass_,
+                             x.at<gtsam::Pose3>(keys_[2 + K]),
+                             H ? &H_pose : nullptr);
+    }
+
+    if (H) {
+      H->resize(size());
+      (*H)[0] = H_twist;
+      (*H)[1] = -inertia_;
+      for (size_t i = 0; i < K; i++) (*H)[2 + i] = gtsam::I_6x6;
+      if (gravity_) (*H)[2 + K] = H_pose;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "wrench factor with " << K << " wrenches" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
 /**
  * Wrench balance factor, common between forward and inverse dynamics.
  * Will create factor corresponding to Lynch & Park book:
  *  wrench balance, Equation 8.48, page 293
+ * Links with 1 to 4 wrenches, i.e., nearly all links, get a
+ * FixedWrenchFactor, others an expression factor.
  * @param gravity (optional) Create gravity wrench in link COM frame.
  */
 inline gtsam::NoiseModelFactor::shared_ptr WrenchFactor(
     const gtsam::SharedNoiseModel &cost_model, const LinkConstSharedPtr &link,
     const std::vector<DynamicsSymbol> &wrench_keys, int time,
     const boost::optional<gtsam::Vector3> &gravity = boost::none) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(),
-      link->wrenchConstraint(wrench_keys, time, gravity));
+  switch (wrench_keys.size()) {
+    case 1:
+      return MakeShared<FixedWrenchFactor<1>>(cost_model, link, wrench_keys,
+                                              time, gravity);
+    case 2:
+      return MakeShared<FixedWrenchFactor<2>>(cost_model, link, wrench_keys,
+                                              time, gravity);
+    case 3:
+      return MakeShared<FixedWrenchFactor<3>>(cost_model, link, wrench_keys,
+                                              time, gravity);
+    case 4:
+      return MakeShared<FixedWrenchFactor<4>>(cost_model, link, wrench_keys,
+                                              time, gravity);
+    default:
+      return MakeShared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+          cost_model, gtsam::Vector6::Zero(),
+          link->wrenchConstraint(wrench_keys, time, gravity));
+  }
 }
 
 }  // namespace gtdynamics
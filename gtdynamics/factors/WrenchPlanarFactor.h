@@ -16,6 +16,7 @@
 #include <gtdynamics/dynamics/Dynamics.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/GraphArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
@@ -63,7 +64,7 @@ inline gtsam::NoiseModelFactor::shared_ptr WrenchPlanarFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     gtsam::Vector3 planar_axis, const JointConstSharedPtr &joint,
     size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector3>>(
+  return MakeShared<gtsam::ExpressionFactor<gtsam::Vector3>>(
       cost_model, gtsam::Vector3::Zero(),
       WrenchPlanarConstraint(planar_axis, joint, k));
 }
@@ -17,71 +17,204 @@
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/expressions.h>
 
 #include <boost/optional.hpp>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
 /** Function for creating expressions. */
-double multDouble1(const double& d1, const double& d2,
-                   gtsam::OptionalJacobian<1, 1> H1,
-                   gtsam::OptionalJacobian<1, 1> H2) {
+inline double multDouble1(const double& d1, const double& d2,
+                          gtsam::OptionalJacobian<1, 1> H1,
+                          gtsam::OptionalJacobian<1, 1> H2) {
   if (H1) *H1 = gtsam::I_1x1 * d2;
   if (H2) *H2 = gtsam::I_1x1 * d1;
   return d1 * d2;
 }
 
+/**
+ * SourceMassCollocationFactor integrates the mass of the source tank over a
+ * time step, from the mass flow rates into all actuators:
+ *    Euler:       m_curr = m_prev - dt * sum(mdot_prev)
+ *    Trapezoidal: m_curr = m_prev - dt/2 * sum(mdot_prev + mdot_curr)
+ * Its error and Jacobians are closed-form, instead of an expression tree with
+ * a product per mass flow rate.
+ *
+ * Keys are m_prev, m_curr, dt, the previous rates, then the current rates
+ * for trapezoidal collocation.
+ */
+class SourceMassCollocationFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = SourceMassCollocationFactor;
+  using Base = gtsam::NoiseModelFactor;
+  size_t num_rates_;
+  bool euler_;
+
+  static gtsam::KeyVector CollocationKeys(
+      const gtsam::KeyVector& mdot_prev_keys,
+      const gtsam::KeyVector& mdot_curr_keys, gtsam::Key source_mass_key_prev,
+      gtsam::Key source_mass_key_curr, gtsam::Key dt_key, bool euler) {
+    if (mdot_prev_keys.size() != mdot_curr_keys.size()) {
+      throw std::invalid_argument(
+          "SourceMassCollocationFactor: previous and current mass flow rates "
+          "differ in number");
+    }
+    gtsam::KeyVector keys{source_mass_key_prev, source_mass_key_curr, dt_key};
+    keys.insert(keys.end(), mdot_prev_keys.begin(), mdot_prev_keys.end());
+    if (!euler) {
+      keys.insert(keys.end(), mdot_curr_keys.begin(), mdot_curr_keys.end());
+    }
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param mdot_prev_keys mass flow rates of the actuators at the previous step
+   * @param mdot_curr_keys mass flow rates of the actuators at the current step
+   * @param source_mass_key_prev source tank mass at the previous step
+   * @param source_mass_key_curr source tank mass at the current step
+   * @param dt_key duration of the step
+   * @param euler Euler instead of trapezoidal collocation
+   * @param cost_model 1-dimensional noise model
+   */
+  SourceMassCollocationFactor(
+      const gtsam::KeyVector& mdot_prev_keys,
+      const gtsam::KeyVector& mdot_curr_keys, gtsam::Key source_mass_key_prev,
+      gtsam::Key source_mass_key_curr, gtsam::Key dt_key, bool euler,
+      const gtsam::noiseModel::Base::shared_ptr& cost_model)
+      : Base(cost_model,
+             CollocationKeys(mdot_prev_keys, mdot_curr_keys,
+                             source_mass_key_prev, source_mass_key_curr,
+                             dt_key, euler)),
+        num_rates_(mdot_prev_keys.size()),
+        euler_(euler) {}
+
+  virtual ~SourceMassCollocationFactor() {}
+
+  gtsam::Vector unwhitenedError(const gtsam::Values& x,
+                                boost::optional<std::vector<gtsam::Matrix>&>
+                                    H = boost::none) const override {
+    const double m_prev = x.at<double>(keys_[0]);
+    const double m_curr = x.at<double>(keys_[1]);
+    const double dt = x.at<double>(keys_[2]);
+    const double weight = euler_ ? 1.0 : 0.5;
+    double rate = 0;
+    for (size_t i = 3; i < size(); i++) rate += x.at<double>(keys_[i]);
+    rate *= weight;
+
+    if (H) {
+      H->resize(size());
+      (*H)[0] = gtsam::I_1x1;
+      (*H)[1] = -gtsam::I_1x1;
+      (*H)[2] = gtsam::Matrix1(-rate);
+      for (size_t i = 3; i < size(); i++) {
+        (*H)[i] = gtsam::Matrix1(-weight * dt);
+      }
+    }
+    return gtsam::Vector1(m_prev - dt * rate - m_curr);
+  }
+
+  /// Number of mass flow rates per step, i.e. of actuators.
+  size_t numRates() const { return num_rates_; }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string& s = "",
+             const gtsam::KeyFormatter& keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "source mass collocation factor ("
+              << (euler_ ? "Euler" : "trapezoidal") << ")" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE& ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &num_rates_;
+    ar &euler_;
+  }
+};
+
+/** TimeCollocationFactor: t_curr = t_prev + dt */
+class TimeCollocationFactor
+    : public gtsam::NoiseModelFactor3<double, double, double> {
+ private:
+  using This = TimeCollocationFactor;
+  using Base = gtsam::NoiseModelFactor3<double, double, double>;
+
+ public:
+  TimeCollocationFactor(gtsam::Key t_prev_key, gtsam::Key t_curr_key,
+                        gtsam::Key dt_key,
+                        const gtsam::noiseModel::Base::shared_ptr& cost_model)
+      : Base(cost_model, t_prev_key, t_curr_key, dt_key) {}
+
+  virtual ~TimeCollocationFactor() {}
+
+  gtsam::Vector evaluateError(
+      const double& t_prev, const double& t_curr, const double& dt,
+      boost::optional<gtsam::Matrix&> H_t_prev = boost::none,
+      boost::optional<gtsam::Matrix&> H_t_curr = boost::none,
+      boost::optional<gtsam::Matrix&> H_dt = boost::none) const override {
+    if (H_t_prev) *H_t_prev = gtsam::I_1x1;
+    if (H_t_curr) *H_t_curr = -gtsam::I_1x1;
+    if (H_dt) *H_dt = gtsam::I_1x1;
+    return gtsam::Vector1(t_prev + dt - t_curr);
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string& s = "",
+             const gtsam::KeyFormatter& keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "time collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE& ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor3", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 /** Add mass collocation factors for source tank. */
-void AddSourceMassCollocationFactor(
+inline void AddSourceMassCollocationFactor(
     gtsam::NonlinearFactorGraph* graph, const gtsam::KeyVector& mdot_prev_keys,
     const gtsam::KeyVector& mdot_curr_keys, gtsam::Key source_mass_key_prev,
     gtsam::Key source_mass_key_curr, gtsam::Key dt_key, bool isEuler,
     const gtsam::noiseModel::Base::shared_ptr& cost_model) {
-  gtsam::Double_ expr0(source_mass_key_prev);
-  gtsam::Double_ expr1(source_mass_key_curr);
-  gtsam::Double_ expr_dt(dt_key);
-  std::vector<gtsam::Double_> mdot0dt_vec;
-  std::vector<gtsam::Double_> mdot1dt_vec;
-  mdot0dt_vec.reserve(mdot_prev_keys.size());
-  mdot1dt_vec.reserve(mdot_curr_keys.size());
-  for (int idx = 0; idx < mdot_prev_keys.size(); idx++) {
-    gtsam::Double_ mdot_prev(mdot_prev_keys[idx]);
-    gtsam::Double_ mdot_curr(mdot_curr_keys[idx]);
-    mdot0dt_vec.push_back(gtsam::Double_(multDouble1, expr_dt, mdot_prev));
-    mdot1dt_vec.push_back(gtsam::Double_(multDouble1, expr_dt, mdot_curr));
-  }
-
-  if (isEuler) {
-    graph->add(gtsam::ExpressionFactor(cost_model, 0.0,
-                                       expr0 - mdot0dt_vec[0] - mdot0dt_vec[1] -
-                                           mdot0dt_vec[2] - mdot0dt_vec[3] -
-                                           expr1));
-  } else {
-    graph->add(gtsam::ExpressionFactor(
-        cost_model, 0.0,
-        expr0 - 0.5 * mdot1dt_vec[0] - 0.5 * mdot1dt_vec[1] -
-            0.5 * mdot1dt_vec[2] - 0.5 * mdot1dt_vec[3] - 0.5 * mdot1dt_vec[0] -
-            0.5 * mdot1dt_vec[1] - 0.5 * mdot1dt_vec[2] - 0.5 * mdot1dt_vec[3] -
-            expr1));
-  }
+  graph->emplace_shared<SourceMassCollocationFactor>(
+      mdot_prev_keys, mdot_curr_keys, source_mass_key_prev,
+      source_mass_key_curr, dt_key, isEuler, cost_model);
 }
 
 /** Add collocation factors for time.
  * t_curr = t_prev + dt
  */
-void AddTimeCollocationFactor(
+inline void AddTimeCollocationFactor(
     gtsam::NonlinearFactorGraph* graph, gtsam::Key t_prev_key,
     gtsam::Key t_curr_key, gtsam::Key dt_key,
     const gtsam::noiseModel::Base::shared_ptr& cost_model) {
-  gtsam::Double_ t_curr_expr(t_curr_key);
-  gtsam::Double_ t_prev_expr(t_prev_key);
-  gtsam::Double_ dt_expr(dt_key);
-  gtsam::Double_ expr = t_curr_expr + dt_expr - t_prev_expr;
-  graph->add(gtsam::ExpressionFactor(cost_model, 0.0, expr));
+  graph->emplace_shared<TimeCollocationFactor>(t_prev_key, t_curr_key, dt_key,
+                                               cost_model);
 }
 
 }  // namespace gtdynamics
@@ -19,6 +19,7 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/optional.hpp>
+#include <cmath>
 #include <iostream>
 #include <string>
 
@@ -550,4 +551,152 @@ class ActuatorVolumeFactor : public gtsam::NoiseModelFactor2<double, double> {
   }
 };
 
+/** State of a pneumatic actuator, see PneumaticActuatorModel. */
+struct PneumaticActuatorState {
+  double pressure;     // in kPa
+  double volume;
+  double contraction;  // in cm
+  double force;
+  double torque;
+};
+
+/** PneumaticActuatorModel evaluates the relations of GasLawFactor,
+ * ActuatorVolumeFactor, SmoothActuatorFactor, ForceBalanceFactor and
+ * JointTorqueFactor directly, to simulate an actuator without solving a
+ * graph. Given the air mass and the joint angle, the contraction is the root
+ * of the force balance, which decreases monotonically with the contraction;
+ * it is found by a safeguarded Newton iteration in that one variable, and
+ * pressure, volume, force and torque follow in closed form. */
+class PneumaticActuatorModel {
+ private:
+  double c_, k_, sign_r_, q_rest_;
+  ActuatorVolumeFactor volume_factor_;
+  SmoothActuatorFactor actuator_factor_;
+  ForceBalanceFactor balance_factor_;
+  JointTorqueFactor torque_factor_;
+
+  /** Force of the actuator minus the force balance at contraction delta_x.
+   * Fills in the state but the torque, the derivatives of the residual by
+   * contraction and pressure, and the derivative of the volume. */
+  double residual(double m, double q, double delta_x,
+                  PneumaticActuatorState *state, double *g_delta_x,
+                  double *g_p, double *v_delta_x) const {
+    gtsam::Matrix H_l, H_delta_x, H_p;
+    state->contraction = delta_x;
+    state->volume = volume_factor_.computeVolume(delta_x, H_l);
+    state->pressure = c_ * m / (1e3 * state->volume);
+    state->force = balance_factor_.evaluateError(delta_x, q, 0)(0);
+    const double f_actuator =
+        actuator_factor_.evaluateError(delta_x, state->pressure, 0,
+                                       H_delta_x, H_p)(0);
+    *v_delta_x = H_l(0, 0);
+    *g_p = H_p(0, 0);
+    *g_delta_x = H_delta_x(0, 0) -
+                 *g_p * state->pressure / state->volume * *v_delta_x -
+                 0.01 * k_;
+    return f_actuator - state->force;
+  }
+
+ public:
+  /** Create the model of an actuator, with the parameters of its factors.
+   *
+   Keyword arguments:
+     gas_constant -- Rs * T, as in GasLawFactor
+     d_tube       -- tube diameter, as in ActuatorVolumeFactor
+     l_tube       -- tube length, as in ActuatorVolumeFactor
+     k            -- tendon stiffness, as in ForceBalanceFactor
+     r            -- pulley radius
+     q_rest       -- joint angle at rest, as in ForceBalanceFactor
+     q_limit      -- spring engagement angle, as in JointTorqueFactor
+     ka           -- antagonistic spring stiffness, as in JointTorqueFactor
+     b            -- damping coefficient, as in JointTorqueFactor
+     positive     -- whether contraction increases the joint angle
+   */
+  PneumaticActuatorModel(double gas_constant, double d_tube, double l_tube,
+                         double k, double r, double q_rest, double q_limit,
+                         double ka, double b, bool positive = false)
+      : c_(gas_constant),
+        k_(k),
+        sign_r_(positive ? r : -r),
+        q_rest_(q_rest),
+        volume_factor_(0, 1, gtsam::noiseModel::Unit::Create(1), d_tube,
+                       l_tube),
+        actuator_factor_(0, 1, 2, gtsam::noiseModel::Unit::Create(1)),
+        balance_factor_(0, 1, 2, gtsam::noiseModel::Unit::Create(1), k, r,
+                        q_rest, positive),
+        torque_factor_(0, 1, 2, 3, gtsam::noiseModel::Unit::Create(1),
+                       q_limit, ka, r, b, positive) {}
+
+  /** Compute the actuator state.
+      Keyword argument:
+          m           -- air mass in the actuator
+          q           -- joint angle, in rad
+          v           -- joint velocity
+          H           -- 5x3 derivative of pressure, volume, contraction,
+                         force and torque by m, q and v
+  */
+  PneumaticActuatorState forward(
+      double m, double q, double v,
+      boost::optional<gtsam::Matrix &> H = boost::none) const {
+    PneumaticActuatorState state;
+    double g_delta_x, g_p, v_delta_x;
+    auto g = [&](double delta_x) {
+      return residual(m, q, delta_x, &state, &g_delta_x, &g_p, &v_delta_x);
+    };
+
+    // Bracket the root, starting where the balance force vanishes.
+    double lo = 100 * sign_r_ * (q - q_rest_), hi = lo;
+    double step = 1;  // cm
+    if (g(lo) >= 0) {
+      for (hi = lo + step; g(hi) > 0; hi = lo + step) {
+        lo = hi;
+        step *= 2;
+      }
+    } else {
+      for (lo = hi - step; g(lo) < 0; lo = hi - step) {
+        hi = lo;
+        step *= 2;
+      }
+    }
+
+    // Newton steps, falling back to bisection when they leave the bracket.
+    double delta_x = 0.5 * (lo + hi);
+    for (size_t i = 0; i < 100; i++) {
+      const double error = g(delta_x);
+      if (error > 0) {
+        lo = delta_x;
+      } else {
+        hi = delta_x;
+      }
+      double next = delta_x - error / g_delta_x;
+      if (!(next > lo && next < hi)) next = 0.5 * (lo + hi);
+      const bool converged = std::abs(next - delta_x) < 1e-12;
+      delta_x = next;
+      if (converged) break;
+    }
+    g(delta_x);
+
+    gtsam::Matrix H_q, H_v, H_f;
+    state.torque = torque_factor_.evaluateError(q, v, state.force, 0, H_q,
+                                                H_v, H_f)(0);
+
+    if (H) {
+      // Implicit function theorem on the force balance residual.
+      const double d_p_m = c_ / (1e3 * state.volume);
+      const double dx_m = -g_p * d_p_m / g_delta_x;
+      const double dx_q = -k_ * sign_r_ / g_delta_x;
+      const double p_v = -state.pressure / state.volume;
+      const double f_m = 0.01 * k_ * dx_m;
+      const double f_q = 0.01 * k_ * dx_q - k_ * sign_r_;
+      H->resize(5, 3);
+      *H << d_p_m + p_v * v_delta_x * dx_m, p_v * v_delta_x * dx_q, 0,
+          v_delta_x * dx_m, v_delta_x * dx_q, 0,
+          dx_m, dx_q, 0,
+          f_m, f_q, 0,
+          H_f(0, 0) * f_m, H_f(0, 0) * f_q + H_q(0, 0), H_v(0, 0);
+    }
+    return state;
+  }
+};
+
 }  // namespace gtdynamics
@@ -21,7 +21,9 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/optional.hpp>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 namespace gtdynamics {
@@ -140,6 +142,24 @@ class MassFlowRateFactor
     return expected_mdot;
   }
 
+  /** Solve for the mass flow of an open valve given the pressures, without
+   * a graph: the mass flow is the fixed point of computeExpectedMassFlow,
+   * found by Newton iterations starting from mdot. */
+  double solveMassFlow(const double &pm, const double &ps,
+                       double mdot = 0.007) const {
+    if (ps * ps == pm * pm) return 0;
+    gtsam::Matrix H_mdot;
+    for (size_t i = 0; i < 100; i++) {
+      double error = computeExpectedMassFlow(pm, ps, mdot, boost::none,
+                                             boost::none, H_mdot) -
+                     mdot;
+      double step = error / (1 - H_mdot(0, 0));
+      mdot += step;
+      if (std::abs(step) <= 1e-12 * std::abs(mdot)) return mdot;
+    }
+    throw std::runtime_error("MassFlowRateFactor: mass flow does not converge");
+  }
+
   gtsam::Vector evaluateError(
       const double &pm, const double &ps, const double &mdot,
       boost::optional<gtsam::Matrix &> H_pm = boost::none,
@@ -179,7 +199,8 @@ class MassFlowRateFactor
 
 /** Sigmoid function, 1/(1+e^-x), used to model the change of mass flow 
  * rate when valve is open/closed. */
-double sigmoid(double x, boost::optional<gtsam::Matrix &> H_x = boost::none) {
+inline double sigmoid(double x,
+                      boost::optional<gtsam::Matrix &> H_x = boost::none) {
   double neg_exp = exp(-x);
   if (H_x) {
     H_x->setConstant(1, 1, neg_exp / pow(1.0 + neg_exp, 2));
@@ -19,6 +19,8 @@ class MassFlowRateFactor: gtsam::NonlinearFactor{
   
   double computeExpectedMassFlow(
       const double &pm, const double &ps, const double &mdot);
+  double solveMassFlow(const double &pm, const double &ps);
+  double solveMassFlow(const double &pm, const double &ps, double mdot);
 };
 
 class ValveControlFactor: gtsam::NonlinearFactor{
@@ -66,6 +68,21 @@ class JointTorqueFactor: gtsam::NonlinearFactor{
                     const double b, const bool positive);
 };
 
+class PneumaticActuatorState {
+  double pressure;
+  double volume;
+  double contraction;
+  double force;
+  double torque;
+};
+
+class PneumaticActuatorModel {
+  PneumaticActuatorModel(double gas_constant, double d_tube, double l_tube,
+                         double k, double r, double q_rest, double q_limit,
+                         double ka, double b, bool positive);
+  gtdynamics::PneumaticActuatorState forward(double m, double q,
+                                             double v) const;
+};
 
 #include <gtdynamics/jumpingrobot/factors/ValueUtils.h>
 gtsam::Values ExtractValues(const gtsam::Values& values, const gtsam::KeyVector& keys);
@@ -74,6 +91,22 @@ gtsam::KeyVector KeySetToKeyVector(const gtsam::KeySet& keys);
 
 
 #include <gtdynamics/jumpingrobot/factors/JRCollocationFactors.h>
+class SourceMassCollocationFactor: gtsam::NonlinearFactor{
+  SourceMassCollocationFactor(
+      const gtsam::KeyVector& mdot_prev_keys,
+      const gtsam::KeyVector& mdot_curr_keys,
+      gtsam::Key source_mass_key_prev, gtsam::Key source_mass_key_curr,
+      gtsam::Key dt_key, bool euler,
+      const gtsam::noiseModel::Base *cost_model);
+  size_t numRates() const;
+};
+
+class TimeCollocationFactor: gtsam::NonlinearFactor{
+  TimeCollocationFactor(gtsam::Key t_prev_key, gtsam::Key t_curr_key,
+                        gtsam::Key dt_key,
+                        const gtsam::noiseModel::Base *cost_model);
+};
+
 void AddSourceMassCollocationFactor(
     gtsam::NonlinearFactorGraph @graph,
     const gtsam::KeyVector& mdot_prev_keys,
@@ -87,4 +120,71 @@ void AddTimeCollocationFactor(
   gtsam::Key t_prev_key, gtsam::Key t_curr_key, gtsam::Key dt_key,
   const gtsam::noiseModel::Base *cost_model);
 
+/****************************************** Simulator ******************************************/
+
+#include <gtdynamics/jumpingrobot/simulator/JRSimulator.h>
+gtdynamics::DynamicsSymbol ActuatorPressureKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol SourcePressureKey(int t = 0);
+gtdynamics::DynamicsSymbol ContractionKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol ActuatorForceKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol ActuatorMassKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol SourceMassKey(int t = 0);
+gtdynamics::DynamicsSymbol MassRateOpenKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol MassRateActualKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol ActuatorVolumeKey(int j, int t = 0);
+gtdynamics::DynamicsSymbol SourceVolumeKey();
+gtdynamics::DynamicsSymbol ValveOpenTimeKey(int j);
+gtdynamics::DynamicsSymbol ValveCloseTimeKey(int j);
+
+class JRPneumaticParameters {
+  JRPneumaticParameters();
+  double d_tube;
+  double l_tube;
+  double mu_tube;
+  double eps_tube;
+  double time_constant_valve;
+  double Rs;
+  double T;
+  double v_source;
+  double init_mass;
+  double gasConstant() const;
+};
+
+class JRActuatorParameters {
+  JRActuatorParameters();
+  int j;
+  bool positive;
+  double k_tendon;
+  double k_anta;
+  double q_anta_limit;
+  double b;
+  double radius;
+  double q_rest;
+};
+
+class JRControls {
+  JRControls();
+  gtsam::Vector valve_open_times;
+  gtsam::Vector valve_close_times;
+  double source_pressure;
+};
+
+class JRSimulator {
+  JRSimulator(const std::vector<gtdynamics::Robot>& robots,
+              const gtdynamics::JRPneumaticParameters& pneumatic,
+              const std::vector<gtdynamics::JRActuatorParameters>& actuators,
+              double threshold = 1e-5);
+  gtsam::Values initialValues(const gtdynamics::JRControls& controls,
+                              const gtsam::Values& initial_state) const;
+  void integrate(int k, double dt, int phase, gtsam::Values @values,
+                 bool include_actuation = true) const;
+  void actuationDynamics(int k, gtsam::Values @values) const;
+  void robotDynamics(int k, int phase, gtsam::Values @values) const;
+  int phaseChange(int k, int phase, const gtsam::Values& values) const;
+  gtsam::Values simulate(size_t num_steps, double dt,
+                         const gtdynamics::JRControls& controls,
+                         const gtsam::Values& initial_state);
+  std::vector<int> phases() const;
+};
+
 }  // namespace gtdynamics
@@ -0,0 +1,433 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JRSimulator.cpp
+ * @brief Simulate the jumping robot by solving the dynamics of each step.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/jumpingrobot/simulator/JRSimulator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Cost model of the valve factors, only used to evaluate them.
+const auto kMassRateModel = Isotropic::Sigma(1, 1e-5);
+
+// Cost models of jumpingrobot/src/robot_graph_builder.py.
+OptimizerSetting JROptimizerSetting() {
+  OptimizerSetting opt(0.001);
+  opt.f_cost_model = Isotropic::Sigma(6, 0.01);
+  opt.fa_cost_model = Isotropic::Sigma(6, 0.01);
+  opt.t_cost_model = Isotropic::Sigma(1, 0.01);
+  opt.time_cost_model = Isotropic::Sigma(1, 0.0001);
+  return opt;
+}
+
+bool HasLink(const Robot &robot, const std::string &name) {
+  for (auto &&link : robot.links())
+    if (link->name() == name) return true;
+  return false;
+}
+
+Key AtTime(Key key, int t) { return DynamicsSymbol(key).atTime(t); }
+
+// The values of the given keys.
+Values Extract(const Values &values, const gtsam::KeySet &keys) {
+  Values extracted;
+  for (Key key : keys) extracted.insert(key, values.at(key));
+  return extracted;
+}
+
+// Insert the step values at time 0 into values at time k; existing values
+// are overwritten if overwrite is set, and kept otherwise.
+void Merge(const Values &step_values, int k, bool overwrite, Values *values) {
+  for (auto &&key_value : step_values) {
+    const Key key = AtTime(key_value.key, k);
+    if (!values->exists(key)) {
+      values->insert(key, key_value.value);
+    } else if (overwrite) {
+      values->update(key, key_value.value);
+    }
+  }
+}
+
+// The value of `key` at time k if there is one, else at time k - 1.
+const gtsam::Value &CurrentOrPrevious(const Values &values, Key key, int k) {
+  const Key key_k = AtTime(key, k);
+  return values.exists(key_k) ? values.at(key_k)
+                              : values.at(AtTime(key, k - 1));
+}
+}  // namespace
+
+/* ************************************************************************* */
+JRSimulator::JRSimulator(const std::vector<Robot> &robots,
+                         const JRPneumaticParameters &pneumatic,
+                         const std::vector<JRActuatorParameters> &actuators,
+                         double threshold)
+    : robots_(robots),
+      pneumatic_(pneumatic),
+      actuators_(actuators),
+      graph_builder_(JROptimizerSetting(), gtsam::Vector3(0, 0, -9.8),
+                     gtsam::Vector3(1, 0, 0)),
+      threshold_(threshold),
+      mass_flow_factor_(ActuatorPressureKey(0), SourcePressureKey(),
+                        MassRateOpenKey(0), kMassRateModel, pneumatic.d_tube,
+                        pneumatic.l_tube, pneumatic.mu_tube,
+                        pneumatic.eps_tube, 1.0 / pneumatic.gasConstant()) {
+  if (robots_.size() != 4) {
+    throw std::invalid_argument(
+        "JRSimulator: expected a robot for each of the 4 phases");
+  }
+
+  for (auto &&actuator : actuators_) {
+    actuator_models_.emplace_back(
+        pneumatic_.gasConstant(), pneumatic_.d_tube, pneumatic_.l_tube,
+        actuator.k_tendon, actuator.radius, actuator.q_rest,
+        actuator.q_anta_limit, actuator.k_anta, actuator.b, actuator.positive);
+  }
+
+  for (auto &&robot : robots_) {
+    q_graphs_.push_back(graph_builder_.qFactors(robot, 0));
+    v_graphs_.push_back(graph_builder_.vFactors(robot, 0));
+    NonlinearFactorGraph dynamics = graph_builder_.aFactors(robot, 0);
+    dynamics.push_back(graph_builder_.dynamicsFactors(robot, 0));
+    dynamics_graphs_.push_back(dynamics);
+  }
+}
+
+/* ************************************************************************* */
+Values JRSimulator::optimize(const NonlinearFactorGraph &graph,
+                             const Values &init_values) const {
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, init_values,
+                                               lm_params_);
+  Values results = optimizer.optimize();
+  if (graph.error(results) > threshold_) {
+    throw std::runtime_error("JRSimulator: optimization does not converge");
+  }
+  return results;
+}
+
+/* ************************************************************************* */
+Values JRSimulator::initialValues(const JRControls &controls,
+                                  const Values &initial_state) const {
+  if (size_t(controls.valve_open_times.size()) != actuators_.size() ||
+      size_t(controls.valve_close_times.size()) != actuators_.size()) {
+    throw std::invalid_argument(
+        "JRSimulator: need valve times for every actuator");
+  }
+
+  // Source tank.
+  Values values;
+  const double v_s = pneumatic_.v_source, p_s = controls.source_pressure;
+  values.insert(SourceVolumeKey(), v_s);
+  values.insert(SourceMassKey(0), v_s * p_s * 1e3 / pneumatic_.gasConstant());
+  values.insert(SourcePressureKey(0), p_s);
+
+  // Joint angles and velocities, and torso pose and twist.
+  const Robot &robot = robots_.front();
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const Key q_key = JointAngleKey(j), v_key = JointVelKey(j);
+    InsertJointAngle(&values, j, 0,
+                     initial_state.exists(q_key) ? JointAngle(initial_state, j)
+                                                 : 0.0);
+    InsertJointVel(&values, j, 0,
+                   initial_state.exists(v_key) ? JointVel(initial_state, j)
+                                               : 0.0);
+  }
+  const auto torso = robot.link("torso");
+  const int i = torso->id();
+  InsertPose(&values, i, 0,
+             initial_state.exists(PoseKey(i)) ? Pose(initial_state, i)
+                                              : torso->bMcom());
+  InsertTwist(&values, i, 0,
+              initial_state.exists(TwistKey(i)) ? Twist(initial_state, i)
+                                                : Vector6::Zero());
+
+  // Actuator masses and valve times.
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const int j = actuators_[a].j;
+    values.insert(ActuatorMassKey(j, 0), pneumatic_.init_mass);
+    values.insert(ValveOpenTimeKey(j), controls.valve_open_times(a));
+    values.insert(ValveCloseTimeKey(j), controls.valve_close_times(a));
+  }
+
+  values.insert(TimeKey(0), 0.0);
+  return values;
+}
+
+/* ************************************************************************* */
+void JRSimulator::integrate(int k, double dt, int phase, Values *values,
+                            bool include_actuation) const {
+  const Robot &robot = robots_.at(phase);
+
+  // Joints, with constant accelerations.
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const double q = JointAngle(*values, j, k - 1);
+    const double v = JointVel(*values, j, k - 1);
+    const double a = JointAccel(*values, j, k - 1);
+    InsertJointAngle(values, j, k, q + v * dt + 0.5 * a * dt * dt);
+    InsertJointVel(values, j, k, v + a * dt);
+  }
+
+  // Torso, with a constant twist acceleration in its body frame.
+  const int i = robot.link("torso")->id();
+  const Pose3 pose = Pose(*values, i, k - 1);
+  const Vector6 twist = Twist(*values, i, k - 1);
+  const Vector6 twist_accel = TwistAccel(*values, i, k - 1);
+  InsertPose(values, i, k,
+             pose.compose(Pose3::Expmap(dt * twist +
+                                        0.5 * dt * dt * twist_accel)));
+  InsertTwist(values, i, k, twist + dt * twist_accel);
+
+  // Air flows from the source into the actuators.
+  if (include_actuation) {
+    double total_m_out = 0;
+    for (auto &&actuator : actuators_) {
+      const int j = actuator.j;
+      const double m_out =
+          values->at<double>(MassRateActualKey(j, k - 1)) * dt;
+      values->insert(ActuatorMassKey(j, k),
+                     values->at<double>(ActuatorMassKey(j, k - 1)) + m_out);
+      total_m_out += m_out;
+    }
+    values->insert(SourceMassKey(k),
+                   values->at<double>(SourceMassKey(k - 1)) - total_m_out);
+  }
+
+  values->insert(TimeKey(k), values->at<double>(TimeKey(k - 1)) + dt);
+}
+
+/* ************************************************************************* */
+void JRSimulator::actuationDynamics(int k, Values *values) const {
+  // The source pressure follows directly from the gas law.
+  const double p_s = values->at<double>(SourceMassKey(k)) *
+                     pneumatic_.gasConstant() /
+                     values->at<double>(SourceVolumeKey()) / 1e3;
+  if (!values->exists(SourcePressureKey(k))) {
+    values->insert(SourcePressureKey(k), p_s);
+  }
+  const double t = values->at<double>(TimeKey(k));
+
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const int j = actuators_[a].j;
+    const PneumaticActuatorState state = actuator_models_[a].forward(
+        values->at<double>(ActuatorMassKey(j, k)), JointAngle(*values, j, k),
+        JointVel(*values, j, k));
+    values->insert(ActuatorPressureKey(j, k), state.pressure);
+    values->insert(ActuatorVolumeKey(j, k), state.volume);
+    values->insert(ContractionKey(j, k), state.contraction);
+    values->insert(ActuatorForceKey(j, k), state.force);
+    InsertTorque(values, j, k, state.torque);
+
+    // Mass flow through the valve.
+    const double mdot = mass_flow_factor_.solveMassFlow(state.pressure, p_s);
+    const ValveControlFactor valve_factor(
+        TimeKey(k), ValveOpenTimeKey(j), ValveCloseTimeKey(j),
+        MassRateOpenKey(j, k), MassRateActualKey(j, k), kMassRateModel,
+        pneumatic_.time_constant_valve);
+    const double mdot_sigma = valve_factor.computeExpectedTrueMassFlow(
+        t, values->at<double>(ValveOpenTimeKey(j)),
+        values->at<double>(ValveCloseTimeKey(j)), mdot);
+    values->insert(MassRateOpenKey(j, k), mdot);
+    values->insert(MassRateActualKey(j, k), mdot_sigma);
+  }
+}
+
+/* ************************************************************************* */
+Values JRSimulator::robotInitValues(const Robot &robot, int k,
+                                    const Values &values) const {
+  Values init_values;
+  if (k == 0) {
+    // Forward kinematics, with unknowns at zero, without copying values.
+    Values fk;
+    if (HasLink(robot, "ground")) {
+      robot.forwardKinematics(values, k, &fk);
+    } else {
+      robot.forwardKinematics(values, k, &fk, std::string("torso"));
+    }
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      const Key pose_key = PoseKey(i, k), twist_key = TwistKey(i, k);
+      InsertPose(&init_values, i,
+                 values.exists(pose_key) ? Pose(values, i, k) : Pose(fk, i, k));
+      InsertTwist(&init_values, i,
+                  values.exists(twist_key) ? Twist(values, i, k)
+                                           : Twist(fk, i, k));
+      InsertTwistAccel(&init_values, i, Vector6::Zero());
+    }
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      const Key q_key = JointAngleKey(j, k), v_key = JointVelKey(j, k);
+      const Key torque_key = TorqueKey(j, k);
+      InsertJointAngle(&init_values, j,
+                       values.exists(q_key) ? values.at<double>(q_key) : 0.0);
+      InsertJointVel(&init_values, j,
+                     values.exists(v_key) ? values.at<double>(v_key) : 0.0);
+      InsertJointAccel(&init_values, j, 0.0);
+      InsertWrench(&init_values, joint->parent()->id(), j, Vector6::Zero());
+      InsertWrench(&init_values, joint->child()->id(), j, Vector6::Zero());
+      InsertTorque(&init_values, j,
+                   values.exists(torque_key) ? values.at<double>(torque_key)
+                                             : 0.0);
+    }
+    return init_values;
+  }
+
+  // The values of step k if known, else of the previous step.
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    init_values.insert(PoseKey(i), CurrentOrPrevious(values, PoseKey(i), k));
+    init_values.insert(TwistKey(i),
+                       CurrentOrPrevious(values, TwistKey(i), k));
+    InsertTwistAccel(&init_values, i, TwistAccel(values, i, k - 1));
+  }
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    init_values.insert(JointAngleKey(j),
+                       CurrentOrPrevious(values, JointAngleKey(j), k));
+    init_values.insert(JointVelKey(j),
+                       CurrentOrPrevious(values, JointVelKey(j), k));
+    InsertJointAccel(&init_values, j, JointAccel(values, j, k - 1));
+    for (int i : {joint->parent()->id(), joint->child()->id()}) {
+      InsertWrench(&init_values, i, j, Wrench(values, i, j, k - 1));
+    }
+    init_values.insert(TorqueKey(j),
+                       CurrentOrPrevious(values, TorqueKey(j), k));
+  }
+  return init_values;
+}
+
+/* ************************************************************************* */
+void JRSimulator::robotDynamics(int k, int phase, Values *values) const {
+  const Robot &robot = robots_.at(phase);
+  const OptimizerSetting &opt = graph_builder_.opt();
+  const int torso = robot.link("torso")->id();
+  const bool grounded = HasLink(robot, "ground");
+  Values init_values = robotInitValues(robot, k, *values);
+
+  // Solve the q level, given the torso pose.
+  NonlinearFactorGraph graph_q = q_graphs_.at(phase);
+  graph_q.addPrior(PoseKey(torso), Pose(*values, torso, k),
+                   opt.p_cost_model);
+  if (!grounded) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      graph_q.addPrior<double>(JointAngleKey(j), JointAngle(*values, j, k),
+                               opt.prior_q_cost_model);
+    }
+  }
+  init_values.update(
+      optimize(graph_q, Extract(init_values, graph_q.keys())));
+
+  // Solve the v level, given the torso twist.
+  NonlinearFactorGraph graph_v = v_graphs_.at(phase);
+  graph_v.addPrior<Vector6>(TwistKey(torso), Twist(*values, torso, k),
+                            opt.v_cost_model);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph_v.addPrior<double>(JointAngleKey(j), JointAngle(init_values, j),
+                             opt.prior_q_cost_model);
+    if (!grounded) {
+      graph_v.addPrior<double>(JointVelKey(j), JointVel(*values, j, k),
+                               opt.prior_qv_cost_model);
+    }
+  }
+  init_values.update(
+      optimize(graph_v, Extract(init_values, graph_v.keys())));
+
+  // Solve accelerations and wrenches, given the kinematics and torques.
+  NonlinearFactorGraph graph = dynamics_graphs_.at(phase);
+  const gtsam::KeySet keys = graph.keys();
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior<double>(JointAngleKey(j), JointAngle(init_values, j),
+                           opt.prior_q_cost_model);
+    graph.addPrior<double>(JointVelKey(j), JointVel(init_values, j),
+                           opt.prior_qv_cost_model);
+    graph.addPrior<double>(TorqueKey(j), Torque(init_values, j),
+                           opt.prior_t_cost_model);
+  }
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    if (keys.count(PoseKey(i))) {
+      graph.addPrior(PoseKey(i), Pose(init_values, i), opt.p_cost_model);
+    }
+    if (keys.count(TwistKey(i))) {
+      graph.addPrior<Vector6>(TwistKey(i), Twist(init_values, i),
+                              opt.v_cost_model);
+    }
+  }
+  init_values.update(optimize(graph, Extract(init_values, graph.keys())));
+
+  Merge(init_values, k, true, values);
+}
+
+/* ************************************************************************* */
+double JRSimulator::groundForceZ(const Robot &robot, const std::string &side,
+                                 int k, const Values &values) const {
+  const int i = robot.link("shank_" + side)->id();
+  const int j = robot.joint("foot_" + side)->id();
+  const Vector6 wrench_b = Wrench(values, i, j, k);
+  const Pose3 T_wb = Pose(values, i, k);
+  const Vector6 wrench_w =
+      T_wb.inverse().AdjointMap().transpose() * wrench_b;
+  return wrench_w(5);
+}
+
+/* ************************************************************************* */
+int JRSimulator::phaseChange(int k, int phase, const Values &values) const {
+  // Event-driven, as in Brogliato02amr_simulating_non_smooth: a foot leaves
+  // the ground once its contact force pulls it down.
+  const Robot &robot = robots_.at(phase);
+  const double threshold = 0;
+  if (phase == 0) {
+    const bool left_off = groundForceZ(robot, "l", k, values) < threshold;
+    const bool right_off = groundForceZ(robot, "r", k, values) < threshold;
+    if (left_off && right_off) return 3;
+    if (left_off) return 2;
+    if (right_off) return 1;
+  } else if (phase == 1) {
+    if (groundForceZ(robot, "l", k, values) < threshold) return 3;
+  } else if (phase == 2) {
+    if (groundForceZ(robot, "r", k, values) < threshold) return 3;
+  }
+  return phase;
+}
+
+/* ************************************************************************* */
+Values JRSimulator::simulate(size_t num_steps, double dt,
+                             const JRControls &controls,
+                             const Values &initial_state) {
+  Values values = initialValues(controls, initial_state);
+  int phase = 0;
+  phases_.assign(1, phase);
+  for (size_t k = 0; k < num_steps; k++) {
+    if (k > 0) integrate(k, dt, phase, &values);
+    actuationDynamics(k, &values);
+    robotDynamics(k, phase, &values);
+    phase = phaseChange(k, phase, values);
+    phases_.push_back(phase);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,249 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JRSimulator.h
+ * @brief Simulate the jumping robot by solving the dynamics of each step.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// @name Keys of the pneumatic variables, named as in the jumping robot paper
+/// @{
+
+/// Pressure of the actuator at joint j, in kPa.
+inline DynamicsSymbol ActuatorPressureKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("Pa", j, t);
+}
+
+/// Pressure of the source tank, in kPa.
+inline DynamicsSymbol SourcePressureKey(int t = 0) {
+  return DynamicsSymbol::SimpleSymbol("Ps", t);
+}
+
+/// Contraction of the actuator at joint j, in cm.
+inline DynamicsSymbol ContractionKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("dx", j, t);
+}
+
+/// Force of the actuator at joint j.
+inline DynamicsSymbol ActuatorForceKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("fa", j, t);
+}
+
+/// Air mass in the actuator at joint j.
+inline DynamicsSymbol ActuatorMassKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("ma", j, t);
+}
+
+/// Air mass in the source tank.
+inline DynamicsSymbol SourceMassKey(int t = 0) {
+  return DynamicsSymbol::SimpleSymbol("ms", t);
+}
+
+/// Mass flow rate into the actuator at joint j if its valve were open.
+inline DynamicsSymbol MassRateOpenKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("mo", j, t);
+}
+
+/// Actual mass flow rate into the actuator at joint j.
+inline DynamicsSymbol MassRateActualKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("md", j, t);
+}
+
+/// Volume of the actuator at joint j.
+inline DynamicsSymbol ActuatorVolumeKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol("Va", j, t);
+}
+
+/// Volume of the source tank.
+inline DynamicsSymbol SourceVolumeKey() {
+  return DynamicsSymbol::SimpleSymbol("Vs", 0);
+}
+
+/// Time the valve of the actuator at joint j opens.
+inline DynamicsSymbol ValveOpenTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol("To", j, 0);
+}
+
+/// Time the valve of the actuator at joint j closes.
+inline DynamicsSymbol ValveCloseTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol("Tc", j, 0);
+}
+
+/// @}
+
+/// Parameters of the pneumatic system, in SI units.
+struct JRPneumaticParameters {
+  double d_tube = 0.1575 * 0.0254;    // tube diameter, valve to actuator
+  double l_tube = 74 * 0.0254;        // tube length, valve to actuator
+  double mu_tube = 1.8377e-5;         // dynamic viscosity of the gas
+  double eps_tube = 1e-5;             // tube roughness
+  double time_constant_valve = 1e-3;  // valve opening/closing time
+  double Rs = 287.0550;               // specific gas constant
+  double T = 296.15;                  // gas temperature
+  double v_source = 1.475e-3;         // volume of the source tank
+  double init_mass = 7.873172488131229e-05;  // initial air mass per actuator
+
+  /// Rs * T, the product in the ideal gas law.
+  double gasConstant() const { return Rs * T; }
+};
+
+/// Parameters of the actuator and the antagonistic spring of one joint.
+struct JRActuatorParameters {
+  int j = 0;                // id of the actuated joint
+  bool positive = false;    // whether contraction increases the angle
+  double k_tendon = 8200;   // tendon stiffness
+  double k_anta = 2.1;      // stiffness of the antagonistic spring
+  double q_anta_limit = 0;  // joint angle where the spring engages
+  double b = 0.03;          // joint damping
+  double radius = 0.04;     // pulley radius
+  double q_rest = 0;        // joint angle at which the actuator is at rest
+};
+
+/// Controls of a jump, per actuator in the order given to JRSimulator.
+struct JRControls {
+  gtsam::Vector valve_open_times, valve_close_times;
+  double source_pressure = 0;  // initial source pressure, in kPa
+};
+
+/**
+ * JRSimulator simulates the jumping robot step by step, as
+ * `JRSimulator` in jumpingrobot/src/jr_simulator.py does: every step first
+ * integrates the state of the previous step, then solves the actuation
+ * dynamics of every actuator, then the robot dynamics layer by layer (q, v,
+ * then accelerations and wrenches), and finally checks the ground forces for
+ * a phase change. The phases are 0 on the ground, 1 with only the left foot
+ * on the ground, 2 with only the right foot, and 3 in the air.
+ *
+ * The actuation dynamics are evaluated directly by PneumaticActuatorModel
+ * and MassFlowRateFactor::solveMassFlow. The robot dynamics graphs of a step
+ * do not depend on the step except for their priors, so they are built once,
+ * on keys at time 0. Every step copies its variables to time 0, solves, and
+ * shifts the results back to its own time.
+ */
+class JRSimulator {
+ private:
+  std::vector<Robot> robots_;  // robot of every phase
+  JRPneumaticParameters pneumatic_;
+  std::vector<JRActuatorParameters> actuators_;
+  DynamicsGraph graph_builder_;
+  gtsam::LevenbergMarquardtParams lm_params_;
+  double threshold_;
+
+  /// Models of the actuators and the valves.
+  std::vector<PneumaticActuatorModel> actuator_models_;
+  MassFlowRateFactor mass_flow_factor_;
+
+  /// Factors of each step, on keys at time 0.
+  std::vector<gtsam::NonlinearFactorGraph> q_graphs_, v_graphs_,
+      dynamics_graphs_;  // per phase
+
+  std::vector<int> phases_;
+
+  /// Optimize, and throw if the error stays above threshold_.
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &init_values) const;
+
+  /// Initial values of the robot dynamics graphs for step k, at time 0.
+  gtsam::Values robotInitValues(const Robot &robot, int k,
+                                const gtsam::Values &values) const;
+
+  /// Vertical ground reaction force on the foot of side "l" or "r".
+  double groundForceZ(const Robot &robot, const std::string &side, int k,
+                      const gtsam::Values &values) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robots     the robot in each of the phases 0 to 3, all with the
+   * same link and joint ids and a link named "torso"
+   * @param pneumatic  parameters of the pneumatic system
+   * @param actuators  parameters of every actuator
+   * @param threshold  largest graph error of a converged step
+   */
+  JRSimulator(const std::vector<Robot> &robots,
+              const JRPneumaticParameters &pneumatic,
+              const std::vector<JRActuatorParameters> &actuators,
+              double threshold = 1e-5);
+
+  /**
+   * Values of the initial configuration at step 0: source volume, mass and
+   * pressure, actuator masses, valve times, time, and the joint angles and
+   * velocities and torso pose and twist in initial_state. Missing joint
+   * angles, velocities and torso twist are zero, a missing torso pose is its
+   * rest pose.
+   */
+  gtsam::Values initialValues(const JRControls &controls,
+                              const gtsam::Values &initial_state) const;
+
+  /**
+   * Integrate joint angles and velocities, the torso pose and twist, air
+   * masses and time from step k - 1 to k, and add them to values.
+   * @param phase phase of step k - 1
+   * @param include_actuation whether to also integrate the air masses
+   */
+  void integrate(int k, double dt, int phase, gtsam::Values *values,
+                 bool include_actuation = true) const;
+
+  /**
+   * Evaluate the actuation dynamics of step k, given the air masses and
+   * joint angles and velocities, and add pressures, volumes, contractions,
+   * forces, torques and mass flow rates to values.
+   */
+  void actuationDynamics(int k, gtsam::Values *values) const;
+
+  /**
+   * Solve the robot dynamics of step k, given the torques, joint angles and
+   * velocities and torso pose and twist, and add the results to values.
+   */
+  void robotDynamics(int k, int phase, gtsam::Values *values) const;
+
+  /// Phase of step k + 1, from the ground reaction forces at step k.
+  int phaseChange(int k, int phase, const gtsam::Values &values) const;
+
+  /**
+   * Simulate a jump.
+   * @param num_steps     number of steps
+   * @param dt            duration of each step
+   * @param controls      valve times and initial source pressure
+   * @param initial_state see initialValues
+   * @return values of all steps; phases() are the phases of the steps
+   */
+  gtsam::Values simulate(size_t num_steps, double dt,
+                         const JRControls &controls,
+                         const gtsam::Values &initial_state);
+
+  /// Phase of every step of the last simulate call, and of the step after.
+  const std::vector<int> &phases() const { return phases_; }
+
+  /// The robot in each phase.
+  const std::vector<Robot> &robots() const { return robots_; }
+
+  /// The actuator parameters.
+  const std::vector<JRActuatorParameters> &actuators() const {
+    return actuators_;
+  }
+};
+
+}  // namespace gtdynamics
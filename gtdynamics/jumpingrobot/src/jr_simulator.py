@@ -59,17 +59,25 @@ class JRSimulator:
         t_curr = t_prev + dt
         values.insert(gtd.TimeKey(k).key(), t_curr)
 
+    def actuator_model(self, actuator):
+        """ Model evaluating the actuator dynamics factors directly. """
+        d_tube = self.jr.params["pneumatic"]["d_tube_valve_musc"] * 0.0254
+        l_tube = self.jr.params["pneumatic"]["l_tube_valve_musc"] * 0.0254
+        q_rest = self.jr.init_config["qs_rest"][actuator.name]
+        return gtd.PneumaticActuatorModel(
+            self.jr.gas_constant, d_tube, l_tube, actuator.config["k_tendon"],
+            actuator.config["rad0"], q_rest, actuator.config["q_anta_limit"],
+            actuator.config["k_anta"], actuator.config["b"],
+            actuator.positive)
+
     def step_actuation_dynamics(self, k, values):
-        """ Perform actuation dynamics by solving the actuation dynamics factor
-            graph of the current step, and add results to values.
+        """ Perform actuation dynamics by evaluating the actuator dynamics of
+            the current step, and add results to values.
 
         Args:
             k (int): current step index
             values (gtsam.Values): values containing q, v, m_a, m_s of
                                    current step and To, Ti, V_s
-
-        Raises:
-            Exception: optimization does not converge
         """
 
         # directly compute source pressure
@@ -77,45 +85,21 @@ class JRSimulator:
         V_s = values.atDouble(Actuator.SourceVolumeKey())
         P_s = m_s * self.jr.gas_constant / V_s / 1e3
         P_s_key = Actuator.SourcePressureKey(k)
+        if not values.exists(P_s_key):
+            values.insert(P_s_key, P_s)
 
-        # perform actuator forward dynamics by solving its dynamcis graph
+        # actuator forward dynamics, without solving a graph
         for actuator in self.jr.actuators:
             j = actuator.j
-
-            # construct graph
-            graph = self.jr_graph_builder.actuation_graph_builder.actuator_dynamics_graph(
-                self.jr, actuator, k)
-            m_a_key = Actuator.MassKey(j, k)
-            q_key = gtd.JointAngleKey(j, k).key()
-            v_key = gtd.JointVelKey(j, k).key()
-            m_a = values.atDouble(m_a_key)
-            q = values.atDouble(q_key)
-            v = values.atDouble(v_key)
-            actuation_graph_builder = self.jr_graph_builder.actuation_graph_builder
-            graph.add(
-                gtd.PriorFactorDouble(
-                    m_a_key, m_a, actuation_graph_builder.prior_m_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    P_s_key, P_s,
-                    actuation_graph_builder.prior_pressure_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    q_key, q, actuation_graph_builder.prior_q_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    v_key, v, actuation_graph_builder.prior_v_cost_model))
-            # TODO(yetong): check why adding the massflow graph makes it unable to optimize
-
-            # construct init values and optimize
-            if k == 0:
-                init_values = JRValues.init_values_from_init_config_actuator(
-                    self.jr, j, k, values)
-            else:
-                init_values = JRValues.init_values_from_prev_actuator(
-                    j, k, values)
-            results = self.optimize(graph, init_values)
-            mergeValues(values, results)
+            m_a = values.atDouble(Actuator.MassKey(j, k))
+            q = values.atDouble(gtd.JointAngleKey(j, k).key())
+            v = values.atDouble(gtd.JointVelKey(j, k).key())
+            state = self.actuator_model(actuator).forward(m_a, q, v)
+            values.insert(Actuator.PressureKey(j, k), state.pressure)
+            values.insert(Actuator.VolumeKey(j, k), state.volume)
+            values.insert(Actuator.ContractionKey(j, k), state.contraction)
+            values.insert(Actuator.ForceKey(j, k), state.force)
+            values.insert(gtd.TorqueKey(j, k).key(), state.torque)
 
             # compute mass flow
             mdot, mdot_sigma = JRValues.compute_mass_flow(
@@ -389,6 +373,77 @@ class JRSimulator:
 
         return values, step_phases
 
+    def native_simulator(self):
+        """ Create the C++ simulator of the same robot, see simulate_native. """
+        params = self.jr.params
+        pneumatic = gtd.JRPneumaticParameters()
+        pneumatic.d_tube = params["pneumatic"]["d_tube_valve_musc"] * 0.0254
+        pneumatic.l_tube = params["pneumatic"]["l_tube_valve_musc"] * 0.0254
+        pneumatic.mu_tube = params["pneumatic"]["mu_tube"]
+        pneumatic.eps_tube = params["pneumatic"]["eps_tube"]
+        pneumatic.time_constant_valve = params["pneumatic"][
+            "time_constant_valve"]
+        pneumatic.Rs = params["pneumatic"]["Rs"]
+        pneumatic.T = params["pneumatic"]["T"]
+        pneumatic.v_source = params["pneumatic"]["v_source"]
+        pneumatic.init_mass = params["pneumatic"]["init_mass"]
+
+        actuators = []
+        for actuator in self.jr.actuators:
+            parameters = gtd.JRActuatorParameters()
+            parameters.j = actuator.j
+            parameters.positive = actuator.positive
+            parameters.k_tendon = actuator.config["k_tendon"]
+            parameters.k_anta = actuator.config["k_anta"]
+            parameters.q_anta_limit = actuator.config["q_anta_limit"]
+            parameters.b = actuator.config["b"]
+            parameters.radius = actuator.config["rad0"]
+            parameters.q_rest = self.init_config["qs_rest"][actuator.name]
+            actuators.append(parameters)
+
+        robots = [JumpingRobot.create_robot(params, phase)
+                  for phase in range(4)]
+        return gtd.JRSimulator(robots, pneumatic, actuators)
+
+    def simulate_native(self, num_steps: int, dt: float, controls):
+        """ Same as simulate, but runs the step loop in C++.
+
+        Args:
+            num_steps (int): total number of simulation steps
+            dt (float): duration of each step
+            controls (Dict): specify control variables
+
+        Returns:
+            (gtsam.Values, list): (values for all steps, list of phases for
+                                   each step)
+        """
+        self.jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        names = [actuator.name for actuator in self.jr.actuators]
+        native_controls = gtd.JRControls()
+        native_controls.valve_open_times = np.array(
+            [float(controls["Tos"][name]) for name in names])
+        native_controls.valve_close_times = np.array(
+            [float(controls["Tcs"][name]) for name in names])
+        native_controls.source_pressure = controls["P_s_0"]
+
+        initial_state = gtsam.Values()
+        for joint in self.jr.robot.joints():
+            j = joint.id()
+            gtd.InsertJointAngle(initial_state, j, 0,
+                                 float(self.init_config["qs"][joint.name()]))
+            gtd.InsertJointVel(initial_state, j, 0,
+                               float(self.init_config["vs"][joint.name()]))
+        torso_i = self.jr.robot.link("torso").id()
+        gtd.InsertPose(initial_state, torso_i, 0,
+                       self.init_config["torso_pose"])
+        gtd.InsertTwist(initial_state, torso_i, 0,
+                        self.init_config["torso_twist"])
+
+        simulator = self.native_simulator()
+        values = simulator.simulate(num_steps, dt, native_controls,
+                                    initial_state)
+        return values, list(simulator.phases())
+
     def simulate_with_torque_seq(self, num_steps, dt, torques_seq):
         """ Run simulation with specified torque sequence. """
         controls = JumpingRobot.create_controls()
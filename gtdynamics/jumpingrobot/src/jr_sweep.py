@@ -0,0 +1,109 @@
+"""
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  jr_sweep.py
+ * @brief Sweep design parameters of the jumping robot in parallel.
+ * @author GTDynamics Team
+"""
+
+import copy
+import inspect
+import os.path as osp
+import sys
+
+currentdir = osp.dirname(osp.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = osp.dirname(currentdir)
+sys.path.insert(0, parentdir)
+sys.path.insert(0, currentdir)
+
+import gtdynamics as gtd
+import gtsam
+
+from jumping_robot import JumpingRobot
+
+
+class JRSweep:
+    """ Solve one problem, e.g. a trajectory optimization built with
+        JRGraphBuilder.collocation_graph, for every point of a grid over
+        fields of robot_config.yaml. Problems are solved concurrently by
+        gtd.ParameterSweep; building them runs one at a time as it needs the
+        GIL, overlapping with the solves of other points. Every point gets
+        its own JumpingRobot, created from its own copy of the parameters.
+    """
+
+    def __init__(self,
+                 yaml_file_path,
+                 init_config,
+                 fields,
+                 parameters=None,
+                 output_keys=None,
+                 num_threads=0):
+        """ Constructor.
+
+        Args:
+            yaml_file_path (str): yaml file with the nominal parameters
+            init_config (dict): initial configuration
+            fields (dict): values of every swept field, keyed by its path in
+                           the yaml file, e.g. "knee.k_tendon" or
+                           "morphology.m.2" for an element of a list
+            parameters (gtd.OptimizationParameters, optional): optimizer
+                                                               parameters
+            output_keys (list, optional): double-valued keys to report
+            num_threads (int, optional): number of threads, 0 for all cores
+        """
+        self.params = JumpingRobot.load_file(yaml_file_path)
+        self.init_config = init_config
+        self.grid = gtd.ParameterGrid()
+        for field, values in fields.items():
+            JRSweep.set_field(copy.deepcopy(self.params), field, 0.0)
+            self.grid.add(field, [float(value) for value in values])
+        if parameters is None:
+            parameters = gtd.OptimizationParameters()
+        keys = gtsam.KeyVector(output_keys or [])
+        self.sweep = gtd.ParameterSweep(self.grid, parameters, keys,
+                                        num_threads)
+
+    @staticmethod
+    def set_field(params, field, value):
+        """ Set the field at a dotted path in the parameters; raises KeyError
+            or IndexError if it does not exist. """
+        *path, last = field.split(".")
+        node = params
+        for name in path:
+            node = node[int(name)] if isinstance(node, list) else node[name]
+        if isinstance(node, list):
+            node[int(last)] = value
+        elif last in node:
+            node[last] = value
+        else:
+            raise KeyError(field)
+
+    def jumping_robot(self, point, phase=0):
+        """ Jumping robot with the parameters of a design point. """
+        params = copy.deepcopy(self.params)
+        for field, value in point.items():
+            JRSweep.set_field(params, field, value)
+        return JumpingRobot(None, self.init_config, phase, params)
+
+    def run(self, build_problem, results_path=""):
+        """ Build and solve the problems of all design points.
+
+        Args:
+            build_problem (function): takes the JumpingRobot of a point and
+                                      returns its graph and initial values
+            results_path (str, optional): CSV file to write the results to
+
+        Returns:
+            list: gtd.SweepResult of every point, ordered by index
+        """
+        def builder(point):
+            graph, init_values = build_problem(self.jumping_robot(point))
+            problem = gtd.SweepProblem()
+            problem.graph = graph
+            problem.initial_values = init_values
+            return problem
+
+        return self.sweep.run(builder, results_path)
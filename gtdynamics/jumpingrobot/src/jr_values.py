@@ -150,38 +150,17 @@ class JRValues:
         temp = jr.params["pneumatic"]["T"]
         k_const = 1.0 / (Rs * temp)
 
-        graph = gtsam.NonlinearFactorGraph()
         P_a_key = Actuator.PressureKey(j, k)
         P_s_key = Actuator.SourcePressureKey(k)
         mdot_key = Actuator.MassRateOpenKey(j, k)
         P_s = values.atDouble(P_s_key)
         P_a = values.atDouble(P_a_key)
 
-        prior_model = noiseModel.Isotropic.Sigma(1, 0.1)
         mass_rate_model = noiseModel.Isotropic.Sigma(1, 1e-5)
-
-        graph.add(
-            gtd.MassFlowRateFactor(P_a_key, P_s_key, mdot_key, mass_rate_model,
-                                   d_tube, l_tube, mu, epsilon, k_const))
-        graph.add(gtd.PriorFactorDouble(P_a_key, P_a, prior_model))
-        graph.add(gtd.PriorFactorDouble(P_s_key, P_s, prior_model))
-
-        init_values = gtsam.Values()
-        init_values.insert(P_a_key, P_a)
-        init_values.insert(P_s_key, P_s)
-        init_values.insert(mdot_key, 0.007)
-
-        result = gtsam.LevenbergMarquardtOptimizer(graph,
-                                                   init_values).optimize()
-        if graph.error(result) > 1e-5:
-            params = gtsam.LevenbergMarquardtParams()
-            params.setVerbosityLM("SUMMARY")
-            results = gtsam.LevenbergMarquardtOptimizer(
-                graph, init_values, params).optimize()
-            print("error: ", graph.error(results))
-            raise Exception("computing mass rate fails")
-
-        mdot = result.atDouble(mdot_key)
+        mass_flow_factor = gtd.MassFlowRateFactor(P_a_key, P_s_key, mdot_key,
+                                                  mass_rate_model, d_tube,
+                                                  l_tube, mu, epsilon, k_const)
+        mdot = mass_flow_factor.solveMassFlow(P_a, P_s)
 
         To_a_key = Actuator.ValveOpenTimeKey(j)
         Tc_a_key = Actuator.ValveCloseTimeKey(j)
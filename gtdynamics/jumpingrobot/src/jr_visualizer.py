@@ -27,21 +27,26 @@ from matplotlib.animation import FuncAnimation
 from jumping_robot import Actuator, JumpingRobot
 
 
-def update_jr_frame(ax, values, jr, k):
-    """ Update the jr animation frame. """
+def link_pose_matrices(values, jr):
+    """ Poses of all links at all steps, as a (steps, links, 4, 4) array. """
+    buffer = gtd.TrajectoryBuffer.FromValues(jr.robot, values)
+    return buffer.poseMatrices()
+
+
+def update_jr_frame(ax, poses, jr, k):
+    """ Update the jr animation frame from the link_pose_matrices array. """
     link_names = ["shank_r", "thigh_r", "torso", "thigh_l", "shank_l"]
     colors = ["red", "orange", "black", "green", "blue"]
+    link_ids = [link.id() for link in jr.robot.links()]
 
     ax.clear()
 
     for name, color in zip(link_names, colors):
-        link = jr.robot.link(name)
-        i = link.id()
-        pose = gtd.Pose(values, i, k)
+        pose = poses[k, link_ids.index(jr.robot.link(name).id())]
 
-        y = pose.y()
-        z = pose.z()
-        theta = pose.rotation().roll()
+        y = pose[1, 3]
+        z = pose[2, 3]
+        theta = np.arctan2(pose[2, 1], pose[2, 2])  # roll
         l = 0.55
         start_y = y - l/2 * np.cos(theta)
         start_z = z - l/2 * np.sin(theta)
@@ -81,7 +86,7 @@ def visualize_jr(values: gtsam.Values, jr: JumpingRobot, k: int):
 
     fig = plt.figure(figsize=(10, 10), dpi=80)
     ax = fig.add_subplot(1, 1, 1)
-    update_jr_frame(ax, values, jr, k)
+    update_jr_frame(ax, link_pose_matrices(values, jr), jr, k)
     plt.show()
 
 
@@ -90,8 +95,10 @@ def visualize_jr_trajectory(values, jr, num_steps, step=1):
     fig = plt.figure(figsize=(10, 10), dpi=80)
     ax = fig.add_subplot(1, 1, 1)
 
+    poses = link_pose_matrices(values, jr)
+
     def animate(i):
-        update_jr_frame(ax, values, jr, i)
+        update_jr_frame(ax, poses, jr, i)
     frames = np.arange(0, num_steps, step)
     FuncAnimation(fig, animate, frames=frames, interval=10)
     plt.show()
@@ -83,7 +83,7 @@ class JumpingRobot:
     """ Class that stores a GTDynamics robot class and all parameters for 
         a jumping robot. """
 
-    def __init__(self, yaml_file_path, init_config, phase=0):
+    def __init__(self, yaml_file_path, init_config, phase=0, params=None):
         """ Constructor
 
         Args:
@@ -94,8 +94,12 @@ class JumpingRobot:
                 - 1: left on ground
                 - 2: right on ground 
                 - 3: in air
+            params (dict, optional): parameters to use instead of loading
+                                     yaml_file_path
         """
-        self.params = self.load_file(yaml_file_path)
+        if params is None:
+            params = self.load_file(yaml_file_path)
+        self.params = params
         self.init_config = init_config
         self.robot = self.create_robot(self.params, phase)
         self.actuators = [Actuator("knee_r", self.robot, self.params["knee"], False),
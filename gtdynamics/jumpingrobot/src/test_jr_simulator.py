@@ -122,5 +122,31 @@ class TestJRSimulator(unittest.TestCase):
         # TODO(yetong): check torques, pressures, etc
 
 
+    def test_native_actuation_dynamics(self):
+        """ Test forward dynamics of actuator in the C++ simulator against
+            the Python one. """
+        Tos = [0, 0, 0, 0]
+        Tcs = [1, 1, 1, 1]
+        P_s_0 = 65 * 6894.76 / 1e3
+        controls = JumpingRobot.create_controls(Tos, Tcs, P_s_0)
+        values = JRValues.init_config_values(self.jr_simulator.jr, controls)
+        self.jr_simulator.step_actuation_dynamics(0, values)
+
+        simulator = self.jr_simulator.native_simulator()
+        native_controls = gtd.JRControls()
+        native_controls.valve_open_times = np.array(Tos, dtype=float)
+        native_controls.valve_close_times = np.array(Tcs, dtype=float)
+        native_controls.source_pressure = P_s_0
+        native_values = simulator.initialValues(native_controls, values)
+        simulator.actuationDynamics(0, native_values)
+
+        for actuator in self.jr_simulator.jr.actuators:
+            j = actuator.j
+            self.assertAlmostEqual(gtd.Torque(native_values, j, 0),
+                                   gtd.Torque(values, j, 0), places=7)
+            key = gtd.MassRateActualKey(j, 0).key()
+            self.assertAlmostEqual(native_values.atDouble(key),
+                                   values.atDouble(key), places=7)
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,77 @@
+"""
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_jr_sweep.py
+ * @brief Unit test for the jumping robot design sweep.
+ * @author GTDynamics Team
+"""
+
+import inspect
+import os
+import os.path as osp
+import sys
+import unittest
+
+import gtdynamics as gtd
+import gtsam
+
+currentdir = osp.dirname(osp.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = osp.dirname(currentdir)
+sys.path.insert(0, parentdir)
+
+from src.jr_sweep import JRSweep
+from src.jumping_robot import JumpingRobot
+
+
+class TestJRSweep(unittest.TestCase):
+    """ Tests for JRSweep. """
+    def setUp(self):
+        """ Set up a sweep over the torso mass and the knee stiffness. """
+        self.yaml_file_path = osp.join(parentdir, "yaml", "robot_config.yaml")
+        self.init_config = JumpingRobot.create_init_config()
+        self.key = gtd.JointAngleKey(0, 0).key()
+        self.sweep = JRSweep(self.yaml_file_path, self.init_config, {
+            "morphology.m.2": [0.5, 1.0],
+            "knee.k_tendon": [8000, 8200, 8400]
+        }, output_keys=[self.key], num_threads=2)
+
+    def test_jumping_robot(self):
+        """ Every point gets a robot with its own parameters. """
+        self.assertEqual(self.sweep.grid.size(), 6)
+        point = self.sweep.grid.point(4)
+        jr = self.sweep.jumping_robot(point)
+        self.assertAlmostEqual(jr.robot.link("torso").mass(), 1.0)
+        self.assertEqual(jr.params["knee"]["k_tendon"], 8200)
+        self.assertEqual(self.sweep.params["morphology"]["m"][2], 0.883)
+        with self.assertRaises(KeyError):
+            JRSweep(self.yaml_file_path, self.init_config, {"knee.k": [1]})
+
+    def test_run(self):
+        """ The problem of every point is solved and written. """
+        def build_problem(jr):
+            mass = jr.robot.link("torso").mass()
+            graph = gtsam.NonlinearFactorGraph()
+            graph.add(
+                gtd.PriorFactorDouble(
+                    self.key, mass, gtsam.noiseModel.Isotropic.Sigma(1, 0.1)))
+            init_values = gtsam.Values()
+            init_values.insert(self.key, 0.0)
+            return graph, init_values
+
+        results_path = "test_jr_sweep.csv"
+        results = self.sweep.run(build_problem, results_path)
+        self.assertEqual(len(results), 6)
+        for result in results:
+            self.assertTrue(result.solved)
+            self.assertAlmostEqual(result.outputs[0],
+                                   result.point["morphology.m.2"])
+        with open(results_path) as file:
+            self.assertEqual(len(file.readlines()), 7)
+        os.remove(results_path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJRCollocationFactors.cpp
+ *  @brief Tests for jumping robot collocation factors.
+ *  @author GTDynamics Team
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/factors/JRCollocationFactors.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using gtdynamics::SourceMassCollocationFactor;
+using gtdynamics::TimeCollocationFactor;
+using gtsam::assert_equal;
+using gtsam::Symbol;
+using gtsam::Values;
+using gtsam::Vector1;
+
+namespace example {
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.001);
+const gtsam::KeyVector mdot_prev_keys{Symbol('a', 0), Symbol('a', 1),
+                                      Symbol('a', 2)};
+const gtsam::KeyVector mdot_curr_keys{Symbol('b', 0), Symbol('b', 1),
+                                      Symbol('b', 2)};
+const Symbol m_prev_key('m', 0), m_curr_key('m', 1), dt_key('d', 0);
+
+Values MassValues() {
+  Values values;
+  values.insert(m_prev_key, 5.0);
+  values.insert(m_curr_key, 4.0);
+  values.insert(dt_key, 0.1);
+  for (int i = 0; i < 3; i++) {
+    values.insert(mdot_prev_keys[i], 1.0 + i);
+    values.insert(mdot_curr_keys[i], 3.0 + i);
+  }
+  return values;
+}
+}  // namespace example
+
+TEST(SourceMassCollocationFactor, Euler) {
+  using namespace example;
+  SourceMassCollocationFactor factor(mdot_prev_keys, mdot_curr_keys,
+                                     m_prev_key, m_curr_key, dt_key, true,
+                                     cost_model);
+  EXPECT_LONGS_EQUAL(6, factor.size());
+  const Values values = MassValues();
+  // 5 - 0.1 * (1 + 2 + 3) - 4
+  EXPECT(assert_equal(Vector1(0.4), factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(SourceMassCollocationFactor, Trapezoidal) {
+  using namespace example;
+  gtsam::NonlinearFactorGraph graph;
+  gtdynamics::AddSourceMassCollocationFactor(&graph, mdot_prev_keys,
+                                             mdot_curr_keys, m_prev_key,
+                                             m_curr_key, dt_key, false,
+                                             cost_model);
+  auto factor =
+      boost::dynamic_pointer_cast<SourceMassCollocationFactor>(graph.back());
+  EXPECT(factor);
+  EXPECT_LONGS_EQUAL(9, factor->size());
+  const Values values = MassValues();
+  // 5 - 0.05 * (1 + 2 + 3 + 3 + 4 + 5) - 4
+  EXPECT(assert_equal(Vector1(0.1), factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(SourceMassCollocationFactor(mdot_prev_keys, {}, m_prev_key,
+                                              m_curr_key, dt_key, false,
+                                              cost_model),
+                  std::invalid_argument);
+}
+
+TEST(TimeCollocationFactor, Factor) {
+  TimeCollocationFactor factor(Symbol('t', 0), Symbol('t', 1), Symbol('d', 0),
+                               example::cost_model);
+  EXPECT(assert_equal(Vector1(0), factor.evaluateError(0.2, 0.3, 0.1), 1e-9));
+  Values values;
+  values.insert(Symbol('t', 0), 0.2);
+  values.insert(Symbol('t', 1), 0.5);
+  values.insert(Symbol('d', 0), 0.1);
+  EXPECT(assert_equal(Vector1(-0.2), factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
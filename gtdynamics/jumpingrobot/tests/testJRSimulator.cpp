@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJRSimulator.cpp
+ *  @brief Tests for the jumping robot simulator.
+ *  @author GTDynamics Team
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/simulator/JRSimulator.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+// A torso with one leg hanging from it, free to fall.
+Robot fallingRobot() {
+  const Pose3 bMtorso(Rot3(), Point3(0, 0, 1));
+  const Pose3 bMleg(Rot3(), Point3(0, 0, 0.5));
+  auto torso = boost::make_shared<Link>(0, "torso", 1.0, gtsam::I_3x3,
+                                        bMtorso, bMtorso);
+  auto leg = boost::make_shared<Link>(1, "leg", 0.5, 0.1 * gtsam::I_3x3,
+                                      bMleg, bMleg);
+  auto hip = boost::make_shared<RevoluteJoint>(
+      0, "hip", Pose3(Rot3(), Point3(0, 0, 0.75)), torso, leg,
+      gtsam::Vector3(1, 0, 0));
+  torso->addJoint(hip);
+  leg->addJoint(hip);
+  return Robot({{"torso", torso}, {"leg", leg}}, {{"hip", hip}});
+}
+
+JRSimulator simulator() {
+  JRActuatorParameters actuator;
+  actuator.j = 0;
+  return JRSimulator(std::vector<Robot>(4, fallingRobot()),
+                     JRPneumaticParameters(), {actuator});
+}
+
+// Valve open from 0 to 1s, 65 psi in the source tank.
+JRControls controls() {
+  JRControls controls;
+  controls.valve_open_times = gtsam::Vector1(0);
+  controls.valve_close_times = gtsam::Vector1(1);
+  controls.source_pressure = 65 * 6894.76 / 1e3;
+  return controls;
+}
+}  // namespace example
+
+// A relaxed actuator exerts no torque, and air starts flowing in.
+TEST(JRSimulator, ActuationDynamics) {
+  const JRSimulator simulator = example::simulator();
+  Values values = simulator.initialValues(example::controls(), Values());
+  simulator.actuationDynamics(0, &values);
+
+  EXPECT_DOUBLES_EQUAL(0, Torque(values, 0, 0), 1e-6);
+  EXPECT_DOUBLES_EQUAL(101.325,
+                       values.at<double>(ActuatorPressureKey(0, 0)), 0.1);
+  const double mdot = values.at<double>(MassRateOpenKey(0, 0));
+  EXPECT(mdot > 0);
+  // At the opening time the valve is half open.
+  EXPECT_DOUBLES_EQUAL(0.5 * mdot,
+                       values.at<double>(MassRateActualKey(0, 0)), 1e-9);
+}
+
+// Without torque the robot falls freely, and is integrated accordingly.
+TEST(JRSimulator, RobotDynamicsAndIntegration) {
+  const JRSimulator simulator = example::simulator();
+  Values values = simulator.initialValues(example::controls(), Values());
+  simulator.actuationDynamics(0, &values);
+  simulator.robotDynamics(0, 0, &values);
+
+  EXPECT_DOUBLES_EQUAL(0, JointAccel(values, 0, 0), 1e-4);
+  EXPECT_DOUBLES_EQUAL(-9.8, TwistAccel(values, 0, 0)(5), 1e-4);
+
+  const double dt = 0.005;
+  simulator.integrate(1, dt, 0, &values);
+  EXPECT_DOUBLES_EQUAL(dt, values.at<double>(TimeKey(1)), 1e-12);
+  EXPECT(assert_equal(Point3(0, 0, 1 - 0.5 * 9.8 * dt * dt),
+                      Pose(values, 0, 1).translation(), 1e-6));
+  const double m_in = values.at<double>(MassRateActualKey(0, 0)) * dt;
+  EXPECT_DOUBLES_EQUAL(values.at<double>(ActuatorMassKey(0, 0)) + m_in,
+                       values.at<double>(ActuatorMassKey(0, 1)), 1e-15);
+  EXPECT_DOUBLES_EQUAL(values.at<double>(SourceMassKey(0)) - m_in,
+                       values.at<double>(SourceMassKey(1)), 1e-15);
+}
+
+// Controls for every actuator are required, and a robot for every phase.
+TEST(JRSimulator, InvalidArguments) {
+  const JRSimulator simulator = example::simulator();
+  CHECK_EXCEPTION(simulator.initialValues(JRControls(), Values()),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(JRSimulator({example::fallingRobot()},
+                              JRPneumaticParameters(), {}),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
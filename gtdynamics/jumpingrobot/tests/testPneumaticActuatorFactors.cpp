@@ -27,7 +27,8 @@
 
 using gtdynamics::ForceBalanceFactor, gtdynamics::JointTorqueFactor,
     gtdynamics::ActuatorVolumeFactor, gtdynamics::SmoothActuatorFactor,
-    gtdynamics::ClippingActuatorFactor;
+    gtdynamics::ClippingActuatorFactor, gtdynamics::PneumaticActuatorModel,
+    gtdynamics::PneumaticActuatorState;
 using gtsam::Symbol, gtsam::Vector1, gtsam::Values, gtsam::Key,
     gtsam::assert_equal, gtsam::noiseModel::Isotropic;
 
@@ -380,6 +381,67 @@ TEST(ClippingActuatorFactor, negative_contraction_zero) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+/** The actuator model satisfies the factors, with correct derivatives. */
+TEST(PneumaticActuatorModel, forward) {
+  const double c = 287.0550 * 296.15, d_tube = 0.1575 * 0.0254,
+               l_tube = 74 * 0.0254, k = 8200, r = 0.04, q_rest = 0,
+               q_limit = 0, ka = 2.1, b = 0.03;
+  const PneumaticActuatorModel model(c, d_tube, l_tube, k, r, q_rest, q_limit,
+                                     ka, b);
+  const double m = 1.6e-4, q = 0.3, v = 0.5;
+  gtsam::Matrix H;
+  const PneumaticActuatorState state = model.forward(m, q, v, H);
+
+  EXPECT_DOUBLES_EQUAL(c * m, 1e3 * state.pressure * state.volume, 1e-9);
+  ActuatorVolumeFactor volume_factor(example::l_key, example::delta_x_key,
+                                     example::cost_model, d_tube, l_tube);
+  EXPECT_DOUBLES_EQUAL(
+      0, volume_factor.evaluateError(state.volume, state.contraction)(0),
+      1e-12);
+  SmoothActuatorFactor actuator_factor(example::delta_x_key, example::p_key,
+                                       example::f_key, example::cost_model);
+  EXPECT_DOUBLES_EQUAL(0,
+                       actuator_factor.evaluateError(
+                           state.contraction, state.pressure, state.force)(0),
+                       1e-6);
+  ForceBalanceFactor balance_factor(example::delta_x_key, example::q_key,
+                                    example::f_key, example::cost_model, k, r,
+                                    q_rest);
+  EXPECT_DOUBLES_EQUAL(
+      0, balance_factor.evaluateError(state.contraction, q, state.force)(0),
+      1e-9);
+  JointTorqueFactor torque_factor(example::q_key, example::v_key,
+                                  example::f_key, example::torque_key,
+                                  example::cost_model, q_limit, ka, r, b);
+  EXPECT_DOUBLES_EQUAL(
+      0, torque_factor.evaluateError(q, v, state.force, state.torque)(0),
+      1e-9);
+
+  // Mass in units of 1e-4, for a sensible numerical derivative.
+  auto f = [&](const double &m_i, const double &q_i, const double &v_i) {
+    const PneumaticActuatorState s = model.forward(1e-4 * m_i, q_i, v_i);
+    return (gtsam::Vector5() << s.pressure, s.volume, s.contraction, s.force,
+            s.torque)
+        .finished();
+  };
+  const double m_scaled = 1e4 * m;
+  EXPECT(assert_equal(
+      gtsam::Matrix(1e-4 * H.col(0)),
+      gtsam::numericalDerivative31<gtsam::Vector5, double, double, double>(
+          f, m_scaled, q, v),
+      1e-4));
+  EXPECT(assert_equal(
+      gtsam::Matrix(H.col(1)),
+      gtsam::numericalDerivative32<gtsam::Vector5, double, double, double>(
+          f, m_scaled, q, v),
+      1e-4));
+  EXPECT(assert_equal(
+      gtsam::Matrix(H.col(2)),
+      gtsam::numericalDerivative33<gtsam::Vector5, double, double, double>(
+          f, m_scaled, q, v),
+      1e-4));
+}
+
 /* main function */
 int main() {
   TestResult tr;
@@ -91,6 +91,26 @@ TEST(MassFlowRateFactor, Factor) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-2);
 }
 
+/** The solved mass flow satisfies the factor, in both directions. */
+TEST(MassFlowRateFactor, solveMassFlow) {
+  double pa = 100;
+  double ps = 65.0 * 6.89476;
+  double D = 0.1575 * 0.0254;
+  double L = 74 * 0.0254;
+  double mu = 1.8377e-5;
+  double epsilon = 1e-5;
+  double k = 1. / (287.0550 * 296.15);
+
+  MassFlowRateFactor factor(example::pa_key, example::ps_key, example::mdot_key,
+                            Isotropic::Sigma(1, 0.001), D, L, mu, epsilon, k);
+  double mdot = factor.solveMassFlow(pa, ps);
+  EXPECT(mdot > 0);
+  EXPECT_DOUBLES_EQUAL(0, factor.evaluateError(pa, ps, mdot)(0), 1e-12);
+  double mdot_negative = factor.solveMassFlow(ps, pa);
+  EXPECT_DOUBLES_EQUAL(-mdot, mdot_negative, 1e-9);
+  EXPECT_DOUBLES_EQUAL(0, factor.solveMassFlow(pa, pa), 0);
+}
+
 TEST(MassFlowRateFactor, Negative) {
   double pa = 65.0 * 6.89476;
   double ps = 100;
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticalIK.cpp
+ * @brief Registry of closed-form inverse kinematics solvers.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/kinematics/AnalyticalIK.h>
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+// Link with the given name, or null.
+static LinkSharedPtr FindLink(const Robot &robot, const std::string &name) {
+  const auto &links = robot.links();
+  auto it = std::find_if(
+      links.begin(), links.end(),
+      [&name](const LinkSharedPtr &link) { return link->name() == name; });
+  return it == links.end() ? nullptr : *it;
+}
+
+/* ************************************************************************* */
+bool AnalyticalIKSolver::matches(const Robot &robot) const {
+  return FindLink(robot, baseLinkName()) &&
+         FindLink(robot, endEffectorLinkName());
+}
+
+/* ************************************************************************* */
+gtsam::Pose3 AnalyticalIKSolver::linkFramePose(const Robot &robot,
+                                               const gtsam::Pose3 &bTe) const {
+  // Link frame in the link CoM frame.
+  auto comMlink = [&robot](const std::string &name) {
+    const auto link = robot.link(name);
+    return link->bMcom().between(link->bMlink());
+  };
+  return comMlink(baseLinkName()).inverse() * bTe *
+         comMlink(endEffectorLinkName());
+}
+
+/* ************************************************************************* */
+bool AnalyticalIKSolver::WithinLimits(const Robot &robot,
+                                      const JointAngleMap &solution) {
+  for (auto &&kv : solution) {
+    const auto &limits = robot.joint(kv.first)->parameters().scalar_limits;
+    if (kv.second < limits.value_lower_limit - limits.value_limit_threshold ||
+        kv.second > limits.value_upper_limit + limits.value_limit_threshold)
+      return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+void AnalyticalIKRegistry::add(const AnalyticalIKSolverSharedPtr &solver) {
+  solvers_[{solver->baseLinkName(), solver->endEffectorLinkName()}] = solver;
+}
+
+/* ************************************************************************* */
+AnalyticalIKSolverSharedPtr AnalyticalIKRegistry::find(
+    const Robot &robot, const std::string &end_effector) const {
+  for (auto &&kv : solvers_) {
+    if (kv.first.second != end_effector) continue;
+    const auto base = FindLink(robot, kv.first.first);
+    if (base && base->isFixed() && kv.second->matches(robot)) return kv.second;
+  }
+  return nullptr;
+}
+
+}  // namespace gtdynamics
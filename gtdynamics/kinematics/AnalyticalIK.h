@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticalIK.h
+ * @brief Registry of closed-form inverse kinematics solvers.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Joint angles by joint name.
+using JointAngleMap = std::map<std::string, double>;
+
+/**
+ * Closed-form inverse kinematics for the serial chain between a base link
+ * and an end-effector link of a robot, e.g. generated by IKFast.
+ */
+class AnalyticalIKSolver {
+ public:
+  virtual ~AnalyticalIKSolver() {}
+
+  /// Name of the base link of the chain.
+  virtual std::string baseLinkName() const = 0;
+
+  /// Name of the end-effector link of the chain.
+  virtual std::string endEffectorLinkName() const = 0;
+
+  /// Whether the solver applies to the robot, by default if both links exist.
+  virtual bool matches(const Robot &robot) const;
+
+  /**
+   * Solve for the joint angles of the chain.
+   * @param robot the robot, for frames and joint limits
+   * @param bTe   end-effector CoM pose in the base link CoM frame
+   * @returns all solutions found, possibly none
+   */
+  virtual std::vector<JointAngleMap> solve(const Robot &robot,
+                                           const gtsam::Pose3 &bTe) const = 0;
+
+ protected:
+  /// End-effector link frame in the base link frame, given bTe as in solve.
+  gtsam::Pose3 linkFramePose(const Robot &robot,
+                             const gtsam::Pose3 &bTe) const;
+
+  /// Whether all joint angles of a solution are within the joint limits.
+  static bool WithinLimits(const Robot &robot, const JointAngleMap &solution);
+};
+
+using AnalyticalIKSolverSharedPtr = boost::shared_ptr<const AnalyticalIKSolver>;
+
+/**
+ * Analytical IK solvers keyed by the (base link, end-effector link) names of
+ * their chain.
+ */
+class AnalyticalIKRegistry {
+ private:
+  std::map<std::pair<std::string, std::string>, AnalyticalIKSolverSharedPtr>
+      solvers_;
+
+ public:
+  /// Add a solver, replacing any solver for the same chain.
+  void add(const AnalyticalIKSolverSharedPtr &solver);
+
+  /**
+   * Find a solver for a chain ending at the given link that matches the
+   * robot and whose base link is fixed in it.
+   * @returns the solver, or null
+   */
+  AnalyticalIKSolverSharedPtr find(const Robot &robot,
+                                   const std::string &end_effector) const;
+
+  /// Number of solvers.
+  size_t size() const { return solvers_.size(); }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArmIK.cpp
+ * @brief Closed-form inverse kinematics for the UR5 and Fanuc LR Mate arms.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/kinematics/ArmIK.h>
+
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace gtdynamics {
+
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+// Angle wrapped to (-pi, pi].
+static double Wrap(double angle) {
+  return std::atan2(std::sin(angle), std::cos(angle));
+}
+
+// Whether the robot has joints with all the given names.
+static bool HasJoints(const Robot &robot,
+                      const std::vector<std::string> &names) {
+  const auto &joints = robot.joints();
+  return std::all_of(names.begin(), names.end(), [&](const std::string &name) {
+    return std::any_of(
+        joints.begin(), joints.end(),
+        [&name](const JointSharedPtr &joint) { return joint->name() == name; });
+  });
+}
+
+// Solution from joint angles, or nothing if outside the joint limits.
+static void AddSolution(const Robot &robot,
+                        const std::vector<std::string> &names,
+                        const std::vector<double> &q,
+                        std::vector<JointAngleMap> *solutions) {
+  JointAngleMap solution;
+  for (size_t i = 0; i < names.size(); i++) solution[names[i]] = Wrap(q[i]);
+  if (AnalyticalIKSolver::WithinLimits(robot, solution)) {
+    solutions->push_back(solution);
+  }
+}
+
+namespace ur5 {
+const std::vector<std::string> kJointNames{
+    "shoulder_pan_joint", "shoulder_lift_joint", "elbow_joint",
+    "wrist_1_joint",      "wrist_2_joint",       "wrist_3_joint"};
+const double d1 = 0.089159;  // shoulder height
+const double a2 = 0.425;     // upper arm length
+const double a3 = 0.39225;   // forearm length
+const double d4 = 0.10915;   // shoulder to wrist offset, along the lift axis
+const double d5 = 0.09465;   // wrist_2 joint to wrist_3 joint
+}  // namespace ur5
+
+/* ************************************************************************* */
+bool UR5IKSolver::matches(const Robot &robot) const {
+  return AnalyticalIKSolver::matches(robot) &&
+         HasJoints(robot, ur5::kJointNames);
+}
+
+/* ************************************************************************* */
+std::vector<JointAngleMap> UR5IKSolver::solve(const Robot &robot,
+                                              const Pose3 &bTe) const {
+  using namespace ur5;
+  // With q234 the sum of the three parallel joint angles and b = q234 + pi,
+  // the wrist_3 frame is Rz(q1) Ry(b) Rz(q5) Ry(q6) at p6, with
+  // p6 . y1 = d4 for the lift axis y1 = Rz(q1) e_y.
+  const Pose3 pose = linkFramePose(robot, bTe);
+  const Matrix3 R = pose.rotation().matrix();
+  const Point3 p6 = pose.translation();
+
+  std::vector<JointAngleMap> solutions;
+  const double rho = std::hypot(p6.x(), p6.y());
+  if (rho < d4) return solutions;
+  const double psi = std::atan2(p6.y(), p6.x()), phi = std::asin(d4 / rho);
+  for (double q1 : {psi - phi, psi - M_PI + phi}) {
+    const Rot3 base_R_shoulder = Rot3::Rz(q1);
+    const Matrix3 M = base_R_shoulder.matrix().transpose() * R;
+    const double c5 = std::max(-1.0, std::min(1.0, M(1, 1)));
+    for (double q5 : {std::acos(c5), -std::acos(c5)}) {
+      const double s5 = std::sin(q5);
+      double q6, b;
+      if (std::abs(s5) > 1e-9) {
+        q6 = std::atan2(M(1, 2) / s5, M(1, 0) / s5);
+        b = std::atan2(M(2, 1) / s5, -M(0, 1) / s5);
+      } else {
+        // Singular wrist: only b + q6 or b - q6 is determined.
+        q6 = 0;
+        const Matrix3 N = M * Rot3::Rz(q5).matrix().transpose();
+        b = std::atan2(N(0, 2), N(0, 0));
+      }
+
+      // Wrist_2 joint in the shoulder frame, relative to the lift joint.
+      const Point3 z4(std::sin(b), 0, std::cos(b));
+      const Point3 p5 = base_R_shoulder.unrotate(p6) - d5 * z4;
+      const double x = p5.x(), z = p5.z() - d1;
+      const double c3 = (x * x + z * z - a2 * a2 - a3 * a3) / (2 * a2 * a3);
+      if (std::abs(c3) > 1) continue;
+      for (double q3 : {std::acos(c3), -std::acos(c3)}) {
+        const double elbow =
+            std::atan2(a3 * std::sin(q3), a2 + a3 * std::cos(q3));
+        const double q2 = std::atan2(x, z) - elbow - M_PI_2;
+        const double q4 = b - M_PI - q2 - q3;
+        AddSolution(robot, kJointNames, {q1, q2, q3, q4, q5, q6}, &solutions);
+      }
+    }
+  }
+  return solutions;
+}
+
+namespace lrmate {
+const std::vector<std::string> kJointNames{
+    "Base_Part2", "Part2_Part3", "Part3_Part4", "Part4_Part5", "Part6_Part6"};
+const Point3 kWaist(0.105, 0.09, 0.16859);  // waist joint in base_link
+const double kShoulderX = 0.05085, kShoulderZ = 0.16872;  // from the waist
+const double kUpperArm = 0.44;  // shoulder to elbow
+// Elbow to wrist center, in the elbow frame.
+const double kForearmX = 0.425, kForearmZ = 0.025;
+}  // namespace lrmate
+
+/* ************************************************************************* */
+bool FanucLRMateIKSolver::matches(const Robot &robot) const {
+  return AnalyticalIKSolver::matches(robot) &&
+         HasJoints(robot, lrmate::kJointNames);
+}
+
+/* ************************************************************************* */
+std::vector<JointAngleMap> FanucLRMateIKSolver::solve(const Robot &robot,
+                                                      const Pose3 &bTe) const {
+  using namespace lrmate;
+  // The Part6 frame is Rz(q1) Ry(q2 + q3) Rx(q4) Ry(q5) at the wrist center,
+  // which only depends on q1, q2 and q3.
+  const Pose3 pose = linkFramePose(robot, bTe);
+  const Matrix3 R = pose.rotation().matrix();
+  const Point3 d = pose.translation() - kWaist;
+
+  std::vector<JointAngleMap> solutions;
+  const double psi = std::atan2(d.y(), d.x()), rho = std::hypot(d.x(), d.y());
+  const double L = std::hypot(kForearmX, kForearmZ);
+  const double phi = std::atan2(kForearmZ, kForearmX);
+  for (double sign : {1.0, -1.0}) {
+    const double q1 = sign > 0 ? psi : psi + M_PI;
+    // Wrist center in the arm plane, relative to the shoulder.
+    const double u = sign * rho - kShoulderX, w = d.z() - kShoulderZ;
+    const double k =
+        (u * u + w * w - kUpperArm * kUpperArm - L * L) / (2 * kUpperArm * L);
+    if (std::abs(k) > 1) continue;
+    for (double q3 : {phi - std::asin(k), phi - M_PI + std::asin(k)}) {
+      const double vx = kForearmX * std::cos(q3) + kForearmZ * std::sin(q3);
+      const double vz =
+          kUpperArm - kForearmX * std::sin(q3) + kForearmZ * std::cos(q3);
+      const double q2 = std::atan2(u, w) - std::atan2(vx, vz);
+
+      // Roll-pitch wrist: R = R3 Rx(q4) Ry(q5), if reachable at all.
+      const Matrix3 M =
+          (Rot3::Rz(q1) * Rot3::Ry(q2 + q3)).matrix().transpose() * R;
+      const double q4 = std::atan2(M(2, 1), M(1, 1));
+      const double q5 = std::atan2(M(0, 2), M(0, 0));
+      const Matrix3 error = (Rot3::Rx(q4) * Rot3::Ry(q5)).matrix() - M;
+      if (error.cwiseAbs().maxCoeff() > tolerance_) continue;
+      AddSolution(robot, kJointNames, {q1, q2, q3, q4, q5}, &solutions);
+    }
+  }
+  return solutions;
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<AnalyticalIKRegistry> ArmIKRegistry() {
+  auto registry = boost::make_shared<AnalyticalIKRegistry>();
+  registry->add(boost::make_shared<UR5IKSolver>());
+  registry->add(boost::make_shared<FanucLRMateIKSolver>());
+  return registry;
+}
+
+}  // namespace gtdynamics
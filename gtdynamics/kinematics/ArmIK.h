@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArmIK.h
+ * @brief Closed-form inverse kinematics for the UR5 and Fanuc LR Mate arms.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/AnalyticalIK.h>
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Closed-form IK for the UR5 URDF chain from base_link to wrist_3_link, with
+ * the link lengths of models/urdfs/ur5. Returns up to 8 solutions (shoulder,
+ * wrist and elbow flips), with angles in (-pi, pi], dropping solutions
+ * outside the URDF joint limits. With the wrist singular (wrist_2_joint at
+ * 0 or pi), wrist_3_joint is set to 0.
+ */
+class UR5IKSolver : public AnalyticalIKSolver {
+ public:
+  std::string baseLinkName() const override { return "base_link"; }
+  std::string endEffectorLinkName() const override { return "wrist_3_link"; }
+
+  /// Matches robots with the UR5 joint names.
+  bool matches(const Robot &robot) const override;
+
+  std::vector<JointAngleMap> solve(const Robot &robot,
+                                   const gtsam::Pose3 &bTe) const override;
+};
+
+/**
+ * Closed-form IK for the Fanuc LR Mate 200iD URDF chain from base_link to
+ * Part6, with the link lengths of models/urdfs/fanuc_lrmate200id.urdf. The
+ * URDF arm has 5 joints, a waist, shoulder and elbow placing the wrist
+ * center and a roll-pitch wrist, so only goals whose orientation the wrist
+ * can reach are solved: up to 4 position solutions are computed, and those
+ * missing the goal orientation by more than the tolerance are dropped.
+ */
+class FanucLRMateIKSolver : public AnalyticalIKSolver {
+ private:
+  double tolerance_;
+
+ public:
+  /**
+   * Constructor.
+   * @param tolerance largest entry of the rotation error matrix accepted
+   */
+  explicit FanucLRMateIKSolver(double tolerance = 1e-6)
+      : tolerance_(tolerance) {}
+
+  std::string baseLinkName() const override { return "base_link"; }
+  std::string endEffectorLinkName() const override { return "Part6"; }
+
+  /// Matches robots with the LR Mate joint names.
+  bool matches(const Robot &robot) const override;
+
+  std::vector<JointAngleMap> solve(const Robot &robot,
+                                   const gtsam::Pose3 &bTe) const override;
+};
+
+/// Registry with the closed-form solvers of all arms in this file.
+boost::shared_ptr<AnalyticalIKRegistry> ArmIKRegistry();
+
+}  // namespace gtdynamics
@@ -13,10 +13,15 @@
 
 #pragma once
 
+#include <gtdynamics/kinematics/AnalyticalIK.h>
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/NoiseModels.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
@@ -65,18 +70,78 @@ struct ContactGoal {
 ///< Map of link name to ContactGoal
 using ContactGoals = std::vector<ContactGoal>;
 
+/**
+ * @fn Check contact goals at time steps [k_start, k_end) of a trajectory at
+ * once, with PredictPoints.
+ * @param contact_goals goals to check.
+ * @param buffer trajectory with link poses.
+ * @param k_start first time step.
+ * @param k_end one past the last time step.
+ * @param tol tolerance in 3D (default 1e-9).
+ * @returns goals x steps array, true where ContactGoal::satisfied is.
+ */
+Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> ContactGoalsSatisfied(
+    const ContactGoals& contact_goals, const TrajectoryBuffer& buffer,
+    size_t k_start, size_t k_end, double tol = 1e-9);
+
+/// Desired world CoM pose for a given link.
+struct PoseGoal {
+  LinkSharedPtr link;  ///< Link whose CoM pose is specified.
+  gtsam::Pose3 wTcom;  ///< Desired CoM pose in world frame.
+
+  /// Constructor
+  PoseGoal(const LinkSharedPtr& link, const gtsam::Pose3& wTcom)
+      : link(link), wTcom(wTcom) {}
+
+  /**
+   * @fn Check that the pose goal has been achieved for given values.
+   * @param values a GTSAM Values instance that should contain link pose.
+   * @param k time step to check (default 0).
+   * @param tol tolerance on the pose error (default 1e-9).
+   */
+  bool satisfied(const gtsam::Values& values, size_t k = 0,
+                 double tol = 1e-9) const {
+    return wTcom.equals(Pose(values, link->id(), k), tol);
+  }
+};
+
+using PoseGoals = std::vector<PoseGoal>;
+
+/// How the slices of an Interval are solved by inverse and interpolate.
+enum class SliceExecution {
+  Serial,     // one slice after the other, each from its own initial values
+  Parallel,   // slices distributed over threads, same results as Serial
+  Pipelined,  // consecutive chunks in parallel, each slice in a chunk
+              // warm-started from the solution of the previous slice
+};
+
 /// Noise models etc specific to Kinematics class
 struct KinematicsParameters : public OptimizationParameters {
   using Isotropic = gtsam::noiseModel::Isotropic;
   const gtsam::SharedNoiseModel p_cost_model,  // pose factor
       g_cost_model,                            // goal point
-      prior_q_cost_model;                      // joint angle prior factor
+      prior_q_cost_model,                      // joint angle prior factor
+      pose_goal_cost_model;                    // goal pose
+
+  SliceExecution slice_execution = SliceExecution::Serial;
+  // Build and solve the phases of a Trajectory in parallel, merged in phase
+  // order, so with the same results as one phase after the other.
+  bool parallel_phases = false;
+  // For Parallel and Pipelined slices and parallel phases, 0 for all cores.
+  size_t num_threads = 0;
+
+  /// Closed-form solvers tried first for a single pose goal, if given.
+  boost::shared_ptr<const AnalyticalIKRegistry> analytical_ik;
+  /// Refine closed-form solutions with the factor graph, using them only as
+  /// initial values.
+  bool refine_analytical_ik = false;
 
   // TODO(yetong): replace noise model with tolerance.
   KinematicsParameters()
-      : p_cost_model(Isotropic::Sigma(6, 1e-4)),
-        g_cost_model(Isotropic::Sigma(3, 0.01)),
-        prior_q_cost_model(Isotropic::Sigma(1, 0.5)) {}
+      : p_cost_model(SharedIsotropic(6, 1e-4)),
+        g_cost_model(SharedIsotropic(3, 0.01)),
+        prior_q_cost_model(SharedIsotropic(1, 0.5)),
+        pose_goal_cost_model(SharedIsotropic(6, 1e-3)) {}
 };
 
 /// All things kinematics, zero velocities/twists, and no forces.
@@ -105,7 +170,7 @@ class Kinematics : public Optimizer {
    * @fn Create kinematics constraints.
    * @param context Slice or Interval instance.
    * @param robot Robot specification from URDF/SDF.
-   * @returns Equality constraints.
+   * @returns Equality constraints, grouped by GroupEqualityConstraints.
    */
   template <class CONTEXT>
   EqualityConstraints constraints(const CONTEXT& context,
@@ -125,12 +190,23 @@ class Kinematics : public Optimizer {
    * @fn Create point goal constraints.
    * @param context Slice or Interval instance.
    * @param contact_goals goals for contact points
-   * @returns Equality constraints with point goal constraints.
+   * @returns Equality constraints with point goal constraints, one per link
+   * and time step: goals on the same link are grouped.
    */
   template <class CONTEXT>
   EqualityConstraints pointGoalConstraints(
       const CONTEXT& context, const ContactGoals& contact_goals) const;
 
+  /**
+   * @fn Create pose goal objectives.
+   * @param context Slice or Interval instance.
+   * @param pose_goals goals for link poses
+   * @returns graph with pose prior factors.
+   */
+  template <class CONTEXT>
+  gtsam::NonlinearFactorGraph poseGoalObjectives(
+      const CONTEXT& context, const PoseGoals& pose_goals) const;
+
   /**
    * @fn Factors that minimize joint angles.
    * @param context Slice or Interval instance.
@@ -169,6 +245,37 @@ class Kinematics : public Optimizer {
                         const ContactGoals& contact_goals,
                         bool contact_goals_as_constraints = true) const;
 
+  /**
+   * @fn Inverse kinematics on a slice, starting from given values.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals goals for contact points
+   * @param initial_values initial poses and joint angles at slice.k
+   * @param contact_goals_as_constraints treat contact goal as hard constraints
+   * @returns values with poses and joint angles.
+   */
+  gtsam::Values inverse(const Slice& slice, const Robot& robot,
+                        const ContactGoals& contact_goals,
+                        const gtsam::Values& initial_values,
+                        bool contact_goals_as_constraints = true) const;
+
+  /**
+   * @fn Inverse kinematics on a slice given link pose goals.
+   *
+   * A single goal on a link for which `analytical_ik` has a solver is solved
+   * in closed form, choosing the solution with the smallest joint angles and
+   * setting the other joints to zero. Otherwise, or if no closed-form
+   * solution exists, the factor graph is optimized, starting from the
+   * closed-form solution when `refine_analytical_ik` is set.
+   *
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param pose_goals goals for link poses
+   * @returns values with poses and joint angles.
+   */
+  gtsam::Values inverse(const Slice& slice, const Robot& robot,
+                        const PoseGoals& pose_goals) const;
+
   /**
    * Interpolate using inverse kinematics: the goals are linearly interpolated.
    * @param context Interval instance
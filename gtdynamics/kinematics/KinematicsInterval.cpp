@@ -13,10 +13,15 @@
 
 #include <gtdynamics/kinematics/Kinematics.h>
 #include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/Parallel.h>
 #include <gtdynamics/utils/Slice.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
@@ -24,6 +29,53 @@ using gtsam::Values;
 using std::string;
 using std::vector;
 
+// Solve each slice of an interval with solve(k, warm_start), where warm_start
+// is the solution of the previous slice moved to time k in pipelined mode and
+// null otherwise, and collect the results in time order.
+static Values SolveSlices(
+    const Interval& interval, const KinematicsParameters& parameters,
+    const std::function<Values(size_t, const Values*)>& solve) {
+  const size_t n = interval.k_end + 1 - interval.k_start;
+  vector<Values> results(n);
+  switch (parameters.slice_execution) {
+    case SliceExecution::Serial:
+      for (size_t i = 0; i < n; i++)
+        results[i] = solve(interval.k_start + i, nullptr);
+      break;
+    case SliceExecution::Parallel:
+      ParallelFor(n, parameters.num_threads, [&](size_t i) {
+        results[i] = solve(interval.k_start + i, nullptr);
+      });
+      break;
+    case SliceExecution::Pipelined: {
+      size_t num_chunks = parameters.num_threads;
+      if (num_chunks == 0) num_chunks = std::thread::hardware_concurrency();
+      num_chunks = std::min(std::max<size_t>(num_chunks, 1), n);
+      ParallelFor(num_chunks, num_chunks, [&](size_t c) {
+        const size_t begin = c * n / num_chunks, end = (c + 1) * n / num_chunks;
+        for (size_t i = begin; i < end; i++) {
+          const size_t k = interval.k_start + i;
+          if (i == begin) {
+            results[i] = solve(k, nullptr);
+            continue;
+          }
+          Values warm_start;
+          for (const auto& key_value : results[i - 1]) {
+            warm_start.insert(DynamicsSymbol(key_value.key).atTime(k),
+                              key_value.value);
+          }
+          results[i] = solve(k, &warm_start);
+        }
+      });
+      break;
+    }
+  }
+
+  Values values;
+  for (auto&& result : results) values.insert(result);
+  return values;
+}
+
 template <>
 NonlinearFactorGraph Kinematics::graph<Interval>(const Interval& interval,
                                                  const Robot& robot) const {
@@ -64,6 +116,16 @@ EqualityConstraints Kinematics::pointGoalConstraints<Interval>(
   return constraints;
 }
 
+template <>
+NonlinearFactorGraph Kinematics::poseGoalObjectives<Interval>(
+    const Interval& interval, const PoseGoals& pose_goals) const {
+  NonlinearFactorGraph graph;
+  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
+    graph.add(poseGoalObjectives(Slice(k), pose_goals));
+  }
+  return graph;
+}
+
 template <>
 NonlinearFactorGraph Kinematics::jointAngleObjectives<Interval>(
     const Interval& interval, const Robot& robot) const {
@@ -90,12 +152,13 @@ Values Kinematics::inverse<Interval>(const Interval& interval,
                                      const Robot& robot,
                                      const ContactGoals& contact_goals,
                                      bool contact_goals_as_constraints) const {
-  Values results;
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    results.insert(
-        inverse(Slice(k), robot, contact_goals, contact_goals_as_constraints));
-  }
-  return results;
+  return SolveSlices(interval, p_, [&](size_t k, const Values* warm_start) {
+    const Slice slice(k);
+    return warm_start ? inverse(slice, robot, contact_goals, *warm_start,
+                                contact_goals_as_constraints)
+                      : inverse(slice, robot, contact_goals,
+                                contact_goals_as_constraints);
+  });
 }
 
 template <>
@@ -103,9 +166,8 @@ Values Kinematics::interpolate<Interval>(
     const Interval& interval, const Robot& robot,
     const ContactGoals& contact_goals1,
     const ContactGoals& contact_goals2) const {
-  Values result;
   const double dt = 1.0 / (interval.k_start - interval.k_end);  // 5 6 7 8 9 [10
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
+  return SolveSlices(interval, p_, [&](size_t k, const Values* warm_start) {
     const double t = dt * (k - interval.k_start);
     ContactGoals goals;
     transform(contact_goals1.begin(), contact_goals1.end(),
@@ -115,9 +177,10 @@ Values Kinematics::interpolate<Interval>(
                     goal1.point_on_link,
                     (1.0 - t) * goal1.goal_point + t * goal2.goal_point};
               });
-    result.insert(inverse(Slice(k), robot, goals));
-  }
-  return result;
+    const Slice slice(k);
+    return warm_start ? inverse(slice, robot, goals, *warm_start)
+                      : inverse(slice, robot, goals);
+  });
 }
 
 }  // namespace gtdynamics
@@ -15,10 +15,13 @@
 #include <gtdynamics/factors/PoseFactor.h>
 #include <gtdynamics/kinematics/Kinematics.h>
 #include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <limits>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
@@ -34,9 +37,31 @@ void ContactGoal::print(const std::string& s) const {
   std::cout << (s.empty() ? s : s + " ") << *this;
 }
 
+Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> ContactGoalsSatisfied(
+    const ContactGoals& contact_goals, const TrajectoryBuffer& buffer,
+    size_t k_start, size_t k_end, double tol) {
+  PointOnLinks points;
+  for (const ContactGoal& goal : contact_goals) {
+    points.push_back(goal.point_on_link);
+  }
+  const PointOnLinksPrediction prediction =
+      PredictPoints(points, buffer, k_start, k_end);
+  Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> satisfied(
+      contact_goals.size(), k_end - k_start);
+  for (size_t i = 0; i < contact_goals.size(); i++) {
+    for (size_t k = k_start; k < k_end; k++) {
+      const double distance = gtsam::distance3(prediction.position(i, k),
+                                               contact_goals[i].goal_point);
+      satisfied(i, k - k_start) = distance < tol;
+    }
+  }
+  return satisfied;
+}
+
 template <>
 NonlinearFactorGraph Kinematics::graph<Slice>(const Slice& slice,
                                               const Robot& robot) const {
+  GTDYNAMICS_TRACE_SCOPE_ARG("Kinematics::graph", slice.k);
   NonlinearFactorGraph graph;
 
   // Constrain kinematics at joints.
@@ -63,7 +88,7 @@ EqualityConstraints Kinematics::constraints<Slice>(const Slice& slice,
                                                             tolerance);
   }
 
-  return constraints;
+  return GroupEqualityConstraints(constraints);
 }
 
 template <>
@@ -95,7 +120,19 @@ EqualityConstraints Kinematics::pointGoalConstraints<Slice>(
     constraints.emplace_shared<VectorExpressionEquality<3>>(constraint_expr,
                                                             tolerance);
   }
-  return constraints;
+  // Goals on the same link share its pose key, and become one constraint.
+  return GroupEqualityConstraints(constraints);
+}
+
+template <>
+NonlinearFactorGraph Kinematics::poseGoalObjectives<Slice>(
+    const Slice& slice, const PoseGoals& pose_goals) const {
+  NonlinearFactorGraph graph;
+  for (const PoseGoal& goal : pose_goals) {
+    graph.addPrior<gtsam::Pose3>(PoseKey(goal.link->id(), slice.k),
+                                 goal.wTcom, p_.pose_goal_cost_model);
+  }
+  return graph;
 }
 
 template <>
@@ -139,6 +176,15 @@ template <>
 Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
                                   const ContactGoals& contact_goals,
                                   bool contact_goals_as_constraints) const {
+  return inverse(slice, robot, contact_goals, initialValues(slice, robot),
+                 contact_goals_as_constraints);
+}
+
+Values Kinematics::inverse(const Slice& slice, const Robot& robot,
+                           const ContactGoals& contact_goals,
+                           const Values& initial_values,
+                           bool contact_goals_as_constraints) const {
+  GTDYNAMICS_TRACE_SCOPE_ARG("Kinematics::inverse", slice.k);
   // Robot kinematics constraints
   auto constraints = this->constraints(slice, robot);
   NonlinearFactorGraph graph;
@@ -157,8 +203,54 @@ Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
   // graph.addPrior<gtsam::Pose3>(PoseKey(0, slice.k),
   // gtsam::Pose3(), nullptr);
 
-  auto initial_values = initialValues(slice, robot);
-
   return optimize(graph, constraints, initial_values);
 }
+Values Kinematics::inverse(const Slice& slice, const Robot& robot,
+                           const PoseGoals& pose_goals) const {
+  boost::optional<Values> analytical;
+  if (p_.analytical_ik && pose_goals.size() == 1) {
+    const PoseGoal& goal = pose_goals.front();
+    const auto solver = p_.analytical_ik->find(robot, goal.link->name());
+    if (solver) {
+      const auto base = robot.link(solver->baseLinkName());
+      const auto solutions =
+          solver->solve(robot, base->getFixedPose().between(goal.wTcom));
+
+      // Closest to the joint angle objectives, which pull towards zero.
+      const JointAngleMap* best = nullptr;
+      double best_norm = std::numeric_limits<double>::infinity();
+      for (const JointAngleMap& solution : solutions) {
+        double norm = 0.0;
+        for (auto&& kv : solution) norm += kv.second * kv.second;
+        if (norm < best_norm) {
+          best = &solution;
+          best_norm = norm;
+        }
+      }
+
+      if (best) {
+        Values joint_angles;
+        for (auto&& joint : robot.joints()) {
+          auto it = best->find(joint->name());
+          InsertJointAngle(&joint_angles, joint->id(), slice.k,
+                           it == best->end() ? 0.0 : it->second);
+        }
+        const Values fk = robot.forwardKinematics(joint_angles, slice.k);
+        analytical = joint_angles;
+        for (auto&& link : robot.links()) {
+          InsertPose(&*analytical, link->id(), slice.k,
+                     Pose(fk, link->id(), slice.k));
+        }
+        if (!p_.refine_analytical_ik) return *analytical;
+      }
+    }
+  }
+
+  auto constraints = this->constraints(slice, robot);
+  NonlinearFactorGraph graph = poseGoalObjectives(slice, pose_goals);
+  graph.add(jointAngleObjectives(slice, robot));
+  return optimize(graph, constraints,
+                  analytical ? *analytical : initialValues(slice, robot));
+}
+
 }  // namespace gtdynamics
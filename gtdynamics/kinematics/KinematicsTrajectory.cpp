@@ -12,11 +12,15 @@
  */
 
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/Parallel.h>
 #include <gtdynamics/utils/Slice.h>
 #include <gtdynamics/utils/Trajectory.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+#include <functional>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
@@ -24,65 +28,109 @@ using gtsam::Values;
 using std::string;
 using std::vector;
 
-template <>
-NonlinearFactorGraph Kinematics::graph<Trajectory>(const Trajectory& trajectory,
-                                                   const Robot& robot) const {
-  NonlinearFactorGraph graph;
+// Call f(p) for every phase p of a trajectory, on the threads of the
+// parameters if parallel_phases is set, and return the results in phase
+// order, so that merging them gives the same result as a serial loop.
+template <class T>
+static vector<T> MapPhases(const Trajectory& trajectory,
+                           const KinematicsParameters& parameters,
+                           const std::function<T(size_t)>& f) {
+  vector<T> results(trajectory.numPhases());
+  ParallelFor(results.size(),
+              parameters.parallel_phases ? parameters.num_threads : 1,
+              [&](size_t p) { results[p] = f(p); });
+  return results;
+}
+
+// The time steps of every phase that no earlier phase has, e.g. without the
+// transition step a phase shares with the previous one; empty if k_start >
+// k_end.
+static vector<Interval> NewSteps(const Trajectory& trajectory) {
+  vector<Interval> intervals;
+  size_t next = 0;
   for (auto&& phase : trajectory.phases()) {
-    graph.add(this->graph<Interval>(phase, robot));
+    intervals.emplace_back(std::max(phase.k_start, next), phase.k_end);
+    next = std::max(next, phase.k_end + 1);
+  }
+  return intervals;
+}
+
+// Insert values in phase order, keeping the values of earlier phases for
+// the time steps phases share.
+static Values Merge(const vector<Values>& phase_values) {
+  Values values;
+  for (auto&& phase : phase_values) {
+    for (auto&& key_value : phase) {
+      if (!values.exists(key_value.key))
+        values.insert(key_value.key, key_value.value);
+    }
   }
+  return values;
+}
+
+template <class GRAPH>
+static GRAPH Concatenate(const vector<GRAPH>& graphs) {
+  GRAPH graph;
+  for (auto&& phase_graph : graphs) graph.add(phase_graph);
   return graph;
 }
 
+template <>
+NonlinearFactorGraph Kinematics::graph<Trajectory>(const Trajectory& trajectory,
+                                                   const Robot& robot) const {
+  return Concatenate(MapPhases<NonlinearFactorGraph>(
+      trajectory, p_, [&](size_t p) {
+        return this->graph<Interval>(trajectory.phase(p), robot);
+      }));
+}
+
 template <>
 EqualityConstraints Kinematics::constraints<Trajectory>(const Trajectory& trajectory,
                                                    const Robot& robot) const {
-  EqualityConstraints constraints;
-  for (auto&& phase : trajectory.phases()) {
-    constraints.add(this->constraints<Interval>(phase, robot));
-  }
-  return constraints;
+  return Concatenate(MapPhases<EqualityConstraints>(
+      trajectory, p_, [&](size_t p) {
+        return this->constraints<Interval>(trajectory.phase(p), robot);
+      }));
 }
 
 template <>
 NonlinearFactorGraph Kinematics::pointGoalObjectives<Trajectory>(
     const Trajectory& trajectory, const ContactGoals& contact_goals) const {
-  NonlinearFactorGraph graph;
-  for (auto&& phase : trajectory.phases()) {
-    graph.add(pointGoalObjectives<Interval>(phase, contact_goals));
-  }
-  return graph;
+  return Concatenate(MapPhases<NonlinearFactorGraph>(
+      trajectory, p_, [&](size_t p) {
+        return pointGoalObjectives<Interval>(trajectory.phase(p),
+                                             contact_goals);
+      }));
 }
 
 template <>
 EqualityConstraints Kinematics::pointGoalConstraints<Trajectory>(
     const Trajectory& trajectory, const ContactGoals& contact_goals) const {
-  EqualityConstraints constraints;
-  for (auto&& phase : trajectory.phases()) {
-    constraints.add(pointGoalConstraints<Interval>(phase, contact_goals));
-  }
-  return constraints;
+  return Concatenate(MapPhases<EqualityConstraints>(
+      trajectory, p_, [&](size_t p) {
+        return pointGoalConstraints<Interval>(trajectory.phase(p),
+                                              contact_goals);
+      }));
 }
 
 template <>
 NonlinearFactorGraph Kinematics::jointAngleObjectives<Trajectory>(
     const Trajectory& trajectory, const Robot& robot) const {
-  NonlinearFactorGraph graph;
-  for (auto&& phase : trajectory.phases()) {
-    graph.add(jointAngleObjectives<Interval>(phase, robot));
-  }
-  return graph;
+  return Concatenate(MapPhases<NonlinearFactorGraph>(
+      trajectory, p_, [&](size_t p) {
+        return jointAngleObjectives<Interval>(trajectory.phase(p), robot);
+      }));
 }
 
 template <>
 Values Kinematics::initialValues<Trajectory>(const Trajectory& trajectory,
                                              const Robot& robot,
                                              double gaussian_noise) const {
-  Values values;
-  for (auto&& phase : trajectory.phases()) {
-    values.insert(initialValues<Interval>(phase, robot, gaussian_noise));
-  }
-  return values;
+  const vector<Interval> intervals = NewSteps(trajectory);
+  return Merge(MapPhases<Values>(trajectory, p_, [&](size_t p) -> Values {
+    if (intervals[p].k_start > intervals[p].k_end) return Values();
+    return initialValues<Interval>(intervals[p], robot, gaussian_noise);
+  }));
 }
 
 template <>
@@ -90,12 +138,12 @@ Values Kinematics::inverse<Trajectory>(
     const Trajectory& trajectory, const Robot& robot,
     const ContactGoals& contact_goals,
     bool contact_goals_as_constraints) const {
-  Values results;
-  for (auto&& phase : trajectory.phases()) {
-    results.insert(inverse<Interval>(phase, robot, contact_goals,
-                                     contact_goals_as_constraints));
-  }
-  return results;
+  const vector<Interval> intervals = NewSteps(trajectory);
+  return Merge(MapPhases<Values>(trajectory, p_, [&](size_t p) -> Values {
+    if (intervals[p].k_start > intervals[p].k_end) return Values();
+    return inverse<Interval>(intervals[p], robot, contact_goals,
+                             contact_goals_as_constraints);
+  }));
 }
 
 template <>
@@ -103,12 +151,12 @@ Values Kinematics::interpolate<Trajectory>(
     const Trajectory& trajectory, const Robot& robot,
     const ContactGoals& contact_goals1,
     const ContactGoals& contact_goals2) const {
-  Values results;
-  for (auto&& phase : trajectory.phases()) {
-    results.insert(
-        interpolate<Interval>(phase, robot, contact_goals1, contact_goals2));
-  }
-  return results;
+  // Every phase interpolates over all its steps, so shared steps are solved
+  // by each phase, and the earlier one is kept.
+  return Merge(MapPhases<Values>(trajectory, p_, [&](size_t p) {
+    return interpolate<Interval>(trajectory.phase(p), robot, contact_goals1,
+                                 contact_goals2);
+  }));
 }
 
 }  // namespace gtdynamics
@@ -0,0 +1,410 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SamplingPlanner.cpp
+ * @brief Sampling-based joint-space motion planning, to seed trajectory
+ * optimization.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/kinematics/SamplingPlanner.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+
+typedef std::vector<Vector> Path;
+
+// Tree of RRT-Connect, with the parent index of every node.
+struct Tree {
+  Path nodes;
+  std::vector<int> parents;
+
+  explicit Tree(const Vector &root) : nodes{root}, parents{-1} {}
+
+  size_t nearest(const Vector &q) const {
+    size_t best = 0;
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < nodes.size(); i++) {
+      const double d = (nodes[i] - q).squaredNorm();
+      if (d < best_distance) {
+        best_distance = d;
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  size_t add(const Vector &q, int parent) {
+    nodes.push_back(q);
+    parents.push_back(parent);
+    return nodes.size() - 1;
+  }
+
+  // Nodes from the root to node i.
+  Path pathTo(int i) const {
+    Path path;
+    for (; i >= 0; i = parents[i]) path.push_back(nodes[i]);
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+};
+
+// Move from a towards b by at most step.
+Vector Steer(const Vector &a, const Vector &b, double step) {
+  const double d = (b - a).norm();
+  return d <= step ? b : Vector(a + (b - a) * (step / d));
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+SamplingPlanner::SamplingPlanner(
+    const Robot &robot, const std::vector<CollisionSphere> &spheres,
+    const SamplingPlannerParameters &parameters,
+    const boost::optional<std::string> &prior_link_name,
+    const boost::optional<gtsam::Pose3> &root_pose)
+    : robot_(robot),
+      prior_link_name_(prior_link_name),
+      root_pose_(root_pose),
+      parameters_(parameters),
+      spheres_(spheres) {
+  const auto joints = robot_.joints();
+  lower_.resize(joints.size());
+  upper_.resize(joints.size());
+  for (size_t j = 0; j < joints.size(); j++) {
+    const JointScalarLimit &limits = joints[j]->parameters().scalar_limits;
+    lower_(j) = limits.value_lower_limit;
+    upper_(j) = limits.value_upper_limit;
+  }
+  const RobotTopology &topo = robot_.topology();
+  for (const CollisionSphere &sphere : spheres_) {
+    centers_.emplace_back(topo.links[topo.link_index.at(sphere.link_id)],
+                          sphere.comPc);
+  }
+  // Fail early on a missing root.
+  BatchForwardKinematics check(robot_, prior_link_name_);
+}
+
+/* ************************************************************************* */
+void SamplingPlanner::setJointLimits(const Vector &lower, const Vector &upper) {
+  if (lower.size() != lower_.size() || upper.size() != upper_.size()) {
+    throw std::invalid_argument(
+        "SamplingPlanner: joint limits do not match the robot");
+  }
+  lower_ = lower;
+  upper_ = upper;
+}
+
+/* ************************************************************************* */
+std::vector<bool> SamplingPlanner::checkRows(const Matrix &configurations,
+                                            size_t begin, size_t end) const {
+  const Matrix rows = configurations.middleRows(begin, end - begin);
+  BatchForwardKinematics fk(robot_, prior_link_name_);
+  fk.compute(rows, Matrix(), root_pose_);
+  const Matrix positions = fk.pointPositions(centers_);
+  const auto links = robot_.links();
+  std::vector<bool> free(rows.rows(), false);
+  for (int n = 0; n < rows.rows(); n++) {
+    bool ok = ((rows.row(n).transpose() - lower_).array() >= 0).all() &&
+              ((upper_ - rows.row(n).transpose()).array() >= 0).all();
+    if (ok && sdf_) {
+      for (size_t i = 0; ok && i < spheres_.size(); i++) {
+        const gtsam::Point3 center =
+            positions.block<1, 3>(n, 3 * i).transpose();
+        ok = sdf_->distance(center) >=
+             spheres_[i].radius + parameters_.clearance;
+      }
+    }
+    if (ok && self_collision_) {
+      Values poses;
+      for (auto &&link : links) {
+        InsertPose(&poses, link->id(), fk.pose(n, link->id()));
+      }
+      ok = self_collision_->nearPairs(poses, 0).empty();
+    }
+    free[n] = ok;
+  }
+  return free;
+}
+
+/* ************************************************************************* */
+std::vector<bool> SamplingPlanner::collisionFree(
+    const Matrix &configurations) const {
+  if (size_t(configurations.cols()) != robot_.numJoints()) {
+    throw std::invalid_argument(
+        "SamplingPlanner: configurations must be N x numJoints");
+  }
+  const size_t N = configurations.rows();
+  const size_t batch = std::max<size_t>(parameters_.batch_size, 1);
+  const size_t num_batches = (N + batch - 1) / batch;
+  // std::vector<bool> packs entries into shared words, so every batch fills
+  // its own vector and they are concatenated afterwards.
+  std::vector<std::vector<bool>> results(num_batches);
+  ParallelFor(num_batches, parameters_.num_threads, [&](size_t b) {
+    results[b] =
+        checkRows(configurations, b * batch, std::min(N, (b + 1) * batch));
+  });
+  std::vector<bool> free;
+  free.reserve(N);
+  for (auto &&result : results) {
+    free.insert(free.end(), result.begin(), result.end());
+  }
+  return free;
+}
+
+/* ************************************************************************* */
+bool SamplingPlanner::collisionFree(const Vector &q) const {
+  return collisionFree(Matrix(q.transpose())).front();
+}
+
+/* ************************************************************************* */
+Matrix SamplingPlanner::edgeConfigurations(const Vector &a,
+                                           const Vector &b) const {
+  const double length = (b - a).lpNorm<Eigen::Infinity>();
+  const int n = std::max(1, int(std::ceil(length / parameters_.resolution)));
+  Matrix configurations(n + 1, a.size());
+  for (int k = 0; k <= n; k++) {
+    configurations.row(k) = (a + (b - a) * (double(k) / n)).transpose();
+  }
+  return configurations;
+}
+
+/* ************************************************************************* */
+bool SamplingPlanner::motionFree(const Vector &a, const Vector &b) const {
+  const std::vector<bool> free = collisionFree(edgeConfigurations(a, b));
+  return std::all_of(free.begin(), free.end(), [](bool f) { return f; });
+}
+
+/* ************************************************************************* */
+template <class RNG>
+Matrix SamplingPlanner::sampleConfigurations(size_t n, RNG *rng) const {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  Matrix samples(n, lower_.size());
+  for (size_t i = 0; i < n; i++) {
+    for (int j = 0; j < lower_.size(); j++) {
+      samples(i, j) = lower_(j) + (upper_(j) - lower_(j)) * uniform(*rng);
+    }
+  }
+  return samples;
+}
+
+/* ************************************************************************* */
+Path SamplingPlanner::planRRTConnect(const Vector &start,
+                                     const Vector &goal) const {
+  if (!collisionFree(start) || !collisionFree(goal)) return {};
+  if (motionFree(start, goal)) return {start, goal};
+
+  std::mt19937_64 rng(parameters_.seed);
+  Tree trees[2] = {Tree(start), Tree(goal)};
+  int a = 0;  // tree extended towards the samples
+  const size_t batch = std::max<size_t>(parameters_.batch_size, 1);
+  for (size_t drawn = 0; drawn < parameters_.max_samples; drawn += batch) {
+    // Discard samples in collision in one batched check.
+    const Matrix samples = sampleConfigurations(batch, &rng);
+    const std::vector<bool> free = collisionFree(samples);
+    for (size_t s = 0; s < batch; s++) {
+      if (!free[s]) continue;
+      const Vector sample = samples.row(s).transpose();
+
+      // Extend tree a by one step towards the sample.
+      Tree &ta = trees[a], &tb = trees[1 - a];
+      const size_t near = ta.nearest(sample);
+      const Vector q_new = Steer(ta.nodes[near], sample, parameters_.step_size);
+      if (!motionFree(ta.nodes[near], q_new)) continue;
+      const size_t added = ta.add(q_new, near);
+
+      // Connect tree b to the new node, step by step.
+      size_t last = tb.nearest(q_new);
+      bool connected = false;
+      while (true) {
+        const Vector q = Steer(tb.nodes[last], q_new, parameters_.step_size);
+        if (!motionFree(tb.nodes[last], q)) break;
+        last = tb.add(q, last);
+        if (q == q_new) {
+          connected = true;
+          break;
+        }
+      }
+      if (connected) {
+        Path head = ta.pathTo(added), tail = tb.pathTo(last);
+        tail.pop_back();  // q_new is the end of head
+        head.insert(head.end(), tail.rbegin(), tail.rend());
+        if (a == 1) std::reverse(head.begin(), head.end());
+        return shortcut(head);
+      }
+      a = 1 - a;
+    }
+  }
+  return {};
+}
+
+/* ************************************************************************* */
+Path SamplingPlanner::planPRM(const Vector &start, const Vector &goal) const {
+  if (!collisionFree(start) || !collisionFree(goal)) return {};
+
+  // Free samples, with the start and goal as nodes 0 and 1.
+  std::mt19937_64 rng(parameters_.seed);
+  const Matrix samples = sampleConfigurations(parameters_.max_samples, &rng);
+  const std::vector<bool> free = collisionFree(samples);
+  Path nodes = {start, goal};
+  for (size_t s = 0; s < free.size(); s++) {
+    if (free[s]) nodes.push_back(samples.row(s).transpose());
+  }
+  const size_t num_nodes = nodes.size();
+
+  // Nearest neighbors of every node, in parallel.
+  const size_t k = std::min(parameters_.num_neighbors, num_nodes - 1);
+  std::vector<std::vector<size_t>> neighbors(num_nodes);
+  ParallelFor(num_nodes, parameters_.num_threads, [&](size_t i) {
+    std::vector<std::pair<double, size_t>> distances;
+    distances.reserve(num_nodes - 1);
+    for (size_t j = 0; j < num_nodes; j++) {
+      if (j != i) distances.emplace_back((nodes[i] - nodes[j]).norm(), j);
+    }
+    std::partial_sort(distances.begin(), distances.begin() + k,
+                      distances.end());
+    for (size_t m = 0; m < k; m++) neighbors[i].push_back(distances[m].second);
+  });
+
+  // Unique candidate edges, checked in parallel on one thread each.
+  std::vector<std::pair<size_t, size_t>> edges;
+  for (size_t i = 0; i < num_nodes; i++) {
+    for (size_t j : neighbors[i]) {
+      edges.emplace_back(std::min(i, j), std::max(i, j));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  std::vector<char> edge_free(edges.size(), 0);
+  ParallelFor(edges.size(), parameters_.num_threads, [&](size_t e) {
+    const Matrix configurations =
+        edgeConfigurations(nodes[edges[e].first], nodes[edges[e].second]);
+    const std::vector<bool> ok =
+        checkRows(configurations, 0, configurations.rows());
+    edge_free[e] = std::all_of(ok.begin(), ok.end(), [](bool f) { return f; });
+  });
+
+  // Dijkstra from the start to the goal over the free edges.
+  std::vector<std::vector<std::pair<size_t, double>>> adjacency(num_nodes);
+  for (size_t e = 0; e < edges.size(); e++) {
+    if (!edge_free[e]) continue;
+    const size_t i = edges[e].first, j = edges[e].second;
+    const double length = (nodes[i] - nodes[j]).norm();
+    adjacency[i].emplace_back(j, length);
+    adjacency[j].emplace_back(i, length);
+  }
+  std::vector<double> cost(num_nodes, std::numeric_limits<double>::infinity());
+  std::vector<int> previous(num_nodes, -1);
+  typedef std::pair<double, size_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  cost[0] = 0;
+  queue.emplace(0.0, 0);
+  while (!queue.empty()) {
+    const Entry top = queue.top();
+    queue.pop();
+    if (top.first > cost[top.second]) continue;
+    if (top.second == 1) break;
+    for (auto &&next : adjacency[top.second]) {
+      const double c = top.first + next.second;
+      if (c < cost[next.first]) {
+        cost[next.first] = c;
+        previous[next.first] = top.second;
+        queue.emplace(c, next.first);
+      }
+    }
+  }
+  if (previous[1] < 0) return {};
+  Path path;
+  for (int i = 1; i >= 0; i = previous[i]) path.push_back(nodes[i]);
+  std::reverse(path.begin(), path.end());
+  return shortcut(path);
+}
+
+/* ************************************************************************* */
+Path SamplingPlanner::shortcut(const Path &path) const {
+  Path result = path;
+  std::mt19937_64 rng(parameters_.seed + 1);
+  for (size_t it = 0; it < parameters_.shortcut_iterations && result.size() > 2;
+       it++) {
+    std::uniform_int_distribution<size_t> index(0, result.size() - 1);
+    size_t i = index(rng), j = index(rng);
+    if (i > j) std::swap(i, j);
+    if (j < i + 2) continue;
+    if (motionFree(result[i], result[j])) {
+      result.erase(result.begin() + i + 1, result.begin() + j);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values SamplingPlanner::toValues(const Path &path, size_t num_steps,
+                                 double dt) const {
+  if (path.empty()) {
+    throw std::invalid_argument("SamplingPlanner: empty path");
+  }
+
+  // Joint angles at equal distances along the path.
+  std::vector<double> arc(path.size(), 0.0);
+  for (size_t i = 1; i < path.size(); i++) {
+    arc[i] = arc[i - 1] + (path[i] - path[i - 1]).norm();
+  }
+  const size_t dof = robot_.numJoints();
+  Matrix angles(num_steps + 1, dof), vels = Matrix::Zero(num_steps + 1, dof);
+  size_t segment = 0;
+  for (size_t k = 0; k <= num_steps; k++) {
+    const double s = num_steps ? arc.back() * k / num_steps : 0.0;
+    while (segment + 2 < path.size() && arc[segment + 1] < s) segment++;
+    const size_t next = std::min(segment + 1, path.size() - 1);
+    const double length = arc[next] - arc[segment];
+    const double u =
+        length > 0 ? std::min(1.0, (s - arc[segment]) / length) : 0.0;
+    angles.row(k) =
+        (path[segment] + u * (path[next] - path[segment])).transpose();
+  }
+  for (size_t k = 1; k < num_steps; k++) {
+    vels.row(k) = (angles.row(k + 1) - angles.row(k - 1)) / (2 * dt);
+  }
+
+  BatchForwardKinematics fk(robot_, prior_link_name_);
+  fk.compute(angles, vels, root_pose_);
+  Initializer initializer;
+  Values values = initializer.ZeroValuesTrajectory(robot_, num_steps);
+  const auto joints = robot_.joints();
+  for (size_t k = 0; k <= num_steps; k++) {
+    for (size_t j = 0; j < dof; j++) {
+      values.update(JointAngleKey(joints[j]->id(), k), angles(k, j));
+      values.update(JointVelKey(joints[j]->id(), k), vels(k, j));
+    }
+    for (auto &&link : robot_.links()) {
+      values.update(PoseKey(link->id(), k), fk.pose(k, link->id()));
+      values.update(TwistKey(link->id(), k), fk.twist(k, link->id()));
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,165 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SamplingPlanner.h
+ * @brief Sampling-based joint-space motion planning, to seed trajectory
+ * optimization.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/SelfCollision.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of SamplingPlanner.
+struct SamplingPlannerParameters {
+  size_t max_samples = 5000;  // RRT-Connect samples, or PRM roadmap size
+  size_t batch_size = 64;     // configurations per batched collision check
+  double step_size = 0.3;     // longest RRT extension, in joint space
+  double resolution = 0.02;   // spacing of the collision checks along edges
+  double clearance = 0.0;     // minimum distance from spheres to obstacles
+  size_t num_neighbors = 10;  // PRM neighbors connected to every sample
+  size_t shortcut_iterations = 100;  // random shortcuts tried on a path
+  size_t num_threads = 0;            // 0 for all threads of the executor
+  uint64_t seed = 42;                // seed of the samples and shortcuts
+};
+
+/**
+ * SamplingPlanner finds collision-free paths in joint space, to be turned
+ * into initial values for trajectory optimization in cluttered scenes.
+ *
+ * The robot is covered with spheres. A configuration is free when every
+ * sphere is at least its radius plus clearance away from the obstacles of a
+ * signed distance field, and SelfCollision finds no near pair, so that its
+ * epsilon and margin act as self-clearance. Configurations are checked in
+ * batches of batch_size with BatchForwardKinematics, the batches in parallel
+ * on num_threads threads. Edges are checked at the given resolution, in the
+ * infinity norm of joint space.
+ *
+ * Joint angles are within the limits of the joint parameters. Planning is
+ * deterministic for a given seed, for any number of threads.
+ */
+class SamplingPlanner {
+ private:
+  Robot robot_;
+  boost::optional<std::string> prior_link_name_;
+  boost::optional<gtsam::Pose3> root_pose_;
+  SamplingPlannerParameters parameters_;
+  gtsam::Vector lower_, upper_;
+  std::vector<CollisionSphere> spheres_;
+  PointOnLinks centers_;
+  boost::optional<SignedDistanceField> sdf_;
+  boost::optional<SelfCollision> self_collision_;
+
+  /// Check rows [begin, end) of configurations on the calling thread.
+  std::vector<bool> checkRows(const gtsam::Matrix &configurations,
+                              size_t begin, size_t end) const;
+
+  /// Configurations every resolution along the segment from a to b.
+  gtsam::Matrix edgeConfigurations(const gtsam::Vector &a,
+                                   const gtsam::Vector &b) const;
+
+  /// Uniform samples within the joint limits, one per row.
+  template <class RNG>
+  gtsam::Matrix sampleConfigurations(size_t n, RNG *rng) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot           the robot, must be a kinematic tree
+   * @param spheres         spheres covering the robot, checked against the
+   * obstacles
+   * @param parameters      planner parameters
+   * @param prior_link_name root link of the forward kinematics, by default
+   * the fixed link
+   * @param root_pose       pose of the root link, by default its fixed pose
+   */
+  SamplingPlanner(
+      const Robot &robot, const std::vector<CollisionSphere> &spheres,
+      const SamplingPlannerParameters &parameters = SamplingPlannerParameters(),
+      const boost::optional<std::string> &prior_link_name = boost::none,
+      const boost::optional<gtsam::Pose3> &root_pose = boost::none);
+
+  /// Set the obstacles.
+  void setObstacles(const SignedDistanceField &sdf) { sdf_ = sdf; }
+
+  /// Also avoid self-collisions between the spheres of collision.
+  void setSelfCollision(const SelfCollision &collision) {
+    self_collision_ = collision;
+  }
+
+  /// Override the joint limits, in Robot::joints() order.
+  void setJointLimits(const gtsam::Vector &lower, const gtsam::Vector &upper);
+
+  const gtsam::Vector &lowerLimits() const { return lower_; }
+  const gtsam::Vector &upperLimits() const { return upper_; }
+  const SamplingPlannerParameters &parameters() const { return parameters_; }
+
+  /**
+   * Whether configurations are collision-free and within the limits.
+   * @param configurations N x numJoints matrix, in Robot::joints() order
+   */
+  std::vector<bool> collisionFree(const gtsam::Matrix &configurations) const;
+
+  /// Whether a configuration is collision-free and within the limits.
+  bool collisionFree(const gtsam::Vector &q) const;
+
+  /// Whether the straight segment between two configurations is free.
+  bool motionFree(const gtsam::Vector &a, const gtsam::Vector &b) const;
+
+  /**
+   * Plan with RRT-Connect: grow trees from start and goal towards batches of
+   * free random samples, each extension by at most step_size, until they
+   * connect. The path is shortcut before it is returned.
+   * @return waypoints from start to goal, empty if none was found
+   */
+  std::vector<gtsam::Vector> planRRTConnect(const gtsam::Vector &start,
+                                            const gtsam::Vector &goal) const;
+
+  /**
+   * Plan with a probabilistic roadmap of max_samples samples, each connected
+   * to its num_neighbors nearest neighbors. Samples, neighbor searches and
+   * edge checks run in parallel; the shortest path is then shortcut.
+   * @return waypoints from start to goal, empty if none was found
+   */
+  std::vector<gtsam::Vector> planPRM(const gtsam::Vector &start,
+                                     const gtsam::Vector &goal) const;
+
+  /// Remove waypoints by joining random pairs with free segments.
+  std::vector<gtsam::Vector> shortcut(
+      const std::vector<gtsam::Vector> &path) const;
+
+  /**
+   * Initial values for trajectory optimization from a path: the values of
+   * Initializer::ZeroValuesTrajectory, with joint angles resampled at equal
+   * joint-space distances over num_steps + 1 steps, finite-difference joint
+   * velocities that are zero at both ends, and link poses and twists from
+   * forward kinematics.
+   * @param path      waypoints, e.g. from planRRTConnect
+   * @param num_steps number of time steps
+   * @param dt        duration of a time step
+   */
+  gtsam::Values toValues(const std::vector<gtsam::Vector> &path,
+                         size_t num_steps, double dt) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdmmQpSolver.cpp
+ * @brief Warm-started ADMM solver for sparse QPs, e.g. of linear MPC.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/AdmmQpSolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Vector;
+
+namespace {
+// Step size of constraints without bounds, as in OSQP.
+constexpr double kRhoFree = 1e-6;
+
+bool SameMatrix(const SparseQP::SparseMatrix &a,
+                const SparseQP::SparseMatrix &b, bool compare_values) {
+  if (a.rows() != b.rows() || a.cols() != b.cols() ||
+      a.nonZeros() != b.nonZeros() || !a.isCompressed() ||
+      !b.isCompressed()) {
+    return false;
+  }
+  const auto n = a.nonZeros();
+  return std::equal(a.outerIndexPtr(), a.outerIndexPtr() + a.outerSize() + 1,
+                    b.outerIndexPtr()) &&
+         std::equal(a.innerIndexPtr(), a.innerIndexPtr() + n,
+                    b.innerIndexPtr()) &&
+         (!compare_values ||
+          std::equal(a.valuePtr(), a.valuePtr() + n, b.valuePtr()));
+}
+
+double InfNorm(const Vector &v) {
+  return v.size() ? v.lpNorm<Eigen::Infinity>() : 0.0;
+}
+}  // namespace
+
+/* ************************************************************************* */
+AdmmQpSolver::AdmmQpSolver(const SparseQP &qp,
+                           const AdmmQpParameters &parameters)
+    : p_(parameters) {
+  if (!(p_.rho > 0) || !(p_.rho_equality > 0) || !(p_.sigma > 0) ||
+      !(p_.alpha > 0 && p_.alpha < 2)) {
+    throw std::invalid_argument(
+        "AdmmQpSolver: rho and sigma must be positive, alpha in (0, 2)");
+  }
+  update(qp);
+}
+
+/* ************************************************************************* */
+Vector AdmmQpSolver::stepSizes() const {
+  Vector rho(qp_.numConstraints());
+  for (int i = 0; i < rho.size(); i++) {
+    const double l = qp_.l(i), u = qp_.u(i);
+    rho(i) = (std::isinf(l) && std::isinf(u)) ? kRhoFree
+             : (l == u)                       ? p_.rho_equality
+                                              : p_.rho;
+  }
+  return rho;
+}
+
+/* ************************************************************************* */
+void AdmmQpSolver::assemble() {
+  const size_t n = qp_.numVariables(), m = qp_.numConstraints();
+  rho_ = stepSizes();
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(qp_.P.nonZeros() + 2 * qp_.A.nonZeros() + n + m);
+  for (int k = 0; k < qp_.P.outerSize(); k++) {
+    for (SparseMatrix::InnerIterator it(qp_.P, k); it; ++it) {
+      triplets.emplace_back(it.row(), it.col(), it.value());
+    }
+  }
+  for (size_t i = 0; i < n; i++) triplets.emplace_back(i, i, p_.sigma);
+  for (int k = 0; k < qp_.A.outerSize(); k++) {
+    for (SparseMatrix::InnerIterator it(qp_.A, k); it; ++it) {
+      triplets.emplace_back(n + it.row(), it.col(), it.value());
+      triplets.emplace_back(it.col(), n + it.row(), it.value());
+    }
+  }
+  for (size_t i = 0; i < m; i++) {
+    triplets.emplace_back(n + i, n + i, -1.0 / rho_(i));
+  }
+  kkt_.resize(n + m, n + m);
+  kkt_.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+/* ************************************************************************* */
+void AdmmQpSolver::factorize(bool analyze) {
+  if (analyze) ldlt_.analyzePattern(kkt_);
+  ldlt_.factorize(kkt_);
+  if (ldlt_.info() != Eigen::Success) {
+    throw std::runtime_error(
+        "AdmmQpSolver: KKT factorization failed, is P positive "
+        "semi-definite?");
+  }
+  num_factorizations_++;
+}
+
+/* ************************************************************************* */
+void AdmmQpSolver::update(const SparseQP &qp) {
+  const size_t n = qp.numVariables(), m = qp.numConstraints();
+  if (size_t(qp.P.rows()) != n || size_t(qp.P.cols()) != n ||
+      size_t(qp.A.rows()) != m || size_t(qp.A.cols()) != n ||
+      size_t(qp.u.size()) != m) {
+    throw std::invalid_argument("AdmmQpSolver: QP sizes do not match");
+  }
+  const bool first = num_factorizations_ == 0;
+  const bool same_values = !first && SameMatrix(qp.P, qp_.P, true) &&
+                           SameMatrix(qp.A, qp_.A, true);
+  const bool same_pattern = !first && SameMatrix(qp.P, qp_.P, false) &&
+                            SameMatrix(qp.A, qp_.A, false);
+  if (same_values) {
+    update(qp.q, qp.l, qp.u);
+    qp_.offsets = qp.offsets;
+    qp_.dims = qp.dims;
+    return;
+  }
+  qp_ = qp;
+  assemble();
+  factorize(!same_pattern);
+  if (size_t(x_.size()) != n || size_t(y_.size()) != m) {
+    x_ = Vector::Zero(n);
+    z_ = Vector::Zero(m);
+    y_ = Vector::Zero(m);
+  }
+}
+
+/* ************************************************************************* */
+void AdmmQpSolver::update(const Vector &q, const Vector &l, const Vector &u) {
+  if (size_t(q.size()) != qp_.numVariables() ||
+      size_t(l.size()) != qp_.numConstraints() ||
+      size_t(u.size()) != qp_.numConstraints()) {
+    throw std::invalid_argument("AdmmQpSolver: QP sizes do not match");
+  }
+  qp_.q = q;
+  qp_.l = l;
+  qp_.u = u;
+  // Constraints that become or stop being equalities change the step sizes.
+  const Vector rho = stepSizes();
+  if (rho != rho_) {
+    const size_t n = qp_.numVariables();
+    rho_ = rho;
+    for (int i = 0; i < rho_.size(); i++) {
+      kkt_.coeffRef(n + i, n + i) = -1.0 / rho_(i);
+    }
+    factorize(false);
+  }
+}
+
+/* ************************************************************************* */
+void AdmmQpSolver::warmStart(const Vector &x, const Vector &y) {
+  if (size_t(x.size()) != qp_.numVariables() ||
+      size_t(y.size()) != qp_.numConstraints()) {
+    throw std::invalid_argument("AdmmQpSolver: warm start sizes do not match");
+  }
+  x_ = x;
+  y_ = y;
+  z_ = qp_.A * x_;
+}
+
+/* ************************************************************************* */
+AdmmQpResult AdmmQpSolver::solve() {
+  const size_t n = qp_.numVariables(), m = qp_.numConstraints();
+  const SparseQP &qp = qp_;
+  const double alpha = p_.alpha;
+  z_ = z_.cwiseMax(qp.l).cwiseMin(qp.u);
+
+  AdmmQpResult result;
+  Vector rhs(n + m), x_tilde(n), z_tilde(m), z_relaxed(m);
+  for (size_t k = 0; k < p_.max_iterations; k++) {
+    rhs.head(n) = p_.sigma * x_ - qp.q;
+    rhs.tail(m) = z_ - y_.cwiseQuotient(rho_);
+    const Vector solution = ldlt_.solve(rhs);
+    x_tilde = solution.head(n);
+    z_tilde = z_ + (solution.tail(m) - y_).cwiseQuotient(rho_);
+
+    x_ = alpha * x_tilde + (1 - alpha) * x_;
+    z_relaxed = alpha * z_tilde + (1 - alpha) * z_;
+    const Vector z_next =
+        (z_relaxed + y_.cwiseQuotient(rho_)).cwiseMax(qp.l).cwiseMin(qp.u);
+    y_ += rho_.cwiseProduct(z_relaxed - z_next);
+    z_ = z_next;
+    result.iterations = k + 1;
+
+    const Vector Ax = qp.A * x_, Px = qp.P * x_;
+    const Vector Aty = qp.A.transpose() * y_;
+    result.primal_residual = InfNorm(Ax - z_);
+    result.dual_residual = InfNorm(Px + qp.q + Aty);
+    const double primal_tolerance =
+        p_.abs_tolerance +
+        p_.rel_tolerance * std::max(InfNorm(Ax), InfNorm(z_));
+    const double dual_tolerance =
+        p_.abs_tolerance +
+        p_.rel_tolerance *
+            std::max({InfNorm(Px), InfNorm(Aty), InfNorm(qp.q)});
+    if (result.primal_residual <= primal_tolerance &&
+        result.dual_residual <= dual_tolerance) {
+      result.converged = true;
+      break;
+    }
+  }
+  result.cost = qp.cost(x_);
+  return result;
+}
+
+}  // namespace gtdynamics
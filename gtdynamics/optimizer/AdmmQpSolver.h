@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdmmQpSolver.h
+ * @brief Warm-started ADMM solver for sparse QPs, e.g. of linear MPC.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/SparseQP.h>
+
+#include <Eigen/SparseCholesky>
+
+namespace gtdynamics {
+
+/// Parameters of AdmmQpSolver, as in OSQP.
+struct AdmmQpParameters {
+  double rho = 0.1;             // step size of inequality constraints
+  double rho_equality = 100.0;  // step size of equality constraints
+  double sigma = 1e-6;          // regularization of the cost Hessian
+  double alpha = 1.6;           // over-relaxation, in (0, 2)
+  double abs_tolerance = 1e-4;  // absolute tolerance on the residuals
+  double rel_tolerance = 1e-4;  // relative tolerance on the residuals
+  size_t max_iterations = 4000;
+};
+
+/// Outcome of AdmmQpSolver::solve.
+struct AdmmQpResult {
+  bool converged = false;  // whether both residuals met the tolerances
+  size_t iterations = 0;
+  double primal_residual = 0;  // |A x - z|, infinity norm
+  double dual_residual = 0;    // |P x + q + A' y|, infinity norm
+  double cost = 0;             // 1/2 x' P x + q' x
+};
+
+/**
+ * AdmmQpSolver solves a SparseQP with the ADMM iteration of OSQP. Every
+ * iteration solves the quasi-definite KKT system
+ *
+ *   [P + sigma I   A'         ] [x]   [sigma x - q   ]
+ *   [A             -diag(1/rho)] [v] = [z - y ./ rho ],
+ *
+ * whose sparse LDL' factorization is computed once and cached, so an
+ * iteration only takes two triangular solves and sparse products.
+ *
+ * For linear MPC, build the solver once for the QP linearized at the
+ * nominal, then every tick update the vectors, e.g. the cost and bounds
+ * that depend on the measured state, and solve: the factorization is kept,
+ * and ADMM starts from the previous primal and dual solution.
+ */
+class AdmmQpSolver {
+ public:
+  typedef SparseQP::SparseMatrix SparseMatrix;
+
+  /// Constructor, factorizes the KKT system of the QP.
+  explicit AdmmQpSolver(const SparseQP &qp,
+                        const AdmmQpParameters &parameters =
+                            AdmmQpParameters());
+
+  /**
+   * Replace the QP. The factorization is kept if the matrices are the same,
+   * reuses the symbolic analysis if they have the same sparsity, and is
+   * recomputed otherwise. The warm start is kept if the sizes match.
+   */
+  void update(const SparseQP &qp);
+
+  /// Replace the cost gradient and bounds, keeping the factorization.
+  void update(const gtsam::Vector &q, const gtsam::Vector &l,
+              const gtsam::Vector &u);
+
+  /// Start the next solve from the given primal and dual solution.
+  void warmStart(const gtsam::Vector &x, const gtsam::Vector &y);
+
+  /// Iterate from the last solution until the tolerances are met.
+  AdmmQpResult solve();
+
+  /// The QP being solved.
+  const SparseQP &qp() const { return qp_; }
+
+  /// Primal solution of the last solve.
+  const gtsam::Vector &x() const { return x_; }
+
+  /// Dual solution of the last solve, one multiplier per constraint.
+  const gtsam::Vector &y() const { return y_; }
+
+  /// Primal solution of the last solve, as the vectors of the keys.
+  gtsam::VectorValues solution() const { return qp_.vectorValues(x_); }
+
+  /// Number of numeric factorizations of the KKT system so far.
+  size_t numFactorizations() const { return num_factorizations_; }
+
+ private:
+  AdmmQpParameters p_;
+  SparseQP qp_;
+  gtsam::Vector rho_;  // step size of every constraint
+  SparseMatrix kkt_;
+  Eigen::SimplicialLDLT<SparseMatrix> ldlt_;
+  gtsam::Vector x_, z_, y_;
+  size_t num_factorizations_ = 0;
+
+  /// Step size of every constraint, larger for equalities.
+  gtsam::Vector stepSizes() const;
+
+  /// Step sizes and the KKT matrix.
+  void assemble();
+
+  /// Factorize the KKT matrix, with the symbolic analysis if requested.
+  void factorize(bool analyze);
+};
+
+}  // namespace gtdynamics
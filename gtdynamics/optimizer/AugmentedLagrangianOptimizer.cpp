@@ -12,83 +12,315 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/MeritGraph.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/Trace.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
 
 namespace gtdynamics {
 
 /** Update penalty parameter and Lagrangian multipliers from unconstrained
- * optimization result. */
-void update_parameters(const EqualityConstraints& constraints,
-                       const gtsam::Values& previous_values,
-                       const gtsam::Values& current_values, double& mu,
-                       std::vector<gtsam::Vector>& z) {
-  double previous_error = 0;
-  double current_error = 0;
-  for (size_t constraint_index = 0; constraint_index < constraints.size();
+ * optimization result, given the constraint evaluations at the previous and
+ * current values. */
+void update_parameters(const ConstraintEvaluation& previous,
+                       const ConstraintEvaluation& current,
+                       const ConstraintEvaluation& previous_inequality,
+                       const ConstraintEvaluation& current_inequality,
+                       double& mu, std::vector<gtsam::Vector>& z,
+                       std::vector<gtsam::Vector>& lambda) {
+  // Update Lagrangian multipliers.
+  for (size_t constraint_index = 0; constraint_index < z.size();
        constraint_index++) {
-    auto constraint = constraints.at(constraint_index);
-
-    // Update Lagrangian multipliers.
-    auto violation = (*constraint)(current_values);
-    z[constraint_index] += mu * violation;
-
-    // Sum errors for updating penalty parameter.
-    previous_error +=
-        pow(constraint->toleranceScaledViolation(previous_values).norm(), 2);
-    current_error +=
-        pow(constraint->toleranceScaledViolation(current_values).norm(), 2);
+    z[constraint_index] += mu * current.violations[constraint_index];
+  }
+  for (size_t constraint_index = 0; constraint_index < lambda.size();
+       constraint_index++) {
+    auto& l = lambda[constraint_index];
+    l = (l - mu * current_inequality.violations[constraint_index])
+            .cwiseMax(0.0);
   }
 
   // Update penalty parameter.
+  const double previous_error =
+      previous.squared_violation + previous_inequality.squared_violation;
+  const double current_error =
+      current.squared_violation + current_inequality.squared_violation;
   if (sqrt(current_error) >= 0.25 * sqrt(previous_error)) {
     mu *= 2;
   }
 }
 
+/// Stored multiplier, zero if unknown or of a different dimension.
+static gtsam::Vector LookupMultiplier(
+    const std::map<AugmentedLagrangianState::ConstraintId,
+                   std::vector<gtsam::Vector>>& multipliers,
+    const AugmentedLagrangianState::ConstraintId& id, size_t dim,
+    size_t occurrence) {
+  auto it = multipliers.find(id);
+  if (it != multipliers.end() && occurrence < it->second.size() &&
+      size_t(it->second[occurrence].size()) == dim) {
+    return it->second[occurrence];
+  }
+  return gtsam::Vector::Zero(dim);
+}
+
+/* ************************************************************************* */
+gtsam::Vector AugmentedLagrangianState::multiplier(
+    const EqualityConstraint& constraint, size_t occurrence) const {
+  return LookupMultiplier(multipliers, constraint.keys(), constraint.dim(),
+                          occurrence);
+}
+
+/* ************************************************************************* */
+gtsam::Vector AugmentedLagrangianState::multiplier(
+    const InequalityConstraint& constraint, size_t occurrence) const {
+  return LookupMultiplier(inequality_multipliers, constraint.keys(),
+                          constraint.dim(), occurrence);
+}
+
+/* ************************************************************************* */
 gtsam::Values AugmentedLagrangianOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
     const EqualityConstraints& constraints, const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
+  AugmentedLagrangianState state;
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  &state, intermediate_result);
+}
+
+/* ************************************************************************* */
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    AugmentedLagrangianState* state,
+    ConstrainedOptResult* intermediate_result) const {
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  state, intermediate_result);
+}
+
+/* ************************************************************************* */
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  AugmentedLagrangianState state;
+  return optimize(graph, constraints, inequality_constraints, initial_values,
+                  &state, intermediate_result);
+}
+
+/* ************************************************************************* */
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+    ConstrainedOptResult* intermediate_result) const {
+  using ConstraintId = AugmentedLagrangianState::ConstraintId;
   gtsam::Values values = initial_values;
 
-  // Set initial values for penalty parameter and Lagrangian multipliers.
-  double mu = 1.0;               // penalty parameter
+  // Set initial values for penalty parameter and Lagrangian multipliers,
+  // from the warm-start state where available.
+  double mu = state->mu;         // penalty parameter
   std::vector<gtsam::Vector> z;  // Lagrangian multiplier
+  std::vector<ConstraintId> ids;
+  std::map<ConstraintId, size_t> occurrences;
   for (const auto& constraint : constraints) {
-    z.push_back(gtsam::Vector::Zero(constraint->dim()));
+    ids.push_back(constraint->keys());
+    z.push_back(state->multiplier(*constraint, occurrences[ids.back()]++));
+  }
+  std::vector<gtsam::Vector> lambda;  // inequality multipliers, >= 0
+  std::vector<ConstraintId> inequality_ids;
+  occurrences.clear();
+  for (const auto& constraint : inequality_constraints) {
+    inequality_ids.push_back(constraint->keys());
+    lambda.push_back(
+        state->multiplier(*constraint, occurrences[inequality_ids.back()]++));
+  }
+
+  // Resume from a checkpoint of a solve with the same constraints.
+  size_t i = 0;
+  if (p_.checkpoint) {
+    if (auto checkpoint =
+            p_.checkpoint->resume(CheckpointSolver::AugmentedLagrangian)) {
+      auto matches = [](const std::vector<gtsam::Vector>& saved,
+                        const std::vector<gtsam::Vector>& current) {
+        if (saved.size() != current.size()) return false;
+        for (size_t k = 0; k < saved.size(); k++) {
+          if (saved[k].size() != current[k].size()) return false;
+        }
+        return true;
+      };
+      if (!matches(checkpoint->multipliers, z) ||
+          !matches(checkpoint->inequality_multipliers, lambda)) {
+        throw std::invalid_argument(
+            "AugmentedLagrangianOptimizer: checkpoint of other constraints");
+      }
+      values = checkpoint->values;
+      mu = checkpoint->mu;
+      z = checkpoint->multipliers;
+      lambda = checkpoint->inequality_multipliers;
+      i = checkpoint->iterations;
+    }
+  }
+
+  // Inequality penalty terms, whose shape changes with the active set.
+  auto add_inequality_factors = [&](gtsam::NonlinearFactorGraph* merit_graph) {
+    for (size_t k = 0; k < inequality_constraints.size(); k++) {
+      gtsam::Vector bias = lambda[k] / mu;
+      merit_graph->add(inequality_constraints[k]->createFactor(mu, bias));
+    }
+  };
+
+  // Optionally build the merit graph and its ordering only once.
+  boost::optional<MeritGraph> reused;
+  gtsam::LevenbergMarquardtParams lm_parameters = p_.lm_parameters;
+  if (p_.reuse_merit_graph) {
+    reused.emplace(graph, constraints);
+    if (inequality_constraints.empty()) {
+      lm_parameters.setOrdering(reused->ordering());
+    } else {
+      gtsam::NonlinearFactorGraph full_graph = reused->graph();
+      add_inequality_factors(&full_graph);
+      lm_parameters.setOrdering(gtsam::Ordering::Colamd(full_graph));
+    }
   }
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
-  for (int i = 0; i < p_.num_iterations; i++) {
+  ConstraintEvaluation evaluation =
+      EvaluateConstraints(constraints, values, p_.num_threads,
+                          p_.deterministic);
+  ConstraintEvaluation inequality_evaluation =
+      EvaluateConstraints(inequality_constraints, values, p_.num_threads,
+                          p_.deterministic);
+  auto violation_norm = [&]() {
+    return sqrt(evaluation.squared_violation +
+                inequality_evaluation.squared_violation);
+  };
+
+  // Keep the best iterate in case the solve runs out of time.
+  const Deadline deadline(p_.time_budget, p_.cancellation);
+  BestIterate best;
+  auto consider = [&]() {
+    if (deadline.bounded()) {
+      best.update(values, graph.error(values),
+                  std::max(evaluation.max_violation,
+                           inequality_evaluation.max_violation));
+    }
+  };
+  consider();
+  bool interrupted = false;
+  while (i < p_.num_iterations) {
+    GTDYNAMICS_TRACE_SCOPE_ARG("AugmentedLagrangian::iteration", i);
+    if (deadline.expired()) {
+      interrupted = true;
+      break;
+    }
+
     // Construct merit function.
-    gtsam::NonlinearFactorGraph merit_graph = graph;
-
-    // Create factors corresponding to penalty terms of constraints.
-    for (size_t constraint_index = 0; constraint_index < constraints.size();
-         constraint_index++) {
-      auto constraint = constraints.at(constraint_index);
-      gtsam::Vector bias = z[constraint_index] / mu;
-      merit_graph.add(constraint->createFactor(mu, bias));
+    // The reused graph is only copied to append inequality penalty terms.
+    const bool copy_graph = !reused || !inequality_constraints.empty();
+    gtsam::NonlinearFactorGraph built_graph;
+    if (reused) {
+      reused->update(mu, z);
+      if (copy_graph) built_graph = reused->graph();
+    } else {
+      built_graph = graph;
+
+      // Create factors corresponding to penalty terms of constraints.
+      for (size_t constraint_index = 0; constraint_index < constraints.size();
+           constraint_index++) {
+        auto constraint = constraints.at(constraint_index);
+        gtsam::Vector bias = z[constraint_index] / mu;
+        built_graph.add(constraint->createFactor(mu, bias));
+      }
     }
+    add_inequality_factors(&built_graph);
+    const gtsam::NonlinearFactorGraph& merit_graph =
+        copy_graph ? built_graph : reused->graph();
 
     // Run LM optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
+    InstrumentedLevenbergMarquardtOptimizer::Options options;
+    options.telemetry = p_.telemetry;
+    options.deadline = deadline.within(p_.outer_time_budget);
+    InstrumentedLevenbergMarquardtOptimizer optimizer(merit_graph, values,
+                                                      lm_parameters, options);
     auto result = optimizer.optimize();
+    SolveRecord record = optimizer.solveRecord();
+    record.mu = mu;
 
     // Update parameters.
-    update_parameters(constraints, values, result, mu, z);
+    // Each constraint is evaluated once per set of values.
+    ConstraintEvaluation current =
+        EvaluateConstraints(constraints, result, p_.num_threads,
+                            p_.deterministic);
+    ConstraintEvaluation current_inequality =
+        EvaluateConstraints(inequality_constraints, result, p_.num_threads,
+                            p_.deterministic);
+    update_parameters(evaluation, current, inequality_evaluation,
+                      current_inequality, mu, z, lambda);
+    evaluation = std::move(current);
+    inequality_evaluation = std::move(current_inequality);
 
     // Update values.
     values = result;
+    i++;
+    record.violation = violation_norm();
+    optimizer.recordSolve(record);
+    consider();
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
-      intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
-      intermediate_result->mu_values.push_back(mu);
+      intermediate_result->record(
+          values, optimizer.getInnerIterations(), mu, violation_norm(),
+          std::max(evaluation.max_violation,
+                   inequality_evaluation.max_violation));
+    }
+
+    if (p_.checkpoint && p_.checkpoint->due()) {
+      OptimizerCheckpoint checkpoint;
+      checkpoint.solver = CheckpointSolver::AugmentedLagrangian;
+      checkpoint.values = values;
+      checkpoint.iterations = i;
+      checkpoint.mu = mu;
+      checkpoint.multipliers = z;
+      checkpoint.inequality_multipliers = lambda;
+      p_.checkpoint->save(checkpoint, true);
     }
+
+    if (violation_norm() < p_.violation_tolerance) break;
+  }
+  if (interrupted) {
+    values = best.values();
+    evaluation = EvaluateConstraints(constraints, values, p_.num_threads,
+                                     p_.deterministic);
+    inequality_evaluation =
+        EvaluateConstraints(inequality_constraints, values, p_.num_threads,
+                            p_.deterministic);
+  }
+
+  // Save state for warm starting the next solve.
+  state->mu = mu;
+  state->multipliers.clear();
+  for (size_t k = 0; k < constraints.size(); k++) {
+    state->multipliers[ids[k]].push_back(z[k]);
+  }
+  state->inequality_multipliers.clear();
+  for (size_t k = 0; k < inequality_constraints.size(); k++) {
+    state->inequality_multipliers[inequality_ids[k]].push_back(lambda[k]);
   }
+  state->values = values;
+  state->num_iterations = i;
+  state->violation = violation_norm();
+  state->max_violation =
+      std::max(evaluation.max_violation, inequality_evaluation.max_violation);
   return values;
 }
 
@@ -14,6 +14,11 @@
 #pragma once
 
 #include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+#include <map>
+#include <set>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -22,17 +27,60 @@ struct AugmentedLagrangianParameters
     : public ConstrainedOptimizationParameters {
   using Base = ConstrainedOptimizationParameters;
   size_t num_iterations;
+  // Stop early once the tolerance-scaled constraint violation is below this,
+  // 0 to always run num_iterations outer loops.
+  double violation_tolerance;
 
   AugmentedLagrangianParameters()
-      : Base(gtsam::LevenbergMarquardtParams()), num_iterations(12) {}
+      : Base(gtsam::LevenbergMarquardtParams()),
+        num_iterations(12),
+        violation_tolerance(0.0) {}
 
   AugmentedLagrangianParameters(
       const gtsam::LevenbergMarquardtParams& _lm_parameters,
-      const size_t& _num_iterations = 12)
-      : Base(_lm_parameters), num_iterations(_num_iterations) {}
+      const size_t& _num_iterations = 12,
+      const double& _violation_tolerance = 0.0)
+      : Base(_lm_parameters),
+        num_iterations(_num_iterations),
+        violation_tolerance(_violation_tolerance) {}
+};
+
+/**
+ * State of the Augmented Lagrangian method at the end of a solve, which can
+ * be passed to a later solve of a similar problem as a warm start.
+ *
+ * Constraints are identified by the keys they involve (and their order
+ * among constraints on the same keys), so that multipliers carry over when
+ * the constraints are rebuilt for the next solve.
+ */
+struct AugmentedLagrangianState {
+  using ConstraintId = std::set<gtsam::Key>;
+
+  double mu = 1.0;  // penalty parameter
+  std::map<ConstraintId, std::vector<gtsam::Vector>>
+      multipliers;           // Lagrange multipliers
+  std::map<ConstraintId, std::vector<gtsam::Vector>>
+      inequality_multipliers;  // multipliers of inequality constraints
+  gtsam::Values values;      // result of the last solve
+  size_t num_iterations = 0;  // outer iterations of the last solve
+  double violation = 0.0;     // tolerance-scaled violation of the last solve
+  double max_violation = 0.0;  // largest tolerance-scaled violation entry
+
+  /// Multiplier for the given occurrence of a constraint, zero if unknown.
+  gtsam::Vector multiplier(const EqualityConstraint& constraint,
+                           size_t occurrence) const;
+
+  /// Multiplier for the given occurrence of an inequality constraint.
+  gtsam::Vector multiplier(const InequalityConstraint& constraint,
+                           size_t occurrence) const;
 };
 
-/// Augmented Lagrangian method only considering equality constraints.
+/**
+ * Augmented Lagrangian method for equality constraints g(x) = 0 and
+ * inequality constraints h(x) >= 0. Inequalities use the shifted penalty
+ * 1/2 mu ||max(0, lambda / mu - h(x))||^2 with multipliers lambda >= 0, so
+ * that inactive constraints do not contribute to the merit function.
+ */
 class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
  protected:
   const AugmentedLagrangianParameters p_;
@@ -51,6 +99,39 @@ class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
       const EqualityConstraints& constraints,
       const gtsam::Values& initial_values,
       ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /**
+   * Run optimization, starting from and updating a warm-start state.
+   *
+   * @param graph A Nonlinear factor graph representing cost.
+   * @param constraints All the constraints.
+   * @param initial_values Initial values, e.g. state->values.
+   * @param state Multipliers and penalty parameter to start from, replaced
+   * by the final state.
+   * @param intermediate_result (optional) intermediate results.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
+
+  /// Run optimization with equality and inequality constraints.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequality_constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
+
+  /// Run optimization with equality and inequality constraints, starting
+  /// from and updating a warm-start state.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequality_constraints,
+      const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
 };
 
 }  // namespace gtdynamics
@@ -0,0 +1,226 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSolver.cpp
+ * @brief Solve batches of serialized trajectory problems, on a thread pool
+ * and optionally across MPI ranks.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/BatchSolver.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtdynamics/utils/ThreadPool.h>
+#include <gtsam/base/serialization.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Values;
+
+/* ************************************************************************* */
+std::string BatchProblem::toBinary() const {
+  return gtsam::serializeBinary(*this);
+}
+
+BatchProblem BatchProblem::FromBinary(const std::string &data) {
+  BatchProblem problem;
+  gtsam::deserializeBinary(data, problem);
+  return problem;
+}
+
+/* ************************************************************************* */
+std::string BatchResult::toBinary() const {
+  return gtsam::serializeBinary(*this);
+}
+
+BatchResult BatchResult::FromBinary(const std::string &data) {
+  BatchResult result;
+  gtsam::deserializeBinary(data, result);
+  return result;
+}
+
+/* ************************************************************************* */
+BatchSolver::BatchSolver(const OptimizationParameters &parameters,
+                         const gtsam::KeyVector &output_keys,
+                         size_t num_threads)
+    : parameters_(parameters),
+      output_keys_(output_keys),
+      num_threads_(num_threads) {}
+
+/* ************************************************************************* */
+BatchResult BatchSolver::solve(size_t index,
+                               const std::string &problem) const {
+  const auto start = std::chrono::steady_clock::now();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  BatchResult result;
+  result.index = index;
+  result.initial_error = result.error = nan;
+  try {
+    const BatchProblem p = BatchProblem::FromBinary(problem);
+    result.initial_error = p.graph.error(p.initial_values);
+    const Values values =
+        Optimizer(parameters_).optimize(p.graph, p.initial_values);
+    result.error = p.graph.error(values);
+    for (gtsam::Key key : output_keys_) {
+      if (values.exists(key)) result.outputs.insert(key, values.at(key));
+    }
+    result.solved = true;
+  } catch (const std::exception &e) {
+    result.message = e.what();
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+/* ************************************************************************* */
+std::vector<BatchResult> BatchSolver::solve(
+    const std::vector<std::string> &problems,
+    const std::vector<size_t> &indices) const {
+  if (!indices.empty() && indices.size() != problems.size()) {
+    throw std::invalid_argument(
+        "BatchSolver: need an index for every problem");
+  }
+  // On several NUMA nodes, every problem is deserialized and solved on one
+  // node, so its graph and values are in local memory.
+  const size_t num_nodes = ExecutorNodes();
+  std::vector<std::future<BatchResult>> futures;
+  {
+    ThreadPool pool(num_threads_);
+    for (size_t i = 0; i < problems.size(); i++) {
+      const size_t index = indices.empty() ? i : indices[i];
+      futures.push_back(pool.submit([this, &problems, i, index, num_nodes]() {
+        if (num_nodes <= 1) return solve(index, problems[i]);
+        BatchResult result;
+        RunOnNode(index % num_nodes,
+                  [&]() { result = solve(index, problems[i]); });
+        return result;
+      }));
+    }
+  }
+  std::vector<BatchResult> results;
+  for (auto &&future : futures) results.push_back(future.get());
+  return results;
+}
+
+#ifdef GTDYNAMICS_WITH_MPI
+namespace {
+
+// Largest message sent at once, as MPI counts are ints.
+constexpr size_t kMaxMessage = size_t(1) << 30;
+
+/// Send a byte string of any length, as its size and pieces.
+void SendBytes(const std::string &data, int rank, MPI_Comm comm) {
+  uint64_t size = data.size();
+  MPI_Send(&size, 1, MPI_UINT64_T, rank, 0, comm);
+  for (size_t offset = 0; offset < data.size(); offset += kMaxMessage) {
+    const int n = static_cast<int>(std::min(kMaxMessage, data.size() - offset));
+    MPI_Send(data.data() + offset, n, MPI_BYTE, rank, 0, comm);
+  }
+}
+
+/// Receive a byte string sent with SendBytes.
+std::string ReceiveBytes(int rank, MPI_Comm comm) {
+  uint64_t size = 0;
+  MPI_Recv(&size, 1, MPI_UINT64_T, rank, 0, comm, MPI_STATUS_IGNORE);
+  std::string data(size, '\0');
+  for (size_t offset = 0; offset < data.size(); offset += kMaxMessage) {
+    const int n = static_cast<int>(std::min(kMaxMessage, data.size() - offset));
+    MPI_Recv(&data[offset], n, MPI_BYTE, rank, 0, comm, MPI_STATUS_IGNORE);
+  }
+  return data;
+}
+
+/// Concatenate strings, each preceded by its size.
+std::string Pack(const std::vector<std::string> &items) {
+  std::string packed;
+  for (auto &&item : items) {
+    const uint64_t size = item.size();
+    packed.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    packed.append(item);
+  }
+  return packed;
+}
+
+/// Split what Pack concatenated.
+std::vector<std::string> Unpack(const std::string &packed) {
+  std::vector<std::string> items;
+  for (size_t offset = 0; offset < packed.size();) {
+    uint64_t size;
+    std::memcpy(&size, packed.data() + offset, sizeof(size));
+    offset += sizeof(size);
+    items.push_back(packed.substr(offset, size));
+    offset += size;
+  }
+  return items;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+std::vector<BatchResult> BatchSolver::solveDistributed(
+    const std::vector<std::string> &problems, MPI_Comm comm) const {
+  int rank = 0, num_ranks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &num_ranks);
+
+  // Deal the problems out round robin, each with its index.
+  std::vector<std::string> local_problems;
+  std::vector<size_t> local_indices;
+  if (rank == 0) {
+    std::vector<std::vector<std::string>> dealt(num_ranks);
+    for (size_t i = 0; i < problems.size(); i++) {
+      const uint64_t index = i;
+      dealt[i % num_ranks].push_back(
+          std::string(reinterpret_cast<const char *>(&index), sizeof(index)) +
+          problems[i]);
+    }
+    for (int r = 1; r < num_ranks; r++) SendBytes(Pack(dealt[r]), r, comm);
+    local_problems = dealt[0];
+  } else {
+    local_problems = Unpack(ReceiveBytes(0, comm));
+  }
+  for (auto &&problem : local_problems) {
+    uint64_t index;
+    std::memcpy(&index, problem.data(), sizeof(index));
+    local_indices.push_back(index);
+    problem.erase(0, sizeof(index));
+  }
+
+  const std::vector<BatchResult> local = solve(local_problems, local_indices);
+
+  // Gather the compact results on the root.
+  if (rank != 0) {
+    std::vector<std::string> serialized;
+    for (auto &&result : local) serialized.push_back(result.toBinary());
+    SendBytes(Pack(serialized), 0, comm);
+    return std::vector<BatchResult>();
+  }
+  std::vector<BatchResult> results = local;
+  for (int r = 1; r < num_ranks; r++) {
+    for (auto &&data : Unpack(ReceiveBytes(r, comm))) {
+      results.push_back(BatchResult::FromBinary(data));
+    }
+  }
+  std::sort(results.begin(), results.end(),
+            [](const BatchResult &a, const BatchResult &b) {
+              return a.index < b.index;
+            });
+  return results;
+}
+#endif
+
+}  // namespace gtdynamics
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSolver.h
+ * @brief Solve batches of serialized trajectory problems, on a thread pool
+ * and optionally across MPI ranks.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/string.hpp>
+#include <string>
+#include <vector>
+
+#ifdef GTDYNAMICS_WITH_MPI
+#include <mpi.h>
+#endif
+
+namespace gtdynamics {
+
+/**
+ * An independent trajectory problem: the robot it was built for, its factor
+ * graph and initial values. The robot is carried along for tools that need
+ * it for post-processing, and may be empty.
+ *
+ * Problems are exchanged as boost binary archives, so the process that
+ * serializes or deserializes them must register the derived joint and
+ * factor types with BOOST_CLASS_EXPORT, as the serialization tests do.
+ */
+struct BatchProblem {
+  Robot robot;
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial_values;
+
+  /// Serialize as a boost binary archive.
+  std::string toBinary() const;
+
+  /// Deserialize from a boost binary archive.
+  static BatchProblem FromBinary(const std::string &data);
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &BOOST_SERIALIZATION_NVP(robot);
+    ar &BOOST_SERIALIZATION_NVP(graph);
+    ar &BOOST_SERIALIZATION_NVP(initial_values);
+  }
+};
+
+/// Compact outcome of one problem of a batch.
+struct BatchResult {
+  size_t index = 0;     ///< index of the problem in the batch
+  bool solved = false;  ///< false if deserializing or solving threw
+  double initial_error = 0, error = 0;  ///< graph error before and after
+  double seconds = 0;      ///< wall-clock time to deserialize and solve
+  gtsam::Values outputs;   ///< values of the output keys in the solution
+  std::string message;     ///< the exception message if not solved
+
+  /// Serialize as a boost binary archive.
+  std::string toBinary() const;
+
+  /// Deserialize from a boost binary archive.
+  static BatchResult FromBinary(const std::string &data);
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &BOOST_SERIALIZATION_NVP(index);
+    ar &BOOST_SERIALIZATION_NVP(solved);
+    ar &BOOST_SERIALIZATION_NVP(initial_error);
+    ar &BOOST_SERIALIZATION_NVP(error);
+    ar &BOOST_SERIALIZATION_NVP(seconds);
+    ar &BOOST_SERIALIZATION_NVP(outputs);
+    ar &BOOST_SERIALIZATION_NVP(message);
+  }
+};
+
+/**
+ * BatchSolver solves many independent serialized problems in one process,
+ * e.g. a nightly sweep, instead of one process per problem. Every problem is
+ * deserialized and solved by one task of a ThreadPool with its own
+ * Optimizer, and only the errors and the values of the output keys are
+ * kept. A failing problem does not stop the batch; its result records the
+ * error. When the shared executor is placed on several NUMA nodes, see
+ * NumaAffinity, problem i runs on node i % ExecutorNodes().
+ *
+ * When GTDynamics is configured with GTDYNAMICS_WITH_MPI, solveDistributed
+ * deals the problems of the root rank out to all ranks, round robin, solves
+ * them on the thread pool of every rank and gathers the results on the
+ * root. Run one rank per node, and let the pool use the cores of the node.
+ *
+ * Example:
+ *   BatchSolver solver(params, {JointAngleKey(0, T)});
+ *   std::vector<std::string> problems;  // BatchProblem::toBinary()
+ *   auto results = solver.solveDistributed(problems);  // on rank 0
+ */
+class BatchSolver {
+ public:
+  /**
+   * Constructor.
+   * @param parameters  parameters of the optimizer of every problem
+   * @param output_keys variables to report for every problem
+   * @param num_threads number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  BatchSolver(
+      const OptimizationParameters &parameters = OptimizationParameters(),
+      const gtsam::KeyVector &output_keys = gtsam::KeyVector(),
+      size_t num_threads = 0);
+
+  /**
+   * Deserialize and solve one problem.
+   * @param index   index of the problem, copied to the result
+   * @param problem the problem, see BatchProblem::toBinary
+   */
+  BatchResult solve(size_t index, const std::string &problem) const;
+
+  /**
+   * Solve problems on the thread pool.
+   * @param problems the problems, see BatchProblem::toBinary
+   * @param indices  index of every problem, by default its position
+   * @return results of all problems, in the order of problems
+   */
+  std::vector<BatchResult> solve(
+      const std::vector<std::string> &problems,
+      const std::vector<size_t> &indices = std::vector<size_t>()) const;
+
+#ifdef GTDYNAMICS_WITH_MPI
+  /**
+   * Solve problems across the ranks of a communicator; every rank must call
+   * this. Blocks until all problems are solved.
+   * @param problems the problems, only read on rank 0
+   * @param comm     the communicator
+   * @return on rank 0 the results of all problems ordered by index, empty
+   * on the other ranks
+   */
+  std::vector<BatchResult> solveDistributed(
+      const std::vector<std::string> &problems,
+      MPI_Comm comm = MPI_COMM_WORLD) const;
+#endif
+
+ private:
+  OptimizationParameters parameters_;
+  gtsam::KeyVector output_keys_;
+  size_t num_threads_;
+};
+
+}  // namespace gtdynamics
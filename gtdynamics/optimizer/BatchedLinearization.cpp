@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchedLinearization.cpp
+ * @brief Parallel linearization of factor graphs in batches of one factor
+ * type.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/BatchedLinearization.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <boost/make_shared.hpp>
+#include <map>
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+
+/* ************************************************************************* */
+FactorBatches::FactorBatches(const gtsam::NonlinearFactorGraph &graph,
+                             size_t batch_size)
+    : num_factors_(graph.size()) {
+  if (batch_size == 0) {
+    throw std::invalid_argument("FactorBatches: batch size must be positive");
+  }
+  std::map<std::type_index, size_t> type_index;
+  for (size_t i = 0; i < graph.size(); i++) {
+    if (!graph[i]) continue;
+    const std::type_info &type = typeid(*graph[i]);
+    auto it = type_index.find(type);
+    if (it == type_index.end()) {
+      it = type_index.emplace(type, types_.size()).first;
+      types_.push_back({boost::core::demangle(type.name()), {}});
+    }
+    types_[it->second].factors.push_back(i);
+  }
+
+  for (size_t t = 0; t < types_.size(); t++) {
+    const size_t n = types_[t].factors.size();
+    for (size_t begin = 0; begin < n; begin += batch_size) {
+      batches_.push_back({t, begin, std::min(begin + batch_size, n)});
+    }
+  }
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr FactorBatches::linearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t num_threads) const {
+  if (graph.size() != num_factors_) {
+    throw std::invalid_argument(
+        "FactorBatches: the graph is not the one batched");
+  }
+  // Null factors stay null, as in NonlinearFactorGraph::linearize.
+  auto linear = boost::make_shared<GaussianFactorGraph>();
+  linear->resize(num_factors_);
+  ParallelFor(batches_.size(), num_threads, [&](size_t b) {
+    const Batch &batch = batches_[b];
+    const std::vector<size_t> &factors = types_[batch.type].factors;
+    for (size_t i = batch.begin; i < batch.end; i++) {
+      (*linear)[factors[i]] = graph[factors[i]]->linearize(values);
+    }
+  });
+  return linear;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchedLinearization.h
+ * @brief Parallel linearization of factor graphs in batches of one factor
+ * type.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FactorBatches lays out the factors of a graph by type, e.g. all
+ * PoseFactors, then all TwistAccelFactors, and splits every type into
+ * batches of consecutive factors. Linearization runs the batches on a pool
+ * of threads, so that every thread evaluates the errors and Jacobians of one
+ * factor type at a time, with the same code and similar data, and writes
+ * each linear factor into the slot of its factor. The result is the same as
+ * NonlinearFactorGraph::linearize.
+ *
+ * Trajectory graphs have thousands of factors of a handful of types, whose
+ * linearizations are independent across time steps.
+ */
+class FactorBatches {
+ public:
+  /// Factors of one type.
+  struct Type {
+    std::string name;              ///< demangled name of the factor type
+    std::vector<size_t> factors;   ///< indices of its factors in the graph
+  };
+
+  /**
+   * Constructor.
+   * @param graph      the graph whose factors to lay out
+   * @param batch_size maximum number of factors of a batch
+   */
+  explicit FactorBatches(const gtsam::NonlinearFactorGraph &graph,
+                         size_t batch_size = 256);
+
+  /// Factor types, in order of their first factor in the graph.
+  const std::vector<Type> &types() const { return types_; }
+
+  /// Number of batches.
+  size_t numBatches() const { return batches_.size(); }
+
+  /**
+   * Linearize all factors of the graph the batches were made for.
+   * @param graph       the graph, with the same factors as at construction
+   * @param values      the linearization point
+   * @param num_threads number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  gtsam::GaussianFactorGraph::shared_ptr linearize(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+      size_t num_threads = 0) const;
+
+ private:
+  /// Factors [begin, end) of one type.
+  struct Batch {
+    size_t type, begin, end;
+  };
+
+  size_t num_factors_;
+  std::vector<Type> types_;
+  std::vector<Batch> batches_;
+};
+
+/**
+ * Levenberg-Marquardt that linearizes with FactorBatches, see
+ * OptimizationParameters::linearization_threads.
+ */
+class BatchedLevenbergMarquardtOptimizer
+    : public gtsam::LevenbergMarquardtOptimizer {
+ protected:
+  FactorBatches batches_;
+  size_t num_threads_;
+
+ public:
+  /**
+   * Constructor.
+   * @param graph          the graph to optimize
+   * @param initial_values initial values of all variables
+   * @param params         LM parameters
+   * @param num_threads    number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  BatchedLevenbergMarquardtOptimizer(
+      const gtsam::NonlinearFactorGraph &graph,
+      const gtsam::Values &initial_values,
+      const gtsam::LevenbergMarquardtParams &params =
+          gtsam::LevenbergMarquardtParams(),
+      size_t num_threads = 0)
+      : gtsam::LevenbergMarquardtOptimizer(graph, initial_values, params),
+        batches_(graph),
+        num_threads_(num_threads) {}
+
+ protected:
+  /// Linearize the graph at the current values in batches.
+  gtsam::GaussianFactorGraph::shared_ptr linearize() const override {
+    return batches_.linearize(graph_, values(), num_threads_);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,303 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Checkpoint.cpp
+ * @brief Checkpoints of long solves, to resume them after preemption.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/MappedFile.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Value;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'C', 'K', 'P', 'T', 0};
+
+/// Fixed header at the start of a checkpoint file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint8_t solver;
+  uint8_t reserved[3];
+  uint64_t iterations;
+  double lambda;
+  double mu;
+  uint64_t num_values;
+};
+
+/// Type of a variable in a checkpoint.
+enum ValueType : uint8_t {
+  kDouble = 0,
+  kVector = 1,
+  kVector3 = 2,
+  kVector6 = 3,
+  kRot3 = 4,
+  kPose3 = 5
+};
+
+/// Appends raw native-endian numbers to a buffer.
+class Writer {
+  std::string data_;
+
+ public:
+  template <class T>
+  void pod(const T &value) {
+    data_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void doubles(const double *p, size_t n) {
+    data_.append(reinterpret_cast<const char *>(p), sizeof(double) * n);
+  }
+
+  void vector(const Vector &v) {
+    pod<uint32_t>(v.size());
+    doubles(v.data(), v.size());
+  }
+
+  void value(Key key, const Value &value) {
+    pod<uint64_t>(key);
+    if (auto v = dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+      pod<uint8_t>(kDouble);
+      pod(v->value());
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Vector> *>(
+                   &value)) {
+      pod<uint8_t>(kVector);
+      vector(v->value());
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Vector3> *>(
+                   &value)) {
+      pod<uint8_t>(kVector3);
+      doubles(v->value().data(), 3);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Vector6> *>(
+                   &value)) {
+      pod<uint8_t>(kVector6);
+      doubles(v->value().data(), 6);
+    } else if (auto v =
+                   dynamic_cast<const gtsam::GenericValue<Rot3> *>(&value)) {
+      pod<uint8_t>(kRot3);
+      const gtsam::Matrix3 R = v->value().matrix();
+      doubles(R.data(), 9);
+    } else if (auto v =
+                   dynamic_cast<const gtsam::GenericValue<Pose3> *>(&value)) {
+      pod<uint8_t>(kPose3);
+      const gtsam::Matrix3 R = v->value().rotation().matrix();
+      const Vector3 t = v->value().translation();
+      doubles(R.data(), 9);
+      doubles(t.data(), 3);
+    } else {
+      throw std::runtime_error("OptimizerCheckpoint: unsupported type of " +
+                               _GTDKeyFormatter(key));
+    }
+  }
+
+  const std::string &data() const { return data_; }
+};
+
+/// Reads what Writer wrote, checking that the data is not truncated.
+class Reader {
+  const char *p_, *end_;
+
+  void need(size_t n) const {
+    if (static_cast<size_t>(end_ - p_) < n)
+      throw std::runtime_error("OptimizerCheckpoint: truncated checkpoint");
+  }
+
+ public:
+  Reader(const char *data, size_t size) : p_(data), end_(data + size) {}
+
+  template <class T>
+  T pod() {
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return value;
+  }
+
+  void doubles(double *p, size_t n) {
+    need(sizeof(double) * n);
+    std::memcpy(p, p_, sizeof(double) * n);
+    p_ += sizeof(double) * n;
+  }
+
+  Vector vector() {
+    Vector v(pod<uint32_t>());
+    doubles(v.data(), v.size());
+    return v;
+  }
+
+  void value(Values *values) {
+    const Key key = pod<uint64_t>();
+    switch (pod<uint8_t>()) {
+      case kDouble:
+        values->insert(key, pod<double>());
+        break;
+      case kVector:
+        values->insert(key, vector());
+        break;
+      case kVector3: {
+        Vector3 v;
+        doubles(v.data(), 3);
+        values->insert(key, v);
+        break;
+      }
+      case kVector6: {
+        Vector6 v;
+        doubles(v.data(), 6);
+        values->insert(key, v);
+        break;
+      }
+      case kRot3: {
+        gtsam::Matrix3 R;
+        doubles(R.data(), 9);
+        values->insert(key, Rot3(R));
+        break;
+      }
+      case kPose3: {
+        gtsam::Matrix3 R;
+        Vector3 t;
+        doubles(R.data(), 9);
+        doubles(t.data(), 3);
+        values->insert(key, Pose3(Rot3(R), t));
+        break;
+      }
+      default:
+        throw std::runtime_error("OptimizerCheckpoint: unknown value type");
+    }
+  }
+
+  bool done() const { return p_ == end_; }
+};
+
+}  // namespace
+
+/* ************************************************************************* */
+void OptimizerCheckpoint::save(const std::string &file_path) const {
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kCheckpointVersion;
+  header.solver = static_cast<uint8_t>(solver);
+  std::memset(header.reserved, 0, sizeof(header.reserved));
+  header.iterations = iterations;
+  header.lambda = lambda;
+  header.mu = mu;
+  header.num_values = values.size();
+
+  Writer writer;
+  writer.pod(header);
+  for (auto &&key_value : values) writer.value(key_value.key, key_value.value);
+  for (auto &&list : {&multipliers, &inequality_multipliers}) {
+    writer.pod<uint64_t>(list->size());
+    for (auto &&multiplier : *list) writer.vector(multiplier);
+  }
+
+  // Write to a temporary file and rename it, so that a job preempted while
+  // saving keeps its previous checkpoint.
+  const std::string &data = writer.data();
+  const std::string tmp_path = file_path + ".tmp";
+  {
+    std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size());
+    if (!os.good())
+      throw std::runtime_error("OptimizerCheckpoint: could not write " +
+                               tmp_path);
+  }
+  if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("OptimizerCheckpoint: could not write " +
+                             file_path);
+  }
+}
+
+/* ************************************************************************* */
+OptimizerCheckpoint OptimizerCheckpoint::Load(const std::string &file_path) {
+  MappedFile file;
+  if (!file.open(file_path))
+    throw std::runtime_error("OptimizerCheckpoint: could not read " +
+                             file_path);
+  Reader reader(file.data(), file.size());
+  const Header header = reader.pod<Header>();
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kCheckpointVersion) {
+    throw std::runtime_error("OptimizerCheckpoint: not a checkpoint of this "
+                             "version: " + file_path);
+  }
+
+  OptimizerCheckpoint checkpoint;
+  checkpoint.solver = static_cast<CheckpointSolver>(header.solver);
+  checkpoint.iterations = header.iterations;
+  checkpoint.lambda = header.lambda;
+  checkpoint.mu = header.mu;
+  for (uint64_t i = 0; i < header.num_values; i++) {
+    reader.value(&checkpoint.values);
+  }
+  for (auto &&list :
+       {&checkpoint.multipliers, &checkpoint.inequality_multipliers}) {
+    const uint64_t size = reader.pod<uint64_t>();
+    for (uint64_t i = 0; i < size; i++) list->push_back(reader.vector());
+  }
+  if (!reader.done())
+    throw std::runtime_error("OptimizerCheckpoint: trailing data in " +
+                             file_path);
+  return checkpoint;
+}
+
+/* ************************************************************************* */
+Checkpointer::Checkpointer(const std::string &file_path, double interval)
+    : file_path_(file_path), interval_(interval), last_save_(Clock::now()) {}
+
+/* ************************************************************************* */
+boost::optional<OptimizerCheckpoint> Checkpointer::resume(
+    CheckpointSolver solver) const {
+  if (!std::ifstream(file_path_).good()) return boost::none;
+  OptimizerCheckpoint checkpoint = OptimizerCheckpoint::Load(file_path_);
+  if (checkpoint.solver != solver) {
+    throw std::invalid_argument(
+        "Checkpointer: checkpoint was written by another solver: " +
+        file_path_);
+  }
+  return checkpoint;
+}
+
+/* ************************************************************************* */
+bool Checkpointer::due() const {
+  return std::chrono::duration<double>(Clock::now() - last_save_).count() >=
+         interval_;
+}
+
+/* ************************************************************************* */
+bool Checkpointer::save(const OptimizerCheckpoint &checkpoint, bool force) {
+  if (!force && !due()) return false;
+  checkpoint.save(file_path_);
+  last_save_ = Clock::now();
+  num_saves_++;
+  return true;
+}
+
+/* ************************************************************************* */
+void Checkpointer::remove() const { std::remove(file_path_.c_str()); }
+
+}  // namespace gtdynamics
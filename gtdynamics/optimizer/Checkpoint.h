@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Checkpoint.h
+ * @brief Checkpoints of long solves, to resume them after preemption.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Version of the binary checkpoint format, bumped whenever it changes.
+constexpr uint32_t kCheckpointVersion = 1;
+
+/// The solver that wrote a checkpoint.
+enum class CheckpointSolver : uint8_t {
+  LevenbergMarquardt = 0,
+  Penalty = 1,
+  AugmentedLagrangian = 2,
+  SQP = 3
+};
+
+/**
+ * State of a solve, enough to continue it where it stopped. Multipliers are
+ * stored in the order of the constraints, so a solve can only resume with
+ * the constraints it was started with.
+ */
+struct OptimizerCheckpoint {
+  CheckpointSolver solver = CheckpointSolver::LevenbergMarquardt;
+  gtsam::Values values;  // current iterate
+  uint64_t iterations = 0;  // completed LM iterations, or outer iterations
+  double lambda = 0.0;      // LM damping
+  double mu = 0.0;          // penalty parameter
+  std::vector<gtsam::Vector> multipliers;  // Lagrange multipliers
+  std::vector<gtsam::Vector> inequality_multipliers;
+
+  /**
+   * Save in a compact binary form, as raw native-endian numbers. The file is
+   * written to a temporary file first and renamed, so that a preempted save
+   * never leaves a partial checkpoint. Values may hold double, Vector,
+   * Vector3, Vector6, Rot3 and Pose3 variables.
+   */
+  void save(const std::string &file_path) const;
+
+  /// Load a checkpoint; throws if the file cannot be read or is not one.
+  static OptimizerCheckpoint Load(const std::string &file_path);
+};
+
+/**
+ * Checkpointer saves the state of a solve at most every interval seconds,
+ * and resumes from the last checkpoint when the solve is started again, e.g.
+ * by a restarted cluster job. It is passed to a solver by shared pointer in
+ * its parameters, like the telemetry, and is meant for one solve.
+ *
+ * Example:
+ *   OptimizationParameters params;
+ *   params.checkpoint = std::make_shared<Checkpointer>("walk.ckpt", 600);
+ *   Values result = Optimizer(params).optimize(graph, init);
+ */
+class Checkpointer {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * Constructor.
+   * @param file_path path of the checkpoint file
+   * @param interval  minimum seconds between saves, 0 to save every time
+   */
+  explicit Checkpointer(const std::string &file_path, double interval = 0.0);
+
+  /// Path of the checkpoint file.
+  const std::string &path() const { return file_path_; }
+
+  /**
+   * The checkpoint to resume from, if there is one.
+   * @param solver the solver about to start; throws if another wrote it
+   */
+  boost::optional<OptimizerCheckpoint> resume(CheckpointSolver solver) const;
+
+  /**
+   * Save a checkpoint if the interval passed since the last save.
+   * @param checkpoint the state of the solve
+   * @param force      whether to save regardless of the interval
+   * @return whether it was saved
+   */
+  bool save(const OptimizerCheckpoint &checkpoint, bool force = false);
+
+  /// Whether the interval passed since the last save.
+  bool due() const;
+
+  /// Number of saves so far.
+  size_t numSaves() const { return num_saves_; }
+
+  /// Remove the checkpoint file, e.g. once the result is stored.
+  void remove() const;
+
+ private:
+  std::string file_path_;
+  double interval_;
+  Clock::time_point last_save_;
+  size_t num_saves_ = 0;
+};
+
+}  // namespace gtdynamics
@@ -19,11 +19,36 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace gtdynamics {
 
+class CancellationToken;
+class Checkpointer;
+class OptimizerTelemetry;
+
 /// Constrained optimization parameters shared between all solvers.
 struct ConstrainedOptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  // Keep one MeritGraph and its ordering across outer iterations.
+  bool reuse_merit_graph = false;
+  // Threads for evaluating constraints, 0 for hardware concurrency.
+  size_t num_threads = 0;
+  // Whether reductions over constraints may not depend on scheduling.
+  bool deterministic = true;
+  // If set, record the timing and convergence of every inner iteration.
+  std::shared_ptr<OptimizerTelemetry> telemetry;
+  // Wall-clock seconds of the whole solve and of each inner solve, 0 for no
+  // limit. When the solve is out of time or cancelled, it returns its best
+  // iterate, see BestIterate.
+  double time_budget = 0;
+  double outer_time_budget = 0;
+  std::shared_ptr<CancellationToken> cancellation;
+  // If set, save the state after outer iterations, at most as often as the
+  // checkpointer allows, and resume from a saved state at the start.
+  std::shared_ptr<Checkpointer> checkpoint;
 
   /// Constructor.
   ConstrainedOptimizationParameters() {}
@@ -34,12 +59,41 @@ struct ConstrainedOptimizationParameters {
       : lm_parameters(_lm_parameters) {}
 };
 
-/// Intermediate results for constrained optimization process.
+/// Called with the index of an inner loop, from 0, and the values after it.
+using IterationCallback =
+    std::function<void(size_t iteration, const gtsam::Values& values)>;
+
+/**
+ * Intermediate results for constrained optimization process. By default the
+ * values after every inner loop are copied into intermediate_values; for
+ * long runs on big trajectories, set store_values to false to keep only the
+ * metrics, and optionally stream the values through a callback, e.g. an
+ * IntermediateValuesLog.
+ */
 struct ConstrainedOptResult {
   std::vector<gtsam::Values>
       intermediate_values;        // values after each inner loop
   std::vector<int> num_iters;     // number of LM iterations for each inner loop
   std::vector<double> mu_values;  // penalty parameter for each inner loop
+  std::vector<double> violations;  // tolerance-scaled violation norm
+  std::vector<double> max_violations;  // largest tolerance-scaled violation
+
+  bool store_values = true;  // whether to fill intermediate_values
+  IterationCallback callback;  // if set, called after each inner loop
+
+  /// Number of inner loops recorded.
+  size_t size() const { return num_iters.size(); }
+
+  /// Record the result of an inner loop.
+  void record(const gtsam::Values& values, int iterations, double mu,
+              double violation, double max_violation) {
+    if (callback) callback(num_iters.size(), values);
+    if (store_values) intermediate_values.push_back(values);
+    num_iters.push_back(iterations);
+    mu_values.push_back(mu);
+    violations.push_back(violation);
+    max_violations.push_back(max_violation);
+  }
 };
 
 /// Base class for constrained optimizer.
@@ -0,0 +1,197 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactImplicitOptimizer.cpp
+ * @brief Contact-implicit trajectory optimization with relaxed
+ * complementarity constraints.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/optimizer/ContactImplicitOptimizer.h>
+#include <gtdynamics/utils/values.h>
+
+using gtsam::Double_;
+using gtsam::Matrix3;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+namespace {
+
+// Product of two scalars, as an expression function.
+double Product(const double &a, const double &b,
+               gtsam::OptionalJacobian<1, 1> H_a = boost::none,
+               gtsam::OptionalJacobian<1, 1> H_b = boost::none) {
+  if (H_a) (*H_a)(0, 0) = b;
+  if (H_b) (*H_b)(0, 0) = a;
+  return a * b;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+double ContactNormalForce::operator()(
+    const gtsam::Pose3 &pose, const gtsam::Vector6 &wrench,
+    gtsam::OptionalJacobian<1, 6> H_pose,
+    gtsam::OptionalJacobian<1, 6> H_wrench) const {
+  const Vector3 f_c = wrench.tail<3>();
+  const Matrix3 R = pose.rotation().matrix();
+  if (H_pose) {
+    H_pose->setZero();
+    H_pose->leftCols<3>() = -up_.transpose() * R * gtsam::skewSymmetric(f_c);
+  }
+  if (H_wrench) {
+    H_wrench->setZero();
+    H_wrench->rightCols<3>() = up_.transpose() * R;
+  }
+  return up_.dot(R * f_c);
+}
+
+/* ************************************************************************* */
+double ContactSlipSpeedSquared::operator()(
+    const gtsam::Pose3 &pose, const gtsam::Vector6 &twist,
+    gtsam::OptionalJacobian<1, 6> H_pose,
+    gtsam::OptionalJacobian<1, 6> H_twist) const {
+  // Velocity of the contact point in the link frame, then in the world frame
+  // without its vertical component.
+  const Vector3 w = twist.head<3>(), v = twist.tail<3>();
+  const Vector3 v_b = v + w.cross(point_);
+  const Matrix3 R = pose.rotation().matrix();
+  const Vector3 v_s = R * v_b;
+  const Vector3 v_t = v_s - up_ * up_.dot(v_s);
+  const Eigen::RowVector3d H_v_s = 2 * v_t.transpose();
+  if (H_pose) {
+    H_pose->setZero();
+    H_pose->leftCols<3>() = -H_v_s * R * gtsam::skewSymmetric(v_b);
+  }
+  if (H_twist) {
+    H_twist->leftCols<3>() = -H_v_s * R * gtsam::skewSymmetric(point_);
+    H_twist->rightCols<3>() = H_v_s * R;
+  }
+  return v_t.squaredNorm();
+}
+
+/* ************************************************************************* */
+InequalityConstraints ContactComplementarity::constraints(
+    int k, double relaxation) const {
+  InequalityConstraints constraints;
+  const ContactNormalForce normal_force(gravity_);
+  for (auto &&cp : candidates_) {
+    if (cp.link->isFixed()) continue;
+    const int i = cp.link->id();
+    const gtsam::Key pose_key = PoseKey(i, k);
+    const gtsam::Expression<gtsam::Pose3> pose(pose_key);
+    const gtsam::Expression<gtsam::Vector6> wrench(
+        gtsam::Key(ContactWrenchKey(i, 0, k)));
+    const Double_ height =
+        ContactHeightConstraint(pose_key, cp.point, gravity_, ground_height_);
+    const Double_ force(normal_force, pose, wrench);
+
+    constraints.emplace_shared<DoubleExpressionInequality>(height, tolerance_);
+    constraints.emplace_shared<DoubleExpressionInequality>(force, tolerance_);
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        Double_(relaxation) - Double_(Product, height, force), tolerance_);
+    if (no_slip_) {
+      const gtsam::Expression<gtsam::Vector6> twist(
+          gtsam::Key(TwistKey(i, k)));
+      const Double_ slip(ContactSlipSpeedSquared(cp.point, gravity_), pose,
+                         twist);
+      constraints.emplace_shared<DoubleExpressionInequality>(
+          Double_(relaxation) - Double_(Product, force, slip), tolerance_);
+    }
+  }
+  return constraints;
+}
+
+/* ************************************************************************* */
+InequalityConstraints ContactComplementarity::trajectoryConstraints(
+    int num_steps, double relaxation) const {
+  InequalityConstraints constraints;
+  for (int k = 0; k <= num_steps; k++) {
+    constraints.add(this->constraints(k, relaxation));
+  }
+  return constraints;
+}
+
+/* ************************************************************************* */
+double ContactComplementarity::height(const gtsam::Values &values, size_t c,
+                                      int k) const {
+  const PointOnLink &cp = candidates_.at(c);
+  return ContactHeightConstraint(PoseKey(cp.link->id(), k), cp.point, gravity_,
+                                 ground_height_)
+      .value(values);
+}
+
+/* ************************************************************************* */
+double ContactComplementarity::normalForce(const gtsam::Values &values,
+                                           size_t c, int k) const {
+  const int i = candidates_.at(c).link->id();
+  return ContactNormalForce(gravity_)(
+      values.at<gtsam::Pose3>(PoseKey(i, k)),
+      values.at<gtsam::Vector6>(ContactWrenchKey(i, 0, k)));
+}
+
+/* ************************************************************************* */
+std::vector<std::vector<bool>> ContactComplementarity::schedule(
+    const gtsam::Values &values, int num_steps, double force_threshold) const {
+  std::vector<std::vector<bool>> in_contact;
+  for (int k = 0; k <= num_steps; k++) {
+    std::vector<bool> step;
+    for (size_t c = 0; c < candidates_.size(); c++) {
+      step.push_back(!candidates_[c].link->isFixed() &&
+                     normalForce(values, c, k) > force_threshold);
+    }
+    in_contact.push_back(step);
+  }
+  return in_contact;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph ContactImplicitOptimizer::TrajectoryGraph(
+    const DynamicsGraph &graph_builder, const Robot &robot, int num_steps,
+    double dt, const PointOnLinks &candidates, CollocationScheme collocation,
+    const boost::optional<double> &mu) {
+  gtsam::NonlinearFactorGraph graph;
+  for (int k = 0; k <= num_steps; k++) {
+    graph.add(graph_builder.qFactors(robot, k));
+    graph.add(graph_builder.vFactors(robot, k));
+    graph.add(graph_builder.aFactors(robot, k));
+    graph.add(graph_builder.dynamicsFactors(robot, k, candidates, mu));
+    if (k < num_steps) {
+      graph.add(graph_builder.collocationFactors(robot, k, dt, collocation));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values ContactImplicitOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const EqualityConstraints &constraints,
+    const InequalityConstraints &inequality_constraints,
+    const ContactComplementarity &complementarity, int num_steps,
+    const gtsam::Values &initial_values, AugmentedLagrangianState *state,
+    ConstrainedOptResult *intermediate_result) const {
+  const AugmentedLagrangianOptimizer optimizer(p_.al_parameters);
+  AugmentedLagrangianState local_state;
+  if (!state) state = &local_state;
+
+  gtsam::Values values = initial_values;
+  double relaxation = p_.initial_relaxation;
+  for (size_t stage = 0; stage < p_.num_stages; stage++) {
+    InequalityConstraints all = inequality_constraints;
+    all.add(complementarity.trajectoryConstraints(num_steps, relaxation));
+    values = optimizer.optimize(graph, constraints, all, values, state,
+                                intermediate_result);
+    relaxation *= p_.relaxation_factor;
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactImplicitOptimizer.h
+ * @brief Contact-implicit trajectory optimization with relaxed
+ * complementarity constraints.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Normal force of a contact wrench, the world "up" component of its force.
+class ContactNormalForce {
+ private:
+  gtsam::Vector3 up_;
+
+ public:
+  /// Constructor, up is the opposite of gravity.
+  explicit ContactNormalForce(const gtsam::Vector3 &gravity)
+      : up_(-gravity.normalized()) {}
+
+  double operator()(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &wrench,
+      gtsam::OptionalJacobian<1, 6> H_pose = boost::none,
+      gtsam::OptionalJacobian<1, 6> H_wrench = boost::none) const;
+};
+
+/// Squared speed of a contact point along the ground, from the link twist.
+class ContactSlipSpeedSquared {
+ private:
+  gtsam::Point3 point_;
+  gtsam::Vector3 up_;
+
+ public:
+  /// Constructor, with the contact point in the link CoM frame.
+  ContactSlipSpeedSquared(const gtsam::Point3 &point,
+                          const gtsam::Vector3 &gravity)
+      : point_(point), up_(-gravity.normalized()) {}
+
+  double operator()(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &twist,
+      gtsam::OptionalJacobian<1, 6> H_pose = boost::none,
+      gtsam::OptionalJacobian<1, 6> H_twist = boost::none) const;
+};
+
+/**
+ * ContactComplementarity builds the constraints of candidate contacts whose
+ * timing is not known in advance. For every candidate contact point and time
+ * step, with height h above the ground and normal force f_n of
+ * ContactWrenchKey(i, 0, k):
+ *   h >= 0,  f_n >= 0,  relaxation - h * f_n >= 0,
+ * and, to prevent slipping, relaxation - f_n * |v_t|^2 >= 0 on the
+ * tangential velocity v_t of the contact point. With relaxation = 0 these are
+ * the complementarity conditions of rigid contact: a foot either touches the
+ * ground or carries no force. A positive relaxation smooths the problem so
+ * that it can be solved from poor initial values, and is then decreased.
+ */
+class ContactComplementarity {
+ private:
+  PointOnLinks candidates_;
+  gtsam::Vector3 gravity_;
+  double ground_height_, tolerance_;
+  bool no_slip_;
+
+ public:
+  /**
+   * Constructor.
+   * @param candidates    candidate contact points, at most one per link
+   * @param gravity       gravity in world frame, defines "up"
+   * @param ground_height height of the flat ground plane
+   * @param tolerance     tolerance of the constraints
+   * @param no_slip       whether to add the slipping complementarity
+   */
+  ContactComplementarity(const PointOnLinks &candidates,
+                         const gtsam::Vector3 &gravity,
+                         double ground_height = 0.0, double tolerance = 1e-3,
+                         bool no_slip = true)
+      : candidates_(candidates),
+        gravity_(gravity),
+        ground_height_(ground_height),
+        tolerance_(tolerance),
+        no_slip_(no_slip) {}
+
+  const PointOnLinks &candidates() const { return candidates_; }
+
+  /// Constraints of time step k, with the given relaxation.
+  InequalityConstraints constraints(int k, double relaxation) const;
+
+  /// Constraints of time steps 0 to num_steps.
+  InequalityConstraints trajectoryConstraints(int num_steps,
+                                              double relaxation) const;
+
+  /// Height above the ground of candidate c at time step k.
+  double height(const gtsam::Values &values, size_t c, int k) const;
+
+  /// Normal force of candidate c at time step k.
+  double normalForce(const gtsam::Values &values, size_t c, int k) const;
+
+  /**
+   * The contact schedule found by a solve: whether each candidate, in the
+   * inner vectors, carries more than force_threshold at each time step.
+   */
+  std::vector<std::vector<bool>> schedule(const gtsam::Values &values,
+                                          int num_steps,
+                                          double force_threshold) const;
+};
+
+/// Parameters of ContactImplicitOptimizer.
+struct ContactImplicitParameters {
+  AugmentedLagrangianParameters al_parameters;  // parameters of every stage
+  double initial_relaxation = 1.0;  // relaxation of the first stage
+  double relaxation_factor = 0.1;   // relaxation decrease between stages
+  size_t num_stages = 4;            // number of relaxation stages
+};
+
+/**
+ * ContactImplicitOptimizer solves a trajectory with ContactComplementarity
+ * constraints by a homotopy on the relaxation: the augmented Lagrangian
+ * method is run once per stage, each warm-started from the values and
+ * multipliers of the previous one, with the relaxation multiplied by
+ * relaxation_factor in between. A single solve thus discovers the contact
+ * schedule instead of searching over gaits.
+ */
+class ContactImplicitOptimizer {
+ private:
+  ContactImplicitParameters p_;
+
+ public:
+  /// Constructor.
+  explicit ContactImplicitOptimizer(
+      const ContactImplicitParameters &parameters = ContactImplicitParameters())
+      : p_(parameters) {}
+
+  /**
+   * Trajectory factor graph in which every candidate contact has a wrench at
+   * every step: the factors of DynamicsGraph::trajectoryFG, without the
+   * contact height and contact kinematics factors, which the complementarity
+   * constraints replace.
+   */
+  static gtsam::NonlinearFactorGraph TrajectoryGraph(
+      const DynamicsGraph &graph_builder, const Robot &robot, int num_steps,
+      double dt, const PointOnLinks &candidates,
+      CollocationScheme collocation = Trapezoidal,
+      const boost::optional<double> &mu = boost::none);
+
+  /**
+   * Run the homotopy.
+   * @param graph                  cost and dynamics factors
+   * @param constraints            other equality constraints
+   * @param inequality_constraints other inequality constraints
+   * @param complementarity        contact constraints
+   * @param num_steps              number of time steps
+   * @param initial_values         initial values
+   * @param state                  (optional) state of the last stage
+   * @param intermediate_result    (optional) results of every inner loop
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph &graph,
+      const EqualityConstraints &constraints,
+      const InequalityConstraints &inequality_constraints,
+      const ContactComplementarity &complementarity, int num_steps,
+      const gtsam::Values &initial_values,
+      AugmentedLagrangianState *state = nullptr,
+      ConstrainedOptResult *intermediate_result = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -58,6 +58,15 @@ gtsam::Vector VectorExpressionEquality<P>::toleranceScaledViolation(
   return scaled_violation;
 }
 
+template <int P>
+void VectorExpressionEquality<P>::evaluate(
+    const gtsam::Values& x, gtsam::Vector* violation,
+    gtsam::Vector* scaled_violation) const {
+  VectorP result = expression_.value(x);
+  *violation = result;
+  *scaled_violation = result.cwiseQuotient(tolerance_);
+}
+
 template <int P>
 size_t VectorExpressionEquality<P>::dim() const {
   return P;
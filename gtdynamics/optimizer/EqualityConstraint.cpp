@@ -12,6 +12,12 @@
  */
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -43,4 +49,308 @@ gtsam::Vector DoubleExpressionEquality::toleranceScaledViolation(
   return (gtsam::Vector(1) << result / tolerance_).finished();
 }
 
+void DoubleExpressionEquality::evaluate(const gtsam::Values& x,
+                                        gtsam::Vector* violation,
+                                        gtsam::Vector* scaled_violation) const {
+  double result = expression_.value(x);
+  *violation = (gtsam::Vector(1) << result).finished();
+  *scaled_violation = (gtsam::Vector(1) << result / tolerance_).finished();
+}
+
+/* ************************************************************************* */
+// Stacked sigmas of the factors, which must have diagonal noise models.
+static gtsam::SharedNoiseModel StackedNoiseModel(
+    const std::vector<gtsam::NoiseModelFactor::shared_ptr>& factors) {
+  std::vector<gtsam::Vector> sigmas;
+  size_t dim = 0;
+  for (const auto& factor : factors) {
+    auto diagonal = boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+        factor->noiseModel());
+    if (!diagonal) {
+      throw std::invalid_argument(
+          "StackedNoiseModelFactor: noise models must be diagonal.");
+    }
+    sigmas.push_back(diagonal->sigmas());
+    dim += sigmas.back().size();
+  }
+  gtsam::Vector stacked(dim);
+  size_t offset = 0;
+  for (const auto& s : sigmas) {
+    stacked.segment(offset, s.size()) = s;
+    offset += s.size();
+  }
+  return gtsam::noiseModel::Diagonal::Sigmas(stacked);
+}
+
+// Union of the keys of the factors, sorted.
+static gtsam::KeyVector StackedKeys(
+    const std::vector<gtsam::NoiseModelFactor::shared_ptr>& factors) {
+  std::set<gtsam::Key> keys;
+  for (const auto& factor : factors) {
+    keys.insert(factor->keys().begin(), factor->keys().end());
+  }
+  return gtsam::KeyVector(keys.begin(), keys.end());
+}
+
+StackedNoiseModelFactor::StackedNoiseModelFactor(
+    const std::vector<gtsam::NoiseModelFactor::shared_ptr>& factors)
+    : gtsam::NoiseModelFactor(StackedNoiseModel(factors),
+                              StackedKeys(factors)),
+      factors_(factors) {
+  for (const auto& factor : factors_) {
+    std::vector<size_t> positions;
+    for (gtsam::Key key : factor->keys()) {
+      positions.push_back(
+          std::lower_bound(keys().begin(), keys().end(), key) -
+          keys().begin());
+    }
+    positions_.push_back(positions);
+  }
+}
+
+gtsam::Vector StackedNoiseModelFactor::unwhitenedError(
+    const gtsam::Values& x,
+    boost::optional<std::vector<gtsam::Matrix>&> H) const {
+  gtsam::Vector error(dim());
+  if (H) {
+    H->resize(size());
+    for (size_t k = 0; k < size(); k++) {
+      (*H)[k] = gtsam::Matrix::Zero(dim(), x.at(keys()[k]).dim());
+    }
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < factors_.size(); i++) {
+    const auto& factor = factors_[i];
+    gtsam::Vector e;
+    if (H) {
+      std::vector<gtsam::Matrix> Hi(factor->size());
+      e = factor->unwhitenedError(x, Hi);
+      for (size_t k = 0; k < factor->size(); k++) {
+        (*H)[positions_[i][k]].middleRows(offset, e.size()) = Hi[k];
+      }
+    } else {
+      e = factor->unwhitenedError(x);
+    }
+    error.segment(offset, e.size()) = e;
+    offset += e.size();
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+EqualityConstraintGroup::EqualityConstraintGroup(
+    const EqualityConstraints& constraints)
+    : constraints_(constraints), dim_(0) {
+  if (constraints_.empty()) {
+    throw std::invalid_argument(
+        "EqualityConstraintGroup: needs at least one constraint.");
+  }
+  for (const auto& constraint : constraints_) dim_ += constraint->dim();
+}
+
+gtsam::NoiseModelFactor::shared_ptr EqualityConstraintGroup::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  std::vector<gtsam::NoiseModelFactor::shared_ptr> factors;
+  size_t offset = 0;
+  for (const auto& constraint : constraints_) {
+    const size_t d = constraint->dim();
+    if (bias) {
+      gtsam::Vector segment = bias->segment(offset, d);
+      factors.push_back(constraint->createFactor(mu, segment));
+    } else {
+      factors.push_back(constraint->createFactor(mu));
+    }
+    offset += d;
+  }
+  return boost::make_shared<StackedNoiseModelFactor>(factors);
+}
+
+bool EqualityConstraintGroup::feasible(const gtsam::Values& x) const {
+  for (const auto& constraint : constraints_) {
+    if (!constraint->feasible(x)) return false;
+  }
+  return true;
+}
+
+gtsam::Vector EqualityConstraintGroup::operator()(
+    const gtsam::Values& x) const {
+  gtsam::Vector violation, scaled_violation;
+  evaluate(x, &violation, &scaled_violation);
+  return violation;
+}
+
+gtsam::Vector EqualityConstraintGroup::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  gtsam::Vector violation, scaled_violation;
+  evaluate(x, &violation, &scaled_violation);
+  return scaled_violation;
+}
+
+void EqualityConstraintGroup::evaluate(const gtsam::Values& x,
+                                       gtsam::Vector* violation,
+                                       gtsam::Vector* scaled_violation) const {
+  violation->resize(dim_);
+  scaled_violation->resize(dim_);
+  size_t offset = 0;
+  for (const auto& constraint : constraints_) {
+    gtsam::Vector v, s;
+    constraint->evaluate(x, &v, &s);
+    violation->segment(offset, v.size()) = v;
+    scaled_violation->segment(offset, s.size()) = s;
+    offset += v.size();
+  }
+}
+
+/* ************************************************************************* */
+namespace {
+/// The unwhitened error of another factor plus a bias, with its own noise.
+class BiasedFactor : public gtsam::NoiseModelFactor {
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+  gtsam::Vector bias_;
+
+ public:
+  BiasedFactor(const gtsam::NoiseModelFactor::shared_ptr& factor,
+               const gtsam::SharedNoiseModel& noise, const gtsam::Vector& bias)
+      : gtsam::NoiseModelFactor(noise, factor->keys()),
+        factor_(factor),
+        bias_(bias) {}
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values& x,
+      boost::optional<std::vector<gtsam::Matrix>&> H =
+          boost::none) const override {
+    return factor_->unwhitenedError(x, H) + bias_;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<BiasedFactor>(*this);
+  }
+};
+}  // namespace
+
+FactorEquality::FactorEquality(
+    const gtsam::NoiseModelFactor::shared_ptr& factor,
+    const gtsam::Vector& tolerance)
+    : factor_(factor), tolerance_(tolerance) {
+  if (!factor_) {
+    throw std::invalid_argument("FactorEquality: factor is null.");
+  }
+  if (tolerance_.size() != static_cast<int>(factor_->dim()) ||
+      !(tolerance_.array() > 0).all()) {
+    throw std::invalid_argument(
+        "FactorEquality: tolerance must be positive, one per dimension.");
+  }
+}
+
+FactorEquality::FactorEquality(
+    const gtsam::NoiseModelFactor::shared_ptr& factor, double tolerance)
+    : FactorEquality(factor,
+                     gtsam::Vector::Constant(factor ? factor->dim() : 0,
+                                             tolerance)) {}
+
+gtsam::NoiseModelFactor::shared_ptr FactorEquality::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  auto noise = gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu));
+  const gtsam::Vector offset =
+      bias ? gtsam::Vector(*bias) : gtsam::Vector::Zero(dim());
+  return boost::make_shared<BiasedFactor>(factor_, noise, offset);
+}
+
+bool FactorEquality::feasible(const gtsam::Values& x) const {
+  return (factor_->unwhitenedError(x).array().abs() <= tolerance_.array())
+      .all();
+}
+
+gtsam::Vector FactorEquality::operator()(const gtsam::Values& x) const {
+  return factor_->unwhitenedError(x);
+}
+
+gtsam::Vector FactorEquality::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  return factor_->unwhitenedError(x).cwiseQuotient(tolerance_);
+}
+
+/* ************************************************************************* */
+EqualityConstraints GroupEqualityConstraints(
+    const EqualityConstraints& constraints) {
+  // Constraints on every key set, in the order of the first one.
+  std::map<std::set<gtsam::Key>, size_t> group_index;
+  std::vector<EqualityConstraints> groups;
+  for (const auto& constraint : constraints) {
+    const std::set<gtsam::Key> keys = constraint->keys();
+    if (keys.empty()) {
+      groups.emplace_back();
+      groups.back().push_back(constraint);
+      continue;
+    }
+    auto inserted = group_index.emplace(keys, groups.size());
+    if (inserted.second) groups.emplace_back();
+    groups[inserted.first->second].push_back(constraint);
+  }
+
+  EqualityConstraints grouped;
+  for (const auto& group : groups) {
+    if (group.size() == 1) {
+      grouped.push_back(group.front());
+    } else {
+      grouped.emplace_shared<EqualityConstraintGroup>(group);
+    }
+  }
+  return grouped;
+}
+
+/* ************************************************************************* */
+namespace {
+/// Aggregate of tolerance-scaled violations.
+struct ViolationSummary {
+  double squared = 0.0, max = 0.0;
+  size_t num_infeasible = 0;
+};
+}  // namespace
+
+ConstraintEvaluation EvaluateConstraints(
+    size_t n,
+    const std::function<void(size_t, gtsam::Vector*, gtsam::Vector*)>& evaluate,
+    size_t num_threads, bool deterministic) {
+  ConstraintEvaluation evaluation;
+  evaluation.violations.resize(n);
+  evaluation.scaled_violations.resize(n);
+  const ViolationSummary summary = ParallelReduce<ViolationSummary>(
+      n, num_threads, deterministic, ViolationSummary(),
+      [&](size_t i) {
+        evaluate(i, &evaluation.violations[i],
+                 &evaluation.scaled_violations[i]);
+        const gtsam::Vector& scaled = evaluation.scaled_violations[i];
+        ViolationSummary s;
+        s.squared = scaled.squaredNorm();
+        s.max = scaled.size() ? scaled.cwiseAbs().maxCoeff() : 0;
+        s.num_infeasible = s.max > 1.0;
+        return s;
+      },
+      [](const ViolationSummary& a, const ViolationSummary& b) {
+        ViolationSummary s;
+        s.squared = a.squared + b.squared;
+        s.max = std::max(a.max, b.max);
+        s.num_infeasible = a.num_infeasible + b.num_infeasible;
+        return s;
+      });
+  evaluation.squared_violation = summary.squared;
+  evaluation.max_violation = summary.max;
+  evaluation.num_infeasible = summary.num_infeasible;
+  return evaluation;
+}
+
+/* ************************************************************************* */
+ConstraintEvaluation EvaluateConstraints(const EqualityConstraints& constraints,
+                                         const gtsam::Values& x,
+                                         size_t num_threads,
+                                         bool deterministic) {
+  return EvaluateConstraints(
+      constraints.size(),
+      [&](size_t i, gtsam::Vector* violation, gtsam::Vector* scaled) {
+        constraints[i]->evaluate(x, violation, scaled);
+      },
+      num_threads, deterministic);
+}
+
 }  // namespace gtdynamics
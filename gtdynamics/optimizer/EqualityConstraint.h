@@ -16,6 +16,11 @@
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
+#include <cmath>
+#include <functional>
+#include <set>
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -66,6 +71,16 @@ class EqualityConstraint {
   /** @brief return the dimension of the constraint. */
   virtual size_t dim() const = 0;
 
+  /**
+   * @brief Evaluate g(x) and g(x)/tolerance, by default calling operator()
+   * and toleranceScaledViolation separately.
+   */
+  virtual void evaluate(const gtsam::Values& x, gtsam::Vector* violation,
+                        gtsam::Vector* scaled_violation) const {
+    *violation = (*this)(x);
+    *scaled_violation = toleranceScaledViolation(x);
+  }
+
   /// Return keys of variables involved in the constraint.
   virtual std::set<gtsam::Key> keys() const{
     return std::set<gtsam::Key>();
@@ -101,6 +116,9 @@ class DoubleExpressionEquality : public EqualityConstraint {
 
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  void evaluate(const gtsam::Values& x, gtsam::Vector* violation,
+                gtsam::Vector* scaled_violation) const override;
+
   size_t dim() const override { return 1; }
 
   std::set<gtsam::Key> keys() const override{
@@ -140,6 +158,9 @@ class VectorExpressionEquality : public EqualityConstraint {
 
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  void evaluate(const gtsam::Values& x, gtsam::Vector* violation,
+                gtsam::Vector* scaled_violation) const override;
+
   size_t dim() const override;
 
   std::set<gtsam::Key> keys() const override{
@@ -174,6 +195,169 @@ class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
 
 };
 
+/**
+ * Factor whose residual stacks those of factors with diagonal noise models,
+ * e.g. created by EqualityConstraint::createFactor, on any of its keys; its
+ * noise model stacks their sigmas.
+ */
+class StackedNoiseModelFactor : public gtsam::NoiseModelFactor {
+ private:
+  std::vector<gtsam::NoiseModelFactor::shared_ptr> factors_;
+  // Position in keys() of every key of every factor.
+  std::vector<std::vector<size_t>> positions_;
+
+ public:
+  /// Constructor; throws if a noise model is not diagonal.
+  explicit StackedNoiseModelFactor(
+      const std::vector<gtsam::NoiseModelFactor::shared_ptr>& factors);
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values& x,
+      boost::optional<std::vector<gtsam::Matrix>&> H =
+          boost::none) const override;
+
+  /// The stacked factors.
+  const std::vector<gtsam::NoiseModelFactor::shared_ptr>& factors() const {
+    return factors_;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<StackedNoiseModelFactor>(*this);
+  }
+};
+
+/**
+ * Several equality constraints on the same keys, as one constraint whose
+ * violation stacks theirs. It creates a single StackedNoiseModelFactor, so
+ * that a merit graph has one factor to linearize instead of many small ones.
+ */
+class EqualityConstraintGroup : public EqualityConstraint {
+ protected:
+  EqualityConstraints constraints_;
+  size_t dim_;
+
+ public:
+  /// Constructor, from non-empty constraints.
+  explicit EqualityConstraintGroup(const EqualityConstraints& constraints);
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  void evaluate(const gtsam::Values& x, gtsam::Vector* violation,
+                gtsam::Vector* scaled_violation) const override;
+
+  size_t dim() const override { return dim_; }
+
+  std::set<gtsam::Key> keys() const override {
+    return constraints_.front()->keys();
+  }
+
+  /// The grouped constraints.
+  const EqualityConstraints& constraints() const { return constraints_; }
+};
+
+/**
+ * Equality constraint that forces the unwhitened error of a factor to zero,
+ * e.g. to use the factors of a dynamics graph as constraints. Its merit
+ * factor has the keys and Jacobians of the factor, and the noise model of
+ * the tolerance and penalty parameter.
+ */
+class FactorEquality : public EqualityConstraint {
+ protected:
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+  gtsam::Vector tolerance_;
+
+ public:
+  /**
+   * @brief Constructor; throws if the factor is null, or if the tolerance is
+   * not positive or does not match the dimension of the factor.
+   *
+   * @param factor     factor whose unwhitened error is g(x).
+   * @param tolerance  vector representing tolerance in each dimension.
+   */
+  FactorEquality(const gtsam::NoiseModelFactor::shared_ptr& factor,
+                 const gtsam::Vector& tolerance);
+
+  /// Constructor, with the same tolerance in every dimension.
+  FactorEquality(const gtsam::NoiseModelFactor::shared_ptr& factor,
+                 double tolerance);
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  size_t dim() const override { return tolerance_.size(); }
+
+  std::set<gtsam::Key> keys() const override {
+    return std::set<gtsam::Key>(factor_->keys().begin(),
+                                factor_->keys().end());
+  }
+
+  /// The constrained factor.
+  const gtsam::NoiseModelFactor::shared_ptr& factor() const { return factor_; }
+};
+
+/**
+ * Merge the constraints on the same set of keys into EqualityConstraintGroup
+ * constraints, in the order of their first constraint. Constraints that
+ * report no keys, and those alone on their keys, are kept as they are.
+ */
+EqualityConstraints GroupEqualityConstraints(
+    const EqualityConstraints& constraints);
+
+/// Violations of a set of constraints at one set of values.
+struct ConstraintEvaluation {
+  std::vector<gtsam::Vector> violations;         // g(x) for each constraint
+  std::vector<gtsam::Vector> scaled_violations;  // g(x)/tolerance
+  double squared_violation = 0.0;      // sum of ||g(x)/tolerance||^2
+  double max_violation = 0.0;          // max of |g(x)/tolerance| entries
+  size_t num_infeasible = 0;           // constraints out of tolerance
+
+  /// Norm of all tolerance-scaled violations.
+  double violationNorm() const { return sqrt(squared_violation); }
+};
+
+/**
+ * @brief Evaluate every constraint once, in parallel.
+ *
+ * @param constraints the constraints.
+ * @param x values to evaluate constraints at.
+ * @param num_threads number of threads, 0 for hardware concurrency.
+ * @param deterministic whether the squared violation may not depend on the
+ * scheduling of the threads, see ParallelReduce.
+ */
+ConstraintEvaluation EvaluateConstraints(const EqualityConstraints& constraints,
+                                         const gtsam::Values& x,
+                                         size_t num_threads = 0,
+                                         bool deterministic = true);
+
+/**
+ * @brief Evaluate n constraints in parallel, and aggregate their
+ * tolerance-scaled violations in the same pass.
+ *
+ * @param n number of constraints.
+ * @param evaluate sets the violation and scaled violation of constraint i.
+ * @param num_threads number of threads, 0 for hardware concurrency.
+ * @param deterministic see ParallelReduce.
+ */
+ConstraintEvaluation EvaluateConstraints(
+    size_t n,
+    const std::function<void(size_t, gtsam::Vector*, gtsam::Vector*)>& evaluate,
+    size_t num_threads, bool deterministic);
+
 }  // namespace gtdynamics
 
 #include <gtdynamics/optimizer/EqualityConstraint-inl.h>
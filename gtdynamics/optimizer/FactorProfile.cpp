@@ -0,0 +1,229 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorProfile.cpp
+ * @brief Attribute the cost of error and linearize calls to factor types.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtsam/linear/GaussianFactor.h>
+
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#ifdef GTDYNAMICS_PROFILE_ALLOCATIONS
+namespace {
+thread_local size_t num_allocations = 0;
+thread_local size_t num_allocated_bytes = 0;
+}  // namespace
+
+void *operator new(size_t size) {
+  num_allocations++;
+  num_allocated_bytes += size;
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+#endif
+
+namespace gtdynamics {
+
+using Clock = std::chrono::steady_clock;
+
+/* ************************************************************************* */
+bool FactorProfile::CountsAllocations() {
+#ifdef GTDYNAMICS_PROFILE_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* ************************************************************************* */
+size_t FactorProfile::NumAllocations() {
+#ifdef GTDYNAMICS_PROFILE_ALLOCATIONS
+  return num_allocations;
+#else
+  return 0;
+#endif
+}
+
+/* ************************************************************************* */
+size_t FactorProfile::NumAllocatedBytes() {
+#ifdef GTDYNAMICS_PROFILE_ALLOCATIONS
+  return num_allocated_bytes;
+#else
+  return 0;
+#endif
+}
+
+/* ************************************************************************* */
+std::string FactorProfile::FactorType(const gtsam::NonlinearFactor &factor) {
+  return boost::core::demangle(typeid(factor).name());
+}
+
+/* ************************************************************************* */
+void FactorProfile::addFactor(const std::string &type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  statistics_[type].num_factors++;
+}
+
+/* ************************************************************************* */
+void FactorProfile::record(const std::string &type, bool linearize,
+                           double seconds, size_t allocations) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FactorStatistics &statistics = statistics_[type];
+  if (linearize) {
+    statistics.linearize_calls++;
+    statistics.linearize_time += seconds;
+    statistics.linearize_allocations += allocations;
+  } else {
+    statistics.error_calls++;
+    statistics.error_time += seconds;
+    statistics.error_allocations += allocations;
+  }
+}
+
+/* ************************************************************************* */
+std::map<std::string, FactorStatistics> FactorProfile::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+/* ************************************************************************* */
+void FactorProfile::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  statistics_.clear();
+}
+
+/* ************************************************************************* */
+void FactorProfile::print(const std::string &s) const {
+  using Entry = std::pair<std::string, FactorStatistics>;
+  const auto statistics = this->statistics();
+  std::vector<Entry> entries(statistics.begin(), statistics.end());
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) {
+              return a.second.time() > b.second.time();
+            });
+
+  if (!s.empty()) std::cout << s << std::endl;
+  std::printf("%10s %10s %12s %10s %12s %12s  %s\n", "factors", "errors",
+              "error [ms]", "linearize", "lin. [ms]", "allocations", "type");
+  for (auto &&entry : entries) {
+    const FactorStatistics &f = entry.second;
+    std::printf("%10zu %10zu %12.3f %10zu %12.3f %12s  %s\n", f.num_factors,
+                f.error_calls, 1e3 * f.error_time, f.linearize_calls,
+                1e3 * f.linearize_time,
+                CountsAllocations()
+                    ? std::to_string(f.error_allocations +
+                                     f.linearize_allocations)
+                          .c_str()
+                    : "-",
+                entry.first.c_str());
+  }
+}
+
+/* ************************************************************************* */
+void FactorProfile::saveJson(std::ostream &stm) const {
+  using JsonSaver = gtdynamics::JsonSaver;
+  std::vector<std::string> items;
+  for (auto &&entry : statistics()) {
+    const FactorStatistics &f = entry.second;
+    std::vector<JsonSaver::AttributeType> attributes{
+        {JsonSaver::Quoted("type"), JsonSaver::Quoted(entry.first)},
+        {JsonSaver::Quoted("num_factors"), std::to_string(f.num_factors)},
+        {JsonSaver::Quoted("error_calls"), std::to_string(f.error_calls)},
+        {JsonSaver::Quoted("error_time"), std::to_string(f.error_time)},
+        {JsonSaver::Quoted("linearize_calls"),
+         std::to_string(f.linearize_calls)},
+        {JsonSaver::Quoted("linearize_time"),
+         std::to_string(f.linearize_time)}};
+    if (CountsAllocations()) {
+      attributes.emplace_back(JsonSaver::Quoted("error_allocations"),
+                              std::to_string(f.error_allocations));
+      attributes.emplace_back(JsonSaver::Quoted("linearize_allocations"),
+                              std::to_string(f.linearize_allocations));
+    }
+    items.push_back(JsonSaver::JsonDict(attributes, -1));
+  }
+  stm << (items.empty() ? std::string("[]") : JsonSaver::JsonList(items));
+}
+
+/* ************************************************************************* */
+ProfiledFactor::ProfiledFactor(const Base::shared_ptr &factor,
+                               const std::shared_ptr<FactorProfile> &profile)
+    : Base(factor->keys()),
+      factor_(factor),
+      type_(FactorProfile::FactorType(*factor)),
+      profile_(profile) {}
+
+/* ************************************************************************* */
+double ProfiledFactor::error(const gtsam::Values &values) const {
+  const size_t allocations = FactorProfile::NumAllocations();
+  const auto start = Clock::now();
+  const double error = factor_->error(values);
+  const std::chrono::duration<double> duration = Clock::now() - start;
+  profile_->record(type_, false, duration.count(),
+                   FactorProfile::NumAllocations() - allocations);
+  return error;
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> ProfiledFactor::linearize(
+    const gtsam::Values &values) const {
+  const size_t allocations = FactorProfile::NumAllocations();
+  const auto start = Clock::now();
+  auto linear = factor_->linearize(values);
+  const std::chrono::duration<double> duration = Clock::now() - start;
+  profile_->record(type_, true, duration.count(),
+                   FactorProfile::NumAllocations() - allocations);
+  return linear;
+}
+
+/* ************************************************************************* */
+void ProfiledFactor::print(const std::string &s,
+                           const gtsam::KeyFormatter &keyFormatter) const {
+  factor_->print(s + "Profiled ", keyFormatter);
+}
+
+/* ************************************************************************* */
+bool ProfiledFactor::equals(const gtsam::NonlinearFactor &other,
+                            double tol) const {
+  const This *e = dynamic_cast<const This *>(&other);
+  return e != nullptr && factor_->equals(*e->factor_, tol);
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph ProfileFactors(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::shared_ptr<FactorProfile> &profile) {
+  gtsam::NonlinearFactorGraph profiled;
+  for (auto &&factor : graph) {
+    if (!factor) {
+      profiled.push_back(factor);
+      continue;
+    }
+    auto wrapped = boost::make_shared<ProfiledFactor>(factor, profile);
+    profile->addFactor(FactorProfile::FactorType(*factor));
+    profiled.push_back(wrapped);
+  }
+  return profiled;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorProfile.h
+ * @brief Attribute the cost of error and linearize calls to factor types.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gtdynamics {
+
+/// Cost of the error and linearize calls of one factor type.
+struct FactorStatistics {
+  size_t num_factors = 0;            // factors of this type in the graph
+  size_t error_calls = 0;            // calls to error
+  size_t linearize_calls = 0;        // calls to linearize
+  double error_time = 0;             // total time in error, in seconds
+  double linearize_time = 0;         // total time in linearize, in seconds
+  size_t error_allocations = 0;      // heap allocations in error
+  size_t linearize_allocations = 0;  // heap allocations in linearize
+
+  /// Total time in seconds.
+  double time() const { return error_time + linearize_time; }
+};
+
+/**
+ * FactorProfile collects FactorStatistics per factor class, identified by the
+ * demangled name of its dynamic type. Factors are profiled by wrapping them
+ * with ProfileFactors; the wrappers may be evaluated from several threads.
+ *
+ * Heap allocations are only counted when GTDynamics is configured with
+ * GTDYNAMICS_PROFILE_ALLOCATIONS, which replaces the global operator new.
+ */
+class FactorProfile {
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, FactorStatistics> statistics_;
+
+ public:
+  /// Whether heap allocations are counted in this build.
+  static bool CountsAllocations();
+
+  /// Number of heap allocations made by this thread so far, if counted.
+  static size_t NumAllocations();
+
+  /// Number of bytes requested by the heap allocations of this thread.
+  static size_t NumAllocatedBytes();
+
+  /// Demangled class name of a factor.
+  static std::string FactorType(const gtsam::NonlinearFactor &factor);
+
+  /// Count one more factor of the given type.
+  void addFactor(const std::string &type);
+
+  /// Record one call to error (linearize = false) or linearize.
+  void record(const std::string &type, bool linearize, double seconds,
+              size_t allocations);
+
+  /// Statistics per factor type.
+  std::map<std::string, FactorStatistics> statistics() const;
+
+  /// Forget all statistics.
+  void clear();
+
+  /// Print a table of the statistics, most expensive factor type first.
+  void print(const std::string &s = "") const;
+
+  /// Write the statistics as a JSON list of dictionaries, see JsonSaver.
+  void saveJson(std::ostream &stm) const;
+};
+
+/**
+ * ProfiledFactor wraps another factor, forwards error and linearize to it,
+ * and records their cost in a FactorProfile.
+ */
+class ProfiledFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = ProfiledFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  Base::shared_ptr factor_;
+  std::string type_;
+  std::shared_ptr<FactorProfile> profile_;
+
+ public:
+  /**
+   * Constructor.
+   * @param factor  the factor to profile
+   * @param profile where to record the cost of the factor
+   */
+  ProfiledFactor(const Base::shared_ptr &factor,
+                 const std::shared_ptr<FactorProfile> &profile);
+
+  virtual ~ProfiledFactor() {}
+
+  /// The wrapped factor.
+  const Base::shared_ptr &factor() const { return factor_; }
+
+  double error(const gtsam::Values &values) const override;
+
+  size_t dim() const override { return factor_->dim(); }
+
+  bool active(const gtsam::Values &values) const override {
+    return factor_->active(values);
+  }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &values) const override;
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+  bool equals(const gtsam::NonlinearFactor &other,
+              double tol = 1e-9) const override;
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/**
+ * Wrap every factor of a graph in a ProfiledFactor.
+ * @param graph   the graph to profile
+ * @param profile where to record the cost of the factors
+ */
+gtsam::NonlinearFactorGraph ProfileFactors(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::shared_ptr<FactorProfile> &profile);
+
+}  // namespace gtdynamics
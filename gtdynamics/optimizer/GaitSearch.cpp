@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaitSearch.cpp
+ * @brief Solve the trajectories of candidate gait schedules in parallel and
+ * rank them.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/GaitSearch.h>
+#include <gtdynamics/optimizer/SolvePlan.h>
+#include <gtdynamics/utils/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Values;
+
+namespace {
+// Wall-clock seconds since start.
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Rank of a result: converged candidates, then pruned, then failed.
+int Tier(const GaitResult &result) {
+  return !result.solved ? 2 : result.pruned ? 1 : 0;
+}
+
+bool Better(const GaitResult &a, const GaitResult &b) {
+  if (Tier(a) != Tier(b)) return Tier(a) < Tier(b);
+  if (Tier(a) == 2) return a.index < b.index;
+  const double error_a = a.pruned ? a.partial_error : a.error;
+  const double error_b = b.pruned ? b.partial_error : b.error;
+  return error_a < error_b || (error_a == error_b && a.index < b.index);
+}
+}  // namespace
+
+/* ************************************************************************* */
+GaitSearch::GaitSearch(const OptimizationParameters &parameters,
+                       size_t screening_iterations, double prune_ratio,
+                       size_t max_survivors, size_t num_threads)
+    : parameters_(parameters),
+      screening_iterations_(screening_iterations),
+      prune_ratio_(prune_ratio),
+      max_survivors_(max_survivors),
+      num_threads_(num_threads) {
+  if (prune_ratio < 1.0) {
+    throw std::invalid_argument("GaitSearch: prune_ratio must be at least 1");
+  }
+  if (!parameters_.solve_plans && !parameters_.time_ordering) {
+    parameters_.solve_plans = std::make_shared<SolvePlanCache>();
+  }
+}
+
+/* ************************************************************************* */
+std::vector<GaitResult> GaitSearch::run(
+    const std::vector<GaitCandidate> &candidates,
+    const Builder &builder) const {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const size_t max_iterations = parameters_.lm_parameters.maxIterations;
+  const bool screen =
+      screening_iterations_ > 0 && screening_iterations_ < max_iterations;
+
+  OptimizationParameters screening = parameters_, remaining = parameters_;
+  if (screen) {
+    screening.lm_parameters.maxIterations = screening_iterations_;
+    remaining.lm_parameters.maxIterations =
+        max_iterations - screening_iterations_;
+  }
+
+  // Problems are kept between the rounds, so survivors are not rebuilt.
+  std::vector<GaitResult> results(candidates.size());
+  std::vector<SweepProblem> problems(candidates.size());
+  std::vector<std::chrono::steady_clock::time_point> starts(
+      candidates.size());
+  ThreadPool pool(num_threads_);
+
+  // Screening round, or the whole solve if there is no screening.
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    futures.push_back(pool.submit([&, i]() {
+      GaitResult &result = results[i];
+      result.index = i;
+      result.name = candidates[i].name;
+      result.initial_error = result.partial_error = result.error = nan;
+      starts[i] = std::chrono::steady_clock::now();
+      try {
+        problems[i] = builder(candidates[i].walkCycle());
+        const SweepProblem &problem = problems[i];
+        result.initial_error = problem.graph.error(problem.initial_values);
+        result.values = Optimizer(screen ? screening : parameters_)
+                            .optimize(problem.graph, problem.initial_values);
+        result.partial_error = result.error =
+            problem.graph.error(result.values);
+        result.solved = true;
+      } catch (const std::exception &e) {
+        result.message = e.what();
+      }
+      result.seconds = SecondsSince(starts[i]);
+    }));
+  }
+  for (auto &&future : futures) future.get();
+
+  if (screen) {
+    // Prune by screening error, relative to the best screened candidate.
+    std::vector<size_t> solved;
+    for (size_t i = 0; i < results.size(); i++) {
+      if (results[i].solved) solved.push_back(i);
+    }
+    std::sort(solved.begin(), solved.end(), [&](size_t a, size_t b) {
+      return Better(results[a], results[b]);
+    });
+    for (size_t r = 0; r < solved.size(); r++) {
+      GaitResult &result = results[solved[r]];
+      const double best = results[solved.front()].partial_error;
+      result.pruned = result.partial_error > prune_ratio_ * best ||
+                      (max_survivors_ > 0 && r >= max_survivors_);
+    }
+
+    // Solve the survivors to convergence.
+    futures.clear();
+    for (size_t i : solved) {
+      if (results[i].pruned) continue;
+      futures.push_back(pool.submit([&, i]() {
+        GaitResult &result = results[i];
+        const SweepProblem &problem = problems[i];
+        try {
+          result.values =
+              Optimizer(remaining).optimize(problem.graph, result.values);
+          result.error = problem.graph.error(result.values);
+        } catch (const std::exception &e) {
+          result.solved = false;
+          result.message = e.what();
+        }
+        result.seconds = SecondsSince(starts[i]);
+        problems[i] = SweepProblem();
+      }));
+    }
+    for (auto &&future : futures) future.get();
+  }
+
+  std::sort(results.begin(), results.end(), Better);
+  return results;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaitSearch.h
+ * @brief Solve the trajectories of candidate gait schedules in parallel and
+ * rank them.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/ParameterSweep.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/WalkCycle.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// A candidate gait schedule: the contacts and length of every phase.
+struct GaitCandidate {
+  std::string name;                  ///< name to report the candidate by
+  FootContactVector states;          ///< contacts of every phase
+  std::vector<size_t> phase_lengths; ///< time steps of every phase
+
+  /// The walk cycle of the schedule.
+  WalkCycle walkCycle() const { return WalkCycle(states, phase_lengths); }
+};
+
+/// Outcome of the trajectory optimization of one candidate.
+struct GaitResult {
+  size_t index = 0;     ///< index of the candidate
+  std::string name;     ///< name of the candidate
+  bool solved = false;  ///< false if building or solving the problem threw
+  bool pruned = false;  ///< true if stopped after the screening solve
+  double initial_error = 0;  ///< graph error of the initial values
+  double partial_error = 0;  ///< graph error after the screening solve
+  double error = 0;          ///< graph error of the returned values
+  double seconds = 0;   ///< wall-clock time to build and solve
+  gtsam::Values values;  ///< the solution, or the screening one if pruned
+  std::string message;  ///< the exception message if not solved
+};
+
+/**
+ * GaitSearch solves the trajectory optimization of every candidate gait
+ * schedule on a ThreadPool, and ranks the candidates by their final error.
+ *
+ * Candidates are solved in two rounds. The screening round builds every
+ * problem and runs a few LM iterations on it; candidates whose error is then
+ * more than prune_ratio times the best one, or beyond the max_survivors
+ * best, are pruned. Only the others are solved to convergence, continuing
+ * from their screening solution. Unless an ordering is already requested in
+ * the parameters, all solves share one SolvePlanCache, so that candidates
+ * with the same graph structure, e.g. the same phase lengths on a
+ * ContactActivationGraph, share their elimination ordering.
+ *
+ * As in ParameterSweep, every problem is built and solved by its own task:
+ * the builder may share a const Robot and graph builder between candidates,
+ * but not modify them. A failing candidate does not stop the search.
+ */
+class GaitSearch {
+ public:
+  /// Creates the problem of a candidate; may be called concurrently.
+  typedef std::function<SweepProblem(const WalkCycle &)> Builder;
+
+  /**
+   * Constructor.
+   * @param parameters           parameters of the optimizer of every candidate
+   * @param screening_iterations LM iterations of the screening round, 0 to
+   * solve all candidates to convergence without pruning
+   * @param prune_ratio          prune candidates with a screening error above
+   * this multiple of the best screening error
+   * @param max_survivors        most candidates solved to convergence, 0 for
+   * no limit
+   * @param num_threads          number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  GaitSearch(const OptimizationParameters &parameters =
+                 OptimizationParameters(),
+             size_t screening_iterations = 10, double prune_ratio = 10.0,
+             size_t max_survivors = 0, size_t num_threads = 0);
+
+  /**
+   * Build and solve the problems of all candidates.
+   * @param candidates the gait schedules
+   * @param builder    creates the problem of the walk cycle of a candidate
+   * @return results of all candidates, best first: the candidates solved to
+   * convergence by error, then the pruned ones by screening error, then the
+   * failed ones
+   */
+  std::vector<GaitResult> run(const std::vector<GaitCandidate> &candidates,
+                              const Builder &builder) const;
+
+ private:
+  OptimizationParameters parameters_;
+  size_t screening_iterations_;
+  double prune_ratio_;
+  size_t max_survivors_;
+  size_t num_threads_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HessianAssembly.cpp
+ * @brief Linearization of trajectory graphs into per-time-step normal
+ * equations, without a JacobianFactor per factor.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/HessianAssembly.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtsam/base/SymmetricBlockMatrix.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <map>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::NoiseModelFactor;
+using gtsam::Vector;
+
+namespace {
+// Whether a factor is assembled: a small NoiseModelFactor whose
+// linearization is a plain whitened Jacobian.
+bool Assembled(const gtsam::NonlinearFactor::shared_ptr &factor,
+               size_t max_dim) {
+  const auto noise_model_factor =
+      boost::dynamic_pointer_cast<NoiseModelFactor>(factor);
+  if (!noise_model_factor || factor->dim() > max_dim) return false;
+  const auto &model = noise_model_factor->noiseModel();
+  if (!model) return true;
+  return !model->isConstrained() &&
+         boost::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(model);
+}
+}  // namespace
+
+/* ************************************************************************* */
+HessianAssembly::HessianAssembly(
+    const gtsam::NonlinearFactorGraph &graph, size_t max_dim,
+    const FactorTimeIndex::Labels &untimed_labels)
+    : num_factors_(graph.size()) {
+  auto untimed = [&](Key key) {
+    return std::find(untimed_labels.begin(), untimed_labels.end(),
+                     DynamicsSymbol::LabelCodeOf(key)) != untimed_labels.end();
+  };
+
+  // Factors by their earliest step, and those on untimed keys only.
+  std::map<uint64_t, Group> steps;
+  Group untimed_group;
+  for (size_t i = 0; i < graph.size(); i++) {
+    if (!graph[i]) continue;
+    if (!Assembled(graph[i], max_dim)) {
+      others_.push_back(i);
+      continue;
+    }
+    bool timed = false;
+    uint64_t first = 0;
+    for (Key key : graph[i]->keys()) {
+      if (untimed(key)) continue;
+      const uint64_t t = DynamicsSymbol::TimeOf(key);
+      first = timed ? std::min(first, t) : t;
+      timed = true;
+    }
+    Group &group = timed ? steps[first] : untimed_group;
+    group.factors.push_back(i);
+    group.keys.insert(group.keys.end(), graph[i]->begin(), graph[i]->end());
+  }
+  for (auto &&step : steps) groups_.push_back(std::move(step.second));
+  if (!untimed_group.factors.empty()) {
+    groups_.push_back(std::move(untimed_group));
+  }
+
+  for (Group &group : groups_) {
+    std::sort(group.keys.begin(), group.keys.end());
+    group.keys.erase(std::unique(group.keys.begin(), group.keys.end()),
+                     group.keys.end());
+    for (size_t i : group.factors) {
+      std::vector<size_t> slots;
+      for (Key key : graph[i]->keys()) {
+        slots.push_back(std::lower_bound(group.keys.begin(), group.keys.end(),
+                                         key) -
+                        group.keys.begin());
+      }
+      group.slots.push_back(std::move(slots));
+    }
+  }
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr HessianAssembly::linearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t num_threads) const {
+  if (graph.size() != num_factors_) {
+    throw std::invalid_argument(
+        "HessianAssembly: the graph is not the one grouped");
+  }
+  auto linear = boost::make_shared<GaussianFactorGraph>();
+  linear->resize(groups_.size() + others_.size());
+  ParallelFor(linear->size(), num_threads, [&](size_t g) {
+    if (g >= groups_.size()) {
+      (*linear)[g] = graph[others_[g - groups_.size()]]->linearize(values);
+      return;
+    }
+
+    // The augmented information matrix [A b]' [A b] of the step, upper
+    // triangle only, with the right-hand side as its last column.
+    const Group &group = groups_[g];
+    std::vector<size_t> dims, offsets;
+    size_t n = 0;
+    for (Key key : group.keys) {
+      dims.push_back(values.at(key).dim());
+      offsets.push_back(n);
+      n += dims.back();
+    }
+    Matrix info = Matrix::Zero(n + 1, n + 1);
+    std::vector<Matrix> A;
+    for (size_t f = 0; f < group.factors.size(); f++) {
+      const auto &factor =
+          static_cast<const NoiseModelFactor &>(*graph[group.factors[f]]);
+      if (!factor.active(values)) continue;
+      A.resize(factor.size());
+      Vector b = -factor.unwhitenedError(values, A);
+      if (factor.noiseModel()) factor.noiseModel()->WhitenSystem(A, b);
+
+      const std::vector<size_t> &slots = group.slots[f];
+      for (size_t a = 0; a < slots.size(); a++) {
+        const size_t row = offsets[slots[a]];
+        for (size_t c = 0; c < slots.size(); c++) {
+          if (slots[c] < slots[a]) continue;
+          info.block(row, offsets[slots[c]], A[a].cols(), A[c].cols())
+              .noalias() += A[a].transpose() * A[c];
+        }
+        info.block(row, n, A[a].cols(), 1).noalias() += A[a].transpose() * b;
+      }
+      info(n, n) += b.squaredNorm();
+    }
+    (*linear)[g] = boost::make_shared<gtsam::HessianFactor>(
+        group.keys, gtsam::SymmetricBlockMatrix(dims, info, true));
+  });
+  return linear;
+}
+
+}  // namespace gtdynamics
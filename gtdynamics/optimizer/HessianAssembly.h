@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HessianAssembly.h
+ * @brief Linearization of trajectory graphs into per-time-step normal
+ * equations, without a JacobianFactor per factor.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorTimeIndex.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * HessianAssembly linearizes a graph into one HessianFactor per time step
+ * instead of one JacobianFactor per factor. The small factors of a step,
+ * i.e. those whose earliest key is at the step, are evaluated with their
+ * whitened Jacobians A and errors b, and A' A, A' b and b' b are added
+ * straight into the blocks of the normal equations of the step, one dense
+ * matrix per step allocated once per linearization. Trajectory graphs have
+ * dozens of factors per step with one to six rows each, so this replaces
+ * thousands of small allocations and copies with one per step, and leaves
+ * elimination with a few dense factors.
+ *
+ * Only NoiseModelFactors with Gaussian, non-constrained noise models and at
+ * most max_dim rows are assembled. The others, e.g. with robust or
+ * constrained noise models, are linearized as in
+ * NonlinearFactorGraph::linearize and appended after the steps. The result
+ * has the same normal equations, and so the same LM steps and linearized
+ * errors, as NonlinearFactorGraph::linearize.
+ *
+ * Steps are the time fields of the keys, as in FactorTimeIndex, and factors
+ * on untimed keys only make up one more group. Grouping only affects speed:
+ * graphs whose keys are not DynamicsSymbols are assembled correctly, if into
+ * arbitrary groups.
+ */
+class HessianAssembly {
+ public:
+  /// Factors assembled into the normal equations of one step.
+  struct Group {
+    gtsam::KeyVector keys;       ///< keys of its factors, sorted
+    std::vector<size_t> factors;  ///< indices of its factors in the graph
+    /// Positions in keys of the keys of every factor.
+    std::vector<std::vector<size_t>> slots;
+  };
+
+  /**
+   * Constructor.
+   * @param graph          the graph whose factors to group
+   * @param max_dim        maximum number of rows of an assembled factor
+   * @param untimed_labels labels of keys that are not placed in time
+   */
+  explicit HessianAssembly(
+      const gtsam::NonlinearFactorGraph &graph, size_t max_dim = 12,
+      const FactorTimeIndex::Labels &untimed_labels =
+          FactorTimeIndex::DefaultUntimedLabels());
+
+  /// Groups of assembled factors, in step order, then the untimed group.
+  const std::vector<Group> &groups() const { return groups_; }
+
+  /// Indices of the factors linearized on their own, in graph order.
+  const std::vector<size_t> &otherFactors() const { return others_; }
+
+  /**
+   * Linearize all factors of the graph the groups were made for.
+   * @param graph       the graph, with the same factors as at construction
+   * @param values      the linearization point
+   * @param num_threads number of threads, 0 for all threads of the shared
+   * executor
+   */
+  gtsam::GaussianFactorGraph::shared_ptr linearize(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+      size_t num_threads = 1) const;
+
+ private:
+  size_t num_factors_;
+  std::vector<Group> groups_;
+  std::vector<size_t> others_;
+};
+
+}  // namespace gtdynamics
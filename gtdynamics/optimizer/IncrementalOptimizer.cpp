@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalOptimizer.cpp
+ * @brief iSAM2-based optimizer for receding-horizon trajectory problems.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+namespace gtdynamics {
+
+using gtsam::FactorIndices;
+using gtsam::FastList;
+using gtsam::FastMap;
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+Values IncrementalOptimizer::update(
+    const NonlinearFactorGraph &new_factors, const Values &new_values,
+    const boost::optional<uint64_t> &earliest_time) {
+  const Deadline deadline(p_.time_budget, p_.cancellation);
+
+  // Variables to marginalize, among existing and new ones.
+  FastList<Key> old_keys;
+  FastMap<Key, int> constrained_keys;
+  if (earliest_time) {
+    auto classify = [&](Key key) {
+      const bool old = DynamicsSymbol(key).time() < *earliest_time;
+      if (old) old_keys.push_back(key);
+      constrained_keys[key] = old ? 0 : 1;
+    };
+    for (Key key : isam_.getLinearizationPoint().keys()) classify(key);
+    for (Key key : new_values.keys()) classify(key);
+  }
+
+  if (old_keys.empty()) {
+    isam_.update(new_factors, new_values);
+  } else {
+    // Eliminate the old variables first and make sure they are re-eliminated,
+    // so that they end up as leaves of the Bayes tree.
+    isam_.update(new_factors, new_values, FactorIndices(), constrained_keys,
+                 boost::none, old_keys);
+    isam_.marginalizeLeaves(old_keys);
+  }
+
+  // Extra updates relinearize and converge towards the (local) optimum, for
+  // as long as the time budget allows.
+  for (size_t i = 1; i < p_.num_isam2_updates && !deadline.expired(); i++) {
+    isam_.update();
+  }
+  return isam_.calculateEstimate();
+}
+
+}  // namespace gtdynamics
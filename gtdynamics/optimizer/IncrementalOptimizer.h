@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalOptimizer.h
+ * @brief iSAM2-based optimizer for receding-horizon trajectory problems.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+
+namespace gtdynamics {
+
+/**
+ * IncrementalOptimizer keeps a trajectory problem in a gtsam::ISAM2 instance,
+ * so that shifting the horizon only re-eliminates and relinearizes the part
+ * of the problem that changed.
+ *
+ * All keys are expected to be DynamicsSymbols; their time step decides which
+ * variables are marginalized when the window moves. Example:
+ *
+ *   IncrementalOptimizer optimizer(params);
+ *   optimizer.update(window_graph, window_values);
+ *   for (each cycle) {
+ *     // new slice (e.g. DynamicsGraph::dynamicsFactorGraph at t_new) plus
+ *     // collocation factors to t_new - 1, and its initial values
+ *     optimizer.update(slice_graph, slice_values, t_oldest + 1);
+ *   }
+ */
+class IncrementalOptimizer : public Optimizer {
+ protected:
+  gtsam::ISAM2 isam_;
+
+ public:
+  /// Constructor, uses parameters.isam2_parameters.
+  explicit IncrementalOptimizer(
+      const OptimizationParameters &parameters = OptimizationParameters())
+      : Optimizer(parameters), isam_(parameters.isam2_parameters) {}
+
+  /**
+   * Add factors and variables, then marginalize variables older than a
+   * given time step.
+   *
+   * The marginalized variables are eliminated first, so they are leaves of
+   * the Bayes tree, and are replaced by a prior on the variables they were
+   * connected to. The extra updates of num_isam2_updates stop when the
+   * time budget of the parameters runs out or the solve is cancelled, but
+   * the new factors are always added.
+   *
+   * @param new_factors   factors to add
+   * @param new_values    initial values for variables not yet in the problem
+   * @param earliest_time marginalize all variables with time step below this
+   * @return the current estimate of all remaining variables
+   */
+  gtsam::Values update(
+      const gtsam::NonlinearFactorGraph &new_factors,
+      const gtsam::Values &new_values,
+      const boost::optional<uint64_t> &earliest_time = boost::none);
+
+  /// Current estimate of all variables.
+  gtsam::Values calculateEstimate() const { return isam_.calculateEstimate(); }
+
+  /// The underlying iSAM2 instance.
+  const gtsam::ISAM2 &isam() const { return isam_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.cpp
+ * @brief Inequality constraints in constrained optimization.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Ramp function max(0, x).
+static double Ramp(const double& x,
+                   gtsam::OptionalJacobian<1, 1> H = boost::none) {
+  if (H) H->setConstant(x > 0 ? 1.0 : 0.0);
+  return x > 0 ? x : 0.0;
+}
+
+gtsam::NoiseModelFactor::shared_ptr DoubleExpressionInequality::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, tolerance_ / sqrt(mu));
+  const double margin = bias ? (*bias)(0) : 0.0;
+  gtsam::Expression<double> hinge(
+      Ramp, gtsam::Expression<double>(margin) - expression_);
+  return gtsam::NoiseModelFactor::shared_ptr(
+      new gtsam::ExpressionFactor<double>(noise, 0.0, hinge));
+}
+
+bool DoubleExpressionInequality::feasible(const gtsam::Values& x) const {
+  return expression_.value(x) >= -tolerance_;
+}
+
+gtsam::Vector DoubleExpressionInequality::operator()(
+    const gtsam::Values& x) const {
+  double result = expression_.value(x);
+  return (gtsam::Vector(1) << result).finished();
+}
+
+gtsam::Vector DoubleExpressionInequality::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  double result = expression_.value(x);
+  return (gtsam::Vector(1) << Ramp(-result) / tolerance_).finished();
+}
+
+gtsam::JacobianFactor::shared_ptr DoubleExpressionInequality::linearize(
+    const gtsam::Values& x) const {
+  const std::set<gtsam::Key> keys = expression_.keys();
+  std::vector<gtsam::Matrix> H(keys.size());
+  const double g = expression_.value(x, H);
+  std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+  size_t i = 0;
+  for (gtsam::Key key : keys) terms.emplace_back(key, H[i++]);
+  return boost::make_shared<gtsam::JacobianFactor>(terms, gtsam::Vector1(-g));
+}
+
+ConstraintEvaluation EvaluateConstraints(
+    const InequalityConstraints& constraints, const gtsam::Values& x,
+    size_t num_threads, bool deterministic) {
+  return EvaluateConstraints(
+      constraints.size(),
+      [&](size_t i, gtsam::Vector* violation, gtsam::Vector* scaled) {
+        *violation = (*constraints[i])(x);
+        *scaled = constraints[i]->toleranceScaledViolation(x);
+      },
+      num_threads, deterministic);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.h
+ * @brief Inequality constraints in constrained optimization.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Inequality constraint base class, for constraints g(x) >= 0.
+ */
+class InequalityConstraint {
+ public:
+  typedef InequalityConstraint This;
+  typedef boost::shared_ptr<This> shared_ptr;
+
+  /** Default constructor. */
+  InequalityConstraint() {}
+
+  /** Destructor. */
+  virtual ~InequalityConstraint() {}
+
+  /**
+   * @brief Create a factor representing the component in the merit function.
+   *
+   * @param mu penalty parameter.
+   * @param bias additional bias, e.g. multiplier / mu.
+   * @return a factor representing
+   * 1/2 mu||max(0, bias - g(x))||_Diag(tolerance^2)^2, which vanishes when the
+   * constraint is satisfied with margin bias.
+   */
+  virtual gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const = 0;
+
+  /**
+   * @brief Check if g(x) >= -tolerance.
+   *
+   * @param x values to evalute constraint at.
+   * @return bool representing if is feasible.
+   */
+  virtual bool feasible(const gtsam::Values& x) const = 0;
+
+  /**
+   * @brief Evaluate g(x), which is non-negative if the constraint holds.
+   *
+   * @param x values to evalute constraint at.
+   * @return a vector with g(x) in each dimension.
+   */
+  virtual gtsam::Vector operator()(const gtsam::Values& x) const = 0;
+
+  /** @brief Violation scaled by tolerance, max(0, -g(x))/tolerance. */
+  virtual gtsam::Vector toleranceScaledViolation(
+      const gtsam::Values& x) const = 0;
+
+  /** @brief return the dimension of the constraint. */
+  virtual size_t dim() const = 0;
+
+  /// Return keys of variables involved in the constraint.
+  virtual std::set<gtsam::Key> keys() const { return std::set<gtsam::Key>(); }
+
+  /**
+   * @brief Linearize the constraint at x, e.g. for a QP subproblem.
+   *
+   * @param x values to linearize at.
+   * @return a factor [A b] such that g(x + dx) >= 0 is A dx >= b to first
+   * order, i.e. A = dg/dx and b = -g(x).
+   */
+  virtual gtsam::JacobianFactor::shared_ptr linearize(
+      const gtsam::Values& x) const {
+    throw std::runtime_error(
+        "InequalityConstraint: linearize is not implemented");
+  }
+};
+
+/** Inequality constraint that forces g(x) >= 0, where g(x) is a
+ * scalar-valued function. */
+class DoubleExpressionInequality : public InequalityConstraint {
+ protected:
+  gtsam::Expression<double> expression_;
+  double tolerance_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param expression  expression representing g(x).
+   * @param tolerance   scalar representing tolerance.
+   */
+  DoubleExpressionInequality(const gtsam::Expression<double>& expression,
+                             const double& tolerance)
+      : expression_(expression), tolerance_(tolerance) {}
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  size_t dim() const override { return 1; }
+
+  std::set<gtsam::Key> keys() const override { return expression_.keys(); }
+
+  gtsam::JacobianFactor::shared_ptr linearize(
+      const gtsam::Values& x) const override;
+};
+
+/// Container of InequalityConstraint.
+class InequalityConstraints
+    : public std::vector<InequalityConstraint::shared_ptr> {
+ private:
+  using Base = std::vector<InequalityConstraint::shared_ptr>;
+
+  template <typename DERIVEDCONSTRAINT>
+  using IsDerived = typename std::enable_if<
+      std::is_base_of<InequalityConstraint, DERIVEDCONSTRAINT>::value>::type;
+
+ public:
+  InequalityConstraints() : Base() {}
+
+  /// Add a set of inequality constraints.
+  void add(const InequalityConstraints& other) {
+    insert(end(), other.begin(), other.end());
+  }
+
+  /// Emplace a shared pointer to constraint of given type.
+  template <class DERIVEDCONSTRAINT, class... Args>
+  IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
+    push_back(boost::allocate_shared<DERIVEDCONSTRAINT>(
+        Eigen::aligned_allocator<DERIVEDCONSTRAINT>(),
+        std::forward<Args>(args)...));
+  }
+};
+
+/**
+ * @brief Evaluate every inequality constraint once, in parallel. The
+ * violations are g(x), the scaled violations max(0, -g(x))/tolerance.
+ *
+ * @param constraints the constraints.
+ * @param x values to evaluate constraints at.
+ * @param num_threads number of threads, 0 for hardware concurrency.
+ * @param deterministic see ParallelReduce.
+ */
+ConstraintEvaluation EvaluateConstraints(
+    const InequalityConstraints& constraints, const gtsam::Values& x,
+    size_t num_threads = 0, bool deterministic = true);
+
+}  // namespace gtdynamics
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IntermediateValuesLog.cpp
+ * @brief Stream intermediate values of constrained optimization to disk.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/IntermediateValuesLog.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+IntermediateValuesLog::IntermediateValuesLog(const std::string &prefix,
+                                             bool diffs, double tolerance)
+    : prefix_(prefix), diffs_(diffs), tolerance_(tolerance) {}
+
+/* ************************************************************************* */
+std::string IntermediateValuesLog::Path(const std::string &prefix,
+                                        size_t iteration) {
+  return prefix + "_" + std::to_string(iteration) + ".gtdtraj";
+}
+
+/* ************************************************************************* */
+void IntermediateValuesLog::operator()(size_t iteration, const Values &values) {
+  TrajectoryLogWriter writer(Path(prefix_, iteration));
+  if (!diffs_) {
+    writer.appendTrajectory(values);
+    return;
+  }
+
+  Values changed;
+  for (auto &&key_value : values) {
+    if (written_.exists(key_value.key)) {
+      const gtsam::Value &previous = written_.at(key_value.key);
+      if (previous.localCoordinates_(key_value.value).norm() <= tolerance_) {
+        continue;
+      }
+      written_.update(key_value.key, key_value.value);
+    } else {
+      written_.insert(key_value.key, key_value.value);
+    }
+    changed.insert(key_value.key, key_value.value);
+  }
+  writer.appendTrajectory(changed);
+}
+
+/* ************************************************************************* */
+Values IntermediateValuesLog::Read(const std::string &prefix, size_t iteration,
+                                   bool diffs) {
+  if (!diffs) return TrajectoryLog(Path(prefix, iteration)).values();
+  Values values;
+  for (size_t i = 0; i <= iteration; i++) {
+    for (auto &&key_value : TrajectoryLog(Path(prefix, i)).values()) {
+      if (values.exists(key_value.key)) {
+        values.update(key_value.key, key_value.value);
+      } else {
+        values.insert(key_value.key, key_value.value);
+      }
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
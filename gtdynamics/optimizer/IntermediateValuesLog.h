@@ -0,0 +1,74 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IntermediateValuesLog.h
+ * @brief Stream intermediate values of constrained optimization to disk.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * IntermediateValuesLog writes the values after every inner loop of a
+ * constrained optimizer to trajectory logs, one file per iteration, instead
+ * of keeping them in memory. With diffs, an iteration only stores the
+ * variables that moved by more than a tolerance since they were last
+ * written, and Read layers the files of all earlier iterations. Only one
+ * copy of the values is kept, for the diffs.
+ *
+ * Variables must be DynamicsSymbols of the types TrajectoryLogWriter stores.
+ *
+ * Example:
+ *   IntermediateValuesLog log("/tmp/solve", true);
+ *   ConstrainedOptResult info;
+ *   info.store_values = false;
+ *   info.callback = std::ref(log);
+ *   optimizer.optimize(graph, constraints, init, &info);
+ *   Values third = IntermediateValuesLog::Read("/tmp/solve", 2, true);
+ */
+class IntermediateValuesLog {
+ private:
+  std::string prefix_;
+  bool diffs_;
+  double tolerance_;
+  gtsam::Values written_;  // last written value of every variable, for diffs
+
+ public:
+  /**
+   * Constructor.
+   * @param prefix    path of the logs without iteration and extension
+   * @param diffs     whether to write only the variables that changed
+   * @param tolerance norm of the change, in the tangent space, up to which a
+   * variable is considered unchanged
+   */
+  explicit IntermediateValuesLog(const std::string &prefix, bool diffs = false,
+                                 double tolerance = 0.0);
+
+  /// Path of the log of an iteration.
+  static std::string Path(const std::string &prefix, size_t iteration);
+
+  /// Write the values after an iteration, see IterationCallback.
+  void operator()(size_t iteration, const gtsam::Values &values);
+
+  /**
+   * Read the values after an iteration.
+   * @param prefix    path of the logs without iteration and extension
+   * @param iteration the iteration
+   * @param diffs     whether the logs were written with diffs
+   */
+  static gtsam::Values Read(const std::string &prefix, size_t iteration,
+                            bool diffs = false);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointStateSmoother.cpp
+ * @brief Fixed-lag smoother for joint states from encoder measurements.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/factors/JointMeasurementFactor.h>
+#include <gtdynamics/optimizer/JointStateSmoother.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+namespace {
+// The robot itself if it has a fixed link, else with its first link fixed.
+Robot FixedBase(const Robot &robot) {
+  const auto &links = robot.links();
+  if (links.empty()) {
+    throw std::invalid_argument("JointStateSmoother: robot has no links");
+  }
+  const bool fixed = std::any_of(links.begin(), links.end(),
+                                 [](const LinkSharedPtr &link) {
+                                   return link->isFixed();
+                                 });
+  return fixed ? robot : robot.fixLink(links.front()->name());
+}
+
+// Factors of step 0: kinematics, and dynamics if the torques are known.
+NonlinearFactorGraph StepFactors(const DynamicsGraph &graph_builder,
+                                 const Robot &robot, bool use_torques) {
+  if (use_torques) return graph_builder.dynamicsFactorGraph(robot, 0);
+  NonlinearFactorGraph graph = graph_builder.qFactors(robot, 0);
+  graph.add(graph_builder.vFactors(robot, 0));
+  graph.add(graph_builder.aFactors(robot, 0));
+  return graph;
+}
+}  // namespace
+
+/* ************************************************************************* */
+JointStateSmoother::JointStateSmoother(
+    const Robot &robot, double dt, size_t lag, double measurement_sigma,
+    double accel_sigma, const boost::optional<gtsam::Vector3> &gravity,
+    bool use_torques, const OptimizationParameters &parameters)
+    : robot_(FixedBase(robot)),
+      dt_(dt),
+      lag_(lag),
+      use_torques_(use_torques),
+      measurement_model_(
+          gtsam::noiseModel::Isotropic::Sigma(6, measurement_sigma)),
+      accel_model_(gtsam::noiseModel::Isotropic::Sigma(1, accel_sigma * dt)),
+      graph_builder_(gravity),
+      step_(StepFactors(graph_builder_, robot_, use_torques), 0),
+      optimizer_(parameters) {
+  if (lag < 2) {
+    throw std::invalid_argument("JointStateSmoother: lag must be at least 2");
+  }
+  torque_model_ = graph_builder_.opt().prior_t_cost_model;
+
+  // Collocation of angles and velocities, and a random walk on the
+  // accelerations, from step 0 to step 1.
+  transition_ = graph_builder_.collocationFactors(robot_, 0, dt);
+  for (auto &&joint : robot_.joints()) {
+    transition_.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAccelKey(joint->id(), 0), JointAccelKey(joint->id(), 1), 0.0,
+        accel_model_);
+  }
+}
+
+/* ************************************************************************* */
+Values JointStateSmoother::initialValues(uint64_t t,
+                                         const Values &measurements) const {
+  Values values;
+  if (t == 0) {
+    // At rest, with the measured angles.
+    Values joints;
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      const Key q = JointAngleKey(j);
+      InsertJointAngle(&joints, j,
+                       measurements.exists(q) ? measurements.at<double>(q)
+                                              : 0.0);
+      InsertJointVel(&joints, j, 0.0);
+    }
+    values = robot_.forwardKinematics(joints);
+    for (auto &&link : robot_.links()) {
+      InsertTwistAccel(&values, link->id(), gtsam::Z_6x1);
+    }
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertJointAccel(&values, j, 0.0);
+      if (!use_torques_) continue;
+      InsertTorque(&values, j, 0.0);
+      for (auto &&link : joint->links()) {
+        InsertWrench(&values, link->id(), j, gtsam::Z_6x1);
+      }
+    }
+    return values;
+  }
+
+  // The estimate of the previous step, with the measured angles.
+  for (Key key : estimate_.keys()) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.time() == t - 1) {
+      values.insert(Key(symbol.atTime(t)), estimate_.at(key));
+    }
+  }
+  for (auto &&joint : robot_.joints()) {
+    const Key q = JointAngleKey(joint->id());
+    if (measurements.exists(q)) {
+      values.update(JointAngleKey(joint->id(), t), measurements.at<double>(q));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+const Values &JointStateSmoother::update(const Values &measurements,
+                                         const Values &torques) {
+  const uint64_t t = t_;
+  NonlinearFactorGraph graph = step_.instantiate(t);
+  if (t == 0) {
+    // The first step is at rest.
+    const OptimizerSetting &opt = graph_builder_.opt();
+    for (auto &&joint : robot_.joints()) {
+      graph.addPrior<double>(JointVelKey(joint->id(), 0), 0.0,
+                             opt.prior_qv_cost_model);
+      graph.addPrior<double>(JointAccelKey(joint->id(), 0), 0.0,
+                             opt.prior_qa_cost_model);
+    }
+  } else {
+    graph.add(RekeyGraph(transition_, [t](Key key) {
+      const DynamicsSymbol symbol(key);
+      return Key(symbol.atTime(symbol.time() + t - 1));
+    }));
+  }
+
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    const Key q = JointAngleKey(j);
+    if (measurements.exists(q)) {
+      graph.emplace_shared<JointMeasurementFactor>(
+          measurement_model_, joint, measurements.at<double>(q), t);
+    }
+    if (use_torques_) {
+      graph.addPrior<double>(TorqueKey(j, t), Torque(torques, j),
+                             torque_model_);
+    }
+  }
+
+  // Keep the last lag_ steps, including this one.
+  boost::optional<uint64_t> earliest_time;
+  if (t + 1 > lag_) earliest_time = t + 1 - lag_;
+  estimate_ =
+      optimizer_.update(graph, initialValues(t, measurements), earliest_time);
+  t_++;
+  return estimate_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointStateSmoother.h
+ * @brief Fixed-lag smoother for joint states from encoder measurements.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+
+namespace gtdynamics {
+
+/**
+ * JointStateSmoother estimates joint angles, velocities and accelerations
+ * online from encoder readings, with a JointMeasurementFactor per reading.
+ * Every tick adds one time step: the kinematics factors of DynamicsGraph,
+ * and optionally its dynamics factors with the commanded torques, collocation
+ * to the previous step, and a random walk on the joint accelerations. Steps
+ * older than the lag are marginalized by IncrementalOptimizer, so memory and
+ * the cost of an update do not grow with the number of ticks.
+ *
+ * The factors of a step and of a transition are built once, and every tick
+ * instantiates them at the new time through GraphTemplate and RekeyGraph.
+ *
+ * Joint states do not depend on the motion of the base, so a robot without
+ * fixed link is estimated with its first link fixed at its rest pose. The
+ * first step is assumed at rest.
+ *
+ * Example:
+ *   JointStateSmoother smoother(robot, 0.001, 20, 1e-3, 10.0);
+ *   for (each tick) {
+ *     smoother.update(encoder_angles);  // JointAngleKey(j) for measured j
+ *     double qdot = smoother.jointVel(j);
+ *   }
+ */
+class JointStateSmoother {
+ private:
+  Robot robot_;
+  double dt_;
+  size_t lag_;
+  bool use_torques_;
+  gtsam::SharedNoiseModel measurement_model_, accel_model_, torque_model_;
+  DynamicsGraph graph_builder_;
+
+  /// Factors of step 0, and from step 0 to step 1.
+  GraphTemplate step_;
+  gtsam::NonlinearFactorGraph transition_;
+
+  IncrementalOptimizer optimizer_;
+  uint64_t t_ = 0;  // time of the next update
+  gtsam::Values estimate_;
+
+  /// Initial values of the variables of step t.
+  gtsam::Values initialValues(uint64_t t,
+                              const gtsam::Values &measurements) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot             the robot
+   * @param dt                time between ticks
+   * @param lag               number of time steps kept in the smoother
+   * @param measurement_sigma standard deviation of the encoder readings
+   * @param accel_sigma       standard deviation of the change of the joint
+   * accelerations per second, for the random walk
+   * @param gravity           gravity, needed with torques
+   * @param use_torques       whether to add the dynamics factors and the
+   * commanded torques of every tick
+   * @param parameters        parameters of the IncrementalOptimizer
+   */
+  JointStateSmoother(
+      const Robot &robot, double dt, size_t lag, double measurement_sigma,
+      double accel_sigma,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      bool use_torques = false,
+      const OptimizationParameters &parameters = OptimizationParameters());
+
+  /**
+   * Add the readings of one tick and update the estimate.
+   * @param measurements JointAngleKey(j) of every measured joint j
+   * @param torques      TorqueKey(j) of all joints, read with use_torques
+   * @return the estimate of all steps in the window
+   */
+  const gtsam::Values &update(const gtsam::Values &measurements,
+                              const gtsam::Values &torques = gtsam::Values());
+
+  /// Number of updates so far.
+  uint64_t numUpdates() const { return t_; }
+
+  /// Time between ticks.
+  double dt() const { return dt_; }
+
+  /// Number of time steps kept in the smoother.
+  size_t lag() const { return lag_; }
+
+  /// Estimate of all steps in the window.
+  const gtsam::Values &estimate() const { return estimate_; }
+
+  /// The robot, with its first link fixed if it had no fixed link.
+  const Robot &robot() const { return robot_; }
+
+  /// Estimated joint angle at the latest step.
+  double jointAngle(int j) const { return JointAngle(estimate_, j, t_ - 1); }
+
+  /// Estimated joint velocity at the latest step.
+  double jointVel(int j) const { return JointVel(estimate_, j, t_ - 1); }
+
+  /// Estimated joint acceleration at the latest step.
+  double jointAccel(int j) const { return JointAccel(estimate_, j, t_ - 1); }
+};
+
+}  // namespace gtdynamics
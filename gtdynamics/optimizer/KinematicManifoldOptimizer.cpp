@@ -0,0 +1,517 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicManifoldOptimizer.cpp
+ * @brief Optimization over joint coordinates, with link poses and twists
+ * recovered by forward kinematics.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/KinematicManifoldOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::NoiseModelFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+KinematicManifold::Structure::Structure(
+    const Robot &robot, bool twists,
+    const boost::optional<std::string> &prior_link_name)
+    : robot(robot), fk(robot, prior_link_name), twists(twists) {
+  const RobotTopology &topo = robot.topology();
+  const auto &root_link = topo.links[fk.rootIndex()];
+  root = root_link->id();
+  root_fixed = root_link->isFixed();
+
+  is_dependent.assign(topo.link_index.size(), false);
+  is_tree_joint.assign(topo.joint_index.size(), false);
+  if (root_fixed) {
+    is_dependent[root] = true;
+    dependent_links.push_back(root);
+  }
+  for (int j : fk.treeJoints()) {
+    const JointSharedPtr &joint = topo.joints[j];
+    tree_joints.push_back(joint);
+    is_tree_joint[joint->id()] = true;
+    for (const auto &link : {joint->parent(), joint->child()}) {
+      if (link->id() != root && !is_dependent[link->id()]) {
+        is_dependent[link->id()] = true;
+        dependent_links.push_back(link->id());
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+KinematicManifold::KinematicManifold(
+    const Robot &robot, bool twists,
+    const boost::optional<std::string> &prior_link_name)
+    : structure_(
+          std::make_shared<Structure>(robot, twists, prior_link_name)) {}
+
+/* ************************************************************************* */
+bool KinematicManifold::isDependent(Key key) const {
+  static const uint16_t pose_code = PoseKey(0).labelCode();
+  static const uint16_t twist_code = TwistKey(0).labelCode();
+  const Structure &s = *structure_;
+  const DynamicsSymbol symbol(key);
+  const uint16_t code = symbol.labelCode();
+  if (code != pose_code && !(s.twists && code == twist_code)) return false;
+  return symbol.robotIdx() == 0 &&
+         symbol.jointIdx() == DynamicsSymbol::kNoIndex &&
+         symbol.linkIdx() < s.is_dependent.size() &&
+         s.is_dependent[symbol.linkIdx()];
+}
+
+/* ************************************************************************* */
+bool KinematicManifold::isKinematic(
+    const gtsam::NonlinearFactor &factor) const {
+  const Structure &s = *structure_;
+  if (factor.size() != 3 && !(s.twists && factor.size() == 4)) return false;
+  static const uint16_t angle_code = JointAngleKey(0).labelCode();
+  for (Key key : factor.keys()) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.labelCode() != angle_code || symbol.robotIdx() != 0 ||
+        symbol.jointIdx() >= s.is_tree_joint.size() ||
+        !s.is_tree_joint[symbol.jointIdx()]) {
+      continue;
+    }
+    const RobotTopology &topo = s.robot.topology();
+    const JointSharedPtr &joint =
+        topo.joints[topo.joint_index[symbol.jointIdx()]];
+    const int p = joint->parent()->id(), c = joint->child()->id();
+    const int j = joint->id(), t = symbol.time();
+    KeyVector expected =
+        factor.size() == 3
+            ? KeyVector{PoseKey(p, t), PoseKey(c, t), JointAngleKey(j, t)}
+            : KeyVector{TwistKey(p, t), TwistKey(c, t), JointAngleKey(j, t),
+                        JointVelKey(j, t)};
+    KeyVector keys = factor.keys();
+    std::sort(expected.begin(), expected.end());
+    std::sort(keys.begin(), keys.end());
+    return keys == expected;
+  }
+  return false;
+}
+
+/* ************************************************************************* */
+KeyVector KinematicManifold::sliceKeys(size_t t) const {
+  const Structure &s = *structure_;
+  KeyVector keys;
+  for (const auto &joint : s.tree_joints) {
+    keys.push_back(JointAngleKey(joint->id(), t));
+    if (s.twists) keys.push_back(JointVelKey(joint->id(), t));
+  }
+  if (!s.root_fixed) {
+    keys.push_back(PoseKey(s.root, t));
+    if (s.twists) keys.push_back(TwistKey(s.root, t));
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::slice(const Values &values, size_t t) const {
+  const Structure &s = *structure_;
+  const RobotTopology &topo = s.robot.topology();
+  const size_t num_joints = topo.joints.size();
+  Matrix q = Matrix::Zero(1, num_joints);
+  Matrix v = s.twists ? Matrix::Zero(1, num_joints) : Matrix();
+  for (const auto &joint : s.tree_joints) {
+    const int k = topo.joint_index[joint->id()];
+    q(0, k) = JointAngle(values, joint->id(), t);
+    if (s.twists) v(0, k) = JointVel(values, joint->id(), t);
+  }
+  boost::optional<Pose3> root_pose;
+  boost::optional<Vector6> root_twist;
+  if (!s.root_fixed) {
+    root_pose = values.at<Pose3>(PoseKey(s.root, t));
+    if (s.twists) root_twist = values.at<Vector6>(TwistKey(s.root, t));
+  }
+
+  // BatchForwardKinematics keeps its results, so compute on a copy.
+  BatchForwardKinematics fk = s.fk;
+  fk.compute(q, v, root_pose, root_twist);
+  Values result;
+  for (uint16_t id : s.dependent_links) {
+    result.insert(PoseKey(id, t), fk.pose(0, id));
+    if (s.twists) result.insert(TwistKey(id, t), fk.twist(0, id));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::recover(const Values &values, const KeyVector &keys,
+                                  const std::vector<size_t> &times) const {
+  Values result;
+  for (Key key : keys) result.insert(key, values.at(key));
+  for (size_t t : times) result.insert(slice(values, t));
+  return result;
+}
+
+/* ************************************************************************* */
+KeyVector KinematicManifold::independentKeys(
+    const KeyVector &keys, const std::vector<size_t> &times) const {
+  KeyVector result;
+  for (Key key : keys) {
+    if (!isDependent(key)) result.push_back(key);
+  }
+  for (size_t t : times) {
+    const KeyVector slice_keys = sliceKeys(t);
+    result.insert(result.end(), slice_keys.begin(), slice_keys.end());
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+/* ************************************************************************* */
+std::vector<size_t> KinematicManifold::dependentTimes(
+    const KeyVector &keys) const {
+  std::vector<size_t> times;
+  for (Key key : keys) {
+    if (isDependent(key)) times.push_back(DynamicsSymbol(key).time());
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  return times;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph KinematicManifold::sliceConstraints(size_t t) const {
+  const Structure &s = *structure_;
+  NonlinearFactorGraph graph;
+  auto constrained = gtsam::noiseModel::Constrained::All(6);
+  if (s.root_fixed) {
+    const RobotTopology &topo = s.robot.topology();
+    graph.emplace_shared<gtsam::PriorFactor<Pose3>>(
+        PoseKey(s.root, t), topo.links[topo.link_index[s.root]]->getFixedPose(),
+        constrained);
+    if (s.twists) {
+      graph.emplace_shared<gtsam::PriorFactor<Vector6>>(
+          TwistKey(s.root, t), Vector6::Zero(), constrained);
+    }
+  }
+  for (const auto &joint : s.tree_joints) {
+    graph.emplace_shared<gtsam::ExpressionFactor<Vector6>>(
+        constrained, Vector6::Zero(), joint->poseConstraint(t));
+    if (s.twists) {
+      graph.emplace_shared<gtsam::ExpressionFactor<Vector6>>(
+          constrained, Vector6::Zero(), joint->twistConstraint(t));
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::independent(const Values &values) const {
+  Values result;
+  for (const auto &key_value : values) {
+    if (!isDependent(key_value.key)) {
+      result.insert(key_value.key, key_value.value);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::expand(const Values &values) const {
+  const Structure &s = *structure_;
+  if (s.tree_joints.empty()) return values;
+
+  // Steps at which the first tree joint has an angle.
+  static const uint16_t angle_code = JointAngleKey(0).labelCode();
+  const int j = s.tree_joints.front()->id();
+  Values result = values;
+  for (const auto &key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    if (symbol.labelCode() != angle_code || symbol.robotIdx() != 0 ||
+        symbol.jointIdx() != j) {
+      continue;
+    }
+    for (const auto &dependent : slice(values, symbol.time())) {
+      if (result.exists(dependent.key)) {
+        result.update(dependent.key, dependent.value);
+      } else {
+        result.insert(dependent.key, dependent.value);
+      }
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph KinematicManifold::reduce(
+    const NonlinearFactorGraph &graph) const {
+  const Structure &s = *structure_;
+  NonlinearFactorGraph result;
+  std::map<std::vector<size_t>, NonlinearFactorGraph> groups;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    const std::vector<size_t> times = dependentTimes(factor->keys());
+    if (times.empty()) {
+      result.push_back(factor);
+      continue;
+    }
+    if (isKinematic(*factor)) continue;
+
+    // Factors on the fixed root only are constant on the manifold.
+    const bool on_root = std::all_of(
+        factor->keys().begin(), factor->keys().end(), [&](Key key) {
+          return s.root_fixed && isDependent(key) &&
+                 DynamicsSymbol(key).linkIdx() == s.root;
+        });
+    if (on_root) continue;
+    groups[times].push_back(factor);
+  }
+  for (const auto &group : groups) {
+    result.emplace_shared<KinematicManifoldFactor>(*this, group.second,
+                                                   group.first);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+EqualityConstraints KinematicManifold::reduce(
+    const EqualityConstraints &constraints) const {
+  EqualityConstraints result;
+  for (const auto &constraint : constraints) {
+    const auto factor = constraint->createFactor(1.0);
+    if (dependentTimes(factor->keys()).empty()) {
+      result.push_back(constraint);
+    } else if (!isKinematic(*factor)) {
+      result.emplace_shared<KinematicManifoldConstraint>(*this, constraint);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+namespace {
+KeyVector FactorKeys(const NonlinearFactorGraph &factors) {
+  KeyVector keys;
+  for (const auto &factor : factors) {
+    keys.insert(keys.end(), factor->keys().begin(), factor->keys().end());
+  }
+  return keys;
+}
+
+gtsam::SharedNoiseModel FactorNoiseModel(const NonlinearFactorGraph &factors) {
+  size_t dim = 0;
+  for (const auto &factor : factors) {
+    auto noise_factor = boost::dynamic_pointer_cast<NoiseModelFactor>(factor);
+    if (!noise_factor) {
+      throw std::invalid_argument(
+          "KinematicManifoldFactor: factors on link poses and twists must be "
+          "NoiseModelFactors.");
+    }
+    if (factors.size() == 1) return noise_factor->noiseModel();
+    if (noise_factor->noiseModel()->isConstrained()) {
+      throw std::invalid_argument(
+          "KinematicManifoldFactor: cannot stack factors with constrained "
+          "noise models, pass them as constraints instead.");
+    }
+    dim += noise_factor->dim();
+  }
+  return gtsam::noiseModel::Unit::Create(dim);
+}
+}  // namespace
+
+/* ************************************************************************* */
+KinematicManifoldFactor::KinematicManifoldFactor(
+    const KinematicManifold &manifold, const NonlinearFactorGraph &factors,
+    const std::vector<size_t> &times)
+    : NoiseModelFactor(FactorNoiseModel(factors),
+                       manifold.independentKeys(FactorKeys(factors), times)),
+      manifold_(manifold),
+      factors_(factors),
+      times_(times),
+      stacked_(factors.size() != 1) {
+  for (size_t t : times_) constraints_.push_back(manifold_.sliceConstraints(t));
+  if (stacked_) {
+    whiteners_.reserve(factors_.size());
+    for (const auto &factor : factors_) {
+      whiteners_.emplace_back(
+          boost::static_pointer_cast<NoiseModelFactor>(factor)->noiseModel());
+    }
+  }
+}
+
+/* ************************************************************************* */
+double KinematicManifoldFactor::error(const Values &x) const {
+  return factors_.error(manifold_.recover(x, keys(), times_));
+}
+
+/* ************************************************************************* */
+Vector KinematicManifoldFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const Values values = manifold_.recover(x, keys(), times_);
+
+  // Columns of the independent variables and rows of the dependent ones.
+  std::map<Key, size_t> column, row;
+  size_t num_columns = 0, num_rows = 0;
+  for (Key key : keys()) {
+    column[key] = num_columns;
+    num_columns += x.at(key).dim();
+  }
+
+  // Jacobian T of the dependent variables in the independent ones, from the
+  // linearized constraints C_d dd + C_i di = 0.
+  Matrix T;
+  if (H) {
+    for (const auto &key_value : values) {
+      if (!column.count(key_value.key)) {
+        row[key_value.key] = num_rows;
+        num_rows += key_value.value.dim();
+      }
+    }
+    Matrix C_d = Matrix::Zero(num_rows, num_rows);
+    Matrix C_i = Matrix::Zero(num_rows, num_columns);
+    size_t r = 0;
+    for (const auto &factor : constraints_) {
+      auto constraint = boost::static_pointer_cast<NoiseModelFactor>(factor);
+      std::vector<Matrix> Hc(constraint->size());
+      const size_t m = constraint->unwhitenedError(values, Hc).size();
+      for (size_t k = 0; k < constraint->size(); k++) {
+        const Key key = constraint->keys()[k];
+        if (row.count(key)) {
+          C_d.block(r, row[key], m, Hc[k].cols()) = Hc[k];
+        } else {
+          C_i.block(r, column.at(key), m, Hc[k].cols()) = Hc[k];
+        }
+      }
+      r += m;
+    }
+    if (r != num_rows) {
+      throw std::runtime_error(
+          "KinematicManifoldFactor: kinematic constraints do not determine "
+          "the link poses and twists.");
+    }
+    T = -C_d.partialPivLu().solve(C_i);
+  }
+
+  // Errors of the factors, and their Jacobians in the independent variables.
+  Vector error(dim());
+  Matrix J = Matrix::Zero(dim(), num_columns);
+  size_t offset = 0;
+  for (size_t i = 0; i < factors_.size(); i++) {
+    auto noise_factor =
+        boost::static_pointer_cast<NoiseModelFactor>(factors_[i]);
+    std::vector<Matrix> Hf(noise_factor->size());
+    Vector e = H ? noise_factor->unwhitenedError(values, Hf)
+                 : noise_factor->unwhitenedError(values);
+    if (stacked_) {
+      if (H) {
+        whiteners_[i].whitenSystem(Hf, e);
+      } else {
+        e = whiteners_[i].whiten(e);
+      }
+    }
+    error.segment(offset, e.size()) = e;
+    if (H) {
+      for (size_t k = 0; k < noise_factor->size(); k++) {
+        const Key key = noise_factor->keys()[k];
+        auto it = row.find(key);
+        if (it != row.end()) {
+          J.middleRows(offset, e.size()) +=
+              Hf[k] * T.middleRows(it->second, Hf[k].cols());
+        } else {
+          J.block(offset, column.at(key), e.size(), Hf[k].cols()) += Hf[k];
+        }
+      }
+    }
+    offset += e.size();
+  }
+
+  if (H) {
+    H->resize(size());
+    for (size_t k = 0; k < size(); k++) {
+      const Key key = keys()[k];
+      (*H)[k] = J.middleCols(column[key], x.at(key).dim());
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+KinematicManifoldConstraint::KinematicManifoldConstraint(
+    const KinematicManifold &manifold,
+    const EqualityConstraint::shared_ptr &constraint)
+    : manifold_(manifold), constraint_(constraint) {
+  const KeyVector keys = constraint_->createFactor(1.0)->keys();
+  times_ = manifold_.dependentTimes(keys);
+  keys_ = manifold_.independentKeys(keys, times_);
+}
+
+/* ************************************************************************* */
+gtsam::NoiseModelFactor::shared_ptr KinematicManifoldConstraint::createFactor(
+    const double mu, boost::optional<gtsam::Vector &> bias) const {
+  NonlinearFactorGraph factors;
+  factors.push_back(constraint_->createFactor(mu, bias));
+  return boost::make_shared<KinematicManifoldFactor>(manifold_, factors,
+                                                     times_);
+}
+
+/* ************************************************************************* */
+bool KinematicManifoldConstraint::feasible(const Values &x) const {
+  return constraint_->feasible(manifold_.recover(x, keys_, times_));
+}
+
+/* ************************************************************************* */
+Vector KinematicManifoldConstraint::operator()(const Values &x) const {
+  return (*constraint_)(manifold_.recover(x, keys_, times_));
+}
+
+/* ************************************************************************* */
+Vector KinematicManifoldConstraint::toleranceScaledViolation(
+    const Values &x) const {
+  return constraint_->toleranceScaledViolation(
+      manifold_.recover(x, keys_, times_));
+}
+
+/* ************************************************************************* */
+void KinematicManifoldConstraint::evaluate(const Values &x, Vector *violation,
+                                           Vector *scaled_violation) const {
+  constraint_->evaluate(manifold_.recover(x, keys_, times_), violation,
+                        scaled_violation);
+}
+
+/* ************************************************************************* */
+Values KinematicManifoldOptimizer::optimize(
+    const NonlinearFactorGraph &graph, const Values &initial_values) const {
+  const Values result = Optimizer::optimize(
+      manifold_.reduce(graph), manifold_.independent(initial_values));
+  return manifold_.expand(result);
+}
+
+/* ************************************************************************* */
+Values KinematicManifoldOptimizer::optimize(
+    const NonlinearFactorGraph &graph, const EqualityConstraints &constraints,
+    const Values &initial_values) const {
+  const Values result = Optimizer::optimize(
+      manifold_.reduce(graph), manifold_.reduce(constraints),
+      manifold_.independent(initial_values));
+  return manifold_.expand(result);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,265 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicManifoldOptimizer.h
+ * @brief Optimization over joint coordinates, with link poses and twists
+ * recovered by forward kinematics.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * KinematicManifold parametrizes the manifold defined by the pose, and
+ * optionally twist, constraints of the joints of a spanning tree of the robot
+ * by the joint angles and velocities on the tree, and the pose and twist of
+ * its root link unless the root is fixed. Link poses and twists at a time step
+ * are then dependent variables, recovered by forward kinematics.
+ *
+ * The tree and its root are those of BatchForwardKinematics. Factors that are
+ * the kinematic constraints of a tree joint, on exactly the keys of
+ * Joint::poseConstraint or Joint::twistConstraint, vanish on the manifold.
+ * Joints that close loops, contacts and all other factors on dependent
+ * variables remain, as KinematicManifoldFactor on the independent ones.
+ *
+ * Copies share the same structure, so they are cheap.
+ */
+class KinematicManifold {
+ public:
+  /**
+   * Constructor.
+   * @param robot           the robot
+   * @param twists          also eliminate link twists, with joint velocities
+   * @param prior_link_name name of the root link, by default the fixed link
+   */
+  explicit KinematicManifold(
+      const Robot &robot, bool twists = true,
+      const boost::optional<std::string> &prior_link_name = boost::none);
+
+  /// Whether the key is a link pose or twist recovered by forward kinematics.
+  bool isDependent(gtsam::Key key) const;
+
+  /// Whether the factor is a pose or twist constraint of a tree joint.
+  bool isKinematic(const gtsam::NonlinearFactor &factor) const;
+
+  /// Independent keys that determine the dependent variables at step t.
+  gtsam::KeyVector sliceKeys(size_t t) const;
+
+  /// Dependent variables at step t, by forward kinematics from values.
+  gtsam::Values slice(const gtsam::Values &values, size_t t) const;
+
+  /**
+   * Values to evaluate factors on the manifold at.
+   * @param values all independent variables
+   * @param keys   independent keys to copy, including the slice keys
+   * @param times  steps whose dependent variables to add
+   */
+  gtsam::Values recover(const gtsam::Values &values,
+                        const gtsam::KeyVector &keys,
+                        const std::vector<size_t> &times) const;
+
+  /// Independent keys among keys and the slice keys of times, sorted.
+  gtsam::KeyVector independentKeys(const gtsam::KeyVector &keys,
+                                   const std::vector<size_t> &times) const;
+
+  /**
+   * Hard constraints that define the dependent variables at step t: the
+   * kinematic constraints of the tree joints, and the pose and twist of the
+   * root link when fixed.
+   */
+  gtsam::NonlinearFactorGraph sliceConstraints(size_t t) const;
+
+  /// Values without the dependent variables.
+  gtsam::Values independent(const gtsam::Values &values) const;
+
+  /// Values with the dependent variables of every step with joint angles.
+  gtsam::Values expand(const gtsam::Values &values) const;
+
+  /**
+   * Graph on the independent variables only: kinematic factors of tree joints
+   * are dropped, as are factors on the fixed root link only, and the factors
+   * on dependent variables of the same steps are combined in one
+   * KinematicManifoldFactor.
+   */
+  gtsam::NonlinearFactorGraph reduce(
+      const gtsam::NonlinearFactorGraph &graph) const;
+
+  /// Constraints on the independent variables only, as reduce(graph).
+  EqualityConstraints reduce(const EqualityConstraints &constraints) const;
+
+  /// Steps of the dependent keys among keys.
+  std::vector<size_t> dependentTimes(const gtsam::KeyVector &keys) const;
+
+ private:
+  struct Structure {
+    Robot robot;
+    BatchForwardKinematics fk;
+    bool twists;
+    uint16_t root;  // id of the root link
+    bool root_fixed;
+    std::vector<JointSharedPtr> tree_joints;
+    std::vector<uint16_t> dependent_links;  // ids, including a fixed root
+    std::vector<bool> is_dependent, is_tree_joint;  // indexed by id
+
+    Structure(const Robot &robot, bool twists,
+              const boost::optional<std::string> &prior_link_name);
+  };
+  std::shared_ptr<const Structure> structure_;
+};
+
+/**
+ * Factors on link poses and twists of some steps, as a factor on the
+ * independent variables of a KinematicManifold: its keys are the independent
+ * keys of the factors and the slice keys of the steps.
+ *
+ * The error is that of the factors at the poses and twists given by forward
+ * kinematics. Its Jacobian substitutes dd = T di for the dependent variables,
+ * where C_d dd + C_i di = 0 linearizes the hard kinematic constraints of the
+ * steps, which hold exactly on the manifold. A single factor keeps its noise
+ * model, so that constraint factors can be biased and scaled as usual;
+ * several factors are stacked whitened, with a unit noise model.
+ */
+class KinematicManifoldFactor : public gtsam::NoiseModelFactor {
+ public:
+  /**
+   * Constructor; throws if a factor is not a NoiseModelFactor, or if one of
+   * several factors has a constrained noise model.
+   * @param manifold the kinematic manifold
+   * @param factors  factors on its variables
+   * @param times    steps of the dependent variables of the factors
+   */
+  KinematicManifoldFactor(const KinematicManifold &manifold,
+                          const gtsam::NonlinearFactorGraph &factors,
+                          const std::vector<size_t> &times);
+
+  double error(const gtsam::Values &values) const override;
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override;
+
+  /// The wrapped factors.
+  const gtsam::NonlinearFactorGraph &factors() const { return factors_; }
+
+  /// Steps of the dependent variables of the factors.
+  const std::vector<size_t> &times() const { return times_; }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<KinematicManifoldFactor>(*this);
+  }
+
+ private:
+  KinematicManifold manifold_;
+  gtsam::NonlinearFactorGraph factors_, constraints_;
+  std::vector<size_t> times_;
+  bool stacked_;
+  std::vector<NoiseModelWhitener> whiteners_;  // of the factors, if stacked
+};
+
+/// An equality constraint on link poses or twists, on the independent
+/// variables of a KinematicManifold, e.g. a loop closure or a contact.
+class KinematicManifoldConstraint : public EqualityConstraint {
+ public:
+  /**
+   * Constructor.
+   * @param manifold   the kinematic manifold
+   * @param constraint constraint on its variables
+   */
+  KinematicManifoldConstraint(const KinematicManifold &manifold,
+                              const EqualityConstraint::shared_ptr &constraint);
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector &> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values &x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values &x) const override;
+
+  gtsam::Vector toleranceScaledViolation(
+      const gtsam::Values &x) const override;
+
+  void evaluate(const gtsam::Values &x, gtsam::Vector *violation,
+                gtsam::Vector *scaled_violation) const override;
+
+  size_t dim() const override { return constraint_->dim(); }
+
+  std::set<gtsam::Key> keys() const override {
+    return std::set<gtsam::Key>(keys_.begin(), keys_.end());
+  }
+
+ private:
+  KinematicManifold manifold_;
+  EqualityConstraint::shared_ptr constraint_;
+  std::vector<size_t> times_;
+  gtsam::KeyVector keys_;  // independent keys
+};
+
+/**
+ * KinematicManifoldOptimizer solves over joint coordinates only: kinematic
+ * constraints of the spanning tree are eliminated, see KinematicManifold,
+ * and the reduced problem is solved with the method of the parameters. Only
+ * loop closures, contacts and other constraints are then treated explicitly,
+ * and the problem has fewer variables and no stiff kinematic penalties.
+ */
+class KinematicManifoldOptimizer : public Optimizer {
+ protected:
+  const KinematicManifold manifold_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot           the robot
+   * @param parameters      optimizer parameters for the reduced problem
+   * @param twists          also eliminate link twists
+   * @param prior_link_name name of the root link, by default the fixed link
+   */
+  KinematicManifoldOptimizer(
+      const Robot &robot,
+      const OptimizationParameters &parameters = OptimizationParameters(),
+      bool twists = true,
+      const boost::optional<std::string> &prior_link_name = boost::none)
+      : Optimizer(parameters), manifold_(robot, twists, prior_link_name) {}
+
+  /// The manifold optimized on.
+  const KinematicManifold &manifold() const { return manifold_; }
+
+  /**
+   * Optimize over the independent variables, and recover the dependent ones.
+   * @param graph          factors on all variables
+   * @param initial_values initial values; dependent variables are ignored
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values) const;
+
+  /// Optimize with explicit constraints, e.g. loop closures and contacts.
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const EqualityConstraints &constraints,
+                         const gtsam::Values &initial_values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedOdometry.cpp
+ * @brief Fixed-lag legged odometry with IMU and contact preintegration.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/LeggedOdometry.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+namespace gtdynamics {
+
+using gtsam::imuBias::ConstantBias;
+using gtsam::NavState;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+LeggedOdometry::LeggedOdometry(const LeggedOdometryParams &params,
+                               int base_id, const NavState &state,
+                               const ConstantBias &bias,
+                               const Contacts &contacts)
+    : p_(params),
+      base_id_(base_id),
+      optimizer_(params.optimizer),
+      state_(state),
+      bias_(bias),
+      pim_(params.imu, bias) {
+  NonlinearFactorGraph graph;
+  Values values;
+  graph.addPrior<Pose3>(PoseKey(base_id_, 0), state.pose(),
+                        p_.prior_pose_model);
+  graph.addPrior<gtsam::Vector3>(BaseVelocityKey(0), state.velocity(),
+                                 p_.prior_velocity_model);
+  graph.addPrior<ConstantBias>(ImuBiasKey(0), bias, p_.prior_bias_model);
+  values.insert(PoseKey(base_id_, 0), state.pose());
+  values.insert(BaseVelocityKey(0), state.velocity());
+  values.insert(ImuBiasKey(0), bias);
+  addContacts(state.pose(), contacts, &graph, &values);
+  optimizer_.update(graph, values);
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::addContacts(const Pose3 &wTb, const Contacts &contacts,
+                                 NonlinearFactorGraph *graph,
+                                 Values *values) {
+  pcms_.clear();
+  for (auto &&kv : contacts) {
+    const Pose3 bTc(Rot3(), kv.second);
+    graph->emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(base_id_, t_), ContactPoseKey(kv.first, t_), bTc,
+        p_.kinematics_model);
+    values->insert(ContactPoseKey(kv.first, t_), wTb * bTc);
+    // Nothing is integrated yet: the first sample adds the first step.
+    PreintegratedPointContactMeasurements pcm(Pose3(), bTc, 0.0,
+                                              p_.contact_velocity_covariance);
+    pcms_.emplace(kv.first, pcm);
+  }
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::integrateMeasurement(const gtsam::Vector3 &acc,
+                                          const gtsam::Vector3 &gyro,
+                                          const Contacts &contacts,
+                                          double dt) {
+  // The contact frame has the base rotation, so the kinematics sample only
+  // enters through the IMU rotation since the last state.
+  const Rot3 deltaRik = pim_.deltaRij();
+  for (auto it = pcms_.begin(); it != pcms_.end();) {
+    if (contacts.count(it->first)) {
+      it->second.integrateMeasurement(deltaRik, Pose3(), dt);
+      ++it;
+    } else {
+      it = pcms_.erase(it);
+    }
+  }
+  pim_.integrateMeasurement(acc, gyro, dt);
+}
+
+/* ************************************************************************* */
+NavState LeggedOdometry::update(const Contacts &contacts) {
+  const int i = t_, j = t_ + 1;
+  NonlinearFactorGraph graph;
+  Values values;
+
+  // IMU factor and bias random walk, initialized with the IMU prediction.
+  graph.emplace_shared<gtsam::ImuFactor>(PoseKey(base_id_, i),
+                                         BaseVelocityKey(i),
+                                         PoseKey(base_id_, j),
+                                         BaseVelocityKey(j), ImuBiasKey(i),
+                                         pim_);
+  graph.emplace_shared<gtsam::BetweenFactor<ConstantBias>>(
+      ImuBiasKey(i), ImuBiasKey(j), ConstantBias(), p_.bias_model);
+  const NavState predicted = pim_.predict(state_, bias_);
+  values.insert(PoseKey(base_id_, j), predicted.pose());
+  values.insert(BaseVelocityKey(j), predicted.velocity());
+  values.insert(ImuBiasKey(j), bias_);
+
+  // Contact factors for feet that stayed in contact.
+  for (auto &&kv : pcms_) {
+    if (!contacts.count(kv.first) || kv.second.preintMeasCov().isZero()) {
+      continue;
+    }
+    graph.emplace_shared<PreintegratedPointContactFactor>(
+        PoseKey(base_id_, i), ContactPoseKey(kv.first, i),
+        PoseKey(base_id_, j), ContactPoseKey(kv.first, j), kv.second);
+  }
+  t_ = j;
+  addContacts(predicted.pose(), contacts, &graph, &values);
+
+  // Keep the last p_.lag states.
+  boost::optional<uint64_t> earliest_time;
+  if (static_cast<size_t>(j) >= p_.lag) earliest_time = j + 1 - p_.lag;
+  const Values estimate = optimizer_.update(graph, values, earliest_time);
+
+  state_ = NavState(estimate.at<Pose3>(PoseKey(base_id_, j)),
+                    estimate.at<gtsam::Vector3>(BaseVelocityKey(j)));
+  bias_ = estimate.at<ConstantBias>(ImuBiasKey(j));
+  pim_.resetIntegrationAndSetBias(bias_);
+  return state_;
+}
+
+}  // namespace gtdynamics
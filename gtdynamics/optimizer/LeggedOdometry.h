@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedOdometry.h
+ * @brief Fixed-lag legged odometry with IMU and contact preintegration.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/factors/PreintegratedContactFactors.h>
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/navigation/ImuBias.h>
+#include <gtsam/navigation/ImuFactor.h>
+#include <gtsam/navigation/NavState.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/shared_ptr.hpp>
+#include <map>
+
+namespace gtdynamics {
+
+/// Key of the base velocity in world frame at state t.
+inline DynamicsSymbol BaseVelocityKey(int t) {
+  return DynamicsSymbol::SimpleSymbol("bv", t);
+}
+
+/// Key of the IMU bias at state t.
+inline DynamicsSymbol ImuBiasKey(int t) {
+  return DynamicsSymbol::SimpleSymbol("bi", t);
+}
+
+/// Key of the contact frame of a foot at state t. The contact frame is at the
+/// foot contact point, with the rotation of the base.
+inline DynamicsSymbol ContactPoseKey(int foot, int t) {
+  return DynamicsSymbol::LinkSymbol("pc", foot, t);
+}
+
+/// Noise models etc specific to LeggedOdometry.
+struct LeggedOdometryParams {
+  using Isotropic = gtsam::noiseModel::Isotropic;
+
+  boost::shared_ptr<gtsam::PreintegrationParams> imu;  // IMU preintegration
+  gtsam::Matrix3 contact_velocity_covariance;  // Σvd, foot slip per step
+  gtsam::SharedNoiseModel kinematics_model,    // contact pose wrt base
+      bias_model,                              // bias change per state
+      prior_pose_model, prior_velocity_model, prior_bias_model;
+  size_t lag;  // number of states kept in the smoother
+  OptimizationParameters optimizer;
+
+  /// Constructor with default arguments
+  explicit LeggedOdometryParams(
+      const boost::shared_ptr<gtsam::PreintegrationParams> &imu,
+      size_t lag = 20)
+      : imu(imu),
+        contact_velocity_covariance(gtsam::I_3x3 * 1e-4),
+        kinematics_model(gtsam::noiseModel::Diagonal::Sigmas(
+            (gtsam::Vector(6) << 0.1, 0.1, 0.1, 1e-3, 1e-3, 1e-3).finished())),
+        bias_model(Isotropic::Sigma(6, 1e-3)),
+        prior_pose_model(Isotropic::Sigma(6, 1e-3)),
+        prior_velocity_model(Isotropic::Sigma(3, 1e-3)),
+        prior_bias_model(Isotropic::Sigma(6, 1e-2)),
+        lag(lag) {}
+};
+
+/**
+ * LeggedOdometry estimates the base state of a legged robot from IMU and leg
+ * kinematics, as in Hartley18icra. Measurements are preintegrated between
+ * states: the IMU with gtsam::PreintegratedImuMeasurements, and every foot
+ * that stays in contact with PreintegratedPointContactMeasurements. Every
+ * state adds
+ *  - the base pose, velocity and IMU bias, with an ImuFactor and a bias
+ *    random walk to the previous state,
+ *  - a contact frame for every foot in contact, tied to the base pose by the
+ *    leg forward kinematics, and
+ *  - a PreintegratedPointContactFactor for every foot that stayed in contact
+ *    since the previous state.
+ *
+ * The problem is kept in an IncrementalOptimizer, and states older than the
+ * lag are marginalized, so memory and the cost per state are bounded. Example:
+ *
+ *   LeggedOdometry odometry(params, base_id, state0, bias0, contacts0);
+ *   for (each sample) {
+ *     odometry.integrateMeasurement(acc, gyro, contacts, dt);
+ *     if (keyframe) odometry.update(contacts);
+ *   }
+ */
+class LeggedOdometry {
+ public:
+  /// Contact point of every foot in contact, in the base frame, keyed on foot
+  /// id, e.g. from forward kinematics of the joint encoders.
+  using Contacts = std::map<int, gtsam::Point3>;
+
+ private:
+  LeggedOdometryParams p_;
+  int base_id_;
+  IncrementalOptimizer optimizer_;
+
+  int t_ = 0;  // index of the last state
+  gtsam::NavState state_;
+  gtsam::imuBias::ConstantBias bias_;
+
+  gtsam::PreintegratedImuMeasurements pim_;
+  // Feet that stayed in contact since the last state, and their
+  // preintegrated contact measurements.
+  std::map<int, PreintegratedPointContactMeasurements> pcms_;
+
+  /// Add contact frames at state t, and restart the contact preintegration.
+  void addContacts(const gtsam::Pose3 &wTb, const Contacts &contacts,
+                   gtsam::NonlinearFactorGraph *graph, gtsam::Values *values);
+
+ public:
+  /**
+   * Constructor, with priors on the first state.
+   * @param params   parameters
+   * @param base_id  id of the base link, used for its pose keys
+   * @param state    initial base pose and velocity
+   * @param bias     initial IMU bias
+   * @param contacts feet in contact at the initial state
+   */
+  LeggedOdometry(const LeggedOdometryParams &params, int base_id,
+                 const gtsam::NavState &state,
+                 const gtsam::imuBias::ConstantBias &bias,
+                 const Contacts &contacts);
+
+  /**
+   * Integrate one IMU and kinematics sample since the last state. Feet that
+   * break contact are dropped until the next state; feet that make contact
+   * are added at the next state.
+   * @param acc      measured acceleration
+   * @param gyro     measured angular velocity
+   * @param contacts feet in contact during the sample
+   * @param dt       time interval of the sample
+   */
+  void integrateMeasurement(const gtsam::Vector3 &acc,
+                            const gtsam::Vector3 &gyro,
+                            const Contacts &contacts, double dt);
+
+  /**
+   * Add a new state with the measurements integrated since the last one, and
+   * update the estimate.
+   * @param contacts feet in contact at the new state
+   * @return the estimated base pose and velocity at the new state
+   */
+  gtsam::NavState update(const Contacts &contacts);
+
+  /// Index of the last state.
+  int time() const { return t_; }
+
+  /// Estimated base pose and velocity at the last state.
+  const gtsam::NavState &state() const { return state_; }
+
+  /// Estimated IMU bias at the last state.
+  const gtsam::imuBias::ConstantBias &bias() const { return bias_; }
+
+  /// Current estimate of all states in the window.
+  gtsam::Values calculateEstimate() const {
+    return optimizer_.calculateEstimate();
+  }
+};
+
+}  // namespace gtdynamics
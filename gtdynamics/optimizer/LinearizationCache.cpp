@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearizationCache.cpp
+ * @brief Partial relinearization of factor graphs in batch solves.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/LinearizationCache.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <map>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactor;
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+void LinearizationCache::clear() {
+  linearization_point_.clear();
+  factors_.clear();
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr LinearizationCache::linearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values) {
+  if (factors_.size() != graph.size()) {
+    clear();
+    factors_.resize(graph.size());
+  }
+
+  // Move the linearization point of the variables that moved beyond the
+  // threshold, and keep the offsets of the others from it.
+  gtsam::KeySet moved;
+  std::map<Key, Vector> offsets;
+  for (const auto &key_value : values) {
+    const Key key = key_value.key;
+    if (!linearization_point_.exists(key)) {
+      linearization_point_.insert(key, key_value.value);
+      moved.insert(key);
+      continue;
+    }
+    Vector dx =
+        linearization_point_.at(key).localCoordinates_(key_value.value);
+    if (dx.lpNorm<Eigen::Infinity>() > threshold_) {
+      linearization_point_.update(key, key_value.value);
+      moved.insert(key);
+    } else if (!dx.isZero(0)) {
+      offsets.emplace(key, std::move(dx));
+    }
+  }
+
+  // Relinearize the factors of moved variables, and those whose cached
+  // linearization cannot be moved, at the linearization point.
+  gtsam::NonlinearFactorGraph stale;
+  std::vector<size_t> stale_index;
+  for (size_t i = 0; i < graph.size(); i++) {
+    if (!graph[i]) continue;
+    bool relinearize =
+        !boost::dynamic_pointer_cast<JacobianFactor>(factors_[i]);
+    for (Key key : graph[i]->keys()) {
+      relinearize = relinearize || moved.count(key);
+    }
+    if (relinearize) {
+      stale.push_back(graph[i]);
+      stale_index.push_back(i);
+    }
+  }
+  const GaussianFactorGraph::shared_ptr relinearized =
+      stale.linearize(linearization_point_);
+  for (size_t k = 0; k < stale_index.size(); k++) {
+    factors_[stale_index[k]] = relinearized->at(k);
+  }
+  num_relinearized_ = stale_index.size();
+
+  // Move every factor from the linearization point to the values.
+  auto linear = boost::make_shared<GaussianFactorGraph>();
+  linear->reserve(graph.size());
+  for (const GaussianFactor::shared_ptr &factor : factors_) {
+    const auto jacobian = boost::dynamic_pointer_cast<JacobianFactor>(factor);
+    if (!jacobian || offsets.empty()) {
+      linear->push_back(factor);
+      continue;
+    }
+    Vector dx = Vector::Zero(jacobian->getA().cols());
+    bool offset = false;
+    size_t column = 0;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      const size_t dim = jacobian->getDim(it);
+      const auto found = offsets.find(*it);
+      if (found != offsets.end()) {
+        dx.segment(column, dim) = found->second;
+        offset = true;
+      }
+      column += dim;
+    }
+    if (!offset) {
+      linear->push_back(factor);
+      continue;
+    }
+    auto moved_factor = boost::make_shared<JacobianFactor>(*jacobian);
+    moved_factor->getb() -= jacobian->getA() * dx;
+    linear->push_back(moved_factor);
+  }
+  return linear;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearizationCache.h
+ * @brief Partial relinearization of factor graphs in batch solves.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * LinearizationCache keeps the linearization of every factor of a graph
+ * between LM iterations, and only relinearizes the factors of variables that
+ * moved beyond a threshold, as iSAM2 does with its relinearization threshold.
+ *
+ * Every variable has a linearization point, updated when the variable moves
+ * more than the threshold from it, in the infinity norm of its local
+ * coordinates, and the factors of the updated variables are relinearized
+ * there. The other factors keep their Jacobians, and their right-hand sides
+ * are moved to the current values to first order, b - A * dx. Near
+ * convergence, when most variables barely change, few factors are
+ * relinearized per iteration.
+ */
+class LinearizationCache {
+ private:
+  double threshold_;
+  gtsam::Values linearization_point_;
+  std::vector<gtsam::GaussianFactor::shared_ptr> factors_;
+  size_t num_relinearized_ = 0;
+
+ public:
+  /**
+   * Constructor.
+   * @param threshold maximum change of a variable, in its local coordinates,
+   * before its factors are relinearized; 0 relinearizes on any change
+   */
+  explicit LinearizationCache(double threshold) : threshold_(threshold) {}
+
+  /**
+   * Linearize a graph at the given values, reusing the linearizations of the
+   * previous call for factors whose variables barely moved. The graph must
+   * have the same factors in every call.
+   */
+  gtsam::GaussianFactorGraph::shared_ptr linearize(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values);
+
+  /// Number of factors relinearized in the last call.
+  size_t numRelinearized() const { return num_relinearized_; }
+
+  /// Linearization point of the cached factors.
+  const gtsam::Values &linearizationPoint() const {
+    return linearization_point_;
+  }
+
+  /// Forget all linearizations, so the next call relinearizes all factors.
+  void clear();
+};
+
+}  // namespace gtdynamics
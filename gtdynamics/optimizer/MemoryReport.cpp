@@ -0,0 +1,241 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryReport.cpp
+ * @brief Memory used by a factor graph and its values, by factor type,
+ * variable label and time step.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/core/demangle.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Value;
+namespace noiseModel = gtsam::noiseModel;
+
+namespace {
+
+// A node of the ordered map of Values: three links and a color, the key and
+// the pointer to the value.
+constexpr size_t kMapNodeBytes = 4 * sizeof(void *) + sizeof(Key) +
+                                 sizeof(void *);
+
+// Bytes of a Vector's heap storage.
+size_t VectorBytes(const gtsam::Vector &v) { return v.size() * sizeof(double); }
+
+// Sizes of the value types of the library, otherwise of an object holding
+// dim() doubles.
+size_t ValueBytes(const Value &value) {
+  if (dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+    return sizeof(gtsam::GenericValue<double>);
+  } else if (auto v = dynamic_cast<const gtsam::GenericValue<gtsam::Vector> *>(
+                 &value)) {
+    return sizeof(*v) + VectorBytes(v->value());
+  } else if (dynamic_cast<const gtsam::GenericValue<gtsam::Vector3> *>(
+                 &value)) {
+    return sizeof(gtsam::GenericValue<gtsam::Vector3>);
+  } else if (dynamic_cast<const gtsam::GenericValue<gtsam::Vector6> *>(
+                 &value)) {
+    return sizeof(gtsam::GenericValue<gtsam::Vector6>);
+  } else if (dynamic_cast<const gtsam::GenericValue<gtsam::Rot3> *>(&value)) {
+    return sizeof(gtsam::GenericValue<gtsam::Rot3>);
+  } else if (dynamic_cast<const gtsam::GenericValue<gtsam::Pose3> *>(&value)) {
+    return sizeof(gtsam::GenericValue<gtsam::Pose3>);
+  }
+  return sizeof(void *) + value.dim() * sizeof(double);
+}
+
+// Bytes of the clone of a value, from the allocations it makes.
+size_t MeasuredValueBytes(const Value &value) {
+  const size_t before = FactorProfile::NumAllocatedBytes();
+  Value *copy = value.clone_();
+  const size_t bytes = FactorProfile::NumAllocatedBytes() - before;
+  copy->deallocate_();
+  return bytes;
+}
+
+// Bytes a factor owns, from the allocations of its clone, or a lower bound
+// when clone is not implemented or allocations are not counted.
+size_t FactorBytes(const gtsam::NonlinearFactor &factor, bool measure) {
+  if (measure) {
+    try {
+      const size_t before = FactorProfile::NumAllocatedBytes();
+      const auto copy = factor.clone();
+      return FactorProfile::NumAllocatedBytes() - before;
+    } catch (const std::exception &) {
+    }
+  }
+  const size_t base = dynamic_cast<const gtsam::NoiseModelFactor *>(&factor)
+                          ? sizeof(gtsam::NoiseModelFactor)
+                          : sizeof(gtsam::NonlinearFactor);
+  return base + factor.size() * sizeof(Key);
+}
+
+// Bytes of a noise model, from its dimension and the matrices it keeps.
+size_t NoiseModelBytes(const noiseModel::Base &model) {
+  const size_t d = model.dim(), vector = d * sizeof(double);
+  if (auto robust = dynamic_cast<const noiseModel::Robust *>(&model)) {
+    return sizeof(noiseModel::Robust) + sizeof(*robust->robust()) +
+           NoiseModelBytes(*robust->noise());
+  } else if (dynamic_cast<const noiseModel::Constrained *>(&model)) {
+    return sizeof(noiseModel::Constrained) + 4 * vector;
+  } else if (dynamic_cast<const noiseModel::Isotropic *>(&model)) {
+    return sizeof(noiseModel::Isotropic) + 3 * vector;
+  } else if (dynamic_cast<const noiseModel::Diagonal *>(&model)) {
+    return sizeof(noiseModel::Diagonal) + 3 * vector;
+  } else if (dynamic_cast<const noiseModel::Gaussian *>(&model)) {
+    return sizeof(noiseModel::Gaussian) + d * vector;
+  }
+  return sizeof(noiseModel::Base);
+}
+
+// Entries of a map, largest first.
+template <class KEY>
+std::vector<std::pair<KEY, MemoryUsage>> Largest(
+    const std::map<KEY, MemoryUsage> &usage) {
+  std::vector<std::pair<KEY, MemoryUsage>> entries(usage.begin(),
+                                                   usage.end());
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const std::pair<KEY, MemoryUsage> &a,
+                      const std::pair<KEY, MemoryUsage> &b) {
+                     return a.second.bytes > b.second.bytes;
+                   });
+  return entries;
+}
+
+template <class KEY>
+void PrintTable(const char *title,
+                const std::vector<std::pair<KEY, MemoryUsage>> &entries) {
+  std::printf("%12s %10s  %s\n", "bytes", "count", title);
+  for (auto &&entry : entries) {
+    std::ostringstream name;
+    name << entry.first;
+    std::printf("%12zu %10zu  %s\n", entry.second.bytes, entry.second.count,
+                name.str().c_str());
+  }
+}
+
+template <class KEY>
+std::string JsonTable(const std::map<KEY, MemoryUsage> &usage) {
+  using JsonSaver = gtdynamics::JsonSaver;
+  std::vector<std::string> items;
+  for (auto &&entry : usage) {
+    std::ostringstream name;
+    name << entry.first;
+    items.push_back(JsonSaver::JsonDict(
+        {{JsonSaver::Quoted("name"), JsonSaver::Quoted(name.str())},
+         {JsonSaver::Quoted("count"), std::to_string(entry.second.count)},
+         {JsonSaver::Quoted("bytes"), std::to_string(entry.second.bytes)}},
+        -1));
+  }
+  return items.empty() ? std::string("[]") : JsonSaver::JsonList(items, -1);
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+MemoryReport::MemoryReport(const gtsam::NonlinearFactorGraph &graph,
+                           const gtsam::Values &values)
+    : measured(FactorProfile::CountsAllocations()) {
+  graph_bytes = sizeof(graph) +
+                graph.size() * sizeof(gtsam::NonlinearFactor::shared_ptr);
+
+  // Split bytes over the labels and time steps of keys, with the remainder
+  // on the first key.
+  auto attribute = [this](const gtsam::KeyVector &keys, size_t bytes,
+                          size_t count) {
+    if (keys.empty()) return;
+    const size_t share = bytes / keys.size();
+    for (size_t i = 0; i < keys.size(); i++) {
+      const DynamicsSymbol symbol(keys[i]);
+      const size_t b = i == 0 ? bytes - share * (keys.size() - 1) : share;
+      labels[symbol.label()].add(count, b);
+      time_steps[symbol.time()].add(count, b);
+    }
+  };
+
+  std::set<const noiseModel::Base *> seen;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    const std::string type = FactorProfile::FactorType(*factor);
+    const size_t bytes = FactorBytes(*factor, measured);
+    factor_types[type].add(1, bytes);
+    factors.add(1, bytes);
+    attribute(factor->keys(), bytes, 0);
+
+    auto noise_factor =
+        dynamic_cast<const gtsam::NoiseModelFactor *>(factor.get());
+    if (!noise_factor || !noise_factor->noiseModel()) continue;
+    const noiseModel::Base *model = noise_factor->noiseModel().get();
+    if (!seen.insert(model).second) continue;
+    const size_t model_bytes = NoiseModelBytes(*model);
+    noise_models[boost::core::demangle(typeid(*model).name())].add(
+        1, model_bytes);
+    noise.add(1, model_bytes);
+  }
+
+  for (auto &&key_value : values) {
+    const size_t bytes =
+        kMapNodeBytes + (measured ? MeasuredValueBytes(key_value.value)
+                                  : ValueBytes(key_value.value));
+    this->values.add(1, bytes);
+    attribute({key_value.key}, bytes, 1);
+  }
+}
+
+/* ************************************************************************* */
+void MemoryReport::print(const std::string &s) const {
+  if (!s.empty()) std::cout << s << std::endl;
+  std::printf("%zu bytes (%s): factors %zu, noise models %zu, values %zu, "
+              "graph %zu\n",
+              bytes(), measured ? "measured" : "estimated", factors.bytes,
+              noise.bytes, values.bytes, graph_bytes);
+  PrintTable("factor type", Largest(factor_types));
+  PrintTable("noise model", Largest(noise_models));
+  PrintTable("label (count: variables)", Largest(labels));
+  PrintTable("time step (count: variables)",
+             std::vector<std::pair<uint64_t, MemoryUsage>>(time_steps.begin(),
+                                                           time_steps.end()));
+}
+
+/* ************************************************************************* */
+void MemoryReport::saveJson(std::ostream &os) const {
+  using JsonSaver = gtdynamics::JsonSaver;
+  os << JsonSaver::JsonDict(
+      {{JsonSaver::Quoted("measured"), measured ? "true" : "false"},
+       {JsonSaver::Quoted("bytes"), std::to_string(bytes())},
+       {JsonSaver::Quoted("factor_bytes"), std::to_string(factors.bytes)},
+       {JsonSaver::Quoted("noise_model_bytes"), std::to_string(noise.bytes)},
+       {JsonSaver::Quoted("value_bytes"), std::to_string(values.bytes)},
+       {JsonSaver::Quoted("graph_bytes"), std::to_string(graph_bytes)},
+       {JsonSaver::Quoted("factor_types"), JsonTable(factor_types)},
+       {JsonSaver::Quoted("noise_models"), JsonTable(noise_models)},
+       {JsonSaver::Quoted("labels"), JsonTable(labels)},
+       {JsonSaver::Quoted("time_steps"), JsonTable(time_steps)}});
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryReport.h
+ * @brief Memory used by a factor graph and its values, by factor type,
+ * variable label and time step.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace gtdynamics {
+
+/// Number of objects and the bytes they use.
+struct MemoryUsage {
+  size_t count = 0;
+  size_t bytes = 0;
+
+  void add(size_t n, size_t b) {
+    count += n;
+    bytes += b;
+  }
+};
+
+/**
+ * MemoryReport breaks down the memory of a factor graph and its values, to
+ * find out whether factors, noise models or values dominate, and for which
+ * factor types, variables and time steps.
+ *
+ * Factors and values are measured by cloning them and counting the bytes
+ * allocated when GTDynamics is configured with GTDYNAMICS_PROFILE_ALLOCATIONS,
+ * see FactorProfile. This covers everything a factor owns, e.g. its keys,
+ * measurements and cached Jacobians, but not what it shares with other
+ * factors: noise models are counted once per distinct model, from their
+ * dimension, and expression trees shared by expression factors are not
+ * counted. Without allocation counting, factor sizes are lower bounds from
+ * their keys, and values are sized from their types.
+ *
+ * Every variable is attributed to the label and time step of its
+ * DynamicsSymbol, and the bytes of a factor are split evenly over its keys,
+ * so the labels and the time steps both add up to the bytes of the factors
+ * and values. Example:
+ *
+ *   MemoryReport report(graph, values);
+ *   report.print();
+ */
+struct MemoryReport {
+  /// Whether factors and values were measured, rather than estimated.
+  bool measured = false;
+
+  /// Factors by demangled class name, without their noise models.
+  std::map<std::string, MemoryUsage> factor_types;
+
+  /// Distinct noise models by class name.
+  std::map<std::string, MemoryUsage> noise_models;
+
+  /// Values and factor shares by DynamicsSymbol label, e.g. "q" or "T".
+  std::map<std::string, MemoryUsage> labels;
+
+  /// Values and factor shares by time step.
+  std::map<uint64_t, MemoryUsage> time_steps;
+
+  /// Totals.
+  MemoryUsage factors, values, noise;
+
+  /// Bytes of the factor graph container itself.
+  size_t graph_bytes = 0;
+
+  /**
+   * Measure a graph and its values.
+   * @param graph  the factor graph
+   * @param values the values, e.g. the initial values of a solve
+   */
+  MemoryReport(const gtsam::NonlinearFactorGraph &graph,
+               const gtsam::Values &values);
+
+  /// Total bytes.
+  size_t bytes() const {
+    return factors.bytes + values.bytes + noise.bytes + graph_bytes;
+  }
+
+  /// Print the totals and the tables, largest entries first.
+  void print(const std::string &s = "") const;
+
+  /// Write the report as a JSON dictionary.
+  void saveJson(std::ostream &os) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeritGraph.cpp
+ * @brief Merit function graph reused across penalty-type outer iterations.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/MeritGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <cmath>
+#include <iostream>
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PenaltyFactor::PenaltyFactor(const EqualityConstraint &constraint)
+    : factor_(constraint.createFactor(1.0)),
+      whitener_(factor_->noiseModel()),
+      bias_(Vector::Zero(constraint.dim())) {
+  keys_ = factor_->keys();
+}
+
+/* ************************************************************************* */
+void PenaltyFactor::setParameters(double mu, const Vector &bias) {
+  mu_ = mu;
+  bias_ = bias;
+}
+
+/* ************************************************************************* */
+Vector PenaltyFactor::whitenedError(const Values &x,
+                                    std::vector<Matrix> *H) const {
+  // For mu = 1 and zero bias the factor has sigma tolerance and measures 0,
+  // so that its unwhitened error is g(x).
+  const double s = std::sqrt(mu_);
+  Vector e;
+  if (H) {
+    H->resize(size());
+    e = factor_->unwhitenedError(x, *H) + bias_;
+    whitener_.whitenSystem(*H, e);
+    for (Matrix &Hi : *H) Hi *= s;
+  } else {
+    e = whitener_.whiten(factor_->unwhitenedError(x) + bias_);
+  }
+  return s * e;
+}
+
+/* ************************************************************************* */
+double PenaltyFactor::error(const Values &x) const {
+  return 0.5 * whitenedError(x).squaredNorm();
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> PenaltyFactor::linearize(
+    const Values &x) const {
+  std::vector<Matrix> H;
+  const Vector b = -whitenedError(x, &H);
+  std::vector<std::pair<gtsam::Key, Matrix>> terms;
+  terms.reserve(size());
+  for (size_t i = 0; i < size(); i++) terms.emplace_back(keys_[i], H[i]);
+  return boost::make_shared<gtsam::JacobianFactor>(terms, b);
+}
+
+/* ************************************************************************* */
+void PenaltyFactor::print(const std::string &s,
+                          const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << s << "PenaltyFactor, mu = " << mu_
+            << ", bias = " << bias_.transpose() << "\n";
+  factor_->print("  constraint: ", keyFormatter);
+}
+
+/* ************************************************************************* */
+MeritGraph::MeritGraph(const gtsam::NonlinearFactorGraph &cost,
+                       const EqualityConstraints &constraints)
+    : graph_(cost) {
+  graph_.reserve(cost.size() + constraints.size());
+  penalties_.reserve(constraints.size());
+  for (const auto &constraint : constraints) {
+    penalties_.push_back(boost::make_shared<PenaltyFactor>(*constraint));
+    graph_.push_back(penalties_.back());
+  }
+  ordering_ = gtsam::Ordering::Colamd(graph_);
+}
+
+/* ************************************************************************* */
+void MeritGraph::update(double mu) {
+  for (auto &&penalty : penalties_) penalty->setMu(mu);
+}
+
+/* ************************************************************************* */
+void MeritGraph::update(double mu, const std::vector<Vector> &z) {
+  for (size_t i = 0; i < penalties_.size(); i++) {
+    penalties_[i]->setParameters(mu, z[i] / mu);
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeritGraph.h
+ * @brief Merit function graph reused across penalty-type outer iterations.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Penalty term 1/2 mu ||g(x) + bias||^2_Diag(tolerance^2) of a constraint,
+ * with penalty parameter and bias that can be changed in place. Evaluates
+ * to the same error and linearization as constraint.createFactor(mu, bias).
+ */
+class PenaltyFactor : public gtsam::NonlinearFactor {
+ private:
+  using Base = gtsam::NonlinearFactor;
+  gtsam::NoiseModelFactor::shared_ptr factor_;  // g(x) with sigma tolerance
+  NoiseModelWhitener whitener_;                 // of the factor's model
+  double mu_ = 1.0;
+  gtsam::Vector bias_;
+
+  /// Whitened and weighted error, and Jacobians if requested.
+  gtsam::Vector whitenedError(const gtsam::Values &x,
+                              std::vector<gtsam::Matrix> *H = nullptr) const;
+
+ public:
+  using shared_ptr = boost::shared_ptr<PenaltyFactor>;
+
+  /// Constructor, with mu = 1 and zero bias.
+  explicit PenaltyFactor(const EqualityConstraint &constraint);
+
+  /// Set penalty parameter and bias.
+  void setParameters(double mu, const gtsam::Vector &bias);
+
+  /// Set penalty parameter, keeping the bias.
+  void setMu(double mu) { mu_ = mu; }
+
+  double error(const gtsam::Values &x) const override;
+
+  size_t dim() const override { return factor_->dim(); }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<PenaltyFactor>(*this);
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+};
+
+/**
+ * MeritGraph holds the cost graph followed by one PenaltyFactor per
+ * constraint, so that outer iterations of the penalty and augmented
+ * Lagrangian methods only update penalty parameters and biases instead of
+ * copying the graph and creating all constraint factors again. The elimination
+ * ordering is computed once, as the graph structure never changes.
+ */
+class MeritGraph {
+ private:
+  gtsam::NonlinearFactorGraph graph_;
+  std::vector<PenaltyFactor::shared_ptr> penalties_;
+  gtsam::Ordering ordering_;
+
+ public:
+  /// Constructor, builds the graph and its COLAMD ordering.
+  MeritGraph(const gtsam::NonlinearFactorGraph &cost,
+             const EqualityConstraints &constraints);
+
+  /// Set penalty parameter for all constraints, keeping their biases.
+  void update(double mu);
+
+  /// Set penalty parameter, and biases z / mu as in the augmented Lagrangian.
+  void update(double mu, const std::vector<gtsam::Vector> &z);
+
+  /// The merit graph, with penalty factors sharing state with this object.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// Elimination ordering of the merit graph.
+  const gtsam::Ordering &ordering() const { return ordering_; }
+};
+
+}  // namespace gtdynamics
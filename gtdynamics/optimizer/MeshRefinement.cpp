@@ -0,0 +1,235 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeshRefinement.cpp
+ * @brief Trajectory optimization on a non-uniform time grid, refined where
+ * the collocation error is high.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/MeshRefinement.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+
+// Throw unless the mesh has an interval and increases strictly.
+void CheckMesh(const MeshRefinement::Mesh &mesh) {
+  if (mesh.size() < 2) {
+    throw std::invalid_argument("MeshRefinement: mesh needs two knots");
+  }
+  for (size_t k = 1; k < mesh.size(); k++) {
+    if (!(mesh[k] > mesh[k - 1])) {
+      throw std::invalid_argument("MeshRefinement: mesh must increase");
+    }
+  }
+}
+
+// Slope at knot i of the parabola through knot i and its neighbors, or
+// through the three knots at the end of the mesh.
+double Slope(const MeshRefinement::Mesh &mesh, const std::vector<double> &y,
+             size_t i) {
+  if (mesh.size() == 2) return (y[1] - y[0]) / (mesh[1] - mesh[0]);
+  const size_t c = std::min(std::max<size_t>(i, 1), mesh.size() - 2);
+  double slope = 0;
+  for (size_t l = c - 1; l <= c + 1; l++) {
+    double numerator = 0, denominator = 1;
+    for (size_t m = c - 1; m <= c + 1; m++) {
+      if (m == l) continue;
+      numerator += mesh[i] - mesh[m];
+      denominator *= mesh[l] - mesh[m];
+    }
+    slope += y[l] * numerator / denominator;
+  }
+  return slope;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+MeshRefinement::MeshRefinement(
+    const DynamicsGraph &graph_builder, const Robot &robot,
+    const MeshRefinementParameters &parameters,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu)
+    : Optimizer(parameters),
+      mr_p_(parameters),
+      graph_builder_(graph_builder),
+      robot_(robot),
+      contact_points_(contact_points),
+      mu_(mu) {
+  if (parameters.collocation != CollocationScheme::Euler &&
+      parameters.collocation != CollocationScheme::Trapezoidal) {
+    throw std::invalid_argument(
+        "MeshRefinement: error estimates need Euler or Trapezoidal "
+        "collocation");
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MeshRefinement::trajectoryGraph(const Mesh &mesh) const {
+  CheckMesh(mesh);
+  NonlinearFactorGraph graph;
+  const int num_steps = mesh.size() - 1;
+  graph.reserve(mesh.size() *
+                graph_builder_.numFactorsEstimate(robot_, contact_points_));
+  for (int k = 0; k <= num_steps; k++) {
+    graph_builder_.addDynamicsFactorGraph(&graph, robot_, k, contact_points_,
+                                          mu_);
+    if (k < num_steps) {
+      graph_builder_.addCollocationFactors(&graph, robot_, k,
+                                           mesh[k + 1] - mesh[k],
+                                           mr_p_.collocation);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Vector MeshRefinement::intervalErrors(const Mesh &mesh,
+                                      const Values &values) const {
+  CheckMesh(mesh);
+  const size_t num_knots = mesh.size();
+  Vector errors = Vector::Zero(num_knots - 1);
+  std::vector<double> v(num_knots), a(num_knots), jerk(num_knots);
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    for (size_t k = 0; k < num_knots; k++) {
+      v[k] = JointVel(values, j, k);
+      a[k] = JointAccel(values, j, k);
+    }
+    for (size_t k = 0; k < num_knots; k++) jerk[k] = Slope(mesh, a, k);
+
+    // Difference with the next higher-order scheme, for angle and velocity.
+    for (size_t k = 0; k + 1 < num_knots; k++) {
+      const double dt = mesh[k + 1] - mesh[k];
+      double error;
+      if (mr_p_.collocation == CollocationScheme::Euler) {
+        // Trapezoidal: x1 = x0 + dt/2 (x0' + x1').
+        error = 0.5 * dt * std::max(std::abs(v[k + 1] - v[k]),
+                                    std::abs(a[k + 1] - a[k]));
+      } else {
+        // Hermite-Simpson: x1 = x0 + dt/2 (x0' + x1') + dt^2/12 (x0" - x1").
+        error = dt * dt / 12 * std::max(std::abs(a[k] - a[k + 1]),
+                                        std::abs(jerk[k] - jerk[k + 1]));
+      }
+      errors(k) = std::max(errors(k), error);
+    }
+  }
+  return errors;
+}
+
+/* ************************************************************************* */
+MeshRefinement::Mesh MeshRefinement::refine(const Mesh &mesh,
+                                            const Vector &errors) const {
+  CheckMesh(mesh);
+  if (size_t(errors.size()) + 1 != mesh.size()) {
+    throw std::invalid_argument(
+        "MeshRefinement: one error per interval expected");
+  }
+  Mesh refined;
+  for (size_t k = 0; k + 1 < mesh.size(); k++) {
+    refined.push_back(mesh[k]);
+    if (errors(k) > mr_p_.tolerance) {
+      refined.push_back(0.5 * (mesh[k] + mesh[k + 1]));
+    }
+  }
+  refined.push_back(mesh.back());
+  return refined;
+}
+
+/* ************************************************************************* */
+Values MeshRefinement::Interpolate(const Mesh &mesh, const Values &values,
+                                   const Mesh &refined) {
+  CheckMesh(mesh);
+  CheckMesh(refined);
+  for (double t : mesh) {
+    if (!std::binary_search(refined.begin(), refined.end(), t)) {
+      throw std::invalid_argument(
+          "MeshRefinement: refined mesh lacks knots of the mesh");
+    }
+  }
+  if (refined.front() != mesh.front() || refined.back() != mesh.back()) {
+    throw std::invalid_argument(
+        "MeshRefinement: refined mesh must span the mesh");
+  }
+
+  // New knots from every old knot up to the next one, with their fraction
+  // of the old interval.
+  std::vector<std::vector<std::pair<size_t, double>>> new_knots(mesh.size());
+  size_t k = 0;
+  for (size_t i = 0; i < refined.size(); i++) {
+    while (k + 1 < mesh.size() && mesh[k + 1] <= refined[i]) k++;
+    const double s = refined[i] == mesh[k]
+                         ? 0.0
+                         : (refined[i] - mesh[k]) / (mesh[k + 1] - mesh[k]);
+    new_knots[k].emplace_back(i, s);
+  }
+
+  Values result;
+  for (auto &&key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    if (symbol.time() >= mesh.size()) {
+      throw std::invalid_argument(
+          "MeshRefinement: variable " + std::string(symbol) +
+          " is not at a knot of the mesh");
+    }
+    for (auto &&new_knot : new_knots[symbol.time()]) {
+      const Key key = symbol.atTime(new_knot.first);
+      if (new_knot.second == 0.0) {
+        result.insert(key, key_value.value);
+      } else {
+        InsertInterpolated(values, key_value.key,
+                           symbol.atTime(symbol.time() + 1), new_knot.second,
+                           key, &result);
+      }
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values MeshRefinement::optimize(Mesh *mesh, const Objectives &objectives,
+                                const Values &initial_values,
+                                size_t *iterations) const {
+  Values values = initial_values;
+  size_t solves = 0;
+  while (true) {
+    NonlinearFactorGraph graph = trajectoryGraph(*mesh);
+    graph.add(objectives(*mesh));
+    values = Optimizer::optimize(graph, values);
+    solves++;
+
+    const Vector errors = intervalErrors(*mesh, values);
+    if (errors.maxCoeff() <= mr_p_.tolerance ||
+        solves >= mr_p_.max_iterations) {
+      break;
+    }
+    const Mesh refined = refine(*mesh, errors);
+    values = Interpolate(*mesh, values, refined);
+    *mesh = refined;
+  }
+  if (iterations) *iterations = solves;
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeshRefinement.h
+ * @brief Trajectory optimization on a non-uniform time grid, refined where
+ * the collocation error is high.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters for mesh refinement.
+struct MeshRefinementParameters : public OptimizationParameters {
+  double tolerance = 1e-3;     // largest local collocation error accepted
+  size_t max_iterations = 5;   // maximum number of solves
+  CollocationScheme collocation = CollocationScheme::Trapezoidal;
+};
+
+/**
+ * MeshRefinement optimizes a trajectory on a mesh, the times of its knots,
+ * with dynamics at every knot and collocation over every interval. It solves
+ * on a coarse mesh, estimates the collocation error of every interval, and
+ * splits only the intervals whose error is above the tolerance, warm-starting
+ * the next solve from the interpolated solution. Smooth segments keep long
+ * intervals while fast ones, e.g. touchdowns, get short ones.
+ *
+ * The local error of an interval is estimated as the largest difference, over
+ * the joint angle and velocity collocation factors, between the residuals of
+ * the scheme and of the next higher-order one at the solution: Trapezoidal
+ * for Euler, and Hermite-Simpson for Trapezoidal. Jerks, which the
+ * Hermite-Simpson velocity rule needs, are estimated from the accelerations
+ * at neighboring knots.
+ *
+ * All variables must be indexed by knot through the time of their
+ * DynamicsSymbol, as in DynamicsGraph::trajectoryFG.
+ */
+class MeshRefinement : public Optimizer {
+ public:
+  /// Times of the knots of a trajectory, strictly increasing.
+  typedef std::vector<double> Mesh;
+
+  /// Creates the problem-specific factors, e.g. priors and objectives, on a
+  /// mesh; knot k is at time mesh[k].
+  typedef std::function<gtsam::NonlinearFactorGraph(const Mesh &)> Objectives;
+
+ protected:
+  const MeshRefinementParameters mr_p_;
+  const DynamicsGraph &graph_builder_;
+  Robot robot_;
+  boost::optional<PointOnLinks> contact_points_;
+  boost::optional<double> mu_;
+
+ public:
+  /**
+   * Constructor.
+   * @param graph_builder  builds dynamics and collocation factors; must
+   * outlive this object
+   * @param robot          the robot
+   * @param parameters     optimizer and refinement parameters
+   * @param contact_points contact points at every knot
+   * @param mu             coefficient of static friction
+   */
+  MeshRefinement(const DynamicsGraph &graph_builder, const Robot &robot,
+                 const MeshRefinementParameters &parameters =
+                     MeshRefinementParameters(),
+                 const boost::optional<PointOnLinks> &contact_points =
+                     boost::none,
+                 const boost::optional<double> &mu = boost::none);
+
+  using Optimizer::optimize;
+
+  /// Dynamics factors at every knot and collocation factors over every
+  /// interval of the mesh.
+  gtsam::NonlinearFactorGraph trajectoryGraph(const Mesh &mesh) const;
+
+  /// Estimated local collocation error of every interval of the mesh.
+  gtsam::Vector intervalErrors(const Mesh &mesh,
+                               const gtsam::Values &values) const;
+
+  /// The mesh with every interval whose error is above the tolerance split
+  /// in two at its midpoint.
+  Mesh refine(const Mesh &mesh, const gtsam::Vector &errors) const;
+
+  /**
+   * Values on a refined mesh. Variables at knots of the mesh are copied; at
+   * new knots, doubles, vectors and poses are interpolated between the
+   * enclosing knots, and other types copied from the earlier one.
+   * @param mesh    the mesh of the values
+   * @param values  variables at the knots of the mesh
+   * @param refined a mesh with all knots of the mesh
+   */
+  static gtsam::Values Interpolate(const Mesh &mesh,
+                                   const gtsam::Values &values,
+                                   const Mesh &refined);
+
+  /**
+   * Solve and refine until the errors of all intervals are below tolerance,
+   * or max_iterations solves were done.
+   * @param mesh           the initial mesh, replaced by the final one
+   * @param objectives     creates the problem-specific factors on a mesh
+   * @param initial_values initial values on the initial mesh
+   * @param iterations     (optional) number of solves performed
+   * @return the solution on the final mesh
+   */
+  gtsam::Values optimize(Mesh *mesh, const Objectives &objectives,
+                         const gtsam::Values &initial_values,
+                         size_t *iterations = nullptr) const;
+};
+
+}  // namespace gtdynamics
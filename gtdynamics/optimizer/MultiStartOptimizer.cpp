@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimizer.cpp
+ * @brief Concurrent solves from several initial values, pruning the runs
+ * that fall behind.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/MultiStartOptimizer.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/ThreadPool.h>
+
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+// Lowest error of any run after each number of iterations, shared by the
+// runs of one solve.
+class Leaderboard {
+  std::mutex mutex_;
+  std::vector<double> best_;  // by iteration, from 1
+  double best_final_ = std::numeric_limits<double>::infinity();
+
+ public:
+  // Record the error of a run after an iteration; returns the lowest error
+  // of any run after that many iterations, or at the end.
+  double update(size_t iteration, double error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (best_.size() < iteration) {
+      best_.resize(iteration, std::numeric_limits<double>::infinity());
+    }
+    double &best = best_[iteration - 1];
+    best = std::min(best, error);
+    return std::min(best, best_final_);
+  }
+
+  // Record the final error of a run, which stays its error at later
+  // iterations.
+  void finish(double error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    best_final_ = std::min(best_final_, error);
+  }
+};
+}  // namespace
+
+/* ************************************************************************* */
+MultiStartResult MultiStartOptimizer::run(
+    const NonlinearFactorGraph &graph, size_t num_starts,
+    const InitialValuesFunction &initial_values) const {
+  if (num_starts == 0) {
+    throw std::invalid_argument("MultiStartOptimizer: no initial values");
+  }
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  Leaderboard leaderboard;
+  std::vector<std::shared_ptr<CancellationToken>> tokens;
+  std::unique_ptr<std::atomic<bool>[]> pruned(
+      new std::atomic<bool>[num_starts]);
+  for (size_t k = 0; k < num_starts; k++) {
+    tokens.push_back(std::make_shared<CancellationToken>());
+    pruned[k] = false;
+  }
+
+  std::vector<std::future<std::pair<Values, double>>> futures;
+  {
+    ThreadPool pool(multi_start_.num_threads);
+    for (size_t k = 0; k < num_starts; k++) {
+      futures.push_back(pool.submit([&, k]() {
+        OptimizationParameters parameters = parameters_;
+        parameters.cancellation = tokens[k];
+        parameters.checkpoint = nullptr;
+        parameters.telemetry = std::make_shared<OptimizerTelemetry>(false);
+        const auto user_token = parameters_.cancellation;
+        parameters.telemetry->onIteration([&, k, user_token](
+                                              const IterationRecord &record) {
+          if (user_token && user_token->cancelled()) tokens[k]->cancel();
+          const double best =
+              leaderboard.update(record.iteration, record.error);
+          if (multi_start_.prune_ratio > 0 &&
+              record.iteration >= multi_start_.min_iterations &&
+              record.error > multi_start_.prune_ratio * best) {
+            pruned[k] = true;
+            tokens[k]->cancel();
+          }
+        });
+
+        // A run cancelled before it starts, e.g. by the user, is skipped.
+        if (user_token && user_token->cancelled()) {
+          return std::make_pair(Values(), nan);
+        }
+        Values values =
+            Optimizer(parameters).optimize(graph, initial_values(k));
+        const double error = graph.error(values);
+        if (!pruned[k]) leaderboard.finish(error);
+        return std::make_pair(std::move(values), error);
+      }));
+    }
+  }
+
+  MultiStartResult result;
+  result.errors.assign(num_starts, nan);
+  result.pruned.assign(num_starts, false);
+  bool found = false;
+  for (size_t k = 0; k < num_starts; k++) {
+    try {
+      auto run = futures[k].get();
+      result.errors[k] = run.second;
+      result.pruned[k] = pruned[k];
+      if (!std::isnan(run.second) &&
+          (!found || run.second < result.errors[result.best])) {
+        found = true;
+        result.best = k;
+        result.values = std::move(run.first);
+      }
+    } catch (const std::exception &) {
+      // A failed run, e.g. with an indeterminate system, is left out.
+    }
+  }
+  if (!found) {
+    throw std::runtime_error("MultiStartOptimizer: all runs failed");
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+MultiStartResult MultiStartOptimizer::optimize(
+    const NonlinearFactorGraph &graph,
+    const InitialValuesFunction &initial_values) const {
+  return run(graph, multi_start_.num_starts, initial_values);
+}
+
+/* ************************************************************************* */
+MultiStartResult MultiStartOptimizer::optimize(
+    const NonlinearFactorGraph &graph,
+    const std::vector<Values> &initial_values) const {
+  return run(graph, initial_values.size(),
+             [&initial_values](size_t k) { return initial_values[k]; });
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimizer.h
+ * @brief Concurrent solves from several initial values, pruning the runs
+ * that fall behind.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of MultiStartOptimizer.
+struct MultiStartParameters {
+  size_t num_starts = 8;   // number of initial values
+  size_t num_threads = 0;  // concurrent runs, 0 for hardware concurrency
+  // A run is cancelled when, after at least min_iterations iterations, its
+  // error exceeds prune_ratio times the lowest error any run had after the
+  // same number of iterations, or at the end; 0 to never prune.
+  double prune_ratio = 2.0;
+  size_t min_iterations = 3;
+};
+
+/// Outcome of a multi-start solve.
+struct MultiStartResult {
+  gtsam::Values values;  ///< result of the best run
+  size_t best = 0;       ///< index of the best run
+  /// Graph error of the result of every run, NaN if it threw.
+  std::vector<double> errors;
+  /// Whether every run was cancelled for falling behind.
+  std::vector<bool> pruned;
+};
+
+/**
+ * MultiStartOptimizer runs an Optimizer from several initial values at
+ * once, e.g. from Initializer trajectories with different noise seeds, and
+ * returns the run with the lowest graph error. Every run has its own
+ * OptimizerTelemetry and CancellationToken: runs report the error after
+ * each iteration, and a run whose error is far above the best error seen
+ * at the same iteration is cancelled, so the solve takes about as long as
+ * one run while the result is about as good as the best of all.
+ *
+ * Runs use the given OptimizationParameters, except that the telemetry is
+ * replaced by the one of the run and no checkpoint is kept; cancelling the
+ * token of the parameters cancels all runs. Pruning relies on the
+ * telemetry of LM iterations, so incremental solves are never pruned.
+ */
+class MultiStartOptimizer {
+ public:
+  /// Initial values of run k, called concurrently from the worker threads.
+  typedef std::function<gtsam::Values(size_t k)> InitialValuesFunction;
+
+  /**
+   * Constructor.
+   * @param parameters parameters of every run
+   * @param multi_start number of runs, threads and pruning
+   */
+  explicit MultiStartOptimizer(
+      const OptimizationParameters &parameters = OptimizationParameters(),
+      const MultiStartParameters &multi_start = MultiStartParameters())
+      : parameters_(parameters), multi_start_(multi_start) {}
+
+  /**
+   * Solve from num_starts initial values.
+   * @param graph          the graph to optimize
+   * @param initial_values creates the initial values of run k
+   */
+  MultiStartResult optimize(
+      const gtsam::NonlinearFactorGraph &graph,
+      const InitialValuesFunction &initial_values) const;
+
+  /// Solve from the given initial values, one run each.
+  MultiStartResult optimize(
+      const gtsam::NonlinearFactorGraph &graph,
+      const std::vector<gtsam::Values> &initial_values) const;
+
+ private:
+  OptimizationParameters parameters_;
+  MultiStartParameters multi_start_;
+
+  MultiStartResult run(const gtsam::NonlinearFactorGraph &graph,
+                       size_t num_starts,
+                       const InitialValuesFunction &initial_values) const;
+};
+
+}  // namespace gtdynamics
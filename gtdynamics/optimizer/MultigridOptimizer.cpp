@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultigridOptimizer.cpp
+ * @brief Coarse-to-fine trajectory optimization over time-decimated
+ * multi-phase problems.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/MultigridOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+
+// Throw unless every phase has at least one step.
+void CheckPhaseSteps(const std::vector<int> &phase_steps) {
+  if (phase_steps.empty()) {
+    throw std::invalid_argument("MultigridOptimizer: no phases");
+  }
+  for (int steps : phase_steps) {
+    if (steps < 1) {
+      throw std::invalid_argument(
+          "MultigridOptimizer: every phase needs a step");
+    }
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+MultigridOptimizer::MultigridOptimizer(const MultigridParameters &parameters)
+    : Optimizer(parameters), mg_p_(parameters) {
+  const std::vector<int> &decimations = parameters.decimations;
+  if (decimations.empty() || decimations.back() != 1) {
+    throw std::invalid_argument(
+        "MultigridOptimizer: the last decimation factor must be 1");
+  }
+  for (size_t l = 1; l < decimations.size(); l++) {
+    if (!(decimations[l] < decimations[l - 1])) {
+      throw std::invalid_argument(
+          "MultigridOptimizer: decimation factors must decrease");
+    }
+  }
+}
+
+/* ************************************************************************* */
+std::vector<int> MultigridOptimizer::Decimate(
+    const std::vector<int> &phase_steps, int decimation) {
+  CheckPhaseSteps(phase_steps);
+  if (decimation < 1) {
+    throw std::invalid_argument(
+        "MultigridOptimizer: decimation factor must be positive");
+  }
+  std::vector<int> decimated;
+  for (int steps : phase_steps) {
+    decimated.push_back(std::max(1, (steps + decimation / 2) / decimation));
+  }
+  return decimated;
+}
+
+/* ************************************************************************* */
+Values MultigridOptimizer::Resample(const Values &values,
+                                    const std::vector<int> &phase_steps,
+                                    const std::vector<int> &target_steps) {
+  CheckPhaseSteps(phase_steps);
+  CheckPhaseSteps(target_steps);
+  const size_t num_phases = phase_steps.size();
+  if (target_steps.size() != num_phases) {
+    throw std::invalid_argument(
+        "MultigridOptimizer: resampling needs the same number of phases");
+  }
+
+  // Target steps from every step up to the next one, with their fraction of
+  // the interval. Step k of phase p, with k0 the first step of the phase in
+  // the target and t0 in the values, is at step t0 + (k - k0) * steps /
+  // target_steps, computed exactly in integers.
+  int num_steps = 0;
+  for (int steps : phase_steps) num_steps += steps;
+  std::vector<std::vector<std::pair<int, double>>> new_steps(num_steps + 1);
+  int k0 = 0, t0 = 0;
+  for (size_t p = 0; p < num_phases; p++) {
+    const int steps = phase_steps[p], target = target_steps[p];
+    // The first step of every phase but the first is the last of the
+    // previous one.
+    for (int k = (p == 0 ? 0 : 1); k <= target; k++) {
+      const int numerator = k * steps;
+      new_steps[t0 + numerator / target].emplace_back(
+          k0 + k, double(numerator % target) / target);
+    }
+    k0 += target;
+    t0 += steps;
+  }
+
+  const uint16_t phase_code = PhaseKey(0).labelCode();
+  Values result;
+  for (auto &&key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const size_t t = symbol.time();
+    if (symbol.labelCode() == phase_code) {
+      // Keep the total duration of the phase.
+      if (t < num_phases && values.exists<double>(key_value.key)) {
+        result.insert(key_value.key, values.at<double>(key_value.key) *
+                                         phase_steps[t] / target_steps[t]);
+      } else {
+        result.insert(key_value.key, key_value.value);
+      }
+      continue;
+    }
+    if (t >= new_steps.size()) {
+      throw std::invalid_argument("MultigridOptimizer: variable " +
+                                  std::string(symbol) +
+                                  " is not at a step of the trajectory");
+    }
+    for (auto &&new_step : new_steps[t]) {
+      const Key key = symbol.atTime(new_step.first);
+      if (new_step.second == 0.0) {
+        result.insert(key, key_value.value);
+      } else {
+        InsertInterpolated(values, key_value.key, symbol.atTime(t + 1),
+                           new_step.second, key, &result);
+      }
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values MultigridOptimizer::optimize(const std::vector<int> &phase_steps,
+                                    const Builder &builder,
+                                    const Values &initial_values,
+                                    std::vector<MultigridLevel> *levels) const {
+  CheckPhaseSteps(phase_steps);
+  if (levels) levels->clear();
+
+  Values values = initial_values;
+  std::vector<int> steps = phase_steps;
+  for (int decimation : mg_p_.decimations) {
+    const auto start = std::chrono::steady_clock::now();
+    MultigridLevel level;
+    level.decimation = decimation;
+    level.phase_steps = Decimate(phase_steps, decimation);
+
+    const NonlinearFactorGraph graph = builder(level.phase_steps);
+    const Values resampled = Resample(values, steps, level.phase_steps);
+
+    // Keep only the variables of the level, e.g. without the contact
+    // wrenches a transition step lends to its neighbors.
+    const gtsam::KeySet keys = graph.keys();
+    Values level_values;
+    for (auto &&key_value : resampled) {
+      if (keys.count(key_value.key)) {
+        level_values.insert(key_value.key, key_value.value);
+      }
+    }
+
+    level.initial_error = graph.error(level_values);
+    values = Optimizer::optimize(graph, level_values);
+    level.error = graph.error(values);
+    level.seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    steps = level.phase_steps;
+    if (levels) levels->push_back(std::move(level));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultigridOptimizer.h
+ * @brief Coarse-to-fine trajectory optimization over time-decimated
+ * multi-phase problems.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters for coarse-to-fine optimization.
+struct MultigridParameters : public OptimizationParameters {
+  // Decimation factor of every level, from coarsest to finest. Factors must
+  // decrease, and the last one, 1, solves the full problem.
+  std::vector<int> decimations{4, 1};
+};
+
+/// Outcome of the solve on one level.
+struct MultigridLevel {
+  int decimation = 1;            ///< decimation factor of the level
+  std::vector<int> phase_steps;  ///< number of steps of every phase
+  double initial_error = 0, error = 0;  ///< graph error before and after
+  double seconds = 0;  ///< wall-clock time to build, resample and solve
+};
+
+/**
+ * MultigridOptimizer solves a multi-phase trajectory optimization, as built by
+ * DynamicsGraph::multiPhaseTrajectoryFG, first with every phase decimated to
+ * a fraction of its steps. The solution of each level is resampled onto the
+ * steps of the next, finer one and warm-starts its solve, so that the full
+ * problem only polishes a solution that is already close. LM on a long
+ * horizon from a poor initial guess otherwise takes many iterations on the
+ * full graph.
+ *
+ * Variables are resampled per phase: a step at a fraction of a phase gets the
+ * values interpolated at the same fraction of the phase on the other level,
+ * linearly for doubles and vectors and on SE(3) for poses, so phase
+ * boundaries map onto each other. Phase durations, PhaseKey(p), are scaled
+ * so that every phase keeps its total duration.
+ *
+ * All variables other than the phase durations must be indexed by step
+ * through the time of their DynamicsSymbol.
+ */
+class MultigridOptimizer : public Optimizer {
+ public:
+  /// Creates the full problem, dynamics, transitions, priors and
+  /// objectives, for the given number of steps of every phase.
+  typedef std::function<gtsam::NonlinearFactorGraph(const std::vector<int> &)>
+      Builder;
+
+ protected:
+  const MultigridParameters mg_p_;
+
+ public:
+  /**
+   * Constructor; throws if the decimation factors are not positive and
+   * decreasing to 1.
+   * @param parameters optimizer parameters and decimation factors
+   */
+  MultigridOptimizer(
+      const MultigridParameters &parameters = MultigridParameters());
+
+  using Optimizer::optimize;
+
+  /// Steps of every phase decimated by the given factor, at least one each.
+  static std::vector<int> Decimate(const std::vector<int> &phase_steps,
+                                   int decimation);
+
+  /**
+   * Values of a multi-phase trajectory on another number of steps per phase.
+   * Works both for upsampling and downsampling.
+   * @param values       variables at the steps of the trajectory
+   * @param phase_steps  number of steps of every phase of the values
+   * @param target_steps number of steps of every phase to resample onto
+   */
+  static gtsam::Values Resample(const gtsam::Values &values,
+                                const std::vector<int> &phase_steps,
+                                const std::vector<int> &target_steps);
+
+  /**
+   * Solve all levels, from coarsest to finest.
+   * @param phase_steps    number of steps of every phase of the full problem
+   * @param builder        creates the problem on a number of steps per phase
+   * @param initial_values initial values of the full problem
+   * @param levels         (optional) outcome of every level
+   * @return the solution of the full problem
+   */
+  gtsam::Values optimize(const std::vector<int> &phase_steps,
+                         const Builder &builder,
+                         const gtsam::Values &initial_values,
+                         std::vector<MultigridLevel> *levels = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShootingOptimizer.cpp
+ * @brief Solve trajectory segments in parallel, with consensus at boundaries.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/MultipleShootingOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeySet;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+/* ************************************************************************* */
+Vector ConsensusFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<gtsam::Matrix> &> H) const {
+  const gtsam::Value &value = x.at(keys_[0]);
+  if (H) H->front() = gtsam::Matrix::Identity(value.dim(), value.dim());
+  return target_->localCoordinates_(value);
+}
+
+/* ************************************************************************* */
+Values MultipleShootingOptimizer::optimize(const NonlinearFactorGraph &graph,
+                                           const Values &initial_values,
+                                           size_t num_blocks,
+                                           const BlockOfKey &block_of_key,
+                                           size_t *iterations) const {
+  // Assign factors to blocks, by their highest block.
+  std::vector<NonlinearFactorGraph> graphs(num_blocks);
+  std::vector<KeySet> block_keys(num_blocks);
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    size_t b = 0;
+    for (Key key : factor->keys()) b = std::max(b, block_of_key(key));
+    if (b >= num_blocks) {
+      throw std::invalid_argument(
+          "MultipleShootingOptimizer: block index out of range");
+    }
+    graphs[b].push_back(factor);
+    for (Key key : factor->keys()) block_keys[b].insert(key);
+  }
+
+  // Variables in more than one block are shared, the consensus z is kept for
+  // them, with one scaled dual variable u per copy.
+  std::map<Key, size_t> copies;
+  for (auto &&keys : block_keys)
+    for (Key key : keys) copies[key]++;
+  Values z;
+  std::vector<Values> local(num_blocks);
+  std::vector<VectorValues> u(num_blocks);
+  for (size_t b = 0; b < num_blocks; b++) {
+    for (Key key : block_keys[b]) {
+      local[b].insert(key, initial_values.at(key));
+      if (copies[key] < 2) continue;
+      if (!z.exists(key)) z.insert(key, initial_values.at(key));
+      u[b].insert(key, Vector::Zero(initial_values.at(key).dim()));
+    }
+  }
+
+  auto model = [this](size_t dim) {
+    return gtsam::noiseModel::Isotropic::Sigma(dim, 1.0 / sqrt(ms_p_.rho));
+  };
+
+  size_t k = 0;
+  while (k < ms_p_.max_iterations) {
+    k++;
+
+    // Solve all blocks, pulling copies towards z - u.
+    ParallelFor(num_blocks, ms_p_.num_threads, [&](size_t b) {
+      if (graphs[b].empty()) return;
+      NonlinearFactorGraph block_graph = graphs[b];
+      const Values target = z.retract(-1.0 * u[b]);
+      for (const auto &key_value : u[b]) {
+        const Key key = key_value.first;
+        block_graph.emplace_shared<ConsensusFactor>(
+            key, target.at(key), model(key_value.second.size()));
+      }
+      gtsam::LevenbergMarquardtOptimizer optimizer(block_graph, local[b],
+                                                   p_.lm_parameters);
+      local[b] = optimizer.optimize();
+    });
+
+    // Average the copies: z = mean(x_b + u_b), in the tangent space at z.
+    VectorValues sum;
+    for (size_t b = 0; b < num_blocks; b++) {
+      for (const auto &key_value : u[b]) {
+        const Key key = key_value.first;
+        const Vector d = z.at(key).localCoordinates_(local[b].at(key)) +
+                         key_value.second;
+        if (sum.exists(key))
+          sum.at(key) += d;
+        else
+          sum.insert(key, d);
+      }
+    }
+    for (auto &&key_value : sum)
+      key_value.second /= double(copies[key_value.first]);
+    z = z.retract(sum);
+
+    // Dual update u_b += x_b - z, and the largest disagreement.
+    double residual = 0.0;
+    for (size_t b = 0; b < num_blocks; b++) {
+      for (auto &&key_value : u[b]) {
+        const Key key = key_value.first;
+        const Vector r = z.at(key).localCoordinates_(local[b].at(key));
+        key_value.second += r;
+        residual = std::max(residual, r.lpNorm<Eigen::Infinity>());
+      }
+    }
+    if (residual < ms_p_.tolerance) break;
+  }
+  if (iterations) *iterations = k;
+
+  // Assemble the result, taking shared variables from the consensus.
+  Values result = z;
+  for (size_t b = 0; b < num_blocks; b++) {
+    for (const auto &key_value : local[b]) {
+      if (!result.exists(key_value.key))
+        result.insert(key_value.key, key_value.value);
+    }
+  }
+  for (const auto &key_value : initial_values) {
+    if (!result.exists(key_value.key))
+      result.insert(key_value.key, key_value.value);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values MultipleShootingOptimizer::optimize(const NonlinearFactorGraph &graph,
+                                           const Values &initial_values,
+                                           const Trajectory &trajectory,
+                                           size_t *iterations) const {
+  constexpr uint16_t kNone = DynamicsSymbol::kNoIndex;
+  const size_t num_phases = trajectory.numPhases();
+  const std::vector<int> &end_steps = trajectory.finalTimeSteps();
+  const std::string phase_label = PhaseKey(0).label();
+  auto block_of_key = [&](Key key) -> size_t {
+    const DynamicsSymbol symbol(key);
+    const uint64_t t = symbol.time();
+    if (symbol.linkIdx() == kNone && symbol.jointIdx() == kNone &&
+        symbol.label() == phase_label) {
+      return std::min<size_t>(t, num_phases - 1);
+    }
+    const auto it =
+        std::lower_bound(end_steps.begin(), end_steps.end(), int(t));
+    return std::min<size_t>(it - end_steps.begin(), num_phases - 1);
+  };
+  return optimize(graph, initial_values, num_phases, block_of_key,
+                  iterations);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShootingOptimizer.h
+ * @brief Solve trajectory segments in parallel, with consensus at boundaries.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <string>
+
+namespace gtdynamics {
+
+/// Parameters for the multiple shooting optimizer.
+struct MultipleShootingParameters : public OptimizationParameters {
+  double rho = 100.0;           // ADMM penalty on boundary disagreement
+  size_t max_iterations = 50;   // maximum number of ADMM iterations
+  double tolerance = 1e-5;      // stop when boundary copies agree this well
+  size_t num_threads = 0;       // 0 for hardware concurrency
+};
+
+/**
+ * Prior pulling one variable towards a target of any type, with error
+ * target.localCoordinates(x) and an identity Jacobian, which is exact for
+ * vector spaces and a first-order approximation on manifolds.
+ */
+class ConsensusFactor : public gtsam::NoiseModelFactor {
+ private:
+  boost::shared_ptr<gtsam::Value> target_;
+
+ public:
+  ConsensusFactor(gtsam::Key key, const gtsam::Value &target,
+                  const gtsam::SharedNoiseModel &model)
+      : gtsam::NoiseModelFactor(model, gtsam::KeyVector{key}),
+        target_(target.clone()) {}
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<ConsensusFactor>(*this);
+  }
+};
+
+/**
+ * MultipleShootingOptimizer splits a trajectory problem into blocks of
+ * consecutive time steps (e.g. the phases of a Trajectory), and solves it by
+ * consensus ADMM: each iteration optimizes all blocks concurrently, each
+ * with a local copy of the variables it shares with other blocks, then
+ * averages the copies and updates the scaled dual variables.
+ *
+ * Every factor is assigned to the highest block among its keys, so
+ * collocation and transition factors at a boundary make the last states of
+ * the previous block shared variables.
+ */
+class MultipleShootingOptimizer : public Optimizer {
+ public:
+  using BlockOfKey = std::function<size_t(gtsam::Key)>;
+
+ protected:
+  const MultipleShootingParameters ms_p_;
+
+ public:
+  /// Constructor.
+  explicit MultipleShootingOptimizer(
+      const MultipleShootingParameters &parameters =
+          MultipleShootingParameters())
+      : Optimizer(parameters), ms_p_(parameters) {}
+
+  using Optimizer::optimize;
+
+  /**
+   * Optimize with the given assignment of variables to blocks.
+   * @param graph          the full problem
+   * @param initial_values initial values for all variables
+   * @param num_blocks     number of blocks
+   * @param block_of_key   block index in [0, num_blocks) of each variable
+   * @param iterations     (optional) number of ADMM iterations performed
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         size_t num_blocks, const BlockOfKey &block_of_key,
+                         size_t *iterations = nullptr) const;
+
+  /**
+   * Optimize a multi-phase problem with one block per phase, using
+   * Trajectory::getEndTimeStep. Phase duration keys PhaseKey(p) belong to
+   * phase p.
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         const Trajectory &trajectory,
+                         size_t *iterations = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -12,27 +12,107 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
 #include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
-#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtdynamics/optimizer/SolvePlan.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtdynamics/utils/ShardedValues.h>
+
+#include <algorithm>
 
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
 using gtsam::Values;
 
+gtsam::LevenbergMarquardtParams Optimizer::lmParameters(
+    const NonlinearFactorGraph& graph, const Values& initial_values) const {
+  gtsam::LevenbergMarquardtParams lm_parameters = p_.lm_parameters;
+  if (p_.time_ordering) {
+    lm_parameters.setOrdering(
+        TimeOrdering(initial_values.keys(), *p_.time_ordering));
+  } else if (p_.solve_plans && !lm_parameters.ordering) {
+    lm_parameters.setOrdering(p_.solve_plans->plan(graph)->ordering());
+  }
+  return lm_parameters;
+}
+
+// Graph with the structure of the merit graphs of constrained solves.
+static NonlinearFactorGraph MeritStructure(
+    const NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints) {
+  NonlinearFactorGraph structure = graph;
+  for (const auto& constraint : constraints) {
+    structure.add(constraint->createFactor(1.0));
+  }
+  return structure;
+}
+
+NonlinearFactorGraph Optimizer::profiled(
+    const NonlinearFactorGraph& graph) const {
+  return p_.profile_factors ? ProfileFactors(graph, profile_) : graph;
+}
+
 Values Optimizer::optimize(const NonlinearFactorGraph& graph,
                            const Values& initial_values) const {
-  gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
-                                               p_.lm_parameters);
+  if (p_.method == OptimizationParameters::Method::INCREMENTAL) {
+    IncrementalOptimizer optimizer(p_);
+    return optimizer.update(profiled(graph), initial_values);
+  }
+  InstrumentedLevenbergMarquardtOptimizer::Options options;
+  options.telemetry = p_.telemetry;
+  options.linearization_threads = p_.linearization_threads;
+  const size_t num_threads =
+      p_.num_threads ? p_.num_threads : ExecutorThreads();
+  if (!options.linearization_threads && num_threads > 1) {
+    options.linearization_threads = num_threads;
+  }
+  options.riccati_solver = p_.riccati_solver;
+  options.relinearize_threshold = p_.relinearize_threshold;
+  options.hessian_linearization =
+      p_.hessian_linearization && (p_.riccati_solver || !p_.pcg_solver);
+  if (p_.pcg_solver) {
+    options.pcg_solver = *p_.pcg_solver;
+    options.pcg_solver->num_threads = p_.num_threads;
+  }
+  options.deadline = Deadline(p_.time_budget, p_.cancellation);
+  options.checkpoint = p_.checkpoint;
+
+  // Resume from the iterate, damping and iteration count of a checkpoint.
+  Values values = initial_values;
+  gtsam::LevenbergMarquardtParams lm_parameters =
+      lmParameters(graph, initial_values);
+  if (p_.checkpoint) {
+    if (auto checkpoint = p_.checkpoint->resume(
+            CheckpointSolver::LevenbergMarquardt)) {
+      values = checkpoint->values;
+      lm_parameters.lambdaInitial = checkpoint->lambda;
+      options.previous_iterations = checkpoint->iterations;
+      lm_parameters.maxIterations -=
+          std::min<size_t>(lm_parameters.maxIterations, checkpoint->iterations);
+    }
+  }
+  InstrumentedLevenbergMarquardtOptimizer optimizer(profiled(graph), values,
+                                                    lm_parameters, options);
   const Values result = optimizer.optimize();
+  optimizer.recordSolve(optimizer.solveRecord());
   return result;
 }
 
+ShardedValues Optimizer::optimize(const NonlinearFactorGraph& graph,
+                                  const ShardedValues& initial_values) const {
+  return ShardedValues(optimize(graph, initial_values.values()));
+}
+
 Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
                            const EqualityConstraints& constraints,
                            const gtsam::Values& initial_values) const {
-  if (p_.method == OptimizationParameters::Method::SOFT_CONSTRAINTS) {
+  if (p_.method == OptimizationParameters::Method::SOFT_CONSTRAINTS ||
+      p_.method == OptimizationParameters::Method::INCREMENTAL) {
     auto merit_graph = graph;
     for (const auto& constraint : constraints) {
       merit_graph.add(constraint->createFactor(1.0));
@@ -40,15 +120,42 @@ Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
     return optimize(merit_graph, initial_values);
 
   } else if (p_.method == OptimizationParameters::Method::PENALTY) {
-    PenaltyMethodParameters params = p_.lm_parameters;
+    PenaltyMethodParameters params = lmParameters(
+        p_.solve_plans ? MeritStructure(graph, constraints) : graph,
+        initial_values);
+    params.telemetry = p_.telemetry;
+    params.time_budget = p_.time_budget;
+    params.cancellation = p_.cancellation;
+    params.checkpoint = p_.checkpoint;
+    params.num_threads = p_.num_threads;
+    params.deterministic = p_.deterministic;
     PenaltyMethodOptimizer optimizer(params);
-    return optimizer.optimize(graph, constraints, initial_values);
+    return optimizer.optimize(profiled(graph), constraints, initial_values);
 
   } else if (p_.method ==
              OptimizationParameters::Method::AUGMENTED_LAGRANGIAN) {
-    AugmentedLagrangianParameters params = p_.lm_parameters;
+    AugmentedLagrangianParameters params = lmParameters(
+        p_.solve_plans ? MeritStructure(graph, constraints) : graph,
+        initial_values);
+    params.telemetry = p_.telemetry;
+    params.time_budget = p_.time_budget;
+    params.cancellation = p_.cancellation;
+    params.checkpoint = p_.checkpoint;
+    params.num_threads = p_.num_threads;
+    params.deterministic = p_.deterministic;
     AugmentedLagrangianOptimizer optimizer(params);
-    return optimizer.optimize(graph, constraints, initial_values);
+    return optimizer.optimize(profiled(graph), constraints, initial_values);
+
+  } else if (p_.method == OptimizationParameters::Method::SQP) {
+    SQPParameters params = p_.lm_parameters;
+    params.telemetry = p_.telemetry;
+    params.time_budget = p_.time_budget;
+    params.cancellation = p_.cancellation;
+    params.checkpoint = p_.checkpoint;
+    params.num_threads = p_.num_threads;
+    params.deterministic = p_.deterministic;
+    SQPOptimizer optimizer(params);
+    return optimizer.optimize(profiled(graph), constraints, initial_values);
 
   } else {
     throw std::runtime_error("optimization method not recognized.");
@@ -14,9 +14,16 @@
 #pragma once
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/optimizer/PcgSolver.h>
+#include <gtdynamics/optimizer/TimeOrdering.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/nonlinear/ISAM2Params.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <boost/optional.hpp>
+#include <memory>
+
 // Forward declarations.
 namespace gtsam {
 class NonlinearFactorGraph;
@@ -25,15 +32,76 @@ class Values;
 
 namespace gtdynamics {
 
+class CancellationToken;
+class Checkpointer;
+class OptimizerTelemetry;
+class ShardedValues;
+class SolvePlanCache;
+
 /// Optimization parameters shared between all solvers
 struct OptimizationParameters {
-  enum Method { SOFT_CONSTRAINTS = 0, PENALTY = 1, AUGMENTED_LAGRANGIAN = 2 };
+  enum Method {
+    SOFT_CONSTRAINTS = 0,
+    PENALTY = 1,
+    AUGMENTED_LAGRANGIAN = 2,
+    INCREMENTAL = 3,
+    SQP = 4
+  };
 
   Method method = Method::SOFT_CONSTRAINTS;       // optimization method
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  gtsam::ISAM2Params isam2_parameters;            // iSAM2 parameters
+  size_t num_isam2_updates = 5;  // iSAM2 updates per incremental step
+  // If set, order trajectory variables by time step instead of using COLAMD.
+  boost::optional<TimeOrderingType> time_ordering;
+  // If set, reuse the elimination ordering of graphs with the same structure
+  // from this cache instead of running COLAMD on every solve, see
+  // SolvePlanCache. Ignored when time_ordering is set.
+  std::shared_ptr<SolvePlanCache> solve_plans;
+  // If set, LM solves its linear systems with a Riccati recursion over time
+  // steps, see RiccatiSolve, instead of multifrontal elimination.
+  bool riccati_solver = false;
+  // If set, LM solves its linear systems with conjugate gradients and a
+  // per-time-step block-Jacobi preconditioner, see PcgSolve, which needs far
+  // less memory than elimination on long horizons. Runs on num_threads
+  // threads; ignored when riccati_solver is set.
+  boost::optional<PcgParameters> pcg_solver;
+  // If set, LM linearizes factors in batches of one type on this many
+  // threads, 0 for all cores, see FactorBatches.
+  boost::optional<size_t> linearization_threads;
+  // If set, LM keeps the linearization of every factor between iterations,
+  // and only relinearizes the factors of variables that moved more than
+  // this, in local coordinates, see LinearizationCache. Takes precedence
+  // over linearization_threads.
+  boost::optional<double> relinearize_threshold;
+  // If set, LM assembles the normal equations of every time step straight
+  // from the Jacobians of its small factors, see HessianAssembly, on
+  // linearization_threads threads. Ignored with relinearize_threshold, and
+  // with pcg_solver, which needs Jacobians.
+  bool hessian_linearization = false;
+  // Threads of the parallel loops of a solve, i.e. linearization when
+  // linearization_threads is not set, and constraint evaluation, 0 for all
+  // threads of the shared executor, see SetExecutorThreads.
+  size_t num_threads = 0;
+  // If false, parallel reductions may combine partial results in the order
+  // they complete, so results can change in the last bits between runs.
+  bool deterministic = true;
+  // If set, record the timing and convergence of every LM iteration.
+  std::shared_ptr<OptimizerTelemetry> telemetry;
+  // Wall-clock seconds an optimize call may take, 0 for no limit. LM then
+  // returns its current, lowest-error iterate after the iteration in
+  // progress, as it does when the cancellation token is set.
+  double time_budget = 0;
+  std::shared_ptr<CancellationToken> cancellation;
+  // If set, record the cost of every factor type, see Optimizer::profile.
+  bool profile_factors = false;
+  // If set, periodically save the state of LM and constrained solves, and
+  // resume from the saved state when the solve is started again.
+  std::shared_ptr<Checkpointer> checkpoint;
   OptimizationParameters() {
     lm_parameters.setlambdaInitial(1e7);
     lm_parameters.setAbsoluteErrorTol(1e-3);
+    isam2_parameters.relinearizeSkip = 1;
   }
 };
 
@@ -42,12 +110,34 @@ class Optimizer {
  protected:
   const OptimizationParameters p_;
 
+  /// Cost of the factors of the last solves, if profile_factors is set.
+  std::shared_ptr<FactorProfile> profile_;
+
+  /// The graph to optimize, wrapped for profiling if requested.
+  gtsam::NonlinearFactorGraph profiled(
+      const gtsam::NonlinearFactorGraph& graph) const;
+
+  /**
+   * LM parameters, with the time ordering of the given values, or the cached
+   * ordering of the structure of graph, if requested.
+   */
+  gtsam::LevenbergMarquardtParams lmParameters(
+      const gtsam::NonlinearFactorGraph& graph,
+      const gtsam::Values& initial_values) const;
+
  public:
   /**
    * @fn Constructor.
    */
   Optimizer(const OptimizationParameters& parameters = OptimizationParameters())
-      : p_(parameters) {}
+      : p_(parameters), profile_(std::make_shared<FactorProfile>()) {}
+
+  /**
+   * Cost of error and linearize calls per factor type, accumulated over all
+   * solves since construction when OptimizationParameters::profile_factors
+   * is set. Can be printed, or saved as JSON with FactorProfile::saveJson.
+   */
+  const FactorProfile& profile() const { return *profile_; }
 
   /**
    * @brief optimize graph using optimizer settings.
@@ -60,6 +150,14 @@ class Optimizer {
   gtsam::Values optimize(const gtsam::NonlinearFactorGraph& graph,
                          const gtsam::Values& initial_values) const;
 
+  /**
+   * @brief optimize graph using optimizer settings, with the values of a
+   * trajectory sharded by time step. The solve itself needs all variables at
+   * once; the result is sharded again.
+   */
+  ShardedValues optimize(const gtsam::NonlinearFactorGraph& graph,
+                         const ShardedValues& initial_values) const;
+
   /**
    * @brief optimize with constraints using optimizer settings.
    *
@@ -0,0 +1,212 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerTelemetry.cpp
+ * @brief Per-iteration timing and convergence records of LM solves.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/RiccatiSolver.h>
+#include <gtdynamics/utils/Trace.h>
+
+#include <cmath>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+}  // namespace
+
+/* ************************************************************************* */
+void OptimizerTelemetry::onIteration(const IterationCallback &f) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  iteration_callback_ = f;
+}
+
+void OptimizerTelemetry::onSolve(const SolveCallback &f) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  solve_callback_ = f;
+}
+
+size_t OptimizerTelemetry::beginSolve() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_solves_++;
+}
+
+void OptimizerTelemetry::record(const IterationRecord &record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (keep_trace_) iterations_.push_back(record);
+  if (iteration_callback_) iteration_callback_(record);
+}
+
+void OptimizerTelemetry::record(const SolveRecord &record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (keep_trace_) solves_.push_back(record);
+  if (solve_callback_) solve_callback_(record);
+}
+
+std::vector<IterationRecord> OptimizerTelemetry::iterations() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return iterations_;
+}
+
+std::vector<SolveRecord> OptimizerTelemetry::solves() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return solves_;
+}
+
+void OptimizerTelemetry::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_solves_ = 0;
+  iterations_.clear();
+  solves_.clear();
+}
+
+/* ************************************************************************* */
+InstrumentedLevenbergMarquardtOptimizer::
+    InstrumentedLevenbergMarquardtOptimizer(
+        const gtsam::NonlinearFactorGraph &graph,
+        const gtsam::Values &initial_values,
+        const gtsam::LevenbergMarquardtParams &params, const Options &options)
+    : gtsam::LevenbergMarquardtOptimizer(graph, initial_values, params),
+      options_(options),
+      initial_error_(error()),
+      start_(Clock::now()) {
+  if (options_.relinearize_threshold) {
+    cache_.emplace(*options_.relinearize_threshold);
+  } else if (options_.hessian_linearization) {
+    assembly_.emplace(graph);
+  } else if (options_.linearization_threads) {
+    batches_.emplace(graph);
+  }
+  if (options_.telemetry) solve_ = options_.telemetry->beginSolve();
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr
+InstrumentedLevenbergMarquardtOptimizer::iterate() {
+  GTDYNAMICS_TRACE_SCOPE_ARG("LevenbergMarquardt::iteration", iterations());
+  linearize_seconds_ = solve_seconds_ = step_norm_ = 0;
+  linear_solves_ = 0;
+  const auto start = Clock::now();
+  GaussianFactorGraph::shared_ptr linear =
+      gtsam::LevenbergMarquardtOptimizer::iterate();
+  const double seconds = SecondsSince(start);
+
+  if (options_.telemetry) {
+    IterationRecord record;
+    record.solve = solve_;
+    record.iteration = iterations();
+    record.error = error();
+    record.lambda = lambda();
+    record.step_norm = step_norm_;
+    record.linear_solves = linear_solves_;
+    record.linearize_seconds = linearize_seconds_;
+    record.solve_seconds = solve_seconds_;
+    record.update_seconds = seconds - linearize_seconds_ - solve_seconds_;
+    options_.telemetry->record(record);
+  }
+  if (options_.checkpoint && options_.checkpoint->due()) {
+    OptimizerCheckpoint checkpoint;
+    checkpoint.values = values();
+    checkpoint.iterations = options_.previous_iterations + iterations();
+    checkpoint.lambda = lambda();
+    options_.checkpoint->save(checkpoint, true);
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+const gtsam::Values &InstrumentedLevenbergMarquardtOptimizer::optimize() {
+  const gtsam::LevenbergMarquardtParams &p = params();
+  double current_error = error();
+  if (current_error <= p.errorTol || iterations() >= p.maxIterations) {
+    return values();
+  }
+  double new_error = current_error;
+  do {
+    if (options_.deadline.expired()) {
+      interrupted_ = true;
+      break;
+    }
+    current_error = new_error;
+    iterate();
+    new_error = error();
+  } while (iterations() < p.maxIterations &&
+           !gtsam::checkConvergence(p.relativeErrorTol, p.absoluteErrorTol,
+                                    p.errorTol, current_error, new_error,
+                                    p.verbosity) &&
+           std::isfinite(current_error));
+  return values();
+}
+
+/* ************************************************************************* */
+SolveRecord InstrumentedLevenbergMarquardtOptimizer::solveRecord() const {
+  SolveRecord record;
+  record.solve = solve_;
+  record.iterations = iterations();
+  record.initial_error = initial_error_;
+  record.error = error();
+  record.seconds = SecondsSince(start_);
+  record.interrupted = interrupted_;
+  return record;
+}
+
+/* ************************************************************************* */
+void InstrumentedLevenbergMarquardtOptimizer::recordSolve(
+    const SolveRecord &record) const {
+  if (options_.telemetry) options_.telemetry->record(record);
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr
+InstrumentedLevenbergMarquardtOptimizer::linearize() const {
+  GTDYNAMICS_TRACE_SCOPE("LevenbergMarquardt::linearize");
+  const auto start = Clock::now();
+  GaussianFactorGraph::shared_ptr linear =
+      cache_      ? cache_->linearize(graph_, values())
+      : assembly_ ? assembly_->linearize(
+                        graph_, values(),
+                        options_.linearization_threads.value_or(1))
+      : batches_  ? batches_->linearize(graph_, values(),
+                                        *options_.linearization_threads)
+                  : gtsam::LevenbergMarquardtOptimizer::linearize();
+  linearize_seconds_ += SecondsSince(start);
+  return linear;
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues InstrumentedLevenbergMarquardtOptimizer::solve(
+    const GaussianFactorGraph &gfg,
+    const gtsam::NonlinearOptimizerParams &params) const {
+  GTDYNAMICS_TRACE_SCOPE("LevenbergMarquardt::eliminate");
+  const auto start = Clock::now();
+  linear_solves_++;
+  gtsam::VectorValues delta;
+  try {
+    delta = options_.riccati_solver ? RiccatiSolve(gfg)
+            : options_.pcg_solver
+                ? PcgSolve(gfg, *options_.pcg_solver)
+                : gtsam::LevenbergMarquardtOptimizer::solve(gfg, params);
+  } catch (...) {
+    solve_seconds_ += SecondsSince(start);
+    throw;
+  }
+  solve_seconds_ += SecondsSince(start);
+  step_norm_ = delta.norm();
+  return delta;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,204 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerTelemetry.h
+ * @brief Per-iteration timing and convergence records of LM solves.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/BatchedLinearization.h>
+#include <gtdynamics/optimizer/HessianAssembly.h>
+#include <gtdynamics/optimizer/LinearizationCache.h>
+#include <gtdynamics/optimizer/PcgSolver.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <boost/optional.hpp>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gtdynamics {
+
+class Checkpointer;
+
+/// Timing and convergence of one LM iteration.
+struct IterationRecord {
+  size_t solve = 0;      ///< index of the solve, see OptimizerTelemetry
+  size_t iteration = 0;  ///< LM iteration within the solve, from 1
+  double error = 0;      ///< graph error after the iteration
+  double lambda = 0;     ///< LM damping after the iteration
+  double step_norm = 0;  ///< norm of the last step solved for
+  size_t linear_solves = 0;  ///< damped systems solved, one per lambda tried
+  double linearize_seconds = 0;  ///< time to linearize
+  double solve_seconds = 0;      ///< time to solve the damped systems
+  /// Rest of the iteration: damping, retraction and error evaluation.
+  double update_seconds = 0;
+  /// Tolerance-scaled constraint violation after the iteration, for
+  /// constrained iterations, e.g. of SQP; NaN otherwise.
+  double violation = std::numeric_limits<double>::quiet_NaN();
+};
+
+/// Outcome of one LM solve, e.g. an inner loop of a constrained method.
+struct SolveRecord {
+  size_t solve = 0;       ///< index of the solve, see OptimizerTelemetry
+  size_t iterations = 0;  ///< LM iterations
+  double initial_error = 0, error = 0;  ///< graph error before and after
+  double seconds = 0;     ///< wall-clock time of the solve
+  /// Penalty parameter and tolerance-scaled constraint violation after the
+  /// solve, NaN for unconstrained solves.
+  double mu = std::numeric_limits<double>::quiet_NaN();
+  double violation = std::numeric_limits<double>::quiet_NaN();
+  bool interrupted = false;  ///< stopped by its deadline or cancellation
+};
+
+/**
+ * OptimizerTelemetry collects the records of the LM solves of optimizers it
+ * is attached to, through OptimizationParameters::telemetry or
+ * ConstrainedOptimizationParameters::telemetry. Records are passed to the
+ * callbacks, if any, and kept in memory unless disabled.
+ *
+ * Recording takes a few clock reads and a lock per iteration, so it can stay
+ * on in production. A sink may be shared by optimizers running on several
+ * threads; callbacks are then called one at a time.
+ */
+class OptimizerTelemetry {
+ public:
+  typedef std::function<void(const IterationRecord &)> IterationCallback;
+  typedef std::function<void(const SolveRecord &)> SolveCallback;
+
+  /**
+   * Constructor.
+   * @param keep_trace keep all records in memory
+   */
+  explicit OptimizerTelemetry(bool keep_trace = true)
+      : keep_trace_(keep_trace) {}
+
+  /// Call f with every iteration record.
+  void onIteration(const IterationCallback &f);
+
+  /// Call f with every solve record.
+  void onSolve(const SolveCallback &f);
+
+  /// Index of a new solve; solves are numbered from 0.
+  size_t beginSolve();
+
+  /// Record an iteration.
+  void record(const IterationRecord &record);
+
+  /// Record a solve.
+  void record(const SolveRecord &record);
+
+  /// Iteration records kept so far.
+  std::vector<IterationRecord> iterations() const;
+
+  /// Solve records kept so far.
+  std::vector<SolveRecord> solves() const;
+
+  /// Forget the records kept, and number solves from 0 again.
+  void clear();
+
+ private:
+  mutable std::mutex mutex_;
+  bool keep_trace_;
+  size_t num_solves_ = 0;
+  IterationCallback iteration_callback_;
+  SolveCallback solve_callback_;
+  std::vector<IterationRecord> iterations_;
+  std::vector<SolveRecord> solves_;
+};
+
+/**
+ * Levenberg-Marquardt that records the timing and convergence of every
+ * iteration in an OptimizerTelemetry, and optionally linearizes with
+ * FactorBatches and solves with RiccatiSolve. It stops early, between
+ * iterations, once its deadline expires; LM never accepts a step that
+ * increases the error, so the current values are then the best so far.
+ */
+class InstrumentedLevenbergMarquardtOptimizer
+    : public gtsam::LevenbergMarquardtOptimizer {
+ public:
+  /// What to record, and how to linearize and solve.
+  struct Options {
+    std::shared_ptr<OptimizerTelemetry> telemetry;  ///< none if null
+    boost::optional<size_t> linearization_threads;  ///< FactorBatches threads
+    bool riccati_solver = false;                    ///< solve with Riccati
+    boost::optional<PcgParameters> pcg_solver;      ///< solve with PCG
+    boost::optional<double> relinearize_threshold;  ///< LinearizationCache
+    bool hessian_linearization = false;             ///< HessianAssembly
+    Deadline deadline;  ///< when to stop iterating
+    std::shared_ptr<Checkpointer> checkpoint;  ///< saved after iterations
+    size_t previous_iterations = 0;  ///< iterations before a resumed solve
+  };
+
+  /**
+   * Constructor; begins a solve of the telemetry.
+   * @param graph          the graph to optimize
+   * @param initial_values initial values of all variables
+   * @param params         LM parameters
+   * @param options        telemetry, linearization and linear solver
+   */
+  InstrumentedLevenbergMarquardtOptimizer(
+      const gtsam::NonlinearFactorGraph &graph,
+      const gtsam::Values &initial_values,
+      const gtsam::LevenbergMarquardtParams &params, const Options &options);
+
+  /// Perform one iteration and record it.
+  gtsam::GaussianFactorGraph::shared_ptr iterate() override;
+
+  /**
+   * Iterate until convergence, as NonlinearOptimizer::defaultOptimize, or
+   * until the deadline expires.
+   */
+  const gtsam::Values &optimize() override;
+
+  /// Whether optimize stopped because the deadline expired.
+  bool interrupted() const { return interrupted_; }
+
+  /**
+   * Record of the solve so far, e.g. after optimize(); not recorded in the
+   * telemetry, so that constrained methods can add the violation first.
+   */
+  SolveRecord solveRecord() const;
+
+  /// Record a solve in the telemetry, if any.
+  void recordSolve(const SolveRecord &record) const;
+
+ protected:
+  gtsam::GaussianFactorGraph::shared_ptr linearize() const override;
+
+  gtsam::VectorValues solve(
+      const gtsam::GaussianFactorGraph &gfg,
+      const gtsam::NonlinearOptimizerParams &params) const override;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  Options options_;
+  boost::optional<FactorBatches> batches_;
+  boost::optional<HessianAssembly> assembly_;
+  mutable boost::optional<LinearizationCache> cache_;
+  size_t solve_ = 0;
+  bool interrupted_ = false;
+  double initial_error_;
+  Clock::time_point start_;
+
+  // Accumulated over the current iteration.
+  mutable double linearize_seconds_ = 0, solve_seconds_ = 0;
+  mutable double step_norm_ = 0;
+  mutable size_t linear_solves_ = 0;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParameterSweep.cpp
+ * @brief Solve one optimization problem per point of a parameter grid, in
+ * parallel.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/ParameterSweep.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/ThreadPool.h>
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+ParameterGrid &ParameterGrid::add(const std::string &name,
+                                  const std::vector<double> &values) {
+  if (values.empty()) {
+    throw std::invalid_argument("ParameterGrid: no values for " + name);
+  }
+  for (auto &&parameter : parameters_) {
+    if (parameter.first == name) {
+      throw std::invalid_argument("ParameterGrid: " + name +
+                                  " is already in the grid");
+    }
+  }
+  parameters_.emplace_back(name, values);
+  return *this;
+}
+
+/* ************************************************************************* */
+std::vector<std::string> ParameterGrid::names() const {
+  std::vector<std::string> names;
+  for (auto &&parameter : parameters_) names.push_back(parameter.first);
+  return names;
+}
+
+/* ************************************************************************* */
+size_t ParameterGrid::size() const {
+  size_t size = 1;
+  for (auto &&parameter : parameters_) size *= parameter.second.size();
+  return size;
+}
+
+/* ************************************************************************* */
+DesignPoint ParameterGrid::point(size_t index) const {
+  if (index >= size()) {
+    throw std::out_of_range("ParameterGrid: no point " +
+                            std::to_string(index));
+  }
+  DesignPoint point;
+  for (auto it = parameters_.rbegin(); it != parameters_.rend(); ++it) {
+    const size_t n = it->second.size();
+    point[it->first] = it->second[index % n];
+    index /= n;
+  }
+  return point;
+}
+
+/* ************************************************************************* */
+ParameterSweep::ParameterSweep(const ParameterGrid &grid,
+                               const OptimizationParameters &parameters,
+                               const gtsam::KeyVector &output_keys,
+                               size_t num_threads)
+    : grid_(grid),
+      parameters_(parameters),
+      output_keys_(output_keys),
+      num_threads_(num_threads) {}
+
+/* ************************************************************************* */
+void ParameterSweep::writeHeader(std::ostream &os) const {
+  os << "index";
+  for (auto &&name : grid_.names()) os << "," << name;
+  os << ",solved,initial_error,error,seconds";
+  for (gtsam::Key key : output_keys_) os << "," << _GTDKeyFormatter(key);
+  os << "\n";
+}
+
+/* ************************************************************************* */
+void ParameterSweep::writeResult(const SweepResult &result,
+                                 std::ostream &os) const {
+  os << result.index;
+  for (auto &&name : grid_.names()) os << "," << result.point.at(name);
+  os << "," << result.solved << "," << result.initial_error << ","
+     << result.error << "," << result.seconds;
+  for (double output : result.outputs) os << "," << output;
+  os << "\n";
+}
+
+/* ************************************************************************* */
+SweepResult ParameterSweep::solvePoint(
+    size_t index, const std::function<SweepProblem()> &build) const {
+  const auto start = std::chrono::steady_clock::now();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  SweepResult result;
+  result.index = index;
+  result.point = grid_.point(index);
+  result.initial_error = result.error = nan;
+  result.outputs.assign(output_keys_.size(), nan);
+  try {
+    const SweepProblem problem = build();
+    result.initial_error = problem.graph.error(problem.initial_values);
+    const Values values = Optimizer(parameters_).optimize(
+        problem.graph, problem.initial_values);
+    result.error = problem.graph.error(values);
+    for (size_t i = 0; i < output_keys_.size(); i++) {
+      if (values.exists(output_keys_[i])) {
+        result.outputs[i] = values.at<double>(output_keys_[i]);
+      }
+    }
+    result.solved = true;
+  } catch (const std::exception &e) {
+    result.message = e.what();
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+/* ************************************************************************* */
+std::vector<SweepResult> ParameterSweep::runAll(
+    const std::function<SweepProblem(size_t)> &build,
+    const std::string &results_path) const {
+  // Results are appended as points complete, so the order of the lines is
+  // that of completion; the index column identifies the point.
+  std::ofstream os;
+  std::mutex os_mutex;
+  if (!results_path.empty()) {
+    os.open(results_path);
+    if (!os) {
+      throw std::runtime_error("ParameterSweep: cannot write " +
+                               results_path);
+    }
+    os.precision(std::numeric_limits<double>::max_digits10);
+    writeHeader(os);
+  }
+
+  std::vector<std::future<SweepResult>> futures;
+  {
+    ThreadPool pool(num_threads_);
+    for (size_t index = 0; index < grid_.size(); index++) {
+      futures.push_back(pool.submit([this, &build, &os, &os_mutex, index]() {
+        SweepResult result = solvePoint(index, [&]() { return build(index); });
+        if (os.is_open()) {
+          std::lock_guard<std::mutex> lock(os_mutex);
+          writeResult(result, os);
+          os.flush();
+        }
+        return result;
+      }));
+    }
+  }
+
+  std::vector<SweepResult> results;
+  for (auto &&future : futures) results.push_back(future.get());
+  return results;
+}
+
+/* ************************************************************************* */
+std::vector<SweepResult> ParameterSweep::run(
+    const Builder &builder, const std::string &results_path) const {
+  return runAll(
+      [this, &builder](size_t index) { return builder(grid_.point(index)); },
+      results_path);
+}
+
+/* ************************************************************************* */
+std::vector<SweepResult> ParameterSweep::solve(
+    const std::vector<NonlinearFactorGraph> &graphs,
+    const std::vector<Values> &initial_values,
+    const std::string &results_path) const {
+  if (graphs.size() != grid_.size() ||
+      initial_values.size() != grid_.size()) {
+    throw std::invalid_argument(
+        "ParameterSweep: need a graph and initial values for every point");
+  }
+  return runAll(
+      [&graphs, &initial_values](size_t index) {
+        return SweepProblem{graphs[index], initial_values[index]};
+      },
+      results_path);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParameterSweep.h
+ * @brief Solve one optimization problem per point of a parameter grid, in
+ * parallel.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// A point of a parameter grid: the value of every parameter, by name.
+typedef std::map<std::string, double> DesignPoint;
+
+/**
+ * ParameterGrid is the Cartesian product of the values of named
+ * parameters, e.g. fields of a robot configuration file. Points are indexed
+ * with the last parameter added varying fastest.
+ */
+class ParameterGrid {
+ public:
+  ParameterGrid() {}
+
+  /**
+   * Add a parameter; throws if it has no values or is already in the grid.
+   * @param name   name of the parameter, e.g. "knee.k_tendon"
+   * @param values values of the parameter
+   */
+  ParameterGrid &add(const std::string &name,
+                     const std::vector<double> &values);
+
+  /// Names of the parameters, in the order they were added.
+  std::vector<std::string> names() const;
+
+  /// Number of points; a grid without parameters has a single point.
+  size_t size() const;
+
+  /// Point with the given index; throws if the index is out of range.
+  DesignPoint point(size_t index) const;
+
+ private:
+  std::vector<std::pair<std::string, std::vector<double>>> parameters_;
+};
+
+/// Factor graph and initial values of the problem at one design point.
+struct SweepProblem {
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial_values;
+};
+
+/// Outcome of the problem at one design point.
+struct SweepResult {
+  size_t index = 0;     ///< index of the point in the grid
+  DesignPoint point;    ///< the point
+  bool solved = false;  ///< false if building or solving the problem threw
+  double initial_error = 0, error = 0;  ///< graph error before and after
+  double seconds = 0;   ///< wall-clock time to build and solve
+  std::vector<double> outputs;  ///< values of the output keys, NaN if absent
+  std::string message;  ///< the exception message if not solved
+};
+
+/**
+ * ParameterSweep solves the problems of all points of a ParameterGrid, e.g.
+ * trajectory optimizations over the design parameters of a robot, on a
+ * ThreadPool. Every point is built and solved by one task with its own
+ * Optimizer, so problems share no mutable state: a builder that needs a
+ * Robot should create it from the point, or copy a prototype it captured,
+ * and not modify links or joints it shares with other points.
+ *
+ * A failing point does not stop the sweep; its result records the error.
+ * Results are written to a CSV file as points complete, one line per point,
+ * so an interrupted sweep keeps the points it finished. Each line holds the
+ * index, the parameters, whether the point was solved, the initial and
+ * final error, the time in seconds, and the values of the output keys.
+ */
+class ParameterSweep {
+ public:
+  /// Creates the problem of a design point; may be called concurrently.
+  typedef std::function<SweepProblem(const DesignPoint &)> Builder;
+
+  /**
+   * Constructor.
+   * @param grid        the design points
+   * @param parameters  parameters of the optimizer of every point
+   * @param output_keys double-valued variables to report for every point
+   * @param num_threads number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  ParameterSweep(const ParameterGrid &grid,
+                 const OptimizationParameters &parameters =
+                     OptimizationParameters(),
+                 const gtsam::KeyVector &output_keys = gtsam::KeyVector(),
+                 size_t num_threads = 0);
+
+  /**
+   * Build and solve the problems of all points, each on a worker thread.
+   * @param builder      creates the problem of a point
+   * @param results_path CSV file to write the results to, none if empty
+   * @return results of all points, ordered by index
+   */
+  std::vector<SweepResult> run(const Builder &builder,
+                               const std::string &results_path = "") const;
+
+  /**
+   * Solve problems built beforehand, e.g. in Python, one per point.
+   * @param graphs         graph of every point, ordered by index
+   * @param initial_values initial values of every point
+   * @param results_path   CSV file to write the results to, none if empty
+   * @return results of all points, ordered by index
+   */
+  std::vector<SweepResult> solve(
+      const std::vector<gtsam::NonlinearFactorGraph> &graphs,
+      const std::vector<gtsam::Values> &initial_values,
+      const std::string &results_path = "") const;
+
+  /// The design points.
+  const ParameterGrid &grid() const { return grid_; }
+
+  /// Write the header line of the results file.
+  void writeHeader(std::ostream &os) const;
+
+  /// Write the line of one result, with the parameters in header order.
+  void writeResult(const SweepResult &result, std::ostream &os) const;
+
+ private:
+  ParameterGrid grid_;
+  OptimizationParameters parameters_;
+  gtsam::KeyVector output_keys_;
+  size_t num_threads_;
+
+  /// Build and solve the problem of one point.
+  SweepResult solvePoint(size_t index,
+                         const std::function<SweepProblem()> &build) const;
+
+  /// Run the problems of all points and collect their results.
+  std::vector<SweepResult> runAll(
+      const std::function<SweepProblem(size_t)> &build,
+      const std::string &results_path) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PcgSolver.cpp
+ * @brief Conjugate gradients with a block-Jacobi preconditioner over time
+ * steps, for linearized trajectory problems too long to factorize.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/PcgSolver.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/Cholesky>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace {
+// Position of a variable in the solution vector, and its block.
+struct Variable {
+  size_t block, offset, dim;
+};
+
+// Whitened Jacobian [A b] of a factor, in place if it has no noise model.
+struct Term {
+  const JacobianFactor *jacobian = nullptr;
+  Matrix A;
+  Vector b;
+  std::vector<size_t> columns;  // first column of every key in A
+  std::vector<Variable> variables;
+
+  Eigen::Ref<const Matrix> matrix() const {
+    return jacobian ? Eigen::Ref<const Matrix>(jacobian->getA())
+                    : Eigen::Ref<const Matrix>(A);
+  }
+  Eigen::Ref<const Vector> rhs() const {
+    return jacobian ? Eigen::Ref<const Vector>(jacobian->getb())
+                    : Eigen::Ref<const Vector>(b);
+  }
+};
+
+// A key of a term whose variable is in a block.
+struct Incidence {
+  size_t term, key;
+};
+}  // namespace
+
+/* ************************************************************************* */
+VectorValues PcgSolve(const gtsam::GaussianFactorGraph &graph,
+                      const PcgParameters &parameters,
+                      PcgStatistics *statistics) {
+  const size_t num_threads = parameters.num_threads;
+
+  // Dimension of every variable, and its block: its time step, or its own.
+  std::map<Key, size_t> dims;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      dims[*it] = factor->getDim(it);
+    }
+  }
+  if (dims.empty()) return VectorValues();
+
+  std::map<uint64_t, size_t> steps;
+  size_t num_global = 0;
+  for (auto &&key_dim : dims) {
+    const DynamicsSymbol symbol(key_dim.first);
+    if (symbol.linkIdx() == DynamicsSymbol::kNoIndex &&
+        symbol.jointIdx() == DynamicsSymbol::kNoIndex) {
+      num_global++;
+    } else {
+      steps.emplace(symbol.time(), 0);
+    }
+  }
+  size_t num_blocks = 0;
+  for (auto &&step_block : steps) step_block.second = num_blocks++;
+  num_blocks += num_global;
+
+  std::map<Key, Variable> variables;
+  std::vector<size_t> block_dims(num_blocks, 0), block_offsets(num_blocks, 0);
+  std::vector<Key> block_keys(num_blocks);
+  size_t global = steps.size();
+  for (auto &&key_dim : dims) {
+    const DynamicsSymbol symbol(key_dim.first);
+    const size_t block = (symbol.linkIdx() == DynamicsSymbol::kNoIndex &&
+                          symbol.jointIdx() == DynamicsSymbol::kNoIndex)
+                             ? global++
+                             : steps[symbol.time()];
+    if (block_dims[block] == 0) block_keys[block] = key_dim.first;
+    variables[key_dim.first] = {block, block_dims[block], key_dim.second};
+    block_dims[block] += key_dim.second;
+  }
+  size_t dim = 0;
+  for (size_t s = 0; s < num_blocks; s++) {
+    block_offsets[s] = dim;
+    dim += block_dims[s];
+  }
+  for (auto &&key_variable : variables) {
+    key_variable.second.offset += block_offsets[key_variable.second.block];
+  }
+
+  // Whitened Jacobians, and the keys of every block.
+  std::vector<Term> terms;
+  std::vector<std::vector<Incidence>> incidence(num_blocks);
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    Term term;
+    const auto jacobian = boost::dynamic_pointer_cast<JacobianFactor>(factor);
+    gtsam::SharedDiagonal model;
+    if (jacobian) model = jacobian->get_model();
+    if (model && model->isConstrained()) {
+      throw std::invalid_argument(
+          "PcgSolve: constrained noise models are not supported");
+    }
+    if (jacobian && (!model || model->isUnit())) {
+      term.jacobian = jacobian.get();
+    } else {
+      std::tie(term.A, term.b) = factor->jacobian();
+    }
+    size_t column = 0;
+    for (size_t k = 0; k < factor->size(); k++) {
+      const Variable &variable = variables[factor->keys()[k]];
+      term.columns.push_back(column);
+      term.variables.push_back(variable);
+      incidence[variable.block].push_back({terms.size(), k});
+      column += variable.dim;
+    }
+    terms.push_back(std::move(term));
+  }
+
+  // Right-hand side A' b, and the Cholesky factors of the diagonal blocks of
+  // A' A. Keys of one term are consecutive in the incidence of a block.
+  Vector g(dim);
+  std::vector<Eigen::LLT<Matrix>> blocks(num_blocks);
+  ParallelFor(num_blocks, num_threads, [&](size_t s) {
+    Matrix D = Matrix::Zero(block_dims[s], block_dims[s]);
+    g.segment(block_offsets[s], block_dims[s]).setZero();
+    const std::vector<Incidence> &keys = incidence[s];
+    for (size_t i = 0; i < keys.size(); i++) {
+      const Term &term = terms[keys[i].term];
+      const auto A = term.matrix();
+      const Variable &vi = term.variables[keys[i].key];
+      const auto Ai = A.middleCols(term.columns[keys[i].key], vi.dim);
+      g.segment(vi.offset, vi.dim) += Ai.transpose() * term.rhs();
+      const size_t row = vi.offset - block_offsets[s];
+      for (size_t k = i; k < keys.size() && keys[k].term == keys[i].term;
+           k++) {
+        const Variable &vk = term.variables[keys[k].key];
+        const size_t col = vk.offset - block_offsets[s];
+        const Matrix block =
+            Ai.transpose() * A.middleCols(term.columns[keys[k].key], vk.dim);
+        D.block(row, col, vi.dim, vk.dim) += block;
+        if (k != i) D.block(col, row, vk.dim, vi.dim) += block.transpose();
+      }
+    }
+    blocks[s].compute(D);
+    if (blocks[s].info() != Eigen::Success) {
+      throw gtsam::IndeterminantLinearSystemException(block_keys[s]);
+    }
+  });
+
+  // y = A' A x, with the residuals of the terms, then gathered per block.
+  std::vector<Vector> residuals(terms.size());
+  auto multiply = [&](const Vector &x, Vector *y) {
+    ParallelFor(terms.size(), num_threads, [&](size_t f) {
+      const Term &term = terms[f];
+      const auto A = term.matrix();
+      Vector &e = residuals[f];
+      e.setZero(A.rows());
+      for (size_t k = 0; k < term.variables.size(); k++) {
+        const Variable &v = term.variables[k];
+        e += A.middleCols(term.columns[k], v.dim) * x.segment(v.offset, v.dim);
+      }
+    });
+    ParallelFor(num_blocks, num_threads, [&](size_t s) {
+      y->segment(block_offsets[s], block_dims[s]).setZero();
+      for (const Incidence &key : incidence[s]) {
+        const Term &term = terms[key.term];
+        const Variable &v = term.variables[key.key];
+        y->segment(v.offset, v.dim) +=
+            term.matrix().middleCols(term.columns[key.key], v.dim).transpose() *
+            residuals[key.term];
+      }
+    });
+  };
+  auto precondition = [&](const Vector &r, Vector *z) {
+    ParallelFor(num_blocks, num_threads, [&](size_t s) {
+      z->segment(block_offsets[s], block_dims[s]) =
+          blocks[s].solve(r.segment(block_offsets[s], block_dims[s]));
+    });
+  };
+
+  // Conjugate gradients, from x = 0.
+  Vector x = Vector::Zero(dim), r = g, z(dim), p(dim), q(dim);
+  const double initial_norm = g.norm();
+  double residual_norm = initial_norm;
+  size_t iterations = 0;
+  if (initial_norm > 0) {
+    precondition(r, &z);
+    p = z;
+    double rz = r.dot(z);
+    while (iterations < parameters.max_iterations) {
+      multiply(p, &q);
+      const double pq = p.dot(q);
+      if (!(pq > 0)) {
+        throw gtsam::IndeterminantLinearSystemException(block_keys[0]);
+      }
+      const double alpha = rz / pq;
+      x += alpha * p;
+      r -= alpha * q;
+      iterations++;
+      residual_norm = r.norm();
+      if (residual_norm <= parameters.relative_tolerance * initial_norm) break;
+      precondition(r, &z);
+      const double rz_next = r.dot(z);
+      p = z + (rz_next / rz) * p;
+      rz = rz_next;
+    }
+  }
+  if (statistics) {
+    statistics->iterations = iterations;
+    statistics->relative_residual =
+        initial_norm > 0 ? residual_norm / initial_norm : 0;
+  }
+
+  VectorValues result;
+  for (auto &&key_variable : variables) {
+    const Variable &v = key_variable.second;
+    result.insert(key_variable.first, Vector(x.segment(v.offset, v.dim)));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
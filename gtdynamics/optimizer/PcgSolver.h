@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PcgSolver.h
+ * @brief Conjugate gradients with a block-Jacobi preconditioner over time
+ * steps, for linearized trajectory problems too long to factorize.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <cstddef>
+
+namespace gtdynamics {
+
+/// Parameters of PcgSolve.
+struct PcgParameters {
+  size_t max_iterations = 1000;      // maximum number of CG iterations
+  double relative_tolerance = 1e-9;  // of the normal equations residual
+  size_t num_threads = 0;  // threads of the products, 0 for all threads
+};
+
+/// What PcgSolve did.
+struct PcgStatistics {
+  size_t iterations = 0;         // CG iterations
+  double relative_residual = 0;  // final residual norm over initial one
+};
+
+/**
+ * Solve the least-squares problem of a linearized trajectory, e.g. of
+ * DynamicsGraph::trajectoryFG, with preconditioned conjugate gradients on
+ * the normal equations A' A x = A' b.
+ *
+ * The normal equations are never formed: products with A' A run over the
+ * Jacobians of the factors, in parallel over time steps, so memory is that
+ * of the graph and one dense block per time step, instead of the fill-in of
+ * elimination. The preconditioner is block-Jacobi with one block per time
+ * step, given by the time of the DynamicsSymbol of the variables, which
+ * captures the dynamics within a step; variables without a link or joint
+ * index, e.g. PhaseKey(k), get a block of their own.
+ *
+ * Stops after max_iterations, with the current iterate, if the tolerance is
+ * not reached. Throws gtsam::IndeterminantLinearSystemException if the system
+ * is not positive definite, and std::invalid_argument for constrained noise
+ * models.
+ *
+ * @param graph      linear factors
+ * @param parameters iterations, tolerance and threads
+ * @param statistics if not null, set to the iterations and residual
+ * @return the minimizer of the error of the graph
+ */
+gtsam::VectorValues PcgSolve(const gtsam::GaussianFactorGraph &graph,
+                             const PcgParameters &parameters = PcgParameters(),
+                             PcgStatistics *statistics = nullptr);
+
+}  // namespace gtdynamics
@@ -11,7 +11,12 @@
  * @author: Yetong Zhang
  */
 
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/MeritGraph.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/Trace.h>
 
 namespace gtdynamics {
 
@@ -21,34 +26,102 @@ gtsam::Values PenaltyMethodOptimizer::optimize(
     ConstrainedOptResult* intermediate_result) const {
   gtsam::Values values = initial_values;
   double mu = p_.initial_mu;
+  int first_iteration = 0;
+  if (p_.checkpoint) {
+    if (auto checkpoint = p_.checkpoint->resume(CheckpointSolver::Penalty)) {
+      values = checkpoint->values;
+      mu = checkpoint->mu;
+      first_iteration = static_cast<int>(checkpoint->iterations);
+    }
+  }
+
+  // Keep the best iterate in case the solve runs out of time.
+  const Deadline deadline(p_.time_budget, p_.cancellation);
+  BestIterate best;
+  auto consider = [&](const ConstraintEvaluation& evaluation) {
+    if (deadline.bounded()) {
+      best.update(values, graph.error(values), evaluation.max_violation);
+    }
+  };
+  if (deadline.bounded()) {
+    consider(EvaluateConstraints(constraints, values, p_.num_threads,
+                                 p_.deterministic));
+  }
+  bool interrupted = false;
+
+  // Optionally build the merit graph and its ordering only once.
+  boost::optional<MeritGraph> reused;
+  gtsam::LevenbergMarquardtParams lm_parameters = p_.lm_parameters;
+  if (p_.reuse_merit_graph) {
+    reused.emplace(graph, constraints);
+    lm_parameters.setOrdering(reused->ordering());
+  }
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
-  for (int i = 0; i < p_.num_iterations; i++) {
-    gtsam::NonlinearFactorGraph merit_graph = graph;
+  for (int i = first_iteration; i < p_.num_iterations; i++) {
+    GTDYNAMICS_TRACE_SCOPE_ARG("PenaltyMethod::iteration", i);
+    if (deadline.expired()) {
+      interrupted = true;
+      break;
+    }
+    gtsam::NonlinearFactorGraph built_graph;
+    if (reused) {
+      reused->update(mu);
+    } else {
+      built_graph = graph;
 
-    // Create factors corresponding to penalty terms of constraints.
-    for (auto& constraint : constraints) {
-      merit_graph.add(constraint->createFactor(mu));
+      // Create factors corresponding to penalty terms of constraints.
+      for (auto& constraint : constraints) {
+        built_graph.add(constraint->createFactor(mu));
+      }
     }
+    const gtsam::NonlinearFactorGraph& merit_graph =
+        reused ? reused->graph() : built_graph;
 
     // Run optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
+    InstrumentedLevenbergMarquardtOptimizer::Options options;
+    options.telemetry = p_.telemetry;
+    options.deadline = deadline.within(p_.outer_time_budget);
+    InstrumentedLevenbergMarquardtOptimizer optimizer(merit_graph, values,
+                                                      lm_parameters, options);
     auto result = optimizer.optimize();
 
     // Save results and update parameters.
     values = result;
+    const bool evaluate = p_.telemetry || deadline.bounded() ||
+                          intermediate_result != nullptr;
+    ConstraintEvaluation evaluation;
+    if (evaluate) {
+      evaluation = EvaluateConstraints(constraints, values, p_.num_threads,
+                                       p_.deterministic);
+      consider(evaluation);
+    }
+    if (p_.telemetry) {
+      SolveRecord record = optimizer.solveRecord();
+      record.mu = mu;
+      record.violation = evaluation.violationNorm();
+      optimizer.recordSolve(record);
+    }
     mu *= p_.mu_increase_rate;
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
-      intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
-      intermediate_result->mu_values.push_back(mu);
+      intermediate_result->record(values, optimizer.getInnerIterations(), mu,
+                                  evaluation.violationNorm(),
+                                  evaluation.max_violation);
+    }
+
+    if (p_.checkpoint && p_.checkpoint->due()) {
+      OptimizerCheckpoint checkpoint;
+      checkpoint.solver = CheckpointSolver::Penalty;
+      checkpoint.values = values;
+      checkpoint.iterations = i + 1;
+      checkpoint.mu = mu;
+      p_.checkpoint->save(checkpoint, true);
     }
   }
-  return values;
+  return interrupted ? best.values() : values;
 }
 
 }  // namespace gtdynamics
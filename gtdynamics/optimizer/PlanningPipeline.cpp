@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningPipeline.cpp
+ * @brief Double-buffered pipeline that plans a trajectory segment while the
+ * previous one executes.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/PlanningPipeline.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+
+// Wait for a condition set by the other thread: spin briefly, then sleep,
+// since a wait may last as long as a segment executes.
+template <class Condition>
+void WaitUntil(const Condition &condition) {
+  for (size_t n = 0; !condition(); n++) {
+    if (n < 64) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+PlanningPipeline::PlanningPipeline(const Planner &planner, size_t num_segments,
+                                   size_t stitch_steps)
+    : planner_(planner),
+      num_segments_(num_segments),
+      stitch_steps_(stitch_steps),
+      published_(0),
+      released_(0),
+      failed_(false),
+      stopping_(false) {
+  if (!planner_)
+    throw std::invalid_argument("PlanningPipeline: no planner given");
+  thread_ = std::thread(&PlanningPipeline::plan, this);
+}
+
+/* ************************************************************************* */
+PlanningPipeline::~PlanningPipeline() {
+  stopping_.store(true);
+  thread_.join();
+}
+
+/* ************************************************************************* */
+void PlanningPipeline::plan() {
+  // The planner keeps its own copy of the previous segment, since the
+  // executor stitches the published one.
+  boost::optional<TrajectoryBuffer> previous;
+  for (size_t k = 0; k < num_segments_; k++) {
+    // Buffer k % 2 held segment k - 2, released when k - 1 was taken.
+    WaitUntil([&]() {
+      return k < 2 || released_.load(std::memory_order_acquire) + 1 >= k ||
+             stopping_.load();
+    });
+    if (stopping_.load()) return;
+    try {
+      TrajectoryBuffer segment = planner_(k, previous.get_ptr());
+      buffers_[k % 2] = segment;
+      previous = std::move(segment);
+    } catch (...) {
+      error_ = std::current_exception();
+      failed_.store(true, std::memory_order_release);
+      return;
+    }
+    published_.store(k + 1, std::memory_order_release);
+  }
+}
+
+/* ************************************************************************* */
+const TrajectoryBuffer &PlanningPipeline::nextSegment() {
+  if (next_ >= num_segments_)
+    throw std::out_of_range("PlanningPipeline: all segments were taken");
+  const size_t k = next_;
+  const auto start = std::chrono::steady_clock::now();
+  WaitUntil([&]() {
+    return published_.load(std::memory_order_acquire) > k ||
+           failed_.load(std::memory_order_acquire);
+  });
+  const std::chrono::duration<double> waited =
+      std::chrono::steady_clock::now() - start;
+  stall_time_ += waited.count();
+  if (published_.load(std::memory_order_acquire) <= k)
+    std::rethrow_exception(error_);
+
+  if (k > 0) stitch(k);
+  // Segment k - 1 has been executed, its buffer is free for segment k + 1.
+  released_.store(k, std::memory_order_release);
+  next_ = k + 1;
+  return *buffers_[k % 2];
+}
+
+/* ************************************************************************* */
+void PlanningPipeline::stitch(size_t k) {
+  if (stitch_steps_ == 0) return;
+  const TrajectoryBuffer &executed = *buffers_[(k - 1) % 2];
+  TrajectoryBuffer &segment = *buffers_[k % 2];
+  if (executed.numSteps() == 0 || segment.numSteps() == 0) return;
+  const size_t last = executed.numSteps() - 1;
+  const size_t n = std::min(stitch_steps_, segment.numSteps());
+
+  auto blend = [&](const gtsam::Matrix &from, gtsam::Matrix *to) {
+    if (to->cols() != from.cols())
+      throw std::invalid_argument(
+          "PlanningPipeline: segments of different robots");
+    const Eigen::RowVectorXd mismatch = from.row(last) - to->row(0);
+    for (size_t t = 0; t < n; t++) {
+      const double weight = 1.0 - double(t) / double(n);
+      to->row(t) += weight * mismatch;
+    }
+  };
+  blend(executed.jointAngles(), &segment.jointAngles());
+  blend(executed.jointVels(), &segment.jointVels());
+  blend(executed.jointAccels(), &segment.jointAccels());
+  blend(executed.torques(), &segment.torques());
+}
+
+/* ************************************************************************* */
+PlanningPipeline::Planner PlanningPipeline::IncrementalPlanner(
+    const std::shared_ptr<IncrementalOptimizer> &optimizer, const Robot &robot,
+    const ProblemBuilder &problem) {
+  return [=](size_t k, const TrajectoryBuffer *previous) {
+    const SegmentProblem p = problem(k, previous);
+    const gtsam::Values estimate =
+        optimizer->update(p.factors, p.values, p.earliest_time);
+
+    auto get = [&](gtsam::Key key, double *value) {
+      if (estimate.exists(key)) *value = estimate.at<double>(key);
+    };
+    TrajectoryBuffer segment(robot, p.num_steps);
+    for (size_t t = 0; t < p.num_steps; t++) {
+      const size_t step = p.first_step + t;
+      for (auto &&joint : robot.joints()) {
+        const int j = joint->id();
+        get(JointAngleKey(j, step), &segment.jointAngle(j, t));
+        get(JointVelKey(j, step), &segment.jointVel(j, t));
+        get(JointAccelKey(j, step), &segment.jointAccel(j, t));
+        get(TorqueKey(j, step), &segment.torque(j, t));
+      }
+      for (auto &&link : robot.links()) {
+        const int i = link->id();
+        if (estimate.exists(PoseKey(i, step)))
+          segment.pose(i, t) = estimate.at<gtsam::Pose3>(PoseKey(i, step));
+        if (estimate.exists(TwistKey(i, step)))
+          segment.twist(i, t) = estimate.at<gtsam::Vector6>(TwistKey(i, step));
+      }
+    }
+    return segment;
+  };
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningPipeline.h
+ * @brief Double-buffered pipeline that plans a trajectory segment while the
+ * previous one executes.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <atomic>
+#include <boost/optional.hpp>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace gtdynamics {
+
+/// Problem of one trajectory segment, for an IncrementalOptimizer.
+struct SegmentProblem {
+  gtsam::NonlinearFactorGraph factors;      // factors to add
+  gtsam::Values values;                     // initial values of new variables
+  boost::optional<uint64_t> earliest_time;  // marginalize older time steps
+  size_t first_step = 0;                    // first time step of the segment
+  size_t num_steps = 0;                     // number of time steps
+};
+
+/**
+ * PlanningPipeline runs a planner on a background thread, one trajectory
+ * segment ahead of the thread that executes them: segment k + 1 is planned
+ * while segment k is streamed to a controller, so planning latency is hidden
+ * whenever planning a segment takes less time than executing one.
+ *
+ * Segments are handed over in two buffers, without locks: the planner writes
+ * a segment into the buffer the executor released last, and publishes it
+ * with an atomic counter. Segments overlap by one step, the first step of
+ * segment k being the boundary state at the last step of segment k - 1. At
+ * every boundary the joint quantities of the new segment are stitched to the
+ * executed ones: their mismatch at the boundary is subtracted, fading out
+ * linearly over stitch_steps steps. Link poses and twists are not stitched.
+ *
+ *   PlanningPipeline pipeline(planner, num_segments, 5);
+ *   for (size_t k = 0; k < num_segments; k++) {
+ *     const TrajectoryBuffer &segment = pipeline.nextSegment();
+ *     for (size_t t = k ? 1 : 0; t < segment.numSteps(); t++) send(segment, t);
+ *   }
+ */
+class PlanningPipeline {
+ public:
+  /**
+   * Plans segment k, given the segment planned before it, or none for the
+   * first one. Called on the planning thread, one segment at a time.
+   */
+  using Planner =
+      std::function<TrajectoryBuffer(size_t k, const TrajectoryBuffer *)>;
+
+  /// Builds the problem of segment k, given the segment planned before it.
+  using ProblemBuilder =
+      std::function<SegmentProblem(size_t k, const TrajectoryBuffer *)>;
+
+ private:
+  Planner planner_;
+  size_t num_segments_, stitch_steps_;
+  boost::optional<TrajectoryBuffer> buffers_[2];  // segment k in k % 2
+  std::atomic<size_t> published_;  // segments written by the planner
+  std::atomic<size_t> released_;   // segments whose buffer may be reused
+  std::atomic<bool> failed_, stopping_;
+  std::exception_ptr error_;
+  size_t next_ = 0;         // next segment to execute
+  double stall_time_ = 0;   // time spent waiting by the executor
+  std::thread thread_;
+
+  void plan();
+
+  /// Stitch segment k to segment k - 1.
+  void stitch(size_t k);
+
+ public:
+  /**
+   * Constructor, starts planning the first segment.
+   * @param planner      the planner
+   * @param num_segments number of segments to plan
+   * @param stitch_steps number of steps over which a boundary mismatch fades
+   * out; with none, segments are not stitched
+   */
+  PlanningPipeline(const Planner &planner, size_t num_segments,
+                   size_t stitch_steps = 0);
+
+  /// Stop planning after the segment being planned, and join the thread.
+  ~PlanningPipeline();
+
+  PlanningPipeline(const PlanningPipeline &) = delete;
+  PlanningPipeline &operator=(const PlanningPipeline &) = delete;
+
+  /**
+   * The next segment to execute, stitched to the previous one, waiting for
+   * the planner if needed. The reference stays valid until the next call,
+   * which hands its buffer back to the planner. Rethrows the exception of
+   * the planner if it failed.
+   */
+  const TrajectoryBuffer &nextSegment();
+
+  /// Number of segments.
+  size_t numSegments() const { return num_segments_; }
+
+  /// Number of segments taken by nextSegment.
+  size_t numTaken() const { return next_; }
+
+  /// Total time nextSegment waited for the planner, in seconds.
+  double stallTime() const { return stall_time_; }
+
+  /**
+   * Planner that adds every segment problem to an incremental optimizer and
+   * returns the joint and link states at the steps of the segment, from the
+   * estimate after the update. States missing from the estimate stay zero.
+   * @param optimizer the optimizer, only used by the planning thread
+   * @param robot     the robot
+   * @param problem   builds the problem of each segment
+   */
+  static Planner IncrementalPlanner(
+      const std::shared_ptr<IncrementalOptimizer> &optimizer,
+      const Robot &robot, const ProblemBuilder &problem);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RiccatiSolver.cpp
+ * @brief Riccati recursion over time steps for linearized trajectory
+ * problems.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/RiccatiSolver.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/Cholesky>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace {
+// Position of a variable in the blocks of its time step.
+struct Slot {
+  size_t stage, offset, dim;
+};
+}  // namespace
+
+/* ************************************************************************* */
+VectorValues RiccatiSolve(const gtsam::GaussianFactorGraph &graph) {
+  // Dimension of every variable, and the time steps, in increasing order.
+  std::map<Key, size_t> dims;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      dims[*it] = factor->getDim(it);
+    }
+  }
+  if (dims.empty()) return VectorValues();
+
+  std::map<uint64_t, size_t> stages;
+  for (auto &&key_dim : dims) {
+    const DynamicsSymbol symbol(key_dim.first);
+    if (symbol.linkIdx() == DynamicsSymbol::kNoIndex &&
+        symbol.jointIdx() == DynamicsSymbol::kNoIndex) {
+      throw std::invalid_argument("RiccatiSolve: variable " +
+                                  std::string(symbol) +
+                                  " is not at a single time step");
+    }
+    stages.emplace(symbol.time(), 0);
+  }
+  size_t num_stages = 0;
+  for (auto &&time_stage : stages) time_stage.second = num_stages++;
+
+  std::map<Key, Slot> slots;
+  std::vector<size_t> stage_dims(num_stages, 0);
+  std::vector<Key> stage_keys(num_stages);
+  for (auto &&key_dim : dims) {
+    const size_t stage = stages[DynamicsSymbol(key_dim.first).time()];
+    if (stage_dims[stage] == 0) stage_keys[stage] = key_dim.first;
+    slots[key_dim.first] = {stage, stage_dims[stage], key_dim.second};
+    stage_dims[stage] += key_dim.second;
+  }
+
+  // Normal equations: diagonal blocks D, blocks U between every step and the
+  // next, and right-hand sides g.
+  std::vector<Matrix> D(num_stages), U(num_stages - 1);
+  std::vector<Vector> g(num_stages);
+  for (size_t s = 0; s < num_stages; s++) {
+    D[s] = Matrix::Zero(stage_dims[s], stage_dims[s]);
+    g[s] = Vector::Zero(stage_dims[s]);
+    if (s + 1 < num_stages) {
+      U[s] = Matrix::Zero(stage_dims[s], stage_dims[s + 1]);
+    }
+  }
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    const Matrix info = factor->augmentedInformation();
+    std::vector<const Slot *> factor_slots;
+    std::vector<size_t> offsets;
+    size_t n = 0;
+    for (Key key : factor->keys()) {
+      factor_slots.push_back(&slots[key]);
+      offsets.push_back(n);
+      n += slots[key].dim;
+    }
+    for (size_t a = 0; a < factor_slots.size(); a++) {
+      const Slot &sa = *factor_slots[a];
+      g[sa.stage].segment(sa.offset, sa.dim) +=
+          info.block(offsets[a], n, sa.dim, 1);
+      for (size_t b = 0; b < factor_slots.size(); b++) {
+        const Slot &sb = *factor_slots[b];
+        const auto block = info.block(offsets[a], offsets[b], sa.dim, sb.dim);
+        if (sb.stage == sa.stage) {
+          D[sa.stage].block(sa.offset, sb.offset, sa.dim, sb.dim) += block;
+        } else if (sb.stage == sa.stage + 1) {
+          U[sa.stage].block(sa.offset, sb.offset, sa.dim, sb.dim) += block;
+        } else if (sa.stage != sb.stage + 1) {
+          throw std::invalid_argument(
+              "RiccatiSolve: a factor couples non-consecutive time steps");
+        }
+      }
+    }
+  }
+
+  // Backward sweep: condense every step onto the previous one, so that
+  // P[s] x[s] + U[s-1]' x[s-1] = r[s].
+  std::vector<Eigen::LLT<Matrix>> P(num_stages);
+  std::vector<Vector> r(num_stages);
+  Matrix S = D.back();
+  r.back() = g.back();
+  for (size_t s = num_stages - 1;; s--) {
+    P[s].compute(S);
+    if (P[s].info() != Eigen::Success) {
+      throw gtsam::IndeterminantLinearSystemException(stage_keys[s]);
+    }
+    if (s == 0) break;
+    const Matrix K = P[s].solve(U[s - 1].transpose());
+    S = D[s - 1] - U[s - 1] * K;
+    r[s - 1] = g[s - 1] - K.transpose() * r[s];
+  }
+
+  // Forward rollout.
+  std::vector<Vector> x(num_stages);
+  x[0] = P[0].solve(r[0]);
+  for (size_t s = 1; s < num_stages; s++) {
+    x[s] = P[s].solve(r[s] - U[s - 1].transpose() * x[s - 1]);
+  }
+
+  VectorValues result;
+  for (auto &&key_slot : slots) {
+    const Slot &slot = key_slot.second;
+    result.insert(key_slot.first,
+                  Vector(x[slot.stage].segment(slot.offset, slot.dim)));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RiccatiSolver.h
+ * @brief Riccati recursion over time steps for linearized trajectory
+ * problems.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+namespace gtdynamics {
+
+/**
+ * Solve the least-squares problem of a linearized trajectory, e.g. of
+ * DynamicsGraph::trajectoryFG, with a Riccati recursion over its time steps.
+ *
+ * The variables of every time step, given by the time of their
+ * DynamicsSymbol, form one dense block of the normal equations, and factors
+ * may only couple consecutive steps, so the system is block-tridiagonal. A
+ * backward sweep from the last step condenses every step onto the previous
+ * one, e.g. the cost-to-go of LQR, and a forward rollout recovers the
+ * solution, in time linear in the number of steps.
+ *
+ * Throws std::invalid_argument for variables without a link or joint index,
+ * e.g. phase durations PhaseKey(k), which couple many steps, or for factors
+ * on non-consecutive steps. Throws gtsam::IndeterminantLinearSystemException
+ * if the system is not positive definite.
+ *
+ * @param graph linear factors on DynamicsSymbol keys
+ * @return the minimizer of the error of the graph
+ */
+gtsam::VectorValues RiccatiSolve(const gtsam::GaussianFactorGraph &graph);
+
+/**
+ * Levenberg-Marquardt that solves its damped linear systems with
+ * RiccatiSolve instead of multifrontal elimination. An indeterminant step
+ * system makes LM increase lambda, as it does with elimination.
+ */
+class RiccatiLevenbergMarquardtOptimizer
+    : public gtsam::LevenbergMarquardtOptimizer {
+ public:
+  RiccatiLevenbergMarquardtOptimizer(
+      const gtsam::NonlinearFactorGraph &graph,
+      const gtsam::Values &initial_values,
+      const gtsam::LevenbergMarquardtParams &params =
+          gtsam::LevenbergMarquardtParams())
+      : gtsam::LevenbergMarquardtOptimizer(graph, initial_values, params) {}
+
+  /// Solve the damped system with RiccatiSolve.
+  gtsam::VectorValues solve(
+      const gtsam::GaussianFactorGraph &gfg,
+      const gtsam::NonlinearOptimizerParams &params) const override {
+    return RiccatiSolve(gfg);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,205 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.cpp
+ * @brief Sequential quadratic programming for equality constrained problems.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/Trace.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::VectorValues;
+using Clock = std::chrono::steady_clock;
+
+static double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* ************************************************************************* */
+double SQPOptimizer::merit(const NonlinearFactorGraph& graph,
+                           const EqualityConstraints& constraints,
+                           const Values& values) const {
+  auto evaluation = EvaluateConstraints(constraints, values, p_.num_threads,
+                                        p_.deterministic);
+  return graph.error(values) + p_.merit_weight * evaluation.violationNorm();
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph SQPOptimizer::subproblem(
+    const NonlinearFactorGraph& graph, const EqualityConstraints& constraints,
+    const Values& values) const {
+  GaussianFactorGraph qp = *graph.linearize(values);
+  qp.reserve(qp.size() + constraints.size() + values.size());
+
+  // Linearized constraints g(x) + J dx = 0, as hard constraints.
+  for (const auto& constraint : constraints) {
+    auto factor = constraint->createFactor(1.0);
+    std::vector<Matrix> H(factor->size());
+    const Vector g = factor->unwhitenedError(values, H);
+    std::vector<std::pair<gtsam::Key, Matrix>> terms;
+    for (size_t i = 0; i < factor->size(); i++) {
+      terms.emplace_back(factor->keys()[i], H[i]);
+    }
+    qp.emplace_shared<gtsam::JacobianFactor>(
+        terms, -g, gtsam::noiseModel::Constrained::All(g.size()));
+  }
+
+  // Damping, as in Levenberg-Marquardt.
+  if (p_.lambda > 0) {
+    const double sigma = 1.0 / std::sqrt(p_.lambda);
+    for (const auto& key_value : values) {
+      const size_t d = key_value.value.dim();
+      qp.emplace_shared<gtsam::JacobianFactor>(
+          key_value.key, Matrix::Identity(d, d), Vector::Zero(d),
+          gtsam::noiseModel::Isotropic::Sigma(d, sigma));
+    }
+  }
+  return qp;
+}
+
+/* ************************************************************************* */
+Values SQPOptimizer::optimize(const NonlinearFactorGraph& graph,
+                              const EqualityConstraints& constraints,
+                              const Values& initial_values,
+                              ConstrainedOptResult* intermediate_result) const {
+  const auto solve_start = Clock::now();
+  const size_t solve = p_.telemetry ? p_.telemetry->beginSolve() : 0;
+  Values values = initial_values;
+  size_t first_iteration = 0;
+  if (p_.checkpoint) {
+    if (auto checkpoint = p_.checkpoint->resume(CheckpointSolver::SQP)) {
+      values = checkpoint->values;
+      first_iteration = checkpoint->iterations;
+    }
+  }
+  double current_merit = merit(graph, constraints, values);
+
+  // The sparsity pattern never changes, so order once.
+  auto start = Clock::now();
+  const GaussianFactorGraph first = subproblem(graph, constraints, values);
+  const gtsam::Ordering ordering = gtsam::Ordering::Colamd(first);
+  double linearize_seconds = SecondsSince(start);
+
+  // Each step decreases the merit function, so when out of time the current
+  // iterate is returned.
+  const Deadline deadline(p_.time_budget, p_.cancellation);
+  bool interrupted = false;
+  size_t iterations = 0;
+  for (size_t i = first_iteration; i < p_.num_iterations; i++) {
+    GTDYNAMICS_TRACE_SCOPE_ARG("SQP::iteration", i);
+    if (deadline.expired()) {
+      interrupted = true;
+      break;
+    }
+    IterationRecord record;
+    record.solve = solve;
+    record.iteration = ++iterations;
+    record.lambda = p_.lambda;
+    record.linear_solves = 1;
+
+    // Solve the QP subproblem with one sparse elimination.
+    start = Clock::now();
+    const GaussianFactorGraph qp =
+        i == first_iteration ? first : subproblem(graph, constraints, values);
+    record.linearize_seconds =
+        i == first_iteration ? linearize_seconds : SecondsSince(start);
+    start = Clock::now();
+    const VectorValues delta = qp.optimize(ordering, gtsam::EliminateQR);
+    record.solve_seconds = SecondsSince(start);
+
+    // Backtrack until the merit function does not increase.
+    start = Clock::now();
+    double alpha = 1.0;
+    Values next = values.retract(delta);
+    double next_merit = merit(graph, constraints, next);
+    for (size_t k = 0; k < p_.max_backtracks && next_merit > current_merit;
+         k++) {
+      alpha *= 0.5;
+      next = values.retract(alpha * delta);
+      next_merit = merit(graph, constraints, next);
+    }
+    if (next_merit > current_merit) {
+      // No step length decreases the merit function, so keep the current
+      // iterate and stop rather than accept a worse one.
+      alpha = 0.0;
+    } else {
+      values = next;
+      current_merit = next_merit;
+    }
+    record.update_seconds = SecondsSince(start);
+
+    if (p_.telemetry) {
+      record.step_norm = alpha * delta.norm();
+      record.violation =
+          EvaluateConstraints(constraints, values, p_.num_threads,
+                              p_.deterministic)
+              .violationNorm();
+      record.error = current_merit - p_.merit_weight * record.violation;
+      p_.telemetry->record(record);
+    }
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      auto evaluation =
+          EvaluateConstraints(constraints, values, p_.num_threads,
+                              p_.deterministic);
+      intermediate_result->record(values, 1, p_.merit_weight,
+                                  evaluation.violationNorm(),
+                                  evaluation.max_violation);
+    }
+
+    if (p_.checkpoint && p_.checkpoint->due()) {
+      OptimizerCheckpoint checkpoint;
+      checkpoint.solver = CheckpointSolver::SQP;
+      checkpoint.values = values;
+      checkpoint.iterations = i + 1;
+      p_.checkpoint->save(checkpoint, true);
+    }
+
+    if (alpha == 0.0 ||
+        alpha * delta.vector().lpNorm<Eigen::Infinity>() < p_.step_tolerance)
+      break;
+  }
+
+  if (p_.telemetry) {
+    SolveRecord record;
+    record.solve = solve;
+    record.iterations = iterations;
+    record.initial_error = graph.error(initial_values);
+    record.seconds = SecondsSince(solve_start);
+    record.mu = p_.merit_weight;
+    record.violation =
+        EvaluateConstraints(constraints, values, p_.num_threads,
+                            p_.deterministic)
+            .violationNorm();
+    record.error = current_merit - p_.merit_weight * record.violation;
+    record.interrupted = interrupted;
+    p_.telemetry->record(record);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
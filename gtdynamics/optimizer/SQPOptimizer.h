@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.h
+ * @brief Sequential quadratic programming for equality constrained problems.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+namespace gtdynamics {
+
+/// Parameters for sequential quadratic programming.
+struct SQPParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t num_iterations;  // maximum number of QP subproblems
+  double step_tolerance;  // stop when the largest step entry is below this
+  double merit_weight;    // weight of scaled violation norm in merit function
+  double lambda;          // damping on the cost, keeps QPs well-posed
+  size_t max_backtracks;  // step halvings before the step is rejected
+
+  SQPParameters()
+      : Base(gtsam::LevenbergMarquardtParams()),
+        num_iterations(50),
+        step_tolerance(1e-8),
+        merit_weight(10.0),
+        lambda(1e-6),
+        max_backtracks(20) {}
+
+  SQPParameters(const gtsam::LevenbergMarquardtParams& _lm_parameters,
+                const size_t& _num_iterations = 50)
+      : Base(_lm_parameters),
+        num_iterations(_num_iterations),
+        step_tolerance(1e-8),
+        merit_weight(10.0),
+        lambda(1e-6),
+        max_backtracks(20) {}
+};
+
+/**
+ * Sequential quadratic programming (Gauss-Newton SQP) only considering
+ * equality constraints.
+ *
+ * Each iteration solves the equality constrained least-squares problem
+ *   min ||A dx - b||^2 + lambda ||dx||^2  s.t.  g(x) + J dx = 0,
+ * where A, b is the linearized cost. Constraints enter as hard (constrained
+ * noise model) Jacobian factors, so the KKT system is solved by sparse
+ * QR elimination of a single Gaussian factor graph, which keeps the
+ * block-banded time structure of trajectory problems. The step is then
+ * scaled back until the merit function cost + w * ||g(x)/tolerance|| does
+ * not increase; if no step within max_backtracks halvings achieves that, the
+ * step is rejected and the current iterate returned.
+ */
+class SQPOptimizer : public ConstrainedOptimizer {
+ protected:
+  const SQPParameters p_;
+
+  /// Cost plus weighted tolerance-scaled constraint violation.
+  double merit(const gtsam::NonlinearFactorGraph& graph,
+               const EqualityConstraints& constraints,
+               const gtsam::Values& values) const;
+
+ public:
+  /// Default constructor.
+  SQPOptimizer() : p_(SQPParameters()) {}
+
+  /// Construct from parameters.
+  SQPOptimizer(const SQPParameters& parameters) : p_(parameters) {}
+
+  /// Linearize cost and constraints into the QP subproblem at values.
+  gtsam::GaussianFactorGraph subproblem(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& values) const;
+
+  /// Run optimization.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollision.cpp
+ * @brief Self-collision avoidance with a broadphase over link spheres.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/factors/SphereSeparationFactor.h>
+#include <gtdynamics/optimizer/SelfCollision.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace {
+// Spheres of one link in the world frame, and a box bounding them.
+struct LinkBounds {
+  uint16_t link_id;
+  const std::vector<size_t> *spheres;
+  std::vector<Point3> centers;
+  gtsam::Vector3 lo, hi;
+};
+
+std::pair<uint16_t, uint16_t> LinkPair(uint16_t a, uint16_t b) {
+  return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+}  // namespace
+
+/* ************************************************************************* */
+SelfCollision::SelfCollision(const Robot &robot,
+                             const std::vector<CollisionSphere> &spheres,
+                             const gtsam::SharedNoiseModel &cost_model,
+                             double epsilon, double margin)
+    : spheres_(spheres),
+      cost_model_(cost_model),
+      epsilon_(epsilon),
+      margin_(margin) {
+  for (size_t i = 0; i < spheres_.size(); i++) {
+    link_spheres_[spheres_[i].link_id].push_back(i);
+  }
+  for (auto &&joint : robot.joints()) {
+    exclude(joint->parent()->id(), joint->child()->id());
+  }
+}
+
+/* ************************************************************************* */
+std::vector<CollisionSphere> SelfCollision::LinkSpheres(
+    const Robot &robot, const std::string &link_name,
+    const std::vector<Point3> &centers, double radius) {
+  const uint16_t id = robot.link(link_name)->id();
+  std::vector<CollisionSphere> spheres;
+  for (const Point3 &comPc : centers) spheres.push_back({id, comPc, radius});
+  return spheres;
+}
+
+/* ************************************************************************* */
+void SelfCollision::exclude(uint16_t link_a, uint16_t link_b) {
+  excluded_.insert(LinkPair(link_a, link_b));
+}
+
+bool SelfCollision::checked(uint16_t link_a, uint16_t link_b) const {
+  return link_a != link_b && !excluded_.count(LinkPair(link_a, link_b));
+}
+
+/* ************************************************************************* */
+size_t SelfCollision::numCandidatePairs() const {
+  size_t count = 0;
+  for (auto a = link_spheres_.begin(); a != link_spheres_.end(); ++a) {
+    for (auto b = std::next(a); b != link_spheres_.end(); ++b) {
+      if (checked(a->first, b->first)) {
+        count += a->second.size() * b->second.size();
+      }
+    }
+  }
+  return count;
+}
+
+/* ************************************************************************* */
+std::vector<SelfCollision::Pair> SelfCollision::nearPairs(const Values &values,
+                                                          size_t k) const {
+  // Bound the spheres of every link, inflated so that boxes overlap when
+  // spheres may be near.
+  const double inflation = 0.5 * (epsilon_ + margin_);
+  std::vector<LinkBounds> bounds;
+  for (auto &&entry : link_spheres_) {
+    const gtsam::Key key = PoseKey(entry.first, k);
+    if (!values.exists(key)) continue;
+    const Pose3 &wTl = values.at<Pose3>(key);
+    LinkBounds link{entry.first, &entry.second, {}, {}, {}};
+    link.lo.setConstant(std::numeric_limits<double>::infinity());
+    link.hi.setConstant(-std::numeric_limits<double>::infinity());
+    for (size_t i : entry.second) {
+      const Point3 center = wTl.transformFrom(spheres_[i].comPc);
+      const double r = spheres_[i].radius + inflation;
+      link.lo = link.lo.cwiseMin(center - gtsam::Vector3::Constant(r));
+      link.hi = link.hi.cwiseMax(center + gtsam::Vector3::Constant(r));
+      link.centers.push_back(center);
+    }
+    bounds.push_back(link);
+  }
+
+  // Sweep and prune along x, then compare the spheres of overlapping links.
+  std::sort(bounds.begin(), bounds.end(),
+            [](const LinkBounds &a, const LinkBounds &b) {
+              return a.lo.x() < b.lo.x();
+            });
+  std::vector<Pair> pairs;
+  for (size_t u = 0; u < bounds.size(); u++) {
+    const LinkBounds &a = bounds[u];
+    for (size_t v = u + 1; v < bounds.size() && bounds[v].lo.x() <= a.hi.x();
+         v++) {
+      const LinkBounds &b = bounds[v];
+      if (b.lo.y() > a.hi.y() || b.hi.y() < a.lo.y() ||
+          b.lo.z() > a.hi.z() || b.hi.z() < a.lo.z() ||
+          !checked(a.link_id, b.link_id)) {
+        continue;
+      }
+      for (size_t i = 0; i < a.centers.size(); i++) {
+        for (size_t j = 0; j < b.centers.size(); j++) {
+          const size_t sa = (*a.spheres)[i], sb = (*b.spheres)[j];
+          const double near = spheres_[sa].radius + spheres_[sb].radius +
+                              epsilon_ + margin_;
+          if ((a.centers[i] - b.centers[j]).norm() < near) {
+            pairs.push_back({std::min(sa, sb), std::max(sa, sb), k});
+          }
+        }
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+std::vector<SelfCollision::Pair> SelfCollision::nearPairs(
+    const Values &values, const std::vector<size_t> &times) const {
+  std::vector<Pair> pairs;
+  for (size_t k : times) {
+    const std::vector<Pair> near = nearPairs(values, k);
+    pairs.insert(pairs.end(), near.begin(), near.end());
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph SelfCollision::factors(
+    const std::vector<Pair> &pairs) const {
+  gtsam::NonlinearFactorGraph graph;
+  for (const Pair &pair : pairs) {
+    const CollisionSphere &a = spheres_[pair.a], &b = spheres_[pair.b];
+    graph.emplace_shared<SphereSeparationFactor>(
+        PoseKey(a.link_id, pair.k), a.comPc, PoseKey(b.link_id, pair.k),
+        b.comPc, a.radius + b.radius + epsilon_, cost_model_);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values SelfCollisionOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph &graph, const Values &initial_values,
+    const std::vector<size_t> &times,
+    std::vector<SelfCollision::Pair> *pairs) const {
+  // Rounds optionally stop after a few LM iterations, to update the pairs.
+  OptimizationParameters round_parameters = sc_p_;
+  if (sc_p_.iterations_per_round > 0) {
+    round_parameters.lm_parameters.maxIterations = sc_p_.iterations_per_round;
+  }
+  const Optimizer round_optimizer(round_parameters);
+
+  Values values = initial_values;
+  std::vector<SelfCollision::Pair> active;
+  for (size_t round = 0; round < sc_p_.max_rounds; round++) {
+    std::vector<SelfCollision::Pair> near = collision_.nearPairs(values, times);
+    const bool converged = round > 0 && near == active;
+    // Finish the solve with the final pairs, unless it already finished.
+    if (converged && sc_p_.iterations_per_round == 0) break;
+    active = near;
+    gtsam::NonlinearFactorGraph full = graph;
+    full.add(collision_.factors(active));
+    if (converged) {
+      values = Optimizer::optimize(full, values);
+      break;
+    }
+    values = round_optimizer.optimize(full, values);
+  }
+  if (pairs) *pairs = active;
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollision.h
+ * @brief Self-collision avoidance with a broadphase over link spheres.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// A sphere on a link, e.g. one of its sphereCenters.
+struct CollisionSphere {
+  uint16_t link_id;     // id of the link
+  gtsam::Point3 comPc;  // center in the link CoM frame
+  double radius;
+};
+
+/**
+ * SelfCollision finds the pairs of spheres on different links that are
+ * close at a configuration, so that only those pairs get a
+ * SphereSeparationFactor instead of all pairs at every time step.
+ *
+ * The broadphase bounds the spheres of every link with an axis-aligned box,
+ * inflated by half of epsilon plus margin, and sweeps the boxes along x;
+ * only the spheres of links with overlapping boxes are compared. Pairs are
+ * near when their spheres are closer than epsilon plus margin, so that a
+ * margin keeps pairs that are about to collide in the graph.
+ *
+ * Links connected by a joint are excluded, as are pairs added with exclude.
+ */
+class SelfCollision {
+ public:
+  /// Near sphere pair, by index in spheres(), at time step k.
+  struct Pair {
+    size_t a, b, k;
+    bool operator==(const Pair &other) const {
+      return a == other.a && b == other.b && k == other.k;
+    }
+    bool operator<(const Pair &other) const {
+      return std::tie(k, a, b) < std::tie(other.k, other.a, other.b);
+    }
+  };
+
+ private:
+  std::vector<CollisionSphere> spheres_;
+  std::map<uint16_t, std::vector<size_t>> link_spheres_;  // sphere indices
+  std::set<std::pair<uint16_t, uint16_t>> excluded_;
+  gtsam::SharedNoiseModel cost_model_;
+  double epsilon_, margin_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot      the robot, whose joints give links not to check
+   * @param spheres    spheres on its links
+   * @param cost_model 1-dimensional noise model of the factors
+   * @param epsilon    clearance between spheres
+   * @param margin     extra distance at which pairs are considered near
+   */
+  SelfCollision(const Robot &robot, const std::vector<CollisionSphere> &spheres,
+                const gtsam::SharedNoiseModel &cost_model, double epsilon,
+                double margin = 0.0);
+
+  /// Spheres on a link, with centers e.g. from sphereCenters.
+  static std::vector<CollisionSphere> LinkSpheres(
+      const Robot &robot, const std::string &link_name,
+      const std::vector<gtsam::Point3> &centers, double radius);
+
+  /// Do not check the spheres of two links against each other.
+  void exclude(uint16_t link_a, uint16_t link_b);
+
+  /// Whether the spheres of two links are checked.
+  bool checked(uint16_t link_a, uint16_t link_b) const;
+
+  /// Number of sphere pairs checked per time step without a broadphase.
+  size_t numCandidatePairs() const;
+
+  /// Near pairs at step k, sorted; links without a pose at k are skipped.
+  std::vector<Pair> nearPairs(const gtsam::Values &values, size_t k) const;
+
+  /// Near pairs at all the steps, sorted.
+  std::vector<Pair> nearPairs(const gtsam::Values &values,
+                              const std::vector<size_t> &times) const;
+
+  /// A SphereSeparationFactor for each pair.
+  gtsam::NonlinearFactorGraph factors(const std::vector<Pair> &pairs) const;
+
+  const std::vector<CollisionSphere> &spheres() const { return spheres_; }
+  double epsilon() const { return epsilon_; }
+  double margin() const { return margin_; }
+};
+
+/// Parameters for the self-collision optimizer.
+struct SelfCollisionParameters : public OptimizationParameters {
+  size_t max_rounds = 10;  // maximum number of broadphase updates
+  // LM iterations between broadphase updates, 0 to solve to convergence.
+  size_t iterations_per_round = 0;
+};
+
+/**
+ * SelfCollisionOptimizer solves with the separation factors of the near
+ * pairs only: it alternates LM with a broadphase update of the near pairs
+ * at the current iterate, until they no longer change.
+ */
+class SelfCollisionOptimizer : public Optimizer {
+ protected:
+  const SelfCollision collision_;
+  const SelfCollisionParameters sc_p_;
+
+ public:
+  /// Constructor.
+  explicit SelfCollisionOptimizer(
+      const SelfCollision &collision,
+      const SelfCollisionParameters &parameters = SelfCollisionParameters())
+      : Optimizer(parameters), collision_(collision), sc_p_(parameters) {}
+
+  using Optimizer::optimize;
+
+  /**
+   * Optimize with self-collision avoidance at the given time steps.
+   * @param graph          factors without self-collision avoidance
+   * @param initial_values initial values, with link poses at the steps
+   * @param times          time steps to check
+   * @param pairs          (optional) near pairs at the last round
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         const std::vector<size_t> &times,
+                         std::vector<SelfCollision::Pair> *pairs =
+                             nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Sensitivity.cpp
+ * @brief Sensitivity of optimal trajectories to parameters, by implicit
+ * differentiation.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/Sensitivity.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace gtdynamics {
+
+const Key OptimumSensitivity::kParameterKey = std::numeric_limits<Key>::max();
+
+namespace {
+// The Jacobian factor of a linearized factor, throws for other factors.
+const JacobianFactor &AsJacobian(const gtsam::GaussianFactor &factor) {
+  auto jacobian = dynamic_cast<const JacobianFactor *>(&factor);
+  if (!jacobian) {
+    throw std::invalid_argument(
+        "OptimumSensitivity: factors must linearize to JacobianFactors");
+  }
+  return *jacobian;
+}
+}  // namespace
+
+/* ************************************************************************* */
+void OptimumSensitivity::eliminate(const GaussianFactorGraph &linear) {
+  const gtsam::KeySet keys = linear.keys();
+  gtsam::KeyVector last;
+  for (auto &&kv : parameter_dims_) {
+    if (!keys.count(kv.first)) {
+      throw std::invalid_argument(
+          "OptimumSensitivity: a parameter is not in the graph");
+    }
+    last.push_back(kv.first);
+  }
+
+  // Eliminate the variables with the parameters as parents.
+  ordering_ = gtsam::Ordering::ColamdConstrainedLast(linear, last);
+  ordering_.resize(ordering_.size() - last.size());
+  bayes_net_ = linear.eliminatePartialSequential(ordering_).first;
+
+  VectorValues zero;
+  for (auto &&kv : parameter_dims_) {
+    zero.insert(kv.first, Vector::Zero(kv.second));
+  }
+  offset_ = bayes_net_->optimize(zero);
+}
+
+/* ************************************************************************* */
+OptimumSensitivity::OptimumSensitivity(const gtsam::NonlinearFactorGraph &graph,
+                                       const gtsam::Values &optimum,
+                                       const gtsam::KeyVector &parameter_keys) {
+  for (Key key : parameter_keys) parameter_dims_[key] = optimum.at(key).dim();
+  eliminate(*graph.linearize(optimum));
+}
+
+/* ************************************************************************* */
+OptimumSensitivity::OptimumSensitivity(const GraphBuilder &builder,
+                                       const Vector &parameters,
+                                       const gtsam::Values &optimum,
+                                       double step) {
+  const auto linear = builder(parameters).linearize(optimum);
+  const size_t num_factors = linear->size(), p = parameters.size();
+
+  // Derivatives of the whitened residuals, r = -b, by central differences.
+  std::vector<Matrix> columns(num_factors);
+  for (size_t i = 0; i < num_factors; i++) {
+    if (linear->at(i)) {
+      columns[i] = Matrix::Zero(AsJacobian(*linear->at(i)).rows(), p);
+    }
+  }
+  for (size_t k = 0; k < p; k++) {
+    Vector plus = parameters, minus = parameters;
+    plus(k) += step;
+    minus(k) -= step;
+    const auto linear_plus = builder(plus).linearize(optimum),
+               linear_minus = builder(minus).linearize(optimum);
+    if (linear_plus->size() != num_factors ||
+        linear_minus->size() != num_factors) {
+      throw std::invalid_argument(
+          "OptimumSensitivity: the graph structure depends on the parameters");
+    }
+    for (size_t i = 0; i < num_factors; i++) {
+      if (!linear->at(i)) continue;
+      columns[i].col(k) = (AsJacobian(*linear_minus->at(i)).getb() -
+                           AsJacobian(*linear_plus->at(i)).getb()) /
+                          (2 * step);
+    }
+  }
+
+  // The linearized graph, with the parameters as one more variable.
+  GaussianFactorGraph augmented;
+  for (size_t i = 0; i < num_factors; i++) {
+    if (!linear->at(i)) continue;
+    const JacobianFactor &factor = AsJacobian(*linear->at(i));
+    std::vector<std::pair<Key, Matrix>> terms;
+    for (auto it = factor.begin(); it != factor.end(); ++it) {
+      terms.emplace_back(*it, factor.getA(it));
+    }
+    terms.emplace_back(kParameterKey, columns[i]);
+    augmented.emplace_shared<JacobianFactor>(terms, factor.getb(),
+                                             factor.get_model());
+  }
+  parameter_dims_[kParameterKey] = p;
+  eliminate(augmented);
+}
+
+/* ************************************************************************* */
+VectorValues OptimumSensitivity::solve(const VectorValues &direction) const {
+  VectorValues given;
+  for (auto &&kv : parameter_dims_) {
+    if (!direction.exists(kv.first)) {
+      given.insert(kv.first, Vector::Zero(kv.second));
+    } else if (size_t(direction.at(kv.first).size()) != kv.second) {
+      throw std::invalid_argument(
+          "OptimumSensitivity: direction has the wrong dimension");
+    } else {
+      given.insert(kv.first, direction.at(kv.first));
+    }
+  }
+  const VectorValues x = bayes_net_->optimize(given);
+  VectorValues dx;
+  for (Key key : ordering_) dx.insert(key, x.at(key) - offset_.at(key));
+  return dx;
+}
+
+/* ************************************************************************* */
+Matrix OptimumSensitivity::jacobian(Key variable, Key parameter) const {
+  const size_t p = parameter_dims_.at(parameter);
+  Matrix J;
+  for (size_t k = 0; k < p; k++) {
+    VectorValues direction;
+    direction.insert(parameter, Vector::Unit(p, k));
+    const Vector dx = solve(direction).at(variable);
+    if (k == 0) J = Matrix(dx.size(), p);
+    J.col(k) = dx;
+  }
+  return J;
+}
+
+}  // namespace gtdynamics
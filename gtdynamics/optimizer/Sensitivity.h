@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Sensitivity.h
+ * @brief Sensitivity of optimal trajectories to parameters, by implicit
+ * differentiation.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * OptimumSensitivity gives the derivative of the optimum x* of a factor
+ * graph with respect to parameters theta, without re-solving.
+ *
+ * The graph is linearized once at the optimum, and its variables are
+ * eliminated with the parameters last, which gives the conditional
+ * x = R^-1 (d - S dtheta) of the Gauss-Newton step. Every parameter direction
+ * then costs one back-substitution. Like Gauss-Newton, this neglects the
+ * second derivatives of the residuals, so it is exact for zero-residual
+ * optima and linear factors, and a good approximation otherwise.
+ *
+ * Parameters are either variables of the graph, e.g. goal poses, that the
+ * optimizer was not allowed to change, or the argument of a function that
+ * builds the graph, e.g. from link masses or actuator parameters, whose
+ * residuals are differentiated numerically without re-solving.
+ *
+ * Example:
+ *   Values optimum = optimizer.optimize(graph, init);  // goal_key fixed
+ *   OptimumSensitivity sensitivity(graph, optimum, {goal_key});
+ *   Matrix dq_dgoal = sensitivity.jacobian(JointAngleKey(j, T), goal_key);
+ */
+class OptimumSensitivity {
+ public:
+  /// Builds the factor graph for a vector of parameters.
+  using GraphBuilder =
+      std::function<gtsam::NonlinearFactorGraph(const gtsam::Vector &)>;
+
+  /// Key of the parameter vector of a GraphBuilder in jacobian and solve.
+  static const gtsam::Key kParameterKey;
+
+ private:
+  gtsam::Ordering ordering_;  // the eliminated variables
+  std::map<gtsam::Key, size_t> parameter_dims_;
+  gtsam::GaussianBayesNet::shared_ptr bayes_net_;
+  gtsam::VectorValues offset_;  // back-substitution without parameter change
+
+  /// Eliminate all variables but the parameters.
+  void eliminate(const gtsam::GaussianFactorGraph &linear);
+
+ public:
+  /**
+   * Sensitivity to variables of the graph.
+   * @param graph          the factor graph
+   * @param optimum        optimum of the graph with the parameters held fixed
+   * @param parameter_keys variables in optimum that are parameters
+   */
+  OptimumSensitivity(const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &optimum,
+                     const gtsam::KeyVector &parameter_keys);
+
+  /**
+   * Sensitivity to the parameters of a graph builder. The graphs for all
+   * parameters must have the same factors on the same keys.
+   * @param builder    builds the graph for given parameters
+   * @param parameters parameters the optimum was found for
+   * @param optimum    optimum of builder(parameters)
+   * @param step       step of the central differences of the residuals
+   */
+  OptimumSensitivity(const GraphBuilder &builder,
+                     const gtsam::Vector &parameters,
+                     const gtsam::Values &optimum, double step = 1e-6);
+
+  /// The eliminated variables, i.e. all variables but the parameters.
+  const gtsam::Ordering &variables() const { return ordering_; }
+
+  /**
+   * First-order change of the optimum for a change of the parameters.
+   * @param direction change of every parameter key, in its tangent space
+   * @return change of every variable, in its tangent space
+   */
+  gtsam::VectorValues solve(const gtsam::VectorValues &direction) const;
+
+  /// Derivative of a variable with respect to a parameter, dim(variable) x
+  /// dim(parameter), with one back-substitution per parameter dimension.
+  gtsam::Matrix jacobian(gtsam::Key variable, gtsam::Key parameter) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,361 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolutionCache.cpp
+ * @brief Persistent cache of the solutions of repeated planning queries.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/SolutionCache.h>
+#include <gtdynamics/optimizer/PcgSolver.h>
+#include <gtdynamics/optimizer/TimeOrdering.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Values;
+
+namespace {
+/// First line of the index file.
+const char kIndexHeader[] = "gtdynamics-solution-cache 1";
+
+PlanningQueryHash &AddPoints(const PointOnLinks &points,
+                             PlanningQueryHash *hash) {
+  hash->add(static_cast<uint64_t>(points.size()));
+  for (auto &&point : points) {
+    hash->add(point.link->name()).add(gtsam::Vector(point.point));
+  }
+  return *hash;
+}
+}  // namespace
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::bytes(const void *data, size_t size) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash_ ^= p[i];
+    hash_ *= 1099511628211ull;
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(double x) {
+  if (x == 0.0) x = 0.0;  // -0 and 0 hash alike
+  return bytes(&x, sizeof(x));
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(uint64_t x) {
+  return bytes(&x, sizeof(x));
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const std::string &s) {
+  add(static_cast<uint64_t>(s.size()));
+  return bytes(s.data(), s.size());
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const gtsam::Vector &v) {
+  add(static_cast<uint64_t>(v.size()));
+  for (int i = 0; i < v.size(); i++) add(v(i));
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const gtsam::Pose3 &pose) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  add(gtsam::Vector(Eigen::Map<const gtsam::Vector9>(R.data())));
+  return add(gtsam::Vector(pose.translation()));
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const Robot &robot) {
+  add(static_cast<uint64_t>(robot.numLinks()));
+  for (auto &&link : robot.links()) {
+    add(link->name()).add(static_cast<uint64_t>(link->id()));
+    add(link->mass()).add(link->bMcom()).add(link->bMlink());
+    const gtsam::Matrix3 &I = link->inertia();
+    add(gtsam::Vector(Eigen::Map<const gtsam::Vector9>(I.data())));
+    add(static_cast<uint64_t>(link->isFixed())).add(link->getFixedPose());
+  }
+  add(static_cast<uint64_t>(robot.numJoints()));
+  for (auto &&joint : robot.joints()) {
+    add(joint->name()).add(static_cast<uint64_t>(joint->id()));
+    add(static_cast<uint64_t>(joint->type()));
+    add(joint->parent()->name()).add(joint->child()->name());
+    add(joint->jMp()).add(joint->jMc());
+    add(gtsam::Vector(joint->cScrewAxis()));
+    const JointParams &p = joint->parameters();
+    add(static_cast<uint64_t>(p.effort_type));
+    add(p.scalar_limits.value_lower_limit);
+    add(p.scalar_limits.value_upper_limit);
+    add(p.scalar_limits.value_limit_threshold);
+    for (double x : {p.velocity_limit, p.velocity_limit_threshold,
+                     p.acceleration_limit, p.acceleration_limit_threshold,
+                     p.torque_limit, p.torque_limit_threshold,
+                     p.damping_coefficient, p.spring_coefficient}) {
+      add(x);
+    }
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const WalkCycle &walk_cycle) {
+  add(static_cast<uint64_t>(walk_cycle.numPhases()));
+  for (size_t p = 0; p < walk_cycle.numPhases(); p++) {
+    add(static_cast<uint64_t>(walk_cycle.phase(p).numTimeSteps()));
+    AddPoints(walk_cycle.getPhaseContactPoints(p), this);
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const Trajectory &trajectory) {
+  const std::vector<int> durations = trajectory.phaseDurations();
+  add(static_cast<uint64_t>(durations.size()));
+  for (size_t p = 0; p < durations.size(); p++) {
+    add(static_cast<uint64_t>(durations[p]));
+    AddPoints(trajectory.phaseContactPoints()[p], this);
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(const ContactGoals &contact_goals) {
+  add(static_cast<uint64_t>(contact_goals.size()));
+  for (auto &&goal : contact_goals) {
+    add(goal.link()->name()).add(gtsam::Vector(goal.contactInCoM()));
+    add(gtsam::Vector(goal.goal_point));
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+PlanningQueryHash &PlanningQueryHash::add(
+    const OptimizationParameters &parameters) {
+  add(static_cast<uint64_t>(parameters.method));
+  const gtsam::LevenbergMarquardtParams &lm = parameters.lm_parameters;
+  add(static_cast<uint64_t>(lm.maxIterations));
+  for (double x : {lm.relativeErrorTol, lm.absoluteErrorTol, lm.errorTol,
+                   lm.lambdaInitial, lm.lambdaFactor, lm.lambdaUpperBound,
+                   lm.lambdaLowerBound, lm.minModelFidelity}) {
+    add(x);
+  }
+  add(static_cast<uint64_t>(lm.diagonalDamping));
+  add(static_cast<uint64_t>(lm.useFixedLambdaFactor));
+  add(static_cast<uint64_t>(parameters.num_isam2_updates));
+  add(static_cast<uint64_t>(
+      parameters.time_ordering
+          ? static_cast<int>(*parameters.time_ordering) + 1
+          : 0));
+  add(static_cast<uint64_t>(parameters.riccati_solver));
+  add(static_cast<uint64_t>(bool(parameters.pcg_solver)));
+  if (parameters.pcg_solver) {
+    add(static_cast<uint64_t>(parameters.pcg_solver->max_iterations));
+    add(parameters.pcg_solver->relative_tolerance);
+  }
+  add(parameters.relinearize_threshold ? *parameters.relinearize_threshold
+                                       : -1.0);
+  add(static_cast<uint64_t>(parameters.hessian_linearization));
+  return add(parameters.time_budget);
+}
+
+/* ************************************************************************* */
+SolutionCache::SolutionCache(const std::string &directory, size_t capacity,
+                             size_t memory_capacity)
+    : directory_(directory),
+      capacity_(capacity),
+      memory_capacity_(memory_capacity) {
+  if (capacity_ == 0)
+    throw std::invalid_argument("SolutionCache: capacity must be positive");
+  std::ifstream is(indexPath());
+  if (!is) return;
+  std::string line;
+  if (!std::getline(is, line) || line != kIndexHeader)
+    throw std::runtime_error("SolutionCache: " + indexPath() +
+                             " is not a solution cache index");
+  while (std::getline(is, line)) {
+    uint64_t query;
+    if (std::sscanf(line.c_str(), "%" SCNx64, &query) != 1 ||
+        index_.count(query)) {
+      continue;
+    }
+    entries_.push_back(Entry{query, boost::none});
+    index_[query] = std::prev(entries_.end());
+  }
+  while (entries_.size() > capacity_) erase(std::prev(entries_.end()));
+}
+
+/* ************************************************************************* */
+SolutionCache::~SolutionCache() {
+  try {
+    sync();
+  } catch (...) {
+  }
+}
+
+/* ************************************************************************* */
+std::string SolutionCache::path(uint64_t query) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016" PRIx64 ".traj", query);
+  return directory_ + "/" + name;
+}
+
+/* ************************************************************************* */
+std::string SolutionCache::indexPath() const {
+  return directory_ + "/solution_cache.index";
+}
+
+/* ************************************************************************* */
+boost::optional<Values> SolutionCache::find(uint64_t query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(query);
+  if (found == index_.end()) {
+    num_misses_++;
+    return boost::none;
+  }
+  const Iterator it = found->second;
+  Values solution;
+  if (it->solution) {
+    solution = *it->solution;
+  } else {
+    try {
+      solution = TrajectoryLog(path(query)).values();
+    } catch (const std::exception &) {
+      // The file was removed or is corrupt: forget the entry.
+      erase(it);
+      num_misses_++;
+      return boost::none;
+    }
+  }
+  use(it, solution);
+  num_hits_++;
+  return solution;
+}
+
+/* ************************************************************************* */
+void SolutionCache::insert(uint64_t query, const Values &solution) {
+  // Write to a temporary file and rename it, so that readers never see a
+  // partial log.
+  const std::string file_path = path(query);
+  const std::string tmp_path = file_path + ".tmp";
+  {
+    TrajectoryLogWriter writer(tmp_path);
+    writer.appendTrajectory(solution);
+    writer.close();
+  }
+  if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("SolutionCache: could not write " + file_path);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(query);
+  Iterator it;
+  if (found != index_.end()) {
+    it = found->second;
+  } else {
+    entries_.push_front(Entry{query, boost::none});
+    it = index_[query] = entries_.begin();
+  }
+  use(it, solution);
+  while (entries_.size() > capacity_) erase(std::prev(entries_.end()));
+  writeIndex();
+}
+
+/* ************************************************************************* */
+Values SolutionCache::findOrSolve(uint64_t query,
+                                  const std::function<Values()> &solve) {
+  if (auto stored = find(query)) return *stored;
+  const Values solution = solve();
+  insert(query, solution);
+  return solution;
+}
+
+/* ************************************************************************* */
+bool SolutionCache::contains(uint64_t query) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.count(query) > 0;
+}
+
+/* ************************************************************************* */
+void SolutionCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!entries_.empty()) erase(entries_.begin());
+  std::remove(indexPath().c_str());
+}
+
+/* ************************************************************************* */
+void SolutionCache::sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  writeIndex();
+}
+
+/* ************************************************************************* */
+size_t SolutionCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+/* ************************************************************************* */
+void SolutionCache::use(Iterator it, const Values &solution) {
+  entries_.splice(entries_.begin(), entries_, it);
+  if (memory_capacity_ == 0) return;
+  if (!it->solution) it->solution = solution;
+  in_memory_.remove(it->query);
+  in_memory_.push_front(it->query);
+  if (in_memory_.size() > memory_capacity_) {
+    index_.at(in_memory_.back())->solution = boost::none;
+    in_memory_.pop_back();
+  }
+}
+
+/* ************************************************************************* */
+void SolutionCache::erase(Iterator it) {
+  std::remove(path(it->query).c_str());
+  if (it->solution) in_memory_.remove(it->query);
+  index_.erase(it->query);
+  entries_.erase(it);
+}
+
+/* ************************************************************************* */
+void SolutionCache::writeIndex() const {
+  if (entries_.empty()) {
+    std::remove(indexPath().c_str());
+    return;
+  }
+  const std::string file_path = indexPath();
+  const std::string tmp_path = file_path + ".tmp";
+  {
+    std::ofstream os(tmp_path, std::ios::trunc);
+    os << kIndexHeader << "\n";
+    char line[32];
+    for (auto &&entry : entries_) {
+      std::snprintf(line, sizeof(line), "%016" PRIx64 "\n", entry.query);
+      os << line;
+    }
+    if (!os.good())
+      throw std::runtime_error("SolutionCache: could not write " + tmp_path);
+  }
+  if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("SolutionCache: could not write " + file_path);
+  }
+}
+
+}  // namespace gtdynamics
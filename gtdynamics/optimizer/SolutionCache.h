@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolutionCache.h
+ * @brief Persistent cache of the solutions of repeated planning queries.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/WalkCycle.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Stable hash of a planning query, to look up its solution in a
+ * SolutionCache: a 64-bit FNV-1a hash of everything added to it, in order.
+ * Numbers are hashed by their native-endian bytes, so like RobotCache files
+ * hashes are meant for machines with the same endianness.
+ *
+ *   const uint64_t query = PlanningQueryHash()
+ *                              .add(robot)
+ *                              .add(trajectory)
+ *                              .add(contact_goals)
+ *                              .add(parameters)
+ *                              .value();
+ */
+class PlanningQueryHash {
+ public:
+  /// Hash of nothing added yet.
+  PlanningQueryHash() {}
+
+  PlanningQueryHash &add(double x);
+  PlanningQueryHash &add(uint64_t x);
+  PlanningQueryHash &add(const std::string &s);
+  PlanningQueryHash &add(const gtsam::Vector &v);
+  PlanningQueryHash &add(const gtsam::Pose3 &pose);
+
+  /// The links and joints of a robot, with all their parameters.
+  PlanningQueryHash &add(const Robot &robot);
+
+  /// The phase lengths and contact points of a walk cycle.
+  PlanningQueryHash &add(const WalkCycle &walk_cycle);
+
+  /// The phase lengths and contact points of all phases of a trajectory.
+  PlanningQueryHash &add(const Trajectory &trajectory);
+
+  /// The contact points and their goals.
+  PlanningQueryHash &add(const ContactGoals &contact_goals);
+
+  /// The method, LM parameters and options that change a solution.
+  PlanningQueryHash &add(const OptimizationParameters &parameters);
+
+  /// The hash.
+  uint64_t value() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 14695981039346656037ull;
+
+  PlanningQueryHash &bytes(const void *data, size_t size);
+};
+
+/**
+ * SolutionCache keeps the solutions of planning queries, keyed by a
+ * PlanningQueryHash, so that exact repeats of a query skip the solve. It is
+ * opt-in: a planner looks a query up before solving it, and inserts the
+ * solution after.
+ *
+ *   SolutionCache cache("/var/cache/planner");
+ *   const Values solution = cache.findOrSolve(query, [&] {
+ *     return optimizer.optimize(graph, init);
+ *   });
+ *
+ * Solutions are stored in a directory, one binary trajectory log per
+ * solution, see TrajectoryLog, so they persist across processes. The least
+ * recently used solution is evicted when there are more than capacity. The
+ * most recently used ones are also kept in memory, so those hits do not
+ * touch the disk. The order of use is written to an index file in the
+ * directory on every insert and when the cache is destroyed; a process
+ * that crashes loses the order of its hits, not its solutions. Lookups and
+ * inserts are thread-safe, but a directory must only be used by one cache
+ * at a time.
+ *
+ * Solutions may only hold double, Vector3, Vector6 and Pose3 variables,
+ * with keys from values.h, and read back exactly. Solves that depend on
+ * more than their query, e.g. with a time budget, should not be cached.
+ */
+class SolutionCache {
+ public:
+  /**
+   * Constructor, reads the index of the directory if there is one.
+   * @param directory       existing directory of the cache files
+   * @param capacity        maximum number of stored solutions
+   * @param memory_capacity maximum number of solutions kept in memory
+   */
+  explicit SolutionCache(const std::string &directory, size_t capacity = 256,
+                         size_t memory_capacity = 16);
+
+  /// Write the index.
+  ~SolutionCache();
+
+  SolutionCache(const SolutionCache &) = delete;
+  SolutionCache &operator=(const SolutionCache &) = delete;
+
+  /// The stored solution of a query, if there is one.
+  boost::optional<gtsam::Values> find(uint64_t query);
+
+  /**
+   * Store the solution of a query, replacing a stored one, and evict the
+   * least recently used solutions beyond capacity.
+   */
+  void insert(uint64_t query, const gtsam::Values &solution);
+
+  /// The stored solution of a query, or the result of solve, then stored.
+  gtsam::Values findOrSolve(uint64_t query,
+                            const std::function<gtsam::Values()> &solve);
+
+  /// Whether a solution of the query is stored, without using it.
+  bool contains(uint64_t query) const;
+
+  /// Remove all stored solutions and the index.
+  void clear();
+
+  /// Write the index, e.g. before the process may be killed.
+  void sync();
+
+  /// Number of stored solutions.
+  size_t size() const;
+
+  /// Maximum number of stored solutions.
+  size_t capacity() const { return capacity_; }
+
+  /// Number of lookups that found a stored solution.
+  size_t numHits() const { return num_hits_; }
+
+  /// Number of lookups that did not.
+  size_t numMisses() const { return num_misses_; }
+
+  /// Path of the file of a query.
+  std::string path(uint64_t query) const;
+
+ private:
+  struct Entry {
+    uint64_t query;
+    boost::optional<gtsam::Values> solution;  // if kept in memory
+  };
+  typedef std::list<Entry>::iterator Iterator;
+
+  std::string directory_;
+  size_t capacity_, memory_capacity_;
+  std::list<Entry> entries_;  // most recently used first
+  std::map<uint64_t, Iterator> index_;
+  std::list<uint64_t> in_memory_;  // most recently used first
+  size_t num_hits_ = 0, num_misses_ = 0;
+  mutable std::mutex mutex_;
+
+  /// Path of the index file.
+  std::string indexPath() const;
+
+  /// Move an entry to the front, and keep its solution in memory.
+  void use(Iterator it, const gtsam::Values &solution);
+
+  /// Remove an entry and its file.
+  void erase(Iterator it);
+
+  /// Write the index, with the mutex held.
+  void writeIndex() const;
+};
+
+}  // namespace gtdynamics
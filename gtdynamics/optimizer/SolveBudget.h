@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolveBudget.h
+ * @brief Wall-clock deadlines, cancellation and anytime results of solves.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/Values.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace gtdynamics {
+
+/**
+ * Flag to stop solves from another thread, e.g. when a newer state estimate
+ * arrives. Solves check it between iterations, so they stop at the end of
+ * the iteration in progress.
+ */
+class CancellationToken {
+ public:
+  CancellationToken() : cancelled_(false) {}
+
+  /// Ask all solves using the token to stop.
+  void cancel() { cancelled_ = true; }
+
+  /// Forget an earlier cancel, e.g. to reuse the token for the next solve.
+  void reset() { cancelled_ = false; }
+
+  /// Whether cancel was called.
+  bool cancelled() const { return cancelled_; }
+
+ private:
+  std::atomic<bool> cancelled_;
+};
+
+/// The time a solve has to return by, and its cancellation token.
+class Deadline {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  /// No deadline.
+  Deadline() : time_(Clock::time_point::max()) {}
+
+  /**
+   * Constructor.
+   * @param seconds wall-clock budget from now, none if not positive
+   * @param token   cancellation token, none if null
+   */
+  explicit Deadline(double seconds,
+                    const std::shared_ptr<const CancellationToken> &token =
+                        nullptr)
+      : Deadline() {
+    token_ = token;
+    if (seconds > 0) time_ = After(seconds);
+  }
+
+  /// This deadline or the one seconds from now, whichever is earlier.
+  Deadline within(double seconds) const {
+    Deadline deadline = *this;
+    if (seconds > 0) deadline.time_ = std::min(time_, After(seconds));
+    return deadline;
+  }
+
+  /// Whether the deadline passed or the solve was cancelled.
+  bool expired() const {
+    return (token_ && token_->cancelled()) || Clock::now() >= time_;
+  }
+
+  /// Whether the deadline can expire at all.
+  bool bounded() const {
+    return token_ || time_ != Clock::time_point::max();
+  }
+
+ private:
+  Clock::time_point time_;
+  std::shared_ptr<const CancellationToken> token_;
+
+  static Clock::time_point After(double seconds) {
+    return Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(seconds));
+  }
+};
+
+/**
+ * Best iterate of a constrained solve, returned when it is interrupted: the
+ * lowest cost among feasible iterates, whose tolerance-scaled violations
+ * are all at most 1, or the lowest violation if none is feasible.
+ */
+class BestIterate {
+ public:
+  /**
+   * Consider an iterate.
+   * @param values        the iterate
+   * @param cost          its cost, e.g. the error of the unconstrained graph
+   * @param max_violation its largest tolerance-scaled constraint violation
+   */
+  void update(const gtsam::Values &values, double cost,
+              double max_violation) {
+    const bool feasible = max_violation <= 1.0;
+    const bool better =
+        empty_ ||
+        (feasible ? !feasible_ || cost < cost_
+                  : !feasible_ && max_violation < max_violation_);
+    if (!better) return;
+    empty_ = false;
+    feasible_ = feasible;
+    values_ = values;
+    cost_ = cost;
+    max_violation_ = max_violation;
+  }
+
+  /// Whether no iterate was considered.
+  bool empty() const { return empty_; }
+
+  /// Whether the best iterate is feasible.
+  bool feasible() const { return feasible_; }
+
+  /// The best iterate.
+  const gtsam::Values &values() const { return values_; }
+
+ private:
+  bool empty_ = true, feasible_ = false;
+  gtsam::Values values_;
+  double cost_ = 0, max_violation_ = 0;
+};
+
+}  // namespace gtdynamics
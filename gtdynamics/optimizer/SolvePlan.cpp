@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolvePlan.cpp
+ * @brief Symbolic analysis of a graph structure, reused across solves.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/SolvePlan.h>
+
+#include <boost/functional/hash.hpp>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+
+// Keys of every factor of graph, empty for null factors.
+static std::vector<gtsam::KeyVector> FactorKeys(
+    const NonlinearFactorGraph &graph) {
+  std::vector<gtsam::KeyVector> factor_keys;
+  factor_keys.reserve(graph.size());
+  for (const auto &factor : graph) {
+    factor_keys.push_back(factor ? factor->keys() : gtsam::KeyVector());
+  }
+  return factor_keys;
+}
+
+/* ************************************************************************* */
+size_t GraphStructureHash(const NonlinearFactorGraph &graph) {
+  size_t hash = graph.size();
+  for (const auto &factor : graph) {
+    if (!factor) {
+      boost::hash_combine(hash, 0);
+      continue;
+    }
+    boost::hash_combine(hash, factor->size());
+    boost::hash_range(hash, factor->begin(), factor->end());
+  }
+  return hash;
+}
+
+/* ************************************************************************* */
+SolvePlan::SolvePlan(const NonlinearFactorGraph &graph)
+    : SolvePlan(graph, gtsam::Ordering::Colamd(graph)) {}
+
+SolvePlan::SolvePlan(const NonlinearFactorGraph &graph,
+                     const gtsam::Ordering &ordering)
+    : hash_(GraphStructureHash(graph)),
+      factor_keys_(FactorKeys(graph)),
+      ordering_(ordering) {}
+
+bool SolvePlan::matches(const NonlinearFactorGraph &graph) const {
+  if (graph.size() != factor_keys_.size()) return false;
+  for (size_t i = 0; i < graph.size(); i++) {
+    const auto &factor = graph[i];
+    if (factor ? factor->keys() != factor_keys_[i]
+               : !factor_keys_[i].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+// Cached plan matching graph, or null; the caller holds the lock.
+static std::shared_ptr<const SolvePlan> Find(
+    const std::multimap<size_t, std::shared_ptr<const SolvePlan>> &plans,
+    size_t hash, const NonlinearFactorGraph &graph) {
+  auto range = plans.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->matches(graph)) return it->second;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const SolvePlan> SolvePlanCache::plan(
+    const NonlinearFactorGraph &graph) {
+  const size_t hash = GraphStructureHash(graph);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto cached = Find(plans_, hash, graph)) {
+      hits_++;
+      return cached;
+    }
+  }
+
+  // Compute the ordering outside the lock, so other structures can proceed,
+  // and keep the first plan if another thread computed one meanwhile.
+  auto plan = std::make_shared<const SolvePlan>(graph);
+  std::lock_guard<std::mutex> lock(mutex_);
+  misses_++;
+  if (auto cached = Find(plans_, hash, graph)) return cached;
+  plans_.emplace(hash, plan);
+  return plan;
+}
+
+size_t SolvePlanCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return plans_.size();
+}
+
+size_t SolvePlanCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t SolvePlanCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void SolvePlanCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  plans_.clear();
+  hits_ = misses_ = 0;
+}
+
+}  // namespace gtdynamics
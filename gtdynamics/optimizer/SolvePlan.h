@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolvePlan.h
+ * @brief Symbolic analysis of a graph structure, reused across solves.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Hash of the structure of a graph: the number of factors and the keys of
+ * each factor, in order. Graphs built the same way with different numbers,
+ * e.g. other goals or initial states, have the same structure.
+ */
+size_t GraphStructureHash(const gtsam::NonlinearFactorGraph &graph);
+
+/**
+ * SolvePlan holds the result of the symbolic analysis of a graph structure,
+ * the fill-reducing elimination ordering, so that it needs to be computed
+ * only once for graphs of the same structure.
+ */
+class SolvePlan {
+ private:
+  size_t hash_;
+  std::vector<gtsam::KeyVector> factor_keys_;
+  gtsam::Ordering ordering_;
+
+ public:
+  /// Plan for the structure of graph, with a COLAMD ordering.
+  explicit SolvePlan(const gtsam::NonlinearFactorGraph &graph);
+
+  /// Plan for the structure of graph, with the given ordering.
+  SolvePlan(const gtsam::NonlinearFactorGraph &graph,
+            const gtsam::Ordering &ordering);
+
+  /// Whether graph has the structure this plan was computed for.
+  bool matches(const gtsam::NonlinearFactorGraph &graph) const;
+
+  /// The structure hash, see GraphStructureHash.
+  size_t hash() const { return hash_; }
+
+  /// The elimination ordering.
+  const gtsam::Ordering &ordering() const { return ordering_; }
+};
+
+/**
+ * Thread-safe cache of solve plans by graph structure, shared by the solves
+ * of an MPC loop or a parameter sweep. The first graph of a structure pays
+ * for COLAMD; later ones only for hashing and comparing their keys.
+ */
+class SolvePlanCache {
+ private:
+  mutable std::mutex mutex_;
+  std::multimap<size_t, std::shared_ptr<const SolvePlan>> plans_;
+  size_t hits_ = 0, misses_ = 0;
+
+ public:
+  /// The plan for the structure of graph, computed if not cached yet.
+  std::shared_ptr<const SolvePlan> plan(
+      const gtsam::NonlinearFactorGraph &graph);
+
+  /// Number of cached plans.
+  size_t size() const;
+
+  /// Number of plan calls that found a cached plan.
+  size_t hits() const;
+
+  /// Number of plan calls that computed a new plan.
+  size_t misses() const;
+
+  /// Forget all plans and counts.
+  void clear();
+};
+
+}  // namespace gtdynamics
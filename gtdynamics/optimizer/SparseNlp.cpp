@@ -0,0 +1,210 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseNlp.cpp
+ * @brief Export of constrained trajectory problems to external NLP solvers,
+ * e.g. interior-point solvers such as IPOPT or Knitro.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/SparseNlp.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <stdexcept>
+#include <tuple>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+SparseNlp::SparseNlp(const gtsam::NonlinearFactorGraph &graph,
+                     const EqualityConstraints &equalities,
+                     const gtsam::Values &reference, size_t num_threads)
+    : reference_(reference), num_threads_(num_threads) {
+  for (auto &&key_value : reference_) {
+    offsets_[key_value.key] = num_variables_;
+    dims_[key_value.key] = key_value.value.dim();
+    num_variables_ += key_value.value.dim();
+  }
+
+  // Lower triangle of the Hessian: the entries of every pair of keys of a
+  // factor, shared by the factors on the same keys.
+  std::map<std::pair<size_t, size_t>, size_t> hessian_index;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    graph_.push_back(factor);
+    Block block;
+    block.columns = columns(factor->keys());
+    for (size_t j = 0; j < block.columns.size(); j++) {
+      for (size_t i = 0; i < block.columns.size(); i++) {
+        const auto entry = std::make_pair(block.columns[i], block.columns[j]);
+        if (entry.first < entry.second) continue;
+        auto it = hessian_index.emplace(entry, hessian_index.size()).first;
+        block.hessian.emplace_back(std::make_pair(i, j), it->second);
+      }
+    }
+    factor_blocks_.push_back(std::move(block));
+  }
+  hessian_structure_.resize(hessian_index.size());
+  for (auto &&entry_index : hessian_index) {
+    hessian_structure_[entry_index.second] = entry_index.first;
+  }
+
+  // Jacobian of the constraints: a dense block of rows per constraint.
+  for (auto &&constraint : equalities) {
+    auto factor = constraint->createFactor(1.0);
+    Block block;
+    block.columns = columns(factor->keys());
+    block.row = num_constraints_;
+    block.jacobian_offset = jacobian_structure_.size();
+    for (size_t r = 0; r < factor->dim(); r++) {
+      for (size_t column : block.columns) {
+        jacobian_structure_.emplace_back(num_constraints_ + r, column);
+      }
+    }
+    num_constraints_ += factor->dim();
+    constraint_factors_.push_back(factor);
+    constraint_blocks_.push_back(std::move(block));
+  }
+}
+
+/* ************************************************************************* */
+std::vector<size_t> SparseNlp::columns(const gtsam::KeyVector &keys) const {
+  std::vector<size_t> result;
+  for (Key key : keys) {
+    const auto offset = offsets_.find(key);
+    if (offset == offsets_.end()) {
+      throw std::invalid_argument(
+          "SparseNlp: a factor key is not in the reference values");
+    }
+    for (size_t i = 0; i < dims_.at(key); i++) {
+      result.push_back(offset->second + i);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::Values SparseNlp::values(const Vector &x) const {
+  if (size_t(x.size()) != num_variables_) {
+    throw std::invalid_argument("SparseNlp: x has the wrong dimension");
+  }
+  gtsam::VectorValues delta;
+  for (auto &&key_offset : offsets_) {
+    delta.insert(key_offset.first,
+                 Vector(x.segment(key_offset.second,
+                                  dims_.at(key_offset.first))));
+  }
+  return reference_.retract(delta);
+}
+
+/* ************************************************************************* */
+void SparseNlp::recenter(const Vector &x) {
+  reference_ = values(x);
+  linearization_ = Linearization();
+}
+
+/* ************************************************************************* */
+double SparseNlp::objective(const Vector &x) const {
+  const gtsam::Values v = values(x);
+  return ParallelReduce<double>(
+      graph_.size(), num_threads_, true, 0.0,
+      [&](size_t f) { return graph_[f]->error(v); },
+      [](const double &a, const double &b) { return a + b; });
+}
+
+/* ************************************************************************* */
+const SparseNlp::Linearization &SparseNlp::linearize(const Vector &x) const {
+  if (linearization_.x.size() == x.size() && linearization_.x == x) {
+    return linearization_;
+  }
+  const gtsam::Values v = values(x);
+  Linearization result;
+  result.A.resize(graph_.size());
+  result.b.resize(graph_.size());
+  ParallelFor(graph_.size(), num_threads_, [&](size_t f) {
+    std::tie(result.A[f], result.b[f]) = graph_[f]->linearize(v)->jacobian();
+  });
+  result.x = x;
+  linearization_ = std::move(result);
+  return linearization_;
+}
+
+/* ************************************************************************* */
+Vector SparseNlp::gradient(const Vector &x) const {
+  const Linearization &linear = linearize(x);
+  std::vector<Vector> gradients(graph_.size());
+  ParallelFor(graph_.size(), num_threads_, [&](size_t f) {
+    gradients[f] = -linear.A[f].transpose() * linear.b[f];
+  });
+  Vector g = Vector::Zero(num_variables_);
+  for (size_t f = 0; f < graph_.size(); f++) {
+    const std::vector<size_t> &columns = factor_blocks_[f].columns;
+    for (size_t j = 0; j < columns.size(); j++) {
+      g(columns[j]) += gradients[f](j);
+    }
+  }
+  return g;
+}
+
+/* ************************************************************************* */
+Vector SparseNlp::constraints(const Vector &x) const {
+  const gtsam::Values v = values(x);
+  Vector h(num_constraints_);
+  ParallelFor(constraint_factors_.size(), num_threads_, [&](size_t c) {
+    const auto &factor = constraint_factors_[c];
+    h.segment(constraint_blocks_[c].row, factor->dim()) =
+        factor->unwhitenedError(v);
+  });
+  return h;
+}
+
+/* ************************************************************************* */
+Vector SparseNlp::jacobianValues(const Vector &x) const {
+  const gtsam::Values v = values(x);
+  Vector nonzeros(jacobian_structure_.size());
+  ParallelFor(constraint_factors_.size(), num_threads_, [&](size_t c) {
+    const auto &factor = constraint_factors_[c];
+    std::vector<Matrix> H(factor->size());
+    factor->unwhitenedError(v, H);
+    // Row-major, in the order of jacobianStructure.
+    size_t k = constraint_blocks_[c].jacobian_offset;
+    for (size_t r = 0; r < factor->dim(); r++) {
+      for (const Matrix &Hi : H) {
+        for (int j = 0; j < Hi.cols(); j++) nonzeros(k++) = Hi(r, j);
+      }
+    }
+  });
+  return nonzeros;
+}
+
+/* ************************************************************************* */
+Vector SparseNlp::hessianValues(const Vector &x,
+                                double objective_factor) const {
+  const Linearization &linear = linearize(x);
+  std::vector<Matrix> hessians(graph_.size());
+  ParallelFor(graph_.size(), num_threads_, [&](size_t f) {
+    hessians[f] = linear.A[f].transpose() * linear.A[f];
+  });
+  // Factors may share nonzeros, so they are summed in order.
+  Vector nonzeros = Vector::Zero(hessian_structure_.size());
+  for (size_t f = 0; f < graph_.size(); f++) {
+    for (auto &&entry : factor_blocks_[f].hessian) {
+      nonzeros(entry.second) +=
+          hessians[f](entry.first.first, entry.first.second);
+    }
+  }
+  return objective_factor * nonzeros;
+}
+
+}  // namespace gtdynamics
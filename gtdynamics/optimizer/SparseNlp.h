@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseNlp.h
+ * @brief Export of constrained trajectory problems to external NLP solvers,
+ * e.g. interior-point solvers such as IPOPT or Knitro.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SparseNlp exposes the problem
+ *
+ *   minimize f(x) = error of a graph  subject to  h(x) = 0
+ *
+ * through the callbacks of sparse NLP solvers: objective, gradient,
+ * constraints, constraint Jacobian, and Hessian of the Lagrangian, with the
+ * sparsity patterns computed once from the keys of the factors and
+ * constraints. Everything is evaluated in parallel over factors.
+ *
+ * The variables x are the stacked local coordinates of a reference
+ * trajectory, in key order, so the values are reference.retract(x) and the
+ * initial point is x = 0. Derivatives are those of the local coordinates at
+ * retract(x): exact for vector-valued variables, and for Lie groups exact at
+ * x = 0, so for rotations recenter() at the solution of a solver run before
+ * restarting it.
+ *
+ * The Hessian is the Gauss-Newton one of the objective, J' J for the
+ * whitened Jacobian J of the factors, and leaves out the curvature of the
+ * constraints, as does SQPOptimizer.
+ *
+ * Evaluations at the same x share one linearization, as solvers ask for the
+ * gradient and the Hessian at the same point; calls may not be concurrent.
+ */
+class SparseNlp {
+ public:
+  /// (row, column) of every nonzero, in the order of the values.
+  typedef std::vector<std::pair<int, int>> Structure;
+
+  /**
+   * Constructor, computes the structure of the derivatives.
+   *
+   * @param graph       nonlinear cost
+   * @param equalities  constraints h(x) = 0
+   * @param reference   values at x = 0, giving every variable
+   * @param num_threads threads of the evaluations, 0 for all threads
+   */
+  SparseNlp(const gtsam::NonlinearFactorGraph &graph,
+            const EqualityConstraints &equalities,
+            const gtsam::Values &reference, size_t num_threads = 0);
+
+  size_t numVariables() const { return num_variables_; }
+  size_t numConstraints() const { return num_constraints_; }
+
+  /// First entry of x of every key.
+  const std::map<gtsam::Key, size_t> &offsets() const { return offsets_; }
+
+  /// The values of the reference trajectory.
+  const gtsam::Values &reference() const { return reference_; }
+
+  /// Values of a point, reference.retract(x).
+  gtsam::Values values(const gtsam::Vector &x) const;
+
+  /// Make the values of x the reference, so that they are at x = 0.
+  void recenter(const gtsam::Vector &x);
+
+  /// Objective f(x).
+  double objective(const gtsam::Vector &x) const;
+
+  /// Gradient of f at x.
+  gtsam::Vector gradient(const gtsam::Vector &x) const;
+
+  /// Constraints h(x), stacked in the order of the equalities.
+  gtsam::Vector constraints(const gtsam::Vector &x) const;
+
+  /// Nonzeros of the Jacobian of h, all entries of every constraint block.
+  const Structure &jacobianStructure() const { return jacobian_structure_; }
+
+  /// Values of the nonzeros of the Jacobian of h at x.
+  gtsam::Vector jacobianValues(const gtsam::Vector &x) const;
+
+  /// Nonzeros of the lower triangle of the Hessian, row >= column.
+  const Structure &hessianStructure() const { return hessian_structure_; }
+
+  /**
+   * Values of the nonzeros of the Gauss-Newton Hessian of the Lagrangian
+   * at x, scaled by the objective factor of interior-point solvers.
+   */
+  gtsam::Vector hessianValues(const gtsam::Vector &x,
+                              double objective_factor = 1.0) const;
+
+ private:
+  // A factor or constraint, with the entries of x of its stacked keys.
+  struct Block {
+    std::vector<size_t> columns;
+    // Hessian nonzero of entries (i, j) of the block with row >= column.
+    std::vector<std::pair<std::pair<size_t, size_t>, size_t>> hessian;
+    size_t row = 0;               // first constraint row
+    size_t jacobian_offset = 0;   // first Jacobian nonzero
+  };
+
+  // Whitened Jacobian [A b] of every factor, at the cached point.
+  struct Linearization {
+    gtsam::Vector x;
+    std::vector<gtsam::Matrix> A;
+    std::vector<gtsam::Vector> b;
+  };
+
+  gtsam::NonlinearFactorGraph graph_;
+  std::vector<gtsam::NoiseModelFactor::shared_ptr> constraint_factors_;
+  gtsam::Values reference_;
+  size_t num_threads_;
+  size_t num_variables_ = 0, num_constraints_ = 0;
+  std::map<gtsam::Key, size_t> offsets_, dims_;
+  std::vector<Block> factor_blocks_, constraint_blocks_;
+  Structure jacobian_structure_, hessian_structure_;
+  mutable Linearization linearization_;
+
+  /// Entries of x of stacked keys.
+  std::vector<size_t> columns(const gtsam::KeyVector &keys) const;
+
+  /// Linearization of the factors at x, computed if x changed.
+  const Linearization &linearize(const gtsam::Vector &x) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseQP.cpp
+ * @brief Export of linearized trajectory problems as sparse quadratic
+ * programs.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/SparseQP.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace {
+typedef Eigen::Triplet<double> Triplet;
+
+// Whitened rows of a factor, and its rows with zero sigma, unwhitened.
+void SplitRows(const gtsam::GaussianFactor &factor, Matrix *soft_A,
+               Vector *soft_b, Matrix *hard_A, Vector *hard_b) {
+  const auto *jacobian = dynamic_cast<const JacobianFactor *>(&factor);
+  gtsam::SharedDiagonal model;
+  if (jacobian) model = jacobian->get_model();
+  if (!model || !model->isConstrained()) {
+    std::tie(*soft_A, *soft_b) = factor.jacobian();
+    hard_A->resize(0, soft_A->cols());
+    hard_b->resize(0);
+    return;
+  }
+  const Matrix A = jacobian->getA();
+  const Vector b = jacobian->getb();
+  const Vector &sigmas = model->sigmas();
+  std::vector<int> soft, hard;
+  for (int i = 0; i < sigmas.size(); i++) {
+    (sigmas(i) == 0 ? hard : soft).push_back(i);
+  }
+  soft_A->resize(soft.size(), A.cols());
+  soft_b->resize(soft.size());
+  for (size_t k = 0; k < soft.size(); k++) {
+    soft_A->row(k) = A.row(soft[k]) / sigmas(soft[k]);
+    (*soft_b)(k) = b(soft[k]) / sigmas(soft[k]);
+  }
+  hard_A->resize(hard.size(), A.cols());
+  hard_b->resize(hard.size());
+  for (size_t k = 0; k < hard.size(); k++) {
+    hard_A->row(k) = A.row(hard[k]);
+    (*hard_b)(k) = b(hard[k]);
+  }
+}
+
+// Columns in the QP of the stacked variables of a factor.
+std::vector<int> Columns(const SparseQP &qp,
+                         const gtsam::GaussianFactor &factor) {
+  std::vector<int> columns;
+  for (Key key : factor.keys()) {
+    const size_t offset = qp.offsets.at(key), dim = qp.dims.at(key);
+    for (size_t i = 0; i < dim; i++) columns.push_back(offset + i);
+  }
+  return columns;
+}
+
+// Add the rows of a dense block of constraints.
+void AddRows(const std::vector<int> &columns, const Matrix &A,
+             const Vector &lower, const Vector &upper,
+             std::vector<Triplet> *triplets, std::vector<double> *l,
+             std::vector<double> *u) {
+  for (int i = 0; i < A.rows(); i++) {
+    const int row = l->size();
+    for (int j = 0; j < A.cols(); j++) {
+      if (A(i, j) != 0) triplets->emplace_back(row, columns[j], A(i, j));
+    }
+    l->push_back(lower(i));
+    u->push_back(upper(i));
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::VectorValues SparseQP::vectorValues(const Vector &x) const {
+  gtsam::VectorValues values;
+  for (auto &&key_offset : offsets) {
+    values.insert(key_offset.first,
+                  Vector(x.segment(key_offset.second,
+                                   dims.at(key_offset.first))));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Vector SparseQP::stack(const gtsam::VectorValues &values) const {
+  Vector x = Vector::Zero(numVariables());
+  for (auto &&key_offset : offsets) {
+    if (values.exists(key_offset.first)) {
+      x.segment(key_offset.second, dims.at(key_offset.first)) =
+          values.at(key_offset.first);
+    }
+  }
+  return x;
+}
+
+/* ************************************************************************* */
+SparseQP SparseQP::FromLinear(const GaussianFactorGraph &cost,
+                              const GaussianFactorGraph &inequalities) {
+  SparseQP qp;
+  for (const GaussianFactorGraph *graph : {&cost, &inequalities}) {
+    for (auto &&factor : *graph) {
+      if (!factor) continue;
+      for (auto it = factor->begin(); it != factor->end(); ++it) {
+        qp.dims[*it] = factor->getDim(it);
+      }
+    }
+  }
+  size_t n = 0;
+  for (auto &&key_dim : qp.dims) {
+    qp.offsets[key_dim.first] = n;
+    n += key_dim.second;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<Triplet> P_triplets, A_triplets;
+  std::vector<double> l, u;
+  qp.q = Vector::Zero(n);
+  for (auto &&factor : cost) {
+    if (!factor) continue;
+    Matrix soft_A, hard_A;
+    Vector soft_b, hard_b;
+    SplitRows(*factor, &soft_A, &soft_b, &hard_A, &hard_b);
+    const std::vector<int> columns = Columns(qp, *factor);
+    const Matrix H = soft_A.transpose() * soft_A;
+    const Vector g = soft_A.transpose() * soft_b;
+    for (size_t j = 0; j < columns.size(); j++) {
+      qp.q(columns[j]) -= g(j);
+      for (size_t i = 0; i < columns.size(); i++) {
+        if (H(i, j) != 0) P_triplets.emplace_back(columns[i], columns[j],
+                                                  H(i, j));
+      }
+    }
+    AddRows(columns, hard_A, hard_b, hard_b, &A_triplets, &l, &u);
+  }
+  for (auto &&factor : inequalities) {
+    if (!factor) continue;
+    const auto Ab = factor->jacobian();
+    AddRows(Columns(qp, *factor), Ab.first, Ab.second,
+            Vector::Constant(Ab.second.size(), inf), &A_triplets, &l, &u);
+  }
+
+  qp.P.resize(n, n);
+  qp.P.setFromTriplets(P_triplets.begin(), P_triplets.end());
+  qp.A.resize(l.size(), n);
+  qp.A.setFromTriplets(A_triplets.begin(), A_triplets.end());
+  qp.l = Eigen::Map<const Vector>(l.data(), l.size());
+  qp.u = Eigen::Map<const Vector>(u.data(), u.size());
+  return qp;
+}
+
+/* ************************************************************************* */
+SparseQP SparseQP::Linearize(const gtsam::NonlinearFactorGraph &graph,
+                             const EqualityConstraints &equalities,
+                             const InequalityConstraints &inequalities,
+                             const gtsam::Values &nominal) {
+  GaussianFactorGraph cost = *graph.linearize(nominal);
+
+  // Linearized equalities h + H dx = 0, as hard constraints.
+  for (const auto &constraint : equalities) {
+    auto factor = constraint->createFactor(1.0);
+    std::vector<Matrix> H(factor->size());
+    const Vector h = factor->unwhitenedError(nominal, H);
+    std::vector<std::pair<Key, Matrix>> terms;
+    for (size_t i = 0; i < factor->size(); i++) {
+      terms.emplace_back(factor->keys()[i], H[i]);
+    }
+    cost.emplace_shared<JacobianFactor>(
+        terms, -h, gtsam::noiseModel::Constrained::All(h.size()));
+  }
+
+  GaussianFactorGraph linear_inequalities;
+  for (const auto &constraint : inequalities) {
+    linear_inequalities.push_back(constraint->linearize(nominal));
+  }
+  return FromLinear(cost, linear_inequalities);
+}
+
+}  // namespace gtdynamics
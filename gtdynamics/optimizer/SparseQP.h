@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseQP.h
+ * @brief Export of linearized trajectory problems as sparse quadratic
+ * programs.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Sparse>
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * Quadratic program in the form of OSQP,
+ *
+ *   minimize 1/2 x' P x + q' x  subject to  l <= A x <= u,
+ *
+ * whose variables x are the stacked vectors of a set of keys, in key order.
+ * Equality constraints have l = u, one-sided ones an infinite bound.
+ */
+struct SparseQP {
+  typedef Eigen::SparseMatrix<double> SparseMatrix;
+
+  std::map<gtsam::Key, size_t> offsets;  ///< first column of every key
+  std::map<gtsam::Key, size_t> dims;     ///< dimension of every key
+  SparseMatrix P;                        ///< symmetric cost Hessian
+  gtsam::Vector q;                       ///< cost gradient at x = 0
+  SparseMatrix A;                        ///< constraint matrix
+  gtsam::Vector l, u;                    ///< constraint bounds
+
+  size_t numVariables() const { return q.size(); }
+  size_t numConstraints() const { return l.size(); }
+
+  /// Cost 1/2 x' P x + q' x.
+  double cost(const gtsam::Vector &x) const {
+    return 0.5 * x.dot(P * x) + q.dot(x);
+  }
+
+  /// Split a solution into the vectors of its keys.
+  gtsam::VectorValues vectorValues(const gtsam::Vector &x) const;
+
+  /// Stack the vectors of the keys, zero for missing keys.
+  gtsam::Vector stack(const gtsam::VectorValues &values) const;
+
+  /**
+   * Export a linear least-squares problem with linear inequalities.
+   *
+   * Factors of the cost add their whitened A' A to P and -A' b to q, except
+   * for rows with a zero sigma of a constrained noise model, which become
+   * equality constraints A x = b. Every row of the inequality factors is a
+   * constraint A x >= b.
+   *
+   * @param cost         linear factors, e.g. a linearized trajectoryFG
+   * @param inequalities factors [A b] of the constraints A x >= b
+   */
+  static SparseQP FromLinear(
+      const gtsam::GaussianFactorGraph &cost,
+      const gtsam::GaussianFactorGraph &inequalities =
+          gtsam::GaussianFactorGraph());
+
+  /**
+   * Export the QP in the update dx of the values, linearizing the cost and
+   * constraints at a nominal trajectory, e.g. for linear MPC.
+   *
+   * @param graph        nonlinear cost
+   * @param equalities   constraints h(x) = 0, linearized to h + H dx = 0
+   * @param inequalities constraints g(x) >= 0, linearized to g + G dx >= 0
+   * @param nominal      linearization point
+   */
+  static SparseQP Linearize(const gtsam::NonlinearFactorGraph &graph,
+                            const EqualityConstraints &equalities,
+                            const InequalityConstraints &inequalities,
+                            const gtsam::Values &nominal);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeOrdering.cpp
+ * @brief Elimination orderings for trajectory problems, using time steps.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/TimeOrdering.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+
+// Append time steps sorted[lo..hi) in nested dissection order.
+static void Dissect(const std::vector<uint64_t> &sorted, size_t lo, size_t hi,
+                    std::vector<uint64_t> *order) {
+  if (lo >= hi) return;
+  const size_t mid = lo + (hi - lo) / 2;
+  Dissect(sorted, lo, mid, order);
+  Dissect(sorted, mid + 1, hi, order);
+  order->push_back(sorted[mid]);
+}
+
+/* ************************************************************************* */
+gtsam::Ordering TimeOrdering(const gtsam::KeyVector &keys,
+                             TimeOrderingType type) {
+  constexpr uint16_t kNone = DynamicsSymbol::kNoIndex;
+
+  // Rank every time step in the chosen elimination order.
+  std::vector<uint64_t> steps;
+  for (Key key : keys) steps.push_back(DynamicsSymbol(key).time());
+  std::sort(steps.begin(), steps.end());
+  steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+  std::vector<uint64_t> order;
+  if (type == TimeOrderingType::NestedDissection) {
+    order.reserve(steps.size());
+    Dissect(steps, 0, steps.size(), &order);
+  } else {
+    order = steps;
+  }
+  std::map<uint64_t, size_t> rank;
+  for (size_t i = 0; i < order.size(); i++) rank[order[i]] = i;
+
+  // Sort by (group, rank of time step, link, joint, key), where global keys
+  // form the last group and, for the link Schur ordering, joint variables
+  // the one before.
+  using SortKey = std::tuple<int, size_t, uint16_t, uint16_t, Key>;
+  std::vector<SortKey> sort_keys;
+  sort_keys.reserve(keys.size());
+  for (Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    int group = 0;
+    if (symbol.linkIdx() == kNone && symbol.jointIdx() == kNone) {
+      group = 2;
+    } else if (type == TimeOrderingType::LinkSchur &&
+               symbol.linkIdx() == kNone) {
+      group = 1;
+    }
+    sort_keys.emplace_back(group, rank[symbol.time()], symbol.linkIdx(),
+                           symbol.jointIdx(), key);
+  }
+  std::sort(sort_keys.begin(), sort_keys.end());
+
+  gtsam::Ordering ordering;
+  for (const SortKey &sort_key : sort_keys)
+    ordering.push_back(std::get<4>(sort_key));
+  return ordering;
+}
+
+}  // namespace gtdynamics
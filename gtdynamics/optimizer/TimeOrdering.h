@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeOrdering.h
+ * @brief Elimination orderings for trajectory problems, using time steps.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+
+namespace gtdynamics {
+
+/// Structure of an ordering computed from DynamicsSymbol time steps.
+enum class TimeOrderingType {
+  /// Eliminate time steps in increasing order, giving a banded factor.
+  TimeMajor,
+  /// Nested dissection by time: both halves of the trajectory first and the
+  /// separating time step last, recursively, giving a balanced Bayes tree.
+  NestedDissection,
+  /// Link variables, e.g. poses, twists and wrenches, of every time step
+  /// first, then joint variables time-major. Link variables only couple
+  /// within a step, so each step is a separate subtree whose elimination
+  /// leaves a dense Schur complement on the joint variables of the step;
+  /// these are eliminated in a Riccati-like sweep along the block-banded
+  /// chain. Subtrees are eliminated in parallel when GTSAM uses TBB.
+  LinkSchur
+};
+
+/**
+ * Ordering of trajectory variables computed from their DynamicsSymbol keys
+ * alone, without COLAMD. Within a time step variables are sorted by link
+ * index, joint index, then label; variables with a link index, including
+ * wrenches, are link variables, and those with only a joint index are joint
+ * variables. Keys without a link or joint index, e.g.
+ * phase durations PhaseKey(k), usually couple many time steps and are
+ * eliminated last.
+ *
+ * @param keys all variables of the problem, e.g. values.keys()
+ * @param type time-major, nested dissection by time, or link Schur
+ */
+gtsam::Ordering TimeOrdering(
+    const gtsam::KeyVector &keys,
+    TimeOrderingType type = TimeOrderingType::TimeMajor);
+
+}  // namespace gtdynamics
@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFeedback.cpp
+ * @brief Time-varying linear feedback around an optimized trajectory.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/TrajectoryFeedback.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+TrajectoryFeedback::TrajectoryFeedback(const Robot &robot,
+                                       const gtsam::NonlinearFactorGraph &graph,
+                                       const Values &solution, size_t num_steps,
+                                       const std::string &base_link)
+    : TrajectoryFeedback(robot, *graph.linearize(solution), solution,
+                         num_steps, base_link) {}
+
+/* ************************************************************************* */
+TrajectoryFeedback::TrajectoryFeedback(const Robot &robot,
+                                       const gtsam::GaussianFactorGraph &linear,
+                                       const Values &solution, size_t num_steps,
+                                       const std::string &base_link) {
+  std::vector<int> joint_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+  std::sort(joint_ids.begin(), joint_ids.end());
+  const int base_id = base_link.empty() ? -1 : robot.link(base_link)->id();
+
+  for (size_t k = 0; k <= num_steps; k++) {
+    KeyVector torques, angles, vels;
+    for (int j : joint_ids) {
+      if (!solution.exists(TorqueKey(j, k))) continue;
+      torques.push_back(TorqueKey(j, k));
+      angles.push_back(JointAngleKey(j, k));
+      vels.push_back(JointVelKey(j, k));
+    }
+    if (torques.empty()) {
+      throw std::invalid_argument("TrajectoryFeedback: no torques at step " +
+                                  std::to_string(k));
+    }
+    KeyVector state = angles;
+    state.insert(state.end(), vels.begin(), vels.end());
+    if (base_id >= 0) {
+      state.push_back(PoseKey(base_id, k));
+      state.push_back(TwistKey(base_id, k));
+    }
+    for (Key key : torques) solution_.insert(key, solution.at(key));
+    for (Key key : state) {
+      if (!solution.exists(key)) {
+        throw std::invalid_argument(
+            "TrajectoryFeedback: missing state variable " +
+            std::string(DynamicsSymbol(key)));
+      }
+      solution_.insert(key, solution.at(key));
+    }
+    torque_keys_.push_back(torques);
+    state_keys_.push_back(state);
+  }
+  state_dim_ = 0;
+  for (Key key : state_keys_[0]) state_dim_ += solution_.at(key).dim();
+  eliminate(linear);
+}
+
+/* ************************************************************************* */
+void TrajectoryFeedback::eliminate(const gtsam::GaussianFactorGraph &linear) {
+  const size_t num_steps = state_keys_.size();
+  std::set<Key> special;
+  for (size_t k = 0; k < num_steps; k++) {
+    special.insert(state_keys_[k].begin(), state_keys_[k].end());
+    special.insert(torque_keys_[k].begin(), torque_keys_[k].end());
+  }
+
+  // Backwards in time: other variables, torques, state; untimed ones last.
+  std::vector<KeyVector> others(num_steps);
+  KeyVector untimed;
+  for (Key key : linear.keys()) {
+    if (special.count(key)) continue;
+    const DynamicsSymbol symbol(key);
+    if ((symbol.linkIdx() == DynamicsSymbol::kNoIndex &&
+         symbol.jointIdx() == DynamicsSymbol::kNoIndex) ||
+        symbol.time() >= num_steps) {
+      untimed.push_back(key);
+    } else {
+      others[symbol.time()].push_back(key);
+    }
+  }
+  gtsam::Ordering ordering;
+  for (size_t k = num_steps; k-- > 0;) {
+    for (Key key : others[k]) ordering.push_back(key);
+    for (Key key : torque_keys_[k]) ordering.push_back(key);
+    for (Key key : state_keys_[k]) ordering.push_back(key);
+  }
+  for (Key key : untimed) ordering.push_back(key);
+  const auto bayes_net = linear.eliminateSequential(ordering);
+
+  std::map<Key, gtsam::GaussianConditional::shared_ptr> conditionals;
+  for (auto &&conditional : *bayes_net) {
+    conditionals[conditional->front()] = conditional;
+  }
+
+  // Every variable as G dx + f; parents missing from the map are held at
+  // the solution.
+  typedef std::pair<Matrix, Vector> Affine;
+  for (size_t k = 0; k < num_steps; k++) {
+    std::map<Key, Affine> affine;
+    size_t offset = 0;
+    for (Key key : state_keys_[k]) {
+      const size_t dim = solution_.at(key).dim();
+      Matrix G = Matrix::Zero(dim, state_dim_);
+      G.middleCols(offset, dim).setIdentity();
+      affine[key] = Affine(G, Vector::Zero(dim));
+      offset += dim;
+    }
+    const KeyVector &torques = torque_keys_[k];
+    for (auto it = torques.rbegin(); it != torques.rend(); ++it) {
+      const auto &conditional = conditionals.at(*it);
+      Matrix G = Matrix::Zero(conditional->rows(), state_dim_);
+      Vector f = conditional->d();
+      for (auto parent = conditional->beginParents();
+           parent != conditional->endParents(); ++parent) {
+        auto found = affine.find(*parent);
+        if (found == affine.end()) continue;
+        const Matrix S = conditional->S(parent);
+        G -= S * found->second.first;
+        f -= S * found->second.second;
+      }
+      const Matrix R = conditional->R();
+      affine[*it] = Affine(R.triangularView<Eigen::Upper>().solve(G),
+                           R.triangularView<Eigen::Upper>().solve(f));
+    }
+
+    size_t num_rows = 0;
+    for (Key key : torques) num_rows += affine.at(key).second.size();
+    Matrix K(num_rows, state_dim_);
+    Vector feedforward(num_rows);
+    size_t row = 0;
+    for (Key key : torques) {
+      const Affine &torque = affine.at(key);
+      K.middleRows(row, torque.second.size()) = torque.first;
+      feedforward.segment(row, torque.second.size()) = torque.second;
+      row += torque.second.size();
+    }
+    gains_.push_back(K);
+    feedforwards_.push_back(feedforward);
+  }
+}
+
+/* ************************************************************************* */
+Vector TrajectoryFeedback::deviation(size_t k, const Values &measured) const {
+  Vector dx(state_dim_);
+  size_t offset = 0;
+  for (Key key : stateKeys(k)) {
+    const gtsam::Value &nominal = solution_.at(key);
+    const Vector local = nominal.localCoordinates_(measured.at(key));
+    dx.segment(offset, local.size()) = local;
+    offset += local.size();
+  }
+  return dx;
+}
+
+/* ************************************************************************* */
+Vector TrajectoryFeedback::torques(size_t k, const Values &measured) const {
+  Vector tau(gain(k).rows());
+  size_t row = 0;
+  for (Key key : torqueKeys(k)) tau(row++) = solution_.at<double>(key);
+  return tau + feedforward(k) + gain(k) * deviation(k, measured);
+}
+
+/* ************************************************************************* */
+Values TrajectoryFeedback::control(size_t k, const Values &measured) const {
+  const Vector tau = torques(k, measured);
+  Values values;
+  const KeyVector &keys = torqueKeys(k);
+  for (size_t i = 0; i < keys.size(); i++) values.insert(keys[i], tau(i));
+  return values;
+}
+
+}  // namespace gtdynamics
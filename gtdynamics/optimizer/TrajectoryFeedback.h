@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFeedback.h
+ * @brief Time-varying linear feedback around an optimized trajectory, from
+ * the elimination of its linearized factor graph.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryFeedback is the time-varying LQR policy around an optimized
+ * trajectory, e.g. a solution of DynamicsGraph::trajectoryFG with costs:
+ * at step k the joint torques are
+ *
+ *   tau_k = tau*_k + k_k + K_k dx_k,
+ *
+ * with dx_k the deviation of the state at step k from the solution, in the
+ * local coordinates of the solution. The state is the joint angles and
+ * velocities, followed by the pose and twist of a base link if one is
+ * given, e.g. for legged robots with a floating base.
+ *
+ * The graph is linearized once at the solution and eliminated backwards in
+ * time: at every step the other variables, then the torques, then the
+ * state, and variables without a link or joint index, e.g. PhaseKey, last.
+ * The conditionals of the torques of a step then give them as a function
+ * of its state by back-substitution, without further solves. The
+ * feed-forward k_k is the remaining Gauss-Newton step, zero at an optimum.
+ *
+ * Parents that are not in the state, e.g. the accelerations of the previous
+ * step with Trapezoidal collocation, are held at the solution; with Euler
+ * collocation the torques only depend on the state.
+ */
+class TrajectoryFeedback {
+ private:
+  size_t state_dim_ = 0;
+  std::vector<gtsam::KeyVector> state_keys_;   // state variables by step
+  std::vector<gtsam::KeyVector> torque_keys_;  // torques by step
+  std::vector<gtsam::Matrix> gains_;
+  std::vector<gtsam::Vector> feedforwards_;
+  gtsam::Values solution_;  // state and torques of the solution
+
+  /// Extract the gains from the linearized graph.
+  void eliminate(const gtsam::GaussianFactorGraph &linear);
+
+ public:
+  /**
+   * Constructor.
+   * @param robot     the robot; its joints with torques in solution are
+   * controlled
+   * @param graph     the factor graph of the trajectory
+   * @param solution  the optimized trajectory
+   * @param num_steps the trajectory has steps 0 to num_steps
+   * @param base_link name of a base link whose pose and twist are part of
+   * the state, empty for none
+   */
+  TrajectoryFeedback(const Robot &robot,
+                     const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &solution, size_t num_steps,
+                     const std::string &base_link = "");
+
+  /// As above, with the graph already linearized at the solution, e.g. the
+  /// last linearization of an optimizer.
+  TrajectoryFeedback(const Robot &robot,
+                     const gtsam::GaussianFactorGraph &linear,
+                     const gtsam::Values &solution, size_t num_steps,
+                     const std::string &base_link = "");
+
+  /// Number of time steps with gains.
+  size_t numSteps() const { return gains_.size(); }
+
+  /// Dimension of the state deviation.
+  size_t stateDim() const { return state_dim_; }
+
+  /// State variables at step k, in the order of the state deviation.
+  const gtsam::KeyVector &stateKeys(size_t k) const {
+    return state_keys_.at(k);
+  }
+
+  /// Torque variables at step k, in the order of the rows of the gains.
+  const gtsam::KeyVector &torqueKeys(size_t k) const {
+    return torque_keys_.at(k);
+  }
+
+  /// Feedback gain K_k, number of torques x stateDim().
+  const gtsam::Matrix &gain(size_t k) const { return gains_.at(k); }
+
+  /// Feed-forward correction k_k.
+  const gtsam::Vector &feedforward(size_t k) const {
+    return feedforwards_.at(k);
+  }
+
+  /// Deviation of the measured state at step k from the solution.
+  gtsam::Vector deviation(size_t k, const gtsam::Values &measured) const;
+
+  /// Torques at step k for the measured state at step k.
+  gtsam::Vector torques(size_t k, const gtsam::Values &measured) const;
+
+  /// As torques, as values of the torque keys of step k.
+  gtsam::Values control(size_t k, const gtsam::Values &measured) const;
+};
+
+}  // namespace gtdynamics
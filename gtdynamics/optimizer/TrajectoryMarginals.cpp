@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryMarginals.cpp
+ * @brief Marginal covariances of selected variables of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/optimizer/TrajectoryMarginals.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/nonlinear/ISAM2.h>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using gtsam::Key;
+using gtsam::Matrix;
+
+namespace gtdynamics {
+
+namespace {
+/// Joint covariance of the frontal and separator variables of a clique,
+/// with the offset and dimension of every variable.
+struct CliqueCovariance {
+  std::map<Key, std::pair<size_t, size_t>> blocks;
+  Matrix sigma;
+};
+}  // namespace
+
+/* ************************************************************************* */
+template <class BAYESTREE>
+std::map<Key, Matrix> MarginalCovariances(const BAYESTREE &bayes_tree,
+                                          const gtsam::KeyVector &keys) {
+  using Clique = typename BAYESTREE::Clique;
+  using SharedClique = typename BAYESTREE::sharedClique;
+  const gtsam::KeySet requested(keys.begin(), keys.end());
+
+  // Pre-order traversal without recursion, the tree can be as deep as the
+  // trajectory is long.
+  std::vector<SharedClique> order, stack(bayes_tree.roots().begin(),
+                                          bayes_tree.roots().end());
+  while (!stack.empty()) {
+    SharedClique clique = stack.back();
+    stack.pop_back();
+    order.push_back(clique);
+    for (auto &&child : clique->children) stack.push_back(child);
+  }
+
+  // A clique is needed if it or one of its descendants has a requested key.
+  std::unordered_map<const Clique *, bool> needed;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const auto &conditional = *(*it)->conditional();
+    bool any = false;
+    for (auto key = conditional.beginFrontals();
+         key != conditional.endFrontals() && !any; ++key) {
+      any = requested.count(*key) > 0;
+    }
+    for (auto &&child : (*it)->children) any = any || needed[child.get()];
+    needed[it->get()] = any;
+  }
+
+  // Top-down pass, from the joint covariance of the parent clique.
+  std::map<Key, Matrix> result;
+  std::vector<std::pair<SharedClique, std::shared_ptr<const CliqueCovariance>>>
+      todo;
+  for (auto &&root : bayes_tree.roots()) todo.emplace_back(root, nullptr);
+  while (!todo.empty()) {
+    const SharedClique clique = todo.back().first;
+    const std::shared_ptr<const CliqueCovariance> parent = todo.back().second;
+    todo.pop_back();
+    if (!needed.at(clique.get())) continue;
+
+    const auto &conditional = *clique->conditional();
+    const Matrix R = conditional.R(), T = conditional.S();
+    const size_t nf = R.rows(), ns = T.cols();
+    const Matrix R_inv = R.template triangularView<Eigen::Upper>().solve(
+        Matrix::Identity(nf, nf));
+
+    auto joint = std::make_shared<CliqueCovariance>();
+    size_t offset = 0;
+    for (auto key = conditional.beginFrontals();
+         key != conditional.endFrontals(); ++key) {
+      const size_t dim = conditional.getDim(key);
+      joint->blocks[*key] = {offset, dim};
+      offset += dim;
+    }
+
+    joint->sigma.resize(nf + ns, nf + ns);
+    if (ns == 0) {
+      joint->sigma = R_inv * R_inv.transpose();
+    } else {
+      // The separator is contained in the variables of the parent clique.
+      std::vector<std::pair<size_t, size_t>> in_parent;
+      for (auto key = conditional.beginParents();
+           key != conditional.endParents(); ++key) {
+        const auto &block = parent->blocks.at(*key);
+        joint->blocks[*key] = {offset, block.second};
+        in_parent.push_back(block);
+        offset += block.second;
+      }
+      Matrix sigma_SS(ns, ns);
+      for (size_t i = 0, row = 0; i < in_parent.size();
+           row += in_parent[i++].second) {
+        for (size_t j = 0, col = 0; j < in_parent.size();
+             col += in_parent[j++].second) {
+          sigma_SS.block(row, col, in_parent[i].second, in_parent[j].second) =
+              parent->sigma.block(in_parent[i].first, in_parent[j].first,
+                                  in_parent[i].second, in_parent[j].second);
+        }
+      }
+      const Matrix sigma_FS = -R_inv * T * sigma_SS;
+      joint->sigma.topLeftCorner(nf, nf) =
+          R_inv * R_inv.transpose() - sigma_FS * T.transpose() *
+                                          R_inv.transpose();
+      joint->sigma.topRightCorner(nf, ns) = sigma_FS;
+      joint->sigma.bottomLeftCorner(ns, nf) = sigma_FS.transpose();
+      joint->sigma.bottomRightCorner(ns, ns) = sigma_SS;
+    }
+
+    for (auto key = conditional.beginFrontals();
+         key != conditional.endFrontals(); ++key) {
+      if (!requested.count(*key)) continue;
+      const auto &block = joint->blocks.at(*key);
+      result[*key] = joint->sigma.block(block.first, block.first,
+                                        block.second, block.second);
+    }
+    for (auto &&child : clique->children) todo.emplace_back(child, joint);
+  }
+
+  for (Key key : requested) {
+    if (!result.count(key)) {
+      throw std::invalid_argument(
+          "MarginalCovariances: a requested variable is not in the tree");
+    }
+  }
+  return result;
+}
+
+template std::map<Key, Matrix> MarginalCovariances<gtsam::GaussianBayesTree>(
+    const gtsam::GaussianBayesTree &, const gtsam::KeyVector &);
+template std::map<Key, Matrix> MarginalCovariances<gtsam::ISAM2>(
+    const gtsam::ISAM2 &, const gtsam::KeyVector &);
+
+/* ************************************************************************* */
+TrajectoryMarginals::TrajectoryMarginals(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &optimum,
+    const boost::optional<gtsam::Ordering> &ordering) {
+  const auto linear = graph.linearize(optimum);
+  bayes_tree_ = *linear->eliminateMultifrontal(
+      ordering ? *ordering : TimeOrdering(optimum.keys()));
+}
+
+}  // namespace gtdynamics
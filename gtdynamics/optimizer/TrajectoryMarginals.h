@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryMarginals.h
+ * @brief Marginal covariances of selected variables of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/TimeOrdering.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * Marginal covariances of selected variables from a Bayes tree of Gaussian
+ * conditionals, e.g. a gtsam::GaussianBayesTree or a gtsam::ISAM2.
+ *
+ * The joint covariance of the frontal and separator variables of every
+ * clique follows from the joint covariance of its parent clique:
+ *
+ *   x_F = R^-1 (d - T x_S)  =>  Sigma_FS = -R^-1 T Sigma_SS,
+ *   Sigma_FF = R^-1 R^-T - Sigma_FS T^T R^-T,
+ *
+ * so a single top-down pass computes all requested blocks. Only the cliques
+ * on the paths from the roots to the requested variables are visited, and
+ * each clique only needs dense matrices of its own size. With a time-ordered
+ * elimination every clique is about one time step, and the pass is linear in
+ * the length of the trajectory.
+ *
+ * @param bayes_tree the Bayes tree
+ * @param keys       variables whose marginal covariances are requested
+ * @return the marginal covariance of every requested variable
+ */
+template <class BAYESTREE>
+std::map<gtsam::Key, gtsam::Matrix> MarginalCovariances(
+    const BAYESTREE &bayes_tree, const gtsam::KeyVector &keys);
+
+/**
+ * TrajectoryMarginals eliminates a trajectory problem once at the optimum,
+ * in time order by default, and recovers marginal covariances of selected
+ * variables with MarginalCovariances. Unlike gtsam::Marginals, no marginal
+ * factors are computed and nothing is cached per query. Example:
+ *
+ *   TrajectoryMarginals marginals(graph, result);
+ *   auto covariances = marginals.marginalCovariances(base_pose_keys);
+ */
+class TrajectoryMarginals {
+ private:
+  gtsam::GaussianBayesTree bayes_tree_;
+
+ public:
+  /**
+   * Constructor, linearizes and eliminates the problem.
+   * @param graph    the factor graph
+   * @param optimum  the values to linearize at, usually the optimum
+   * @param ordering elimination ordering, by default TimeOrdering
+   */
+  TrajectoryMarginals(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &optimum,
+      const boost::optional<gtsam::Ordering> &ordering = boost::none);
+
+  /// Marginal covariances of the given variables, in one pass.
+  std::map<gtsam::Key, gtsam::Matrix> marginalCovariances(
+      const gtsam::KeyVector &keys) const {
+    return MarginalCovariances(bayes_tree_, keys);
+  }
+
+  /// Marginal covariance of one variable.
+  gtsam::Matrix marginalCovariance(gtsam::Key key) const {
+    return marginalCovariances({key}).at(key);
+  }
+
+  /// The Bayes tree of the problem.
+  const gtsam::GaussianBayesTree &bayesTree() const { return bayes_tree_; }
+};
+
+}  // namespace gtdynamics
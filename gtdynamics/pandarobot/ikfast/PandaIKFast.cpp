@@ -23,19 +23,81 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <gtdynamics/utils/Parallel.h>
+
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace gtdynamics {
 
+using gtsam::Matrix;
 using gtsam::Matrix3;
 using gtsam::Point3;
 using gtsam::Pose3;
 using gtsam::Rot3;
 using gtsam::Vector7;
 
+namespace {
+
+// Solution list that writes non-singular solutions straight into a buffer
+// instead of keeping them in a std::list, and filters by joint limits.
+class BufferSolutionList
+    : public ikfast::IkSolutionListBase<panda_internal::IkReal> {
+ public:
+  using IkReal = panda_internal::IkReal;
+
+  BufferSolutionList(Vector7* buffer, size_t capacity,
+                     const PandaIKFast::JointLimits* limits)
+      : buffer_(buffer), capacity_(capacity), limits_(limits) {}
+
+  size_t AddSolution(
+      const std::vector<ikfast::IkSingleDOFSolutionBase<IkReal>>& vinfos,
+      const std::vector<int>& vfree) override {
+    // Skip singularities, which have extra degrees of freedom. Otherwise no
+    // joint depends on a free value, see IkSolution::GetSolution.
+    if (!vfree.empty() || size_ == capacity_) return size_;
+    Vector7& q = buffer_[size_];
+    for (size_t i = 0; i < PandaIKFast::kNumJoints; i++)
+      q(i) = vinfos[i].foffset;
+    if (!limits_ || limits_->contains(q)) size_++;
+    return size_;
+  }
+
+  const ikfast::IkSolutionBase<IkReal>& GetSolution(
+      size_t index) const override {
+    throw std::runtime_error("BufferSolutionList does not keep solutions");
+  }
+
+  size_t GetNumSolutions() const override { return size_; }
+
+  void Clear() override { size_ = 0; }
+
+ private:
+  Vector7* buffer_;
+  size_t capacity_, size_ = 0;
+  const PandaIKFast::JointLimits* limits_;
+};
+
+}  // namespace
+
 PandaIKFast::PandaIKFast() {}
 
+PandaIKFast::JointLimits PandaIKFast::JointLimits::FromRobot(
+    const Robot& robot) {
+  JointLimits limits;
+  for (size_t i = 0; i < kNumJoints; i++) {
+    const auto joint = robot.joint("joint" + std::to_string(i + 1));
+    const auto& scalar_limits = joint->parameters().scalar_limits;
+    limits.lower(i) = scalar_limits.value_lower_limit;
+    limits.upper(i) = scalar_limits.value_upper_limit;
+  }
+  return limits;
+}
+
 Pose3 PandaIKFast::forward(const Vector7& joint_values) {
   // Arrays where solution for orientation and position will be stored
   panda_internal::IkReal orientation[9], position[3];
@@ -89,4 +151,94 @@ std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
   return joint_values;
 }
 
+size_t PandaIKFast::inverse(const Pose3& bTe,
+                            const FreeJointSampling& sampling,
+                            Vector7* solutions, size_t capacity,
+                            const JointLimits* limits) {
+  const Matrix3 bRe = bTe.rotation().matrix().transpose();
+  size_t num_solutions = 0;
+  for (size_t i = 0; i < sampling.num_samples && num_solutions < capacity;
+       i++) {
+    const double theta7 = sampling.sample(i);
+    // Solutions of every sample are appended to those of the previous ones.
+    BufferSolutionList list(solutions + num_solutions,
+                            capacity - num_solutions, limits);
+    if (panda_internal::ComputeIk(bTe.translation().data(), bRe.data(),
+                                  &theta7, list)) {
+      num_solutions += list.GetNumSolutions();
+    }
+  }
+  return num_solutions;
+}
+
+void PandaIKFast::inverse(const std::vector<Pose3>& poses,
+                          const FreeJointSampling& sampling, size_t capacity,
+                          std::vector<Vector7>* solutions,
+                          std::vector<size_t>* num_solutions,
+                          const JointLimits* limits, size_t num_threads) {
+  const size_t n = poses.size();
+  if (solutions->size() < n * capacity) solutions->resize(n * capacity);
+  if (num_solutions->size() < n) num_solutions->resize(n);
+  ParallelFor(n, num_threads, [&](size_t k) {
+    (*num_solutions)[k] = inverse(poses[k], sampling,
+                                  solutions->data() + k * capacity, capacity,
+                                  limits);
+  });
+}
+
+Matrix PandaIKFast::inversePath(const std::vector<Pose3>& poses,
+                                const FreeJointSampling& sampling,
+                                const JointLimits* limits,
+                                const Vector7* start, size_t num_threads) {
+  const size_t n = poses.size();
+  if (n == 0) return Matrix(0, kNumJoints);
+  const size_t capacity =
+      kMaxSolutions * std::max<size_t>(1, sampling.num_samples);
+  std::vector<Vector7> solutions;
+  std::vector<size_t> num_solutions;
+  inverse(poses, sampling, capacity, &solutions, &num_solutions, limits,
+          num_threads);
+  for (size_t k = 0; k < n; k++) {
+    if (num_solutions[k] == 0) {
+      throw std::runtime_error(
+          "PandaIKFast::inversePath: no solution for pose " +
+          std::to_string(k));
+    }
+  }
+
+  // cost[k * capacity + s] is the smallest cost of a path ending at solution
+  // s of pose k, reached from solution parent[k * capacity + s] of pose k-1.
+  std::vector<double> cost(n * capacity);
+  std::vector<size_t> parent(n * capacity);
+  for (size_t s = 0; s < num_solutions[0]; s++) {
+    cost[s] = start ? (solutions[s] - *start).squaredNorm() : 0.0;
+  }
+  for (size_t k = 1; k < n; k++) {
+    const size_t previous = (k - 1) * capacity, current = k * capacity;
+    for (size_t s = 0; s < num_solutions[k]; s++) {
+      double best = std::numeric_limits<double>::infinity();
+      for (size_t r = 0; r < num_solutions[k - 1]; r++) {
+        const double c =
+            cost[previous + r] +
+            (solutions[current + s] - solutions[previous + r]).squaredNorm();
+        if (c < best) {
+          best = c;
+          parent[current + s] = r;
+        }
+      }
+      cost[current + s] = best;
+    }
+  }
+
+  // Backtrack from the cheapest solution of the last pose.
+  Matrix path(n, kNumJoints);
+  const double* last = cost.data() + (n - 1) * capacity;
+  size_t s = std::min_element(last, last + num_solutions[n - 1]) - last;
+  for (size_t k = n; k-- > 0;) {
+    path.row(k) = solutions[k * capacity + s].transpose();
+    s = parent[k * capacity + s];
+  }
+  return path;
+}
+
 }  // namespace gtdynamics
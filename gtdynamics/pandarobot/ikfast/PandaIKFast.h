@@ -9,6 +9,8 @@
 
 //----------------------------------------------------------------------------//
 
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <stdio.h>
@@ -26,6 +28,9 @@ class PandaIKFast {
   // The robot's number of joints, for the panda it's 7
   static constexpr size_t kNumJoints = 7;
 
+  // Upper bound on the number of solutions for one value of the 7th joint.
+  static constexpr size_t kMaxSolutions = 16;
+
   /**
    * @brief Forward Kinematics on Panda robot using IKFast.
    *
@@ -46,6 +51,91 @@ class PandaIKFast {
    */
   static std::vector<gtsam::Vector7> inverse(const gtsam::Pose3& bRe,
                                              double theta7);
+
+  /// Values of the 7th joint angle to solve for: num_samples evenly spaced
+  /// values from lower to upper, or their midpoint if num_samples is 1.
+  struct FreeJointSampling {
+    double lower = 0.0, upper = 0.0;
+    size_t num_samples = 1;
+
+    /// Sample i.
+    double sample(size_t i) const {
+      if (num_samples < 2) return 0.5 * (lower + upper);
+      return lower + i * (upper - lower) / (num_samples - 1);
+    }
+  };
+
+  /// Joint limits used to filter solutions.
+  struct JointLimits {
+    gtsam::Vector7 lower, upper;
+
+    /// Scalar limits of joint1 to joint7 of a Panda robot.
+    static JointLimits FromRobot(const Robot& robot);
+
+    /// Whether all joint angles are within the limits.
+    bool contains(const gtsam::Vector7& q) const {
+      return (q.array() >= lower.array()).all() &&
+             (q.array() <= upper.array()).all();
+    }
+  };
+
+  /**
+   * @brief Inverse Kinematics into a caller-provided buffer, without
+   * allocating the solutions. Safe to call from many threads.
+   *
+   * @param bTe -- the desired end-effector pose wrt the base frame
+   * @param sampling -- values of the 7th joint angle to solve for
+   * @param solutions -- buffer for at least `capacity` solutions
+   * @param capacity -- maximum number of solutions to write
+   * @param limits -- if given, solutions outside the limits are dropped
+   * @return size_t -- number of solutions written
+   */
+  static size_t inverse(const gtsam::Pose3& bTe,
+                        const FreeJointSampling& sampling,
+                        gtsam::Vector7* solutions, size_t capacity,
+                        const JointLimits* limits = nullptr);
+
+  /**
+   * @brief Batch Inverse Kinematics. Solutions for pose n are written to
+   * (*solutions)[n * capacity + s] for s < (*num_solutions)[n]; the buffers
+   * are only resized when too small, so they can be reused across calls.
+   *
+   * @param poses -- the desired end-effector poses wrt the base frame
+   * @param sampling -- values of the 7th joint angle to solve for
+   * @param capacity -- maximum number of solutions per pose
+   * @param solutions -- solution buffer
+   * @param num_solutions -- number of solutions per pose
+   * @param limits -- if given, solutions outside the limits are dropped
+   * @param num_threads -- number of threads, 0 for hardware concurrency
+   */
+  static void inverse(const std::vector<gtsam::Pose3>& poses,
+                      const FreeJointSampling& sampling, size_t capacity,
+                      std::vector<gtsam::Vector7>* solutions,
+                      std::vector<size_t>* num_solutions,
+                      const JointLimits* limits = nullptr,
+                      size_t num_threads = 1);
+
+  /**
+   * @brief Inverse Kinematics along a Cartesian path, e.g. from circle() or
+   * square() in utils.h. All solutions of all poses are computed in
+   * parallel, then one solution per pose is picked by dynamic programming,
+   * minimizing the sum of squared joint-space distances between consecutive
+   * poses so the path does not jump between solution branches. Throws
+   * std::runtime_error if a pose has no solution.
+   *
+   * @param poses -- the end-effector poses along the path wrt the base frame
+   * @param sampling -- values of the 7th joint angle to solve for
+   * @param limits -- if given, solutions outside the limits are dropped
+   * @param start -- if given, the squared distance from these joint angles
+   * to the first solution is added to the cost
+   * @param num_threads -- number of threads, 0 for hardware concurrency
+   * @return gtsam::Matrix -- joint angles, one row per pose
+   */
+  static gtsam::Matrix inversePath(const std::vector<gtsam::Pose3>& poses,
+                                   const FreeJointSampling& sampling,
+                                   const JointLimits* limits = nullptr,
+                                   const gtsam::Vector7* start = nullptr,
+                                   size_t num_threads = 1);
 };
 
 }  // namespace gtdynamics
@@ -0,0 +1,62 @@
+/**
+ * @file  PandaIKFastSolver.cpp
+ * @brief PandaIKFast as an analytical IK solver for Kinematics.
+ * @author GTDynamics Team
+ */
+
+#include "PandaIKFastSolver.h"
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Vector7;
+
+// Panda joint names, in IKFast order.
+static std::string JointName(size_t i) {
+  return "joint" + std::to_string(i + 1);
+}
+
+bool PandaIKFastSolver::matches(const Robot &robot) const {
+  if (!AnalyticalIKSolver::matches(robot)) return false;
+  const auto &joints = robot.joints();
+  for (size_t i = 0; i < PandaIKFast::kNumJoints; i++) {
+    const std::string name = JointName(i);
+    if (std::none_of(joints.begin(), joints.end(),
+                     [&name](const JointSharedPtr &joint) {
+                       return joint->name() == name;
+                     }))
+      return false;
+  }
+  return true;
+}
+
+std::vector<JointAngleMap> PandaIKFastSolver::solve(const Robot &robot,
+                                                    const Pose3 &bTe) const {
+  // IKFast works with the link frames rather than the CoM frames.
+  const Pose3 base_link_T_ee_link = linkFramePose(robot, bTe);
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i < PandaIKFast::kNumJoints; i++)
+    names.push_back(JointName(i));
+  const auto limits = PandaIKFast::JointLimits::FromRobot(robot);
+
+  std::vector<JointAngleMap> solutions;
+  Vector7 buffer[PandaIKFast::kMaxSolutions];
+  for (double theta7 : theta7_samples_) {
+    PandaIKFast::FreeJointSampling sampling;
+    sampling.lower = sampling.upper = theta7;
+    const size_t n = PandaIKFast::inverse(base_link_T_ee_link, sampling, buffer,
+                                          PandaIKFast::kMaxSolutions, &limits);
+    for (size_t s = 0; s < n; s++) {
+      JointAngleMap solution;
+      for (size_t i = 0; i < PandaIKFast::kNumJoints; i++)
+        solution[names[i]] = buffer[s](i);
+      solutions.push_back(solution);
+    }
+  }
+  return solutions;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,46 @@
+/**
+ * @file  PandaIKFastSolver.h
+ * @brief PandaIKFast as an analytical IK solver for Kinematics.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/AnalyticalIK.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Closed-form IK for the Panda URDF chain from link0 to link7 (joints joint1
+ * to joint7), for registration in an AnalyticalIKRegistry. The redundant 7th
+ * joint angle is sampled at the given values, and solutions outside the URDF
+ * joint limits are dropped.
+ */
+class PandaIKFastSolver : public AnalyticalIKSolver {
+ private:
+  std::vector<double> theta7_samples_;
+
+ public:
+  /**
+   * Constructor.
+   * @param theta7_samples values of the 7th joint angle to solve for
+   */
+  explicit PandaIKFastSolver(
+      const std::vector<double> &theta7_samples = std::vector<double>{0.0})
+      : theta7_samples_(theta7_samples) {}
+
+  std::string baseLinkName() const override { return "link0"; }
+  std::string endEffectorLinkName() const override { return "link7"; }
+
+  /// Matches robots with the Panda joint names.
+  bool matches(const Robot &robot) const override;
+
+  std::vector<JointAngleMap> solve(const Robot &robot,
+                                   const gtsam::Pose3 &bTe) const override;
+};
+
+}  // namespace gtdynamics
@@ -90,6 +90,72 @@ TEST(PandaIKFast, Inverse) {
   }
 }
 
+TEST(PandaIKFast, InverseBatch) {
+  const Pose3 bTe(Rot3(), Point3(0, 0, 0.25));
+  PandaIKFast::FreeJointSampling sampling;
+  sampling.lower = sampling.upper = 0.3;
+  const std::vector<Vector7> expected = PandaIKFast::inverse(bTe, 0.3);
+
+  // Batch over identical poses, in parallel.
+  const std::vector<Pose3> poses(3, bTe);
+  const size_t capacity = PandaIKFast::kMaxSolutions;
+  std::vector<Vector7> solutions;
+  std::vector<size_t> num_solutions;
+  PandaIKFast::inverse(poses, sampling, capacity, &solutions, &num_solutions,
+                       nullptr, 2);
+  EXPECT_LONGS_EQUAL(3 * capacity, solutions.size());
+  for (size_t n = 0; n < poses.size(); n++) {
+    EXPECT_LONGS_EQUAL(expected.size(), num_solutions[n]);
+    for (size_t s = 0; s < expected.size(); ++s) {
+      EXPECT(assert_equal(expected[s], solutions[n * capacity + s], 1e-9));
+    }
+  }
+
+  // Only solutions within the joint limits are kept.
+  PandaIKFast::JointLimits limits;
+  limits.lower = Vector7::Constant(-2.9);
+  limits.upper = Vector7::Constant(2.9);
+  Vector7 buffer[PandaIKFast::kMaxSolutions];
+  const size_t n = PandaIKFast::inverse(bTe, sampling, buffer,
+                                        PandaIKFast::kMaxSolutions, &limits);
+  size_t expected_n = 0;
+  for (const Vector7& q : expected) expected_n += limits.contains(q);
+  EXPECT_LONGS_EQUAL(expected_n, n);
+  for (size_t s = 0; s < n; ++s) EXPECT(limits.contains(buffer[s]));
+
+  // The capacity bounds the number of solutions written.
+  EXPECT_LONGS_EQUAL(2, PandaIKFast::inverse(bTe, sampling, buffer, 2));
+}
+
+TEST(PandaIKFast, InversePath) {
+  // Poses along a smooth joint-space path, with a constant 7th joint angle.
+  const size_t n = 20;
+  const Vector7 q0 =
+      (Vector7() << 0.2, -0.3, 0.1, -1.8, 0.4, 1.5, -0.4).finished();
+  const Vector7 dq =
+      (Vector7() << 0.02, 0.01, -0.01, 0.015, -0.02, 0.01, 0).finished();
+  std::vector<Pose3> poses;
+  for (size_t k = 0; k < n; k++) {
+    poses.push_back(PandaIKFast::forward(q0 + double(k) * dq));
+  }
+
+  PandaIKFast::FreeJointSampling sampling;
+  sampling.lower = sampling.upper = q0(6);
+  const Matrix path =
+      PandaIKFast::inversePath(poses, sampling, nullptr, &q0, 2);
+  EXPECT_LONGS_EQUAL(n, path.rows());
+  for (size_t k = 0; k < n; k++) {
+    const Vector7 q = path.row(k).transpose();
+    EXPECT(assert_equal(Vector7(q0 + double(k) * dq), q, 1e-6));
+    EXPECT(assert_equal(poses[k], PandaIKFast::forward(q), 1e-6));
+  }
+
+  // Unreachable poses throw.
+  poses[3] = Pose3(Rot3(), Point3(5, 0, 0));
+  CHECK_EXCEPTION(PandaIKFast::inversePath(poses, sampling),
+                  std::runtime_error);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
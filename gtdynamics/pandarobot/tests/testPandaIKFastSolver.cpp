@@ -0,0 +1,61 @@
+/**
+ * @file  testPandaIKFastSolver.cpp
+ * @brief test PandaIKFast dispatch from Kinematics::inverse
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFastSolver.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <boost/make_shared.hpp>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+TEST(PandaIKFastSolver, Inverse) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+          .fixLink("link0");
+  const double theta7 = -0.4;
+  const std::vector<double> q{0.2, -0.3, 0.1, -1.8, 0.4, 1.5, theta7};
+
+  // Goal pose from forward kinematics of the URDF.
+  gtsam::Values joint_angles;
+  for (size_t i = 0; i < q.size(); i++) {
+    const auto joint = robot.joint("joint" + std::to_string(i + 1));
+    InsertJointAngle(&joint_angles, joint->id(), q[i]);
+  }
+  const auto fk = robot.forwardKinematics(joint_angles);
+  const auto ee = robot.link("link7"), base = robot.link("link0");
+  const gtsam::Pose3 wTe = Pose(fk, ee->id());
+
+  // All solutions reproduce the goal.
+  auto solver = boost::make_shared<PandaIKFastSolver>(
+      std::vector<double>{theta7});
+  EXPECT(solver->matches(robot));
+  const auto solutions =
+      solver->solve(robot, base->getFixedPose().between(wTe));
+  CHECK(!solutions.empty());
+
+  // Kinematics::inverse uses the closed-form solver.
+  auto registry = boost::make_shared<AnalyticalIKRegistry>();
+  registry->add(solver);
+  KinematicsParameters parameters;
+  parameters.analytical_ik = registry;
+  const PoseGoals goals{{ee, wTe}};
+  const auto result = Kinematics(parameters).inverse(Slice(0), robot, goals);
+  EXPECT(goals[0].satisfied(result, 0, 1e-5));
+  EXPECT_DOUBLES_EQUAL(theta7, JointAngle(result, robot.joint("joint7")->id()),
+                       1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,231 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticFeasibility.cpp
+ * @brief Fast check whether a stance of contact goals can be reached and
+ * held at rest, before solving a trajectory for it.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/statics/StaticFeasibility.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/ChainInitializer.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+
+#include <Eigen/QR>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace {
+
+// The base of the legs, as in ChainInitializer: the link with the most
+// joints.
+LinkSharedPtr LegBase(const Robot& robot) {
+  LinkSharedPtr base;
+  for (auto&& link : robot.links()) {
+    if (!base || link->numJoints() > base->numJoints()) base = link;
+  }
+  return base;
+}
+
+// Nonnegative least squares min |A x - b| s.t. x >= 0, by the active set
+// method of Lawson and Hanson.
+Vector Nnls(const Matrix& A, const Vector& b, double tol = 1e-12) {
+  const size_t n = A.cols();
+  Vector x = Vector::Zero(n);
+  std::vector<bool> passive(n, false);
+  for (size_t iteration = 0; iteration < 3 * n; iteration++) {
+    // Add the zero weight whose column most lowers the residual.
+    const Vector w = A.transpose() * (b - A * x);
+    int j = -1;
+    for (size_t i = 0; i < n; i++) {
+      if (!passive[i] && w(i) > tol && (j < 0 || w(i) > w(j))) j = i;
+    }
+    if (j < 0) break;
+    passive[j] = true;
+
+    // Solve on the passive set, and step back to the boundary until all of
+    // its weights are positive.
+    while (true) {
+      std::vector<size_t> set;
+      for (size_t i = 0; i < n; i++) {
+        if (passive[i]) set.push_back(i);
+      }
+      Matrix A_set(A.rows(), set.size());
+      for (size_t k = 0; k < set.size(); k++) A_set.col(k) = A.col(set[k]);
+      const Vector z_set = A_set.colPivHouseholderQr().solve(b);
+
+      double alpha = 1.0;
+      bool interior = true;
+      for (size_t k = 0; k < set.size(); k++) {
+        const size_t i = set[k];
+        if (z_set(k) > 0) continue;
+        interior = false;
+        const double step = x(i) - z_set(k);
+        alpha = std::min(alpha, step > 0 ? x(i) / step : 0.0);
+      }
+      if (interior) {
+        for (size_t k = 0; k < set.size(); k++) x(set[k]) = z_set(k);
+        break;
+      }
+      for (size_t k = 0; k < set.size(); k++) {
+        const size_t i = set[k];
+        x(i) += alpha * (z_set(k) - x(i));
+        if (x(i) <= tol) {
+          x(i) = 0.0;
+          passive[i] = false;
+        }
+      }
+    }
+  }
+  return x;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+StaticFeasibility CheckStaticFeasibility(
+    const Robot& robot, const Pose3& wTb, const ContactGoals& goals,
+    const StaticFeasibilityParameters& parameters) {
+  StaticFeasibility result;
+  const LinkSharedPtr base = LegBase(robot);
+
+  // Legs in closed form, and the nominal angles for all other joints.
+  const gtsam::Values legs = ChainInitializer().LegJointAngles(
+      robot, wTb, goals, 0, parameters.nominal);
+  for (auto&& joint : robot.joints()) {
+    const gtsam::Key key = JointAngleKey(joint->id(), 0);
+    double q = 0.0;
+    if (legs.exists(key)) {
+      q = legs.at<double>(key);
+    } else {
+      auto it = parameters.nominal.find(joint->name());
+      if (it != parameters.nominal.end()) q = it->second;
+    }
+    InsertJointAngle(&result.joint_angles, joint->id(), 0, q);
+  }
+  gtsam::Values known = result.joint_angles;
+  InsertPose(&known, base->id(), 0, wTb);
+  const gtsam::Values fk = robot.forwardKinematics(known, 0, base->name());
+
+  // 1. Reachability: the feet of the closest legs at the goals.
+  for (size_t g = 0; g < goals.size(); g++) {
+    const double distance = gtsam::distance3(
+        goals[g].point_on_link.predict(fk, 0), goals[g].goal_point);
+    if (distance > parameters.reach_tolerance) {
+      result.reason = FeasibilityReason::Unreachable;
+      result.goal = g;
+      result.violation = distance;
+      return result;
+    }
+  }
+
+  // 2. Joint limits of the legs.
+  if (parameters.check_joint_limits) {
+    for (auto&& joint : robot.joints()) {
+      const gtsam::Key key = JointAngleKey(joint->id(), 0);
+      if (!legs.exists(key)) continue;
+      const auto& limits = joint->parameters().scalar_limits;
+      const double q = legs.at<double>(key);
+      const double violation = std::max(limits.value_lower_limit - q,
+                                        q - limits.value_upper_limit);
+      if (violation > limits.value_limit_threshold) {
+        result.reason = FeasibilityReason::JointLimits;
+        result.joint = joint->id();
+        result.violation = violation;
+        return result;
+      }
+    }
+  }
+
+  // 3. Static balance: the center of mass of the whole robot, and the weight
+  // it must carry.
+  double mass = 0.0;
+  Point3 com(0, 0, 0);
+  for (auto&& link : robot.links()) {
+    mass += link->mass();
+    com += link->mass() * Pose(fk, link->id(), 0).translation();
+  }
+  const double weight = mass * parameters.gravity.norm();
+  if (!(weight > 0)) return result;
+  com /= mass;
+
+  // Columns are the unit wrenches, at the CoM and in world coordinates, of
+  // the edges of the friction pyramid of every contact.
+  const Vector3 up = -parameters.gravity.normalized();
+  const Vector3 axis = std::abs(up.x()) < 0.9 ? Vector3::UnitX()
+                                              : Vector3::UnitY();
+  const Vector3 t1 = up.cross(axis).normalized(), t2 = up.cross(t1);
+  std::vector<Vector3> edges;
+  for (double s1 : {-1.0, 1.0}) {
+    for (double s2 : {-1.0, 1.0}) {
+      edges.push_back(
+          (up + parameters.mu * (s1 * t1 + s2 * t2)).normalized());
+    }
+  }
+  Matrix A(6, edges.size() * goals.size());
+  for (size_t g = 0; g < goals.size(); g++) {
+    const Vector3 r = goals[g].goal_point - com;
+    for (size_t e = 0; e < edges.size(); e++) {
+      A.col(g * edges.size() + e) << r.cross(edges[e]), edges[e];
+    }
+  }
+
+  // Forces of the edges, per unit weight, that cancel gravity.
+  Vector6 b;
+  b << 0, 0, 0, up;
+  const Vector x = Nnls(A, b);
+
+  std::vector<Vector6> wrenches;
+  for (size_t g = 0; g < goals.size(); g++) {
+    const Vector6 wrench =
+        weight * A.middleCols(g * edges.size(), edges.size()) *
+        x.segment(g * edges.size(), edges.size());
+    wrenches.push_back(wrench);
+  }
+  const Vector6 residual =
+      ResultantWrench(wrenches, mass, Pose3(gtsam::Rot3(), com),
+                      parameters.gravity, boost::none);
+  const double violation = residual.norm() / weight;
+  if (violation > parameters.balance_tolerance) {
+    result.reason = FeasibilityReason::Unbalanced;
+    result.violation = violation;
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+std::vector<StaticFeasibility> CheckStaticFeasibility(
+    const Robot& robot, const std::vector<Pose3>& base_poses,
+    const std::vector<ContactGoals>& goals,
+    const StaticFeasibilityParameters& parameters, size_t num_threads) {
+  if (goals.size() != base_poses.size()) {
+    throw std::invalid_argument(
+        "CheckStaticFeasibility: need foot goals for every base pose");
+  }
+  std::vector<StaticFeasibility> results(base_poses.size());
+  ParallelFor(base_poses.size(), num_threads, [&](size_t k) {
+    results[k] =
+        CheckStaticFeasibility(robot, base_poses[k], goals[k], parameters);
+  });
+  return results;
+}
+
+}  // namespace gtdynamics
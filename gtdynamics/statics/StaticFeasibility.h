@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticFeasibility.h
+ * @brief Fast check whether a stance of contact goals can be reached and
+ * held at rest, before solving a trajectory for it.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Why a stance is, or is not, statically feasible.
+enum class FeasibilityReason {
+  Feasible,     ///< feet reach the goals, and contacts can hold the robot
+  Unreachable,  ///< a goal is out of reach of its leg
+  JointLimits,  ///< a leg reaches its goal only outside the joint limits
+  Unbalanced    ///< no contact forces in the friction cones balance gravity
+};
+
+/// Parameters of CheckStaticFeasibility.
+struct StaticFeasibilityParameters {
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  double mu = 1.0;  ///< friction coefficient of the contacts
+  /// Distance of a foot from its goal above which the goal is unreachable.
+  double reach_tolerance = 1e-3;
+  /// Residual wrench, as a fraction of the weight, above which the robot is
+  /// unbalanced.
+  double balance_tolerance = 1e-3;
+  bool check_joint_limits = true;  ///< check the angles of the legs
+  /// Joint angles by joint name that pick the leg solutions, and give the
+  /// angles of the joints without goals; zero for joints not in it.
+  std::map<std::string, double> nominal;
+};
+
+/// Result of CheckStaticFeasibility.
+struct StaticFeasibility {
+  FeasibilityReason reason = FeasibilityReason::Feasible;
+  int goal = -1;   ///< index of the unreachable goal, -1 if none
+  int joint = -1;  ///< id of the joint beyond its limits, -1 if none
+  /// Size of the violation: distance of the foot from the goal, angle beyond
+  /// the limit, or residual wrench over the weight.
+  double violation = 0.0;
+  gtsam::Values joint_angles;  ///< angles of all joints, at time 0
+
+  /// Whether the stance passed all checks.
+  bool feasible() const { return reason == FeasibilityReason::Feasible; }
+};
+
+/**
+ * @fn Check whether the robot can stand at rest with its base at wTb and the
+ * feet at the goals, without building or optimizing a graph, e.g. to reject
+ * infeasible requests before a trajectory optimization. The checks, in order:
+ *
+ *  1. Reachability: the legs are solved in closed form, see
+ *     ChainInitializer::LegJointAngles, which gives the nearest stretched or
+ *     folded leg for goals out of reach; forward kinematics then measures the
+ *     distance of every foot from its goal.
+ *  2. Joint limits of the leg joints, with the threshold of every joint.
+ *  3. Static balance: contact forces in a friction pyramid at every goal,
+ *     with normals against gravity, must cancel the gravity wrench of the
+ *     whole robot at its center of mass. The forces are the nonnegative least
+ *     squares weights of the pyramid edges, and the residual is the
+ *     ResultantWrench of them and gravity. The pyramid circumscribes the
+ *     friction cone, so a stance the cone can hold is never rejected.
+ *
+ * The check stops at the first failure. Without goals, the robot is
+ * unbalanced.
+ * @param robot      a legged robot, see ChainInitializer::LegJointAngles
+ * @param wTb        pose of the base CoM
+ * @param goals      goal points of the feet, in world coordinates
+ * @param parameters gravity, friction, tolerances and nominal angles
+ */
+StaticFeasibility CheckStaticFeasibility(
+    const Robot& robot, const gtsam::Pose3& wTb, const ContactGoals& goals,
+    const StaticFeasibilityParameters& parameters =
+        StaticFeasibilityParameters());
+
+/**
+ * @fn Check many stances at once, in parallel, see CheckStaticFeasibility.
+ * @param robot       a legged robot
+ * @param base_poses  pose of the base CoM of every stance
+ * @param goals       goal points of the feet of every stance
+ * @param parameters  gravity, friction, tolerances and nominal angles
+ * @param num_threads number of threads, 0 for all threads of the shared
+ * executor
+ */
+std::vector<StaticFeasibility> CheckStaticFeasibility(
+    const Robot& robot, const std::vector<gtsam::Pose3>& base_poses,
+    const std::vector<ContactGoals>& goals,
+    const StaticFeasibilityParameters& parameters =
+        StaticFeasibilityParameters(),
+    size_t num_threads = 0);
+
+}  // namespace gtdynamics
@@ -11,17 +11,21 @@
  * @author Frank Dellaert, Mandy Xie, Yetong Zhang, and Gerry Chen
  */
 
+#include <gtdynamics/statics/Statics.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 
+#include <stdexcept>
+#include <vector>
+
 namespace gtdynamics {
 
 using gtsam::Vector6;
 
 Vector6 GravityWrench(const gtsam::Vector3 &gravity, double mass,
                       const gtsam::Pose3 &wTcom,
-                      gtsam::OptionalJacobian<6, 6> H_wTcom = boost::none) {
+                      gtsam::OptionalJacobian<6, 6> H_wTcom) {
   // Transform gravity from base frame to link COM frame.
   gtsam::Matrix33 H_unrotate;
   const gtsam::Rot3 wRcom = wTcom.rotation();
@@ -77,4 +81,98 @@ Vector6 ResultantWrench(const std::vector<Vector6> &wrenches, double mass,
   }
 }
 
+gtsam::Vector GravityCompensationTorques(const Robot &robot,
+                                         const gtsam::Vector &q,
+                                         const gtsam::Vector3 &gravity,
+                                         boost::optional<gtsam::Matrix &> H_q) {
+  const RobotTopology &topo = robot.topology();
+  const size_t num_links = topo.links.size(), num_joints = topo.joints.size();
+  if (topo.root < 0 || !topo.fixed[topo.root]) {
+    throw std::invalid_argument(
+        "GravityCompensationTorques: robot has no fixed link.");
+  }
+  if (num_links != num_joints + 1 || topo.bfs_order.size() != num_links) {
+    throw std::invalid_argument(
+        "GravityCompensationTorques: links do not form a tree.");
+  }
+  if (static_cast<size_t>(q.size()) != num_joints) {
+    throw std::invalid_argument(
+        "GravityCompensationTorques: expected one angle per joint.");
+  }
+
+  // Forward pass, in BFS order: the joint towards the root of every link,
+  // CoM poses, and the world screw axis of every joint, pointing away from
+  // the root.
+  std::vector<int> rank(num_links), parent(num_links, -1),
+      parent_joint(num_links, -1);
+  for (size_t r = 0; r < num_links; r++) rank[topo.bfs_order[r]] = r;
+  std::vector<gtsam::Pose3> wTcom(num_links);
+  std::vector<Vector6> screws(num_joints);
+  wTcom[topo.root] = topo.links[topo.root]->getFixedPose();
+  for (size_t r = 1; r < num_links; r++) {
+    const int i = topo.bfs_order[r];
+    for (int k = topo.link_joint_offsets[i];
+         k < topo.link_joint_offsets[i + 1]; k++) {
+      if (rank[topo.link_neighbors[k]] < rank[i]) {
+        parent[i] = topo.link_neighbors[k];
+        parent_joint[i] = topo.link_joints[k];
+        break;
+      }
+    }
+    const int j = parent_joint[i];
+    const gtsam::Pose3 pTc = topo.joints[j]->parentTchild(q(j));
+    if (topo.joint_child[j] == i) {
+      wTcom[i] = wTcom[parent[i]] * pTc;
+      screws[j] = wTcom[i].Adjoint(topo.c_screw_axes[j]);
+    } else {
+      wTcom[i] = wTcom[parent[i]] * pTc.inverse();
+      screws[j] = -wTcom[parent[i]].Adjoint(topo.c_screw_axes[j]);
+    }
+  }
+
+  // Backward pass: mass and mass-weighted CoM of the subtree of every link.
+  std::vector<double> subtree_mass(num_links, 0.0);
+  std::vector<gtsam::Vector3> subtree_moment(num_links, gtsam::Z_3x1);
+  for (size_t r = num_links - 1; r > 0; r--) {
+    const int i = topo.bfs_order[r];
+    subtree_mass[i] += topo.masses[i];
+    subtree_moment[i] += topo.masses[i] * wTcom[i].translation();
+    if (parent[i] != topo.root) {
+      subtree_mass[parent[i]] += subtree_mass[i];
+      subtree_moment[parent[i]] += subtree_moment[i];
+    }
+  }
+
+  // Moving joint j with unit speed moves the subtree beyond it with twist
+  // (w, v), and its mass-weighted CoM with a = w x moment + mass * v. The
+  // torque is minus the work rate of gravity, -g.a, and moving an ancestor
+  // joint l changes it by -g.(w_l x a).
+  gtsam::Vector torques(num_joints);
+  std::vector<gtsam::Vector3> rates(num_joints);
+  for (size_t i = 0; i < num_links; i++) {
+    const int j = parent_joint[i];
+    if (j < 0) continue;
+    const Vector6 &screw = screws[j];
+    rates[j] = screw.head<3>().cross(subtree_moment[i]) +
+               subtree_mass[i] * screw.tail<3>();
+    torques(j) = -gravity.dot(rates[j]);
+  }
+
+  if (H_q) {
+    H_q->setZero(num_joints, num_joints);
+    for (size_t i = 0; i < num_links; i++) {
+      const int j = parent_joint[i];
+      if (j < 0) continue;
+      for (int a = i; a != topo.root; a = parent[a]) {
+        const int l = parent_joint[a];
+        const double h =
+            -gravity.dot(screws[l].head<3>().cross(rates[j]));
+        (*H_q)(j, l) = h;
+        (*H_q)(l, j) = h;
+      }
+    }
+  }
+  return torques;
+}
+
 }  // namespace gtdynamics
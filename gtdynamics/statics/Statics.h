@@ -18,6 +18,9 @@
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <vector>
 
 namespace gtdynamics {
 
@@ -56,6 +59,25 @@ gtsam::Vector6 ResultantWrench(const std::vector<gtsam::Vector6>& wrenches,
                                boost::optional<gtsam::Vector3> gravity,
                                boost::optional<std::vector<gtsam::Matrix>&> H);
 
+/**
+ * @fn Joint torques that hold a fixed-base robot at rest against gravity.
+ *
+ * Closed form on the cached RobotTopology, without building a graph: the
+ * torque of a joint is the work rate of gravity on all links beyond it, i.e.,
+ * the gradient of the potential energy, so that the Jacobian is its
+ * (symmetric) Hessian. The torques agree with Statics::solve at the forward
+ * kinematics of q.
+ * @param robot robot with a fixed root link, whose links form a tree
+ * @param q joint angles, in Robot::joints() order
+ * @param gravity 3-vector indicating gravity force, typically, [0,0,-g]
+ * @param H_q optional NxN Jacobian of torques wrt joint angles
+ * @returns N torques, in Robot::joints() order
+ */
+gtsam::Vector GravityCompensationTorques(
+    const Robot& robot, const gtsam::Vector& q,
+    const gtsam::Vector3& gravity = gtsam::Vector3(0, 0, -9.8),
+    boost::optional<gtsam::Matrix&> H_q = boost::none);
+
 /// Noise models etc specific to Statics class
 struct StaticsParameters : public KinematicsParameters {
   boost::optional<gtsam::Vector3> gravity, planar_axis;
@@ -73,9 +95,9 @@ struct StaticsParameters : public KinematicsParameters {
       const boost::optional<gtsam::Vector3>& planar_axis = boost::none)
       : gravity(gravity),
         planar_axis(planar_axis),
-        fs_cost_model(Isotropic::Sigma(6, 1e-4)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)) {}
+        fs_cost_model(SharedIsotropic(6, 1e-4)),
+        f_cost_model(SharedIsotropic(6, sigma_dynamics)),
+        t_cost_model(SharedIsotropic(1, sigma_dynamics)) {}
 };
 
 /// Algorithms for Statics, i.e. kinematics + wrenches at rest
@@ -129,6 +151,33 @@ class Statics : public Kinematics {
   gtsam::Values solve(const Slice& slice, const Robot& robot,
                       const gtsam::Values& configuration) const;
 
+  /**
+   * Linear graph of static balance given a kinematics configuration: given
+   * the poses, static balance is linear in the wrenches and torques.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param configuration A known kinematics configuration.
+   */
+  gtsam::GaussianFactorGraph linearGraph(
+      const Slice& slice, const Robot& robot,
+      const gtsam::Values& configuration) const;
+
+  /**
+   * Solve for wrenches at many kinematics configurations, e.g., for payload
+   * feasibility maps. Every configuration is a linear solve of linearGraph,
+   * with one elimination ordering shared by all configurations, and the
+   * configurations are solved in parallel.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param configurations Known kinematics configurations.
+   * @param num_threads Number of threads, 0 for hardware concurrency.
+   * @return for every configuration, its values with wrenches and torques.
+   */
+  std::vector<gtsam::Values> solveBatch(
+      const Slice& slice, const Robot& robot,
+      const std::vector<gtsam::Values>& configurations,
+      size_t num_threads = 0) const;
+
   /**
    * Solve for wrenches and kinematics configuration.
    * @param slice Slice instance.
@@ -16,7 +16,11 @@
 #include <gtdynamics/factors/WrenchPlanarFactor.h>       // TODO: move
 #include <gtdynamics/statics/StaticWrenchFactor.h>
 #include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/Trace.h>
+#include <gtsam/inference/Ordering.h>
 #include <gtsam/linear/Sampler.h>
+#include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearEquality.h>
@@ -59,6 +63,7 @@ gtsam::NonlinearFactorGraph Statics::wrenchPlanarFactors(
 
 gtsam::NonlinearFactorGraph Statics::graph(const Slice& slice,
                                            const Robot& robot) const {
+  GTDYNAMICS_TRACE_SCOPE_ARG("Statics::graph", slice.k);
   gtsam::NonlinearFactorGraph graph;
   const auto k = slice.k;
 
@@ -113,6 +118,7 @@ gtsam::Values Statics::initialValues(const Slice& slice, const Robot& robot,
 
 gtsam::Values Statics::solve(const Slice& slice, const Robot& robot,
                              const gtsam::Values& configuration) const {
+  GTDYNAMICS_TRACE_SCOPE_ARG("Statics::solve", slice.k);
   auto graph = this->graph(slice, robot);
   gtsam::Values initial_values;
   initial_values.insert(initialValues(slice, robot));
@@ -139,6 +145,70 @@ gtsam::Values Statics::solve(const Slice& slice, const Robot& robot,
   return optimize(graph, initial_values);
 }
 
+gtsam::GaussianFactorGraph Statics::linearGraph(
+    const Slice& slice, const Robot& robot,
+    const gtsam::Values& configuration) const {
+  gtsam::GaussianFactorGraph graph;
+  const auto k = slice.k;
+  const auto fs_model =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+          p_.fs_cost_model);
+
+  // Static balance of every moving link, weighted as StaticWrenchFactor:
+  // F_i_j1 + .. + F_i_jn = - m_i * R_i^T * g
+  for (auto&& link : robot.links()) {
+    int i = link->id();
+    if (link->isFixed()) continue;
+    gtsam::Vector6 rhs = gtsam::Z_6x1;
+    if (p_.gravity) {
+      rhs = -GravityWrench(*p_.gravity, link->mass(),
+                           Pose(configuration, i, k));
+    }
+    std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+    for (auto&& joint : link->joints()) {
+      terms.emplace_back(WrenchKey(i, joint->id(), k), gtsam::I_6x6);
+    }
+    if (!terms.empty()) graph.add(terms, rhs, fs_model);
+  }
+
+  // Torque, wrench equivalence and planar factors of every joint.
+  const OptimizerSetting opt;
+  for (auto&& joint : robot.joints()) {
+    graph += joint->linearDynamicsFactors(k, configuration, opt,
+                                          p_.planar_axis);
+  }
+  return graph;
+}
+
+std::vector<gtsam::Values> Statics::solveBatch(
+    const Slice& slice, const Robot& robot,
+    const std::vector<gtsam::Values>& configurations,
+    size_t num_threads) const {
+  std::vector<gtsam::Values> results(configurations.size());
+  if (configurations.empty()) return results;
+
+  // All configurations have the same graph structure, so they can share
+  // the elimination ordering.
+  const gtsam::Ordering ordering =
+      gtsam::Ordering::Colamd(linearGraph(slice, robot, configurations[0]));
+
+  const auto k = slice.k;
+  ParallelFor(configurations.size(), num_threads, [&](size_t n) {
+    const gtsam::VectorValues solution =
+        linearGraph(slice, robot, configurations[n]).optimize(ordering);
+    gtsam::Values values = configurations[n];
+    for (auto&& joint : robot.joints()) {
+      int j = joint->id();
+      int i1 = joint->parent()->id(), i2 = joint->child()->id();
+      InsertWrench(&values, i1, j, k, solution.at(WrenchKey(i1, j, k)));
+      InsertWrench(&values, i2, j, k, solution.at(WrenchKey(i2, j, k)));
+      InsertTorque(&values, j, k, solution.at(TorqueKey(j, k))[0]);
+    }
+    results[n] = values;
+  });
+  return results;
+}
+
 gtsam::Values Statics::minimizeTorques(const Slice& slice,
                                        const Robot& robot) const {
   auto graph = this->graph(slice, robot);
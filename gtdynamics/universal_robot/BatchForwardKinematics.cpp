@@ -0,0 +1,272 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.cpp
+ * @brief Forward kinematics for many joint configurations at once.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+
+#include <queue>
+#include <stdexcept>
+
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+// Column k of a matrix as an array, for coefficient-wise batch operations.
+template <class M>
+static Eigen::Map<Eigen::Array<typename M::Scalar, Eigen::Dynamic, 1>> Col(
+    M *m, int k) {
+  return Eigen::Map<Eigen::Array<typename M::Scalar, Eigen::Dynamic, 1>>(
+      m->col(k).data(), m->rows());
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+BatchForwardKinematicsT<Scalar>::BatchForwardKinematicsT(
+    const Robot &robot, const boost::optional<std::string> &prior_link_name)
+    : links_(robot.links()),
+      num_joints_(robot.numJoints()),
+      link_index_(robot.topology().link_index),
+      root_(-1) {
+  const RobotTopology &topo = robot.topology();
+
+  // Same root as Robot::forwardKinematics.
+  if (prior_link_name) {
+    root_ = link_index_[robot.link(*prior_link_name)->id()];
+  } else {
+    for (size_t i = 0; i < links_.size(); i++)
+      if (topo.fixed[i]) root_ = i;
+  }
+  if (root_ < 0) {
+    throw std::runtime_error(
+        "BatchForwardKinematics: no prior link given and cannot find a fixed "
+        "link.");
+  }
+
+  // Spanning tree edges in BFS order.
+  std::vector<bool> visited(links_.size(), false);
+  std::queue<int> q;
+  q.push(root_);
+  visited[root_] = true;
+  while (!q.empty()) {
+    const int a = q.front();
+    q.pop();
+    for (int k = topo.link_joint_offsets[a]; k < topo.link_joint_offsets[a + 1];
+         k++) {
+      const int b = topo.link_neighbors[k];
+      if (visited[b]) continue;
+      visited[b] = true;
+      q.push(b);
+
+      Edge e;
+      e.a = a;
+      e.b = b;
+      e.joint = topo.link_joints[k];
+      const auto &joint = topo.joints[e.joint];
+      const bool forward = (topo.joint_child[e.joint] == b);
+      const Pose3 M = forward ? joint->pMc() : joint->pMc().inverse();
+      const gtsam::Vector6 S =
+          forward ? topo.c_screw_axes[e.joint] : topo.p_screw_axes[e.joint];
+      e.S = S.cast<Scalar>();
+
+      // exp(S * q) for S = w * [u; v] with |u| = 1 is a rotation by w * q
+      // about u, with translation (I wq + (1 - cos) K + (wq - sin) K^2) v.
+      // Coefficients are computed in double precision, then rounded.
+      const gtsam::Matrix3 MR = M.rotation().matrix();
+      const gtsam::Vector3 omega = S.head<3>();
+      double w = omega.norm();
+      e.rotational = w > 1e-9;
+      e.A0 = MR.cast<Scalar>();
+      e.b0 = M.translation().cast<Scalar>();
+      if (e.rotational) {
+        const gtsam::Matrix3 K = gtsam::skewSymmetric(omega / w);
+        const gtsam::Vector3 v = S.tail<3>() / w;
+        e.A1 = (MR * K).cast<Scalar>();
+        e.A2 = (MR * K * K).cast<Scalar>();
+        e.b1 = (MR * v).cast<Scalar>();
+        e.b2 = (MR * K * v).cast<Scalar>();
+        e.b3 = (MR * K * K * v).cast<Scalar>();
+      } else {
+        w = 1.0;
+        e.A1.setZero();
+        e.A2.setZero();
+        e.b1 = (MR * S.tail<3>()).cast<Scalar>();
+        e.b2.setZero();
+        e.b3.setZero();
+      }
+      e.w = Scalar(w);
+      edges_.push_back(e);
+    }
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+std::vector<int> BatchForwardKinematicsT<Scalar>::treeJoints() const {
+  std::vector<int> joints;
+  joints.reserve(edges_.size());
+  for (const Edge &e : edges_) joints.push_back(e.joint);
+  return joints;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void BatchForwardKinematicsT<Scalar>::compute(
+    const Matrix &joint_angles, const Matrix &joint_vels,
+    const boost::optional<Pose3> &root_pose,
+    const boost::optional<gtsam::Vector6> &root_twist) {
+  const int N = joint_angles.rows();
+  const bool has_vels = joint_vels.size() > 0;
+  if (size_t(joint_angles.cols()) != num_joints_ ||
+      (has_vels && (joint_vels.rows() != N ||
+                    size_t(joint_vels.cols()) != num_joints_))) {
+    throw std::invalid_argument(
+        "BatchForwardKinematics: joint matrices must be N x numJoints");
+  }
+
+  const size_t num_links = links_.size();
+  poses_.setZero(N, 12 * num_links);
+  twists_.setZero(N, 6 * num_links);
+  relative_.resize(N, 12);
+  work_.resize(N, 3);
+  for (size_t i = 0; i < num_links; i++)
+    for (int r = 0; r < 3; r++) Col(&poses_, 12 * i + 4 * r).setOnes();
+
+  // Root link.
+  const auto &root_link = links_[root_];
+  const Pose3 T0 = root_pose ? *root_pose
+                             : (root_link->isFixed() ? root_link->getFixedPose()
+                                                     : Pose3());
+  const gtsam::Matrix3 R0 = T0.rotation().matrix();
+  const int p0 = 12 * root_, v0 = 6 * root_;
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++)
+      Col(&poses_, p0 + 3 * r + c) = Scalar(R0(r, c));
+    Col(&poses_, p0 + 9 + r) = Scalar(T0.translation()(r));
+  }
+  if (root_twist) {
+    for (int k = 0; k < 6; k++)
+      Col(&twists_, v0 + k) = Scalar((*root_twist)(k));
+  }
+
+  typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> Array;
+  Eigen::Map<Array> theta = Col(&work_, 0), s = Col(&work_, 1),
+                    omc = Col(&work_, 2);
+  for (const Edge &e : edges_) {
+    const int pa = 12 * e.a, pb = 12 * e.b, va = 6 * e.a, vb = 6 * e.b;
+    const Eigen::Map<const Array> q(joint_angles.col(e.joint).data(), N);
+
+    // Relative pose T_ab, rotation row-major in columns 0-8 of relative_.
+    theta = e.w * q;
+    if (e.rotational) {
+      s = theta.sin();
+      omc = Scalar(1) - theta.cos();
+      for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++)
+          Col(&relative_, 3 * r + c) =
+              e.A0(r, c) + e.A1(r, c) * s + e.A2(r, c) * omc;
+      for (int r = 0; r < 3; r++)
+        Col(&relative_, 9 + r) = e.b0(r) + e.b1(r) * theta +
+                                 e.b2(r) * omc + e.b3(r) * (theta - s);
+    } else {
+      for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++) Col(&relative_, 3 * r + c) = e.A0(r, c);
+      for (int r = 0; r < 3; r++)
+        Col(&relative_, 9 + r) = e.b0(r) + e.b1(r) * theta;
+    }
+
+    // World pose T_b = T_a * T_ab.
+    for (int r = 0; r < 3; r++) {
+      for (int c = 0; c < 3; c++) {
+        Col(&poses_, pb + 3 * r + c) =
+            Col(&poses_, pa + 3 * r) * Col(&relative_, c) +
+            Col(&poses_, pa + 3 * r + 1) * Col(&relative_, 3 + c) +
+            Col(&poses_, pa + 3 * r + 2) * Col(&relative_, 6 + c);
+      }
+      Col(&poses_, pb + 9 + r) =
+          Col(&poses_, pa + 3 * r) * Col(&relative_, 9) +
+          Col(&poses_, pa + 3 * r + 1) * Col(&relative_, 10) +
+          Col(&poses_, pa + 3 * r + 2) * Col(&relative_, 11) +
+          Col(&poses_, pa + 9 + r);
+    }
+
+    // Twist V_b = Ad(T_ab^-1) * V_a + S * qdot, where the linear part of
+    // Ad(T_ab^-1) * V_a is R_ab^T * (v_a - t_ab x w_a).
+    for (int l = 0; l < 3; l++) {
+      const int l1 = (l + 1) % 3, l2 = (l + 2) % 3;
+      // work_ columns 0-2 are free again, reuse them for v_a - t_ab x w_a.
+      Col(&work_, l) = Col(&twists_, va + 3 + l) -
+                       (Col(&relative_, 9 + l1) * Col(&twists_, va + l2) -
+                        Col(&relative_, 9 + l2) * Col(&twists_, va + l1));
+    }
+    for (int r = 0; r < 3; r++) {
+      Col(&twists_, vb + r) = Col(&relative_, r) * Col(&twists_, va) +
+                              Col(&relative_, 3 + r) * Col(&twists_, va + 1) +
+                              Col(&relative_, 6 + r) * Col(&twists_, va + 2);
+      Col(&twists_, vb + 3 + r) = Col(&relative_, r) * Col(&work_, 0) +
+                                  Col(&relative_, 3 + r) * Col(&work_, 1) +
+                                  Col(&relative_, 6 + r) * Col(&work_, 2);
+    }
+    if (has_vels) {
+      const Eigen::Map<const Array> qdot(joint_vels.col(e.joint).data(), N);
+      for (int k = 0; k < 6; k++) Col(&twists_, vb + k) += e.S(k) * qdot;
+    }
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+Pose3 BatchForwardKinematicsT<Scalar>::pose(size_t n, uint16_t link_id) const {
+  const int p = 12 * linkIndex(link_id);
+  const auto row = poses_.row(n);
+  return Pose3(gtsam::Rot3(row(p), row(p + 1), row(p + 2), row(p + 3),
+                           row(p + 4), row(p + 5), row(p + 6), row(p + 7),
+                           row(p + 8)),
+               gtsam::Point3(row(p + 9), row(p + 10), row(p + 11)));
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+gtsam::Vector6 BatchForwardKinematicsT<Scalar>::twist(size_t n,
+                                                      uint16_t link_id) const {
+  const int v = 6 * linkIndex(link_id);
+  return twists_.template block<1, 6>(n, v).transpose().template cast<double>();
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+typename BatchForwardKinematicsT<Scalar>::Matrix
+BatchForwardKinematicsT<Scalar>::pointPositions(
+    const PointOnLinks &points) const {
+  typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> Array;
+  const int N = poses_.rows();
+  Matrix positions(N, 3 * points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    const int p = 12 * linkIndex(points[i].link->id());
+    const Vector3 point = points[i].point.cast<Scalar>();
+    // R * point + t, with R row-major in columns p to p + 8.
+    for (int r = 0; r < 3; r++) {
+      Col(&positions, 3 * i + r) =
+          Eigen::Map<const Array>(poses_.col(p + 3 * r).data(), N) * point(0) +
+          Eigen::Map<const Array>(poses_.col(p + 3 * r + 1).data(), N) *
+              point(1) +
+          Eigen::Map<const Array>(poses_.col(p + 3 * r + 2).data(), N) *
+              point(2) +
+          Eigen::Map<const Array>(poses_.col(p + 9 + r).data(), N);
+    }
+  }
+  return positions;
+}
+
+template class BatchForwardKinematicsT<double>;
+template class BatchForwardKinematicsT<float>;
+
+}  // namespace gtdynamics
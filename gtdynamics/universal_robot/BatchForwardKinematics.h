@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.h
+ * @brief Forward kinematics for many joint configurations at once.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * BatchForwardKinematics computes CoM poses and twists of all links for a
+ * batch of N joint configurations, with the same conventions as
+ * Robot::forwardKinematics.
+ *
+ * The spanning tree of the robot is traversed once at construction, and each
+ * relative pose is factored as M * exp(S * q), so that a batch only needs a
+ * vectorized sin/cos per joint followed by constant-coefficient products.
+ * Results are stored with the batch index as the fastest-varying dimension:
+ * poses() is N x (12 * numLinks), with the row-major rotation followed by the
+ * translation of link i in columns 12 * i to 12 * i + 11, and twists() is
+ * N x (6 * numLinks). Links are indexed as in Robot::links().
+ *
+ * Joints that close kinematic loops are not traversed, so unlike
+ * Robot::forwardKinematics no consistency check is made for them. Links not
+ * connected to the root keep the identity pose and zero twist.
+ *
+ * The batch is computed in precision Scalar: BatchForwardKinematicsf trades
+ * accuracy, ~1e-5 in poses, for twice the SIMD width, which suits screening
+ * many candidate configurations before refining a few in double precision.
+ */
+template <typename Scalar>
+class BatchForwardKinematicsT {
+ public:
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+ private:
+  typedef Eigen::Matrix<Scalar, 3, 3> Matrix3;
+  typedef Eigen::Matrix<Scalar, 3, 1> Vector3;
+  typedef Eigen::Matrix<Scalar, 6, 1> Vector6;
+
+  /// Tree edge from link a to link b, with T_ab(q) = M * exp(S * q).
+  struct Edge {
+    int a, b, joint;
+    bool rotational;
+    Scalar w;  // norm of the angular part of S
+    Vector6 S;
+    // R_ab = A0 + sin(wq) * A1 + (1 - cos(wq)) * A2
+    Matrix3 A0, A1, A2;
+    // t_ab = b0 + wq * b1 + (1 - cos(wq)) * b2 + (wq - sin(wq)) * b3
+    Vector3 b0, b1, b2, b3;
+  };
+
+  std::vector<LinkSharedPtr> links_;
+  size_t num_joints_;
+  std::vector<int> link_index_;
+  int root_;
+  std::vector<Edge> edges_;
+
+  Matrix poses_, twists_, relative_, work_;
+
+ public:
+  /**
+   * Constructor, precomputes the traversal.
+   * @param robot           the robot
+   * @param prior_link_name name of the root link, by default the fixed link
+   */
+  explicit BatchForwardKinematicsT(
+      const Robot &robot,
+      const boost::optional<std::string> &prior_link_name = boost::none);
+
+  /**
+   * Compute poses and twists for a batch of configurations.
+   *
+   * @param joint_angles N x numJoints matrix, columns in Robot::joints() order
+   * @param joint_vels   N x numJoints matrix, or empty for zero velocities
+   * @param root_pose    root link pose, by default its fixed pose if fixed
+   * and the identity otherwise
+   * @param root_twist   root link twist, by default zero
+   */
+  void compute(const Matrix &joint_angles,
+               const Matrix &joint_vels = Matrix(),
+               const boost::optional<gtsam::Pose3> &root_pose = boost::none,
+               const boost::optional<gtsam::Vector6> &root_twist = boost::none);
+
+  /// Number of configurations in the last batch.
+  size_t batchSize() const { return poses_.rows(); }
+
+  /// Number of links.
+  size_t numLinks() const { return links_.size(); }
+
+  /// Index of the link with the given id in the result columns.
+  int linkIndex(uint16_t id) const { return link_index_.at(id); }
+
+  /// Index of the root link, in Robot::links() order.
+  int rootIndex() const { return root_; }
+
+  /// Indices of the joints traversed, in Robot::joints() order, in BFS
+  /// order; the remaining joints close kinematic loops.
+  std::vector<int> treeJoints() const;
+
+  /// Poses of the last batch, N x (12 * numLinks).
+  const Matrix &poses() const { return poses_; }
+
+  /// Twists of the last batch, N x (6 * numLinks).
+  const Matrix &twists() const { return twists_; }
+
+  /// Pose of a link in configuration n of the last batch.
+  gtsam::Pose3 pose(size_t n, uint16_t link_id) const;
+
+  /// Twist of a link in configuration n of the last batch.
+  gtsam::Vector6 twist(size_t n, uint16_t link_id) const;
+
+  /**
+   * World positions of points on links, e.g. contact or collision points,
+   * for every configuration of the last batch.
+   * @param points points on links of the robot
+   * @return N x (3 * points.size()) matrix, the position of point i in
+   * columns 3 * i to 3 * i + 2
+   */
+  Matrix pointPositions(const PointOnLinks &points) const;
+};
+
+typedef BatchForwardKinematicsT<double> BatchForwardKinematics;
+typedef BatchForwardKinematicsT<float> BatchForwardKinematicsf;
+
+}  // namespace gtdynamics
@@ -0,0 +1,133 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ForwardKinematicsCache.cpp
+ * @brief Incrementally updated link poses of a robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/ForwardKinematicsCache.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ForwardKinematicsCache::ForwardKinematicsCache(const Robot &robot)
+    : topology_(robot.topology()) {
+  const size_t num_links = numLinks(), num_joints = numJoints();
+  joint_link_.assign(num_joints, -1);
+  poses_.resize(num_links);
+  for (size_t i = 0; i < num_links; i++) {
+    const int j = topology_.tree_joint[i];
+    if (j >= 0) joint_link_[j] = i;
+    const auto &link = topology_.links[i];
+    if (link->isFixed()) poses_[i] = link->getFixedPose();
+  }
+  joint_angles_ = gtsam::Vector::Zero(num_joints);
+  stale_pose_.assign(num_links, true);
+  updated_.assign(num_links, false);
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::invalidateBelow(int i) {
+  stale_pose_[i] = true;
+  stale_ = true;
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::setRootPose(const Pose3 &pose) {
+  const int root = topology_.root;
+  if (root < 0) return;
+  num_recomputed_ = 0;
+  poses_[root] = pose;
+  invalidateBelow(root);
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::setJointAngle(int j, double q) {
+  if (j < 0 || size_t(j) >= numJoints()) {
+    throw std::out_of_range("ForwardKinematicsCache: no joint with index " +
+                            std::to_string(j));
+  }
+  num_recomputed_ = 0;
+  if (joint_angles_(j) == q) return;
+  joint_angles_(j) = q;
+  if (joint_link_[j] >= 0) invalidateBelow(joint_link_[j]);
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::setJointAngles(
+    const gtsam::Vector &joint_angles) {
+  if (size_t(joint_angles.size()) != numJoints()) {
+    throw std::invalid_argument(
+        "ForwardKinematicsCache: joint angles do not match the robot");
+  }
+  for (size_t j = 0; j < numJoints(); j++) setJointAngle(j, joint_angles(j));
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::setJointAngles(const gtsam::Values &values,
+                                            int t) {
+  for (size_t j = 0; j < numJoints(); j++) {
+    setJointAngle(j, JointAngle(values, topology_.joints[j]->id(), t));
+  }
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::refresh() const {
+  if (!stale_) return;
+  // Parents come first in forest_order, so a link is recomputed if it was
+  // marked or its tree parent was recomputed in this pass. Roots keep their
+  // pose, set at construction or by setRootPose.
+  for (int i : topology_.forest_order) {
+    const int parent = topology_.tree_parent[i];
+    updated_[i] = stale_pose_[i] || (parent >= 0 && updated_[parent]);
+    if (!updated_[i]) continue;
+    if (parent >= 0) {
+      const int j = topology_.tree_joint[i];
+      poses_[i] = poses_[parent] * topology_.joints[j]->relativePoseOf(
+                                       topology_.links[i], joint_angles_(j));
+    }
+    stale_pose_[i] = false;
+    num_recomputed_++;
+  }
+  stale_ = false;
+}
+
+/* ************************************************************************* */
+const Pose3 &ForwardKinematicsCache::pose(int i) const {
+  refresh();
+  return poses_.at(i);
+}
+
+/* ************************************************************************* */
+const std::vector<Pose3> &ForwardKinematicsCache::poses() const {
+  refresh();
+  return poses_;
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsCache::insertPoses(gtsam::Values *values, int t) const {
+  refresh();
+  for (size_t i = 0; i < numLinks(); i++) {
+    InsertPose(values, topology_.links[i]->id(), t, poses_[i]);
+  }
+}
+
+/* ************************************************************************* */
+size_t ForwardKinematicsCache::numRecomputed() const {
+  refresh();
+  return num_recomputed_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ForwardKinematicsCache.h
+ * @brief Incrementally updated link poses of a robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotTopology.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ForwardKinematicsCache holds the CoM poses of all links for the current
+ * joint angles, with the conventions of Robot::forwardKinematics, for queries
+ * that change few joints at a time such as IK iterations or planners.
+ *
+ * The pose of a link only depends on the joint angles on its path to the root
+ * of its tree in the spanning forest of the robot topology, so changing the
+ * angle of a joint only invalidates the subtree below it. Setters mark the
+ * link the joint leads to, and accessors recompute the marked subtrees on
+ * demand, in BFS order; everything else is reused. Joints that close loops
+ * are not tree edges and their angles do not affect any pose.
+ *
+ * The root of the topology has the pose given by setRootPose, by default its
+ * fixed pose if it is fixed and the identity otherwise. Roots of links it does
+ * not reach follow the same default. Links and joints are referred to by their
+ * index in Robot::links() and Robot::joints(). Accessors are not thread-safe,
+ * as they may update the cache.
+ */
+class ForwardKinematicsCache {
+ private:
+  RobotTopology topology_;
+
+  /// Per joint: the link it leads to in the spanning forest, -1 if none.
+  std::vector<int> joint_link_;
+
+  gtsam::Vector joint_angles_;
+
+  /// Per link: CoM pose, stale flag for the link itself, and whether it was
+  /// recomputed by the last refresh, which makes its children stale.
+  mutable std::vector<gtsam::Pose3> poses_;
+  mutable std::vector<bool> stale_pose_, updated_;
+  mutable bool stale_ = true;
+  mutable size_t num_recomputed_ = 0;  // since joint angles were last set
+
+  /// Mark link i stale, so that its subtree is recomputed.
+  void invalidateBelow(int i);
+
+  /// Recompute the poses of stale subtrees.
+  void refresh() const;
+
+ public:
+  /// Constructor, with all joint angles zero.
+  explicit ForwardKinematicsCache(const Robot &robot);
+
+  /// Number of links.
+  size_t numLinks() const { return topology_.links.size(); }
+
+  /// Number of joints.
+  size_t numJoints() const { return topology_.joints.size(); }
+
+  /// The topology, whose spanning forest defines the subtrees.
+  const RobotTopology &topology() const { return topology_; }
+
+  /// Set the CoM pose of the root link of the topology.
+  void setRootPose(const gtsam::Pose3 &pose);
+
+  /// Set the angle of joint j.
+  void setJointAngle(int j, double q);
+
+  /// Set all joint angles, in Robot::joints() order; only the joints whose
+  /// angle changed invalidate the cache.
+  void setJointAngles(const gtsam::Vector &joint_angles);
+
+  /// Set all joint angles from the values of time step t.
+  void setJointAngles(const gtsam::Values &values, int t = 0);
+
+  /// Current joint angles.
+  const gtsam::Vector &jointAngles() const { return joint_angles_; }
+
+  /// CoM pose of link i.
+  const gtsam::Pose3 &pose(int i) const;
+
+  /// CoM poses of all links, in Robot::links() order.
+  const std::vector<gtsam::Pose3> &poses() const;
+
+  /// Insert the link poses of time step t into values.
+  void insertPoses(gtsam::Values *values, int t = 0) const;
+
+  /// Number of link poses recomputed since joint angles were last set,
+  /// including by this call.
+  size_t numRecomputed() const;
+};
+
+}  // namespace gtdynamics
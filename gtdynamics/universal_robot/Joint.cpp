@@ -16,9 +16,13 @@
 
 #include <gtdynamics/factors/JointLimitFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtsam/slam/expressions.h>
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <iostream>
 
 using gtsam::Pose3;
@@ -27,7 +31,7 @@ using gtsam::Vector6;
 namespace gtdynamics {
 
 /* ************************************************************************* */
-Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+Joint::Joint(uint16_t id, const std::string &name, const Pose3 &bTj,
              const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
              const Vector6 &jScrewAxis, const JointParams &parameters)
     : id_(id),
@@ -42,40 +46,53 @@ Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
 
 /* ************************************************************************* */
 bool Joint::isChildLink(const LinkSharedPtr &link) const {
-  if (link != child_link_ && link != parent_link_)
+  // Compare ids: Robot::fixLink variants hold copies of the connected links.
+  if (link->id() != child_link_->id() && link->id() != parent_link_->id())
     throw std::runtime_error("link " + link->name() +
                              " is not connected to this joint " + name_);
-  return link == child_link_;
+  return link->id() == child_link_->id();
 }
 
+/* ************************************************************************* */
+uint64_t Joint::NextSerial() {
+  static std::atomic<uint64_t> next_serial(1);
+  return next_serial++;
+}
+
+namespace {
+/// Entry of the per-thread cache of joint motions, see Joint::parentTchild.
+struct MotionCacheEntry {
+  uint64_t serial = 0;  // 0 for an empty entry
+  double q = 0;
+  Pose3 pTc;
+};
+constexpr size_t kMotionCacheSize = 256;
+}  // namespace
+
 /* ************************************************************************* */
 Pose3 Joint::parentTchild(double q,
                           gtsam::OptionalJacobian<6, 1> pTc_H_q) const {
-  // Multiply screw axis with joint angle to get a finite 6D screw.
-  const Vector6 screw = cScrewAxis_ * q;
-
-  // Calculate the actual relative pose taking into account the joint angle.
-  // TODO(dellaert): use formula `pMj_ * screw_around_Z * jMc_`.
-  gtsam::Matrix6 exp_H_screw;
-  const Pose3 exp = Pose3::Expmap(screw, pTc_H_q ? &exp_H_screw : 0);
-  if (pTc_H_q) {
-    *pTc_H_q = exp_H_screw * cScrewAxis_;
+  // The derivative is the screw axis for any q, so only the pose is cached.
+  if (pTc_H_q) *pTc_H_q = cScrewAxis_;
+
+  static thread_local std::array<MotionCacheEntry, kMotionCacheSize> cache;
+  const size_t slot =
+      (std::hash<double>()(q) ^ (serial_ * 0x9E3779B97F4A7C15ull)) %
+      kMotionCacheSize;
+  MotionCacheEntry &entry = cache[slot];
+  if (entry.serial != serial_ || entry.q != q) {
+    entry.serial = serial_;
+    entry.q = q;
+    entry.pTc = pMc() * JointMotion<Joint>::Expmap(cScrewAxis_, q);
   }
-  return pMc() * exp;  // Note: derivative of compose in exp is identity.
+  return entry.pTc;
 }
 
 /* ************************************************************************* */
 Pose3 Joint::childTparent(double q,
                           gtsam::OptionalJacobian<6, 1> cTp_H_q) const {
-  // TODO(frank): don't go via inverse, specialize in base class
-  Vector6 pTc_H_q;
-  Pose3 pTc = parentTchild(q, cTp_H_q ? &pTc_H_q : 0);  // pTc(q) ->  pTc_H_q
-  gtsam::Matrix6 cTp_H_pTc;
-  Pose3 cTp = pTc.inverse(cTp_H_q ? &cTp_H_pTc : 0);  // cTp(pTc) ->  cTp_H_pTc
-  if (cTp_H_q) {
-    *cTp_H_q = cTp_H_pTc * pTc_H_q;
-  }
-  return cTp;
+  if (cTp_H_q) *cTp_H_q = pScrewAxis_;
+  return parentTchild(q).inverse();
 }
 
 /* ************************************************************************* */
@@ -84,26 +101,9 @@ Vector6 Joint::transformTwistTo(
     boost::optional<Vector6> other_twist, gtsam::OptionalJacobian<6, 1> H_q,
     gtsam::OptionalJacobian<6, 1> H_q_dot,
     gtsam::OptionalJacobian<6, 6> H_other_twist) const {
-  Vector6 other_twist_ = other_twist ? *other_twist : Vector6::Zero();
-  auto other = otherLink(link);
-
-  // Intermediate Jacobian declarations
-  gtsam::Matrix61 T_H_q;
-  gtsam::Matrix6 H_T;
-
-  // Calculations
-  auto twist_from_other =
-      relativePoseOf(other, q, H_q ? &T_H_q : nullptr)
-          .Adjoint(other_twist_, H_q ? &H_T : nullptr, H_other_twist);
-
-  if (H_q) {
-    *H_q = H_T * T_H_q;
-  }
-  if (H_q_dot) {
-    *H_q_dot = screwAxis(link);
-  }
-
-  return twist_from_other + screwAxis(link) * q_dot;
+  return TransformTwistTo<Joint>(*this, link, q, q_dot,
+                                 other_twist ? *other_twist : Vector6::Zero(),
+                                 H_q, H_q_dot, H_other_twist);
 }
 
 /* ************************************************************************* */
@@ -111,20 +111,8 @@ Vector6 Joint::transformWrenchCoordinate(
     const LinkSharedPtr &link, double q, const gtsam::Vector6 &wrench,
     gtsam::OptionalJacobian<6, 1> H_q,
     gtsam::OptionalJacobian<6, 6> H_wrench) const {
-  auto other = otherLink(link);
-
-  // Intermediate Jacobian declarations
-  gtsam::Matrix6 H_T_21;
-  gtsam::Matrix61 T_21_H_q;
-
-  gtsam::Pose3 T_21 = relativePoseOf(other, q, H_q ? &T_21_H_q : nullptr);
-  gtsam::Vector6 transformed_wrench =
-      T_21.AdjointTranspose(wrench, H_q ? &H_T_21 : nullptr, H_wrench);
-
-  if (H_q) {
-    *H_q = H_T_21 * T_21_H_q;
-  }
-  return transformed_wrench;
+  return TransformWrenchCoordinate<Joint>(*this, link, q, wrench, H_q,
+                                          H_wrench);
 }
 
 /* ************************************************************************* */
@@ -145,8 +133,7 @@ gtsam::GaussianFactorGraph Joint::linearFDPriors(
   gtsam::GaussianFactorGraph priors;
   gtsam::Vector1 rhs(Torque(known_values, id(), t));
   // TODO(alej`andro): use optimizer settings
-  priors.add(TorqueKey(id(), t), gtsam::I_1x1, rhs,
-             gtsam::noiseModel::Constrained::All(1));
+  priors.add(TorqueKey(id(), t), gtsam::I_1x1, rhs, SharedConstrained(1));
   return priors;
 }
 
@@ -168,8 +155,7 @@ gtsam::GaussianFactorGraph Joint::linearAFactors(
   Vector6 rhs_tw = Pose3::adjointMap(V_i2) * S_i2_j * v_j;
   graph.add(TwistAccelKey(child()->id(), t), gtsam::I_6x6,
             TwistAccelKey(parent()->id(), t), -T_i2i1.AdjointMap(),
-            JointAccelKey(id(), t), -S_i2_j, rhs_tw,
-            gtsam::noiseModel::Constrained::All(6));
+            JointAccelKey(id(), t), -S_i2_j, rhs_tw, SharedConstrained(6));
 
   return graph;
 }
@@ -190,20 +176,20 @@ gtsam::GaussianFactorGraph Joint::linearDynamicsFactors(
   gtsam::Vector1 rhs_torque = gtsam::Vector1::Zero();
   graph.add(WrenchKey(child()->id(), id(), t), S_i2_j.transpose(),
             TorqueKey(id(), t), -gtsam::I_1x1, rhs_torque,
-            gtsam::noiseModel::Constrained::All(1));
+            SharedConstrained(1));
 
   // wrench equivalence factor
   // F_i1_j + Ad(T_i2i1)^T F_i2_j = 0
   Vector6 rhs_weq = Vector6::Zero();
   graph.add(WrenchKey(parent()->id(), id(), t), gtsam::I_6x6,
             WrenchKey(child()->id(), id(), t), T_i2i1.AdjointMap().transpose(),
-            rhs_weq, gtsam::noiseModel::Constrained::All(6));
+            rhs_weq, SharedConstrained(6));
 
   // wrench planar factor
   if (planar_axis) {
     gtsam::Matrix36 J_wrench = getPlanarJacobian(*planar_axis);
     graph.add(WrenchKey(child()->id(), id(), t), J_wrench,
-              gtsam::Vector3::Zero(), gtsam::noiseModel::Constrained::All(3));
+              gtsam::Vector3::Zero(), SharedConstrained(3));
   }
 
   return graph;
@@ -112,6 +112,7 @@ struct JointParams {
 class Joint : public boost::enable_shared_from_this<Joint> {
   /// Robot class should have access to the internals of its joints.
   friend class Robot;
+  friend class RobotBinaryCodec;
 
  protected:
   using Pose3 = gtsam::Pose3;
@@ -141,7 +142,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   std::string name_;
 
   /// ID reference to DynamicsSymbol.
-  uint8_t id_;
+  uint16_t id_;
 
   /// Rest transform to parent link CoM frame from joint frame.
   Pose3 jMp_;
@@ -159,6 +160,12 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   /// Joint parameters struct.
   JointParams parameters_;
 
+  /// Unique number identifying this joint's kinematics in the motion cache.
+  uint64_t serial_ = NextSerial();
+
+  /// Return a new unique serial number.
+  static uint64_t NextSerial();
+
   /// Check if the link is a child link, throw an error if link is not
   /// connected to this joint.
   bool isChildLink(const LinkSharedPtr &link) const;
@@ -179,7 +186,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
    * @param[in] jScrewAxis   Screw axis in the joint frame
    * @param[in] parameters   The joint parameters.
    */
-  Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+  Joint(uint16_t id, const std::string &name, const Pose3 &bTj,
         const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
         const Vector6 &jScrewAxis,
         const JointParams &parameters = JointParams());
@@ -196,7 +203,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   JointConstSharedPtr shared() const { return shared_from_this(); }
 
   /// Get the joint's ID.
-  uint8_t id() const { return id_; }
+  uint16_t id() const { return id_; }
 
   /// Return (unchanging) pose of the parent link's COM in the joint frame.
   const Pose3 &jMp() const { return jMp_; }
@@ -281,7 +288,10 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   /**@}*/
 
   /**
-   * Return transform of child link CoM frame w.r.t parent link CoM frame
+   * Return transform of child link CoM frame w.r.t parent link CoM frame.
+   *
+   * The factors of one time step all evaluate the same (joint, q) pairs, so
+   * the result is memoized per thread in a small cache keyed by joint and q.
    */
   Pose3 parentTchild(double q,
                      gtsam::OptionalJacobian<6, 1> pMc_H_q = boost::none) const;
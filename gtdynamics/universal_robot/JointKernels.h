@@ -0,0 +1,242 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKernels.h
+ * @brief Joint kinematics specialized at compile time per joint type.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/utils/GraphArena.h>
+#include <gtdynamics/utils/SE3Batch.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace gtdynamics {
+
+/**
+ * JointMotion<JOINT>::Expmap(S, q) returns Pose3::Expmap(S * q) for the screw
+ * axis S of a joint of type JOINT, expressed in any frame. The generic version
+ * is for joints of unknown type; the specializations use the structure of the
+ * screw axis of their type to skip the general exponential map.
+ */
+template <class JOINT>
+struct JointMotion {
+  static gtsam::Pose3 Expmap(const gtsam::Vector6 &S, double q) {
+    return gtsam::Pose3::Expmap(S * q);
+  }
+};
+
+/// Revolute joints rotate about a line: S = (w, v) with w.v = 0.
+template <>
+struct JointMotion<RevoluteJoint> {
+  static gtsam::Pose3 Expmap(const gtsam::Vector6 &S, double q) {
+    const gtsam::Vector3 w = S.head<3>(), v = S.tail<3>();
+    const gtsam::Rot3 R = gtsam::Rot3::Expmap(w * q);
+    // A point on the rotation axis stays in place.
+    const gtsam::Vector3 c = w.cross(v) / w.squaredNorm();
+    return gtsam::Pose3(R, c - R * c);
+  }
+};
+
+/// Prismatic joints translate: S = (0, v).
+template <>
+struct JointMotion<PrismaticJoint> {
+  static gtsam::Pose3 Expmap(const gtsam::Vector6 &S, double q) {
+    return gtsam::Pose3(gtsam::Rot3(), S.tail<3>() * q);
+  }
+};
+
+/// Helical joints rotate about and translate along a line, with w != 0.
+template <>
+struct JointMotion<HelicalJoint> {
+  static gtsam::Pose3 Expmap(const gtsam::Vector6 &S, double q) {
+    const gtsam::Vector3 w = S.head<3>(), v = S.tail<3>();
+    const double w2 = w.squaredNorm();
+    if (w2 == 0) return JointMotion<PrismaticJoint>::Expmap(S, q);
+    const gtsam::Rot3 R = gtsam::Rot3::Expmap(w * q);
+    const gtsam::Vector3 c = w.cross(v) / w2;
+    return gtsam::Pose3(R, c - R * c + w * (w.dot(v) * q / w2));
+  }
+};
+
+/// Fixed joints do not move.
+template <>
+struct JointMotion<FixedJoint> {
+  static gtsam::Pose3 Expmap(const gtsam::Vector6 &, double) {
+    return gtsam::Pose3();
+  }
+};
+
+/**
+ * Same as Joint::parentTchild, for a joint of type JOINT.
+ *
+ * Since the motion is a one-parameter subgroup, the derivative in the tangent
+ * space of pTc is the screw axis in the child frame, for any q.
+ */
+template <class JOINT>
+gtsam::Pose3 ParentTchild(const Joint &joint, double q,
+                          gtsam::OptionalJacobian<6, 1> H_q = boost::none) {
+  if (H_q) *H_q = joint.cScrewAxis();
+  return joint.pMc() * JointMotion<JOINT>::Expmap(joint.cScrewAxis(), q);
+}
+
+/**
+ * Same as Joint::childTparent, for a joint of type JOINT. The derivative in
+ * the tangent space of cTp is the screw axis in the parent frame.
+ */
+template <class JOINT>
+gtsam::Pose3 ChildTparent(const Joint &joint, double q,
+                          gtsam::OptionalJacobian<6, 1> H_q = boost::none) {
+  if (H_q) *H_q = joint.pScrewAxis();
+  return JointMotion<JOINT>::Expmap(joint.cScrewAxis(), -q) *
+         joint.pMc().inverse();
+}
+
+/// For joints of unknown type, use the memoized Joint::parentTchild.
+template <>
+inline gtsam::Pose3 ParentTchild<Joint>(const Joint &joint, double q,
+                                        gtsam::OptionalJacobian<6, 1> H_q) {
+  return joint.parentTchild(q, H_q);
+}
+
+/// For joints of unknown type, use the memoized Joint::childTparent.
+template <>
+inline gtsam::Pose3 ChildTparent<Joint>(const Joint &joint, double q,
+                                        gtsam::OptionalJacobian<6, 1> H_q) {
+  return joint.childTparent(q, H_q);
+}
+
+/**
+ * Same as Joint::transformTwistTo, for a joint of type JOINT: the twist of
+ * link given the twist of the other link.
+ */
+template <class JOINT>
+gtsam::Vector6 TransformTwistTo(
+    const Joint &joint, const LinkSharedPtr &link, double q, double q_dot,
+    const gtsam::Vector6 &other_twist,
+    gtsam::OptionalJacobian<6, 1> H_q = boost::none,
+    gtsam::OptionalJacobian<6, 1> H_q_dot = boost::none,
+    gtsam::OptionalJacobian<6, 6> H_other_twist = boost::none) {
+  const bool to_child = joint.otherLink(link) == joint.parent();
+  const gtsam::Pose3 T = to_child ? ChildTparent<JOINT>(joint, q)
+                                  : ParentTchild<JOINT>(joint, q);
+  const gtsam::Vector6 &S = to_child ? joint.cScrewAxis() : joint.pScrewAxis();
+  const gtsam::Vector6 twist_from_other =
+      T.Adjoint(other_twist, boost::none, H_other_twist);
+  // Ad(T) maps the screw axis in the other frame to -S in this frame.
+  if (H_q) *H_q = gtsam::Pose3::adjoint(twist_from_other, S);
+  if (H_q_dot) *H_q_dot = S;
+  return twist_from_other + S * q_dot;
+}
+
+/**
+ * Same as Joint::transformWrenchCoordinate, for a joint of type JOINT: the
+ * wrench on link expressed in the frame of the other link.
+ */
+template <class JOINT>
+gtsam::Vector6 TransformWrenchCoordinate(
+    const Joint &joint, const LinkSharedPtr &link, double q,
+    const gtsam::Vector6 &wrench,
+    gtsam::OptionalJacobian<6, 1> H_q = boost::none,
+    gtsam::OptionalJacobian<6, 6> H_wrench = boost::none) {
+  const bool to_parent = joint.otherLink(link) == joint.parent();
+  const gtsam::Pose3 T = to_parent ? ChildTparent<JOINT>(joint, q)
+                                   : ParentTchild<JOINT>(joint, q);
+  const gtsam::Vector6 &S =
+      to_parent ? joint.pScrewAxis() : joint.cScrewAxis();
+  const gtsam::Vector6 transformed_wrench =
+      T.AdjointTranspose(wrench, boost::none, H_wrench);
+  if (H_q) *H_q = gtsam::Pose3::adjointTranspose(S, transformed_wrench);
+  return transformed_wrench;
+}
+
+/**
+ * Joint::parentTchild for a batch of joint angles q. The motion of any joint
+ * type is the exponential of its screw axis, so one kernel serves them all.
+ */
+template <typename Scalar>
+PoseBatchT<Scalar> ParentTchildBatch(const Joint &joint,
+                                     const ScalarBatchT<Scalar> &q) {
+  return BatchCompose(joint.pMc(), BatchExpmap(joint.cScrewAxis(), q));
+}
+
+/// Joint::childTparent for a batch of joint angles q.
+template <typename Scalar>
+PoseBatchT<Scalar> ChildTparentBatch(const Joint &joint,
+                                     const ScalarBatchT<Scalar> &q) {
+  return BatchCompose(BatchExpmap<Scalar>(joint.cScrewAxis(), -q),
+                      joint.pMc().inverse());
+}
+
+/**
+ * TransformTwistTo for batches of joint angles, joint velocities and twists
+ * of the other link, without Jacobians.
+ */
+template <typename Scalar>
+TwistBatchT<Scalar> TransformTwistToBatch(
+    const Joint &joint, const LinkSharedPtr &link,
+    const ScalarBatchT<Scalar> &q, const ScalarBatchT<Scalar> &q_dot,
+    const TwistBatchT<Scalar> &other_twists) {
+  const bool to_child = joint.otherLink(link) == joint.parent();
+  const PoseBatchT<Scalar> T =
+      to_child ? ChildTparentBatch(joint, q) : ParentTchildBatch(joint, q);
+  const gtsam::Vector6 &S = to_child ? joint.cScrewAxis() : joint.pScrewAxis();
+  TwistBatchT<Scalar> twists = BatchAdjoint(T, other_twists);
+  twists += q_dot.matrix() * S.transpose().cast<Scalar>();
+  return twists;
+}
+
+/**
+ * TransformWrenchCoordinate for batches of joint angles and wrenches on
+ * link, without Jacobians.
+ */
+template <typename Scalar>
+TwistBatchT<Scalar> TransformWrenchCoordinateBatch(
+    const Joint &joint, const LinkSharedPtr &link,
+    const ScalarBatchT<Scalar> &q, const TwistBatchT<Scalar> &wrenches) {
+  const bool to_parent = joint.otherLink(link) == joint.parent();
+  const PoseBatchT<Scalar> T =
+      to_parent ? ChildTparentBatch(joint, q) : ParentTchildBatch(joint, q);
+  return BatchAdjointTranspose(T, wrenches);
+}
+
+/**
+ * Create an object of class DERIVED<JOINT> for the joint class JOINT of the
+ * given joint type, e.g. a factor whose joint kinematics are specialized at
+ * compile time, and return it as a pointer to BASE.
+ * @param type joint type, as returned by Joint::type()
+ * @param args constructor arguments
+ */
+template <class BASE, template <class> class DERIVED, class... ARGS>
+boost::shared_ptr<BASE> MakeJointTyped(Joint::Type type,
+                                       const ARGS &... args) {
+  switch (type) {
+    case Joint::Type::Revolute:
+      return MakeShared<DERIVED<RevoluteJoint>>(args...);
+    case Joint::Type::Prismatic:
+      return MakeShared<DERIVED<PrismaticJoint>>(args...);
+    case Joint::Type::Screw:
+      return MakeShared<DERIVED<HelicalJoint>>(args...);
+    case Joint::Type::Fixed:
+      return MakeShared<DERIVED<FixedJoint>>(args...);
+  }
+  return MakeShared<DERIVED<Joint>>(args...);
+}
+
+}  // namespace gtdynamics
@@ -43,7 +43,7 @@ namespace gtdynamics {
  */
 class Link : public boost::enable_shared_from_this<Link> {
  private:
-  uint8_t id_;
+  uint16_t id_;
   std::string name_;
 
   /// Inertial elements.
@@ -64,6 +64,7 @@ class Link : public boost::enable_shared_from_this<Link> {
 
   /// Robot class should have access to the internals of its links.
   friend class Robot;
+  friend class RobotBinaryCodec;
 
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -82,7 +83,7 @@ class Link : public boost::enable_shared_from_this<Link> {
    * @param bMlink The pose of the link frame relative to the base frame.
    * @param is_fixed Flag indicating if the link is fixed.
    */
-  Link(uint8_t id, const std::string &name, const double mass,
+  Link(uint16_t id, const std::string &name, const double mass,
        const gtsam::Matrix3 &inertia, const gtsam::Pose3 &bMcom,
        const gtsam::Pose3 &bMlink, bool is_fixed = false)
       : id_(id),
@@ -113,7 +114,7 @@ class Link : public boost::enable_shared_from_this<Link> {
   }
 
   /// return ID of the link
-  uint8_t id() const { return id_; }
+  uint16_t id() const { return id_; }
 
   /// add joint to the link
   void addJoint(const JointSharedPtr &joint) { joints_.push_back(joint); }
@@ -0,0 +1,231 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarRobot.cpp
+ * @brief Planar model of a robot that moves in a plane.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/PlanarRobot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/GenericValue.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Pose2;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+constexpr double kPlanarTol = 1e-6;
+
+// Plane frame with its z axis along the normal, and its x axis close to the
+// world axis most orthogonal to it.
+Rot3 PlaneRotation(const Vector3 &planar_axis) {
+  if (planar_axis.norm() == 0) {
+    throw std::invalid_argument("PlanarRobot: planar axis is zero");
+  }
+  const Vector3 z = planar_axis.normalized();
+  int axis = 0;
+  for (int i = 1; i < 3; i++) {
+    if (std::abs(z(i)) < std::abs(z(axis))) axis = i;
+  }
+  const Vector3 e = Vector3::Unit(axis);
+  const Vector3 x = (e - e.dot(z) * z).normalized();
+  return Rot3(x, z.cross(x), z);
+}
+
+// Angle of a rotation about the z axis.
+double Yaw(const gtsam::Matrix3 &R) { return std::atan2(R(1, 0), R(0, 0)); }
+
+// 6-vector with the planar components of a 3-vector: (0, 0, c, a, b, 0) for
+// (a, b, c), for twists and wrenches alike.
+Vector6 Lift(const Vector3 &v) {
+  return (Vector6() << 0, 0, v(2), v(0), v(1), 0).finished();
+}
+
+// Planar components of a 6-vector, the inverse of Lift.
+Vector3 Project(const Vector6 &v) { return Vector3(v(3), v(4), v(2)); }
+
+// Rotate both halves of a twist or wrench.
+Vector6 Rotate(const gtsam::Matrix3 &R, const Vector6 &v) {
+  Vector6 result;
+  result << R * v.head<3>(), R * v.tail<3>();
+  return result;
+}
+
+template <class T>
+const T *ValueAs(const gtsam::Value &value) {
+  auto generic = dynamic_cast<const gtsam::GenericValue<T> *>(&value);
+  return generic ? &generic->value() : nullptr;
+}
+}  // namespace
+
+/* ************************************************************************* */
+PlanarRobot::PlanarRobot(const Robot &robot, const Vector3 &planar_axis)
+    : robot_(robot),
+      wRp_(PlaneRotation(planar_axis)),
+      link_index_(DynamicsSymbol::kNoIndex + 1, -1),
+      joint_index_(DynamicsSymbol::kNoIndex + 1, -1) {
+  const gtsam::Matrix3 pRw = wRp_.matrix().transpose();
+  for (auto &&link : robot.links()) {
+    link_index_[link->id()] = links_.size();
+    PlanarLink planar;
+    planar.link = link;
+    planar.fRcom = Rot3(pRw * link->bMcom().rotation().matrix());
+    planar.depth = (pRw * link->bMcom().translation())(2);
+    const gtsam::Matrix3 R = planar.fRcom.matrix();
+    const double inertia = (R * link->inertia() * R.transpose())(2, 2);
+    planar.inertia = Vector3(link->mass(), link->mass(), inertia).asDiagonal();
+    links_.push_back(planar);
+  }
+
+  for (auto &&joint : robot.joints()) {
+    PlanarJoint planar;
+    planar.joint = joint;
+    planar.parent = linkIndex(joint->parent()->id());
+    planar.child = linkIndex(joint->child()->id());
+    const PlanarLink &parent = links_[planar.parent],
+                     &child = links_[planar.child];
+
+    // Rest pose and screw axis of the planar frames.
+    const Pose3 fMf = Pose3(parent.fRcom, gtsam::Point3::Zero()) *
+                      joint->pMc() *
+                      Pose3(child.fRcom.inverse(), gtsam::Point3::Zero());
+    const gtsam::Matrix3 R = fMf.rotation().matrix();
+    const Vector6 screw = Rotate(child.fRcom.matrix(), joint->cScrewAxis());
+    if (std::abs(R(2, 2) - 1) > kPlanarTol ||
+        std::abs(fMf.z() - (child.depth - parent.depth)) > kPlanarTol ||
+        std::abs(screw(0)) > kPlanarTol || std::abs(screw(1)) > kPlanarTol ||
+        std::abs(screw(5)) > kPlanarTol) {
+      throw std::invalid_argument("PlanarRobot: joint " + joint->name() +
+                                  " does not move in the plane");
+    }
+    planar.pMc = Pose2(fMf.x(), fMf.y(), Yaw(R));
+    planar.screw = Project(screw);
+    joint_index_[joint->id()] = joints_.size();
+    joints_.push_back(planar);
+  }
+}
+
+/* ************************************************************************* */
+int PlanarRobot::linkIndex(uint16_t id) const {
+  const int i = link_index_.at(id);
+  if (i < 0) {
+    throw std::out_of_range("PlanarRobot: no link with id " +
+                            std::to_string(id));
+  }
+  return i;
+}
+
+/* ************************************************************************* */
+int PlanarRobot::jointIndex(uint16_t id) const {
+  const int j = joint_index_.at(id);
+  if (j < 0) {
+    throw std::out_of_range("PlanarRobot: no joint with id " +
+                            std::to_string(id));
+  }
+  return j;
+}
+
+/* ************************************************************************* */
+gtsam::Vector2 PlanarRobot::planarGravity(const Vector3 &gravity) const {
+  return wRp_.unrotate(gravity).head<2>();
+}
+
+/* ************************************************************************* */
+Pose2 PlanarRobot::planarPose(uint16_t id, const Pose3 &wTcom) const {
+  const PlanarLink &planar = link(id);
+  const gtsam::Matrix3 R =
+      (wRp_.inverse() * wTcom.rotation() * planar.fRcom.inverse()).matrix();
+  const Vector3 t = wRp_.unrotate(wTcom.translation());
+  return Pose2(t(0), t(1), Yaw(R));
+}
+
+/* ************************************************************************* */
+Pose3 PlanarRobot::spatialPose(uint16_t id, const Pose2 &pose) const {
+  const PlanarLink &planar = link(id);
+  return Pose3(wRp_ * Rot3::Rz(pose.theta()) * planar.fRcom,
+               wRp_.rotate(Vector3(pose.x(), pose.y(), planar.depth)));
+}
+
+/* ************************************************************************* */
+Vector3 PlanarRobot::planarTwist(uint16_t id, const Vector6 &twist) const {
+  return Project(Rotate(link(id).fRcom.matrix(), twist));
+}
+
+/* ************************************************************************* */
+Vector6 PlanarRobot::spatialTwist(uint16_t id, const Vector3 &twist) const {
+  return Rotate(link(id).fRcom.transpose(), Lift(twist));
+}
+
+/* ************************************************************************* */
+Vector3 PlanarRobot::planarWrench(uint16_t id, const Vector6 &wrench) const {
+  // The planar frame only differs from the CoM frame by a rotation, which
+  // transforms wrenches like twists.
+  return planarTwist(id, wrench);
+}
+
+/* ************************************************************************* */
+Vector6 PlanarRobot::spatialWrench(uint16_t id, const Vector3 &wrench) const {
+  return spatialTwist(id, wrench);
+}
+
+/* ************************************************************************* */
+gtsam::Values PlanarRobot::toPlanar(const gtsam::Values &values) const {
+  gtsam::Values result;
+  for (auto &&key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const std::string label = symbol.label();
+    if (label == "p") {
+      if (auto pose = ValueAs<Pose3>(key_value.value)) {
+        result.insert(key_value.key, planarPose(symbol.linkIdx(), *pose));
+        continue;
+      }
+    } else if (label == "V" || label == "A" || label == "F") {
+      if (auto v = ValueAs<Vector6>(key_value.value)) {
+        result.insert<Vector3>(key_value.key,
+                               planarTwist(symbol.linkIdx(), *v));
+        continue;
+      }
+    }
+    result.insert(key_value.key, key_value.value);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::Values PlanarRobot::toSpatial(const gtsam::Values &values) const {
+  gtsam::Values result;
+  for (auto &&key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const std::string label = symbol.label();
+    if (label == "p") {
+      if (auto pose = ValueAs<Pose2>(key_value.value)) {
+        result.insert(key_value.key, spatialPose(symbol.linkIdx(), *pose));
+        continue;
+      }
+    } else if (label == "V" || label == "A" || label == "F") {
+      if (auto v = ValueAs<Vector3>(key_value.value)) {
+        result.insert<Vector6>(key_value.key,
+                               spatialTwist(symbol.linkIdx(), *v));
+        continue;
+      }
+    }
+    result.insert(key_value.key, key_value.value);
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarRobot.h
+ * @brief Planar model of a robot that moves in a plane.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * PlanarRobot is the planar model of a robot all joints of which are
+ * revolute about the plane normal, prismatic along the plane, or fixed, e.g.
+ * a cart-pole or a planar pendulum.
+ *
+ * Every link has a planar frame at its CoM, with the orientation of the
+ * plane frame at rest, so that its pose is a Pose2 in the plane frame. Its
+ * twist, twist acceleration and wrenches are 3-vectors in its planar frame,
+ * in the Pose2 tangent order: (vx, vy, omega) and (fx, fy, tau). The plane
+ * frame has its z axis along the plane normal and its origin at the world
+ * origin; each link's planar frame is offset from it by a constant depth.
+ *
+ * Links and joints are indexed in Robot::links() and Robot::joints() order,
+ * and keep their ids, so the planar variables use the keys of the spatial
+ * ones: PoseKey, TwistKey, TwistAccelKey and WrenchKey.
+ */
+class PlanarRobot {
+ public:
+  /// A link in the plane.
+  struct PlanarLink {
+    LinkSharedPtr link;
+    gtsam::Rot3 fRcom;       ///< CoM frame in the planar frame
+    double depth;            ///< planar frame offset along the normal
+    gtsam::Matrix3 inertia;  ///< diag(m, m, I) about the CoM, I normal
+  };
+
+  /// A joint in the plane.
+  struct PlanarJoint {
+    JointSharedPtr joint;
+    int parent, child;    ///< link indices
+    gtsam::Pose2 pMc;     ///< child planar frame in the parent one, at rest
+    gtsam::Vector3 screw;  ///< screw axis in the child planar frame
+
+    /// Pose of the child planar frame in the parent one at angle q.
+    gtsam::Pose2 parentTchild(double q) const {
+      return pMc * gtsam::Pose2::Expmap(screw * q);
+    }
+  };
+
+ private:
+  Robot robot_;
+  gtsam::Rot3 wRp_;
+  std::vector<PlanarLink> links_;
+  std::vector<PlanarJoint> joints_;
+  std::vector<int> link_index_, joint_index_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot       the robot
+   * @param planar_axis normal of the plane, in world frame
+   *
+   * Throws std::invalid_argument if a joint does not keep its links in
+   * planes normal to planar_axis.
+   */
+  PlanarRobot(const Robot &robot, const gtsam::Vector3 &planar_axis);
+
+  /// The robot.
+  const Robot &robot() const { return robot_; }
+
+  /// Rotation of the plane frame in world frame, z along the normal.
+  const gtsam::Rot3 &planeRotation() const { return wRp_; }
+
+  /// Links, in Robot::links() order.
+  const std::vector<PlanarLink> &links() const { return links_; }
+
+  /// Joints, in Robot::joints() order.
+  const std::vector<PlanarJoint> &joints() const { return joints_; }
+
+  /// Index of the link with the given id.
+  int linkIndex(uint16_t id) const;
+
+  /// Index of the joint with the given id.
+  int jointIndex(uint16_t id) const;
+
+  /// The link with the given id.
+  const PlanarLink &link(uint16_t id) const { return links_[linkIndex(id)]; }
+
+  /// The joint with the given id.
+  const PlanarJoint &joint(uint16_t id) const {
+    return joints_[jointIndex(id)];
+  }
+
+  /// Gravity in the plane frame, without its component along the normal.
+  gtsam::Vector2 planarGravity(const gtsam::Vector3 &gravity) const;
+
+  /// Pose of the planar frame of link `id` from the pose of its CoM frame.
+  gtsam::Pose2 planarPose(uint16_t id, const gtsam::Pose3 &wTcom) const;
+
+  /// Pose of the CoM frame of link `id` from the pose of its planar frame.
+  gtsam::Pose3 spatialPose(uint16_t id, const gtsam::Pose2 &pose) const;
+
+  /// Planar twist or twist acceleration of link `id` from the spatial one.
+  gtsam::Vector3 planarTwist(uint16_t id, const gtsam::Vector6 &twist) const;
+
+  /// Spatial twist or twist acceleration of link `id` from the planar one.
+  gtsam::Vector6 spatialTwist(uint16_t id, const gtsam::Vector3 &twist) const;
+
+  /// Planar wrench on link `id` from the spatial one.
+  gtsam::Vector3 planarWrench(uint16_t id, const gtsam::Vector6 &wrench) const;
+
+  /// Spatial wrench on link `id` from the planar one.
+  gtsam::Vector6 spatialWrench(uint16_t id, const gtsam::Vector3 &wrench) const;
+
+  /**
+   * Convert spatial values to planar ones: link poses, twists, twist
+   * accelerations and wrenches of all time steps are projected into the
+   * plane, all other values are copied.
+   */
+  gtsam::Values toPlanar(const gtsam::Values &values) const;
+
+  /// Convert planar values to spatial ones, the inverse of toPlanar.
+  gtsam::Values toSpatial(const gtsam::Values &values) const;
+};
+
+}  // namespace gtdynamics
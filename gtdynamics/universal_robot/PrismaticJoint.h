@@ -52,7 +52,7 @@ class PrismaticJoint : public Joint {
    * @param[in] axis          joint axis expressed in joint frame
    * @param[in] parameters    JointParams struct
    */
-  PrismaticJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  PrismaticJoint(uint16_t id, const std::string &name, const gtsam::Pose3 &bTj,
                  const LinkSharedPtr &parent_link,
                  const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                  const JointParams &parameters = JointParams())
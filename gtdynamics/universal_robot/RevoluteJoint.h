@@ -51,7 +51,7 @@ class RevoluteJoint : public Joint {
    * @param[in] axis          joint axis expressed in joint frame
    * @param[in] parameters    JointParams struct
    */
-  RevoluteJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  RevoluteJoint(uint16_t id, const std::string &name, const gtsam::Pose3 &bTj,
                 const LinkSharedPtr &parent_link,
                 const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                 const JointParams &parameters = JointParams())
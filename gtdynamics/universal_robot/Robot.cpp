@@ -11,14 +11,20 @@
  * @author: Frank Dellaert, Mandy Xie, and Alejandro Escontrela
  */
 
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <queue>
 #include <sstream>
 #include <stdexcept>
@@ -39,14 +45,37 @@ std::vector<V> getValues(std::map<K, V> m) {
 }
 
 Robot::Robot(const LinkMap &links, const JointMap &joints)
-    : name_to_link_(links), name_to_joint_(joints) {}
+    : structure_(boost::make_shared<Structure>(Structure{links, joints})),
+      topology_cache_(std::make_shared<TopologyCache>()) {}
+
+const RobotTopology &Robot::topology() const {
+  TopologyCache &cache = *topology_cache_;
+  std::call_once(cache.once, [this, &cache] {
+    cache.topology = boost::make_shared<const RobotTopology>(
+        getValues<std::string, LinkSharedPtr>(linkMap()),
+        getValues<std::string, JointSharedPtr>(structure_->name_to_joint));
+  });
+  return *cache.topology;
+}
 
-std::vector<LinkSharedPtr> Robot::links() const {
-  return getValues<std::string, LinkSharedPtr>(name_to_link_);
+boost::shared_ptr<const RobotTopology> Robot::sharedTopology() const {
+  topology();
+  return topology_cache_->topology;
 }
 
-std::vector<JointSharedPtr> Robot::joints() const {
-  return getValues<std::string, JointSharedPtr>(name_to_joint_);
+Robot::Structure &Robot::mutableStructure() {
+  if (!structure_.unique()) {
+    structure_ = boost::make_shared<Structure>(*structure_);
+  }
+  return *structure_;
+}
+
+LinkMap Robot::linkMap() const {
+  LinkMap links = structure_->name_to_link;
+  if (fixed_overlay_) {
+    for (auto &&kv : *fixed_overlay_) links[kv.first] = kv.second;
+  }
+  return links;
 }
 
 void Robot::removeLink(const LinkSharedPtr &link) {
@@ -56,56 +85,242 @@ void Robot::removeLink(const LinkSharedPtr &link) {
     removeJoint(joint);
   }
 
-  // remove link from name_to_link_
-  name_to_link_.erase(link->name());
+  // remove link from the structure and the overlay
+  mutableStructure().name_to_link.erase(link->name());
+  if (fixed_overlay_ && fixed_overlay_->count(link->name())) {
+    auto overlay = boost::make_shared<LinkMap>(*fixed_overlay_);
+    overlay->erase(link->name());
+    fixed_overlay_ = overlay;
+  }
+  resetTopology();
 }
 
 void Robot::removeJoint(const JointSharedPtr &joint) {
   // in all links connected to the joint, remove the joint
   for (auto link : joint->links()) {
     link->removeJoint(joint);
+    // The overridden copy of the link has its own joint list.
+    if (fixed_overlay_ && fixed_overlay_->count(link->name())) {
+      fixed_overlay_->at(link->name())->removeJoint(joint);
+    }
   }
-  // Remove the joint from name_to_joint_
-  name_to_joint_.erase(joint->name());
+  // Remove the joint from the structure
+  mutableStructure().name_to_joint.erase(joint->name());
+  resetTopology();
 }
 
 LinkSharedPtr Robot::link(const std::string &name) const {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
+  if (fixed_overlay_) {
+    auto it = fixed_overlay_->find(name);
+    if (it != fixed_overlay_->end()) return it->second;
+  }
+  const LinkMap &links = structure_->name_to_link;
+  if (links.find(name) == links.end()) {
     throw std::runtime_error("no link named " + name);
   }
-  return name_to_link_.at(name);
+  return links.at(name);
 }
 
-Robot Robot::fixLink(const std::string &name) {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
-    throw std::runtime_error("no link named " + name);
+Robot Robot::withLink(const Link &link) const {
+  auto overlay = fixed_overlay_ ? boost::make_shared<LinkMap>(*fixed_overlay_)
+                                : boost::make_shared<LinkMap>();
+
+  // Only keep the copy if it differs from the shared link.
+  const Link &shared = *structure_->name_to_link.at(link.name());
+  if (shared.isFixed() == link.isFixed() &&
+      (!link.isFixed() ||
+       shared.getFixedPose().equals(link.getFixedPose(), 0))) {
+    overlay->erase(link.name());
+  } else {
+    (*overlay)[link.name()] = boost::make_shared<Link>(link);
   }
 
-  Robot fixed_robot = Robot(*this);
-  fixed_robot.name_to_link_.at(name)->fix();
-  return fixed_robot;
+  Robot variant(*this);
+  variant.fixed_overlay_ = overlay;
+  variant.resetTopology();
+  return variant;
 }
 
-Robot Robot::unfixLink(const std::string &name) {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
-    throw std::runtime_error("no link named " + name);
+Robot Robot::fixLink(const std::string &name) const {
+  return withLink(Link::fix(*link(name)));
+}
+
+Robot Robot::unfixLink(const std::string &name) const {
+  return withLink(Link::unfix(*link(name)));
+}
+
+namespace {
+// Copy of a joint, as its concrete type.
+JointSharedPtr CopyJoint(const Joint &joint) {
+  switch (joint.type()) {
+    case Joint::Type::Revolute:
+      return boost::make_shared<RevoluteJoint>(
+          static_cast<const RevoluteJoint &>(joint));
+    case Joint::Type::Prismatic:
+      return boost::make_shared<PrismaticJoint>(
+          static_cast<const PrismaticJoint &>(joint));
+    case Joint::Type::Screw:
+      return boost::make_shared<HelicalJoint>(
+          static_cast<const HelicalJoint &>(joint));
+    case Joint::Type::Fixed:
+      return boost::make_shared<FixedJoint>(
+          static_cast<const FixedJoint &>(joint));
+  }
+  throw std::runtime_error("lumpFixedJoints: unknown type of joint " +
+                           joint.name());
+}
+}  // namespace
+
+Robot Robot::lumpFixedJoints(LumpedLinkMap *lumped_links) const {
+  const RobotTopology &topo = topology();
+  const std::vector<LinkSharedPtr> &links = topo.links;
+  const size_t num_links = links.size();
+  auto index = [&](const LinkSharedPtr &link) {
+    return topo.link_index[link->id()];
+  };
+
+  // Sets of links attached by fixed joints, as a union-find forest.
+  std::vector<int> set(num_links);
+  std::iota(set.begin(), set.end(), 0);
+  std::function<int(int)> find = [&](int i) {
+    return set[i] == i ? i : (set[i] = find(set[i]));
+  };
+  std::vector<bool> fixed_child(num_links, false);
+  for (auto &&joint : topo.joints) {
+    if (joint->type() != Joint::Type::Fixed) continue;
+    fixed_child[index(joint->child())] = true;
+    set[find(index(joint->child()))] = find(index(joint->parent()));
+  }
+
+  // The link kept for each set: a fixed one, else one that is not the child
+  // of a fixed joint, else the first.
+  auto rank = [&](int i) {
+    return links[i]->isFixed() ? 0 : fixed_child[i] ? 2 : 1;
+  };
+  std::vector<int> kept(num_links, -1);
+  for (size_t i = 0; i < num_links; i++) {
+    int &k = kept[find(i)];
+    if (k < 0 || rank(i) < rank(k)) k = i;
+  }
+
+  // Total mass and CoM frame of each set, indexed by its root.
+  std::vector<double> mass(num_links, 0.0);
+  std::vector<Vector3> moment(num_links, Vector3::Zero());
+  for (size_t i = 0; i < num_links; i++) {
+    const int r = find(i);
+    mass[r] += links[i]->mass();
+    moment[r] += links[i]->mass() * (links[i]->bMcom().translation() -
+                                     links[kept[r]]->bMcom().translation());
+  }
+  std::vector<Pose3> bMcom(num_links);
+  for (size_t r = 0; r < num_links; r++) {
+    if (find(r) != int(r)) continue;
+    const Pose3 &bMk = links[kept[r]]->bMcom();
+    const Vector3 offset = mass[r] > 0 ? Vector3(moment[r] / mass[r])
+                                       : Vector3(Vector3::Zero());
+    bMcom[r] = Pose3(bMk.rotation(), bMk.translation() + offset);
+  }
+
+  // Rotational inertia of each set about its CoM, with the parallel axis
+  // theorem.
+  std::vector<gtsam::Matrix3> inertia(num_links, gtsam::Z_3x3);
+  for (size_t i = 0; i < num_links; i++) {
+    const int r = find(i);
+    const Pose3 lMc = bMcom[r].between(links[i]->bMcom());
+    const gtsam::Matrix3 R = lMc.rotation().matrix();
+    const Vector3 d = lMc.translation();
+    inertia[r] += R * links[i]->inertia() * R.transpose() +
+                  links[i]->mass() * (d.squaredNorm() * gtsam::I_3x3 -
+                                      d * d.transpose());
+  }
+
+  // One link per set, a copy of the kept one.
+  LinkMap name_to_link;
+  std::vector<LinkSharedPtr> lumped(num_links);
+  for (size_t r = 0; r < num_links; r++) {
+    if (find(r) != int(r)) continue;
+    const Link &kept_link = *links[kept[r]];
+    auto link = boost::make_shared<Link>(kept_link);
+    link->mass_ = mass[r];
+    link->inertia_ = inertia[r];
+    link->bMcom_ = bMcom[r];
+    link->fixed_pose_ =
+        kept_link.fixed_pose_ * kept_link.bMcom().between(bMcom[r]);
+    link->joints_.clear();
+    name_to_link.emplace(link->name(), link);
+    lumped[r] = link;
+  }
+  if (lumped_links) {
+    lumped_links->clear();
+    for (size_t i = 0; i < num_links; i++) {
+      const int r = find(i);
+      (*lumped_links)[links[i]->name()] =
+          LumpedLink{lumped[r]->name(), bMcom[r].between(links[i]->bMcom())};
+    }
   }
 
-  Robot unfixed_robot = Robot(*this);
-  unfixed_robot.name_to_link_.at(name)->unfix();
-  return unfixed_robot;
+  // Copies of the other joints, with their rest poses and screw axes moved
+  // to the CoM frames of the lumped links, in the joint order of the links.
+  JointMap name_to_joint;
+  auto copy = [&](const Joint &joint) {
+    const int p = find(index(joint.parent())), c = find(index(joint.child()));
+    if (p == c) {
+      throw std::runtime_error("lumpFixedJoints: joint " + joint.name() +
+                               " connects rigidly attached links");
+    }
+    const Pose3 pMl = joint.parent()->bMcom().between(bMcom[p]),
+                cMl = joint.child()->bMcom().between(bMcom[c]);
+    JointSharedPtr lumped_joint = CopyJoint(joint);
+    lumped_joint->parent_link_ = lumped[p];
+    lumped_joint->child_link_ = lumped[c];
+    lumped_joint->jMp_ = joint.jMp_ * pMl;
+    lumped_joint->jMc_ = joint.jMc_ * cMl;
+    lumped_joint->pScrewAxis_ = pMl.inverse().AdjointMap() * joint.pScrewAxis_;
+    lumped_joint->cScrewAxis_ = cMl.inverse().AdjointMap() * joint.cScrewAxis_;
+    lumped_joint->serial_ = Joint::NextSerial();
+    return lumped_joint;
+  };
+  for (size_t i = 0; i < num_links; i++) {
+    for (auto &&joint : links[i]->joints()) {
+      if (joint->type() == Joint::Type::Fixed) continue;
+      auto it = name_to_joint.find(joint->name());
+      if (it == name_to_joint.end()) {
+        it = name_to_joint.emplace(joint->name(), copy(*joint)).first;
+      }
+      lumped[find(i)]->joints_.push_back(it->second);
+    }
+  }
+  return Robot(name_to_link, name_to_joint);
+}
+
+PointOnLinks LumpPointOnLinks(const Robot &lumped,
+                              const LumpedLinkMap &lumped_links,
+                              const PointOnLinks &points) {
+  PointOnLinks lumped_points;
+  lumped_points.reserve(points.size());
+  for (auto &&point : points) {
+    auto it = lumped_links.find(point.link->name());
+    if (it == lumped_links.end()) {
+      throw std::runtime_error("LumpPointOnLinks: no lumped link for " +
+                               point.link->name());
+    }
+    lumped_points.emplace_back(lumped.link(it->second.name),
+                               it->second.lMc.transformFrom(point.point));
+  }
+  return lumped_points;
 }
 
 JointSharedPtr Robot::joint(const std::string &name) const {
-  if (name_to_joint_.find(name) == name_to_joint_.end()) {
+  const JointMap &joints = structure_->name_to_joint;
+  if (joints.find(name) == joints.end()) {
     throw std::runtime_error("no joint named " + name);
   }
-  return name_to_joint_.at(name);
+  return joints.at(name);
 }
 
-int Robot::numLinks() const { return name_to_link_.size(); }
+int Robot::numLinks() const { return structure_->name_to_link.size(); }
 
-int Robot::numJoints() const { return name_to_joint_.size(); }
+int Robot::numJoints() const { return structure_->name_to_joint.size(); }
 
 void Robot::print(const std::string &s) const {
   using std::cout;
@@ -155,7 +370,7 @@ LinkSharedPtr Robot::findRootLink(
   if (prior_link_name) {
     root_link = link(*prior_link_name);
   } else {
-    auto links = this->links();
+    const auto &links = this->links();
     auto links_iter =
         std::find_if(links.rbegin(), links.rend(),
                      [](const LinkSharedPtr &link) { return link->isFixed(); });
@@ -173,23 +388,53 @@ LinkSharedPtr Robot::findRootLink(
   return root_link;
 }
 
+namespace {
+
+// Values read by forward kinematics: the known ones, and the ones it added,
+// which are the same object when working in place. New variables are only
+// inserted into the added ones.
+class FKValues {
+  const gtsam::Values &known_;
+  gtsam::Values *added_;
+
+ public:
+  FKValues(const gtsam::Values &known, gtsam::Values *added)
+      : known_(known), added_(added) {}
+
+  bool exists(gtsam::Key key) const {
+    return added_->exists(key) || (&known_ != added_ && known_.exists(key));
+  }
+
+  template <typename T>
+  const T &at(gtsam::Key key) const {
+    return added_->exists(key) || &known_ == added_ ? added_->at<T>(key)
+                                                    : known_.at<T>(key);
+  }
+
+  template <typename T>
+  void insert(gtsam::Key key, const T &value) {
+    if (exists(key)) throw gtsam::ValuesKeyAlreadyExists(key);
+    added_->insert(key, value);
+  }
+};
+
 // Insert fixed link poses into values
-static void InsertFixedLinks(const std::vector<LinkSharedPtr> &links, size_t t,
-                             gtsam::Values *values) {
+void InsertFixedLinks(const std::vector<LinkSharedPtr> &links, size_t t,
+                      FKValues *values) {
   for (auto &&link : links) {
     if (link->isFixed()) {
-      InsertPose(values, link->id(), t, link->getFixedPose());
-      InsertTwist(values, link->id(), t, Vector6::Zero());
+      values->insert(PoseKey(link->id(), t), link->getFixedPose());
+      values->insert<Vector6>(TwistKey(link->id(), t), Vector6::Zero());
     }
   }
 }
 
 // Add zero default values for joint angles and joint velocities.
 // if they do not yet exist
-static void InsertZeroDefaults(size_t j, size_t t, gtsam::Values *values) {
+void InsertZeroDefaults(size_t j, size_t t, FKValues *values) {
   for (const auto key : {JointAngleKey(j, t), JointVelKey(j, t)}) {
     if (!values->exists(key)) {
-      values->insertDouble(key, 0.0);
+      values->insert(key, 0.0);
     }
   }
 }
@@ -197,9 +442,9 @@ static void InsertZeroDefaults(size_t j, size_t t, gtsam::Values *values) {
 // Insert a pose/twist into values, but if they already are present, just check
 // if they are consistent. Throw exception otherwise.
 // Returns true if values were inserted.
-static bool InsertWithCheck(size_t i, size_t t,
-                            const std::pair<Pose3, Vector6> &poseTwist,
-                            gtsam::Values *values) {
+bool InsertWithCheck(size_t i, size_t t,
+                     const std::pair<Pose3, Vector6> &poseTwist,
+                     FKValues *values) {
   Pose3 pose;
   Vector6 twist;
   std::tie(pose, twist) = poseTwist;
@@ -220,49 +465,132 @@ static bool InsertWithCheck(size_t i, size_t t,
   return !exists;
 }
 
-gtsam::Values Robot::forwardKinematics(
-    const gtsam::Values &known_values, size_t t,
-    const boost::optional<std::string> &prior_link_name) const {
-  gtsam::Values values = known_values;
-
-  // Set root link.
-  const auto root_link = findRootLink(values, prior_link_name);
-  InsertFixedLinks(links(), t, &values);
+// BFS from the root link over the link-joint graph, at time step t.
+void ForwardKinematics(const RobotTopology &topo,
+                       const std::vector<LinkSharedPtr> &links,
+                       const LinkSharedPtr &root_link, size_t t,
+                       FKValues *values) {
+  InsertFixedLinks(links, t, values);
 
-  if (!values.exists(PoseKey(root_link->id(), t))) {
-    InsertPose(&values, root_link->id(), t, gtsam::Pose3());
+  if (!values->exists(PoseKey(root_link->id(), t))) {
+    values->insert(PoseKey(root_link->id(), t), gtsam::Pose3());
   }
-  if (!values.exists(TwistKey(root_link->id(), t))) {
-    InsertTwist(&values, root_link->id(), t, gtsam::Vector6::Zero());
+  if (!values->exists(TwistKey(root_link->id(), t))) {
+    values->insert<Vector6>(TwistKey(root_link->id(), t),
+                            gtsam::Vector6::Zero());
   }
 
   // BFS to update all poses downstream in the graph.
-  std::queue<LinkSharedPtr> q;
-  q.push(root_link);
+  std::queue<int> q;
+  q.push(topo.link_index[root_link->id()]);
   int loop_count = 0;
   while (!q.empty()) {
     // Pop link from the queue and retrieve the pose and twist.
-    const auto link1 = q.front();
-    const Pose3 T_w1 = Pose(values, link1->id(), t);
-    const Vector6 V_1 = Twist(values, link1->id(), t);
+    const int i1 = q.front();
+    const auto &link1 = topo.links[i1];
+    const Pose3 T_w1 = values->at<Pose3>(PoseKey(link1->id(), t));
+    const Vector6 V_1 = values->at<Vector6>(TwistKey(link1->id(), t));
     q.pop();
 
     // Loop through all joints to find the pose and twist of child links.
-    for (auto &&joint : link1->joints()) {
-      InsertZeroDefaults(joint->id(), t, &values);
+    for (int k = topo.link_joint_offsets[i1];
+         k < topo.link_joint_offsets[i1 + 1]; k++) {
+      const auto &joint = topo.joints[topo.link_joints[k]];
+      InsertZeroDefaults(joint->id(), t, values);
       const auto poseTwist = joint->otherPoseTwist(
-          link1, T_w1, V_1, JointAngle(values, joint->id(), t),
-          JointVel(values, joint->id(), t));
-      const auto link2 = joint->otherLink(link1);
-      if (InsertWithCheck(link2->id(), t, poseTwist, &values)) {
-        q.push(link2);
+          link1, T_w1, V_1, values->at<double>(JointAngleKey(joint->id(), t)),
+          values->at<double>(JointVelKey(joint->id(), t)));
+      const int i2 = topo.link_neighbors[k];
+      if (InsertWithCheck(topo.links[i2]->id(), t, poseTwist, values)) {
+        q.push(i2);
       }
     }
     if (loop_count++ > 100000) {
       throw std::runtime_error("infinite loop in bfs");
     }
   }
+}
+
+}  // namespace
+
+gtsam::Values Robot::forwardKinematics(
+    const gtsam::Values &known_values, size_t t,
+    const boost::optional<std::string> &prior_link_name) const {
+  gtsam::Values values = known_values;
+  forwardKinematicsInPlace(&values, t, prior_link_name);
   return values;
 }
 
+void Robot::forwardKinematics(
+    const gtsam::Values &known_values, size_t t, gtsam::Values *result,
+    const boost::optional<std::string> &prior_link_name) const {
+  const auto root_link = findRootLink(known_values, prior_link_name);
+  FKValues values(known_values, result);
+  ForwardKinematics(topology(), links(), root_link, t, &values);
+}
+
+void Robot::forwardKinematicsInPlace(
+    gtsam::Values *values, size_t t,
+    const boost::optional<std::string> &prior_link_name) const {
+  const auto root_link = findRootLink(*values, prior_link_name);
+  FKValues fk_values(*values, values);
+  ForwardKinematics(topology(), links(), root_link, t, &fk_values);
+}
+
+/* ************************************************************************* */
+KinematicPath Robot::kinematicPath(const std::string &start_link_name,
+                                   const std::string &end_link_name) const {
+  const RobotTopology &topo = topology();
+  const int start = topo.link_index[link(start_link_name)->id()];
+  const int end = topo.link_index[link(end_link_name)->id()];
+  std::vector<int> joints;
+  if (!topo.path(start, end, &joints)) {
+    throw std::runtime_error("Robot: no kinematic path from " +
+                             start_link_name + " to " + end_link_name);
+  }
+
+  KinematicPath path;
+  path.links.push_back(topo.links[start]);
+  int i = start;
+  for (int j : joints) {
+    i = topo.joint_parent[j] == i ? topo.joint_child[j] : topo.joint_parent[j];
+    path.joints.push_back(topo.joints[j]);
+    path.links.push_back(topo.links[i]);
+  }
+  return path;
+}
+
+/* ************************************************************************* */
+Pose3 Robot::relativePose(const gtsam::Values &joint_angles,
+                          const std::string &start_link_name,
+                          const std::string &end_link_name, size_t t) const {
+  const RobotTopology &topo = topology();
+  int a = topo.link_index[link(start_link_name)->id()];
+  int b = topo.link_index[link(end_link_name)->id()];
+  const int lca = topo.commonAncestor(a, b);
+  if (lca < 0) {
+    throw std::runtime_error("Robot: no kinematic path from " +
+                             start_link_name + " to " + end_link_name);
+  }
+
+  auto angle = [&](const JointSharedPtr &joint) {
+    const gtsam::Key key = JointAngleKey(joint->id(), t);
+    return joint_angles.exists(key) ? joint_angles.at<double>(key) : 0.0;
+  };
+
+  // Pose of the common ancestor in the start frame, walking up from the
+  // start, and of the end in the ancestor frame, walking up from the end.
+  Pose3 sTa, aTe;
+  for (; a != lca; a = topo.tree_parent[a]) {
+    const auto &joint = topo.joints[topo.tree_joint[a]];
+    sTa = sTa * joint->relativePoseOf(topo.links[topo.tree_parent[a]],
+                                      angle(joint));
+  }
+  for (; b != lca; b = topo.tree_parent[b]) {
+    const auto &joint = topo.joints[topo.tree_joint[b]];
+    aTe = joint->relativePoseOf(topo.links[b], angle(joint)) * aTe;
+  }
+  return sTa * aTe;
+}
+
 }  // namespace gtdynamics.
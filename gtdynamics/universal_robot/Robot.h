@@ -16,10 +16,19 @@
 #include <gtdynamics/config.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/RobotTopology.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
+#include <gtdynamics/utils/PointOnLink.h>
 
+#include <algorithm>
+#include <boost/make_shared.hpp>
 #include <boost/optional.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/shared_ptr.hpp>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,21 +51,74 @@ using LinkTwists = std::map<std::string, gtsam::Vector6>;
 // type for storing forward kinematics results
 using FKResults = std::pair<LinkPoses, LinkTwists>;
 
+/**
+ * Links and joints on the kinematic path between two links: joints[i]
+ * connects links[i] and links[i + 1], from the start to the end link.
+ */
+struct KinematicPath {
+  std::vector<LinkSharedPtr> links;
+  std::vector<JointSharedPtr> joints;
+};
+
+/// Where a link ended up in the robot returned by Robot::lumpFixedJoints.
+struct LumpedLink {
+  std::string name;  ///< name of the link it was lumped into
+  gtsam::Pose3 lMc;  ///< its CoM frame in the CoM frame of that link
+};
+/// Map from link name to the link it was lumped into.
+using LumpedLinkMap = std::map<std::string, LumpedLink>;
+
 /**
  * Robot is used to create a representation of a robot's
  * inertial/dynamic properties from a URDF/SDF file. The resulting object
  * provides getters for the robot's various joints and links, which can then
  * be fed into an optimization pipeline.
+ *
+ * Copies are cheap: a robot and its copies, including the variants returned
+ * by fixLink and unfixLink, share one link/joint structure. A variant only
+ * stores the links whose fixed state it changed, as copies of the shared
+ * ones. Joints keep pointing at the shared links, so ask the robot, not
+ * Joint::parent or Joint::child, whether a link is fixed.
+ *
+ * To share one robot between threads, wrap it in a RobotModel.
  */
 class Robot {
  private:
-  // For quicker/easier access to links and joints.
-  LinkMap name_to_link_;
-  JointMap name_to_joint_;
+  /// Links and joints, shared between copies and copied before mutation.
+  struct Structure {
+    LinkMap name_to_link;
+    JointMap name_to_joint;
+  };
+  boost::shared_ptr<Structure> structure_;
+
+  /// Links whose fixed state differs from the one in structure_.
+  boost::shared_ptr<const LinkMap> fixed_overlay_;
+
+  /// Flat view of the structure, built on first use and shared between
+  /// copies of an unchanged robot.
+  struct TopologyCache {
+    std::once_flag once;
+    boost::shared_ptr<const RobotTopology> topology;
+  };
+  std::shared_ptr<TopologyCache> topology_cache_;
+
+  /// Drop the topology, to be rebuilt after links or joints changed.
+  void resetTopology() { topology_cache_ = std::make_shared<TopologyCache>(); }
+
+  /// Make structure_ private to this robot before modifying it.
+  Structure &mutableStructure();
+
+  /// Return a variant of this robot with `link` replacing the same-named link.
+  Robot withLink(const Link &link) const;
+
+  /// Links by name, with the fixed overlay applied.
+  LinkMap linkMap() const;
 
  public:
   /** Default Constructor */
-  Robot() {}
+  Robot()
+      : structure_(boost::make_shared<Structure>()),
+        topology_cache_(std::make_shared<TopologyCache>()) {}
 
   /**
    * Constructor from link and joint elements.
@@ -67,11 +129,21 @@ class Robot {
    */
   explicit Robot(const LinkMap &links, const JointMap &joints);
 
-  /// Return this robot's links.
-  std::vector<LinkSharedPtr> links() const;
+  /// Return this robot's links, sorted by name.
+  const std::vector<LinkSharedPtr> &links() const { return topology().links; }
+
+  /// Return this robot's joints, sorted by name.
+  const std::vector<JointSharedPtr> &joints() const {
+    return topology().joints;
+  }
+
+  /// Return the flat, index-based view of this robot's links and joints.
+  /// Safe to call concurrently on a robot that is not being modified.
+  const RobotTopology &topology() const;
 
-  /// Return this robot's joints.
-  std::vector<JointSharedPtr> joints() const;
+  /// The topology as above, shared by copies of an unchanged robot, so
+  /// caches can tell whether it is still the same.
+  boost::shared_ptr<const RobotTopology> sharedTopology() const;
 
   /// remove specified link from the robot
   void removeLink(const LinkSharedPtr &link);
@@ -84,21 +156,46 @@ class Robot {
 
   /**
    * @brief Return a copy of this robot with the link corresponding to the input
-   * string as a fixed link.
+   * string as a fixed link. This robot is not modified, and the copy shares
+   * all other links and joints with it.
    *
    * @param name The name of the link to fix.
    * @return Robot
    */
-  Robot fixLink(const std::string &name);
+  Robot fixLink(const std::string &name) const;
 
   /**
    * @brief Return a copy of this robot after unfixing the link corresponding to
-   * the input string.
+   * the input string. This robot is not modified, and the copy shares all
+   * other links and joints with it.
    *
    * @param name The name of the link to unfix.
    * @return Robot
    */
-  Robot unfixLink(const std::string &name);
+  Robot unfixLink(const std::string &name) const;
+
+  /**
+   * @brief Return a copy of this robot in which every set of links rigidly
+   * attached by fixed joints is lumped into one link, so graphs built for it
+   * only have variables and factors for the bodies that move. This is what
+   * the URDF parser does unless fixed joints are preserved, for any robot,
+   * e.g. one read from an SDF file.
+   *
+   * A lumped link keeps the name, id, link frame and CoM frame orientation
+   * of the link of the set that is fixed, or else that is not the child of a
+   * fixed joint in the set. Its mass is the total mass, its CoM frame is at
+   * the combined center of mass, and its inertia is the combined rotational
+   * inertia about it. The other joints keep their names, ids and
+   * parameters. Links and joints are all copies: this robot is not modified.
+   *
+   * Throws std::runtime_error if a joint that is not fixed connects two
+   * links of the same set.
+   *
+   * @param lumped_links if given, filled with where each link of this robot
+   * ended up, to move contact points with LumpPointOnLinks
+   * @return Robot
+   */
+  Robot lumpFixedJoints(LumpedLinkMap *lumped_links = nullptr) const;
 
   /// Return the joint corresponding to the input string.
   JointSharedPtr joint(const std::string &name) const;
@@ -109,30 +206,31 @@ class Robot {
   /// Return number of joints.
   int numJoints() const;
 
+  /// Return the number of links whose fixed state this robot overrides.
+  size_t numOverriddenLinks() const {
+    return fixed_overlay_ ? fixed_overlay_->size() : 0;
+  }
+
   /// Print links and joints of the robot, for debug purposes
   void print(const std::string &s = "") const;
 
   /// Overload equality operator.
   bool operator==(const Robot &other) const {
-    // Define comparators for easy std::map equality checking
-    // Needed since we are storing shared pointers as the values.
-    auto link_comparator = [](decltype(*this->name_to_link_.begin()) a,
-                              decltype(a) b) {
-      // compare the key name and the underlying shared_ptr object
-      return a.first == b.first && (*a.second) == (*b.second);
+    // Compare the underlying objects, since we store shared pointers.
+    auto link_comparator = [](const LinkSharedPtr &a, const LinkSharedPtr &b) {
+      return a->name() == b->name() && *a == *b;
     };
-    auto joint_comparator = [](decltype(*this->name_to_joint_.begin()) a,
-                               decltype(a) b) {
-      // compare the key name and the underlying shared_ptr object
-      return a.first == b.first && (*a.second) == (*b.second);
+    auto joint_comparator = [](const JointSharedPtr &a,
+                               const JointSharedPtr &b) {
+      return a->name() == b->name() && *a == *b;
     };
 
-    return (this->name_to_link_.size() == other.name_to_link_.size() &&
-            std::equal(this->name_to_link_.begin(), this->name_to_link_.end(),
-                       other.name_to_link_.begin(), link_comparator) &&
-            this->name_to_joint_.size() == other.name_to_joint_.size() &&
-            std::equal(this->name_to_joint_.begin(), this->name_to_joint_.end(),
-                       other.name_to_joint_.begin(), joint_comparator));
+    return (links().size() == other.links().size() &&
+            std::equal(links().begin(), links().end(), other.links().begin(),
+                       link_comparator) &&
+            joints().size() == other.joints().size() &&
+            std::equal(joints().begin(), joints().end(),
+                       other.joints().begin(), joint_comparator));
   }
 
   bool equals(const Robot &other, double tol = 0) const {
@@ -158,6 +256,59 @@ class Robot {
       const gtsam::Values &known_values, size_t t = 0,
       const boost::optional<std::string> &prior_link_name = boost::none) const;
 
+  /**
+   * Forward kinematics as above, but only the variables of step t that are
+   * not in `known_values` are inserted into `result`: the link poses and
+   * twists, and zero joint angles and velocities where missing. Nothing is
+   * copied from `known_values`, so calling this per time step on a whole
+   * trajectory costs O(links) per step, and inserting `result` into
+   * `known_values` gives the values forwardKinematics returns.
+   *
+   * @param[in] known_values Values with joint angles, joint velocities, and
+   * (optionally) root link pose and twist.
+   * @param[in] t integer time index
+   * @param[out] result Values to insert the new variables into; variables
+   * already in it are checked for consistency like known ones.
+   * @param[in] prior_link_name name of link with known pose & twist
+   */
+  void forwardKinematics(
+      const gtsam::Values &known_values, size_t t, gtsam::Values *result,
+      const boost::optional<std::string> &prior_link_name = boost::none) const;
+
+  /**
+   * Forward kinematics in place: insert the new variables of step t into
+   * values, see forwardKinematics.
+   */
+  void forwardKinematicsInPlace(
+      gtsam::Values *values, size_t t = 0,
+      const boost::optional<std::string> &prior_link_name = boost::none) const;
+
+  /**
+   * The kinematic path between two links in the spanning forest of the
+   * topology, see RobotTopology::path: the unique path for tree-structured
+   * robots. Throws if the links are not connected.
+   */
+  KinematicPath kinematicPath(const std::string &start_link_name,
+                              const std::string &end_link_name) const;
+
+  /**
+   * Forward kinematics restricted to the kinematic path between two links,
+   * without computing the poses of the other links. Walks the spanning
+   * forest of the topology up to the common ancestor of the links, in
+   * O(path length) time and without allocating.
+   *
+   * @param[in] joint_angles Values with the angles of the joints on the path;
+   * missing angles are zero, as in forwardKinematics
+   * @param[in] start_link_name name of the start link
+   * @param[in] end_link_name name of the end link
+   * @param[in] t integer time index
+   * @return CoM pose of the end link in the CoM frame of the start link
+   */
+  gtsam::Pose3 relativePose(const gtsam::Values &joint_angles,
+                            const std::string &start_link_name,
+                            const std::string &end_link_name,
+                            size_t t = 0) const;
+
  private:
   /// Find root link for forward kinematics
   LinkSharedPtr findRootLink(
@@ -170,13 +321,41 @@ class Robot {
   /** Serialization function */
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
-    ar &BOOST_SERIALIZATION_NVP(name_to_link_);
-    ar &BOOST_SERIALIZATION_NVP(name_to_joint_);
+  void save(ARCHIVE &ar, const unsigned int /*version*/) const {
+    const LinkMap name_to_link = linkMap();
+    ar &boost::serialization::make_nvp("name_to_link_", name_to_link);
+    ar &boost::serialization::make_nvp("name_to_joint_",
+                                       structure_->name_to_joint);
   }
+  template <class ARCHIVE>
+  void load(ARCHIVE &ar, const unsigned int /*version*/) {
+    structure_ = boost::make_shared<Structure>();
+    fixed_overlay_.reset();
+    ar &boost::serialization::make_nvp("name_to_link_",
+                                       structure_->name_to_link);
+    ar &boost::serialization::make_nvp("name_to_joint_",
+                                       structure_->name_to_joint);
+    resetTopology();
+  }
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
 
   /// @}
 };
+
+/**
+ * Move points on links of a robot to the links of the robot
+ * Robot::lumpFixedJoints returned for it, e.g. contact points on a foot link
+ * that was lumped into the lower leg.
+ *
+ * @param lumped       the robot returned by lumpFixedJoints
+ * @param lumped_links where the links ended up, filled by lumpFixedJoints
+ * @param points       points on links of the original robot
+ * @return the same points, on links of the lumped robot
+ */
+PointOnLinks LumpPointOnLinks(const Robot &lumped,
+                              const LumpedLinkMap &lumped_links,
+                              const PointOnLinks &points);
+
 }  // namespace gtdynamics
 
 namespace gtsam {
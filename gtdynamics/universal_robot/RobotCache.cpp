@@ -0,0 +1,394 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotCache.cpp
+ * @brief Binary robot model files, to skip parsing urdf/sdf files.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/MappedFile.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'R', 'O', 'B', 'O', 'T'};
+
+/// Fixed header at the start of a binary robot file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_links;
+  uint64_t source_hash;
+  uint32_t num_joints;
+  uint32_t reserved;
+};
+
+/// Appends raw native-endian numbers to a buffer.
+class Writer {
+  std::string data_;
+
+ public:
+  template <class T>
+  void pod(const T &value) {
+    data_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void string(const std::string &s) {
+    pod<uint32_t>(s.size());
+    data_.append(s);
+  }
+
+  template <class MATRIX>
+  void matrix(const MATRIX &m) {
+    const Eigen::Matrix<double, MATRIX::RowsAtCompileTime,
+                        MATRIX::ColsAtCompileTime>
+        dense = m;
+    data_.append(reinterpret_cast<const char *>(dense.data()),
+                 sizeof(double) * dense.size());
+  }
+
+  void pose(const Pose3 &pose) {
+    matrix(pose.rotation().matrix());
+    matrix(pose.translation());
+  }
+
+  const std::string &data() const { return data_; }
+};
+
+/// Reads what Writer wrote, checking that the data is not truncated.
+class Reader {
+  const char *p_, *end_;
+
+  void need(size_t n) const {
+    if (static_cast<size_t>(end_ - p_) < n)
+      throw std::runtime_error("LoadRobotBinary: truncated robot file");
+  }
+
+ public:
+  Reader(const char *data, size_t size) : p_(data), end_(data + size) {}
+
+  template <class T>
+  T pod() {
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return value;
+  }
+
+  std::string string() {
+    const uint32_t size = pod<uint32_t>();
+    need(size);
+    std::string s(p_, size);
+    p_ += size;
+    return s;
+  }
+
+  template <class MATRIX>
+  MATRIX matrix() {
+    MATRIX m;
+    need(sizeof(double) * m.size());
+    std::memcpy(m.data(), p_, sizeof(double) * m.size());
+    p_ += sizeof(double) * m.size();
+    return m;
+  }
+
+  Pose3 pose() {
+    const gtsam::Matrix3 R = matrix<gtsam::Matrix3>();
+    return Pose3(gtsam::Rot3(R), matrix<gtsam::Vector3>());
+  }
+};
+
+/// 64-bit FNV-1a hash, continuing from `hash`.
+uint64_t Fnv1a(const char *data, size_t size,
+               uint64_t hash = 14695981039346656037ull) {
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+/**
+ * Converts robots to and from the binary format; a friend of Link and Joint
+ * so it can restore their state without recomputing it.
+ */
+class RobotBinaryCodec {
+ public:
+  static std::string Encode(const Robot &robot, uint64_t source_hash) {
+    const auto links = robot.links();
+    const auto joints = robot.joints();
+    // Links by name: the links of a fixLink variant may be copies of the
+    // ones the joints point to.
+    std::map<std::string, uint32_t> link_index;
+    std::map<const Joint *, uint32_t> joint_index;
+    for (size_t i = 0; i < links.size(); i++) link_index[links[i]->name()] = i;
+    for (size_t j = 0; j < joints.size(); j++)
+      joint_index[joints[j].get()] = j;
+
+    Writer writer;
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kRobotBinaryVersion;
+    header.num_links = links.size();
+    header.source_hash = source_hash;
+    header.num_joints = joints.size();
+    header.reserved = 0;
+    writer.pod(header);
+
+    for (auto &&link : links) {
+      writer.pod(link->id_);
+      writer.string(link->name_);
+      writer.pod(link->mass_);
+      writer.pose(link->centerOfMass_);
+      writer.matrix(link->inertia_);
+      writer.pose(link->bMcom_);
+      writer.pose(link->bMlink_);
+      writer.pod<uint8_t>(link->is_fixed_);
+      writer.pose(link->fixed_pose_);
+      writer.pod<uint32_t>(link->joints_.size());
+      for (auto &&joint : link->joints_)
+        writer.pod<uint32_t>(joint_index.at(joint.get()));
+    }
+
+    for (auto &&joint : joints) {
+      writer.pod<char>(joint->type());
+      writer.pod(joint->id_);
+      writer.string(joint->name_);
+      writer.pod<uint32_t>(link_index.at(joint->parent_link_->name()));
+      writer.pod<uint32_t>(link_index.at(joint->child_link_->name()));
+      writer.pose(joint->jMp_);
+      writer.pose(joint->jMc_);
+      writer.matrix(joint->pScrewAxis_);
+      writer.matrix(joint->cScrewAxis_);
+      const JointParams &p = joint->parameters_;
+      writer.pod<int32_t>(p.effort_type);
+      writer.pod(p.scalar_limits.value_lower_limit);
+      writer.pod(p.scalar_limits.value_upper_limit);
+      writer.pod(p.scalar_limits.value_limit_threshold);
+      writer.pod(p.velocity_limit);
+      writer.pod(p.velocity_limit_threshold);
+      writer.pod(p.acceleration_limit);
+      writer.pod(p.acceleration_limit_threshold);
+      writer.pod(p.torque_limit);
+      writer.pod(p.torque_limit_threshold);
+      writer.pod(p.damping_coefficient);
+      writer.pod(p.spring_coefficient);
+    }
+    return writer.data();
+  }
+
+  static Robot Decode(Reader *reader, const Header &header) {
+    std::vector<LinkSharedPtr> links(header.num_links);
+    std::vector<std::vector<uint32_t>> link_joints(header.num_links);
+    for (uint32_t i = 0; i < header.num_links; i++) {
+      auto link = boost::make_shared<Link>();
+      link->id_ = reader->pod<uint16_t>();
+      link->name_ = reader->string();
+      link->mass_ = reader->pod<double>();
+      link->centerOfMass_ = reader->pose();
+      link->inertia_ = reader->matrix<gtsam::Matrix3>();
+      link->bMcom_ = reader->pose();
+      link->bMlink_ = reader->pose();
+      link->is_fixed_ = reader->pod<uint8_t>();
+      link->fixed_pose_ = reader->pose();
+      link_joints[i].resize(reader->pod<uint32_t>());
+      for (auto &&j : link_joints[i]) j = reader->pod<uint32_t>();
+      links[i] = link;
+    }
+
+    auto link_at = [&](uint32_t i) {
+      if (i >= links.size())
+        throw std::runtime_error("LoadRobotBinary: invalid link index");
+      return links[i];
+    };
+
+    std::vector<JointSharedPtr> joints(header.num_joints);
+    for (uint32_t j = 0; j < header.num_joints; j++) {
+      const char type = reader->pod<char>();
+      const uint16_t id = reader->pod<uint16_t>();
+      const std::string name = reader->string();
+      const LinkSharedPtr parent = link_at(reader->pod<uint32_t>());
+      const LinkSharedPtr child = link_at(reader->pod<uint32_t>());
+
+      JointSharedPtr joint;
+      switch (type) {
+        case Joint::Type::Revolute:
+          joint = boost::make_shared<RevoluteJoint>();
+          break;
+        case Joint::Type::Prismatic:
+          joint = boost::make_shared<PrismaticJoint>();
+          break;
+        case Joint::Type::Screw:
+          joint = boost::make_shared<HelicalJoint>();
+          break;
+        case Joint::Type::Fixed:
+          joint = boost::make_shared<FixedJoint>(id, name, Pose3(), parent,
+                                                 child);
+          break;
+        default:
+          throw std::runtime_error("LoadRobotBinary: unknown joint type");
+      }
+      joint->id_ = id;
+      joint->name_ = name;
+      joint->parent_link_ = parent;
+      joint->child_link_ = child;
+      joint->jMp_ = reader->pose();
+      joint->jMc_ = reader->pose();
+      joint->pScrewAxis_ = reader->matrix<gtsam::Vector6>();
+      joint->cScrewAxis_ = reader->matrix<gtsam::Vector6>();
+      JointParams &p = joint->parameters_;
+      p.effort_type = static_cast<JointEffortType>(reader->pod<int32_t>());
+      p.scalar_limits.value_lower_limit = reader->pod<double>();
+      p.scalar_limits.value_upper_limit = reader->pod<double>();
+      p.scalar_limits.value_limit_threshold = reader->pod<double>();
+      p.velocity_limit = reader->pod<double>();
+      p.velocity_limit_threshold = reader->pod<double>();
+      p.acceleration_limit = reader->pod<double>();
+      p.acceleration_limit_threshold = reader->pod<double>();
+      p.torque_limit = reader->pod<double>();
+      p.torque_limit_threshold = reader->pod<double>();
+      p.damping_coefficient = reader->pod<double>();
+      p.spring_coefficient = reader->pod<double>();
+      joints[j] = joint;
+    }
+
+    LinkMap name_to_link;
+    for (uint32_t i = 0; i < header.num_links; i++) {
+      for (uint32_t j : link_joints[i]) {
+        if (j >= joints.size())
+          throw std::runtime_error("LoadRobotBinary: invalid joint index");
+        links[i]->joints_.push_back(joints[j]);
+      }
+      name_to_link.emplace(links[i]->name(), links[i]);
+    }
+    JointMap name_to_joint;
+    for (auto &&joint : joints) name_to_joint.emplace(joint->name(), joint);
+    return Robot(name_to_link, name_to_joint);
+  }
+};
+
+/* ************************************************************************* */
+uint64_t RobotSourceHash(const std::string &file_path,
+                         const std::string &model_name,
+                         bool preserve_fixed_joint) {
+  MappedFile file;
+  if (!file.open(file_path))
+    throw std::runtime_error("RobotSourceHash: no file found at " +
+                             file_path);
+  uint64_t hash = Fnv1a(file.data(), file.size());
+  hash = Fnv1a(model_name.data(), model_name.size() + 1, hash);
+  const char flags[2] = {preserve_fixed_joint ? '1' : '0',
+                         static_cast<char>(kRobotBinaryVersion)};
+  return Fnv1a(flags, sizeof(flags), hash);
+}
+
+/* ************************************************************************* */
+void SaveRobotBinary(const Robot &robot, const std::string &file_path,
+                     uint64_t source_hash) {
+  const std::string data = RobotBinaryCodec::Encode(robot, source_hash);
+
+  // Write to a temporary file and rename it, so that concurrent readers
+  // never see a partially written file.
+  const std::string tmp_path = file_path + ".tmp";
+  {
+    std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size());
+    if (!os.good())
+      throw std::runtime_error("SaveRobotBinary: could not write " +
+                               tmp_path);
+  }
+  if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("SaveRobotBinary: could not write " + file_path);
+  }
+}
+
+/* ************************************************************************* */
+boost::optional<Robot> LoadRobotBinary(
+    const std::string &file_path,
+    const boost::optional<uint64_t> &source_hash) {
+  MappedFile file;
+  if (!file.open(file_path)) return boost::none;
+
+  Reader reader(file.data(), file.size());
+  if (file.size() < sizeof(Header)) return boost::none;
+  const Header header = reader.pod<Header>();
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kRobotBinaryVersion)
+    return boost::none;
+  if (source_hash && header.source_hash != *source_hash) return boost::none;
+  return RobotBinaryCodec::Decode(&reader, header);
+}
+
+/* ************************************************************************* */
+std::string RobotToBytes(const Robot &robot) {
+  return RobotBinaryCodec::Encode(robot, 0);
+}
+
+/* ************************************************************************* */
+Robot RobotFromBytes(const std::string &data) {
+  Reader reader(data.data(), data.size());
+  const Header header = reader.pod<Header>();
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kRobotBinaryVersion)
+    throw std::runtime_error("RobotFromBytes: not a robot of this version");
+  return RobotBinaryCodec::Decode(&reader, header);
+}
+
+/* ************************************************************************* */
+Robot CreateRobotFromFileCached(const std::string &file_path,
+                                const std::string &model_name,
+                                bool preserve_fixed_joint,
+                                const std::string &cache_path) {
+  const uint64_t hash =
+      RobotSourceHash(file_path, model_name, preserve_fixed_joint);
+  std::string path = cache_path;
+  if (path.empty()) {
+    path = file_path;
+    if (!model_name.empty()) path += "." + model_name;
+    if (preserve_fixed_joint) path += ".fixed";
+    path += ".gtdrobot";
+  }
+
+  try {
+    if (auto robot = LoadRobotBinary(path, hash)) return *robot;
+  } catch (const std::runtime_error &) {
+    // A corrupt cache is replaced below.
+  }
+
+  Robot robot =
+      CreateRobotFromFile(file_path, model_name, preserve_fixed_joint);
+  try {
+    SaveRobotBinary(robot, path, hash);
+  } catch (const std::runtime_error &) {
+    // The cache is an optimization only, e.g., the directory may be read-only.
+  }
+  return robot;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotCache.h
+ * @brief Binary robot model files, to skip parsing urdf/sdf files.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+
+namespace gtdynamics {
+
+/// Version of the binary robot model format, bumped whenever it changes.
+constexpr uint32_t kRobotBinaryVersion = 2;
+
+/**
+ * Hash identifying the robot parsed from a urdf/sdf file: a 64-bit FNV-1a
+ * hash of the file contents, the model name, the fixed joint flag and the
+ * binary format version.
+ */
+uint64_t RobotSourceHash(const std::string &file_path,
+                         const std::string &model_name = "",
+                         bool preserve_fixed_joint = false);
+
+/**
+ * Write a robot to a binary model file.
+ *
+ * The file is a fixed header (magic, version, source hash, counts) followed
+ * by the links and joints as raw native-endian numbers, so it can be read
+ * straight from a memory mapping. It is meant as a cache on one machine, not
+ * as an interchange format.
+ *
+ * @param robot       the robot to save
+ * @param file_path   path of the binary file
+ * @param source_hash hash of the source file, see RobotSourceHash
+ */
+void SaveRobotBinary(const Robot &robot, const std::string &file_path,
+                     uint64_t source_hash = 0);
+
+/**
+ * Read a robot from a binary model file written by SaveRobotBinary.
+ * @param file_path   path of the binary file
+ * @param source_hash if given, the expected hash of the source file
+ * @return the robot, or none if the file does not exist, has another format
+ * version or another source hash. Throws if the file is corrupt.
+ */
+boost::optional<Robot> LoadRobotBinary(
+    const std::string &file_path,
+    const boost::optional<uint64_t> &source_hash = boost::none);
+
+/**
+ * The binary model format of a robot, in memory, e.g. to send the robot to
+ * other processes; see SaveRobotBinary.
+ */
+std::string RobotToBytes(const Robot &robot);
+
+/**
+ * Decode a robot encoded by RobotToBytes on the same platform. Throws
+ * std::runtime_error if the data is corrupt or has another format version.
+ */
+Robot RobotFromBytes(const std::string &data);
+
+/**
+ * Same as CreateRobotFromFile, but caches the parsed robot in a binary model
+ * file and loads it from there as long as the source file is unchanged.
+ *
+ * @param file_path            path to the urdf or sdf file
+ * @param model_name           name of the robot, see CreateRobotFromFile
+ * @param preserve_fixed_joint see CreateRobotFromFile
+ * @param cache_path           path of the binary file; by default the source
+ * path with the model name and ".gtdrobot" appended. If the cache cannot be
+ * written the robot is still returned.
+ */
+Robot CreateRobotFromFileCached(const std::string &file_path,
+                                const std::string &model_name = "",
+                                bool preserve_fixed_joint = false,
+                                const std::string &cache_path = "");
+
+}  // namespace gtdynamics
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotGenerator.cpp
+ * @brief Synthetic robots of any size, for scaling benchmarks and tests.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <boost/make_shared.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+namespace robot_generator {
+
+namespace {
+
+/// Adds rod-shaped links and the revolute joints between them.
+class Builder {
+ private:
+  GeneratedLinkParams params_;
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+
+ public:
+  Builder(size_t num_links, const GeneratedLinkParams &params)
+      : params_(params) {
+    if (num_links < 2 || num_links > DynamicsSymbol::kNoIndex) {
+      throw std::invalid_argument(
+          "robot_generator: need 2 to 4095 links, for the indices of "
+          "DynamicsSymbol");
+    }
+    if (params.length <= 0 || params.mass <= 0 || params.radius <= 0) {
+      throw std::invalid_argument(
+          "robot_generator: link length, mass and radius must be positive");
+    }
+  }
+
+  /// Add a link with its frame at `start` and its center of mass at `com`,
+  /// and the inertia of a rod from start to 2 com - start.
+  LinkSharedPtr addLink(const Point3 &start, const Point3 &com) {
+    const double m = params_.mass, r = params_.radius;
+    const Vector3 axis = (com - start).normalized();
+    const double l = 2 * (com - start).norm();
+    const Matrix3 dd = axis * axis.transpose();
+    const Matrix3 inertia = m * l * l / 12 * (Matrix3::Identity() - dd) +
+                            m * r * r / 2 * dd;
+    return addLink(start, com, inertia);
+  }
+
+  /// Add a link with the given inertia about its center of mass.
+  LinkSharedPtr addLink(const Point3 &start, const Point3 &com,
+                        const Matrix3 &inertia) {
+    const uint16_t id = links_.size();
+    links_.push_back(boost::make_shared<Link>(
+        id, "link_" + std::to_string(id), params_.mass, inertia,
+        Pose3(Rot3(), com), Pose3(Rot3(), start)));
+    return links_.back();
+  }
+
+  /// Add a revolute joint at the frame of the child, with alternating axes.
+  void addJoint(const LinkSharedPtr &parent, const LinkSharedPtr &child) {
+    const uint16_t id = joints_.size();
+    const Vector3 axis = id % 2 ? Vector3::UnitY() : Vector3::UnitX();
+    JointParams parameters;
+    parameters.effort_type = JointEffortType::Actuated;
+    auto joint = boost::make_shared<RevoluteJoint>(
+        id, "joint_" + std::to_string(id), child->bMlink(), parent, child,
+        axis, parameters);
+    parent->addJoint(joint);
+    child->addJoint(joint);
+    joints_.push_back(joint);
+  }
+
+  Robot robot(bool fixed_base) const {
+    LinkMap links;
+    JointMap joints;
+    for (auto &&link : links_) links.emplace(link->name(), link);
+    for (auto &&joint : joints_) joints.emplace(joint->name(), joint);
+    const Robot robot(links, joints);
+    return fixed_base ? robot.fixLink(links_.front()->name()) : robot;
+  }
+};
+
+}  // namespace
+
+/* ************************************************************************* */
+Robot SerialChain(size_t num_joints, bool fixed_base,
+                  const GeneratedLinkParams &params) {
+  Builder builder(num_joints + 1, params);
+  const double l = params.length;
+  LinkSharedPtr parent;
+  for (size_t i = 0; i <= num_joints; i++) {
+    auto link =
+        builder.addLink(Point3(0, 0, i * l), Point3(0, 0, (i + 0.5) * l));
+    if (parent) builder.addJoint(parent, link);
+    parent = link;
+  }
+  return builder.robot(fixed_base);
+}
+
+/* ************************************************************************* */
+Robot BinaryTree(size_t num_levels, bool fixed_base,
+                 const GeneratedLinkParams &params) {
+  if (num_levels < 2 || num_levels > 12) {
+    throw std::invalid_argument("BinaryTree: need 2 to 12 levels");
+  }
+  const size_t num_links = (size_t(1) << num_levels) - 1;
+  Builder builder(num_links, params);
+  const double l = params.length;
+
+  // Link i starts at the end of its parent and leans out in x, less and less
+  // with depth so that the branches do not cross.
+  std::vector<LinkSharedPtr> links;
+  std::vector<Point3> ends;
+  for (size_t i = 0; i < num_links; i++) {
+    Point3 start(0, 0, 0), direction(0, 0, 1);
+    if (i > 0) {
+      const size_t level = std::floor(std::log2(i + 1));
+      const double spread = std::ldexp(1.0, -int(level));
+      start = ends[(i - 1) / 2];
+      direction = Point3(i % 2 ? -spread : spread, 0, 1).normalized();
+    }
+    links.push_back(builder.addLink(start, start + 0.5 * l * direction));
+    ends.push_back(start + l * direction);
+    if (i > 0) builder.addJoint(links[(i - 1) / 2], links[i]);
+  }
+  return builder.robot(fixed_base);
+}
+
+/* ************************************************************************* */
+Robot Walker(size_t num_legs, size_t joints_per_leg,
+             const GeneratedLinkParams &params) {
+  if (num_legs == 0 || joints_per_leg == 0) {
+    throw std::invalid_argument("Walker: need at least one leg and joint");
+  }
+  Builder builder(1 + num_legs * joints_per_leg, params);
+  const double l = params.length, r = l / 2;
+
+  // The torso is a ball of radius l / 2, with the hips on its equator.
+  auto torso = builder.addLink(Point3(0, 0, 0), Point3(0, 0, 0),
+                               0.4 * params.mass * r * r *
+                                   Matrix3::Identity());
+  for (size_t leg = 0; leg < num_legs; leg++) {
+    const double angle = 2 * M_PI * leg / num_legs;
+    const Point3 hip(r * std::cos(angle), r * std::sin(angle), 0);
+    LinkSharedPtr parent = torso;
+    for (size_t k = 0; k < joints_per_leg; k++) {
+      auto link = builder.addLink(hip - Point3(0, 0, k * l),
+                                  hip - Point3(0, 0, (k + 0.5) * l));
+      builder.addJoint(parent, link);
+      parent = link;
+    }
+  }
+  return builder.robot(false);
+}
+
+/* ************************************************************************* */
+PointOnLinks WalkerFeet(const Robot &walker, size_t num_legs,
+                        size_t joints_per_leg,
+                        const GeneratedLinkParams &params) {
+  PointOnLinks feet;
+  for (size_t leg = 0; leg < num_legs; leg++) {
+    const size_t id = (leg + 1) * joints_per_leg;
+    feet.emplace_back(walker.link("link_" + std::to_string(id)),
+                      Point3(0, 0, -params.length / 2));
+  }
+  return feet;
+}
+
+}  // namespace robot_generator
+}  // namespace gtdynamics
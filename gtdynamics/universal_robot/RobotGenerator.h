@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotGenerator.h
+ * @brief Synthetic robots of any size, for scaling benchmarks and tests.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/// Geometry and inertia of the links of generated robots.
+struct GeneratedLinkParams {
+  double length = 0.5;   // length of every rod-shaped link
+  double mass = 1.0;     // mass of every link
+  double radius = 0.05;  // radius of the rods, for their inertia
+};
+
+/**
+ * Generators of robots with revolute joints and rod-shaped links, of any
+ * size up to the index limits of DynamicsSymbol, i.e. DynamicsSymbol::kNoIndex
+ * links and joints. Links and joints are numbered from 0 in order, links are
+ * named "link_i" and joints "joint_i", and all joints are actuated. Joint
+ * axes alternate between x and y, so chains are not planar. All robots are at
+ * rest with zero joint angles.
+ */
+namespace robot_generator {
+
+/**
+ * A serial chain of num_joints joints, pointing up from link_0 along z.
+ * @param num_joints number of joints, one less than the number of links
+ * @param fixed_base whether link_0 is fixed
+ * @param params     link geometry and inertia
+ */
+Robot SerialChain(size_t num_joints, bool fixed_base = true,
+                  const GeneratedLinkParams &params = GeneratedLinkParams());
+
+/**
+ * A binary tree of links: link_0 is the root, and every link below the last
+ * level has two children, spreading out in x. Link i has children 2i + 1 and
+ * 2i + 2, and is attached to its parent by joint i - 1.
+ * @param num_levels number of levels, 2^num_levels - 1 links
+ * @param fixed_base whether the root is fixed
+ * @param params     link geometry and inertia
+ */
+Robot BinaryTree(size_t num_levels, bool fixed_base = true,
+                 const GeneratedLinkParams &params = GeneratedLinkParams());
+
+/**
+ * A walker: a free torso, link_0, with num_legs legs spaced evenly around
+ * it, each a chain of joints_per_leg joints hanging down along -z. Leg l is
+ * made of links 1 + l * joints_per_leg, ..., (l + 1) * joints_per_leg, and
+ * the last of them is its foot, see WalkerFeet.
+ * @param num_legs       number of legs
+ * @param joints_per_leg number of joints of every leg
+ * @param params         link geometry and inertia
+ */
+Robot Walker(size_t num_legs, size_t joints_per_leg,
+             const GeneratedLinkParams &params = GeneratedLinkParams());
+
+/// Contact points at the bottom of the feet of a Walker.
+PointOnLinks WalkerFeet(
+    const Robot &walker, size_t num_legs, size_t joints_per_leg,
+    const GeneratedLinkParams &params = GeneratedLinkParams());
+
+}  // namespace robot_generator
+}  // namespace gtdynamics
@@ -0,0 +1,24 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotModel.cpp
+ * @brief Immutable robot, shared between threads building graphs.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/RobotModel.h>
+
+namespace gtdynamics {
+
+RobotModel::RobotModel(const Robot &robot)
+    : robot_(std::make_shared<const Robot>(robot)) {
+  // Build the topology now, so readers never wait on each other.
+  robot_->topology();
+}
+
+}  // namespace gtdynamics
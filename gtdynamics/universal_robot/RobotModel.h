@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotModel.h
+ * @brief Immutable robot, shared between threads building graphs.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * RobotModel is a frozen Robot that can be shared by a pool of workers. It
+ * converts to `const Robot &`, so it can be passed to every DynamicsGraph,
+ * Kinematics, Statics and Initializer builder.
+ *
+ * Thread safety: any number of threads may concurrently call const methods
+ * on a RobotModel, on the Robot it holds and on its links and joints,
+ * without locking. The topology is built when the model is created, and the
+ * joint motion caches are thread_local. Copying a RobotModel only copies a
+ * pointer.
+ *
+ * The links and joints are shared with the Robot the model was created
+ * from. Do not call removeLink or removeJoint on that robot, or on any other
+ * copy of it, while the model is in use: those modify the shared links.
+ */
+class RobotModel {
+ private:
+  std::shared_ptr<const Robot> robot_;
+
+ public:
+  /// Freeze a copy of `robot`.
+  explicit RobotModel(const Robot &robot);
+
+  /// Return the frozen robot.
+  const Robot &robot() const { return *robot_; }
+
+  /// Use the model wherever a `const Robot &` is expected.
+  operator const Robot &() const { return *robot_; }
+
+  const Robot &operator*() const { return *robot_; }
+  const Robot *operator->() const { return robot_.get(); }
+
+  /// Return a model of this robot with the named link fixed.
+  RobotModel fixLink(const std::string &name) const {
+    return RobotModel(robot_->fixLink(name));
+  }
+
+  /// Return a model of this robot with the named link unfixed.
+  RobotModel unfixLink(const std::string &name) const {
+    return RobotModel(robot_->unfixLink(name));
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotTopology.cpp
+ * @brief Flat, index-based view of the links and joints of a robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/RobotTopology.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <algorithm>
+#include <queue>
+
+namespace gtdynamics {
+
+RobotTopology::RobotTopology(const std::vector<LinkSharedPtr> &robot_links,
+                             const std::vector<JointSharedPtr> &robot_joints)
+    : links(robot_links),
+      joints(robot_joints),
+      // Sized so that any index in a DynamicsSymbol can be looked up.
+      link_index(DynamicsSymbol::kNoIndex + 1, -1),
+      joint_index(DynamicsSymbol::kNoIndex + 1, -1) {
+  const size_t num_links = links.size(), num_joints = joints.size();
+
+  for (size_t i = 0; i < num_links; i++) {
+    const auto &link = links[i];
+    link_index[link->id()] = i;
+    masses.push_back(link->mass());
+    inertias.push_back(link->inertiaMatrix());
+    fixed.push_back(link->isFixed());
+  }
+
+  std::vector<bool> is_child(num_links, false);
+  for (size_t j = 0; j < num_joints; j++) {
+    const auto &joint = joints[j];
+    joint_index[joint->id()] = j;
+    joint_parent.push_back(link_index[joint->parent()->id()]);
+    joint_child.push_back(link_index[joint->child()->id()]);
+    p_screw_axes.push_back(joint->pScrewAxis());
+    c_screw_axes.push_back(joint->cScrewAxis());
+    jMp.push_back(joint->jMp());
+    jMc.push_back(joint->jMc());
+    is_child[joint_child.back()] = true;
+  }
+
+  // Incidence lists, in the order of Link::joints().
+  link_joint_offsets.reserve(num_links + 1);
+  link_joint_offsets.push_back(0);
+  for (size_t i = 0; i < num_links; i++) {
+    for (auto &&joint : links[i]->joints()) {
+      const int j = joint_index[joint->id()];
+      if (j < 0) continue;
+      link_joints.push_back(j);
+      link_neighbors.push_back(joint_parent[j] == int(i) ? joint_child[j]
+                                                         : joint_parent[j]);
+    }
+    link_joint_offsets.push_back(link_joints.size());
+  }
+
+  if (num_links == 0) return;
+  for (size_t i = 0; i < num_links; i++)
+    if (fixed[i]) root = i;
+  for (size_t i = 0; i < num_links && root < 0; i++)
+    if (!is_child[i]) root = i;
+  if (root < 0) root = 0;
+
+  // BFS from the root, then from every link not reached yet, recording the
+  // spanning forest; bfs_order only holds the tree of the root.
+  tree_parent.assign(num_links, -1);
+  tree_joint.assign(num_links, -1);
+  tree_depth.assign(num_links, 0);
+  tree_id.assign(num_links, -1);
+  int num_trees = 0;
+  for (size_t r = 0; r <= num_links; r++) {
+    const int tree_root = r == 0 ? root : int(r - 1);
+    if (tree_id[tree_root] >= 0) continue;
+    std::queue<int> q;
+    q.push(tree_root);
+    tree_id[tree_root] = num_trees;
+    while (!q.empty()) {
+      const int i = q.front();
+      q.pop();
+      if (num_trees == 0) bfs_order.push_back(i);
+      forest_order.push_back(i);
+      for (int k = link_joint_offsets[i]; k < link_joint_offsets[i + 1];
+           k++) {
+        const int other = link_neighbors[k];
+        if (tree_id[other] >= 0) continue;
+        tree_id[other] = num_trees;
+        tree_parent[other] = i;
+        tree_joint[other] = link_joints[k];
+        tree_depth[other] = tree_depth[i] + 1;
+        q.push(other);
+      }
+    }
+    num_trees++;
+  }
+}
+
+/* ************************************************************************* */
+int RobotTopology::commonAncestor(int a, int b) const {
+  if (tree_id[a] != tree_id[b]) return -1;
+  while (tree_depth[a] > tree_depth[b]) a = tree_parent[a];
+  while (tree_depth[b] > tree_depth[a]) b = tree_parent[b];
+  while (a != b) {
+    a = tree_parent[a];
+    b = tree_parent[b];
+  }
+  return a;
+}
+
+/* ************************************************************************* */
+bool RobotTopology::path(int a, int b, std::vector<int> *joints) const {
+  joints->clear();
+  const int lca = commonAncestor(a, b);
+  if (lca < 0) return false;
+
+  // Up from a, then down to b: the joints from b up are appended and then
+  // reversed in place.
+  for (int i = a; i != lca; i = tree_parent[i]) {
+    joints->push_back(tree_joint[i]);
+  }
+  const size_t up = joints->size();
+  for (int i = b; i != lca; i = tree_parent[i]) {
+    joints->push_back(tree_joint[i]);
+  }
+  std::reverse(joints->begin() + up, joints->end());
+  return true;
+}
+
+}  // namespace gtdynamics
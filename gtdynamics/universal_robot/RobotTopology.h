@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotTopology.h
+ * @brief Flat, index-based view of the links and joints of a robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/RobotTypes.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RobotTopology is a frozen structure-of-arrays view of a robot, built once
+ * by Robot whenever its structure changes. Links and joints are referred to by
+ * their index in `links` and `joints`, which are in the same order as
+ * Robot::links() and Robot::joints().
+ *
+ * The fixed flags and the BFS order reflect the state at construction time:
+ * fix or unfix links through Robot::fixLink and Robot::unfixLink so that the
+ * topology is rebuilt.
+ */
+struct RobotTopology {
+  std::vector<LinkSharedPtr> links;
+  std::vector<JointSharedPtr> joints;
+
+  /// Link and joint indices keyed on their ids, -1 for unused ids.
+  std::vector<int> link_index, joint_index;
+
+  /// Per joint: parent and child link indices, screw axes in the parent and
+  /// child CoM frames, and the joint frame relative to both CoM frames.
+  std::vector<int> joint_parent, joint_child;
+  std::vector<gtsam::Vector6> p_screw_axes, c_screw_axes;
+  std::vector<gtsam::Pose3> jMp, jMc;
+
+  /// Per link: mass, 6x6 inertia matrix and whether it is fixed.
+  std::vector<double> masses;
+  std::vector<gtsam::Matrix6> inertias;
+  std::vector<bool> fixed;
+
+  /// Joints incident to each link in compressed row form: the joints of link
+  /// i are link_joints[k] for link_joint_offsets[i] <= k <
+  /// link_joint_offsets[i + 1], and link_neighbors[k] is the link at the other
+  /// end of that joint.
+  std::vector<int> link_joint_offsets, link_joints, link_neighbors;
+
+  /// BFS order of the links reachable from the root link. The root is the
+  /// last fixed link, as in Robot::forwardKinematics, or else the first link
+  /// that is not the child of any joint, or else the first link. -1 if there
+  /// are no links.
+  int root = -1;
+  std::vector<int> bfs_order;
+
+  /// Spanning forest of the links, for kinematic path queries: the BFS tree
+  /// from the root, then trees from every link it does not reach. Per link:
+  /// the link it was reached from and the joint to it, -1 for tree roots,
+  /// its depth, and the index of its tree. forest_order holds all links, tree
+  /// by tree in BFS order, so every link comes after its tree parent.
+  std::vector<int> tree_parent, tree_joint, tree_depth, tree_id;
+  std::vector<int> forest_order;
+
+  RobotTopology() {}
+
+  /// Build the topology from links and joints, in Robot::links() and
+  /// Robot::joints() order.
+  RobotTopology(const std::vector<LinkSharedPtr> &robot_links,
+                const std::vector<JointSharedPtr> &robot_joints);
+
+  /// Lowest common ancestor of links a and b in the spanning forest, -1 if
+  /// they are not connected. Takes O(path length) time.
+  int commonAncestor(int a, int b) const;
+
+  /**
+   * Joints on the path from link a to link b in the spanning forest, in
+   * order; the unique path when the robot is a tree. Reuses the storage of
+   * joints, so repeated queries do not allocate. Returns false if the links
+   * are not connected.
+   */
+  bool path(int a, int b, std::vector<int> *joints) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SubtreeInertiaCache.cpp
+ * @brief Incrementally updated composite rigid-body inertias of the subtrees
+ * of a robot.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/universal_robot/SubtreeInertiaCache.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SubtreeInertiaCache::SubtreeInertiaCache(const Robot &robot)
+    : topology_(robot.topology()) {
+  const size_t num_links = numLinks(), num_joints = numJoints();
+
+  // Children lists of the spanning forest, and the tree edge of every joint.
+  child_offsets_.assign(num_links + 1, 0);
+  joint_link_.assign(num_joints, -1);
+  for (size_t i = 0; i < num_links; i++) {
+    const int parent = topology_.tree_parent[i];
+    if (parent < 0) continue;
+    child_offsets_[parent + 1]++;
+    joint_link_[topology_.tree_joint[i]] = i;
+  }
+  for (size_t i = 0; i < num_links; i++) {
+    child_offsets_[i + 1] += child_offsets_[i];
+  }
+  children_.resize(child_offsets_[num_links]);
+  std::vector<int> next(child_offsets_.begin(), child_offsets_.end() - 1);
+  for (int i : topology_.forest_order) {
+    const int parent = topology_.tree_parent[i];
+    if (parent >= 0) children_[next[parent]++] = i;
+  }
+
+  joint_angles_ = gtsam::Vector::Zero(num_joints);
+  pTl_.resize(num_links);
+  X_.resize(num_links, gtsam::I_6x6);
+  composite_.resize(num_links, gtsam::Z_6x6);
+  stale_pose_.assign(num_links, true);
+  stale_composite_.assign(num_links, true);
+}
+
+/* ************************************************************************* */
+void SubtreeInertiaCache::invalidateAbove(int i) {
+  stale_pose_[i] = true;
+  for (int a = topology_.tree_parent[i]; a >= 0 && !stale_composite_[a];
+       a = topology_.tree_parent[a]) {
+    stale_composite_[a] = true;
+  }
+  stale_ = true;
+}
+
+/* ************************************************************************* */
+void SubtreeInertiaCache::setJointAngle(int j, double q) {
+  if (j < 0 || size_t(j) >= numJoints()) {
+    throw std::out_of_range("SubtreeInertiaCache: no joint with index " +
+                            std::to_string(j));
+  }
+  num_recomputed_ = 0;
+  if (joint_angles_(j) == q) return;
+  joint_angles_(j) = q;
+  if (joint_link_[j] >= 0) invalidateAbove(joint_link_[j]);
+}
+
+/* ************************************************************************* */
+void SubtreeInertiaCache::setJointAngles(const gtsam::Vector &joint_angles) {
+  if (size_t(joint_angles.size()) != numJoints()) {
+    throw std::invalid_argument(
+        "SubtreeInertiaCache: joint angles do not match the robot");
+  }
+  for (size_t j = 0; j < numJoints(); j++) setJointAngle(j, joint_angles(j));
+}
+
+/* ************************************************************************* */
+void SubtreeInertiaCache::setJointAngles(const gtsam::Values &values,
+                                         int t) {
+  for (size_t j = 0; j < numJoints(); j++) {
+    setJointAngle(j, JointAngle(values, topology_.joints[j]->id(), t));
+  }
+}
+
+/* ************************************************************************* */
+void SubtreeInertiaCache::refresh() const {
+  if (!stale_) return;
+  const size_t num_links = numLinks();
+  for (size_t i = 0; i < num_links; i++) {
+    if (!stale_pose_[i]) continue;
+    const int j = topology_.tree_joint[i];
+    pTl_[i] = j < 0 ? Pose3()
+                    : topology_.joints[j]->relativePoseOf(topology_.links[i],
+                                                          joint_angles_(j));
+    X_[i] = pTl_[i].inverse().AdjointMap();
+    stale_pose_[i] = false;
+  }
+
+  // Leaves first: I_a = I_a^link + sum over children b of X_b^T I_b X_b.
+  const auto &order = topology_.forest_order;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const int a = *it;
+    if (!stale_composite_[a]) continue;
+    Matrix6 &composite = composite_[a];
+    composite = topology_.inertias[a];
+    for (int k = child_offsets_[a]; k < child_offsets_[a + 1]; k++) {
+      const int b = children_[k];
+      composite += X_[b].transpose() * composite_[b] * X_[b];
+    }
+    stale_composite_[a] = false;
+    num_recomputed_++;
+  }
+  stale_ = false;
+}
+
+/* ************************************************************************* */
+const Matrix6 &SubtreeInertiaCache::compositeInertia(int i) const {
+  refresh();
+  return composite_.at(i);
+}
+
+/* ************************************************************************* */
+const std::vector<Matrix6> &SubtreeInertiaCache::compositeInertias() const {
+  refresh();
+  return composite_;
+}
+
+/* ************************************************************************* */
+const Pose3 &SubtreeInertiaCache::parentPose(int i) const {
+  refresh();
+  return pTl_.at(i);
+}
+
+/* ************************************************************************* */
+const std::vector<Matrix6> &SubtreeInertiaCache::relativeAdjoints() const {
+  refresh();
+  return X_;
+}
+
+/* ************************************************************************* */
+gtsam::Point3 SubtreeInertiaCache::subtreeCom(int i) const {
+  // The upper right block of a spatial inertia is m [c]x, for a center of
+  // mass c.
+  const Matrix6 &composite = compositeInertia(i);
+  const double m = composite(3, 3);
+  return gtsam::Point3(composite(2, 4), composite(0, 5), composite(1, 3)) / m;
+}
+
+/* ************************************************************************* */
+size_t SubtreeInertiaCache::numRecomputed() const {
+  refresh();
+  return num_recomputed_;
+}
+
+}  // namespace gtdynamics
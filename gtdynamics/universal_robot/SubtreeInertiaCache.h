@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SubtreeInertiaCache.h
+ * @brief Incrementally updated composite rigid-body inertias of the subtrees
+ * of a robot.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotTopology.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SubtreeInertiaCache holds, for every link, the composite inertia of the
+ * subtree below it in the spanning forest of the robot topology: the spatial
+ * inertia of all links of the subtree, rigidly locked in the current joint
+ * angles, in the CoM frame of the link.
+ *
+ * A composite inertia only depends on the joint angles inside its subtree, so
+ * changing the angle of a joint only invalidates the links above it, up to
+ * their tree root. Setters mark those links, and accessors recompute them on
+ * demand, children first; everything else is reused. Joints that close loops
+ * are not tree edges and their angles do not affect any subtree.
+ *
+ * Links and joints are referred to by their index in Robot::links() and
+ * Robot::joints(). Accessors are not thread-safe, as they may update the
+ * cache.
+ */
+class SubtreeInertiaCache {
+ private:
+  RobotTopology topology_;
+
+  /// Per link: its children in the spanning forest, in compressed row form.
+  std::vector<int> child_offsets_, children_;
+
+  /// Per joint: the link it leads to in the spanning forest, -1 if none.
+  std::vector<int> joint_link_;
+
+  gtsam::Vector joint_angles_;
+
+  /// Per link: pose in its tree parent, the adjoint of its inverse, and its
+  /// composite inertia; stale flags for the first two and the last.
+  mutable std::vector<gtsam::Pose3> pTl_;
+  mutable std::vector<gtsam::Matrix6> X_, composite_;
+  mutable std::vector<bool> stale_pose_, stale_composite_;
+  mutable bool stale_ = true;
+  mutable size_t num_recomputed_ = 0;  // since joint angles were last set
+
+  /// Mark the ancestors of link i stale, stopping at stale ones as their
+  /// ancestors are stale already.
+  void invalidateAbove(int i);
+
+  /// Recompute stale poses and composite inertias.
+  void refresh() const;
+
+ public:
+  /**
+   * Constructor, with all joint angles zero: the rest configuration in which
+   * the links are at Link::bMcom().
+   */
+  explicit SubtreeInertiaCache(const Robot &robot);
+
+  /// Number of links.
+  size_t numLinks() const { return topology_.links.size(); }
+
+  /// Number of joints.
+  size_t numJoints() const { return topology_.joints.size(); }
+
+  /// The topology, whose spanning forest defines the subtrees.
+  const RobotTopology &topology() const { return topology_; }
+
+  /// Set the angle of joint j.
+  void setJointAngle(int j, double q);
+
+  /// Set all joint angles, in Robot::joints() order; only the joints whose
+  /// angle changed invalidate the cache.
+  void setJointAngles(const gtsam::Vector &joint_angles);
+
+  /// Set all joint angles from the values of time step t.
+  void setJointAngles(const gtsam::Values &values, int t = 0);
+
+  /// Current joint angles.
+  const gtsam::Vector &jointAngles() const { return joint_angles_; }
+
+  /// Composite inertia of the subtree of link i, in its CoM frame.
+  const gtsam::Matrix6 &compositeInertia(int i) const;
+
+  /// Composite inertias of all links, see compositeInertia.
+  const std::vector<gtsam::Matrix6> &compositeInertias() const;
+
+  /// Pose of link i in the CoM frame of its tree parent, identity for roots.
+  const gtsam::Pose3 &parentPose(int i) const;
+
+  /// Adjoint map of the pose of the tree parent of link i in the CoM frame of
+  /// link i, which maps parent twists to link i twists.
+  const std::vector<gtsam::Matrix6> &relativeAdjoints() const;
+
+  /// Total mass of the subtree of link i.
+  double subtreeMass(int i) const { return compositeInertia(i)(3, 3); }
+
+  /// Center of mass of the subtree of link i, in its CoM frame.
+  gtsam::Point3 subtreeCom(int i) const;
+
+  /// Number of composite inertias recomputed since joint angles were last
+  /// set, including by this call.
+  size_t numRecomputed() const;
+};
+
+}  // namespace gtdynamics
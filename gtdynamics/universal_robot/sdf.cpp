@@ -18,8 +18,11 @@
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/universal_robot/sdf_internal.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Parallel.h>
 
 #include <fstream>
+#include <set>
 #include <sdf/parser.hh>
 #include <sdf/sdf.hh>
 
@@ -27,9 +30,9 @@ namespace gtdynamics {
 
 using gtsam::Pose3;
 
-sdf::Model GetSdf(const std::string &sdf_file_path,
-                  const std::string &model_name,
-                  const sdf::ParserConfig &config) {
+// Parse a urdf or sdf file into `root`.
+static void LoadSdfRoot(const std::string &sdf_file_path,
+                        const sdf::ParserConfig &config, sdf::Root *root) {
   sdf::Errors errors;
 
   sdf::SDFPtr sdf = sdf::readFile(sdf_file_path, config, errors);
@@ -41,14 +44,20 @@ sdf::Model GetSdf(const std::string &sdf_file_path,
     throw std::runtime_error("SDF library could not parse " + sdf_file_path);
   }
 
-  sdf::Root root;
-  errors = root.Load(sdf, config);
+  errors = root->Load(sdf, config);
   if (errors.size() > 0) {
     for (auto &&error : errors) {
       std::cout << error.Message() << std::endl;
     }
     throw std::runtime_error("Error loading SDF file " + sdf_file_path);
   }
+}
+
+sdf::Model GetSdf(const std::string &sdf_file_path,
+                  const std::string &model_name,
+                  const sdf::ParserConfig &config) {
+  sdf::Root root;
+  LoadSdfRoot(sdf_file_path, config, &root);
 
   // Check whether this is a world file, in which case we have to first
   // access the world element then check whether one of its child models
@@ -166,7 +175,7 @@ gtsam::Vector3 GetSdfAxis(const sdf::Joint &sdf_joint) {
   return gtsam::Vector3(axis[0], axis[1], axis[2]);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
+LinkSharedPtr LinkFromSdf(uint16_t id, const sdf::Link &sdf_link) {
   gtsam::Matrix3 inertia;
   const auto &I = sdf_link.Inertial().Moi();
   inertia << I(0, 0), I(0, 1), I(0, 2), I(1, 0), I(1, 1), I(1, 2), I(2, 0),
@@ -183,14 +192,14 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
                                   inertia, bMcom, bMl);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &link_name,
+LinkSharedPtr LinkFromSdf(uint16_t id, const std::string &link_name,
                           const std::string &sdf_file_path,
                           const std::string &model_name) {
   auto model = GetSdf(sdf_file_path, model_name);
   return LinkFromSdf(id, *model.LinkByName(link_name));
 }
 
-JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
+JointSharedPtr JointFromSdf(uint16_t id, const LinkSharedPtr &parent_link,
                             const sdf::Link *parent_sdf_link,
                             const LinkSharedPtr &child_link,
                             const sdf::Link *child_sdf_link,
@@ -242,6 +251,13 @@ JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
  * @return LinkMap and JointMap as a pair
  */
 static LinkJointPair ExtractRobotFromSdf(const sdf::Model &sdf) {
+  // Ids must fit in the link and joint fields of a DynamicsSymbol.
+  if (sdf.LinkCount() >= DynamicsSymbol::kNoIndex ||
+      sdf.JointCount() >= DynamicsSymbol::kNoIndex) {
+    throw std::runtime_error("Model " + sdf.Name() +
+                             " has too many links or joints.");
+  }
+
   // Loop through all links in the sdf interface and construct Link
   // objects without parents or children.
   LinkMap name_to_link;
@@ -293,9 +309,8 @@ static LinkJointPair ExtractRobotFromSdf(const sdf::Model &sdf) {
  * URDF file should be preserved and not merged.
  * @return LinkMap and JointMap as a pair
  */
-static LinkJointPair ExtractRobotFromFile(const std::string &file_path,
-                                          const std::string &model_name,
-                                          bool preserve_fixed_joint) {
+// Check that a robot file exists and return its lower case extension.
+static std::string RobotFileExtension(const std::string &file_path) {
   std::ifstream is(file_path);
   if (!is.good())
     throw std::runtime_error("ExtractRobotFromFile: no file found at " +
@@ -304,6 +319,13 @@ static LinkJointPair ExtractRobotFromFile(const std::string &file_path,
 
   std::string file_ext = file_path.substr(file_path.find_last_of(".") + 1);
   std::transform(file_ext.begin(), file_ext.end(), file_ext.begin(), ::tolower);
+  return file_ext;
+}
+
+static LinkJointPair ExtractRobotFromFile(const std::string &file_path,
+                                          const std::string &model_name,
+                                          bool preserve_fixed_joint) {
+  const std::string file_ext = RobotFileExtension(file_path);
 
   sdf::ParserConfig _config = sdf::ParserConfig::GlobalConfig();
   _config.URDFSetPreserveFixedJoint(preserve_fixed_joint);
@@ -325,4 +347,54 @@ Robot CreateRobotFromFile(const std::string &file_path,
   return Robot(links_joints_pair.first, links_joints_pair.second);
 }
 
+std::map<std::string, Robot> CreateRobotsFromFile(
+    const std::string &file_path, const std::vector<std::string> &model_names,
+    bool preserve_fixed_joint, size_t num_threads) {
+  const std::string file_ext = RobotFileExtension(file_path);
+  if (file_ext != "urdf" && file_ext != "sdf")
+    throw std::runtime_error("Invalid file extension.");
+
+  sdf::ParserConfig config = sdf::ParserConfig::GlobalConfig();
+  config.URDFSetPreserveFixedJoint(preserve_fixed_joint);
+  sdf::Root root;
+  LoadSdfRoot(file_path, config, &root);
+
+  // Collect the requested models of all worlds, the first one of each name.
+  const std::set<std::string> wanted(model_names.begin(), model_names.end());
+  std::vector<const sdf::Model *> models;
+  std::set<std::string> found;
+  auto collect = [&](const sdf::Model *model) {
+    const std::string &name = model->Name();
+    if ((wanted.empty() || wanted.count(name)) && found.insert(name).second)
+      models.push_back(model);
+  };
+  if (root.WorldCount() > 0) {
+    for (size_t widx = 0; widx < root.WorldCount(); widx++) {
+      const sdf::World *world = root.WorldByIndex(widx);
+      for (uint midx = 0; midx < world->ModelCount(); midx++)
+        collect(world->ModelByIndex(midx));
+    }
+  } else if (root.Model() && root.Model()->Name() != "__default__") {
+    collect(root.Model());
+  }
+
+  for (auto &&name : wanted) {
+    if (!found.count(name))
+      throw std::runtime_error("Model " + name + " not found in: " + file_path);
+  }
+
+  // The models are independent, so convert them concurrently.
+  std::vector<LinkJointPair> links_joints(models.size());
+  ParallelFor(models.size(), num_threads, [&](size_t i) {
+    links_joints[i] = ExtractRobotFromSdf(*models[i]);
+  });
+
+  std::map<std::string, Robot> robots;
+  for (size_t i = 0; i < models.size(); i++) {
+    robots.emplace(models[i]->Name(),
+                   Robot(links_joints[i].first, links_joints[i].second));
+  }
+  return robots;
+}
+
 }  // namespace gtdynamics
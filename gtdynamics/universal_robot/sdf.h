@@ -15,7 +15,9 @@
 
 #include <gtdynamics/universal_robot/Robot.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -31,4 +33,20 @@ Robot CreateRobotFromFile(const std::string &file_path,
                           const std::string &model_name = "",
                           bool preserve_fixed_joint = false);
 
+/**
+ * @fn Construct several robots from a urdf or sdf file, parsing it only once.
+ * @param[in] file_path path to the file.
+ * @param[in] model_names names of the robots we care about. If empty, all
+ *    models in all worlds of the file are loaded.
+ * @param[in] preserve_fixed_joint Flag indicating if the fixed joints in the
+ * URDF file should be preserved and not merged.
+ * @param[in] num_threads number of threads building the robots, 0 to use the
+ * hardware concurrency.
+ * @return map from model name to robot.
+ */
+std::map<std::string, Robot> CreateRobotsFromFile(
+    const std::string &file_path,
+    const std::vector<std::string> &model_names = {},
+    bool preserve_fixed_joint = false, size_t num_threads = 0);
+
 }  // namespace gtdynamics
@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AsyncResultWriter.cpp
+ * @brief Write optimization results to disk on a background thread.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/AsyncResultWriter.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+// Json format of a ResultFormat, which must be one of the json formats.
+static JsonFormat ToJsonFormat(ResultFormat format) {
+  switch (format) {
+    case ResultFormat::kJson:
+      return JsonFormat::kJson;
+    case ResultFormat::kNdJson:
+      return JsonFormat::kNdJson;
+    default:
+      throw std::invalid_argument("AsyncResultWriter: not a json format");
+  }
+}
+
+static void OpenFile(const std::string &file_path, std::ofstream *os) {
+  os->open(file_path);
+  if (!*os) {
+    throw std::runtime_error("AsyncResultWriter: cannot open " + file_path);
+  }
+}
+
+static void WriteValues(const std::string &file_path, const Values &values,
+                        ResultFormat format) {
+  if (format == ResultFormat::kTrajectoryLog) {
+    TrajectoryLogWriter log(file_path);
+    log.appendTrajectory(values);
+    log.close();
+    return;
+  }
+  std::ofstream os;
+  OpenFile(file_path, &os);
+  JsonStreamWriter writer(os, ToJsonFormat(format));
+  writer.beginList("variables");
+  for (gtsam::Key key : values.keys()) {
+    writer.addDict(JsonSaver::GetVariableAttributes(
+        key, values, JsonSaver::LocationType()));
+  }
+  writer.close();
+}
+
+/* ************************************************************************* */
+AsyncResultWriter::AsyncResultWriter(size_t capacity) : capacity_(capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("AsyncResultWriter: capacity must be > 0");
+  }
+  thread_ = std::thread(&AsyncResultWriter::work, this);
+}
+
+/* ************************************************************************* */
+AsyncResultWriter::~AsyncResultWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  not_empty_.notify_all();
+  thread_.join();
+}
+
+/* ************************************************************************* */
+size_t AsyncResultWriter::numQueued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+/* ************************************************************************* */
+size_t AsyncResultWriter::numWritten() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_written_;
+}
+
+/* ************************************************************************* */
+bool AsyncResultWriter::push(const std::function<Task()> &make, bool block) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (block) {
+      not_full_.wait(lock, [this]() { return queue_.size() < capacity_; });
+    } else if (queue_.size() >= capacity_) {
+      return false;
+    }
+    queue_.push_back(make());
+  }
+  not_empty_.notify_one();
+  return true;
+}
+
+/* ************************************************************************* */
+void AsyncResultWriter::post(Task task) {
+  push([&task]() { return std::move(task); }, true);
+}
+
+/* ************************************************************************* */
+bool AsyncResultWriter::tryPost(Task &&task) {
+  return push([&task]() { return std::move(task); }, false);
+}
+
+/* ************************************************************************* */
+void AsyncResultWriter::writeValues(const std::string &file_path,
+                                    Values &&values, ResultFormat format) {
+  auto owned = std::make_shared<Values>(std::move(values));
+  post([file_path, owned, format]() {
+    WriteValues(file_path, *owned, format);
+  });
+}
+
+/* ************************************************************************* */
+bool AsyncResultWriter::tryWriteValues(const std::string &file_path,
+                                       Values &&values, ResultFormat format) {
+  return push(
+      [&]() -> Task {
+        auto owned = std::make_shared<Values>(std::move(values));
+        return [file_path, owned, format]() {
+          WriteValues(file_path, *owned, format);
+        };
+      },
+      false);
+}
+
+/* ************************************************************************* */
+void AsyncResultWriter::writeGraph(const std::string &file_path,
+                                   NonlinearFactorGraph &&graph,
+                                   Values &&values, ResultFormat format) {
+  const JsonFormat json_format = ToJsonFormat(format);
+  auto owned_graph = std::make_shared<NonlinearFactorGraph>(std::move(graph));
+  auto owned_values = std::make_shared<Values>(std::move(values));
+  post([file_path, owned_graph, owned_values, json_format]() {
+    std::ofstream os;
+    OpenFile(file_path, &os);
+    JsonSaver::SaveFactorGraph(*owned_graph, os, *owned_values,
+                               JsonSaver::LocationType(), json_format);
+  });
+}
+
+/* ************************************************************************* */
+void AsyncResultWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+/* ************************************************************************* */
+void AsyncResultWriter::work() {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) return;  // stopping, with all results written
+      task = std::move(queue_.front());
+      queue_.pop_front();
+      busy_ = true;
+    }
+    not_full_.notify_one();
+
+    std::exception_ptr error;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_ = false;
+      num_written_++;
+      if (error && !error_) error_ = error;
+    }
+    idle_.notify_all();
+  }
+}
+
+}  // namespace gtdynamics
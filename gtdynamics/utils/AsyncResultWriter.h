@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AsyncResultWriter.h
+ * @brief Write optimization results to disk on a background thread.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace gtdynamics {
+
+/// File formats of AsyncResultWriter.
+enum class ResultFormat {
+  kTrajectoryLog,  // binary, see TrajectoryLogWriter
+  kJson,           // one json document, see JsonStreamWriter
+  kNdJson,         // newline delimited json, one variable or factor per line
+};
+
+/**
+ * AsyncResultWriter serializes results on a background thread, so that a
+ * solver can start its next job while the previous results go to disk.
+ *
+ * Results are moved into a bounded queue and written in order. When the
+ * queue is full, the write functions block until a result has been written,
+ * and the try functions return false without taking the result, so callers
+ * choose between waiting and dropping or retrying. Any other output, e.g.
+ * CSV files or boost archives, can be queued as a task.
+ *
+ * Exceptions thrown while writing do not stop the writer: the first one is
+ * kept and rethrown by the next flush().
+ *
+ * Example:
+ *   AsyncResultWriter writer;
+ *   for (...) {
+ *     gtsam::Values result = optimizer.optimize();
+ *     writer.writeValues("result.log", std::move(result),
+ *                        ResultFormat::kTrajectoryLog);
+ *   }
+ *   writer.flush();
+ */
+class AsyncResultWriter {
+ public:
+  typedef std::function<void()> Task;
+
+  /**
+   * Start the writer thread.
+   * @param capacity maximum number of results waiting to be written
+   */
+  explicit AsyncResultWriter(size_t capacity = 8);
+
+  /// Write the results still queued, then join the thread.
+  ~AsyncResultWriter();
+
+  AsyncResultWriter(const AsyncResultWriter &) = delete;
+  AsyncResultWriter &operator=(const AsyncResultWriter &) = delete;
+
+  /// Maximum number of results waiting to be written.
+  size_t capacity() const { return capacity_; }
+
+  /// Number of results waiting to be written, not counting the current one.
+  size_t numQueued() const;
+
+  /// Number of results written so far, including failed ones.
+  size_t numWritten() const;
+
+  /// Queue a task, waiting while the queue is full.
+  void post(Task task);
+
+  /// Queue a task if the queue is not full; task is only moved from if so.
+  bool tryPost(Task &&task);
+
+  /**
+   * Queue values to be written to a file, waiting while the queue is full.
+   * @param file_path path of the file, overwritten
+   * @param values    values, moved into the writer
+   * @param format    file format; kTrajectoryLog writes the trajectory of
+   * double, Vector3, Vector6 and Pose3 variables, the json formats write
+   * every variable as in JsonSaver
+   */
+  void writeValues(const std::string &file_path, gtsam::Values &&values,
+                   ResultFormat format);
+
+  /// As writeValues, if the queue is not full; values are only moved if so.
+  bool tryWriteValues(const std::string &file_path, gtsam::Values &&values,
+                      ResultFormat format);
+
+  /**
+   * Queue a factor graph and its values to be written as json, as in
+   * JsonSaver::SaveFactorGraph, waiting while the queue is full.
+   * @param file_path path of the file, overwritten
+   * @param graph     factor graph, moved into the writer
+   * @param values    values, moved into the writer
+   * @param format    kJson or kNdJson
+   */
+  void writeGraph(const std::string &file_path,
+                  gtsam::NonlinearFactorGraph &&graph, gtsam::Values &&values,
+                  ResultFormat format = ResultFormat::kNdJson);
+
+  /**
+   * Wait until all queued results are written, and rethrow the first
+   * exception thrown while writing since the last flush, if any.
+   */
+  void flush();
+
+ private:
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_, idle_;
+  std::deque<Task> queue_;
+  std::thread thread_;
+  bool busy_ = false, stopping_ = false;
+  size_t num_written_ = 0;
+  std::exception_ptr error_;
+
+  /**
+   * Queue the task returned by make, called with the lock held once there
+   * is room, or not at all if the queue is full and block is false.
+   */
+  bool push(const std::function<Task()> &make, bool block);
+
+  void work();
+};
+
+}  // namespace gtdynamics
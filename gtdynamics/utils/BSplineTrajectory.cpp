@@ -0,0 +1,258 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BSplineTrajectory.cpp
+ * @brief Joint trajectories parameterized by B-spline control points.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/BSplineTrajectory.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+
+// Index of the knot span [U[span], U[span + 1]) that contains u, for n + 1
+// control points of degree p (Piegl and Tiller, The NURBS Book, A2.1).
+size_t FindSpan(const std::vector<double> &U, size_t n, size_t p, double u) {
+  if (u >= U[n + 1]) return n;
+  if (u <= U[p]) return p;
+  size_t low = p, high = n + 1, mid = (low + high) / 2;
+  while (u < U[mid] || u >= U[mid + 1]) {
+    if (u < U[mid]) {
+      high = mid;
+    } else {
+      low = mid;
+    }
+    mid = (low + high) / 2;
+  }
+  return mid;
+}
+
+// Nonzero basis functions at u and their derivatives up to num_ders, in the
+// rows of a (num_ders + 1) x (p + 1) matrix (The NURBS Book, A2.3).
+Matrix DersBasisFuns(const std::vector<double> &U, size_t span, size_t p,
+                     double u, size_t num_ders) {
+  Matrix ders = Matrix::Zero(num_ders + 1, p + 1);
+  std::vector<std::vector<double>> ndu(p + 1, std::vector<double>(p + 1)),
+      a(2, std::vector<double>(p + 1));
+  std::vector<double> left(p + 1), right(p + 1);
+  ndu[0][0] = 1.0;
+  for (size_t j = 1; j <= p; j++) {
+    left[j] = u - U[span + 1 - j];
+    right[j] = U[span + j] - u;
+    double saved = 0.0;
+    for (size_t r = 0; r < j; r++) {
+      ndu[j][r] = right[r + 1] + left[j - r];
+      const double temp = ndu[r][j - 1] / ndu[j][r];
+      ndu[r][j] = saved + right[r + 1] * temp;
+      saved = left[j - r] * temp;
+    }
+    ndu[j][j] = saved;
+  }
+  for (size_t j = 0; j <= p; j++) ders(0, j) = ndu[j][p];
+
+  const int P = p, n = std::min(num_ders, p);
+  for (int r = 0; r <= P; r++) {
+    int s1 = 0, s2 = 1;
+    a[0][0] = 1.0;
+    for (int k = 1; k <= n; k++) {
+      double d = 0.0;
+      const int rk = r - k, pk = P - k;
+      if (r >= k) {
+        a[s2][0] = a[s1][0] / ndu[pk + 1][rk];
+        d = a[s2][0] * ndu[rk][pk];
+      }
+      const int j1 = (rk >= -1) ? 1 : -rk;
+      const int j2 = (r - 1 <= pk) ? k - 1 : P - r;
+      for (int j = j1; j <= j2; j++) {
+        a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[pk + 1][rk + j];
+        d += a[s2][j] * ndu[rk + j][pk];
+      }
+      if (r <= pk) {
+        a[s2][k] = -a[s1][k - 1] / ndu[pk + 1][r];
+        d += a[s2][k] * ndu[r][pk];
+      }
+      ders(k, r) = d;
+      std::swap(s1, s2);
+    }
+  }
+  double factor = P;
+  for (int k = 1; k <= n; k++) {
+    ders.row(k) *= factor;
+    factor *= (P - k);
+  }
+  return ders;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+BSplineTrajectory::BSplineTrajectory(size_t num_control_points,
+                                     size_t num_steps, double dt,
+                                     size_t degree)
+    : num_control_points_(num_control_points),
+      num_steps_(num_steps),
+      degree_(degree),
+      dt_(dt) {
+  if (degree_ < 1 || num_control_points_ < degree_ + 1) {
+    throw std::invalid_argument(
+        "BSplineTrajectory: need a degree of at least 1 and at least "
+        "degree + 1 control points");
+  }
+  if (num_steps_ < 1 || dt_ <= 0) {
+    throw std::invalid_argument(
+        "BSplineTrajectory: need at least one step of positive duration");
+  }
+
+  // Clamped uniform knots over [0, num_steps * dt].
+  const double T = num_steps_ * dt_;
+  const size_t p = degree_, n = num_control_points_ - 1,
+               num_spans = num_control_points_ - degree_;
+  knots_.assign(p + 1, 0.0);
+  for (size_t j = 1; j < num_spans; j++) knots_.push_back(T * j / num_spans);
+  knots_.insert(knots_.end(), p + 1, T);
+
+  for (size_t k = 0; k <= num_steps_; k++) {
+    const double t = std::min(k * dt_, T);
+    const size_t span = FindSpan(knots_, n, p, t);
+    first_.push_back(span - p);
+    weights_.push_back(DersBasisFuns(knots_, span, p, t, 2));
+  }
+}
+
+/* ************************************************************************* */
+Vector BSplineTrajectory::weights(size_t k, int order) const {
+  if (order < 0 || order > 2) {
+    throw std::invalid_argument("BSplineTrajectory: order must be 0, 1 or 2");
+  }
+  return weights_.at(k).row(order).transpose();
+}
+
+/* ************************************************************************* */
+BSplineFactor::Combination BSplineTrajectory::combination(
+    gtsam::Key key) const {
+  const uint16_t label = DynamicsSymbol::LabelCodeOf(key);
+  int order;
+  if (label == DynamicsSymbol::LabelCode("q")) {
+    order = 0;
+  } else if (label == DynamicsSymbol::LabelCode("v")) {
+    order = 1;
+  } else if (label == DynamicsSymbol::LabelCode("a")) {
+    order = 2;
+  } else {
+    return {};
+  }
+  const DynamicsSymbol symbol(key);
+  if (symbol.linkIdx() != DynamicsSymbol::kNoIndex ||
+      symbol.jointIdx() == DynamicsSymbol::kNoIndex ||
+      symbol.time() > num_steps_) {
+    return {};
+  }
+
+  const size_t k = symbol.time();
+  BSplineFactor::Combination terms;
+  for (size_t i = 0; i <= degree_; i++) {
+    const double w = weights_[k](order, i);
+    if (w == 0.0) continue;
+    const gtsam::Key control =
+        DynamicsSymbol(JointControlPointKey(symbol.jointIdx(), first_[k] + i))
+            .ofRobot(symbol.robotIdx());
+    terms.emplace_back(control, w);
+  }
+  // Keep a key for a combination that happens to be zero, e.g. the
+  // acceleration of a linear spline.
+  if (terms.empty()) {
+    terms.emplace_back(
+        DynamicsSymbol(JointControlPointKey(symbol.jointIdx(), first_[k]))
+            .ofRobot(symbol.robotIdx()),
+        0.0);
+  }
+  return terms;
+}
+
+/* ************************************************************************* */
+double BSplineTrajectory::evaluate(const Values &control_points, int j,
+                                   size_t k, int order) const {
+  const Vector w = weights(k, order);
+  double value = 0.0;
+  for (size_t i = 0; i <= degree_; i++) {
+    value += w(i) * control_points.at<double>(
+                        JointControlPointKey(j, first_[k] + i));
+  }
+  return value;
+}
+
+/* ************************************************************************* */
+Values BSplineTrajectory::expand(const Robot &robot,
+                                 const Values &control_points) const {
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (size_t k = 0; k <= num_steps_; k++) {
+      InsertJointAngle(&values, j, k, evaluate(control_points, j, k, 0));
+      InsertJointVel(&values, j, k, evaluate(control_points, j, k, 1));
+      InsertJointAccel(&values, j, k, evaluate(control_points, j, k, 2));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values BSplineTrajectory::fit(const Robot &robot, const Values &values) const {
+  Matrix B = Matrix::Zero(num_steps_ + 1, num_control_points_);
+  for (size_t k = 0; k <= num_steps_; k++) {
+    B.block(k, first_[k], 1, degree_ + 1) = weights_[k].row(0);
+  }
+  const auto qr = B.colPivHouseholderQr();
+
+  Values control_points;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    Vector q(num_steps_ + 1);
+    for (size_t k = 0; k <= num_steps_; k++) q(k) = JointAngle(values, j, k);
+    const Vector P = qr.solve(q);
+    for (size_t c = 0; c < num_control_points_; c++) {
+      control_points.insert(JointControlPointKey(j, c), P(c));
+    }
+  }
+  return control_points;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph BSplineTrajectory::rewrite(
+    const gtsam::NonlinearFactorGraph &graph) const {
+  gtsam::NonlinearFactorGraph rewritten;
+  rewritten.reserve(graph.size());
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    std::map<gtsam::Key, BSplineFactor::Combination> combinations;
+    for (gtsam::Key key : factor->keys()) {
+      BSplineFactor::Combination terms = combination(key);
+      if (!terms.empty()) combinations.emplace(key, std::move(terms));
+    }
+    if (combinations.empty()) {
+      rewritten.push_back(factor);
+    } else {
+      rewritten.emplace_shared<BSplineFactor>(factor, combinations);
+    }
+  }
+  return rewritten;
+}
+
+}  // namespace gtdynamics
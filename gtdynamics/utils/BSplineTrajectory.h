@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BSplineTrajectory.h
+ * @brief Joint trajectories parameterized by B-spline control points.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/factors/BSplineFactor.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * BSplineTrajectory represents every joint trajectory over num_steps time
+ * steps of duration dt by the control points of a clamped uniform B-spline,
+ * with keys JointControlPointKey(j, c). Joint angles, velocities and
+ * accelerations at every step are fixed linear combinations of degree + 1
+ * consecutive control points, so the q/v/a variables of a trajectory factor
+ * graph can be replaced by far fewer control points: rewrite wraps the
+ * factors of a graph in BSplineFactors, which keeps the existing dynamics
+ * factors. Collocation factors are not needed, as the spline is smooth by
+ * construction; leave them out of the graph that is rewritten.
+ *
+ * The spline is clamped, so the first and last control points are the joint
+ * angles at the first and last steps.
+ */
+class BSplineTrajectory {
+ private:
+  size_t num_control_points_, num_steps_, degree_;
+  double dt_;
+  std::vector<double> knots_;
+
+  /// For every step, the first control point it depends on, and the weights
+  /// of angle, velocity and acceleration in the rows of a 3 x (degree + 1)
+  /// matrix.
+  std::vector<size_t> first_;
+  std::vector<gtsam::Matrix> weights_;
+
+ public:
+  /**
+   * Constructor.
+   * @param num_control_points control points per joint, at least degree + 1
+   * @param num_steps          number of time steps, steps 0 to num_steps
+   * @param dt                 duration of a time step
+   * @param degree             degree of the spline
+   */
+  BSplineTrajectory(size_t num_control_points, size_t num_steps, double dt,
+                    size_t degree = 3);
+
+  size_t numControlPoints() const { return num_control_points_; }
+  size_t numSteps() const { return num_steps_; }
+  size_t degree() const { return degree_; }
+  double dt() const { return dt_; }
+
+  /// First control point that step k depends on.
+  size_t firstControlPoint(size_t k) const { return first_.at(k); }
+
+  /**
+   * Weights of the control points firstControlPoint(k) to
+   * firstControlPoint(k) + degree at step k.
+   * @param k     time step
+   * @param order 0 for the angle, 1 for the velocity, 2 for the acceleration
+   */
+  gtsam::Vector weights(size_t k, int order) const;
+
+  /**
+   * The combination of control points of a joint angle, velocity or
+   * acceleration key at a step of the spline; empty for other keys.
+   */
+  BSplineFactor::Combination combination(gtsam::Key key) const;
+
+  /// Angle, velocity or acceleration of joint j at step k.
+  double evaluate(const gtsam::Values &control_points, int j, size_t k,
+                  int order) const;
+
+  /// Joint angles, velocities and accelerations of every joint of the robot
+  /// and every step, from control points.
+  gtsam::Values expand(const Robot &robot,
+                       const gtsam::Values &control_points) const;
+
+  /// Least-squares fit of the control points of every joint of the robot to
+  /// the joint angles of every step, e.g. to initialize them.
+  gtsam::Values fit(const Robot &robot, const gtsam::Values &values) const;
+
+  /**
+   * Replace joint angles, velocities and accelerations by control points in
+   * every factor of a graph, wrapping the factors that involve them in
+   * BSplineFactors. Other factors are copied as they are.
+   */
+  gtsam::NonlinearFactorGraph rewrite(
+      const gtsam::NonlinearFactorGraph &graph) const;
+};
+
+}  // namespace gtdynamics
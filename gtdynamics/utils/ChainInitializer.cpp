@@ -12,30 +12,203 @@
  */
 
 #include <gtdynamics/utils/ChainInitializer.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 namespace gtdynamics {
 
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+namespace {
+
+// The base of ChainDynamicsGraph: the link with the most joints.
+LinkSharedPtr ChainBase(const Robot& robot) {
+  LinkSharedPtr base;
+  for (auto&& link : robot.links()) {
+    if (!base || link->numJoints() > base->numJoints()) base = link;
+  }
+  return base;
+}
+
+// Angle in [-pi, pi].
+double Wrap(double angle) {
+  return std::atan2(std::sin(angle), std::cos(angle));
+}
+
+// Rotate x by R about the point p.
+Point3 Rotate(const Rot3& R, const Point3& p, const Point3& x) {
+  return p + R.rotate(x - p);
+}
+
+// A leg of three revolute joints from the base to a foot, with its axes,
+// points on them and the foot point in the base CoM frame, all at zero
+// joint angles.
+struct Leg {
+  std::array<JointSharedPtr, 3> joints;
+  std::array<Vector3, 3> axes;
+  std::array<Point3, 3> points;
+  Point3 foot;
+
+  Leg(const Robot& robot, const LinkSharedPtr& base, const PointOnLink& goal,
+      const gtsam::Values& zero) {
+    LinkSharedPtr link = goal.link;
+    for (int i = 2; i >= 0; i--) {
+      JointSharedPtr parent_joint;
+      for (auto&& joint : link->joints()) {
+        if (joint->child() == link) parent_joint = joint;
+      }
+      if (!parent_joint || parent_joint->type() != Joint::Type::Revolute ||
+          (i > 0 && parent_joint->parent() == base)) {
+        throw std::invalid_argument(
+            "ChainInitializer: the leg of " + goal.link->name() +
+            " is not three revolute joints from the base");
+      }
+      joints[i] = parent_joint;
+      link = parent_joint->parent();
+    }
+    if (link != base) {
+      throw std::invalid_argument(
+          "ChainInitializer: the leg of " + goal.link->name() +
+          " is not three revolute joints from the base");
+    }
+    for (int i = 0; i < 3; i++) {
+      // Axis direction and point on the axis, from the screw axis of the
+      // joint in the child CoM frame.
+      const Pose3 bTc = Pose(zero, joints[i]->child()->id());
+      const gtsam::Vector6 screw = joints[i]->cScrewAxis();
+      const Vector3 w = screw.head<3>().normalized(), v = screw.tail<3>();
+      axes[i] = bTc.rotation().rotate(w);
+      points[i] = bTc.transformFrom(Point3(w.cross(v)));
+    }
+    if (axes[1].cross(axes[2]).norm() > 1e-6) {
+      throw std::invalid_argument("ChainInitializer: the last two joints of "
+                                  "the leg of " + goal.link->name() +
+                                  " are not parallel");
+    }
+    foot = Pose(zero, goal.link->id()).transformFrom(goal.point);
+  }
+
+  // Solutions of the planar two-link chain for a first angle q1, as
+  // (q1, q2, q3) triples.
+  void planar(const Point3& target, double q1,
+              std::vector<std::array<double, 3>>* solutions) const {
+    const Rot3 R1 = Rot3::AxisAngle(axes[0], q1);
+    const Point3 p2 = Rotate(R1, points[0], points[1]);
+    const Point3 p3 = Rotate(R1, points[0], points[2]);
+    const Point3 f = Rotate(R1, points[0], foot);
+    const Vector3 a2 = R1.rotate(axes[1]);
+    const double s = a2.dot(R1.rotate(axes[2])) > 0 ? 1.0 : -1.0;
+
+    // Coordinates in the plane normal to a2.
+    auto project = [&a2](const Vector3& x) -> Vector3 {
+      return x - a2.dot(x) * a2;
+    };
+    const Vector3 v1 = project(p3 - p2);
+    const double l1 = v1.norm();
+    if (l1 < 1e-9) {
+      throw std::invalid_argument(
+          "ChainInitializer: leg joints on one axis");
+    }
+    const Vector3 e1 = v1 / l1, e2 = a2.cross(e1);
+    auto coordinates = [&](const Vector3& x) {
+      const Vector3 y = project(x);
+      return gtsam::Vector2(y.dot(e1), y.dot(e2));
+    };
+    const gtsam::Vector2 V2 = coordinates(f - p3),
+                        T = coordinates(target - p2);
+    const double l2 = V2.norm();
+    const double beta = std::atan2(V2.y(), V2.x());
+    const double cos_knee = std::max(
+        -1.0, std::min(1.0, (T.squaredNorm() - l1 * l1 - l2 * l2) /
+                                (2 * l1 * std::max(l2, 1e-9))));
+    for (double sign : {1.0, -1.0}) {
+      const double phi = sign * std::acos(cos_knee) - beta;
+      const gtsam::Vector2 W(l1 + std::cos(phi) * V2.x() -
+                                 std::sin(phi) * V2.y(),
+                             std::sin(phi) * V2.x() + std::cos(phi) * V2.y());
+      const double q2 = std::atan2(T.y(), T.x()) - std::atan2(W.y(), W.x());
+      const std::array<double, 3> q = {{Wrap(q1), Wrap(q2), Wrap(s * phi)}};
+      solutions->push_back(q);
+    }
+  }
+
+  // The joint angles reaching target, in the base CoM frame, closest to the
+  // nominal angles.
+  std::array<double, 3> solve(const Point3& target,
+                              const std::array<double, 3>& nominal) const {
+    // The first angle puts the target at the offset of the foot along the
+    // parallel axes: (R1 a2) . (target - p1) = c.
+    const Vector3 &a1 = axes[0], &a2 = axes[1];
+    const Vector3 r = target - points[0];
+    const double c = a2.dot(foot - points[1]) + a2.dot(points[1] - points[0]);
+    const double A = a2.dot(r) - a1.dot(a2) * a1.dot(r);
+    const double B = a1.cross(a2).dot(r), C = a1.dot(a2) * a1.dot(r);
+    std::vector<std::array<double, 3>> solutions;
+    const double rho = std::hypot(A, B);
+    if (rho < 1e-12) {
+      planar(target, nominal[0], &solutions);
+    } else {
+      const double ratio = std::max(-1.0, std::min(1.0, (c - C) / rho));
+      const double theta = std::atan2(B, A), delta = std::acos(ratio);
+      planar(target, theta + delta, &solutions);
+      planar(target, theta - delta, &solutions);
+    }
+
+    std::array<double, 3> best = solutions.front();
+    double min_distance = std::numeric_limits<double>::infinity();
+    for (auto&& q : solutions) {
+      double distance = 0;
+      for (int i = 0; i < 3; i++) {
+        distance += std::pow(Wrap(q[i] - nominal[i]), 2);
+      }
+      if (distance < min_distance) {
+        min_distance = distance;
+        best = q;
+      }
+    }
+    return best;
+  }
+};
+
+}  // namespace
+
 gtsam::Values ChainInitializer::ZeroValues(const Robot& robot, const int t, double gaussian_noise,
                   const boost::optional<PointOnLinks>& contact_points) const {
   gtsam::Values values;
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  gtsam::Sampler sampler(sampler_noise_model);
+  gtsam::Sampler sampler(sampler_noise_model, seed_);
 
-  // Initialize link dynamics to 0.
+  // The variables of ChainDynamicsGraph: the base is the link with the most
+  // joints, and the feet are the links at the end of the legs.
+  const LinkSharedPtr base = ChainBase(robot);
+
+  // Initialize base dynamics and foot poses to 0.
   for (auto&& link : robot.links()) {
     int i = link->id();
+    if (link != base && link->numJoints() != 1) continue;
     InsertPose(&values, i, t, AddGaussianNoiseToPose(link->bMcom(), sampler));
-    InsertTwist(&values, i, t, sampler.sample());
-    InsertTwistAccel(&values, i, t, sampler.sample());
+    if (link == base) {
+      InsertTwist(&values, i, t, sampler.sample());
+      InsertTwistAccel(&values, i, t, sampler.sample());
+    }
   }
 
   // Initialize joint kinematics/dynamics to 0.
   for (auto&& joint : robot.joints()) {
     int j = joint->id();
-    if (joint->parent()->name().find("trunk") < 100) {
-      InsertWrench(&values, joint->parent()->id(), j, t, sampler.sample());
+    if (joint->parent() == base) {
+      InsertWrench(&values, base->id(), j, t, sampler.sample());
     }
     std::vector<DynamicsSymbol> keys = {TorqueKey(j, t), JointAngleKey(j, t),
                                         JointVelKey(j, t), JointAccelKey(j, t)};
@@ -53,4 +226,99 @@ gtsam::Values ChainInitializer::ZeroValues(const Robot& robot, const int t, doub
   return values;
 }
 
-} //namespace gtdynamics
\ No newline at end of file
+/* ************************************************************************* */
+gtsam::Values ChainInitializer::LegJointAngles(
+    const Robot& robot, const Pose3& wTb, const ContactGoals& goals, int t,
+    const std::map<std::string, double>& nominal) const {
+  const LinkSharedPtr base = ChainBase(robot);
+  gtsam::Values joint_angles;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&joint_angles, joint->id(), 0.0);
+  }
+  const gtsam::Values zero =
+      robot.forwardKinematics(joint_angles, 0, base->name());
+
+  gtsam::Values values;
+  for (auto&& goal : goals) {
+    const Leg leg(robot, base, goal.point_on_link, zero);
+    std::array<double, 3> q0;
+    for (int i = 0; i < 3; i++) {
+      auto it = nominal.find(leg.joints[i]->name());
+      q0[i] = it == nominal.end() ? 0.0 : it->second;
+    }
+    const std::array<double, 3> q =
+        leg.solve(wTb.transformTo(goal.goal_point), q0);
+    for (int i = 0; i < 3; i++) {
+      InsertJointAngle(&values, leg.joints[i]->id(), t, q[i]);
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+gtsam::Values ChainInitializer::LegInverseKinematicsTrajectory(
+    const Robot& robot, const std::vector<Pose3>& base_poses,
+    const std::vector<ContactGoals>& foot_goals, double dt,
+    double gaussian_noise,
+    const boost::optional<std::vector<PointOnLinks>>& contact_points,
+    const std::map<std::string, double>& nominal) const {
+  const size_t num_steps = base_poses.size();
+  if (foot_goals.size() != num_steps ||
+      (contact_points && contact_points->size() != num_steps)) {
+    throw std::invalid_argument(
+        "ChainInitializer: need base poses, foot goals and contact points "
+        "for every step");
+  }
+  const LinkSharedPtr base = ChainBase(robot);
+
+  std::vector<gtsam::Values> steps(num_steps), angles(num_steps);
+  ParallelFor(num_steps, num_threads_, [&](size_t k) {
+    const int t = k;
+    angles[k] = LegJointAngles(robot, base_poses[k], foot_goals[k], t, nominal);
+    gtsam::Values& values = steps[k];
+    values = ZeroValues(robot, t, gaussian_noise,
+                        contact_points ? boost::optional<PointOnLinks>(
+                                             (*contact_points)[k])
+                                       : boost::none);
+    for (auto&& key_value : angles[k]) {
+      values.update(key_value.key, key_value.value);
+    }
+
+    // Base and foot poses from forward kinematics.
+    gtsam::Values known;
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&known, joint->id(), t,
+                       JointAngle(values, joint->id(), t));
+    }
+    InsertPose(&known, base->id(), t, base_poses[k]);
+    const gtsam::Values fk = robot.forwardKinematics(known, t, base->name());
+    for (auto&& link : robot.links()) {
+      const gtsam::Key key = PoseKey(link->id(), t);
+      if (values.exists(key)) values.update(key, fk.at(key));
+    }
+  });
+
+  gtsam::Values values;
+  for (size_t k = 0; k < num_steps; k++) {
+    if (dt > 0 && num_steps > 1) {
+      // Central differences, one-sided at the ends.
+      const size_t prev = k > 0 ? k - 1 : 0;
+      const size_t next = k + 1 < num_steps ? k + 1 : k;
+      const size_t mid = std::min(std::max<size_t>(k, 1), num_steps - 2);
+      for (auto&& key_value : angles[k]) {
+        const int j = DynamicsSymbol(key_value.key).jointIdx();
+        auto q = [&](size_t i) { return JointAngle(angles[i], j, i); };
+        steps[k].update(JointVelKey(j, k),
+                        (q(next) - q(prev)) / ((next - prev) * dt));
+        if (num_steps > 2) {
+          steps[k].update(JointAccelKey(j, k),
+                          (q(mid + 1) - 2 * q(mid) + q(mid - 1)) / (dt * dt));
+        }
+      }
+    }
+    values.insert(steps[k]);
+  }
+  return values;
+}
+
+} //namespace gtdynamics
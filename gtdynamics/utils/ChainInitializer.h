@@ -13,13 +13,20 @@
 
 #pragma once
 
+#include <gtdynamics/kinematics/Kinematics.h>
 #include <gtdynamics/utils/Initializer.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace gtdynamics {
 
-class ChainInitializer : Initializer {
+class ChainInitializer : public Initializer {
 
   public:
+    using Initializer::Initializer;
+
       /**
      * @fn Return zero values for all variables for initial value of optimization.
      *
@@ -33,6 +40,60 @@ class ChainInitializer : Initializer {
     gtsam::Values ZeroValues(
         const Robot& robot, const int t, double gaussian_noise = 0.0,
         const boost::optional<PointOnLinks>& contact_points = boost::none) const override;
+
+    /**
+     * @fn Joint angles of the legs that put their feet at goal points, in
+     * closed form.
+     *
+     * Every goal is a point on a foot, the end of a leg of three revolute
+     * joints from the base, the link with the most joints, whose last two
+     * axes are parallel, e.g. the hip, upper and lower joints of a
+     * quadruped. The first angle turns the plane of the last two joints
+     * through the goal, and the last two solve the planar two-link chain.
+     * Of the up to four solutions, the closest to the nominal angles is
+     * used. Goals out of reach give the closest stretched or folded leg.
+     *
+     * @param[in] robot   A Robot object.
+     * @param[in] wTb     Pose of the base CoM.
+     * @param[in] goals   Goal points of the feet, in world coordinates.
+     * @param[in] t       Timestep of the joint angle keys.
+     * @param[in] nominal Joint angles by joint name that pick the solution,
+     *      zero for joints not in it.
+     * @return Joint angles of the joints of the legs with goals.
+     */
+    gtsam::Values LegJointAngles(
+        const Robot& robot, const gtsam::Pose3& wTb, const ContactGoals& goals,
+        int t = 0,
+        const std::map<std::string, double>& nominal = {}) const;
+
+    /**
+     * @fn Initial values of a legged trajectory from closed-form leg
+     * inverse kinematics, see LegJointAngles, solved for every step in
+     * parallel on the threads of the initializer.
+     *
+     * Every step starts from ZeroValues, with the base pose given, the leg
+     * joint angles that reach the foot goals of the step, e.g. from
+     * StanceTrajectory and SimpleSwingTrajectory, and the foot poses from
+     * forward kinematics. With dt, the leg joint velocities and accelerations
+     * are finite differences of the angles.
+     *
+     * @param[in] robot          A Robot object.
+     * @param[in] base_poses     Pose of the base CoM at every step.
+     * @param[in] foot_goals     Goal points of the feet at every step.
+     * @param[in] dt             Duration of a step, 0 for zero joint
+     *      velocities and accelerations.
+     * @param[in] gaussian_noise Optional gaussian noise of ZeroValues.
+     * @param[in] contact_points Contact points at every step.
+     * @param[in] nominal        Joint angles that pick the leg solutions.
+     * @return Initial solution stored in gtsam::Values object.
+     */
+    gtsam::Values LegInverseKinematicsTrajectory(
+        const Robot& robot, const std::vector<gtsam::Pose3>& base_poses,
+        const std::vector<ContactGoals>& foot_goals, double dt = 0.0,
+        double gaussian_noise = 0.0,
+        const boost::optional<std::vector<PointOnLinks>>& contact_points =
+            boost::none,
+        const std::map<std::string, double>& nominal = {}) const;
 };
 
 } // namespace gtdynamics
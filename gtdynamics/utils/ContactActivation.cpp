@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactActivation.cpp
+ * @brief Dynamics graph with contact factors switched on and off per step.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
+#include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/utils/ContactActivation.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+using gtsam::NonlinearFactor;
+using gtsam::NonlinearFactorGraph;
+
+namespace gtdynamics {
+
+namespace {
+using WrenchPrior = gtsam::PriorFactor<gtsam::Vector>;
+
+// Whether a factor of DynamicsGraph only exists for a contact point.
+bool IsContactFactor(const NonlinearFactor::shared_ptr &factor) {
+  const NonlinearFactor *f = factor.get();
+  return dynamic_cast<const ContactHeightFactor *>(f) ||
+         dynamic_cast<const ContactKinematicsTwistFactor *>(f) ||
+         dynamic_cast<const ContactKinematicsAccelFactor *>(f) ||
+         dynamic_cast<const ContactDynamicsFrictionConeFactor *>(f) ||
+         dynamic_cast<const ContactDynamicsMomentFactor *>(f);
+}
+}  // namespace
+
+/* ************************************************************************* */
+ContactActivationGraph::ContactActivationGraph(
+    const DynamicsGraph &graph_builder, const Robot &robot,
+    const PointOnLinks &candidates, size_t k_first, size_t k_last,
+    const boost::optional<double> &mu,
+    const gtsam::SharedNoiseModel &off_model)
+    : candidates_(candidates), k_first_(k_first), k_last_(k_last) {
+  if (graph_builder.opt().contact_block_factors) {
+    throw std::invalid_argument(
+        "ContactActivationGraph: contact block factors can not be gated");
+  }
+  if (k_last < k_first) {
+    throw std::invalid_argument("ContactActivationGraph: empty step range");
+  }
+
+  // Contact factors are found by the link of their first key: a pose, twist,
+  // acceleration or contact wrench of the link in contact.
+  std::map<int, size_t> candidate_of_link;
+  for (size_t c = 0; c < candidates.size(); c++) {
+    if (!candidate_of_link.emplace(candidates[c].link->id(), c).second) {
+      throw std::invalid_argument("ContactActivationGraph: link " +
+                                  candidates[c].link->name() +
+                                  " has more than one candidate");
+    }
+  }
+
+  const gtsam::SharedNoiseModel model =
+      off_model ? off_model : graph_builder.opt().f_cost_model;
+  const size_t num_steps = k_last - k_first + 1;
+  gates_.resize(num_steps * candidates.size());
+  const size_t step_size =
+      graph_builder.numFactorsEstimate(robot, candidates) + candidates.size();
+  graph_.reserve(num_steps * step_size);
+  for (size_t k = k_first; k <= k_last; k++) {
+    NonlinearFactorGraph step =
+        graph_builder.dynamicsFactorGraph(robot, k, candidates, mu);
+    for (auto &&factor : step) {
+      if (!IsContactFactor(factor)) {
+        graph_.push_back(factor);
+        continue;
+      }
+      const int link_id = DynamicsSymbol(factor->keys()[0]).linkIdx();
+      auto gated = boost::make_shared<GatedFactor>(factor);
+      gates(candidate_of_link.at(link_id), k).on.push_back(gated);
+      graph_.push_back(gated);
+    }
+    for (size_t c = 0; c < candidates.size(); c++) {
+      const auto prior = boost::make_shared<WrenchPrior>(
+          ContactWrenchKey(candidates[c].link->id(), 0, k),
+          gtsam::Vector::Zero(6), model);
+      gates(c, k).off = boost::make_shared<GatedFactor>(prior, false);
+      graph_.push_back(gates(c, k).off);
+    }
+  }
+}
+
+/* ************************************************************************* */
+ContactActivationGraph::Gates &ContactActivationGraph::gates(size_t c,
+                                                             size_t k) {
+  return const_cast<Gates &>(
+      static_cast<const ContactActivationGraph &>(*this).gates(c, k));
+}
+
+/* ************************************************************************* */
+const ContactActivationGraph::Gates &ContactActivationGraph::gates(
+    size_t c, size_t k) const {
+  if (c >= candidates_.size() || k < k_first_ || k > k_last_) {
+    throw std::out_of_range("ContactActivationGraph: no candidate " +
+                            std::to_string(c) + " at step " +
+                            std::to_string(k));
+  }
+  return gates_[(k - k_first_) * candidates_.size() + c];
+}
+
+/* ************************************************************************* */
+void ContactActivationGraph::setContact(size_t c, size_t k, bool in_contact) {
+  Gates &g = gates(c, k);
+  g.in_contact = in_contact;
+  for (auto &&factor : g.on) factor->setEnabled(in_contact);
+  g.off->setEnabled(!in_contact);
+}
+
+/* ************************************************************************* */
+void ContactActivationGraph::setPhase(const FootContactConstraintSpec &phase,
+                                      size_t k_first, size_t k_last) {
+  const std::vector<bool> mask = phase.contactMask(candidates_);
+  for (size_t k = k_first; k <= k_last; k++) {
+    for (size_t c = 0; c < candidates_.size(); c++) {
+      setContact(c, k, mask[c]);
+    }
+  }
+}
+
+}  // namespace gtdynamics
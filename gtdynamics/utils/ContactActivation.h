@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactActivation.h
+ * @brief Dynamics graph with contact factors switched on and off per step.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/GatedFactor.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ContactActivationGraph builds the dynamics factor graph of a range of time
+ * steps once, with all candidate contact points in contact, and then switches
+ * the contact factors of each candidate on or off per time step. A candidate
+ * out of contact has its contact height, twist, acceleration, friction cone
+ * and moment factors disabled, and a zero-wrench prior on its contact wrench
+ * enabled instead, which leaves the same solutions as a graph built without
+ * that contact. As the keys and factors never change, different contact
+ * schedules share one graph structure, ordering and symbolic elimination.
+ *
+ * The factors are shared with the graph returned by graph(), and with any
+ * graph it is added to, so that switching contacts affects those in place.
+ */
+class ContactActivationGraph {
+ private:
+  /// Gated factors of one candidate at one time step.
+  struct Gates {
+    std::vector<GatedFactor::shared_ptr> on;  ///< enabled in contact
+    GatedFactor::shared_ptr off;  ///< zero-wrench prior, enabled otherwise
+    bool in_contact = true;
+  };
+
+  PointOnLinks candidates_;
+  size_t k_first_, k_last_;
+  std::vector<Gates> gates_;  ///< per time step, then per candidate
+  gtsam::NonlinearFactorGraph graph_;
+
+  Gates &gates(size_t c, size_t k);
+  const Gates &gates(size_t c, size_t k) const;
+
+ public:
+  /**
+   * Constructor, starts with all candidates in contact.
+   * @param graph_builder builder of the dynamics factors, which must not use
+   * contact block factors, as those couple all contacts of a step
+   * @param robot the robot
+   * @param candidates all contact points that may be in contact, at most one
+   * per link
+   * @param k_first first time step
+   * @param k_last last time step
+   * @param mu friction coefficient, as in DynamicsGraph::dynamicsFactorGraph
+   * @param off_model noise model of the zero-wrench priors, the wrench
+   * equivalence model of graph_builder by default
+   */
+  ContactActivationGraph(
+      const DynamicsGraph &graph_builder, const Robot &robot,
+      const PointOnLinks &candidates, size_t k_first, size_t k_last,
+      const boost::optional<double> &mu = boost::none,
+      const gtsam::SharedNoiseModel &off_model = nullptr);
+
+  /// The dynamics factors of all time steps, of fixed size and structure.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// All candidate contact points.
+  const PointOnLinks &candidates() const { return candidates_; }
+
+  /// Number of candidate contact points.
+  size_t numCandidates() const { return candidates_.size(); }
+
+  /// Whether candidate c is in contact at time step k.
+  bool inContact(size_t c, size_t k) const {
+    return gates(c, k).in_contact;
+  }
+
+  /// Put candidate c in contact at time step k, or take it out of contact.
+  void setContact(size_t c, size_t k, bool in_contact);
+
+  /**
+   * Put the candidates in contact in phase in contact, and the others out of
+   * contact, for time steps k_first to k_last inclusive.
+   */
+  void setPhase(const FootContactConstraintSpec &phase, size_t k_first,
+                size_t k_last);
+};
+
+}  // namespace gtdynamics
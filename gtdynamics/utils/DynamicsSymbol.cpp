@@ -15,27 +15,77 @@
 
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
+#include <cctype>
 #include <iostream>
 
 using gtsam::Key;
 namespace gtdynamics {
 
+constexpr uint16_t DynamicsSymbol::kNoIndex;
+constexpr uint8_t DynamicsSymbol::kMaxRobot;
+constexpr uint64_t DynamicsSymbol::kMaxTime;
+constexpr size_t DynamicsSymbol::kMaxStringLength;
+
+namespace {
+thread_local uint8_t current_robot = 0;
+
+// Write the decimal digits of n at out, return the end.
+char* WriteUnsigned(uint64_t n, char* out) {
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[count++] = char('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  while (count > 0) *out++ = digits[--count];
+  return out;
+}
+}  // namespace
+
+/* ************************************************************************* */
+DynamicsSymbol::RobotScope::RobotScope(uint8_t robot)
+    : previous_(current_robot) {
+  if (robot > kMaxRobot) {
+    throw std::runtime_error("robot instance " + std::to_string(robot) +
+                             " does not fit in a dynamics symbol");
+  }
+  current_robot = robot;
+}
+
+/* ************************************************************************* */
+DynamicsSymbol::RobotScope::~RobotScope() { current_robot = previous_; }
+
+/* ************************************************************************* */
+uint8_t DynamicsSymbol::CurrentRobot() { return current_robot; }
+
+/* ************************************************************************* */
+bool DynamicsSymbol::IsDynamicsSymbol(Key key) {
+  const uint16_t code = LabelCodeOf(key);
+  const int c1 = code >> 8, c2 = code & 0xff;
+  if (c1 == 0) return std::isalpha(c2) != 0;
+  return std::isalpha(c1) && std::isalnum(c2);
+}
+
 /* ************************************************************************* */
 DynamicsSymbol::DynamicsSymbol()
-    : c1_(0), c2_(0), link_idx_(0), joint_idx_(0), t_(0) {}
+    : c1_(0), c2_(0), robot_idx_(0), link_idx_(0), joint_idx_(0), t_(0) {}
 
 /* ************************************************************************* */
 DynamicsSymbol::DynamicsSymbol(const DynamicsSymbol& key)
     : c1_(key.c1_),
       c2_(key.c2_),
+      robot_idx_(key.robot_idx_),
       link_idx_(key.link_idx_),
       joint_idx_(key.joint_idx_),
       t_(key.t_) {}
 
 /* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                               uint8_t joint_idx, uint64_t t)
-    : link_idx_(link_idx), joint_idx_(joint_idx), t_(t) {
+DynamicsSymbol::DynamicsSymbol(const std::string& s, uint16_t link_idx,
+                               uint16_t joint_idx, uint64_t t)
+    : robot_idx_(current_robot),
+      link_idx_(link_idx),
+      joint_idx_(joint_idx),
+      t_(t) {
   if (s.length() > 2) {
     throw std::runtime_error(
         "cannot use more than 2 characters in dynamics symbol");
@@ -50,47 +100,60 @@ DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
     c1_ = 0;
     c2_ = 0;
   }
+  check();
+}
+
+/* ************************************************************************* */
+DynamicsSymbol::DynamicsSymbol(uint16_t label_code, uint16_t link_idx,
+                               uint16_t joint_idx, uint64_t t)
+    : c1_(uint8_t(label_code >> 8)),
+      c2_(uint8_t(label_code & 0xff)),
+      robot_idx_(current_robot),
+      link_idx_(link_idx),
+      joint_idx_(joint_idx),
+      t_(t) {
+  check();
+}
+
+/* ************************************************************************* */
+void DynamicsSymbol::check() const {
+  if (c1_ > ch_mask || c2_ > ch_mask) {
+    throw std::runtime_error("dynamics symbol characters must be ASCII");
+  }
+  if (robot_idx_ > kMaxRobot) {
+    throw std::runtime_error("robot instance " + std::to_string(robot_idx_) +
+                             " does not fit in a dynamics symbol");
+  }
+  if (link_idx_ > kNoIndex || joint_idx_ > kNoIndex) {
+    throw std::runtime_error("link/joint index does not fit in a dynamics "
+                             "symbol");
+  }
+  if (t_ > kMaxTime) {
+    throw std::runtime_error("time step " + std::to_string(t_) +
+                             " does not fit in a dynamics symbol");
+  }
 }
 
 DynamicsSymbol DynamicsSymbol::LinkJointSymbol(const std::string& s,
-                                               uint8_t link_idx,
-                                               uint8_t joint_idx,
+                                               uint16_t link_idx,
+                                               uint16_t joint_idx,
                                                uint64_t t) {
   return DynamicsSymbol(s, link_idx, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::JointSymbol(const std::string& s,
-                                           uint8_t joint_idx,
+                                           uint16_t joint_idx,
                                            uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, joint_idx, t);
+  return DynamicsSymbol(s, kNoIndex, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::LinkSymbol(const std::string& s,
-                                          uint8_t link_idx, uint64_t t) {
-  return DynamicsSymbol(s, link_idx, kMax_uchar_, t);
+                                          uint16_t link_idx, uint64_t t) {
+  return DynamicsSymbol(s, link_idx, kNoIndex, t);
 }
 
 DynamicsSymbol DynamicsSymbol::SimpleSymbol(const std::string& s, uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, kMax_uchar_, t);
-}
-
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const Key& key) {
-  c1_ = (uint8_t)((key & ch1_mask) >> (key_bits - ch1_bits));
-  c2_ = (uint8_t)((key & ch2_mask) >> (key_bits - ch1_bits - ch2_bits));
-  link_idx_ = (uint8_t)((key & link_mask) >> (time_bits + joint_bits));
-  joint_idx_ = (uint8_t)((key & joint_mask) >> time_bits);
-  t_ = key & time_mask;
-}
-
-/* ************************************************************************* */
-DynamicsSymbol::operator Key() const {
-  Key ch1_comp = Key(c1_) << (key_bits - ch1_bits);
-  Key ch2_comp = Key(c2_) << (key_bits - ch1_bits - ch2_bits);
-  Key link_comp = Key(link_idx_) << (time_bits + joint_bits);
-  Key joint_comp = Key(joint_idx_) << time_bits;
-  Key key = ch1_comp | ch2_comp | link_comp | joint_comp | t_;
-  return key;
+  return DynamicsSymbol(s, kNoIndex, kNoIndex, t);
 }
 
 /* ************************************************************************* */
@@ -115,15 +178,33 @@ void DynamicsSymbol::print(const std::string& s) const {
 
 /* ************************************************************************* */
 DynamicsSymbol::operator std::string() const {
-  std::string s = label();
-  if (link_idx_ != kMax_uchar_) {
-    s += "[" + std::to_string((int)(link_idx_)) + "]";
+  char buffer[kMaxStringLength + 1];
+  return std::string(buffer, format(buffer));
+}
+
+/* ************************************************************************* */
+size_t DynamicsSymbol::format(char* buffer) const {
+  char* out = buffer;
+  if (c1_ != 0) *out++ = c1_;
+  if (c2_ != 0) *out++ = c2_;
+  if (robot_idx_ != 0) {
+    *out++ = '{';
+    out = WriteUnsigned(robot_idx_, out);
+    *out++ = '}';
   }
-  if (joint_idx_ != kMax_uchar_) {
-    s += "(" + std::to_string((int)(joint_idx_)) + ")";
+  if (link_idx_ != kNoIndex) {
+    *out++ = '[';
+    out = WriteUnsigned(link_idx_, out);
+    *out++ = ']';
   }
-  s += std::to_string(t_);
-  return s;
+  if (joint_idx_ != kNoIndex) {
+    *out++ = '(';
+    out = WriteUnsigned(joint_idx_, out);
+    *out++ = ')';
+  }
+  out = WriteUnsigned(t_, out);
+  *out = 0;
+  return out - buffer;
 }
 
 std::string _GTDKeyFormatter(Key key) {
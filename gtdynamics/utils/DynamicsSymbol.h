@@ -16,11 +16,64 @@
 #include <gtsam/inference/Key.h>
 #include <gtsam/inference/Symbol.h>
 
+#include <cstdint>
+#include <string>
+
 namespace gtdynamics {
 
+/**
+ * DynamicsSymbol packs a variable into a 64-bit gtsam::Key, from the most
+ * significant bit down:
+ *   - 2 x 7 bits: one or two ASCII characters for the variable type,
+ *   - 6 bits: robot instance, 0 unless several robots share one graph,
+ *   - 12 bits: link index, kNoIndex if not related to a link,
+ *   - 12 bits: joint index, kNoIndex if not related to a joint,
+ *   - 20 bits: time step, at most kMaxTime.
+ *
+ * Symbols created by the static constructors take their robot instance from
+ * the innermost RobotScope on the current thread, so single-robot graph
+ * builders can build the graph of one robot in a multi-robot problem. Tasks
+ * of the shared Executor run in the scope of the thread that submitted them.
+ */
 class DynamicsSymbol {
+ public:
+  /// Link or joint index of symbols not related to a link or joint.
+  static constexpr uint16_t kNoIndex = (1 << 12) - 1;
+
+  /**
+   * Largest robot instance and time step that fit in a key. The robot field
+   * and the 12-bit indices leave 20 bits for the time step, so a horizon is
+   * limited to 2^20 steps, about 17 minutes at 1 kHz; creating a symbol at a
+   * later step throws. Longer runs move a receding horizon back in time, see
+   * ShiftGraph.
+   */
+  static constexpr uint8_t kMaxRobot = (1 << 6) - 1;
+  static constexpr uint64_t kMaxTime = (uint64_t(1) << 20) - 1;
+
+  /// Length of the longest string of a symbol, "dt{63}[4094](4094)1048575".
+  static constexpr size_t kMaxStringLength = 25;
+
+  /**
+   * While a RobotScope is alive, symbols created on this thread belong to the
+   * given robot instance. Scopes nest.
+   */
+  class RobotScope {
+   private:
+    uint8_t previous_;
+
+   public:
+    explicit RobotScope(uint8_t robot);
+    ~RobotScope();
+    RobotScope(const RobotScope &) = delete;
+    RobotScope &operator=(const RobotScope &) = delete;
+  };
+
+  /// Robot instance of symbols created on this thread, see RobotScope.
+  static uint8_t CurrentRobot();
+
  protected:
-  uint8_t c1_, c2_, link_idx_, joint_idx_;
+  uint8_t c1_, c2_, robot_idx_;
+  uint16_t link_idx_, joint_idx_;
   uint64_t t_;
 
  private:
@@ -32,10 +85,44 @@ class DynamicsSymbol {
    * @param[in] joint_idx index of the joint
    * @param[in] t         time step
    */
-  DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                 uint8_t joint_idx, uint64_t t);
+  DynamicsSymbol(const std::string& s, uint16_t link_idx,
+                 uint16_t joint_idx, uint64_t t);
+
+  /// Constructor from a label code, see LabelCode.
+  DynamicsSymbol(uint16_t label_code, uint16_t link_idx, uint16_t joint_idx,
+                 uint64_t t);
 
  public:
+  /**
+   * Label code of a string literal of at most 2 characters, as returned by
+   * labelCode(). It is a constant expression, so symbols created from
+   * literals do not build or parse a std::string.
+   */
+  template <size_t N>
+  static constexpr uint16_t LabelCode(const char (&s)[N]) {
+    static_assert(N <= 3, "cannot use more than 2 characters in dynamics "
+                          "symbol");
+    return N < 2   ? 0
+           : N < 3 ? uint8_t(s[0])
+                   : (uint16_t(uint8_t(s[0])) << 8) | uint8_t(s[1]);
+  }
+
+  /// Label code of a key, without decoding the other fields.
+  static constexpr uint16_t LabelCodeOf(gtsam::Key key) {
+    return uint16_t((((key >> ch1_shift) & ch_mask) << 8) |
+                    ((key >> ch2_shift) & ch_mask));
+  }
+
+  /// Time step of a key, without decoding the other fields.
+  static constexpr uint64_t TimeOf(gtsam::Key key) { return key & time_mask; }
+
+  /**
+   * Whether a key has the label of a DynamicsSymbol: a letter, optionally
+   * followed by a letter or digit. Integer keys and gtsam::Symbol keys, whose
+   * character straddles the two label fields, do not.
+   */
+  static bool IsDynamicsSymbol(gtsam::Key key);
+
   /** Default constructor */
   DynamicsSymbol();
 
@@ -47,8 +134,15 @@ class DynamicsSymbol {
    *  See private constructor
    */
   static DynamicsSymbol LinkJointSymbol(const std::string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx, uint64_t t);
+                                        uint16_t link_idx,
+                                        uint16_t joint_idx, uint64_t t);
+
+  /// LinkJointSymbol with a literal label, encoded at compile time.
+  template <size_t N>
+  static DynamicsSymbol LinkJointSymbol(const char (&s)[N], uint16_t link_idx,
+                                        uint16_t joint_idx, uint64_t t) {
+    return DynamicsSymbol(LabelCode(s), link_idx, joint_idx, t);
+  }
 
   /**
    * Constructor for symbol related to only joint (e.g. joint angle).
@@ -58,7 +152,14 @@ class DynamicsSymbol {
    * @param[in] t         time step
    */
   static DynamicsSymbol JointSymbol(const std::string& s,
-                                    uint8_t joint_idx, uint64_t t);
+                                    uint16_t joint_idx, uint64_t t);
+
+  /// JointSymbol with a literal label, encoded at compile time.
+  template <size_t N>
+  static DynamicsSymbol JointSymbol(const char (&s)[N], uint16_t joint_idx,
+                                    uint64_t t) {
+    return DynamicsSymbol(LabelCode(s), kNoIndex, joint_idx, t);
+  }
 
   /**
    * Constructor for symbol related to only link (e.g. link pose).
@@ -67,9 +168,16 @@ class DynamicsSymbol {
    * @param[in] joint_idx index of the joint
    * @param[in] t         time step
    */
-  static DynamicsSymbol LinkSymbol(const std::string& s, uint8_t link_idx,
+  static DynamicsSymbol LinkSymbol(const std::string& s, uint16_t link_idx,
                                    uint64_t t);
 
+  /// LinkSymbol with a literal label, encoded at compile time.
+  template <size_t N>
+  static DynamicsSymbol LinkSymbol(const char (&s)[N], uint16_t link_idx,
+                                   uint64_t t) {
+    return DynamicsSymbol(LabelCode(s), link_idx, kNoIndex, t);
+  }
+
   /**
    * Constructor for symbol related to neither joint or link (e.g. time).
    *
@@ -78,26 +186,65 @@ class DynamicsSymbol {
    */
   static DynamicsSymbol SimpleSymbol(const std::string& s, uint64_t t);
 
+  /// SimpleSymbol with a literal label, encoded at compile time.
+  template <size_t N>
+  static DynamicsSymbol SimpleSymbol(const char (&s)[N], uint64_t t) {
+    return DynamicsSymbol(LabelCode(s), kNoIndex, kNoIndex, t);
+  }
+
   /**
    * Constructor that decodes an integer gtsam::Key
    */
-  DynamicsSymbol(const gtsam::Key& key);
+  DynamicsSymbol(const gtsam::Key& key)
+      : c1_(uint8_t((key >> ch1_shift) & ch_mask)),
+        c2_(uint8_t((key >> ch2_shift) & ch_mask)),
+        robot_idx_(uint8_t((key >> robot_shift) & robot_mask)),
+        link_idx_(uint16_t((key >> link_shift) & index_mask)),
+        joint_idx_(uint16_t((key >> joint_shift) & index_mask)),
+        t_(key & time_mask) {}
 
   /// Cast to a GTSAM Key.
-  operator gtsam::Key() const;
+  operator gtsam::Key() const {
+    return (gtsam::Key(c1_) << ch1_shift) | (gtsam::Key(c2_) << ch2_shift) |
+           (gtsam::Key(robot_idx_) << robot_shift) |
+           (gtsam::Key(link_idx_) << link_shift) |
+           (gtsam::Key(joint_idx_) << joint_shift) | t_;
+  }
 
   /// Return string label.
   std::string label() const;
 
+  /// Return the label characters packed as (c1 << 8) | c2, for comparisons.
+  inline uint16_t labelCode() const { return (uint16_t(c1_) << 8) | c2_; }
+
+  /// Return robot instance.
+  inline uint8_t robotIdx() const { return robot_idx_; }
+
   /// Return link id.
-  inline uint8_t linkIdx() const { return link_idx_; }
+  inline uint16_t linkIdx() const { return link_idx_; }
 
   /// Return joint id.
-  inline uint8_t jointIdx() const { return joint_idx_; }
+  inline uint16_t jointIdx() const { return joint_idx_; }
 
   /// Retrieve key index.
   inline uint64_t time() const { return t_; }
 
+  /// Return the same symbol at another time step.
+  DynamicsSymbol atTime(uint64_t t) const {
+    DynamicsSymbol symbol(*this);
+    symbol.t_ = t;
+    symbol.check();
+    return symbol;
+  }
+
+  /// Return the same symbol for another robot instance.
+  DynamicsSymbol ofRobot(uint8_t robot) const {
+    DynamicsSymbol symbol(*this);
+    symbol.robot_idx_ = robot;
+    symbol.check();
+    return symbol;
+  }
+
   /// Print.
   void print(const std::string& s = "") const;
 
@@ -112,6 +259,13 @@ class DynamicsSymbol {
   /// Create a string from the key
   operator std::string() const;
 
+  /**
+   * Write the string of the symbol into a buffer of at least
+   * kMaxStringLength + 1 characters, null terminated, without allocating.
+   * @return the length of the string
+   */
+  size_t format(char* buffer) const;
+
  private:
   /// Serialization function
   friend class boost::serialization::access;
@@ -119,35 +273,39 @@ class DynamicsSymbol {
   void serialize(ARCHIVE& ar, const unsigned int /*version*/) {
     ar& BOOST_SERIALIZATION_NVP(c1_);
     ar& BOOST_SERIALIZATION_NVP(c2_);
+    ar& BOOST_SERIALIZATION_NVP(robot_idx_);
     ar& BOOST_SERIALIZATION_NVP(link_idx_);
     ar& BOOST_SERIALIZATION_NVP(joint_idx_);
     ar& BOOST_SERIALIZATION_NVP(t_);
   }
 
+  /// Throw if a field does not fit in its bits.
+  void check() const;
+
   /**
    * \defgroup Bitfield bit field constants
    * @{
    */
-  static constexpr size_t kMax_uchar_ =
-      std::numeric_limits<uint8_t>::max();
   // bit counts
   static constexpr size_t key_bits = sizeof(gtsam::Key) * 8;
-  static constexpr size_t ch1_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t ch2_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t link_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t joint_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t time_bits =
-      key_bits - ch1_bits - ch2_bits - link_bits - joint_bits;
-  // masks
-  static constexpr gtsam::Key ch1_mask = gtsam::Key(kMax_uchar_)
-                                         << (key_bits - ch1_bits);
-  static constexpr gtsam::Key ch2_mask = gtsam::Key(kMax_uchar_)
-                                         << (key_bits - ch1_bits - ch2_bits);
-  static constexpr gtsam::Key link_mask = gtsam::Key(kMax_uchar_)
-                                          << (time_bits + joint_bits);
-  static constexpr gtsam::Key joint_mask = gtsam::Key(kMax_uchar_) << time_bits;
-  static constexpr gtsam::Key time_mask =
-      ~(ch1_mask | ch2_mask | link_mask | joint_mask);
+  static constexpr size_t ch1_bits = 7;
+  static constexpr size_t ch2_bits = 7;
+  static constexpr size_t robot_bits = 6;
+  static constexpr size_t link_bits = 12;
+  static constexpr size_t joint_bits = 12;
+  static constexpr size_t time_bits = key_bits - ch1_bits - ch2_bits -
+                                      robot_bits - link_bits - joint_bits;
+  // shifts
+  static constexpr size_t ch1_shift = key_bits - ch1_bits;
+  static constexpr size_t ch2_shift = ch1_shift - ch2_bits;
+  static constexpr size_t robot_shift = ch2_shift - robot_bits;
+  static constexpr size_t link_shift = robot_shift - link_bits;
+  static constexpr size_t joint_shift = link_shift - joint_bits;
+  // masks, before shifting
+  static constexpr gtsam::Key ch_mask = (1 << ch1_bits) - 1;
+  static constexpr gtsam::Key robot_mask = kMaxRobot;
+  static constexpr gtsam::Key index_mask = kNoIndex;
+  static constexpr gtsam::Key time_mask = kMaxTime;
   /**@}*/
 };
 
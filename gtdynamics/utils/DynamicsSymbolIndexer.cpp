@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsSymbolIndexer.cpp
+ * @brief Dense slots for DynamicsSymbol keys, and Values with O(1) access.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/DynamicsSymbolIndexer.h>
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Values;
+
+/* ************************************************************************* */
+DynamicsSymbolIndexer::DynamicsSymbolIndexer(const gtsam::KeyVector &keys) {
+  // Ranges of link, joint and time indices per group, as [min, max].
+  struct Range {
+    uint16_t link_min, link_max, joint_min, joint_max;
+    uint64_t t_min, t_max;
+  };
+  std::vector<Range> ranges;
+  for (Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    const uint32_t group = Group(symbol);
+    auto it =
+        std::find_if(blocks_.begin(), blocks_.end(),
+                     [group](const Block &b) { return b.group == group; });
+    if (it == blocks_.end()) {
+      Block b;
+      b.group = group;
+      blocks_.push_back(b);
+      ranges.push_back({symbol.linkIdx(), symbol.linkIdx(), symbol.jointIdx(),
+                        symbol.jointIdx(), symbol.time(), symbol.time()});
+      continue;
+    }
+    Range &r = ranges[it - blocks_.begin()];
+    r.link_min = std::min(r.link_min, symbol.linkIdx());
+    r.link_max = std::max(r.link_max, symbol.linkIdx());
+    r.joint_min = std::min(r.joint_min, symbol.jointIdx());
+    r.joint_max = std::max(r.joint_max, symbol.jointIdx());
+    r.t_min = std::min(r.t_min, symbol.time());
+    r.t_max = std::max(r.t_max, symbol.time());
+  }
+
+  size_t offset = 0;
+  for (size_t k = 0; k < blocks_.size(); k++) {
+    Block &b = blocks_[k];
+    const Range &r = ranges[k];
+    b.link0 = r.link_min;
+    b.joint0 = r.joint_min;
+    b.t0 = r.t_min;
+    b.num_links = r.link_max - r.link_min + 1;
+    b.num_joints = r.joint_max - r.joint_min + 1;
+    b.num_steps = r.t_max - r.t_min + 1;
+    b.offset = offset;
+    offset += b.num_links * b.num_joints * b.num_steps;
+  }
+
+  keys_.assign(offset, 0);
+  used_.assign(offset, false);
+  for (Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    const Block &b = *block(Group(symbol));
+    const size_t s = b.offset +
+                     ((symbol.time() - b.t0) * b.num_links +
+                      (symbol.linkIdx() - b.link0)) *
+                         b.num_joints +
+                     (symbol.jointIdx() - b.joint0);
+    keys_[s] = key;
+    used_[s] = true;
+  }
+}
+
+/* ************************************************************************* */
+IndexedValues::IndexedValues(const Values &values)
+    : values_(values), indexer_(values) {
+  rebuild();
+}
+
+IndexedValues::IndexedValues(const IndexedValues &other)
+    : values_(other.values_), indexer_(other.indexer_) {
+  rebuild();
+}
+
+IndexedValues &IndexedValues::operator=(const IndexedValues &other) {
+  values_ = other.values_;
+  indexer_ = other.indexer_;
+  rebuild();
+  return *this;
+}
+
+void IndexedValues::rebuild() {
+  slots_.assign(indexer_.size(), nullptr);
+  for (auto &&key_value : values_)
+    slots_[indexer_.slot(key_value.key)] = &key_value.value;
+}
+
+}  // namespace gtdynamics
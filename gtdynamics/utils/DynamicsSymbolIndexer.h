@@ -0,0 +1,211 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsSymbolIndexer.h
+ * @brief Dense slots for DynamicsSymbol keys, and Values with O(1) access.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <typeinfo>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * DynamicsSymbolIndexer maps the keys of a fixed set of DynamicsSymbols to
+ * contiguous slots in constant time.
+ *
+ * Keys are grouped by label and robot instance; each group gets a dense block
+ * spanning the ranges of link indices, joint indices and time steps that
+ * occur with it, laid out time-major. Lookup is a search over the few groups
+ * followed by arithmetic, so slots can be unused when a group does not fill
+ * its ranges, e.g. wrenches only exist for (link, joint) pairs that are
+ * connected.
+ */
+class DynamicsSymbolIndexer {
+ private:
+  struct Block {
+    uint32_t group;
+    uint16_t link0, joint0;
+    uint64_t t0;
+    size_t num_links, num_joints, num_steps, offset;
+  };
+  std::vector<Block> blocks_;
+  gtsam::KeyVector keys_;  // key of each slot, 0 if unused
+  std::vector<bool> used_;
+
+  /// Label and robot instance of a symbol, as one number.
+  static uint32_t Group(const DynamicsSymbol &symbol) {
+    return (uint32_t(symbol.robotIdx()) << 16) | symbol.labelCode();
+  }
+
+  const Block *block(uint32_t group) const {
+    for (const Block &b : blocks_)
+      if (b.group == group) return &b;
+    return nullptr;
+  }
+
+ public:
+  /// Slot value returned by slot() for keys that are not indexed.
+  static constexpr size_t kNotFound = size_t(-1);
+
+  DynamicsSymbolIndexer() {}
+
+  /// Index the given keys.
+  explicit DynamicsSymbolIndexer(const gtsam::KeyVector &keys);
+
+  /// Index the keys of the given values.
+  explicit DynamicsSymbolIndexer(const gtsam::Values &values)
+      : DynamicsSymbolIndexer(values.keys()) {}
+
+  /// Number of slots, including unused ones.
+  size_t size() const { return keys_.size(); }
+
+  /// Slot of a key, or kNotFound.
+  size_t slot(gtsam::Key key) const {
+    const DynamicsSymbol symbol(key);
+    const Block *b = block(Group(symbol));
+    if (!b) return kNotFound;
+    // Indices below the start of a range wrap around and fail the checks.
+    const size_t l = size_t(symbol.linkIdx()) - b->link0,
+                 j = size_t(symbol.jointIdx()) - b->joint0,
+                 t = size_t(symbol.time() - b->t0);
+    if (l >= b->num_links || j >= b->num_joints || t >= b->num_steps)
+      return kNotFound;
+    const size_t s = b->offset + (t * b->num_links + l) * b->num_joints + j;
+    return used_[s] ? s : kNotFound;
+  }
+
+  /// Whether a key is indexed.
+  bool exists(gtsam::Key key) const { return slot(key) != kNotFound; }
+
+  /// Key in a slot, only meaningful if used(slot).
+  gtsam::Key key(size_t slot) const { return keys_.at(slot); }
+
+  /// Whether a slot holds a key.
+  bool used(size_t slot) const { return used_.at(slot); }
+};
+
+/**
+ * IndexedValues holds a copy of Values with a fixed set of keys, together
+ * with a DynamicsSymbolIndexer over them, so that values can be read and
+ * overwritten in constant time. Keys cannot be added or removed.
+ */
+class IndexedValues {
+ private:
+  gtsam::Values values_;
+  DynamicsSymbolIndexer indexer_;
+  std::vector<gtsam::Value *> slots_;
+
+  void rebuild();
+
+  gtsam::Value *value(gtsam::Key key, const char *operation) const {
+    const size_t s = indexer_.slot(key);
+    if (s == DynamicsSymbolIndexer::kNotFound)
+      throw KeyDoesNotExist(operation, key);
+    return slots_[s];
+  }
+
+ public:
+  /// Constructor, copies the values.
+  explicit IndexedValues(const gtsam::Values &values);
+
+  IndexedValues(const IndexedValues &other);
+  IndexedValues &operator=(const IndexedValues &other);
+
+  /// The values.
+  const gtsam::Values &values() const { return values_; }
+
+  /// The indexer.
+  const DynamicsSymbolIndexer &indexer() const { return indexer_; }
+
+  /// Whether a key exists.
+  bool exists(gtsam::Key key) const { return indexer_.exists(key); }
+
+  /// Retrieve a value, throws KeyDoesNotExist or ValuesIncorrectType.
+  template <typename T>
+  const T &at(gtsam::Key key) const {
+    const gtsam::Value *v = value(key, "at");
+    auto *generic = dynamic_cast<const gtsam::GenericValue<T> *>(v);
+    if (!generic)
+      throw gtsam::ValuesIncorrectType(key, typeid(*v), typeid(T));
+    return generic->value();
+  }
+
+  /// Mutable reference to a value, throws as the const version.
+  template <typename T>
+  T &at(gtsam::Key key) {
+    gtsam::Value *v = value(key, "at");
+    auto *generic = dynamic_cast<gtsam::GenericValue<T> *>(v);
+    if (!generic)
+      throw gtsam::ValuesIncorrectType(key, typeid(*v), typeid(T));
+    return generic->value();
+  }
+
+  /// Overwrite a value.
+  template <typename T>
+  void update(gtsam::Key key, const T &value) {
+    at<T>(key) = value;
+  }
+};
+
+/* *************************************************************************
+  Accessors mirroring values.h.
+ ************************************************************************* */
+
+/// Retrieve j-th joint angle at time t.
+inline double JointAngle(const IndexedValues &values, int j, int t = 0) {
+  return values.at<double>(JointAngleKey(j, t));
+}
+
+/// Retrieve j-th joint velocity at time t.
+inline double JointVel(const IndexedValues &values, int j, int t = 0) {
+  return values.at<double>(JointVelKey(j, t));
+}
+
+/// Retrieve j-th joint acceleration at time t.
+inline double JointAccel(const IndexedValues &values, int j, int t = 0) {
+  return values.at<double>(JointAccelKey(j, t));
+}
+
+/// Retrieve torque on the j-th joint at time t.
+inline double Torque(const IndexedValues &values, int j, int t = 0) {
+  return values.at<double>(TorqueKey(j, t));
+}
+
+/// Retrieve i-th link pose at time t.
+inline gtsam::Pose3 Pose(const IndexedValues &values, int i, int t = 0) {
+  return values.at<gtsam::Pose3>(PoseKey(i, t));
+}
+
+/// Retrieve i-th link twist at time t.
+inline gtsam::Vector6 Twist(const IndexedValues &values, int i, int t = 0) {
+  return values.at<gtsam::Vector6>(TwistKey(i, t));
+}
+
+/// Retrieve i-th link twist acceleration at time t.
+inline gtsam::Vector6 TwistAccel(const IndexedValues &values, int i,
+                                 int t = 0) {
+  return values.at<gtsam::Vector6>(TwistAccelKey(i, t));
+}
+
+/// Retrieve wrench on the i-th link from the j-th joint at time t.
+inline gtsam::Vector6 Wrench(const IndexedValues &values, int i, int j,
+                             int t = 0) {
+  return values.at<gtsam::Vector6>(WrenchKey(i, j, t));
+}
+
+}  // namespace gtdynamics
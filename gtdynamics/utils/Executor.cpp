@@ -0,0 +1,379 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Executor.cpp
+ * @brief Library-wide work-stealing executor behind all parallel loops.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtsam/config.h>
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <future>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/global_control.h>
+#endif
+
+namespace gtdynamics {
+
+namespace {
+
+// The executor and worker index of the current thread, if it is a worker.
+thread_local const Executor *current_executor = nullptr;
+thread_local size_t current_worker = 0;
+
+// Run a task in the robot scope of the thread submitting it, so that keys
+// created by graph builders on workers belong to the right robot instance.
+std::function<void()> InSubmitterScope(std::function<void()> task) {
+  const uint8_t robot = DynamicsSymbol::CurrentRobot();
+  return [robot, task]() {
+    DynamicsSymbol::RobotScope scope(robot);
+    task();
+  };
+}
+
+std::mutex shared_mutex;
+std::shared_ptr<Executor> shared_executor;
+#ifdef GTSAM_USE_TBB
+std::unique_ptr<tbb::global_control> tbb_control;
+#endif
+
+size_t HardwareThreads() {
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+/// State of one parallel loop, shared with the helper tasks.
+struct Loop {
+  explicit Loop(size_t n, const std::function<void(size_t)> *f)
+      : n(n), f(f), next(0), active(0) {}
+
+  const size_t n;
+  const std::function<void(size_t)> *f;  // only used while indices remain
+  std::atomic<size_t> next, active;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+
+  void run() {
+    try {
+      for (size_t i = next++; i < n; i = next++) (*f)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) error = std::current_exception();
+      next = n;
+    }
+  }
+};
+
+// Pin the calling thread to the given CPUs, where supported.
+void PinThread(const std::vector<int> &cpus) {
+#ifdef __linux__
+  if (cpus.empty()) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  // Failure, e.g. for CPUs outside the cgroup, leaves the thread unpinned.
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)cpus;
+#endif
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+std::vector<int> CpuTopology::ParseCpuList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.find_first_of("0123456789") == std::string::npos) continue;
+    const size_t dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+/* ************************************************************************* */
+CpuTopology CpuTopology::Detect() {
+  CpuTopology topology;
+#ifdef __linux__
+  for (size_t node = 0;; node++) {
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!file || !std::getline(file, list)) break;
+    std::vector<int> cpus = ParseCpuList(list);
+    if (!cpus.empty()) topology.nodes.push_back(cpus);
+  }
+#endif
+  if (topology.nodes.empty()) {
+    topology.nodes.emplace_back();
+    for (size_t cpu = 0; cpu < HardwareThreads(); cpu++)
+      topology.nodes.back().push_back(cpu);
+  }
+  return topology;
+}
+
+/* ************************************************************************* */
+NumaAffinity::NumaAffinity(const CpuTopology &topology, bool pin_cores)
+    : topology_(topology), pin_cores_(pin_cores) {
+  if (topology_.nodes.empty()) {
+    throw std::invalid_argument("NumaAffinity: need at least one node");
+  }
+}
+
+/* ************************************************************************* */
+size_t NumaAffinity::node(size_t worker, size_t num_workers) const {
+  return worker * numNodes() / std::max<size_t>(num_workers, 1);
+}
+
+/* ************************************************************************* */
+std::vector<int> NumaAffinity::cpus(size_t worker, size_t num_workers) const {
+  const size_t n = node(worker, num_workers);
+  const std::vector<int> &node_cpus = topology_.nodes[n];
+  if (!pin_cores_ || node_cpus.empty()) return node_cpus;
+  // Index of the worker among those of its node.
+  size_t first = 0;
+  while (node(first, num_workers) != n) first++;
+  return {node_cpus[(worker - first) % node_cpus.size()]};
+}
+
+/* ************************************************************************* */
+Executor::Executor(size_t num_workers,
+                   std::shared_ptr<const AffinityPolicy> policy)
+    : policy_(policy ? policy : std::make_shared<AffinityPolicy>()),
+      next_queue_(0) {
+  const size_t num_nodes = std::max<size_t>(policy_->numNodes(), 1);
+  node_workers_.resize(num_nodes);
+  node_pending_.assign(num_nodes, 0);
+  for (size_t n = 0; n < num_nodes; n++) node_queues_.emplace_back(new Queue());
+  for (size_t w = 0; w < num_workers; w++) {
+    const size_t n = policy_->node(w, num_workers);
+    if (n >= num_nodes) {
+      throw std::invalid_argument("Executor: policy gave an invalid node");
+    }
+    queues_.emplace_back(new Queue());
+    worker_node_.push_back(n);
+    node_workers_[n].push_back(w);
+  }
+  for (size_t w = 0; w < num_workers; w++) {
+    std::vector<size_t> order;
+    for (size_t k = 1; k < num_workers; k++) {
+      const size_t v = (w + k) % num_workers;
+      if (worker_node_[v] == worker_node_[w]) order.push_back(v);
+    }
+    for (size_t k = 1; k < num_workers; k++) {
+      const size_t v = (w + k) % num_workers;
+      if (worker_node_[v] != worker_node_[w]) order.push_back(v);
+    }
+    steal_order_.push_back(order);
+  }
+  for (size_t w = 0; w < num_workers; w++)
+    threads_.emplace_back(&Executor::work, this, w);
+}
+
+/* ************************************************************************* */
+Executor::~Executor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (auto &&thread : threads_) thread.join();
+}
+
+/* ************************************************************************* */
+void Executor::submit(std::function<void()> task) {
+  if (queues_.empty()) {
+    task();
+    return;
+  }
+  const size_t w = current_executor == this
+                       ? current_worker
+                       : next_queue_++ % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[w]->mutex);
+    queues_[w]->tasks.push_back(InSubmitterScope(std::move(task)));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_++;
+  }
+  ready_.notify_one();
+}
+
+/* ************************************************************************* */
+void Executor::submit(std::function<void()> task, size_t node) {
+  if (node >= numNodes() || node_workers_[node].empty()) {
+    submit(std::move(task));
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(node_queues_[node]->mutex);
+    node_queues_[node]->tasks.push_back(InSubmitterScope(std::move(task)));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    node_pending_[node]++;
+  }
+  // Only workers of the node may claim it.
+  ready_.notify_all();
+}
+
+/* ************************************************************************* */
+void Executor::run(size_t node, const std::function<void()> &f) {
+  if (current_executor == this || node >= numNodes() ||
+      node_workers_[node].empty()) {
+    f();
+    return;
+  }
+  auto task = std::make_shared<std::packaged_task<void()>>(f);
+  std::future<void> done = task->get_future();
+  submit([task]() { (*task)(); }, node);
+  done.get();
+}
+
+/* ************************************************************************* */
+bool Executor::take(size_t worker, std::function<void()> *task) {
+  {
+    Queue &own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (size_t victim : steal_order_[worker]) {
+    Queue &other = *queues_[victim];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      *task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+/* ************************************************************************* */
+void Executor::work(size_t worker) {
+  current_executor = this;
+  current_worker = worker;
+  PinThread(policy_->cpus(worker, queues_.size()));
+  const size_t node = worker_node_[worker];
+  while (true) {
+    bool for_node = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this, node] {
+        return stopping_ || pending_ > 0 || node_pending_[node] > 0;
+      });
+      if (node_pending_[node] > 0) {
+        node_pending_[node]--;
+        for_node = true;
+      } else if (pending_ > 0) {
+        pending_--;  // claim one of the queued tasks
+      } else {
+        return;
+      }
+    }
+    std::function<void()> task;
+    if (for_node) {
+      // Only claimed tasks are taken from the node queue, so it is there.
+      Queue &queue = *node_queues_[node];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    } else {
+      // The claimed task is queued, but a scan over the queues can miss it
+      // while other workers take theirs, so retry until one is found.
+      while (!take(worker, &task)) std::this_thread::yield();
+    }
+    task();
+  }
+}
+
+/* ************************************************************************* */
+void Executor::parallelFor(size_t n, size_t num_helpers,
+                           const std::function<void(size_t)> &f) {
+  // Helpers that start after the loop ran out of indices never call f, so
+  // the loop may return while they are still queued.
+  auto loop = std::make_shared<Loop>(n, &f);
+  for (size_t h = 0; h < num_helpers; h++) {
+    submit([loop]() {
+      loop->active++;
+      loop->run();
+      if (--loop->active == 0) {
+        std::lock_guard<std::mutex> lock(loop->mutex);
+        loop->done.notify_all();
+      }
+    });
+  }
+  loop->run();
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->done.wait(lock, [&loop] { return loop->active == 0; });
+  if (loop->error) std::rethrow_exception(loop->error);
+}
+
+/* ************************************************************************* */
+std::shared_ptr<Executor> Executor::Shared() {
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  if (!shared_executor) {
+    shared_executor = std::make_shared<Executor>(HardwareThreads() - 1);
+  }
+  return shared_executor;
+}
+
+/* ************************************************************************* */
+void SetExecutorThreads(size_t num_threads,
+                        std::shared_ptr<const AffinityPolicy> policy) {
+  if (num_threads == 0) num_threads = HardwareThreads();
+  std::shared_ptr<Executor> previous =
+      std::make_shared<Executor>(num_threads - 1, policy);
+  {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    shared_executor.swap(previous);
+#ifdef GTSAM_USE_TBB
+    tbb_control.reset(new tbb::global_control(
+        tbb::global_control::max_allowed_parallelism, num_threads));
+#endif
+  }
+  // The previous executor joins its threads once its loops are done.
+}
+
+/* ************************************************************************* */
+size_t ExecutorThreads() { return Executor::Shared()->numWorkers() + 1; }
+
+/* ************************************************************************* */
+size_t ExecutorNodes() { return Executor::Shared()->numNodes(); }
+
+/* ************************************************************************* */
+void RunOnNode(size_t node, const std::function<void()> &f) {
+  Executor::Shared()->run(node, f);
+}
+
+}  // namespace gtdynamics
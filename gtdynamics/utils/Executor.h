@@ -0,0 +1,205 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Executor.h
+ * @brief Library-wide work-stealing executor behind all parallel loops.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/// CPUs of every NUMA node of the machine.
+struct CpuTopology {
+  std::vector<std::vector<int>> nodes;
+
+  /**
+   * Read the NUMA nodes from /sys/devices/system/node on Linux. Elsewhere, or
+   * if that fails, all CPUs are on one node.
+   */
+  static CpuTopology Detect();
+
+  /// Parse a Linux CPU list, e.g. "0-3,8-11".
+  static std::vector<int> ParseCpuList(const std::string &list);
+};
+
+/**
+ * AffinityPolicy places the workers of an Executor on NUMA nodes and CPUs.
+ * The default places all workers on one node and does not pin them.
+ */
+class AffinityPolicy {
+ public:
+  virtual ~AffinityPolicy() {}
+
+  /// Number of nodes workers are placed on.
+  virtual size_t numNodes() const { return 1; }
+
+  /// Node of a worker, in [0, numNodes()).
+  virtual size_t node(size_t worker, size_t num_workers) const { return 0; }
+
+  /// CPUs a worker is pinned to, none to leave it to the scheduler.
+  virtual std::vector<int> cpus(size_t worker, size_t num_workers) const {
+    return {};
+  }
+};
+
+/**
+ * NumaAffinity splits the workers evenly over the NUMA nodes, in contiguous
+ * ranges, and pins every worker to the CPUs of its node, or with pin_cores
+ * to one CPU of its node. Memory is allocated on the node of the thread that
+ * first touches it, so a solve that runs on one node, see RunOnNode, builds
+ * and solves its graph in local memory.
+ */
+class NumaAffinity : public AffinityPolicy {
+ private:
+  CpuTopology topology_;
+  bool pin_cores_;
+
+ public:
+  /**
+   * Constructor.
+   * @param topology  the nodes, by default those of this machine
+   * @param pin_cores whether to pin every worker to a single CPU
+   */
+  explicit NumaAffinity(const CpuTopology &topology = CpuTopology::Detect(),
+                        bool pin_cores = false);
+
+  size_t numNodes() const override { return topology_.nodes.size(); }
+  size_t node(size_t worker, size_t num_workers) const override;
+  std::vector<int> cpus(size_t worker, size_t num_workers) const override;
+};
+
+/**
+ * Executor runs tasks on a fixed set of worker threads, each with its own
+ * queue. A worker runs the tasks it submitted itself last-in first-out, and
+ * steals the oldest tasks of other workers when its queue is empty, so
+ * nested parallel loops stay on the threads that started them.
+ *
+ * All parallel loops of the library, see ParallelFor, run on one shared
+ * executor, so nested loops and concurrent solves never use more threads
+ * than it has. Embedding applications size it once with SetExecutorThreads.
+ *
+ * An AffinityPolicy places the workers on NUMA nodes. Stealing prefers
+ * workers of the same node, and tasks submitted to a node only run there,
+ * together with the loops they start.
+ */
+class Executor {
+ public:
+  /**
+   * Start the worker threads.
+   * @param num_workers number of worker threads; with none, tasks run in the
+   * thread that submits them
+   * @param policy      placement of the workers, by default on one node
+   */
+  explicit Executor(size_t num_workers,
+                    std::shared_ptr<const AffinityPolicy> policy = nullptr);
+
+  /// Run the tasks still queued, then join the threads.
+  ~Executor();
+
+  Executor(const Executor &) = delete;
+  Executor &operator=(const Executor &) = delete;
+
+  /// Number of worker threads.
+  size_t numWorkers() const { return threads_.size(); }
+
+  /// Number of NUMA nodes the workers are placed on.
+  size_t numNodes() const { return node_queues_.size(); }
+
+  /// Queue a task; it must not throw.
+  void submit(std::function<void()> task);
+
+  /// Queue a task that only runs on a worker of the given node.
+  void submit(std::function<void()> task, size_t node);
+
+  /**
+   * Call f on a worker of the given node and wait for it, rethrowing its
+   * exception. On a worker of this executor, or without workers on the
+   * node, f runs in the calling thread.
+   */
+  void run(size_t node, const std::function<void()> &f);
+
+  /**
+   * Call f(i) for every i in [0, n), on the calling thread and up to
+   * num_helpers workers. Returns when all calls are done, rethrowing the
+   * first exception thrown by f.
+   */
+  void parallelFor(size_t n, size_t num_helpers,
+                   const std::function<void(size_t)> &f);
+
+  /// The shared executor, created on first use.
+  static std::shared_ptr<Executor> Shared();
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::shared_ptr<const AffinityPolicy> policy_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<size_t> worker_node_;
+  std::vector<std::vector<size_t>> steal_order_;  // same node first
+  std::vector<std::vector<size_t>> node_workers_;
+  std::vector<std::unique_ptr<Queue>> node_queues_;  // tasks for a node
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  size_t pending_ = 0;  // submitted tasks not yet claimed by a worker
+  std::vector<size_t> node_pending_;  // same, of the tasks for a node
+  bool stopping_ = false;
+  std::atomic<size_t> next_queue_;
+
+  /// Take a task from the own queue, or steal one from another.
+  bool take(size_t worker, std::function<void()> *task);
+
+  void work(size_t worker);
+};
+
+/**
+ * Set the number of threads the parallel loops of the library share,
+ * including the calling thread, 0 for std::thread::hardware_concurrency.
+ * Loops already running finish on the previous executor. When GTSAM uses
+ * TBB, this also limits the parallelism of TBB.
+ * @param num_threads number of threads
+ * @param policy      placement of the workers, e.g. NumaAffinity
+ */
+void SetExecutorThreads(
+    size_t num_threads,
+    std::shared_ptr<const AffinityPolicy> policy = nullptr);
+
+/// Number of threads the parallel loops of the library share.
+size_t ExecutorThreads();
+
+/// Number of NUMA nodes of the shared executor.
+size_t ExecutorNodes();
+
+/**
+ * Run f on a worker of a node of the shared executor, e.g. to build and
+ * solve a problem in memory of that node:
+ *
+ *   SetExecutorThreads(0, std::make_shared<NumaAffinity>());
+ *   RunOnNode(i % ExecutorNodes(), [&]() { results[i] = solve(i); });
+ *
+ * The parallel loops f starts stay on the node as long as its workers keep
+ * up. Blocks until f returns, and rethrows its exception.
+ */
+void RunOnNode(size_t node, const std::function<void()> &f);
+
+}  // namespace gtdynamics
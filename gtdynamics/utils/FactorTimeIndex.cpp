@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorTimeIndex.cpp
+ * @brief Index of the factors and variables of a trajectory graph by time
+ * step.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/FactorTimeIndex.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::FactorIndices;
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+bool FactorTimeIndex::untimed(Key key) const {
+  const uint16_t label = DynamicsSymbol::LabelCodeOf(key);
+  return std::find(untimed_labels_.begin(), untimed_labels_.end(), label) !=
+         untimed_labels_.end();
+}
+
+/* ************************************************************************* */
+size_t FactorTimeIndex::add(const gtsam::NonlinearFactor::shared_ptr &factor) {
+  const size_t index = num_factors_++;
+  if (!factor) return index;
+
+  bool timed = false;
+  uint64_t first = 0, last = 0;
+  for (Key key : factor->keys()) {
+    if (untimed(key)) continue;
+    const uint64_t t = DynamicsSymbol::TimeOf(key);
+    first = timed ? std::min(first, t) : t;
+    last = timed ? std::max(last, t) : t;
+    timed = true;
+    if (t >= keys_.size()) keys_.resize(t + 1);
+    keys_[t].insert(key);
+  }
+  if (!timed) {
+    untimed_factors_.push_back(index);
+    return index;
+  }
+  if (first >= factors_.size()) factors_.resize(first + 1);
+  factors_[first].emplace_back(index, last);
+  max_span_ = std::max(max_span_, last - first);
+  return index;
+}
+
+/* ************************************************************************* */
+void FactorTimeIndex::add(const NonlinearFactorGraph &graph) {
+  for (auto &&factor : graph) add(factor);
+}
+
+/* ************************************************************************* */
+FactorIndices FactorTimeIndex::factors(uint64_t k1, uint64_t k2) const {
+  if (k1 > k2) {
+    throw std::invalid_argument("FactorTimeIndex: empty window of steps");
+  }
+  FactorIndices indices;
+  if (factors_.empty()) return indices;
+  // A factor touching the window starts at most max_span_ steps before it.
+  const uint64_t begin = k1 > max_span_ ? k1 - max_span_ : 0;
+  const uint64_t end = std::min<uint64_t>(k2, factors_.size() - 1);
+  for (uint64_t k = begin; k <= end; k++) {
+    for (auto &&entry : factors_[k]) {
+      if (entry.second >= k1) indices.push_back(entry.first);
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+/* ************************************************************************* */
+KeyVector FactorTimeIndex::keys(uint64_t k1, uint64_t k2) const {
+  KeyVector keys;
+  for (uint64_t k = k1; k <= k2 && k < keys_.size(); k++) {
+    keys.insert(keys.end(), keys_[k].begin(), keys_[k].end());
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph FactorTimeIndex::subgraph(
+    const NonlinearFactorGraph &graph, uint64_t k1, uint64_t k2) const {
+  if (graph.size() != num_factors_) {
+    throw std::invalid_argument(
+        "FactorTimeIndex: graph does not match the index");
+  }
+  const FactorIndices indices = factors(k1, k2);
+  NonlinearFactorGraph window;
+  window.reserve(indices.size());
+  for (size_t i : indices) window.push_back(graph[i]);
+  return window;
+}
+
+}  // namespace gtdynamics
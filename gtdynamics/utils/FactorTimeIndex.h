@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorTimeIndex.h
+ * @brief Index of the factors and variables of a trajectory graph by time
+ * step, to extract the factors of a window of steps.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FactorTimeIndex maps time steps to the factors and variables of a graph
+ * with DynamicsSymbol keys. A factor spans the steps from the earliest to
+ * the latest time of its keys, and is stored with its earliest step, so the
+ * factors touching a window of steps are found by visiting the steps of the
+ * window and the few before it, without scanning the graph.
+ *
+ * Keys whose time field is not a time step, such as the phase durations of
+ * PhaseKey, are untimed: they do not place a factor in time, and factors on
+ * untimed keys only are kept apart.
+ *
+ * Example:
+ *   FactorTimeIndex index;
+ *   auto graph = graph_builder.trajectoryFG(robot, N, dt, Trapezoidal,
+ *                                           boost::none, boost::none, &index);
+ *   auto window = index.subgraph(graph, k1, k2);
+ */
+class FactorTimeIndex {
+ public:
+  typedef std::vector<uint16_t> Labels;
+
+  /// Labels of untimed keys by default: those of PhaseKey.
+  static Labels DefaultUntimedLabels() {
+    return {DynamicsSymbol::LabelCode("dt")};
+  }
+
+ private:
+  Labels untimed_labels_;
+  size_t num_factors_ = 0;
+  uint64_t max_span_ = 0;  // largest difference of latest and earliest step
+  // Factors by their earliest step, each with its latest step.
+  std::vector<std::vector<std::pair<size_t, uint64_t>>> factors_;
+  std::vector<gtsam::KeySet> keys_;  // timed keys by step
+  gtsam::FactorIndices untimed_factors_;
+
+  bool untimed(gtsam::Key key) const;
+
+ public:
+  /**
+   * Constructor of an empty index.
+   * @param untimed_labels labels of keys that are not placed in time
+   */
+  explicit FactorTimeIndex(
+      const Labels &untimed_labels = DefaultUntimedLabels())
+      : untimed_labels_(untimed_labels) {}
+
+  /// Index all factors of a graph.
+  explicit FactorTimeIndex(
+      const gtsam::NonlinearFactorGraph &graph,
+      const Labels &untimed_labels = DefaultUntimedLabels())
+      : FactorTimeIndex(untimed_labels) {
+    add(graph);
+  }
+
+  /// Index a factor appended to the graph, and return its index.
+  size_t add(const gtsam::NonlinearFactor::shared_ptr &factor);
+
+  /// Index the factors of a graph appended to the graph.
+  void add(const gtsam::NonlinearFactorGraph &graph);
+
+  /// Number of factors indexed, including null factors.
+  size_t size() const { return num_factors_; }
+
+  /// One past the latest step of any key.
+  size_t numSteps() const { return keys_.size(); }
+
+  /**
+   * Indices of the factors whose span overlaps the steps [k1, k2], in order.
+   * With keys at consecutive steps, as in trajectory graphs, these are the
+   * factors on some key at a step in [k1, k2].
+   */
+  gtsam::FactorIndices factors(uint64_t k1, uint64_t k2) const;
+
+  /// Timed keys at steps in [k1, k2], in step order.
+  gtsam::KeyVector keys(uint64_t k1, uint64_t k2) const;
+
+  /// Indices of the factors on untimed keys only, in order.
+  const gtsam::FactorIndices &untimedFactors() const {
+    return untimed_factors_;
+  }
+
+  /**
+   * Factors of the indexed graph whose span overlaps the steps [k1, k2], see
+   * factors(), in graph order and sharing the factors of graph.
+   */
+  gtsam::NonlinearFactorGraph subgraph(
+      const gtsam::NonlinearFactorGraph &graph, uint64_t k1,
+      uint64_t k2) const;
+};
+
+}  // namespace gtdynamics
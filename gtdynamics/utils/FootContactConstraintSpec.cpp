@@ -47,6 +47,14 @@ bool FootContactConstraintSpec::hasContact(const LinkSharedPtr &link) const {
   return link_count > 0;
 }
 
+std::vector<bool> FootContactConstraintSpec::contactMask(
+    const PointOnLinks &candidates) const {
+  std::vector<bool> mask;
+  mask.reserve(candidates.size());
+  for (auto &&cp : candidates) mask.push_back(hasContact(cp.link));
+  return mask;
+}
+
 const gtsam::Point3 &FootContactConstraintSpec::contactPoint(const std::string &link_name) const {
   auto it = std::find_if(contact_points_.begin(), contact_points_.end(),
                           [&](const PointOnLink &contact_point) {
@@ -58,6 +58,13 @@ class FootContactConstraintSpec : public ConstraintSpec {
   /// Check if phase has a contact for given link.
   bool hasContact(const LinkSharedPtr &link) const;
 
+  /**
+   * Contact mask of candidate contact points, true for those on a link in
+   * contact, e.g. to switch the contacts of a ContactActivationGraph.
+   * @param[in] candidates stance *and* swing feet.
+   */
+  std::vector<bool> contactMask(const PointOnLinks &candidates) const;
+
   /// Returns the contact point object of link.
   const gtsam::Point3 &contactPoint(const std::string &link_name) const;
 
@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphArena.cpp
+ * @brief Arena allocation of the factors of a factor graph.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/GraphArena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace gtdynamics {
+
+namespace {
+thread_local const std::shared_ptr<GraphArena> *current_arena = nullptr;
+}  // namespace
+
+/* ************************************************************************* */
+void *GraphArena::allocate(size_t bytes, size_t alignment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto align = [alignment](char *p) {
+    const uintptr_t u = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char *>((u + alignment - 1) & ~(alignment - 1));
+  };
+
+  char *p = next_ ? align(next_) : nullptr;
+  if (!p || p + bytes > end_) {
+    // Start a new block, large enough for oversized objects.
+    const size_t size = std::max(block_size_, bytes + alignment);
+    blocks_.emplace_back(new char[size]);
+    next_ = blocks_.back().get();
+    end_ = next_ + size;
+    statistics_.num_blocks++;
+    statistics_.bytes_reserved += size;
+    p = align(next_);
+  }
+
+  statistics_.num_allocations++;
+  statistics_.bytes_allocated += (p + bytes) - next_;
+  next_ = p + bytes;
+  return p;
+}
+
+/* ************************************************************************* */
+ArenaStatistics GraphArena::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+/* ************************************************************************* */
+GraphArena::Scope::Scope(const std::shared_ptr<GraphArena> &arena)
+    : arena_(arena), previous_(current_arena) {
+  if (arena_) current_arena = &arena_;
+}
+
+/* ************************************************************************* */
+GraphArena::Scope::~Scope() { current_arena = previous_; }
+
+/* ************************************************************************* */
+const std::shared_ptr<GraphArena> *GraphArena::Current() {
+  return current_arena;
+}
+
+}  // namespace gtdynamics
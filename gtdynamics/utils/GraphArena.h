@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphArena.h
+ * @brief Arena allocation of the factors of a factor graph.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Allocation counts of a GraphArena.
+struct ArenaStatistics {
+  size_t num_allocations = 0;  // objects allocated from the arena
+  size_t bytes_allocated = 0;  // bytes handed out, including alignment
+  size_t num_blocks = 0;       // blocks obtained from the heap
+  size_t bytes_reserved = 0;   // total size of the blocks
+};
+
+/**
+ * GraphArena is a monotonic allocator for the factors of a graph: objects are
+ * carved out of large blocks and memory is only released, all at once, when
+ * the arena is destroyed. Shared pointers created by MakeShared keep the
+ * arena alive, so the arena lives exactly as long as the factors built in it.
+ *
+ * Use one arena per graph build: memory of the factors of a graph that is
+ * dropped is not reused by the arena, but returned when the arena goes.
+ *
+ * Allocation is thread-safe, so graphs may be built in parallel in one arena.
+ */
+class GraphArena {
+ private:
+  const size_t block_size_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *next_ = nullptr, *end_ = nullptr;
+  ArenaStatistics statistics_;
+
+ public:
+  /**
+   * Constructor.
+   * @param block_size size of the blocks obtained from the heap, in bytes.
+   */
+  explicit GraphArena(size_t block_size = 64 * 1024)
+      : block_size_(block_size) {}
+
+  GraphArena(const GraphArena &) = delete;
+  GraphArena &operator=(const GraphArena &) = delete;
+
+  /// Allocate `bytes` bytes aligned to `alignment`, a power of two.
+  void *allocate(size_t bytes, size_t alignment);
+
+  /// Allocation counts so far.
+  ArenaStatistics statistics() const;
+
+  /**
+   * While a Scope is alive, MakeShared on the same thread allocates from its
+   * arena. Scopes nest; a Scope of a null arena leaves the current one as is.
+   */
+  class Scope {
+    std::shared_ptr<GraphArena> arena_;
+    const std::shared_ptr<GraphArena> *previous_;
+
+   public:
+    explicit Scope(const std::shared_ptr<GraphArena> &arena);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  /// The arena of the innermost Scope on this thread, or null.
+  static const std::shared_ptr<GraphArena> *Current();
+};
+
+/**
+ * Standard allocator allocating from a GraphArena. Deallocation is a no-op:
+ * the memory is released with the arena, which each copy keeps alive.
+ */
+template <class T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(const std::shared_ptr<GraphArena> &arena)
+      : arena_(arena) {}
+
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, size_t) {}
+
+  const std::shared_ptr<GraphArena> &arena() const { return arena_; }
+
+  template <class U>
+  struct rebind {
+    using other = ArenaAllocator<U>;
+  };
+
+ private:
+  std::shared_ptr<GraphArena> arena_;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return !(a == b);
+}
+
+/**
+ * Same as boost::make_shared<T>, but allocates the object and its control
+ * block from the current GraphArena, if any.
+ */
+template <class T, class... ARGS>
+boost::shared_ptr<T> MakeShared(ARGS &&... args) {
+  if (const std::shared_ptr<GraphArena> *arena = GraphArena::Current()) {
+    return boost::allocate_shared<T>(ArenaAllocator<T>(*arena),
+                                     std::forward<ARGS>(args)...);
+  }
+  return boost::make_shared<T>(std::forward<ARGS>(args)...);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphTemplate.cpp
+ * @brief Build the factors of one time step once and reuse them for others.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/factors/BSplineFactor.h>
+#include <gtdynamics/factors/GatedFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Unit3.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+#include <stdexcept>
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RekeyedFactor::RekeyedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                             const KeyVector &keys)
+    : Base(keys), factor_(factor) {
+  if (keys.size() != factor->size()) {
+    throw std::invalid_argument(
+        "RekeyedFactor: number of keys does not match the template factor");
+  }
+  key_map_.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    key_map_.emplace_back(factor->keys()[i], keys[i]);
+  }
+  std::sort(key_map_.begin(), key_map_.end());
+}
+
+/* ************************************************************************* */
+Values RekeyedFactor::templateValues(const Values &x) const {
+  Values values;
+  for (auto &&keys : key_map_) values.insert(keys.first, x.at(keys.second));
+  return values;
+}
+
+/* ************************************************************************* */
+double RekeyedFactor::error(const Values &x) const {
+  return factor_->error(templateValues(x));
+}
+
+/* ************************************************************************* */
+bool RekeyedFactor::active(const Values &x) const {
+  return factor_->active(templateValues(x));
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> RekeyedFactor::linearize(
+    const Values &x) const {
+  auto linear = factor_->linearize(templateValues(x));
+  if (!linear) return linear;
+  for (Key &key : linear->keys()) {
+    key = std::lower_bound(key_map_.begin(), key_map_.end(),
+                           std::make_pair(key, Key(0)))
+              ->second;
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+void RekeyedFactor::print(const std::string &s,
+                          const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << s << "RekeyedFactor on";
+  for (Key key : keys_) std::cout << " " << keyFormatter(key);
+  std::cout << "\n";
+  factor_->print("  template: ", keyFormatter);
+}
+
+/* ************************************************************************* */
+// Whether factor is an ExpressionFactor<T> for one of the given types.
+template <typename... T>
+static bool IsExpressionFactor(const gtsam::NonlinearFactor &factor) {
+  const bool is[] = {
+      dynamic_cast<const gtsam::ExpressionFactor<T> *>(&factor) != nullptr...};
+  return std::find(std::begin(is), std::end(is), true) != std::end(is);
+}
+
+/* ************************************************************************* */
+// Whether evaluating factor reads variables other than through its keys.
+static bool NeedsRekeyedFactor(const gtsam::NonlinearFactor &factor) {
+  return IsExpressionFactor<double, gtsam::Vector, gtsam::Vector1,
+                            gtsam::Vector2, gtsam::Vector3, gtsam::Vector4,
+                            gtsam::Vector5, gtsam::Vector6, gtsam::Rot2,
+                            gtsam::Rot3, gtsam::Pose2, gtsam::Pose3,
+                            gtsam::Unit3>(factor) ||
+         dynamic_cast<const GatedFactor *>(&factor) ||
+         dynamic_cast<const BSplineFactor *>(&factor);
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactor::shared_ptr RekeyFactor(
+    const gtsam::NonlinearFactor::shared_ptr &factor, const KeyVector &keys) {
+  if (auto rekeyed = boost::dynamic_pointer_cast<RekeyedFactor>(factor)) {
+    return boost::make_shared<RekeyedFactor>(rekeyed->templateFactor(), keys);
+  }
+  if (!NeedsRekeyedFactor(*factor)) {
+    try {
+      return factor->rekey(keys);
+    } catch (const std::runtime_error &) {
+      // No clone() implementation, wrap the factor instead.
+    }
+  }
+  return boost::make_shared<RekeyedFactor>(factor, keys);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph RekeyGraph(const NonlinearFactorGraph &graph,
+                                const std::function<Key(Key)> &rekey) {
+  NonlinearFactorGraph rekeyed;
+  rekeyed.reserve(graph.size());
+  for (auto &&factor : graph) {
+    if (!factor) {
+      rekeyed.push_back(factor);
+      continue;
+    }
+    KeyVector keys;
+    keys.reserve(factor->size());
+    for (Key key : factor->keys()) keys.push_back(rekey(key));
+    rekeyed.push_back(RekeyFactor(factor, keys));
+  }
+  return rekeyed;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GraphTemplate::instantiate(uint64_t t) const {
+  if (t == t0_) return graph_;
+  return RekeyGraph(graph_, [this, t](Key key) {
+    if (!DynamicsSymbol::IsDynamicsSymbol(key)) return key;
+    const DynamicsSymbol symbol(key);
+    return symbol.time() == t0_ ? Key(symbol.atTime(t)) : key;
+  });
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphTemplate.h
+ * @brief Build the factors of one time step once and reuse them for others.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RekeyedFactor evaluates a shared template factor on different keys.
+ *
+ * Cloning an ExpressionFactor and calling rekey() is not enough, since the
+ * leaves of its expression tree keep the original keys. Instead, this factor
+ * copies its own variables into the template keys before delegating, and
+ * renames the keys of the linearized factor. Construction only copies a key
+ * vector; the price is a small Values copy per evaluation, so RekeyFactor
+ * only uses it for factors that cannot be rekeyed directly.
+ */
+class RekeyedFactor : public gtsam::NonlinearFactor {
+ private:
+  using Base = gtsam::NonlinearFactor;
+  gtsam::NonlinearFactor::shared_ptr factor_;
+
+  /// (template key, key) pairs, sorted by template key.
+  std::vector<std::pair<gtsam::Key, gtsam::Key>> key_map_;
+
+  /// Values of this factor's variables under the template keys.
+  gtsam::Values templateValues(const gtsam::Values &x) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param factor  template factor
+   * @param keys    keys replacing factor->keys(), in the same order
+   */
+  RekeyedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                const gtsam::KeyVector &keys);
+
+  /// The wrapped template factor.
+  const gtsam::NonlinearFactor::shared_ptr &templateFactor() const {
+    return factor_;
+  }
+
+  double error(const gtsam::Values &x) const override;
+
+  size_t dim() const override { return factor_->dim(); }
+
+  bool active(const gtsam::Values &x) const override;
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<RekeyedFactor>(*this);
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+};
+
+/**
+ * Return a factor on other keys. Factors that only read their variables
+ * through their keys are cloned and rekeyed once. Expression factors, factors
+ * wrapping other factors (GatedFactor, BSplineFactor) and factors without
+ * clone() are wrapped in a RekeyedFactor, which for a RekeyedFactor wraps its
+ * template factor instead.
+ * @param factor  template factor
+ * @param keys    keys replacing factor->keys(), in the same order
+ */
+gtsam::NonlinearFactor::shared_ptr RekeyFactor(
+    const gtsam::NonlinearFactor::shared_ptr &factor,
+    const gtsam::KeyVector &keys);
+
+/**
+ * Return the factors of a graph on other keys, see RekeyFactor.
+ * @param graph  template factors
+ * @param rekey  returns the new key of every key in graph
+ */
+gtsam::NonlinearFactorGraph RekeyGraph(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::function<gtsam::Key(gtsam::Key)> &rekey);
+
+/**
+ * GraphTemplate stores the factors of a single time step, all of whose
+ * DynamicsSymbol keys at time t0 are replaced when the template is
+ * instantiated at another step. Keys at other times, and keys that are not
+ * DynamicsSymbols, are left unchanged.
+ *
+ * Example:
+ *   GraphTemplate slice(graph_builder.dynamicsFactorGraph(robot, 0), 0);
+ *   for (int k = 0; k <= num_steps; k++) graph.add(slice.instantiate(k));
+ */
+class GraphTemplate {
+ private:
+  gtsam::NonlinearFactorGraph graph_;
+  uint64_t t0_;
+
+ public:
+  /**
+   * Constructor.
+   * @param graph  factors of one time step
+   * @param t0     the time step the factors were built for
+   */
+  GraphTemplate(const gtsam::NonlinearFactorGraph &graph, uint64_t t0)
+      : graph_(graph), t0_(t0) {}
+
+  /// Number of factors per instance.
+  size_t size() const { return graph_.size(); }
+
+  /// Return the factors for time step t; at t0 the template itself.
+  gtsam::NonlinearFactorGraph instantiate(uint64_t t) const;
+};
+
+}  // namespace gtdynamics
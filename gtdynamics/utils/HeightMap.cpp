@@ -0,0 +1,292 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.cpp
+ * @brief Tiled terrain height grid, memory mapped.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtdynamics/utils/MappedFile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'H', 'M', 'A', 'P', 0};
+
+/// Fixed header at the start of a file, followed by the tile offsets.
+struct MapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tile_size;
+  double origin[2];
+  double cell_size;
+  double default_height;
+  uint64_t rows, cols;
+};
+static_assert(sizeof(MapHeader) % sizeof(uint64_t) == 0,
+              "tile offsets after the header must stay aligned");
+
+// Index of the cell below x along an axis of n cells, and the weight t of
+// the cell above it; t is clamped to the grid, clamped tells whether it was.
+size_t Lower(double x, size_t n, double *t, bool *clamped) {
+  const double upper = static_cast<double>(n - 1);
+  *clamped = x < 0 || x > upper;
+  x = std::min(std::max(x, 0.0), upper);
+  const size_t i = std::min(static_cast<size_t>(x), n - 2);
+  *t = x - i;
+  return i;
+}
+
+/// Cells and weights of an interpolation along one axis, with derivatives.
+struct Kernel {
+  size_t size;
+  size_t index[4];
+  double w[4], dw[4], ddw[4];
+};
+
+Kernel MakeKernel(double x, size_t n, HeightMap::Interpolation interpolation) {
+  Kernel k;
+  double t;
+  bool clamped;
+  const size_t i = Lower(x, n, &t, &clamped);
+  if (interpolation == HeightMap::Bilinear) {
+    k.size = 2;
+    k.index[0] = i;
+    k.index[1] = i + 1;
+    k.w[0] = 1 - t, k.w[1] = t;
+    k.dw[0] = -1, k.dw[1] = 1;
+    k.ddw[0] = k.ddw[1] = 0;
+  } else {
+    // Catmull-Rom on cells i - 1 to i + 2, repeating the border cells.
+    k.size = 4;
+    for (size_t a = 0; a < 4; a++) {
+      k.index[a] = std::min(std::max(i + a, size_t(1)) - 1, n - 1);
+    }
+    const double t2 = t * t, t3 = t2 * t;
+    k.w[0] = 0.5 * (-t3 + 2 * t2 - t);
+    k.w[1] = 0.5 * (3 * t3 - 5 * t2 + 2);
+    k.w[2] = 0.5 * (-3 * t3 + 4 * t2 + t);
+    k.w[3] = 0.5 * (t3 - t2);
+    k.dw[0] = 0.5 * (-3 * t2 + 4 * t - 1);
+    k.dw[1] = 0.5 * (9 * t2 - 10 * t);
+    k.dw[2] = 0.5 * (-9 * t2 + 8 * t + 1);
+    k.dw[3] = 0.5 * (3 * t2 - 2 * t);
+    k.ddw[0] = -3 * t + 2;
+    k.ddw[1] = 9 * t - 5;
+    k.ddw[2] = -9 * t + 4;
+    k.ddw[3] = 3 * t - 1;
+  }
+  if (clamped) {
+    std::fill(k.dw, k.dw + 4, 0.0);
+    std::fill(k.ddw, k.ddw + 4, 0.0);
+  }
+  return k;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+HeightMap::HeightMap(const gtsam::Point2 &origin, double cell_size,
+                     const gtsam::Matrix &heights, size_t tile_size,
+                     double default_height) {
+  if (heights.rows() < 2 || heights.cols() < 2)
+    throw std::invalid_argument(
+        "HeightMap: the grid needs at least 2 x 2 cells");
+  if (cell_size <= 0)
+    throw std::invalid_argument("HeightMap: the cell size must be positive");
+  if (tile_size < 1)
+    throw std::invalid_argument("HeightMap: the tile size must be positive");
+
+  MapHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kHeightMapVersion;
+  header.tile_size = tile_size;
+  header.origin[0] = origin.x();
+  header.origin[1] = origin.y();
+  header.cell_size = cell_size;
+  header.default_height = default_height;
+  header.rows = heights.rows();
+  header.cols = heights.cols();
+
+  const size_t tile_rows = (header.rows + tile_size - 1) / tile_size;
+  const size_t tile_cols = (header.cols + tile_size - 1) / tile_size;
+  std::vector<uint64_t> offsets(tile_rows * tile_cols, 0);
+  std::vector<float> tiles;
+  const uint64_t first = sizeof(header) + sizeof(uint64_t) * offsets.size();
+  for (size_t tr = 0; tr < tile_rows; tr++) {
+    for (size_t tc = 0; tc < tile_cols; tc++) {
+      // Cells past the grid pad the border tiles, and are never read.
+      std::vector<float> tile(tile_size * tile_size, 0.0f);
+      bool empty = true;
+      for (size_t a = 0; a < tile_size; a++) {
+        const size_t row = tr * tile_size + a;
+        for (size_t b = 0; b < tile_size && row < header.rows; b++) {
+          const size_t col = tc * tile_size + b;
+          if (col >= header.cols) break;
+          const double h = heights(row, col);
+          empty = empty && std::isnan(h);
+          tile[a * tile_size + b] = h;
+        }
+      }
+      if (empty) continue;
+      offsets[tr * tile_cols + tc] = first + sizeof(float) * tiles.size();
+      tiles.insert(tiles.end(), tile.begin(), tile.end());
+    }
+  }
+
+  auto image = std::make_shared<std::string>();
+  image->append(reinterpret_cast<const char *>(&header), sizeof(header));
+  image->append(reinterpret_cast<const char *>(offsets.data()),
+                sizeof(uint64_t) * offsets.size());
+  image->append(reinterpret_cast<const char *>(tiles.data()),
+                sizeof(float) * tiles.size());
+  data_ = image->data();
+  size_ = image->size();
+  image_ = image;
+  parse("heights");
+}
+
+/* ************************************************************************* */
+void HeightMap::parse(const std::string &name) {
+  MapHeader header;
+  if (size_ < sizeof(header))
+    throw std::runtime_error("HeightMap: " + name + " is not a height map");
+  std::memcpy(&header, data_, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("HeightMap: " + name + " is not a height map");
+  if (header.version != kHeightMapVersion)
+    throw std::runtime_error("HeightMap: " + name +
+                             " has another format version");
+  if (header.rows < 2 || header.cols < 2 || header.tile_size < 1 ||
+      header.cell_size <= 0)
+    throw std::runtime_error("HeightMap: invalid grid in " + name);
+
+  origin_ = gtsam::Point2(header.origin[0], header.origin[1]);
+  cell_size_ = header.cell_size;
+  default_height_ = header.default_height;
+  rows_ = header.rows;
+  cols_ = header.cols;
+  tile_size_ = header.tile_size;
+  tile_rows_ = (rows_ + tile_size_ - 1) / tile_size_;
+  tile_cols_ = (cols_ + tile_size_ - 1) / tile_size_;
+
+  const uint64_t num_tiles = tile_rows_ * tile_cols_;
+  if ((size_ - sizeof(header)) / sizeof(uint64_t) < num_tiles)
+    throw std::runtime_error("HeightMap: truncated tile table in " + name);
+  // Mappings are page aligned, and buffers are aligned for any type.
+  offsets_ = reinterpret_cast<const uint64_t *>(data_ + sizeof(header));
+
+  // Only the table is checked here: the tiles stay on disk until queried.
+  const uint64_t first = sizeof(header) + sizeof(uint64_t) * num_tiles;
+  const uint64_t tile_bytes = sizeof(float) * tile_size_ * tile_size_;
+  for (uint64_t t = 0; t < num_tiles; t++) {
+    const uint64_t offset = offsets_[t];
+    if (!offset) continue;
+    if (offset < first || offset % sizeof(float) != 0 || offset > size_ ||
+        size_ - offset < tile_bytes)
+      throw std::runtime_error("HeightMap: invalid tile offset in " + name);
+  }
+}
+
+/* ************************************************************************* */
+HeightMap HeightMap::Load(const std::string &file_path) {
+  auto file = std::make_shared<MappedFile>();
+  if (!file->open(file_path))
+    throw std::runtime_error("HeightMap: no file found at " + file_path);
+  HeightMap map;
+  map.data_ = file->data();
+  map.size_ = file->size();
+  map.file_ = file;
+  map.parse(file_path);
+  return map;
+}
+
+/* ************************************************************************* */
+void HeightMap::save(const std::string &file_path) const {
+  std::ofstream os(file_path, std::ios::binary);
+  os.write(data_, size_);
+  if (!os.good())
+    throw std::runtime_error("HeightMap: could not write " + file_path);
+}
+
+/* ************************************************************************* */
+size_t HeightMap::numStoredTiles() const {
+  const size_t num_tiles = tile_rows_ * tile_cols_;
+  return num_tiles - std::count(offsets_, offsets_ + num_tiles, uint64_t(0));
+}
+
+/* ************************************************************************* */
+double HeightMap::evaluate(const gtsam::Point2 &xy,
+                           Interpolation interpolation,
+                           gtsam::Vector2 *gradient,
+                           gtsam::Matrix2 *hessian) const {
+  const gtsam::Point2 p = (xy - origin_) / cell_size_;
+  const Kernel kx = MakeKernel(p.x(), cols_, interpolation);
+  const Kernel ky = MakeKernel(p.y(), rows_, interpolation);
+
+  double h = 0, h_x = 0, h_y = 0, h_xx = 0, h_xy = 0, h_yy = 0;
+  for (size_t a = 0; a < ky.size; a++) {
+    for (size_t b = 0; b < kx.size; b++) {
+      const double c = cell(ky.index[a], kx.index[b]);
+      h += ky.w[a] * kx.w[b] * c;
+      h_x += ky.w[a] * kx.dw[b] * c;
+      h_y += ky.dw[a] * kx.w[b] * c;
+      h_xx += ky.w[a] * kx.ddw[b] * c;
+      h_xy += ky.dw[a] * kx.dw[b] * c;
+      h_yy += ky.ddw[a] * kx.w[b] * c;
+    }
+  }
+  if (gradient) *gradient = gtsam::Vector2(h_x, h_y) / cell_size_;
+  if (hessian) {
+    *hessian << h_xx, h_xy, h_xy, h_yy;
+    *hessian /= cell_size_ * cell_size_;
+  }
+  return h;
+}
+
+/* ************************************************************************* */
+double HeightMap::height(const gtsam::Point2 &xy,
+                         gtsam::OptionalJacobian<1, 2> H,
+                         Interpolation interpolation) const {
+  gtsam::Vector2 gradient;
+  const double h =
+      evaluate(xy, interpolation, H ? &gradient : nullptr, nullptr);
+  if (H) *H = gradient.transpose();
+  return h;
+}
+
+/* ************************************************************************* */
+gtsam::Vector3 HeightMap::normal(const gtsam::Point2 &xy,
+                                 gtsam::OptionalJacobian<3, 2> H,
+                                 Interpolation interpolation) const {
+  gtsam::Vector2 gradient;
+  gtsam::Matrix2 hessian;
+  evaluate(xy, interpolation, &gradient, H ? &hessian : nullptr);
+  // Normal of the surface z = h(x, y), and the derivative of normalizing.
+  const gtsam::Vector3 g(-gradient.x(), -gradient.y(), 1.0);
+  const double norm = g.norm();
+  const gtsam::Vector3 n = g / norm;
+  if (H) {
+    gtsam::Matrix32 H_g = gtsam::Matrix32::Zero();
+    H_g.topRows<2>() = -hessian;
+    *H = (gtsam::I_3x3 - n * n.transpose()) * H_g / norm;
+  }
+  return n;
+}
+
+}  // namespace gtdynamics
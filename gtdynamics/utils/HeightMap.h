@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.h
+ * @brief Tiled terrain height grid, memory mapped.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/geometry/Point2.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+class MappedFile;
+
+/// Version of the binary height map format.
+constexpr uint32_t kHeightMapVersion = 1;
+
+/**
+ * Terrain heights along world z, sampled on a regular grid: rows run along y
+ * and columns along x, and cell (row, col) is at origin + cell_size * (col,
+ * row), as for a slice of SignedDistanceField.
+ *
+ * The grid is split into square tiles of tile_size x tile_size cells, each
+ * stored contiguously, so that a query touches one to four tiles. Binary
+ * files are a fixed header, a table with the byte offset of every tile, and
+ * the tiles as native-endian 32-bit floats, row-major. Files are memory
+ * mapped: loading reads only the header and the table, and tiles are paged
+ * in from disk when they are first queried, so maps of several GB load
+ * immediately and use memory only for the regions visited. Tiles without
+ * data are not stored, and read as default_height. Copies share the grid.
+ */
+class HeightMap {
+ public:
+  /// Interpolation of the cells.
+  enum Interpolation {
+    Bilinear,  // continuous heights, gradients constant within cells
+    Bicubic    // Catmull-Rom, continuous gradients
+  };
+
+ private:
+  std::shared_ptr<const MappedFile> file_;   // mapped image, or
+  std::shared_ptr<const std::string> image_;  // image in memory
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  const uint64_t *offsets_ = nullptr;  // byte offset of every tile, 0 if none
+  gtsam::Point2 origin_;
+  double cell_size_ = 0, default_height_ = 0;
+  size_t rows_ = 0, cols_ = 0, tile_size_ = 0, tile_rows_ = 0, tile_cols_ = 0;
+
+  HeightMap() {}
+
+  /// Set the grid fields from an image, throws if it is not a height map.
+  void parse(const std::string &name);
+
+  /// Height with its gradient and Hessian along x and y.
+  double evaluate(const gtsam::Point2 &xy, Interpolation interpolation,
+                  gtsam::Vector2 *gradient, gtsam::Matrix2 *hessian) const;
+
+ public:
+  /**
+   * Constructor from a grid of heights.
+   * @param origin         position of cell (0, 0)
+   * @param cell_size      edge length of a cell
+   * @param heights        rows x cols heights, at least 2 x 2; tiles whose
+   * heights are all NaN are not stored
+   * @param tile_size      edge length of a tile, in cells
+   * @param default_height height of the cells of missing tiles
+   */
+  HeightMap(const gtsam::Point2 &origin, double cell_size,
+            const gtsam::Matrix &heights, size_t tile_size = 64,
+            double default_height = 0.0);
+
+  /// Map a binary height map file; throws if it is not one.
+  static HeightMap Load(const std::string &file_path);
+
+  /// Write the binary format, to be loaded with Load.
+  void save(const std::string &file_path) const;
+
+  /// Height of a cell.
+  double cell(size_t row, size_t col) const {
+    const size_t tile_row = row / tile_size_, tile_col = col / tile_size_;
+    const uint64_t offset = offsets_[tile_row * tile_cols_ + tile_col];
+    if (!offset) return default_height_;
+    const float *tile = reinterpret_cast<const float *>(data_ + offset);
+    return tile[(row - tile_row * tile_size_) * tile_size_ +
+                (col - tile_col * tile_size_)];
+  }
+
+  /**
+   * Terrain height below a point. Points outside the grid get the height at
+   * the nearest point of the grid, with zero derivative along the axes they
+   * are outside along.
+   * @param xy            world x and y
+   * @param H             optional 1x2 gradient of the height
+   * @param interpolation interpolation of the cells
+   */
+  double height(const gtsam::Point2 &xy,
+                gtsam::OptionalJacobian<1, 2> H = boost::none,
+                Interpolation interpolation = Bilinear) const;
+
+  /**
+   * Upward unit normal of the terrain below a point.
+   * @param xy            world x and y
+   * @param H             optional 3x2 derivative of the normal
+   * @param interpolation interpolation of the cells
+   */
+  gtsam::Vector3 normal(const gtsam::Point2 &xy,
+                        gtsam::OptionalJacobian<3, 2> H = boost::none,
+                        Interpolation interpolation = Bilinear) const;
+
+  const gtsam::Point2 &origin() const { return origin_; }
+  double cellSize() const { return cell_size_; }
+  double defaultHeight() const { return default_height_; }
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t tileSize() const { return tile_size_; }
+
+  /// Number of tiles stored, out of tileRows() * tileCols().
+  size_t numStoredTiles() const;
+  size_t tileRows() const { return tile_rows_; }
+  size_t tileCols() const { return tile_cols_; }
+};
+
+}  // namespace gtdynamics
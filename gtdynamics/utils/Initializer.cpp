@@ -15,6 +15,8 @@
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Value.h>
 #include <gtsam/base/Vector.h>
@@ -22,7 +24,9 @@
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <algorithm>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -37,6 +41,13 @@ using gtsam::Vector6;
 
 namespace gtdynamics {
 
+constexpr size_t Initializer::kDeterministicSegments;
+
+Sampler Initializer::stepSampler(double gaussian_noise, int t) const {
+  return Sampler(gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise),
+                 seed_ + t);
+}
+
 Pose3 Initializer::AddGaussianNoiseToPose(const Pose3& T, const Sampler& sampler) const {
   Vector6 xi = sampler.sample();
   return T.expmap(xi);
@@ -109,21 +120,25 @@ Values Initializer::InitializeSolutionInterpolation(
     const Pose3& wTl_f, double T_s, double T_f, double dt,
     double gaussian_noise,
     const boost::optional<PointOnLinks>& contact_points) {
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  GTDYNAMICS_TRACE_SCOPE("Initializer::interpolation");
+  auto link = robot.link(link_name);
+  if (link->isFixed()) {
+    throw std::invalid_argument("InitializeSolutionInterpolation: Link " +
+                                link_name + " is fixed.");
+  }
 
   // Initial and final discretized timesteps.
   int n_steps_init = std::lround(T_s / dt);
   int n_steps_final = std::lround(T_f / dt);
+  int num_steps = std::max(n_steps_final - n_steps_init + 1, 0);
 
-  double t_elapsed = T_s;
-
-  Values init_vals;
-
-  // Initialize joint angles and velocities to 0.
-  for (int t = n_steps_init; t <= n_steps_final; t++) {
-    double s = (t_elapsed - T_s) / (T_f - T_s);
+  // Initialize every step in its own Values, merged once all are done.
+  std::vector<Values> step_vals(num_steps);
+  ParallelFor(num_steps, num_threads_, [&](size_t k) {
+    int t = n_steps_init + k;
+    GTDYNAMICS_TRACE_SCOPE_ARG("Initializer::interpolationStep", t);
+    Sampler sampler = stepSampler(gaussian_noise, t);
+    double s = (k * dt) / (T_f - T_s);
 
     // Compute interpolated pose for link.
     Pose3 wTl_t = AddGaussianNoiseToPose(
@@ -131,27 +146,23 @@ Values Initializer::InitializeSolutionInterpolation(
 
     // Compute forward dynamics to obtain remaining link poses.
     // TODO(Alejandro): forwardKinematics needs to get passed prev link twist
+    Values values;
     for (auto&& joint : robot.joints()) {
-      InsertJointAngle(&init_vals, joint->id(), t, sampler.sample()[0]);
-      InsertJointVel(&init_vals, joint->id(), t, sampler.sample()[0]);
+      InsertJointAngle(&values, joint->id(), t, sampler.sample()[0]);
+      InsertJointVel(&values, joint->id(), t, sampler.sample()[0]);
     }
-
-    auto link = robot.link(link_name);
-    if (link->isFixed()) {
-      throw std::invalid_argument("InitializeSolutionInterpolation: Link " +
-                                  link_name + " is fixed.");
-    }
-    InsertPose(&init_vals, link->id(), t, wTl_t);
-    InsertTwist(&init_vals, link->id(), t, gtsam::Z_6x1);
-    init_vals = robot.forwardKinematics(init_vals, t, link_name);
+    InsertPose(&values, link->id(), t, wTl_t);
+    InsertTwist(&values, link->id(), t, gtsam::Z_6x1);
+    robot.forwardKinematicsInPlace(&values, t, link_name);
 
     for (auto&& kvp : ZeroValues(robot, t, gaussian_noise, contact_points)) {
-      init_vals.tryInsert(kvp.key, kvp.value);
+      values.tryInsert(kvp.key, kvp.value);
     }
+    step_vals[k] = std::move(values);
+  });
 
-    t_elapsed += dt;
-  }
-
+  Values init_vals;
+  for (auto&& values : step_vals) init_vals.insert(values);
   return init_vals;
 }
 
@@ -177,6 +188,58 @@ Values Initializer::InitializeSolutionInterpolationMultiPhase(
   return init_vals;
 }
 
+std::vector<Values> Initializer::InverseKinematicsSteps(
+    const Robot& robot, const std::string& link_name,
+    const std::vector<Pose3>& wTl_dt, const Values& values,
+    const std::vector<boost::optional<PointOnLinks>>& contact_points) const {
+  GTDYNAMICS_TRACE_SCOPE("Initializer::inverseKinematics");
+  const size_t num_steps = contact_points.size();
+  if (num_steps == 0) return {};
+  size_t num_segments = deterministic_ ? kDeterministicSegments : num_threads_;
+  if (num_segments == 0) num_segments = std::thread::hardware_concurrency();
+  num_segments = std::min(std::max<size_t>(num_segments, 1), num_steps);
+
+  const Vector3 gravity(0, 0, -9.8);
+  const DynamicsGraph dgb(gravity);
+  const auto noise = gtsam::noiseModel::Isotropic::Sigma(6, 0.001);
+  const int link_id = robot.link(link_name)->id();
+
+  // Link poses and joint angles of `source` at step t_source, keyed at t.
+  auto next_step = [&robot](const Values& source, int t, int t_source) {
+    Values next;
+    for (auto&& link : robot.links()) {
+      InsertPose(&next, link->id(), t, Pose(source, link->id(), t_source));
+    }
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&next, joint->id(), t,
+                       JointAngle(source, joint->id(), t_source));
+    }
+    return next;
+  };
+
+  std::vector<Values> results(num_steps);
+  const size_t segment = (num_steps + num_segments - 1) / num_segments;
+  const size_t num_workers = deterministic_ ? num_threads_ : num_segments;
+  ParallelFor(num_segments, num_workers, [&](size_t w) {
+    const size_t begin = w * segment;
+    const size_t end = std::min(num_steps, begin + segment);
+    if (begin >= end) return;
+    Values guess = begin == 0 ? values : next_step(values, begin, 0);
+    for (size_t t = begin; t < end; t++) {
+      GTDYNAMICS_TRACE_SCOPE_ARG("Initializer::inverseKinematicsStep", t);
+      auto kfg = dgb.qFactors(robot, t, contact_points[t]);
+      kfg.addPrior(PoseKey(link_id, t), wTl_dt[t], noise);
+
+      gtsam::LevenbergMarquardtOptimizer optimizer(kfg, guess);
+      results[t] = optimizer.optimize();
+
+      // Update initial values for next timestep.
+      guess = next_step(results[t], t + 1, t);
+    }
+  });
+  return results;
+}
+
 Values Initializer::InitializeSolutionInverseKinematics(
     const Robot& robot, const std::string& link_name, const Pose3& wTl_i,
     const std::vector<Pose3>& wTl_t, const std::vector<double>& timesteps,
@@ -184,48 +247,33 @@ Values Initializer::InitializeSolutionInverseKinematics(
     const boost::optional<PointOnLinks>& contact_points) {
   double t_i = 0.0;  // Time elapsed.
 
-  Vector3 gravity(0, 0, -9.8);
-
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   // Link pose at each step
   std::vector<Pose3> wTl_dt;
 
   // Iteratively solve the inverse kinematics problem while statisfying
   // the contact pose constraint.
-  Values init_vals,
-      values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i,
-                                        timesteps, dt, sampler, &wTl_dt);
-
-  DynamicsGraph dgb(gravity);
-  for (int t = 0; t <= std::round(timesteps[timesteps.size() - 1] / dt); t++) {
-    auto kfg = dgb.qFactors(robot, t, contact_points);
-    kfg.addPrior(PoseKey(robot.link(link_name)->id(), t), wTl_dt[t],
-                 gtsam::noiseModel::Isotropic::Sigma(6, 0.001));
-
-    gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values);
-    Values results = optimizer.optimize();
-
-    // Add zero initial values for remaining variables.
-    init_vals.insert(ZeroValues(robot, t, gaussian_noise, contact_points));
-
-    // Update with the results of the optimizer.
-    init_vals.update(results);
-
-    // Update initial values for next timestep.
-    values.clear();
-
-    for (auto&& link : robot.links()) {
-      InsertPose(&values, link->id(), t + 1, Pose(results, link->id(), t));
-    }
-    for (auto&& joint : robot.joints()) {
-      InsertJointAngle(&values, joint->id(), t + 1,
-                       JointAngle(results, joint->id(), t));
-    }
-  }
+  Values values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i,
+                                           timesteps, dt, sampler, &wTl_dt);
+
+  const int num_steps = std::round(timesteps[timesteps.size() - 1] / dt) + 1;
+  std::vector<Values> results = InverseKinematicsSteps(
+      robot, link_name, wTl_dt, values,
+      std::vector<boost::optional<PointOnLinks>>(num_steps, contact_points));
+
+  // Add zero initial values for remaining variables, updated with the results
+  // of the optimizer.
+  std::vector<Values> step_vals(num_steps);
+  ParallelFor(num_steps, num_threads_, [&](size_t t) {
+    step_vals[t] = ZeroValues(robot, t, gaussian_noise, contact_points);
+    step_vals[t].update(results[t]);
+  });
 
+  Values init_vals;
+  for (auto&& step : step_vals) init_vals.insert(step);
   return init_vals;
 }
 
@@ -276,54 +324,33 @@ Values Initializer::MultiPhaseInverseKinematicsTrajectory(
     std::vector<Values> transition_graph_init, double dt, double gaussian_noise,
     const boost::optional<std::vector<PointOnLinks>>& phase_contact_points) {
   double t_i = 0;  // Time elapsed.
-  Vector3 gravity = (Vector(3) << 0, 0, -9.8).finished();
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   std::vector<Pose3> wTl_dt;
 
   // Iteratively solve the inverse kinematics problem while statisfying
   // the contact pose constraint.
-  Values init_vals,
-      values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i, ts,
-                                        dt, sampler, &wTl_dt);
+  Values values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i,
+                                           ts, dt, sampler, &wTl_dt);
 
-  DynamicsGraph dgb(gravity);
-
-  int t = 0;
+  // Contact points at each step; the last phase includes the final step.
+  std::vector<boost::optional<PointOnLinks>> contact_points;
   int num_phases = phase_steps.size();
-
   for (int phase = 0; phase < num_phases; phase++) {
-    // In-phase.
     int curr_phase_steps =
         phase == (num_phases - 1) ? phase_steps[phase] + 1 : phase_steps[phase];
-    for (int phase_step = 0; phase_step < curr_phase_steps; phase_step++) {
-      auto kfg = dgb.qFactors(robot, t, (*phase_contact_points)[phase]);
-
-      kfg.addPrior(PoseKey(robot.link(link_name)->id(), t), wTl_dt[t],
-                   gtsam::noiseModel::Isotropic::Sigma(6, 0.001));
-
-      gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values);
-      Values results = optimizer.optimize();
-
-      init_vals.insert(results);
+    contact_points.insert(contact_points.end(), curr_phase_steps,
+                          (*phase_contact_points)[phase]);
+  }
 
-      // Update initial values for next timestep.
-      values.clear();
-      for (auto&& link : robot.links()) {
-        int link_id = link->id();
-        InsertPose(&values, link_id, t + 1, Pose(results, link_id, t));
-      }
-
-      for (auto&& joint : robot.joints()) {
-        int joint_id = joint->id();
-        InsertJointAngle(&values, joint_id, t + 1,
-                         JointAngle(results, joint_id, t));
-      }
-      t++;
-    }
+  Values init_vals;
+  for (auto&& results :
+       InverseKinematicsSteps(robot, link_name, wTl_dt, values,
+                              contact_points)) {
+    init_vals.insert(results);
   }
 
   Values zero_values =
@@ -343,7 +370,7 @@ Values Initializer::ZeroValues(const Robot& robot, const int t, double gaussian_
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   // Initialize link dynamics to 0.
   for (auto&& link : robot.links()) {
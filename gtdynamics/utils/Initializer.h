@@ -22,19 +22,64 @@
 #include <gtsam/slam/PriorFactor.h>
 
 #include <boost/optional.hpp>
+#include <cstdint>
 #include <random>
 #include <string>
 #include <vector>
 
 namespace gtdynamics {
 
+/**
+ * Initializer computes initial values for trajectory optimization. The time
+ * steps of a trajectory are initialized in parallel on num_threads threads;
+ * the noise of every step is drawn from its own random stream, seeded by the
+ * seed and the step index, so the noise does not depend on the number of
+ * threads.
+ *
+ * Inverse kinematics is warm-started step by step and split into one segment
+ * per thread, so its result depends on the number of threads. In
+ * deterministic mode it always uses kDeterministicSegments segments, and
+ * initial values are bit-for-bit the same for any number of threads.
+ */
 class Initializer {
+ public:
+    /// Number of inverse kinematics segments in deterministic mode.
+    static constexpr size_t kDeterministicSegments = 8;
+
+ protected:
+    size_t num_threads_ = 1;
+    bool deterministic_ = false;
+    uint64_t seed_ = 42;
+
+    /// Sampler with its own random stream for time step t.
+    gtsam::Sampler stepSampler(double gaussian_noise, int t) const;
 
  public:
     
     // Default Constructor
     Initializer() {}
 
+    /**
+     * Constructor.
+     * @param num_threads   number of threads, 0 for hardware concurrency
+     * @param deterministic whether results may not depend on num_threads
+     * @param seed          seed of the random streams of the noise
+     */
+    explicit Initializer(size_t num_threads, bool deterministic = false,
+                         uint64_t seed = 42)
+        : num_threads_(num_threads),
+          deterministic_(deterministic),
+          seed_(seed) {}
+
+    /// Number of threads used to initialize the time steps.
+    size_t numThreads() const { return num_threads_; }
+
+    /// Whether results do not depend on the number of threads.
+    bool deterministic() const { return deterministic_; }
+
+    /// Seed of the random streams of the noise.
+    uint64_t seed() const { return seed_; }
+
     /**
      * Add zero-mean gaussian noise to a Pose3.
      *
@@ -124,6 +169,12 @@ class Initializer {
     /**
      * @fn Iteratively solve for the robot kinematics with contacts.
      *
+     * Every step is warm-started from the solution at the previous step. With
+     * more than one thread, or in deterministic mode, the steps are split
+     * into contiguous segments that are solved in parallel, and the first
+     * step of each segment starts from the initial poses and joint angles
+     * instead.
+     *
      * @param[in] robot           A Robot object.
      * @param[in] link_name       The name of the link whose pose to interpolate.
      * @param[in] wTl_i           The initial pose of the link.
@@ -162,6 +213,9 @@ class Initializer {
     /**
      * @fn Multi-phase initialize solution inverse kinematics.
      *
+     * The steps are solved in parallel segments as in
+     * InitializeSolutionInverseKinematics.
+     *
      * @param[in] robots                A Robot object for each phase.
      * @param[in] link_name             The name of the link whose pose to
      * interpolate.
@@ -218,6 +272,22 @@ class Initializer {
         double gaussian_noise = 0.0,
         const boost::optional<PointOnLinks>& contact_points = boost::none);
 
+ protected:
+    /**
+     * Solve the kinematics at steps 0..N-1 for the desired link poses, each
+     * step warm-started from the previous one, in parallel segments.
+     *
+     * @param robot          A Robot object.
+     * @param link_name      The name of the link whose pose is constrained.
+     * @param wTl_dt         Desired link pose at each step.
+     * @param values         Initial link poses and joint angles at step 0.
+     * @param contact_points Contact points at each of the N steps.
+     * @return The solution of every step.
+     */
+    std::vector<gtsam::Values> InverseKinematicsSteps(
+        const Robot& robot, const std::string& link_name,
+        const std::vector<gtsam::Pose3>& wTl_dt, const gtsam::Values& values,
+        const std::vector<boost::optional<PointOnLinks>>& contact_points) const;
 };
 
 }  // namespace gtdynamics
@@ -17,6 +17,7 @@
 #include <gtdynamics/factors/WrenchFactor.h>
 #include <gtdynamics/factors/WrenchPlanarFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -26,12 +27,20 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <boost/core/demangle.hpp>
 #include <boost/format.hpp>
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <typeinfo>
 #include <utility>
@@ -41,6 +50,13 @@
 
 // using namespace gtdynamics;
 namespace gtdynamics {
+
+/**
+ * @brief Output format of JsonStreamWriter: one json document, or newline
+ * delimited json with one compact dictionary per line.
+ */
+enum class JsonFormat { kJson, kNdJson };
+
 /**
  * @brief
  * Store optimization results history, export factor graph in json format. The
@@ -235,7 +251,7 @@ class JsonSaver {
                    &(*factor))) {
       return "PriorPose";
     } else {
-      return typeid(factor).name();
+      return GetTypeName(factor);
     }
   }
 
@@ -354,6 +370,19 @@ class JsonSaver {
   static inline std::string GetVariable(const gtsam::Key& key,
                                         const gtsam::Values& values,
                                         const LocationType& locations) {
+    return JsonDict(GetVariableAttributes(key, values, locations));
+  }
+
+  /**
+   * @brief get the attributes of a variable, see GetVariable
+   * @param[in] key           corresponding key of variable
+   * @param[in] values        values
+   * @param[in] locations     locations
+   * @return                  attributes of the variable
+   */
+  static inline std::vector<AttributeType> GetVariableAttributes(
+      const gtsam::Key& key, const gtsam::Values& values,
+      const LocationType& locations) {
     std::vector<AttributeType> attributes;
 
     // name;
@@ -372,7 +401,7 @@ class JsonSaver {
         attributes.emplace_back(Quoted("location"), loc_str);
       }
     }
-    return JsonDict(attributes);
+    return attributes;
   }
 
   /**
@@ -385,6 +414,19 @@ class JsonSaver {
   static inline std::string GetFactor(const size_t idx,
                                       const gtsam::NonlinearFactorGraph& graph,
                                       const gtsam::Values& values) {
+    return JsonDict(GetFactorAttributes(idx, graph, values));
+  }
+
+  /**
+   * @brief get the attributes of a factor, see GetFactor
+   * @param[in] idx           index of factor
+   * @param[in] graph         factor graph
+   * @param[in] values        values
+   * @return                  attributes of the factor
+   */
+  static inline std::vector<AttributeType> GetFactorAttributes(
+      const size_t idx, const gtsam::NonlinearFactorGraph& graph,
+      const gtsam::Values& values) {
     const gtsam::NonlinearFactor::shared_ptr& factor = graph.at(idx);
 
     std::vector<AttributeType> attributes;
@@ -420,40 +462,24 @@ class JsonSaver {
     // error
     attributes.emplace_back(Quoted("error"), GetError(factor, values));
 
-    return JsonDict(attributes);
+    return attributes;
   }
 
   /**
-   * @brief output the json format factor graph to ostream
+   * @brief output the json format factor graph to ostream, one variable or
+   * factor at a time, see JsonStreamWriter
    * @param[in] graph         gtsam factor graph
    * @param[in] stm           output stream
    * @param[in] values        gtsam values of variables
    * @param[in] locations     manually specify the location of variables
+   * @param[in] format        json document or newline delimited json
    */
   // TODO: add option to include GT values
   static inline void SaveFactorGraph(
       const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
       const gtsam::Values& values = gtsam::Values(),
-      const LocationType& locations = LocationType()) {
-    std::vector<std::string> variable_strings;
-    std::vector<std::string> factor_strings;
-
-    // add variables
-    for (gtsam::Key key : graph.keys()) {
-      variable_strings.push_back(GetVariable(key, values, locations));
-    }
-
-    // add factors
-    for (size_t i = 0; i < graph.size(); ++i) {
-      factor_strings.push_back(GetFactor(i, graph, values));
-    }
-
-    std::string s_variables = JsonList(variable_strings);
-    std::string s_factors = JsonList(factor_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
-  }
+      const LocationType& locations = LocationType(),
+      JsonFormat format = JsonFormat::kJson);
 
   /**
    * @brief get the gtsam variable value as a string in list format
@@ -496,98 +522,383 @@ class JsonSaver {
     return JsonList(value_types, -1);
   }
 
+  /**
+   * @brief output clusters of variables and factors in json format, e.g. one
+   * cluster per time step, written one cluster at a time
+   * @param[in] stm               output stream
+   * @param[in] clustered_graphs  factor graph of each factor cluster
+   * @param[in] clustered_values  values of each variable cluster
+   * @param[in] values            values used to evaluate cluster errors
+   * @param[in] locations         locations of the clusters
+   * @param[in] format            json document or newline delimited json
+   */
   static inline void SaveClusteredGraph(
       std::ostream& stm,
       const std::map<std::string, gtsam::NonlinearFactorGraph>&
           clustered_graphs,
       const std::map<std::string, gtsam::Values>& clustered_values,
       const gtsam::Values& values,
-      const StrLocationType& locations = StrLocationType()) {
-    // create map from key to value_cluster name for faster searching
-    std::map<gtsam::Key, std::string> key_to_cluster;
-    for (auto value_cluster : clustered_values) {
-      std::string cluster_name = value_cluster.first;
-      // std::cout << "value cluster: " << cluster_name << "\n";
-      for (const auto& key : value_cluster.second.keys()) {
-        key_to_cluster[key] = cluster_name;
-      }
+      const StrLocationType& locations = StrLocationType(),
+      JsonFormat format = JsonFormat::kJson);
+
+  /**
+   * @brief demangled name of the run-time type of a factor
+   * @param[in] factor        gtsam factor pointer
+   * @return                  e.g. "gtdynamics::PoseFactor"
+   */
+  static inline std::string GetTypeName(
+      const gtsam::NonlinearFactor::shared_ptr& factor) {
+    return boost::core::demangle(typeid(*factor).name());
+  }
+
+  /**
+   * @brief time step of a factor in summaries: the earliest time step of its
+   * variables
+   * @param[in] factor        gtsam factor pointer
+   * @return                  the time step, 0 for factors without variables
+   */
+  static inline uint64_t GetStep(
+      const gtsam::NonlinearFactor::shared_ptr& factor) {
+    uint64_t step = std::numeric_limits<uint64_t>::max();
+    for (gtsam::Key key : factor->keys()) {
+      step = std::min(step, DynamicsSymbol(key).time());
     }
+    return factor->keys().empty() ? 0 : step;
+  }
 
-    std::vector<std::string> values_strings;
-    std::vector<std::string> graphs_strings;
+  /**
+   * @brief output a level-of-detail summary of a multi-step factor graph, of
+   * size proportional to the number of time steps instead of the number of
+   * factors. The format is that of SaveFactorGraph, with one variable node
+   * per variable label and time step, e.g. "q_3" for all joint angles of
+   * step 3, and one factor node per factor type and time step (see GetStep).
+   * Nodes hold the number of members as "count" and their time step as
+   * "step"; factor nodes hold their summed "error" and the variable nodes
+   * they connect to.
+   * @param[in] graph         gtsam factor graph
+   * @param[in] stm           output stream
+   * @param[in] values        gtsam values used to evaluate the errors
+   * @param[in] chunk_name    if given, the name of the detailed file of a
+   * time step, stored as "chunk" in every node so that viewers can expand it
+   * @param[in] format        json document or newline delimited json
+   */
+  static inline void SaveSummarizedGraph(
+      const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
+      const gtsam::Values& values,
+      const std::function<std::string(uint64_t)>& chunk_name = nullptr,
+      JsonFormat format = JsonFormat::kJson);
+};
 
-    // add clustered values
-    for (const auto& it : clustered_values) {
-      std::string cluster_name = it.first;
-      const gtsam::Values& values = it.second;
+/**
+ * @brief
+ * Write json incrementally to a stream, so that memory stays bounded by the
+ * largest single item instead of the whole document. Lists are opened and
+ * closed explicitly, and dictionaries are written as soon as they are added.
+ *
+ * In JsonFormat::kJson the output is the same as building the document with
+ * JsonSaver::JsonList and JsonSaver::JsonDict. In JsonFormat::kNdJson lists
+ * are not written; each dictionary goes on its own line, compact, with a
+ * "section" attribute naming the innermost named list it was added to.
+ */
+class JsonStreamWriter {
+ public:
+  typedef JsonSaver::AttributeType AttributeType;
 
-      std::vector<AttributeType> attributes;
-      // name
-      attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+  /**
+   * @brief constructor
+   * @param[in] stm           output stream, must outlive the writer
+   * @param[in] format        json document or newline delimited json
+   */
+  explicit JsonStreamWriter(std::ostream& stm,
+                            JsonFormat format = JsonFormat::kJson)
+      : stm_(stm), format_(format) {}
 
-      // location
-      if (locations.find(cluster_name) != locations.end()) {
-        const auto loc_str = GetVector(locations.at(cluster_name));
-        attributes.emplace_back(Quoted("location"), loc_str);
-      }
+  /// Closes all lists that are still open.
+  ~JsonStreamWriter() { close(); }
+
+  JsonStreamWriter(const JsonStreamWriter&) = delete;
+  JsonStreamWriter& operator=(const JsonStreamWriter&) = delete;
+
+  /**
+   * @brief open a list, nested in the current one if any
+   * @param[in] name          section name of its dictionaries in kNdJson
+   */
+  void beginList(const std::string& name = "") {
+    if (format_ == JsonFormat::kJson) {
+      separate();
+      stm_ << "[";
+    }
+    const std::string section = name.empty() && !open_.empty()
+                                    ? open_.back().section
+                                    : name;
+    open_.push_back({section, 0});
+  }
+
+  /**
+   * @brief write a dictionary into the current list
+   * @param[in] attributes    key value pairs, keys already quoted
+   */
+  void addDict(const std::vector<AttributeType>& attributes) {
+    if (format_ == JsonFormat::kJson) {
+      separate();
+      stm_ << JsonSaver::JsonDict(attributes);
+      return;
+    }
+    std::vector<AttributeType> record;
+    if (!open_.empty() && !open_.back().section.empty()) {
+      record.emplace_back(JsonSaver::Quoted("section"),
+                          JsonSaver::Quoted(open_.back().section));
+    }
+    record.insert(record.end(), attributes.begin(), attributes.end());
 
-      // values
-      std::vector<std::string> varaible_names;
-      for (const gtsam::Key& key : values.keys()) {
-        varaible_names.emplace_back(GetName(key));
+    // A compact dictionary has no newlines of its own, so the remaining ones
+    // are inside strings (e.g. printed Eigen vectors) and must be escaped.
+    for (char c : JsonSaver::JsonDict(record, -1)) {
+      if (c == '\n') {
+        stm_ << "\\n";
+      } else {
+        stm_ << c;
       }
-      attributes.emplace_back(JsonSaver::Quoted("value"),
-                              Quoted(JsonList(varaible_names, -1)));
-      values_strings.emplace_back(JsonDict(attributes));
     }
+    stm_ << "\n";
+  }
+
+  /// Close the current list.
+  void endList() {
+    if (open_.empty()) {
+      throw std::runtime_error("JsonStreamWriter: no list to close");
+    }
+    if (format_ == JsonFormat::kJson) stm_ << "\n]";
+    open_.pop_back();
+  }
 
-    // add clustered graphs
-    for (const auto& it : clustered_graphs) {
-      std::string cluster_name = it.first;
-      const gtsam::NonlinearFactorGraph& graph = it.second;
+  /// Close all open lists and flush the stream.
+  void close() {
+    while (!open_.empty()) endList();
+    stm_.flush();
+  }
 
-      // std::cout << "graph cluster: " << cluster_name << "\tsize:" <<
-      // graph.size() << "\n";
+ private:
+  struct OpenList {
+    std::string section;
+    size_t num_items;
+  };
+
+  /// Write the separator before a new item of the current list.
+  void separate() {
+    if (open_.empty()) return;
+    stm_ << (open_.back().num_items++ > 0 ? ",\n" : "\n");
+  }
 
-      std::vector<AttributeType> attributes;
-      // name
-      attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+  std::ostream& stm_;
+  JsonFormat format_;
+  std::vector<OpenList> open_;
+};
 
-      // varaible clusters
-      std::set<std::string> values_cluster_names;
-      for (const auto& factor : graph) {
-        for (const auto& key : factor->keys()) {
-          values_cluster_names.insert(Quoted(key_to_cluster[key]));
-        }
-      }
-      std::vector<std::string> vec_cluster_names(values_cluster_names.begin(),
-                                                 values_cluster_names.end());
-      attributes.emplace_back(Quoted("variables"),
-                              JsonList(vec_cluster_names, -1));
-
-      // calculate errors
-      double error = 0;
-      for (const auto& factor : graph) {
-        error += factor->error(values);
-      }
-      attributes.emplace_back(Quoted("error"), std::to_string(error));
+/* ************************************************************************* */
+inline void JsonSaver::SaveFactorGraph(const gtsam::NonlinearFactorGraph& graph,
+                                       std::ostream& stm,
+                                       const gtsam::Values& values,
+                                       const LocationType& locations,
+                                       JsonFormat format) {
+  JsonStreamWriter writer(stm, format);
+  writer.beginList();
+
+  // add variables
+  writer.beginList("variables");
+  for (gtsam::Key key : graph.keys()) {
+    writer.addDict(GetVariableAttributes(key, values, locations));
+  }
+  writer.endList();
 
-      // location
-      if (locations.find(cluster_name) != locations.end()) {
-        const auto loc_str = GetVector(locations.at(cluster_name));
-        attributes.emplace_back(Quoted("location"), loc_str);
+  // add factors
+  writer.beginList("factors");
+  for (size_t i = 0; i < graph.size(); ++i) {
+    writer.addDict(GetFactorAttributes(i, graph, values));
+  }
+  writer.endList();
+
+  writer.close();
+}
+
+/* ************************************************************************* */
+inline void JsonSaver::SaveClusteredGraph(
+    std::ostream& stm,
+    const std::map<std::string, gtsam::NonlinearFactorGraph>& clustered_graphs,
+    const std::map<std::string, gtsam::Values>& clustered_values,
+    const gtsam::Values& values, const StrLocationType& locations,
+    JsonFormat format) {
+  // create map from key to value_cluster name for faster searching
+  std::map<gtsam::Key, std::string> key_to_cluster;
+  for (const auto& value_cluster : clustered_values) {
+    for (const auto& key : value_cluster.second.keys()) {
+      key_to_cluster[key] = value_cluster.first;
+    }
+  }
+
+  JsonStreamWriter writer(stm, format);
+  writer.beginList();
+
+  // add clustered values
+  writer.beginList("variables");
+  for (const auto& it : clustered_values) {
+    const std::string& cluster_name = it.first;
+
+    std::vector<AttributeType> attributes;
+    // name
+    attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+
+    // location
+    if (locations.find(cluster_name) != locations.end()) {
+      const auto loc_str = GetVector(locations.at(cluster_name));
+      attributes.emplace_back(Quoted("location"), loc_str);
+    }
+
+    // values
+    std::vector<std::string> variable_names;
+    for (const gtsam::Key& key : it.second.keys()) {
+      variable_names.emplace_back(GetName(key));
+    }
+    attributes.emplace_back(Quoted("value"),
+                            Quoted(JsonList(variable_names, -1)));
+    writer.addDict(attributes);
+  }
+  writer.endList();
+
+  // add clustered graphs
+  writer.beginList("factors");
+  for (const auto& it : clustered_graphs) {
+    const std::string& cluster_name = it.first;
+    const gtsam::NonlinearFactorGraph& graph = it.second;
+
+    std::vector<AttributeType> attributes;
+    // name
+    attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+
+    // variable clusters
+    std::set<std::string> values_cluster_names;
+    for (const auto& factor : graph) {
+      for (const auto& key : factor->keys()) {
+        values_cluster_names.insert(Quoted(key_to_cluster[key]));
       }
+    }
+    std::vector<std::string> vec_cluster_names(values_cluster_names.begin(),
+                                               values_cluster_names.end());
+    attributes.emplace_back(Quoted("variables"),
+                            JsonList(vec_cluster_names, -1));
+
+    // calculate errors
+    double error = 0;
+    for (const auto& factor : graph) {
+      error += factor->error(values);
+    }
+    attributes.emplace_back(Quoted("error"), std::to_string(error));
 
-      graphs_strings.emplace_back(JsonDict(attributes));
+    // location
+    if (locations.find(cluster_name) != locations.end()) {
+      const auto loc_str = GetVector(locations.at(cluster_name));
+      attributes.emplace_back(Quoted("location"), loc_str);
     }
 
-    std::string s_variables = JsonList(values_strings);
-    std::string s_factors = JsonList(graphs_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
+    writer.addDict(attributes);
   }
-};
+  writer.endList();
+
+  writer.close();
+}
+
+/* ************************************************************************* */
+inline void JsonSaver::SaveSummarizedGraph(
+    const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
+    const gtsam::Values& values,
+    const std::function<std::string(uint64_t)>& chunk_name,
+    JsonFormat format) {
+  // Names usable as html ids, as the viewer selects nodes by name.
+  auto node_name = [](const std::string& label, uint64_t step) {
+    std::string name;
+    for (char c : label) {
+      name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return name + "_" + std::to_string(step);
+  };
+
+  // Variable groups keyed on (step, label), with their member counts.
+  std::map<std::pair<uint64_t, std::string>, size_t> variable_groups;
+  std::map<std::string, size_t> rows;  // row of each label in the layout
+  for (gtsam::Key key : graph.keys()) {
+    const DynamicsSymbol symbol(key);
+    variable_groups[{symbol.time(), symbol.label()}]++;
+    rows.emplace(symbol.label(), 0);
+  }
+  size_t row = 0;
+  for (auto& it : rows) it.second = row++;
+
+  // Factor groups keyed on (step, type): count, error, variable groups.
+  struct FactorGroup {
+    size_t count = 0;
+    double error = 0;
+    std::set<std::string> variables;
+  };
+  std::map<std::pair<uint64_t, std::string>, FactorGroup> factor_groups;
+  for (const auto& factor : graph) {
+    if (!factor) continue;
+    FactorGroup& group = factor_groups[{GetStep(factor), GetTypeName(factor)}];
+    group.count++;
+    group.error += factor->error(values);
+    for (gtsam::Key key : factor->keys()) {
+      const DynamicsSymbol symbol(key);
+      group.variables.insert(Quoted(node_name(symbol.label(), symbol.time())));
+    }
+  }
+
+  auto add_common = [&](std::vector<AttributeType>* attributes,
+                        const std::string& name, uint64_t step,
+                        size_t count) {
+    attributes->emplace_back(Quoted("name"), Quoted(name));
+    attributes->emplace_back(Quoted("step"), std::to_string(step));
+    attributes->emplace_back(Quoted("count"), std::to_string(count));
+    if (chunk_name) {
+      attributes->emplace_back(Quoted("chunk"), Quoted(chunk_name(step)));
+    }
+  };
+
+  JsonStreamWriter writer(stm, format);
+  writer.beginList();
+
+  writer.beginList("variables");
+  for (const auto& it : variable_groups) {
+    const uint64_t step = it.first.first;
+    const std::string& label = it.first.second;
+    std::vector<AttributeType> attributes;
+    add_common(&attributes, node_name(label, step), step, it.second);
+    attributes.emplace_back(Quoted("label"), Quoted(label));
+    attributes.emplace_back(
+        Quoted("location"),
+        GetVector(gtsam::Vector3(double(step), double(rows[label]), 0)));
+    writer.addDict(attributes);
+  }
+  writer.endList();
+
+  writer.beginList("factors");
+  for (const auto& it : factor_groups) {
+    const uint64_t step = it.first.first;
+    const std::string& type = it.first.second;
+    const FactorGroup& group = it.second;
+    std::vector<AttributeType> attributes;
+    add_common(&attributes, node_name(type, step), step, group.count);
+    attributes.emplace_back(Quoted("type"), Quoted(type));
+    attributes.emplace_back(
+        Quoted("variables"),
+        JsonList(std::vector<std::string>(group.variables.begin(),
+                                          group.variables.end()),
+                 -1));
+    attributes.emplace_back(Quoted("error"), std::to_string(group.error));
+    writer.addDict(attributes);
+  }
+  writer.endList();
+
+  writer.close();
+}
 
 class StorageManager {
  private:
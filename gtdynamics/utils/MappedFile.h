@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MappedFile.h
+ * @brief Read-only view of a whole file, memory mapped where possible.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GTDYNAMICS_MMAP_FILES
+#endif
+
+namespace gtdynamics {
+
+/**
+ * Read-only view of a whole file. The file is memory mapped on platforms
+ * that support it, and read into a buffer otherwise or if mapping fails.
+ */
+class MappedFile {
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+#ifdef GTDYNAMICS_MMAP_FILES
+  void *mapping_ = nullptr;
+#endif
+  std::string buffer_;
+
+ public:
+  MappedFile() {}
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /// Open the file, returns false if it cannot be read.
+  bool open(const std::string &file_path) {
+#ifdef GTDYNAMICS_MMAP_FILES
+    const int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        mapping_ = p;
+        data_ = static_cast<const char *>(p);
+        size_ = st.st_size;
+      }
+    }
+    ::close(fd);
+    if (mapping_) return true;
+#endif
+    std::ifstream is(file_path, std::ios::binary);
+    if (!is.good()) return false;
+    buffer_.assign(std::istreambuf_iterator<char>(is),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+  }
+
+  ~MappedFile() {
+#ifdef GTDYNAMICS_MMAP_FILES
+    if (mapping_) ::munmap(mapping_, size_);
+#endif
+  }
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+};
+
+}  // namespace gtdynamics
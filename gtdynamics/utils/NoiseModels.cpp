@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.cpp
+ * @brief Interned noise models shared by all factors, and cheap whitening.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/NoiseModels.h>
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+using gtsam::SharedNoiseModel;
+using gtsam::Vector;
+namespace noiseModel = gtsam::noiseModel;
+
+namespace gtdynamics {
+
+namespace {
+// Models are keyed by their kind and parameters, so that e.g. a diagonal
+// model with equal sigmas stays distinct from an isotropic one.
+enum Kind { kIsotropic, kDiagonal, kConstrained };
+using RegistryKey = std::pair<int, std::vector<double>>;
+
+struct Registry {
+  std::mutex mutex;
+  std::map<RegistryKey, SharedNoiseModel> models;
+};
+
+Registry &GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+std::vector<double> Parameters(const Vector &v) {
+  return std::vector<double>(v.data(), v.data() + v.size());
+}
+
+// The registered model for key, created by create() if there is none.
+template <typename Create>
+SharedNoiseModel Intern(Kind kind, std::vector<double> &&parameters,
+                        Create &&create) {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  SharedNoiseModel &model =
+      registry.models[RegistryKey(kind, std::move(parameters))];
+  if (!model) model = create();
+  return model;
+}
+
+std::vector<double> ConstrainedParameters(
+    const noiseModel::Constrained &model) {
+  std::vector<double> parameters = Parameters(model.sigmas());
+  const Vector &mu = model.mu();
+  parameters.insert(parameters.end(), mu.data(), mu.data() + mu.size());
+  return parameters;
+}
+}  // namespace
+
+/* ************************************************************************* */
+noiseModel::Isotropic::shared_ptr SharedIsotropic(size_t dim, double sigma) {
+  return boost::static_pointer_cast<noiseModel::Isotropic>(
+      Intern(kIsotropic, {double(dim), sigma},
+             [&] { return noiseModel::Isotropic::Sigma(dim, sigma); }));
+}
+
+/* ************************************************************************* */
+noiseModel::Diagonal::shared_ptr SharedDiagonal(const Vector &sigmas) {
+  // Smart construction turns equal sigmas into an isotropic model and zero
+  // sigmas into a constrained one, so intern the result.
+  return boost::static_pointer_cast<noiseModel::Diagonal>(
+      InternNoiseModel(noiseModel::Diagonal::Sigmas(sigmas)));
+}
+
+/* ************************************************************************* */
+noiseModel::Constrained::shared_ptr SharedConstrained(size_t dim) {
+  const auto model = noiseModel::Constrained::All(dim);
+  return boost::static_pointer_cast<noiseModel::Constrained>(Intern(
+      kConstrained, ConstrainedParameters(*model), [&] { return model; }));
+}
+
+/* ************************************************************************* */
+noiseModel::Diagonal::shared_ptr RepeatedNoiseModel(
+    const SharedNoiseModel &scalar_model, size_t n) {
+  if (!scalar_model || scalar_model->dim() != 1 ||
+      !dynamic_cast<const noiseModel::Diagonal *>(scalar_model.get())) {
+    throw std::invalid_argument(
+        "RepeatedNoiseModel: needs a 1-dimensional diagonal noise model");
+  }
+  if (dynamic_cast<const noiseModel::Constrained *>(scalar_model.get())) {
+    return SharedConstrained(n);
+  }
+  return SharedIsotropic(n, scalar_model->sigmas()(0));
+}
+
+/* ************************************************************************* */
+SharedNoiseModel InternNoiseModel(const SharedNoiseModel &model) {
+  if (!model) return model;
+  const auto create = [&] { return model; };
+  if (auto constrained =
+          dynamic_cast<const noiseModel::Constrained *>(model.get())) {
+    return Intern(kConstrained, ConstrainedParameters(*constrained), create);
+  }
+  if (auto isotropic =
+          dynamic_cast<const noiseModel::Isotropic *>(model.get())) {
+    return Intern(kIsotropic, {double(model->dim()), isotropic->sigma()},
+                  create);
+  }
+  if (auto diagonal = dynamic_cast<const noiseModel::Diagonal *>(model.get())) {
+    return Intern(kDiagonal, Parameters(diagonal->sigmas()), create);
+  }
+  return model;
+}
+
+/* ************************************************************************* */
+size_t NumInternedNoiseModels() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.models.size();
+}
+
+/* ************************************************************************* */
+NoiseModelWhitener::NoiseModelWhitener(const SharedNoiseModel &model) {
+  if (!model) return;
+  const auto isotropic =
+      dynamic_cast<const noiseModel::Isotropic *>(model.get());
+  if (!isotropic) {
+    model_ = model;
+  } else if (!dynamic_cast<const noiseModel::Unit *>(model.get())) {
+    scale_ = 1.0 / isotropic->sigma();
+    unit_ = false;
+  }
+}
+
+/* ************************************************************************* */
+void NoiseModelWhitener::whitenSystem(std::vector<gtsam::Matrix> &H,
+                                      Vector &e) const {
+  if (model_) {
+    model_->WhitenSystem(H, e);
+  } else if (!unit_) {
+    for (gtsam::Matrix &Hi : H) Hi *= scale_;
+    e *= scale_;
+  }
+}
+
+}  // namespace gtdynamics
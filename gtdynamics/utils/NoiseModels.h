@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.h
+ * @brief Interned noise models shared by all factors, and cheap whitening.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/linear/NoiseModel.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Noise models are immutable, so factors with equal models can share one
+ * instance. The functions below return the same model for equal arguments,
+ * from a process-wide registry that never shrinks: use them for the models
+ * of settings and graph builders, not for models that change every
+ * iteration, e.g. with a penalty parameter.
+ */
+
+/// Isotropic model with the given dimension and sigma, Unit if sigma is 1.
+gtsam::noiseModel::Isotropic::shared_ptr SharedIsotropic(size_t dim,
+                                                         double sigma);
+
+/// Diagonal model with the given sigmas, as noiseModel::Diagonal::Sigmas.
+gtsam::noiseModel::Diagonal::shared_ptr SharedDiagonal(
+    const gtsam::Vector &sigmas);
+
+/// Hard constraint of the given dimension, as noiseModel::Constrained::All.
+gtsam::noiseModel::Constrained::shared_ptr SharedConstrained(size_t dim);
+
+/**
+ * Diagonal model of dimension n with the sigma of a 1-dimensional diagonal
+ * model in every entry, for block factors that stack n scalar factors with
+ * the same model. Throws std::invalid_argument for other models.
+ */
+gtsam::noiseModel::Diagonal::shared_ptr RepeatedNoiseModel(
+    const gtsam::SharedNoiseModel &scalar_model, size_t n);
+
+/**
+ * The registered model equal to an isotropic, diagonal or constrained model,
+ * registering model itself if there is none. Other models, e.g. robust ones,
+ * are returned unchanged.
+ */
+gtsam::SharedNoiseModel InternNoiseModel(const gtsam::SharedNoiseModel &model);
+
+/// Number of models in the registry.
+size_t NumInternedNoiseModels();
+
+/**
+ * Whitening of a noise model, precomputed for isotropic and unit models, to
+ * a scale or nothing, without the virtual calls. Other models whiten as
+ * usual. A null model does not whiten.
+ */
+class NoiseModelWhitener {
+ private:
+  gtsam::SharedNoiseModel model_;  // only kept for non-isotropic models
+  double scale_ = 1.0;             // 1/sigma for isotropic models
+  bool unit_ = true;
+
+ public:
+  NoiseModelWhitener() = default;
+
+  /// Constructor from the model of a factor.
+  explicit NoiseModelWhitener(const gtsam::SharedNoiseModel &model);
+
+  /// Whether whitening does nothing.
+  bool isUnit() const { return unit_ && !model_; }
+
+  /// Whitened error.
+  gtsam::Vector whiten(const gtsam::Vector &e) const {
+    if (model_) return model_->whiten(e);
+    return unit_ ? e : gtsam::Vector(scale_ * e);
+  }
+
+  /// Whiten Jacobians and error in place, as noiseModel::Base::WhitenSystem.
+  void whitenSystem(std::vector<gtsam::Matrix> &H, gtsam::Vector &e) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Parallel.h
+ * @brief Minimal thread-parallel loop used to build independent sub-problems.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/Executor.h>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Call f(i) for every i in [0, n), using up to num_threads threads of the
+ * shared Executor, including the calling thread, that pick the next index as
+ * they become free. Calls must be independent; results are deterministic as
+ * long as f(i) only writes to slot i of its output. Exceptions thrown by f
+ * are rethrown in the calling thread.
+ *
+ * @param n           number of iterations
+ * @param num_threads number of threads, 0 for all threads of the executor,
+ * see SetExecutorThreads
+ * @param f           loop body
+ */
+inline void ParallelFor(size_t n, size_t num_threads,
+                        const std::function<void(size_t)> &f) {
+  const std::shared_ptr<Executor> executor = Executor::Shared();
+  const size_t max_threads = executor->numWorkers() + 1;
+  if (num_threads == 0 || num_threads > max_threads) num_threads = max_threads;
+  num_threads = std::min(num_threads, n);
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < n; i++) f(i);
+    return;
+  }
+  executor->parallelFor(n, num_threads - 1, f);
+}
+
+/**
+ * Combine map(i) for every i in [0, n) in parallel, see ParallelFor. With
+ * deterministic, the indices are split into blocks that do not depend on the
+ * number of threads, and the blocks are combined in order, so the result is
+ * the same for any number of threads. Otherwise there are a few blocks per
+ * thread, combined as they complete, which for floating-point sums can
+ * change the last bits from run to run.
+ *
+ * @param n             number of iterations
+ * @param num_threads   number of threads, 0 for all threads of the executor
+ * @param deterministic whether the result may not depend on scheduling
+ * @param identity      identity of combine
+ * @param map           value of an index; may be called concurrently
+ * @param combine       associative combination of two values
+ */
+template <class T>
+T ParallelReduce(size_t n, size_t num_threads, bool deterministic,
+                 const T &identity, const std::function<T(size_t)> &map,
+                 const std::function<T(const T &, const T &)> &combine) {
+  constexpr size_t kDeterministicBlocks = 256, kBlocksPerThread = 4;
+  const size_t threads = num_threads ? num_threads : ExecutorThreads();
+  const size_t num_blocks = std::min(
+      n, deterministic ? kDeterministicBlocks : kBlocksPerThread * threads);
+  auto reduce_block = [&](size_t b) {
+    T partial = identity;
+    for (size_t i = b * n / num_blocks; i < (b + 1) * n / num_blocks; i++) {
+      partial = combine(partial, map(i));
+    }
+    return partial;
+  };
+
+  T result = identity;
+  if (deterministic) {
+    std::vector<T> partials(num_blocks, identity);
+    ParallelFor(num_blocks, num_threads,
+                [&](size_t b) { partials[b] = reduce_block(b); });
+    for (auto &&partial : partials) result = combine(result, partial);
+  } else {
+    std::mutex mutex;
+    ParallelFor(num_blocks, num_threads, [&](size_t b) {
+      const T partial = reduce_block(b);
+      std::lock_guard<std::mutex> lock(mutex);
+      result = combine(result, partial);
+    });
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
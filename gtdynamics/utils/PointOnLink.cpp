@@ -12,6 +12,9 @@
  */
 
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -21,6 +24,40 @@ gtsam::Point3 PointOnLink::predict(const gtsam::Values &values,
   return wTcom.transformFrom(point);
 }
 
+PointOnLinksPrediction PredictPoints(const PointOnLinks &points,
+                                     const TrajectoryBuffer &buffer,
+                                     size_t k_start, size_t k_end,
+                                     bool jacobians) {
+  if (k_start > k_end || k_end > buffer.numSteps()) {
+    throw std::out_of_range("PredictPoints: time steps beyond the buffer");
+  }
+  PointOnLinksPrediction prediction;
+  prediction.k_start = k_start;
+  prediction.num_steps = k_end - k_start;
+  prediction.num_points = points.size();
+  const size_t n = prediction.num_steps;
+  prediction.positions.resize(3, points.size() * n);
+  if (jacobians) prediction.jacobians.resize(3, 6 * points.size() * n);
+
+  for (size_t i = 0; i < points.size(); i++) {
+    const gtsam::Point3 &p = points[i].point;
+    const gtsam::Matrix3 skew = gtsam::skewSymmetric(-p);
+    // The poses of one link are contiguous in the buffer.
+    const gtsam::Pose3 *wTcom = &buffer.pose(points[i].link->id(), k_start);
+    for (size_t k = 0; k < n; k++) {
+      const gtsam::Matrix3 R = wTcom[k].rotation().matrix();
+      const size_t c = i * n + k;
+      prediction.positions.col(c) = R * p + wTcom[k].translation();
+      if (jacobians) {
+        // Same as Pose3::transformFrom: [R * skew(-p), R].
+        prediction.jacobians.block<3, 3>(0, 6 * c) = R * skew;
+        prediction.jacobians.block<3, 3>(0, 6 * c + 3) = R;
+      }
+    }
+  }
+  return prediction;
+}
+
 std::ostream &operator<<(std::ostream &os, const PointOnLink &cp) {
   os << "{" << cp.link->name() << ", [" << cp.point.transpose() << "]}";
   return os;
@@ -14,11 +14,13 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtsam/base/Matrix.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/geometry/Point3.h>
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -61,6 +63,45 @@ struct PointOnLink {
 ///< Vector of `PointOnLink`s
 using PointOnLinks = std::vector<PointOnLink>;
 
+class TrajectoryBuffer;
+
+/**
+ * World positions of points on links over consecutive time steps, and
+ * optionally their 3x6 Jacobians w.r.t. the link CoM poses, as
+ * Pose3::transformFrom computes them. Columns are point-major: the time
+ * series of a point is contiguous.
+ */
+struct PointOnLinksPrediction {
+  size_t k_start = 0, num_steps = 0, num_points = 0;
+  gtsam::Matrix positions;  ///< 3 x (num_points * num_steps)
+  gtsam::Matrix jacobians;  ///< 3 x (6 * num_points * num_steps), or empty
+
+  /// World position of point i at time step k.
+  gtsam::Point3 position(size_t i, size_t k) const {
+    return positions.col(i * num_steps + k - k_start);
+  }
+
+  /// Jacobian of the position of point i at step k w.r.t. its link pose.
+  gtsam::Matrix36 jacobian(size_t i, size_t k) const {
+    return jacobians.block<3, 6>(0, 6 * (i * num_steps + k - k_start));
+  }
+};
+
+/**
+ * Predict where points on links are in the world frame, as
+ * PointOnLink::predict does, for all points at time steps [k_start, k_end)
+ * at once, reading the contiguous pose series of a TrajectoryBuffer.
+ * @param points    points on links of the robot of the buffer
+ * @param buffer    trajectory with link poses
+ * @param k_start   first time step
+ * @param k_end     one past the last time step, at most buffer.numSteps()
+ * @param jacobians whether to also compute the Jacobians
+ */
+PointOnLinksPrediction PredictPoints(const PointOnLinks &points,
+                                     const TrajectoryBuffer &buffer,
+                                     size_t k_start, size_t k_end,
+                                     bool jacobians = false);
+
 }  // namespace gtdynamics
 
 namespace gtsam {
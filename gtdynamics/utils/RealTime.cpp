@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RealTime.cpp
+ * @brief Real-time mode, with diagnostics in a preallocated lock-free ring.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/RealTime.h>
+
+#include <chrono>
+#include <iostream>
+
+namespace gtdynamics {
+
+namespace {
+
+std::atomic<bool> real_time_mode(false);
+
+}  // namespace
+
+/* ************************************************************************* */
+DiagnosticRing::DiagnosticRing(size_t capacity) : head_(0) {
+  size_t size = 1;
+  while (size < capacity) size *= 2;
+  mask_ = size - 1;
+  slots_.reset(new Slot[size]);
+  for (size_t i = 0; i < size; i++) slots_[i].sequence.store(0);
+}
+
+/* ************************************************************************* */
+void DiagnosticRing::push(const char *message, gtsam::Key key) noexcept {
+  const uint64_t n = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = slots_[n & mask_];
+  slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.record.sequence = n;
+  slot.record.time_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  slot.record.message = message;
+  slot.record.key = key;
+  slot.sequence.store(2 * n + 2, std::memory_order_release);
+}
+
+/* ************************************************************************* */
+bool DiagnosticRing::pop(DiagnosticRecord *record) noexcept {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  while (tail_ < head) {
+    // Records more than a ring behind the head were overwritten.
+    if (head - tail_ > capacity()) {
+      dropped_ += head - capacity() - tail_;
+      tail_ = head - capacity();
+    }
+    const Slot &slot = slots_[tail_ & mask_];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence < 2 * tail_ + 2) return false;  // still being written
+    if (sequence == 2 * tail_ + 2) {
+      *record = slot.record;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+        tail_++;
+        return true;
+      }
+    }
+    // Overwritten by a later record.
+    dropped_++;
+    tail_++;
+  }
+  return false;
+}
+
+/* ************************************************************************* */
+void SetRealTimeMode(bool enabled) {
+  Diagnostics();  // allocate the ring before the control loop
+  real_time_mode.store(enabled);
+}
+
+/* ************************************************************************* */
+bool RealTimeMode() { return real_time_mode.load(std::memory_order_relaxed); }
+
+/* ************************************************************************* */
+DiagnosticRing &Diagnostics() {
+  static DiagnosticRing ring;
+  return ring;
+}
+
+/* ************************************************************************* */
+void ReportDiagnostic(const char *message, gtsam::Key key) {
+  if (RealTimeMode()) {
+    Diagnostics().push(message, key);
+  } else {
+    std::cerr << message << _GTDKeyFormatter(key) << '\n';
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RealTime.h
+ * @brief Real-time mode, with diagnostics in a preallocated lock-free ring.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace gtdynamics {
+
+/// A diagnostic reported by the library.
+struct DiagnosticRecord {
+  uint64_t sequence = 0;  // number of the record, from 0
+  int64_t time_ns = 0;    // steady clock time of the report
+  const char *message = nullptr;  // static string
+  gtsam::Key key = 0;     // key the diagnostic is about, if any
+};
+
+/**
+ * DiagnosticRing is a fixed-capacity ring of diagnostics, allocated once.
+ * Any number of threads push records without locks, allocations or system
+ * calls, and one thread pops them, e.g. to log them outside of the control
+ * loop. When the ring is full the oldest records are overwritten: pop skips
+ * them and counts them as dropped.
+ */
+class DiagnosticRing {
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence;  // 2 n + 1 while record n is written
+    DiagnosticRecord record;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_;  // records pushed
+  uint64_t tail_ = 0;           // records popped or dropped
+  uint64_t dropped_ = 0;
+
+ public:
+  /// Constructor, with capacity rounded up to a power of two.
+  explicit DiagnosticRing(size_t capacity = 1024);
+
+  DiagnosticRing(const DiagnosticRing &) = delete;
+  DiagnosticRing &operator=(const DiagnosticRing &) = delete;
+
+  /// Number of records kept.
+  size_t capacity() const { return mask_ + 1; }
+
+  /// Add a record, from any thread; message must be a static string.
+  void push(const char *message, gtsam::Key key = 0) noexcept;
+
+  /// Take the oldest record not yet taken, from one thread only.
+  bool pop(DiagnosticRecord *record) noexcept;
+
+  /// Number of records pushed.
+  uint64_t numPushed() const { return head_.load(); }
+
+  /// Number of records overwritten before they were popped.
+  uint64_t numDropped() const { return dropped_; }
+};
+
+/**
+ * Enable real-time mode. In real-time mode the library reports diagnostics
+ * to Diagnostics() instead of writing them to std::cerr, so that calling it
+ * from a control loop neither blocks on output nor allocates.
+ *
+ * The array versions of ArticulatedBodyForwardDynamics::solve,
+ * NewtonEulerInverseDynamics::solve and CompositeRigidBodyDynamics::solve,
+ * solveMassMatrix and solveGravityForces, and of
+ * GenericRobotKernels::forwardKinematics, do not allocate once the objects
+ * and output vectors are constructed, in either mode. Errors are still
+ * reported with exceptions, which do allocate.
+ */
+void SetRealTimeMode(bool enabled);
+
+/// Whether real-time mode is enabled.
+bool RealTimeMode();
+
+/// The ring real-time diagnostics are reported to.
+DiagnosticRing &Diagnostics();
+
+/**
+ * Report a diagnostic: to Diagnostics() in real-time mode, otherwise to
+ * std::cerr, followed by the formatted key.
+ * @param message static string
+ * @param key     key the diagnostic is about
+ */
+void ReportDiagnostic(const char *message, gtsam::Key key);
+
+}  // namespace gtdynamics
@@ -0,0 +1,331 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SE3Batch.cpp
+ * @brief SE(3) operations on batches of poses, twists and wrenches, stored
+ * as structures of arrays.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/SE3Batch.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix3;
+using gtsam::Pose3;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+namespace {
+
+// Column k of a batch as an array, for coefficient-wise operations.
+template <class M>
+Eigen::Map<const ScalarBatchT<typename M::Scalar>> Col(const M &m, int k) {
+  return Eigen::Map<const ScalarBatchT<typename M::Scalar>>(
+      m.data() + k * m.rows(), m.rows());
+}
+
+template <class M>
+Eigen::Map<ScalarBatchT<typename M::Scalar>> Col(M *m, int k) {
+  return Eigen::Map<ScalarBatchT<typename M::Scalar>>(
+      m->data() + k * m->rows(), m->rows());
+}
+
+// Columns of rotation entry (r, c) and translation entry r.
+inline int R(int r, int c) { return 3 * r + c; }
+inline int T(int r) { return 9 + r; }
+
+void CheckSizes(const char *function, Eigen::Index a, Eigen::Index b) {
+  if (a != b) {
+    throw std::invalid_argument(std::string(function) +
+                                ": batches must have the same size");
+  }
+}
+
+// Set the rotations to I + a K + b K^2 and the translations to t, for
+// batches of skew-symmetric K given as the arrays of its entries.
+template <typename Scalar>
+void SetPoses(const ScalarBatchT<Scalar> &a, const ScalarBatchT<Scalar> &b,
+              const ScalarBatchT<Scalar> (&K)[9],
+              const ScalarBatchT<Scalar> (&K2)[9],
+              const ScalarBatchT<Scalar> (&t)[3], PoseBatchT<Scalar> *poses) {
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      Col(poses, R(r, c)) =
+          a * K[R(r, c)] + b * K2[R(r, c)] + Scalar(r == c ? 1 : 0);
+    }
+    Col(poses, T(r)) = t[r];
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchIdentity(size_t n) {
+  PoseBatchT<Scalar> poses = PoseBatchT<Scalar>::Zero(n, 12);
+  for (int r = 0; r < 3; r++) Col(&poses, R(r, r)).setOnes();
+  return poses;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchFromPoses(const std::vector<Pose3> &poses) {
+  PoseBatchT<Scalar> batch(poses.size(), 12);
+  for (size_t n = 0; n < poses.size(); n++) SetBatchPose(&batch, n, poses[n]);
+  return batch;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+Pose3 BatchPose(const PoseBatchT<Scalar> &batch, size_t n) {
+  Matrix3 rotation;
+  for (int r = 0; r < 3; r++)
+    for (int c = 0; c < 3; c++) rotation(r, c) = batch(n, R(r, c));
+  return Pose3(gtsam::Rot3(rotation),
+               Vector3(batch(n, T(0)), batch(n, T(1)), batch(n, T(2))));
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void SetBatchPose(PoseBatchT<Scalar> *batch, size_t n, const Pose3 &pose) {
+  const Matrix3 rotation = pose.rotation().matrix();
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) (*batch)(n, R(r, c)) = Scalar(rotation(r, c));
+    (*batch)(n, T(r)) = Scalar(pose.translation()(r));
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const PoseBatchT<Scalar> &a,
+                                const PoseBatchT<Scalar> &b) {
+  CheckSizes("BatchCompose", a.rows(), b.rows());
+  PoseBatchT<Scalar> ab(a.rows(), 12);
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      Col(&ab, R(r, c)) = Col(a, R(r, 0)) * Col(b, R(0, c)) +
+                          Col(a, R(r, 1)) * Col(b, R(1, c)) +
+                          Col(a, R(r, 2)) * Col(b, R(2, c));
+    }
+    Col(&ab, T(r)) = Col(a, R(r, 0)) * Col(b, T(0)) +
+                     Col(a, R(r, 1)) * Col(b, T(1)) +
+                     Col(a, R(r, 2)) * Col(b, T(2)) + Col(a, T(r));
+  }
+  return ab;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const Pose3 &a, const PoseBatchT<Scalar> &b) {
+  const Eigen::Matrix<Scalar, 3, 3> Ra = a.rotation().matrix().cast<Scalar>();
+  const Eigen::Matrix<Scalar, 3, 1> ta = a.translation().cast<Scalar>();
+  PoseBatchT<Scalar> ab(b.rows(), 12);
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      Col(&ab, R(r, c)) = Ra(r, 0) * Col(b, R(0, c)) +
+                          Ra(r, 1) * Col(b, R(1, c)) +
+                          Ra(r, 2) * Col(b, R(2, c));
+    }
+    Col(&ab, T(r)) = Ra(r, 0) * Col(b, T(0)) + Ra(r, 1) * Col(b, T(1)) +
+                     Ra(r, 2) * Col(b, T(2)) + ta(r);
+  }
+  return ab;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const PoseBatchT<Scalar> &a, const Pose3 &b) {
+  const Eigen::Matrix<Scalar, 3, 3> Rb = b.rotation().matrix().cast<Scalar>();
+  const Eigen::Matrix<Scalar, 3, 1> tb = b.translation().cast<Scalar>();
+  PoseBatchT<Scalar> ab(a.rows(), 12);
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      Col(&ab, R(r, c)) = Col(a, R(r, 0)) * Rb(0, c) +
+                          Col(a, R(r, 1)) * Rb(1, c) +
+                          Col(a, R(r, 2)) * Rb(2, c);
+    }
+    Col(&ab, T(r)) = Col(a, R(r, 0)) * tb(0) + Col(a, R(r, 1)) * tb(1) +
+                     Col(a, R(r, 2)) * tb(2) + Col(a, T(r));
+  }
+  return ab;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchInverse(const PoseBatchT<Scalar> &poses) {
+  PoseBatchT<Scalar> inverse(poses.rows(), 12);
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) Col(&inverse, R(r, c)) = Col(poses, R(c, r));
+    // -R^T t
+    Col(&inverse, T(r)) = -(Col(poses, R(0, r)) * Col(poses, T(0)) +
+                            Col(poses, R(1, r)) * Col(poses, T(1)) +
+                            Col(poses, R(2, r)) * Col(poses, T(2)));
+  }
+  return inverse;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+TwistBatchT<Scalar> BatchAdjoint(const PoseBatchT<Scalar> &poses,
+                                 const TwistBatchT<Scalar> &twists) {
+  CheckSizes("BatchAdjoint", poses.rows(), twists.rows());
+  // Ad(T) (w, v) = (R w, t x R w + R v).
+  TwistBatchT<Scalar> result(poses.rows(), 6);
+  for (int r = 0; r < 3; r++) {
+    Col(&result, r) = Col(poses, R(r, 0)) * Col(twists, 0) +
+                      Col(poses, R(r, 1)) * Col(twists, 1) +
+                      Col(poses, R(r, 2)) * Col(twists, 2);
+    Col(&result, 3 + r) = Col(poses, R(r, 0)) * Col(twists, 3) +
+                          Col(poses, R(r, 1)) * Col(twists, 4) +
+                          Col(poses, R(r, 2)) * Col(twists, 5);
+  }
+  for (int r = 0; r < 3; r++) {
+    const int r1 = (r + 1) % 3, r2 = (r + 2) % 3;
+    Col(&result, 3 + r) += Col(poses, T(r1)) * Col(result, r2) -
+                           Col(poses, T(r2)) * Col(result, r1);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+TwistBatchT<Scalar> BatchAdjointTranspose(
+    const PoseBatchT<Scalar> &poses, const TwistBatchT<Scalar> &wrenches) {
+  CheckSizes("BatchAdjointTranspose", poses.rows(), wrenches.rows());
+  // Ad(T)^T (m, f) = (R^T (m - t x f), R^T f).
+  ScalarBatchT<Scalar> u[3];
+  for (int r = 0; r < 3; r++) {
+    const int r1 = (r + 1) % 3, r2 = (r + 2) % 3;
+    u[r] = Col(wrenches, r) - (Col(poses, T(r1)) * Col(wrenches, 3 + r2) -
+                               Col(poses, T(r2)) * Col(wrenches, 3 + r1));
+  }
+  TwistBatchT<Scalar> result(poses.rows(), 6);
+  for (int r = 0; r < 3; r++) {
+    Col(&result, r) = Col(poses, R(0, r)) * u[0] +
+                      Col(poses, R(1, r)) * u[1] + Col(poses, R(2, r)) * u[2];
+    Col(&result, 3 + r) = Col(poses, R(0, r)) * Col(wrenches, 3) +
+                          Col(poses, R(1, r)) * Col(wrenches, 4) +
+                          Col(poses, R(2, r)) * Col(wrenches, 5);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchExpmap(const TwistBatchT<Scalar> &twists) {
+  typedef ScalarBatchT<Scalar> Array;
+  const Eigen::Index n = twists.rows();
+  const Array w[3] = {Col(twists, 0), Col(twists, 1), Col(twists, 2)};
+  const Array theta2 = w[0].square() + w[1].square() + w[2].square();
+
+  // R = I + A W + B W^2 and t = (I + B W + C W^2) v for W = [w], with the
+  // Taylor expansions of A, B and C near zero. The threshold scales with the
+  // precision, below it C = (theta - sin) / theta^3 would lose all digits.
+  const Scalar eps = std::sqrt(Eigen::NumTraits<Scalar>::epsilon());
+  const auto small = theta2 < eps;
+  const Array theta = small.select(Scalar(1), theta2.sqrt());
+  const Array s = theta.sin(), omc = Scalar(1) - theta.cos();
+  const Array A = small.select(Scalar(1) - theta2 / Scalar(6), s / theta);
+  const Array B =
+      small.select(Scalar(0.5) - theta2 / Scalar(24), omc / theta.square());
+  const Array C = small.select(Scalar(1.0 / 6.0) - theta2 / Scalar(120),
+                               (theta - s) / theta.cube());
+
+  const Array zero = Array::Zero(n);
+  const Array W[9] = {zero, -w[2], w[1], w[2], zero, -w[0], -w[1], w[0], zero};
+  Array W2[9];
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      W2[R(r, c)] = w[r] * w[c];
+      if (r == c) W2[R(r, c)] -= theta2;
+    }
+  }
+
+  Array t[3];
+  for (int r = 0; r < 3; r++) {
+    t[r] = Col(twists, 3 + r);
+    for (int k = 0; k < 3; k++) {
+      t[r] += (B * W[R(r, k)] + C * W2[R(r, k)]) * Col(twists, 3 + k);
+    }
+  }
+  PoseBatchT<Scalar> poses(n, 12);
+  SetPoses(A, B, W, W2, t, &poses);
+  return poses;
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchExpmap(const gtsam::Vector6 &S,
+                               const ScalarBatchT<Scalar> &q) {
+  typedef ScalarBatchT<Scalar> Array;
+  const Eigen::Index n = q.size();
+  const Vector3 w = S.head<3>(), v = S.tail<3>();
+  const double norm = w.norm();
+  PoseBatchT<Scalar> poses = BatchIdentity<Scalar>(n);
+  if (norm < 1e-12) {
+    for (int r = 0; r < 3; r++) Col(&poses, T(r)) = Scalar(v(r)) * q;
+    return poses;
+  }
+
+  // With K = [w / |w|] and phi = |w| q, R = I + sin(phi) K + (1 - cos) K^2,
+  // t = q v + (1 - cos(phi)) / |w| K v + (phi - sin(phi)) / |w| K^2 v.
+  const Matrix3 K = gtsam::skewSymmetric(w / norm), K2 = K * K;
+  const Vector3 Kv = K * v / norm, K2v = K2 * v / norm;
+  const Array phi = Scalar(norm) * q;
+  const Array s = phi.sin(), omc = Scalar(1) - phi.cos();
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 3; c++) {
+      Col(&poses, R(r, c)) = Scalar(K(r, c)) * s + Scalar(K2(r, c)) * omc +
+                             Scalar(r == c ? 1 : 0);
+    }
+    Col(&poses, T(r)) = Scalar(v(r)) * q + Scalar(Kv(r)) * omc +
+                        Scalar(K2v(r)) * (phi - s);
+  }
+  return poses;
+}
+
+/* ************************************************************************* */
+const char *BatchSimdInstructionSets() {
+  return Eigen::SimdInstructionSetsInUse();
+}
+
+// Instantiate all operations in single and double precision.
+#define GTDYNAMICS_INSTANTIATE_SE3_BATCH(Scalar)                             \
+  template PoseBatchT<Scalar> BatchIdentity<Scalar>(size_t);                 \
+  template PoseBatchT<Scalar> BatchFromPoses<Scalar>(                        \
+      const std::vector<Pose3> &);                                           \
+  template Pose3 BatchPose<Scalar>(const PoseBatchT<Scalar> &, size_t);      \
+  template void SetBatchPose<Scalar>(PoseBatchT<Scalar> *, size_t,           \
+                                     const Pose3 &);                         \
+  template PoseBatchT<Scalar> BatchCompose<Scalar>(                          \
+      const PoseBatchT<Scalar> &, const PoseBatchT<Scalar> &);               \
+  template PoseBatchT<Scalar> BatchCompose<Scalar>(                          \
+      const Pose3 &, const PoseBatchT<Scalar> &);                            \
+  template PoseBatchT<Scalar> BatchCompose<Scalar>(                          \
+      const PoseBatchT<Scalar> &, const Pose3 &);                            \
+  template PoseBatchT<Scalar> BatchInverse<Scalar>(                          \
+      const PoseBatchT<Scalar> &);                                           \
+  template TwistBatchT<Scalar> BatchAdjoint<Scalar>(                         \
+      const PoseBatchT<Scalar> &, const TwistBatchT<Scalar> &);              \
+  template TwistBatchT<Scalar> BatchAdjointTranspose<Scalar>(                \
+      const PoseBatchT<Scalar> &, const TwistBatchT<Scalar> &);              \
+  template PoseBatchT<Scalar> BatchExpmap<Scalar>(                           \
+      const TwistBatchT<Scalar> &);                                          \
+  template PoseBatchT<Scalar> BatchExpmap<Scalar>(                           \
+      const gtsam::Vector6 &, const ScalarBatchT<Scalar> &);
+
+GTDYNAMICS_INSTANTIATE_SE3_BATCH(double)
+GTDYNAMICS_INSTANTIATE_SE3_BATCH(float)
+
+#undef GTDYNAMICS_INSTANTIATE_SE3_BATCH
+
+}  // namespace gtdynamics
@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SE3Batch.h
+ * @brief SE(3) operations on batches of poses, twists and wrenches, stored
+ * as structures of arrays.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * N poses as an N x 12 matrix: column k holds entry k of every pose, with the
+ * row-major rotation in columns 0-8 and the translation in columns 9-11, the
+ * layout of BatchForwardKinematics::poses. Every operation below is a
+ * sequence of coefficient-wise products and sums of whole columns, which
+ * Eigen vectorizes with the SIMD instructions the library is compiled for,
+ * e.g. AVX2 or AVX-512 with GTSAM_BUILD_WITH_MARCH_NATIVE, or NEON on ARM.
+ *
+ * Operations are instantiated for double and float. Single precision fits
+ * twice as many poses in a SIMD register, which suits sampling workloads
+ * such as workspace or collision screening that tolerate errors of ~1e-6.
+ */
+template <typename Scalar>
+using PoseBatchT = Eigen::Matrix<Scalar, Eigen::Dynamic, 12>;
+
+/// N twists (w, v) or wrenches (m, f), as an N x 6 matrix.
+template <typename Scalar>
+using TwistBatchT = Eigen::Matrix<Scalar, Eigen::Dynamic, 6>;
+
+/// N scalars, e.g. joint angles.
+template <typename Scalar>
+using ScalarBatchT = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+typedef PoseBatchT<double> PoseBatch;
+typedef PoseBatchT<float> PoseBatchf;
+typedef TwistBatchT<double> TwistBatch;
+typedef TwistBatchT<float> TwistBatchf;
+
+/// N identity poses.
+template <typename Scalar = double>
+PoseBatchT<Scalar> BatchIdentity(size_t n);
+
+/// Poses as a batch.
+template <typename Scalar = double>
+PoseBatchT<Scalar> BatchFromPoses(const std::vector<gtsam::Pose3> &poses);
+
+/// Pose n of a batch.
+template <typename Scalar>
+gtsam::Pose3 BatchPose(const PoseBatchT<Scalar> &batch, size_t n);
+
+/// Set pose n of a batch.
+template <typename Scalar>
+void SetBatchPose(PoseBatchT<Scalar> *batch, size_t n,
+                  const gtsam::Pose3 &pose);
+
+/// Compose every pose of a with the pose of b with the same index.
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const PoseBatchT<Scalar> &a,
+                                const PoseBatchT<Scalar> &b);
+
+/// Compose one pose with every pose of b.
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const gtsam::Pose3 &a,
+                                const PoseBatchT<Scalar> &b);
+
+/// Compose every pose of a with one pose.
+template <typename Scalar>
+PoseBatchT<Scalar> BatchCompose(const PoseBatchT<Scalar> &a,
+                                const gtsam::Pose3 &b);
+
+/// Inverse of every pose.
+template <typename Scalar>
+PoseBatchT<Scalar> BatchInverse(const PoseBatchT<Scalar> &poses);
+
+/// Ad(T) * xi for every pose T and twist xi, as Pose3::Adjoint.
+template <typename Scalar>
+TwistBatchT<Scalar> BatchAdjoint(const PoseBatchT<Scalar> &poses,
+                                 const TwistBatchT<Scalar> &twists);
+
+/// Ad(T)^T * F for every pose T and wrench F, as Pose3::AdjointTranspose.
+template <typename Scalar>
+TwistBatchT<Scalar> BatchAdjointTranspose(const PoseBatchT<Scalar> &poses,
+                                          const TwistBatchT<Scalar> &wrenches);
+
+/// Exponential map of every twist, as Pose3::Expmap.
+template <typename Scalar>
+PoseBatchT<Scalar> BatchExpmap(const TwistBatchT<Scalar> &twists);
+
+/**
+ * exp(S * q) for one screw axis S and N scalars q, e.g. the motion of a
+ * joint at N joint angles: a rotation and translation about one line, so
+ * that only the sine and cosine of every angle depend on the batch.
+ */
+template <typename Scalar>
+PoseBatchT<Scalar> BatchExpmap(const gtsam::Vector6 &S,
+                               const ScalarBatchT<Scalar> &q);
+
+/// SIMD instruction sets the batch operations are compiled for.
+const char *BatchSimdInstructionSets();
+
+}  // namespace gtdynamics
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ShardedValues.cpp
+ * @brief Values of a trajectory, stored per time step with copy-on-write.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/ShardedValues.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using gtsam::Key;
+using gtsam::Values;
+using gtsam::VectorValues;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ShardedValues::ShardedValues(const Values &values) {
+  std::map<uint64_t, Values> slices;
+  for (auto &&key_value : values) {
+    slices[Time(key_value.key)].insert(key_value.key, key_value.value);
+  }
+  for (auto &&slice : slices) {
+    slices_.emplace(slice.first,
+                    std::make_shared<Values>(std::move(slice.second)));
+  }
+}
+
+/* ************************************************************************* */
+Values &ShardedValues::mutableSlice(uint64_t t) {
+  SlicePtr &slice = slices_[t];
+  if (!slice) {
+    slice = std::make_shared<Values>();
+  } else if (slice.use_count() > 1) {
+    slice = std::make_shared<Values>(*slice);
+  }
+  // Slices are created as non-const Values, and this one is not shared.
+  return const_cast<Values &>(*slice);
+}
+
+/* ************************************************************************* */
+size_t ShardedValues::size() const {
+  size_t size = 0;
+  for (auto &&slice : slices_) size += slice.second->size();
+  return size;
+}
+
+/* ************************************************************************* */
+std::vector<uint64_t> ShardedValues::times() const {
+  std::vector<uint64_t> times;
+  times.reserve(slices_.size());
+  for (auto &&slice : slices_) times.push_back(slice.first);
+  return times;
+}
+
+/* ************************************************************************* */
+const Values &ShardedValues::slice(uint64_t t) const {
+  static const Values kEmpty;
+  auto it = slices_.find(t);
+  return it == slices_.end() ? kEmpty : *it->second;
+}
+
+/* ************************************************************************* */
+void ShardedValues::setSlice(uint64_t t, const Values &values) {
+  for (auto &&key_value : values) {
+    if (Time(key_value.key) != t) {
+      throw std::invalid_argument("ShardedValues: " +
+                                  _GTDKeyFormatter(key_value.key) +
+                                  " is not at time " + std::to_string(t));
+    }
+  }
+  if (values.empty()) {
+    slices_.erase(t);
+  } else {
+    slices_[t] = std::make_shared<Values>(values);
+  }
+}
+
+/* ************************************************************************* */
+bool ShardedValues::sharesSlice(const ShardedValues &other, uint64_t t) const {
+  auto it = slices_.find(t), other_it = other.slices_.find(t);
+  return it != slices_.end() && other_it != other.slices_.end() &&
+         it->second == other_it->second;
+}
+
+/* ************************************************************************* */
+bool ShardedValues::exists(Key key) const {
+  auto it = slices_.find(Time(key));
+  return it != slices_.end() && it->second->exists(key);
+}
+
+/* ************************************************************************* */
+const gtsam::Value &ShardedValues::at(Key key) const {
+  return slice(Time(key)).at(key);
+}
+
+/* ************************************************************************* */
+void ShardedValues::insert(Key key, const gtsam::Value &value) {
+  mutableSlice(Time(key)).insert(key, value);
+}
+
+/* ************************************************************************* */
+void ShardedValues::insert(const ShardedValues &other) {
+  for (auto &&slice : other.slices_) {
+    auto it = slices_.find(slice.first);
+    if (it == slices_.end()) {
+      slices_.emplace(slice.first, slice.second);
+    } else {
+      mutableSlice(slice.first).insert(*slice.second);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void ShardedValues::insertOrAssign(const ShardedValues &other) {
+  for (auto &&slice : other.slices_) {
+    auto it = slices_.find(slice.first);
+    if (it == slices_.end()) {
+      slices_.emplace(slice.first, slice.second);
+      continue;
+    }
+    Values &values = mutableSlice(slice.first);
+    for (auto &&key_value : *slice.second) {
+      if (values.exists(key_value.key)) {
+        values.update(key_value.key, key_value.value);
+      } else {
+        values.insert(key_value.key, key_value.value);
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+ShardedValues ShardedValues::retract(const VectorValues &delta) const {
+  std::map<uint64_t, VectorValues> deltas;
+  for (auto &&key_vector : delta) {
+    const uint64_t t = Time(key_vector.first);
+    if (slices_.count(t)) deltas[t].insert(key_vector.first, key_vector.second);
+  }
+  ShardedValues result(*this);
+  for (auto &&slice_delta : deltas) {
+    result.slices_[slice_delta.first] = std::make_shared<Values>(
+        slice(slice_delta.first).retract(slice_delta.second));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values ShardedValues::values() const {
+  Values values;
+  for (auto &&slice : slices_) values.insert(*slice.second);
+  return values;
+}
+
+/* ************************************************************************* */
+Values ShardedValues::values(uint64_t first, uint64_t last) const {
+  Values values;
+  for (auto it = slices_.lower_bound(first);
+       it != slices_.end() && it->first <= last; ++it) {
+    values.insert(*it->second);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
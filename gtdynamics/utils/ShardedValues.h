@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ShardedValues.h
+ * @brief Values of a trajectory, stored per time step with copy-on-write.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ShardedValues holds the variables of a trajectory as one gtsam::Values per
+ * time step, the slice of all keys whose DynamicsSymbol has that time.
+ *
+ * Slices are shared between copies and only copied when modified, so copying
+ * a ShardedValues, or solving and updating a single time step, costs O(steps)
+ * pointer copies plus the size of the modified slices, instead of a copy of
+ * the whole trajectory. Merging and retracting share the slices they leave
+ * unchanged.
+ *
+ * Keys must be DynamicsSymbol keys, or at least keep the time step in the low
+ * bits as DynamicsSymbol does.
+ */
+class ShardedValues {
+ private:
+  using SlicePtr = std::shared_ptr<const gtsam::Values>;
+  std::map<uint64_t, SlicePtr> slices_;
+
+  /// The slice at time t, copied first if it is shared; created if missing.
+  gtsam::Values &mutableSlice(uint64_t t);
+
+ public:
+  /// Empty values.
+  ShardedValues() = default;
+
+  /// Split values into time slices.
+  explicit ShardedValues(const gtsam::Values &values);
+
+  /// Time step of a key.
+  static uint64_t Time(gtsam::Key key) { return DynamicsSymbol::TimeOf(key); }
+
+  /// Total number of variables.
+  size_t size() const;
+
+  /// Whether there are no variables.
+  bool empty() const { return slices_.empty(); }
+
+  /// Number of non-empty time slices.
+  size_t numSlices() const { return slices_.size(); }
+
+  /// Time steps with variables, in increasing order.
+  std::vector<uint64_t> times() const;
+
+  /// Whether there are variables at time t.
+  bool hasSlice(uint64_t t) const { return slices_.count(t) > 0; }
+
+  /// Variables at time t; empty if there are none.
+  const gtsam::Values &slice(uint64_t t) const;
+
+  /// Replace the variables at time t, which must all have time t.
+  void setSlice(uint64_t t, const gtsam::Values &values);
+
+  /// Remove the variables at time t.
+  void eraseSlice(uint64_t t) { slices_.erase(t); }
+
+  /// Whether the slices at time t of this and other are the same object.
+  bool sharesSlice(const ShardedValues &other, uint64_t t) const;
+
+  /// Whether a variable exists.
+  bool exists(gtsam::Key key) const;
+
+  /// Value of a variable; throws ValuesKeyDoesNotExist if missing.
+  const gtsam::Value &at(gtsam::Key key) const;
+
+  /// Value of a variable of type T.
+  template <typename T>
+  const T &at(gtsam::Key key) const {
+    return slice(Time(key)).at<T>(key);
+  }
+
+  /// Insert a variable; throws ValuesKeyAlreadyExists if present.
+  void insert(gtsam::Key key, const gtsam::Value &value);
+
+  /// Insert a variable of type T.
+  template <typename T>
+  void insert(gtsam::Key key, const T &value) {
+    mutableSlice(Time(key)).insert(key, value);
+  }
+
+  /// Update a variable of type T, which must exist.
+  template <typename T>
+  void update(gtsam::Key key, const T &value) {
+    if (!exists(key)) throw gtsam::ValuesKeyDoesNotExist("update", key);
+    mutableSlice(Time(key)).update(key, value);
+  }
+
+  /**
+   * Insert all variables of other. Slices at times that only other has are
+   * shared; throws ValuesKeyAlreadyExists if both have a variable.
+   */
+  void insert(const ShardedValues &other);
+
+  /**
+   * Update the variables of other, and insert the ones missing here. Slices
+   * at times that only other has are shared.
+   */
+  void insertOrAssign(const ShardedValues &other);
+
+  /// Retract by delta, sharing the slices that delta does not touch.
+  ShardedValues retract(const gtsam::VectorValues &delta) const;
+
+  /// All variables, as a single gtsam::Values.
+  gtsam::Values values() const;
+
+  /// Variables of time steps first up to and including last.
+  gtsam::Values values(uint64_t first, uint64_t last) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,305 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SharedTrajectoryRing.cpp
+ * @brief Ring of trajectories in shared memory, for zero-copy handoff to a
+ * controller process.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/SharedTrajectoryRing.h>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GTDYNAMICS_SHARED_MEMORY
+#endif
+
+namespace gtdynamics {
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'R', 'I', 'N', 'G', 0};
+
+// Slots start on cache lines, so that a reader of one does not share lines
+// with the writer of the next.
+constexpr size_t kAlignment = 64;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "sequence counters must be lock-free to be shared");
+
+/// Header at the start of the segment, followed by the joint ids.
+struct RingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_joints;
+  uint64_t num_slots, max_steps, slot_bytes, slots_offset;
+  std::atomic<uint64_t> latest;  // newest complete trajectory
+};
+
+/// Header of a slot, followed by its joint quantities.
+struct SlotHeader {
+  std::atomic<uint64_t> sequence;  // odd while the slot is written
+  uint64_t trajectory, num_steps;
+  double start_time, dt;
+  uint64_t reserved[3];
+};
+static_assert(sizeof(SlotHeader) % kAlignment == 0,
+              "quantities after the slot header must stay aligned");
+
+size_t AlignUp(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+RingHeader *Header(char *data) { return reinterpret_cast<RingHeader *>(data); }
+
+SlotHeader *Slot(char *slot) { return reinterpret_cast<SlotHeader *>(slot); }
+
+double *Quantities(char *slot) {
+  return reinterpret_cast<double *>(slot + sizeof(SlotHeader));
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+size_t SharedTrajectoryRing::Size(size_t num_joints, size_t max_steps,
+                                  size_t num_slots) {
+  const size_t slots_offset =
+      AlignUp(sizeof(RingHeader) + sizeof(uint16_t) * num_joints);
+  const size_t slot_bytes =
+      AlignUp(sizeof(SlotHeader) + 4 * sizeof(double) * max_steps * num_joints);
+  return slots_offset + num_slots * slot_bytes;
+}
+
+/* ************************************************************************* */
+void SharedTrajectoryRing::map(const std::string &name, bool create,
+                               size_t size) {
+  name_ = (!name.empty() && name[0] == '/') ? name : "/" + name;
+#ifdef GTDYNAMICS_SHARED_MEMORY
+  const int fd = create ? ::shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600)
+                        : ::shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    throw std::runtime_error("SharedTrajectoryRing: could not open " + name_);
+  struct stat st;
+  if (create ? ::ftruncate(fd, size) != 0 : ::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("SharedTrajectoryRing: could not size " + name_);
+  }
+  if (!create) size = st.st_size;
+  void *p = size ? ::mmap(nullptr, size,
+                          create ? PROT_READ | PROT_WRITE : PROT_READ,
+                          MAP_SHARED, fd, 0)
+                 : MAP_FAILED;
+  ::close(fd);
+  if (p == MAP_FAILED)
+    throw std::runtime_error("SharedTrajectoryRing: could not map " + name_);
+  data_ = static_cast<char *>(p);
+  size_ = size;
+#else
+  throw std::runtime_error(
+      "SharedTrajectoryRing: shared memory is not supported on this platform");
+#endif
+}
+
+/* ************************************************************************* */
+SharedTrajectoryRing::~SharedTrajectoryRing() {
+#ifdef GTDYNAMICS_SHARED_MEMORY
+  if (data_) ::munmap(data_, size_);
+#endif
+}
+
+/* ************************************************************************* */
+void SharedTrajectoryRing::parse() {
+  const RingHeader *header = Header(data_);
+  if (size_ < sizeof(RingHeader) ||
+      std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("SharedTrajectoryRing: " + name_ +
+                             " is not a trajectory ring");
+  if (header->version != kSharedTrajectoryRingVersion)
+    throw std::runtime_error("SharedTrajectoryRing: " + name_ +
+                             " has another layout version");
+  if (header->num_slots < 2 ||
+      header->slots_offset + header->num_slots * header->slot_bytes > size_ ||
+      Size(header->num_joints, header->max_steps, header->num_slots) > size_)
+    throw std::runtime_error("SharedTrajectoryRing: invalid layout in " +
+                             name_);
+
+  num_slots_ = header->num_slots;
+  max_steps_ = header->max_steps;
+  slot_bytes_ = header->slot_bytes;
+  slots_offset_ = header->slots_offset;
+  const uint16_t *ids =
+      reinterpret_cast<const uint16_t *>(data_ + sizeof(RingHeader));
+  joint_ids_.assign(ids, ids + header->num_joints);
+  joint_columns_.clear();
+  for (size_t c = 0; c < joint_ids_.size(); c++) {
+    if (joint_ids_[c] >= joint_columns_.size())
+      joint_columns_.resize(joint_ids_[c] + 1, -1);
+    joint_columns_[joint_ids_[c]] = c;
+  }
+}
+
+/* ************************************************************************* */
+SharedTrajectoryWriter::SharedTrajectoryWriter(const std::string &name,
+                                               const Robot &robot,
+                                               size_t max_steps,
+                                               size_t num_slots)
+    : robot_(robot) {
+  if (num_slots < 2)
+    throw std::invalid_argument(
+        "SharedTrajectoryWriter: the ring needs at least 2 slots");
+  if (max_steps < 1)
+    throw std::invalid_argument(
+        "SharedTrajectoryWriter: trajectories need at least 1 step");
+  const size_t num_joints = robot.numJoints();
+  map(name, true, Size(num_joints, max_steps, num_slots));
+  std::memset(data_, 0, size_);
+
+  RingHeader *header = Header(data_);
+  header->version = kSharedTrajectoryRingVersion;
+  header->num_joints = num_joints;
+  header->num_slots = num_slots;
+  header->max_steps = max_steps;
+  header->slots_offset =
+      AlignUp(sizeof(RingHeader) + sizeof(uint16_t) * num_joints);
+  header->slot_bytes = AlignUp(sizeof(SlotHeader) +
+                               4 * sizeof(double) * max_steps * num_joints);
+  new (&header->latest) std::atomic<uint64_t>(0);
+  uint16_t *ids = reinterpret_cast<uint16_t *>(data_ + sizeof(RingHeader));
+  for (size_t c = 0; c < num_joints; c++) ids[c] = robot.joints()[c]->id();
+  for (size_t s = 0; s < num_slots; s++) {
+    char *slot = data_ + header->slots_offset + s * header->slot_bytes;
+    new (&Slot(slot)->sequence) std::atomic<uint64_t>(0);
+  }
+
+  // Readers accept the segment once the magic is there.
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  parse();
+}
+
+/* ************************************************************************* */
+SharedTrajectoryWriter::~SharedTrajectoryWriter() {
+#ifdef GTDYNAMICS_SHARED_MEMORY
+  if (data_) ::shm_unlink(name_.c_str());
+#endif
+}
+
+/* ************************************************************************* */
+uint64_t SharedTrajectoryWriter::write(const TrajectoryBuffer &buffer,
+                                       double start_time, double dt) {
+  const size_t num_steps = buffer.numSteps(), num_joints = numJoints();
+  if (num_steps > max_steps_)
+    throw std::invalid_argument(
+        "SharedTrajectoryWriter: trajectory of " + std::to_string(num_steps) +
+        " steps, the ring holds at most " + std::to_string(max_steps_));
+  if (size_t(buffer.jointAngles().cols()) != num_joints)
+    throw std::invalid_argument(
+        "SharedTrajectoryWriter: trajectory of another robot");
+
+  const uint64_t trajectory = written_ + 1;
+  char *slot = this->slot(trajectory);
+  SlotHeader *header = Slot(slot);
+  const uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  header->trajectory = trajectory;
+  header->num_steps = num_steps;
+  header->start_time = start_time;
+  header->dt = dt;
+  using RowMajor = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                                 Eigen::RowMajor>;
+  const size_t stride = max_steps_ * num_joints;
+  const gtsam::Matrix *quantities[4] = {&buffer.jointAngles(),
+                                        &buffer.jointVels(),
+                                        &buffer.jointAccels(),
+                                        &buffer.torques()};
+  for (size_t m = 0; m < 4; m++) {
+    Eigen::Map<RowMajor>(Quantities(slot) + m * stride, num_steps,
+                         num_joints) = *quantities[m];
+  }
+
+  header->sequence.store(sequence + 2, std::memory_order_release);
+  Header(data_)->latest.store(trajectory, std::memory_order_release);
+  written_ = trajectory;
+  return trajectory;
+}
+
+/* ************************************************************************* */
+uint64_t SharedTrajectoryWriter::write(const gtsam::Values &values,
+                                       double start_time, double dt) {
+  return write(TrajectoryBuffer::FromValues(robot_, values), start_time, dt);
+}
+
+/* ************************************************************************* */
+SharedTrajectoryReader::SharedTrajectoryReader(const std::string &name) {
+  map(name, false, 0);
+  parse();
+}
+
+/* ************************************************************************* */
+SharedTrajectoryReader::~SharedTrajectoryReader() {}
+
+/* ************************************************************************* */
+uint64_t SharedTrajectoryReader::latest() const {
+  return Header(data_)->latest.load(std::memory_order_acquire);
+}
+
+/* ************************************************************************* */
+bool SharedTrajectoryReader::view(uint64_t trajectory,
+                                  SharedTrajectoryView *view) const {
+  if (trajectory == 0) return false;
+  char *slot = this->slot(trajectory);
+  const SlotHeader *header = Slot(slot);
+  const uint64_t sequence = header->sequence.load(std::memory_order_acquire);
+  if (sequence & 1) return false;
+  if (header->trajectory != trajectory || header->num_steps > max_steps_)
+    return false;
+  view->trajectory = trajectory;
+  view->sequence = sequence;
+  view->num_steps = header->num_steps;
+  view->start_time = header->start_time;
+  view->dt = header->dt;
+  const size_t stride = max_steps_ * numJoints();
+  view->angles = Quantities(slot);
+  view->vels = view->angles + stride;
+  view->accels = view->vels + stride;
+  view->torques = view->accels + stride;
+  return validate(*view);
+}
+
+/* ************************************************************************* */
+bool SharedTrajectoryReader::validate(const SharedTrajectoryView &view) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return Slot(slot(view.trajectory))
+             ->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+/* ************************************************************************* */
+bool SharedTrajectoryReader::readStep(uint64_t trajectory, size_t step,
+                                      double *angles, double *vels,
+                                      double *accels, double *torques) const {
+  SharedTrajectoryView v;
+  if (!view(trajectory, &v) || step >= v.num_steps) return false;
+  const size_t n = numJoints(), offset = step * n;
+  if (angles) std::memcpy(angles, v.angles + offset, n * sizeof(double));
+  if (vels) std::memcpy(vels, v.vels + offset, n * sizeof(double));
+  if (accels) std::memcpy(accels, v.accels + offset, n * sizeof(double));
+  if (torques) std::memcpy(torques, v.torques + offset, n * sizeof(double));
+  return validate(v);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,185 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SharedTrajectoryRing.h
+ * @brief Ring of trajectories in shared memory, for zero-copy handoff to a
+ * controller process.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Version of the shared memory layout.
+constexpr uint32_t kSharedTrajectoryRingVersion = 1;
+
+/**
+ * A trajectory in a SharedTrajectoryRing, read in place. Joint quantities are
+ * numSteps x numJoints arrays, row-major, so that a time step of all joints is
+ * contiguous; columns are in the order of jointIds(). The pointers stay valid
+ * while the ring is mapped, but the data is only that of the trajectory as
+ * long as SharedTrajectoryReader::validate returns true.
+ */
+struct SharedTrajectoryView {
+  uint64_t trajectory = 0;  // number of the trajectory, from 1 on
+  uint64_t sequence = 0;    // version of its slot, for validate
+  size_t num_steps = 0;
+  double start_time = 0, dt = 0;
+  const double *angles = nullptr, *vels = nullptr, *accels = nullptr,
+               *torques = nullptr;
+};
+
+/**
+ * Shared memory segment with a ring of fixed-size trajectory slots, written
+ * by one SharedTrajectoryWriter and read by any number of
+ * SharedTrajectoryReaders in other processes.
+ *
+ * Every slot is guarded by a sequence lock: the writer makes its sequence odd
+ * while it writes the slot, and even again when done, so readers never wait
+ * and detect a trajectory overwritten while they read it. With n slots, a
+ * trajectory can be read until n - 1 newer ones are written. The layout is a
+ * header, the joint ids, then the slots, each a header followed by the
+ * angles, velocities, accelerations and torques as native doubles.
+ */
+class SharedTrajectoryRing {
+ protected:
+  std::string name_;
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  size_t num_slots_ = 0, max_steps_ = 0, slot_bytes_ = 0, slots_offset_ = 0;
+  std::vector<uint16_t> joint_ids_;
+  std::vector<int> joint_columns_;  // column of every joint id, or -1
+
+  SharedTrajectoryRing() {}
+  ~SharedTrajectoryRing();
+
+  /// Create or open the segment and map it, throws if that fails.
+  void map(const std::string &name, bool create, size_t size);
+
+  /// Set the layout fields from the mapped header.
+  void parse();
+
+  /// Start of the slot of a trajectory.
+  char *slot(uint64_t trajectory) const {
+    return data_ + slots_offset_ + (trajectory % num_slots_) * slot_bytes_;
+  }
+
+  /// Bytes of a segment with the given layout.
+  static size_t Size(size_t num_joints, size_t max_steps, size_t num_slots);
+
+ public:
+  SharedTrajectoryRing(const SharedTrajectoryRing &) = delete;
+  SharedTrajectoryRing &operator=(const SharedTrajectoryRing &) = delete;
+
+  /// Name of the shared memory segment.
+  const std::string &name() const { return name_; }
+
+  /// Ids of the joints, in the order of the columns.
+  const std::vector<uint16_t> &jointIds() const { return joint_ids_; }
+
+  /// Column of a joint id, or -1 if it is not in the ring.
+  int jointColumn(uint16_t joint_id) const {
+    return joint_id < joint_columns_.size() ? joint_columns_[joint_id] : -1;
+  }
+
+  size_t numJoints() const { return joint_ids_.size(); }
+  size_t maxSteps() const { return max_steps_; }
+  size_t numSlots() const { return num_slots_; }
+};
+
+/**
+ * SharedTrajectoryWriter creates a SharedTrajectoryRing and publishes
+ * trajectories into it, e.g. the result of every solve:
+ *
+ *   SharedTrajectoryWriter writer("/robot_plan", robot, 500);
+ *   writer.write(optimizer.optimize(graph, init), now, dt);
+ *
+ * The segment is removed when the writer is destroyed.
+ */
+class SharedTrajectoryWriter : public SharedTrajectoryRing {
+ private:
+  Robot robot_;
+  uint64_t written_ = 0;
+
+ public:
+  /**
+   * Constructor, creates the segment or resets an existing one.
+   * @param name      name of the segment, see shm_open
+   * @param robot     the robot, all of whose joints are written
+   * @param max_steps maximum number of time steps of a trajectory
+   * @param num_slots number of trajectories kept, at least 2
+   */
+  SharedTrajectoryWriter(const std::string &name, const Robot &robot,
+                         size_t max_steps, size_t num_slots = 4);
+
+  ~SharedTrajectoryWriter();
+
+  /**
+   * Publish the joint quantities of a trajectory.
+   * @param buffer     trajectory of at most maxSteps() steps
+   * @param start_time time of its first step
+   * @param dt         time between steps
+   * @return the number of the trajectory
+   */
+  uint64_t write(const TrajectoryBuffer &buffer, double start_time,
+                 double dt);
+
+  /// Publish a trajectory in Values, see TrajectoryBuffer::FromValues.
+  uint64_t write(const gtsam::Values &values, double start_time, double dt);
+
+  /// Number of trajectories written.
+  uint64_t numWritten() const { return written_; }
+};
+
+/**
+ * SharedTrajectoryReader maps a SharedTrajectoryRing read-only. After the
+ * constructor, its functions take bounded time, never block, allocate or make
+ * system calls, so a hard real-time control loop can call them: a read that
+ * overlaps a write returns false instead of waiting, and can be retried on
+ * the next cycle or with the previous trajectory.
+ */
+class SharedTrajectoryReader : public SharedTrajectoryRing {
+ public:
+  /// Constructor, throws if the segment does not exist or has another layout.
+  explicit SharedTrajectoryReader(const std::string &name);
+
+  ~SharedTrajectoryReader();
+
+  /// Number of the newest complete trajectory, 0 if none was written.
+  uint64_t latest() const;
+
+  /**
+   * View a trajectory in place, without copying it.
+   * @return false if it is not in the ring, or being overwritten
+   */
+  bool view(uint64_t trajectory, SharedTrajectoryView *view) const;
+
+  /// Whether a view still shows its trajectory; check it after reading.
+  bool validate(const SharedTrajectoryView &view) const;
+
+  /**
+   * Copy one time step of all joints, in the order of jointIds(), any of the
+   * outputs may be null.
+   * @return false if the trajectory or step is not available, or the
+   * trajectory was overwritten during the copy
+   */
+  bool readStep(uint64_t trajectory, size_t step, double *angles,
+                double *vels = nullptr, double *accels = nullptr,
+                double *torques = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.cpp
+ * @brief Voxel grid of signed distances to obstacles, memory mapped.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/MappedFile.h>
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtdynamics/utils/utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'S', 'D', 'F', 0, 0};
+
+/// Fixed header at the start of a file, followed by the cells.
+struct FieldHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  double origin[3];
+  double cell_size;
+  uint64_t rows, cols, depth;
+};
+static_assert(sizeof(FieldHeader) % sizeof(double) == 0,
+              "cells after the header must stay aligned");
+
+// Index of the cell below x along an axis of n cells, and the weight t of
+// the cell above it; t is clamped to the grid, clamped tells whether it was.
+size_t Lower(double x, size_t n, double *t, bool *clamped) {
+  const double upper = static_cast<double>(n - 1);
+  *clamped = x < 0 || x > upper;
+  x = std::min(std::max(x, 0.0), upper);
+  const size_t i = std::min(static_cast<size_t>(x), n - 2);
+  *t = x - i;
+  return i;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+SignedDistanceField::SignedDistanceField(
+    const gtsam::Point3 &origin, double cell_size,
+    const std::vector<gtsam::Matrix> &slices)
+    : origin_(origin), cell_size_(cell_size), depth_(slices.size()) {
+  if (depth_ < 2 || slices[0].rows() < 2 || slices[0].cols() < 2)
+    throw std::invalid_argument(
+        "SignedDistanceField: the grid needs at least 2 x 2 x 2 cells");
+  if (cell_size <= 0)
+    throw std::invalid_argument(
+        "SignedDistanceField: the cell size must be positive");
+  rows_ = slices[0].rows();
+  cols_ = slices[0].cols();
+  auto buffer = std::make_shared<std::vector<float>>();
+  buffer->reserve(rows_ * cols_ * depth_);
+  for (const gtsam::Matrix &slice : slices) {
+    if (size_t(slice.rows()) != rows_ || size_t(slice.cols()) != cols_)
+      throw std::invalid_argument(
+          "SignedDistanceField: slices must have the same size");
+    for (size_t i = 0; i < rows_; i++) {
+      for (size_t j = 0; j < cols_; j++) buffer->push_back(slice(i, j));
+    }
+  }
+  cells_ = buffer->data();
+  buffer_ = buffer;
+}
+
+/* ************************************************************************* */
+SignedDistanceField SignedDistanceField::Load(const std::string &file_path) {
+  auto file = std::make_shared<MappedFile>();
+  if (!file->open(file_path))
+    throw std::runtime_error("SignedDistanceField: no file found at " +
+                             file_path);
+  FieldHeader header;
+  if (file->size() < sizeof(header))
+    throw std::runtime_error("SignedDistanceField: " + file_path +
+                             " is not a signed distance field");
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("SignedDistanceField: " + file_path +
+                             " is not a signed distance field");
+  if (header.version != kSignedDistanceFieldVersion)
+    throw std::runtime_error("SignedDistanceField: " + file_path +
+                             " has another format version");
+  if (header.rows < 2 || header.cols < 2 || header.depth < 2 ||
+      header.cell_size <= 0)
+    throw std::runtime_error("SignedDistanceField: invalid grid in " +
+                             file_path);
+  const uint64_t num_cells = header.rows * header.cols * header.depth;
+  if ((file->size() - sizeof(header)) / sizeof(float) < num_cells)
+    throw std::runtime_error("SignedDistanceField: truncated grid in " +
+                             file_path);
+
+  SignedDistanceField field;
+  field.origin_ =
+      gtsam::Point3(header.origin[0], header.origin[1], header.origin[2]);
+  field.cell_size_ = header.cell_size;
+  field.rows_ = header.rows;
+  field.cols_ = header.cols;
+  field.depth_ = header.depth;
+  // Mappings are page aligned, and buffers are aligned for any type.
+  field.cells_ =
+      reinterpret_cast<const float *>(file->data() + sizeof(header));
+  field.file_ = file;
+  return field;
+}
+
+/* ************************************************************************* */
+SignedDistanceField SignedDistanceField::LoadTxt(
+    const std::string &file_path) {
+  gtsam::Point3 origin;
+  double cell_size = 0;
+  const std::vector<gtsam::Matrix> slices =
+      readFromTxt(file_path, origin, cell_size);
+  if (slices.empty())
+    throw std::runtime_error("SignedDistanceField: could not read " +
+                             file_path);
+  return SignedDistanceField(origin, cell_size, slices);
+}
+
+/* ************************************************************************* */
+void SignedDistanceField::save(const std::string &file_path) const {
+  FieldHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kSignedDistanceFieldVersion;
+  for (size_t i = 0; i < 3; i++) header.origin[i] = origin_[i];
+  header.cell_size = cell_size_;
+  header.rows = rows_;
+  header.cols = cols_;
+  header.depth = depth_;
+
+  std::ofstream os(file_path, std::ios::binary);
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char *>(cells_),
+           sizeof(float) * rows_ * cols_ * depth_);
+  if (!os.good())
+    throw std::runtime_error("SignedDistanceField: could not write " +
+                             file_path);
+}
+
+/* ************************************************************************* */
+double SignedDistanceField::distance(const gtsam::Point3 &point,
+                                     gtsam::OptionalJacobian<1, 3> H) const {
+  const gtsam::Point3 p = (point - origin_) / cell_size_;
+  double tx, ty, tz;
+  bool cx, cy, cz;
+  const size_t j = Lower(p.x(), cols_, &tx, &cx);
+  const size_t i = Lower(p.y(), rows_, &ty, &cy);
+  const size_t k = Lower(p.z(), depth_, &tz, &cz);
+
+  // Interpolate along x, then y, then z.
+  double c[2][2], dc[2][2];
+  for (size_t b = 0; b < 2; b++) {
+    for (size_t a = 0; a < 2; a++) {
+      const double c0 = cell(i + a, j, k + b), c1 = cell(i + a, j + 1, k + b);
+      c[a][b] = c0 + tx * (c1 - c0);
+      dc[a][b] = c1 - c0;
+    }
+  }
+  double e[2], de_dx[2];
+  for (size_t b = 0; b < 2; b++) {
+    e[b] = c[0][b] + ty * (c[1][b] - c[0][b]);
+    de_dx[b] = dc[0][b] + ty * (dc[1][b] - dc[0][b]);
+  }
+  const double d = e[0] + tz * (e[1] - e[0]);
+
+  if (H) {
+    const double dd_dx = de_dx[0] + tz * (de_dx[1] - de_dx[0]);
+    const double dd_dy = (1 - tz) * (c[1][0] - c[0][0]) +
+                         tz * (c[1][1] - c[0][1]);
+    const double dd_dz = e[1] - e[0];
+    *H << (cx ? 0 : dd_dx), (cy ? 0 : dd_dy), (cz ? 0 : dd_dz);
+    *H /= cell_size_;
+  }
+  return d;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.h
+ * @brief Voxel grid of signed distances to obstacles, memory mapped.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/geometry/Point3.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+class MappedFile;
+
+/// Version of the binary signed distance field format.
+constexpr uint32_t kSignedDistanceFieldVersion = 1;
+
+/**
+ * Signed distances to the nearest obstacle, negative inside obstacles,
+ * sampled on a regular grid. As for readFromTxt, the grid is a stack of
+ * rows x cols slices along z; rows run along y and columns along x, and
+ * cell (row, col, z) is at origin + cell_size * (col, row, z).
+ *
+ * Binary files are a fixed header followed by the cells as native-endian
+ * 32-bit floats, slice by slice and row-major within a slice. They are
+ * memory mapped, so loading a large map is immediate and only the cells
+ * that are queried are read from disk. Copies share the same grid.
+ */
+class SignedDistanceField {
+ private:
+  std::shared_ptr<const MappedFile> file_;            // mapped grid, or
+  std::shared_ptr<const std::vector<float>> buffer_;  // grid in memory
+  const float *cells_ = nullptr;
+  gtsam::Point3 origin_;
+  double cell_size_ = 0;
+  size_t rows_ = 0, cols_ = 0, depth_ = 0;
+
+  SignedDistanceField() {}
+
+ public:
+  /**
+   * Constructor from slices along z, e.g. read by readFromTxt.
+   * @param origin    position of cell (0, 0, 0)
+   * @param cell_size edge length of a cell
+   * @param slices    rows x cols signed distances, at least 2 x 2 x 2
+   */
+  SignedDistanceField(const gtsam::Point3 &origin, double cell_size,
+                      const std::vector<gtsam::Matrix> &slices);
+
+  /// Map a binary signed distance field file; throws if it is not one.
+  static SignedDistanceField Load(const std::string &file_path);
+
+  /// Read the text format of readFromTxt, e.g. to convert it with save.
+  static SignedDistanceField LoadTxt(const std::string &file_path);
+
+  /// Write the binary format, to be loaded with Load.
+  void save(const std::string &file_path) const;
+
+  /**
+   * Signed distance at a point, by trilinear interpolation of the cells.
+   * Points outside the grid get the distance at the nearest point of the
+   * grid, with zero derivative along the axes they are outside along.
+   * @param point point in the world frame
+   * @param H     optional 1x3 gradient of the distance
+   */
+  double distance(const gtsam::Point3 &point,
+                  gtsam::OptionalJacobian<1, 3> H = boost::none) const;
+
+  /// Signed distance of a cell.
+  double cell(size_t row, size_t col, size_t z) const {
+    return cells_[(z * rows_ + row) * cols_ + col];
+  }
+
+  const gtsam::Point3 &origin() const { return origin_; }
+  double cellSize() const { return cell_size_; }
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t depth() const { return depth_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ThreadPool.cpp
+ * @brief Fixed set of worker threads running independent tasks.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/ThreadPool.h>
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ThreadPool::ThreadPool(size_t num_threads) {
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  num_threads = std::max<size_t>(num_threads, 1);
+  for (size_t i = 0; i < num_threads; i++)
+    threads_.emplace_back(&ThreadPool::work, this);
+}
+
+/* ************************************************************************* */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (auto &&thread : threads_) thread.join();
+}
+
+/* ************************************************************************* */
+size_t ThreadPool::numQueued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+/* ************************************************************************* */
+void ThreadPool::enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  ready_.notify_one();
+}
+
+/* ************************************************************************* */
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    // packaged_task stores exceptions in the future, so this does not throw.
+    task();
+  }
+}
+
+}  // namespace gtdynamics
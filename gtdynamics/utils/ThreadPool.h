@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ThreadPool.h
+ * @brief Fixed set of worker threads running independent tasks.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ThreadPool runs submitted tasks on a fixed set of worker threads, in
+ * submission order, and hands back their results as futures. Where
+ * ParallelFor runs one loop and waits for it, a pool keeps its threads and
+ * lets callers start solves and collect them later, e.g. from Python.
+ *
+ * Tasks must not share mutable state unless they synchronize it themselves.
+ * Exceptions thrown by a task are rethrown by the get() of its future.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Start the worker threads.
+   * @param num_threads number of threads, 0 for
+   * std::thread::hardware_concurrency
+   */
+  explicit ThreadPool(size_t num_threads = 0);
+
+  /// Run the tasks still queued, then join the threads.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// Number of worker threads.
+  size_t numThreads() const { return threads_.size(); }
+
+  /// Number of tasks waiting for a free thread.
+  size_t numQueued() const;
+
+  /**
+   * Queue a task.
+   * @param f callable without arguments, copied or moved into the pool
+   * @return future of the result of f
+   */
+  template <class F>
+  std::future<typename std::result_of<F()>::type> submit(F f) {
+    typedef typename std::result_of<F()>::type Result;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+    std::future<Result> future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+
+  void enqueue(std::function<void()> task);
+  void work();
+};
+
+}  // namespace gtdynamics
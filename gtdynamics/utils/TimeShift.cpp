@@ -0,0 +1,133 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeShift.cpp
+ * @brief Shift trajectories and their factors in time.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtdynamics/utils/TimeShift.h>
+
+#include <memory>
+#include <vector>
+
+using gtsam::Key;
+using gtsam::KeySet;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Value;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+namespace {
+// Frees the values returned by gtsam::Value::retract_.
+struct ValueDeleter {
+  void operator()(Value *value) const { value->deallocate_(); }
+};
+
+// One key of a series, at time t.
+struct Entry {
+  uint64_t t;
+  Key key;
+  const Value *value;
+};
+}  // namespace
+
+/* ************************************************************************* */
+Values ShiftValues(const Values &values, size_t steps, TailExtrapolation tail,
+                   const KeySet &fixed_keys) {
+  if (steps == 0) return values;
+  Values shifted;
+  std::vector<Entry> series;
+
+  // Keys differing only in time are adjacent in a Values, in time order, so
+  // every value of a series is at hand when the next series starts.
+  auto flush = [&]() {
+    if (series.empty()) return;
+    const Entry &last = series.back();
+    gtsam::Vector delta;  // per step, empty to hold the last value
+    if (tail == TailExtrapolation::Linear && series.size() > 1) {
+      const Entry &previous = series[series.size() - 2];
+      delta = previous.value->localCoordinates_(*last.value) /
+              double(last.t - previous.t);
+    }
+    size_t source = 0;
+    for (const Entry &entry : series) {
+      const uint64_t t = entry.t + steps;
+      while (source < series.size() && series[source].t < t) source++;
+      if (source < series.size()) {
+        shifted.insert(entry.key, *series[source].value);
+      } else if (tail == TailExtrapolation::None) {
+        continue;
+      } else if (delta.size() == 0) {
+        shifted.insert(entry.key, *last.value);
+      } else {
+        std::unique_ptr<Value, ValueDeleter> next(
+            last.value->retract_(double(t - last.t) * delta));
+        shifted.insert(entry.key, *next);
+      }
+    }
+    series.clear();
+  };
+
+  Key current = 0;
+  for (const auto &kv : values) {
+    if (fixed_keys.count(kv.key)) {
+      shifted.insert(kv.key, kv.value);
+      continue;
+    }
+    const uint64_t t = DynamicsSymbol::TimeOf(kv.key);
+    if (series.empty() || kv.key - t != current) {
+      flush();
+      current = kv.key - t;
+    }
+    series.push_back({t, kv.key, &kv.value});
+  }
+  flush();
+  return shifted;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ShiftGraph(const NonlinearFactorGraph &graph,
+                                size_t steps, const KeySet &fixed_keys) {
+  if (steps == 0) return graph;
+  NonlinearFactorGraph shifted;
+  shifted.reserve(graph.size());
+  for (auto &&factor : graph) {
+    if (!factor) {
+      shifted.push_back(factor);
+      continue;
+    }
+    KeyVector keys;
+    keys.reserve(factor->size());
+    bool moved = false, dropped = false;
+    for (Key key : factor->keys()) {
+      if (fixed_keys.count(key)) {
+        keys.push_back(key);
+      } else if (DynamicsSymbol::TimeOf(key) < steps) {
+        dropped = true;
+        break;
+      } else {
+        keys.push_back(key - steps);  // the time is in the lowest bits
+        moved = true;
+      }
+    }
+    if (dropped) continue;
+    if (!moved) {
+      shifted.push_back(factor);
+      continue;
+    }
+    shifted.push_back(RekeyFactor(factor, keys));
+  }
+  return shifted;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeShift.h
+ * @brief Shift trajectories and their factors in time, e.g. to warm start a
+ * receding-horizon controller from its previous solution.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/// How ShiftValues fills the steps past the end of the shifted trajectory.
+enum class TailExtrapolation {
+  Hold,    // repeat the last value
+  Linear,  // continue the last step, in the local coordinates of the value
+  None,    // leave the steps out
+};
+
+/**
+ * Move a trajectory back in time by the given number of steps, keeping its
+ * keys: the value of every DynamicsSymbol key at time t becomes the value
+ * originally at t + steps. A series of keys differing only in time is
+ * assumed to be the contiguous steps of one quantity; the last steps of a
+ * series, whose values would come from past its end, are extrapolated from
+ * its last two steps.
+ *
+ * Keys are visited once, in order, and values are only copied into the new
+ * Values: there is no erase, lookup or re-insert per key as with
+ * gtsam::Values::update.
+ *
+ * @param values     trajectory with DynamicsSymbol keys
+ * @param steps      number of time steps to shift by
+ * @param tail       how to fill the last steps of every series
+ * @param fixed_keys keys whose values are copied unchanged, e.g. parameters
+ */
+gtsam::Values ShiftValues(const gtsam::Values &values, size_t steps,
+                          TailExtrapolation tail = TailExtrapolation::Hold,
+                          const gtsam::KeySet &fixed_keys = gtsam::KeySet());
+
+/**
+ * Move the factors of a graph back in time by the given number of steps:
+ * every DynamicsSymbol key at time t >= steps is replaced by the same key at
+ * time t - steps, and factors on earlier keys are dropped. Factors without
+ * time-dependent keys are shared, the others are rekeyed with RekeyFactor,
+ * so shifting a shifted graph does not nest RekeyedFactors.
+ *
+ * @param graph      factors with DynamicsSymbol keys
+ * @param steps      number of time steps to shift by
+ * @param fixed_keys keys that are not shifted, e.g. parameters
+ */
+gtsam::NonlinearFactorGraph ShiftGraph(
+    const gtsam::NonlinearFactorGraph &graph, size_t steps,
+    const gtsam::KeySet &fixed_keys = gtsam::KeySet());
+
+}  // namespace gtdynamics
@@ -0,0 +1,215 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.cpp
+ * @brief Scoped trace markers, recorded per thread, with Chrome trace export.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/Trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace {
+
+struct Event {
+  const char *name;
+  int64_t arg;
+  uint64_t start, duration;
+};
+
+/// Ring buffer of one thread. Only its thread writes events; others only
+/// touch them while no write is in progress, see Pause.
+struct ThreadBuffer {
+  size_t tid;
+  std::vector<Event> events;
+  std::atomic<uint64_t> head{0};  // number of events ever written
+  std::atomic<bool> writing{false};
+};
+
+const std::chrono::steady_clock::time_point epoch =
+    std::chrono::steady_clock::now();
+
+std::atomic<bool> recording(false);
+std::mutex buffers_mutex;  // registration, and readers of the buffers
+std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+size_t capacity = 1 << 16;
+
+ThreadBuffer &LocalBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> local;
+  if (!local) {
+    local = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    local->tid = buffers.size();
+    local->events.resize(capacity);
+    buffers.push_back(local);
+  }
+  return *local;
+}
+
+/// Stop recording and wait for writes in progress, with buffers_mutex held.
+/// A writer sets its flag before it checks the recording flag, so it either
+/// sees recording stopped or is waited for here.
+bool Pause() {
+  const bool was_recording = recording.exchange(false);
+  for (auto &&buffer : buffers) {
+    while (buffer->writing.load()) std::this_thread::yield();
+  }
+  return was_recording;
+}
+
+void Escape(std::ostream &os, const char *s) {
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') {
+      os << '\\' << *s;
+    } else if (static_cast<unsigned char>(*s) < 0x20) {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", *s);
+      os << code;
+    } else {
+      os << *s;
+    }
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+bool Tracer::Enabled() {
+#ifdef GTDYNAMICS_ENABLE_TRACING
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* ************************************************************************* */
+void Tracer::Start(size_t events_per_thread) {
+  if (events_per_thread == 0) {
+    throw std::invalid_argument("Tracer: need room for at least one event");
+  }
+  std::lock_guard<std::mutex> lock(buffers_mutex);
+  Pause();
+  capacity = events_per_thread;
+  for (auto &&buffer : buffers) {
+    buffer->events.assign(capacity, Event());
+    buffer->head = 0;
+  }
+  recording = true;
+}
+
+/* ************************************************************************* */
+void Tracer::Stop() {
+  std::lock_guard<std::mutex> lock(buffers_mutex);
+  Pause();
+}
+
+/* ************************************************************************* */
+bool Tracer::Recording() { return recording.load(std::memory_order_relaxed); }
+
+/* ************************************************************************* */
+void Tracer::Clear() {
+  std::lock_guard<std::mutex> lock(buffers_mutex);
+  const bool was_recording = Pause();
+  for (auto &&buffer : buffers) buffer->head = 0;
+  recording = was_recording;
+}
+
+/* ************************************************************************* */
+size_t Tracer::NumEvents() {
+  std::lock_guard<std::mutex> lock(buffers_mutex);
+  size_t n = 0;
+  for (auto &&buffer : buffers) {
+    n += std::min<uint64_t>(buffer->head, buffer->events.size());
+  }
+  return n;
+}
+
+/* ************************************************************************* */
+uint64_t Tracer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch)
+      .count();
+}
+
+/* ************************************************************************* */
+void Tracer::Record(const char *name, int64_t arg, uint64_t start,
+                    uint64_t end) {
+  ThreadBuffer &buffer = LocalBuffer();
+  buffer.writing = true;
+  if (recording.load()) {
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % buffer.events.size()] = {name, arg, start,
+                                                  end - start};
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+  buffer.writing = false;
+}
+
+/* ************************************************************************* */
+void Tracer::WriteChromeTrace(std::ostream &os) {
+  struct Copy {
+    size_t tid;
+    std::vector<Event> events;
+  };
+  std::vector<Copy> copies;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    const bool was_recording = Pause();
+    for (auto &&buffer : buffers) {
+      const uint64_t head = buffer->head, size = buffer->events.size();
+      Copy copy{buffer->tid, {}};
+      for (uint64_t i = head > size ? head - size : 0; i < head; i++) {
+        copy.events.push_back(buffer->events[i % size]);
+      }
+      copies.push_back(std::move(copy));
+    }
+    recording = was_recording;
+  }
+
+  // Timestamps and durations are in microseconds.
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  char time[64];
+  for (auto &&copy : copies) {
+    for (auto &&event : copy.events) {
+      os << (first ? "\n" : ",\n") << "{\"name\":\"";
+      Escape(os, event.name);
+      std::snprintf(time, sizeof(time), "\"ts\":%.3f,\"dur\":%.3f",
+                    event.start * 1e-3, event.duration * 1e-3);
+      os << "\",\"cat\":\"gtdynamics\",\"ph\":\"X\"," << time
+         << ",\"pid\":1,\"tid\":" << copy.tid;
+      if (event.arg >= 0) os << ",\"args\":{\"i\":" << event.arg << "}";
+      os << "}";
+      first = false;
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+/* ************************************************************************* */
+void Tracer::SaveChromeTrace(const std::string &path) {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Tracer: cannot open " + path);
+  }
+  WriteChromeTrace(file);
+}
+
+}  // namespace gtdynamics
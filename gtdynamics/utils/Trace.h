@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.h
+ * @brief Scoped trace markers, recorded per thread, with Chrome trace export.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/config.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Tracer records trace events of the library: graph construction,
+ * initialization, linearization, elimination, outer iterations of the
+ * constrained optimizers and simulation steps, each with its duration and
+ * optionally a time step or iteration.
+ *
+ * The markers, see GTDYNAMICS_TRACE_SCOPE, are compiled out unless
+ * GTDynamics is configured with GTDYNAMICS_ENABLE_TRACING. When compiled in,
+ * they cost one atomic load while not recording. Every thread records into
+ * its own ring buffer without locks, and keeps the latest events when it is
+ * full. Export pauses recording for as long as it takes to copy the buffers.
+ *
+ * Example:
+ *   Tracer::Start();
+ *   optimizer.optimize(graph, init);
+ *   Tracer::Stop();
+ *   Tracer::SaveChromeTrace("solve.json");  // chrome://tracing, Perfetto
+ */
+class Tracer {
+ public:
+  /// Whether the markers of the library are compiled in.
+  static bool Enabled();
+
+  /**
+   * Clear all events and start recording.
+   * @param events_per_thread capacity of the ring buffer of every thread
+   */
+  static void Start(size_t events_per_thread = 1 << 16);
+
+  /// Stop recording, keeping the events.
+  static void Stop();
+
+  /// Whether events are being recorded.
+  static bool Recording();
+
+  /// Drop all recorded events.
+  static void Clear();
+
+  /// Number of events in the buffers.
+  static size_t NumEvents();
+
+  /// Nanoseconds since the start of the process, on a steady clock.
+  static uint64_t Now();
+
+  /**
+   * Record a complete event of the calling thread.
+   * @param name  name of the event, a string literal that outlives the tracer
+   * @param arg   time step or iteration, negative for none
+   * @param start start time, from Now()
+   * @param end   end time, from Now()
+   */
+  static void Record(const char *name, int64_t arg, uint64_t start,
+                     uint64_t end);
+
+  /// Write the events in the Chrome trace event format.
+  static void WriteChromeTrace(std::ostream &os);
+
+  /// Write the events to a Chrome trace file.
+  static void SaveChromeTrace(const std::string &path);
+};
+
+/// Records the lifetime of a scope as one event, see GTDYNAMICS_TRACE_SCOPE.
+class TraceScope {
+ private:
+  const char *name_;
+  int64_t arg_;
+  uint64_t start_ = 0;
+  bool active_;
+
+ public:
+  explicit TraceScope(const char *name, int64_t arg = -1)
+      : name_(name), arg_(arg), active_(Tracer::Recording()) {
+    if (active_) start_ = Tracer::Now();
+  }
+
+  ~TraceScope() {
+    if (active_) Tracer::Record(name_, arg_, start_, Tracer::Now());
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+};
+
+}  // namespace gtdynamics
+
+#define GTDYNAMICS_TRACE_CONCAT_(a, b) a##b
+#define GTDYNAMICS_TRACE_CONCAT(a, b) GTDYNAMICS_TRACE_CONCAT_(a, b)
+
+#ifdef GTDYNAMICS_ENABLE_TRACING
+/// Trace the enclosing scope under a string literal name.
+#define GTDYNAMICS_TRACE_SCOPE(name)               \
+  ::gtdynamics::TraceScope GTDYNAMICS_TRACE_CONCAT( \
+      gtdynamics_trace_, __LINE__)(name)
+/// Trace the enclosing scope, with a time step or iteration.
+#define GTDYNAMICS_TRACE_SCOPE_ARG(name, arg)      \
+  ::gtdynamics::TraceScope GTDYNAMICS_TRACE_CONCAT( \
+      gtdynamics_trace_, __LINE__)(name, static_cast<int64_t>(arg))
+#else
+#define GTDYNAMICS_TRACE_SCOPE(name) static_cast<void>(0)
+#define GTDYNAMICS_TRACE_SCOPE_ARG(name, arg) static_cast<void>(0)
+#endif
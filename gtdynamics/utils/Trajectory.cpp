@@ -14,6 +14,7 @@
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/GraphTemplate.h>
 #include <gtdynamics/utils/Trajectory.h>
 #include <gtsam/geometry/Point3.h>
 
@@ -39,7 +40,7 @@ namespace gtdynamics {
 vector<NonlinearFactorGraph> Trajectory::getTransitionGraphs(
     const Robot &robot, const DynamicsGraph &graph_builder, double mu) const {
   vector<NonlinearFactorGraph> transition_graphs;
-  const vector<int> final_timesteps = finalTimeSteps();
+  const vector<int> &final_timesteps = finalTimeSteps();
   const vector<PointOnLinks> trans_cps = transitionContactPoints();
   for (int p = 1; p < numPhases(); p++) {
     transition_graphs.push_back(graph_builder.dynamicsFactorGraph(
@@ -50,19 +51,96 @@ vector<NonlinearFactorGraph> Trajectory::getTransitionGraphs(
 
 NonlinearFactorGraph Trajectory::multiPhaseFactorGraph(
     const Robot &robot, const DynamicsGraph &graph_builder,
-    const CollocationScheme collocation, double mu) const {
+    const CollocationScheme collocation, double mu, bool reuse_cycles,
+    FactorTimeIndex *index) const {
+  if (reuse_cycles && repeat_ > 1) {
+    auto graph =
+        repeatedCycleFactorGraph(robot, graph_builder, collocation, mu);
+    if (index) index->add(graph);
+    return graph;
+  }
+
   // Graphs for transition between phases + their initial values.
   auto transition_graphs = getTransitionGraphs(robot, graph_builder, mu);
-  return graph_builder.multiPhaseTrajectoryFG(robot, phaseDurations(),
-                                              transition_graphs, collocation,
-                                              phaseContactPoints(), mu);
+  return graph_builder.multiPhaseTrajectoryFG(
+      robot, phaseDurations(), transition_graphs, collocation,
+      phaseContactPoints(), mu, index);
+}
+
+NonlinearFactorGraph Trajectory::repeatedCycleFactorGraph(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const CollocationScheme collocation, double mu) const {
+  const vector<int> phase_steps = phaseDurations();
+  const vector<PointOnLinks> &phase_cps = phaseContactPoints();
+  const int C = cycle_phases_;
+
+  // Factors of the first cycle, as in DynamicsGraph::multiPhaseTrajectoryFG,
+  // but for the slices at its start and end, which differ between cycles.
+  NonlinearFactorGraph cycle;
+  int k = 0;
+  for (int p = 0; p < C; p++) {
+    for (int step = 0; step < phase_steps[p] - 1; step++) {
+      graph_builder.addDynamicsFactorGraph(&cycle, robot, ++k, phase_cps[p],
+                                           mu);
+    }
+    if (p < C - 1) {
+      graph_builder.addDynamicsFactorGraph(
+          &cycle, robot, ++k, transitionContactPoints()[p], mu);
+    }
+  }
+  const int S = ++k;  // number of steps in a cycle
+  k = 0;
+  for (int p = 0; p < C; p++) {
+    for (int step = 0; step < phase_steps[p]; step++, k++) {
+      graph_builder.addMultiPhaseCollocationFactors(&cycle, robot, k, p,
+                                                    collocation);
+    }
+  }
+
+  // The transition from one cycle to the next.
+  const NonlinearFactorGraph transition = graph_builder.dynamicsFactorGraph(
+      robot, S, transitionContactPoints()[C - 1], mu);
+
+  // Shift time steps by r cycles, and PhaseKey by r times C phases.
+  const uint16_t phase_label = PhaseKey(0).labelCode();
+  auto shifted = [&](const NonlinearFactorGraph &graph, int r) {
+    return RekeyGraph(graph, [&](gtsam::Key key) {
+      const DynamicsSymbol symbol(key);
+      const int shift = symbol.labelCode() == phase_label ? r * C : r * S;
+      return gtsam::Key(symbol.atTime(symbol.time() + shift));
+    });
+  };
+
+  NonlinearFactorGraph graph;
+  graph.reserve(repeat_ * (cycle.size() + transition.size()) +
+                graph_builder.numFactorsEstimate(robot, phase_cps[0]) +
+                graph_builder.numFactorsEstimate(robot, phase_cps[C - 1]));
+  graph_builder.addDynamicsFactorGraph(&graph, robot, 0, phase_cps[0], mu);
+  auto append = [&](const NonlinearFactorGraph &factors, int r) {
+    if (r == 0) {
+      graph.push_back(factors.begin(), factors.end());
+    } else {
+      DynamicsGraph::appendFactors(&graph, shifted(factors, r));
+    }
+  };
+  for (size_t r = 0; r < repeat_; r++) {
+    append(cycle, r);
+    if (r + 1 < repeat_) {
+      append(transition, r);
+    } else {
+      // Last slice of the trajectory.
+      graph_builder.addDynamicsFactorGraph(&graph, robot, repeat_ * S,
+                                           phase_cps[C - 1], mu);
+    }
+  }
+  return graph;
 }
 
 vector<Values> Trajectory::transitionPhaseInitialValues(
     const Robot &robot, const  Initializer & initializer, double gaussian_noise) const {
   vector<PointOnLinks> trans_cps = transitionContactPoints();
   vector<Values> transition_graph_init;
-  vector<int> final_timesteps = finalTimeSteps();
+  const vector<int> &final_timesteps = finalTimeSteps();
   for (int p = 1; p < numPhases(); p++) {
     transition_graph_init.push_back(initializer.ZeroValues(
         robot, final_timesteps[p - 1], gaussian_noise, trans_cps[p - 1]));
@@ -140,6 +218,20 @@ void Trajectory::addMinimumTorqueFactors(
   }
 }
 
+void Trajectory::addMinimumTorqueBlockFactors(
+    gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+    const SharedNoiseModel &cost_model) const {
+  if (robot.numJoints() == 0) return;
+  int K = getEndTimeStep(numPhases() - 1);
+  gtsam::KeyVector torque_keys(robot.numJoints());
+  for (int k = 0; k <= K; k++) {
+    for (size_t j = 0; j < torque_keys.size(); j++) {
+      torque_keys[j] = TorqueKey(robot.joints()[j]->id(), k);
+    }
+    graph->emplace_shared<MinTorqueBlockFactor>(torque_keys, cost_model);
+  }
+}
+
 void Trajectory::writePhaseToFile(const Robot &robot, std::ofstream &file,
                                   const gtsam::Values &results, int p) const {
   using gtsam::Matrix;
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/MinTorqueBlockFactor.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
@@ -21,6 +22,11 @@
 #include <gtdynamics/utils/WalkCycle.h>
 #include <gtdynamics/utils/Initializer.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -30,6 +36,33 @@ namespace gtdynamics {
 class Trajectory {
  protected:
   std::vector<Phase> phases_;  ///< All phases in the trajectory
+  size_t cycle_phases_ = 0;    ///< Number of phases in one walk cycle
+  size_t repeat_ = 0;          ///< Number of walk cycle repetitions
+
+  /// Contact points of every phase and transition, computed once.
+  std::vector<PointOnLinks> phase_contact_points_, transition_contact_points_;
+
+  /// Final time step of every phase, a prefix sum of the phase durations.
+  std::vector<int> final_timesteps_;
+
+  /// Compute the contact points and phase boundaries of phases_.
+  void cachePhases() {
+    const WalkCycle wc(phases_);
+    phase_contact_points_ = wc.allPhasesContactPoints();
+    transition_contact_points_ = wc.transitionContactPoints();
+    final_timesteps_.clear();
+    final_timesteps_.reserve(phases_.size());
+    int final_timestep = 0;
+    for (auto &&phase : phases_) {
+      final_timestep += phase.numTimeSteps();
+      final_timesteps_.push_back(final_timestep);
+    }
+  }
+
+  /// multiPhaseFactorGraph, reusing the graphs of the first walk cycle.
+  gtsam::NonlinearFactorGraph repeatedCycleFactorGraph(
+      const Robot &robot, const DynamicsGraph &graph_builder,
+      const CollocationScheme collocation, double mu) const;
 
  public:
   /// Default Constructor (for serialization)
@@ -44,7 +77,8 @@ class Trajectory {
    * @param walk_cycle  The Walk Cycle for the robot.
    * @param repeat      The number of repetitions for each phase of the gait.
    */
-  Trajectory(const WalkCycle &walk_cycle, size_t repeat) {
+  Trajectory(const WalkCycle &walk_cycle, size_t repeat)
+      : cycle_phases_(walk_cycle.numPhases()), repeat_(repeat) {
     // Get phases of walk_cycle.
     auto phases_i = walk_cycle.phases();
     // Loop over `repeat` walk cycles W_i
@@ -52,6 +86,7 @@ class Trajectory {
       // Append phases_i of walk_cycle to phases_ vector member.
       phases_.insert(phases_.end(), phases_i.begin(), phases_i.end());
     }
+    cachePhases();
   }
 
   /// Returns vector of phases in the trajectory
@@ -64,9 +99,8 @@ class Trajectory {
    * and may have repetitions, as opposed to contact_points_.
    * @return Phase CPs.
    */
-  std::vector<PointOnLinks> phaseContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.allPhasesContactPoints();
+  const std::vector<PointOnLinks> &phaseContactPoints() const {
+    return phase_contact_points_;
   }
 
   /**
@@ -74,9 +108,8 @@ class Trajectory {
    * phases after applying repetition on the original sequence.
    * @return Transition CPs.
    */
-  std::vector<PointOnLinks> transitionContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.transitionContactPoints();
+  const std::vector<PointOnLinks> &transitionContactPoints() const {
+    return transition_contact_points_;
   }
 
   /**
@@ -110,15 +143,25 @@ class Trajectory {
 
   /**
    * @fn Builds multi-phase factor graph.
+   *
+   * Every repetition of the walk cycle has the same phases, so with
+   * reuse_cycles the factors of the first cycle are built once, and later
+   * cycles get RekeyedFactors sharing them, shifted in time by the steps of
+   * a cycle and in PhaseKey by its number of phases. The graph has the same
+   * factors either way, in a different order.
+   *
    * @param[in] robot            Robot specification from URDF/SDF.
    * @param[in] graph_builder    GraphBuilder instance.
    * @param[in] collocation      Which collocation scheme to use.
    * @param[in] mu               Coefficient of static friction.
+   * @param[in] reuse_cycles     Reuse the graphs of the first walk cycle.
+   * @param[out] index           If given, the time index to append to.
    * @return Multi-phase factor graph
    */
   gtsam::NonlinearFactorGraph multiPhaseFactorGraph(
       const Robot &robot, const DynamicsGraph &graph_builder,
-      const CollocationScheme collocation, double mu) const;
+      const CollocationScheme collocation, double mu,
+      bool reuse_cycles = false, FactorTimeIndex *index = nullptr) const;
 
   /**
    * @fn Returns Initial values for transition graphs.
@@ -146,16 +189,7 @@ class Trajectory {
    * @fn Returns a vector of final time step for every phase.
    * @return Vector of final time steps.
    */
-  std::vector<int> finalTimeSteps() const {
-    int final_timestep = 0;
-    std::vector<int> final_timesteps;
-    for (size_t i = 0; i < phases_.size(); i++) {
-      int phase_timestep = phases_[i].numTimeSteps();
-      final_timestep += phase_timestep;
-      final_timesteps.push_back(final_timestep);
-    }
-    return final_timesteps;
-  }
+  const std::vector<int> &finalTimeSteps() const { return final_timesteps_; }
 
   /**
    * @fn Return phase for given phase number p.
@@ -170,10 +204,7 @@ class Trajectory {
    * @return Initial time step.
    */
   int getStartTimeStep(size_t p) const {
-    std::vector<int> final_timesteps = finalTimeSteps();
-    int k_start = final_timesteps[p] - phase(p).numTimeSteps();
-    if (p != 0) k_start += 1;
-    return k_start;
+    return p == 0 ? 0 : final_timesteps_[p - 1] + 1;
   }
 
   /**
@@ -181,7 +212,23 @@ class Trajectory {
    * @param[in] p    Phase number.
    * @return Final time step.
    */
-  int getEndTimeStep(size_t p) const { return finalTimeSteps()[p]; }
+  int getEndTimeStep(size_t p) const { return final_timesteps_[p]; }
+
+  /**
+   * @fn Returns the phase containing a time step, i.e., the p for which
+   * getStartTimeStep(p) <= k <= getEndTimeStep(p), in O(log numPhases()).
+   * @param[in] k    Time step in [0..getEndTimeStep(numPhases() - 1)].
+   * @return Phase number.
+   */
+  size_t phaseIndex(int k) const {
+    auto it = std::lower_bound(final_timesteps_.begin(),
+                               final_timesteps_.end(), k);
+    if (k < 0 || it == final_timesteps_.end()) {
+      throw std::out_of_range("Trajectory: time step " + std::to_string(k) +
+                              " is not in any phase");
+    }
+    return it - final_timesteps_.begin();
+  }
 
   /**
    * @fn Generates a PointGoalFactor object
@@ -227,6 +274,17 @@ class Trajectory {
                                const Robot &robot,
                                const gtsam::SharedNoiseModel &cost_model) const;
 
+  /**
+   * @fn Add minimum torque objectives as one MinTorqueBlockFactor per time
+   * step, with the same error as addMinimumTorqueFactors.
+   * @param[in,out] graph nonlinear factor graph to add to.
+   * @param[in] robot Robot specification from URDF/SDF.
+   * @param[in] cost_model 1-dimensional diagonal noise model of every torque
+   */
+  void addMinimumTorqueBlockFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const gtsam::SharedNoiseModel &cost_model) const;
+
   /**
    * @fn Create objective factors for slice 0 and slice K.
    *
@@ -255,7 +313,7 @@ class Trajectory {
    */
   void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph *graph,
                                  double desired_dt, double sigma = 0) const {
-    auto model = gtsam::noiseModel::Isotropic::Sigma(1, sigma);
+    auto model = SharedIsotropic(1, sigma);
     for (size_t phase = 0; phase < numPhases(); phase++)
       graph->addPrior<double>(PhaseKey(phase), desired_dt, model);
   }
@@ -0,0 +1,218 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryBuffer.cpp
+ * @brief Contiguous per-quantity storage of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace {
+constexpr uint16_t kNone = DynamicsSymbol::kNoIndex;
+
+// Quantity of a joint (link == kNone) or link (joint == kNone) state key,
+// or 0 for any other key.
+unsigned QuantityOf(const DynamicsSymbol &symbol) {
+  const bool joint = symbol.linkIdx() == kNone && symbol.jointIdx() != kNone;
+  const bool link = symbol.jointIdx() == kNone && symbol.linkIdx() != kNone;
+  if (!joint && !link) return 0;
+  const std::string label = symbol.label();
+  if (label.size() != 1) return 0;
+  if (joint) {
+    switch (label[0]) {
+      case 'q':
+        return TrajectoryBuffer::kJointAngles;
+      case 'v':
+        return TrajectoryBuffer::kJointVels;
+      case 'a':
+        return TrajectoryBuffer::kJointAccels;
+      case 'T':
+        return TrajectoryBuffer::kTorques;
+    }
+  } else {
+    switch (label[0]) {
+      case 'p':
+        return TrajectoryBuffer::kPoses;
+      case 'V':
+        return TrajectoryBuffer::kTwists;
+    }
+  }
+  return 0;
+}
+}  // namespace
+
+/* ************************************************************************* */
+TrajectoryBuffer::TrajectoryBuffer(const Robot &robot, size_t num_steps)
+    : joint_index_(robot.topology().joint_index),
+      link_index_(robot.topology().link_index),
+      num_steps_(num_steps),
+      quantities_(kAll) {
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  for (auto &&link : robot.links()) {
+    link_ids_.push_back(link->id());
+    comTlinks_.push_back(link->bMcom().between(link->bMlink()));
+  }
+  const size_t num_joints = joint_ids_.size(), num_links = link_ids_.size();
+  q_.setZero(num_steps, num_joints);
+  v_.setZero(num_steps, num_joints);
+  a_.setZero(num_steps, num_joints);
+  torques_.setZero(num_steps, num_joints);
+  poses_.assign(num_links * num_steps, Pose3());
+  twists_.setZero(6, num_links * num_steps);
+}
+
+/* ************************************************************************* */
+TrajectoryBuffer TrajectoryBuffer::FromValues(
+    const Robot &robot, const Values &values,
+    const boost::optional<size_t> &num_steps) {
+  const auto &topology = robot.topology();
+
+  // Decode each key once, keeping only states of this robot's joints and
+  // links.
+  struct Entry {
+    unsigned quantity;
+    int index;
+    size_t t;
+    const gtsam::Value *value;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(values.size());
+  size_t max_steps = 0;
+  for (const auto &key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const unsigned quantity = QuantityOf(symbol);
+    if (!quantity) continue;
+    const int index = symbol.linkIdx() == kNone
+                          ? topology.joint_index[symbol.jointIdx()]
+                          : topology.link_index[symbol.linkIdx()];
+    if (index < 0) continue;
+    entries.push_back({quantity, index, size_t(symbol.time()),
+                       &key_value.value});
+    max_steps = std::max<size_t>(max_steps, symbol.time() + 1);
+  }
+
+  TrajectoryBuffer buffer(robot, num_steps ? *num_steps : max_steps);
+  buffer.quantities_ = 0;
+  const size_t n = buffer.num_steps_;
+  for (const Entry &e : entries) {
+    if (e.t >= n) continue;
+    buffer.quantities_ |= e.quantity;
+    switch (e.quantity) {
+      case kJointAngles:
+        buffer.q_(e.t, e.index) = e.value->cast<double>();
+        break;
+      case kJointVels:
+        buffer.v_(e.t, e.index) = e.value->cast<double>();
+        break;
+      case kJointAccels:
+        buffer.a_(e.t, e.index) = e.value->cast<double>();
+        break;
+      case kTorques:
+        buffer.torques_(e.t, e.index) = e.value->cast<double>();
+        break;
+      case kPoses:
+        buffer.poses_[e.index * n + e.t] = e.value->cast<Pose3>();
+        break;
+      case kTwists:
+        buffer.twists_.col(e.index * n + e.t) = e.value->cast<Vector6>();
+        break;
+    }
+  }
+  return buffer;
+}
+
+/* ************************************************************************* */
+void TrajectoryBuffer::resize(size_t num_steps) {
+  const size_t num_joints = joint_ids_.size(), num_links = link_ids_.size();
+  const size_t kept = std::min(num_steps, num_steps_);
+  for (Matrix *m : {&q_, &v_, &a_, &torques_}) {
+    Matrix resized = Matrix::Zero(num_steps, num_joints);
+    resized.topRows(kept) = m->topRows(kept);
+    m->swap(resized);
+  }
+
+  // Links are stored link-major, so every link's time series moves.
+  std::vector<Pose3> poses(num_links * num_steps, Pose3());
+  Matrix twists = Matrix::Zero(6, num_links * num_steps);
+  for (size_t i = 0; i < num_links; i++) {
+    std::copy_n(poses_.begin() + i * num_steps_, kept,
+                poses.begin() + i * num_steps);
+    twists.middleCols(i * num_steps, kept) =
+        twists_.middleCols(i * num_steps_, kept);
+  }
+  poses_.swap(poses);
+  twists_.swap(twists);
+  num_steps_ = num_steps;
+}
+
+/* ************************************************************************* */
+void TrajectoryBuffer::insert(
+    Values *values, const boost::optional<unsigned> &quantities) const {
+  const unsigned q = quantities ? *quantities : quantities_;
+  for (size_t j = 0; j < joint_ids_.size(); j++) {
+    const int id = joint_ids_[j];
+    for (size_t t = 0; t < num_steps_; t++) {
+      if (q & kJointAngles) InsertJointAngle(values, id, t, q_(t, j));
+      if (q & kJointVels) InsertJointVel(values, id, t, v_(t, j));
+      if (q & kJointAccels) InsertJointAccel(values, id, t, a_(t, j));
+      if (q & kTorques) InsertTorque(values, id, t, torques_(t, j));
+    }
+  }
+  for (size_t i = 0; i < link_ids_.size(); i++) {
+    const int id = link_ids_[i];
+    for (size_t t = 0; t < num_steps_; t++) {
+      const size_t slot = i * num_steps_ + t;
+      if (q & kPoses) InsertPose(values, id, t, poses_[slot]);
+      if (q & kTwists) InsertTwist(values, id, t, twists_.col(slot));
+    }
+  }
+}
+
+/* ************************************************************************* */
+void TrajectoryBuffer::poseMatrices(double *out, PoseFrame frame) const {
+  const size_t num_links = link_ids_.size();
+  for (size_t t = 0; t < num_steps_; t++) {
+    for (size_t i = 0; i < num_links; i++, out += 16) {
+      const Pose3 &wTcom = poses_[i * num_steps_ + t];
+      const Pose3 pose =
+          frame == kLinkFrame ? wTcom.compose(comTlinks_[i]) : wTcom;
+      Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(out) =
+          pose.matrix();
+    }
+  }
+}
+
+/* ************************************************************************* */
+std::vector<double> TrajectoryBuffer::poseMatrices(PoseFrame frame) const {
+  std::vector<double> matrices(num_steps_ * link_ids_.size() * 16);
+  poseMatrices(matrices.data(), frame);
+  return matrices;
+}
+
+/* ************************************************************************* */
+Values TrajectoryBuffer::values(
+    const boost::optional<unsigned> &quantities) const {
+  Values values;
+  insert(&values, quantities);
+  return values;
+}
+
+}  // namespace gtdynamics
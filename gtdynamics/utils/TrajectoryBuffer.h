@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryBuffer.h
+ * @brief Contiguous per-quantity storage of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryBuffer stores the joint and link states of a robot over a number
+ * of time steps in contiguous arrays, as an alternative to looking up every
+ * (joint, time) pair in a gtsam::Values.
+ *
+ * Joint quantities are numSteps x numJoints matrices, so the time series of a
+ * joint is contiguous; link poses and twists are stored link-major, so the
+ * time series of a link is contiguous too. Joints and links are indexed as in
+ * Robot::joints() and Robot::links(), and accessors take their ids.
+ *
+ * Conversion from Values is a single pass over the Values; keys of other
+ * quantities, or beyond the last time step, are ignored.
+ */
+class TrajectoryBuffer {
+ public:
+  /// Flags for the quantities held by a buffer.
+  enum Quantity : unsigned {
+    kJointAngles = 1,
+    kJointVels = 2,
+    kJointAccels = 4,
+    kTorques = 8,
+    kPoses = 16,
+    kTwists = 32,
+    kAll = 63
+  };
+
+  /// Frames of the link poses exported by poseMatrices.
+  enum PoseFrame : unsigned { kComFrame = 0, kLinkFrame = 1 };
+
+ private:
+  std::vector<uint16_t> joint_ids_, link_ids_;
+  std::vector<int> joint_index_, link_index_;
+  size_t num_steps_;
+  unsigned quantities_;
+
+  gtsam::Matrix q_, v_, a_, torques_;
+  std::vector<gtsam::Pose3> poses_;  // link-major, numLinks * numSteps
+  std::vector<gtsam::Pose3> comTlinks_;  // link frames in CoM frames
+  gtsam::Matrix twists_;             // 6 x (numLinks * numSteps), link-major
+
+  size_t linkSlot(uint16_t link_id, size_t t) const {
+    return size_t(link_index_.at(link_id)) * num_steps_ + t;
+  }
+
+ public:
+  /**
+   * Constructor, with all quantities zero and poses at the identity.
+   * @param robot     the robot
+   * @param num_steps number of time steps
+   */
+  TrajectoryBuffer(const Robot &robot, size_t num_steps);
+
+  /**
+   * Fill a buffer from Values.
+   * @param robot     the robot
+   * @param values    values with keys from values.h
+   * @param num_steps number of time steps, by default one more than the
+   * largest time step of a joint or link state in values
+   */
+  static TrajectoryBuffer FromValues(
+      const Robot &robot, const gtsam::Values &values,
+      const boost::optional<size_t> &num_steps = boost::none);
+
+  /**
+   * Insert the contents into Values.
+   * @param values     values to insert into, must not contain the keys
+   * @param quantities bitwise or of Quantity flags, by default those that
+   * were present when filled from Values
+   */
+  void insert(gtsam::Values *values,
+              const boost::optional<unsigned> &quantities = boost::none) const;
+
+  /// Values with the contents, see insert.
+  gtsam::Values values(
+      const boost::optional<unsigned> &quantities = boost::none) const;
+
+  /// Number of time steps.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Number of links.
+  size_t numLinks() const { return link_ids_.size(); }
+
+  /**
+   * Change the number of time steps, keeping the contents of the steps that
+   * remain; new steps are zero with poses at the identity.
+   */
+  void resize(size_t num_steps);
+
+  /// Quantities read by FromValues, or kAll for a constructed buffer.
+  unsigned quantities() const { return quantities_; }
+
+  /// Joint angles, numSteps x numJoints.
+  const gtsam::Matrix &jointAngles() const { return q_; }
+  gtsam::Matrix &jointAngles() { return q_; }
+
+  /// Joint velocities, numSteps x numJoints.
+  const gtsam::Matrix &jointVels() const { return v_; }
+  gtsam::Matrix &jointVels() { return v_; }
+
+  /// Joint accelerations, numSteps x numJoints.
+  const gtsam::Matrix &jointAccels() const { return a_; }
+  gtsam::Matrix &jointAccels() { return a_; }
+
+  /// Joint torques, numSteps x numJoints.
+  const gtsam::Matrix &torques() const { return torques_; }
+  gtsam::Matrix &torques() { return torques_; }
+
+  /// Column of a joint in the joint matrices.
+  int jointIndex(uint16_t joint_id) const { return joint_index_.at(joint_id); }
+
+  /// Angle of joint j at time t.
+  double &jointAngle(uint16_t j, size_t t) { return q_(t, jointIndex(j)); }
+  double jointAngle(uint16_t j, size_t t) const { return q_(t, jointIndex(j)); }
+
+  /// Velocity of joint j at time t.
+  double &jointVel(uint16_t j, size_t t) { return v_(t, jointIndex(j)); }
+  double jointVel(uint16_t j, size_t t) const { return v_(t, jointIndex(j)); }
+
+  /// Acceleration of joint j at time t.
+  double &jointAccel(uint16_t j, size_t t) { return a_(t, jointIndex(j)); }
+  double jointAccel(uint16_t j, size_t t) const { return a_(t, jointIndex(j)); }
+
+  /// Torque of joint j at time t.
+  double &torque(uint16_t j, size_t t) { return torques_(t, jointIndex(j)); }
+  double torque(uint16_t j, size_t t) const {
+    return torques_(t, jointIndex(j));
+  }
+
+  /// Column of a link in the twist matrix is linkIndex * numSteps + t.
+  int linkIndex(uint16_t link_id) const { return link_index_.at(link_id); }
+
+  /// Link twists, 6 x (numLinks * numSteps), link-major.
+  const gtsam::Matrix &twists() const { return twists_; }
+  gtsam::Matrix &twists() { return twists_; }
+
+  /// CoM pose of link i at time t.
+  gtsam::Pose3 &pose(uint16_t i, size_t t) { return poses_[linkSlot(i, t)]; }
+  const gtsam::Pose3 &pose(uint16_t i, size_t t) const {
+    return poses_[linkSlot(i, t)];
+  }
+
+  /// Twist of link i at time t.
+  Eigen::Block<gtsam::Matrix, 6, 1> twist(uint16_t i, size_t t) {
+    return twists_.block<6, 1>(0, linkSlot(i, t));
+  }
+  gtsam::Vector6 twist(uint16_t i, size_t t) const {
+    return twists_.block<6, 1>(0, linkSlot(i, t));
+  }
+
+  /**
+   * Export the poses of all links at all steps as homogeneous 4x4 matrices,
+   * in one numSteps x numLinks x 4 x 4 array of doubles in row-major order,
+   * the layout of a C-contiguous NumPy array: the matrix of the link with
+   * index i at step t starts at (t * numLinks + i) * 16. Renderers can then
+   * animate a trajectory without a lookup per link and frame.
+   *
+   * @param out   array of numSteps * numLinks * 16 doubles
+   * @param frame CoM frames as stored, or link frames, in which the visual
+   * meshes of URDF and SDF models are defined
+   */
+  void poseMatrices(double *out, PoseFrame frame = kComFrame) const;
+
+  /// Pose matrices in a new vector, see poseMatrices(double *, PoseFrame).
+  std::vector<double> poseMatrices(PoseFrame frame = kComFrame) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryCodec.cpp
+ * @brief Compact, streamable encoding of the joint series of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/TrajectoryCodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+constexpr uint8_t kHeaderTag = 'H', kChunkTag = 'C';
+constexpr size_t kNumQuantities = 4;  // angles, velocities, accels, torques
+
+// Largest quantized magnitude, so that the second differences of the
+// predictor cannot overflow.
+constexpr double kMaxQuantized = 1e15;
+
+typedef Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic> IntMatrix;
+
+void PutVarint(uint64_t value, std::vector<uint8_t> *out) {
+  while (value >= 0x80) {
+    out->push_back(uint8_t(value) | 0x80);
+    value >>= 7;
+  }
+  out->push_back(uint8_t(value));
+}
+
+void PutSigned(int64_t value, std::vector<uint8_t> *out) {
+  PutVarint((uint64_t(value) << 1) ^ uint64_t(value >> 63), out);
+}
+
+// Reads a message, throwing on truncation.
+class Reader {
+  const std::vector<uint8_t> &data_;
+  size_t offset_;
+
+ public:
+  Reader(const std::vector<uint8_t> &data, size_t offset)
+      : data_(data), offset_(offset) {}
+
+  bool done() const { return offset_ == data_.size(); }
+
+  uint8_t byte() {
+    if (offset_ >= data_.size()) {
+      throw std::runtime_error("TrajectoryDecoder: truncated message");
+    }
+    return data_[offset_++];
+  }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = byte();
+      value |= uint64_t(b & 0x7f) << shift;
+      if (!(b & 0x80)) return value;
+    }
+    throw std::runtime_error("TrajectoryDecoder: malformed integer");
+  }
+
+  int64_t signedVarint() {
+    const uint64_t z = varint();
+    return int64_t(z >> 1) ^ -int64_t(z & 1);
+  }
+
+  double real() {
+    double value;
+    uint8_t bytes[sizeof(double)];
+    for (auto &b : bytes) b = byte();
+    std::memcpy(&value, bytes, sizeof(double));
+    return value;
+  }
+};
+
+double Tolerance(const TrajectoryCodecParameters &parameters, size_t k) {
+  const double tolerances[kNumQuantities] = {
+      parameters.angle_tolerance, parameters.vel_tolerance,
+      parameters.accel_tolerance, parameters.torque_tolerance};
+  return tolerances[k];
+}
+
+gtsam::Matrix &Series(TrajectoryBuffer *buffer, size_t k) {
+  switch (k) {
+    case 0:
+      return buffer->jointAngles();
+    case 1:
+      return buffer->jointVels();
+    case 2:
+      return buffer->jointAccels();
+    default:
+      return buffer->torques();
+  }
+}
+
+const gtsam::Matrix &Series(const TrajectoryBuffer &buffer, size_t k) {
+  switch (k) {
+    case 0:
+      return buffer.jointAngles();
+    case 1:
+      return buffer.jointVels();
+    case 2:
+      return buffer.jointAccels();
+    default:
+      return buffer.torques();
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+TrajectoryEncoder::TrajectoryEncoder(
+    const TrajectoryBuffer &buffer,
+    const TrajectoryCodecParameters &parameters)
+    : parameters_(parameters),
+      num_steps_(buffer.numSteps()),
+      num_joints_(buffer.jointAngles().cols()),
+      quantized_(kNumQuantities) {
+  if (parameters.chunk_steps == 0 ||
+      (parameters.quantities & ~((1u << kNumQuantities) - 1))) {
+    throw std::invalid_argument(
+        "TrajectoryEncoder: chunk_steps must be positive and quantities "
+        "joint quantities");
+  }
+  for (size_t k = 0; k < kNumQuantities; k++) {
+    if (!(parameters.quantities & (1u << k))) continue;
+    const double step = 2 * Tolerance(parameters, k);
+    if (!(step > 0)) {
+      throw std::invalid_argument(
+          "TrajectoryEncoder: tolerances must be positive");
+    }
+    const gtsam::Matrix scaled = Series(buffer, k) / step;
+    if (!scaled.allFinite() || scaled.cwiseAbs().maxCoeff() > kMaxQuantized) {
+      throw std::invalid_argument(
+          "TrajectoryEncoder: values not finite or too large for their "
+          "tolerance");
+    }
+    quantized_[k] = scaled.array().round().matrix().cast<int64_t>();
+  }
+}
+
+/* ************************************************************************* */
+std::vector<uint8_t> TrajectoryEncoder::header() const {
+  std::vector<uint8_t> out{kHeaderTag, kTrajectoryCodecVersion};
+  PutVarint(num_joints_, &out);
+  PutVarint(num_steps_, &out);
+  PutVarint(parameters_.chunk_steps, &out);
+  out.push_back(uint8_t(parameters_.quantities));
+  for (size_t k = 0; k < kNumQuantities; k++) {
+    const double tolerance = Tolerance(parameters_, k);
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&tolerance);
+    out.insert(out.end(), bytes, bytes + sizeof(double));
+  }
+  return out;
+}
+
+/* ************************************************************************* */
+size_t TrajectoryEncoder::numChunks() const {
+  return (num_steps_ + parameters_.chunk_steps - 1) / parameters_.chunk_steps;
+}
+
+/* ************************************************************************* */
+std::vector<uint8_t> TrajectoryEncoder::chunk(size_t i) const {
+  if (i >= numChunks()) {
+    throw std::out_of_range("TrajectoryEncoder::chunk: no such chunk");
+  }
+  const size_t start = i * parameters_.chunk_steps,
+               end = std::min(num_steps_, start + parameters_.chunk_steps);
+  std::vector<uint8_t> out{kChunkTag};
+  PutVarint(i, &out);
+  for (size_t k = 0; k < kNumQuantities; k++) {
+    if (!(parameters_.quantities & (1u << k))) continue;
+    const IntMatrix &x = quantized_[k];
+    for (size_t j = 0; j < num_joints_; j++) {
+      // Predict by linear extrapolation, from the start of the chunk.
+      for (size_t t = start; t < end; t++) {
+        int64_t prediction = 0;
+        if (t >= start + 2) {
+          prediction = 2 * x(t - 1, j) - x(t - 2, j);
+        } else if (t == start + 1) {
+          prediction = x(t - 1, j);
+        }
+        PutSigned(x(t, j) - prediction, &out);
+      }
+    }
+  }
+  return out;
+}
+
+/* ************************************************************************* */
+TrajectoryDecoder::TrajectoryDecoder(const Robot &robot)
+    : buffer_(robot, 0), num_joints_(robot.joints().size()) {}
+
+/* ************************************************************************* */
+void TrajectoryDecoder::add(const std::vector<uint8_t> &message) {
+  Reader reader(message, 0);
+  const uint8_t tag = reader.byte();
+  if (tag == kHeaderTag) {
+    if (reader.byte() != kTrajectoryCodecVersion) {
+      throw std::runtime_error("TrajectoryDecoder: unsupported version");
+    }
+    if (reader.varint() != num_joints_) {
+      throw std::runtime_error(
+          "TrajectoryDecoder: number of joints does not match the robot");
+    }
+    const size_t num_steps = reader.varint();
+    chunk_steps_ = reader.varint();
+    quantities_ = reader.byte();
+    steps_.resize(kNumQuantities);
+    for (double &step : steps_) step = 2 * reader.real();
+    if (chunk_steps_ == 0) {
+      throw std::runtime_error("TrajectoryDecoder: malformed header");
+    }
+    buffer_.resize(0);
+    buffer_.resize(num_steps);
+    received_.assign((num_steps + chunk_steps_ - 1) / chunk_steps_, false);
+    has_header_ = true;
+  } else if (tag == kChunkTag) {
+    if (!has_header_) {
+      throw std::runtime_error("TrajectoryDecoder: chunk before the header");
+    }
+    const size_t i = reader.varint();
+    if (i >= received_.size()) {
+      throw std::runtime_error("TrajectoryDecoder: chunk index out of range");
+    }
+    const size_t start = i * chunk_steps_,
+                 end = std::min(buffer_.numSteps(), start + chunk_steps_);
+    std::vector<int64_t> x(end - start);
+    for (size_t k = 0; k < kNumQuantities; k++) {
+      if (!(quantities_ & (1u << k))) continue;
+      gtsam::Matrix &series = Series(&buffer_, k);
+      for (size_t j = 0; j < num_joints_; j++) {
+        for (size_t n = 0; n < x.size(); n++) {
+          const int64_t prediction =
+              n >= 2 ? 2 * x[n - 1] - x[n - 2] : n == 1 ? x[0] : 0;
+          x[n] = prediction + reader.signedVarint();
+          series(start + n, j) = double(x[n]) * steps_[k];
+        }
+      }
+    }
+    if (!reader.done()) {
+      throw std::runtime_error("TrajectoryDecoder: malformed chunk");
+    }
+    received_[i] = true;
+  } else {
+    throw std::runtime_error("TrajectoryDecoder: unknown message");
+  }
+}
+
+/* ************************************************************************* */
+size_t TrajectoryDecoder::numReadySteps() const {
+  const size_t ready = std::find(received_.begin(), received_.end(), false) -
+                       received_.begin();
+  return std::min(buffer_.numSteps(), ready * chunk_steps_);
+}
+
+/* ************************************************************************* */
+bool TrajectoryDecoder::complete() const {
+  return has_header_ &&
+         std::find(received_.begin(), received_.end(), false) ==
+             received_.end();
+}
+
+/* ************************************************************************* */
+TrajectoryBuffer TrajectoryDecoder::Decode(
+    const Robot &robot, const std::vector<std::vector<uint8_t>> &messages) {
+  TrajectoryDecoder decoder(robot);
+  for (auto &&message : messages) decoder.add(message);
+  if (!decoder.complete()) {
+    throw std::runtime_error("TrajectoryDecoder::Decode: missing chunks");
+  }
+  return decoder.buffer();
+}
+
+}  // namespace gtdynamics
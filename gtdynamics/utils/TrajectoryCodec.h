@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryCodec.h
+ * @brief Compact, streamable encoding of the joint series of a trajectory.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Version of the trajectory stream format, bumped whenever it changes.
+constexpr uint8_t kTrajectoryCodecVersion = 1;
+
+/// Parameters of TrajectoryEncoder.
+struct TrajectoryCodecParameters {
+  /// Largest decoding error of each joint quantity.
+  double angle_tolerance = 1e-4, vel_tolerance = 1e-3,
+         accel_tolerance = 1e-2, torque_tolerance = 1e-2;
+  /// Joint quantities to send, as TrajectoryBuffer::Quantity flags.
+  unsigned quantities = TrajectoryBuffer::kJointAngles |
+                        TrajectoryBuffer::kJointVels |
+                        TrajectoryBuffer::kJointAccels |
+                        TrajectoryBuffer::kTorques;
+  size_t chunk_steps = 25;  // time steps per chunk
+};
+
+/**
+ * TrajectoryEncoder encodes the joint series of a trajectory for links with
+ * little bandwidth. Every value is quantized to a multiple of twice its
+ * tolerance, so it decodes to within the tolerance; the quantized series of
+ * each joint is predicted by linear extrapolation from the two previous
+ * steps, and the prediction errors, which are small integers for smooth
+ * trajectories, are written as zigzag variable-length integers.
+ *
+ * The stream is a header message followed by chunks of chunk_steps time
+ * steps. Every chunk decodes on its own, so a robot can start executing
+ * after the first chunk, and lost chunks only lose their own steps. Like
+ * TrajectoryLog files, the tolerances in the header are native-endian.
+ */
+class TrajectoryEncoder {
+ public:
+  /**
+   * Constructor, quantizes the buffer; throws std::invalid_argument for
+   * values that are not finite or too large for their tolerance.
+   * @param buffer     the trajectory
+   * @param parameters tolerances and chunk size
+   */
+  explicit TrajectoryEncoder(const TrajectoryBuffer &buffer,
+                             const TrajectoryCodecParameters &parameters =
+                                 TrajectoryCodecParameters());
+
+  /// The header message, to send first.
+  std::vector<uint8_t> header() const;
+
+  /// Number of chunks.
+  size_t numChunks() const;
+
+  /// Chunk message i, encoding steps i * chunk_steps onwards.
+  std::vector<uint8_t> chunk(size_t i) const;
+
+ private:
+  TrajectoryCodecParameters parameters_;
+  size_t num_steps_, num_joints_;
+  /// Quantized series, one numSteps x numJoints matrix per sent quantity.
+  std::vector<Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>>
+      quantized_;
+};
+
+/**
+ * TrajectoryDecoder rebuilds the joint series of a trajectory from the
+ * messages of a TrajectoryEncoder, received in any order after the header.
+ */
+class TrajectoryDecoder {
+ public:
+  /// Constructor, for the robot of the encoded buffer.
+  explicit TrajectoryDecoder(const Robot &robot);
+
+  /**
+   * Decode a header or chunk message; throws std::runtime_error for
+   * malformed messages, or chunks before the header.
+   */
+  void add(const std::vector<uint8_t> &message);
+
+  /// Whether the header has been decoded.
+  bool hasHeader() const { return has_header_; }
+
+  /// Number of steps from the start decoded without gaps, ready to execute.
+  size_t numReadySteps() const;
+
+  /// Whether all chunks have been decoded.
+  bool complete() const;
+
+  /**
+   * The decoded trajectory, zero where not decoded yet. Only the sent joint
+   * quantities are set.
+   */
+  const TrajectoryBuffer &buffer() const { return buffer_; }
+
+  /// Decode a whole stream, header first, returning the trajectory.
+  static TrajectoryBuffer Decode(
+      const Robot &robot, const std::vector<std::vector<uint8_t>> &messages);
+
+ private:
+  TrajectoryBuffer buffer_;
+  size_t num_joints_;
+  bool has_header_ = false;
+  unsigned quantities_ = 0;
+  size_t chunk_steps_ = 0;
+  std::vector<double> steps_;  // quantization step of each quantity
+  std::vector<bool> received_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,437 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryLog.cpp
+ * @brief Columnar binary trajectory logs, appended step by step.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/MappedFile.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix3;
+using gtsam::Pose3;
+using gtsam::Value;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'D', 'T', 'R', 'A', 'J', 0};
+
+/// Fixed header at the start of a log file.
+struct LogHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_columns;
+};
+
+/// A column in the log header.
+struct ColumnRecord {
+  char label[2];
+  uint8_t robot;
+  uint8_t type;
+  uint16_t link;
+  uint16_t joint;
+};
+
+/// Header of a chunk, followed by num_steps * step_dim doubles.
+struct ChunkHeader {
+  uint32_t num_steps;
+  uint32_t reserved;
+};
+
+/// Key of the column of a variable: its symbol at time 0.
+Key ColumnKey(Key key) { return DynamicsSymbol(key).atTime(0); }
+
+ColumnRecord Record(const TrajectoryLogColumn &column) {
+  const DynamicsSymbol symbol(column.key);
+  const std::string label = symbol.label();
+  ColumnRecord record;
+  record.label[0] = label.size() > 0 ? label[0] : 0;
+  record.label[1] = label.size() > 1 ? label[1] : 0;
+  record.robot = symbol.robotIdx();
+  record.type = column.type;
+  record.link = symbol.linkIdx();
+  record.joint = symbol.jointIdx();
+  return record;
+}
+
+TrajectoryLogColumn Column(const ColumnRecord &record) {
+  switch (record.type) {
+    case TrajectoryLogColumn::kDouble:
+    case TrajectoryLogColumn::kVector3:
+    case TrajectoryLogColumn::kVector6:
+    case TrajectoryLogColumn::kPose3:
+      break;
+    default:
+      throw std::runtime_error("TrajectoryLog: unknown column type");
+  }
+  std::string label;
+  for (char c : record.label)
+    if (c) label += c;
+  const Key key =
+      DynamicsSymbol::LinkJointSymbol(label, record.link, record.joint, 0)
+          .ofRobot(record.robot);
+  return {key, static_cast<TrajectoryLogColumn::Type>(record.type)};
+}
+
+/// Fill the offsets in a step and the key to column map, returns step size.
+size_t Layout(const std::vector<TrajectoryLogColumn> &columns,
+              std::vector<size_t> *offsets,
+              std::map<Key, size_t> *column_index) {
+  size_t step_dim = 0;
+  offsets->clear();
+  column_index->clear();
+  for (size_t c = 0; c < columns.size(); c++) {
+    offsets->push_back(step_dim);
+    column_index->emplace(columns[c].key, c);
+    step_dim += columns[c].dim();
+  }
+  return step_dim;
+}
+
+TrajectoryLogColumn::Type TypeOf(const Value &value, Key key) {
+  if (dynamic_cast<const gtsam::GenericValue<double> *>(&value))
+    return TrajectoryLogColumn::kDouble;
+  if (dynamic_cast<const gtsam::GenericValue<Vector3> *>(&value))
+    return TrajectoryLogColumn::kVector3;
+  if (dynamic_cast<const gtsam::GenericValue<Vector6> *>(&value))
+    return TrajectoryLogColumn::kVector6;
+  if (dynamic_cast<const gtsam::GenericValue<Pose3> *>(&value))
+    return TrajectoryLogColumn::kPose3;
+  throw std::runtime_error("TrajectoryLogWriter: unsupported type of " +
+                           _GTDKeyFormatter(key));
+}
+
+template <class T>
+const T &As(const Value &value) {
+  return static_cast<const gtsam::GenericValue<T> &>(value).value();
+}
+
+/// Write a value as column.dim() doubles.
+void Store(const Value &value, Key key, const TrajectoryLogColumn &column,
+           double *out) {
+  if (TypeOf(value, key) != column.type)
+    throw std::runtime_error("TrajectoryLogWriter: type of " +
+                             _GTDKeyFormatter(key) + " changed");
+  switch (column.type) {
+    case TrajectoryLogColumn::kDouble:
+      *out = As<double>(value);
+      break;
+    case TrajectoryLogColumn::kVector3:
+      Eigen::Map<Vector3>(out) = As<Vector3>(value);
+      break;
+    case TrajectoryLogColumn::kVector6:
+      Eigen::Map<Vector6>(out) = As<Vector6>(value);
+      break;
+    case TrajectoryLogColumn::kPose3: {
+      const Pose3 &pose = As<Pose3>(value);
+      Eigen::Map<Matrix3>(out) = pose.rotation().matrix();
+      Eigen::Map<Vector3>(out + 9) = pose.translation();
+      break;
+    }
+  }
+}
+
+template <class T>
+void WritePod(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+TrajectoryLogWriter::TrajectoryLogWriter(const std::string &file_path,
+                                         size_t chunk_steps, bool append)
+    : file_path_(file_path), chunk_steps_(std::max<size_t>(1, chunk_steps)) {
+  if (append && std::ifstream(file_path).good()) {
+    const TrajectoryLog log(file_path);
+    if (log.truncated())
+      throw std::runtime_error("TrajectoryLogWriter: " + file_path +
+                               " ends in a partially written chunk");
+    columns_ = log.columns();
+    step_dim_ = Layout(columns_, &offsets_, &column_index_);
+    buffer_.resize(step_dim_ * chunk_steps_);
+    num_steps_ = log.numSteps();
+    header_written_ = true;
+  }
+  os_.open(file_path, std::ios::binary | (header_written_ ? std::ios::app
+                                                          : std::ios::trunc));
+  if (!os_.good())
+    throw std::runtime_error("TrajectoryLogWriter: could not open " +
+                             file_path);
+}
+
+/* ************************************************************************* */
+TrajectoryLogWriter::~TrajectoryLogWriter() {
+  try {
+    close();
+  } catch (const std::runtime_error &) {
+    // Destructors must not throw; call close to see write errors.
+  }
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::setColumns(const Values &values) {
+  std::map<Key, TrajectoryLogColumn::Type> types;
+  for (auto &&key_value : values) {
+    const auto type = TypeOf(key_value.value, key_value.key);
+    auto it = types.emplace(ColumnKey(key_value.key), type).first;
+    if (it->second != type)
+      throw std::runtime_error("TrajectoryLogWriter: type of " +
+                               _GTDKeyFormatter(key_value.key) +
+                               " differs between time steps");
+  }
+  columns_.clear();
+  for (auto &&column : types) columns_.push_back({column.first, column.second});
+  step_dim_ = Layout(columns_, &offsets_, &column_index_);
+  buffer_.resize(step_dim_ * chunk_steps_);
+
+  LogHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kTrajectoryLogVersion;
+  header.num_columns = columns_.size();
+  WritePod(os_, header);
+  for (auto &&column : columns_) WritePod(os_, Record(column));
+  header_written_ = true;
+}
+
+/* ************************************************************************* */
+size_t TrajectoryLogWriter::column(Key key) const {
+  auto it = column_index_.find(ColumnKey(key));
+  if (it == column_index_.end())
+    throw std::runtime_error("TrajectoryLogWriter: " + _GTDKeyFormatter(key) +
+                             " is not a column of " + file_path_);
+  return it->second;
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::appendStep(const std::vector<const Value *> &step) {
+  if (!os_.is_open())
+    throw std::runtime_error("TrajectoryLogWriter: " + file_path_ +
+                             " is closed");
+  const size_t k = num_buffered_;
+  for (size_t c = 0; c < columns_.size(); c++) {
+    const size_t dim = columns_[c].dim();
+    double *out = buffer_.data() + offsets_[c] * chunk_steps_ + k * dim;
+    if (step[c]) {
+      Store(*step[c], columns_[c].key, columns_[c], out);
+    } else {
+      std::fill(out, out + dim, std::numeric_limits<double>::quiet_NaN());
+    }
+  }
+  num_buffered_++;
+  num_steps_++;
+  if (num_buffered_ == chunk_steps_) flush();
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::append(const Values &values) {
+  if (!header_written_) setColumns(values);
+  std::vector<const Value *> step(columns_.size(), nullptr);
+  for (auto &&key_value : values) {
+    const size_t c = column(key_value.key);
+    if (step[c])
+      throw std::runtime_error("TrajectoryLogWriter: " +
+                               _GTDKeyFormatter(key_value.key) +
+                               " is in one step twice");
+    step[c] = &key_value.value;
+  }
+  appendStep(step);
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::appendTrajectory(const Values &values) {
+  if (!header_written_) setColumns(values);
+  std::vector<std::vector<const Value *>> steps;
+  for (auto &&key_value : values) {
+    const size_t c = column(key_value.key);
+    const uint64_t t = DynamicsSymbol(key_value.key).time();
+    if (t >= steps.size())
+      steps.resize(t + 1, std::vector<const Value *>(columns_.size()));
+    steps[t][c] = &key_value.value;
+  }
+  for (auto &&step : steps) appendStep(step);
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::flush() {
+  if (num_buffered_ == 0 || !os_.is_open()) return;
+  ChunkHeader chunk;
+  chunk.num_steps = num_buffered_;
+  chunk.reserved = 0;
+  WritePod(os_, chunk);
+  for (size_t c = 0; c < columns_.size(); c++) {
+    os_.write(
+        reinterpret_cast<const char *>(buffer_.data() +
+                                       offsets_[c] * chunk_steps_),
+        sizeof(double) * num_buffered_ * columns_[c].dim());
+  }
+  os_.flush();
+  num_buffered_ = 0;
+  if (!os_.good())
+    throw std::runtime_error("TrajectoryLogWriter: could not write " +
+                             file_path_);
+}
+
+/* ************************************************************************* */
+void TrajectoryLogWriter::close() {
+  if (!os_.is_open()) return;
+  if (!header_written_) setColumns(Values());
+  flush();
+  os_.close();
+}
+
+/* ************************************************************************* */
+TrajectoryLog::TrajectoryLog(const std::string &file_path) {
+  auto file = std::make_shared<MappedFile>();
+  if (!file->open(file_path))
+    throw std::runtime_error("TrajectoryLog: no file found at " + file_path);
+  file_ = file;
+  const char *p = file->data(), *end = p + file->size();
+
+  LogHeader header;
+  if (file->size() < sizeof(header))
+    throw std::runtime_error("TrajectoryLog: " + file_path +
+                             " is not a trajectory log");
+  std::memcpy(&header, p, sizeof(header));
+  p += sizeof(header);
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("TrajectoryLog: " + file_path +
+                             " is not a trajectory log");
+  if (header.version != kTrajectoryLogVersion)
+    throw std::runtime_error("TrajectoryLog: " + file_path +
+                             " has another format version");
+  if (size_t(end - p) / sizeof(ColumnRecord) < header.num_columns)
+    throw std::runtime_error("TrajectoryLog: truncated header in " +
+                             file_path);
+  for (uint32_t c = 0; c < header.num_columns; c++) {
+    ColumnRecord record;
+    std::memcpy(&record, p, sizeof(record));
+    p += sizeof(record);
+    columns_.push_back(Column(record));
+  }
+  const size_t step_dim = Layout(columns_, &offsets_, &column_index_);
+
+  // Index the chunks; a partial chunk at the end is left out.
+  while (p < end) {
+    ChunkHeader chunk;
+    if (size_t(end - p) < sizeof(chunk)) {
+      truncated_ = true;
+      break;
+    }
+    std::memcpy(&chunk, p, sizeof(chunk));
+    const size_t bytes = sizeof(double) * step_dim * chunk.num_steps;
+    if (size_t(end - p) - sizeof(chunk) < bytes) {
+      truncated_ = true;
+      break;
+    }
+    p += sizeof(chunk);
+    chunks_.push_back({p, num_steps_, chunk.num_steps});
+    num_steps_ += chunk.num_steps;
+    p += bytes;
+  }
+}
+
+/* ************************************************************************* */
+bool TrajectoryLog::has(Key key) const {
+  return column_index_.count(ColumnKey(key)) > 0;
+}
+
+/* ************************************************************************* */
+gtsam::Matrix TrajectoryLog::series(Key key) const {
+  auto it = column_index_.find(ColumnKey(key));
+  if (it == column_index_.end())
+    throw std::runtime_error("TrajectoryLog: no column for " +
+                             _GTDKeyFormatter(key));
+  const size_t c = it->second, dim = columns_[c].dim();
+  gtsam::Matrix series(num_steps_, dim);
+  for (auto &&chunk : chunks_) {
+    const char *data =
+        chunk.data + sizeof(double) * offsets_[c] * chunk.num_steps;
+    for (size_t k = 0; k < chunk.num_steps; k++) {
+      for (size_t d = 0; d < dim; d++) {
+        std::memcpy(&series(chunk.first_step + k, d),
+                    data + sizeof(double) * (k * dim + d), sizeof(double));
+      }
+    }
+  }
+  return series;
+}
+
+/* ************************************************************************* */
+void TrajectoryLog::insert(const Chunk &chunk, size_t k, uint64_t t,
+                           Values *values) const {
+  for (size_t c = 0; c < columns_.size(); c++) {
+    const TrajectoryLogColumn &column = columns_[c];
+    const size_t dim = column.dim();
+    double x[TrajectoryLogColumn::kPose3];
+    std::memcpy(x,
+                chunk.data + sizeof(double) *
+                                 (offsets_[c] * chunk.num_steps + k * dim),
+                sizeof(double) * dim);
+    if (std::isnan(x[0])) continue;
+
+    const Key key = DynamicsSymbol(column.key).atTime(t);
+    switch (column.type) {
+      case TrajectoryLogColumn::kDouble:
+        values->insert(key, x[0]);
+        break;
+      case TrajectoryLogColumn::kVector3:
+        values->insert(key, Vector3(Eigen::Map<const Vector3>(x)));
+        break;
+      case TrajectoryLogColumn::kVector6:
+        values->insert(key, Vector6(Eigen::Map<const Vector6>(x)));
+        break;
+      case TrajectoryLogColumn::kPose3:
+        values->insert(key,
+                       Pose3(gtsam::Rot3(Matrix3(Eigen::Map<const Matrix3>(x))),
+                             Vector3(Eigen::Map<const Vector3>(x + 9))));
+        break;
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values TrajectoryLog::values(size_t step) const {
+  if (step >= num_steps_)
+    throw std::runtime_error("TrajectoryLog: step " + std::to_string(step) +
+                             " is past the end of the log");
+  auto it = std::upper_bound(
+      chunks_.begin(), chunks_.end(), step,
+      [](size_t s, const Chunk &chunk) { return s < chunk.first_step; });
+  --it;
+  Values values;
+  insert(*it, step - it->first_step, step, &values);
+  return values;
+}
+
+/* ************************************************************************* */
+Values TrajectoryLog::values() const {
+  Values values;
+  for (auto &&chunk : chunks_) {
+    for (size_t k = 0; k < chunk.num_steps; k++) {
+      insert(chunk, k, chunk.first_step + k, &values);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
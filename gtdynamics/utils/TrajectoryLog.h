@@ -0,0 +1,191 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryLog.h
+ * @brief Columnar binary trajectory logs, appended step by step.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+class MappedFile;
+
+/// Version of the binary trajectory log format, bumped whenever it changes.
+constexpr uint32_t kTrajectoryLogVersion = 1;
+
+/**
+ * A column of a trajectory log: one variable, e.g. the angle of joint 2,
+ * over all time steps.
+ */
+struct TrajectoryLogColumn {
+  /// Type of the variable; the value is the number of doubles it takes.
+  enum Type : uint8_t { kDouble = 1, kVector3 = 3, kVector6 = 6, kPose3 = 12 };
+
+  gtsam::Key key;  ///< DynamicsSymbol of the variable at time 0
+  Type type;
+
+  /// Number of doubles per time step.
+  size_t dim() const { return type; }
+};
+
+/**
+ * Write a trajectory log, one time step at a time, e.g. while simulating.
+ *
+ * A log is a header listing the columns, each given by the label, robot
+ * instance, link and joint index of a DynamicsSymbol and a type, followed by
+ * chunks of up to chunk_steps time steps. Within a chunk the data of each
+ * column is contiguous and time-major, as raw native-endian doubles; poses
+ * are the rotation matrix in column-major order followed by the translation.
+ * Variables missing at a time step are stored as NaN, so a logged value
+ * starting with NaN reads back as missing.
+ *
+ * Steps are buffered and written a chunk at a time, so a log cut short by a
+ * crash still holds all complete chunks. Like RobotCache files, logs are
+ * meant to be read on machines with the same endianness.
+ */
+class TrajectoryLogWriter {
+ public:
+  /**
+   * Open a log for writing.
+   * @param file_path   path of the log file
+   * @param chunk_steps number of time steps per chunk
+   * @param append      whether to append to an existing log at file_path,
+   * which then fixes the columns
+   */
+  TrajectoryLogWriter(const std::string &file_path, size_t chunk_steps = 64,
+                      bool append = false);
+
+  /// Write the buffered steps, see close.
+  ~TrajectoryLogWriter();
+
+  TrajectoryLogWriter(const TrajectoryLogWriter &) = delete;
+  TrajectoryLogWriter &operator=(const TrajectoryLogWriter &) = delete;
+
+  /**
+   * Append one time step. The time of the keys is ignored. The first step
+   * written to a new log fixes the columns; later steps may miss variables
+   * but not add new ones.
+   * @param values values of double, Vector3, Vector6 or Pose3 variables
+   */
+  void append(const gtsam::Values &values);
+
+  /**
+   * Append a whole trajectory, as steps 0 up to the largest time of a key in
+   * values. If it is the first data written to a new log, the columns are
+   * all variables present at any time step.
+   * @param values values of double, Vector3, Vector6 or Pose3 variables
+   */
+  void appendTrajectory(const gtsam::Values &values);
+
+  /// Write the buffered steps as a chunk.
+  void flush();
+
+  /// Write the buffered steps and close the file. Further appends throw.
+  void close();
+
+  /// Number of time steps in the log, including buffered ones.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Columns of the log, empty until the first step is appended.
+  const std::vector<TrajectoryLogColumn> &columns() const { return columns_; }
+
+ private:
+  std::string file_path_;
+  std::ofstream os_;
+  size_t chunk_steps_;
+  bool header_written_ = false;
+
+  std::vector<TrajectoryLogColumn> columns_;
+  std::map<gtsam::Key, size_t> column_index_;
+  std::vector<size_t> offsets_;  // first double of each column in a step
+  size_t step_dim_ = 0;          // doubles per time step
+
+  std::vector<double> buffer_;  // column-major chunk, chunk_steps_ per column
+  size_t num_buffered_ = 0, num_steps_ = 0;
+
+  /// Set the columns from the variables in values, and write the header.
+  void setColumns(const gtsam::Values &values);
+
+  /// Index of the column of a key; throws if it has none.
+  size_t column(gtsam::Key key) const;
+
+  /// Buffer one step, with a value or nullptr per column.
+  void appendStep(const std::vector<const gtsam::Value *> &step);
+};
+
+/**
+ * Read a trajectory log written by TrajectoryLogWriter. The file is memory
+ * mapped and read lazily, so opening a large log is cheap and reading one
+ * column only touches the pages of that column. Copies share the mapping.
+ */
+class TrajectoryLog {
+ public:
+  /**
+   * Open a log; throws if the file cannot be read or is not a log.
+   * @param file_path path of the log file
+   */
+  explicit TrajectoryLog(const std::string &file_path);
+
+  /// Number of time steps in the complete chunks.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Columns of the log.
+  const std::vector<TrajectoryLogColumn> &columns() const { return columns_; }
+
+  /// Whether the file ends in a partially written chunk, which is ignored.
+  bool truncated() const { return truncated_; }
+
+  /// Whether there is a column for the key, ignoring its time.
+  bool has(gtsam::Key key) const;
+
+  /**
+   * Time series of a variable.
+   * @param key the variable, its time is ignored
+   * @return numSteps x dim matrix, NaN where the variable is missing
+   */
+  gtsam::Matrix series(gtsam::Key key) const;
+
+  /// Variables present at a time step, with keys at time `step`.
+  gtsam::Values values(size_t step) const;
+
+  /// Variables of all time steps.
+  gtsam::Values values() const;
+
+ private:
+  struct Chunk {
+    const char *data;  // first double of the chunk
+    size_t first_step, num_steps;
+  };
+
+  std::shared_ptr<const MappedFile> file_;
+  std::vector<TrajectoryLogColumn> columns_;
+  std::map<gtsam::Key, size_t> column_index_;
+  std::vector<size_t> offsets_;
+  std::vector<Chunk> chunks_;
+  size_t num_steps_ = 0;
+  bool truncated_ = false;
+
+  /// Insert the variables of one step of a chunk.
+  void insert(const Chunk &chunk, size_t k, uint64_t t,
+              gtsam::Values *values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,194 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartLibrary.cpp
+ * @brief Store of optimized trajectories to warm-start recurring tasks.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/WarmStartLibrary.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/GenericValue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace {
+
+// Linear interpolation, or geodesic for poses.
+template <class T>
+T Blend(const T &x0, const T &x1, double alpha) {
+  return (1 - alpha) * x0 + alpha * x1;
+}
+template <>
+Pose3 Blend<Pose3>(const Pose3 &x0, const Pose3 &x1, double alpha) {
+  return gtsam::interpolate<Pose3>(x0, x1, alpha);
+}
+
+// Insert the blend of the values at key0 and key1 if they hold a T.
+template <class T>
+bool InsertBlend(const Values &solution, Key key0, Key key1, double alpha,
+                 Key key, Values *values) {
+  if (!dynamic_cast<const gtsam::GenericValue<T> *>(&solution.at(key0))) {
+    return false;
+  }
+  values->insert(key, Blend<T>(solution.at<T>(key0), solution.at<T>(key1),
+                               alpha));
+  return true;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+WarmStartTask::WarmStartTask(const Robot &robot, const Trajectory &trajectory,
+                             const ContactPointGoals &goals)
+    : goals(goals) {
+  for (auto &&joint : robot.joints()) structure += joint->name() + ",";
+  for (auto &&contact_points : trajectory.phaseContactPoints()) {
+    structure += "|";
+    for (auto &&cp : contact_points) structure += cp.link->name() + ",";
+  }
+  structure += "|";
+  for (auto &&goal : goals) structure += goal.first + ",";
+
+  for (int steps : trajectory.phaseDurations()) phase_steps.push_back(steps);
+}
+
+/* ************************************************************************* */
+size_t WarmStartTask::numTimeSteps() const {
+  size_t num_steps = 0;
+  for (size_t steps : phase_steps) num_steps += steps;
+  return num_steps;
+}
+
+/* ************************************************************************* */
+double WarmStartTask::distance(const WarmStartTask &other) const {
+  double distance = 0;
+  for (auto &&goal : goals) {
+    auto it = other.goals.find(goal.first);
+    if (it == other.goals.end()) {
+      return std::numeric_limits<double>::infinity();
+    }
+    distance += (goal.second - it->second).squaredNorm();
+  }
+  return distance;
+}
+
+/* ************************************************************************* */
+void WarmStartLibrary::add(const WarmStartTask &task,
+                           const Values &solution) {
+  entries_[task.structure].emplace_back(task, solution);
+  size_++;
+}
+
+/* ************************************************************************* */
+bool WarmStartLibrary::hasMatch(const WarmStartTask &task) const {
+  return entries_.count(task.structure) > 0;
+}
+
+/* ************************************************************************* */
+Values WarmStartLibrary::initialValues(const WarmStartTask &task,
+                                       const Values &fallback) const {
+  auto it = entries_.find(task.structure);
+  if (it == entries_.end()) return fallback;
+
+  const Entry *nearest = nullptr;
+  double min_distance = std::numeric_limits<double>::infinity();
+  for (auto &&entry : it->second) {
+    const double distance = task.distance(entry.first);
+    if (!nearest || distance < min_distance) {
+      nearest = &entry;
+      min_distance = distance;
+    }
+  }
+  return TimeWarp(nearest->second, nearest->first.phase_steps,
+                  task.phase_steps, fallback);
+}
+
+/* ************************************************************************* */
+Values WarmStartLibrary::TimeWarp(const Values &solution,
+                                  const std::vector<size_t> &from_steps,
+                                  const std::vector<size_t> &to_steps,
+                                  const Values &fallback) {
+  if (from_steps.size() != to_steps.size()) {
+    throw std::invalid_argument(
+        "WarmStartLibrary::TimeWarp: trajectories have different phases");
+  }
+
+  // Time in the solution of every step of the new trajectory, mapping the
+  // phase boundaries onto each other.
+  const size_t num_phases = to_steps.size();
+  std::vector<double> source_time(1, 0.0);
+  size_t from_start = 0;
+  for (size_t p = 0; p < num_phases; p++) {
+    for (size_t k = 1; k <= to_steps[p]; k++) {
+      source_time.push_back(from_start +
+                            double(k * from_steps[p]) / to_steps[p]);
+    }
+    from_start += from_steps[p];
+  }
+
+  const uint16_t phase_label = DynamicsSymbol(PhaseKey(0)).labelCode();
+  Values values;
+  for (auto &&key_value : fallback) {
+    const DynamicsSymbol symbol(key_value.key);
+
+    // Phase durations, scaled to keep the duration of the phase.
+    if (symbol.labelCode() == phase_label) {
+      const size_t p = symbol.time();
+      if (!solution.exists(key_value.key)) {
+        values.insert(key_value.key, key_value.value);
+      } else if (p < num_phases && from_steps[p] > 0 && to_steps[p] > 0) {
+        const double dt = solution.at<double>(key_value.key);
+        values.insert(key_value.key, dt * from_steps[p] / to_steps[p]);
+      } else {
+        values.insert(key_value.key, solution.at(key_value.key));
+      }
+      continue;
+    }
+
+    const size_t k = std::min<size_t>(symbol.time(), source_time.size() - 1);
+    const double s = source_time[k];
+    Key key0 = symbol.atTime(std::floor(s));
+    Key key1 = symbol.atTime(std::ceil(s));
+    const double alpha = s - std::floor(s);
+    const bool has0 = solution.exists(key0), has1 = solution.exists(key1);
+    if (!has0 && !has1) {
+      values.insert(key_value.key, key_value.value);
+      continue;
+    }
+    if (!has0) key0 = key1;
+    if (!has1) key1 = key0;
+
+    if (!InsertBlend<double>(solution, key0, key1, alpha, key_value.key,
+                             &values) &&
+        !InsertBlend<gtsam::Vector3>(solution, key0, key1, alpha,
+                                     key_value.key, &values) &&
+        !InsertBlend<gtsam::Vector6>(solution, key0, key1, alpha,
+                                     key_value.key, &values) &&
+        !InsertBlend<gtsam::Vector>(solution, key0, key1, alpha,
+                                    key_value.key, &values) &&
+        !InsertBlend<Pose3>(solution, key0, key1, alpha, key_value.key,
+                            &values)) {
+      // Other types take the nearest stored step.
+      values.insert(key_value.key, solution.at(alpha < 0.5 ? key0 : key1));
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
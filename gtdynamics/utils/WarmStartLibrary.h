@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartLibrary.h
+ * @brief Store of optimized trajectories to warm-start recurring tasks.
+ * @author GTDynamics Team
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * WarmStartTask describes a trajectory optimization task for the purpose of
+ * looking up warm starts: the structure of the task, i.e., the joints of the
+ * robot, the contact links of every phase and the contact links with goals,
+ * the number of steps of every phase, and the contact goal points.
+ */
+struct WarmStartTask {
+  std::string structure;            ///< robot joints and contacts per phase
+  std::vector<size_t> phase_steps;  ///< number of time steps of each phase
+  ContactPointGoals goals;          ///< goal point of each contact link
+
+  /// Default constructor.
+  WarmStartTask() {}
+
+  /**
+   * Constructor.
+   * @param robot      the robot
+   * @param trajectory the walk cycle, and how often it is repeated
+   * @param goals      contact point goals at the start of the trajectory
+   */
+  WarmStartTask(const Robot &robot, const Trajectory &trajectory,
+                const ContactPointGoals &goals);
+
+  /// Number of time steps, summing over all phases.
+  size_t numTimeSteps() const;
+
+  /// Sum of squared distances between the goals of two tasks.
+  double distance(const WarmStartTask &other) const;
+};
+
+/**
+ * WarmStartLibrary keeps optimized trajectories of previous tasks, and
+ * provides initial values for a new task from the nearest stored task with
+ * the same structure, nearest meaning closest contact goals.
+ *
+ * Tasks with the same structure may differ in the number of steps of their
+ * phases. The stored trajectory is then time-warped, phase by phase, to the
+ * new phase lengths: a step of the new trajectory takes the values at the
+ * same fraction of its phase in the stored one, interpolated between the two
+ * neighboring stored steps. Phase durations are scaled so that every phase
+ * takes as long as it did.
+ */
+class WarmStartLibrary {
+ private:
+  using Entry = std::pair<WarmStartTask, gtsam::Values>;
+  std::map<std::string, std::vector<Entry>> entries_;  // by task structure
+  size_t size_ = 0;
+
+ public:
+  /// Default constructor.
+  WarmStartLibrary() {}
+
+  /**
+   * Store the optimized trajectory of a task.
+   * @param task     the task
+   * @param solution its optimized values, with keys from values.h
+   */
+  void add(const WarmStartTask &task, const gtsam::Values &solution);
+
+  /// Number of stored trajectories.
+  size_t size() const { return size_; }
+
+  /// Whether a trajectory with the structure of task is stored.
+  bool hasMatch(const WarmStartTask &task) const;
+
+  /**
+   * Initial values for a task.
+   * @param task     the task
+   * @param fallback initial values for all variables of the task, e.g. from
+   * an Initializer
+   * @return fallback, with every variable the nearest stored trajectory has
+   * replaced by its time-warped value, or fallback when nothing matches
+   */
+  gtsam::Values initialValues(const WarmStartTask &task,
+                              const gtsam::Values &fallback) const;
+
+  /**
+   * Time-warp a trajectory to other phase lengths.
+   * @param solution    the trajectory
+   * @param from_steps  number of time steps of the phases of solution
+   * @param to_steps    number of time steps of the phases to warp to
+   * @param fallback    values for all variables of the new trajectory
+   * @return fallback, with every variable solution has replaced by its
+   * time-warped value
+   */
+  static gtsam::Values TimeWarp(const gtsam::Values &solution,
+                                const std::vector<size_t> &from_steps,
+                                const std::vector<size_t> &to_steps,
+                                const gtsam::Values &fallback);
+};
+
+}  // namespace gtdynamics
@@ -115,7 +115,8 @@ std::vector<gtsam::Pose3> square(int numOfWayPoints, double goalAngle,
 
 /**
  * Read a variable from a text file, and save to vector of matrix.
- * This is used for SDF.
+ * This is used for SDF; large fields are better converted once with
+ * SignedDistanceField::LoadTxt and save, and memory mapped with Load.
  */
 std::vector<gtsam::Matrix> readFromTxt(std::string mat_dir,
                                        gtsam::Point3 &origin,  // NOLINT
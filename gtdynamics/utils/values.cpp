@@ -13,6 +13,15 @@
  */
 
 #include <gtdynamics/utils/values.h>
+#include <gtsam/base/Lie.h>
+#include <gtsam/geometry/Pose2.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -166,4 +175,323 @@ Vector6 Wrench(const Values &values, int i, int j, int t) {
   return at<Vector6>(values, WrenchKey(i, j, t));
 }
 
+/* ************************************************************************* */
+void InsertInterpolated(const Values &values, gtsam::Key key0,
+                        gtsam::Key key1, double s, gtsam::Key key,
+                        Values *result) {
+  if (!values.exists(key1)) {
+    result->insert(key, values.at(key0));
+  } else if (auto a = values.exists<double>(key0)) {
+    result->insert(key, (1 - s) * *a + s * values.at<double>(key1));
+  } else if (auto a = values.exists<Vector>(key0)) {
+    result->insert(key, Vector((1 - s) * *a + s * values.at<Vector>(key1)));
+  } else if (auto a = values.exists<gtsam::Vector3>(key0)) {
+    result->insert(key, gtsam::Vector3((1 - s) * *a +
+                                       s * values.at<gtsam::Vector3>(key1)));
+  } else if (auto a = values.exists<Vector6>(key0)) {
+    result->insert(key, Vector6((1 - s) * *a + s * values.at<Vector6>(key1)));
+  } else if (auto a = values.exists<Pose3>(key0)) {
+    result->insert(key,
+                   gtsam::interpolate<Pose3>(*a, values.at<Pose3>(key1), s));
+  } else {
+    result->insert(key, values.at(key0));
+  }
+}
+
+/* ************************************************************************* */
+namespace {
+
+// Formats table lines into one buffer, written out when it is nearly full.
+class TableWriter {
+  static constexpr size_t kBlockSize = 1 << 16;
+  std::ostream &os_;
+  std::string buffer_;
+  char format_[8];
+
+ public:
+  TableWriter(std::ostream &os, int precision) : os_(os) {
+    buffer_.reserve(kBlockSize + 256);
+    std::snprintf(format_, sizeof(format_), "\t%%.%dg", precision);
+  }
+  ~TableWriter() { flush(); }
+
+  void flush() {
+    os_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  void append(const char *s, size_t n) {
+    buffer_.append(s, n);
+    if (buffer_.size() >= kBlockSize) flush();
+  }
+
+  // Append a tab and an integer, or -1 for kNoIndex.
+  void appendIndex(uint64_t i, bool valid = true) {
+    char s[24];
+    const int n =
+        valid ? std::snprintf(s, sizeof(s), "\t%llu", (unsigned long long)i)
+              : std::snprintf(s, sizeof(s), "\t-1");
+    append(s, n);
+  }
+
+  void appendEntries(const double *data, size_t n) {
+    char s[40];
+    for (size_t i = 0; i < n; i++) {
+      append(s, std::snprintf(s, sizeof(s), format_, data[i]));
+    }
+  }
+};
+
+}  // namespace
+
+void WriteValuesTable(const Values &values, std::ostream &os,
+                      int precision) {
+  TableWriter table(os, std::max(1, std::min(precision, 17)));
+  const char header[] = "# label\trobot\tlink\tjoint\tt\tdim\tvalue\n";
+  table.append(header, sizeof(header) - 1);
+  for (auto &&key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const gtsam::Value &value = key_value.value;
+    const std::string label = symbol.label();
+    table.append(label.data(), label.size());
+    table.appendIndex(symbol.robotIdx());
+    table.appendIndex(symbol.linkIdx(),
+                      symbol.linkIdx() != DynamicsSymbol::kNoIndex);
+    table.appendIndex(symbol.jointIdx(),
+                      symbol.jointIdx() != DynamicsSymbol::kNoIndex);
+    table.appendIndex(symbol.time());
+    table.appendIndex(value.dim());
+    if (auto v = dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+      table.appendEntries(&v->value(), 1);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Vector> *>(
+                   &value)) {
+      table.appendEntries(v->value().data(), v->value().size());
+    } else if (auto v =
+                   dynamic_cast<const gtsam::GenericValue<gtsam::Vector3> *>(
+                       &value)) {
+      table.appendEntries(v->value().data(), 3);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Vector6> *>(
+                   &value)) {
+      table.appendEntries(v->value().data(), 6);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<gtsam::Rot3> *>(
+                   &value)) {
+      const gtsam::Matrix3 R = v->value().matrix();
+      table.appendEntries(R.data(), 9);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Pose3> *>(
+                   &value)) {
+      const gtsam::Matrix3 R = v->value().rotation().matrix();
+      table.appendEntries(R.data(), 9);
+      table.appendEntries(v->value().translation().data(), 3);
+    }
+    table.append("\n", 1);
+  }
+}
+
+void WriteValuesTable(const Values &values, const std::string &file_path,
+                      int precision) {
+  std::ofstream os(file_path);
+  if (!os.good()) {
+    throw std::runtime_error("WriteValuesTable: could not open " + file_path);
+  }
+  WriteValuesTable(values, os, precision);
+  os.flush();
+  if (!os.good()) {
+    throw std::runtime_error("WriteValuesTable: could not write " +
+                             file_path);
+  }
+}
+
+namespace {
+constexpr char kValuesMagic[8] = {'G', 'T', 'D', 'V', 'A', 'L', 'S', '1'};
+
+/// Type tags of the binary values format.
+enum ValueType : uint8_t {
+  kDouble,
+  kVector,       // size, then entries
+  kFixedVector,  // size, then entries
+  kRot3,         // column-major matrix
+  kPose3,        // rotation matrix, then translation
+  kPose2         // x, y, theta
+};
+
+template <class T>
+void AppendPod(std::string *data, const T &value) {
+  data->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void AppendDoubles(std::string *data, const double *x, size_t n) {
+  data->append(reinterpret_cast<const char *>(x), sizeof(double) * n);
+}
+
+/// Append a fixed-size vector of at most N entries, if the value is one.
+template <int N>
+bool AppendFixedVector(std::string *data, const gtsam::Value &value) {
+  typedef Eigen::Matrix<double, N, 1> VectorN;
+  if (auto v = dynamic_cast<const gtsam::GenericValue<VectorN> *>(&value)) {
+    AppendPod<uint8_t>(data, kFixedVector);
+    AppendPod<uint8_t>(data, N);
+    AppendDoubles(data, v->value().data(), N);
+    return true;
+  }
+  return AppendFixedVector<N - 1>(data, value);
+}
+
+template <>
+bool AppendFixedVector<0>(std::string *, const gtsam::Value &) {
+  return false;
+}
+
+/// Reads what ValuesToBytes wrote, checking that the data is not truncated.
+class ValuesReader {
+  const char *p_, *end_;
+
+  void need(size_t n) const {
+    if (static_cast<size_t>(end_ - p_) < n)
+      throw std::runtime_error("ValuesFromBytes: truncated data");
+  }
+
+ public:
+  explicit ValuesReader(const std::string &data)
+      : p_(data.data()), end_(data.data() + data.size()) {}
+
+  bool done() const { return p_ == end_; }
+
+  void skip(size_t n) {
+    need(n);
+    p_ += n;
+  }
+
+  template <class T>
+  T pod() {
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return value;
+  }
+
+  Vector doubles(size_t n) {
+    need(sizeof(double) * n);
+    Vector x(n);
+    std::memcpy(x.data(), p_, sizeof(double) * n);
+    p_ += sizeof(double) * n;
+    return x;
+  }
+};
+
+/// Insert a fixed-size vector of at most N entries.
+template <int N>
+void InsertFixedVector(Values *values, gtsam::Key key, const Vector &x) {
+  if (x.size() == N) {
+    values->insert(key, Eigen::Matrix<double, N, 1>(x));
+  } else {
+    InsertFixedVector<N - 1>(values, key, x);
+  }
+}
+
+template <>
+void InsertFixedVector<0>(Values *, gtsam::Key, const Vector &) {
+  throw std::runtime_error("ValuesFromBytes: invalid vector size");
+}
+
+// Largest fixed-size vector type, e.g. Vector6 of twists and wrenches.
+constexpr int kMaxFixedVector = 12;
+}  // namespace
+
+/* ************************************************************************* */
+std::string ValuesToBytes(const Values &values) {
+  std::string data;
+  data.reserve(sizeof(kValuesMagic) + sizeof(uint64_t) +
+               values.size() * (sizeof(uint64_t) + 2 + 12 * sizeof(double)));
+  data.append(kValuesMagic, sizeof(kValuesMagic));
+  AppendPod<uint64_t>(&data, values.size());
+  for (auto &&key_value : values) {
+    AppendPod<uint64_t>(&data, key_value.key);
+    const gtsam::Value &value = key_value.value;
+    if (auto v = dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+      AppendPod<uint8_t>(&data, kDouble);
+      AppendPod(&data, v->value());
+    } else if (auto v =
+                   dynamic_cast<const gtsam::GenericValue<Vector> *>(&value)) {
+      AppendPod<uint8_t>(&data, kVector);
+      AppendPod<uint32_t>(&data, v->value().size());
+      AppendDoubles(&data, v->value().data(), v->value().size());
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<gtsam::Rot3> *>(
+                   &value)) {
+      AppendPod<uint8_t>(&data, kRot3);
+      const gtsam::Matrix3 R = v->value().matrix();
+      AppendDoubles(&data, R.data(), 9);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<Pose3> *>(
+                   &value)) {
+      AppendPod<uint8_t>(&data, kPose3);
+      const gtsam::Matrix3 R = v->value().rotation().matrix();
+      AppendDoubles(&data, R.data(), 9);
+      AppendDoubles(&data, v->value().translation().data(), 3);
+    } else if (auto v = dynamic_cast<const gtsam::GenericValue<gtsam::Pose2> *>(
+                   &value)) {
+      AppendPod<uint8_t>(&data, kPose2);
+      const gtsam::Vector3 xytheta(v->value().x(), v->value().y(),
+                                   v->value().theta());
+      AppendDoubles(&data, xytheta.data(), 3);
+    } else if (!AppendFixedVector<kMaxFixedVector>(&data, value)) {
+      throw std::invalid_argument(
+          "ValuesToBytes: no binary encoding for the value of " +
+          _GTDKeyFormatter(key_value.key));
+    }
+  }
+  return data;
+}
+
+/* ************************************************************************* */
+Values ValuesFromBytes(const std::string &data) {
+  if (data.size() < sizeof(kValuesMagic) ||
+      std::memcmp(data.data(), kValuesMagic, sizeof(kValuesMagic)) != 0) {
+    throw std::runtime_error("ValuesFromBytes: not encoded values");
+  }
+  ValuesReader reader(data);
+  reader.skip(sizeof(kValuesMagic));
+  const uint64_t size = reader.pod<uint64_t>();
+  Values values;
+  for (uint64_t i = 0; i < size; i++) {
+    const gtsam::Key key = reader.pod<uint64_t>();
+    switch (reader.pod<uint8_t>()) {
+      case kDouble:
+        values.insert(key, reader.pod<double>());
+        break;
+      case kVector:
+        values.insert(key, reader.doubles(reader.pod<uint32_t>()));
+        break;
+      case kFixedVector:
+        InsertFixedVector<kMaxFixedVector>(
+            &values, key, reader.doubles(reader.pod<uint8_t>()));
+        break;
+      case kRot3: {
+        const Vector R = reader.doubles(9);
+        values.insert(key, gtsam::Rot3(Eigen::Map<const gtsam::Matrix3>(
+                               R.data())));
+        break;
+      }
+      case kPose3: {
+        const Vector Rt = reader.doubles(12);
+        values.insert(
+            key, Pose3(gtsam::Rot3(Eigen::Map<const gtsam::Matrix3>(Rt.data())),
+                       gtsam::Point3(Rt.tail<3>())));
+        break;
+      }
+      case kPose2: {
+        const Vector xytheta = reader.doubles(3);
+        values.insert(key,
+                      gtsam::Pose2(xytheta(0), xytheta(1), xytheta(2)));
+        break;
+      }
+      default:
+        throw std::runtime_error("ValuesFromBytes: unknown value type");
+    }
+  }
+  if (!reader.done()) {
+    throw std::runtime_error("ValuesFromBytes: trailing data");
+  }
+  return values;
+}
+
 }  // namespace gtdynamics
@@ -19,6 +19,10 @@
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <iosfwd>
+#include <limits>
+#include <string>
+
 #define GTD_PRINT(x) ((x).print(#x, gtdynamics::_GTDKeyFormatter))
 
 namespace gtdynamics {
@@ -53,6 +57,11 @@ inline DynamicsSymbol JointAccelKey(int j, int t = 0) {
   return DynamicsSymbol::JointSymbol("a", j, t);
 }
 
+/// Shorthand for qc_j_c, for the c-th spline control point of the j-th joint.
+inline DynamicsSymbol JointControlPointKey(int j, int c) {
+  return DynamicsSymbol::JointSymbol("qc", j, c);
+}
+
 /// Shorthand for T_j_t, for torque on the j-th joint at time t.
 inline DynamicsSymbol TorqueKey(int j, int t = 0) {
   return DynamicsSymbol::JointSymbol("T", j, t);
@@ -436,4 +445,68 @@ gtsam::Vector Wrench(const gtsam::VectorValues &values, int i, int j,
  */
 gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t = 0);
 
+/**
+ * @brief Insert a value interpolated between two variables, e.g. the same
+ * variable at two time steps.
+ *
+ * Doubles and vectors are interpolated linearly and poses on SE(3). Other
+ * types, and variables whose second key is not in the values, are copied
+ * from the first key.
+ *
+ * @param values Values dictionary with the two variables.
+ * @param key0 Key of the variable at s = 0.
+ * @param key1 Key of the variable at s = 1.
+ * @param s Interpolation fraction, in [0, 1].
+ * @param key The key to insert the interpolated value as.
+ * @param result Values dictionary to insert into.
+ */
+void InsertInterpolated(const gtsam::Values &values, gtsam::Key key0,
+                        gtsam::Key key1, double s, gtsam::Key key,
+                        gtsam::Values *result);
+
+/**
+ * @brief Write values as a table, for logging: a header line starting with
+ * '#', then one tab separated line per variable in key order, with the label,
+ * robot instance, link and joint index (-1 if none), time step, dimension and
+ * the value.
+ *
+ * Doubles and vectors are written as their entries, Rot3 as its matrix in
+ * column-major order, and Pose3 as its rotation followed by its translation.
+ * Other types are written without entries. Lines are formatted into one
+ * buffer and written in large blocks, so that dumping long trajectories is
+ * cheap enough to leave on.
+ *
+ * @param values Values dictionary to write.
+ * @param os Stream to write to.
+ * @param precision Significant digits of the entries; the default is exact.
+ */
+void WriteValuesTable(
+    const gtsam::Values &values, std::ostream &os,
+    int precision = std::numeric_limits<double>::max_digits10);
+
+/**
+ * @brief Write values as a table to a file, see WriteValuesTable; throws
+ * std::runtime_error if the file cannot be written.
+ */
+void WriteValuesTable(
+    const gtsam::Values &values, const std::string &file_path,
+    int precision = std::numeric_limits<double>::max_digits10);
+
+/**
+ * @brief Encode values in a compact binary format, e.g. to send them to
+ * other processes: the keys and raw native-endian entries of doubles,
+ * vectors (fixed-size ones of up to 12 entries, keeping their type), Rot3,
+ * Pose3 and Pose2 values. Throws std::invalid_argument for other types.
+ *
+ * @param values Values dictionary to encode.
+ * @return the encoded values, see ValuesFromBytes.
+ */
+std::string ValuesToBytes(const gtsam::Values &values);
+
+/**
+ * @brief Decode values encoded by ValuesToBytes on the same platform; throws
+ * std::runtime_error if the data is truncated or has another format.
+ */
+gtsam::Values ValuesFromBytes(const std::string &data);
+
 }  // namespace gtdynamics
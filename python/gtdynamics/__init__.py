@@ -1,3 +1,6 @@
+import copyreg
+import pickle
+
 # Python needs to know about gtsam base classes before it can import module classes
 # Else will throw cryptic "referenced unknown base type" error.
 import gtsam
@@ -19,3 +22,39 @@ class Values(_GtdKeyFormatter, gtsam.Values):
 
 class NonlinearFactorGraph(_GtdKeyFormatter, gtsam.NonlinearFactorGraph):
     pass
+
+
+def _values_from_bytes(cls, data):
+    """Unpickle values of type `cls` encoded by ValuesToBytes."""
+    return cls(ValuesFromBytes(data))
+
+
+def _values_reduce(values, fallback):
+    """Reduce values to the binary format of ValuesToBytes, much faster than
+    text serialization, falling back to `fallback()` for types it lacks."""
+    try:
+        data = ValuesToBytes(values)
+    except ValueError:
+        return fallback()
+    return (_values_from_bytes, (type(values), data))
+
+
+def _values_reduce_ex(self, protocol):
+    return _values_reduce(
+        self, lambda: gtsam.Values.__reduce_ex__(self, protocol))
+
+
+Values.__reduce_ex__ = _values_reduce_ex
+
+
+def register_values_pickling():
+    """Opt in to pickling plain gtsam.Values in the binary format too, e.g.
+    before sending optimizer results to multiprocessing workers.
+
+    This changes how gtsam.Values pickle for the whole process, and the
+    native-endian format is only meant for passing values between processes
+    on one machine, not for storage.
+    """
+    copyreg.pickle(
+        gtsam.Values, lambda values: _values_reduce(
+            values, lambda: values.__reduce_ex__(pickle.DEFAULT_PROTOCOL)))
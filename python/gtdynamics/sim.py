@@ -2,7 +2,11 @@
 
 #pylint: disable=c-extension-no-member
 
-from typing import Dict
+from typing import Dict, Optional, Sequence
+
+import numpy as np
+
+import gtdynamics as gtd
 
 
 def set_joint_angles(pyb,
@@ -34,3 +38,59 @@ def set_joint_angles(pyb,
                                   controlMode=pyb.POSITION_CONTROL,
                                   targetPosition=angle,
                                   targetVelocity=target_velocity)
+
+
+def validate_trajectory(robot: "gtd.Robot",
+                        trajectory: "gtd.TrajectoryBuffer",
+                        dt: float,
+                        contact_points: Optional["gtd.PointOnLinks"] = None,
+                        gravity: Sequence[float] = (0, 0, -9.8),
+                        kp: float = 100.0,
+                        kd: float = 10.0,
+                        feedforward: bool = True,
+                        substeps: int = 1) -> Dict[str, np.ndarray]:
+    """
+    Replay an optimized trajectory in the native contact simulator with PD
+    tracking, as a replacement for stepping PyBullet with set_joint_angles.
+    The whole replay runs in C++, see gtd.ReplayTrajectory.
+
+    Args:
+        robot: The robot of the trajectory.
+        trajectory: Planned joint states and torques, e.g. from
+            gtd.TrajectoryBuffer.FromValues; poses and twists of the root
+            link, if present, give the initial base state.
+        dt: Duration of a trajectory step.
+        contact_points: Points that can touch the ground, none by default.
+        gravity: Gravity vector.
+        kp: Proportional gain.
+        kd: Derivative gain.
+        feedforward: Whether to apply the planned torques on top of PD.
+        substeps: Simulator steps per trajectory step.
+
+    Returns:
+        Tracking errors, simulated minus planned: "joint_angle_errors" and
+        "joint_vel_errors" (num_steps x num_joints), "base_position_errors"
+        (num_steps x 3), the applied "torques", and the summaries
+        "rms_joint_angle_errors" (per joint), "max_joint_angle_error" and
+        "rms_base_position_error".
+    """
+    if contact_points is None:
+        contact_points = gtd.PointOnLinks()
+    simulator = gtd.ContactSimulator(robot, contact_points,
+                                     np.asarray(gravity, dtype=float))
+    parameters = gtd.ReplayParameters()
+    parameters.kp = kp
+    parameters.kd = kd
+    parameters.feedforward = feedforward
+    parameters.substeps = substeps
+    metrics = gtd.ReplayTrajectory(simulator, trajectory, dt, parameters)
+    return {
+        "joint_angle_errors": np.asarray(metrics.joint_angle_errors),
+        "joint_vel_errors": np.asarray(metrics.joint_vel_errors),
+        "base_position_errors": np.asarray(metrics.base_position_errors),
+        "torques": np.asarray(metrics.torques),
+        "rms_joint_angle_errors": np.asarray(metrics.rms_joint_angle_errors),
+        "max_joint_angle_error": np.asarray(metrics.max_joint_angle_error),
+        "rms_base_position_error":
+        np.asarray(metrics.rms_base_position_error),
+    }
@@ -2,3 +2,348 @@
 // These are required to save one copy operation on Python calls
 py::bind_vector<gtdynamics::PointOnLinks>(m_, "PointOnLinks");
 py::bind_map<gtdynamics::ContactPointGoals>(m_, "ContactPointGoals");
+
+// The arrays of a TrajectoryBuffer are returned as NumPy views that share
+// memory with the buffer and keep it alive, so whole trajectories cross the
+// binding boundary at once instead of one scalar per call. Assigning into a
+// view, e.g. `buffer.jointAngles()[:] = q`, fills the buffer for insert().
+// poseMatrices() returns all link poses as one (numSteps, numLinks, 4, 4)
+// array, for renderers.
+{
+  using gtdynamics::TrajectoryBuffer;
+  auto buffer = py::reinterpret_borrow<
+      py::class_<TrajectoryBuffer, boost::shared_ptr<TrajectoryBuffer>>>(
+      m_.attr("TrajectoryBuffer"));
+  const auto view = py::return_value_policy::reference_internal;
+  buffer
+      .def("jointAngles",
+           [](TrajectoryBuffer &self) -> gtsam::Matrix & {
+             return self.jointAngles();
+           },
+           view)
+      .def("jointVels",
+           [](TrajectoryBuffer &self) -> gtsam::Matrix & {
+             return self.jointVels();
+           },
+           view)
+      .def("jointAccels",
+           [](TrajectoryBuffer &self) -> gtsam::Matrix & {
+             return self.jointAccels();
+           },
+           view)
+      .def("torques",
+           [](TrajectoryBuffer &self) -> gtsam::Matrix & {
+             return self.torques();
+           },
+           view)
+      .def("twists",
+           [](TrajectoryBuffer &self) -> gtsam::Matrix & {
+             return self.twists();
+           },
+           view)
+      .def("pose",
+           [](const TrajectoryBuffer &self, uint16_t i, size_t t) {
+             return self.pose(i, t);
+           })
+      .def("setPose",
+           [](TrajectoryBuffer &self, uint16_t i, size_t t,
+              const gtsam::Pose3 &pose) { self.pose(i, t) = pose; })
+      .def("poseMatrices",
+           [](const TrajectoryBuffer &self, unsigned frame) {
+             // A new (numSteps, numLinks, 4, 4) array, filled in one pass.
+             py::array_t<double> matrices(std::vector<size_t>{
+                 self.numSteps(), self.numLinks(), size_t(4), size_t(4)});
+             double *data = matrices.mutable_data();
+             {
+               py::gil_scoped_release release;
+               self.poseMatrices(
+                   data, static_cast<TrajectoryBuffer::PoseFrame>(frame));
+             }
+             return matrices;
+           },
+           py::arg("frame") = unsigned(TrajectoryBuffer::kComFrame));
+  buffer.attr("kJointAngles") = unsigned(TrajectoryBuffer::kJointAngles);
+  buffer.attr("kJointVels") = unsigned(TrajectoryBuffer::kJointVels);
+  buffer.attr("kJointAccels") = unsigned(TrajectoryBuffer::kJointAccels);
+  buffer.attr("kTorques") = unsigned(TrajectoryBuffer::kTorques);
+  buffer.attr("kPoses") = unsigned(TrajectoryBuffer::kPoses);
+  buffer.attr("kTwists") = unsigned(TrajectoryBuffer::kTwists);
+  buffer.attr("kAll") = unsigned(TrajectoryBuffer::kAll);
+  buffer.attr("kComFrame") = unsigned(TrajectoryBuffer::kComFrame);
+  buffer.attr("kLinkFrame") = unsigned(TrajectoryBuffer::kLinkFrame);
+}
+
+// The arrays of a VectorEnv are NumPy views sharing memory with it, so a
+// training loop writes `env.actions()[:] = a` and reads `env.observations()`
+// without copies, and step() runs all environments without the GIL.
+{
+  using gtdynamics::VectorEnv;
+  auto env = py::reinterpret_borrow<
+      py::class_<VectorEnv, boost::shared_ptr<VectorEnv>>>(
+      m_.attr("VectorEnv"));
+  const auto view = py::return_value_policy::reference_internal;
+  const auto release = py::call_guard<py::gil_scoped_release>();
+  env.def("actions",
+          [](VectorEnv &self) -> VectorEnv::Array & { return self.actions(); },
+          view)
+      .def("observations",
+           [](const VectorEnv &self) -> const VectorEnv::Array & {
+             return self.observations();
+           },
+           view)
+      .def("terminated",
+           [](const VectorEnv &self) -> const VectorEnv::Flags & {
+             return self.terminated();
+           },
+           view)
+      .def("truncated",
+           [](const VectorEnv &self) -> const VectorEnv::Flags & {
+             return self.truncated();
+           },
+           view)
+      .def("step", [](VectorEnv &self) { self.step(); }, release)
+      .def("reset", [](VectorEnv &self) { self.reset(); }, release)
+      .def("reset", [](VectorEnv &self, size_t n) { self.reset(n); },
+           py::arg("n"), release);
+}
+
+// Long solves release the GIL, so other Python threads keep running while
+// they do; they only touch C++ objects. SolverPool runs the same solves on a
+// C++ thread pool and returns futures, so one Python thread can keep several
+// cores busy. Tasks copy their inputs, except the Simulator, whose state they
+// advance: do not use a Simulator while a simulate task on it is pending.
+{
+  using namespace gtdynamics;
+  using gtsam::NonlinearFactorGraph;
+  using gtsam::Values;
+  typedef boost::optional<PointOnLinks> OptionalPoints;
+  const auto release = py::call_guard<py::gil_scoped_release>();
+
+  py::reinterpret_borrow<
+      py::class_<Optimizer, boost::shared_ptr<Optimizer>>>(
+      m_.attr("Optimizer"))
+      .def("optimize",
+           [](const Optimizer &self, const NonlinearFactorGraph &graph,
+              const Values &initial_values) {
+             return self.optimize(graph, initial_values);
+           },
+           py::arg("graph"), py::arg("initial_values"), release);
+
+  py::reinterpret_borrow<
+      py::class_<Kinematics, boost::shared_ptr<Kinematics>>>(
+      m_.attr("Kinematics"))
+      .def("inverse",
+           [](const Kinematics &self, const Slice &slice, const Robot &robot,
+              const ContactGoals &contact_goals) {
+             return self.inverse(slice, robot, contact_goals);
+           },
+           release)
+      .def("inverse",
+           [](const Kinematics &self, const Interval &interval,
+              const Robot &robot, const ContactGoals &contact_goals) {
+             return self.inverse(interval, robot, contact_goals);
+           },
+           release);
+
+  py::reinterpret_borrow<
+      py::class_<DynamicsGraph, boost::shared_ptr<DynamicsGraph>>>(
+      m_.attr("DynamicsGraph"))
+      .def("trajectoryFG",
+           [](const DynamicsGraph &self, const Robot &robot, int num_steps,
+              double dt, CollocationScheme collocation,
+              const OptionalPoints &contact_points,
+              const boost::optional<double> &mu) {
+             return self.trajectoryFG(robot, num_steps, dt, collocation,
+                                      contact_points, mu);
+           },
+           py::arg("robot"), py::arg("num_steps"), py::arg("dt"),
+           py::arg("collocation") = CollocationScheme::Trapezoidal,
+           py::arg("contact_points") = OptionalPoints(),
+           py::arg("mu") = boost::optional<double>(), release);
+
+  py::reinterpret_borrow<
+      py::class_<Simulator, boost::shared_ptr<Simulator>>>(
+      m_.attr("Simulator"))
+      .def("simulate",
+           [](Simulator &self, const std::vector<Values> &torques_seq,
+              double dt) { return self.simulate(torques_seq, dt); },
+           py::arg("torques_seq"), py::arg("dt"), release);
+
+  // Python builders run one at a time, as they need the GIL; their solves
+  // still run in parallel.
+  py::reinterpret_borrow<
+      py::class_<ParameterSweep, boost::shared_ptr<ParameterSweep>>>(
+      m_.attr("ParameterSweep"))
+      .def("run",
+           [](const ParameterSweep &self,
+              const ParameterSweep::Builder &builder,
+              const std::string &results_path) {
+             return self.run(builder, results_path);
+           },
+           py::arg("builder"), py::arg("results_path") = "", release)
+      .def("solve",
+           [](const ParameterSweep &self,
+              const std::vector<NonlinearFactorGraph> &graphs,
+              const std::vector<Values> &initial_values,
+              const std::string &results_path) {
+             return self.solve(graphs, initial_values, results_path);
+           },
+           py::arg("graphs"), py::arg("initial_values"),
+           py::arg("results_path") = "", release);
+
+  py::reinterpret_borrow<
+      py::class_<GaitSearch, boost::shared_ptr<GaitSearch>>>(
+      m_.attr("GaitSearch"))
+      .def("run",
+           [](const GaitSearch &self,
+              const std::vector<GaitCandidate> &candidates,
+              const GaitSearch::Builder &builder) {
+             return self.run(candidates, builder);
+           },
+           py::arg("candidates"), py::arg("builder"), release);
+
+  py::reinterpret_borrow<py::class_<MultiStartOptimizer,
+                                    boost::shared_ptr<MultiStartOptimizer>>>(
+      m_.attr("MultiStartOptimizer"))
+      .def("optimize",
+           [](const MultiStartOptimizer &self,
+              const NonlinearFactorGraph &graph,
+              const std::vector<Values> &initial_values) {
+             return self.optimize(graph, initial_values);
+           },
+           py::arg("graph"), py::arg("initial_values"), release)
+      .def("optimize",
+           [](const MultiStartOptimizer &self,
+              const NonlinearFactorGraph &graph,
+              const MultiStartOptimizer::InitialValuesFunction &function) {
+             return self.optimize(graph, function);
+           },
+           py::arg("graph"), py::arg("initial_values"), release);
+
+  // Futures of solves; result() waits without holding the GIL and rethrows
+  // exceptions of the solve.
+  typedef std::shared_future<Values> ValuesFuture;
+  typedef std::shared_future<NonlinearFactorGraph> GraphFuture;
+  py::class_<ValuesFuture>(m_, "ValuesFuture")
+      .def("result", [](const ValuesFuture &self) { return self.get(); },
+           release)
+      .def("wait", [](const ValuesFuture &self) { self.wait(); }, release)
+      .def("done", [](const ValuesFuture &self) {
+        return self.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+      });
+  py::class_<GraphFuture>(m_, "GraphFuture")
+      .def("result", [](const GraphFuture &self) { return self.get(); },
+           release)
+      .def("wait", [](const GraphFuture &self) { self.wait(); }, release)
+      .def("done", [](const GraphFuture &self) {
+        return self.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+      });
+
+  py::class_<ThreadPool, std::shared_ptr<ThreadPool>>(m_, "SolverPool")
+      .def(py::init<size_t>(), py::arg("num_threads") = 0)
+      .def("numThreads", &ThreadPool::numThreads)
+      .def("numQueued", &ThreadPool::numQueued)
+      .def("optimize",
+           [](ThreadPool &self, const NonlinearFactorGraph &graph,
+              const Values &initial_values,
+              const OptimizationParameters &parameters) {
+             return ValuesFuture(
+                 self.submit([graph, initial_values, parameters]() {
+                   return Optimizer(parameters).optimize(graph,
+                                                         initial_values);
+                 }));
+           },
+           py::arg("graph"), py::arg("initial_values"),
+           py::arg("parameters") = OptimizationParameters())
+      .def("inverse",
+           [](ThreadPool &self, const Kinematics &kinematics,
+              const Slice &slice, const Robot &robot,
+              const ContactGoals &contact_goals) {
+             return ValuesFuture(
+                 self.submit([kinematics, slice, robot, contact_goals]() {
+                   return kinematics.inverse(slice, robot, contact_goals);
+                 }));
+           })
+      .def("inverse",
+           [](ThreadPool &self, const Kinematics &kinematics,
+              const Interval &interval, const Robot &robot,
+              const ContactGoals &contact_goals) {
+             return ValuesFuture(
+                 self.submit([kinematics, interval, robot, contact_goals]() {
+                   return kinematics.inverse(interval, robot, contact_goals);
+                 }));
+           })
+      .def("trajectoryFG",
+           [](ThreadPool &self, const DynamicsGraph &graph_builder,
+              const Robot &robot, int num_steps, double dt,
+              CollocationScheme collocation,
+              const OptionalPoints &contact_points,
+              const boost::optional<double> &mu) {
+             return GraphFuture(self.submit([=]() {
+               return graph_builder.trajectoryFG(
+                   robot, num_steps, dt, collocation, contact_points, mu);
+             }));
+           },
+           py::arg("graph_builder"), py::arg("robot"), py::arg("num_steps"),
+           py::arg("dt"),
+           py::arg("collocation") = CollocationScheme::Trapezoidal,
+           py::arg("contact_points") = OptionalPoints(),
+           py::arg("mu") = boost::optional<double>())
+      .def("simulate",
+           [](ThreadPool &self, boost::shared_ptr<Simulator> simulator,
+              const std::vector<Values> &torques_seq, double dt) {
+             return ValuesFuture(self.submit([simulator, torques_seq, dt]() {
+               return simulator->simulate(torques_seq, dt);
+             }));
+           },
+           py::arg("simulator"), py::arg("torques_seq"), py::arg("dt"));
+}
+
+// Robots and values pickle in their compact binary formats, see RobotToBytes
+// and ValuesToBytes, so sending them to multiprocessing workers costs a copy
+// of their numbers instead of text serialization. These are raw
+// native-endian bytes, for processes on one machine, not for storage. Only
+// gtd.Values pickle this way by default, see register_values_pickling.
+{
+  using namespace gtdynamics;
+  py::reinterpret_borrow<py::class_<Robot, boost::shared_ptr<Robot>>>(
+      m_.attr("Robot"))
+      .def(py::pickle(
+          [](const Robot &self) { return py::bytes(RobotToBytes(self)); },
+          [](const py::bytes &data) {
+            return boost::make_shared<Robot>(RobotFromBytes(data));
+          }));
+  m_.def("ValuesToBytes", [](const gtsam::Values &values) {
+    return py::bytes(ValuesToBytes(values));
+  });
+  m_.def("ValuesFromBytes", [](const py::bytes &data) {
+    return ValuesFromBytes(data);
+  });
+}
+
+// Replays of trajectories in the contact simulator run without the GIL; the
+// simulator passed to ReplayTrajectory is advanced, ReplayTrajectories copies
+// it per trajectory.
+{
+  using namespace gtdynamics;
+  const auto release = py::call_guard<py::gil_scoped_release>();
+  m_.def("ReplayTrajectory",
+         [](ContactSimulator &simulator, const TrajectoryBuffer &trajectory,
+            double dt, const ReplayParameters &parameters) {
+           return ReplayTrajectory(&simulator, trajectory, dt, parameters);
+         },
+         py::arg("simulator"), py::arg("trajectory"), py::arg("dt"),
+         py::arg("parameters") = ReplayParameters(), release);
+  m_.def("ReplayTrajectories",
+         [](const ContactSimulator &simulator,
+            const std::vector<TrajectoryBuffer> &trajectories, double dt,
+            const ReplayParameters &parameters, size_t num_threads) {
+           return ReplayTrajectories(simulator, trajectories, dt, parameters,
+                                     num_threads);
+         },
+         py::arg("simulator"), py::arg("trajectories"), py::arg("dt"),
+         py::arg("parameters") = ReplayParameters(),
+         py::arg("num_threads") = 0, release);
+}
@@ -52,3 +52,25 @@ class TestContactEqualityFactor(TestFactors):
             point_on_link, gtsam.noiseModel.Isotropic.Sigma(3, 0.1), 0, 1)
 
         self.assertIsInstance(factor, gtd.ContactEqualityFactor)
+
+
+class TestBulkObjectives(TestFactors):
+    """Test suite for the bulk factor builders."""
+    def test_joint_priors(self):
+        """Priors on all joints for all steps, in one call."""
+        keys = gtd.JointKeys("q", [0, 1], 3)
+        self.assertEqual(len(keys), 6)
+        self.assertEqual(keys[5], gtd.JointAngleKey(1, 2).key())
+        model = gtsam.noiseModel.Unit.Create(1)
+        graph = gtd.DoublePriorFactors(keys, np.zeros(1), model)
+        self.assertEqual(graph.size(), 6)
+
+        angles = np.zeros((3, self.robot.numJoints()))
+        graph = gtd.JointPriorObjectives(self.robot, "q", angles, model)
+        self.assertEqual(graph.size(), 3 * self.robot.numJoints())
+
+    def test_min_torque(self):
+        """Torque minimization across a horizon."""
+        graph = gtd.MinTorqueObjectives(self.robot, 4,
+                                        gtsam.noiseModel.Unit.Create(1))
+        self.assertEqual(graph.size(), 4 * self.robot.numJoints())
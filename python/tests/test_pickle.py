@@ -0,0 +1,93 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_pickle.py
+ * @brief Test pickling robots and values for multiprocessing.
+ * @author GTDynamics Team
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import copyreg
+import multiprocessing
+import os.path as osp
+import pickle
+import unittest
+
+import numpy as np
+from gtsam import Pose3, Rot3, Unit3, Values
+
+import gtdynamics as gtd
+
+URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                     "models", "urdfs")
+
+
+def _num_links(robot):
+    """Work done in a worker process."""
+    return robot.numLinks()
+
+
+class TestPickle(unittest.TestCase):
+    """Test the binary pickling of Robot and Values."""
+
+    def setUp(self):
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(URDF_PATH, "vision60.urdf"), "")
+        self.values = Values()
+        gtd.InsertJointAngle(self.values, 2, 5, 0.25)
+        gtd.InsertPose(self.values, 1, 3,
+                       Pose3(Rot3.Rz(0.5), np.array([1., 2, 3])))
+        gtd.InsertWrench(self.values, 1, 2, 0, np.full(6, -1.5))
+
+    def test_robot(self):
+        """Robots round-trip through pickle."""
+        robot = pickle.loads(pickle.dumps(self.robot))
+        self.assertEqual(robot.numLinks(), self.robot.numLinks())
+        self.assertEqual(robot.numJoints(), self.robot.numJoints())
+        self.assertEqual(robot.joints()[3].name(),
+                         self.robot.joints()[3].name())
+
+    def test_values(self):
+        """gtd.Values round-trip through pickle in the binary format."""
+        gtd_values = gtd.Values(self.values)
+        self.assertNotIn(b"gtdynamics", pickle.dumps(self.values))
+        self.assertIn(b"_values_from_bytes", pickle.dumps(gtd_values))
+
+        values = pickle.loads(pickle.dumps(gtd_values))
+        self.assertIsInstance(values, gtd.Values)
+        self.assertTrue(values.equals(self.values, 1e-12))
+
+        decoded = gtd.ValuesFromBytes(gtd.ValuesToBytes(self.values))
+        self.assertTrue(decoded.equals(self.values, 1e-12))
+
+    def test_register_values_pickling(self):
+        """Plain gtsam values use the binary format only after opting in."""
+        gtd.register_values_pickling()
+        try:
+            self.assertIn(b"_values_from_bytes", pickle.dumps(self.values))
+            values = pickle.loads(pickle.dumps(self.values))
+            self.assertIsInstance(values, Values)
+            self.assertTrue(values.equals(self.values, 1e-12))
+        finally:
+            del copyreg.dispatch_table[Values]
+
+    def test_unsupported_values(self):
+        """Values without a binary encoding fall back to gtsam pickling."""
+        self.values.insert(gtd.DynamicsSymbol.SimpleSymbol("u", 0).key(),
+                           Unit3())
+        with self.assertRaises(ValueError):
+            gtd.ValuesToBytes(self.values)
+
+    def test_multiprocessing(self):
+        """Robots can be sent to worker processes."""
+        with multiprocessing.Pool(2) as pool:
+            counts = pool.map(_num_links, [self.robot] * 2)
+        self.assertEqual(counts, [self.robot.numLinks()] * 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -56,6 +56,17 @@ class TestLink(GtsamTestCase):
         self.assertEqual(expected_qVel, gtd.JointVel(results, 0, 0))
         self.assertEqual(expected_qAccel, gtd.JointAccel(results, 0, 0))
 
+    def test_validate_trajectory(self):
+        """Replay a trajectory at rest with PD tracking in C++."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        robot = robot.fixLink("l1")
+        trajectory = gtd.TrajectoryBuffer(robot, 5)
+        metrics = gtd.sim.validate_trajectory(robot, trajectory, 0.01,
+                                              gravity=np.zeros(3))
+        self.assertEqual(metrics["joint_angle_errors"].shape, (5, 1))
+        self.assertAlmostEqual(float(metrics["max_joint_angle_error"]), 0.0)
+
 
 if __name__ == "__main__":
     unittest.main()
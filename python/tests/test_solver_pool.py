@@ -0,0 +1,83 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_solver_pool.py
+ * @brief Test running solves on C++ threads from Python.
+ * @author GTDynamics Team
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import threading
+import unittest
+
+import numpy as np
+from gtsam import Values
+
+import gtdynamics as gtd
+
+
+class TestSolverPool(unittest.TestCase):
+    """Test SolverPool and GIL-releasing calls."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def setUp(self):
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        self.torques = Values()
+        gtd.InsertTorque(self.torques, 0, 1.0)
+
+    def simulator(self):
+        """Simulator of the one-link robot, as in test_simulator."""
+        return gtd.Simulator(self.robot.fixLink("l1"), Values(), np.zeros(3),
+                             np.asarray([1, 0, 0]))
+
+    def test_trajectory_fg(self):
+        """Graphs built on the pool match the ones built in Python."""
+        graph_builder = gtd.DynamicsGraph(np.asarray([0, 0, -9.8]), None)
+        expected = graph_builder.trajectoryFG(self.robot, 3, 0.1)
+        pool = gtd.SolverPool(2)
+        futures = [
+            pool.trajectoryFG(graph_builder, self.robot, 3, 0.1)
+            for _ in range(4)
+        ]
+        for future in futures:
+            self.assertEqual(future.result().size(), expected.size())
+            self.assertTrue(future.done())
+
+    def test_simulate(self):
+        """Simulations on the pool match serial ones."""
+        expected = self.simulator().simulate([self.torques] * 2, 1)
+        pool = gtd.SolverPool()
+        futures = [
+            pool.simulate(self.simulator(), [self.torques] * 2, 1)
+            for _ in range(3)
+        ]
+        for future in futures:
+            self.assertEqual(gtd.JointAngle(future.result(), 0, 0),
+                             gtd.JointAngle(expected, 0, 0))
+
+    def test_release_gil(self):
+        """Python threads can simulate concurrently."""
+        results = [None] * 4
+
+        def run(i):
+            results[i] = self.simulator().simulate([self.torques] * 2, 1)
+
+        threads = [threading.Thread(target=run, args=(i, )) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for result in results:
+            self.assertEqual(gtd.JointAngle(result, 0, 0), 0.03125)
+
+
+if __name__ == "__main__":
+    unittest.main()
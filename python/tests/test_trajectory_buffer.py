@@ -0,0 +1,96 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_trajectory_buffer.py
+ * @brief Test NumPy views of trajectory buffers.
+ * @author GTDynamics Team
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import numpy as np
+from gtsam import Point3, Pose3, Rot3, Values
+from gtsam.utils.test_case import GtsamTestCase
+
+import gtdynamics as gtd
+
+
+class TestTrajectoryBuffer(GtsamTestCase):
+    """Test bulk access to trajectories through TrajectoryBuffer."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def setUp(self):
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+
+    def test_from_values(self):
+        """Arrays read from Values are views of the buffer."""
+        values = Values()
+        for t in range(4):
+            gtd.InsertJointAngle(values, 0, t, 0.1 * t)
+        buffer = gtd.TrajectoryBuffer.FromValues(self.robot, values)
+        self.assertEqual(buffer.numSteps(), 4)
+
+        q = buffer.jointAngles()
+        np.testing.assert_allclose(q[:, 0], [0, 0.1, 0.2, 0.3])
+
+        # Writing into the view writes into the buffer.
+        q[2, 0] = 5.0
+        np.testing.assert_allclose(buffer.jointAngles()[2, 0], 5.0)
+
+    def test_insert(self):
+        """Whole arrays are inserted into Values at once."""
+        buffer = gtd.TrajectoryBuffer(self.robot, 3)
+        buffer.jointVels()[:, 0] = [1.0, 2.0, 3.0]
+        values = Values()
+        buffer.insert(values, gtd.TrajectoryBuffer.kJointVels)
+        self.assertEqual(values.size(), 3)
+        self.assertEqual(gtd.JointVel(values, 0, 2), 3.0)
+
+    def test_pose_matrices(self):
+        """All link poses come back as one array, frame by frame."""
+        values = Values()
+        for t in range(3):
+            for link in self.robot.links():
+                gtd.InsertPose(values, link.id(), t,
+                               Pose3(Rot3.Rz(0.3 * t), Point3(t, 0, 1)))
+        buffer = gtd.TrajectoryBuffer.FromValues(self.robot, values)
+        matrices = buffer.poseMatrices()
+        self.assertEqual(matrices.shape, (3, self.robot.numLinks(), 4, 4))
+        link = self.robot.links()[1]
+        np.testing.assert_allclose(
+            matrices[2, buffer.linkIndex(link.id())],
+            gtd.Pose(values, link.id(), 2).matrix())
+
+        frames = buffer.poseMatrices(gtd.TrajectoryBuffer.kLinkFrame)
+        com_T_link = link.bMcom().between(link.bMlink())
+        np.testing.assert_allclose(
+            frames[2, buffer.linkIndex(link.id())],
+            gtd.Pose(values, link.id(), 2).compose(com_T_link).matrix(),
+            atol=1e-12)
+
+    def test_recording(self):
+        """Simulator recordings come back as arrays."""
+        torques = Values()
+        gtd.InsertTorque(torques, 0, 1.0)
+        simulator = gtd.Simulator(self.robot.fixLink("l1"), Values(),
+                                  np.zeros(3), np.asarray([1, 0, 0]))
+        simulator.startRecording(2, False)
+        for _ in range(3):
+            simulator.step(torques, 0.5)
+        simulator.stopRecording()
+        recording = simulator.recording()
+        self.assertEqual(recording.numSteps(), 3)
+        np.testing.assert_allclose(recording.torques()[:, 0], 1.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
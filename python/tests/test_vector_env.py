@@ -0,0 +1,54 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_vector_env.py
+ * @brief Test NumPy views of vectorized environments.
+ * @author GTDynamics Team
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import numpy as np
+from gtsam.utils.test_case import GtsamTestCase
+
+import gtdynamics as gtd
+
+
+class TestVectorEnv(GtsamTestCase):
+    """Test stepping vectorized environments through array views."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def test_step(self):
+        """Actions written into the view drive every environment."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "vision60.urdf"), "")
+        feet = gtd.PointOnLinks()
+        for name in ["lower0", "lower1", "lower2", "lower3"]:
+            feet.append(gtd.PointOnLink(robot.link(name),
+                                        np.array([0.14, 0, 0])))
+        env = gtd.VectorEnv(robot, feet, 8, np.array([0, 0, -9.8]))
+
+        actions = env.actions()
+        observations = env.observations()
+        self.assertEqual(actions.shape, (8, 12))
+        self.assertEqual(observations.shape, (8, env.observationDim()))
+
+        actions[:] = 1.0
+        env.step()
+        # The views share memory with the environments.
+        np.testing.assert_array_equal(env.actions(), np.ones((8, 12)))
+        np.testing.assert_array_equal(observations, env.observations())
+        self.assertEqual(env.episodeSteps(0), 1)
+        self.assertFalse(env.terminated().any())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -7,8 +7,8 @@
 
 /**
  * @file  nithya_yetong00_constrainedopt_benchmark.cpp
- * @brief Benchmark penalty method optimizer and augmented lagrangian optimizer
- * on a toy example, and output intermediate results to file.
+ * @brief Benchmark soft constraints, penalty method, augmented lagrangian and
+ * SQP optimizers on a toy example, and output intermediate results to file.
  * @author: Nithya Jayakumar
  * @author: Yetong Zhang
  */
@@ -16,9 +16,12 @@
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
 #include <gtdynamics/optimizer/EqualityConstraint.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
 
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "constrainedExample.h"
 
@@ -60,6 +63,20 @@ int main(int argc, char** argv) {
   Values augl_results =
       augl_optimizer.optimize(graph, constraints, init_values, &augl_info);
 
+  /// Solve the constraint problem with SQP optimizer.
+  gtdynamics::SQPOptimizer sqp_optimizer;
+  gtdynamics::ConstrainedOptResult sqp_info;
+  Values sqp_results =
+      sqp_optimizer.optimize(graph, constraints, init_values, &sqp_info);
+
+  /// Solve with constraints as soft factors, in a single LM run.
+  NonlinearFactorGraph soft_graph = graph;
+  for (auto& constraint : constraints) {
+    soft_graph.add(constraint->createFactor(1.0));
+  }
+  LevenbergMarquardtOptimizer soft_optimizer(soft_graph, init_values);
+  Values soft_results = soft_optimizer.optimize();
+
   /// Function to evaluate constraint violation.
   auto evaluate_constraint = [&constraints](const gtsam::Values& values) {
     double violation = 0;
@@ -95,5 +112,32 @@ int main(int argc, char** argv) {
               << evaluate_cost(augl_info.intermediate_values[i]) << "\n";
   }
   augl_file.close();
+
+  std::ofstream sqp_file;
+  sqp_file.open("sqp_data.txt");
+  for (size_t i = 0; i < sqp_info.num_iters.size(); i++) {
+    sqp_file << sqp_info.num_iters[i] << " " << sqp_info.mu_values[i] << " "
+             << evaluate_constraint(sqp_info.intermediate_values[i]) << " "
+             << evaluate_cost(sqp_info.intermediate_values[i]) << "\n";
+  }
+  sqp_file.close();
+
+  /// Summary: total number of linear solves, violation and cost.
+  auto total = [](const std::vector<int>& num_iters) {
+    int sum = 0;
+    for (int n : num_iters) sum += n;
+    return sum;
+  };
+  auto report = [&](const std::string& name, int num_solves,
+                    const Values& values) {
+    std::cout << name << ": " << num_solves << " linear solves, violation "
+              << evaluate_constraint(values) << ", cost "
+              << evaluate_cost(values) << "\n";
+  };
+  report("soft constraints", soft_optimizer.getInnerIterations(),
+         soft_results);
+  report("penalty", total(penalty_info.num_iters), penalty_results);
+  report("augmented lagrangian", total(augl_info.num_iters), augl_results);
+  report("sqp", total(sqp_info.num_iters), sqp_results);
   return 0;
 }
\ No newline at end of file
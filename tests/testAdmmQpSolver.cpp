@@ -0,0 +1,147 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAdmmQpSolver.cpp
+ * @brief Test the export of linearized problems as QPs, and their ADMM
+ * solver.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AdmmQpSolver.h>
+#include <gtdynamics/optimizer/SparseQP.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <limits>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::I_1x1;
+using gtsam::Vector;
+using gtsam::Vector1;
+using gtsam::Vector2;
+
+namespace example {
+const gtsam::Key x0 = gtsam::Symbol('x', 0), x1 = gtsam::Symbol('x', 1);
+const double inf = std::numeric_limits<double>::infinity();
+
+// Cost 1/2 (x0 - 1)^2 + 1/2 (x1 - 2)^2.
+gtsam::GaussianFactorGraph Cost() {
+  gtsam::GaussianFactorGraph cost;
+  cost.add(x0, I_1x1, Vector1(1));
+  cost.add(x1, I_1x1, Vector1(2));
+  return cost;
+}
+
+// Constraints x0 + x1 <= 2 and x0 >= 0.
+gtsam::GaussianFactorGraph Inequalities() {
+  gtsam::GaussianFactorGraph inequalities;
+  inequalities.add(x0, -I_1x1, x1, -I_1x1, Vector1(-2));
+  inequalities.add(x0, I_1x1, Vector1(0));
+  return inequalities;
+}
+
+AdmmQpParameters Tight() {
+  AdmmQpParameters parameters;
+  parameters.abs_tolerance = parameters.rel_tolerance = 1e-8;
+  return parameters;
+}
+}  // namespace example
+
+// Least-squares factors become the cost, constrained rows equalities.
+TEST(SparseQP, FromLinear) {
+  using namespace example;
+  gtsam::GaussianFactorGraph cost = Cost();
+  cost.add(x0, I_1x1, x1, -I_1x1, Vector1(0),
+           gtsam::noiseModel::Constrained::All(1));
+  const SparseQP qp = SparseQP::FromLinear(cost, Inequalities());
+  LONGS_EQUAL(2, qp.numVariables());
+  LONGS_EQUAL(3, qp.numConstraints());
+  EXPECT(assert_equal(gtsam::Matrix(gtsam::I_2x2), gtsam::Matrix(qp.P)));
+  EXPECT(assert_equal(Vector2(-1, -2), qp.q));
+  EXPECT(assert_equal(Vector(gtsam::Vector3(0, -2, 0)), qp.l));
+  EXPECT_DOUBLES_EQUAL(0, qp.u(0), 0);
+  CHECK(std::isinf(qp.u(1)) && std::isinf(qp.u(2)));
+  EXPECT_DOUBLES_EQUAL(-1, qp.A.coeff(0, 1), 0);
+  EXPECT_DOUBLES_EQUAL(1, qp.A.coeff(2, 0), 0);
+
+  const gtsam::VectorValues values = qp.vectorValues(Vector2(3, 4));
+  EXPECT(assert_equal(Vector1(4), values.at(x1)));
+  EXPECT(assert_equal(Vector(Vector2(3, 4)), qp.stack(values)));
+}
+
+// ADMM finds the constrained minimum, and warm starts keep the
+// factorization.
+TEST(AdmmQpSolver, solve) {
+  using namespace example;
+  SparseQP qp = SparseQP::FromLinear(Cost(), Inequalities());
+  AdmmQpSolver solver(qp, Tight());
+  AdmmQpResult result = solver.solve();
+  CHECK(result.converged);
+  EXPECT(assert_equal(Vector(Vector2(0.5, 1.5)), solver.x(), 1e-6));
+  EXPECT_DOUBLES_EQUAL(qp.cost(solver.x()), result.cost, 1e-12);
+  EXPECT(assert_equal(Vector1(1.5), solver.solution().at(x1), 1e-6));
+
+  // A new target, as in the next MPC tick.
+  solver.update(Vector2(-1.1, -2), qp.l, qp.u);
+  result = solver.solve();
+  CHECK(result.converged);
+  EXPECT(assert_equal(Vector(Vector2(0.55, 1.45)), solver.x(), 1e-6));
+  LONGS_EQUAL(1, solver.numFactorizations());
+
+  // An equality x0 = x1 changes the matrices.
+  qp.A.resize(2, 2);
+  qp.A.insert(0, 0) = -1;
+  qp.A.insert(0, 1) = -1;
+  qp.A.insert(1, 0) = 1;
+  qp.A.insert(1, 1) = -1;
+  qp.A.makeCompressed();
+  qp.l = Vector2(-2, 0);
+  qp.u = Vector2(inf, 0);
+  solver.update(qp);
+  result = solver.solve();
+  CHECK(result.converged);
+  EXPECT(assert_equal(Vector(Vector2(1, 1)), solver.x(), 1e-6));
+  LONGS_EQUAL(2, solver.numFactorizations());
+
+  CHECK_EXCEPTION(solver.update(Vector1(1), qp.l, qp.u),
+                  std::invalid_argument);
+  AdmmQpParameters bad;
+  bad.alpha = 2;
+  CHECK_EXCEPTION(AdmmQpSolver(qp, bad), std::invalid_argument);
+}
+
+// The QP of a nonlinear problem is in the update of the nominal values.
+TEST(SparseQP, Linearize) {
+  using namespace example;
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      x0, 3.0, gtsam::noiseModel::Unit::Create(1));
+  InequalityConstraints inequalities;
+  const gtsam::Double_ x(x0);
+  inequalities.emplace_shared<DoubleExpressionInequality>(
+      gtsam::Double_(2.0) - x, 1e-3);
+
+  gtsam::Values nominal;
+  nominal.insert(x0, 0.5);
+  const SparseQP qp =
+      SparseQP::Linearize(graph, EqualityConstraints(), inequalities, nominal);
+  AdmmQpSolver solver(qp, Tight());
+  CHECK(solver.solve().converged);
+  EXPECT(assert_equal(Vector1(1.5), solver.solution().at(x0), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testArmIK.cpp
+ * @brief Test closed-form IK of the UR5 and Fanuc LR Mate arms.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/kinematics/ArmIK.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+namespace example {
+// End-effector pose from forward kinematics for the given joint angles.
+Pose3 Fk(const Robot &robot, const JointAngleMap &q,
+         const std::string &end_effector) {
+  gtsam::Values joint_angles;
+  for (auto &&kv : q) {
+    InsertJointAngle(&joint_angles, robot.joint(kv.first)->id(), kv.second);
+  }
+  const auto fk = robot.forwardKinematics(joint_angles);
+  return Pose(fk, robot.link(end_effector)->id());
+}
+
+// Check all solutions reproduce the goal and one of them is q.
+void CheckSolutions(const Robot &robot, const AnalyticalIKSolver &solver,
+                    const JointAngleMap &q, size_t expected_size) {
+  const auto base = robot.link(solver.baseLinkName());
+  const std::string ee = solver.endEffectorLinkName();
+  const Pose3 wTe = Fk(robot, q, ee);
+  const auto solutions =
+      solver.solve(robot, base->getFixedPose().between(wTe));
+  LONGS_EQUAL(expected_size, solutions.size());
+  bool found = false;
+  for (auto &&solution : solutions) {
+    EXPECT(assert_equal(wTe, Fk(robot, solution, ee), 1e-9));
+    bool same = true;
+    for (auto &&kv : q) {
+      same &= std::abs(solution.at(kv.first) - kv.second) < 1e-9;
+    }
+    found |= same;
+  }
+  EXPECT(found);
+}
+}  // namespace example
+
+TEST(ArmIK, UR5) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("ur5/ur5.urdf"))
+          .fixLink("base_link");
+  const UR5IKSolver solver;
+  EXPECT(solver.matches(robot));
+  EXPECT(!FanucLRMateIKSolver().matches(robot));
+  example::CheckSolutions(robot, solver,
+                          {{"shoulder_pan_joint", 0.3},
+                           {"shoulder_lift_joint", -1.2},
+                           {"elbow_joint", 1.4},
+                           {"wrist_1_joint", -0.5},
+                           {"wrist_2_joint", 0.8},
+                           {"wrist_3_joint", 0.2}},
+                          8);
+
+  // Out of reach.
+  EXPECT(solver.solve(robot, Pose3(gtsam::Rot3(), gtsam::Point3(2, 0, 0)))
+             .empty());
+}
+
+TEST(ArmIK, FanucLRMate) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("fanuc_lrmate200id.urdf"))
+          .fixLink("base_link");
+  const FanucLRMateIKSolver solver;
+  EXPECT(solver.matches(robot));
+  const JointAngleMap q{{"Base_Part2", 0.1},
+                        {"Part2_Part3", 0.2},
+                        {"Part3_Part4", 0.3},
+                        {"Part4_Part5", 0.4},
+                        {"Part6_Part6", 0.5}};
+  example::CheckSolutions(robot, solver, q, 1);
+
+  // The 5-DOF wrist does not reach every orientation.
+  const auto base = robot.link("base_link");
+  const Pose3 bTe =
+      base->getFixedPose().between(example::Fk(robot, q, "Part6"));
+  const Pose3 yawed = bTe * Pose3(gtsam::Rot3::Rz(0.3), gtsam::Point3());
+  EXPECT(solver.solve(robot, yawed).empty());
+}
+
+// Kinematics::inverse dispatches to the arm solvers through the registry.
+TEST(ArmIK, Registry) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("ur5/ur5.urdf"))
+          .fixLink("base_link");
+  const auto registry = ArmIKRegistry();
+  LONGS_EQUAL(2, registry->size());
+  CHECK(registry->find(robot, "wrist_3_link"));
+  EXPECT(!registry->find(robot, "Part6"));
+
+  const auto ee = robot.link("wrist_3_link");
+  const Pose3 wTe = example::Fk(robot,
+                                {{"shoulder_pan_joint", -0.4},
+                                 {"shoulder_lift_joint", -0.9},
+                                 {"elbow_joint", 1.1},
+                                 {"wrist_1_joint", 0.3},
+                                 {"wrist_2_joint", -1.2},
+                                 {"wrist_3_joint", 0.6}},
+                                "wrist_3_link");
+  KinematicsParameters parameters;
+  parameters.analytical_ik = registry;
+  const PoseGoals goals{{ee, wTe}};
+  const auto result = Kinematics(parameters).inverse(Slice(0), robot, goals);
+  EXPECT(goals[0].satisfied(result, 0, 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
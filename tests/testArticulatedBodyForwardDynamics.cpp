@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testArticulatedBodyForwardDynamics.cpp
+ * @brief Test articulated-body forward dynamics against the graph solvers.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/CompiledForwardDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Create kinematics and torques with non-trivial values for every joint.
+Values movingValues(const Robot& robot,
+                    const boost::optional<std::string>& root = boost::none) {
+  Values values;
+  double angle = 0.3, vel = -0.7;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), angle);
+    InsertJointVel(&values, joint->id(), vel);
+    angle = -0.8 * angle + 0.1, vel = 0.5 - 0.6 * vel;
+  }
+  Values known_values = robot.forwardKinematics(values, 0, root);
+  double torque = 0.2;
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&known_values, joint->id(), torque);
+    torque = 0.3 - torque;
+  }
+  return known_values;
+}
+
+// Compare accelerations and wrenches of two solutions.
+void checkEqual(const Robot& robot, const Values& expected,
+                const Values& actual, double tol) {
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j), JointAccel(actual, j), tol);
+    for (auto&& link : joint->links()) {
+      EXPECT(assert_equal(Wrench(expected, link->id(), j),
+                          Wrench(actual, link->id(), j), tol));
+    }
+  }
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(TwistAccel(expected, link->id()),
+                        TwistAccel(actual, link->id()), tol));
+  }
+}
+
+// Two-link robot with unit torque and a floating base.
+TEST(ArticulatedBodyForwardDynamics, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  int j = robot.joint("j1")->id();
+  EXPECT(ArticulatedBodyForwardDynamics::IsTree(robot));
+
+  Values values;
+  InsertPose(&values, l1->id(), l1->bMcom());
+  InsertTwist(&values, l1->id(), gtsam::Z_6x1);
+  Values known_values = robot.forwardKinematics(values, 0, std::string("l1"));
+  InsertTorque(&known_values, j, 1.0);
+
+  ArticulatedBodyForwardDynamics aba(robot, simple_urdf_eq_mass::gravity);
+  Values actual = aba.solve(0, known_values);
+  EXPECT(assert_equal(4.0, JointAccel(actual, j), 1e-6));
+
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity);
+  checkEqual(robot, graph_builder.linearSolveFD(robot, 0, known_values),
+             actual, 1e-6);
+}
+
+// Serial chain with a fixed base, in motion under gravity.
+TEST(ArticulatedBodyForwardDynamics, simple_rr_moving) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Vector3 gravity(0, 0, -9.8);
+  Values known_values = movingValues(robot);
+
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+  DynamicsGraph graph_builder(gravity);
+  checkEqual(robot, graph_builder.linearSolveFD(robot, 0, known_values),
+             aba.solve(0, known_values), 1e-6);
+}
+
+// Floating-base quadruped, checked against the compiled graph solver.
+TEST(ArticulatedBodyForwardDynamics, a1) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  gtsam::Vector3 gravity(0, 0, -9.8);
+  Values known_values = movingValues(robot, std::string("trunk"));
+
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+  CompiledForwardDynamics compiled(robot, gravity);
+  checkEqual(robot, compiled.solve(0, known_values),
+             aba.solve(0, known_values), 1e-5);
+}
+
+// Closed chains are rejected.
+TEST(ArticulatedBodyForwardDynamics, four_bar_linkage_pure) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  EXPECT(!ArticulatedBodyForwardDynamics::IsTree(robot));
+  CHECK_EXCEPTION(ArticulatedBodyForwardDynamics aba(robot),
+                  std::invalid_argument);
+}
+
+// Simulator selects the backend automatically and all backends agree.
+TEST(ArticulatedBodyForwardDynamics, Simulator) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Vector3 gravity(0, 0, -9.8);
+  Values initial_values, torques;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&initial_values, joint->id(), 0.1);
+    InsertJointVel(&initial_values, joint->id(), 0.0);
+    InsertTorque(&torques, joint->id(), 0.5);
+  }
+  std::vector<Values> torques_seq(5, torques);
+
+  Simulator graph_sim(robot, initial_values, gravity, boost::none,
+                      ForwardDynamicsBackend::FactorGraph);
+  Values expected = graph_sim.simulate(torques_seq, 0.01);
+
+  Simulator aba_sim(robot, initial_values, gravity);
+  EXPECT(aba_sim.backend() == ForwardDynamicsBackend::ArticulatedBody);
+  Values actual = aba_sim.simulate(torques_seq, 0.01);
+
+  Simulator compiled_sim(robot, initial_values, gravity, boost::none,
+                         ForwardDynamicsBackend::Compiled);
+  Values compiled = compiled_sim.simulate(torques_seq, 0.01);
+
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(JointAngle(expected, j), JointAngle(actual, j), 1e-9);
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j), JointAccel(actual, j), 1e-6);
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j), JointAccel(compiled, j),
+                         1e-6);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
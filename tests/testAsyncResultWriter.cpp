@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAsyncResultWriter.cpp
+ * @brief Test writing results on a background thread.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/AsyncResultWriter.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace example {
+const std::string json_path = "testAsyncResultWriter.ndjson";
+const std::string log_path = "testAsyncResultWriter.gtdtraj";
+
+Values Trajectory(int num_steps) {
+  Values values;
+  for (int t = 0; t < num_steps; t++) {
+    InsertJointAngle(&values, 0, t, 0.1 * t);
+    InsertPose(&values, 1, t, gtsam::Pose3());
+  }
+  return values;
+}
+
+size_t NumLines(const std::string &path) {
+  std::ifstream is(path);
+  size_t n = 0;
+  for (std::string line; std::getline(is, line);) n++;
+  return n;
+}
+}  // namespace example
+
+// Results are moved into the writer and written in both formats.
+TEST(AsyncResultWriter, Formats) {
+  AsyncResultWriter writer;
+  Values values = example::Trajectory(3);
+  writer.writeValues(example::json_path, std::move(values),
+                     ResultFormat::kNdJson);
+  EXPECT(values.empty());
+  writer.writeValues(example::log_path, example::Trajectory(4),
+                     ResultFormat::kTrajectoryLog);
+  writer.flush();
+  EXPECT_LONGS_EQUAL(2, writer.numWritten());
+  EXPECT_LONGS_EQUAL(6, example::NumLines(example::json_path));
+  EXPECT_LONGS_EQUAL(4, TrajectoryLog(example::log_path).numSteps());
+
+  // A factor graph with its values: one variable and one factor.
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      JointAngleKey(0, 0), 0.0, gtsam::noiseModel::Unit::Create(1));
+  writer.writeGraph(example::json_path, std::move(graph),
+                    example::Trajectory(1));
+  writer.flush();
+  EXPECT_LONGS_EQUAL(2, example::NumLines(example::json_path));
+  CHECK_EXCEPTION(writer.writeGraph(example::json_path,
+                                    gtsam::NonlinearFactorGraph(), Values(),
+                                    ResultFormat::kTrajectoryLog),
+                  std::invalid_argument);
+
+  std::remove(example::json_path.c_str());
+  std::remove(example::log_path.c_str());
+}
+
+// With the queue full, try functions refuse results and leave them intact.
+TEST(AsyncResultWriter, Backpressure) {
+  AsyncResultWriter writer(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  writer.post([released]() { released.wait(); });
+  while (writer.numQueued() > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  writer.post([]() {});
+  EXPECT_LONGS_EQUAL(1, writer.numQueued());
+
+  EXPECT(!writer.tryPost([]() {}));
+  Values values = example::Trajectory(2);
+  EXPECT(!writer.tryWriteValues(example::json_path, std::move(values),
+                                ResultFormat::kNdJson));
+  EXPECT_LONGS_EQUAL(4, values.size());
+
+  release.set_value();
+  writer.flush();
+  EXPECT_LONGS_EQUAL(2, writer.numWritten());
+  EXPECT(writer.tryWriteValues(example::json_path, std::move(values),
+                               ResultFormat::kNdJson));
+  writer.flush();
+  EXPECT_LONGS_EQUAL(4, example::NumLines(example::json_path));
+  std::remove(example::json_path.c_str());
+}
+
+// Exceptions in the writer thread are rethrown once by flush.
+TEST(AsyncResultWriter, Errors) {
+  CHECK_EXCEPTION(AsyncResultWriter(0), std::invalid_argument);
+  AsyncResultWriter writer;
+  writer.post([]() { throw std::runtime_error("disk full"); });
+  writer.post([]() {});
+  CHECK_EXCEPTION(writer.flush(), std::runtime_error);
+  EXPECT_LONGS_EQUAL(2, writer.numWritten());
+  writer.flush();
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
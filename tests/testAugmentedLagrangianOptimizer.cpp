@@ -59,6 +59,47 @@ TEST(AugmentedLagrangianOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+// Solve twice, the second time warm started from the first.
+TEST(AugmentedLagrangianOptimizer, WarmStart) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1e-3);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  AugmentedLagrangianParameters params;
+  params.num_iterations = 20;
+  params.violation_tolerance = 1.0;
+  gtdynamics::AugmentedLagrangianOptimizer optimizer(params);
+
+  // Cold start terminates early once feasible.
+  AugmentedLagrangianState state;
+  Values results = optimizer.optimize(graph, constraints, init_values, &state);
+  EXPECT(state.num_iterations < params.num_iterations);
+  EXPECT(state.violation < 1.0);
+  EXPECT(constraints[0]->feasible(results));
+  EXPECT_LONGS_EQUAL(1, state.multipliers.size());
+  EXPECT(assert_equal(results, state.values));
+
+  // Warm start from the previous solution needs at most as many iterations.
+  const size_t cold_iterations = state.num_iterations;
+  AugmentedLagrangianState warm = state;
+  Values warm_results =
+      optimizer.optimize(graph, constraints, state.values, &warm);
+  EXPECT(warm.num_iterations <= cold_iterations);
+  EXPECT(assert_equal(results, warm_results, 1e-3));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBSplineTrajectory.cpp
+ * @brief Test joint trajectories parameterized by B-spline control points.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/BSplineTrajectory.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const size_t num_steps = 20;
+const double dt = 0.05;
+
+// A cubic, which a cubic spline represents exactly.
+double q(double t, int j) {
+  return 0.3 * j + 0.5 * t - 0.2 * t * t + t * t * t;
+}
+double v(double t) { return 0.5 - 0.4 * t + 3.0 * t * t; }
+double a(double t) { return -0.4 + 6.0 * t; }
+
+Values Angles() {
+  Values values;
+  for (auto&& joint : robot.joints())
+    for (size_t k = 0; k <= num_steps; k++)
+      InsertJointAngle(&values, joint->id(), k, q(k * dt, joint->id()));
+  return values;
+}
+}  // namespace example
+
+// Weights of the angle sum to one, those of its derivatives to zero.
+TEST(BSplineTrajectory, PartitionOfUnity) {
+  BSplineTrajectory spline(6, example::num_steps, example::dt);
+  for (size_t k = 0; k <= example::num_steps; k++) {
+    EXPECT_DOUBLES_EQUAL(1.0, spline.weights(k, 0).sum(), 1e-12);
+    EXPECT_DOUBLES_EQUAL(0.0, spline.weights(k, 1).sum(), 1e-9);
+    EXPECT_DOUBLES_EQUAL(0.0, spline.weights(k, 2).sum(), 1e-9);
+  }
+  // Clamped: the end steps are the end control points.
+  LONGS_EQUAL(0, spline.firstControlPoint(0));
+  EXPECT_DOUBLES_EQUAL(1.0, spline.weights(0, 0)(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(1.0, spline.weights(example::num_steps, 0)(3), 1e-12);
+}
+
+// Fitting a cubic recovers it and its derivatives at every step.
+TEST(BSplineTrajectory, FitAndExpand) {
+  using namespace example;
+  BSplineTrajectory spline(5, num_steps, dt);
+  const Values control_points = spline.fit(robot, Angles());
+  LONGS_EQUAL(5 * robot.numJoints(), control_points.size());
+
+  const Values values = spline.expand(robot, control_points);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    for (size_t k = 0; k <= num_steps; k++) {
+      const double t = k * dt;
+      EXPECT_DOUBLES_EQUAL(q(t, j), JointAngle(values, j, k), 1e-9);
+      EXPECT_DOUBLES_EQUAL(v(t), JointVel(values, j, k), 1e-9);
+      EXPECT_DOUBLES_EQUAL(a(t), JointAccel(values, j, k), 1e-9);
+    }
+  }
+}
+
+// Rewritten factors have the error of the original factors at the expanded
+// values, and optimizing the control points solves the original problem.
+TEST(BSplineTrajectory, Rewrite) {
+  using namespace example;
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+  const int j = robot.joints()[0]->id();
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t k = 0; k <= num_steps; k += 4) {
+    graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(j, k),
+                                                      q(k * dt, j), model);
+  }
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointVelKey(j, 0), v(0),
+                                                    model);
+  // Velocity at step 10 minus velocity at step 0.
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointVelKey(j, 0), JointVelKey(j, 10), v(10 * dt) - v(0), model);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAccelKey(j, 20),
+                                                    a(20 * dt), model);
+  // A factor on another variable is kept as it is.
+  graph.emplace_shared<gtsam::PriorFactor<double>>(TorqueKey(j, 0), 1.0,
+                                                    model);
+
+  BSplineTrajectory spline(4, num_steps, dt);
+  const auto rewritten = spline.rewrite(graph);
+  LONGS_EQUAL(graph.size(), rewritten.size());
+  CHECK(rewritten.back() == graph.back());
+  CHECK(boost::dynamic_pointer_cast<BSplineFactor>(rewritten.front()));
+
+  Values initial;
+  for (size_t c = 0; c < 4; c++) {
+    initial.insert(JointControlPointKey(j, c), 0.1 * c);
+  }
+  initial.insert(TorqueKey(j, 0), 0.0);
+  Values expanded = initial;
+  for (size_t k = 0; k <= num_steps; k++) {
+    for (int order = 0; order < 3; order++) {
+      const double value = spline.evaluate(initial, j, k, order);
+      if (order == 0) InsertJointAngle(&expanded, j, k, value);
+      if (order == 1) InsertJointVel(&expanded, j, k, value);
+      if (order == 2) InsertJointAccel(&expanded, j, k, value);
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(graph.error(expanded), rewritten.error(initial), 1e-9);
+
+  // Only the 4 control points and the torque are variables.
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(rewritten, initial).optimize();
+  LONGS_EQUAL(5, result.size());
+  EXPECT_DOUBLES_EQUAL(0.0, rewritten.error(result), 1e-9);
+  for (size_t k = 0; k <= num_steps; k++) {
+    EXPECT_DOUBLES_EQUAL(q(k * dt, j), spline.evaluate(result, j, k, 0), 1e-6);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchForwardKinematics.cpp
+ * @brief Test batched forward kinematics against Robot::forwardKinematics.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+
+// Check every configuration of a batch against the Values-based version.
+void checkBatch(const Robot& robot, const Matrix& angles, const Matrix& vels,
+                const boost::optional<std::string>& prior_link_name,
+                const boost::optional<Pose3>& root_pose) {
+  BatchForwardKinematics batch(robot, prior_link_name);
+  batch.compute(angles, vels, root_pose);
+  EXPECT_LONGS_EQUAL(angles.rows(), batch.batchSize());
+
+  const auto joints = robot.joints();
+  for (int n = 0; n < angles.rows(); n++) {
+    Values values;
+    for (size_t j = 0; j < joints.size(); j++) {
+      InsertJointAngle(&values, joints[j]->id(), angles(n, j));
+      InsertJointVel(&values, joints[j]->id(), vels(n, j));
+    }
+    if (root_pose) {
+      const int root_id = robot.link(*prior_link_name)->id();
+      InsertPose(&values, root_id, *root_pose);
+    }
+    Values expected = robot.forwardKinematics(values, 0, prior_link_name);
+    for (auto&& link : robot.links()) {
+      EXPECT(assert_equal(Pose(expected, link->id()),
+                          batch.pose(n, link->id()), 1e-9));
+      EXPECT(assert_equal(Twist(expected, link->id()),
+                          batch.twist(n, link->id()), 1e-9));
+    }
+  }
+}
+
+// Serial chain with a fixed base.
+TEST(BatchForwardKinematics, simple_rr) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  Matrix angles(3, 2), vels(3, 2);
+  angles << 0, 0, 0.3, -1.2, 2.5, 0.7;
+  vels << 0, 0, 1.0, 0.5, -2.0, 3.0;
+  checkBatch(robot, angles, vels, boost::none, boost::none);
+}
+
+// Floating-base quadruped rooted at the trunk, with a given trunk pose.
+TEST(BatchForwardKinematics, a1) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const int N = 4, dof = robot.numJoints();
+  Matrix angles(N, dof), vels(N, dof);
+  for (int n = 0; n < N; n++) {
+    for (int j = 0; j < dof; j++) {
+      angles(n, j) = 0.1 * (n + 1) * std::sin(j + 1.0);
+      vels(n, j) = 0.5 * std::cos(n + 2.0 * j);
+    }
+  }
+  Pose3 trunk_pose(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                   gtsam::Point3(1, 2, 0.4));
+  checkBatch(robot, angles, vels, std::string("trunk"), trunk_pose);
+}
+
+// Prismatic joints and zero velocities.
+TEST(BatchForwardKinematics, prismatic) {
+  auto robot = CreateRobotFromFile(
+                   kUrdfPath + std::string("test/simple_urdf_prismatic.urdf"))
+                   .fixLink("l1");
+  Matrix angles(2, 1);
+  angles << 0.0, 0.75;
+  BatchForwardKinematics batch(robot);
+  batch.compute(angles);
+  Values values;
+  InsertJointAngle(&values, robot.joint("j1")->id(), 0.75);
+  Values expected = robot.forwardKinematics(values);
+  int l2 = robot.link("l2")->id();
+  EXPECT(assert_equal(Pose(expected, l2), batch.pose(1, l2), 1e-9));
+  EXPECT(assert_equal(gtsam::Vector6::Zero(), batch.twist(1, l2), 1e-9));
+}
+
+// Single precision agrees with double precision on all robot models.
+TEST(BatchForwardKinematics, single_precision) {
+  for (auto &&file :
+       {"a1/a1.urdf", "atlas.urdf", "biped.urdf", "cart_pole.urdf",
+        "fanuc_lrmate200id.urdf", "fetch.urdf", "inverted_pendulum.urdf",
+        "laikago.urdf", "panda/panda.urdf", "ur5/ur5.urdf", "vision60.urdf"}) {
+    auto robot = CreateRobotFromFile(kUrdfPath + std::string(file));
+    const std::string root = robot.links()[0]->name();
+    const int N = 5, dof = robot.numJoints();
+    Matrix angles(N, dof), vels(N, dof);
+    for (int n = 0; n < N; n++) {
+      for (int j = 0; j < dof; j++) {
+        angles(n, j) = 0.3 * (n + 1) * std::sin(j + 1.0);
+        vels(n, j) = 0.5 * std::cos(n + 2.0 * j);
+      }
+    }
+    BatchForwardKinematics batch(robot, root);
+    batch.compute(angles, vels);
+    BatchForwardKinematicsf batch_f(robot, root);
+    batch_f.compute(angles.cast<float>(), vels.cast<float>());
+    for (int n = 0; n < N; n++) {
+      for (auto&& link : robot.links()) {
+        EXPECT(assert_equal(batch.pose(n, link->id()),
+                            batch_f.pose(n, link->id()), 1e-4));
+        EXPECT(assert_equal(batch.twist(n, link->id()),
+                            batch_f.twist(n, link->id()), 1e-4));
+      }
+    }
+  }
+}
+
+// World positions of points on links.
+TEST(BatchForwardKinematics, point_positions) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  Matrix angles(2, 2);
+  angles << 0.3, -1.2, 2.5, 0.7;
+  BatchForwardKinematics batch(robot);
+  batch.compute(angles);
+  const PointOnLinks points = {
+      PointOnLink(robot.link("link_1"), gtsam::Point3(0, 0, 0.5)),
+      PointOnLink(robot.link("link_2"), gtsam::Point3(0.1, -0.2, 0.3))};
+  const Matrix positions = batch.pointPositions(points);
+  EXPECT_LONGS_EQUAL(6, positions.cols());
+  for (int n = 0; n < 2; n++) {
+    for (size_t i = 0; i < points.size(); i++) {
+      const gtsam::Point3 expected =
+          batch.pose(n, points[i].link->id()).transformFrom(points[i].point);
+      EXPECT(assert_equal(expected,
+                          gtsam::Point3(positions.block<1, 3>(n, 3 * i)),
+                          1e-9));
+    }
+  }
+}
+
+// Without a prior link the robot needs a fixed link.
+TEST(BatchForwardKinematics, no_root) {
+  auto robot = simple_rr::getRobot();
+  THROWS_EXCEPTION(BatchForwardKinematics batch(robot));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
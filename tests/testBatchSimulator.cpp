@@ -0,0 +1,202 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchSimulator.cpp
+ * @brief Test BatchSimulator against Simulator.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Values;
+
+// Same single-joint case as testSimulator, in several environments.
+TEST(BatchSimulator, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  const size_t num_envs = 3;
+  BatchSimulator simulator(robot, num_envs, simple_urdf::gravity, 2);
+
+  Matrix torques = Matrix::Ones(num_envs, 1);
+  const double dt = 1;
+  auto trajectories =
+      simulator.simulate(std::vector<Matrix>(2, torques), dt);
+  EXPECT_LONGS_EQUAL(num_envs, trajectories.size());
+  EXPECT_LONGS_EQUAL(2, simulator.t());
+
+  const double acceleration = 0.0625;
+  const int j = robot.joints()[0]->id();
+  for (auto &&trajectory : trajectories) {
+    EXPECT_LONGS_EQUAL(2, trajectory.numSteps());
+    EXPECT_DOUBLES_EQUAL(acceleration * 0.5 * dt * dt,
+                         trajectory.jointAngle(j, 1), 1e-9);
+    EXPECT_DOUBLES_EQUAL(acceleration * dt, trajectory.jointVel(j, 1), 1e-9);
+    EXPECT_DOUBLES_EQUAL(acceleration, trajectory.jointAccel(j, 1), 1e-9);
+  }
+}
+
+// Every environment follows the Simulator with the same initial state and
+// torques.
+TEST(BatchSimulator, simple_rr) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const size_t num_envs = 4, num_joints = robot.numJoints(), num_steps = 5;
+  const double dt = 0.01;
+
+  Matrix q0(num_envs, num_joints), v0(num_envs, num_joints);
+  std::vector<Matrix> torques_seq;
+  for (size_t n = 0; n < num_envs; n++) {
+    for (size_t j = 0; j < num_joints; j++) {
+      q0(n, j) = 0.1 * n - 0.2 * j;
+      v0(n, j) = 0.3 * j - 0.05 * n;
+    }
+  }
+  for (size_t k = 0; k < num_steps; k++) {
+    Matrix torques(num_envs, num_joints);
+    for (size_t n = 0; n < num_envs; n++)
+      for (size_t j = 0; j < num_joints; j++)
+        torques(n, j) = 0.1 * k - 0.2 * n + 0.3 * j;
+    torques_seq.push_back(torques);
+  }
+
+  BatchSimulator batch(robot, num_envs, gravity, 0);
+  batch.setInitialState(q0, v0);
+  auto trajectories = batch.simulate(torques_seq, dt);
+
+  const auto &joints = robot.joints();
+  for (size_t n = 0; n < num_envs; n++) {
+    Values initial_values;
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertJointAngle(&initial_values, joints[j]->id(), q0(n, j));
+      InsertJointVel(&initial_values, joints[j]->id(), v0(n, j));
+    }
+    Simulator simulator(robot, initial_values, gravity, boost::none,
+                        ForwardDynamicsBackend::ArticulatedBody);
+    for (size_t k = 0; k < num_steps; k++) {
+      Values torques;
+      for (size_t j = 0; j < num_joints; j++)
+        InsertTorque(&torques, joints[j]->id(), torques_seq[k](n, j));
+      simulator.step(torques, dt);
+      const Values &expected = simulator.getValues();
+      for (auto &&joint : joints) {
+        const int id = joint->id();
+        EXPECT_DOUBLES_EQUAL(JointAngle(expected, id),
+                             trajectories[n].jointAngle(id, k), 1e-9);
+        EXPECT_DOUBLES_EQUAL(JointVel(expected, id),
+                             trajectories[n].jointVel(id, k), 1e-9);
+        EXPECT_DOUBLES_EQUAL(JointAccel(expected, id),
+                             trajectories[n].jointAccel(id, k), 1e-9);
+      }
+      for (auto &&link : robot.links()) {
+        EXPECT(assert_equal(Pose(expected, link->id()),
+                            trajectories[n].pose(link->id(), k), 1e-9));
+      }
+    }
+  }
+
+  // A reset returns to the initial state.
+  batch.reset();
+  EXPECT(assert_equal(q0, batch.jointAngles()));
+  EXPECT(assert_equal(v0, batch.jointVels()));
+}
+
+// The batch and single-environment simulators agree for every scheme.
+TEST(BatchSimulator, integrators) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const size_t num_joints = robot.numJoints();
+  const double dt = 0.05;
+  const Matrix q0 = Matrix::Constant(1, num_joints, 0.3),
+               v0 = Matrix::Constant(1, num_joints, -0.2),
+               torques = Matrix::Constant(1, num_joints, 0.1);
+
+  Values initial_values, torque_values;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&initial_values, joint->id(), 0.3);
+    InsertJointVel(&initial_values, joint->id(), -0.2);
+    InsertTorque(&torque_values, joint->id(), 0.1);
+  }
+
+  for (auto scheme :
+       {IntegrationScheme::SemiImplicitEuler, IntegrationScheme::RK4,
+        IntegrationScheme::ImplicitEuler}) {
+    BatchSimulator batch(robot, 1, gravity, 1, scheme);
+    batch.setInitialState(q0, v0);
+    Simulator simulator(robot, initial_values, gravity, boost::none,
+                        ForwardDynamicsBackend::ArticulatedBody, scheme);
+    for (int k = 0; k < 3; k++) {
+      batch.step(torques, dt);
+      simulator.step(torque_values, dt);
+    }
+    // One more forward dynamics exposes the integrated state.
+    simulator.forwardDynamics(torque_values);
+    const Values &expected = simulator.getValues();
+    for (auto &&joint : robot.joints()) {
+      const int i = robot.topology().joint_index[joint->id()];
+      EXPECT_DOUBLES_EQUAL(JointAngle(expected, joint->id()),
+                           batch.jointAngles()(0, i), 1e-6);
+      EXPECT_DOUBLES_EQUAL(JointVel(expected, joint->id()),
+                           batch.jointVels()(0, i), 1e-6);
+    }
+  }
+}
+
+// Passive torques and limits match the Simulator.
+TEST(BatchSimulator, joint_efforts) {
+  auto robot = simple_urdf::getRobot();
+  const size_t num_envs = 2;
+  BatchSimulator batch(robot, num_envs, simple_urdf::gravity);
+  batch.setJointEfforts();
+  Matrix q0(num_envs, 1), v0(num_envs, 1), torques(num_envs, 1);
+  q0 << 0.0, 1.5;
+  v0 << 0.1, 0.0;
+  torques << 1.0, 2000.0;
+  batch.setInitialState(q0, v0);
+  const double dt = 0.01;
+  auto trajectories =
+      batch.simulate(std::vector<Matrix>(20, torques), dt);
+
+  const int j = robot.joints()[0]->id();
+  for (size_t n = 0; n < num_envs; n++) {
+    Values initial_values, env_torques;
+    InsertJointAngle(&initial_values, j, q0(n, 0));
+    InsertJointVel(&initial_values, j, v0(n, 0));
+    InsertTorque(&env_torques, j, torques(n, 0));
+    Simulator simulator(robot, initial_values, simple_urdf::gravity,
+                        simple_urdf::planar_axis,
+                        ForwardDynamicsBackend::ArticulatedBody);
+    simulator.setJointEfforts();
+    for (int k = 0; k < 20; k++) {
+      simulator.step(env_torques, dt);
+      const Values &values = simulator.getValues();
+      EXPECT_DOUBLES_EQUAL(JointAngle(values, j),
+                           trajectories[n].jointAngle(j, k), 1e-9);
+      EXPECT_DOUBLES_EQUAL(JointVel(values, j),
+                           trajectories[n].jointVel(j, k), 1e-9);
+      EXPECT_DOUBLES_EQUAL(Torque(values, j), trajectories[n].torque(j, k),
+                           1e-9);
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(1.57, batch.jointAngles()(1, 0), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
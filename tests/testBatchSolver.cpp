@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchSolver.cpp
+ * @brief Test solving batches of serialized problems.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/BatchSolver.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/serializationTestHelpers.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// Declarations needed for serialization of derived classes.
+BOOST_CLASS_EXPORT_GUID(gtsam::noiseModel::Isotropic,
+                        "gtsam_noiseModel_Isotropic")
+BOOST_CLASS_EXPORT_GUID(gtsam::PriorFactor<double>, "gtsam_PriorFactor_double")
+BOOST_CLASS_EXPORT_GUID(gtsam::BetweenFactor<double>,
+                        "gtsam_BetweenFactor_double")
+GTSAM_VALUE_EXPORT(double)
+
+namespace example {
+// A chain of joint angles from zero to a goal.
+BatchProblem chain(int num_steps, double goal) {
+  BatchProblem problem;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+  problem.graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  for (int t = 1; t < num_steps; t++) {
+    problem.graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), goal / (num_steps - 1),
+        model);
+  }
+  for (int t = 0; t < num_steps; t++) {
+    InsertJointAngle(&problem.initial_values, 0, t, 0.0);
+  }
+  return problem;
+}
+}  // namespace example
+
+// Problems survive serialization.
+TEST(BatchProblem, Serialization) {
+  const BatchProblem problem = example::chain(4, 1.0);
+  const BatchProblem copy = BatchProblem::FromBinary(problem.toBinary());
+  EXPECT(problem.graph.equals(copy.graph));
+  EXPECT(assert_equal(problem.initial_values, copy.initial_values));
+}
+
+// A batch solved on a thread pool, with one broken problem.
+TEST(BatchSolver, solve) {
+  std::vector<std::string> problems;
+  for (int k = 0; k < 4; k++) {
+    problems.push_back(example::chain(5, 0.5 * k).toBinary());
+  }
+  problems.push_back("not a problem");
+
+  const BatchSolver solver(OptimizationParameters(), {JointAngleKey(0, 4)},
+                           2);
+  const auto results = solver.solve(problems);
+  EXPECT_LONGS_EQUAL(5, results.size());
+  for (int k = 0; k < 4; k++) {
+    EXPECT(results[k].solved);
+    EXPECT_LONGS_EQUAL(k, results[k].index);
+    EXPECT_DOUBLES_EQUAL(0.0, results[k].error, 1e-6);
+    EXPECT_DOUBLES_EQUAL(0.5 * k, JointAngle(results[k].outputs, 0, 4), 1e-6);
+  }
+  EXPECT(!results[4].solved);
+  EXPECT(!results[4].message.empty());
+
+  // Results are compact and survive serialization.
+  const BatchResult copy = BatchResult::FromBinary(results[2].toBinary());
+  EXPECT_LONGS_EQUAL(2, copy.index);
+  EXPECT_LONGS_EQUAL(1, copy.outputs.size());
+  EXPECT(assert_equal(results[2].outputs, copy.outputs));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
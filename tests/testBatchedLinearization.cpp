@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchedLinearization.cpp
+ * @brief Test linearization in batches of one factor type.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/BatchedLinearization.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <set>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const int num_steps = 10;
+
+// Forward dynamics of a single joint under constant torque.
+gtsam::NonlinearFactorGraph Graph() {
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  return graph;
+}
+}  // namespace example
+
+// Every factor is in one batch of its type, and the linearization is that
+// of the graph.
+TEST(FactorBatches, linearize) {
+  using namespace example;
+  auto graph = Graph();
+  graph.push_back(gtsam::NonlinearFactor::shared_ptr());
+  Initializer initializer;
+  const auto values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+
+  const FactorBatches batches(graph, 8);
+  EXPECT(batches.types().size() > 1);
+  std::set<size_t> batched;
+  size_t expected_batches = 0;
+  for (auto &&type : batches.types()) {
+    EXPECT(!type.name.empty());
+    batched.insert(type.factors.begin(), type.factors.end());
+    expected_batches += (type.factors.size() + 7) / 8;
+  }
+  EXPECT_LONGS_EQUAL(graph.size() - 1, batched.size());
+  EXPECT_LONGS_EQUAL(expected_batches, batches.numBatches());
+
+  const auto expected = graph.linearize(values);
+  EXPECT(assert_equal(*expected, *batches.linearize(graph, values, 1)));
+  const auto linear = batches.linearize(graph, values, 4);
+  EXPECT(assert_equal(*expected, *linear));
+  EXPECT(!linear->back());
+
+  CHECK_EXCEPTION(batches.linearize(Graph(), values), std::invalid_argument);
+  CHECK_EXCEPTION(FactorBatches(graph, 0), std::invalid_argument);
+}
+
+// LM with batched linearization converges to the same trajectory.
+TEST(FactorBatches, Optimizer) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters params;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.linearization_threads = size_t(2);
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init),
+                      1e-6));
+  params.riccati_solver = true;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init),
+                      1e-5));
+}
+
+// num_threads 0 linearizes on all threads of the executor, with the same
+// result as an explicit number of threads.
+TEST(FactorBatches, AllThreads) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  SetExecutorThreads(3);
+  OptimizationParameters params;
+  params.num_threads = 3;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.num_threads = 0;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init)));
+  SetExecutorThreads(0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
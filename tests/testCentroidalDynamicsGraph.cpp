@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCentroidalDynamicsGraph.cpp
+ * @brief Test the single-rigid-body dynamics graph of legged robots.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CentroidalDynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/WalkCycle.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+const Point3 contact_in_com(0.14, 0, 0);
+const Vector3 gravity(0, 0, -9.8);
+
+PointOnLinks ContactPoints() {
+  PointOnLinks contact_points;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    contact_points.emplace_back(robot.link(name), contact_in_com);
+  }
+  return contact_points;
+}
+
+// The rest values of step k, with every pose and twist moved away from rest,
+// and the feet out of reach.
+Values MovingValues(const CentroidalDynamicsGraph &graph_builder, int k) {
+  Values values = graph_builder.initialValues(k, ContactPoints());
+  const int b = graph_builder.base()->id();
+  const Pose3 offset(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.2, -0.1, 0.1));
+  values.update(PoseKey(b, k), Pose(values, b, k) * offset);
+  values.update(TwistKey(b, k),
+                (Vector6() << 0.1, -0.3, 0.2, 0.5, 0.1, -0.2).finished());
+  values.update(TwistAccelKey(b, k),
+                (Vector6() << -0.2, 0.1, 0.4, 0.3, -0.5, 1.0).finished());
+  for (auto &&foot : graph_builder.feet()) {
+    const int i = foot->id();
+    values.update(PoseKey(i, k), offset * Pose(values, i, k));
+    values.update(TwistKey(i, k), Vector6::Constant(0.1 * i));
+  }
+  return values;
+}
+}  // namespace example
+
+// The body has the mass of the robot, at its center of mass, and the feet are
+// the lower legs.
+TEST(CentroidalDynamicsGraph, body) {
+  using namespace example;
+  const CentroidalDynamicsGraph graph_builder(robot, OptimizerSetting(),
+                                              gravity);
+  EXPECT(graph_builder.base() == robot.link("body"));
+  EXPECT_LONGS_EQUAL(4, graph_builder.feet().size());
+  for (auto &&foot : graph_builder.feet()) {
+    EXPECT(foot->name().find("lower") == 0);
+  }
+
+  double mass = 0;
+  Vector3 moment = Vector3::Zero();
+  for (auto &&link : robot.links()) {
+    mass += link->mass();
+    moment += link->mass() * link->bMcom().translation();
+  }
+  EXPECT_DOUBLES_EQUAL(mass, graph_builder.mass(), 1e-9);
+  EXPECT(assert_equal(Point3(moment / mass),
+                      graph_builder.restPose().translation(), 1e-9));
+
+  const gtsam::Matrix6 &inertia = graph_builder.inertia();
+  EXPECT(assert_equal(gtsam::Matrix(inertia.transpose()),
+                      gtsam::Matrix(inertia), 1e-9));
+  EXPECT(inertia.topLeftCorner<3, 3>().determinant() > 0);
+  EXPECT(assert_equal(robot.link("body")->bMcom(),
+                      graph_builder.basePose(graph_builder.restPose()),
+                      1e-9));
+}
+
+// At rest the kinematic factors are satisfied, and the contact forces carry
+// the weight.
+TEST(CentroidalDynamicsGraph, rest) {
+  using namespace example;
+  const CentroidalDynamicsGraph graph_builder(robot, OptimizerSetting(),
+                                              gravity);
+  const Values values = graph_builder.initialValues(0, ContactPoints());
+  EXPECT_DOUBLES_EQUAL(0, graph_builder.qFactors(robot, 0).error(values),
+                       1e-9);
+  EXPECT_DOUBLES_EQUAL(
+      0, graph_builder.vFactors(robot, 0, ContactPoints()).error(values),
+      1e-9);
+  EXPECT_LONGS_EQUAL(0, graph_builder.aFactors(robot, 0).size());
+
+  // The body balance is last; its force is in equilibrium.
+  const NonlinearFactorGraph dynamics =
+      graph_builder.dynamicsFactors(robot, 0, ContactPoints(), 1.0);
+  auto balance =
+      boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(dynamics.back());
+  CHECK(balance);
+  const gtsam::Vector error = balance->unwhitenedError(values);
+  EXPECT(assert_equal(Vector3::Zero(), Vector3(error.tail<3>()), 1e-6));
+
+  // Contacts must be on a foot.
+  const PointOnLinks on_body = {
+      PointOnLink(robot.link("body"), contact_in_com)};
+  THROWS_EXCEPTION(graph_builder.qFactors(robot, 0, on_body));
+}
+
+// All factors have correct Jacobians away from rest.
+TEST(CentroidalDynamicsGraph, jacobians) {
+  using namespace example;
+  for (bool block : {false, true}) {
+    OptimizerSetting opt;
+    opt.contact_block_factors = block;
+    const CentroidalDynamicsGraph graph_builder(robot, opt, gravity);
+    Values values = MovingValues(graph_builder, 0);
+    values.insert(MovingValues(graph_builder, 1));
+    values.insert(PhaseKey(0), 0.1);
+
+    NonlinearFactorGraph graph =
+        graph_builder.dynamicsFactorGraph(robot, 0, ContactPoints(), 1.0);
+    graph.add(graph_builder.collocationFactors(robot, 0, 0.1,
+                                               CollocationScheme::Euler));
+    graph.add(graph_builder.multiPhaseCollocationFactors(
+        robot, 0, 0, CollocationScheme::Trapezoidal));
+    EXPECT(graph.error(values) > 0);
+    for (auto &&factor : graph) {
+      EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+    }
+  }
+}
+
+// A resting robot satisfies the collocation factors.
+TEST(CentroidalDynamicsGraph, collocation) {
+  using namespace example;
+  const CentroidalDynamicsGraph graph_builder(robot, OptimizerSetting(),
+                                              gravity);
+  Values values = graph_builder.initialValues(0);
+  values.insert(graph_builder.initialValues(1));
+  const NonlinearFactorGraph graph = graph_builder.collocationFactors(
+      robot, 0, 0.1, CollocationScheme::Trapezoidal);
+  EXPECT_LONGS_EQUAL(2 + graph_builder.feet().size(), graph.size());
+  EXPECT_DOUBLES_EQUAL(0, graph.error(values), 1e-9);
+  THROWS_EXCEPTION(graph_builder.collocationFactors(
+      robot, 0, 0.1, CollocationScheme::HermiteSimpson));
+}
+
+// Trajectory builds a trot on the body and feet only, with far fewer
+// variables than the full dynamics.
+TEST(CentroidalDynamicsGraph, trajectory) {
+  using namespace example;
+  auto phase0 = boost::make_shared<FootContactConstraintSpec>(
+      std::vector<LinkSharedPtr>{robot.link("lower0"), robot.link("lower3")},
+      contact_in_com);
+  auto phase1 = boost::make_shared<FootContactConstraintSpec>(
+      std::vector<LinkSharedPtr>{robot.link("lower1"), robot.link("lower2")},
+      contact_in_com);
+  const WalkCycle walk_cycle({phase0, phase1}, {2, 2});
+  const Trajectory trajectory(walk_cycle, 2);
+
+  const OptimizerSetting opt;
+  const CentroidalDynamicsGraph centroidal(robot, opt, gravity);
+  const NonlinearFactorGraph graph = trajectory.multiPhaseFactorGraph(
+      robot, centroidal, CollocationScheme::Euler, 1.0);
+  for (gtsam::Key key : graph.keys()) {
+    const std::string label = DynamicsSymbol(key).label();
+    EXPECT(label == "p" || label == "V" || label == "A" || label == "C" ||
+           label == "dt");
+  }
+
+  const DynamicsGraph full(opt, gravity);
+  const NonlinearFactorGraph full_graph = trajectory.multiPhaseFactorGraph(
+      robot, full, CollocationScheme::Euler, 1.0);
+  EXPECT(3 * graph.keys().size() < full_graph.keys().size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
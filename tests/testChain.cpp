@@ -583,6 +583,53 @@ TEST(Chain, ChainConstraintFactorJacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, init_values, 1e-7, 1e-3);
 }
 
+// Test FixedChain against Chain on a general three-joint chain
+TEST(Chain, FixedChain) {
+  Pose3 sMb = Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(0, 3, 8));
+  Vector6 screwAxis0, screwAxis1, screwAxis2;
+  screwAxis0 << 0.0, 0.0, 1.0, 0.0, 5.0, 0.0;
+  screwAxis1 << 0.0, 1.0, 0.0, 3.0, 0.0, 0.0;
+  screwAxis2 << 1.0, 0.0, 0.0, 0.0, 0.0, 29.0;
+
+  // Composition gives the same chain.
+  std::vector<Chain> chains{Chain(sMb, screwAxis0), Chain(sMb, screwAxis1),
+                            Chain(sMb, screwAxis2)};
+  Chain composed = Chain::compose(chains);
+  Chain3 fixed = FixedChain<0>() * FixedChain<1>(sMb, screwAxis0) *
+                 FixedChain<1>(sMb, screwAxis1) *
+                 FixedChain<1>(sMb, screwAxis2);
+  EXPECT(assert_equal(composed.sMb(), fixed.sMb(), 1e-9));
+  EXPECT(assert_equal(composed.axes(), Matrix(fixed.axes()), 1e-9));
+  EXPECT(assert_equal(composed.axes(), Matrix(Chain3(composed).axes())));
+
+  // Forward kinematics and its Jacobian agree.
+  Vector3 angles(0.3, -0.5, 1.2);
+  Pose3 fTe(Rot3::Ry(0.4), Point3(0.1, 0, -0.2));
+  Matrix J;
+  Eigen::Matrix<double, 6, 3> J3;
+  Pose3 expected = composed.poe(angles, fTe, J);
+  EXPECT(assert_equal(expected, fixed.poe(angles, fTe, J3), 1e-9));
+  EXPECT(assert_equal(J, Matrix(J3), 1e-9));
+  EXPECT(assert_equal(expected, fixed.poe(angles, fTe), 1e-9));
+
+  // So do the dynamical equality and its Jacobians.
+  Vector6 wrench;
+  wrench << 1, -2, 3, 0.5, 0.1, -1;
+  Vector3 torques(1, 2, 3);
+  Matrix H_wrench, H_angles;
+  gtsam::Matrix36 H3_wrench;
+  gtsam::Matrix3 H3_angles;
+  EXPECT(assert_equal(
+      composed.DynamicalEquality3(wrench, angles, torques, H_wrench, H_angles),
+      fixed.DynamicalEquality3(wrench, angles, torques, H3_wrench, H3_angles),
+      1e-9));
+  EXPECT(assert_equal(H_wrench, Matrix(H3_wrench), 1e-9));
+  EXPECT(assert_equal(H_angles, Matrix(H3_angles), 1e-9));
+
+  // A chain with another number of joints cannot be fixed to three.
+  THROWS_EXCEPTION(Chain3(chains[0]));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
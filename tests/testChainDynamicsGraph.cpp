@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testChainDynamicsGraph.cpp
+ * @brief Test the reduced dynamics graph of legged robots.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ChainDynamicsGraph.h>
+#include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/ChainInitializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+const Point3 contact_in_com(0.14, 0, 0);
+
+PointOnLinks ContactPoints() {
+  PointOnLinks contact_points;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    contact_points.emplace_back(robot.link(name), contact_in_com);
+  }
+  return contact_points;
+}
+
+// A moving robot, with foot poses and twists from forward kinematics, and
+// arbitrary accelerations, torques and wrenches.
+Values MovingValues() {
+  Values values;
+  InsertPose(&values, robot.link("body")->id(),
+             Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.1, 0.2, 0.5)));
+  InsertTwist(&values, robot.link("body")->id(),
+              (Vector6() << 0.1, -0.3, 0.2, 0.5, 0.1, -0.2).finished());
+  InsertTwistAccel(&values, robot.link("body")->id(),
+                   (Vector6() << -0.2, 0.1, 0.4, 0.3, -0.5, 1.0).finished());
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, 0.1 * j - 0.5);
+    InsertJointVel(&values, j, 0.3 - 0.05 * j);
+    InsertJointAccel(&values, j, 0.2 * j);
+    InsertTorque(&values, j, 1.0 - 0.1 * j);
+    InsertWrench(&values, joint->parent()->id(), j,
+                 Vector6::Constant(0.1 * j));
+  }
+  for (auto &&cp : ContactPoints()) {
+    values.insert(ContactWrenchKey(cp.link->id(), 0),
+                  (Vector6() << 0.1, 0.2, -0.1, 1, -2, 30).finished());
+  }
+  Values fk = robot.forwardKinematics(values, 0, std::string("body"));
+  for (auto &&cp : ContactPoints()) {
+    InsertPose(&values, cp.link->id(), Pose(fk, cp.link->id()));
+    InsertTwist(&values, cp.link->id(), Twist(fk, cp.link->id()));
+  }
+  return values;
+}
+}  // namespace example
+
+// Every leg is found, from hip to foot.
+TEST(ChainDynamicsGraph, legs) {
+  const ChainDynamicsGraph graph_builder(example::robot, OptimizerSetting());
+  EXPECT(graph_builder.base() == example::robot.link("body"));
+  EXPECT_LONGS_EQUAL(4, graph_builder.legs().size());
+  for (auto &&leg : graph_builder.legs()) {
+    EXPECT_LONGS_EQUAL(3, leg.joints.size());
+    EXPECT(leg.joints[0]->parent() == graph_builder.base());
+    EXPECT(leg.joints[2]->child() == leg.foot);
+    EXPECT_LONGS_EQUAL(1, leg.foot->numJoints());
+  }
+
+  // A robot without legs of 3 joints.
+  const Robot simple =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  THROWS_EXCEPTION(ChainDynamicsGraph(simple, OptimizerSetting()));
+}
+
+// The chains agree with forward kinematics of the full robot.
+TEST(ChainDynamicsGraph, kinematics) {
+  const ChainDynamicsGraph graph_builder(example::robot, OptimizerSetting());
+  const Values values = example::MovingValues();
+  const PointOnLinks contact_points = example::ContactPoints();
+
+  const auto q_graph = graph_builder.qFactors(example::robot, 0);
+  EXPECT_LONGS_EQUAL(4, q_graph.size());
+  EXPECT_DOUBLES_EQUAL(0, q_graph.error(values), 1e-9);
+
+  const auto v_graph = graph_builder.vFactors(example::robot, 0,
+                                              contact_points);
+  EXPECT_LONGS_EQUAL(4, v_graph.size());
+  for (size_t c = 0; c < 4; c++) {
+    const ContactKinematicsTwistFactor factor(
+        TwistKey(contact_points[c].link->id()),
+        OptimizerSetting().cv_cost_model,
+        Pose3(Rot3(), -contact_points[c].point));
+    auto chain_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(v_graph[c]);
+    EXPECT(assert_equal(factor.unwhitenedError(values),
+                        chain_factor->unwhitenedError(values), 1e-9));
+  }
+
+  for (auto &&graph :
+       {q_graph, v_graph,
+        graph_builder.aFactors(example::robot, 0, contact_points)}) {
+    for (auto &&factor : graph) {
+      auto f = boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+      EXPECT_CORRECT_FACTOR_JACOBIANS(*f, values, 1e-7, 1e-5);
+    }
+  }
+}
+
+// Legs are massless: torques and hip wrenches balance the contact wrench.
+TEST(ChainDynamicsGraph, dynamics) {
+  const ChainDynamicsGraph graph_builder(example::robot, OptimizerSetting());
+  const Values values = example::MovingValues();
+  PointOnLinks contact_points = example::ContactPoints();
+  contact_points.pop_back();
+
+  const auto graph =
+      graph_builder.dynamicsFactors(example::robot, 0, contact_points);
+  for (auto &&factor : graph) {
+    auto f = boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*f, values, 1e-7, 1e-5);
+  }
+
+  // The torques of a leg are the torques of Chain::DynamicalEquality3 with
+  // the wrench of the ground on the foot, as the leg exerts the opposite one.
+  const auto &leg = graph_builder.legs()[0];
+  Vector3 q, torques;
+  for (size_t i = 0; i < 3; i++) {
+    q(i) = JointAngle(values, leg.joints[i]->id());
+    torques(i) = Torque(values, leg.joints[i]->id());
+  }
+  const Vector6 wrench =
+      values.at<Vector6>(ContactWrenchKey(leg.foot->id(), 0));
+  const Vector3 expected =
+      -leg.chain->DynamicalEquality3(-wrench, q, torques);
+  bool found = false;
+  for (auto &&factor : graph) {
+    auto f = boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    const auto key = TorqueKey(leg.joints[0]->id());
+    if (f->dim() != 3 || f->find(key) == f->end()) continue;
+    EXPECT(assert_equal(expected, f->unwhitenedError(values), 1e-9));
+    found = true;
+  }
+  EXPECT(found);
+
+  // At rest without gravity, zero wrenches and torques are a solution.
+  const ChainDynamicsGraph weightless(example::robot, OptimizerSetting(),
+                                      Vector3::Zero());
+  Values rest;
+  InsertPose(&rest, graph_builder.base()->id(), Pose3());
+  InsertTwist(&rest, graph_builder.base()->id(), Vector6::Zero());
+  InsertTwistAccel(&rest, graph_builder.base()->id(), Vector6::Zero());
+  for (auto &&joint : example::robot.joints()) {
+    InsertJointAngle(&rest, joint->id(), 0.3);
+    InsertTorque(&rest, joint->id(), 0.0);
+    InsertWrench(&rest, graph_builder.base()->id(), joint->id(),
+                 Vector6::Zero());
+  }
+  EXPECT_DOUBLES_EQUAL(
+      0, weightless.dynamicsFactors(example::robot, 0).error(rest), 1e-9);
+}
+
+// The reduced graph has far fewer variables, exactly those of
+// ChainInitializer.
+TEST(ChainDynamicsGraph, trajectory) {
+  const ChainDynamicsGraph graph_builder(example::robot, OptimizerSetting());
+  const DynamicsGraph full_builder;
+  const PointOnLinks contact_points = example::ContactPoints();
+
+  EXPECT_LONGS_EQUAL(63, graph_builder
+                             .dynamicsFactorGraph(example::robot, 0,
+                                                  contact_points)
+                             .keys()
+                             .size());
+  EXPECT_LONGS_EQUAL(
+      115,
+      full_builder.dynamicsFactorGraph(example::robot, 0, contact_points)
+          .keys()
+          .size());
+
+  const size_t num_steps = 3;
+  const auto graph = graph_builder.trajectoryFG(example::robot, num_steps, 0.1,
+                                                CollocationScheme::Euler,
+                                                contact_points);
+  Values init;
+  for (size_t k = 0; k <= num_steps; k++) {
+    init.insert(ChainInitializer().ZeroValues(example::robot, k, 0.0,
+                                              contact_points));
+  }
+  const gtsam::KeyVector keys = init.keys();
+  EXPECT(gtsam::KeySet(keys.begin(), keys.end()) == graph.keys());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testChainIK.cpp
+ * @brief Test damped least-squares IK on fixed-size chains.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/ChainIK.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+typedef ChainIK<7> PandaIK;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+        .fixLink("link0");
+
+std::vector<JointSharedPtr> Joints() {
+  std::vector<JointSharedPtr> joints;
+  for (size_t i = 0; i < 7; i++) {
+    joints.push_back(robot.joint("joint" + std::to_string(i + 1)));
+  }
+  return joints;
+}
+
+const PandaIK::Angles q =
+    (PandaIK::Angles() << 0.2, -0.3, 0.1, -1.8, 0.4, 1.5, -0.4).finished();
+}  // namespace example
+
+// The chain from the joints matches the forward kinematics of the robot.
+TEST(ChainIK, FromJoints) {
+  const PandaIK ik = PandaIK::FromJoints(example::Joints());
+  gtsam::Values joint_angles;
+  for (size_t i = 0; i < 7; i++) {
+    InsertJointAngle(&joint_angles, example::Joints()[i]->id(),
+                     example::q(i));
+  }
+  const auto fk = example::robot.forwardKinematics(joint_angles);
+  const auto base = example::robot.link("link0");
+  const auto ee = example::robot.link("link7");
+  EXPECT(assert_equal(base->getFixedPose().between(Pose(fk, ee->id())),
+                      ik.chain().poe(example::q), 1e-9));
+  CHECK_EXCEPTION(ChainIK<6>::FromJoints(example::Joints()),
+                  std::invalid_argument);
+}
+
+// Converges to the goal from a perturbed initial guess.
+TEST(ChainIK, Solve) {
+  const PandaIK ik = PandaIK::FromJoints(example::Joints());
+  const Pose3 fTe(gtsam::Rot3(), gtsam::Point3(0, 0, 0.1));
+  const Pose3 goal = ik.chain().poe(example::q, fTe);
+  const PandaIK::Angles q_init =
+      example::q + PandaIK::Angles::Constant(0.15);
+  const PandaIK::Result result = ik.solve(goal, q_init, fTe);
+  EXPECT(result.converged);
+  EXPECT(result.iterations > 0);
+  EXPECT(assert_equal(goal, ik.chain().poe(result.q, fTe), 1e-6));
+
+  // Already at the goal.
+  EXPECT_LONGS_EQUAL(0, ik.solve(goal, example::q, fTe).iterations);
+}
+
+// Joint angles stay within the limits, even if the goal is outside.
+TEST(ChainIK, Limits) {
+  const PandaIK unlimited = PandaIK::FromJoints(example::Joints());
+  PandaIK::Angles lower = PandaIK::Angles::Constant(-10);
+  PandaIK::Angles upper = PandaIK::Angles::Constant(10);
+  upper(0) = 0.1;
+  const PandaIK ik(unlimited.chain(), lower, upper);
+  const PandaIK::Result result =
+      ik.solve(unlimited.chain().poe(example::q), PandaIK::Angles::Zero());
+  EXPECT(result.q(0) <= 0.1);
+  EXPECT(assert_equal(PandaIK::Angles(ik.clamp(result.q)), result.q));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
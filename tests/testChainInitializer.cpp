@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testChainInitializer.cpp
+ * @brief Test closed-form leg initial values of ChainInitializer.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/ChainInitializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+const Point3 contact_in_com(0.14, 0, 0);
+const Pose3 wTb(Rot3::RzRyRx(0.05, -0.1, 0.2), Point3(0.1, 0.0, 0.45));
+
+PointOnLinks Feet() {
+  PointOnLinks feet;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    feet.emplace_back(robot.link(name), contact_in_com);
+  }
+  return feet;
+}
+
+// Angles of a crouched stance, by joint name.
+std::map<std::string, double> Stance() {
+  std::map<std::string, double> angles;
+  for (auto &&joint : robot.joints()) {
+    const std::string &child = joint->child()->name();
+    if (child.find("hip") == 0) angles[joint->name()] = 0.1;
+    if (child.find("upper") == 0) angles[joint->name()] = 0.7;
+    if (child.find("lower") == 0) angles[joint->name()] = -1.4;
+  }
+  return angles;
+}
+}  // namespace example
+
+// Feet put at the points of a stance give back its angles.
+TEST(ChainInitializer, LegJointAngles) {
+  using namespace example;
+  Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), Stance().at(joint->name()));
+  }
+  InsertPose(&known, robot.link("body")->id(), wTb);
+  const Values fk = robot.forwardKinematics(known, 0, std::string("body"));
+
+  ContactGoals goals;
+  for (auto &&foot : Feet()) goals.emplace_back(foot, foot.predict(fk, 0));
+
+  // Nominal angles near, not at, the stance pick its solution.
+  std::map<std::string, double> nominal = Stance();
+  for (auto &&angle : nominal) angle.second += 0.2;
+  const Values angles =
+      ChainInitializer().LegJointAngles(robot, wTb, goals, 0, nominal);
+  EXPECT_LONGS_EQUAL(12, angles.size());
+  for (auto &&joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(Stance().at(joint->name()),
+                         JointAngle(angles, joint->id()), 1e-6);
+  }
+
+  // The base is not at the end of a leg.
+  ContactGoals base_goal = {{{robot.link("body"), Point3()}, Point3()}};
+  CHECK_EXCEPTION(ChainInitializer().LegJointAngles(robot, wTb, base_goal),
+                  std::invalid_argument);
+}
+
+// Every step of a trajectory has its feet at the goals.
+TEST(ChainInitializer, LegInverseKinematicsTrajectory) {
+  using namespace example;
+  Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), Stance().at(joint->name()));
+  }
+  InsertPose(&known, robot.link("body")->id(), wTb);
+  const Values fk = robot.forwardKinematics(known, 0, std::string("body"));
+
+  // The body moves forward over feet in stance, and one foot swings.
+  const size_t num_steps = 5;
+  std::vector<Pose3> base_poses;
+  std::vector<ContactGoals> foot_goals(num_steps);
+  const PointOnLinks feet = Feet();
+  const auto swing = SimpleSwingTrajectory(feet[0].predict(fk, 0),
+                                           Point3(0.05, 0, 0), num_steps);
+  for (size_t k = 0; k < num_steps; k++) {
+    base_poses.push_back(Pose3(wTb.rotation(),
+                               wTb.translation() + Point3(0.01 * k, 0, 0)));
+    foot_goals[k].emplace_back(feet[0], swing[k]);
+    for (size_t i = 1; i < feet.size(); i++) {
+      foot_goals[k].emplace_back(feet[i], feet[i].predict(fk, 0));
+    }
+  }
+
+  const ChainInitializer initializer(2);
+  const std::vector<PointOnLinks> contact_points(num_steps, feet);
+  const Values values = initializer.LegInverseKinematicsTrajectory(
+      robot, base_poses, foot_goals, 0.1, 0.0, contact_points, Stance());
+  Values zero;
+  for (size_t k = 0; k < num_steps; k++) {
+    zero.insert(initializer.ZeroValues(robot, k, 0.0, feet));
+  }
+  EXPECT_LONGS_EQUAL(zero.size(), values.size());
+  for (size_t k = 0; k < num_steps; k++) {
+    EXPECT(gtsam::assert_equal(base_poses[k],
+                               Pose(values, robot.link("body")->id(), k)));
+    for (auto &&goal : foot_goals[k]) EXPECT(goal.satisfied(values, k, 1e-6));
+  }
+
+  // The swing leg moves, so its knee has a velocity.
+  const int knee = robot.joint("1")->id();
+  EXPECT_DOUBLES_EQUAL(
+      (JointAngle(values, knee, 3) - JointAngle(values, knee, 1)) / 0.2,
+      JointVel(values, knee, 2), 1e-9);
+  EXPECT(std::abs(JointVel(values, knee, 2)) > 1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCheckpoint.cpp
+ * @brief Test checkpointing and resuming solves.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Checkpoint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cstdio>
+#include <memory>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+const std::string path = "testCheckpoint.ckpt";
+
+// A chain of poses with a loop closure, which LM takes several steps on.
+NonlinearFactorGraph poses(Values *init) {
+  NonlinearFactorGraph graph;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+  const Pose3 step(Rot3::Rz(M_PI / 2), gtsam::Point3(1, 0, 0));
+  graph.addPrior<Pose3>(PoseKey(0, 0), Pose3(), model);
+  for (int t = 1; t < 4; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(0, t - 1), PoseKey(0, t), step, model);
+  }
+  graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(PoseKey(0, 3),
+                                                    PoseKey(0, 0), step, model);
+  for (int t = 0; t < 4; t++) {
+    init->insert(PoseKey(0, t),
+                 Pose3(Rot3::Rz(1.2 * t), gtsam::Point3(0.5 * t, t, 0.3)));
+  }
+  return graph;
+}
+}  // namespace example
+
+// All supported types and the solver state survive a round trip.
+TEST(OptimizerCheckpoint, RoundTrip) {
+  OptimizerCheckpoint checkpoint;
+  checkpoint.solver = CheckpointSolver::AugmentedLagrangian;
+  checkpoint.values.insert(JointAngleKey(0, 1), 0.5);
+  checkpoint.values.insert(TwistKey(1, 2),
+                           (gtsam::Vector6() << 1, 2, 3, 4, 5, 6).finished());
+  checkpoint.values.insert(gtsam::Symbol('c', 0), gtsam::Vector3(1, 2, 3));
+  checkpoint.values.insert(PoseKey(2, 3),
+                           Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3),
+                                 gtsam::Point3(4, 5, 6)));
+  checkpoint.values.insert(gtsam::Symbol('r', 0), Rot3::Ry(0.4));
+  checkpoint.values.insert(gtsam::Symbol('v', 0), gtsam::Vector2(7, 8));
+  checkpoint.iterations = 7;
+  checkpoint.lambda = 1e-3;
+  checkpoint.mu = 16;
+  checkpoint.multipliers = {gtsam::Vector2(1, -1), gtsam::Vector1(3)};
+  checkpoint.inequality_multipliers = {gtsam::Vector3(0, 1, 2)};
+  checkpoint.save(example::path);
+
+  const OptimizerCheckpoint loaded = OptimizerCheckpoint::Load(example::path);
+  EXPECT(loaded.solver == CheckpointSolver::AugmentedLagrangian);
+  EXPECT(assert_equal(checkpoint.values, loaded.values));
+  EXPECT_LONGS_EQUAL(7, loaded.iterations);
+  EXPECT_DOUBLES_EQUAL(1e-3, loaded.lambda, 0);
+  EXPECT_DOUBLES_EQUAL(16, loaded.mu, 0);
+  EXPECT_LONGS_EQUAL(2, loaded.multipliers.size());
+  EXPECT(assert_equal(checkpoint.multipliers[0], loaded.multipliers[0]));
+  EXPECT(assert_equal(checkpoint.inequality_multipliers[0],
+                      loaded.inequality_multipliers[0]));
+
+  // A checkpoint of another solver is not resumed.
+  Checkpointer checkpointer(example::path);
+  CHECK_EXCEPTION(checkpointer.resume(CheckpointSolver::Penalty),
+                  std::invalid_argument);
+  checkpointer.remove();
+  EXPECT(!checkpointer.resume(CheckpointSolver::Penalty));
+}
+
+// An LM solve stopped early and resumed gives the uninterrupted result.
+TEST(Checkpointer, LevenbergMarquardt) {
+  Values init;
+  const NonlinearFactorGraph graph = example::poses(&init);
+  OptimizationParameters params;
+  params.lm_parameters.setlambdaInitial(1e-2);
+  params.lm_parameters.setAbsoluteErrorTol(0);
+  params.lm_parameters.setRelativeErrorTol(1e-10);
+  const Values expected = Optimizer(params).optimize(graph, init);
+
+  auto checkpointer = std::make_shared<Checkpointer>(example::path);
+  params.checkpoint = checkpointer;
+  params.lm_parameters.setMaxIterations(2);
+  Optimizer(params).optimize(graph, init);  // preempted
+  EXPECT_LONGS_EQUAL(2, checkpointer->numSaves());
+  EXPECT_LONGS_EQUAL(
+      2, checkpointer->resume(CheckpointSolver::LevenbergMarquardt)
+             ->iterations);
+
+  params.lm_parameters.setMaxIterations(100);
+  const Values resumed = Optimizer(params).optimize(graph, init);
+  EXPECT(assert_equal(expected, resumed, 1e-6));
+  checkpointer->remove();
+}
+
+// An Augmented Lagrangian solve resumes with its multipliers and mu.
+TEST(Checkpointer, AugmentedLagrangian) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+  Values init;
+  init.insert(x1_key, -0.2);
+  init.insert(x2_key, -0.2);
+
+  AugmentedLagrangianParameters params;
+  AugmentedLagrangianState expected_state;
+  const Values expected = AugmentedLagrangianOptimizer(params).optimize(
+      graph, constraints, init, &expected_state);
+
+  auto checkpointer = std::make_shared<Checkpointer>(example::path);
+  params.checkpoint = checkpointer;
+  params.num_iterations = 3;
+  AugmentedLagrangianOptimizer(params).optimize(graph, constraints, init);
+  EXPECT_LONGS_EQUAL(3, checkpointer->numSaves());
+
+  params.num_iterations = 12;
+  AugmentedLagrangianState state;
+  const Values resumed = AugmentedLagrangianOptimizer(params).optimize(
+      graph, constraints, init, &state);
+  EXPECT(assert_equal(expected, resumed, 1e-9));
+  EXPECT_DOUBLES_EQUAL(expected_state.mu, state.mu, 1e-9);
+  EXPECT_LONGS_EQUAL(expected_state.num_iterations, state.num_iterations);
+  checkpointer->remove();
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompiledForwardDynamics.cpp
+ * @brief Test compiled forward dynamics against DynamicsGraph::linearSolveFD.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CompiledForwardDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Check that accelerations and wrenches agree with linearSolveFD.
+void checkAgainstGraph(const Robot& robot, const Values& known_values, int t,
+                       const gtsam::Vector3& gravity,
+                       const boost::optional<gtsam::Vector3>& planar_axis) {
+  DynamicsGraph graph_builder(gravity, planar_axis);
+  Values expected = graph_builder.linearSolveFD(robot, t, known_values);
+
+  CompiledForwardDynamics compiled(robot, gravity, planar_axis);
+  Values actual = compiled.solve(t, known_values);
+
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                         1e-6);
+    for (auto&& link : joint->links()) {
+      int i = link->id();
+      EXPECT(assert_equal(Wrench(expected, i, j, t), Wrench(actual, i, j, t),
+                          1e-6));
+    }
+  }
+  for (auto&& link : robot.links()) {
+    int i = link->id();
+    EXPECT(assert_equal(TwistAccel(expected, i, t), TwistAccel(actual, i, t),
+                        1e-6));
+  }
+}
+
+// Two-link robot with unit torque, same setup as testDynamicsGraph.
+TEST(CompiledForwardDynamics, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  int j = robot.joint("j1")->id();
+  int t = 777;
+
+  Values values;
+  InsertPose(&values, l1->id(), t, l1->bMcom());
+  InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+  Values known_values = robot.forwardKinematics(values, t, std::string("l1"));
+  InsertTorque(&known_values, j, t, 1.0);
+
+  CompiledForwardDynamics compiled(robot, simple_urdf_eq_mass::gravity,
+                                   simple_urdf_eq_mass::planar_axis);
+  Values result = compiled.solve(t, known_values);
+  EXPECT(assert_equal(4.0, JointAccel(result, j, t), 1e-3));
+
+  checkAgainstGraph(robot, known_values, t, simple_urdf_eq_mass::gravity,
+                    simple_urdf_eq_mass::planar_axis);
+}
+
+// Serial chain in motion under gravity.
+TEST(CompiledForwardDynamics, simple_rr_moving) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Vector3 gravity(0, 0, -9.8);
+
+  Values values;
+  double angle = 0.3, vel = -0.7, torque = 0.2;
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    InsertJointAngle(&values, j, angle);
+    InsertJointVel(&values, j, vel);
+    angle += 0.4, vel += 1.1;
+  }
+  Values known_values = robot.forwardKinematics(values);
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&known_values, joint->id(), torque);
+    torque -= 0.5;
+  }
+
+  checkAgainstGraph(robot, known_values, 0, gravity, boost::none);
+}
+
+// Closed chain: the four-bar linkage with one link fixed.
+TEST(CompiledForwardDynamics, four_bar_linkage_pure) {
+  auto robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), 0.0);
+    InsertJointVel(&values, joint->id(), 0.0);
+  }
+  Values known_values = robot.forwardKinematics(values);
+  Vector torques = (Vector(4) << 1, 0, 1, 0).finished();
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    InsertTorque(&known_values, j, torques[j]);
+  }
+
+  CompiledForwardDynamics compiled(robot, four_bar_linkage_pure::gravity,
+                                   four_bar_linkage_pure::planar_axis);
+  compiled.solve(0, known_values);
+  Vector expected_qAccel = (Vector(4) << 0.25, -0.25, 0.25, -0.25).finished();
+  EXPECT(assert_equal(expected_qAccel, compiled.jointAccels(), 1e-6));
+
+  checkAgainstGraph(robot, known_values, 0, four_bar_linkage_pure::gravity,
+                    four_bar_linkage_pure::planar_axis);
+}
+
+// Repeated solves reuse the compiled structure and stay consistent.
+TEST(CompiledForwardDynamics, repeated_solves) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Vector3 gravity(0, 0, -9.8);
+  CompiledForwardDynamics compiled(robot, gravity);
+
+  for (double angle : {0.0, 0.5, -1.2}) {
+    Values values;
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&values, joint->id(), angle);
+      InsertJointVel(&values, joint->id(), 2 * angle);
+    }
+    Values known_values = robot.forwardKinematics(values);
+    for (auto&& joint : robot.joints()) {
+      InsertTorque(&known_values, joint->id(), angle);
+    }
+
+    Values actual = compiled.solve(0, known_values);
+    DynamicsGraph graph_builder(gravity);
+    Values expected = graph_builder.linearSolveFD(robot, 0, known_values);
+    EXPECT(assert_equal(DynamicsGraph::jointAccels(robot, expected, 0),
+                        DynamicsGraph::jointAccels(robot, actual, 0), 1e-6));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
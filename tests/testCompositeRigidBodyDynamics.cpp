@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompositeRigidBodyDynamics.cpp
+ * @brief Test the joint-space equations of motion against inverse dynamics.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+        .fixLink("link0");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+
+// A moving configuration, with poses and twists from forward kinematics.
+Values MovingValues() {
+  Values values;
+  double angle = 0.3, vel = -0.7;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), angle);
+    InsertJointVel(&values, joint->id(), vel);
+    angle = -0.8 * angle + 0.1, vel = 0.5 - 0.6 * vel;
+  }
+  return robot.forwardKinematics(values);
+}
+}  // namespace example
+
+// tau = M * qddot + C * qdot + g agrees with inverse dynamics.
+TEST(CompositeRigidBodyDynamics, panda) {
+  using namespace example;
+  const Values values = MovingValues();
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  for (auto&& link : robot.links()) {
+    poses.push_back(Pose(values, link->id()));
+    twists.push_back(Twist(values, link->id()));
+  }
+  const size_t n = robot.numJoints();
+  Vector joint_vels(n), joint_accels(n);
+  for (size_t j = 0; j < n; j++) {
+    joint_vels(j) = JointVel(values, robot.joints()[j]->id());
+    joint_accels(j) = 1.5 - 0.4 * j;
+  }
+
+  CompositeRigidBodyDynamics crba(robot, gravity);
+  crba.solve(poses, twists, joint_vels);
+  const Matrix& M = crba.massMatrix();
+  EXPECT(assert_equal(Matrix(M.transpose()), M, 1e-12));
+
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  rnea.solve(poses, twists, joint_vels, joint_accels);
+  EXPECT(assert_equal(rnea.torques(),
+                      Vector(M * joint_accels + crba.biasForces()), 1e-9));
+
+  // The columns of M are the torques of unit accelerations at rest.
+  NewtonEulerInverseDynamics weightless(robot);
+  const std::vector<Vector6> zero_twists(poses.size(), Vector6::Zero());
+  for (size_t j = 0; j < n; j++) {
+    weightless.solve(poses, zero_twists, Vector::Zero(n),
+                     Vector::Unit(n, j));
+    EXPECT(assert_equal(weightless.torques(), Vector(M.col(j)), 1e-9));
+  }
+
+  // Gravity forces are the torques at rest, Coriolis forces the rest.
+  rnea.solve(poses, zero_twists, Vector::Zero(n), Vector::Zero(n));
+  EXPECT(assert_equal(rnea.torques(), crba.gravityForces(), 1e-9));
+  weightless.solve(poses, twists, joint_vels, Vector::Zero(n));
+  EXPECT(assert_equal(weightless.torques(), crba.coriolisForces(), 1e-9));
+
+  // Forward dynamics is the inverse of M applied to the remaining torques.
+  const Vector torques = Vector::LinSpaced(n, -2, 3);
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+  aba.solve(poses, twists, joint_vels, torques);
+  EXPECT(assert_equal(aba.jointAccels(),
+                      Vector(M.ldlt().solve(torques - crba.biasForces())),
+                      1e-9));
+
+  // The Values version gives the same.
+  CompositeRigidBodyDynamics crba2(robot, gravity);
+  crba2.solve(0, values);
+  EXPECT(assert_equal(M, crba2.massMatrix(), 1e-12));
+  EXPECT(assert_equal(crba.biasForces(), crba2.biasForces(), 1e-12));
+}
+
+// Floating-base robots and closed chains are rejected.
+TEST(CompositeRigidBodyDynamics, unsupported) {
+  const Robot floating =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  CHECK_EXCEPTION(CompositeRigidBodyDynamics crba(floating),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(
+      CompositeRigidBodyDynamics crba(four_bar_linkage_pure::getRobot()),
+      std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompressedTrajectory.cpp
+ * @brief Test trajectories stored as joint states.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CompressedTrajectory.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const size_t num_steps = 5;
+
+// A full trajectory: forward kinematics from the root, then inverse
+// dynamics, at every step.
+Values Trajectory(const Robot &robot, const std::string &root) {
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  Values trajectory;
+  for (size_t t = 0; t < num_steps; t++) {
+    Values known;
+    double phase = 0.3 * t;
+    for (auto &&joint : robot.joints()) {
+      InsertJointAngle(&known, joint->id(), t, std::sin(phase));
+      InsertJointVel(&known, joint->id(), t, std::cos(phase));
+      phase += 0.7;
+    }
+    const auto link = robot.link(root);
+    if (!link->isFixed()) {
+      InsertPose(&known, link->id(), t,
+                 gtsam::Pose3(gtsam::Rot3::Rz(0.1 * t),
+                              gtsam::Point3(0.2 * t, 0, 0.5)));
+      InsertTwist(&known, link->id(), t,
+                  (gtsam::Vector6() << 0, 0, 0.1, 0.2, 0, 0).finished());
+    }
+    Values values = robot.forwardKinematics(known, t, root);
+    for (auto &&joint : robot.joints()) {
+      InsertJointAccel(&values, joint->id(), t, 0.5 - 0.1 * t);
+    }
+    trajectory.insert(rnea.solve(t, values));
+  }
+  return trajectory;
+}
+
+// Check every step reconstructs the full trajectory.
+void CheckSteps(const Robot &robot, const std::string &root) {
+  const Values expected = Trajectory(robot, root);
+  const CompressedTrajectory trajectory =
+      CompressedTrajectory::FromValues(robot, expected, gravity);
+  EXPECT_LONGS_EQUAL(num_steps, trajectory.numSteps());
+  EXPECT(trajectory.baseLink()->name() == root);
+  EXPECT(trajectory.numStoredDoubles() * 5 < expected.dim());
+
+  std::vector<size_t> steps;
+  for (size_t t = 0; t < num_steps; t++) steps.push_back(t);
+  EXPECT(assert_equal(expected, trajectory.values(steps), 1e-9));
+}
+}  // namespace example
+
+TEST(CompressedTrajectory, FixedBase) {
+  example::CheckSteps(simple_rr::getRobot().fixLink("link_0"), "link_0");
+}
+
+// The root pose and twist of a floating base are stored.
+TEST(CompressedTrajectory, FloatingBase) {
+  const auto robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  example::CheckSteps(robot, "trunk");
+}
+
+// Reconstructed steps are cached, least recently used out first, and
+// changed steps are reconstructed again.
+TEST(CompressedTrajectory, Cache) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const Values full = example::Trajectory(robot, "link_0");
+  CompressedTrajectory trajectory =
+      CompressedTrajectory::FromValues(robot, full, example::gravity,
+                                       boost::none, 2);
+  const Values &step0 = trajectory.step(0);
+  trajectory.step(1);
+  EXPECT(&step0 == &trajectory.step(0));
+  trajectory.step(2);  // evicts step 1
+  EXPECT_LONGS_EQUAL(2, trajectory.numCached());
+  EXPECT(&step0 == &trajectory.step(0));
+
+  const size_t num_joints = robot.numJoints();
+  trajectory.setJointStates(0, gtsam::Vector::Zero(num_joints),
+                            gtsam::Vector::Zero(num_joints),
+                            gtsam::Vector::Zero(num_joints),
+                            gtsam::Vector::Ones(num_joints));
+  EXPECT_LONGS_EQUAL(1, trajectory.numCached());
+  for (auto &&joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(0, JointAngle(trajectory.step(0), joint->id(), 0),
+                         0);
+    EXPECT_DOUBLES_EQUAL(1, Torque(trajectory.step(0), joint->id(), 0), 0);
+  }
+
+  CHECK_EXCEPTION(trajectory.step(example::num_steps), std::out_of_range);
+  CHECK_EXCEPTION(trajectory.setBaseState(0, gtsam::Pose3(),
+                                          gtsam::Vector6::Zero()),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,140 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactActivation.cpp
+ * @brief Test switching contact factors on and off in a fixed graph.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/GatedFactor.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/ContactActivation.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.81);
+Robot Biped() {
+  return CreateRobotFromFile(kUrdfPath + std::string("biped.urdf"));
+}
+PointOnLinks Feet(const Robot &biped) {
+  return {{biped.link("lower0"), Point3(0.14, 0, 0)},
+          {biped.link("lower2"), Point3(0.14, 0, 0)}};
+}
+}  // namespace example
+
+// A disabled factor has no error, and linearizes to zeros on the same keys.
+TEST(GatedFactor, disabled) {
+  const gtsam::Key key = PoseKey(0, 0);
+  auto prior = boost::make_shared<gtsam::PriorFactor<gtsam::Pose3>>(
+      key, gtsam::Pose3(), gtsam::noiseModel::Unit::Create(6));
+  GatedFactor gated(prior);
+  Values values;
+  values.insert(key, gtsam::Pose3(gtsam::Rot3(), Point3(1, 2, 3)));
+  EXPECT_DOUBLES_EQUAL(prior->error(values), gated.error(values), 1e-9);
+
+  gated.setEnabled(false);
+  EXPECT(!gated.enabled());
+  EXPECT_DOUBLES_EQUAL(0.0, gated.error(values), 1e-9);
+  const auto linear = gated.linearize(values);
+  EXPECT(linear->keys() == prior->keys());
+  EXPECT_LONGS_EQUAL(6, linear->jacobian().first.rows());
+  EXPECT(assert_equal(gtsam::Matrix::Zero(6, 6), linear->jacobian().first));
+}
+
+// Taking a foot out of contact gives the error of the graph built without it,
+// for values with a zero wrench on that foot, in a graph of the same size.
+TEST(ContactActivationGraph, schedule) {
+  const Robot biped = example::Biped();
+  const PointOnLinks feet = example::Feet(biped);
+  const DynamicsGraph graph_builder(example::gravity);
+  ContactActivationGraph activation(graph_builder, biped, feet, 0, 1, 0.5);
+  EXPECT_LONGS_EQUAL(2, activation.numCandidates());
+  const size_t size = activation.graph().size();
+
+  Initializer initializer;
+  Values values = initializer.ZeroValues(biped, 0, 0.0, feet);
+  values.insert(initializer.ZeroValues(biped, 1, 0.0, feet));
+  NonlinearFactorGraph expected;
+  for (int k = 0; k < 2; k++) {
+    expected.add(graph_builder.dynamicsFactorGraph(biped, k, feet, 0.5));
+  }
+  EXPECT_DOUBLES_EQUAL(expected.error(values), activation.graph().error(values),
+                       1e-9);
+
+  // Lift the second foot at both steps.
+  const PointOnLinks left_stance_points{feet[0]};
+  const FootContactConstraintSpec left_stance(left_stance_points);
+  activation.setPhase(left_stance, 0, 1);
+  EXPECT(activation.inContact(0, 1));
+  EXPECT(!activation.inContact(1, 0));
+  EXPECT_LONGS_EQUAL(size, activation.graph().size());
+  NonlinearFactorGraph swing;
+  for (int k = 0; k < 2; k++) {
+    swing.add(graph_builder.dynamicsFactorGraph(biped, k, left_stance_points,
+                                                0.5));
+  }
+  EXPECT_DOUBLES_EQUAL(swing.error(values), activation.graph().error(values),
+                       1e-9);
+
+  // A nonzero wrench on the lifted foot is penalized by the zero-wrench prior.
+  const gtsam::Key wrench_key = ContactWrenchKey(feet[1].link->id(), 0, 1);
+  values.update(wrench_key, (Vector(6) << 0, 0, 0, 0, 0, 1).finished());
+  const gtsam::PriorFactor<Vector> zero_wrench(
+      wrench_key, Vector::Zero(6), graph_builder.opt().f_cost_model);
+  EXPECT(zero_wrench.error(values) > 0);
+  EXPECT(activation.graph().error(values) >= zero_wrench.error(values));
+
+  // The linearized graph keeps its keys whatever the schedule.
+  const auto linear = activation.graph().linearize(values);
+  activation.setContact(1, 1, true);
+  const auto relinear = activation.graph().linearize(values);
+  EXPECT_LONGS_EQUAL(linear->size(), relinear->size());
+  for (size_t i = 0; i < linear->size(); i++) {
+    EXPECT(linear->at(i)->keys() == relinear->at(i)->keys());
+  }
+
+  CHECK_EXCEPTION(activation.setContact(2, 0, true), std::out_of_range);
+  CHECK_EXCEPTION(activation.setContact(0, 2, true), std::out_of_range);
+}
+
+// Contact block factors couple all contacts of a step, so are not gated.
+TEST(ContactActivationGraph, blockFactors) {
+  const Robot biped = example::Biped();
+  OptimizerSetting opt;
+  opt.setContactBlockFactors(true);
+  const DynamicsGraph graph_builder(opt, example::gravity);
+  CHECK_EXCEPTION(ContactActivationGraph(graph_builder, biped,
+                                         example::Feet(biped), 0, 0),
+                  std::invalid_argument);
+}
+
+// The contact mask marks the candidates on links in contact.
+TEST(FootContactConstraintSpec, contactMask) {
+  const Robot biped = example::Biped();
+  const PointOnLinks feet = example::Feet(biped);
+  const FootContactConstraintSpec right_stance({feet[1]});
+  EXPECT(right_stance.contactMask(feet) == std::vector<bool>({false, true}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
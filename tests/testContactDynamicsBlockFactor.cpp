@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactDynamicsBlockFactor.cpp
+ * @brief Test the batched friction cone and contact moment factor.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ContactDynamicsBlockFactor.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::LabeledSymbol;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const double mu = 0.8;
+auto friction_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+auto moment_model = gtsam::noiseModel::Isotropic::Sigma(3, 0.02);
+
+// Three contacts, the last two on the same link, where the first and last
+// slip and the second is inside its cone.
+const std::vector<ContactDynamicsBlockFactor::Contact> contacts{
+    {LabeledSymbol('p', 0, 0), LabeledSymbol('C', 0, 0),
+     Pose3(Rot3(), Point3(0, 0, -0.1))},
+    {LabeledSymbol('p', 1, 0), LabeledSymbol('C', 1, 0),
+     Pose3(Rot3(), Point3(0.1, 0, -0.2))},
+    {LabeledSymbol('p', 1, 0), LabeledSymbol('C', 2, 0),
+     Pose3(Rot3(), Point3(-0.1, 0, -0.2))}};
+
+Values ContactValues() {
+  Values values;
+  values.insert(contacts[0].pose_key,
+                Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0, 0, 1)));
+  values.insert(contacts[1].pose_key,
+                Pose3(Rot3::RzRyRx(-0.3, 0.1, 0.2), Point3(1, 0, 1)));
+  values.insert<Vector6>(contacts[0].wrench_key,
+                         (Vector(6) << 0.1, 0.2, 0.3, 4, 2, 3).finished());
+  values.insert<Vector6>(contacts[1].wrench_key,
+                         (Vector(6) << -0.2, 0.1, 0, 0.5, 0.2, 9).finished());
+  values.insert<Vector6>(contacts[2].wrench_key,
+                         (Vector(6) << 0.3, 0, -0.1, 6, -5, 1).finished());
+  return values;
+}
+}  // namespace example
+
+// The block factor stacks the errors of the per-contact factors.
+TEST(ContactDynamicsBlockFactor, error) {
+  using namespace example;
+  const Values values = ContactValues();
+  ContactDynamicsBlockFactor factor(contacts, friction_model, moment_model,
+                                    mu, gravity);
+  EXPECT_LONGS_EQUAL(12, factor.dim());
+  EXPECT_LONGS_EQUAL(5, factor.size());
+
+  const size_t n = contacts.size();
+  Vector expected(4 * n);
+  double expected_error = 0;
+  for (size_t i = 0; i < n; i++) {
+    ContactDynamicsFrictionConeFactor cone(
+        contacts[i].pose_key, contacts[i].wrench_key, friction_model, mu,
+        gravity);
+    ContactDynamicsMomentFactor moment(contacts[i].wrench_key, moment_model,
+                                       contacts[i].cTcom);
+    expected.segment<1>(i) = cone.unwhitenedError(values);
+    expected.segment<3>(n + 3 * i) = moment.unwhitenedError(values);
+    expected_error += cone.error(values) + moment.error(values);
+  }
+  EXPECT(expected(0) > 0 && expected(1) == 0 && expected(2) > 0);
+  EXPECT(assert_equal(expected, factor.unwhitenedError(values), 1e-9));
+  EXPECT_DOUBLES_EQUAL(expected_error, factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// Without moment model, only the friction cones are evaluated.
+TEST(ContactDynamicsBlockFactor, friction_cones_only) {
+  using namespace example;
+  const Values values = ContactValues();
+  ContactDynamicsBlockFactor factor(contacts, friction_model, nullptr, mu,
+                                    gravity);
+  EXPECT_LONGS_EQUAL(3, factor.dim());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(ContactDynamicsBlockFactor(
+                      std::vector<ContactDynamicsBlockFactor::Contact>(),
+                      friction_model, nullptr, mu, gravity),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactImplicitOptimizer.cpp
+ * @brief Test complementarity contact constraints and their homotopy solve.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/ContactImplicitOptimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <functional>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const Pose3 pose(Rot3::RzRyRx(0.3, -0.2, 0.5), Point3(0.1, 0.2, 0.3));
+const Vector6 vector = (Vector6() << 0.4, -0.3, 0.2, 1.0, -2.0, 3.0).finished();
+}  // namespace example
+
+// Analytic Jacobians of the normal force and the slip speed.
+TEST(ContactImplicit, Jacobians) {
+  using example::pose;
+  using example::vector;
+  const ContactNormalForce force(example::gravity);
+  const ContactSlipSpeedSquared slip(Point3(0.1, -0.2, 0.3), example::gravity);
+
+  gtsam::Matrix16 H_pose, H_vector;
+  force(pose, vector, H_pose, H_vector);
+  std::function<double(const Pose3&, const Vector6&)> f =
+      [&](const Pose3& T, const Vector6& w) { return force(T, w); };
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative21<double, Pose3, Vector6>(f, pose, vector),
+      H_pose, 1e-7));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative22<double, Pose3, Vector6>(f, pose, vector),
+      H_vector, 1e-7));
+
+  slip(pose, vector, H_pose, H_vector);
+  std::function<double(const Pose3&, const Vector6&)> s =
+      [&](const Pose3& T, const Vector6& V) { return slip(T, V); };
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative21<double, Pose3, Vector6>(s, pose, vector),
+      H_pose, 1e-6));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative22<double, Pose3, Vector6>(s, pose, vector),
+      H_vector, 1e-6));
+}
+
+// A link pulled into the ground while a force is requested ends up on the
+// ground, carrying the force: the homotopy finds the contact.
+TEST(ContactImplicit, Homotopy) {
+  const Robot robot = simple_rr::getRobot();
+  const auto link = robot.link("link_2");
+  const int i = link->id();
+  const ContactComplementarity complementarity(
+      {PointOnLink(link, Point3(0, 0, 0))}, example::gravity);
+  LONGS_EQUAL(4, complementarity.constraints(0, 1.0).size());
+
+  auto model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(
+      PoseKey(i, 0), Pose3(Rot3(), Point3(0, 0, -0.2)), model);
+  graph.emplace_shared<gtsam::PriorFactor<Vector6>>(
+      ContactWrenchKey(i, 0, 0),
+      (Vector6() << 0, 0, 0, 0, 0, 1).finished(), model);
+  graph.emplace_shared<gtsam::PriorFactor<Vector6>>(
+      TwistKey(i, 0), Vector6::Zero(), model);
+
+  gtsam::Values initial;
+  initial.insert(PoseKey(i, 0), Pose3(Rot3(), Point3(0, 0, 0.3)));
+  initial.insert(ContactWrenchKey(i, 0, 0), Vector6::Zero().eval());
+  initial.insert(TwistKey(i, 0), Vector6::Zero().eval());
+
+  ContactImplicitOptimizer optimizer;
+  AugmentedLagrangianState state;
+  const gtsam::Values result =
+      optimizer.optimize(graph, EqualityConstraints(), InequalityConstraints(),
+                         complementarity, 0, initial, &state);
+  EXPECT_DOUBLES_EQUAL(0.0, complementarity.height(result, 0, 0), 5e-3);
+  EXPECT_DOUBLES_EQUAL(1.0, complementarity.normalForce(result, 0, 0), 1e-2);
+  const auto schedule = complementarity.schedule(result, 0, 0.5);
+  CHECK(schedule[0][0]);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactSimulator.cpp
+ * @brief Test soft-contact simulation of a floating two-link robot.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace example {
+// Floating version of simple_urdf: two stacked links, with l1 standing on
+// four contact points at its bottom corners.
+Robot robot() {
+  return CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+}
+
+PointOnLinks feet(const Robot &robot) {
+  const auto l1 = robot.link("l1");
+  PointOnLinks feet;
+  for (double x : {-0.2, 0.2})
+    for (double y : {-0.2, 0.2}) feet.emplace_back(l1, Point3(x, y, -1));
+  return feet;
+}
+
+const Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// Without contact, the robot falls freely as one rigid body.
+TEST(ContactSimulator, FreeFall) {
+  const Robot robot = example::robot();
+  ContactSimulator simulator(robot, example::feet(robot), example::gravity);
+  const Pose3 start(gtsam::Rot3(), Point3(0, 0, 5));
+  simulator.setState(start, gtsam::Z_6x1, Vector::Zero(1), Vector::Zero(1));
+
+  const double dt = 0.01;
+  const int num_steps = 10;
+  for (int k = 0; k < num_steps; k++) simulator.step(Vector::Zero(1), dt);
+  EXPECT_LONGS_EQUAL(num_steps, simulator.t());
+
+  // Semi-implicit Euler: v_k = k g dt, z_k = z_0 + g dt^2 k (k + 1) / 2.
+  const double drop = 0.5 * 9.8 * dt * dt * num_steps * (num_steps + 1);
+  EXPECT(assert_equal(Point3(0, 0, 5 - drop),
+                      simulator.basePose().translation(), 1e-9));
+  EXPECT(assert_equal(Vector3(0, 0, -9.8 * dt * num_steps),
+                      Vector3(simulator.baseTwist().tail<3>()), 1e-9));
+  EXPECT_DOUBLES_EQUAL(0.0, simulator.jointAngles()(0), 1e-9);
+  for (auto &&wrench : simulator.contactWrenches())
+    EXPECT(assert_equal(gtsam::Z_6x1, wrench));
+}
+
+// Dropped from just above the ground, the robot comes to rest on its feet,
+// with the contact forces carrying its weight.
+TEST(ContactSimulator, Rest) {
+  const Robot robot = example::robot();
+  const auto feet = example::feet(robot);
+  ContactSimulatorParameters parameters;
+  parameters.stiffness = 1e5;
+  parameters.damping = 2e3;
+  ContactSimulator simulator(robot, feet, example::gravity, parameters);
+  simulator.setState(Pose3(gtsam::Rot3(), Point3(0, 0, 1.01)), gtsam::Z_6x1,
+                     Vector::Zero(1), Vector::Zero(1));
+
+  for (int k = 0; k < 2000; k++) simulator.step(Vector::Zero(1), 1e-3);
+  simulator.forwardDynamics(Vector::Zero(1));
+
+  const double weight = 115 * 9.8;
+  double total_normal_force = 0;
+  const gtsam::Values values = simulator.values();
+  for (size_t c = 0; c < feet.size(); c++) {
+    const auto &wrench = simulator.contactWrenches()[c];
+    const Vector3 force =
+        Pose(values, feet[c].link->id()).rotation() * Vector3(wrench.tail<3>());
+    total_normal_force += force.z();
+    EXPECT(assert_equal(wrench, values.at<gtsam::Vector6>(ContactWrenchKey(
+                                    feet[c].link->id(), c))));
+    EXPECT_DOUBLES_EQUAL(-weight / 4 / parameters.stiffness,
+                         simulator.contactHeight(c), 1e-5);
+  }
+  EXPECT_DOUBLES_EQUAL(weight, total_normal_force, 1e-2 * weight);
+  EXPECT(assert_equal(Vector(gtsam::Z_6x1), Vector(simulator.baseTwist()),
+                      1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,147 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDynamicsDerivatives.cpp
+ * @brief Test analytic dynamics Jacobians against numerical derivatives.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/DynamicsDerivatives.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+
+// Poses and twists of all links at joint angles q and velocities v.
+void Kinematics(const Robot& robot, const Vector& q, const Vector& v,
+                std::vector<Pose3>* poses, std::vector<Vector6>* twists) {
+  Values values;
+  for (size_t j = 0; j < robot.joints().size(); j++) {
+    InsertJointAngle(&values, robot.joints()[j]->id(), q(j));
+    InsertJointVel(&values, robot.joints()[j]->id(), v(j));
+  }
+  const Values fk = robot.forwardKinematics(values);
+  poses->clear();
+  twists->clear();
+  for (auto&& link : robot.links()) {
+    poses->push_back(Pose(fk, link->id()));
+    twists->push_back(Twist(fk, link->id()));
+  }
+}
+
+// Central differences of f wrt x.
+Matrix NumericalJacobian(const std::function<Vector(const Vector&)>& f,
+                         const Vector& x) {
+  constexpr double delta = 1e-6;
+  Matrix H(f(x).size(), x.size());
+  for (int i = 0; i < x.size(); i++) {
+    Vector dx = Vector::Zero(x.size());
+    dx(i) = delta;
+    H.col(i) = (f(x + dx) - f(x - dx)) / (2 * delta);
+  }
+  return H;
+}
+
+// Check the Jacobians of inverse and forward dynamics of a robot.
+void CheckJacobians(const Robot& robot, double tol) {
+  const size_t n = robot.numJoints();
+  const Vector q = Vector::LinSpaced(n, -0.7, 0.9);
+  const Vector v = Vector::LinSpaced(n, 0.8, -0.5);
+  const Vector a = Vector::LinSpaced(n, 1.5, -1.0);
+  const Vector tau = Vector::LinSpaced(n, -2.0, 3.0);
+
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  auto ID = [&](const Vector& q, const Vector& v, const Vector& a) -> Vector {
+    Kinematics(robot, q, v, &poses, &twists);
+    rnea.solve(poses, twists, v, a);
+    return rnea.torques();
+  };
+  auto FD = [&](const Vector& q, const Vector& v, const Vector& tau) -> Vector {
+    Kinematics(robot, q, v, &poses, &twists);
+    aba.solve(poses, twists, v, tau);
+    return aba.jointAccels();
+  };
+
+  DynamicsDerivatives derivatives(robot, gravity);
+  Kinematics(robot, q, v, &poses, &twists);
+  derivatives.solveInverse(poses, twists, v, a);
+  EXPECT(assert_equal(ID(q, v, a), derivatives.torques(), 1e-9));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return ID(x, v, a); }, q),
+      derivatives.H_q(), tol));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return ID(q, x, a); }, v),
+      derivatives.H_v(), tol));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return ID(q, v, x); }, a),
+      derivatives.H_u(), tol));
+
+  Kinematics(robot, q, v, &poses, &twists);
+  derivatives.solveForward(poses, twists, v, tau);
+  EXPECT(assert_equal(FD(q, v, tau), derivatives.jointAccels(), 1e-9));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return FD(x, v, tau); }, q),
+      derivatives.H_q(), tol));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return FD(q, x, tau); }, v),
+      derivatives.H_v(), tol));
+  EXPECT(assert_equal(
+      NumericalJacobian([&](const Vector& x) { return FD(q, v, x); }, tau),
+      derivatives.H_u(), tol));
+}
+}  // namespace example
+
+// Serial arm.
+TEST(DynamicsDerivatives, panda) {
+  example::CheckJacobians(
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+          .fixLink("link0"),
+      1e-5);
+}
+
+// Quadruped fixed at a foot, so that most tree edges run against the joints.
+TEST(DynamicsDerivatives, a1_fixed_foot) {
+  example::CheckJacobians(
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"))
+          .fixLink("FR_lower"),
+      1e-5);
+}
+
+// Floating-base robots are rejected.
+TEST(DynamicsDerivatives, floating) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  CHECK_EXCEPTION(DynamicsDerivatives derivatives(robot),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -13,11 +13,16 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Executor.h>
 #include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Parallel.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Testable.h>
@@ -29,6 +34,7 @@
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
 #include <gtsam/slam/PriorFactor.h>
 
 #include <iostream>
@@ -81,6 +87,169 @@ TEST(linearDynamicsFactorGraph, simple_urdf_eq_mass_values) {
   EXPECT(assert_equal(1.0, Torque(result_id, j, t), 1e-3));
 }
 
+// Hybrid dynamics of a fixed-base serial chain agrees with FD and ID.
+TEST(linearSolveHybrid, simple_rr) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  const int t = 3;
+  Values kinematics;
+  double angle = 0.3, vel = -0.7;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&kinematics, joint->id(), t, angle);
+    InsertJointVel(&kinematics, joint->id(), t, vel);
+    angle = 0.1 - angle, vel = 0.5 - vel;
+  }
+  kinematics = robot.forwardKinematics(kinematics, t);
+
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  Values known_torques = kinematics;
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&known_torques, joint->id(), t, 0.2 * joint->id() + 0.1);
+  }
+  Values fd = graph_builder.linearSolveFD(robot, t, known_torques);
+
+  const auto& joints = robot.joints();
+  const std::vector<bool> mask{true, false};
+  for (int k = 0; k < 2; k++) {
+    Values known_values = kinematics;
+    InsertJointAccel(&known_values, joints[0]->id(), t,
+                     JointAccel(fd, joints[0]->id(), t));
+    InsertTorque(&known_values, joints[1]->id(), t,
+                 Torque(fd, joints[1]->id(), t));
+    Values hybrid =
+        graph_builder.linearSolveHybrid(robot, t, known_values, mask);
+    for (auto&& joint : joints) {
+      int j = joint->id();
+      EXPECT_DOUBLES_EQUAL(Torque(fd, j, t), Torque(hybrid, j, t), 1e-6);
+      EXPECT_DOUBLES_EQUAL(JointAccel(fd, j, t), JointAccel(hybrid, j, t),
+                           1e-6);
+      for (auto&& link : joint->links()) {
+        EXPECT(assert_equal(Wrench(fd, link->id(), j, t),
+                            Wrench(hybrid, link->id(), j, t), 1e-6));
+      }
+    }
+  }
+
+  // All accelerations known is inverse dynamics.
+  Values known_accels = kinematics;
+  for (auto&& joint : joints) {
+    InsertJointAccel(&known_accels, joint->id(), t,
+                     JointAccel(fd, joint->id(), t));
+  }
+  Values hybrid = graph_builder.linearSolveHybrid(robot, t, known_accels,
+                                                  {true, true});
+  for (auto&& joint : joints) {
+    EXPECT_DOUBLES_EQUAL(Torque(fd, joint->id(), t),
+                         Torque(hybrid, joint->id(), t), 1e-6);
+  }
+
+  CHECK_EXCEPTION(
+      graph_builder.linearSolveHybrid(robot, t, known_accels, {true}),
+      std::invalid_argument);
+}
+
+// Threads may share the compiled solvers of a graph builder.
+TEST(linearSolveHybrid, shared) {
+  const int t = 0;
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  Values known_values;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), t, 0.2);
+    InsertJointVel(&known_values, joint->id(), t, -0.4);
+    InsertTorque(&known_values, joint->id(), t, 0.3);
+  }
+  known_values = robot.forwardKinematics(known_values, t);
+
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const std::vector<bool> mask{false, false};
+  const Values expected =
+      graph_builder.linearSolveHybrid(robot, t, known_values, mask);
+
+  SetExecutorThreads(4);
+  std::vector<Values> results(16);
+  ParallelFor(results.size(), 0, [&](size_t i) {
+    results[i] = graph_builder.linearSolveHybrid(robot, t, known_values, mask);
+  });
+  SetExecutorThreads(0);
+  for (auto&& result : results) EXPECT(assert_equal(expected, result, 1e-9));
+}
+
+// Quadruped in stance: the feet do not accelerate, and every link is in
+// balance with the joint and contact wrenches.
+TEST(linearSolveContactFD, vision60) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+  const int t = 2;
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const gtsam::Point3 contact_in_com(0.14, 0, 0);
+  PointOnLinks contacts;
+  for (auto&& name : {"lower0", "lower1", "lower2", "lower3"}) {
+    contacts.emplace_back(robot.link(name), contact_in_com);
+  }
+
+  Values known_values;
+  const int b = robot.link("body")->id();
+  InsertPose(&known_values, b, t,
+             gtsam::Pose3(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                          gtsam::Point3(0, 0, 0.5)));
+  InsertTwist(&known_values, b, t,
+              (Vector6() << 0.1, -0.3, 0.2, 0.5, 0.1, -0.2).finished());
+  double angle = 0.3, vel = -0.7, torque = 0.2;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), t, angle);
+    InsertJointVel(&known_values, joint->id(), t, vel);
+    angle = -0.8 * angle + 0.1, vel = 0.5 - 0.6 * vel;
+  }
+  known_values = robot.forwardKinematics(known_values, t, std::string("body"));
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&known_values, joint->id(), t, torque);
+    torque = 0.3 - torque;
+  }
+
+  DynamicsGraph graph_builder(gravity);
+  Values result =
+      graph_builder.linearSolveContactFD(robot, t, known_values, contacts);
+
+  auto model3 = gtsam::noiseModel::Unit::Create(3);
+  for (size_t c = 0; c < contacts.size(); c++) {
+    const auto& cp = contacts[c];
+    const gtsam::Pose3 cTcom(gtsam::Rot3(), -cp.point);
+    const int i = cp.link->id();
+    ContactKinematicsAccelFactor accel(TwistAccelKey(i, t), model3, cTcom);
+    EXPECT(assert_equal(gtsam::Vector3::Zero().eval(),
+                        accel.unwhitenedError(result), 1e-6));
+    ContactDynamicsMomentFactor moment(ContactWrenchKey(i, c, t), model3,
+                                       cTcom);
+    EXPECT(assert_equal(gtsam::Vector3::Zero().eval(),
+                        moment.unwhitenedError(result), 1e-6));
+  }
+  auto model6 = gtsam::noiseModel::Unit::Create(6);
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    std::vector<DynamicsSymbol> wrench_keys;
+    for (auto&& joint : link->joints()) {
+      wrench_keys.push_back(WrenchKey(i, joint->id(), t));
+    }
+    for (size_t c = 0; c < contacts.size(); c++) {
+      if (contacts[c].link == link) {
+        wrench_keys.push_back(ContactWrenchKey(i, c, t));
+      }
+    }
+    auto balance = WrenchFactor(model6, link, wrench_keys, t, gravity);
+    EXPECT(assert_equal(gtsam::Z_6x1, balance->unwhitenedError(result), 1e-6));
+  }
+
+  // The compiled solver is reused for the same contact set.
+  Values again =
+      graph_builder.linearSolveContactFD(robot, t, known_values, contacts);
+  EXPECT(assert_equal(result, again, 1e-9));
+
+  // Contacts on fixed links are rejected.
+  auto fixed = simple_rr::getRobot().fixLink("link_0");
+  PointOnLinks on_fixed{PointOnLink(fixed.link("link_0"), contact_in_com)};
+  CHECK_EXCEPTION(
+      graph_builder.linearSolveContactFD(fixed, 0, Values(), on_fixed),
+      std::invalid_argument);
+}
+
 Values zero_values(const Robot& robot, size_t t, bool insert_accels = false) {
   Values values;
   for (auto&& joint : robot.joints()) {
@@ -307,6 +476,25 @@ TEST(collocationFactors, simple_urdf) {
 
   EXPECT(assert_equal(2.75, JointAngle(mp_trapezoidal_result, j, t + 1)));
   EXPECT(assert_equal(2.5, JointVel(mp_trapezoidal_result, j, t + 1)));
+
+  // Hermite-Simpson is exact for the linear acceleration a = 1 + t.
+  NonlinearFactorGraph hs_graph;
+  hs_graph.add(graph_builder.collocationFactors(
+      robot, t, dt, CollocationScheme::HermiteSimpson));
+  hs_graph.add(prior_factors);
+  gtsam::GaussNewtonOptimizer optimizer_hs(hs_graph, init_values);
+  Values hs_result = optimizer_hs.optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(hs_result, j, t + 1), 1e-6));
+  EXPECT(assert_equal(2.5, JointVel(hs_result, j, t + 1), 1e-6));
+
+  NonlinearFactorGraph mp_hs_graph;
+  mp_hs_graph.add(graph_builder.multiPhaseCollocationFactors(
+      robot, t, phase, CollocationScheme::HermiteSimpson));
+  mp_hs_graph.add(prior_factors);
+  gtsam::GaussNewtonOptimizer optimizer_mphs(mp_hs_graph, init_values);
+  Values mp_hs_result = optimizer_mphs.optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(mp_hs_result, j, t + 1), 1e-6));
+  EXPECT(assert_equal(2.5, JointVel(mp_hs_result, j, t + 1), 1e-6));
 }
 
 // test forward dynamics of a trajectory
@@ -364,6 +552,20 @@ TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   EXPECT(assert_equal(4.0, JointVel(trapezoidal_result, j, 2)));
   EXPECT(assert_equal(3.0, JointAccel(trapezoidal_result, j, 2)));
 
+  // test Hermite-Simpson, exact for a = 1 + t: q = t^2 / 2 + t^3 / 6.
+  auto hs_graph = graph_builder.trajectoryFG(robot, num_steps, dt,
+                                             CollocationScheme::HermiteSimpson);
+  hs_graph.add(
+      graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+
+  gtsam::GaussNewtonOptimizer optimizer_hs(hs_graph, init_values);
+  Values hs_result = optimizer_hs.optimize();
+
+  EXPECT(assert_equal(2.0 / 3, JointAngle(hs_result, j, 1), 1e-6));
+  EXPECT(assert_equal(1.5, JointVel(hs_result, j, 1), 1e-6));
+  EXPECT(assert_equal(10.0 / 3, JointAngle(hs_result, j, 2), 1e-6));
+  EXPECT(assert_equal(4.0, JointVel(hs_result, j, 2), 1e-6));
+
   // test the scenario with dt as a variable
   vector<int> phase_steps{1, 1};
   auto transition_graph = graph_builder.dynamicsFactorGraph(robot, 1);
@@ -417,9 +619,61 @@ TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   EXPECT(assert_equal(2.0, JointAccel(mp_trapezoidal_result, j, 1)));
   EXPECT(assert_equal(8.75, JointAngle(mp_trapezoidal_result, j, 2)));
   EXPECT(assert_equal(6.5, JointVel(mp_trapezoidal_result, j, 2)));
+
+  // multi-phase Hermite-Simpson: q2 = q1 + 8 - 4 / 12.
+  auto mp_hs_graph = graph_builder.multiPhaseTrajectoryFG(
+      robot, phase_steps, transition_graphs,
+      CollocationScheme::HermiteSimpson);
+  mp_hs_graph.add(mp_prior_graph);
+  gtsam::GaussNewtonOptimizer optimizer_mphs(mp_hs_graph, mp_euler_result);
+  Values mp_hs_result = optimizer_mphs.optimize();
+  EXPECT(assert_equal(2.0 / 3, JointAngle(mp_hs_result, j, 1), 1e-6));
+  EXPECT(assert_equal(1.5, JointVel(mp_hs_result, j, 1), 1e-6));
+  EXPECT(assert_equal(25.0 / 3, JointAngle(mp_hs_result, j, 2), 1e-6));
+  EXPECT(assert_equal(6.5, JointVel(mp_hs_result, j, 2), 1e-6));
   EXPECT(assert_equal(3.0, JointAccel(mp_trapezoidal_result, j, 2)));
 }
 
+// Graphs built with several threads have the same factors in the same order.
+TEST(dynamicsTrajectoryFG, parallel) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  int num_steps = 20;
+
+  OptimizerSetting serial_opt, parallel_opt;
+  serial_opt.setNumThreads(1);
+  parallel_opt.setNumThreads(4);
+  DynamicsGraph serial_builder(serial_opt, simple_urdf_eq_mass::gravity);
+  DynamicsGraph parallel_builder(parallel_opt, simple_urdf_eq_mass::gravity);
+
+  auto expected = serial_builder.trajectoryFG(robot, num_steps, 0.1,
+                                              CollocationScheme::Trapezoidal);
+  auto actual = parallel_builder.trajectoryFG(robot, num_steps, 0.1,
+                                              CollocationScheme::Trapezoidal);
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT(expected.at(i)->keys() == actual.at(i)->keys());
+  }
+
+  vector<int> phase_steps{5, 5};
+  vector<NonlinearFactorGraph> transition_graphs{
+      serial_builder.dynamicsFactorGraph(robot, 5)};
+  auto mp_expected = serial_builder.multiPhaseTrajectoryFG(
+      robot, phase_steps, transition_graphs, CollocationScheme::Euler);
+  auto mp_actual = parallel_builder.multiPhaseTrajectoryFG(
+      robot, phase_steps, transition_graphs, CollocationScheme::Euler);
+  EXPECT_LONGS_EQUAL(mp_expected.size(), mp_actual.size());
+  for (size_t i = 0; i < mp_expected.size(); i++) {
+    EXPECT(mp_expected.at(i)->keys() == mp_actual.at(i)->keys());
+  }
+
+  // Same error at a common linearization point.
+  Initializer initializer;
+  Values init_values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected.error(init_values), actual.error(init_values),
+                       1e-9);
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rr) {
   // Load the robot from urdf file
@@ -539,6 +793,32 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_biped) {
   EXPECT(assert_equal(187.8615, normal_force, 1e-2));
 }
 
+// One contact block factor per step gives the same error as per-contact
+// friction cone and moment factors.
+TEST(dynamicsFactors, contact_block_factors) {
+  Robot biped = CreateRobotFromFile(kUrdfPath + std::string("biped.urdf"));
+  PointOnLinks contact_points;
+  contact_points.emplace_back(biped.link("lower0"), gtsam::Point3(0.14, 0, 0));
+  contact_points.emplace_back(biped.link("lower2"), gtsam::Point3(0.14, 0, 0));
+
+  const gtsam::Vector3 gravity(0, 0, -9.81);
+  OptimizerSetting opt;
+  DynamicsGraph per_contact(opt, gravity);
+  opt.setContactBlockFactors(true);
+  DynamicsGraph block(opt, gravity);
+  const auto graph = per_contact.dynamicsFactors(biped, 0, contact_points, 0.5);
+  const auto block_graph = block.dynamicsFactors(biped, 0, contact_points, 0.5);
+  EXPECT_LONGS_EQUAL(graph.size() - 3, block_graph.size());
+
+  Initializer initializer;
+  Values values = initializer.ZeroValues(biped, 0, 0.0, contact_points);
+  values.update(ContactWrenchKey(biped.link("lower0")->id(), 0, 0),
+                (Vector(6) << 0.1, 0.2, 0.3, 4, 2, 3).finished());
+  values.update(ContactWrenchKey(biped.link("lower2")->id(), 0, 0),
+                (Vector(6) << -0.2, 0.1, 0, 0.5, 0.2, 9).finished());
+  EXPECT_DOUBLES_EQUAL(graph.error(values), block_graph.error(values), 1e-9);
+}
+
 // check joint limit factors
 TEST(jointlimitFactors, simple_urdf) {
   auto robot = simple_urdf::getRobot();
@@ -551,6 +831,86 @@ TEST(jointlimitFactors, simple_urdf) {
                       joint_limit_factors.keys().size()));
 }
 
+// One block factor per step has the error of the per-joint limit factors.
+TEST(jointlimitFactors, block) {
+  auto robot = simple_urdf::getRobot();
+  OptimizerSetting opt;
+  DynamicsGraph graph_builder(opt);
+  opt.setJointLimitBlockFactors(true);
+  DynamicsGraph block_builder(opt);
+  const NonlinearFactorGraph expected =
+      graph_builder.jointLimitFactors(robot, 2);
+  const NonlinearFactorGraph block = block_builder.jointLimitFactors(robot, 2);
+  EXPECT_LONGS_EQUAL(1, block.size());
+  EXPECT(expected.keys() == block.keys());
+
+  // Values on both sides of every limit.
+  for (double scale : {0.0, 1e3, -1e3}) {
+    Values values;
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, 2, 0.1 + 2 * scale);
+      InsertJointVel(&values, j, 2, -0.2 - 3 * scale);
+      InsertJointAccel(&values, j, 2, 0.3 + 5 * scale);
+      InsertTorque(&values, j, 2, -0.4 + 7 * scale);
+    }
+    EXPECT_DOUBLES_EQUAL(expected.error(values), block.error(values), 1e-6);
+    auto factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(block[0]);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+  }
+}
+
+// Check joint limits as inequality constraints.
+TEST(jointLimitConstraints, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  DynamicsGraph graph_builder;
+  auto constraints = graph_builder.jointLimitConstraints(robot, 0);
+
+  // Lower and upper limit on angle, velocity, acceleration, and torque.
+  EXPECT_LONGS_EQUAL(robot.numJoints() * 8, constraints.size());
+
+  auto j = robot.joints()[0]->id();
+  Values values;
+  InsertJointAngle(&values, j, 0, 0.0);
+  InsertJointVel(&values, j, 0, 0.0);
+  InsertJointAccel(&values, j, 0, 0.0);
+  InsertTorque(&values, j, 0, 0.0);
+  for (auto&& constraint : constraints) EXPECT(constraint->feasible(values));
+
+  // Beyond the upper angle limit of pi/2.
+  values.update(JointAngleKey(j, 0), 2.0);
+  EXPECT(!constraints[1]->feasible(values));
+  EXPECT(constraints[0]->feasible(values));
+}
+
+// Check friction cone inequality constraints.
+TEST(frictionConeConstraints, simple_rr) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  LinkSharedPtr l0 = robot.link("link_0");
+  contact_points.emplace_back(l0, gtsam::Point3(0, 0, -0.1));
+
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  auto constraints =
+      graph_builder.frictionConeConstraints(robot, 0, contact_points, 0.5);
+  EXPECT_LONGS_EQUAL(1, constraints.size());
+
+  // Inside the cone: |f_t| = 1 < 0.5 * 4.
+  Values values;
+  auto pose_key = PoseKey(l0->id(), 0);
+  auto wrench_key = ContactWrenchKey(l0->id(), 0, 0);
+  values.insert(pose_key, gtsam::Pose3(gtsam::Rot3::Rx(0.1), gtsam::Point3()));
+  values.insert(wrench_key, (Vector6() << 0, 0, 0, 1, 0, 4).finished());
+  EXPECT(constraints[0]->feasible(values));
+
+  // Outside the cone, check Jacobians of the active penalty factor.
+  values.update(wrench_key, (Vector6() << 0, 0, 0, 3, 1, 4).finished());
+  EXPECT(!constraints[0]->feasible(values));
+  auto factor = constraints[0]->createFactor(1.0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
   // Load the robot from urdf file
@@ -607,6 +967,33 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
     EXPECT(assert_equal(0, Torque(results, joint->id())));
 }
 
+// Sinks append the same factors as the by-value builders, and the estimate
+// counts the factors of a time step with collocation.
+TEST(DynamicsGraph, addFactors) {
+  Robot biped = CreateRobotFromFile(kUrdfPath + std::string("biped.urdf"));
+  PointOnLinks contact_points;
+  contact_points.emplace_back(biped.link("lower0"), gtsam::Point3(0.14, 0, 0));
+  contact_points.emplace_back(biped.link("lower2"), gtsam::Point3(0.14, 0, 0));
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.81));
+
+  NonlinearFactorGraph expected =
+      graph_builder.dynamicsFactorGraph(biped, 1, contact_points, 1.0);
+  expected.add(graph_builder.collocationFactors(biped, 1, 0.1));
+  EXPECT_LONGS_EQUAL(expected.size(),
+                     graph_builder.numFactorsEstimate(biped, contact_points));
+
+  NonlinearFactorGraph graph;
+  graph_builder.addDynamicsFactorGraph(&graph, biped, 1, contact_points, 1.0);
+  graph_builder.addCollocationFactors(&graph, biped, 1, 0.1);
+  EXPECT(assert_equal(expected, graph));
+
+  NonlinearFactorGraph factors = graph_builder.qFactors(biped, 1);
+  const size_t num_factors = factors.size();
+  DynamicsGraph::appendFactors(&graph, std::move(factors));
+  EXPECT_LONGS_EQUAL(expected.size() + num_factors, graph.size());
+  EXPECT_LONGS_EQUAL(0, factors.size());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
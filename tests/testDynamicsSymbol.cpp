@@ -23,12 +23,12 @@ using namespace gtdynamics;
 /* ************************************************************************* */
 TEST(DynamicsSymbol, LinkJointSymbol) {
   std::string variable_type = "F";
-  const uint8_t link_index = 1;
-  const uint8_t joint_index = 2;
+  const uint16_t link_index = 1;
+  const uint16_t joint_index = 2;
   const uint64_t t = 10;
   const DynamicsSymbol symbol = DynamicsSymbol::LinkJointSymbol(
       variable_type, link_index, joint_index, t);
-  const Key key = 0x004601020000000A;
+  const Key key = 0x011800010020000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal(variable_type, symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -41,11 +41,11 @@ TEST(DynamicsSymbol, LinkJointSymbol) {
 }
 
 TEST(DynamicsSymbol, LinkSymbol) {
-  const uint8_t link_index = 2;
+  const uint16_t link_index = 2;
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::LinkSymbol("FA", link_index, 10);
-  const Key key = 0x464102FF0000000A;
+  const Key key = 0x8D040002FFF0000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("FA", symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -57,11 +57,11 @@ TEST(DynamicsSymbol, LinkSymbol) {
 }
 
 TEST(DynamicsSymbol, JointSymbol) {
-  const uint8_t joint_index = 1;
+  const uint16_t joint_index = 1;
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::JointSymbol("q", joint_index, 10);
-  const Key key = 0x0071FF010000000A;
+  const Key key = 0x01C40FFF0010000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("q", symbol.label()));
   EXPECT_LONGS_EQUAL(joint_index, symbol.jointIdx());
@@ -74,7 +74,7 @@ TEST(DynamicsSymbol, JointSymbol) {
 
 TEST(DynamicsSymbol, SimpleSymbol) {
   const DynamicsSymbol symbol = DynamicsSymbol::SimpleSymbol("ti", 10);
-  const Key key = 0x7469FFFF0000000A;
+  const Key key = 0xE9A40FFFFFF0000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("ti", symbol.label()));
   EXPECT_LONGS_EQUAL(10, symbol.time());
@@ -84,6 +84,105 @@ TEST(DynamicsSymbol, SimpleSymbol) {
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)DynamicsSymbol(key));
 }
 
+// Wide indices and robot instances survive the round trip through a key.
+TEST(DynamicsSymbol, RobotInstance) {
+  const DynamicsSymbol symbol =
+      DynamicsSymbol::JointSymbol("q", 300, 100000).ofRobot(3);
+  const Key key = 0x01C4312CFFF186A0;
+  EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
+  EXPECT_LONGS_EQUAL(3, symbol.robotIdx());
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::kNoIndex, symbol.linkIdx());
+  EXPECT_LONGS_EQUAL(300, symbol.jointIdx());
+  EXPECT_LONGS_EQUAL(100000, symbol.time());
+  EXPECT(assert_equal(std::string("q{3}(300)100000"), (std::string)(symbol)));
+  EXPECT_LONGS_EQUAL((long)key, (long)(Key)DynamicsSymbol(key));
+  EXPECT(DynamicsSymbol::JointSymbol("q", 300, 100000).key() != key);
+
+  // Fields that do not fit are rejected.
+  CHECK_EXCEPTION(DynamicsSymbol::LinkSymbol("p", DynamicsSymbol::kNoIndex + 1,
+                                             0),
+                  std::runtime_error);
+  CHECK_EXCEPTION(DynamicsSymbol::SimpleSymbol("t", DynamicsSymbol::kMaxTime +
+                                                        1),
+                  std::runtime_error);
+  CHECK_EXCEPTION(symbol.ofRobot(DynamicsSymbol::kMaxRobot + 1),
+                  std::runtime_error);
+}
+
+// Time steps are limited to 20 bits, whichever way a symbol is created.
+TEST(DynamicsSymbol, TimeLimit) {
+  const uint64_t limit = uint64_t(1) << 20;
+  EXPECT_LONGS_EQUAL(limit - 1, DynamicsSymbol::kMaxTime);
+  EXPECT_LONGS_EQUAL(limit - 1,
+                     DynamicsSymbol::JointSymbol("q", 1, limit - 1).time());
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol("q", 1, limit),
+                  std::runtime_error);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkJointSymbol(std::string("F"), 1, 2,
+                                                  limit),
+                  std::runtime_error);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkSymbol("p", 1, 0).atTime(limit),
+                  std::runtime_error);
+}
+
+// Symbols created inside a RobotScope belong to its robot instance.
+TEST(DynamicsSymbol, RobotScope) {
+  {
+    DynamicsSymbol::RobotScope scope(2);
+    EXPECT_LONGS_EQUAL(2, DynamicsSymbol::LinkSymbol("p", 1, 0).robotIdx());
+    {
+      DynamicsSymbol::RobotScope inner(5);
+      EXPECT_LONGS_EQUAL(5, DynamicsSymbol::SimpleSymbol("t", 0).robotIdx());
+    }
+    EXPECT_LONGS_EQUAL(2, DynamicsSymbol::JointSymbol("q", 1, 0).robotIdx());
+  }
+  EXPECT_LONGS_EQUAL(0, DynamicsSymbol::JointSymbol("q", 1, 0).robotIdx());
+}
+
+// Literal labels are encoded at compile time, and agree with string labels.
+TEST(DynamicsSymbol, LabelCode) {
+  static_assert(DynamicsSymbol::LabelCode("q") == 'q', "one character");
+  static_assert(DynamicsSymbol::LabelCode("dt") == ('d' << 8 | 't'),
+                "two characters");
+  static_assert(DynamicsSymbol::LabelCodeOf(0x8D040002FFF0000A) ==
+                    DynamicsSymbol::LabelCode("FA"),
+                "decoded label");
+  static_assert(DynamicsSymbol::TimeOf(0x8D040002FFF0000A) == 10,
+                "decoded time");
+  EXPECT_LONGS_EQUAL(0, DynamicsSymbol::LabelCode(""));
+
+  const std::string label = "Pa";
+  const DynamicsSymbol symbol = DynamicsSymbol::LinkJointSymbol("Pa", 3, 4, 5);
+  EXPECT_LONGS_EQUAL((long)DynamicsSymbol::LinkJointSymbol(label, 3, 4, 5),
+                     (long)(Key)symbol);
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::LabelCode("Pa"), symbol.labelCode());
+  EXPECT_LONGS_EQUAL(symbol.labelCode(),
+                     DynamicsSymbol::LabelCodeOf(symbol.key()));
+  EXPECT_LONGS_EQUAL(5, DynamicsSymbol::TimeOf(symbol.key()));
+  EXPECT_LONGS_EQUAL((long)DynamicsSymbol::SimpleSymbol(std::string("t"), 2),
+                     (long)(Key)DynamicsSymbol::SimpleSymbol("t", 2));
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol("\xe9", 0, 0),
+                  std::runtime_error);
+}
+
+// format writes the same string as the string cast, up to the longest one.
+TEST(DynamicsSymbol, format) {
+  char buffer[DynamicsSymbol::kMaxStringLength + 1];
+  const DynamicsSymbol longest =
+      DynamicsSymbol::LinkJointSymbol("dt", DynamicsSymbol::kNoIndex - 1,
+                                      DynamicsSymbol::kNoIndex - 1,
+                                      DynamicsSymbol::kMaxTime)
+          .ofRobot(DynamicsSymbol::kMaxRobot);
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::kMaxStringLength, longest.format(buffer));
+  EXPECT(assert_equal(std::string("dt{63}[4094](4094)1048575"),
+                      std::string(buffer)));
+
+  const DynamicsSymbol symbol = DynamicsSymbol::SimpleSymbol("t", 0);
+  EXPECT_LONGS_EQUAL(2, symbol.format(buffer));
+  EXPECT(assert_equal(std::string("t0"), std::string(buffer)));
+  EXPECT(assert_equal(std::string("V[12]7"),
+                      GTDKeyFormatter(DynamicsSymbol::LinkSymbol("V", 12, 7))));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
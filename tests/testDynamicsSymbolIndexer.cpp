@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDynamicsSymbolIndexer.cpp
+ * @brief Test dense indexing of DynamicsSymbol keys.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/DynamicsSymbolIndexer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <set>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace example {
+Values values() {
+  Values values;
+  for (int t = 2; t < 5; t++) {
+    for (int j = 1; j < 4; j++) InsertJointAngle(&values, j, t, 10.0 * t + j);
+    InsertPose(&values, 0, t, gtsam::Pose3());
+    InsertWrench(&values, 1, 3, t, gtsam::Vector6::Constant(t));
+  }
+  values.insert(DynamicsSymbol::SimpleSymbol("dt", 0), 0.1);
+  return values;
+}
+}  // namespace example
+
+// Slots of the indexed keys are distinct and invert to the keys.
+TEST(DynamicsSymbolIndexer, Slots) {
+  const Values values = example::values();
+  DynamicsSymbolIndexer indexer(values);
+  EXPECT(indexer.size() >= values.size());
+
+  std::set<size_t> slots;
+  for (gtsam::Key key : values.keys()) {
+    const size_t s = indexer.slot(key);
+    CHECK(s < indexer.size());
+    EXPECT(indexer.used(s));
+    EXPECT_LONGS_EQUAL(key, indexer.key(s));
+    slots.insert(s);
+  }
+  EXPECT_LONGS_EQUAL(values.size(), slots.size());
+
+  // Keys outside the ranges, or with another label, are not found.
+  EXPECT(!indexer.exists(JointAngleKey(0, 2)));
+  EXPECT(!indexer.exists(JointAngleKey(1, 5)));
+  EXPECT(!indexer.exists(JointAngleKey(1, 1)));
+  EXPECT(!indexer.exists(JointVelKey(1, 2)));
+  EXPECT(!indexer.exists(WrenchKey(0, 3, 2)));
+}
+
+// Reading and writing through IndexedValues, including after a copy.
+TEST(IndexedValues, Access) {
+  const Values values = example::values();
+  IndexedValues indexed(values);
+  EXPECT_DOUBLES_EQUAL(JointAngle(values, 2, 3), JointAngle(indexed, 2, 3),
+                       1e-12);
+  EXPECT(assert_equal(Wrench(values, 1, 3, 4), Wrench(indexed, 1, 3, 4)));
+
+  indexed.update<double>(JointAngleKey(2, 3), -1.0);
+  indexed.at<gtsam::Pose3>(PoseKey(0, 4)) =
+      gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(1, 2, 3));
+  EXPECT_DOUBLES_EQUAL(-1.0, JointAngle(indexed.values(), 2, 3), 1e-12);
+
+  IndexedValues copy(indexed);
+  copy.update<double>(JointAngleKey(2, 3), 5.0);
+  EXPECT_DOUBLES_EQUAL(-1.0, JointAngle(indexed, 2, 3), 1e-12);
+  EXPECT_DOUBLES_EQUAL(5.0, JointAngle(copy, 2, 3), 1e-12);
+  EXPECT(assert_equal(gtsam::Point3(1, 2, 3),
+                      Pose(copy, 0, 4).translation()));
+
+  CHECK_EXCEPTION(JointVel(indexed, 1, 2), KeyDoesNotExist);
+  CHECK_EXCEPTION(indexed.at<gtsam::Pose3>(JointAngleKey(1, 2)),
+                  gtsam::ValuesIncorrectType);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -170,6 +170,123 @@ TEST(EqualityConstraint, Container) {
   EXPECT_LONGS_EQUAL(2, constraints.size());
 }
 
+// Evaluate many constraints at once, on several threads.
+TEST(EqualityConstraint, EvaluateConstraints) {
+  Vector2_ x1_vec_expr(x1_key);
+  Vector2_ x2_vec_expr(x2_key);
+  auto g = x1_vec_expr + x2_vec_expr;
+
+  EqualityConstraints constraints;
+  for (size_t i = 0; i < 100; i++) {
+    constraints.emplace_shared<VectorExpressionEquality<2>>(
+        g, Vector2(0.1 * (i + 1), 0.5));
+  }
+
+  Values values;
+  values.insert(x1_key, Vector2(1, 1));
+  values.insert(x2_key, Vector2(1, 1));
+
+  auto evaluation = EvaluateConstraints(constraints, values, 4);
+  EXPECT_LONGS_EQUAL(100, evaluation.violations.size());
+  double expected_squared = 0;
+  for (size_t i = 0; i < constraints.size(); i++) {
+    EXPECT(assert_equal(constraints[i]->operator()(values),
+                        evaluation.violations[i]));
+    EXPECT(assert_equal(constraints[i]->toleranceScaledViolation(values),
+                        evaluation.scaled_violations[i]));
+    expected_squared +=
+        constraints[i]->toleranceScaledViolation(values).squaredNorm();
+  }
+  EXPECT_DOUBLES_EQUAL(expected_squared, evaluation.squared_violation, 1e-9);
+  EXPECT_DOUBLES_EQUAL(20.0, evaluation.max_violation, 1e-9);
+  // g = [2, 2] is only within tolerance 0.1 * (i + 1) >= 2 for i >= 19, but
+  // never within the second tolerance 0.5.
+  EXPECT_LONGS_EQUAL(100, evaluation.num_infeasible);
+
+  auto serial = EvaluateConstraints(constraints, values, 1);
+  EXPECT_DOUBLES_EQUAL(serial.squared_violation, evaluation.squared_violation,
+                       0);
+}
+
+// Constraints on the same keys are grouped into one constraint and factor.
+TEST(EqualityConstraint, GroupEqualityConstraints) {
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  auto g2 = x1 - 2.0 * x2;
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 0.1);
+  constraints.emplace_shared<DoubleExpressionEquality>(2.0 * x1, 0.5);
+  constraints.emplace_shared<DoubleExpressionEquality>(g2, 0.2);
+
+  const EqualityConstraints grouped = GroupEqualityConstraints(constraints);
+  EXPECT_LONGS_EQUAL(2, grouped.size());
+  auto group = boost::dynamic_pointer_cast<EqualityConstraintGroup>(grouped[0]);
+  CHECK(group);
+  EXPECT_LONGS_EQUAL(2, group->dim());
+  EXPECT(grouped[1] == constraints[1]);
+
+  Values values;
+  values.insert(x1_key, 1.0);
+  values.insert(x2_key, 0.5);
+  EXPECT(!group->feasible(values));
+  EXPECT(assert_equal(Vector2(2.75, 0.0), (*group)(values)));
+  EXPECT(assert_equal(Vector2(27.5, 0.0),
+                      group->toleranceScaledViolation(values)));
+
+  // The factor is that of the grouped constraints, biased per constraint.
+  Vector bias = Vector2(0.5, -1.0);
+  Vector bias1 = Vector1(0.5), bias2 = Vector1(-1.0);
+  auto factor = group->createFactor(2.0, bias);
+  EXPECT_LONGS_EQUAL(2, factor->dim());
+  EXPECT_LONGS_EQUAL(2, factor->size());
+  const double expected =
+      constraints[0]->createFactor(2.0, bias1)->error(values) +
+      constraints[2]->createFactor(2.0, bias2)->error(values);
+  EXPECT_DOUBLES_EQUAL(expected, factor->error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+
+  // Factors on different keys are stacked with their key positions.
+  std::vector<NoiseModelFactor::shared_ptr> factors{
+      constraints[1]->createFactor(1.0), constraints[2]->createFactor(1.0)};
+  const StackedNoiseModelFactor stacked(factors);
+  EXPECT_LONGS_EQUAL(2, stacked.size());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(stacked, values, 1e-7, 1e-5);
+}
+
+// A factor as a constraint is the same as the constraint of its expression.
+TEST(EqualityConstraint, FactorEquality) {
+  auto g = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  auto factor = boost::make_shared<ExpressionFactor<double>>(
+      noiseModel::Isotropic::Sigma(1, 1e-3), 0.0, g);
+  const FactorEquality constraint(factor, 0.1);
+  const DoubleExpressionEquality expected(g, 0.1);
+
+  Values values1, values2;
+  values1.insert(x1_key, 0.0);
+  values1.insert(x2_key, 0.0);
+  values2.insert(x1_key, 1.0);
+  values2.insert(x2_key, 1.0);
+  EXPECT(constraint.feasible(values1));
+  EXPECT(!constraint.feasible(values2));
+  EXPECT(assert_equal(expected(values2), constraint(values2)));
+  EXPECT(assert_equal(expected.toleranceScaledViolation(values2),
+                      constraint.toleranceScaledViolation(values2)));
+  EXPECT_LONGS_EQUAL(1, constraint.dim());
+  EXPECT(constraint.keys() == expected.keys());
+
+  // The merit factor ignores the noise model of the factor.
+  Vector bias = Vector::Constant(1, 0.5);
+  auto merit_factor = constraint.createFactor(4.0, bias);
+  EXPECT(assert_equal(expected.createFactor(4.0, bias)->error(values2),
+                      merit_factor->error(values2)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*merit_factor, values1, 1e-7, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*merit_factor, values2, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(FactorEquality(factor, Vector2(0.1, 0.1)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(FactorEquality(factor, 0.0), std::invalid_argument);
+  CHECK_EXCEPTION(FactorEquality(nullptr, 0.1), std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testExecutor.cpp
+ * @brief Test the shared executor of the parallel loops.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtdynamics/utils/Parallel.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+
+// Nested loops run every index once, on no more threads than the executor.
+TEST(Executor, nested) {
+  SetExecutorThreads(3);
+  EXPECT_LONGS_EQUAL(3, ExecutorThreads());
+  std::vector<std::atomic<int>> counts(100);
+  for (auto &&count : counts) count = 0;
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  ParallelFor(10, 0, [&](size_t i) {
+    ParallelFor(10, 0, [&](size_t j) {
+      counts[10 * i + j]++;
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+  });
+  for (auto &&count : counts) EXPECT_LONGS_EQUAL(1, count);
+  EXPECT(threads.size() <= 3);
+  SetExecutorThreads(0);
+}
+
+// Exceptions are rethrown in the calling thread.
+TEST(Executor, exception) {
+  SetExecutorThreads(4);
+  CHECK_EXCEPTION(ParallelFor(50, 0,
+                              [](size_t i) {
+                                if (i == 17) throw std::runtime_error("17");
+                              }),
+                  std::runtime_error);
+  SetExecutorThreads(0);
+}
+
+// Tasks create symbols of the robot instance of the submitting thread.
+TEST(Executor, RobotScope) {
+  SetExecutorThreads(4);
+  std::vector<int> robots(50, -1);
+  {
+    DynamicsSymbol::RobotScope scope(3);
+    ParallelFor(robots.size(), 0, [&](size_t i) {
+      robots[i] = DynamicsSymbol::JointSymbol("q", 0, i).robotIdx();
+    });
+  }
+  for (int robot : robots) EXPECT_LONGS_EQUAL(3, robot);
+  EXPECT_LONGS_EQUAL(0, DynamicsSymbol::CurrentRobot());
+  SetExecutorThreads(0);
+}
+
+// Deterministic sums do not depend on the number of threads.
+TEST(ParallelReduce, deterministic) {
+  SetExecutorThreads(4);
+  auto map = [](size_t i) { return 1.0 / (1.0 + i); };
+  auto plus = [](const double &a, const double &b) { return a + b; };
+  const double serial =
+      ParallelReduce<double>(10000, 1, true, 0.0, map, plus);
+  for (size_t threads : {2, 3, 4}) {
+    EXPECT(serial == ParallelReduce<double>(10000, threads, true, 0.0, map,
+                                            plus));
+  }
+  EXPECT_DOUBLES_EQUAL(
+      serial, ParallelReduce<double>(10000, 4, false, 0.0, map, plus), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0,
+                       ParallelReduce<double>(0, 4, true, 0.0, map, plus), 0);
+  SetExecutorThreads(0);
+}
+
+// CPU lists as in /sys/devices/system/node.
+TEST(CpuTopology, ParseCpuList) {
+  const std::vector<int> expected{0, 1, 2, 3, 8, 10, 11};
+  EXPECT(expected == CpuTopology::ParseCpuList("0-3,8,10-11\n"));
+  EXPECT(CpuTopology::ParseCpuList("").empty());
+  EXPECT(!CpuTopology::Detect().nodes.empty());
+}
+
+// Workers are split evenly and pinned to the CPUs of their node.
+TEST(NumaAffinity, placement) {
+  CpuTopology topology;
+  topology.nodes = {{0, 1, 2, 3}, {4, 5, 6, 7}};
+  const NumaAffinity numa(topology), cores(topology, true);
+  EXPECT_LONGS_EQUAL(2, numa.numNodes());
+  EXPECT_LONGS_EQUAL(0, numa.node(2, 6));
+  EXPECT_LONGS_EQUAL(1, numa.node(3, 6));
+  EXPECT(topology.nodes[1] == numa.cpus(5, 6));
+  EXPECT(std::vector<int>{5} == cores.cpus(4, 6));
+  CHECK_EXCEPTION(NumaAffinity(CpuTopology()), std::invalid_argument);
+}
+
+// Tasks for a node run on its workers, and so do the loops they start.
+TEST(Executor, RunOnNode) {
+  CpuTopology topology;
+  topology.nodes = {{}, {}};  // placement only, no pinning
+  SetExecutorThreads(5, std::make_shared<NumaAffinity>(topology));
+  EXPECT_LONGS_EQUAL(2, ExecutorNodes());
+  const std::thread::id caller = std::this_thread::get_id();
+  for (size_t node = 0; node < 2; node++) {
+    std::atomic<int> count(0);
+    RunOnNode(node, [&]() {
+      EXPECT(std::this_thread::get_id() != caller);
+      ParallelFor(20, 0, [&](size_t) { count++; });
+    });
+    EXPECT_LONGS_EQUAL(20, count);
+  }
+  CHECK_EXCEPTION(RunOnNode(1, []() { throw std::runtime_error("node"); }),
+                  std::runtime_error);
+  SetExecutorThreads(0);
+  EXPECT_LONGS_EQUAL(1, ExecutorNodes());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorProfile.cpp
+ * @brief Test attributing factor costs to factor types.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <sstream>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// A chain of joint angles with a prior on the first.
+NonlinearFactorGraph graph(Values *init) {
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  init->insert(JointAngleKey(0, 0), 0.3);
+  for (int t = 1; t <= 4; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.1, model);
+    init->insert(JointAngleKey(0, t), 0.0);
+  }
+  return graph;
+}
+
+const std::string prior = "gtsam::PriorFactor<double>",
+                  between = "gtsam::BetweenFactor<double>";
+}  // namespace example
+
+// Wrapped factors behave as the original ones and record their calls.
+TEST(FactorProfile, ProfileFactors) {
+  Values init;
+  const NonlinearFactorGraph graph = example::graph(&init);
+  auto profile = std::make_shared<FactorProfile>();
+  const NonlinearFactorGraph profiled = ProfileFactors(graph, profile);
+  EXPECT_LONGS_EQUAL(graph.size(), profiled.size());
+  EXPECT_DOUBLES_EQUAL(graph.error(init), profiled.error(init), 1e-9);
+  EXPECT(assert_equal(*graph.linearize(init), *profiled.linearize(init)));
+
+  const auto statistics = profile->statistics();
+  EXPECT_LONGS_EQUAL(2, statistics.size());
+  EXPECT_LONGS_EQUAL(1, statistics.at(example::prior).num_factors);
+  EXPECT_LONGS_EQUAL(1, statistics.at(example::prior).error_calls);
+  EXPECT_LONGS_EQUAL(1, statistics.at(example::prior).linearize_calls);
+  EXPECT_LONGS_EQUAL(4, statistics.at(example::between).num_factors);
+  EXPECT_LONGS_EQUAL(4, statistics.at(example::between).error_calls);
+  EXPECT_LONGS_EQUAL(4, statistics.at(example::between).linearize_calls);
+
+  std::stringstream ss;
+  profile->saveJson(ss);
+  EXPECT(ss.str().find("\"type\":\"" + example::between + "\"") !=
+         std::string::npos);
+  EXPECT(ss.str().find("\"linearize_calls\":4") != std::string::npos);
+
+  profile->clear();
+  EXPECT(profile->statistics().empty());
+}
+
+// The Optimizer profiles its solves only when asked to.
+TEST(FactorProfile, Optimizer) {
+  Values init;
+  const NonlinearFactorGraph graph = example::graph(&init);
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+
+  OptimizationParameters parameters;
+  parameters.lm_parameters = gtsam::LevenbergMarquardtParams();
+  Optimizer optimizer(parameters);
+  EXPECT(assert_equal(expected, optimizer.optimize(graph, init), 1e-6));
+  EXPECT(optimizer.profile().statistics().empty());
+
+  parameters.profile_factors = true;
+  Optimizer profiling_optimizer(parameters);
+  EXPECT(assert_equal(expected, profiling_optimizer.optimize(graph, init),
+                      1e-6));
+  const auto statistics = profiling_optimizer.profile().statistics();
+  EXPECT_LONGS_EQUAL(2, statistics.size());
+  EXPECT(statistics.at(example::between).linearize_calls >= 4);
+  EXPECT(statistics.at(example::between).error_calls >= 8);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
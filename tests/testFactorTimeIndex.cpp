@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorTimeIndex.cpp
+ * @brief Test the time step index of trajectory factor graphs.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/FactorTimeIndex.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace gtdynamics;
+
+namespace example {
+// Indices of the factors with timed keys overlapping [k1, k2], by scanning.
+gtsam::FactorIndices Scan(const gtsam::NonlinearFactorGraph &graph,
+                          uint64_t k1, uint64_t k2) {
+  gtsam::FactorIndices indices;
+  for (size_t i = 0; i < graph.size(); i++) {
+    uint64_t first = DynamicsSymbol::kMaxTime, last = 0;
+    for (gtsam::Key key : graph[i]->keys()) {
+      if (DynamicsSymbol(key).label() == "dt") continue;
+      first = std::min(first, DynamicsSymbol::TimeOf(key));
+      last = std::max(last, DynamicsSymbol::TimeOf(key));
+    }
+    if (first <= k2 && last >= k1) indices.push_back(i);
+  }
+  return indices;
+}
+}  // namespace example
+
+TEST(FactorTimeIndex, TrajectoryFG) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8), boost::none);
+  FactorTimeIndex index;
+  const int num_steps = 4;
+  const auto graph =
+      graph_builder.trajectoryFG(robot, num_steps, 0.1, Trapezoidal,
+                                 boost::none, boost::none, &index);
+  EXPECT_LONGS_EQUAL(graph.size(), index.size());
+  EXPECT_LONGS_EQUAL(num_steps + 1, index.numSteps());
+  EXPECT(index.untimedFactors().empty());
+
+  for (auto window : {std::make_pair(0, 0), std::make_pair(1, 2),
+                      std::make_pair(4, 4), std::make_pair(2, 10)}) {
+    const auto expected = example::Scan(graph, window.first, window.second);
+    EXPECT(expected == index.factors(window.first, window.second));
+    EXPECT_LONGS_EQUAL(
+        expected.size(),
+        index.subgraph(graph, window.first, window.second).size());
+  }
+
+  // Variables of a window are those of its steps.
+  gtsam::KeySet expected_keys;
+  for (gtsam::Key key : graph.keys()) {
+    const uint64_t t = DynamicsSymbol::TimeOf(key);
+    if (t >= 1 && t <= 2) expected_keys.insert(key);
+  }
+  const auto keys = index.keys(1, 2);
+  EXPECT_LONGS_EQUAL(expected_keys.size(), keys.size());
+  EXPECT(expected_keys == gtsam::KeySet(keys));
+
+  // Building the index from the graph gives the same result.
+  EXPECT(FactorTimeIndex(graph).factors(1, 3) == index.factors(1, 3));
+
+  THROWS_EXCEPTION(index.factors(3, 2));
+  THROWS_EXCEPTION(index.subgraph(gtsam::NonlinearFactorGraph(), 0, 1));
+}
+
+TEST(FactorTimeIndex, Untimed) {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(PhaseKey(3), 0.1, model);
+  graph.push_back(gtsam::NonlinearFactor::shared_ptr());
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(JointAngleKey(0, 5),
+                                                     PhaseKey(3), 0.0, model);
+  FactorTimeIndex index(graph);
+  EXPECT_LONGS_EQUAL(3, index.size());
+  EXPECT(index.untimedFactors() == gtsam::FactorIndices{0});
+  EXPECT(index.factors(5, 5) == gtsam::FactorIndices{2});
+  EXPECT(index.factors(3, 3).empty());
+  EXPECT(index.keys(0, 10) == gtsam::KeyVector{JointAngleKey(0, 5)});
+
+  // Appended factors are numbered after the indexed ones.
+  gtsam::NonlinearFactorGraph more;
+  more.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, 6), JointAngleKey(0, 8), 0.0, model);
+  index.add(more);
+  EXPECT(index.factors(7, 7) == gtsam::FactorIndices{3});
+  EXPECT(index.factors(5, 6) == (gtsam::FactorIndices{2, 3}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testForwardKinematicsCache.cpp
+ * @brief Test incrementally updated link poses.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/ForwardKinematicsCache.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+const Pose3 root_pose(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                      gtsam::Point3(1, 2, 0.4));
+
+Vector JointAngles(double angle) {
+  Vector q(robot.numJoints());
+  for (size_t j = 0; j < robot.numJoints(); j++) {
+    q(j) = angle;
+    angle = -0.8 * angle + 0.1;
+  }
+  return q;
+}
+
+// Check all poses of the cache against Robot::forwardKinematics.
+bool CheckPoses(const ForwardKinematicsCache &cache, const Vector &q) {
+  const RobotTopology &topo = robot.topology();
+  const auto &root = topo.links[topo.root];
+  Values values;
+  for (size_t j = 0; j < robot.numJoints(); j++) {
+    InsertJointAngle(&values, robot.joints()[j]->id(), q(j));
+    InsertJointVel(&values, robot.joints()[j]->id(), 0.0);
+  }
+  InsertPose(&values, root->id(), root_pose);
+  const Values fk = robot.forwardKinematics(values, 0, root->name());
+  bool ok = true;
+  for (size_t i = 0; i < robot.numLinks(); i++) {
+    ok &= assert_equal(Pose(fk, topo.links[i]->id()), cache.pose(i), 1e-9);
+  }
+  return ok;
+}
+}  // namespace example
+
+// Poses agree with forward kinematics.
+TEST(ForwardKinematicsCache, vision60) {
+  using namespace example;
+  ForwardKinematicsCache cache(robot);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numLinks());
+  cache.setRootPose(root_pose);
+  for (double angle : {0.0, 0.3}) {
+    const Vector q = JointAngles(angle);
+    cache.setJointAngles(q);
+    EXPECT(CheckPoses(cache, q));
+  }
+
+  Values values;
+  cache.insertPoses(&values, 3);
+  EXPECT(assert_equal(cache.pose(2),
+                      Pose(values, robot.topology().links[2]->id(), 3)));
+}
+
+// Only the links below a changed joint are recomputed.
+TEST(ForwardKinematicsCache, incremental) {
+  using namespace example;
+  ForwardKinematicsCache cache(robot);
+  cache.setRootPose(root_pose);
+  cache.setJointAngles(JointAngles(0.3));
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numRecomputed());
+  cache.setJointAngles(JointAngles(0.3));
+  EXPECT_LONGS_EQUAL(0, cache.numRecomputed());
+
+  // The hip moves the upper and lower leg, the knee only the lower leg.
+  const RobotTopology &topo = robot.topology();
+  const int hip =
+      topo.joint_index[robot.link("upper0")->joints().front()->id()];
+  const int knee =
+      topo.joint_index[robot.link("lower0")->joints().front()->id()];
+  Vector q = JointAngles(0.3);
+  q(hip) = 0.7;
+  cache.setJointAngle(hip, q(hip));
+  EXPECT_LONGS_EQUAL(2, cache.numRecomputed());
+  q(knee) = -0.5;
+  cache.setJointAngles(q);
+  EXPECT_LONGS_EQUAL(1, cache.numRecomputed());
+  EXPECT(CheckPoses(cache, q));
+
+  // Moving the root moves everything.
+  cache.setRootPose(root_pose);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numRecomputed());
+
+  CHECK_EXCEPTION(cache.setJointAngle(robot.numJoints(), 0.0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(cache.setJointAngles(Vector::Zero(2)),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGaitSearch.cpp
+ * @brief Test solving and ranking candidate gait schedules in parallel.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/GaitSearch.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+
+namespace example {
+const gtsam::Key key = JointAngleKey(0);
+const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+
+// A candidate with one phase per length, without contacts.
+GaitCandidate candidate(const std::string &name,
+                        const std::vector<size_t> &phase_lengths) {
+  GaitCandidate candidate;
+  candidate.name = name;
+  for (size_t i = 0; i < phase_lengths.size(); i++) {
+    candidate.states.push_back(
+        boost::make_shared<FootContactConstraintSpec>());
+  }
+  candidate.phase_lengths = phase_lengths;
+  return candidate;
+}
+
+// Conflicting priors pulling the angle of joint 0 to 0 and to the number of
+// time steps, so longer cycles have a larger error, n^2/4 at the minimum.
+SweepProblem problem(const WalkCycle &walk_cycle) {
+  const double n = walk_cycle.numTimeSteps();
+  if (n > 100) throw std::runtime_error("too long");
+  SweepProblem problem;
+  problem.graph.emplace_shared<gtsam::PriorFactor<double>>(key, 0.0, model);
+  problem.graph.emplace_shared<gtsam::PriorFactor<double>>(key, n, model);
+  problem.initial_values.insert(key, 0.0);
+  return problem;
+}
+
+// A small initial lambda, so that one LM iteration solves the problems.
+OptimizationParameters parameters() {
+  OptimizationParameters parameters;
+  parameters.lm_parameters.setlambdaInitial(1e-5);
+  return parameters;
+}
+
+std::vector<GaitCandidate> candidates() {
+  return {candidate("long", {10, 10}), candidate("short", {1, 1}),
+          candidate("failing", {200}), candidate("medium", {2, 2}),
+          candidate("single", {1})};
+}
+}  // namespace example
+
+// Candidates are ranked by error, clearly worse ones pruned after screening.
+TEST(GaitSearch, run) {
+  const GaitSearch search(example::parameters(), 1, 5.0);
+  const std::vector<GaitResult> results =
+      search.run(example::candidates(), example::problem);
+  EXPECT_LONGS_EQUAL(5, results.size());
+
+  // Errors are 1/4, 1, 4 and 100 for 1, 2, 4 and 20 steps.
+  EXPECT(results[0].name == "single");
+  EXPECT_DOUBLES_EQUAL(0.25, results[0].error, 1e-6);
+  EXPECT(results[1].name == "short");
+  EXPECT(!results[1].pruned);
+  EXPECT(results[2].name == "medium");
+  EXPECT(results[2].pruned);
+  EXPECT(results[3].name == "long");
+  EXPECT(results[3].pruned);
+  EXPECT(results[3].solved);
+  EXPECT_DOUBLES_EQUAL(100, results[3].partial_error, 1e-6);
+  EXPECT(results[4].name == "failing");
+  EXPECT(!results[4].solved);
+  EXPECT(results[4].message == "too long");
+  EXPECT_LONGS_EQUAL(2, results[4].index);
+  EXPECT_DOUBLES_EQUAL(
+      10.0, results[3].values.at<double>(example::key), 1e-6);
+}
+
+// Without screening all candidates are solved to convergence.
+TEST(GaitSearch, noScreening) {
+  const GaitSearch search(example::parameters(), 0);
+  const std::vector<GaitResult> results =
+      search.run(example::candidates(), example::problem);
+  for (size_t r = 0; r < 4; r++) EXPECT(!results[r].pruned);
+  EXPECT(results[3].name == "long");
+  EXPECT_DOUBLES_EQUAL(100, results[3].error, 1e-6);
+}
+
+// At most max_survivors candidates are solved to convergence.
+TEST(GaitSearch, maxSurvivors) {
+  const GaitSearch search(example::parameters(), 1, 1e3, 1);
+  const std::vector<GaitResult> results =
+      search.run(example::candidates(), example::problem);
+  EXPECT(!results[0].pruned);
+  for (size_t r = 1; r < 4; r++) EXPECT(results[r].pruned);
+  CHECK_EXCEPTION(GaitSearch(OptimizationParameters(), 1, 0.5),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
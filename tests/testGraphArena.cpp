@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphArena.cpp
+ * @brief Test arena allocation of factors.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/GraphArena.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cstdint>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+// Allocations are aligned and counted, oversized ones get their own block.
+TEST(GraphArena, allocate) {
+  GraphArena arena(1024);
+  void *p = arena.allocate(3, 1);
+  void *q = arena.allocate(64, 32);
+  EXPECT(p != q);
+  EXPECT_LONGS_EQUAL(0, reinterpret_cast<uintptr_t>(q) % 32);
+  arena.allocate(4096, 16);
+
+  const ArenaStatistics statistics = arena.statistics();
+  EXPECT_LONGS_EQUAL(3, statistics.num_allocations);
+  EXPECT_LONGS_EQUAL(2, statistics.num_blocks);
+  EXPECT(statistics.bytes_allocated >= 3 + 64 + 4096);
+  EXPECT(statistics.bytes_reserved >= 1024 + 4096);
+}
+
+// MakeShared uses the arena of the innermost scope, and keeps it alive.
+TEST(GraphArena, MakeShared) {
+  auto arena = std::make_shared<GraphArena>();
+  std::weak_ptr<GraphArena> weak_arena = arena;
+  boost::shared_ptr<gtsam::Pose3> pose;
+  {
+    GraphArena::Scope scope(arena);
+    {
+      GraphArena::Scope null_scope(nullptr);
+      pose = MakeShared<gtsam::Pose3>(gtsam::Rot3::Rz(0.1),
+                                      gtsam::Point3(1, 2, 3));
+    }
+  }
+  EXPECT(GraphArena::Current() == nullptr);
+  EXPECT_LONGS_EQUAL(1, arena->statistics().num_allocations);
+
+  // Without a scope, objects come from the heap.
+  auto heap_pose = MakeShared<gtsam::Pose3>();
+  EXPECT_LONGS_EQUAL(1, arena->statistics().num_allocations);
+
+  arena.reset();
+  EXPECT(!weak_arena.expired());
+  EXPECT(assert_equal(gtsam::Point3(1, 2, 3), pose->translation()));
+  pose.reset();
+  EXPECT(weak_arena.expired());
+}
+
+// A graph built in an arena is the same as one built on the heap.
+TEST(GraphArena, DynamicsGraph) {
+  const Robot robot = simple_urdf::getRobot();
+  const int num_steps = 3;
+  const double dt = 0.1;
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  const auto expected = graph_builder.trajectoryFG(robot, num_steps, dt);
+
+  auto arena = std::make_shared<GraphArena>();
+  std::weak_ptr<GraphArena> weak_arena = arena;
+  graph_builder.setArena(arena);
+  auto actual = graph_builder.trajectoryFG(robot, num_steps, dt);
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+  EXPECT(arena->statistics().num_allocations >= actual.size());
+
+  Initializer initializer;
+  const auto values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+
+  // The graph keeps the arena alive after the builder lets go of it.
+  graph_builder.setArena(nullptr);
+  arena.reset();
+  EXPECT(!weak_arena.expired());
+  actual = gtsam::NonlinearFactorGraph();
+  EXPECT(weak_arena.expired());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphTemplate.cpp
+ * @brief Test instantiating one time slice at other time steps.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+TEST(DynamicsSymbol, atTime) {
+  DynamicsSymbol symbol = DynamicsSymbol::LinkJointSymbol("p", 2, 3, 7);
+  DynamicsSymbol moved = symbol.atTime(11);
+  EXPECT_LONGS_EQUAL(11, moved.time());
+  EXPECT(symbol.label() == moved.label());
+  EXPECT_LONGS_EQUAL(symbol.linkIdx(), moved.linkIdx());
+  EXPECT_LONGS_EQUAL(symbol.jointIdx(), moved.jointIdx());
+}
+
+TEST(GraphTemplate, instantiate) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8), boost::none);
+
+  const int t0 = 0, t = 3;
+  GraphTemplate slice(graph_builder.dynamicsFactorGraph(robot, t0), t0);
+  auto rekeyed = slice.instantiate(t);
+  auto expected = graph_builder.dynamicsFactorGraph(robot, t);
+  EXPECT_LONGS_EQUAL(expected.size(), rekeyed.size());
+  EXPECT_LONGS_EQUAL(expected.size(), slice.size());
+
+  // Same keys, errors and linearizations as building at t directly.
+  auto values = Initializer().ZeroValues(robot, t, 0.1);
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT(expected[i]->keys() == rekeyed[i]->keys());
+  }
+  EXPECT_DOUBLES_EQUAL(expected.error(values), rekeyed.error(values), 1e-9);
+  EXPECT(assert_equal(*expected.linearize(values), *rekeyed.linearize(values),
+                      1e-9));
+
+  // Instantiating at the template time returns the template factors.
+  auto original = slice.instantiate(t0);
+  auto same = slice.instantiate(t0);
+  for (size_t i = 0; i < same.size(); i++) {
+    EXPECT(same[i] == original[i]);
+    EXPECT(!boost::dynamic_pointer_cast<RekeyedFactor>(same[i]));
+  }
+}
+
+// Analytic factors are rekeyed clones, expression factors are wrapped, and
+// keys that are not DynamicsSymbols are left unchanged.
+TEST(GraphTemplate, RekeyFactor) {
+  const gtsam::Key x = gtsam::Symbol('x', 0);
+  EXPECT(DynamicsSymbol::IsDynamicsSymbol(JointAngleKey(0, 0)));
+  EXPECT(DynamicsSymbol::IsDynamicsSymbol(PhaseKey(0)));
+  EXPECT(!DynamicsSymbol::IsDynamicsSymbol(x));
+  EXPECT(!DynamicsSymbol::IsDynamicsSymbol(0));
+
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(JointAngleKey(0, 0), x,
+                                                     1.0, model);
+  const gtsam::Double_ q(JointAngleKey(0, 0)), v(JointVelKey(0, 0));
+  graph.emplace_shared<gtsam::ExpressionFactor<double>>(model, 0.0, q - v);
+
+  const auto rekeyed = GraphTemplate(graph, 0).instantiate(2);
+  EXPECT(!boost::dynamic_pointer_cast<RekeyedFactor>(rekeyed[0]));
+  EXPECT(rekeyed[0]->keys() == gtsam::KeyVector({JointAngleKey(0, 2), x}));
+  EXPECT(boost::dynamic_pointer_cast<RekeyedFactor>(rekeyed[1]));
+
+  gtsam::Values values;
+  values.insert(JointAngleKey(0, 2), 3.0);
+  values.insert(JointVelKey(0, 2), 2.5);
+  values.insert(x, 1.0);
+  EXPECT_DOUBLES_EQUAL(0.5 * 9.0, rekeyed[0]->error(values), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5 * 0.25, rekeyed[1]->error(values), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testHessianAssembly.cpp
+ * @brief Test linearization into per-time-step normal equations.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/HessianAssembly.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const int num_steps = 10;
+
+// Forward dynamics of a single joint under constant torque.
+gtsam::NonlinearFactorGraph Graph() {
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  return graph;
+}
+}  // namespace example
+
+// The assembled normal equations are those of the Jacobian factors.
+TEST(HessianAssembly, linearize) {
+  using namespace example;
+  auto graph = Graph();
+  const size_t num_factors = graph.size();
+  // A robust factor is linearized on its own.
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      JointAngleKey(j, num_steps), 1.0,
+      gtsam::noiseModel::Robust::Create(
+          gtsam::noiseModel::mEstimator::Huber::Create(0.1),
+          gtsam::noiseModel::Isotropic::Sigma(1, 0.1)));
+  graph.push_back(gtsam::NonlinearFactor::shared_ptr());
+  Initializer initializer;
+  const auto values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+
+  const HessianAssembly assembly(graph);
+  EXPECT_LONGS_EQUAL(num_steps + 1, assembly.groups().size());
+  EXPECT_LONGS_EQUAL(1, assembly.otherFactors().size());
+  EXPECT_LONGS_EQUAL(num_factors, assembly.otherFactors()[0]);
+  size_t num_assembled = 0;
+  for (auto &&group : assembly.groups()) {
+    num_assembled += group.factors.size();
+  }
+  EXPECT_LONGS_EQUAL(num_factors, num_assembled);
+
+  const auto expected = graph.linearize(values);
+  const auto linear = assembly.linearize(graph, values);
+  EXPECT_LONGS_EQUAL(num_steps + 2, linear->size());
+  EXPECT(assert_equal(expected->augmentedHessian(),
+                      linear->augmentedHessian(), 1e-9));
+  EXPECT(assert_equal(expected->augmentedHessian(),
+                      assembly.linearize(graph, values, 4)->augmentedHessian(),
+                      1e-9));
+
+  // With no factors small enough, all are linearized on their own.
+  EXPECT_LONGS_EQUAL(0, HessianAssembly(graph, 0).groups().size());
+
+  CHECK_EXCEPTION(assembly.linearize(Graph(), values), std::invalid_argument);
+}
+
+// LM with assembled normal equations converges to the same trajectory.
+TEST(HessianAssembly, Optimizer) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters params;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.hessian_linearization = true;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init),
+                      1e-6));
+  params.linearization_threads = size_t(2);
+  params.riccati_solver = true;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init),
+                      1e-5));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
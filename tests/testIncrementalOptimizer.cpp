@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIncrementalOptimizer.cpp
+ * @brief Test iSAM2-based receding-horizon optimizer.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/IncrementalOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const auto prior_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+const auto step_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+
+// Joint angle increases by 0.1 rad per step, and its sine is measured.
+NonlinearFactorGraph slice(int t) {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.1, step_model);
+  return graph;
+}
+}  // namespace example
+
+// Batch problem through the Optimizer interface.
+TEST(IncrementalOptimizer, Method) {
+  using namespace example;
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, prior_model);
+  Values init;
+  init.insert(JointAngleKey(0, 0), 0.3);
+  for (int t = 1; t <= 4; t++) {
+    graph.add(slice(t));
+    init.insert(JointAngleKey(0, t), 0.0);
+  }
+
+  OptimizationParameters params;
+  params.method = OptimizationParameters::Method::INCREMENTAL;
+  Optimizer optimizer(params);
+  Values result = optimizer.optimize(graph, init);
+  Values expected = gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+  EXPECT(assert_equal(expected, result, 1e-6));
+}
+
+// Shift a window of 3 steps along the trajectory.
+TEST(IncrementalOptimizer, RecedingHorizon) {
+  using namespace example;
+  OptimizationParameters params;
+  IncrementalOptimizer optimizer(params);
+
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, prior_model);
+  Values init;
+  init.insert(JointAngleKey(0, 0), 0.0);
+  for (int t = 1; t <= 2; t++) {
+    graph.add(slice(t));
+    init.insert(JointAngleKey(0, t), 0.0);
+  }
+  Values result = optimizer.update(graph, init);
+  EXPECT_LONGS_EQUAL(3, result.size());
+
+  for (int t = 3; t <= 6; t++) {
+    Values new_values;
+    new_values.insert(JointAngleKey(0, t), JointAngle(result, 0, t - 1));
+    result = optimizer.update(slice(t), new_values, t - 2);
+    EXPECT_LONGS_EQUAL(3, result.size());
+    EXPECT(!result.exists(JointAngleKey(0, t - 3)));
+    EXPECT_DOUBLES_EQUAL(0.1 * t, JointAngle(result, 0, t), 1e-6);
+  }
+}
+
+// A cancelled update still adds the new slice, but skips the extra updates;
+// the problem is linear, so one update solves it.
+TEST(IncrementalOptimizer, Cancelled) {
+  using namespace example;
+  OptimizationParameters params;
+  params.cancellation = std::make_shared<CancellationToken>();
+  params.cancellation->cancel();
+  IncrementalOptimizer optimizer(params);
+
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, prior_model);
+  graph.add(slice(1));
+  Values init;
+  init.insert(JointAngleKey(0, 0), 0.0);
+  init.insert(JointAngleKey(0, 1), 0.0);
+  Values result = optimizer.update(graph, init);
+  EXPECT_DOUBLES_EQUAL(0.1, JointAngle(result, 0, 1), 1e-6);
+
+  Values new_values;
+  new_values.insert(JointAngleKey(0, 2), 0.0);
+  result = optimizer.update(slice(2), new_values, 1);
+  EXPECT_LONGS_EQUAL(2, result.size());
+  EXPECT_DOUBLES_EQUAL(0.2, JointAngle(result, 0, 2), 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInequalityConstraint.cpp
+ * @brief Test inequality constraints and their augmented Lagrangian solution.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::pow;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::x1_key, constrained_example::x2_key;
+
+// Test methods of DoubleExpressionInequality.
+TEST(InequalityConstraint, DoubleExpressionInequality) {
+  // g(x1, x2) = 1 - x1^2 - x2^2 >= 0, inside the unit circle.
+  auto g = Double_(1.0) - pow(x1, 2) - pow(x2, 2);
+  const double tolerance = 0.1;
+  DoubleExpressionInequality constraint(g, tolerance);
+  EXPECT_LONGS_EQUAL(1, constraint.dim());
+  EXPECT_LONGS_EQUAL(2, constraint.keys().size());
+
+  Values values1, values2;
+  values1.insert(x1_key, 0.0);
+  values1.insert(x2_key, 0.0);
+  values2.insert(x1_key, 1.0);
+  values2.insert(x2_key, 1.0);
+
+  // Satisfied inside, with zero violation and zero merit error.
+  EXPECT(constraint.feasible(values1));
+  EXPECT(assert_equal(Vector1(1.0), constraint(values1)));
+  EXPECT(assert_equal(Vector1(0.0),
+                      constraint.toleranceScaledViolation(values1)));
+  auto factor = constraint.createFactor(4.0);
+  EXPECT_DOUBLES_EQUAL(0.0, factor->error(values1), 1e-9);
+
+  // Violated outside, g = -1.
+  EXPECT(!constraint.feasible(values2));
+  EXPECT(assert_equal(Vector1(-1.0), constraint(values2)));
+  EXPECT(assert_equal(Vector1(10.0),
+                      constraint.toleranceScaledViolation(values2)));
+
+  // Error is 0.5 * mu * (bias - g)^2 / tolerance^2 when active.
+  Vector bias = Vector1(0.5);
+  auto biased = constraint.createFactor(4.0, bias);
+  EXPECT_DOUBLES_EQUAL(0.5 * 4.0 * 1.5 * 1.5 / 0.01, biased->error(values2),
+                       1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*biased, values2, 1e-7, 1e-5);
+}
+
+// Inactive and active bounds on a simple quadratic problem.
+TEST(InequalityConstraint, AugmentedLagrangian) {
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 2.0, x1));
+  graph.add(ExpressionFactor<double>(cost_noise, 2.0, x2));
+
+  // x1 <= 1 is active, x2 >= 0 is not.
+  InequalityConstraints inequalities;
+  inequalities.emplace_shared<DoubleExpressionInequality>(Double_(1.0) - x1,
+                                                          1e-4);
+  inequalities.emplace_shared<DoubleExpressionInequality>(x2, 1e-4);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.0);
+  init_values.insert(x2_key, 0.0);
+
+  AugmentedLagrangianParameters params;
+  params.num_iterations = 20;
+  AugmentedLagrangianOptimizer optimizer(params);
+  AugmentedLagrangianState state;
+  Values results = optimizer.optimize(graph, EqualityConstraints(),
+                                      inequalities, init_values, &state);
+
+  Values expected;
+  expected.insert(x1_key, 1.0);
+  expected.insert(x2_key, 2.0);
+  EXPECT(assert_equal(expected, results, 1e-3));
+
+  // Only the active bound has a positive multiplier.
+  EXPECT(state.multiplier(*inequalities[0], 0)(0) > 0);
+  EXPECT(assert_equal(Vector1(0.0), state.multiplier(*inequalities[1], 0)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
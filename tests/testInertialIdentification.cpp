@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInertialIdentification.cpp
+ * @brief Test the inertial regressor and least squares identification.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+Robot fixedA1() {
+  return CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"))
+      .fixLink("trunk");
+}
+
+// Joint angles, velocities and accelerations of sample k, in joint order.
+void sample(size_t num_joints, int k, Vector* q, Vector* v, Vector* a) {
+  *q = Vector(num_joints), *v = Vector(num_joints), *a = Vector(num_joints);
+  for (size_t j = 0; j < num_joints; j++) {
+    const double s = 0.37 * k + 1.3 * j;
+    (*q)(j) = 0.8 * std::sin(s);
+    (*v)(j) = 1.5 * std::cos(1.7 * s);
+    (*a)(j) = 3.0 * std::sin(2.3 * s + 0.4);
+  }
+}
+}  // namespace
+
+// The regressor times the parameters of the robot gives the RNEA torques.
+TEST(InertialRegressor, a1) {
+  auto robot = fixedA1();
+  InertialRegressor regressor(robot, kGravity);
+  NewtonEulerInverseDynamics rnea(robot, kGravity);
+  const Vector pi = regressor.parameters();
+  EXPECT_LONGS_EQUAL(10 * robot.numLinks(), regressor.numParameters());
+
+  Vector q, v, a;
+  sample(robot.numJoints(), 3, &q, &v, &a);
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id(), idx = regressor.jointIndex(j);
+    InsertJointAngle(&values, j, q(idx));
+    InsertJointVel(&values, j, v(idx));
+  }
+  Values known_values = robot.forwardKinematics(values);
+  for (auto&& joint : robot.joints()) {
+    InsertJointAccel(&known_values, joint->id(),
+                     a(regressor.jointIndex(joint->id())));
+  }
+  Values expected = rnea.solve(0, known_values);
+
+  const gtsam::Matrix& Y = regressor.compute(known_values);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    const double torque = Y.row(regressor.jointIndex(j)).dot(pi);
+    EXPECT_DOUBLES_EQUAL(Torque(expected, j), torque, 1e-9);
+  }
+
+  // The columns of the fixed trunk are zero.
+  const int root = regressor.linkIndex(robot.link("trunk")->id());
+  EXPECT(assert_equal(gtsam::Matrix::Zero(Y.rows(), 10).eval(),
+                      Y.middleCols(10 * root, 10).eval()));
+}
+
+// Parameters of a link round-trip through its physical quantities.
+TEST(InertialRegressor, Inertia) {
+  auto link = fixedA1().link("FR_upper");
+  InertialRegressor::LinkParameters pi = InertialRegressor::Parameters(*link);
+  EXPECT(assert_equal(link->inertiaMatrix(),
+                      InertialRegressor::SpatialInertia(pi)));
+
+  // Shift the center of mass by c, so I_o = I_c - m [c]^2.
+  const gtsam::Point3 c(0.01, -0.02, 0.03);
+  const gtsam::Matrix3 C = gtsam::skewSymmetric(c.x(), c.y(), c.z());
+  const gtsam::Matrix3 I_o = link->inertia() - link->mass() * C * C;
+  pi.segment<3>(1) = link->mass() * c;
+  pi.tail<6>() << I_o(0, 0), I_o(0, 1), I_o(0, 2), I_o(1, 1), I_o(1, 2),
+      I_o(2, 2);
+  double mass;
+  gtsam::Point3 com;
+  gtsam::Matrix3 inertia;
+  InertialRegressor::Inertia(pi, &mass, &com, &inertia);
+  EXPECT_DOUBLES_EQUAL(link->mass(), mass, 1e-12);
+  EXPECT(assert_equal(c, com, 1e-12));
+  EXPECT(assert_equal(link->inertia(), inertia, 1e-12));
+}
+
+// Identification recovers the torques of perturbed parameters.
+TEST(InertialLeastSquares, a1) {
+  auto robot = fixedA1();
+  InertialRegressor regressor(robot, kGravity);
+  const Vector prior = regressor.parameters();
+  Vector truth = prior;
+  for (size_t i = 0; i < regressor.numLinks(); i++) {
+    truth(10 * i) *= 1.2;
+    truth(10 * i + 2) += 0.01 * truth(10 * i);
+  }
+
+  // Accumulate in two parts, as if filled in parallel.
+  InertialLeastSquares first(regressor.numParameters()),
+      second(regressor.numParameters());
+  Vector q, v, a;
+  for (int k = 0; k < 200; k++) {
+    sample(robot.numJoints(), k, &q, &v, &a);
+    const gtsam::Matrix& Y = regressor.compute(q, v, a);
+    (k % 2 ? first : second).add(Y, Y * truth);
+  }
+  EXPECT_DOUBLES_EQUAL(0.0, first.error(truth), 1e-6);
+  first.merge(second);
+  EXPECT_LONGS_EQUAL(200, first.numSamples());
+  EXPECT(first.error(prior) > 1e-3);
+
+  // Rigid-body dynamics only determines some parameter combinations, so
+  // compare torques at a new sample rather than the parameters.
+  const Vector estimate = first.solve(prior, 1e-9);
+  EXPECT(first.error(estimate) < 1e-6);
+  sample(robot.numJoints(), 1000, &q, &v, &a);
+  const gtsam::Matrix& Y = regressor.compute(q, v, a);
+  EXPECT(assert_equal(Vector(Y * truth), Vector(Y * estimate), 1e-5));
+
+  CHECK_EXCEPTION(first.solve(prior, 0), std::invalid_argument);
+}
+
+// Floating-base robots are rejected.
+TEST(InertialRegressor, floating_base) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  CHECK_EXCEPTION(InertialRegressor regressor(robot), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -202,6 +202,73 @@ TEST(InitializeSolutionUtils, InverseKinematics) {
   EXPECT(assert_equal(0.0, pose.translation().z(), 1e-3));
 }
 
+// Noisy initial values do not depend on the number of threads.
+TEST(InitializeSolutionUtils, InterpolationThreads) {
+  Robot robot = simple_rr::getRobot();
+  Pose3 wTb_i, wTb_f(Rot3::Rz(M_PI / 4), Point3(1, 1, 1));
+
+  Initializer serial, parallel(4);
+  EXPECT_LONGS_EQUAL(4, parallel.numThreads());
+  gtsam::Values expected = serial.InitializeSolutionInterpolation(
+      robot, "link_0", wTb_i, wTb_f, 0, 10, 1, 0.1);
+  gtsam::Values actual = parallel.InitializeSolutionInterpolation(
+      robot, "link_0", wTb_i, wTb_f, 0, 10, 1, 0.1);
+  EXPECT(assert_equal(expected, actual));
+}
+
+// Inverse kinematics solved in parallel segments still respects the contacts.
+TEST(InitializeSolutionUtils, InverseKinematicsThreads) {
+  auto robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+
+  Pose3 wTb_i = l2->bMcom();
+  std::vector<Pose3> wTb_t = {Pose3(Rot3(), Point3(1, 0, 2.5))};
+  std::vector<double> ts = {10};
+  Pose3 oTc_l1(Rot3(), Point3(0, 0, -1.0));
+  PointOnLinks contact_points = {{l1, oTc_l1.translation()}};
+
+  Initializer initializer(3);
+  gtsam::Values init_vals = initializer.InitializeSolutionInverseKinematics(
+      robot, l2->name(), wTb_i, wTb_t, ts, 1, kNoiseSigma, contact_points);
+
+  for (size_t t = 0; t <= 10; t++) {
+    Pose3 pose = Pose(init_vals, l1->id(), t) * oTc_l1;
+    EXPECT(assert_equal(0.0, pose.translation().z(), 1e-3));
+    EXPECT(init_vals.exists(TorqueKey(robot.joint("j1")->id(), t)));
+  }
+  EXPECT(assert_equal(wTb_t[0], Pose(init_vals, l2->id(), 10), 1e-3));
+}
+
+// In deterministic mode inverse kinematics is the same for any number of
+// threads, and the seed changes the noise.
+TEST(InitializeSolutionUtils, Deterministic) {
+  auto robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+  std::vector<Pose3> wTb_t = {Pose3(Rot3(), Point3(1, 0, 2.5))};
+  std::vector<double> ts = {10};
+  PointOnLinks contact_points = {{l1, Point3(0, 0, -1.0)}};
+
+  Initializer serial(1, true), parallel(4, true);
+  EXPECT(parallel.deterministic());
+  gtsam::Values expected = serial.InitializeSolutionInverseKinematics(
+      robot, l2->name(), l2->bMcom(), wTb_t, ts, 1, kNoiseSigma,
+      contact_points);
+  gtsam::Values actual = parallel.InitializeSolutionInverseKinematics(
+      robot, l2->name(), l2->bMcom(), wTb_t, ts, 1, kNoiseSigma,
+      contact_points);
+  EXPECT(assert_equal(expected, actual, 0.0));
+
+  Initializer seeded(1, true, 7);
+  EXPECT_LONGS_EQUAL(7, seeded.seed());
+  const int j = robot.joints()[0]->id();
+  EXPECT(JointAngle(serial.ZeroValues(robot, 0, 0.1), j, 0) !=
+         JointAngle(seeded.ZeroValues(robot, 0, 0.1), j, 0));
+}
+
 TEST(InitializeSolutionUtils, ZeroValues) {
   auto robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIntegration.cpp
+ * @brief Test integration schemes on a harmonic oscillator.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+
+namespace example {
+// Two uncoupled unit oscillators per row, q'' = -q, with an extra damping
+// term -0.1 v on the second.
+Matrix accelerations(const Matrix &q, const Matrix &v) {
+  Matrix a = -q;
+  a.col(1) -= 0.1 * v.col(1);
+  return a;
+}
+
+// Batch of two states.
+Matrix q0() { return (Matrix(2, 2) << 1, 0.5, -0.3, 0.2).finished(); }
+Matrix v0() { return (Matrix(2, 2) << 0, 0.4, 0.7, -0.1).finished(); }
+}  // namespace example
+
+TEST(Integrate, ExplicitSchemes) {
+  const double dt = 0.1;
+  const Matrix q0 = example::q0(), v0 = example::v0();
+  const Matrix a0 = example::accelerations(q0, v0);
+
+  Matrix q = q0, v = v0;
+  Integrate(IntegrationScheme::ExplicitTaylor, example::accelerations, dt, a0,
+            &q, &v);
+  EXPECT(assert_equal(Matrix(q0 + dt * v0 + 0.5 * dt * dt * a0), q));
+  EXPECT(assert_equal(Matrix(v0 + dt * a0), v));
+
+  q = q0, v = v0;
+  Integrate(IntegrationScheme::SemiImplicitEuler, example::accelerations, dt,
+            a0, &q, &v);
+  EXPECT(assert_equal(Matrix(v0 + dt * a0), v));
+  EXPECT(assert_equal(Matrix(q0 + dt * v), q));
+}
+
+// For linear dynamics the Newton step of implicit Euler is exact.
+TEST(Integrate, ImplicitEuler) {
+  const double dt = 0.5;
+  const Matrix q0 = example::q0(), v0 = example::v0();
+  Matrix q = q0, v = v0;
+  Integrate(IntegrationScheme::ImplicitEuler, example::accelerations, dt,
+            example::accelerations(q0, v0), &q, &v);
+  EXPECT(assert_equal(Matrix(q0 + dt * v), q, 1e-9));
+  EXPECT(assert_equal(Matrix(v0 + dt * example::accelerations(q, v)), v,
+                      1e-5));
+}
+
+// RK4 follows the undamped oscillator closely with a large step.
+TEST(Integrate, RK4) {
+  const double dt = 0.1;
+  Matrix q = example::q0(), v = example::v0();
+  for (int k = 0; k < 10; k++) {
+    Integrate(IntegrationScheme::RK4, example::accelerations, dt,
+              example::accelerations(q, v), &q, &v);
+  }
+  // q(t) = q0 cos(t) + v0 sin(t) for the first column.
+  const Matrix q0 = example::q0(), v0 = example::v0();
+  for (int r = 0; r < 2; r++) {
+    EXPECT_DOUBLES_EQUAL(q0(r, 0) * std::cos(1.0) + v0(r, 0) * std::sin(1.0),
+                         q(r, 0), 1e-5);
+    EXPECT_DOUBLES_EQUAL(-q0(r, 0) * std::sin(1.0) + v0(r, 0) * std::cos(1.0),
+                         v(r, 0), 1e-5);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIntermediateValuesLog.cpp
+ * @brief Test streaming intermediate values to trajectory logs.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/IntermediateValuesLog.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace example {
+const std::string prefix = "testIntermediateValuesLog";
+
+// Iterates of a trajectory where only joint 0 keeps moving.
+std::vector<Values> iterates() {
+  std::vector<Values> result;
+  for (int i = 0; i < 3; i++) {
+    Values values;
+    for (int t = 0; t < 4; t++) {
+      InsertJointAngle(&values, 0, t, 0.1 * t + i);
+      InsertJointAngle(&values, 1, t, i == 0 ? 0.0 : 1.0 + 1e-9 * i);
+    }
+    result.push_back(values);
+  }
+  return result;
+}
+
+void cleanup() {
+  for (size_t i = 0; i < 3; i++) {
+    std::remove(IntermediateValuesLog::Path(prefix, i).c_str());
+  }
+}
+}  // namespace example
+
+// Full iterates read back the same.
+TEST(IntermediateValuesLog, Full) {
+  const auto iterates = example::iterates();
+  IntermediateValuesLog log(example::prefix);
+  for (size_t i = 0; i < iterates.size(); i++) log(i, iterates[i]);
+  for (size_t i = 0; i < iterates.size(); i++) {
+    EXPECT(assert_equal(iterates[i],
+                        IntermediateValuesLog::Read(example::prefix, i)));
+  }
+  example::cleanup();
+}
+
+// Diffs skip unchanged variables and are layered when read.
+TEST(IntermediateValuesLog, Diffs) {
+  const auto iterates = example::iterates();
+  IntermediateValuesLog log(example::prefix, true, 1e-6);
+  for (size_t i = 0; i < iterates.size(); i++) log(i, iterates[i]);
+
+  // Joint 1 did not move from iteration 1 to 2.
+  const Values third =
+      TrajectoryLog(IntermediateValuesLog::Path(example::prefix, 2)).values();
+  EXPECT_LONGS_EQUAL(4, third.size());
+  for (size_t i = 0; i < iterates.size(); i++) {
+    EXPECT(assert_equal(iterates[i],
+                        IntermediateValuesLog::Read(example::prefix, i, true),
+                        1e-6));
+  }
+  example::cleanup();
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
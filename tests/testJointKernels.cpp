@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointKernels.cpp
+ * @brief Test joint kinematics specialized per joint type.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/JointKernels.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace example {
+const auto robot = simple_urdf::getRobot();
+const auto l1 = robot.link("l1"), l2 = robot.link("l2");
+const Pose3 bTj(Rot3::Ypr(0.3, -0.2, 0.1), Point3(0.1, 0.2, 2));
+const Vector3 axis = Vector3(1, 2, -0.5).normalized();
+const Vector6 twist = (Vector6() << 1, -2, 3, 0.5, 1, -1).finished();
+}  // namespace example
+
+/// Check the kernels for JOINT against the generic ones and numerically.
+template <class JOINT>
+bool CheckKernels(const Joint &joint) {
+  const double q = 0.7, q_dot = -1.3;
+  const Vector6 &V = example::twist;
+  bool ok = true;
+
+  // Poses.
+  gtsam::Matrix61 H_q, expected_H_q;
+  ok &= assert_equal(ParentTchild<Joint>(joint, q, expected_H_q),
+                     ParentTchild<JOINT>(joint, q, H_q), 1e-9);
+  ok &= assert_equal(expected_H_q, H_q, 1e-9);
+  auto pTc = [&](const double &q) { return ParentTchild<JOINT>(joint, q); };
+  ok &= assert_equal(gtsam::numericalDerivative11<Pose3, double>(pTc, q),
+                     Matrix(H_q), 1e-7);
+  auto cTp = [&](const double &q) { return ChildTparent<JOINT>(joint, q); };
+  ok &= assert_equal(ParentTchild<JOINT>(joint, q).inverse(),
+                     ChildTparent<JOINT>(joint, q, H_q), 1e-9);
+  ok &= assert_equal(gtsam::numericalDerivative11<Pose3, double>(cTp, q),
+                     Matrix(H_q), 1e-7);
+
+  // Twists and wrenches, in both directions.
+  for (auto &&link : {example::l1, example::l2}) {
+    gtsam::Matrix61 H_q_dot;
+    gtsam::Matrix6 H_V;
+    const Vector6 twist =
+        TransformTwistTo<JOINT>(joint, link, q, q_dot, V, H_q, H_q_dot, H_V);
+    ok &= assert_equal(TransformTwistTo<Joint>(joint, link, q, q_dot, V),
+                       twist, 1e-9);
+    auto f_twist = [&](const double &q, const double &q_dot,
+                       const Vector6 &V) {
+      return TransformTwistTo<JOINT>(joint, link, q, q_dot, V);
+    };
+    ok &= assert_equal(
+        gtsam::numericalDerivative31<Vector6, double, double, Vector6>(
+            f_twist, q, q_dot, V),
+        Matrix(H_q), 1e-7);
+    ok &= assert_equal(
+        gtsam::numericalDerivative32<Vector6, double, double, Vector6>(
+            f_twist, q, q_dot, V),
+        Matrix(H_q_dot), 1e-7);
+    ok &= assert_equal(
+        gtsam::numericalDerivative33<Vector6, double, double, Vector6>(
+            f_twist, q, q_dot, V),
+        Matrix(H_V), 1e-7);
+
+    const Vector6 wrench =
+        TransformWrenchCoordinate<JOINT>(joint, link, q, V, H_q, H_V);
+    ok &= assert_equal(TransformWrenchCoordinate<Joint>(joint, link, q, V),
+                       wrench, 1e-9);
+    auto f_wrench = [&](const double &q, const Vector6 &F) {
+      return TransformWrenchCoordinate<JOINT>(joint, link, q, F);
+    };
+    ok &= assert_equal(
+        gtsam::numericalDerivative21<Vector6, double, Vector6>(f_wrench, q, V),
+        Matrix(H_q), 1e-7);
+    ok &= assert_equal(
+        gtsam::numericalDerivative22<Vector6, double, Vector6>(f_wrench, q, V),
+        Matrix(H_V), 1e-7);
+  }
+
+  // Batched kernels.
+  const Eigen::ArrayXd qs = Eigen::ArrayXd::LinSpaced(3, -1.0, q);
+  const Eigen::ArrayXd q_dots = Eigen::ArrayXd::Constant(3, q_dot);
+  const TwistBatch Vs = V.transpose().replicate(3, 1);
+  const PoseBatch pTcs = ParentTchildBatch(joint, qs);
+  const PoseBatch cTps = ChildTparentBatch(joint, qs);
+  for (int n = 0; n < qs.size(); n++) {
+    ok &= assert_equal(ParentTchild<JOINT>(joint, qs(n)), BatchPose(pTcs, n),
+                       1e-9);
+    ok &= assert_equal(ChildTparent<JOINT>(joint, qs(n)), BatchPose(cTps, n),
+                       1e-9);
+  }
+  for (auto &&link : {example::l1, example::l2}) {
+    const TwistBatch twists =
+        TransformTwistToBatch(joint, link, qs, q_dots, Vs);
+    const TwistBatch wrenches =
+        TransformWrenchCoordinateBatch(joint, link, qs, Vs);
+    for (int n = 0; n < qs.size(); n++) {
+      ok &= assert_equal(
+          TransformTwistTo<JOINT>(joint, link, qs(n), q_dot, V),
+          Vector6(twists.row(n).transpose()), 1e-9);
+      ok &= assert_equal(
+          TransformWrenchCoordinate<JOINT>(joint, link, qs(n), V),
+          Vector6(wrenches.row(n).transpose()), 1e-9);
+    }
+  }
+  return ok;
+}
+
+TEST(JointKernels, Revolute) {
+  RevoluteJoint joint(1, "j1", example::bTj, example::l1, example::l2,
+                      example::axis);
+  EXPECT(CheckKernels<RevoluteJoint>(joint));
+}
+
+TEST(JointKernels, Prismatic) {
+  PrismaticJoint joint(1, "j1", example::bTj, example::l1, example::l2,
+                       example::axis);
+  EXPECT(CheckKernels<PrismaticJoint>(joint));
+}
+
+TEST(JointKernels, Helical) {
+  HelicalJoint joint(1, "j1", example::bTj, example::l1, example::l2,
+                     example::axis, 0.5);
+  EXPECT(CheckKernels<HelicalJoint>(joint));
+}
+
+TEST(JointKernels, Fixed) {
+  FixedJoint joint(1, "j1", example::bTj, example::l1, example::l2);
+  EXPECT(CheckKernels<FixedJoint>(joint));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
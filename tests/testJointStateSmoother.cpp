@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointStateSmoother.cpp
+ * @brief Test the fixed-lag smoother for joint states.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/JointStateSmoother.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace {
+const double kAmplitude = 0.3, kFrequency = 2.0, kDt = 0.01;
+
+// Encoder readings of q_j(t) = A (1 - cos(w t)) / (j + 1), at rest at t = 0.
+Values readings(const Robot& robot, int k) {
+  Values measurements;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&measurements, j,
+                     kAmplitude * (1 - std::cos(kFrequency * k * kDt)) /
+                         (j + 1));
+  }
+  return measurements;
+}
+}  // namespace
+
+// Velocities follow the measured angles, with a bounded window.
+TEST(JointStateSmoother, simple_rr) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  const size_t lag = 10;
+  JointStateSmoother smoother(robot, kDt, lag, 1e-4, 10.0);
+
+  size_t window_size = 0;
+  for (int k = 0; k < 60; k++) {
+    const Values& estimate = smoother.update(readings(robot, k));
+    if (k == 30) window_size = estimate.size();
+  }
+  EXPECT_LONGS_EQUAL(60, smoother.numUpdates());
+  EXPECT_LONGS_EQUAL(window_size, smoother.estimate().size());
+  EXPECT(!smoother.estimate().exists(JointAngleKey(0, 59 - lag)));
+
+  const double t = 59 * kDt;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    const double scale = kAmplitude / (j + 1);
+    EXPECT_DOUBLES_EQUAL(scale * (1 - std::cos(kFrequency * t)),
+                         smoother.jointAngle(j), 1e-4);
+    EXPECT_DOUBLES_EQUAL(scale * kFrequency * std::sin(kFrequency * t),
+                         smoother.jointVel(j), 1e-2);
+  }
+}
+
+// A robot without fixed link is estimated with its first link fixed.
+TEST(JointStateSmoother, floating_base) {
+  auto robot = simple_rr::getRobot();
+  JointStateSmoother smoother(robot, kDt, 5, 1e-4, 10.0);
+  EXPECT(smoother.robot().links().front()->isFixed());
+  smoother.update(readings(robot, 0));
+  for (auto&& joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(0.0, smoother.jointAngle(joint->id()), 1e-6);
+  }
+  CHECK_EXCEPTION(JointStateSmoother(robot, kDt, 1, 1e-4, 10.0),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
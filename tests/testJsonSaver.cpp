@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJsonSaver.cpp
+ * @brief Test streaming factor graphs to json.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// A chain of joint angles with a prior on the first.
+NonlinearFactorGraph graph(Values *values) {
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  values->insert(JointAngleKey(0, 0), 0.1);
+  for (int t = 1; t <= 3; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 1.0, model);
+    values->insert(JointAngleKey(0, t), 0.5 * t);
+  }
+  return graph;
+}
+}  // namespace example
+
+// Streaming gives the same document as building it in memory.
+TEST(JsonSaver, SaveFactorGraph) {
+  Values values;
+  const auto graph = example::graph(&values);
+
+  std::vector<std::string> variables, factors;
+  for (gtsam::Key key : graph.keys()) {
+    variables.push_back(JsonSaver::GetVariable(key, values, {}));
+  }
+  for (size_t i = 0; i < graph.size(); i++) {
+    factors.push_back(JsonSaver::GetFactor(i, graph, values));
+  }
+  const std::string expected = JsonSaver::JsonList(
+      {JsonSaver::JsonList(variables), JsonSaver::JsonList(factors)});
+
+  std::stringstream ss;
+  JsonSaver::SaveFactorGraph(graph, ss, values);
+  EXPECT(expected == ss.str());
+}
+
+// Newline delimited json has one record per variable and factor.
+TEST(JsonSaver, NdJson) {
+  Values values;
+  const auto graph = example::graph(&values);
+
+  std::stringstream ss;
+  JsonSaver::SaveFactorGraph(graph, ss, values, {}, JsonFormat::kNdJson);
+  std::string line;
+  size_t num_variables = 0, num_factors = 0;
+  while (std::getline(ss, line)) {
+    EXPECT(line.front() == '{' && line.back() == '}');
+    if (line.find("\"section\":\"variables\"") != std::string::npos) {
+      num_variables++;
+    } else if (line.find("\"section\":\"factors\"") != std::string::npos) {
+      num_factors++;
+    }
+  }
+  EXPECT_LONGS_EQUAL(graph.keys().size(), num_variables);
+  EXPECT_LONGS_EQUAL(graph.size(), num_factors);
+}
+
+// Summaries have one node per label or factor type and time step.
+TEST(JsonSaver, SaveSummarizedGraph) {
+  Values values;
+  auto graph = example::graph(&values);
+  for (int t = 0; t <= 3; t++) {
+    graph.addPrior<double>(JointAngleKey(1, t), 0.0, example::model);
+    values.insert(JointAngleKey(1, t), 0.2);
+  }
+
+  std::stringstream ss;
+  JsonSaver::SaveSummarizedGraph(
+      graph, ss, values,
+      [](uint64_t step) { return "chunk" + std::to_string(step) + ".json"; },
+      JsonFormat::kNdJson);
+  std::string line;
+  size_t num_variables = 0, num_factors = 0;
+  while (std::getline(ss, line)) {
+    if (line.find("\"section\":\"variables\"") != std::string::npos) {
+      num_variables++;
+      EXPECT(line.find("\"count\":2") != std::string::npos);
+    } else if (line.find("\"section\":\"factors\"") != std::string::npos) {
+      num_factors++;
+    }
+  }
+  // Joint angles of both joints share a node per step; priors of step 0
+  // share a node, and the between factor of step t is grouped at step t.
+  EXPECT_LONGS_EQUAL(4, num_variables);
+  EXPECT_LONGS_EQUAL(4 + 3, num_factors);
+
+  // The summary links factor groups to variable groups, and names chunks.
+  std::stringstream json;
+  JsonSaver::SaveSummarizedGraph(
+      graph, json, values,
+      [](uint64_t step) { return "chunk" + std::to_string(step) + ".json"; });
+  EXPECT(json.str().find("\"variables\":[\"q_0\",\"q_1\"]") !=
+         std::string::npos);
+  EXPECT(json.str().find("\"chunk\":\"chunk3.json\"") != std::string::npos);
+}
+
+// Lists nest, and closing a list that is not open throws.
+TEST(JsonSaver, JsonStreamWriter) {
+  std::stringstream ss;
+  {
+    JsonStreamWriter writer(ss);
+    writer.beginList();
+    writer.addDict({{JsonSaver::Quoted("a"), "1"}});
+    writer.beginList();
+    writer.addDict({{JsonSaver::Quoted("b"), "2"}});
+    // The destructor closes both lists.
+  }
+  const std::string a = JsonSaver::JsonDict({{JsonSaver::Quoted("a"), "1"}});
+  const std::string b = JsonSaver::JsonDict({{JsonSaver::Quoted("b"), "2"}});
+  EXPECT(JsonSaver::JsonList({a, JsonSaver::JsonList({b})}) == ss.str());
+
+  JsonStreamWriter writer(ss);
+  CHECK_EXCEPTION(writer.endList(), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
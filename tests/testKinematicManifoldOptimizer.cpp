@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicManifoldOptimizer.cpp
+ * @brief Test optimization over joint coordinates.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/KinematicManifoldOptimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace example {
+auto noise6 = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+auto noise1 = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+
+// Joint angles and velocities of all joints at step t.
+void InsertJoints(const Robot &robot, size_t t, double q, double v,
+                  Values *values) {
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(values, joint->id(), t, q);
+    InsertJointVel(values, joint->id(), t, v);
+  }
+}
+}  // namespace example
+
+// Link poses and twists are dependent, and equal forward kinematics.
+TEST(KinematicManifold, slice) {
+  using namespace example;
+  const Robot robot = simple_urdf::getRobot();
+  const KinematicManifold manifold(robot);
+  const int l1 = robot.link("l1")->id(), l2 = robot.link("l2")->id();
+  const int j = robot.joints()[0]->id();
+  EXPECT(manifold.isDependent(PoseKey(l1, 3)));
+  EXPECT(manifold.isDependent(TwistKey(l2, 3)));
+  EXPECT(!manifold.isDependent(JointAngleKey(j, 3)));
+  EXPECT(!manifold.isDependent(TwistAccelKey(l2, 3)));
+  EXPECT(!KinematicManifold(robot, false).isDependent(TwistKey(l2, 3)));
+  EXPECT_LONGS_EQUAL(2, manifold.sliceKeys(3).size());
+
+  Values values;
+  InsertJoints(robot, 3, 0.4, -0.7, &values);
+  const Values expected = robot.forwardKinematics(values, 3);
+  const Values slice = manifold.slice(values, 3);
+  EXPECT_LONGS_EQUAL(4, slice.size());
+  EXPECT(assert_equal(Pose(expected, l2, 3), Pose(slice, l2, 3)));
+  EXPECT(assert_equal(Twist(expected, l2, 3), Twist(slice, l2, 3)));
+
+  const Values full = manifold.expand(values);
+  EXPECT_LONGS_EQUAL(values.size() + slice.size(), full.size());
+  EXPECT(assert_equal(values, manifold.independent(full)));
+}
+
+// Factors on poses and twists become one factor on the joint coordinates
+// of their step, with correct Jacobians.
+TEST(KinematicManifold, reduce) {
+  using namespace example;
+  const Robot robot = simple_urdf::getRobot();
+  const KinematicManifold manifold(robot);
+  const int l2 = robot.link("l2")->id();
+  const int j = robot.joints()[0]->id();
+
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  NonlinearFactorGraph graph = graph_builder.qFactors(robot, 0);
+  graph.add(graph_builder.vFactors(robot, 0));
+  graph.addPrior(PoseKey(l2, 0), Pose3(), noise6);
+  graph.addPrior<Vector6>(TwistKey(l2, 0), Vector6::Ones(), noise6);
+  graph.addPrior(JointAngleKey(j, 0), 0.1, noise1);
+
+  const NonlinearFactorGraph reduced = manifold.reduce(graph);
+  EXPECT_LONGS_EQUAL(2, reduced.size());
+  auto factor = boost::dynamic_pointer_cast<KinematicManifoldFactor>(
+      reduced.back());
+  CHECK(factor);
+  EXPECT_LONGS_EQUAL(2, factor->factors().size());
+  EXPECT_LONGS_EQUAL(12, factor->dim());
+  EXPECT_LONGS_EQUAL(2, factor->keys().size());
+
+  Values values;
+  InsertJoints(robot, 0, 0.4, -0.7, &values);
+  const Values full = manifold.expand(values);
+  EXPECT_DOUBLES_EQUAL(graph.error(full) - reduced.front()->error(values),
+                       factor->error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+}
+
+// The loop closure of a four-bar linkage is the only factor left, and the
+// optimizer closes the loop.
+TEST(KinematicManifoldOptimizer, four_bar) {
+  using namespace example;
+  const Robot robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+  const KinematicManifold manifold(robot, false);
+  DynamicsGraph graph_builder(four_bar_linkage_pure::gravity,
+                              four_bar_linkage_pure::planar_axis);
+  NonlinearFactorGraph graph = graph_builder.qFactors(robot, 0);
+  const int j = robot.joints()[0]->id();
+  graph.addPrior(JointAngleKey(j, 0), 0.2, noise1);
+
+  const NonlinearFactorGraph reduced = manifold.reduce(graph);
+  EXPECT_LONGS_EQUAL(2, reduced.size());
+  for (gtsam::Key key : reduced.keys()) EXPECT(!manifold.isDependent(key));
+
+  Values init;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&init, joint->id(), 0, 0.0);
+  }
+  auto loop = boost::dynamic_pointer_cast<KinematicManifoldFactor>(
+      reduced.back());
+  CHECK(loop);
+  Values perturbed = init;
+  for (auto &&joint : robot.joints()) {
+    perturbed.update(JointAngleKey(joint->id(), 0), 0.1 * joint->id());
+  }
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*loop, perturbed, 1e-7, 1e-5);
+
+  const KinematicManifoldOptimizer optimizer(robot, OptimizationParameters(),
+                                             false);
+  const Values result = optimizer.optimize(graph, init);
+  EXPECT_DOUBLES_EQUAL(0.2, JointAngle(result, j, 0), 1e-3);
+  EXPECT(result.exists(PoseKey(robot.link("l3")->id(), 0)));
+  EXPECT(graph.error(result) < 1e-3);
+
+  // The same loop closure as an explicit constraint.
+  EqualityConstraints constraints;
+  for (auto &&joint : robot.joints()) {
+    constraints.emplace_shared<VectorExpressionEquality<6>>(
+        joint->poseConstraint(0), Vector6::Constant(1e-4));
+  }
+  const EqualityConstraints reduced_constraints =
+      manifold.reduce(constraints);
+  EXPECT_LONGS_EQUAL(1, reduced_constraints.size());
+  EXPECT_LONGS_EQUAL(6, reduced_constraints[0]->dim());
+
+  OptimizationParameters params;
+  params.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  NonlinearFactorGraph costs;
+  costs.addPrior(JointAngleKey(j, 0), 0.2, noise1);
+  const Values constrained = KinematicManifoldOptimizer(robot, params, false)
+                                 .optimize(costs, constraints, init);
+  EXPECT(EvaluateConstraints(constraints, constrained).max_violation < 1.0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
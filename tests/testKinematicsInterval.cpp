@@ -60,6 +60,36 @@ TEST(Interval, InverseKinematics) {
   }
 }
 
+TEST(Interval, SliceExecution) {
+  using namespace contact_goals_example;
+  const Interval interval(0, 4);
+
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  const auto serial = Kinematics(parameters).inverse(interval, robot,
+                                                     contact_goals);
+
+  // Parallel execution gives the same result as serial execution.
+  parameters.slice_execution = SliceExecution::Parallel;
+  parameters.num_threads = 3;
+  const auto parallel = Kinematics(parameters).inverse(interval, robot,
+                                                       contact_goals);
+  EXPECT(assert_equal(serial, parallel));
+
+  // Warm-started slices still achieve the goals.
+  parameters.slice_execution = SliceExecution::Pipelined;
+  parameters.num_threads = 2;
+  const auto pipelined = Kinematics(parameters).inverse(interval, robot,
+                                                        contact_goals);
+  EXPECT_LONGS_EQUAL(serial.size(), pipelined.size());
+  constexpr double tol = 1e-5;
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = 0; k <= 4; k++) {
+      EXPECT(goal.satisfied(pipelined, k, tol));
+    }
+  }
+}
+
 TEST(Interval, Interpolate) {
   // Load robot and establish contact/goal pairs
   using namespace contact_goals_example;
@@ -13,8 +13,11 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/utils/Slice.h>
 
+#include <boost/make_shared.hpp>
+
 #include "contactGoalsExample.h"
 
 using namespace gtdynamics;
@@ -81,6 +84,55 @@ TEST(Slice, InverseKinematics) {
   }
 }
 
+// Closed-form solver for simple_rr that returns fixed candidate solutions.
+class FakeRRSolver : public AnalyticalIKSolver {
+ public:
+  std::vector<JointAngleMap> candidates;
+  std::string baseLinkName() const override { return "link_0"; }
+  std::string endEffectorLinkName() const override { return "link_2"; }
+  std::vector<JointAngleMap> solve(const Robot& robot,
+                                   const gtsam::Pose3& bTe) const override {
+    return candidates;
+  }
+};
+
+TEST(Slice, AnalyticalInverseKinematics) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const size_t k = 3;
+  const auto ee = robot.link("link_2");
+
+  // Goal pose from forward kinematics.
+  gtsam::Values joint_angles;
+  InsertJointAngle(&joint_angles, robot.joint("joint_1")->id(), k, 0.3);
+  InsertJointAngle(&joint_angles, robot.joint("joint_2")->id(), k, -0.5);
+  const auto fk = robot.forwardKinematics(joint_angles, k);
+  const PoseGoals goals{{ee, Pose(fk, ee->id(), k)}};
+
+  auto solver = boost::make_shared<FakeRRSolver>();
+  solver->candidates = {{{"joint_1", 2.0}, {"joint_2", 1.0}},
+                        {{"joint_1", 0.3}, {"joint_2", -0.5}}};
+  auto registry = boost::make_shared<AnalyticalIKRegistry>();
+  registry->add(solver);
+  EXPECT(registry->find(robot, "link_2") == solver);
+  EXPECT(!registry->find(robot, "link_1"));
+  // The base link has to be fixed.
+  EXPECT(!registry->find(simple_rr::getRobot(), "link_2"));
+
+  // The solution with the smallest joint angles is returned as is.
+  KinematicsParameters parameters;
+  parameters.analytical_ik = registry;
+  auto result = Kinematics(parameters).inverse(Slice(k), robot, goals);
+  EXPECT(goals[0].satisfied(result, k, 1e-9));
+  EXPECT_DOUBLES_EQUAL(-0.5,
+                       JointAngle(result, robot.joint("joint_2")->id(), k),
+                       1e-12);
+
+  // Refined by the factor graph, starting from the closed-form solution.
+  parameters.refine_analytical_ik = true;
+  result = Kinematics(parameters).inverse(Slice(k), robot, goals);
+  EXPECT(goals[0].satisfied(result, k, 1e-3));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicsTrajectory.cpp
+ * @brief Test Kinematics for a trajectory with several phases.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/WalkCycle.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+#include "contactGoalsExample.h"
+
+namespace example {
+using namespace contact_goals_example;
+const auto all_feet = boost::make_shared<FootContactConstraintSpec>(
+    std::vector<LinkSharedPtr>{LH, LF, RF, RH}, contact_in_com);
+const auto three_feet = boost::make_shared<FootContactConstraintSpec>(
+    std::vector<LinkSharedPtr>{LH, LF, RH}, contact_in_com);
+
+// Phases of steps 0..2 and 2..4, sharing the transition step 2.
+const Trajectory trajectory(WalkCycle({all_feet, three_feet}, {2, 2}), 1);
+}  // namespace example
+
+TEST(Trajectory, InverseKinematics) {
+  using namespace example;
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  const Kinematics serial(parameters);
+
+  // Every phase contributes the factors of all its steps.
+  const size_t num_slices = 3 + 3;
+  EXPECT_LONGS_EQUAL(12 * num_slices, serial.graph(trajectory, robot).size());
+  EXPECT_LONGS_EQUAL(
+      4 * num_slices,
+      serial.pointGoalObjectives(trajectory, contact_goals).size());
+
+  // Shared steps are solved once.
+  const auto result = serial.inverse(trajectory, robot, contact_goals);
+  const auto slice = serial.inverse(Slice(0), robot, contact_goals);
+  EXPECT_LONGS_EQUAL(5 * slice.size(), result.size());
+  constexpr double tol = 1e-5;
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = 0; k <= 4; k++) {
+      EXPECT(goal.satisfied(result, k, tol));
+    }
+  }
+
+  // Parallel phases give the same graphs and results as serial ones.
+  parameters.parallel_phases = true;
+  parameters.num_threads = 2;
+  const Kinematics parallel(parameters);
+  EXPECT(assert_equal(serial.graph(trajectory, robot),
+                      parallel.graph(trajectory, robot)));
+  EXPECT(assert_equal(serial.initialValues(trajectory, robot),
+                      parallel.initialValues(trajectory, robot)));
+  EXPECT(assert_equal(result,
+                      parallel.inverse(trajectory, robot, contact_goals)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLeggedOdometry.cpp
+ * @brief Test fixed-lag legged odometry on a simulated walking base.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/LeggedOdometry.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+namespace example {
+constexpr int kBase = 0;
+constexpr double kDt = 0.005;
+constexpr int kSamplesPerState = 10;
+const Vector3 kVelocity(0.2, 0, 0);
+const std::vector<Point3> kFeet{Point3(0.3, 0.2, 0), Point3(0.3, -0.2, 0),
+                                Point3(-0.3, 0.2, 0), Point3(-0.3, -0.2, 0)};
+
+// The base moves at constant velocity, 0.5 m above the ground.
+Pose3 BasePose(double time) {
+  return Pose3(Rot3(), Point3(0, 0, 0.5) + kVelocity * time);
+}
+
+// Feet in contact at a time, in the base frame; foot 1 swings for a while.
+LeggedOdometry::Contacts Contacts(double time) {
+  LeggedOdometry::Contacts contacts;
+  const Pose3 wTb = BasePose(time);
+  for (int foot = 0; foot < 4; foot++) {
+    if (foot == 1 && time > 0.4 && time < 0.6) continue;
+    contacts[foot] = wTb.transformTo(kFeet[foot]);
+  }
+  return contacts;
+}
+
+LeggedOdometryParams Params(size_t lag) {
+  auto imu = gtsam::PreintegrationParams::MakeSharedU(9.81);
+  imu->setAccelerometerCovariance(gtsam::I_3x3 * 1e-4);
+  imu->setGyroscopeCovariance(gtsam::I_3x3 * 1e-6);
+  imu->setIntegrationCovariance(gtsam::I_3x3 * 1e-8);
+  return LeggedOdometryParams(imu, lag);
+}
+}  // namespace example
+
+// Exact measurements are tracked, with a bounded window.
+TEST(LeggedOdometry, walking) {
+  using namespace example;
+  const size_t lag = 10;
+  LeggedOdometry odometry(Params(lag), kBase,
+                          gtsam::NavState(BasePose(0), kVelocity),
+                          gtsam::imuBias::ConstantBias(), Contacts(0));
+
+  // At constant velocity, the accelerometer only measures gravity.
+  const Vector3 acc(0, 0, 9.81), gyro(0, 0, 0);
+  double time = 0;
+  for (int t = 1; t <= 40; t++) {
+    for (int s = 0; s < kSamplesPerState; s++) {
+      odometry.integrateMeasurement(acc, gyro, Contacts(time), kDt);
+      time += kDt;
+    }
+    const gtsam::NavState state = odometry.update(Contacts(time));
+    EXPECT_LONGS_EQUAL(t, odometry.time());
+    EXPECT(assert_equal(BasePose(time), state.pose(), 1e-4));
+    EXPECT(assert_equal(kVelocity, Vector3(state.velocity()), 1e-4));
+  }
+
+  // Only the last lag states remain, with their contact frames.
+  const gtsam::Values estimate = odometry.calculateEstimate();
+  EXPECT(!estimate.exists(PoseKey(kBase, 40 - lag)));
+  EXPECT(estimate.exists(PoseKey(kBase, 40 - lag + 1)));
+  EXPECT(estimate.size() <= lag * (3 + kFeet.size()));
+  EXPECT(assert_equal(kFeet[0],
+                      estimate.at<Pose3>(ContactPoseKey(0, 40)).translation(),
+                      1e-4));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
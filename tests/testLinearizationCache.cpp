@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinearizationCache.cpp
+ * @brief Test partial relinearization in batch solves.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/LinearizationCache.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const int num_steps = 10;
+
+// Forward dynamics of a single joint under constant torque.
+gtsam::NonlinearFactorGraph Graph() {
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  return graph;
+}
+
+// A chain x0 - x1 - x2 of linear factors, whose linearization is exact.
+gtsam::NonlinearFactorGraph Chain() {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(0, 1.0, model);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(0, 1, 2.0, model);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(1, 2, -1.0, model);
+  return graph;
+}
+}  // namespace example
+
+// Factors of variables that moved less than the threshold are moved to the
+// new values instead of being relinearized.
+TEST(LinearizationCache, linearize) {
+  using namespace example;
+  const auto graph = Chain();
+  gtsam::Values values;
+  values.insert<double>(0, 0.0);
+  values.insert<double>(1, 0.0);
+  values.insert<double>(2, 0.0);
+
+  LinearizationCache cache(0.1);
+  EXPECT(assert_equal(*graph.linearize(values),
+                      *cache.linearize(graph, values)));
+  EXPECT_LONGS_EQUAL(3, cache.numRelinearized());
+
+  // Small moves: nothing is relinearized, and the linear factors are exact.
+  values.update<double>(0, 0.05);
+  values.update<double>(2, -0.08);
+  EXPECT(assert_equal(*graph.linearize(values),
+                      *cache.linearize(graph, values), 1e-9));
+  EXPECT_LONGS_EQUAL(0, cache.numRelinearized());
+  EXPECT_DOUBLES_EQUAL(0.0, cache.linearizationPoint().at<double>(0), 0);
+
+  // x1 moves beyond the threshold: the two factors on it are relinearized.
+  values.update<double>(1, 0.5);
+  EXPECT(assert_equal(*graph.linearize(values),
+                      *cache.linearize(graph, values), 1e-9));
+  EXPECT_LONGS_EQUAL(2, cache.numRelinearized());
+  EXPECT_DOUBLES_EQUAL(0.5, cache.linearizationPoint().at<double>(1), 0);
+
+  // Another graph relinearizes everything.
+  auto other = graph;
+  other.push_back(gtsam::NonlinearFactor::shared_ptr());
+  const auto linear = cache.linearize(other, values);
+  EXPECT_LONGS_EQUAL(3, cache.numRelinearized());
+  EXPECT_LONGS_EQUAL(4, linear->size());
+  EXPECT(!linear->back());
+}
+
+// LM with partial relinearization converges to the same trajectory.
+TEST(LinearizationCache, Optimizer) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters params;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.relinearize_threshold = 1e-3;
+  const auto result = Optimizer(params).optimize(graph, init);
+  EXPECT(assert_equal(expected, result, 1e-4));
+  EXPECT_DOUBLES_EQUAL(graph.error(expected), graph.error(result), 1e-4);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
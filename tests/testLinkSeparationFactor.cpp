@@ -0,0 +1,57 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinkSeparationFactor.cpp
+ * @brief Test link separation factor.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/LinkSeparationFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+gtsam::noiseModel::Base::shared_ptr cost_model =
+    gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+gtsam::Key pose_a_key = gtsam::Symbol('p', 1),
+           pose_b_key = gtsam::Symbol('p', 2);
+}  // namespace example
+
+// The error is a hinge on the distance between the CoMs.
+TEST(LinkSeparationFactor, error) {
+  LinkSeparationFactor factor(example::pose_a_key, example::pose_b_key, 1.0,
+                              example::cost_model);
+  const Pose3 wTa(Rot3::Rz(0.3), Point3(0, 0, 1));
+  const Pose3 near(Rot3(), Point3(0, 0.4, 1)), far(Rot3(), Point3(0, 2, 1));
+  EXPECT(assert_equal((gtsam::Vector(1) << 0.6).finished(),
+                      factor.evaluateError(wTa, near), 1e-9));
+  EXPECT(assert_equal((gtsam::Vector(1) << 0.0).finished(),
+                      factor.evaluateError(wTa, far), 1e-9));
+
+  // Make sure linearization is correct while the hinge is active.
+  gtsam::Values values;
+  values.insert(example::pose_a_key, wTa);
+  values.insert(example::pose_b_key,
+                Pose3(Rot3::Rx(0.2), Point3(0.1, 0.3, 0.8)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMemoryReport.cpp
+ * @brief Test the memory report of factor graphs and values.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <sstream>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+
+// Bytes add up over the labels and the time steps.
+TEST(MemoryReport, breakdown) {
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  graph.addPrior<double>(JointAngleKey(0, 1), 0.0, model);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, 0), JointAngleKey(0, 1), 1.0,
+      gtsam::noiseModel::Diagonal::Sigmas(gtsam::Vector1(0.2)));
+  graph.addPrior<Pose3>(PoseKey(0, 1), Pose3(),
+                        gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+
+  gtsam::Values values;
+  InsertJointAngle(&values, 0, 0, 0.0);
+  InsertJointAngle(&values, 0, 1, 1.0);
+  InsertPose(&values, 0, 1, Pose3());
+
+  const MemoryReport report(graph, values);
+  EXPECT_LONGS_EQUAL(4, report.factors.count);
+  EXPECT_LONGS_EQUAL(3, report.factor_types.size());
+  EXPECT_LONGS_EQUAL(3, report.noise.count);  // the shared model once
+  EXPECT_LONGS_EQUAL(3, report.values.count);
+  EXPECT_LONGS_EQUAL(2, report.labels.at("q").count);
+  EXPECT_LONGS_EQUAL(1, report.labels.at("p").count);
+  EXPECT_LONGS_EQUAL(2, report.time_steps.size());
+  EXPECT_LONGS_EQUAL(2, report.time_steps.at(1).count);
+
+  size_t label_bytes = 0, step_bytes = 0;
+  for (auto &&entry : report.labels) label_bytes += entry.second.bytes;
+  for (auto &&entry : report.time_steps) step_bytes += entry.second.bytes;
+  EXPECT_LONGS_EQUAL(report.factors.bytes + report.values.bytes, label_bytes);
+  EXPECT_LONGS_EQUAL(label_bytes, step_bytes);
+  EXPECT(report.values.bytes > 0);
+  EXPECT(report.bytes() > label_bytes);
+
+  std::ostringstream os;
+  report.saveJson(os);
+  EXPECT(os.str().find("\"labels\"") != std::string::npos);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
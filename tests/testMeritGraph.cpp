@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMeritGraph.cpp
+ * @brief Test penalty factors with parameters updated in place.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/MeritGraph.h>
+#include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+namespace example {
+using namespace constrained_example;
+
+// Vector-valued constraint g(x) = [x1 - x2; x1 + 2 x2].
+Vector2 stack_func(const double& a, const double& b,
+                   gtsam::OptionalJacobian<2, 1> H1 = boost::none,
+                   gtsam::OptionalJacobian<2, 1> H2 = boost::none) {
+  if (H1) *H1 << 1, 1;
+  if (H2) *H2 << -1, 2;
+  return Vector2(a - b, a + 2 * b);
+}
+
+NonlinearFactorGraph Cost() {
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(
+      ExpressionFactor<double>(cost_noise, 0., pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 0.5);
+  constraints.emplace_shared<VectorExpressionEquality<2>>(
+      gtsam::Vector2_(stack_func, x1, x2), Vector2(0.1, 0.2));
+  return constraints;
+}
+
+Values Init() {
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, 0.3);
+  return init_values;
+}
+}  // namespace example
+
+// Penalty factors agree with EqualityConstraint::createFactor.
+TEST(MeritGraph, PenaltyFactor) {
+  using namespace example;
+  auto constraints = Constraints();
+  auto values = Init();
+  const double mu = 8.0;
+  std::vector<Vector> z{Vector1(0.3), Vector2(-0.5, 2.0)};
+
+  MeritGraph merit(Cost(), constraints);
+  merit.update(mu, z);
+  NonlinearFactorGraph expected = Cost();
+  for (size_t i = 0; i < constraints.size(); i++) {
+    Vector bias = z[i] / mu;
+    expected.add(constraints[i]->createFactor(mu, bias));
+  }
+
+  EXPECT_LONGS_EQUAL(expected.size(), merit.graph().size());
+  EXPECT_DOUBLES_EQUAL(expected.error(values), merit.graph().error(values),
+                       1e-9);
+  EXPECT(assert_equal(*expected.linearize(values),
+                      *merit.graph().linearize(values), 1e-9));
+}
+
+// Reusing the merit graph gives the same result as rebuilding it.
+TEST(MeritGraph, Optimizers) {
+  using namespace example;
+  auto cost = Cost();
+  auto constraints = Constraints();
+  auto init_values = Init();
+
+  AugmentedLagrangianParameters al_params;
+  Values al_expected = AugmentedLagrangianOptimizer(al_params)
+                           .optimize(cost, constraints, init_values);
+  al_params.reuse_merit_graph = true;
+  Values al_result = AugmentedLagrangianOptimizer(al_params)
+                         .optimize(cost, constraints, init_values);
+  EXPECT(assert_equal(al_expected, al_result, 1e-6));
+
+  PenaltyMethodParameters penalty_params;
+  Values penalty_expected = PenaltyMethodOptimizer(penalty_params)
+                                .optimize(cost, constraints, init_values);
+  penalty_params.reuse_merit_graph = true;
+  Values penalty_result = PenaltyMethodOptimizer(penalty_params)
+                              .optimize(cost, constraints, init_values);
+  EXPECT(assert_equal(penalty_expected, penalty_result, 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
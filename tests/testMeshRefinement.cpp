@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMeshRefinement.cpp
+ * @brief Test trajectory optimization with mesh refinement.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MeshRefinement.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using Mesh = MeshRefinement::Mesh;
+
+namespace example {
+// A single joint with unit inertia, so the acceleration is the torque.
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                                  simple_urdf_eq_mass::planar_axis);
+
+// Torque cos(3 t), starting at rest: q = (1 - cos(3 t)) / 9.
+gtsam::NonlinearFactorGraph Objectives(const Mesh &mesh) {
+  Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (size_t k = 0; k < mesh.size(); k++) {
+    InsertTorque(&known_values, j, k, std::cos(3 * mesh[k]));
+  }
+  return graph_builder.trajectoryFDPriors(robot, mesh.size() - 1,
+                                          known_values);
+}
+}  // namespace example
+
+// Refine, split and interpolate on a given mesh.
+TEST(MeshRefinement, refine) {
+  using namespace example;
+  MeshRefinementParameters parameters;
+  parameters.tolerance = 0.1;
+  MeshRefinement refinement(graph_builder, robot, parameters);
+  const Mesh mesh{0, 1, 3};
+  const Mesh refined =
+      refinement.refine(mesh, (gtsam::Vector(2) << 0.05, 0.2).finished());
+  EXPECT_LONGS_EQUAL(4, refined.size());
+  EXPECT_DOUBLES_EQUAL(2.0, refined[2], 1e-12);
+
+  Values values;
+  for (int k = 0; k < 3; k++) {
+    InsertJointAngle(&values, j, k, mesh[k] * mesh[k]);
+    InsertPose(&values, 0, k, gtsam::Pose3(gtsam::Rot3::Rz(mesh[k]),
+                                           gtsam::Point3(mesh[k], 0, 0)));
+  }
+  const Values interpolated =
+      MeshRefinement::Interpolate(mesh, values, refined);
+  EXPECT_LONGS_EQUAL(8, interpolated.size());
+  EXPECT_DOUBLES_EQUAL(1.0, JointAngle(interpolated, j, 1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(5.0, JointAngle(interpolated, j, 2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(9.0, JointAngle(interpolated, j, 3), 1e-12);
+  EXPECT(assert_equal(gtsam::Rot3::Rz(2), Pose(interpolated, 0, 2).rotation(),
+                      1e-9));
+
+  CHECK_EXCEPTION(MeshRefinement::Interpolate(refined, values, mesh),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(refinement.trajectoryGraph(Mesh{0, 1, 1}),
+                  std::invalid_argument);
+}
+
+// A coarse trapezoidal solve is refined until the local errors are below
+// tolerance, with fewer knots than a uniform mesh at the finest spacing.
+TEST(MeshRefinement, optimize) {
+  using namespace example;
+  MeshRefinementParameters parameters;
+  parameters.tolerance = 1e-3;
+  parameters.max_iterations = 8;
+  MeshRefinement refinement(graph_builder, robot, parameters);
+
+  Mesh mesh{0, 0.5, 1, 1.5, 2};
+  Initializer initializer;
+  const Values initial_values =
+      initializer.ZeroValuesTrajectory(robot, mesh.size() - 1);
+  size_t iterations;
+  const Values result = refinement.optimize(&mesh, example::Objectives,
+                                            initial_values, &iterations);
+
+  EXPECT(iterations > 1 && iterations < parameters.max_iterations);
+  EXPECT(refinement.intervalErrors(mesh, result).maxCoeff() <=
+         parameters.tolerance);
+  double shortest = mesh.back();
+  for (size_t k = 0; k + 1 < mesh.size(); k++) {
+    shortest = std::min(shortest, mesh[k + 1] - mesh[k]);
+  }
+  EXPECT(mesh.size() < 2 / shortest + 1);
+
+  const int K = mesh.size() - 1;
+  const double T = mesh.back();
+  EXPECT_DOUBLES_EQUAL(std::cos(3 * T), JointAccel(result, j, K), 1e-6);
+  EXPECT_DOUBLES_EQUAL(std::sin(3 * T) / 3, JointVel(result, j, K), 5e-4);
+  EXPECT_DOUBLES_EQUAL((1 - std::cos(3 * T)) / 9, JointAngle(result, j, K),
+                       5e-4);
+}
+
+// Runge-Kutta and Hermite-Simpson have no higher-order error estimate.
+TEST(MeshRefinement, scheme) {
+  using namespace example;
+  MeshRefinementParameters parameters;
+  parameters.collocation = CollocationScheme::HermiteSimpson;
+  CHECK_EXCEPTION(MeshRefinement(graph_builder, robot, parameters),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -12,6 +12,7 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/MinTorqueBlockFactor.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
@@ -77,6 +78,29 @@ TEST(MinTorqueFactor, optimization) {
   EXPECT(assert_equal(0.0, torque_optimized, 1e-3));
 }
 
+// The block factor has the error of one MinTorqueFactor per torque.
+TEST(MinTorqueBlockFactor, error) {
+  const gtsam::KeyVector keys{gtsam::Symbol('t', 1), gtsam::Symbol('t', 2),
+                              gtsam::Symbol('t', 3)};
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  MinTorqueBlockFactor factor(keys, model);
+  EXPECT_LONGS_EQUAL(3, factor.dim());
+
+  gtsam::Values values;
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t i = 0; i < keys.size(); i++) {
+    values.insert(keys[i], 2.0 - i);
+    graph.emplace_shared<MinTorqueFactor>(keys[i], model);
+  }
+  EXPECT(assert_equal(gtsam::Vector3(2, 1, 0),
+                      factor.unwhitenedError(values), 1e-9));
+  EXPECT_DOUBLES_EQUAL(graph.error(values), factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(MinTorqueBlockFactor(keys, example::cost_model),
+                  std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
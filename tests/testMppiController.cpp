@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMppiController.cpp
+ * @brief Test sampling-based MPC with batch rollouts.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/MppiController.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::Vector2;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const Vector2 target(0.1, -0.1);
+
+// Reach the target angles at the end of the horizon, with small torques.
+double Cost(const TrajectoryBuffer &rollout) {
+  const size_t end = rollout.numSteps() - 1;
+  const Vector q = rollout.jointAngles().row(end).transpose();
+  return 100 * (q - target).squaredNorm() +
+         1e-3 * rollout.torques().squaredNorm();
+}
+
+MppiParameters Parameters() {
+  MppiParameters parameters;
+  parameters.num_samples = 32;
+  parameters.horizon = 10;
+  parameters.dt = 0.05;
+  parameters.temperature = 0.1;
+  return parameters;
+}
+}  // namespace example
+
+// MPPI lowers the cost of the mean, independently of the number of threads.
+TEST(MppiController, Mppi) {
+  using namespace example;
+  const Vector zero = Vector::Zero(2);
+  MppiController serial(robot, Cost, Parameters(), boost::none, 1);
+  serial.iterate(zero, zero);
+  const double initial_cost = serial.costs()[0];
+  EXPECT_LONGS_EQUAL(32, serial.costs().size());
+  for (int i = 0; i < 20; i++) serial.iterate(zero, zero);
+  EXPECT(serial.costs()[0] < 0.5 * initial_cost);
+
+  MppiController parallel(robot, Cost, Parameters(), boost::none, 4);
+  for (int i = 0; i < 21; i++) parallel.iterate(zero, zero);
+  EXPECT(assert_equal(serial.mean(), parallel.mean()));
+
+  // control returns the first torques and shifts the horizon.
+  const Matrix mean = serial.mean();
+  MppiParameters no_iterations = Parameters();
+  no_iterations.num_iterations = 0;
+  MppiController shifted(robot, Cost, no_iterations);
+  shifted.setMean(mean);
+  EXPECT(assert_equal(Vector(mean.row(0).transpose()),
+                      shifted.control(zero, zero)));
+  EXPECT(assert_equal(Vector(mean.row(1).transpose()),
+                      Vector(shifted.mean().row(0).transpose())));
+  EXPECT(assert_equal(Vector(mean.row(9).transpose()),
+                      Vector(shifted.mean().row(9).transpose())));
+
+  CHECK_EXCEPTION(shifted.setMean(Matrix::Zero(2, 2)), std::invalid_argument);
+  CHECK_EXCEPTION(serial.iterate(Vector::Zero(3), zero),
+                  std::invalid_argument);
+}
+
+// CEM refits the mean and narrows the distribution, with an objective cost.
+TEST(MppiController, Cem) {
+  using namespace example;
+  MppiParameters parameters = Parameters();
+  parameters.num_elites = 4;
+  parameters.sigma = 0.5;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph objectives;
+  for (size_t i = 0; i < 2; i++) {
+    const int j = robot.joints()[i]->id();
+    objectives.add(
+        JointObjectives(j, parameters.horizon).angle(target(i), model));
+  }
+  MppiController cem(robot, ObjectiveCost(objectives), parameters);
+
+  const Vector zero = Vector::Zero(2);
+  cem.iterate(zero, zero);
+  const double initial_cost = cem.costs()[0];
+  for (int i = 0; i < 10; i++) cem.iterate(zero, zero);
+  EXPECT(cem.costs()[0] < initial_cost);
+  EXPECT(cem.sigma().maxCoeff() < parameters.sigma);
+  EXPECT(cem.sigma().minCoeff() >= parameters.min_sigma);
+
+  parameters.num_elites = 33;
+  CHECK_EXCEPTION(MppiController(robot, Cost, parameters),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
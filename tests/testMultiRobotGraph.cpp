@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiRobotGraph.cpp
+ * @brief Test several robots in one factor graph.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/MultiRobotGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Executor.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+
+using namespace gtdynamics;
+
+// Each robot gets its own keys, and coupling variables are eliminated last.
+// Graphs are built on several threads, which create keys of the same robot.
+TEST(MultiRobotGraph, TwoRobots) {
+  SetExecutorThreads(4);
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  OptimizerSetting opt;
+  opt.setNumThreads(4);
+  const DynamicsGraph graph_builder(opt, simple_rr::gravity,
+                                    simple_rr::planar_axis);
+  const size_t num_steps = 3;
+  const double dt = 0.1;
+  MultiRobotGraph problem(2, [&](size_t) {
+    Initializer initializer;
+    return MultiRobotGraph::RobotProblem(
+        graph_builder.trajectoryFG(robot, num_steps, dt),
+        initializer.ZeroValuesTrajectory(robot, num_steps, -1, 0.0));
+  });
+  EXPECT_LONGS_EQUAL(2, problem.numRobots());
+
+  for (size_t r = 0; r < 2; r++) {
+    for (gtsam::Key key : problem.robotGraph(r).keys())
+      EXPECT_LONGS_EQUAL(r, DynamicsSymbol(key).robotIdx());
+    for (gtsam::Key key : problem.robotValues(r).keys())
+      EXPECT_LONGS_EQUAL(r, DynamicsSymbol(key).robotIdx());
+  }
+  EXPECT_LONGS_EQUAL(problem.robotGraph(0).size(),
+                     problem.robotGraph(1).size());
+
+  // Couple the end links of the two arms.
+  const uint16_t link_2 = robot.link("link_2")->id();
+  problem.addSeparation(0, link_2, 1, link_2, 0.5, 0, num_steps,
+                        gtsam::noiseModel::Isotropic::Sigma(1, 0.1));
+  EXPECT_LONGS_EQUAL(num_steps + 1, problem.couplingFactors().size());
+
+  const gtsam::NonlinearFactorGraph graph = problem.graph();
+  EXPECT_LONGS_EQUAL(2 * problem.robotGraph(0).size() + num_steps + 1,
+                     graph.size());
+  const gtsam::Values values = problem.initialValues();
+  EXPECT_LONGS_EQUAL(2 * problem.robotValues(0).size(), values.size());
+
+  // Both arms start at the same place, so the separation factors are active.
+  EXPECT(graph.error(values) > problem.robotGraph(0).error(values) +
+                                   problem.robotGraph(1).error(values));
+
+  // The separator keys come last in the ordering.
+  const gtsam::KeyVector separator = problem.separatorKeys();
+  EXPECT_LONGS_EQUAL(2 * (num_steps + 1), separator.size());
+  const gtsam::Ordering ordering = problem.ordering();
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  const gtsam::KeyVector last(ordering.end() - separator.size(),
+                              ordering.end());
+  for (gtsam::Key key : separator)
+    EXPECT(std::find(last.begin(), last.end(), key) != last.end());
+  SetExecutorThreads(0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
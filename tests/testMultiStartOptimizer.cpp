@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiStartOptimizer.cpp
+ * @brief Test concurrent solves from several initial values.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MultiStartOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace example {
+const gtsam::Key key = 0;
+
+// Residuals x^2 - 1 and (x - 1) / 2: a global minimum at x = 1 and a local
+// one near x = -0.85.
+class DoubleWellFactor : public gtsam::NoiseModelFactor1<double> {
+ public:
+  DoubleWellFactor()
+      : gtsam::NoiseModelFactor1<double>(
+            gtsam::noiseModel::Unit::Create(2), key) {}
+
+  gtsam::Vector evaluateError(
+      const double &x,
+      boost::optional<gtsam::Matrix &> H = boost::none) const override {
+    if (H) *H = (gtsam::Matrix21() << 2 * x, 0.5).finished();
+    return gtsam::Vector2(x * x - 1, 0.5 * (x - 1));
+  }
+};
+
+gtsam::NonlinearFactorGraph Graph() {
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<DoubleWellFactor>();
+  return graph;
+}
+
+// LM with little initial damping, so that runs converge in a few steps.
+OptimizationParameters Parameters() {
+  OptimizationParameters parameters;
+  parameters.lm_parameters.setlambdaInitial(1e-3);
+  parameters.lm_parameters.setAbsoluteErrorTol(1e-12);
+  return parameters;
+}
+
+std::vector<Values> Starts(const std::vector<double> &xs) {
+  std::vector<Values> starts;
+  for (double x : xs) {
+    Values values;
+    values.insert(key, x);
+    starts.push_back(values);
+  }
+  return starts;
+}
+}  // namespace example
+
+// The best run wins, and runs behind a finished better one are pruned.
+TEST(MultiStartOptimizer, Best) {
+  MultiStartParameters multi_start;
+  multi_start.num_threads = 1;  // runs in order, the best first
+  multi_start.min_iterations = 1;
+  const MultiStartOptimizer optimizer(example::Parameters(), multi_start);
+  const auto graph = example::Graph();
+  const auto result =
+      optimizer.optimize(graph, example::Starts({2, -2, -1.5}));
+  LONGS_EQUAL(0, result.best);
+  EXPECT_DOUBLES_EQUAL(1, result.values.at<double>(example::key), 1e-3);
+  EXPECT(result.errors[0] < 1e-6);
+  EXPECT(!result.pruned[0]);
+  EXPECT(result.pruned[1]);
+  EXPECT(result.pruned[2]);
+
+  // Without pruning, the other runs reach the local minimum.
+  multi_start.prune_ratio = 0;
+  multi_start.num_threads = 3;
+  const auto unpruned = MultiStartOptimizer(example::Parameters(),
+                                            multi_start)
+                            .optimize(graph, example::Starts({-2, 2, -1.5}));
+  LONGS_EQUAL(1, unpruned.best);
+  EXPECT(!unpruned.pruned[0] && !unpruned.pruned[2]);
+  EXPECT(unpruned.errors[0] > 0.1);
+}
+
+// Initial values can be generated per run, e.g. with seeded noise.
+TEST(MultiStartOptimizer, Function) {
+  MultiStartParameters multi_start;
+  multi_start.num_starts = 4;
+  const MultiStartOptimizer optimizer(example::Parameters(), multi_start);
+  const auto result =
+      optimizer.optimize(example::Graph(), [](size_t k) {
+        Values values;
+        values.insert(example::key, k % 2 ? 1.5 : -1.5);
+        return values;
+      });
+  EXPECT(result.best % 2 == 1);
+  EXPECT_LONGS_EQUAL(4, result.errors.size());
+}
+
+// Cancelling the token of the parameters cancels all runs.
+TEST(MultiStartOptimizer, Cancelled) {
+  OptimizationParameters parameters = example::Parameters();
+  parameters.cancellation = std::make_shared<CancellationToken>();
+  parameters.cancellation->cancel();
+  const MultiStartOptimizer optimizer(parameters);
+  CHECK_EXCEPTION(optimizer.optimize(example::Graph(), example::Starts({2})),
+                  std::runtime_error);
+  CHECK_EXCEPTION(optimizer.optimize(example::Graph(), example::Starts({})),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultigridOptimizer.cpp
+ * @brief Test coarse-to-fine multi-phase trajectory optimization.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/MultigridOptimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+// A single joint with unit inertia, so the acceleration is the torque.
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                                  simple_urdf_eq_mass::planar_axis);
+auto dt_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-4);
+
+// Two phases of one second, with torque cos(3 t) starting at rest.
+NonlinearFactorGraph Problem(const std::vector<int> &phase_steps) {
+  const std::vector<NonlinearFactorGraph> transition_graphs{
+      graph_builder.dynamicsFactorGraph(robot, phase_steps[0])};
+  NonlinearFactorGraph graph = graph_builder.multiPhaseTrajectoryFG(
+      robot, phase_steps, transition_graphs);
+
+  Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  int k = 0;
+  for (size_t p = 0; p < phase_steps.size(); p++) {
+    const double dt = 1.0 / phase_steps[p];
+    graph.addPrior<double>(PhaseKey(p), dt, dt_model);
+    for (int step = (p == 0 ? 0 : 1); step <= phase_steps[p]; step++) {
+      InsertTorque(&known_values, j, k++, std::cos(3 * (p + step * dt)));
+    }
+    k--;
+  }
+  graph.add(graph_builder.trajectoryFDPriors(robot, k, known_values));
+  return graph;
+}
+}  // namespace example
+
+// Phases are decimated to at least one step.
+TEST(MultigridOptimizer, Decimate) {
+  const std::vector<int> decimated = MultigridOptimizer::Decimate({8, 3}, 4);
+  EXPECT_LONGS_EQUAL(2, decimated.size());
+  EXPECT_LONGS_EQUAL(2, decimated[0]);
+  EXPECT_LONGS_EQUAL(1, decimated[1]);
+  CHECK_EXCEPTION(MultigridOptimizer::Decimate({8, 0}, 4),
+                  std::invalid_argument);
+}
+
+// Steps are interpolated per phase, and phase durations scaled.
+TEST(MultigridOptimizer, Resample) {
+  using namespace example;
+  Values values;
+  for (int t = 0; t <= 3; t++) {
+    InsertJointAngle(&values, j, t, t * t);
+    InsertPose(&values, 0, t,
+               gtsam::Pose3(gtsam::Rot3::Rz(t), gtsam::Point3(t, 0, 0)));
+  }
+  values.insert(PhaseKey(0), 0.5);
+  values.insert(PhaseKey(1), 0.4);
+
+  const Values upsampled = MultigridOptimizer::Resample(values, {1, 2}, {2, 4});
+  EXPECT_LONGS_EQUAL(16, upsampled.size());
+  EXPECT_DOUBLES_EQUAL(0.5, JointAngle(upsampled, j, 1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(1.0, JointAngle(upsampled, j, 2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(2.5, JointAngle(upsampled, j, 3), 1e-12);
+  EXPECT_DOUBLES_EQUAL(6.5, JointAngle(upsampled, j, 5), 1e-12);
+  EXPECT_DOUBLES_EQUAL(9.0, JointAngle(upsampled, j, 6), 1e-12);
+  EXPECT(assert_equal(gtsam::Rot3::Rz(1.5), Pose(upsampled, 0, 3).rotation(),
+                      1e-9));
+  EXPECT_DOUBLES_EQUAL(0.25, upsampled.at<double>(PhaseKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.2, upsampled.at<double>(PhaseKey(1)), 1e-12);
+
+  // Downsampling onto the original steps recovers the values.
+  const Values downsampled =
+      MultigridOptimizer::Resample(upsampled, {2, 4}, {1, 2});
+  EXPECT(assert_equal(values, downsampled, 1e-9));
+
+  CHECK_EXCEPTION(MultigridOptimizer::Resample(values, {1, 2}, {3}),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(MultigridOptimizer::Resample(values, {1, 1}, {2, 2}),
+                  std::invalid_argument);
+}
+
+// The coarse-to-fine solve finds the solution of the full problem.
+TEST(MultigridOptimizer, optimize) {
+  using namespace example;
+  const std::vector<int> phase_steps{8, 8};
+  const NonlinearFactorGraph graph = Problem(phase_steps);
+  Initializer initializer;
+  const Values initial_values = initializer.ZeroValuesTrajectory(
+      robot, 16, phase_steps.size());
+
+  MultigridOptimizer optimizer;
+  std::vector<MultigridLevel> levels;
+  const Values result =
+      optimizer.optimize(phase_steps, Problem, initial_values, &levels);
+
+  EXPECT_LONGS_EQUAL(2, levels.size());
+  EXPECT_LONGS_EQUAL(4, levels[0].decimation);
+  EXPECT_LONGS_EQUAL(2, levels[0].phase_steps[1]);
+  EXPECT_LONGS_EQUAL(1, levels[1].decimation);
+  EXPECT_LONGS_EQUAL(8, levels[1].phase_steps[1]);
+  for (auto &&level : levels) {
+    EXPECT(level.seconds >= 0);
+    EXPECT(level.error <= level.initial_error);
+  }
+  EXPECT_DOUBLES_EQUAL(graph.error(result), levels[1].error, 1e-9);
+
+  // The warm start is closer than the initial values.
+  EXPECT(levels[1].initial_error < graph.error(initial_values));
+
+  const Values expected = optimizer.optimize(graph, initial_values);
+  EXPECT_DOUBLES_EQUAL(0.125, result.at<double>(PhaseKey(1)), 1e-6);
+  EXPECT_DOUBLES_EQUAL(JointAngle(expected, j, 16), JointAngle(result, j, 16),
+                       1e-5);
+  EXPECT_DOUBLES_EQUAL(JointVel(expected, j, 16), JointVel(result, j, 16),
+                       1e-5);
+
+  MultigridParameters parameters;
+  parameters.decimations = {2, 4, 1};
+  CHECK_EXCEPTION(MultigridOptimizer{parameters}, std::invalid_argument);
+  parameters.decimations = {4, 2};
+  CHECK_EXCEPTION(MultigridOptimizer{parameters}, std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultipleShootingOptimizer.cpp
+ * @brief Test parallel-in-time consensus optimizer.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MultipleShootingOptimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const auto prior_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+const auto step_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+const int num_steps = 9;
+
+// Joint angle chain with priors at both ends, so the interior is a
+// compromise that only the full problem determines.
+NonlinearFactorGraph graph() {
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, prior_model);
+  graph.addPrior<double>(JointAngleKey(0, num_steps), 1.0, prior_model);
+  for (int t = 1; t <= num_steps; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.1, step_model);
+  }
+  return graph;
+}
+
+Values init() {
+  Values init;
+  for (int t = 0; t <= num_steps; t++) init.insert(JointAngleKey(0, t), 0.0);
+  return init;
+}
+}  // namespace example
+
+// Error and Jacobian of the consensus factor.
+TEST(ConsensusFactor, Error) {
+  const auto model = gtsam::noiseModel::Unit::Create(3);
+  const gtsam::Pose2 target(1, 2, 0.3);
+  ConsensusFactor factor(0, gtsam::GenericValue<gtsam::Pose2>(target), model);
+
+  Values x;
+  x.insert(0, target);
+  EXPECT(assert_equal(gtsam::Vector3::Zero().eval(),
+                      factor.unwhitenedError(x), 1e-9));
+
+  const gtsam::Vector3 delta(0.1, -0.2, 0.05);
+  Values y;
+  y.insert(0, target.retract(delta));
+  std::vector<gtsam::Matrix> H(1);
+  EXPECT(assert_equal(gtsam::Vector(delta), factor.unwhitenedError(y, H),
+                      1e-9));
+  EXPECT(assert_equal(gtsam::Matrix(gtsam::Matrix3::Identity()), H[0]));
+}
+
+// Three blocks of consecutive time steps converge to the batch solution.
+TEST(MultipleShootingOptimizer, Blocks) {
+  using namespace example;
+  const NonlinearFactorGraph full = graph();
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(full, init()).optimize();
+
+  MultipleShootingParameters params;
+  params.rho = 1e4;
+  params.max_iterations = 200;
+  params.tolerance = 1e-7;
+  MultipleShootingOptimizer optimizer(params);
+  auto block_of_key = [](gtsam::Key key) -> size_t {
+    return DynamicsSymbol(key).time() / 4;
+  };
+  size_t iterations = 0;
+  const Values result =
+      optimizer.optimize(full, init(), 3, block_of_key, &iterations);
+
+  EXPECT(assert_equal(expected, result, 1e-3));
+  EXPECT(iterations > 1);
+  EXPECT(iterations <= params.max_iterations);
+}
+
+// A single block is a plain optimization and needs one iteration.
+TEST(MultipleShootingOptimizer, SingleBlock) {
+  using namespace example;
+  const NonlinearFactorGraph full = graph();
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(full, init()).optimize();
+
+  MultipleShootingOptimizer optimizer;
+  size_t iterations = 0;
+  const Values result = optimizer.optimize(
+      full, init(), 1, [](gtsam::Key) -> size_t { return 0; }, &iterations);
+  EXPECT(assert_equal(expected, result, 1e-6));
+  EXPECT_LONGS_EQUAL(1, iterations);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
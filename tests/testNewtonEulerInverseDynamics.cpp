@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNewtonEulerInverseDynamics.cpp
+ * @brief Test recursive Newton-Euler inverse dynamics against linearSolveID.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Create kinematics and accelerations with non-trivial values for every joint.
+Values movingValues(const Robot& robot, int t,
+                    const boost::optional<std::string>& root = boost::none) {
+  Values values;
+  double angle = 0.3, vel = -0.7;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), t, angle);
+    InsertJointVel(&values, joint->id(), t, vel);
+    angle = -0.8 * angle + 0.1, vel = 0.5 - 0.6 * vel;
+  }
+  Values known_values = robot.forwardKinematics(values, t, root);
+  double accel = 1.5;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAccel(&known_values, joint->id(), t, accel);
+    accel = 0.4 - 0.7 * accel;
+  }
+  return known_values;
+}
+
+// Check torques, wrenches and twist accelerations against linearSolveID.
+void checkAgainstGraph(const Robot& robot, const Values& known_values, int t,
+                       const gtsam::Vector3& gravity, double tol) {
+  DynamicsGraph graph_builder(gravity);
+  Values expected = graph_builder.linearSolveID(robot, t, known_values);
+
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  Values actual = rnea.solve(t, known_values);
+
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(Torque(expected, j, t), Torque(actual, j, t), tol);
+    for (auto&& link : joint->links()) {
+      EXPECT(assert_equal(Wrench(expected, link->id(), j, t),
+                          Wrench(actual, link->id(), j, t), tol));
+    }
+  }
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(TwistAccel(expected, link->id(), t),
+                        TwistAccel(actual, link->id(), t), tol));
+  }
+}
+
+// Two-link robot with a floating base, same setup as testDynamicsGraph.
+TEST(NewtonEulerInverseDynamics, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  int j = robot.joint("j1")->id();
+  int t = 777;
+
+  Values values;
+  InsertPose(&values, l1->id(), t, l1->bMcom());
+  InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+  Values known_values = robot.forwardKinematics(values, t, std::string("l1"));
+  InsertJointAccel(&known_values, j, t, 4.0);
+
+  NewtonEulerInverseDynamics rnea(robot, simple_urdf_eq_mass::gravity);
+  Values result = rnea.solve(t, known_values);
+  EXPECT(assert_equal(1.0, Torque(result, j, t), 1e-6));
+
+  checkAgainstGraph(robot, known_values, t, simple_urdf_eq_mass::gravity,
+                    1e-6);
+}
+
+// Serial chain with a fixed base, in motion under gravity.
+TEST(NewtonEulerInverseDynamics, simple_rr_moving) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  checkAgainstGraph(robot, movingValues(robot, 5), 5,
+                    gtsam::Vector3(0, 0, -9.8), 1e-6);
+}
+
+// Floating-base quadruped.
+TEST(NewtonEulerInverseDynamics, a1) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  checkAgainstGraph(robot, movingValues(robot, 0, std::string("trunk")), 0,
+                    gtsam::Vector3(0, 0, -9.8), 1e-5);
+}
+
+// Inverse dynamics recovers the torques applied in forward dynamics.
+TEST(NewtonEulerInverseDynamics, round_trip) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Vector3 gravity(0, 0, -9.8);
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+
+  Values known_values = movingValues(robot, 0);
+  rnea.solve(0, known_values);
+  Vector torques = rnea.torques();
+
+  std::vector<gtsam::Pose3> poses;
+  std::vector<gtsam::Vector6> twists;
+  for (auto&& link : robot.links()) {
+    poses.push_back(Pose(known_values, link->id()));
+    twists.push_back(Twist(known_values, link->id()));
+  }
+  Vector joint_vels = DynamicsGraph::jointVels(robot, known_values, 0);
+  aba.solve(poses, twists, joint_vels, torques);
+  EXPECT(assert_equal(DynamicsGraph::jointAccels(robot, known_values, 0),
+                      aba.jointAccels(), 1e-9));
+}
+
+// Closed chains are rejected.
+TEST(NewtonEulerInverseDynamics, four_bar_linkage_pure) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  CHECK_EXCEPTION(NewtonEulerInverseDynamics rnea(robot),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNoiseModels.cpp
+ * @brief Test interned noise models and whitening.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::Vector3;
+namespace noiseModel = gtsam::noiseModel;
+
+// Equal arguments give the same model, equal to the one gtsam creates.
+TEST(NoiseModels, intern) {
+  const auto isotropic = SharedIsotropic(3, 0.25);
+  EXPECT(isotropic == SharedIsotropic(3, 0.25));
+  EXPECT(isotropic != SharedIsotropic(3, 0.5));
+  EXPECT(isotropic != SharedIsotropic(2, 0.25));
+  EXPECT(assert_equal(*noiseModel::Isotropic::Sigma(3, 0.25), *isotropic));
+  EXPECT(dynamic_cast<const noiseModel::Unit *>(SharedIsotropic(2, 1).get()));
+
+  const auto constrained = SharedConstrained(6);
+  EXPECT(constrained == SharedConstrained(6));
+  EXPECT(constrained->isConstrained());
+
+  // Diagonal models are interned after smart construction.
+  EXPECT(SharedDiagonal(Vector3(0.1, 0.2, 0.3)) ==
+         SharedDiagonal(Vector3(0.1, 0.2, 0.3)));
+  EXPECT(SharedDiagonal(Vector3::Constant(0.25)) == isotropic);
+
+  // Models created elsewhere are registered once.
+  const gtsam::SharedNoiseModel diagonal =
+      noiseModel::Diagonal::Sigmas(Vector3(0.7, 0.8, 0.9));
+  EXPECT(InternNoiseModel(diagonal) == diagonal);
+  EXPECT(InternNoiseModel(noiseModel::Diagonal::Sigmas(
+             Vector3(0.7, 0.8, 0.9))) == diagonal);
+  EXPECT(InternNoiseModel(noiseModel::Isotropic::Sigma(3, 0.25)) == isotropic);
+  const size_t num_models = NumInternedNoiseModels();
+  const auto robust = noiseModel::Robust::Create(
+      noiseModel::mEstimator::Huber::Create(1.0), isotropic);
+  EXPECT(InternNoiseModel(robust) == robust);
+  EXPECT_LONGS_EQUAL(num_models, NumInternedNoiseModels());
+}
+
+// Settings share the models of equal sigmas.
+TEST(NoiseModels, OptimizerSetting) {
+  const OptimizerSetting a, b(0.001);
+  EXPECT(a.p_cost_model == b.p_cost_model);
+  EXPECT(a.p_cost_model == a.v_cost_model);
+  EXPECT(a.t_cost_model == b.jl_cost_model);
+}
+
+// Precomputed whitening agrees with the noise models.
+TEST(NoiseModels, whitener) {
+  const Vector e = Vector3(1, -2, 3);
+  const Matrix H = (Matrix(3, 2) << 1, 2, 3, 4, 5, 6).finished();
+  for (const gtsam::SharedNoiseModel &model :
+       {gtsam::SharedNoiseModel(SharedIsotropic(3, 0.1)),
+        gtsam::SharedNoiseModel(SharedIsotropic(3, 1.0)),
+        gtsam::SharedNoiseModel(SharedDiagonal(Vector3(0.1, 0.2, 0.3)))}) {
+    const NoiseModelWhitener whitener(model);
+    EXPECT(assert_equal(model->whiten(e), whitener.whiten(e)));
+
+    std::vector<Matrix> expected_H{H}, actual_H{H};
+    Vector expected_e = e, actual_e = e;
+    model->WhitenSystem(expected_H, expected_e);
+    whitener.whitenSystem(actual_H, actual_e);
+    EXPECT(assert_equal(expected_e, actual_e));
+    EXPECT(assert_equal(expected_H[0], actual_H[0]));
+  }
+  EXPECT(NoiseModelWhitener(SharedIsotropic(3, 1.0)).isUnit());
+  EXPECT(!NoiseModelWhitener(SharedIsotropic(3, 0.1)).isUnit());
+  EXPECT(NoiseModelWhitener().isUnit());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -78,6 +78,67 @@ TEST(ObjectiveFactors, OptionalNoiseModels) {
   EXPECT_LONGS_EQUAL(5, graph.size());
 }
 
+TEST(ObjectiveFactors, BulkKeys) {
+  const gtsam::KeyVector keys = JointKeys("T", {2, 0}, 3, 10);
+  EXPECT_LONGS_EQUAL(6, keys.size());
+  EXPECT_LONGS_EQUAL(TorqueKey(2, 10), keys[0]);
+  EXPECT_LONGS_EQUAL(TorqueKey(0, 10), keys[1]);
+  EXPECT_LONGS_EQUAL(TorqueKey(0, 12), keys[5]);
+  EXPECT_LONGS_EQUAL(PoseKey(4, 1), LinkKeys("p", {3, 4}, 2)[3]);
+}
+
+TEST(ObjectiveFactors, BulkPriors) {
+  const gtsam::KeyVector keys = JointKeys("q", {0, 1}, 2);
+  auto graph = DoublePriorFactors(keys, gtsam::Vector1(0.5), kModel1);
+  EXPECT_LONGS_EQUAL(4, graph.size());
+  auto prior =
+      boost::dynamic_pointer_cast<gtsam::PriorFactor<double>>(graph[3]);
+  CHECK(prior);
+  EXPECT_LONGS_EQUAL(JointAngleKey(1, 1), prior->key());
+  EXPECT_DOUBLES_EQUAL(0.5, prior->prior(), 0);
+  graph = DoublePriorFactors(keys, gtsam::Vector4(1, 2, 3, 4), kModel1);
+  EXPECT_DOUBLES_EQUAL(
+      3,
+      boost::dynamic_pointer_cast<gtsam::PriorFactor<double>>(graph[2])
+          ->prior(),
+      0);
+  CHECK_EXCEPTION(DoublePriorFactors(keys, gtsam::Vector2(1, 2), kModel1),
+                  std::invalid_argument);
+
+  const std::vector<Pose3> poses{Pose3(),
+                                 Pose3(gtsam::Rot3(), Point3(1, 0, 0))};
+  graph = PosePriorFactors(LinkKeys("p", {5}, 2), poses, kModel6);
+  EXPECT_LONGS_EQUAL(2, graph.size());
+  EXPECT_LONGS_EQUAL(PoseKey(5, 1), graph[1]->front());
+  CHECK_EXCEPTION(PosePriorFactors(LinkKeys("p", {5}, 3), poses, kModel6),
+                  std::invalid_argument);
+}
+
+TEST(ObjectiveFactors, RobotHorizon) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+  const size_t num_joints = robot.numJoints(), num_steps = 3, k = 5;
+
+  gtsam::Matrix angles = gtsam::Matrix::Zero(num_steps, num_joints);
+  angles(2, 7) = 0.25;
+  auto graph = JointPriorObjectives(robot, "q", angles, kModel1, k);
+  EXPECT_LONGS_EQUAL(num_steps * num_joints, graph.size());
+  gtsam::Values values;
+  for (size_t t = k; t < k + num_steps; t++) {
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertJointAngle(&values, j, t, 0.0);
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(0.5 * 0.25 * 0.25, graph.error(values), 1e-12);
+  CHECK_EXCEPTION(JointPriorObjectives(robot, "q", angles.leftCols(2),
+                                       kModel1, k),
+                  std::invalid_argument);
+
+  graph = MinTorqueObjectives(robot, num_steps, kModel1, k);
+  EXPECT_LONGS_EQUAL(num_steps * num_joints, graph.size());
+  EXPECT(graph.keys().exists(TorqueKey(num_joints - 1, k + num_steps - 1)));
+}
+
 TEST(Phase, AddGoals) {
   Robot robot =
       CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"), "spider");
@@ -89,7 +150,7 @@ TEST(Phase, AddGoals) {
   auto LF = robot.link("lower0");  // left forward leg
   Point3 stance_point = LF->bMcom().transformFrom(point_com);
 
-  uint8_t id = LF->id();
+  uint16_t id = LF->id();
   constexpr size_t num_stance_steps = 10;
   constexpr size_t k = 777;
   const gtsam::SharedNoiseModel &cost_model = kModel3;
@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testObstacleSDFFactor.cpp
+ * @brief Test signed distance fields and obstacle avoidance factors.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ObstacleSDFFactor.h>
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+const Point3 origin(1, -1, 0.5);
+const double cell_size = 0.5;
+const std::string sdf_path = "testObstacleSDFFactor.gtdsdf";
+const std::string txt_path = "testObstacleSDFFactor.txt";
+
+// Grid of 5 rows, 6 columns and 4 slices sampling f.
+template <class F>
+SignedDistanceField Field(const F &f) {
+  std::vector<gtsam::Matrix> slices;
+  for (size_t z = 0; z < 4; z++) {
+    gtsam::Matrix slice(5, 6);
+    for (size_t row = 0; row < 5; row++) {
+      for (size_t col = 0; col < 6; col++) {
+        slice(row, col) = f(origin + cell_size * Point3(col, row, z));
+      }
+    }
+    slices.push_back(slice);
+  }
+  return SignedDistanceField(origin, cell_size, slices);
+}
+
+// Signed distance to the plane x + 2y - z = 0, up to scale.
+double Plane(const Point3 &p) { return p.x() + 2 * p.y() - p.z(); }
+
+double Wavy(const Point3 &p) { return std::sin(3 * Plane(p)); }
+}  // namespace example
+
+// Trilinear interpolation is exact for linear fields, and has the gradient
+// of the interpolant.
+TEST(SignedDistanceField, distance) {
+  using namespace example;
+  const SignedDistanceField plane = Field(Plane);
+  gtsam::Matrix13 H;
+  const Point3 p(2.1, -0.3, 1.2);
+  EXPECT_DOUBLES_EQUAL(Plane(p), plane.distance(p, H), 1e-6);
+  EXPECT(assert_equal(gtsam::Matrix13(1, 2, -1), H, 1e-6));
+
+  const SignedDistanceField wavy = Field(Wavy);
+  EXPECT_DOUBLES_EQUAL(Wavy(origin + cell_size * Point3(3, 2, 1)),
+                       wavy.distance(origin + cell_size * Point3(3, 2, 1)),
+                       1e-6);
+  auto f = [&](const Point3 &q) { return wavy.distance(q); };
+  wavy.distance(p, H);
+  EXPECT(assert_equal(gtsam::numericalDerivative11<double, Point3>(f, p), H,
+                      1e-5));
+
+  // Outside the grid along x, the distance is that at the boundary.
+  const Point3 outside(10, -0.3, 1.2), boundary(3.5, -0.3, 1.2);
+  EXPECT_DOUBLES_EQUAL(plane.distance(boundary), plane.distance(outside, H),
+                       1e-9);
+  EXPECT_DOUBLES_EQUAL(0, H(0), 1e-9);
+}
+
+// Binary files map back to the same field, and text files convert.
+TEST(SignedDistanceField, save) {
+  using namespace example;
+  const SignedDistanceField field = Field(Wavy);
+  field.save(sdf_path);
+  const SignedDistanceField loaded = SignedDistanceField::Load(sdf_path);
+  EXPECT(assert_equal(origin, loaded.origin()));
+  EXPECT_DOUBLES_EQUAL(cell_size, loaded.cellSize(), 0);
+  EXPECT_LONGS_EQUAL(5, loaded.rows());
+  EXPECT_LONGS_EQUAL(6, loaded.cols());
+  EXPECT_LONGS_EQUAL(4, loaded.depth());
+  const Point3 p(2.1, -0.3, 1.2);
+  EXPECT_DOUBLES_EQUAL(field.distance(p), loaded.distance(p), 0);
+  std::remove(sdf_path.c_str());
+
+  {
+    std::ofstream os(txt_path);
+    os << origin.x() << " " << origin.y() << " " << origin.z() << "\n"
+       << cell_size << "\n5 6 4\n";
+    for (size_t z = 0; z < 4; z++) {
+      for (size_t row = 0; row < 5; row++) {
+        for (size_t col = 0; col < 6; col++) {
+          os << field.cell(row, col, z) << " ";
+        }
+      }
+    }
+  }
+  const SignedDistanceField text = SignedDistanceField::LoadTxt(txt_path);
+  EXPECT_DOUBLES_EQUAL(field.distance(p), text.distance(p), 1e-5);
+  std::remove(txt_path.c_str());
+
+  CHECK_EXCEPTION(SignedDistanceField::Load(txt_path), std::runtime_error);
+}
+
+// The hinge loss vanishes away from obstacles, with correct Jacobians near
+// them.
+TEST(ObstacleSDFFactor, error) {
+  using namespace example;
+  auto sdf = std::make_shared<const SignedDistanceField>(Field(Plane));
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  const Point3 comPc(0.1, 0, 0);
+  const ObstacleSDFFactor factor(0, cost_model, sdf, comPc, 0.2, 0.05);
+
+  // Sphere center at distance 1.35 from the plane.
+  gtsam::Values values;
+  values.insert(0, Pose3(Rot3::Rz(0.3), Point3(2.0, 0.4, 0.8)));
+  EXPECT_DOUBLES_EQUAL(0, factor.unwhitenedError(values)(0), 1e-9);
+
+  // Sphere center at distance 0.15, closer than radius plus clearance.
+  values.update(0, Pose3(Rot3::Rz(0.3), Point3(1.0, 0.0, 1.0)));
+  const double d = Plane(values.at<Pose3>(0).transformFrom(comPc));
+  EXPECT_DOUBLES_EQUAL(0.25 - d, factor.unwhitenedError(values)(0), 1e-6);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  const auto graph = ObstacleSDFFactors(
+      0, cost_model, sdf, sphereCenters({0.4}, {0.1})[0], 0.1, 0.05);
+  EXPECT_LONGS_EQUAL(4, graph.size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
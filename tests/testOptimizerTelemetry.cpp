@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOptimizerTelemetry.cpp
+ * @brief Test the per-iteration records of optimizers.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <memory>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::ExpressionFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+using namespace constrained_example;
+auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+
+// Two nonlinear costs on x1 and x2.
+NonlinearFactorGraph Graph() {
+  NonlinearFactorGraph graph;
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+// x1 + x1^3 + x2 + x2^2 = 0.
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.push_back(EqualityConstraint::shared_ptr(
+      new DoubleExpressionEquality(g1, 1.0)));
+  return constraints;
+}
+
+Values InitialValues() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+// Every LM iteration of a solve is recorded, and reaches the callback.
+TEST(OptimizerTelemetry, Optimizer) {
+  using namespace example;
+  auto telemetry = std::make_shared<OptimizerTelemetry>();
+  size_t num_callbacks = 0;
+  telemetry->onIteration([&](const IterationRecord &) { num_callbacks++; });
+
+  OptimizationParameters params;
+  params.telemetry = telemetry;
+  const NonlinearFactorGraph graph = Graph();
+  const Values result = Optimizer(params).optimize(graph, InitialValues());
+  Optimizer(params).optimize(graph, InitialValues());
+
+  const auto solves = telemetry->solves();
+  const auto iterations = telemetry->iterations();
+  EXPECT_LONGS_EQUAL(2, solves.size());
+  EXPECT_LONGS_EQUAL(0, solves[0].solve);
+  EXPECT_LONGS_EQUAL(1, solves[1].solve);
+  EXPECT(solves[0].iterations > 0);
+  EXPECT_LONGS_EQUAL(2 * solves[0].iterations, iterations.size());
+  EXPECT_LONGS_EQUAL(iterations.size(), num_callbacks);
+  EXPECT_DOUBLES_EQUAL(graph.error(InitialValues()), solves[0].initial_error,
+                       1e-9);
+  EXPECT_DOUBLES_EQUAL(graph.error(result), solves[0].error, 1e-9);
+  EXPECT(std::isnan(solves[0].mu) && std::isnan(solves[0].violation));
+
+  double previous_error = solves[0].initial_error;
+  for (size_t i = 0; i < solves[0].iterations; i++) {
+    const IterationRecord &record = iterations[i];
+    EXPECT_LONGS_EQUAL(i + 1, record.iteration);
+    EXPECT(record.error <= previous_error);
+    EXPECT(record.lambda > 0 && record.linear_solves > 0);
+    EXPECT(record.linearize_seconds >= 0 && record.solve_seconds >= 0);
+    EXPECT(record.solve_seconds <= solves[0].seconds);
+    previous_error = record.error;
+  }
+  EXPECT_DOUBLES_EQUAL(solves[0].error, previous_error, 1e-9);
+
+  telemetry->clear();
+  EXPECT_LONGS_EQUAL(0, telemetry->iterations().size());
+  EXPECT_LONGS_EQUAL(0, telemetry->beginSolve());
+}
+
+// A sink that keeps no trace only calls back.
+TEST(OptimizerTelemetry, keep_trace) {
+  using namespace example;
+  auto telemetry = std::make_shared<OptimizerTelemetry>(false);
+  size_t num_solves = 0;
+  telemetry->onSolve([&](const SolveRecord &) { num_solves++; });
+  OptimizationParameters params;
+  params.telemetry = telemetry;
+  Optimizer(params).optimize(Graph(), InitialValues());
+  EXPECT_LONGS_EQUAL(1, num_solves);
+  EXPECT_LONGS_EQUAL(0, telemetry->solves().size());
+  EXPECT_LONGS_EQUAL(0, telemetry->iterations().size());
+}
+
+// Constrained methods record every inner solve with its penalty parameter
+// and violation, and SQP its iterations.
+TEST(OptimizerTelemetry, Constrained) {
+  using namespace example;
+  auto telemetry = std::make_shared<OptimizerTelemetry>();
+  AugmentedLagrangianParameters al_params;
+  al_params.telemetry = telemetry;
+  AugmentedLagrangianOptimizer(al_params).optimize(Graph(), Constraints(),
+                                                   InitialValues());
+  auto solves = telemetry->solves();
+  EXPECT_LONGS_EQUAL(al_params.num_iterations, solves.size());
+  EXPECT_DOUBLES_EQUAL(1.0, solves[0].mu, 1e-9);
+  EXPECT(solves.back().violation <= solves[0].violation);
+
+  telemetry->clear();
+  SQPParameters sqp_params;
+  sqp_params.telemetry = telemetry;
+  SQPOptimizer(sqp_params).optimize(Graph(), Constraints(), InitialValues());
+  solves = telemetry->solves();
+  const auto iterations = telemetry->iterations();
+  EXPECT_LONGS_EQUAL(1, solves.size());
+  EXPECT_LONGS_EQUAL(solves[0].iterations, iterations.size());
+  EXPECT_DOUBLES_EQUAL(iterations.back().violation, solves[0].violation,
+                       1e-9);
+  EXPECT_DOUBLES_EQUAL(iterations.back().error, solves[0].error, 1e-9);
+  EXPECT(solves[0].violation <= iterations[0].violation);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
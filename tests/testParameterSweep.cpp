@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testParameterSweep.cpp
+ * @brief Test solving problems over a parameter grid in parallel.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/ParameterSweep.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const std::string results_path = "testParameterSweep.csv";
+const gtsam::Key key = JointAngleKey(0);
+const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+ParameterGrid grid() {
+  return ParameterGrid().add("a", {1, 2, 3}).add("b", {10, 20});
+}
+
+// A prior pulling the angle of joint 0 to a + b.
+SweepProblem problem(double a, double b) {
+  SweepProblem problem;
+  problem.graph.emplace_shared<gtsam::PriorFactor<double>>(key, a + b, model);
+  problem.initial_values.insert(key, 0.0);
+  return problem;
+}
+}  // namespace example
+
+// Points are indexed with the last parameter varying fastest.
+TEST(ParameterGrid, point) {
+  const ParameterGrid grid = example::grid();
+  EXPECT_LONGS_EQUAL(6, grid.size());
+  EXPECT(grid.names() == std::vector<std::string>({"a", "b"}));
+  const DesignPoint point = grid.point(3);
+  EXPECT_DOUBLES_EQUAL(2, point.at("a"), 0);
+  EXPECT_DOUBLES_EQUAL(20, point.at("b"), 0);
+  CHECK_EXCEPTION(grid.point(6), std::out_of_range);
+
+  EXPECT_LONGS_EQUAL(1, ParameterGrid().size());
+  CHECK_EXCEPTION(ParameterGrid().add("a", {}), std::invalid_argument);
+  CHECK_EXCEPTION(example::grid().add("a", {4}), std::invalid_argument);
+}
+
+// Every point is solved, a failing one is recorded, and all are written.
+TEST(ParameterSweep, run) {
+  const ParameterSweep sweep(example::grid(), OptimizationParameters(),
+                             {example::key}, 4);
+  const auto results = sweep.run(
+      [](const DesignPoint &point) {
+        if (point.at("a") == 3 && point.at("b") == 20) {
+          throw std::runtime_error("no such design");
+        }
+        return example::problem(point.at("a"), point.at("b"));
+      },
+      example::results_path);
+
+  EXPECT_LONGS_EQUAL(6, results.size());
+  for (size_t index = 0; index < 5; index++) {
+    const SweepResult &result = results[index];
+    EXPECT_LONGS_EQUAL(index, result.index);
+    EXPECT(result.solved);
+    EXPECT(result.initial_error > 0);
+    EXPECT_DOUBLES_EQUAL(0, result.error, 1e-9);
+    EXPECT_DOUBLES_EQUAL(result.point.at("a") + result.point.at("b"),
+                         result.outputs.at(0), 1e-6);
+  }
+  EXPECT(!results[5].solved);
+  EXPECT(results[5].message == "no such design");
+
+  // A header, then one line per point in order of completion.
+  std::ifstream is(example::results_path);
+  std::string line;
+  std::getline(is, line);
+  EXPECT(line == "index,a,b,solved,initial_error,error,seconds,q(0)0");
+  std::set<std::string> indices;
+  while (std::getline(is, line)) {
+    indices.insert(line.substr(0, line.find(',')));
+  }
+  EXPECT(indices == std::set<std::string>({"0", "1", "2", "3", "4", "5"}));
+  is.close();
+  std::remove(example::results_path.c_str());
+}
+
+// Problems built beforehand are solved the same way.
+TEST(ParameterSweep, solve) {
+  const ParameterGrid grid = ParameterGrid().add("a", {1, 2});
+  const ParameterSweep sweep(grid, OptimizationParameters(), {example::key});
+  std::vector<NonlinearFactorGraph> graphs;
+  std::vector<Values> initial_values;
+  for (size_t index = 0; index < grid.size(); index++) {
+    const SweepProblem problem =
+        example::problem(grid.point(index).at("a"), 0);
+    graphs.push_back(problem.graph);
+    initial_values.push_back(problem.initial_values);
+  }
+  const auto results = sweep.solve(graphs, initial_values);
+  EXPECT_LONGS_EQUAL(2, results.size());
+  EXPECT_DOUBLES_EQUAL(2, results[1].outputs.at(0), 1e-6);
+
+  graphs.pop_back();
+  CHECK_EXCEPTION(sweep.solve(graphs, initial_values),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
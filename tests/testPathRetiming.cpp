@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPathRetiming.cpp
+ * @brief Test time-optimal path retiming under joint limits.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/dynamics/PathRetiming.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Vector;
+using gtsam::Vector2;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const gtsam::Vector3 gravity(0, 0, -9.81);
+const std::vector<Vector> waypoints = {Vector2(-1.0, 0.5), Vector2(0.0, 1.2),
+                                       Vector2(0.8, 0.3)};
+}  // namespace example
+
+// The spline passes through the waypoints, at chord-length parameters.
+TEST(PathRetiming, Spline) {
+  using example::waypoints;
+  const double l1 = (waypoints[1] - waypoints[0]).norm(),
+               l2 = (waypoints[2] - waypoints[1]).norm();
+  gtsam::Matrix q, dq, ddq;
+  PathRetiming::Spline(waypoints, {0.0, l1 / (l1 + l2), 1.0}, &q, &dq, &ddq);
+  for (size_t k = 0; k < 3; k++) {
+    EXPECT(assert_equal(waypoints[k], Vector(q.row(k).transpose()), 1e-9));
+  }
+  // Natural spline: no curvature at the ends.
+  EXPECT(assert_equal(Vector(Vector2::Zero()), Vector(ddq.row(0).transpose()),
+                      1e-9));
+  EXPECT(assert_equal(Vector(Vector2::Zero()), Vector(ddq.row(2).transpose()),
+                      1e-9));
+}
+
+// Under acceleration limits only, a straight path is bang-bang, which the
+// discretization is exact for.
+TEST(PathRetiming, BangBang) {
+  PathRetimingParameters parameters;
+  parameters.num_gridpoints = 101;
+  parameters.torque_limits = false;
+  parameters.velocity_limits = false;
+  PathRetiming retiming(example::robot, example::gravity, parameters);
+
+  const Vector start = Vector2(-1.0, 0.5), goal = Vector2(0.5, 0.0);
+  auto path = retiming.retime({start, goal});
+  CHECK(path);
+
+  const double a_max =
+      example::robot.joints()[0]->parameters().acceleration_limit;
+  const double L = (goal - start).cwiseAbs().maxCoeff();
+  EXPECT_DOUBLES_EQUAL(2.0 * std::sqrt(L / a_max), path->duration(), 1e-9);
+  EXPECT(assert_equal(start, Vector(path->angles.row(0).transpose()), 1e-9));
+  EXPECT(assert_equal(goal, Vector(path->angles.row(100).transpose()), 1e-9));
+  EXPECT_DOUBLES_EQUAL(0.0, path->vels.row(100).norm(), 1e-9);
+
+  Vector q, v;
+  path->sample(0.5 * path->duration(), &q, &v);
+  EXPECT(assert_equal(Vector(0.5 * (start + goal)), q, 1e-9));
+}
+
+// Torques match inverse dynamics along the retimed path, all limits hold,
+// and at least one is reached.
+TEST(PathRetiming, TorqueLimits) {
+  using example::robot;
+  PathRetiming retiming(robot, example::gravity);
+  auto path = retiming.retime(example::waypoints);
+  CHECK(path);
+  const size_t G = retiming.parameters().num_gridpoints;
+  LONGS_EQUAL(G, path->times.size());
+  for (size_t i = 1; i < G; i++) CHECK(path->times[i] > path->times[i - 1]);
+  EXPECT_DOUBLES_EQUAL(0.0, path->vels.row(0).norm(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, path->vels.row(G - 1).norm(), 1e-9);
+
+  BatchForwardKinematics fk(robot);
+  NewtonEulerInverseDynamics id(robot, example::gravity);
+  double tightest = 0.0;
+  for (size_t i = 0; i < G; i += 11) {
+    fk.compute(path->angles.row(i), path->vels.row(i));
+    std::vector<gtsam::Pose3> poses;
+    std::vector<gtsam::Vector6> twists;
+    for (auto&& link : robot.links()) {
+      poses.push_back(fk.pose(0, link->id()));
+      twists.push_back(fk.twist(0, link->id()));
+    }
+    id.solve(poses, twists, path->vels.row(i).transpose(),
+             path->accels.row(i).transpose());
+    EXPECT(assert_equal(id.torques(), Vector(path->torques.row(i).transpose()),
+                        1e-6));
+  }
+  for (size_t i = 0; i < G; i++) {
+    for (size_t j = 0; j < robot.numJoints(); j++) {
+      const JointParams& params = robot.joints()[j]->parameters();
+      const double ratios[] = {
+          std::abs(path->torques(i, j)) / params.torque_limit,
+          std::abs(path->vels(i, j)) / params.velocity_limit,
+          std::abs(path->accels(i, j)) / params.acceleration_limit};
+      for (double ratio : ratios) {
+        CHECK(ratio < 1.0 + 1e-6);
+        tightest = std::max(tightest, ratio);
+      }
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(1.0, tightest, 1e-6);
+}
+
+// Waypoints from the joint angles of a range of time steps.
+TEST(PathRetiming, Waypoints) {
+  using example::robot;
+  gtsam::Values values;
+  for (size_t k = 0; k < 3; k++) {
+    for (size_t j = 0; j < 2; j++) {
+      InsertJointAngle(&values, robot.joints()[j]->id(), k,
+                       example::waypoints[k](j));
+    }
+  }
+  const auto waypoints = PathRetiming::Waypoints(robot, values, 1, 2);
+  LONGS_EQUAL(2, waypoints.size());
+  EXPECT(assert_equal(example::waypoints[1], waypoints[0]));
+  EXPECT(assert_equal(example::waypoints[2], waypoints[1]));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
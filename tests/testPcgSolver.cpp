@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPcgSolver.cpp
+ * @brief Test conjugate gradients with a block-Jacobi preconditioner.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/PcgSolver.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::I_1x1;
+using gtsam::Vector1;
+
+namespace example {
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const int num_steps = 5;
+auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// Forward dynamics of a single joint under constant torque.
+gtsam::NonlinearFactorGraph Graph() {
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  return graph;
+}
+}  // namespace example
+
+// Conjugate gradients give the solution of elimination.
+TEST(PcgSolve, trajectory) {
+  using namespace example;
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps, -1,
+                                                     0.1);
+  const auto linear = Graph().linearize(init);
+  PcgParameters parameters;
+  parameters.relative_tolerance = 1e-12;
+  PcgStatistics statistics;
+  EXPECT(assert_equal(linear->optimize(),
+                      PcgSolve(*linear, parameters, &statistics), 1e-6));
+  EXPECT(statistics.iterations > 0);
+  EXPECT(statistics.relative_residual < 1e-6);
+
+  parameters.num_threads = 1;
+  EXPECT(assert_equal(linear->optimize(), PcgSolve(*linear, parameters),
+                      1e-6));
+  EXPECT_LONGS_EQUAL(0, PcgSolve(gtsam::GaussianFactorGraph()).size());
+}
+
+// Global variables and factors on any steps are allowed, but the system
+// must be positive definite, without hard constraints.
+TEST(PcgSolve, structure) {
+  using example::model;
+  gtsam::GaussianFactorGraph graph;
+  graph.add(JointAngleKey(0, 0), I_1x1, Vector1(1), model);
+  graph.add(JointAngleKey(0, 0), I_1x1, JointAngleKey(0, 2), -I_1x1,
+            Vector1(0), model);
+  graph.add(PhaseKey(0), I_1x1, JointAngleKey(0, 2), I_1x1, Vector1(3),
+            model);
+  graph.add(PhaseKey(0), 2 * I_1x1, Vector1(0), model);
+  EXPECT(assert_equal(graph.optimize(), PcgSolve(graph), 1e-9));
+
+  gtsam::GaussianFactorGraph constrained_graph;
+  constrained_graph.add(JointAngleKey(0, 0), I_1x1, Vector1(1),
+                        gtsam::noiseModel::Constrained::All(1));
+  CHECK_EXCEPTION(PcgSolve(constrained_graph), std::invalid_argument);
+
+  // A variable without information is indeterminant.
+  gtsam::GaussianFactorGraph singular_graph;
+  singular_graph.add(JointAngleKey(0, 0), I_1x1, JointAngleKey(0, 1),
+                     gtsam::Z_1x1, Vector1(1), model);
+  CHECK_EXCEPTION(PcgSolve(singular_graph),
+                  gtsam::IndeterminantLinearSystemException);
+}
+
+// LM with the PCG solver converges to the same trajectory.
+TEST(PcgSolve, Optimizer) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters params;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.pcg_solver = PcgParameters();
+  const auto actual = Optimizer(params).optimize(graph, init);
+  EXPECT(assert_equal(expected, actual, 1e-5));
+  EXPECT_DOUBLES_EQUAL(JointAngle(expected, j, num_steps),
+                       JointAngle(actual, j, num_steps), 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -57,6 +57,43 @@ TEST(PenaltyMethodOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+// Metrics only, with the values streamed through a callback.
+TEST(PenaltyMethodOptimizer, MetricsOnly) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 1., x1));
+  graph.add(ExpressionFactor<double>(cost_noise, 2., x2));
+
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(x1 + x2, 1e-3);
+
+  Values init_values;
+  init_values.insert(x1_key, 3.0);
+  init_values.insert(x2_key, -7.0);
+
+  ConstrainedOptResult info;
+  info.store_values = false;
+  std::vector<size_t> iterations;
+  Values last;
+  info.callback = [&](size_t iteration, const Values& values) {
+    iterations.push_back(iteration);
+    last = values;
+  };
+  PenaltyMethodParameters params;
+  params.num_iterations = 4;
+  gtdynamics::PenaltyMethodOptimizer optimizer(params);
+  Values results = optimizer.optimize(graph, constraints, init_values, &info);
+
+  EXPECT(info.intermediate_values.empty());
+  EXPECT_LONGS_EQUAL(4, info.size());
+  EXPECT_LONGS_EQUAL(4, info.mu_values.size());
+  EXPECT_LONGS_EQUAL(4, info.violations.size());
+  EXPECT_LONGS_EQUAL(4, iterations.size());
+  EXPECT_LONGS_EQUAL(3, iterations.back());
+  EXPECT(assert_equal(results, last));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanarDynamics.cpp
+ * @brief Test planar robots, dynamics graphs and forward dynamics.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/PlanarDynamicsGraph.h>
+#include <gtdynamics/dynamics/PlanarForwardDynamics.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/PlanarRobot.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+Robot fixedRobot() { return simple_rr::getRobot().fixLink("link_0"); }
+
+// Joint angles, velocities and torques with non-trivial values.
+Values movingValues(const Robot& robot) {
+  Values values;
+  double angle = 0.3, vel = -0.7, torque = 0.2;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), angle);
+    InsertJointVel(&values, joint->id(), vel);
+    InsertTorque(&values, joint->id(), torque);
+    angle = -0.8 * angle + 0.1, vel = 0.5 - 0.6 * vel, torque = 0.3 - torque;
+  }
+  return values;
+}
+}  // namespace
+
+// Conversions between planar and spatial quantities round-trip.
+TEST(PlanarRobot, conversions) {
+  auto robot = fixedRobot();
+  PlanarRobot planar(robot, simple_rr::planar_axis);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), planar.links().size());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), planar.joints().size());
+  EXPECT(assert_equal(gtsam::Vector2(0, -9.8), planar.planarGravity(kGravity),
+                      1e-9));
+
+  Values spatial = robot.forwardKinematics(movingValues(robot));
+  Values converted = planar.toSpatial(planar.toPlanar(spatial));
+  for (auto&& link : robot.links()) {
+    int i = link->id();
+    EXPECT(assert_equal(Pose(spatial, i), Pose(converted, i), 1e-9));
+    EXPECT(assert_equal(Twist(spatial, i), Twist(converted, i), 1e-9));
+  }
+  for (auto&& joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(JointAngle(spatial, joint->id()),
+                         JointAngle(converted, joint->id()), 1e-12);
+  }
+
+  // Joints that leave the plane are rejected.
+  CHECK_EXCEPTION(PlanarRobot(robot, gtsam::Vector3(0, 0, 1)),
+                  std::invalid_argument);
+}
+
+// Planar forward dynamics agrees with articulated-body forward dynamics.
+TEST(PlanarForwardDynamics, simple_rr) {
+  auto robot = fixedRobot();
+  Values known_values = movingValues(robot);
+
+  PlanarForwardDynamics planar_fd(robot, simple_rr::planar_axis, kGravity);
+  Values actual = planar_fd.solve(0, known_values);
+
+  ArticulatedBodyForwardDynamics aba(robot, kGravity);
+  Values expected = aba.solve(0, robot.forwardKinematics(known_values));
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j), JointAccel(actual, j), 1e-6);
+    for (auto&& link : joint->links()) {
+      EXPECT(assert_equal(Wrench(expected, link->id(), j),
+                          Wrench(actual, link->id(), j), 1e-6));
+    }
+  }
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(TwistAccel(expected, link->id()),
+                        TwistAccel(actual, link->id()), 1e-6));
+  }
+
+  auto floating = simple_rr::getRobot();
+  CHECK_EXCEPTION(
+      PlanarForwardDynamics(floating, simple_rr::planar_axis, kGravity),
+      std::invalid_argument);
+}
+
+// The planar dynamics graph is satisfied by the spatial solution.
+TEST(PlanarDynamicsGraph, simple_rr) {
+  auto robot = fixedRobot();
+  ArticulatedBodyForwardDynamics aba(robot, kGravity);
+  Values spatial =
+      aba.solve(0, robot.forwardKinematics(movingValues(robot)));
+
+  PlanarDynamicsGraph graph_builder(robot, simple_rr::planar_axis,
+                                    OptimizerSetting(), kGravity);
+  auto graph = graph_builder.dynamicsFactorGraph(robot, 0);
+  Values planar = graph_builder.planarRobot().toPlanar(spatial);
+  EXPECT_DOUBLES_EQUAL(0, graph.error(planar), 1e-9);
+
+  // Half the variable dimension of the spatial graph.
+  DynamicsGraph spatial_builder(kGravity, simple_rr::planar_axis);
+  auto spatial_graph = spatial_builder.dynamicsFactorGraph(robot, 0);
+  EXPECT_LONGS_EQUAL(spatial.dim() - planar.dim(),
+                     3 * (2 * robot.numJoints() + 3 * robot.numLinks()));
+  EXPECT_DOUBLES_EQUAL(0, spatial_graph.error(spatial), 1e-9);
+
+  PointOnLinks contacts{PointOnLink(robot.links()[1], gtsam::Point3(0, 0, 0))};
+  CHECK_EXCEPTION(graph_builder.dynamicsFactorGraph(robot, 0, contacts),
+                  std::invalid_argument);
+}
+
+// Simulator with the planar backend matches the articulated-body one.
+TEST(PlanarForwardDynamics, Simulator) {
+  auto robot = fixedRobot();
+  Values initial_values, torques;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&initial_values, joint->id(), 0.1);
+    InsertJointVel(&initial_values, joint->id(), 0.0);
+    InsertTorque(&torques, joint->id(), 0.5);
+  }
+  std::vector<Values> torques_seq(5, torques);
+
+  Simulator aba_sim(robot, initial_values, kGravity);
+  Values expected = aba_sim.simulate(torques_seq, 0.01);
+
+  Simulator planar_sim(robot, initial_values, kGravity,
+                       simple_rr::planar_axis, ForwardDynamicsBackend::Planar);
+  EXPECT(planar_sim.backend() == ForwardDynamicsBackend::Planar);
+  Values actual = planar_sim.simulate(torques_seq, 0.01);
+  for (auto&& joint : robot.joints()) {
+    int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(JointAngle(expected, j), JointAngle(actual, j), 1e-9);
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, j), JointAccel(actual, j), 1e-6);
+  }
+
+  CHECK_EXCEPTION(Simulator(robot, initial_values, kGravity, boost::none,
+                            ForwardDynamicsBackend::Planar),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
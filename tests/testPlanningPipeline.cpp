@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanningPipeline.cpp
+ * @brief Test the double-buffered planning and execution pipeline.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/PlanningPipeline.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace gtdynamics;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const size_t num_steps = 5;
+
+// Segment k has angles 10 k + t, so consecutive segments do not meet.
+TrajectoryBuffer Segment(size_t k) {
+  TrajectoryBuffer segment(robot, num_steps);
+  for (size_t t = 0; t < num_steps; t++) {
+    segment.jointAngles().row(t).setConstant(10.0 * k + t);
+  }
+  return segment;
+}
+}  // namespace example
+
+// Segments arrive in order, stitched at their boundaries, and each one is
+// planned while the previous one executes, never further ahead.
+TEST(PlanningPipeline, DoubleBuffer) {
+  using namespace example;
+  std::atomic<size_t> planned(0);
+  std::atomic<bool> chained(true);
+  auto planner = [&](size_t k, const TrajectoryBuffer *previous) {
+    if ((k == 0) != (previous == nullptr)) chained = false;
+    planned++;
+    return Segment(k);
+  };
+
+  const size_t num_segments = 4;
+  PlanningPipeline pipeline(planner, num_segments, 2);
+  const int j = robot.joints()[0]->id();
+  for (size_t k = 0; k < num_segments; k++) {
+    const TrajectoryBuffer &segment = pipeline.nextSegment();
+    // The first step continues the previous segment, the mismatch is half
+    // gone at step 1, and steps 2 on are as planned.
+    const double first = k ? 10.0 * (k - 1) + num_steps - 1 : 0.0;
+    EXPECT_DOUBLES_EQUAL(first, segment.jointAngle(j, 0), 1e-12);
+    EXPECT_DOUBLES_EQUAL(10.0 * k + (k ? 0.5 * (first - 10.0 * k) : 0) + 1,
+                         segment.jointAngle(j, 1), 1e-12);
+    EXPECT_DOUBLES_EQUAL(10.0 * k + 2, segment.jointAngle(j, 2), 1e-12);
+
+    // "Execute" the segment.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LONGS_EQUAL(std::min(k + 2, num_segments), planned.load());
+  }
+  LONGS_EQUAL(num_segments, pipeline.numTaken());
+  CHECK(chained);
+  CHECK_EXCEPTION(pipeline.nextSegment(), std::out_of_range);
+}
+
+// Planner exceptions surface in the executing thread.
+TEST(PlanningPipeline, Failure) {
+  using namespace example;
+  auto planner = [](size_t k, const TrajectoryBuffer *) {
+    if (k == 1) throw std::runtime_error("no solution");
+    return Segment(k);
+  };
+  PlanningPipeline pipeline(planner, 3);
+  pipeline.nextSegment();
+  CHECK_EXCEPTION(pipeline.nextSegment(), std::runtime_error);
+}
+
+// Segments of a receding-horizon problem solved with IncrementalOptimizer:
+// the angle increases by 0.1 per step, and old steps are marginalized.
+TEST(PlanningPipeline, IncrementalPlanner) {
+  using namespace example;
+  const int j = robot.joints()[0]->id();
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+  const size_t length = num_steps - 1;
+  auto problem = [&](size_t k, const TrajectoryBuffer *) {
+    SegmentProblem p;
+    p.first_step = k * length;
+    p.num_steps = num_steps;
+    p.earliest_time = p.first_step;
+    if (k == 0) {
+      p.factors.emplace_shared<gtsam::PriorFactor<double>>(
+          JointAngleKey(j, 0), 0.0, model);
+      p.values.insert(JointAngleKey(j, 0), 0.0);
+    }
+    for (size_t t = p.first_step + 1; t <= p.first_step + length; t++) {
+      p.factors.emplace_shared<gtsam::BetweenFactor<double>>(
+          JointAngleKey(j, t - 1), JointAngleKey(j, t), 0.1, model);
+      p.values.insert(JointAngleKey(j, t), 0.0);
+    }
+    return p;
+  };
+
+  auto optimizer = std::make_shared<IncrementalOptimizer>();
+  PlanningPipeline pipeline(
+      PlanningPipeline::IncrementalPlanner(optimizer, robot, problem), 3);
+  for (size_t k = 0; k < 3; k++) {
+    const TrajectoryBuffer &segment = pipeline.nextSegment();
+    LONGS_EQUAL(num_steps, segment.numSteps());
+    for (size_t t = 0; t < num_steps; t++) {
+      EXPECT_DOUBLES_EQUAL(0.1 * (k * length + t), segment.jointAngle(j, t),
+                           1e-6);
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -207,6 +207,29 @@ TEST(PoseFactor, ForwardKinematics) {
   EXPECT(assert_equal(Pose(result, 2, t), Pose(expected, 2, t)));
 }
 
+// The analytic factor agrees with the expression factor away from the
+// solution.
+TEST(PoseFactor, analytic) {
+  Pose3 cMp = Pose3(Rot3::Rx(1), Point3(-2, 0, 0));
+  Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(cMp, screw_axis);
+  auto expected = PoseFactor(example::wTp_key, example::wTc_key,
+                             example::q_key, example::cost_model, joint);
+  auto factor = PoseFactor(example::wTp_key, example::wTc_key, example::q_key,
+                           example::cost_model, joint, true);
+  EXPECT(boost::dynamic_pointer_cast<AnalyticPoseFactor<HelicalJoint>>(
+      factor));
+
+  Values values;
+  InsertPose(&values, 1, Pose3(Rot3::Ypr(0.1, -0.2, 0.3), Point3(1, 0.5, 0)));
+  InsertPose(&values, 2, Pose3(Rot3::Rz(0.7), Point3(2, 1, -0.3)));
+  InsertJointAngle(&values, 1, 0.4);
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
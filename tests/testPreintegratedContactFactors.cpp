@@ -24,6 +24,7 @@
 #include <math.h>
 
 #include <iostream>
+#include <vector>
 
 using namespace gtdynamics;
 using namespace gtsam;
@@ -58,6 +59,41 @@ TEST(PreintegratedPointContactMeasurements, IntegrateMeasurement) {
   EXPECT(assert_equal<Matrix3>(I_3x3 * 3e-4, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Test batch integration against integrating one sample at a time.
+TEST(PreintegratedPointContactMeasurements, IntegrateMeasurements) {
+  const Pose3 base_k(Rot3::Rx(0.1), Point3(0, 0, 1));
+  const Pose3 contact_k(Rot3::Rz(0.2), Point3(0.3, 0, 0));
+  std::vector<PreintegratedPointContactMeasurements::Sample> samples;
+  for (size_t k = 0; k < 10; k++) {
+    samples.push_back({Rot3::Ypr(0.1 * k, -0.05 * k, 0.02 * k),
+                       Pose3(Rot3::Rx(0.03 * k), Point3(0, 0, 1)),
+                       0.001 * (1 + k % 3)});
+  }
+
+  Matrix3 anisotropic;
+  anisotropic << 2, 0.1, 0, 0.1, 1, 0.2, 0, 0.2, 3;
+  for (const Matrix3 &cov : {Matrix3(anisotropic), Matrix3(I_3x3 * 0.5)}) {
+    PreintegratedPointContactMeasurements expected(base_k, contact_k, 0.01,
+                                                   cov);
+    for (auto &&sample : samples) {
+      expected.integrateMeasurement(sample.deltaRik, sample.contact_k,
+                                    sample.dt);
+    }
+    PreintegratedPointContactMeasurements actual(base_k, contact_k, 0.01, cov);
+    actual.integrateMeasurements(samples);
+    EXPECT(assert_equal<Matrix3>(expected.preintMeasCov(),
+                                 actual.preintMeasCov(), 1e-12));
+
+    // Streaming: restarting gives the same as a new object.
+    actual.resetIntegration(base_k, contact_k, 0.01);
+    EXPECT(assert_equal<Matrix3>(
+        PreintegratedPointContactMeasurements(base_k, contact_k, 0.01, cov)
+            .preintMeasCov(),
+        actual.preintMeasCov(), 1e-12));
+  }
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Point Contact Factor.
 TEST(PreintegratedPointContactFactor, Constructor) {
@@ -119,6 +155,25 @@ TEST(PreintegratedPointContactFactor, Jacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
 }
 
+/* ************************************************************************* */
+// Jacobians also hold when the contact rotations differ from the body's, as
+// happens during optimization.
+TEST(PreintegratedPointContactFactor, JacobiansRotatedContacts) {
+  const Pose3 wTb_i(Rot3::Rz(0.2), Point3(0, 0, 0.5)),
+      wTc_i(Rot3::Rx(0.3), Point3(0.3, 0.2, 0)),
+      wTb_j(Rot3::Rz(0.25), Point3(0.1, 0, 0.5)),
+      wTc_j(Rot3::Ry(-0.4), Point3(0.31, 0.19, 0.01));
+  PreintegratedPointContactMeasurements pcm(wTb_i, wTc_i, 0.01, I_3x3);
+  PreintegratedPointContactFactor factor(PoseKey(0, 0), PoseKey(1, 0),
+                                         PoseKey(0, 1), PoseKey(1, 1), pcm);
+  Values values;
+  InsertPose(&values, 0, 0, wTb_i);
+  InsertPose(&values, 1, 0, wTc_i);
+  InsertPose(&values, 0, 1, wTb_j);
+  InsertPose(&values, 1, 1, wTc_j);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Rigid Contact Factor.
 TEST(PreintegratedRigidContactMeasurements, Constructor) {
@@ -160,6 +215,19 @@ TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurementVarying) {
   EXPECT(assert_equal<Matrix6>(expected * dt * dt, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Test batch integration against integrating one time step at a time.
+TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurements) {
+  const Matrix3 wCov = I_3x3 * 0.05, vCov = I_3x3 * 0.01;
+  const std::vector<double> dts{0.001, 0.002, 0.001, 0.003};
+  PreintegratedRigidContactMeasurements expected(wCov, vCov),
+      actual(wCov, vCov);
+  for (const double dt : dts) expected.integrateMeasurement(wCov, vCov, dt);
+  actual.integrateMeasurements(dts);
+  EXPECT(assert_equal<Matrix6>(expected.preintMeasCov(),
+                               actual.preintMeasCov(), 1e-12));
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Rigid Contact Factor.
 TEST(PreintegratedRigidContactFactor, Constructor) {
@@ -0,0 +1,223 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRealTime.cpp
+ * @brief Test real-time mode: the diagnostics ring, and that the array
+ * dynamics solvers do not allocate.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodyForwardDynamics.h>
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
+#include <gtdynamics/dynamics/RobotKernels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/RealTime.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+// Allocation trap: with glibc, replace malloc and friends, which operator new
+// and Eigen call, to count calls made while the trap is armed.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define GTDYNAMICS_ALLOCATION_TRAP
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+thread_local bool trap_armed = false;
+thread_local size_t num_allocations = 0;
+
+void Trap() {
+  if (trap_armed) num_allocations++;
+}
+}  // namespace
+
+extern "C" {
+void *malloc(size_t size) {
+  Trap();
+  return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+  Trap();
+  return __libc_calloc(count, size);
+}
+void *realloc(void *p, size_t size) {
+  Trap();
+  return __libc_realloc(p, size);
+}
+void *memalign(size_t alignment, size_t size) {
+  Trap();
+  return __libc_memalign(alignment, size);
+}
+void *aligned_alloc(size_t alignment, size_t size) {
+  Trap();
+  return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **p, size_t alignment, size_t size) {
+  Trap();
+  *p = __libc_memalign(alignment, size);
+  return *p ? 0 : ENOMEM;
+}
+}
+#endif
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+        .fixLink("link0");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+
+// Drain the global ring, so tests start from an empty one.
+void Drain() {
+  DiagnosticRecord record;
+  while (Diagnostics().pop(&record)) {
+  }
+}
+}  // namespace example
+
+// Records come out in order, and overwritten ones are counted as dropped.
+TEST(RealTime, DiagnosticRing) {
+  DiagnosticRing ring(3);
+  LONGS_EQUAL(4, ring.capacity());
+  DiagnosticRecord record;
+  CHECK(!ring.pop(&record));
+
+  static const char *kMessage = "test message";
+  for (size_t k = 0; k < 3; k++) ring.push(kMessage, k);
+  for (size_t k = 0; k < 3; k++) {
+    CHECK(ring.pop(&record));
+    LONGS_EQUAL(k, record.sequence);
+    LONGS_EQUAL(k, record.key);
+    CHECK(record.message == kMessage);
+  }
+  CHECK(!ring.pop(&record));
+
+  // 6 more records in a ring of 4: the first 2 of them are lost.
+  for (size_t k = 3; k < 9; k++) ring.push(kMessage, k);
+  CHECK(ring.pop(&record));
+  LONGS_EQUAL(5, record.sequence);
+  LONGS_EQUAL(2, ring.numDropped());
+  LONGS_EQUAL(9, ring.numPushed());
+  size_t num_popped = 1;
+  while (ring.pop(&record)) num_popped++;
+  LONGS_EQUAL(4, num_popped);
+}
+
+// Diagnostics go to std::cerr, or to the ring in real-time mode.
+TEST(RealTime, ReportDiagnostic) {
+  using namespace example;
+  Drain();
+  const gtsam::Key key = gtsam::Symbol('x', 7);
+  std::stringstream captured;
+  std::streambuf *cerr = std::cerr.rdbuf(captured.rdbuf());
+
+  CHECK(!RealTimeMode());
+  ReportDiagnostic("key already exists:", key);
+  CHECK(captured.str().find("key already exists:") == 0);
+
+  captured.str("");
+  SetRealTimeMode(true);
+  ReportDiagnostic("key already exists:", key);
+  SetRealTimeMode(false);
+  std::cerr.rdbuf(cerr);
+  CHECK(captured.str().empty());
+
+  DiagnosticRecord record;
+  CHECK(Diagnostics().pop(&record));
+  LONGS_EQUAL(key, record.key);
+  CHECK(std::strcmp(record.message, "key already exists:") == 0);
+}
+
+#ifdef GTDYNAMICS_ALLOCATION_TRAP
+// After construction and a first call, the array solvers and diagnostics do
+// not allocate.
+TEST(RealTime, NoAllocation) {
+  using namespace example;
+  const size_t n = robot.numJoints();
+  Values joints;
+  for (size_t j = 0; j < n; j++) {
+    InsertJointAngle(&joints, robot.joints()[j]->id(), 0.2 * j - 0.5);
+    InsertJointVel(&joints, robot.joints()[j]->id(), 0.3 - 0.1 * j);
+  }
+  const Values values = robot.forwardKinematics(joints);
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  for (auto &&link : robot.links()) {
+    poses.push_back(Pose(values, link->id()));
+    twists.push_back(Twist(values, link->id()));
+  }
+  Vector q(n), qdot(n), qddot(n), tau(n);
+  for (size_t j = 0; j < n; j++) {
+    q(j) = JointAngle(values, robot.joints()[j]->id());
+    qdot(j) = JointVel(values, robot.joints()[j]->id());
+    qddot(j) = 1.0 - 0.2 * j;
+    tau(j) = 0.5 * j;
+  }
+
+  NewtonEulerInverseDynamics rnea(robot, gravity);
+  ArticulatedBodyForwardDynamics aba(robot, gravity);
+  CompositeRigidBodyDynamics crba(robot, gravity);
+  GenericRobotKernels kernels(robot, gravity);
+  std::vector<Pose3> fk_poses;
+  std::vector<Vector6> fk_twists;
+  SetRealTimeMode(true);
+
+  auto cycle = [&]() {
+    kernels.forwardKinematics(q, qdot, &fk_poses, &fk_twists);
+    rnea.solve(poses, twists, qdot, qddot);
+    aba.solve(poses, twists, qdot, tau);
+    crba.solve(poses, twists, qdot);
+    crba.solveMassMatrix(q);
+    crba.solveGravityForces(poses);
+    ReportDiagnostic("key already exists:", 0);
+  };
+  cycle();  // warm up
+
+  num_allocations = 0;
+  trap_armed = true;
+  for (size_t k = 0; k < 10; k++) {
+    q(k % n) += 0.01;
+    cycle();
+  }
+  trap_armed = false;
+  SetRealTimeMode(false);
+  LONGS_EQUAL(0, num_allocations);
+
+  // The gravity path agrees with the full solve.
+  crba.solve(poses, twists, qdot);
+  const Vector g = crba.gravityForces();
+  EXPECT(gtsam::assert_equal(g, crba.solveGravityForces(poses), 1e-12));
+  Drain();
+}
+#endif
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -211,6 +211,24 @@ TEST(RevoluteJoint, ParentTchild) {
   EXPECT(assert_equal(expected_pTc, pTc, 1e-4));
 }
 
+// Memoized poses stay correct when joints share angles and cache slots.
+TEST(RevoluteJoint, ParentTchildCache) {
+  const Pose3 bTj(Rot3(), Point3(0, 0, 2));
+  RevoluteJoint jx(1, "jx", bTj, l1, l2, Vector3(1, 0, 0));
+  RevoluteJoint jy(2, "jy", bTj, l1, l2, Vector3(0, 1, 0));
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < 1000; i++) {
+      const double q = 0.01 * i;
+      for (auto &&joint : {&jx, &jy}) {
+        const Pose3 expected =
+            joint->pMc() * Pose3::Expmap(joint->cScrewAxis() * q);
+        EXPECT(assert_equal(expected, joint->parentTchild(q), 1e-9));
+        EXPECT(assert_equal(expected.inverse(), joint->childTparent(q), 1e-9));
+      }
+    }
+  }
+}
+
 BOOST_CLASS_EXPORT(gtdynamics::RevoluteJoint)
 
 TEST(RevoluteJoint, Serialization) {
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRiccatiSolver.cpp
+ * @brief Test the Riccati recursion for linearized trajectories.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/RiccatiSolver.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::I_1x1;
+using gtsam::Vector1;
+
+namespace example {
+const Robot robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+const int j = robot.joints()[0]->id();
+const int num_steps = 5;
+auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// Forward dynamics of a single joint under constant torque.
+gtsam::NonlinearFactorGraph Graph() {
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  return graph;
+}
+}  // namespace example
+
+// The recursion gives the solution of elimination.
+TEST(RiccatiSolve, trajectory) {
+  using namespace example;
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps, -1,
+                                                     0.1);
+  const auto linear = Graph().linearize(init);
+  EXPECT(assert_equal(linear->optimize(), RiccatiSolve(*linear), 1e-6));
+  EXPECT_LONGS_EQUAL(0, RiccatiSolve(gtsam::GaussianFactorGraph()).size());
+}
+
+// Global variables and factors skipping a step are not block-tridiagonal.
+TEST(RiccatiSolve, structure) {
+  using example::model;
+  gtsam::GaussianFactorGraph graph;
+  graph.add(JointAngleKey(0, 0), I_1x1, Vector1(1), model);
+  graph.add(JointAngleKey(0, 0), I_1x1, JointAngleKey(0, 2), -I_1x1,
+            Vector1(0), model);
+  CHECK_EXCEPTION(RiccatiSolve(graph), std::invalid_argument);
+
+  gtsam::GaussianFactorGraph global_graph;
+  global_graph.add(PhaseKey(0), I_1x1, Vector1(1), model);
+  CHECK_EXCEPTION(RiccatiSolve(global_graph), std::invalid_argument);
+
+  // A variable without information is indeterminant.
+  gtsam::GaussianFactorGraph singular_graph;
+  singular_graph.add(JointAngleKey(0, 0), I_1x1, JointAngleKey(0, 1),
+                     -I_1x1, Vector1(0), model);
+  CHECK_EXCEPTION(RiccatiSolve(singular_graph),
+                  gtsam::IndeterminantLinearSystemException);
+}
+
+// LM with the Riccati solver converges to the same trajectory.
+TEST(RiccatiSolve, Optimizer) {
+  using namespace example;
+  const auto graph = Graph();
+  Initializer initializer;
+  const auto init = initializer.ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters params;
+  const auto expected = Optimizer(params).optimize(graph, init);
+  params.riccati_solver = true;
+  const auto actual = Optimizer(params).optimize(graph, init);
+  EXPECT(assert_equal(expected, actual, 1e-5));
+  EXPECT_DOUBLES_EQUAL(JointAngle(expected, j, num_steps),
+                       JointAngle(actual, j, num_steps), 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -14,6 +14,7 @@
 
 #include <CppUnitLite/Test.h>
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
 #include <gtdynamics/universal_robot/HelicalJoint.h>
 #include <gtdynamics/universal_robot/PrismaticJoint.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
@@ -88,6 +89,75 @@ TEST(Robot, removeLink) {
   EXPECT(robot.link("l3")->joints().size() == 1);
 }
 
+TEST(Robot, Topology) {
+  auto robot = simple_rr::getRobot();
+  const RobotTopology &topo = robot.topology();
+  EXPECT(topo.links.size() == 3);
+  EXPECT(topo.joints.size() == 2);
+
+  int l0 = topo.link_index[robot.link("link_0")->id()];
+  int l1 = topo.link_index[robot.link("link_1")->id()];
+  int l2 = topo.link_index[robot.link("link_2")->id()];
+  int j2 = topo.joint_index[robot.joint("joint_2")->id()];
+  EXPECT(topo.links[l1] == robot.link("link_1"));
+  EXPECT(topo.joint_parent[j2] == l1);
+  EXPECT(topo.joint_child[j2] == l2);
+  EXPECT(assert_equal(robot.joint("joint_2")->jMc(), topo.jMc[j2]));
+  EXPECT(topo.link_joint_offsets[l1 + 1] - topo.link_joint_offsets[l1] == 2);
+
+  // No fixed link: BFS from the link that is not a joint child.
+  EXPECT(topo.root == l0);
+  EXPECT(topo.bfs_order == std::vector<int>({l0, l1, l2}));
+  EXPECT(topo.forest_order == topo.bfs_order);
+
+  // Fixing a link gives a variant with its own topology.
+  Robot fixed_robot = robot.fixLink("link_2");
+  EXPECT(fixed_robot.topology().root == l2);
+  EXPECT(fixed_robot.topology().bfs_order == std::vector<int>({l2, l1, l0}));
+  EXPECT(!robot.topology().fixed[l2]);
+
+  // Paths in the spanning tree, through the common ancestor.
+  int j1 = topo.joint_index[robot.joint("joint_1")->id()];
+  EXPECT(topo.tree_parent[l2] == l1 && topo.tree_joint[l2] == j2);
+  EXPECT(topo.tree_depth[l2] == 2);
+  EXPECT(topo.commonAncestor(l2, l1) == l1);
+  std::vector<int> path;
+  EXPECT(topo.path(l2, l0, &path));
+  EXPECT(path == std::vector<int>({j2, j1}));
+  EXPECT(topo.path(l0, l2, &path));
+  EXPECT(path == std::vector<int>({j1, j2}));
+
+  // Removing a joint refreshes the topology.
+  robot.removeJoint(robot.joint("joint_2"));
+  EXPECT(robot.topology().joints.size() == 1);
+  EXPECT(robot.topology().bfs_order == std::vector<int>({l0, l1}));
+  EXPECT(robot.topology().commonAncestor(l0, l2) == -1);
+  EXPECT(!robot.topology().path(l0, l2, &path));
+}
+
+// fixLink and unfixLink variants share everything but the changed links.
+TEST(Robot, FixLinkVariants) {
+  const Robot robot = simple_rr::getRobot();
+  const Robot fixed = robot.fixLink("link_0");
+  EXPECT(fixed.link("link_0")->isFixed());
+  EXPECT(!robot.link("link_0")->isFixed());
+  EXPECT_LONGS_EQUAL(1, fixed.numOverriddenLinks());
+  EXPECT(fixed.link("link_1") == robot.link("link_1"));
+  EXPECT(fixed.joint("joint_1") == robot.joint("joint_1"));
+  EXPECT(!(fixed == robot));
+
+  // Forward kinematics works through the copied link.
+  const auto values = fixed.forwardKinematics(gtsam::Values());
+  EXPECT(assert_equal(fixed.link("link_0")->getFixedPose(),
+                      Pose(values, fixed.link("link_0")->id())));
+
+  // Unfixing again drops the copy.
+  const Robot unfixed = fixed.unfixLink("link_0");
+  EXPECT_LONGS_EQUAL(0, unfixed.numOverriddenLinks());
+  EXPECT(unfixed.link("link_0") == robot.link("link_0"));
+  EXPECT(unfixed == robot);
+}
+
 TEST(Robot, ForwardKinematics) {
   Robot robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
@@ -284,6 +354,64 @@ TEST(ForwardKinematics, A1) {
       Pose(fk_results, 20, 0), 1e-6));
 }
 
+// Output-only and in-place forward kinematics add exactly the variables that
+// the copying version adds, for one step of a longer trajectory.
+TEST(ForwardKinematics, OutputOnly) {
+  Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"), "", true);
+  robot = robot.fixLink("trunk");
+
+  Values trajectory;
+  for (size_t t = 0; t < 5; t++) {
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&trajectory, joint->id(), t,
+                       0.1 * t - 0.05 * joint->id());
+    }
+  }
+  const Values expected = robot.forwardKinematics(trajectory, 3);
+
+  Values added;
+  robot.forwardKinematics(trajectory, 3, &added);
+  // 21 joint velocities, 22 link poses, 22 link twists
+  EXPECT_LONGS_EQUAL(65, added.size());
+  for (auto&& key_value : added) {
+    EXPECT_LONGS_EQUAL(3, DynamicsSymbol(key_value.key).time());
+  }
+  Values merged = trajectory;
+  merged.insert(added);
+  EXPECT(assert_equal(expected, merged));
+
+  // Variables already in the output are checked, not inserted again.
+  robot.forwardKinematics(trajectory, 3, &added);
+  EXPECT_LONGS_EQUAL(65, added.size());
+
+  Values in_place = trajectory;
+  robot.forwardKinematicsInPlace(&in_place, 3);
+  EXPECT(assert_equal(expected, in_place));
+}
+
+// Relative poses along a kinematic path agree with full forward kinematics.
+TEST(Robot, RelativePose) {
+  const Robot robot = simple_rr::getRobot();
+  const KinematicPath path = robot.kinematicPath("link_2", "link_0");
+  EXPECT_LONGS_EQUAL(3, path.links.size());
+  EXPECT(path.links[1] == robot.link("link_1"));
+  EXPECT(path.joints[0] == robot.joint("joint_2"));
+  EXPECT(path.joints[1] == robot.joint("joint_1"));
+  EXPECT(robot.kinematicPath("link_1", "link_1").joints.empty());
+
+  Values joint_angles;
+  InsertJointAngle(&joint_angles, robot.joint("joint_1")->id(), 3, 0.3);
+  InsertJointAngle(&joint_angles, robot.joint("joint_2")->id(), 3, -0.8);
+  const Values fk = robot.forwardKinematics(joint_angles, 3, "link_0");
+  const Pose3 wT0 = Pose(fk, robot.link("link_0")->id(), 3);
+  const Pose3 wT2 = Pose(fk, robot.link("link_2")->id(), 3);
+  EXPECT(assert_equal(wT0.between(wT2),
+                      robot.relativePose(joint_angles, "link_0", "link_2", 3)));
+  EXPECT(assert_equal(wT2.between(wT0),
+                      robot.relativePose(joint_angles, "link_2", "link_0", 3)));
+}
+
 TEST(Robot, Equality) {
   Robot robot1 = CreateRobotFromFile(
       kSdfPath + std::string("test/four_bar_linkage_pure.sdf"));
@@ -317,6 +445,81 @@ TEST(Robot, Serialization) {
   EXPECT(equalsBinary(robot));
 }
 
+// Links attached by fixed joints are lumped like the URDF parser does, and
+// lumped robots move and have the mass matrix of the original.
+TEST(Robot, lumpFixedJoints) {
+  const std::string a1_urdf = kUrdfPath + std::string("a1/a1.urdf");
+  const Robot a1 = CreateRobotFromFile(a1_urdf, "", true);
+  LumpedLinkMap lumped_links;
+  const Robot lumped = a1.lumpFixedJoints(&lumped_links);
+  EXPECT_LONGS_EQUAL(13, lumped.numLinks());
+  EXPECT_LONGS_EQUAL(12, lumped.numJoints());
+  EXPECT(lumped_links.at("FR_toe").name == "FR_lower");
+  EXPECT(lumped_links.at("FR_upper_shoulder").name == "FR_hip");
+  EXPECT(lumped_links.at("imu_link").name == "trunk");
+  EXPECT(lumped_links.at("trunk").name == "trunk");
+  EXPECT_LONGS_EQUAL(a1.link("FR_hip")->id(), lumped.link("FR_hip")->id());
+
+  // Same mass properties as when the URDF parser lumps the links.
+  const Robot parsed = CreateRobotFromFile(a1_urdf);
+  EXPECT_LONGS_EQUAL(parsed.numLinks(), lumped.numLinks());
+  for (auto&& link : parsed.links()) {
+    const LinkSharedPtr lumped_link = lumped.link(link->name());
+    EXPECT_DOUBLES_EQUAL(link->mass(), lumped_link->mass(), 1e-9);
+    EXPECT(assert_equal(link->bMcom().translation(),
+                        lumped_link->bMcom().translation(), 1e-6));
+    const gtsam::Matrix3 R = link->bMcom().rotation().matrix(),
+                         lumped_R = lumped_link->bMcom().rotation().matrix();
+    EXPECT(assert_equal(gtsam::Matrix3(R * link->inertia() * R.transpose()),
+                        gtsam::Matrix3(lumped_R * lumped_link->inertia() *
+                                       lumped_R.transpose()),
+                        1e-6));
+  }
+
+  // Contact points are moved with the links they are on.
+  const Robot fixed = a1.fixLink("trunk"),
+              lumped_fixed = lumped.fixLink("trunk");
+  Values angles, lumped_angles;
+  double angle = 0.3;
+  for (auto&& joint : lumped.joints()) {
+    InsertJointAngle(&angles, a1.joint(joint->name())->id(), angle);
+    InsertJointAngle(&lumped_angles, joint->id(), angle);
+    angle = 0.5 - 0.9 * angle;
+  }
+  const PointOnLinks points{{a1.link("FR_toe"), Point3(0, 0, -0.02)},
+                            {a1.link("imu_link"), Point3(0.1, 0, 0)}};
+  const PointOnLinks lumped_points =
+      LumpPointOnLinks(lumped, lumped_links, points);
+  EXPECT(lumped_points[0].link == lumped.link("FR_lower"));
+  const Values fk = fixed.forwardKinematics(angles),
+               lumped_fk = lumped_fixed.forwardKinematics(lumped_angles);
+  for (size_t i = 0; i < points.size(); i++) {
+    EXPECT(assert_equal(points[i].predict(fk),
+                        lumped_points[i].predict(lumped_fk), 1e-9));
+  }
+
+  // The mass matrix only has the moving joints, with the same entries.
+  const size_t n = lumped.numJoints();
+  gtsam::Vector q = gtsam::Vector::Zero(a1.numJoints()), lumped_q(n);
+  std::vector<size_t> index;
+  for (size_t j = 0; j < n; j++) {
+    const JointSharedPtr joint = lumped.joints()[j];
+    const auto& joints = a1.joints();
+    index.push_back(std::find(joints.begin(), joints.end(),
+                              a1.joint(joint->name())) -
+                    joints.begin());
+    lumped_q(j) = q(index[j]) = JointAngle(lumped_angles, joint->id());
+  }
+  CompositeRigidBodyDynamics crba(fixed), lumped_crba(lumped_fixed);
+  const gtsam::Matrix M = crba.solveMassMatrix(q),
+                      lumped_M = lumped_crba.solveMassMatrix(lumped_q);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      EXPECT_DOUBLES_EQUAL(M(index[i], index[j]), lumped_M(i, j), 1e-9);
+    }
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotCache.cpp
+ * @brief Test binary robot model files.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+const std::string cache_path = "testRobotCache.gtdrobot";
+
+// Check everything the binary format stores.
+bool SameRobot(const Robot &expected, const Robot &actual) {
+  bool ok = expected.equals(actual);
+  const auto links = expected.links(), actual_links = actual.links();
+  ok &= links.size() == actual_links.size();
+  for (size_t i = 0; ok && i < links.size(); i++) {
+    ok &= links[i]->name() == actual_links[i]->name();
+    ok &= links[i]->isFixed() == actual_links[i]->isFixed();
+    ok &= assert_equal(links[i]->inertia(), actual_links[i]->inertia());
+    ok &= links[i]->numJoints() == actual_links[i]->numJoints();
+    for (size_t j = 0; ok && j < links[i]->numJoints(); j++)
+      ok &= links[i]->joints()[j]->name() ==
+            actual_links[i]->joints()[j]->name();
+  }
+  const auto joints = expected.joints(), actual_joints = actual.joints();
+  ok &= joints.size() == actual_joints.size();
+  for (size_t j = 0; ok && j < joints.size(); j++) {
+    ok &= joints[j]->type() == actual_joints[j]->type();
+    ok &= joints[j]->parent()->name() == actual_joints[j]->parent()->name();
+    ok &= assert_equal(joints[j]->cScrewAxis(), actual_joints[j]->cScrewAxis());
+    ok &= assert_equal(joints[j]->pScrewAxis(), actual_joints[j]->pScrewAxis());
+    ok &= joints[j]->parameters().torque_limit ==
+          actual_joints[j]->parameters().torque_limit;
+  }
+  return ok;
+}
+}  // namespace example
+
+// Robots with all joint types survive a round trip.
+TEST(RobotCache, RoundTrip) {
+  for (auto &&file : {kUrdfPath + std::string("vision60.urdf"),
+                      kSdfPath + std::string("test/simple_rpr.sdf"),
+                      kSdfPath + std::string("test/simple_screw_joint.sdf")}) {
+    const std::string model =
+        file.find("simple_rpr") != std::string::npos ? "simple_rpr_sdf" : "";
+    const Robot robot = CreateRobotFromFile(file, model);
+    SaveRobotBinary(robot, example::cache_path, 42);
+    const auto loaded = LoadRobotBinary(example::cache_path);
+    CHECK(loaded);
+    EXPECT(example::SameRobot(robot, *loaded));
+    EXPECT(LoadRobotBinary(example::cache_path, 42));
+    EXPECT(!LoadRobotBinary(example::cache_path, 43));
+  }
+  std::remove(example::cache_path.c_str());
+  EXPECT(!LoadRobotBinary(example::cache_path));
+}
+
+// Truncated files are rejected.
+TEST(RobotCache, Truncated) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  SaveRobotBinary(robot, example::cache_path);
+  std::string data;
+  {
+    std::ifstream is(example::cache_path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(is),
+                std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream os(example::cache_path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size() - 8);
+  }
+  CHECK_EXCEPTION(LoadRobotBinary(example::cache_path), std::runtime_error);
+  std::remove(example::cache_path.c_str());
+}
+
+// Robots survive a round trip through memory, and bad data is rejected.
+TEST(RobotCache, RobotToBytes) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+  const std::string data = RobotToBytes(robot);
+  EXPECT(example::SameRobot(robot, RobotFromBytes(data)));
+  CHECK_EXCEPTION(RobotFromBytes(data.substr(0, data.size() - 8)),
+                  std::runtime_error);
+  CHECK_EXCEPTION(RobotFromBytes("GTDVALS1"), std::runtime_error);
+}
+
+// The cached loader parses once, then reads the binary file.
+TEST(RobotCache, CreateRobotFromFileCached) {
+  const std::string file = kUrdfPath + std::string("test/simple_urdf.urdf");
+  const Robot expected = CreateRobotFromFile(file);
+  std::remove(example::cache_path.c_str());
+  EXPECT(example::SameRobot(
+      expected,
+      CreateRobotFromFileCached(file, "", false, example::cache_path)));
+  const auto cached =
+      LoadRobotBinary(example::cache_path, RobotSourceHash(file));
+  CHECK(cached);
+  EXPECT(example::SameRobot(expected, *cached));
+  EXPECT(example::SameRobot(
+      expected,
+      CreateRobotFromFileCached(file, "", false, example::cache_path)));
+
+  // A different model name or fixed joint flag gives a different hash.
+  EXPECT(RobotSourceHash(file) != RobotSourceHash(file, "other"));
+  EXPECT(RobotSourceHash(file) != RobotSourceHash(file, "", true));
+  std::remove(example::cache_path.c_str());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotGenerator.cpp
+ * @brief Test the synthetic robot generators.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+// A chain has one more link than joints, its base fixed, and stands up.
+TEST(RobotGenerator, SerialChain) {
+  const Robot robot = robot_generator::SerialChain(5);
+  EXPECT_LONGS_EQUAL(6, robot.numLinks());
+  EXPECT_LONGS_EQUAL(5, robot.numJoints());
+  EXPECT(robot.link("link_0")->isFixed());
+  EXPECT(!robot.link("link_1")->isFixed());
+  EXPECT(robot.joint("joint_4")->child()->name() == "link_5");
+
+  const GeneratedLinkParams params;
+  gtsam::Values known;
+  InsertPose(&known, 0, Pose3(Rot3(), Point3(0, 0, params.length / 2)));
+  const gtsam::Values fk = robot.forwardKinematics(known, 0, "link_0");
+  EXPECT(assert_equal(Point3(0, 0, 5.5 * params.length),
+                      Pose(fk, 5).translation()));
+
+  EXPECT(!robot_generator::SerialChain(5, false).link("link_0")->isFixed());
+}
+
+// A tree of 4 levels has 15 links, and link i is the parent of 2i + 1.
+TEST(RobotGenerator, BinaryTree) {
+  const Robot robot = robot_generator::BinaryTree(4);
+  EXPECT_LONGS_EQUAL(15, robot.numLinks());
+  EXPECT_LONGS_EQUAL(14, robot.numJoints());
+  EXPECT(robot.joint("joint_6")->parent()->name() == "link_3");
+  EXPECT(robot.joint("joint_6")->child()->name() == "link_7");
+  EXPECT_LONGS_EQUAL(3, robot.link("link_1")->numJoints());
+  EXPECT_LONGS_EQUAL(1, robot.link("link_14")->numJoints());
+}
+
+// The feet of a walker touch the plane z = -joints_per_leg * length.
+TEST(RobotGenerator, Walker) {
+  const size_t num_legs = 6, joints_per_leg = 3;
+  const Robot robot = robot_generator::Walker(num_legs, joints_per_leg);
+  EXPECT_LONGS_EQUAL(19, robot.numLinks());
+  EXPECT_LONGS_EQUAL(18, robot.numJoints());
+  EXPECT(!robot.link("link_0")->isFixed());
+  EXPECT_LONGS_EQUAL(num_legs, robot.link("link_0")->numJoints());
+
+  const PointOnLinks feet =
+      robot_generator::WalkerFeet(robot, num_legs, joints_per_leg);
+  EXPECT_LONGS_EQUAL(num_legs, feet.size());
+  const gtsam::Values fk = robot.forwardKinematics(gtsam::Values(), 0,
+                                                   std::string("link_0"));
+  const double length = GeneratedLinkParams().length;
+  for (auto &&foot : feet) {
+    EXPECT_DOUBLES_EQUAL(-3 * length, foot.predict(fk).z(), 1e-9);
+  }
+}
+
+// Sizes past the 12-bit indices of DynamicsSymbol are rejected.
+TEST(RobotGenerator, Limits) {
+  const size_t max_joints = DynamicsSymbol::kNoIndex - 1;
+  EXPECT_LONGS_EQUAL(max_joints + 1,
+                     robot_generator::SerialChain(max_joints).numLinks());
+  CHECK_EXCEPTION(robot_generator::SerialChain(max_joints + 1),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(robot_generator::SerialChain(0), std::invalid_argument);
+  CHECK_EXCEPTION(robot_generator::BinaryTree(13), std::invalid_argument);
+  CHECK_EXCEPTION(robot_generator::Walker(0, 3), std::invalid_argument);
+  CHECK_EXCEPTION(robot_generator::Walker(4095, 1), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
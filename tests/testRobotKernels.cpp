@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotKernels.cpp
+ * @brief Test generic and generated robot kernels against the dynamics
+ * classes and each other.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/dynamics/RobotKernelGenerator.h>
+#include <gtdynamics/dynamics/RobotKernels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Generated from the Panda URDF by gtdynamics_add_robot_kernels.
+#include "PandaKernels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace example {
+const Robot panda =
+    CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+const Robot robot = panda.fixLink("link0");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const size_t n = robot.numJoints();
+const Vector q = Vector::LinSpaced(n, -0.6, 0.9);
+const Vector qdot = Vector::LinSpaced(n, 0.8, -0.5);
+const Vector qddot = Vector::LinSpaced(n, -1.5, 2.0);
+
+Values JointValues() {
+  Values values;
+  for (size_t j = 0; j < n; j++) {
+    const int id = robot.joints()[j]->id();
+    InsertJointAngle(&values, id, q(j));
+    InsertJointVel(&values, id, qdot(j));
+    InsertJointAccel(&values, id, qddot(j));
+  }
+  return values;
+}
+}  // namespace example
+
+// Forward kinematics agrees with Robot::forwardKinematics.
+TEST(GenericRobotKernels, forwardKinematics) {
+  using namespace example;
+  GenericRobotKernels kernels(robot, gravity);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), kernels.numLinks());
+  EXPECT_LONGS_EQUAL(n, kernels.numJoints());
+
+  const Values expected = robot.forwardKinematics(JointValues());
+  const Values actual = kernels.forwardKinematics(JointValues());
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(Pose(expected, link->id()), Pose(actual, link->id()),
+                        1e-9));
+    EXPECT(assert_equal(Twist(expected, link->id()),
+                        Twist(actual, link->id()), 1e-9));
+  }
+
+  std::vector<Pose3> poses;
+  kernels.forwardKinematics(q, qdot, &poses, nullptr);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), poses.size());
+  CHECK_EXCEPTION(kernels.massMatrix(Vector::Zero(n + 1)),
+                  std::invalid_argument);
+}
+
+// Inverse dynamics agrees with the joint-space equations of motion.
+TEST(GenericRobotKernels, inverseDynamics) {
+  using namespace example;
+  GenericRobotKernels kernels(robot, gravity);
+  const Matrix M = kernels.massMatrix(q);
+
+  const Values values = robot.forwardKinematics(JointValues());
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  for (auto&& link : robot.links()) {
+    poses.push_back(Pose(values, link->id()));
+    twists.push_back(Twist(values, link->id()));
+  }
+  CompositeRigidBodyDynamics crba(robot, gravity);
+  crba.solve(poses, twists, qdot);
+  EXPECT(assert_equal(crba.massMatrix(), M, 1e-9));
+  EXPECT(assert_equal(Vector(M * qddot + crba.biasForces()),
+                      kernels.inverseDynamics(q, qdot, qddot), 1e-9));
+
+  const Values torques = kernels.inverseDynamics(JointValues());
+  const Vector tau = kernels.inverseDynamics(q, qdot, qddot);
+  for (size_t j = 0; j < n; j++) {
+    EXPECT_DOUBLES_EQUAL(tau(j), Torque(torques, robot.joints()[j]->id()),
+                         1e-12);
+  }
+}
+
+// The kernels generated for the Panda have the results of the generic ones.
+TEST(GeneratedRobotKernels, panda) {
+  using namespace example;
+  GenericRobotKernels generic(robot, gravity);
+  PandaKernels generated;
+  EXPECT(generic.linkIds() == generated.linkIds());
+  EXPECT(generic.jointIds() == generated.jointIds());
+
+  std::vector<Pose3> expected_poses, actual_poses;
+  std::vector<Vector6> expected_twists, actual_twists;
+  generic.forwardKinematics(q, qdot, &expected_poses, &expected_twists);
+  generated.forwardKinematics(q, qdot, &actual_poses, &actual_twists);
+  for (size_t i = 0; i < robot.numLinks(); i++) {
+    EXPECT(assert_equal(expected_poses[i], actual_poses[i], 1e-9));
+    EXPECT(assert_equal(expected_twists[i], actual_twists[i], 1e-9));
+  }
+  EXPECT(assert_equal(generic.inverseDynamics(q, qdot, qddot),
+                      generated.inverseDynamics(q, qdot, qddot), 1e-9));
+  EXPECT(assert_equal(generic.massMatrix(q), generated.massMatrix(q), 1e-9));
+
+  // Through the interface, with the Values adapters.
+  RobotKernels& kernels = generated;
+  const Values torques = kernels.inverseDynamics(JointValues());
+  const Vector tau = generic.inverseDynamics(q, qdot, qddot);
+  EXPECT_DOUBLES_EQUAL(tau(3), Torque(torques, robot.joints()[3]->id()),
+                       1e-9);
+  CHECK_EXCEPTION(generated.inverseDynamics(q, qdot, Vector::Zero(2)),
+                  std::invalid_argument);
+}
+
+// The generator names the class as asked and rejects floating bases.
+TEST(GenerateRobotKernels, sources) {
+  using namespace example;
+  RobotKernelOptions options;
+  options.class_name = "PandaKernels";
+  options.namespace_name = "robots::panda";
+  options.gravity = gravity;
+  const RobotKernelSources sources = GenerateRobotKernels(robot, options);
+  EXPECT(sources.header.find("class PandaKernels") != std::string::npos);
+  EXPECT(sources.header.find("namespace panda") != std::string::npos);
+  EXPECT(sources.source.find("#include \"PandaKernels.h\"") !=
+         std::string::npos);
+
+  CHECK_EXCEPTION(GenerateRobotKernels(panda, options),
+                  std::invalid_argument);
+  options.class_name = "";
+  CHECK_EXCEPTION(GenerateRobotKernels(robot, options),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,65 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotModel.cpp
+ * @brief Test sharing a frozen robot between threads.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModel.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Parallel.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+
+// A model converts to its robot, and its variants are models too.
+TEST(RobotModel, Robot) {
+  const Robot robot = simple_rr::getRobot();
+  const RobotModel model(robot);
+  const Robot &frozen = model;
+  EXPECT(frozen == robot);
+  EXPECT(model->link("link_0") == robot.link("link_0"));
+
+  const RobotModel fixed = model.fixLink("link_0");
+  EXPECT(fixed->link("link_0")->isFixed());
+  EXPECT(!model->link("link_0")->isFixed());
+}
+
+// Graphs built on many threads from one model match a serial build.
+TEST(RobotModel, ConcurrentGraphs) {
+  const RobotModel model(simple_rr::getRobot().fixLink("link_0"));
+  const DynamicsGraph graph_builder(simple_rr::gravity,
+                                    simple_rr::planar_axis);
+  Initializer initializer;
+
+  const size_t num_steps = 16;
+  std::vector<gtsam::NonlinearFactorGraph> graphs(num_steps);
+  ParallelFor(num_steps, 4, [&](size_t t) {
+    graphs[t] = graph_builder.dynamicsFactorGraph(model, t);
+  });
+
+  for (size_t t = 0; t < num_steps; t++) {
+    const auto expected = graph_builder.dynamicsFactorGraph(model, t);
+    const auto values = initializer.ZeroValues(model, t);
+    EXPECT_LONGS_EQUAL(expected.size(), graphs[t].size());
+    EXPECT_DOUBLES_EQUAL(expected.error(values), graphs[t].error(values),
+                         1e-9);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
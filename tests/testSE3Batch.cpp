@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSE3Batch.cpp
+ * @brief Test SE(3) operations on batches against gtsam::Pose3.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/SE3Batch.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+const std::vector<Pose3> a = {
+    Pose3(), Pose3(Rot3::Ypr(0.3, -0.2, 0.1), Point3(0.1, 0.2, 2)),
+    Pose3(Rot3::Ypr(-1.2, 0.5, 2.0), Point3(-1, 0, 0.5))};
+const std::vector<Pose3> b = {
+    Pose3(Rot3::Rz(0.4), Point3(1, 2, 3)), Pose3(),
+    Pose3(Rot3::Ypr(0.7, 0.1, -0.3), Point3(0, -0.5, 1))};
+
+TwistBatch Twists() {
+  TwistBatch twists(3, 6);
+  twists.row(0) << 1, -2, 3, 0.5, 1, -1;
+  twists.row(1) << 0, 0, 0, 0.3, -0.1, 2;
+  twists.row(2) << 1e-6, -2e-6, 0, 1, 2, 3;
+  return twists;
+}
+}  // namespace example
+
+TEST(SE3Batch, ComposeInverse) {
+  using namespace example;
+  const PoseBatch A = BatchFromPoses(a), B = BatchFromPoses(b);
+  const PoseBatch AB = BatchCompose(A, B), AInv = BatchInverse(A);
+  const PoseBatch a1B = BatchCompose(a[1], B), Ab1 = BatchCompose(A, b[1]);
+  for (size_t n = 0; n < a.size(); n++) {
+    EXPECT(assert_equal(a[n], BatchPose(A, n)));
+    EXPECT(assert_equal(a[n] * b[n], BatchPose(AB, n), 1e-12));
+    EXPECT(assert_equal(a[n].inverse(), BatchPose(AInv, n), 1e-12));
+    EXPECT(assert_equal(a[1] * b[n], BatchPose(a1B, n), 1e-12));
+    EXPECT(assert_equal(a[n] * b[1], BatchPose(Ab1, n), 1e-12));
+  }
+  EXPECT(assert_equal(Pose3(), BatchPose(BatchIdentity(2), 1)));
+  CHECK_EXCEPTION(BatchCompose(A, BatchIdentity(2)), std::invalid_argument);
+}
+
+TEST(SE3Batch, Adjoint) {
+  using namespace example;
+  const PoseBatch A = BatchFromPoses(a);
+  const TwistBatch twists = Twists();
+  const TwistBatch Ad = BatchAdjoint(A, twists);
+  const TwistBatch AdT = BatchAdjointTranspose(A, twists);
+  for (size_t n = 0; n < a.size(); n++) {
+    const Vector6 xi = twists.row(n).transpose();
+    EXPECT(assert_equal(a[n].Adjoint(xi), Vector6(Ad.row(n).transpose()),
+                        1e-12));
+    EXPECT(assert_equal(a[n].AdjointTranspose(xi),
+                        Vector6(AdT.row(n).transpose()), 1e-12));
+  }
+}
+
+TEST(SE3Batch, Expmap) {
+  const TwistBatch twists = example::Twists();
+  const PoseBatch poses = BatchExpmap(twists);
+  for (size_t n = 0; n < 3; n++) {
+    const Vector6 xi = twists.row(n).transpose();
+    EXPECT(assert_equal(Pose3::Expmap(xi), BatchPose(poses, n), 1e-9));
+  }
+
+  // One screw axis, scaled by a batch of scalars.
+  for (const Vector6 &S : {Vector6(twists.row(0).transpose()),
+                           Vector6(twists.row(1).transpose())}) {
+    const Eigen::ArrayXd q = Eigen::ArrayXd::LinSpaced(5, -2.0, 2.0);
+    const PoseBatch screw = BatchExpmap(S, q);
+    for (int n = 0; n < q.size(); n++) {
+      EXPECT(assert_equal(Pose3::Expmap(S * q(n)), BatchPose(screw, n), 1e-9));
+    }
+  }
+}
+
+TEST(SE3Batch, SinglePrecision) {
+  using namespace example;
+  const PoseBatchf A = BatchFromPoses<float>(a), B = BatchFromPoses<float>(b);
+  const TwistBatchf twists = Twists().cast<float>();
+  const PoseBatchf AB = BatchCompose(BatchInverse(A), B);
+  const TwistBatchf Ad = BatchAdjoint(A, twists);
+  const PoseBatchf exp = BatchExpmap(twists);
+  for (size_t n = 0; n < a.size(); n++) {
+    EXPECT(assert_equal(a[n].inverse() * b[n], BatchPose(AB, n), 1e-6));
+    const Vector6 xi = Twists().row(n).transpose();
+    EXPECT(assert_equal(a[n].Adjoint(xi),
+                        Vector6(Ad.row(n).transpose().cast<double>()), 1e-5));
+    EXPECT(assert_equal(Pose3::Expmap(xi), BatchPose(exp, n), 1e-6));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSQPOptimizer.cpp
+ * @brief Test sequential quadratic programming for equality constraints.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+using std::map;
+using std::string;
+
+TEST(SQPOptimizer, ConstrainedExample) {
+  using namespace constrained_example;
+
+  /// Create a constrained optimization problem with 2 cost factors and 1
+  /// constraint.
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  double tolerance = 1.0;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.push_back(EqualityConstraint::shared_ptr(
+      new DoubleExpressionEquality(g1, tolerance)));
+
+  /// Create initial values.
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  /// Solve the constraint problem with SQP optimizer.
+  gtdynamics::SQPOptimizer optimizer;
+  Values results = optimizer.optimize(graph, constraints, init_values);
+
+  /// Check the result is correct within tolerance.
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  double tol = 1e-4;
+  EXPECT(assert_equal(gt_results, results, tol));
+}
+
+// Quadratic cost with a linear constraint is solved by the first QP.
+TEST(SQPOptimizer, LinearConstraint) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 1., x1));
+  graph.add(ExpressionFactor<double>(cost_noise, 2., x2));
+
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(x1 + x2, 1e-6);
+
+  Values init_values;
+  init_values.insert(x1_key, 3.0);
+  init_values.insert(x2_key, -7.0);
+
+  SQPParameters params;
+  params.lambda = 0;
+  SQPOptimizer optimizer(params);
+  ConstrainedOptResult info;
+  Values results = optimizer.optimize(graph, constraints, init_values, &info);
+
+  Values expected;
+  expected.insert(x1_key, -0.5);
+  expected.insert(x2_key, 0.5);
+  EXPECT(assert_equal(expected, results, 1e-9));
+  EXPECT(assert_equal(expected, info.intermediate_values.front(), 1e-9));
+  EXPECT(info.num_iters.size() <= 2);
+  EXPECT_DOUBLES_EQUAL(0.0, info.violations.back(), 1e-6);
+}
+
+// A step that increases the merit function after all backtracks is rejected.
+TEST(SQPOptimizer, RejectedStep) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 1., pow(x1, 3)));
+
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(x2, 1e-6);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.1);
+  init_values.insert(x2_key, 0.0);
+
+  // The full Gauss-Newton step overshoots to x1 = 33.4.
+  SQPParameters params;
+  params.max_backtracks = 0;
+  Values results =
+      SQPOptimizer(params).optimize(graph, constraints, init_values);
+  EXPECT(assert_equal(init_values, results));
+
+  // Halving the step gives a decrease.
+  params.max_backtracks = 20;
+  results = SQPOptimizer(params).optimize(graph, constraints, init_values);
+  EXPECT(graph.error(results) < graph.error(init_values));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSamplingPlanner.cpp
+ * @brief Test sampling-based planning around an obstacle.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/SamplingPlanner.h>
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Vector;
+using gtsam::Vector2;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const uint16_t l2 = robot.link("link_2")->id();
+const std::vector<CollisionSphere> spheres = {{l2, Point3(0, 0, 0), 0.05},
+                                              {l2, Point3(0, 0, 0.3), 0.05}};
+const Vector start = Vector2(-1.0, 1.0), goal = Vector2(1.0, 1.0);
+
+// Tip of link 2 at joint angles q.
+Point3 Tip(const Vector &q) {
+  BatchForwardKinematics fk(robot);
+  fk.compute(q.transpose());
+  return fk.pose(0, l2).transformFrom(spheres[1].comPc);
+}
+
+// A ball of radius 0.1 where the tip would be halfway between start and
+// goal, so that the straight path is blocked.
+SamplingPlanner Planner() {
+  const Point3 center = Tip(Vector2(0.0, 1.0));
+  const double cell_size = 0.05;
+  const Point3 origin(-1, -1, 0);
+  std::vector<gtsam::Matrix> slices;
+  for (size_t z = 0; z < 41; z++) {
+    gtsam::Matrix slice(41, 41);
+    for (size_t row = 0; row < 41; row++) {
+      for (size_t col = 0; col < 41; col++) {
+        const Point3 p = origin + cell_size * Point3(col, row, z);
+        slice(row, col) = (p - center).norm() - 0.1;
+      }
+    }
+    slices.push_back(slice);
+  }
+  SamplingPlannerParameters parameters;
+  parameters.max_samples = 2000;
+  parameters.num_threads = 2;
+  SamplingPlanner planner(robot, spheres, parameters);
+  planner.setObstacles(SignedDistanceField(origin, cell_size, slices));
+  planner.setJointLimits(Vector2(-M_PI, -M_PI), Vector2(M_PI, M_PI));
+  return planner;
+}
+
+// Path from start to goal with free segments.
+bool CheckPath(const SamplingPlanner &planner,
+               const std::vector<Vector> &path) {
+  bool ok = path.size() >= 3;
+  ok &= assert_equal(start, path.front()) && assert_equal(goal, path.back());
+  for (size_t i = 1; ok && i < path.size(); i++) {
+    ok &= planner.motionFree(path[i - 1], path[i]);
+  }
+  return ok;
+}
+}  // namespace example
+
+// Batched checks against the obstacle and the joint limits.
+TEST(SamplingPlanner, collisionFree) {
+  using namespace example;
+  const SamplingPlanner planner = Planner();
+  gtsam::Matrix configurations(4, 2);
+  configurations << -1.0, 1.0, 0.0, 1.0, 0.0, 0.2, 4.0, 0.0;
+  const std::vector<bool> free = planner.collisionFree(configurations);
+  EXPECT(free[0]);
+  EXPECT(!free[1]);  // tip in the ball
+  EXPECT(free[2]);
+  EXPECT(!free[3]);  // outside the limits
+  EXPECT(!planner.motionFree(start, goal));
+  CHECK_EXCEPTION(planner.collisionFree(gtsam::Matrix::Zero(1, 3)),
+                  std::invalid_argument);
+}
+
+// Both planners go around the obstacle, and the path seeds a trajectory.
+TEST(SamplingPlanner, plan) {
+  using namespace example;
+  const SamplingPlanner planner = Planner();
+  const std::vector<Vector> rrt = planner.planRRTConnect(start, goal);
+  EXPECT(CheckPath(planner, rrt));
+  const std::vector<Vector> prm = planner.planPRM(start, goal);
+  EXPECT(CheckPath(planner, prm));
+
+  // Planning is deterministic.
+  const std::vector<Vector> again = planner.planRRTConnect(start, goal);
+  CHECK(rrt.size() == again.size());
+  for (size_t i = 0; i < rrt.size(); i++) {
+    EXPECT(assert_equal(rrt[i], again[i]));
+  }
+
+  const size_t num_steps = 20;
+  const gtsam::Values values = planner.toValues(rrt, num_steps, 0.1);
+  const int j1 = robot.joint("joint_1")->id();
+  const int j2 = robot.joint("joint_2")->id();
+  EXPECT_DOUBLES_EQUAL(start(0), JointAngle(values, j1, 0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(goal(1), JointAngle(values, j2, num_steps), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, JointVel(values, j1, 0), 1e-9);
+  EXPECT(values.exists(TorqueKey(j1, num_steps)));
+  const Vector q =
+      Vector2(JointAngle(values, j1, 7), JointAngle(values, j2, 7));
+  EXPECT(assert_equal(Tip(q),
+                      Pose(values, l2, 7).transformFrom(spheres[1].comPc),
+                      1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -658,6 +658,24 @@ TEST(Sdf, PreserveFixedJoint) {
   EXPECT_LONGS_EQUAL(21, a1_fixed_joints.numJoints());
 }
 
+// Load several robots from one parse of a file.
+TEST(Sdf, CreateRobotsFromFile) {
+  const std::string world = kSdfPath + std::string("test/simple_rr.sdf");
+  const auto all = CreateRobotsFromFile(world);
+  LONGS_EQUAL(1, all.size());
+  EXPECT(all.count("simple_rr_sdf"));
+  EXPECT(CreateRobotFromFile(world, "simple_rr_sdf")
+             .equals(all.at("simple_rr_sdf")));
+
+  const std::string urdf = kUrdfPath + std::string("a1/a1.urdf");
+  const auto selected = CreateRobotsFromFile(urdf, {}, true, 2);
+  LONGS_EQUAL(1, selected.size());
+  EXPECT_LONGS_EQUAL(21, selected.begin()->second.numJoints());
+
+  CHECK_EXCEPTION(CreateRobotsFromFile(world, {"simple_rr_sdf", "missing"}),
+                  std::runtime_error);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSelfCollision.cpp
+ * @brief Test the self-collision broadphase and optimizer.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/SphereSeparationFactor.h>
+#include <gtdynamics/optimizer/SelfCollision.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const uint16_t l0 = robot.link("link_0")->id(), l1 = robot.link("link_1")->id(),
+               l2 = robot.link("link_2")->id();
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.001);
+auto pose_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+
+// One sphere of radius 0.1 at the CoM of every link.
+SelfCollision Collision(double margin = 0.0) {
+  std::vector<CollisionSphere> spheres;
+  for (auto &&link : robot.links()) {
+    spheres.push_back({link->id(), Point3(0, 0, 0), 0.1});
+  }
+  return SelfCollision(robot, spheres, cost_model, 0.05, margin);
+}
+
+Values Poses(const Point3 &t2) {
+  Values values;
+  InsertPose(&values, l0, 0, Pose3());
+  InsertPose(&values, l1, 0, Pose3());
+  InsertPose(&values, l2, 0, Pose3(Rot3(), t2));
+  return values;
+}
+}  // namespace example
+
+// Only links that are not connected by a joint are checked, and only when
+// their spheres are near.
+TEST(SelfCollision, nearPairs) {
+  using namespace example;
+  const SelfCollision collision = Collision();
+  EXPECT(!collision.checked(l0, l1));
+  EXPECT(collision.checked(l0, l2));
+  EXPECT_LONGS_EQUAL(1, collision.numCandidatePairs());
+
+  auto pairs = collision.nearPairs(Poses(Point3(0.2, 0, 0)), 0);
+  EXPECT_LONGS_EQUAL(1, pairs.size());
+  EXPECT_LONGS_EQUAL(0, pairs[0].k);
+  EXPECT(collision.nearPairs(Poses(Point3(0.3, 0, 0)), 0).empty());
+  EXPECT(collision.nearPairs(Poses(Point3(0, 0.2, 1)), 0).empty());
+  EXPECT(collision.nearPairs(Poses(Point3(0.2, 0, 0)), 1).empty());
+
+  // A margin keeps pairs about to collide.
+  EXPECT_LONGS_EQUAL(
+      1, Collision(0.1).nearPairs(Poses(Point3(0.3, 0, 0)), 0).size());
+
+  SelfCollision excluded = Collision();
+  excluded.exclude(l2, l0);
+  EXPECT(excluded.nearPairs(Poses(Point3(0.2, 0, 0)), 0).empty());
+
+  const NonlinearFactorGraph factors = collision.factors(pairs);
+  EXPECT_LONGS_EQUAL(1, factors.size());
+  // Centers 0.2 apart, 0.05 closer than the radii and clearance.
+  EXPECT_DOUBLES_EQUAL(0.5 * 50 * 50,
+                       factors.at(0)->error(Poses(Point3(0.2, 0, 0))), 1e-6);
+}
+
+TEST(SphereSeparationFactor, Jacobians) {
+  using namespace example;
+  const SphereSeparationFactor factor(PoseKey(l0, 0), Point3(0.1, 0.2, 0),
+                                      PoseKey(l2, 0), Point3(0, -0.1, 0.3),
+                                      1.0, cost_model);
+  Values values;
+  InsertPose(&values, l0, 0, Pose3(Rot3::Rz(0.3), Point3(0.1, 0, 0)));
+  InsertPose(&values, l2, 0, Pose3(Rot3::Rx(-0.2), Point3(0.2, 0.3, -0.1)));
+  EXPECT(factor.unwhitenedError(values)(0) > 0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// Colliding links are pushed apart by the factors of their near pairs.
+TEST(SelfCollisionOptimizer, optimize) {
+  using namespace example;
+  NonlinearFactorGraph graph;
+  graph.addPrior(PoseKey(l0, 0), Pose3(), pose_model);
+  graph.addPrior(PoseKey(l1, 0), Pose3(), pose_model);
+  graph.addPrior(PoseKey(l2, 0), Pose3(Rot3(), Point3(0.1, 0, 0)),
+                 pose_model);
+
+  SelfCollisionParameters params;
+  params.iterations_per_round = 3;
+  std::vector<SelfCollision::Pair> pairs;
+  const Values result = SelfCollisionOptimizer(Collision(0.05), params)
+                            .optimize(graph, Poses(Point3(0.1, 0, 0)), {0},
+                                      &pairs);
+  EXPECT_LONGS_EQUAL(1, pairs.size());
+  const double distance = (Pose(result, l2, 0).translation() -
+                           Pose(result, l0, 0).translation())
+                              .norm();
+  EXPECT(distance > 0.24);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSensitivity.cpp
+ * @brief Test sensitivity of optima to parameters.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/Sensitivity.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+const gtsam::Key goal = JointAngleKey(9, 0);
+
+// A chain of angles pulled towards a goal at the end and zero at the start.
+NonlinearFactorGraph chain(int num_steps, double stiffness) {
+  NonlinearFactorGraph graph;
+  const auto step_model = gtsam::noiseModel::Isotropic::Sigma(1, stiffness);
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  for (int t = 1; t < num_steps; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.0, step_model);
+  }
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      goal, JointAngleKey(0, num_steps - 1), 0.0, model);
+  return graph;
+}
+}  // namespace example
+
+// A goal variable held fixed, compared with re-solving.
+TEST(OptimumSensitivity, goal_variable) {
+  using namespace example;
+  const int num_steps = 5;
+  NonlinearFactorGraph graph = chain(num_steps, 0.5);
+  auto solve = [&](double goal_value) {
+    NonlinearFactorGraph fixed = graph;
+    fixed.addPrior<double>(goal, goal_value,
+                           gtsam::noiseModel::Constrained::All(1));
+    Values init;
+    for (int t = 0; t < num_steps; t++) init.insert(JointAngleKey(0, t), 0.0);
+    init.insert(goal, goal_value);
+    return gtsam::LevenbergMarquardtOptimizer(fixed, init).optimize();
+  };
+
+  Values optimum = solve(1.0);
+  OptimumSensitivity sensitivity(graph, optimum, {goal});
+  EXPECT_LONGS_EQUAL(num_steps, sensitivity.variables().size());
+
+  const double h = 1e-4;
+  for (int t = 0; t < num_steps; t++) {
+    const gtsam::Key key = JointAngleKey(0, t);
+    const double expected =
+        (solve(1.0 + h).at<double>(key) - solve(1.0 - h).at<double>(key)) /
+        (2 * h);
+    Matrix J = sensitivity.jacobian(key, goal);
+    EXPECT_LONGS_EQUAL(1, J.size());
+    EXPECT_DOUBLES_EQUAL(expected, J(0, 0), 1e-6);
+  }
+  CHECK_EXCEPTION(OptimumSensitivity(graph, optimum, {JointAngleKey(5, 0)}),
+                  std::exception);
+}
+
+// Parameters of a graph builder: x* = theta^2 / 2 from two priors.
+TEST(OptimumSensitivity, graph_builder) {
+  using namespace example;
+  const gtsam::Key x = JointAngleKey(0, 0);
+  auto builder = [&](const Vector& theta) {
+    NonlinearFactorGraph graph;
+    graph.addPrior<double>(x, theta(0) * theta(0), model);
+    graph.addPrior<double>(x, 0.0, model);
+    return graph;
+  };
+  Values optimum;
+  optimum.insert(x, 0.5 * 1.5 * 1.5);
+  OptimumSensitivity sensitivity(builder, Vector::Constant(1, 1.5), optimum);
+  Matrix J = sensitivity.jacobian(x, OptimumSensitivity::kParameterKey);
+  EXPECT(assert_equal((Matrix(1, 1) << 1.5).finished(), J, 1e-6));
+
+  gtsam::VectorValues direction;
+  direction.insert(OptimumSensitivity::kParameterKey, Vector::Constant(1, 2));
+  EXPECT(assert_equal(Vector::Constant(1, 3.0).eval(),
+                      sensitivity.solve(direction).at(x), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testShardedValues.cpp
+ * @brief Test values sharded by time step.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/ShardedValues.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace example {
+// Joint angles and link poses of three time steps.
+Values Trajectory() {
+  Values values;
+  for (int t = 0; t < 3; t++) {
+    for (int j = 0; j < 2; j++) InsertJointAngle(&values, j, t, 0.1 * t + j);
+    InsertPose(&values, 0, t, Pose3());
+  }
+  return values;
+}
+}  // namespace example
+
+// Values are split by time step and merged back unchanged.
+TEST(ShardedValues, slices) {
+  const Values values = example::Trajectory();
+  const ShardedValues sharded(values);
+  EXPECT_LONGS_EQUAL(values.size(), sharded.size());
+  EXPECT_LONGS_EQUAL(3, sharded.numSlices());
+  EXPECT(sharded.times() == std::vector<uint64_t>({0, 1, 2}));
+  EXPECT_LONGS_EQUAL(3, sharded.slice(1).size());
+  EXPECT_LONGS_EQUAL(0, sharded.slice(7).size());
+  EXPECT(assert_equal(values, sharded.values()));
+  EXPECT_LONGS_EQUAL(6, sharded.values(1, 5).size());
+
+  EXPECT(sharded.exists(JointAngleKey(1, 2)));
+  EXPECT(!sharded.exists(JointAngleKey(2, 2)));
+  EXPECT_DOUBLES_EQUAL(1.2, sharded.at<double>(JointAngleKey(1, 2)), 1e-12);
+  CHECK_EXCEPTION(sharded.at(JointAngleKey(0, 7)),
+                  gtsam::ValuesKeyDoesNotExist);
+
+  ShardedValues copy = sharded;
+  CHECK_EXCEPTION(copy.setSlice(0, sharded.slice(1)), std::invalid_argument);
+}
+
+// Copies share slices until they are modified.
+TEST(ShardedValues, copyOnWrite) {
+  const ShardedValues original(example::Trajectory());
+  ShardedValues copy = original;
+  for (uint64_t t : {0, 1, 2}) EXPECT(copy.sharesSlice(original, t));
+
+  copy.update<double>(JointAngleKey(0, 1), 5.0);
+  EXPECT(copy.sharesSlice(original, 0));
+  EXPECT(!copy.sharesSlice(original, 1));
+  EXPECT(copy.sharesSlice(original, 2));
+  EXPECT_DOUBLES_EQUAL(0.1, original.at<double>(JointAngleKey(0, 1)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(5.0, copy.at<double>(JointAngleKey(0, 1)), 1e-12);
+
+  // Inserting a new step only adds a slice.
+  copy.insert<double>(JointAngleKey(0, 3), 1.0);
+  EXPECT_LONGS_EQUAL(4, copy.numSlices());
+  CHECK_EXCEPTION(copy.insert<double>(JointAngleKey(0, 3), 1.0),
+                  gtsam::ValuesKeyAlreadyExists);
+  CHECK_EXCEPTION(copy.update<double>(JointAngleKey(0, 4), 1.0),
+                  gtsam::ValuesKeyDoesNotExist);
+}
+
+// Merges share slices that only one side has.
+TEST(ShardedValues, merge) {
+  ShardedValues a(example::Trajectory());
+  Values later;
+  InsertJointAngle(&later, 0, 5, 0.5);
+  InsertJointAngle(&later, 0, 2, 9.0);
+  const ShardedValues b(later);
+
+  ShardedValues merged = a;
+  CHECK_EXCEPTION(merged.insert(b), gtsam::ValuesKeyAlreadyExists);
+
+  merged = a;
+  merged.insertOrAssign(b);
+  EXPECT(merged.sharesSlice(b, 5));
+  EXPECT(merged.sharesSlice(a, 1));
+  EXPECT_DOUBLES_EQUAL(9.0, merged.at<double>(JointAngleKey(0, 2)), 1e-12);
+  EXPECT_LONGS_EQUAL(a.size() + 1, merged.size());
+}
+
+// Retracting only copies the slices with a nonzero delta.
+TEST(ShardedValues, retract) {
+  const Values values = example::Trajectory();
+  const ShardedValues sharded(values);
+  gtsam::VectorValues delta;
+  delta.insert(JointAngleKey(1, 2), gtsam::Vector1(0.5));
+  const ShardedValues retracted = sharded.retract(delta);
+  EXPECT(retracted.sharesSlice(sharded, 0));
+  EXPECT(!retracted.sharesSlice(sharded, 2));
+  EXPECT(assert_equal(values.retract(delta), retracted.values()));
+}
+
+// Solving one time step of a trajectory leaves the other steps shared.
+TEST(ShardedValues, linearSolveFD) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  ShardedValues known;
+  for (int t = 0; t < 3; t++) {
+    Values values;
+    InsertPose(&values, l1->id(), t, l1->bMcom());
+    InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+    values = robot.forwardKinematics(values, t, std::string("l1"));
+    InsertTorque(&values, robot.joint("j1")->id(), t, 1.0);
+    known.setSlice(t, values);
+  }
+
+  const ShardedValues result = graph_builder.linearSolveFD(robot, 1, known);
+  EXPECT(result.sharesSlice(known, 0));
+  EXPECT(!result.sharesSlice(known, 1));
+  EXPECT(result.sharesSlice(known, 2));
+  EXPECT(assert_equal(graph_builder.linearSolveFD(robot, 1, known.slice(1)),
+                      result.slice(1)));
+  EXPECT(result.exists(JointAccelKey(robot.joint("j1")->id(), 1)));
+  EXPECT(!result.exists(JointAccelKey(robot.joint("j1")->id(), 0)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
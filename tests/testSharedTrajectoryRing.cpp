@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSharedTrajectoryRing.cpp
+ * @brief Test the shared memory ring of trajectories.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/SharedTrajectoryRing.h>
+#include <gtdynamics/utils/values.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace gtdynamics;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const std::string name =
+    "/testSharedTrajectoryRing_" + std::to_string(::getpid());
+
+// Trajectory whose quantities are value + 10 step + joint column, and
+// 100 more for every derivative.
+TrajectoryBuffer Trajectory(size_t num_steps, double value) {
+  TrajectoryBuffer buffer(robot, num_steps);
+  for (size_t t = 0; t < num_steps; t++) {
+    for (size_t c = 0; c < robot.numJoints(); c++) {
+      buffer.jointAngles()(t, c) = value + 10 * t + c;
+      buffer.jointVels()(t, c) = value + 10 * t + c + 100;
+      buffer.jointAccels()(t, c) = value + 10 * t + c + 200;
+      buffer.torques()(t, c) = value + 10 * t + c + 300;
+    }
+  }
+  return buffer;
+}
+}  // namespace example
+
+// A reader in place of another process finds the written trajectories.
+TEST(SharedTrajectoryRing, WriteRead) {
+  using namespace example;
+  SharedTrajectoryWriter writer(name, robot, 8, 2);
+  SharedTrajectoryReader reader(name);
+  LONGS_EQUAL(robot.numJoints(), reader.numJoints());
+  LONGS_EQUAL(8, reader.maxSteps());
+  const uint16_t id = robot.joints()[1]->id();
+  LONGS_EQUAL(1, reader.jointColumn(id));
+  LONGS_EQUAL(-1, reader.jointColumn(1000));
+  LONGS_EQUAL(0, reader.latest());
+
+  LONGS_EQUAL(1, writer.write(Trajectory(5, 0.0), 2.0, 0.01));
+  LONGS_EQUAL(1, reader.latest());
+  double q[2], v[2], a[2], tau[2];
+  CHECK(reader.readStep(1, 3, q, v, a, tau));
+  EXPECT_DOUBLES_EQUAL(31, q[1], 0);
+  EXPECT_DOUBLES_EQUAL(130, v[0], 0);
+  EXPECT_DOUBLES_EQUAL(231, a[1], 0);
+  EXPECT_DOUBLES_EQUAL(330, tau[0], 0);
+  CHECK(!reader.readStep(1, 5, q));
+
+  SharedTrajectoryView view;
+  CHECK(reader.view(1, &view));
+  LONGS_EQUAL(5, view.num_steps);
+  EXPECT_DOUBLES_EQUAL(2.0, view.start_time, 0);
+  EXPECT_DOUBLES_EQUAL(0.01, view.dt, 0);
+  EXPECT_DOUBLES_EQUAL(41, view.angles[4 * 2 + 1], 0);
+
+  // With 2 slots, trajectory 3 overwrites trajectory 1.
+  writer.write(Trajectory(4, 1000.0), 2.05, 0.01);
+  writer.write(Trajectory(4, 2000.0), 2.1, 0.01);
+  LONGS_EQUAL(3, reader.latest());
+  CHECK(!reader.validate(view));
+  CHECK(!reader.readStep(1, 0, q));
+  CHECK(reader.readStep(2, 0, q));
+  EXPECT_DOUBLES_EQUAL(1000, q[0], 0);
+
+  CHECK_EXCEPTION(writer.write(Trajectory(9, 0.0), 0, 0.01),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(SharedTrajectoryReader("/testSharedTrajectoryRing_none"),
+                  std::runtime_error);
+}
+
+// Reads concurrent with writes either fail or return a whole step of one
+// trajectory, never a mix.
+TEST(SharedTrajectoryRing, Concurrent) {
+  using namespace example;
+  SharedTrajectoryWriter writer(name, robot, 50, 2);
+  SharedTrajectoryReader reader(name);
+  std::atomic<bool> done(false);
+  std::thread writing([&]() {
+    for (size_t n = 1; n <= 2000; n++) {
+      writer.write(Trajectory(50, 1000.0 * n), 0, 0.01);
+    }
+    done = true;
+  });
+
+  size_t num_torn = 0;
+  double q[2], tau[2];
+  while (!done) {
+    const uint64_t n = reader.latest();
+    if (!reader.readStep(n, 49, q, nullptr, nullptr, tau)) continue;
+    if (q[0] != 1000.0 * n + 490 || q[1] != q[0] + 1 || tau[0] != q[0] + 300)
+      num_torn++;
+  }
+  writing.join();
+  LONGS_EQUAL(0, num_torn);
+  CHECK(reader.readStep(2000, 0, q));
+  EXPECT_DOUBLES_EQUAL(2000000, q[0], 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
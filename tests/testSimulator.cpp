@@ -21,6 +21,7 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <cmath>
 #include <iostream>
 
 using namespace gtdynamics;
@@ -52,6 +53,165 @@ TEST(Simulate, simple_urdf) {
   EXPECT(assert_equal(expected_qAccel, JointAccel(results, 0)));
 }
 
+TEST(Simulate, recording) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+
+  // The buffer starts with one step and has to grow.
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  simulator.startRecording(1, true);
+  const double dt = 0.5;
+  std::vector<gtsam::Values> steps;
+  for (int k = 0; k < 3; k++) {
+    simulator.step(torques, dt);
+    steps.push_back(simulator.getValues());
+  }
+  simulator.stopRecording();
+  simulator.step(torques, dt);
+  EXPECT_LONGS_EQUAL(3, simulator.numRecordedSteps());
+
+  const gtsam::Values recorded = simulator.recordedValues();
+  for (int k = 0; k < 3; k++) {
+    EXPECT(assert_equal(JointAngle(steps[k], 0), JointAngle(recorded, 0, k)));
+    EXPECT(assert_equal(JointVel(steps[k], 0), JointVel(recorded, 0, k)));
+    EXPECT(assert_equal(JointAccel(steps[k], 0), JointAccel(recorded, 0, k)));
+    EXPECT(assert_equal(1.0, Torque(recorded, 0, k)));
+    for (auto &&link : robot.links()) {
+      EXPECT(assert_equal(Pose(steps[k], link->id()),
+                          Pose(recorded, link->id(), k)));
+    }
+  }
+  EXPECT(!recorded.exists(JointAngleKey(0, 3)));
+  EXPECT_LONGS_EQUAL(3, simulator.recording().numSteps());
+}
+
+// Damping of simple_urdf opposes the joint velocity.
+TEST(Simulate, passive_joint_torques) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertJointAngle(&initial_values, 0, 0.0);
+  InsertJointVel(&initial_values, 0, 0.1);
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  simulator.setJointEfforts(true, false);
+  simulator.forwardDynamics(torques);
+
+  // Unit torque gives an acceleration of 0.0625, and the damping is 500.
+  const double net_torque = 1.0 - 500 * 0.1;
+  EXPECT(assert_equal(net_torque, Torque(simulator.getValues(), 0)));
+  EXPECT(assert_equal(0.0625 * net_torque,
+                      JointAccel(simulator.getValues(), 0), 1e-9));
+}
+
+// Hard limits of simple_urdf stop the joint at its angle limit.
+TEST(Simulate, joint_limits) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertJointAngle(&initial_values, 0, 0.0);
+  InsertJointVel(&initial_values, 0, 0.0);
+  InsertTorque(&torques, 0, 2000.0);
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  simulator.setJointEfforts(false, true);
+  simulator.step(torques, 0.01);
+
+  // The torque is clamped to the effort limit of 1000.
+  EXPECT(assert_equal(1000.0, Torque(simulator.getValues(), 0)));
+  EXPECT(assert_equal(62.5, JointAccel(simulator.getValues(), 0), 1e-9));
+
+  // The velocity is clamped to 0.5, then the joint stops at 1.57.
+  simulator.step(torques, 0.01);
+  EXPECT(assert_equal(0.5, JointVel(simulator.getValues(), 0), 1e-9));
+  for (int k = 0; k < 400; k++) simulator.step(torques, 0.01);
+  EXPECT(assert_equal(1.57, JointAngle(simulator.getValues(), 0), 1e-9));
+  EXPECT(assert_equal(0.0, JointVel(simulator.getValues(), 0), 1e-9));
+}
+// A joint angle threshold ends the step at its analytic crossing time.
+TEST(Simulate, stepToEvent) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertJointAngle(&initial_values, 0, 0.0);
+  InsertJointVel(&initial_values, 0, 0.0);
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  simulator.addEvent(ThresholdEvent("angle", JointAngleKey(0), 0.02,
+                                    EventDirection::Rising));
+
+  // With acceleration 0.0625, the angle 0.02 is reached after 0.8 s.
+  EventStep result = simulator.stepToEvent(torques, 1.0, 1e-12);
+  EXPECT_LONGS_EQUAL(0, result.event);
+  EXPECT(assert_equal(0.8, result.dt, 1e-9));
+  simulator.forwardDynamics(torques);
+  EXPECT(assert_equal(0.02, JointAngle(simulator.getValues(), 0), 1e-9));
+  EXPECT(assert_equal(0.05, JointVel(simulator.getValues(), 0), 1e-9));
+
+  // Past the threshold, the event does not trigger again.
+  result = simulator.stepToEvent(torques, 1.0);
+  EXPECT_LONGS_EQUAL(-1, result.event);
+  EXPECT(assert_equal(1.0, result.dt));
+}
+
+// A restored or forked simulator continues exactly like the original.
+TEST(Simulate, snapshot) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  const SimulatorState start = simulator.snapshot();
+  EXPECT_LONGS_EQUAL(0, start.t);
+  EXPECT(assert_equal(gtsam::Vector::Zero(1), start.q));
+
+  const double dt = 0.5;
+  simulator.step(torques, dt);
+  const SimulatorState state = simulator.snapshot();
+  EXPECT_LONGS_EQUAL(1, state.t);
+  simulator.step(torques, dt);
+  simulator.step(torques, dt);
+  const gtsam::Values expected = simulator.getValues();
+  const SimulatorState end = simulator.snapshot();
+
+  Simulator fork = simulator.fork(state);
+  EXPECT(fork.backend() == simulator.backend());
+  fork.step(torques, dt);
+  fork.step(torques, dt);
+  EXPECT(assert_equal(expected, fork.getValues()));
+  EXPECT(assert_equal(end.v, fork.snapshot().v));
+
+  // The original is unaffected by its fork, and can branch again.
+  EXPECT(assert_equal(end.q, simulator.snapshot().q));
+  simulator.restore(state);
+  simulator.step(torques, dt);
+  simulator.step(torques, dt);
+  EXPECT(assert_equal(expected, simulator.getValues()));
+  EXPECT_LONGS_EQUAL(3, simulator.snapshot().t);
+
+  SimulatorState wrong = state;
+  wrong.q = gtsam::Vector::Zero(2);
+  CHECK_EXCEPTION(simulator.restore(wrong), std::invalid_argument);
+}
+
+TEST(LocalizeZeroCrossing, cubic) {
+  auto f = [](double t) { return t * t * t - 2; };
+  const double t = LocalizeZeroCrossing(f, 0, f(0), 2, f(2), 1e-10);
+  EXPECT_DOUBLES_EQUAL(std::cbrt(2.0), t, 1e-9);
+  CHECK_EXCEPTION(LocalizeZeroCrossing(f, 2, f(2), 3, f(3)),
+                  std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
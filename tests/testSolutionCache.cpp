@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolutionCache.cpp
+ * @brief Test the persistent cache of planning solutions.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/SolutionCache.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+Values Solution(double scale) {
+  Values values;
+  for (size_t k = 0; k <= 3; k++) {
+    InsertJointAngle(&values, 0, k, scale * k);
+    InsertPose(&values, 0, k, Pose3(Rot3::Rz(scale * k), Point3(k, 0, 0)));
+  }
+  values.insert(PhaseKey(0), 0.1 * scale);
+  return values;
+}
+}  // namespace example
+
+// Equal queries hash alike, and any change of the query changes the hash.
+TEST(PlanningQueryHash, Queries) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 2);
+  ContactGoals goals;
+  for (auto &&cp : walk_cycle.contactPoints()) {
+    goals.emplace_back(cp, Point3(0, 0, -0.2));
+  }
+  const OptimizationParameters parameters;
+  auto query = [&](const Trajectory &trajectory, const ContactGoals &goals,
+                   const OptimizationParameters &parameters) {
+    return PlanningQueryHash()
+        .add(robot)
+        .add(trajectory)
+        .add(goals)
+        .add(parameters)
+        .value();
+  };
+  const uint64_t hash = query(trajectory, goals, parameters);
+  EXPECT(hash == query(Trajectory(walk_cycle, 2), goals, parameters));
+  EXPECT(hash != query(Trajectory(walk_cycle, 3), goals, parameters));
+
+  ContactGoals moved = goals;
+  moved[0].goal_point.z() += 1e-9;
+  EXPECT(hash != query(trajectory, moved, parameters));
+
+  OptimizationParameters other = parameters;
+  other.lm_parameters.setMaxIterations(7);
+  EXPECT(hash != query(trajectory, goals, other));
+
+  EXPECT(PlanningQueryHash().add(robot).value() !=
+         PlanningQueryHash().add(simple_rr::getRobot()).value());
+  EXPECT(PlanningQueryHash().add(walk_cycle).value() ==
+         PlanningQueryHash().add(walk_cycle).value());
+}
+
+// Solutions are found again, after the cache is reopened too.
+TEST(SolutionCache, Persistence) {
+  {
+    SolutionCache cache(".");
+    cache.clear();
+    EXPECT(!cache.find(1));
+    cache.insert(1, example::Solution(1.0));
+    EXPECT(cache.contains(1));
+    auto found = cache.find(1);
+    CHECK(found);
+    EXPECT(assert_equal(example::Solution(1.0), *found));
+    EXPECT_LONGS_EQUAL(1, cache.numHits());
+    EXPECT_LONGS_EQUAL(1, cache.numMisses());
+  }
+
+  // Reopened, without solutions in memory.
+  SolutionCache cache(".", 256, 0);
+  EXPECT_LONGS_EQUAL(1, cache.size());
+  auto found = cache.find(1);
+  CHECK(found);
+  EXPECT(assert_equal(example::Solution(1.0), *found));
+
+  // findOrSolve only solves on a miss.
+  size_t num_solves = 0;
+  auto solve = [&]() {
+    num_solves++;
+    return example::Solution(2.0);
+  };
+  EXPECT(assert_equal(example::Solution(1.0), cache.findOrSolve(1, solve)));
+  EXPECT(assert_equal(example::Solution(2.0), cache.findOrSolve(2, solve)));
+  EXPECT(assert_equal(example::Solution(2.0), cache.findOrSolve(2, solve)));
+  EXPECT_LONGS_EQUAL(1, num_solves);
+
+  // A removed file is a miss.
+  std::remove(cache.path(2).c_str());
+  EXPECT(!cache.find(2));
+  EXPECT(!cache.contains(2));
+  cache.clear();
+  EXPECT_LONGS_EQUAL(0, cache.size());
+}
+
+// The least recently used solution is evicted, with its file.
+TEST(SolutionCache, Eviction) {
+  {
+    SolutionCache cache(".", 2, 1);
+    cache.clear();
+    cache.insert(1, example::Solution(1.0));
+    cache.insert(2, example::Solution(2.0));
+    EXPECT(cache.find(1));
+    cache.insert(3, example::Solution(3.0));
+    EXPECT_LONGS_EQUAL(2, cache.size());
+    EXPECT(!cache.contains(2));
+    EXPECT(!std::ifstream(cache.path(2)));
+  }
+
+  SolutionCache reopened(".", 2);
+  EXPECT(reopened.contains(1));
+  EXPECT(reopened.contains(3));
+  EXPECT(assert_equal(example::Solution(3.0), *reopened.find(3)));
+  reopened.clear();
+
+  CHECK_EXCEPTION(SolutionCache(".", 0), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolveBudget.cpp
+ * @brief Test deadlines, cancellation and anytime results of solves.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/OptimizerTelemetry.h>
+#include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtdynamics/optimizer/SolveBudget.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <memory>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::ExpressionFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+using namespace constrained_example;
+auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+
+// Two nonlinear costs on x1 and x2.
+NonlinearFactorGraph Graph() {
+  NonlinearFactorGraph graph;
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+// x1 + x1^3 + x2 + x2^2 = 0.
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.push_back(EqualityConstraint::shared_ptr(
+      new DoubleExpressionEquality(g1, 1.0)));
+  return constraints;
+}
+
+Values InitialValues() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+TEST(SolveBudget, Deadline) {
+  EXPECT(!Deadline().bounded());
+  EXPECT(!Deadline().expired());
+  EXPECT(!Deadline(0).bounded());
+  EXPECT(Deadline(100).bounded() && !Deadline(100).expired());
+  EXPECT(Deadline(100).within(1e-9).expired());
+  EXPECT(!Deadline().within(100).expired());
+
+  auto token = std::make_shared<CancellationToken>();
+  const Deadline deadline(0, token);
+  EXPECT(deadline.bounded() && !deadline.expired());
+  token->cancel();
+  EXPECT(deadline.expired() && deadline.within(100).expired());
+  token->reset();
+  EXPECT(!deadline.expired());
+}
+
+// Feasible iterates beat infeasible ones, then the lower cost wins; among
+// infeasible ones the lower violation wins.
+TEST(SolveBudget, BestIterate) {
+  auto iterate = [](double x) {
+    Values values;
+    values.insert(0, x);
+    return values;
+  };
+  BestIterate best;
+  EXPECT(best.empty());
+  best.update(iterate(1), 1.0, 5.0);
+  best.update(iterate(2), 0.5, 7.0);
+  EXPECT(!best.empty() && !best.feasible());
+  EXPECT(assert_equal(iterate(1), best.values()));
+  best.update(iterate(3), 9.0, 0.5);
+  best.update(iterate(4), 0.1, 3.0);
+  best.update(iterate(5), 4.0, 1.0);
+  best.update(iterate(6), 8.0, 0.0);
+  EXPECT(best.feasible());
+  EXPECT(assert_equal(iterate(5), best.values()));
+}
+
+// A cancelled or expired solve returns without iterating, and a zero budget
+// is no limit.
+TEST(SolveBudget, Optimizer) {
+  using namespace example;
+  auto telemetry = std::make_shared<OptimizerTelemetry>();
+  OptimizationParameters params;
+  params.telemetry = telemetry;
+  const Values expected = Optimizer(params).optimize(Graph(), InitialValues());
+  EXPECT(!telemetry->solves().back().interrupted);
+
+  params.cancellation = std::make_shared<CancellationToken>();
+  EXPECT(assert_equal(expected,
+                      Optimizer(params).optimize(Graph(), InitialValues())));
+  params.cancellation->cancel();
+  EXPECT(assert_equal(InitialValues(),
+                      Optimizer(params).optimize(Graph(), InitialValues())));
+  EXPECT(telemetry->solves().back().interrupted);
+  EXPECT_LONGS_EQUAL(0, telemetry->solves().back().iterations);
+
+  params.cancellation.reset();
+  params.time_budget = 1e-9;
+  EXPECT(assert_equal(InitialValues(),
+                      Optimizer(params).optimize(Graph(), InitialValues())));
+}
+
+// Constrained methods out of time return their best iterate so far, and
+// inner solves are cut off by the outer-iteration budget.
+TEST(SolveBudget, Constrained) {
+  using namespace example;
+  const Values init = InitialValues();
+  auto token = std::make_shared<CancellationToken>();
+  token->cancel();
+
+  AugmentedLagrangianParameters al_params;
+  al_params.cancellation = token;
+  AugmentedLagrangianState state;
+  EXPECT(assert_equal(init, AugmentedLagrangianOptimizer(al_params).optimize(
+                                Graph(), Constraints(), init, &state)));
+  EXPECT_LONGS_EQUAL(0, state.num_iterations);
+
+  PenaltyMethodParameters penalty_params;
+  penalty_params.cancellation = token;
+  EXPECT(assert_equal(init, PenaltyMethodOptimizer(penalty_params)
+                                .optimize(Graph(), Constraints(), init)));
+
+  SQPParameters sqp_params;
+  sqp_params.cancellation = token;
+  EXPECT(assert_equal(
+      init, SQPOptimizer(sqp_params).optimize(Graph(), Constraints(), init)));
+
+  // Every inner solve is interrupted, but outer iterations go on.
+  auto telemetry = std::make_shared<OptimizerTelemetry>();
+  al_params.cancellation.reset();
+  al_params.telemetry = telemetry;
+  al_params.outer_time_budget = 1e-9;
+  AugmentedLagrangianOptimizer(al_params).optimize(Graph(), Constraints(),
+                                                   init);
+  const auto solves = telemetry->solves();
+  EXPECT_LONGS_EQUAL(al_params.num_iterations, solves.size());
+  for (auto&& solve : solves) EXPECT(solve.interrupted);
+
+  // A generous budget changes nothing.
+  al_params.telemetry.reset();
+  al_params.outer_time_budget = 0;
+  const Values expected = AugmentedLagrangianOptimizer(al_params).optimize(
+      Graph(), Constraints(), init);
+  al_params.time_budget = 100;
+  EXPECT(assert_equal(expected, AugmentedLagrangianOptimizer(al_params)
+                                    .optimize(Graph(), Constraints(), init)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolvePlan.cpp
+ * @brief Test reuse of symbolic analysis across solves.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolvePlan.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+auto noise = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// A chain of n scalars with a prior on the first one at x0.
+NonlinearFactorGraph Chain(size_t n, double x0, double step) {
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(0, x0, noise);
+  for (size_t i = 0; i + 1 < n; i++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(i, i + 1, step, noise);
+  }
+  return graph;
+}
+
+Values Zeros(size_t n) {
+  Values values;
+  for (size_t i = 0; i < n; i++) values.insert<double>(i, 0.0);
+  return values;
+}
+}  // namespace example
+
+// The structure only depends on the keys of the factors.
+TEST(SolvePlan, matches) {
+  using namespace example;
+  const SolvePlan plan(Chain(5, 1.0, 2.0));
+  EXPECT(plan.matches(Chain(5, -3.0, 0.5)));
+  EXPECT(!plan.matches(Chain(6, 1.0, 2.0)));
+  EXPECT_LONGS_EQUAL(GraphStructureHash(Chain(5, 7.0, 1.0)), plan.hash());
+  EXPECT_LONGS_EQUAL(5, plan.ordering().size());
+
+  NonlinearFactorGraph reversed;
+  reversed.addPrior<double>(0, 1.0, noise);
+  for (size_t i = 0; i < 4; i++) {
+    reversed.emplace_shared<gtsam::BetweenFactor<double>>(i + 1, i, 2.0,
+                                                          noise);
+  }
+  EXPECT(!plan.matches(reversed));
+}
+
+// Plans are computed once per structure.
+TEST(SolvePlanCache, plan) {
+  using namespace example;
+  SolvePlanCache cache;
+  auto plan = cache.plan(Chain(5, 1.0, 2.0));
+  EXPECT(plan == cache.plan(Chain(5, 4.0, -1.0)));
+  EXPECT(plan != cache.plan(Chain(3, 1.0, 2.0)));
+  EXPECT_LONGS_EQUAL(2, cache.size());
+  EXPECT_LONGS_EQUAL(1, cache.hits());
+  EXPECT_LONGS_EQUAL(2, cache.misses());
+  cache.clear();
+  EXPECT_LONGS_EQUAL(0, cache.size());
+}
+
+// Solves with a cached plan give the same results.
+TEST(SolvePlanCache, Optimizer) {
+  using namespace example;
+  OptimizationParameters params;
+  params.solve_plans = std::make_shared<SolvePlanCache>();
+  const Optimizer optimizer(params);
+  for (double x0 : {1.0, -2.0, 3.0}) {
+    const NonlinearFactorGraph graph = Chain(5, x0, 0.5);
+    const Values expected = Optimizer().optimize(graph, Zeros(5));
+    EXPECT(assert_equal(expected, optimizer.optimize(graph, Zeros(5)), 1e-6));
+    EXPECT_DOUBLES_EQUAL(x0 + 2.0, expected.at<double>(4), 1e-3);
+  }
+  EXPECT_LONGS_EQUAL(1, params.solve_plans->size());
+  EXPECT_LONGS_EQUAL(2, params.solve_plans->hits());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSparseNlp.cpp
+ * @brief Test the export of constrained problems to external NLP solvers.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/SparseNlp.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::pow;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::x1_key, constrained_example::x2_key;
+
+namespace example {
+// Cost 1/2 (x1 - 1)^2 + 1/2 (x2 - 2)^2 + 1/2 (x2 - x1)^2,
+// subject to x1^2 + x2 - 1 = 0.
+SparseNlp Nlp(size_t num_threads = 1) {
+  NonlinearFactorGraph graph;
+  auto model = noiseModel::Unit::Create(1);
+  graph.emplace_shared<PriorFactor<double>>(x1_key, 1.0, model);
+  graph.emplace_shared<PriorFactor<double>>(x2_key, 2.0, model);
+  graph.emplace_shared<BetweenFactor<double>>(x1_key, x2_key, 0.0, model);
+  EqualityConstraints equalities;
+  equalities.emplace_shared<DoubleExpressionEquality>(
+      pow(x1, 2) + x2 + Double_(-1.0), 1e-3);
+  Values reference;
+  reference.insert(x1_key, 0.5);
+  reference.insert(x2_key, 0.25);
+  return SparseNlp(graph, equalities, reference, num_threads);
+}
+
+// Dense matrix of the nonzeros of a structure.
+Matrix Dense(const SparseNlp::Structure &structure, const Vector &nonzeros,
+             size_t rows, size_t cols) {
+  Matrix dense = Matrix::Zero(rows, cols);
+  for (size_t k = 0; k < structure.size(); k++) {
+    dense(structure[k].first, structure[k].second) += nonzeros(k);
+  }
+  return dense;
+}
+}  // namespace example
+
+// Values and derivatives at the reference and away from it.
+TEST(SparseNlp, Evaluate) {
+  const SparseNlp nlp = example::Nlp();
+  LONGS_EQUAL(2, nlp.numVariables());
+  LONGS_EQUAL(1, nlp.numConstraints());
+  LONGS_EQUAL(1, nlp.offsets().at(x2_key));
+
+  const Vector x = Vector2::Zero();
+  const double expected = 0.5 * (0.25 + 1.75 * 1.75 + 0.0625);
+  EXPECT_DOUBLES_EQUAL(expected, nlp.objective(x), 1e-9);
+  EXPECT(assert_equal(Vector1(-0.5), nlp.constraints(x), 1e-9));
+
+  LONGS_EQUAL(2, nlp.jacobianStructure().size());
+  EXPECT(assert_equal(Matrix((Matrix(1, 2) << 1, 1).finished()),
+                      example::Dense(nlp.jacobianStructure(),
+                                     nlp.jacobianValues(x), 1, 2),
+                      1e-9));
+
+  // Lower triangle of the Gauss-Newton Hessian, one nonzero per entry.
+  LONGS_EQUAL(3, nlp.hessianStructure().size());
+  for (auto &&entry : nlp.hessianStructure()) {
+    CHECK(entry.first >= entry.second);
+  }
+  EXPECT(assert_equal(Matrix((Matrix(2, 2) << 4, 0, -2, 4).finished()),
+                      example::Dense(nlp.hessianStructure(),
+                                     nlp.hessianValues(x, 2.0), 2, 2),
+                      1e-9));
+
+  // Gradient and Jacobian against central differences.
+  const Vector y = Vector2(0.1, -0.3);
+  const double delta = 1e-5;
+  Vector numerical_gradient(2), numerical_jacobian(2);
+  for (size_t i = 0; i < 2; i++) {
+    const Vector d = delta * Vector::Unit(2, i);
+    numerical_gradient(i) =
+        (nlp.objective(y + d) - nlp.objective(y - d)) / (2 * delta);
+    numerical_jacobian(i) =
+        (nlp.constraints(y + d)(0) - nlp.constraints(y - d)(0)) / (2 * delta);
+  }
+  EXPECT(assert_equal(numerical_gradient, nlp.gradient(y), 1e-6));
+  EXPECT(assert_equal(numerical_jacobian, nlp.jacobianValues(y), 1e-6));
+  EXPECT_DOUBLES_EQUAL(0.6, nlp.values(y).at<double>(x1_key), 1e-12);
+}
+
+// Parallel evaluation gives the serial results.
+TEST(SparseNlp, Parallel) {
+  const SparseNlp serial = example::Nlp(1), parallel = example::Nlp(4);
+  const Vector x = Vector2(0.2, 0.4);
+  EXPECT_DOUBLES_EQUAL(serial.objective(x), parallel.objective(x), 1e-12);
+  EXPECT(assert_equal(serial.gradient(x), parallel.gradient(x), 1e-12));
+  EXPECT(assert_equal(serial.hessianValues(x), parallel.hessianValues(x),
+                      1e-12));
+  EXPECT(assert_equal(serial.jacobianValues(x), parallel.jacobianValues(x),
+                      1e-12));
+}
+
+// Recentering moves the reference to the given point.
+TEST(SparseNlp, Recenter) {
+  SparseNlp nlp = example::Nlp();
+  const Vector x = Vector2(0.5, 0.75);
+  const double objective = nlp.objective(x);
+  nlp.recenter(x);
+  EXPECT_DOUBLES_EQUAL(objective, nlp.objective(Vector2::Zero()), 1e-12);
+  EXPECT(assert_equal(Vector1(1.0), nlp.constraints(Vector2::Zero()), 1e-9));
+  CHECK_EXCEPTION(nlp.objective(Vector1(0)), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
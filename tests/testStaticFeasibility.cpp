@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStaticFeasibility.cpp
+ * @brief Test the static-feasibility check of contact goals.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/statics/StaticFeasibility.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+const Pose3 wTb(Rot3(), Point3(0, 0, 0.45));
+
+// Angles of a crouched stance, by joint name, as in testChainInitializer.
+std::map<std::string, double> Stance() {
+  std::map<std::string, double> angles;
+  for (auto &&joint : robot.joints()) {
+    const std::string &child = joint->child()->name();
+    if (child.find("hip") == 0) angles[joint->name()] = 0.1;
+    if (child.find("upper") == 0) angles[joint->name()] = 0.7;
+    if (child.find("lower") == 0) angles[joint->name()] = -1.4;
+  }
+  return angles;
+}
+
+// Goals at the feet of the stance, one per leg.
+ContactGoals StanceGoals() {
+  Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), Stance().at(joint->name()));
+  }
+  InsertPose(&known, robot.link("body")->id(), wTb);
+  const Values fk = robot.forwardKinematics(known, 0, std::string("body"));
+  ContactGoals goals;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    const PointOnLink foot(robot.link(name), Point3(0.14, 0, 0));
+    goals.emplace_back(foot, foot.predict(fk, 0));
+  }
+  return goals;
+}
+}  // namespace example
+
+// A stance on four feet is feasible, and failures give their reason.
+TEST(StaticFeasibility, Reasons) {
+  using namespace example;
+  StaticFeasibilityParameters parameters;
+  parameters.nominal = Stance();
+  const ContactGoals goals = StanceGoals();
+
+  const StaticFeasibility stance =
+      CheckStaticFeasibility(robot, wTb, goals, parameters);
+  EXPECT(stance.feasible());
+  EXPECT_LONGS_EQUAL(12, stance.joint_angles.size());
+  for (auto &&joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(Stance().at(joint->name()),
+                         JointAngle(stance.joint_angles, joint->id()), 1e-6);
+  }
+
+  // A foot a meter below the ground of the others is out of reach.
+  ContactGoals far = goals;
+  far[2].goal_point.z() -= 1.0;
+  const StaticFeasibility unreachable =
+      CheckStaticFeasibility(robot, wTb, far, parameters);
+  EXPECT(unreachable.reason == FeasibilityReason::Unreachable);
+  EXPECT_LONGS_EQUAL(2, unreachable.goal);
+  EXPECT(unreachable.violation > 0.5);
+
+  // One foot, away from below the center of mass, cannot hold the robot.
+  const StaticFeasibility one_foot =
+      CheckStaticFeasibility(robot, wTb, {goals[0]}, parameters);
+  EXPECT(one_foot.reason == FeasibilityReason::Unbalanced);
+  EXPECT(one_foot.violation > parameters.balance_tolerance);
+
+  // Neither can no feet at all.
+  const StaticFeasibility no_feet =
+      CheckStaticFeasibility(robot, wTb, {}, parameters);
+  EXPECT(no_feet.reason == FeasibilityReason::Unbalanced);
+  EXPECT_DOUBLES_EQUAL(1.0, no_feet.violation, 1e-9);
+}
+
+// Many stances are checked in parallel, as one by one.
+TEST(StaticFeasibility, Batch) {
+  using namespace example;
+  StaticFeasibilityParameters parameters;
+  parameters.nominal = Stance();
+  const ContactGoals goals = StanceGoals();
+  ContactGoals far = goals;
+  far[1].goal_point.x() += 1.0;
+
+  const std::vector<Pose3> base_poses(3, wTb);
+  const std::vector<ContactGoals> stances = {goals, far, {goals[3]}};
+  const std::vector<StaticFeasibility> results =
+      CheckStaticFeasibility(robot, base_poses, stances, parameters, 2);
+  EXPECT_LONGS_EQUAL(3, results.size());
+  for (size_t k = 0; k < 3; k++) {
+    const StaticFeasibility expected =
+        CheckStaticFeasibility(robot, base_poses[k], stances[k], parameters);
+    EXPECT(expected.reason == results[k].reason);
+    EXPECT_LONGS_EQUAL(expected.goal, results[k].goal);
+    EXPECT_DOUBLES_EQUAL(expected.violation, results[k].violation, 1e-12);
+  }
+  EXPECT(results[0].feasible());
+  EXPECT(results[1].reason == FeasibilityReason::Unreachable);
+  EXPECT(results[2].reason == FeasibilityReason::Unbalanced);
+
+  CHECK_EXCEPTION(
+      CheckStaticFeasibility(robot, base_poses, {goals}, parameters),
+      std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
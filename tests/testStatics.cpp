@@ -12,6 +12,7 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/NewtonEulerInverseDynamics.h>
 #include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtsam/base/numericalDerivative.h>
@@ -67,6 +68,55 @@ TEST(Statics, ResultantWrench) {
   EXPECT(assert_equal(expected, actualH[1], kTol));
 }
 
+// Gravity compensation of an arm agrees with inverse dynamics at rest.
+TEST(Statics, GravityCompensationTorques) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+          .fixLink("link0");
+  const size_t n = robot.numJoints();
+  Vector q(n);
+  Values values;
+  for (size_t j = 0; j < n; j++) {
+    q(j) = 0.3 * j - 0.8;
+    InsertJointAngle(&values, robot.joints()[j]->id(), q(j));
+  }
+  const Values fk = robot.forwardKinematics(values);
+
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  for (auto&& link : robot.links()) {
+    poses.push_back(Pose(fk, link->id()));
+    twists.push_back(Vector6::Zero());
+  }
+  NewtonEulerInverseDynamics rnea(robot, example::gravity);
+  rnea.solve(poses, twists, Vector::Zero(n), Vector::Zero(n));
+
+  Matrix actualH;
+  const Vector actual =
+      GravityCompensationTorques(robot, q, example::gravity, actualH);
+  EXPECT(assert_equal(rnea.torques(), actual, 1e-9));
+
+  // The Jacobian is the symmetric Hessian of the potential energy.
+  Matrix numericalH(n, n);
+  constexpr double delta = 1e-5;
+  for (size_t j = 0; j < n; j++) {
+    Vector dq = Vector::Zero(n);
+    dq(j) = delta;
+    numericalH.col(j) =
+        (GravityCompensationTorques(robot, q + dq, example::gravity) -
+         GravityCompensationTorques(robot, q - dq, example::gravity)) /
+        (2 * delta);
+  }
+  EXPECT(assert_equal(numericalH, actualH, 1e-6));
+  EXPECT(assert_equal(Matrix(actualH.transpose()), actualH, 1e-9));
+
+  // Without a fixed link there is nothing to compensate against.
+  const Robot floating =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  CHECK_EXCEPTION(GravityCompensationTorques(floating, q),
+                  std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
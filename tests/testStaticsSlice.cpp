@@ -14,6 +14,7 @@
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/sdf.h>
 
 #include "contactGoalsExample.h"
 
@@ -133,6 +134,39 @@ TEST(Statics, Quadruped) {
   EXPECT_LONGS_EQUAL(61, minimal.size());
 }
 
+// Batch solve of a fixed-base arm at many configurations.
+TEST(Statics, solveBatch) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"))
+          .fixLink("l1");
+  StaticsParameters parameters(kSigmaDynamics, Vector3(0, 0, -10));
+  Statics statics(parameters);
+  const size_t k = 3;
+  const Slice slice(k);
+
+  std::vector<Values> configurations;
+  for (size_t n = 0; n < 7; n++) {
+    Values values;
+    InsertJointAngle(&values, 0, k, -1.5 + 0.5 * n);
+    configurations.push_back(robot.forwardKinematics(values, k));
+  }
+
+  const auto results = statics.solveBatch(slice, robot, configurations, 3);
+  EXPECT_LONGS_EQUAL(7, results.size());
+  for (size_t n = 0; n < 7; n++) {
+    const Values expected = statics.solve(slice, robot, configurations[n]);
+    EXPECT_DOUBLES_EQUAL(Torque(expected, 0, k), Torque(results[n], 0, k),
+                         1e-5);
+    EXPECT(assert_equal(Wrench(expected, 1, 0, k), Wrench(results[n], 1, 0, k),
+                        1e-5));
+  }
+
+  // The same on one thread.
+  const auto serial = statics.solveBatch(slice, robot, configurations, 1);
+  EXPECT_DOUBLES_EQUAL(Torque(serial[4], 0, k), Torque(results[4], 0, k),
+                       1e-12);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,165 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSubtreeInertiaCache.cpp
+ * @brief Test incrementally updated composite inertias.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CompositeRigidBodyDynamics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/SubtreeInertiaCache.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Matrix6;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+
+Vector JointAngles(double angle) {
+  Vector q(robot.numJoints());
+  for (size_t j = 0; j < robot.numJoints(); j++) {
+    q(j) = angle;
+    angle = -0.8 * angle + 0.1;
+  }
+  return q;
+}
+
+// Composite inertia of every link, summed over the links below it with
+// poses from forward kinematics.
+std::vector<Matrix6> CompositeInertias(const Vector &q) {
+  Values values;
+  for (size_t j = 0; j < robot.numJoints(); j++) {
+    InsertJointAngle(&values, robot.joints()[j]->id(), q(j));
+    InsertJointVel(&values, robot.joints()[j]->id(), 0.0);
+  }
+  const Values fk = robot.forwardKinematics(values);
+  const RobotTopology &topo = robot.topology();
+  std::vector<Matrix6> composites(robot.numLinks(), gtsam::Z_6x6);
+  for (size_t l = 0; l < robot.numLinks(); l++) {
+    const Pose3 wTl = Pose(fk, topo.links[l]->id());
+    for (int i = l; i >= 0; i = topo.tree_parent[i]) {
+      const Pose3 wTi = Pose(fk, topo.links[i]->id());
+      const Matrix6 X = wTl.between(wTi).AdjointMap();
+      composites[i] += X.transpose() * topo.inertias[l] * X;
+    }
+  }
+  return composites;
+}
+}  // namespace example
+
+// Composite inertias agree with forward kinematics, and the root holds the
+// mass and center of mass of the robot.
+TEST(SubtreeInertiaCache, vision60) {
+  using namespace example;
+  SubtreeInertiaCache cache(robot);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numLinks());
+
+  const RobotTopology &topo = robot.topology();
+  const int root = topo.root;
+  double mass = 0;
+  Point3 moment(0, 0, 0);
+  for (auto &&link : robot.links()) {
+    mass += link->mass();
+    moment += link->mass() * link->bMcom().translation();
+  }
+  EXPECT_DOUBLES_EQUAL(mass, cache.subtreeMass(root), 1e-9);
+  EXPECT(assert_equal(topo.links[root]->bMcom().transformTo(moment / mass),
+                      cache.subtreeCom(root), 1e-9));
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numRecomputed());
+
+  for (double angle : {0.0, 0.3}) {
+    const Vector q = JointAngles(angle);
+    cache.setJointAngles(q);
+    const std::vector<Matrix6> expected = CompositeInertias(q);
+    for (size_t i = 0; i < robot.numLinks(); i++) {
+      EXPECT(assert_equal(Matrix(expected[i]),
+                          Matrix(cache.compositeInertia(i)), 1e-9));
+    }
+  }
+}
+
+// Only the links above a changed joint are recomputed.
+TEST(SubtreeInertiaCache, incremental) {
+  using namespace example;
+  SubtreeInertiaCache cache(robot);
+  cache.setJointAngles(JointAngles(0.3));
+  EXPECT_LONGS_EQUAL(robot.numLinks(), cache.numRecomputed());
+  cache.setJointAngles(JointAngles(0.3));
+  EXPECT_LONGS_EQUAL(0, cache.numRecomputed());
+
+  // The knee moves the lower leg relative to the upper leg and body.
+  const RobotTopology &topo = robot.topology();
+  const int knee =
+      topo.joint_index[robot.link("lower0")->joints().front()->id()];
+  cache.setJointAngle(knee, -0.5);
+  EXPECT_LONGS_EQUAL(2, cache.numRecomputed());
+
+  Vector q = JointAngles(0.3);
+  q(knee) = -0.5;
+  const std::vector<Matrix6> expected = CompositeInertias(q);
+  for (size_t i = 0; i < robot.numLinks(); i++) {
+    EXPECT(assert_equal(Matrix(expected[i]),
+                        Matrix(cache.compositeInertia(i)), 1e-9));
+  }
+  CHECK_EXCEPTION(cache.setJointAngle(robot.numJoints(), 0.0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(cache.setJointAngles(Vector::Zero(2)),
+                  std::invalid_argument);
+}
+
+// The mass matrix from cached composite inertias equals the one from poses.
+TEST(SubtreeInertiaCache, massMatrix) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+          .fixLink("link0");
+  Values values;
+  Vector q(robot.numJoints());
+  for (size_t j = 0; j < robot.numJoints(); j++) {
+    q(j) = 0.2 * j - 0.4;
+    InsertJointAngle(&values, robot.joints()[j]->id(), q(j));
+    InsertJointVel(&values, robot.joints()[j]->id(), 0.0);
+  }
+  CompositeRigidBodyDynamics crba(robot);
+  crba.solve(0, robot.forwardKinematics(values));
+  const Matrix expected = crba.massMatrix();
+
+  CompositeRigidBodyDynamics cached(robot);
+  EXPECT(assert_equal(expected, cached.solveMassMatrix(q), 1e-9));
+
+  // Moving a joint only updates the links above it.
+  const RobotTopology &topo = robot.topology();
+  const int j = robot.numJoints() - 1;
+  const int child = topo.tree_joint[topo.joint_child[j]] == j
+                        ? topo.joint_child[j]
+                        : topo.joint_parent[j];
+  q(j) += 0.5;
+  cached.solveMassMatrix(q);
+  EXPECT_LONGS_EQUAL(topo.tree_depth[child],
+                     cached.subtreeInertias().numRecomputed());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTerrainHeightFactor.cpp
+ * @brief Test tiled height maps and terrain contact factors.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/TerrainHeightFactor.h>
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point2;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+const Point2 origin(-1, 0.5);
+const double cell_size = 0.25;
+const std::string map_path = "testTerrainHeightFactor.gtdhmap";
+
+double Plane(double x, double y) { return 0.3 + 0.2 * x - 0.5 * y; }
+double Wavy(double x, double y) { return 0.1 * std::sin(3 * x) * y; }
+
+// Grid of 7 rows and 9 columns sampling f, in tiles of 4 x 4 cells.
+HeightMap Map(double (*f)(double, double), size_t tile_size = 4) {
+  gtsam::Matrix heights(7, 9);
+  for (size_t row = 0; row < 7; row++) {
+    for (size_t col = 0; col < 9; col++) {
+      heights(row, col) = f(origin.x() + cell_size * col,
+                            origin.y() + cell_size * row);
+    }
+  }
+  return HeightMap(origin, cell_size, heights, tile_size);
+}
+}  // namespace example
+
+// Cells are found in their tiles, and empty tiles are not stored.
+TEST(HeightMap, tiles) {
+  using namespace example;
+  const HeightMap map = Map(Wavy);
+  LONGS_EQUAL(2, map.tileRows());
+  LONGS_EQUAL(3, map.tileCols());
+  LONGS_EQUAL(6, map.numStoredTiles());
+  for (size_t row = 0; row < 7; row++) {
+    for (size_t col = 0; col < 9; col++) {
+      EXPECT_DOUBLES_EQUAL(Wavy(origin.x() + cell_size * col,
+                                origin.y() + cell_size * row),
+                           map.cell(row, col), 1e-6);
+    }
+  }
+
+  gtsam::Matrix heights = gtsam::Matrix::Zero(7, 9);
+  heights.topLeftCorner(4, 4).setConstant(
+      std::numeric_limits<double>::quiet_NaN());
+  const HeightMap sparse(origin, cell_size, heights, 4, -1.0);
+  LONGS_EQUAL(5, sparse.numStoredTiles());
+  EXPECT_DOUBLES_EQUAL(-1.0, sparse.cell(1, 2), 0);
+  EXPECT_DOUBLES_EQUAL(0.0, sparse.cell(1, 4), 0);
+
+  CHECK_EXCEPTION(HeightMap(origin, 0.0, heights), std::invalid_argument);
+}
+
+// Both interpolations reproduce planes, and extend the border outside.
+TEST(HeightMap, height) {
+  using namespace example;
+  const HeightMap map = Map(Plane);
+  for (auto interpolation : {HeightMap::Bilinear, HeightMap::Bicubic}) {
+    gtsam::Matrix12 H;
+    const Point2 xy(0.13, 1.27);
+    EXPECT_DOUBLES_EQUAL(Plane(xy.x(), xy.y()),
+                         map.height(xy, H, interpolation), 1e-6);
+    EXPECT(assert_equal(gtsam::Matrix12(0.2, -0.5), H, 1e-6));
+
+    // Beyond the last column, x is clamped.
+    const double h = map.height(Point2(5.0, 1.27), H, interpolation);
+    EXPECT_DOUBLES_EQUAL(Plane(1.0, 1.27), h, 1e-6);
+    EXPECT_DOUBLES_EQUAL(0, H(0), 1e-9);
+    EXPECT_DOUBLES_EQUAL(-0.5, H(1), 1e-6);
+  }
+}
+
+// Analytic gradients of the height and of the normal.
+TEST(HeightMap, derivatives) {
+  using namespace example;
+  const HeightMap map = Map(Wavy);
+  const Point2 xy(0.07, 1.13);
+  for (auto interpolation : {HeightMap::Bilinear, HeightMap::Bicubic}) {
+    std::function<double(const Point2 &)> h = [&](const Point2 &p) {
+      return map.height(p, boost::none, interpolation);
+    };
+    gtsam::Matrix12 H_height;
+    map.height(xy, H_height, interpolation);
+    EXPECT(assert_equal(gtsam::numericalDerivative11<double, Point2>(h, xy),
+                        H_height, 1e-6));
+
+    std::function<gtsam::Vector3(const Point2 &)> n = [&](const Point2 &p) {
+      return map.normal(p, boost::none, interpolation);
+    };
+    gtsam::Matrix32 H_normal;
+    const gtsam::Vector3 normal = map.normal(xy, H_normal, interpolation);
+    EXPECT_DOUBLES_EQUAL(1.0, normal.norm(), 1e-9);
+    EXPECT_DOUBLES_EQUAL(0.0, normal.x() + normal.z() * H_height(0), 1e-9);
+    EXPECT(assert_equal(
+        gtsam::numericalDerivative11<gtsam::Vector3, Point2>(n, xy), H_normal,
+        1e-5));
+  }
+}
+
+// Binary files map back to the same heights, and other files are rejected.
+TEST(HeightMap, save) {
+  using namespace example;
+  const HeightMap map = Map(Wavy, 3);
+  map.save(map_path);
+  const HeightMap loaded = HeightMap::Load(map_path);
+  EXPECT(assert_equal(origin, loaded.origin()));
+  EXPECT_DOUBLES_EQUAL(cell_size, loaded.cellSize(), 0);
+  LONGS_EQUAL(7, loaded.rows());
+  LONGS_EQUAL(9, loaded.cols());
+  LONGS_EQUAL(3, loaded.tileSize());
+  const Point2 xy(0.4, 1.6);
+  EXPECT_DOUBLES_EQUAL(map.height(xy, boost::none, HeightMap::Bicubic),
+                       loaded.height(xy, boost::none, HeightMap::Bicubic), 0);
+  std::remove(map_path.c_str());
+
+  {
+    std::ofstream os(map_path);
+    os << "not a height map";
+  }
+  CHECK_EXCEPTION(HeightMap::Load(map_path), std::runtime_error);
+  std::remove(map_path.c_str());
+  CHECK_EXCEPTION(HeightMap::Load(map_path), std::runtime_error);
+}
+
+// The error is the height above the terrain, with correct Jacobians.
+TEST(TerrainHeightFactor, error) {
+  using namespace example;
+  auto map = std::make_shared<const HeightMap>(Map(Wavy));
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  const Point3 comPc(0, 0, -0.1);
+  const Pose3 pose(Rot3::RzRyRx(0.1, 0.2, -0.3), Point3(0.1, 1.2, 0.4));
+  const Point3 sPc = pose.transformFrom(comPc);
+
+  for (auto interpolation : {HeightMap::Bilinear, HeightMap::Bicubic}) {
+    const TerrainHeightFactor factor(0, model, map, comPc, interpolation, 0.05);
+    const double h = map->height(sPc.head<2>(), boost::none, interpolation);
+    EXPECT(assert_equal(gtsam::Vector1(sPc.z() - h - 0.05),
+                        factor.evaluateError(pose), 1e-9));
+    gtsam::Values values;
+    values.insert(0, pose);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
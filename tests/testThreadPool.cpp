@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testThreadPool.cpp
+ * @brief Test running solves on a thread pool.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/ThreadPool.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+
+// Every task runs once, and the futures hold their results.
+TEST(ThreadPool, submit) {
+  std::atomic<int> count(0);
+  std::vector<std::future<int>> futures;
+  {
+    ThreadPool pool(3);
+    EXPECT_LONGS_EQUAL(3, pool.numThreads());
+    for (int i = 0; i < 20; i++) {
+      futures.push_back(pool.submit([i, &count]() {
+        count++;
+        return i * i;
+      }));
+    }
+  }
+  // The destructor ran the queued tasks.
+  EXPECT_LONGS_EQUAL(20, count);
+  for (int i = 0; i < 20; i++) EXPECT_LONGS_EQUAL(i * i, futures[i].get());
+}
+
+// Exceptions are rethrown by the future.
+TEST(ThreadPool, exception) {
+  ThreadPool pool(1);
+  auto future = pool.submit([]() -> int { throw std::runtime_error("x"); });
+  CHECK_EXCEPTION(future.get(), std::runtime_error);
+  EXPECT_LONGS_EQUAL(2, pool.submit([]() { return 2; }).get());
+}
+
+// Graphs built on the pool are the same as serial ones.
+TEST(ThreadPool, trajectoryFG) {
+  const Robot robot = simple_urdf::getRobot();
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  const auto expected = graph_builder.trajectoryFG(robot, 3, 0.1);
+
+  ThreadPool pool(2);
+  std::vector<std::future<gtsam::NonlinearFactorGraph>> graphs;
+  for (int i = 0; i < 4; i++) {
+    graphs.push_back(pool.submit([&]() {
+      return graph_builder.trajectoryFG(robot, 3, 0.1);
+    }));
+  }
+  for (auto &&graph : graphs)
+    EXPECT_LONGS_EQUAL(expected.size(), graph.get().size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeOrdering.cpp
+ * @brief Test time-based elimination orderings.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>  // PhaseKey
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/TimeOrdering.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Key;
+using gtsam::KeyVector;
+
+namespace example {
+// Joint angles and torques of two joints at 7 time steps, plus one phase.
+KeyVector Keys() {
+  KeyVector keys;
+  keys.push_back(PhaseKey(0));
+  for (int t = 6; t >= 0; t--) {
+    for (int j = 1; j >= 0; j--) {
+      keys.push_back(TorqueKey(j, t));
+      keys.push_back(JointAngleKey(j, t));
+    }
+  }
+  return keys;
+}
+}  // namespace example
+
+TEST(TimeOrdering, TimeMajor) {
+  auto keys = example::Keys();
+  auto ordering = TimeOrdering(keys);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+  for (size_t i = 1; i + 1 < ordering.size(); i++) {
+    EXPECT(DynamicsSymbol(ordering[i - 1]).time() <=
+           DynamicsSymbol(ordering[i]).time());
+  }
+  // Variables of a step are grouped by joint, and phases come last.
+  EXPECT(DynamicsSymbol(ordering[0]).jointIdx() == 0);
+  EXPECT(DynamicsSymbol(ordering[1]).jointIdx() == 0);
+  EXPECT(DynamicsSymbol(ordering[2]).jointIdx() == 1);
+  EXPECT(ordering.back() == Key(PhaseKey(0)));
+}
+
+TEST(TimeOrdering, NestedDissection) {
+  auto keys = example::Keys();
+  auto ordering = TimeOrdering(keys, TimeOrderingType::NestedDissection);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+
+  // Steps in order 0 2 1 4 6 5 3, 4 variables each, then the phase.
+  const std::vector<uint64_t> expected{0, 2, 1, 4, 6, 5, 3};
+  for (size_t i = 0; i < expected.size(); i++) {
+    for (size_t k = 0; k < 4; k++) {
+      EXPECT_LONGS_EQUAL(expected[i],
+                         DynamicsSymbol(ordering[4 * i + k]).time());
+    }
+  }
+  EXPECT(ordering.back() == Key(PhaseKey(0)));
+}
+
+TEST(TimeOrdering, LinkSchur) {
+  auto keys = example::Keys();
+  for (int t = 0; t < 7; t++) {
+    keys.push_back(WrenchKey(1, 0, t));
+    keys.push_back(PoseKey(0, t));
+  }
+  auto ordering = TimeOrdering(keys, TimeOrderingType::LinkSchur);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+
+  // Link variables of all steps, then joint variables of all steps, each
+  // time-major, then the phase.
+  const size_t num_link_keys = 14;
+  for (size_t i = 0; i + 1 < ordering.size(); i++) {
+    const DynamicsSymbol symbol(ordering[i]);
+    EXPECT((symbol.linkIdx() != DynamicsSymbol::kNoIndex) ==
+           (i < num_link_keys));
+    if (i > 0 && i != num_link_keys) {
+      EXPECT(DynamicsSymbol(ordering[i - 1]).time() <= symbol.time());
+    }
+  }
+  EXPECT(ordering[0] == Key(PoseKey(0, 0)));
+  EXPECT(ordering.back() == Key(PhaseKey(0)));
+}
+
+// Link variables of a dynamics trajectory are eliminated per step, onto
+// variables of the same step only.
+TEST(TimeOrdering, LinkSchurTrajectory) {
+  const Robot fixed_robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  const int j = fixed_robot.joints()[0]->id();
+  const int num_steps = 4;
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.trajectoryFG(fixed_robot, num_steps, 0.1);
+  gtsam::Values known_values;
+  InsertJointAngle(&known_values, j, 0, 0.0);
+  InsertJointVel(&known_values, j, 0, 0.0);
+  for (int t = 0; t <= num_steps; t++) InsertTorque(&known_values, j, t, 1.0);
+  graph.add(graph_builder.trajectoryFDPriors(fixed_robot, num_steps,
+                                             known_values));
+  Initializer initializer;
+  auto init = initializer.ZeroValuesTrajectory(fixed_robot, num_steps);
+
+  auto ordering = TimeOrdering(init.keys(), TimeOrderingType::LinkSchur);
+  auto bayes_tree = graph.linearize(init)->eliminateMultifrontal(ordering);
+  for (auto &&node : bayes_tree->nodes()) {
+    const auto conditional = node.second->conditional();
+    const DynamicsSymbol frontal(conditional->front());
+    if (frontal.linkIdx() == DynamicsSymbol::kNoIndex) continue;
+    for (Key key : conditional->keys()) {
+      EXPECT_LONGS_EQUAL(frontal.time(), DynamicsSymbol(key).time());
+    }
+  }
+
+  OptimizationParameters params;
+  auto expected = Optimizer(params).optimize(graph, init);
+  params.time_ordering = TimeOrderingType::LinkSchur;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init), 1e-6));
+}
+
+// Using the time ordering in Optimizer gives the same solution.
+TEST(TimeOrdering, Optimizer) {
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values init;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, noise);
+  init.insert(JointAngleKey(0, 0), 0.5);
+  for (int t = 1; t < 20; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.1, noise);
+    init.insert(JointAngleKey(0, t), 0.0);
+  }
+
+  OptimizationParameters params;
+  auto expected = Optimizer(params).optimize(graph, init);
+  params.time_ordering = TimeOrderingType::TimeMajor;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init), 1e-6));
+  params.time_ordering = TimeOrderingType::NestedDissection;
+  EXPECT(assert_equal(expected, Optimizer(params).optimize(graph, init), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
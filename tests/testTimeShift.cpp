@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeShift.cpp
+ * @brief Test shifting trajectories and factor graphs in time.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/utils/GraphTemplate.h>
+#include <gtdynamics/utils/TimeShift.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+const size_t kNumSteps = 4;
+const double kAngles[kNumSteps] = {0, 1, 2, 4};
+
+// Poses moving with a constant twist.
+Pose3 WTb(int t) { return Pose3(Rot3::Rz(0.1 * t), Point3(t, 0, 0)); }
+
+gtsam::Values Trajectory() {
+  gtsam::Values values;
+  for (size_t t = 0; t < kNumSteps; t++) {
+    InsertJointAngle(&values, 0, t, kAngles[t]);
+    InsertPose(&values, 0, t, WTb(t));
+  }
+  values.insert(PhaseKey(0), 0.05);
+  return values;
+}
+}  // namespace example
+
+TEST(TimeShift, Hold) {
+  using namespace example;
+  const auto values = Trajectory();
+  const auto shifted = ShiftValues(values, 2);
+  EXPECT_LONGS_EQUAL(values.size(), shifted.size());
+  EXPECT_DOUBLES_EQUAL(2, JointAngle(shifted, 0, 0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(4, JointAngle(shifted, 0, 1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(4, JointAngle(shifted, 0, 2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(4, JointAngle(shifted, 0, 3), 1e-12);
+  EXPECT(assert_equal(WTb(2), Pose(shifted, 0, 0)));
+  EXPECT(assert_equal(WTb(3), Pose(shifted, 0, 3)));
+
+  // A series with a single step holds its value.
+  EXPECT_DOUBLES_EQUAL(0.05, shifted.at<double>(PhaseKey(0)), 1e-12);
+
+  // Shifting past the end holds the last step everywhere.
+  const auto far = ShiftValues(values, 10);
+  EXPECT_DOUBLES_EQUAL(4, JointAngle(far, 0, 0), 1e-12);
+  EXPECT(assert_equal(values, ShiftValues(values, 0)));
+}
+
+TEST(TimeShift, Linear) {
+  using namespace example;
+  const auto values = Trajectory();
+  const auto shifted = ShiftValues(values, 2, TailExtrapolation::Linear);
+  EXPECT_DOUBLES_EQUAL(4, JointAngle(shifted, 0, 1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(6, JointAngle(shifted, 0, 2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(8, JointAngle(shifted, 0, 3), 1e-12);
+
+  // A constant twist is continued exactly.
+  const auto next = ShiftValues(values, 1, TailExtrapolation::Linear);
+  EXPECT(assert_equal(WTb(4), Pose(next, 0, 3), 1e-9));
+}
+
+TEST(TimeShift, None) {
+  using namespace example;
+  const auto values = Trajectory();
+  const auto shifted =
+      ShiftValues(values, 1, TailExtrapolation::None, {PhaseKey(0)});
+  EXPECT_LONGS_EQUAL(2 * (kNumSteps - 1) + 1, shifted.size());
+  EXPECT(!shifted.exists(JointAngleKey(0, 3)));
+  EXPECT_DOUBLES_EQUAL(1, JointAngle(shifted, 0, 0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.05, shifted.at<double>(PhaseKey(0)), 1e-12);
+}
+
+TEST(TimeShift, Graph) {
+  using namespace example;
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t t = 0; t < kNumSteps; t++) {
+    graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, t),
+                                                      kAngles[t], model);
+  }
+  graph.emplace_shared<gtsam::PriorFactor<double>>(PhaseKey(0), 0.05, model);
+
+  // The prior at t = 0 is dropped, the others move one step back.
+  const auto shifted = ShiftGraph(graph, 1, {PhaseKey(0)});
+  EXPECT_LONGS_EQUAL(kNumSteps, shifted.size());
+  EXPECT(shifted[0]->keys() == gtsam::KeyVector{JointAngleKey(0, 0)});
+  EXPECT(shifted.back() == graph.back());
+  const auto values = Trajectory();
+  EXPECT_DOUBLES_EQUAL(
+      0, shifted.error(ShiftValues(values, 1, TailExtrapolation::Linear)),
+      1e-9);
+
+  // Priors are rekeyed clones, not wrapped.
+  const auto twice = ShiftGraph(shifted, 1, {PhaseKey(0)});
+  EXPECT_LONGS_EQUAL(kNumSteps - 1, twice.size());
+  EXPECT(!boost::dynamic_pointer_cast<RekeyedFactor>(twice[0]));
+  auto prior =
+      boost::dynamic_pointer_cast<gtsam::PriorFactor<double>>(twice[0]);
+  CHECK(prior);
+  EXPECT_DOUBLES_EQUAL(kAngles[2], prior->prior(), 1e-12);
+  EXPECT(twice[0]->keys() == gtsam::KeyVector{JointAngleKey(0, 0)});
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -65,6 +65,27 @@ TEST(TorqueFactor, error) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-7);
 }
 
+// The analytic factor agrees with the expression factor away from the
+// solution.
+TEST(TorqueFactor, analytic) {
+  Pose3 kMj = Pose3(Rot3(), Point3(0, 0, -2));
+  gtsam::Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(kMj, screw_axis);
+  auto cost_model = gtsam::noiseModel::Gaussian::Covariance(gtsam::I_1x1);
+  auto expected = TorqueFactor(cost_model, joint, 777);
+  auto factor = TorqueFactor(cost_model, joint, 777, true);
+  EXPECT(boost::dynamic_pointer_cast<AnalyticTorqueFactor>(factor));
+
+  gtsam::Values values;
+  values.insert(WrenchKey(2, 1, 777),
+                (Vector6() << 1, -2, 3, 0.5, 1, -1).finished());
+  values.insert(TorqueKey(1, 777), 4.0);
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-7);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
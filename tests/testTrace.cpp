@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrace.cpp
+ * @brief Test recording and exporting trace events.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/Trace.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+
+// Scopes are only recorded while recording, and buffers keep the latest.
+TEST(Tracer, record) {
+  { TraceScope scope("before"); }
+  Tracer::Start(4);
+  EXPECT(Tracer::Recording());
+  EXPECT_LONGS_EQUAL(0, Tracer::NumEvents());
+  for (int i = 0; i < 6; i++) TraceScope scope("step", i);
+  EXPECT_LONGS_EQUAL(4, Tracer::NumEvents());
+  Tracer::Stop();
+  { TraceScope scope("after"); }
+  EXPECT_LONGS_EQUAL(4, Tracer::NumEvents());
+
+  std::ostringstream os;
+  Tracer::WriteChromeTrace(os);
+  const std::string json = os.str();
+  EXPECT(json.find("\"traceEvents\"") != std::string::npos);
+  EXPECT(json.find("\"args\":{\"i\":5}") != std::string::npos);
+  EXPECT(json.find("\"args\":{\"i\":1}") == std::string::npos);
+  EXPECT(json.find("before") == std::string::npos);
+  EXPECT(json.find("after") == std::string::npos);
+
+  Tracer::Clear();
+  EXPECT_LONGS_EQUAL(0, Tracer::NumEvents());
+  CHECK_EXCEPTION(Tracer::Start(0), std::invalid_argument);
+}
+
+// Every thread records into its own buffer, also while exporting.
+TEST(Tracer, threads) {
+  Tracer::Start(1000);
+  std::vector<std::thread> threads;
+  for (int k = 0; k < 4; k++) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 100; i++) TraceScope scope("work \"quoted\"", i);
+    });
+  }
+  std::ostringstream during;
+  Tracer::WriteChromeTrace(during);
+  for (auto &&thread : threads) thread.join();
+  Tracer::Stop();
+  EXPECT_LONGS_EQUAL(400, Tracer::NumEvents());
+
+  std::ostringstream os;
+  Tracer::WriteChromeTrace(os);
+  EXPECT(os.str().find("work \\\"quoted\\\"") != std::string::npos);
+  Tracer::Clear();
+}
+
+// The markers of the library record only when compiled in.
+TEST(Tracer, markers) {
+  Tracer::Start();
+  { GTDYNAMICS_TRACE_SCOPE_ARG("marker", 3); }
+  Tracer::Stop();
+  EXPECT_LONGS_EQUAL(Tracer::Enabled() ? 1 : 0, Tracer::NumEvents());
+  Tracer::Clear();
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -63,6 +63,17 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(7, final_timesteps[2]);
   EXPECT_LONGS_EQUAL(6, trajectory.getStartTimeStep(2));
   EXPECT_LONGS_EQUAL(7, trajectory.getEndTimeStep(2));
+  EXPECT_LONGS_EQUAL(0, trajectory.getStartTimeStep(0));
+  EXPECT_LONGS_EQUAL(3, trajectory.getStartTimeStep(1));
+
+  // Phase lookup, every step in between start and end of its phase.
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    for (int k = trajectory.getStartTimeStep(p);
+         k <= trajectory.getEndTimeStep(p); k++) {
+      EXPECT_LONGS_EQUAL(p, trajectory.phaseIndex(k));
+    }
+  }
+  CHECK_EXCEPTION(trajectory.phaseIndex(16), std::out_of_range);
 
   auto cp_goals = walk_cycle.initContactPointGoal(robot, 0);
   EXPECT_LONGS_EQUAL(5, cp_goals.size());
@@ -121,6 +132,29 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(260, boundary_conditions.size());
 }
 
+// Reusing the first walk cycle's graphs gives the same factors.
+TEST(Trajectory, reuseCycles) {
+  using namespace walk_cycle_example;
+  Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  auto trajectory = Trajectory(walk_cycle, 3);
+  auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), gtsam::Vector3(0, 0, -9.8));
+
+  auto expected = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, 1.0);
+  auto actual = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, 1.0, true);
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+  EXPECT(expected.keys() == actual.keys());
+
+  Initializer initializer;
+  Values values =
+      trajectory.multiPhaseInitialValues(robot, initializer, 1e-2, 1. / 240);
+  const double error = expected.error(values);
+  EXPECT_DOUBLES_EQUAL(error, actual.error(values), 1e-9 * error);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
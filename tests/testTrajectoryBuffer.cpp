@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryBuffer.cpp
+ * @brief Test conversion between TrajectoryBuffer and Values.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/TrajectoryBuffer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace example {
+// Joint angles, velocities and link poses of simple_rr over three steps.
+Values values(const Robot &robot) {
+  Values values;
+  for (int t = 0; t < 3; t++) {
+    for (auto &&joint : robot.joints()) {
+      InsertJointAngle(&values, joint->id(), t, 0.1 * t + joint->id());
+      InsertJointVel(&values, joint->id(), t, -0.2 * t);
+    }
+    for (auto &&link : robot.links()) {
+      InsertPose(&values, link->id(), t,
+                 Pose3(gtsam::Rot3::Rz(0.3 * t), gtsam::Point3(t, 0, 1)));
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+// Values survive a round trip, and only the quantities present are written.
+TEST(TrajectoryBuffer, RoundTrip) {
+  const auto robot = simple_rr::getRobot();
+  const Values values = example::values(robot);
+  // Keys of other quantities are ignored.
+  Values with_wrench = values;
+  InsertWrench(&with_wrench, 0, 0, 0, gtsam::Vector6::Ones());
+
+  const auto buffer = TrajectoryBuffer::FromValues(robot, with_wrench);
+  EXPECT_LONGS_EQUAL(3, buffer.numSteps());
+  EXPECT_LONGS_EQUAL(TrajectoryBuffer::kJointAngles |
+                         TrajectoryBuffer::kJointVels |
+                         TrajectoryBuffer::kPoses,
+                     buffer.quantities());
+  EXPECT(assert_equal(values, buffer.values()));
+
+  const int j = robot.joints()[1]->id();
+  EXPECT_DOUBLES_EQUAL(JointAngle(values, j, 2), buffer.jointAngle(j, 2),
+                       1e-12);
+  const int i = robot.links()[0]->id();
+  EXPECT(assert_equal(Pose(values, i, 1), buffer.pose(i, 1)));
+}
+
+// Writing through accessors, and a shorter horizon than the values.
+TEST(TrajectoryBuffer, Accessors) {
+  const auto robot = simple_rr::getRobot();
+  auto buffer = TrajectoryBuffer::FromValues(robot, example::values(robot), 2);
+  EXPECT_LONGS_EQUAL(2, buffer.numSteps());
+
+  const int j = robot.joints()[0]->id(), i = robot.links()[1]->id();
+  buffer.torque(j, 1) = 4.0;
+  buffer.twist(i, 0) = gtsam::Vector6::Constant(2.0);
+  const Values values = buffer.values(TrajectoryBuffer::kAll);
+  EXPECT_DOUBLES_EQUAL(4.0, Torque(values, j, 1), 1e-12);
+  EXPECT(assert_equal(gtsam::Vector6::Constant(2.0), Twist(values, i, 0)));
+  EXPECT_DOUBLES_EQUAL(0.0, Torque(values, j, 0), 1e-12);
+  EXPECT(!values.exists(JointAngleKey(j, 2)));
+
+  // DynamicsGraph accessors agree with their Values versions.
+  EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, values, 1),
+                      DynamicsGraph::jointAngles(robot, buffer, 1)));
+  EXPECT(assert_equal(DynamicsGraph::jointTorques(robot, values, 1),
+                      DynamicsGraph::jointTorques(robot, buffer, 1)));
+}
+
+// Resizing keeps the remaining steps of every joint and link.
+TEST(TrajectoryBuffer, Resize) {
+  const auto robot = simple_rr::getRobot();
+  const Values values = example::values(robot);
+  auto buffer = TrajectoryBuffer::FromValues(robot, values);
+  const int j = robot.joints()[1]->id(), i = robot.links()[2]->id();
+
+  buffer.resize(5);
+  EXPECT_LONGS_EQUAL(5, buffer.numSteps());
+  EXPECT_DOUBLES_EQUAL(JointAngle(values, j, 2), buffer.jointAngle(j, 2),
+                       1e-12);
+  EXPECT(assert_equal(Pose(values, i, 2), buffer.pose(i, 2)));
+  EXPECT_DOUBLES_EQUAL(0.0, buffer.jointAngle(j, 4), 1e-12);
+  EXPECT(assert_equal(Pose3(), buffer.pose(i, 4)));
+
+  buffer.resize(2);
+  EXPECT_LONGS_EQUAL(2, buffer.numSteps());
+  EXPECT(assert_equal(Pose(values, i, 1), buffer.pose(i, 1)));
+  EXPECT_DOUBLES_EQUAL(JointVel(values, j, 1), buffer.jointVel(j, 1), 1e-12);
+}
+
+// Batched predictions of points on links agree with PointOnLink::predict.
+TEST(TrajectoryBuffer, PredictPoints) {
+  const Robot robot = simple_rr::getRobot();
+  const Values values = example::values(robot);
+  const TrajectoryBuffer buffer = TrajectoryBuffer::FromValues(robot, values);
+  const PointOnLinks points{{robot.link("link_0"), gtsam::Point3(0, 0, -0.1)},
+                            {robot.link("link_2"), gtsam::Point3(0.2, 0.1, 0)}};
+
+  const PointOnLinksPrediction prediction =
+      PredictPoints(points, buffer, 1, 3, true);
+  EXPECT_LONGS_EQUAL(2, prediction.num_steps);
+  for (size_t i = 0; i < 2; i++) {
+    for (size_t k = 1; k < 3; k++) {
+      EXPECT(assert_equal(points[i].predict(values, k),
+                          prediction.position(i, k)));
+      gtsam::Matrix36 H;
+      Pose(values, points[i].link->id(), k).transformFrom(points[i].point, H);
+      EXPECT(assert_equal(H, prediction.jacobian(i, k)));
+    }
+  }
+  EXPECT(PredictPoints(points, buffer, 0, 3).jacobians.size() == 0);
+
+  // Contact goals at the predicted point of one step only.
+  const ContactGoals goals{{points[0], prediction.position(0, 2)}};
+  const auto satisfied = ContactGoalsSatisfied(goals, buffer, 0, 3);
+  EXPECT(!satisfied(0, 0) && !satisfied(0, 1) && satisfied(0, 2));
+  EXPECT(goals[0].satisfied(values, 2));
+}
+
+// Poses are exported time-major as row-major homogeneous matrices.
+TEST(TrajectoryBuffer, PoseMatrices) {
+  const auto robot = simple_rr::getRobot();
+  const Values values = example::values(robot);
+  const auto buffer = TrajectoryBuffer::FromValues(robot, values);
+  const size_t num_links = robot.numLinks();
+
+  const std::vector<double> com = buffer.poseMatrices();
+  EXPECT_LONGS_EQUAL(3 * num_links * 16, com.size());
+  const std::vector<double> frames =
+      buffer.poseMatrices(TrajectoryBuffer::kLinkFrame);
+  for (size_t t = 0; t < 3; t++) {
+    for (size_t i = 0; i < num_links; i++) {
+      const auto &link = robot.links()[i];
+      const size_t offset = (t * num_links + i) * 16;
+      typedef Eigen::Matrix<double, 4, 4, Eigen::RowMajor> RowMajor4;
+      const gtsam::Matrix4 wTcom = Eigen::Map<const RowMajor4>(&com[offset]);
+      EXPECT(assert_equal(Pose(values, link->id(), t), Pose3(wTcom)));
+      const gtsam::Matrix4 wTlink =
+          Eigen::Map<const RowMajor4>(&frames[offset]);
+      EXPECT(assert_equal(Pose(values, link->id(), t) *
+                              link->bMcom().between(link->bMlink()),
+                          Pose3(wTlink), 1e-12));
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
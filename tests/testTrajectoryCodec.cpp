@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryCodec.cpp
+ * @brief Test the streamable trajectory encoding.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectoryCodec.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const size_t num_steps = 110;
+
+// Smooth joint series, 10 ms apart.
+TrajectoryBuffer Buffer() {
+  TrajectoryBuffer buffer(robot, num_steps);
+  for (size_t t = 0; t < num_steps; t++) {
+    for (int j = 0; j < 2; j++) {
+      const double s = 0.01 * t + j;
+      buffer.jointAngles()(t, j) = std::sin(s);
+      buffer.jointVels()(t, j) = std::cos(s);
+      buffer.jointAccels()(t, j) = -std::sin(s);
+      buffer.torques()(t, j) = 5 * std::cos(2 * s);
+    }
+  }
+  return buffer;
+}
+
+std::vector<std::vector<uint8_t>> Messages(const TrajectoryEncoder &encoder) {
+  std::vector<std::vector<uint8_t>> messages{encoder.header()};
+  for (size_t i = 0; i < encoder.numChunks(); i++) {
+    messages.push_back(encoder.chunk(i));
+  }
+  return messages;
+}
+}  // namespace example
+
+// Every value decodes to within its tolerance, in far fewer bytes.
+TEST(TrajectoryCodec, RoundTrip) {
+  const TrajectoryBuffer buffer = example::Buffer();
+  const TrajectoryCodecParameters parameters;
+  const TrajectoryEncoder encoder(buffer, parameters);
+  EXPECT_LONGS_EQUAL(5, encoder.numChunks());
+  const auto messages = example::Messages(encoder);
+  size_t num_bytes = 0;
+  for (auto &&message : messages) num_bytes += message.size();
+  EXPECT(num_bytes * 4 < example::num_steps * 2 * 4 * sizeof(double));
+
+  const TrajectoryBuffer decoded =
+      TrajectoryDecoder::Decode(example::robot, messages);
+  EXPECT_LONGS_EQUAL(example::num_steps, decoded.numSteps());
+  EXPECT((decoded.jointAngles() - buffer.jointAngles()).cwiseAbs().maxCoeff() <=
+         parameters.angle_tolerance);
+  EXPECT((decoded.jointVels() - buffer.jointVels()).cwiseAbs().maxCoeff() <=
+         parameters.vel_tolerance);
+  EXPECT((decoded.jointAccels() - buffer.jointAccels()).cwiseAbs().maxCoeff() <=
+         parameters.accel_tolerance);
+  EXPECT((decoded.torques() - buffer.torques()).cwiseAbs().maxCoeff() <=
+         parameters.torque_tolerance);
+
+  // Decoding is exact on the quantization grid, so encoding again gives the
+  // same messages.
+  EXPECT(example::Messages(TrajectoryEncoder(decoded, parameters)) ==
+         messages);
+}
+
+// Steps are ready as soon as all chunks before them arrived.
+TEST(TrajectoryCodec, Streaming) {
+  TrajectoryCodecParameters parameters;
+  parameters.quantities = TrajectoryBuffer::kJointAngles;
+  const TrajectoryEncoder encoder(example::Buffer(), parameters);
+  TrajectoryDecoder decoder(example::robot);
+  CHECK_EXCEPTION(decoder.add(encoder.chunk(0)), std::runtime_error);
+
+  decoder.add(encoder.header());
+  EXPECT(decoder.hasHeader());
+  EXPECT_LONGS_EQUAL(0, decoder.numReadySteps());
+  decoder.add(encoder.chunk(0));
+  EXPECT_LONGS_EQUAL(25, decoder.numReadySteps());
+  decoder.add(encoder.chunk(2));
+  EXPECT_LONGS_EQUAL(25, decoder.numReadySteps());
+  decoder.add(encoder.chunk(1));
+  EXPECT_LONGS_EQUAL(75, decoder.numReadySteps());
+  decoder.add(encoder.chunk(4));
+  decoder.add(encoder.chunk(3));
+  EXPECT(decoder.complete());
+  EXPECT_LONGS_EQUAL(example::num_steps, decoder.numReadySteps());
+  EXPECT(decoder.buffer().torques().isZero());
+
+  std::vector<uint8_t> truncated = encoder.chunk(1);
+  truncated.pop_back();
+  CHECK_EXCEPTION(decoder.add(truncated), std::runtime_error);
+}
+
+// Invalid parameters and values are rejected.
+TEST(TrajectoryCodec, Errors) {
+  TrajectoryBuffer buffer = example::Buffer();
+  TrajectoryCodecParameters parameters;
+  parameters.angle_tolerance = 0;
+  CHECK_EXCEPTION(TrajectoryEncoder(buffer, parameters),
+                  std::invalid_argument);
+  buffer.jointVels()(3, 1) = std::numeric_limits<double>::quiet_NaN();
+  CHECK_EXCEPTION(TrajectoryEncoder(buffer), std::invalid_argument);
+
+  const TrajectoryEncoder encoder(example::Buffer());
+  const Robot other = simple_urdf::getRobot();
+  TrajectoryDecoder decoder(other);
+  CHECK_EXCEPTION(decoder.add(encoder.header()), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryFeedback.cpp
+ * @brief Test feedback gains extracted from an optimized trajectory.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/TrajectoryFeedback.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector2;
+
+namespace example {
+const auto robot = simple_rr::getRobot();
+const int kNumSteps = 5;
+const double kDt = 0.1;
+const auto tight = gtsam::noiseModel::Isotropic::Sigma(1, 1e-4);
+const auto unit = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+
+// Double integrators, a = tau, from a start state at step k0 to a goal
+// angle at kNumSteps, with torque costs and a cost coupling the joints.
+NonlinearFactorGraph Graph(int k0, const Vector2 &q0, const Vector2 &v0,
+                           Values *init) {
+  NonlinearFactorGraph graph;
+  for (int k = k0; k <= kNumSteps; k++) {
+    for (int j = 0; j < 2; j++) {
+      for (auto key : {JointAngleKey(j, k), JointVelKey(j, k),
+                       JointAccelKey(j, k), TorqueKey(j, k)}) {
+        init->insert(key, 0.0);
+      }
+      graph.emplace_shared<gtsam::PriorFactor<double>>(TorqueKey(j, k), 0.0,
+                                                       unit);
+      graph.emplace_shared<gtsam::BetweenFactor<double>>(
+          TorqueKey(j, k), JointAccelKey(j, k), 0.0, tight);
+      if (k == k0) {
+        graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(j, k),
+                                                         q0(j), tight);
+        graph.emplace_shared<gtsam::PriorFactor<double>>(JointVelKey(j, k),
+                                                         v0(j), tight);
+      }
+      if (k < kNumSteps) {
+        DynamicsGraph::addCollocationFactorDouble(
+            &graph, JointAngleKey(j, k), JointAngleKey(j, k + 1),
+            JointVelKey(j, k), JointVelKey(j, k + 1), kDt, tight, Euler);
+        DynamicsGraph::addCollocationFactorDouble(
+            &graph, JointVelKey(j, k), JointVelKey(j, k + 1),
+            JointAccelKey(j, k), JointAccelKey(j, k + 1), kDt, tight, Euler);
+      } else {
+        graph.emplace_shared<gtsam::PriorFactor<double>>(
+            JointAngleKey(j, k), 1.0 - j, gtsam::noiseModel::Isotropic::Sigma(
+                                              1, 0.1));
+      }
+    }
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, k), JointAngleKey(1, k), 0.0, unit);
+  }
+  return graph;
+}
+
+Values Solve(const NonlinearFactorGraph &graph, const Values &init) {
+  return gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+}
+}  // namespace example
+
+TEST(TrajectoryFeedback, Gains) {
+  using namespace example;
+  Values init;
+  const auto graph = Graph(0, Vector2(0, 0), Vector2(0, 0), &init);
+  const Values solution = Solve(graph, init);
+  const TrajectoryFeedback feedback(robot, graph, solution, kNumSteps);
+  EXPECT_LONGS_EQUAL(kNumSteps + 1, feedback.numSteps());
+  EXPECT_LONGS_EQUAL(4, feedback.stateDim());
+  EXPECT_LONGS_EQUAL(2, feedback.gain(0).rows());
+  EXPECT_LONGS_EQUAL(4, feedback.gain(0).cols());
+
+  // At the optimum there is no feed-forward correction, and at the solution
+  // the torques are the optimal ones.
+  for (size_t k = 0; k < feedback.numSteps(); k++) {
+    EXPECT(assert_equal(Vector::Zero(2), feedback.feedforward(k), 1e-6));
+  }
+  EXPECT(assert_equal(
+      Vector2(Torque(solution, 0, 2), Torque(solution, 1, 2)),
+      feedback.torques(2, solution), 1e-6));
+
+  // Off the trajectory, the gains give the torques of the optimal
+  // trajectory from the measured state on.
+  const int k = 2;
+  const Vector2 q(JointAngle(solution, 0, k) + 0.01,
+                  JointAngle(solution, 1, k) - 0.02);
+  const Vector2 v(JointVel(solution, 0, k) + 0.03, JointVel(solution, 1, k));
+  Values tail_init;
+  const auto tail = Graph(k, q, v, &tail_init);
+  const Values expected = Solve(tail, tail_init);
+  Values measured;
+  for (int j = 0; j < 2; j++) {
+    InsertJointAngle(&measured, j, k, q(j));
+    InsertJointVel(&measured, j, k, v(j));
+  }
+  const Values control = feedback.control(k, measured);
+  EXPECT_DOUBLES_EQUAL(Torque(expected, 0, k), Torque(control, 0, k), 1e-4);
+  EXPECT_DOUBLES_EQUAL(Torque(expected, 1, k), Torque(control, 1, k), 1e-4);
+
+  // The coupling cost makes the gains of one joint depend on the other.
+  EXPECT(std::abs(feedback.gain(k)(0, 1)) > 1e-6);
+
+  CHECK_EXCEPTION(TrajectoryFeedback(robot, graph, solution, kNumSteps + 1),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryLog.cpp
+ * @brief Test columnar binary trajectory logs.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectoryLog.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace example {
+const std::string log_path = "testTrajectoryLog.gtdtraj";
+
+// A trajectory with joint angles, link poses and twists; no twist at t = 2.
+Values trajectory(int num_steps) {
+  Values values;
+  for (int t = 0; t < num_steps; t++) {
+    InsertJointAngle(&values, 0, t, 0.1 * t);
+    InsertJointAngle(&values, 1, t, -0.2 * t);
+    InsertPose(&values, 3, t, Pose3(gtsam::Rot3::Rz(0.3 * t),
+                                    gtsam::Point3(t, 2, 3)));
+    if (t != 2) {
+      InsertTwist(&values, 3, t,
+                  (gtsam::Vector6() << 1, 2, 3, 4, 5, t).finished());
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+// A trajectory spread over several chunks reads back the same.
+TEST(TrajectoryLog, RoundTrip) {
+  const Values values = example::trajectory(5);
+  {
+    TrajectoryLogWriter writer(example::log_path, 2);
+    writer.appendTrajectory(values);
+    EXPECT_LONGS_EQUAL(5, writer.numSteps());
+  }
+
+  const TrajectoryLog log(example::log_path);
+  EXPECT_LONGS_EQUAL(5, log.numSteps());
+  EXPECT_LONGS_EQUAL(4, log.columns().size());
+  EXPECT(!log.truncated());
+  EXPECT(assert_equal(values, log.values(), 1e-12));
+  EXPECT(log.has(JointAngleKey(1, 42)));
+  EXPECT(!log.has(JointAngleKey(2, 0)));
+  EXPECT(!log.values(2).exists(TwistKey(3, 2)));
+  EXPECT(assert_equal(Pose(values, 3, 4), Pose(log.values(4), 3, 4), 1e-12));
+
+  const gtsam::Matrix q = log.series(JointAngleKey(1));
+  EXPECT_LONGS_EQUAL(5, q.rows());
+  EXPECT_LONGS_EQUAL(1, q.cols());
+  EXPECT_DOUBLES_EQUAL(-0.6, q(3, 0), 1e-12);
+  const gtsam::Matrix twists = log.series(TwistKey(3));
+  EXPECT_LONGS_EQUAL(6, twists.cols());
+  EXPECT(std::isnan(twists(2, 0)));
+  EXPECT_DOUBLES_EQUAL(4, twists(4, 5), 1e-12);
+  CHECK_EXCEPTION(log.series(JointAngleKey(2)), std::runtime_error);
+  CHECK_EXCEPTION(log.values(5), std::runtime_error);
+  std::remove(example::log_path.c_str());
+}
+
+// Steps appended one at a time, and to an existing log.
+TEST(TrajectoryLog, Append) {
+  const Values values = example::trajectory(4);
+  {
+    TrajectoryLogWriter writer(example::log_path, 3);
+    for (int t = 0; t < 2; t++) {
+      Values step;
+      for (gtsam::Key key : values.keys())
+        if (DynamicsSymbol(key).time() == size_t(t))
+          step.insert(DynamicsSymbol(key).atTime(0), values.at(key));
+      writer.append(step);
+    }
+
+    // New variables cannot be added after the first step.
+    Values other;
+    InsertJointAngle(&other, 2, 0.0);
+    CHECK_EXCEPTION(writer.append(other), std::runtime_error);
+  }
+  {
+    TrajectoryLogWriter writer(example::log_path, 3, true);
+    EXPECT_LONGS_EQUAL(2, writer.numSteps());
+    Values rest;
+    for (gtsam::Key key : values.keys())
+      if (DynamicsSymbol(key).time() >= 2) rest.insert(key, values.at(key));
+    writer.appendTrajectory(rest);
+    writer.close();
+    CHECK_EXCEPTION(writer.append(rest), std::runtime_error);
+  }
+
+  // The second trajectory's steps 0 and 1 are empty.
+  const TrajectoryLog log(example::log_path);
+  EXPECT_LONGS_EQUAL(6, log.numSteps());
+  Values first = log.values(0);
+  first.insert(log.values(1));
+  EXPECT(assert_equal(example::trajectory(2), first));
+  EXPECT_LONGS_EQUAL(0, log.values(3).size());
+  EXPECT_DOUBLES_EQUAL(-0.6, JointAngle(log.values(5), 1, 5), 1e-12);
+  std::remove(example::log_path.c_str());
+}
+
+// A partially written chunk is ignored, and not appended to.
+TEST(TrajectoryLog, Truncated) {
+  {
+    TrajectoryLogWriter writer(example::log_path, 2);
+    writer.appendTrajectory(example::trajectory(4));
+  }
+  std::string data;
+  {
+    std::ifstream is(example::log_path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(is),
+                std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream os(example::log_path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size() - 8);
+  }
+  const TrajectoryLog log(example::log_path);
+  EXPECT(log.truncated());
+  EXPECT_LONGS_EQUAL(2, log.numSteps());
+  CHECK_EXCEPTION(TrajectoryLogWriter{example::log_path, 2, true},
+                  std::runtime_error);
+  std::remove(example::log_path.c_str());
+  CHECK_EXCEPTION(TrajectoryLog{example::log_path}, std::runtime_error);
+}
+
+// The simulator logs what getValues() returns after every step.
+TEST(TrajectoryLog, Simulator) {
+  const Robot robot = simple_urdf::getRobot();
+  Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  Simulator simulator(robot, initial_values, simple_urdf::gravity,
+                      simple_urdf::planar_axis);
+  simulator.startLogging(example::log_path, 2);
+  std::vector<Values> steps;
+  for (int k = 0; k < 3; k++) {
+    simulator.step(torques, 0.5);
+    steps.push_back(simulator.getValues());
+  }
+  simulator.stopLogging();
+  simulator.step(torques, 0.5);
+
+  const TrajectoryLog log(example::log_path);
+  EXPECT_LONGS_EQUAL(3, log.numSteps());
+  for (int k = 0; k < 3; k++) {
+    const Values logged = log.values(k);
+    EXPECT_LONGS_EQUAL(steps[k].size(), logged.size());
+    EXPECT(assert_equal(JointAngle(steps[k], 0), JointAngle(logged, 0, k)));
+    EXPECT(assert_equal(JointAccel(steps[k], 0), JointAccel(logged, 0, k)));
+    EXPECT(assert_equal(Pose(steps[k], 1), Pose(logged, 1, k)));
+  }
+  std::remove(example::log_path.c_str());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryMarginals.cpp
+ * @brief Test marginal covariances of selected trajectory variables.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/TrajectoryMarginals.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/Marginals.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+// Two joint angles over time, coupled at every step, with priors at both
+// ends so that the covariances vary along the trajectory.
+NonlinearFactorGraph chain(int num_steps, Values *values) {
+  NonlinearFactorGraph graph;
+  const auto prior_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  const auto step_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.3);
+  const auto coupling_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  for (int t = 0; t < num_steps; t++) {
+    for (int j = 0; j < 2; j++) {
+      values->insert(JointAngleKey(j, t), 0.1 * t + j);
+      if (t > 0) {
+        graph.emplace_shared<gtsam::BetweenFactor<double>>(
+            JointAngleKey(j, t - 1), JointAngleKey(j, t), 0.1, step_model);
+      }
+    }
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t), JointAngleKey(1, t), 1.0, coupling_model);
+  }
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, prior_model);
+  graph.addPrior<double>(JointAngleKey(1, num_steps - 1), 1.0, prior_model);
+  return graph;
+}
+}  // namespace example
+
+// Compare with gtsam::Marginals for a few variables.
+TEST(TrajectoryMarginals, chain) {
+  Values values;
+  const NonlinearFactorGraph graph = example::chain(10, &values);
+  const gtsam::Marginals expected(graph, values);
+  const TrajectoryMarginals marginals(graph, values);
+
+  const gtsam::KeyVector keys{JointAngleKey(0, 0), JointAngleKey(1, 4),
+                              JointAngleKey(0, 9)};
+  const auto covariances = marginals.marginalCovariances(keys);
+  EXPECT_LONGS_EQUAL(3, covariances.size());
+  for (gtsam::Key key : keys) {
+    EXPECT(assert_equal(expected.marginalCovariance(key),
+                        covariances.at(key), 1e-9));
+  }
+  EXPECT(assert_equal(expected.marginalCovariance(JointAngleKey(1, 7)),
+                      marginals.marginalCovariance(JointAngleKey(1, 7)),
+                      1e-9));
+  CHECK_EXCEPTION(marginals.marginalCovariance(JointAngleKey(2, 0)),
+                  std::invalid_argument);
+}
+
+// The Bayes tree of ISAM2 gives the same covariances.
+TEST(TrajectoryMarginals, ISAM2) {
+  Values values;
+  const NonlinearFactorGraph graph = example::chain(10, &values);
+  const gtsam::Marginals expected(graph, values);
+
+  gtsam::ISAM2 isam;
+  isam.update(graph, values);
+  const gtsam::KeyVector keys{JointAngleKey(1, 0), JointAngleKey(0, 5)};
+  const auto covariances = MarginalCovariances(isam, keys);
+  for (gtsam::Key key : keys) {
+    EXPECT(assert_equal(expected.marginalCovariance(key),
+                        covariances.at(key), 1e-6));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
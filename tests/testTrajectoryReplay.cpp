@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryReplay.cpp
+ * @brief Test replaying trajectories with PD tracking in the contact
+ * simulator.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/TrajectoryReplay.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace example {
+const double dt = 1e-3;
+const size_t num_steps = 200;
+
+// Floating simple_urdf standing on the four corners of l1.
+ContactSimulator Simulator() {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  const auto l1 = robot.link("l1");
+  PointOnLinks feet;
+  for (double x : {-0.2, 0.2})
+    for (double y : {-0.2, 0.2}) feet.emplace_back(l1, Point3(x, y, -1));
+  ContactSimulator simulator(robot, feet, gtsam::Vector3(0, 0, -9.8));
+  simulator.setState(Pose3(gtsam::Rot3(), Point3(0, 0, 1)), gtsam::Z_6x1,
+                     Vector::Zero(1), Vector::Zero(1));
+  return simulator;
+}
+
+// The open-loop response to a sinusoidal torque, as the planned trajectory.
+TrajectoryBuffer Plan(const ContactSimulator &prototype) {
+  ContactSimulator simulator = prototype;
+  const uint16_t root = simulator.rootLink()->id();
+  TrajectoryBuffer plan(simulator.robot(), num_steps);
+  for (size_t t = 0; t < num_steps; t++) {
+    const Vector torque = Vector::Constant(1, 5 * std::sin(0.05 * t));
+    plan.jointAngles().row(t) = simulator.jointAngles().transpose();
+    plan.jointVels().row(t) = simulator.jointVels().transpose();
+    plan.torques().row(t) = torque.transpose();
+    plan.pose(root, t) = simulator.basePose();
+    plan.twist(root, t) = simulator.baseTwist();
+    simulator.step(torque, dt);
+  }
+  return plan;
+}
+}  // namespace example
+
+// A trajectory of the simulator itself is tracked exactly.
+TEST(TrajectoryReplay, Exact) {
+  const ContactSimulator prototype = example::Simulator();
+  const TrajectoryBuffer plan = example::Plan(prototype);
+  ContactSimulator simulator = prototype;
+  const TrackingMetrics metrics =
+      ReplayTrajectory(&simulator, plan, example::dt);
+  EXPECT_LONGS_EQUAL(example::num_steps, metrics.joint_angle_errors.rows());
+  EXPECT_LONGS_EQUAL(example::num_steps, simulator.t());
+  EXPECT_DOUBLES_EQUAL(0, metrics.max_joint_angle_error, 1e-12);
+  EXPECT_DOUBLES_EQUAL(0, metrics.rms_base_position_error, 1e-12);
+  EXPECT(assert_equal(plan.torques(), metrics.torques, 1e-12));
+}
+
+// Without the planned torques, PD alone lags behind; batches in parallel
+// match replays one at a time.
+TEST(TrajectoryReplay, Batch) {
+  const ContactSimulator prototype = example::Simulator();
+  const TrajectoryBuffer plan = example::Plan(prototype);
+  ReplayParameters parameters;
+  parameters.feedforward = false;
+  parameters.substeps = 2;
+
+  ContactSimulator simulator = prototype;
+  const TrackingMetrics expected =
+      ReplayTrajectory(&simulator, plan, example::dt, parameters);
+  EXPECT(expected.max_joint_angle_error > 1e-6);
+  EXPECT_LONGS_EQUAL(2 * example::num_steps, simulator.t());
+  EXPECT_DOUBLES_EQUAL(expected.max_joint_angle_error,
+                       expected.joint_angle_errors.cwiseAbs().maxCoeff(), 0);
+
+  const std::vector<TrackingMetrics> batch = ReplayTrajectories(
+      prototype, {plan, plan, plan}, example::dt, parameters, 3);
+  LONGS_EQUAL(3, batch.size());
+  for (auto &&metrics : batch) {
+    EXPECT(assert_equal(expected.joint_angle_errors,
+                        metrics.joint_angle_errors, 1e-12));
+    EXPECT(assert_equal(expected.rms_joint_angle_errors,
+                        metrics.rms_joint_angle_errors, 1e-12));
+  }
+
+  parameters.substeps = 0;
+  CHECK_EXCEPTION(ReplayTrajectory(&simulator, plan, example::dt, parameters),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
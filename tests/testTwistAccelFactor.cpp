@@ -112,6 +112,32 @@ TEST(TwistAccelFactor, error_1) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-3);
 }
 
+// The analytic factor agrees with the expression factor away from the
+// solution.
+TEST(TwistAccelFactor, analytic) {
+  gtsam::Pose3 cMp(gtsam::Rot3::Ry(0.2), gtsam::Point3(-1, 0, 0));
+  gtsam::Vector6 screw_axis = (gtsam::Vector(6) << 0, 0, 1, 0, 1, 0).finished();
+  auto joint = make_joint(cMp, screw_axis);
+  auto expected = TwistAccelFactor(example::cost_model, joint, 0);
+  auto factor = TwistAccelFactor(example::cost_model, joint, 0, true);
+  EXPECT(boost::dynamic_pointer_cast<AnalyticTwistAccelFactor<HelicalJoint>>(
+      factor));
+
+  gtsam::Values values;
+  values.insert(example::qKey, 0.5);
+  values.insert(example::qVelKey, 1.5);
+  values.insert(example::qAccelKey, -3.0);
+  values.insert(example::twistKey,
+                (gtsam::Vector6() << 1, -2, 3, 0.5, 1, -1).finished());
+  values.insert(example::twistAccel_p_key,
+                (gtsam::Vector6() << 0, 1, 2, -1, 0.5, 2).finished());
+  values.insert(example::twistAccel_c_key,
+                (gtsam::Vector6() << -1, 0, 1, 2, 0, 0.5).finished());
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
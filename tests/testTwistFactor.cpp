@@ -68,6 +68,30 @@ TEST(TwistFactor, error) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-3);
 }
 
+// The analytic factor agrees with the expression factor away from the
+// solution.
+TEST(TwistFactor, analytic) {
+  gtsam::Pose3 cMp(gtsam::Rot3::Rx(0.3), gtsam::Point3(-1, 0, 0));
+  gtsam::Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(cMp, screw_axis);
+  auto expected = TwistFactor(example::cost_model, joint, 0);
+  auto factor = TwistFactor(example::cost_model, joint, 0, true);
+  EXPECT(boost::dynamic_pointer_cast<AnalyticTwistFactor<HelicalJoint>>(
+      factor));
+
+  gtsam::Values values;
+  values.insert(example::qKey, 0.6);
+  values.insert(example::qVelKey, -2.0);
+  values.insert(example::twist_p_key,
+                (gtsam::Vector6() << 1, -2, 3, 0.5, 1, -1).finished());
+  values.insert(example::twist_c_key,
+                (gtsam::Vector6() << 0, 1, 2, -1, 0.5, 2).finished());
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
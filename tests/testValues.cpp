@@ -17,6 +17,11 @@
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Unit3.h>
+
+#include <sstream>
+#include <string>
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -34,6 +39,61 @@ TEST(Values, at) {
   CHECK_EXCEPTION(TwistAccel(values, 7), KeyDoesNotExist);
 }
 
+// One tab separated line per variable, in key order.
+TEST(Values, WriteValuesTable) {
+  gtsam::Values values;
+  InsertJointAngle(&values, 2, 5, 0.25);
+  InsertPose(&values, 1, 3,
+             gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(1, 2, 3)));
+  InsertWrench(&values, 1, 2, 0, gtsam::Vector6::Constant(-1.5));
+  values.insert(DynamicsSymbol::SimpleSymbol("s", 4), gtsam::Vector2(1, 2));
+
+  std::ostringstream os;
+  WriteValuesTable(values, os);
+  const std::string expected =
+      "# label\trobot\tlink\tjoint\tt\tdim\tvalue\n"
+      "F\t0\t1\t2\t0\t6\t-1.5\t-1.5\t-1.5\t-1.5\t-1.5\t-1.5\n"
+      "p\t0\t1\t-1\t3\t6\t1\t0\t0\t0\t1\t0\t0\t0\t1\t1\t2\t3\n"
+      "q\t0\t-1\t2\t5\t1\t0.25\n"
+      "s\t0\t-1\t-1\t4\t2\n";
+  EXPECT(assert_equal(expected, os.str()));
+
+  CHECK_EXCEPTION(WriteValuesTable(values, "/nonexistent/values.tsv"),
+                  std::runtime_error);
+}
+
+// Values of all supported types survive a binary round trip.
+TEST(Values, ValuesToBytes) {
+  gtsam::Values values;
+  InsertJointAngle(&values, 2, 5, 0.25);
+  InsertPose(&values, 1, 3,
+             gtsam::Pose3(gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3),
+                          gtsam::Point3(1, 2, 3)));
+  InsertWrench(&values, 1, 2, 0, gtsam::Vector6::Constant(-1.5));
+  values.insert(DynamicsSymbol::SimpleSymbol("s", 4), gtsam::Vector2(1, 2));
+  values.insert(DynamicsSymbol::SimpleSymbol("v", 0),
+                gtsam::Vector(gtsam::Vector3(1, 2, 3)));
+  values.insert(DynamicsSymbol::SimpleSymbol("R", 0), gtsam::Rot3::Rz(0.5));
+  values.insert(DynamicsSymbol::SimpleSymbol("P", 0),
+                gtsam::Pose2(1, 2, 0.5));
+
+  const std::string data = ValuesToBytes(values);
+  const gtsam::Values decoded = ValuesFromBytes(data);
+  EXPECT(assert_equal(values, decoded));
+  // Fixed-size vectors keep their type.
+  EXPECT(assert_equal(gtsam::Vector6::Constant(-1.5), Wrench(decoded, 1, 2)));
+  EXPECT(assert_equal(
+      gtsam::Vector3(1, 2, 3),
+      gtsam::Vector3(decoded.at<gtsam::Vector>(
+          DynamicsSymbol::SimpleSymbol("v", 0)))));
+
+  CHECK_EXCEPTION(ValuesFromBytes(data.substr(0, data.size() - 1)),
+                  std::runtime_error);
+  CHECK_EXCEPTION(ValuesFromBytes("GTDROBOT"), std::runtime_error);
+  values.insert(DynamicsSymbol::SimpleSymbol("u", 0), gtsam::Unit3());
+  CHECK_EXCEPTION(ValuesToBytes(values), std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
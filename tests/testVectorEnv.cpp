@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testVectorEnv.cpp
+ * @brief Test vectorized environments against the contact simulator.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/VectorEnv.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace example {
+// Floating simple_urdf standing on the four corners of l1, as in
+// testContactSimulator.
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+
+PointOnLinks Feet() {
+  PointOnLinks feet;
+  for (double x : {-0.2, 0.2})
+    for (double y : {-0.2, 0.2})
+      feet.emplace_back(robot.link("l1"), Point3(x, y, -1));
+  return feet;
+}
+
+const Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// Every environment steps like its own ContactSimulator.
+TEST(VectorEnv, Step) {
+  using namespace example;
+  VectorEnvParameters parameters;
+  parameters.dt = 1e-3;
+  parameters.substeps = 5;
+  VectorEnv env(robot, Feet(), 3, gravity, parameters, 2);
+  EXPECT_LONGS_EQUAL(3, env.numEnvs());
+  EXPECT_LONGS_EQUAL(1, env.actionDim());
+  EXPECT_LONGS_EQUAL(13 + 2, env.observationDim());
+
+  const Pose3 start(gtsam::Rot3::Rz(0.3), Point3(0, 0, 1.2));
+  for (size_t n = 0; n < 3; n++) {
+    env.setInitialState(n, start, gtsam::Z_6x1, Vector::Constant(1, 0.1 * n),
+                        Vector::Zero(1));
+  }
+  env.reset();
+  const auto q = start.rotation().toQuaternion();
+  EXPECT(assert_equal(Vector(start.translation()),
+                      Vector(env.observations().row(1).head<3>().transpose())));
+  EXPECT_DOUBLES_EQUAL(q.w(), env.observations()(1, 3), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.1, env.observations()(1, 13), 1e-12);
+
+  ContactSimulator simulator(robot, Feet(), gravity, parameters.contact);
+  simulator.setState(start, gtsam::Z_6x1, Vector::Constant(1, 0.2),
+                     Vector::Zero(1));
+  for (int k = 0; k < 10; k++) {
+    env.actions().setConstant(0.5);
+    env.step();
+    for (size_t s = 0; s < parameters.substeps; s++) {
+      simulator.step(Vector::Constant(1, 0.5), parameters.dt);
+    }
+  }
+  EXPECT_LONGS_EQUAL(10, env.episodeSteps(2));
+  EXPECT(assert_equal(simulator.basePose(), env.simulator(2).basePose()));
+  EXPECT(assert_equal(simulator.jointAngles(),
+                      Vector(env.observations().row(2).segment<1>(13))));
+  EXPECT(assert_equal(simulator.jointVels(),
+                      Vector(env.observations().row(2).segment<1>(14))));
+  EXPECT(!env.terminated()(2) && !env.truncated()(2));
+
+  CHECK_EXCEPTION(env.setInitialState(0, start, gtsam::Z_6x1, Vector::Zero(2),
+                                      Vector::Zero(2)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(env.reset(3), std::out_of_range);
+}
+
+// Ended episodes are reset within the step.
+TEST(VectorEnv, Episodes) {
+  using namespace example;
+  VectorEnvParameters parameters;
+  parameters.max_episode_steps = 2;
+  VectorEnv env(robot, Feet(), 2, gravity, parameters, 1);
+  const VectorEnv::Array initial = env.observations();
+
+  env.step();
+  EXPECT(!env.truncated()(0));
+  EXPECT_LONGS_EQUAL(1, env.episodeSteps(0));
+  env.step();
+  EXPECT(env.truncated()(0) && !env.terminated()(0));
+  EXPECT_LONGS_EQUAL(0, env.episodeSteps(0));
+  EXPECT(assert_equal(Vector(initial.row(0).transpose()),
+                      Vector(env.observations().row(0).transpose())));
+
+  // A base below the minimum height terminates the episode.
+  parameters.min_base_height = 10;
+  parameters.max_episode_steps = 0;
+  VectorEnv falling(robot, Feet(), 1, gravity, parameters, 1);
+  falling.step();
+  EXPECT(falling.terminated()(0) && !falling.truncated()(0));
+  EXPECT_LONGS_EQUAL(0, falling.episodeSteps(0));
+}
+
+// The legged robots of training load and step.
+TEST(VectorEnv, Vision60) {
+  const Robot vision60 =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+  PointOnLinks feet;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    feet.emplace_back(vision60.link(name), Point3(0.14, 0, 0));
+  }
+  VectorEnv env(vision60, feet, 4, example::gravity);
+  EXPECT_LONGS_EQUAL(12, env.actionDim());
+  EXPECT_LONGS_EQUAL(13 + 24, env.observationDim());
+  env.step();
+  EXPECT_LONGS_EQUAL(1, env.episodeSteps(3));
+  EXPECT(env.observations().allFinite());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWarmStartLibrary.cpp
+ * @brief Test the warm-start library.
+ * @author GTDynamics Team
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/WarmStartLibrary.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+namespace example {
+// One joint angle and one link pose per step, and the phase durations.
+Values Solution(size_t num_steps, double angle_scale) {
+  Values values;
+  for (size_t k = 0; k <= num_steps; k++) {
+    InsertJointAngle(&values, 0, k, angle_scale * k);
+    InsertPose(&values, 0, k, Pose3(Rot3::Rz(0.1 * k), Point3(k, 0, 0)));
+  }
+  values.insert(PhaseKey(0), 0.1);
+  values.insert(PhaseKey(1), 0.2);
+  return values;
+}
+
+// Initial values for a trajectory, with a torque the solutions do not have.
+Values Fallback(size_t num_steps) {
+  Values values;
+  for (size_t k = 0; k <= num_steps; k++) {
+    InsertJointAngle(&values, 0, k, 0.0);
+    InsertPose(&values, 0, k, Pose3());
+    InsertTorque(&values, 0, k, 7.0);
+  }
+  values.insert(PhaseKey(0), 1.0);
+  values.insert(PhaseKey(1), 1.0);
+  return values;
+}
+}  // namespace example
+
+// Phases of 2 and 3 steps, stretched to 4 and 6 steps.
+TEST(WarmStartLibrary, TimeWarp) {
+  const Values solution = example::Solution(5, 1.0);
+  const Values values = WarmStartLibrary::TimeWarp(solution, {2, 3}, {4, 6},
+                                                   example::Fallback(10));
+  EXPECT_LONGS_EQUAL(example::Fallback(10).size(), values.size());
+
+  // Boundaries map onto each other, and steps in between are interpolated.
+  EXPECT_DOUBLES_EQUAL(0.0, JointAngle(values, 0, 0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1.5, JointAngle(values, 0, 3), 1e-9);
+  EXPECT_DOUBLES_EQUAL(2.0, JointAngle(values, 0, 4), 1e-9);
+  EXPECT_DOUBLES_EQUAL(3.5, JointAngle(values, 0, 7), 1e-9);
+  EXPECT_DOUBLES_EQUAL(5.0, JointAngle(values, 0, 10), 1e-9);
+  EXPECT(assert_equal(gtsam::interpolate<Pose3>(Pose(solution, 0, 0),
+                                                Pose(solution, 0, 1), 0.5),
+                      Pose(values, 0, 1)));
+
+  // Phases take as long as they did.
+  EXPECT_DOUBLES_EQUAL(0.05, values.at<double>(PhaseKey(0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.1, values.at<double>(PhaseKey(1)), 1e-9);
+
+  // Variables without a stored value keep the fallback.
+  EXPECT_DOUBLES_EQUAL(7.0, Torque(values, 0, 5), 1e-9);
+
+  THROWS_EXCEPTION(
+      WarmStartLibrary::TimeWarp(solution, {5}, {10}, example::Fallback(10)));
+}
+
+// The nearest task with the same structure provides the warm start.
+TEST(WarmStartLibrary, initialValues) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 1);
+  const ContactPointGoals goals = walk_cycle.initContactPointGoal(robot, 0);
+  ContactPointGoals far_goals = goals;
+  for (auto &&goal : far_goals) goal.second += Point3(1, 0, 0);
+
+  WarmStartLibrary library;
+  library.add(WarmStartTask(robot, trajectory, goals),
+              example::Solution(5, 1.0));
+  library.add(WarmStartTask(robot, trajectory, far_goals),
+              example::Solution(5, 2.0));
+  EXPECT_LONGS_EQUAL(2, library.size());
+
+  ContactPointGoals query_goals = goals;
+  for (auto &&goal : query_goals) goal.second += Point3(0.9, 0, 0);
+  const WarmStartTask task(robot, trajectory, query_goals);
+  EXPECT_LONGS_EQUAL(5, task.numTimeSteps());
+  EXPECT(library.hasMatch(task));
+  const Values values = library.initialValues(task, example::Fallback(5));
+  EXPECT_DOUBLES_EQUAL(6.0, JointAngle(values, 0, 3), 1e-9);
+
+  // A trajectory with other phases does not match.
+  const WarmStartTask other(robot, Trajectory(walk_cycle, 2), goals);
+  EXPECT(!library.hasMatch(other));
+  EXPECT(assert_equal(example::Fallback(10),
+                      library.initialValues(other, example::Fallback(10))));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
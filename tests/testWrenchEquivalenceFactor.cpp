@@ -128,6 +128,29 @@ TEST(WrenchEquivalenceFactor, error_3) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-3);
 }
 
+// The analytic factor agrees with the expression factor away from the
+// solution.
+TEST(WrenchEquivalenceFactor, analytic) {
+  Pose3 kMj = Pose3(Rot3::Rx(0.4), Point3(-2, 0, 0));
+  Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(kMj, screw_axis);
+  auto expected = WrenchEquivalenceFactor(example::cost_model, joint, 777);
+  auto factor = WrenchEquivalenceFactor(example::cost_model, joint, 777, true);
+  using Analytic = AnalyticWrenchEquivalenceFactor<HelicalJoint>;
+  EXPECT(boost::dynamic_pointer_cast<Analytic>(factor));
+
+  Values values;
+  values.insert(example::wrench_j_key,
+                (Vector6() << 1, -2, 3, 0.5, 1, -1).finished());
+  values.insert(example::wrench_k_key,
+                (Vector6() << 0, 1, 2, -1, 0.5, 2).finished());
+  values.insert(example::qKey, 0.7);
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
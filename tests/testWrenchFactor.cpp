@@ -25,6 +25,8 @@
 #include <gtsam/nonlinear/factorTesting.h>
 
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 using namespace gtdynamics;
 using namespace gtsam;
@@ -115,6 +117,42 @@ TEST(WrenchFactor, NonzeroTwistCase) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, x, diffDelta, tol);
 }
 
+// Fixed-arity factors match the expression factor, for 1 to 5 wrenches.
+TEST(WrenchFactor, FixedArity) {
+  int id = 0;
+  Values x;
+  InsertTwist(&x, id, (Vector(6) << 0.1, -0.2, 1, 0.3, 1, -0.5).finished());
+  InsertTwistAccel(&x, id,
+                   (Vector(6) << 0.4, 0, 1, -0.1, 1, 0.2).finished());
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0, 0)));
+  std::vector<DynamicsSymbol> wrench_keys;
+  for (int j = 1; j <= 5; j++) {
+    wrench_keys.push_back(WrenchKey(id, j));
+    InsertWrench(&x, id, j, Vector6::Constant(0.1 * j));
+
+    for (auto &&gravity :
+         {boost::optional<Vector3>(), boost::optional<Vector3>(
+                                          example::gravity)}) {
+      const auto factor = WrenchFactor(example::cost_model, example::link,
+                                       wrench_keys, 0, gravity);
+      EXPECT_LONGS_EQUAL(j + 2 + (gravity ? 1 : 0), factor->size());
+      const bool fixed = j <= 4;
+      EXPECT(fixed == !boost::dynamic_pointer_cast<ExpressionFactor<Vector6>>(
+                          factor));
+      const ExpressionFactor<Vector6> expected(
+          example::cost_model, Z_6x1,
+          example::link->wrenchConstraint(wrench_keys, 0, gravity));
+      EXPECT(assert_equal(expected.unwhitenedError(x),
+                          factor->unwhitenedError(x), 1e-9));
+      EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, x, diffDelta, tol);
+    }
+  }
+
+  CHECK_EXCEPTION(FixedWrenchFactor<2>(example::cost_model, example::link,
+                                       {WrenchKey(id, 1)}, 0),
+                  std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
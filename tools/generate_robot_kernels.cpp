@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  generate_robot_kernels.cpp
+ * @brief Command-line tool writing the RobotKernels of a URDF or SDF model,
+ * used by the gtdynamics_add_robot_kernels CMake function.
+ * @author GTDynamics Team
+ */
+
+#include <gtdynamics/dynamics/RobotKernelGenerator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace gtdynamics;
+
+namespace {
+const char *kUsage =
+    "Usage: gtdynamics_generate_robot_kernels --model <urdf or sdf file>\n"
+    "    --class <class name> --header <output .h> --source <output .cpp>\n"
+    "    [--model-name <model in sdf file>] [--fixed-link <link name>]\n"
+    "    [--namespace <namespace>] [--gravity <gx> <gy> <gz>]\n";
+
+void Write(const std::string &path, const std::string &contents) {
+  std::ofstream os(path);
+  if (!os) throw std::runtime_error("cannot write " + path);
+  os << contents;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string model, model_name, fixed_link, header_path, source_path;
+  RobotKernelOptions options;
+  try {
+    for (int i = 1; i < argc; i++) {
+      const std::string arg = argv[i];
+      auto next = [&]() -> std::string {
+        if (++i >= argc) throw std::invalid_argument(arg + " needs a value");
+        return argv[i];
+      };
+      if (arg == "--model") {
+        model = next();
+      } else if (arg == "--model-name") {
+        model_name = next();
+      } else if (arg == "--fixed-link") {
+        fixed_link = next();
+      } else if (arg == "--class") {
+        options.class_name = next();
+      } else if (arg == "--namespace") {
+        options.namespace_name = next();
+      } else if (arg == "--header") {
+        header_path = next();
+      } else if (arg == "--source") {
+        source_path = next();
+      } else if (arg == "--gravity") {
+        gtsam::Vector3 gravity;
+        for (int k = 0; k < 3; k++) gravity(k) = std::stod(next());
+        options.gravity = gravity;
+      } else {
+        throw std::invalid_argument("unknown argument " + arg);
+      }
+    }
+    if (model.empty() || header_path.empty() || source_path.empty()) {
+      throw std::invalid_argument("--model, --header and --source are needed");
+    }
+
+    Robot robot = CreateRobotFromFile(model, model_name);
+    if (!fixed_link.empty()) robot = robot.fixLink(fixed_link);
+    options.header_name =
+        header_path.substr(header_path.find_last_of("/\\") + 1);
+    options.description = model + (model_name.empty() ? "" : " " + model_name);
+
+    const RobotKernelSources sources = GenerateRobotKernels(robot, options);
+    Write(header_path, sources.header);
+    Write(source_path, sources.source);
+  } catch (const std::exception &e) {
+    std::cerr << "gtdynamics_generate_robot_kernels: " << e.what() << "\n"
+              << kUsage;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -11,7 +11,12 @@ var line_chart = svg.append("g")
                     .attr('class', 'line_chart');
 
 // =================== load data =================== //
-var file = "factor_graph.json";
+// The file can be chosen with ?file=<name>. Summaries written by
+// DynamicsGraph::saveGraphSummary have one node per time step and label or
+// factor type; double clicking a node opens the detailed chunk of its step,
+// and the browser's back button returns to the summary.
+var file = new URLSearchParams(window.location.search).get("file") ||
+           "factor_graph.json";
 Promise.all([d3.json(file)])
         .then(function(data) 
         {
@@ -61,7 +66,7 @@ function draw_factor_graph(data) {
             .on("end", dragended)
         );
 
-    factor_nodes.on("dblclick", pin);
+    factor_nodes.on("dblclick", pin_or_expand);
 
     var timeout = null;
     variable_nodes//.on("click", make_plot);
@@ -73,7 +78,7 @@ function draw_factor_graph(data) {
       })
       .on("dblclick", function(d) {
         clearTimeout(timeout);
-        pin(d);
+        pin_or_expand(d);
       });
 
     // =================== mouse over =================== //
@@ -157,6 +162,15 @@ function draw_factor_graph(data) {
         c.style("stroke", d.fixed? "black" :null).style("stroke-width", d.fixed? "2.5px" :null)      
     };
 
+    // summary nodes expand into the chunk of their time step
+    function pin_or_expand(d) {
+        if (d.chunk) {
+            window.location.search = "?file=" + encodeURIComponent(d.chunk);
+        } else {
+            pin(d);
+        }
+    }
+
     // =================== double click =================== //
     function make_plot(d_node) {
         // remove the old plot